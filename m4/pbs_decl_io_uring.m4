@@ -0,0 +1,69 @@
+
+#
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+#
+
+
+#
+# Prefix the macro names with PBS_ so they don't conflict with Python definitions
+#
+# Only checks that the io_uring interface can be built against. Whether the
+# running kernel supports it is checked when an event context is created,
+# falling back to epoll if it does not.
+#
+
+AC_DEFUN([PBS_AC_DECL_IO_URING],
+[
+  AS_CASE([x$target_os],
+    [xlinux*],
+      AC_MSG_CHECKING([for io_uring])
+      AC_TRY_COMPILE(
+[
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+], [
+  struct io_uring_getevents_arg arg;
+  long nr = __NR_io_uring_setup + __NR_io_uring_enter;
+  return (IORING_FEAT_EXT_ARG | IORING_FEAT_NODROP | IORING_SETUP_CLAMP | IORING_OP_POLL_REMOVE) + (int) sizeof(arg) + (int) nr;
+],
+        AC_DEFINE([PBS_HAVE_IO_URING], [], [Defined when io_uring is available])
+        AC_MSG_RESULT([yes]),
+        AC_MSG_RESULT([no])
+      ),
+)])
@@ -0,0 +1,76 @@
+
+#
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+#
+
+
+# lz4 is an optional codec for TPP compression (PBS_USE_COMPRESSION=2).
+# It is linked in wherever libz is, so the flags are added to libz_inc
+# and libz_lib; call this after PBS_AC_WITH_LIBZ.
+AC_DEFUN([PBS_AC_WITH_LIBLZ4],
+[
+  AC_ARG_WITH([lz4],
+    AS_HELP_STRING([--with-lz4=DIR],
+      [Enable lz4 TPP compression, optionally specifying the directory where liblz4 is installed.]
+    )
+  )
+  AC_MSG_CHECKING([for lz4])
+  AS_IF([test "x$with_lz4" = "xno" -o "x$with_lz4" = "x"],
+    AC_MSG_RESULT([no]),
+    AS_IF([test "x$with_lz4" = "xyes"],
+      lz4_dir=["/usr"],
+      lz4_dir=["$with_lz4"]
+    )
+    AS_IF([test -r "$lz4_dir/include/lz4.h"],
+      [],
+      AC_MSG_ERROR([lz4 headers not found.])
+    )
+    AS_IF([test "$lz4_dir" = "/usr"],
+      [lz4_lib="-llz4"],
+      AS_IF([test -r "$lz4_dir/lib64/liblz4.so"],
+        [lz4_lib="-L$lz4_dir/lib64 -llz4"],
+        [lz4_lib="-L$lz4_dir/lib -llz4"]
+      )
+      [libz_inc="$libz_inc -I$lz4_dir/include"]
+    )
+    AC_MSG_RESULT([$lz4_dir])
+    [libz_lib="$libz_lib $lz4_lib"]
+    AC_DEFINE([PBS_LZ4_ENABLED], [], [Defined when lz4 TPP compression is available])
+  )
+])
@@ -68,6 +68,94 @@ int	fire_phasers = 0;
 int	no_obit = 0;
 extern char *get_ecname(int rc);
 
+/*
+ * Map of the spawn and obit events to the index of their task, so that
+ * wait_for_task() finds the task of a polled event without scanning the
+ * event arrays of every task, which made fanning out over many thousand
+ * nodes quadratic.  Event numbers are not reused while pbsdsh runs, so
+ * entries are never removed.
+ */
+typedef struct ev_slot {
+	tm_event_t	es_event;
+	int		es_index;	/* index of the task, -1 if free */
+} ev_slot;
+static ev_slot	*ev_map = NULL;
+static unsigned int ev_map_mask = 0;
+
+/**
+ * @brief
+ *	allocate the event map for up to max_events tasks
+ *
+ * @param[in] max_events - number of tasks
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - out of memory
+ *
+ */
+static int
+ev_map_init(int max_events)
+{
+	unsigned int size = 16;
+	unsigned int i;
+
+	/* a spawn and an obit event per task, keep the map half empty */
+	while (size < (unsigned int)max_events * 4)
+		size <<= 1;
+	ev_map = (ev_slot *)malloc(size * sizeof(ev_slot));
+	if (ev_map == NULL)
+		return -1;
+	for (i = 0; i < size; i++)
+		ev_map[i].es_index = -1;
+	ev_map_mask = size - 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	record that event belongs to the task at index
+ *
+ * @param[in] event - spawn or obit event
+ * @param[in] index - index of the task
+ *
+ * @return - Void
+ *
+ */
+static void
+ev_map_add(tm_event_t event, int index)
+{
+	unsigned int h = (unsigned int)event & ev_map_mask;
+
+	while (ev_map[h].es_index != -1 && ev_map[h].es_event != event)
+		h = (h + 1) & ev_map_mask;
+	ev_map[h].es_event = event;
+	ev_map[h].es_index = index;
+}
+
+/**
+ * @brief
+ *	find the index of the task an event belongs to
+ *
+ * @param[in] event - polled event
+ *
+ * @return int
+ * @retval index of the task
+ * @retval -1 if the event is not one of ours
+ *
+ */
+static int
+ev_map_find(tm_event_t event)
+{
+	unsigned int h = (unsigned int)event & ev_map_mask;
+
+	while (ev_map[h].es_index != -1) {
+		if (ev_map[h].es_event == event)
+			return ev_map[h].es_index;
+		h = (h + 1) & ev_map_mask;
+	}
+	return -1;
+}
+
 /**
  * @brief
  *	signal handler function
@@ -141,44 +229,47 @@ wait_for_task(int first, int *nspawned)
 			exit(2);
 		}
 
-		for (c = first; c < (first+nevents); ++c) {
-			if (eventpolled == *(events_spawn + c)) {
-				/* spawn event returned - register obit */
-				(*nspawned)--;
-				if (tm_errno) {
-					fprintf(stderr, "error %d on spawn\n",
-						tm_errno);
-					continue;
-				}
-				if (no_obit)
-					continue;
-
-				rc = tm_obit(*(tid+c), ev+c, events_obit+c);
-				if (rc == TM_SUCCESS) {
-					if (*(events_obit+c) == TM_NULL_EVENT) {
-						if (verbose) {
-							fprintf(stderr, "task already dead\n");
-						}
-					} else if (*(events_obit+c) == TM_ERROR_EVENT) {
-						if (verbose) {
-							fprintf(stderr, "Error on Obit return\n");
-						}
-					} else {
-						nobits++;
+		c = ev_map_find(eventpolled);
+		if (c < first || c >= (first+nevents))
+			continue;
+
+		if (eventpolled == *(events_spawn + c)) {
+			/* spawn event returned - register obit */
+			(*nspawned)--;
+			if (tm_errno) {
+				fprintf(stderr, "error %d on spawn\n",
+					tm_errno);
+				continue;
+			}
+			if (no_obit)
+				continue;
+
+			rc = tm_obit(*(tid+c), ev+c, events_obit+c);
+			if (rc == TM_SUCCESS) {
+				if (*(events_obit+c) == TM_NULL_EVENT) {
+					if (verbose) {
+						fprintf(stderr, "task already dead\n");
+					}
+				} else if (*(events_obit+c) == TM_ERROR_EVENT) {
+					if (verbose) {
+						fprintf(stderr, "Error on Obit return\n");
 					}
-				} else if (verbose) {
-					fprintf(stderr, "%s: failed to register for task termination notice, task 0x%08X\n", id, c);
+				} else {
+					ev_map_add(*(events_obit+c), c);
+					nobits++;
 				}
+			} else if (verbose) {
+				fprintf(stderr, "%s: failed to register for task termination notice, task 0x%08X\n", id, c);
+			}
 
 
-			} else if (eventpolled == *(events_obit + c)) {
-				/* obit event, task exited */
-				nobits--;
-				*(tid+c) = TM_NULL_TASK;
-				if (verbose || *(ev+c) != 0) {
-					printf("%s: task 0x%08X exit status %d\n",
-						id, c, *(ev+c));
-				}
+		} else if (eventpolled == *(events_obit + c)) {
+			/* obit event, task exited */
+			nobits--;
+			*(tid+c) = TM_NULL_TASK;
+			if (verbose || *(ev+c) != 0) {
+				printf("%s: task 0x%08X exit status %d\n",
+					id, c, *(ev+c));
 			}
 		}
 	}
@@ -337,6 +428,10 @@ main(int argc, char *argv[], char *envp[])
 		fprintf(stderr, "%s: out of memory\n", id);
 		return 1;
 	}
+	if (ev_map_init(max_events) != 0) {
+		fprintf(stderr, "%s: out of memory\n", id);
+		return 1;
+	}
 	for (c = 0; c < max_events; c++) {
 		*(tid + c)          = TM_NULL_TASK;
 		*(events_spawn + c) = TM_NULL_EVENT;
@@ -383,6 +478,7 @@ main(int argc, char *argv[], char *envp[])
 		} else {
 			if (verbose)
 				printf("%s: spawned task 0x%08X on logical node %d event %d\n", id, c, nd, *(events_spawn+c));
+			ev_map_add(*(events_spawn+c), c);
 			++nspawned;
 			if (sync)
 				wait_for_task(c, &nspawned); /* one at a time */
@@ -88,6 +88,10 @@
  *	pbsnodes -Sj			single line Jobs summary of specified nodes
  *	pbsnodes -S[j]L			list expanded version of each field in the single line summary
  *
+ *	pbsnodes -t			totals over all vnodes: vnodes in each state,
+ *					resources available and assigned
+ *	pbsnodes -T			totals over all vnodes and for each host
+ *
  *	pbsnodes -c host1 host2		clear OFF_LINE or DOWN from listed hosts
  */
 #include	<pbs_config.h>   /* the master config generated by configure */
@@ -129,7 +133,8 @@ typedef enum mgr_operation {
 	UPDATE_COMMENT, /* add comment to nodes */
 	ALL, /* List all nodes */
 	LISTSP, /* List specified nodes */
-	LISTSPNV /* List specified nodes and their associated vnodes*/
+	LISTSPNV, /* List specified nodes and their associated vnodes*/
+	TOTALS /* List totals computed by the server */
 }mgr_operation_t;
 
 enum output_format_enum {
@@ -206,13 +211,14 @@ encode_to_json(struct batch_status *bstat)
 	if (add_json_node(JSON_OBJECT, JSON_NULL, JSON_NOVALUE, bstat->name, NULL) == NULL)
 		return 1;
 	for (pattr = bstat->attribs; pattr; pattr = pattr->next) {
-		if (strcmp(pattr->name, "resources_available") == 0) {
+		if ((strcmp(pattr->name, "resources_available") == 0) ||
+			(strcmp(pattr->name, ATTR_NODE_summary_state) == 0)) {
 			if (add_json_node(JSON_OBJECT, JSON_NULL, JSON_NOVALUE, pattr->name, NULL) == NULL)
 				return 1;
 			for (next = pattr; next; ) {
 				if (add_json_node(JSON_VALUE, JSON_NULL, JSON_FULLESCAPE, next->resource, next->value) == NULL)
 					return 1;
-				if (next->next == NULL || strcmp(next->next->name, "resources_available")) {
+				if (next->next == NULL || strcmp(next->next->name, pattr->name)) {
 					/* Nothing left in resources_available, close object */
 					if (add_json_node(JSON_OBJECT_END, JSON_NULL, JSON_NOVALUE, NULL, NULL) == NULL)
 						return 1;
@@ -917,6 +923,7 @@ main(int argc, char *argv[])
 	int long_summary = 0;
 	int format = 0;
 	int prt_summary = 0;
+	int by_host = 0;
 
 	/*test for real deal or just version and exit*/
 
@@ -927,7 +934,7 @@ main(int argc, char *argv[])
 
 	if (argc == 1)
 		errflg = 1;
-	while ((i = getopt(argc, argv, "acC:dD:F:HjlLoqrs:Sv")) != EOF)
+	while ((i = getopt(argc, argv, "acC:dD:F:HjlLoqrs:StTv")) != EOF)
 		switch (i) {
 
 			case 'a':
@@ -962,7 +969,7 @@ main(int argc, char *argv[])
 				break;
 
 			case 'D':
-				if (oper == LISTSP || oper == ALL || oper == LISTSPNV)
+				if (oper == LISTSP || oper == ALL || oper == LISTSPNV || oper == TOTALS)
 					dsv_delim = optarg;
 				else
 					errflg = 1;
@@ -1036,6 +1043,16 @@ main(int argc, char *argv[])
 					errflg = 1;
 				break;
 
+			case 't':
+			case 'T':
+				if (oper == LISTSP || oper == TOTALS) {
+					oper = TOTALS;
+					if (i == 'T')
+						by_host = 1;
+				} else
+					errflg = 1;
+				break;
+
 			case 'v':
 				if (oper == LISTSP || oper == ALL)
 					do_vnodes = 1;
@@ -1058,6 +1075,7 @@ main(int argc, char *argv[])
 		(oper == LISTSPNV && optind == argc) ||
 		(oper == LISTSP && optind == argc) ||
 		(oper == UPDATE_COMMENT && optind == argc) ||
+		(oper == TOTALS && (optind != argc || do_vnodes)) ||
 		(prt_summary && (oper != LISTSP && oper != LISTSPNV && oper != ALL))) {
 		if (!quiet)
 			fprintf(stderr,
@@ -1066,8 +1084,9 @@ main(int argc, char *argv[])
 				"\t%s [-s server] -v vnode vnode ...\n"
 				"\t%s -a[v][S[j][L]][-F format][-D delim][-s server]\n"
 				"\t%s -[H][S[j][L]][-F format][-D delim] host host ...\n"
+				"\t%s -{t|T}[-F format][-D delim][-s server]\n"
 				"\t%s --version\n\n",
-				argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+				argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
 		exit(1);
 	}
 
@@ -1094,9 +1113,12 @@ main(int argc, char *argv[])
 	/* if do_vnodes is set, get status of all virtual nodes (vnodes) */
 	/* else if oper is ALL then get status of all hosts              */
 
-	if ((do_vnodes == 1) || (oper == ALL) ||
+	if ((do_vnodes == 1) || (oper == ALL) || (oper == TOTALS) ||
 		(oper == DOWN)   || (oper == LISTMRK) || (oper == LISTSPNV)) {
-		if (do_vnodes || oper == LISTSPNV)
+		if (oper == TOTALS)
+			bstat_head = pbs_statvnode(con, "", NULL,
+				by_host ? EXTEND_OPT_NODE_SUMMARY_HOST : EXTEND_OPT_NODE_SUMMARY);
+		else if (do_vnodes || oper == LISTSPNV)
 			bstat_head = pbs_statvnode(con, "", NULL, NULL);
 		else
 			bstat_head = pbs_stathost(con, "", NULL, NULL);
@@ -1240,6 +1262,40 @@ main(int argc, char *argv[])
 
 			break;
 
+		case TOTALS:
+
+			/* a server which does not know the request sends every vnode */
+			for (pattr = bstat_head->attribs; pattr; pattr = pattr->next) {
+				if (strcmp(pattr->name, ATTR_NODE_summary_vnodes) == 0)
+					break;
+			}
+			if (pattr == NULL) {
+				if (!quiet)
+					fprintf(stderr, "%s: server does not support node totals\n", argv[0]);
+				exit(1);
+			}
+			for (bstat = bstat_head; bstat; bstat = bstat->next) {
+				/* the totals over all the vnodes come first, unnamed */
+				if (bstat->name[0] == '\0') {
+					free(bstat->name);
+					if ((bstat->name = strdup("total")) == NULL) {
+						fprintf(stderr, "pbsnodes: out of memory\n");
+						exit(1);
+					}
+				}
+				prt_node(bstat);
+			}
+			if (output_format == FORMAT_JSON) {
+				if (add_json_node(JSON_OBJECT_END, JSON_NULL, JSON_NOVALUE, NULL, NULL) == NULL) {
+					fprintf(stderr, "pbsnodes: out of memory\n");
+					return 1;
+				}
+				generate_json(stdout);
+				free_json_node_list();
+			}
+			pbs_statfree(bstat_head);
+			break;
+
 		case LISTMRK:
 
 			/* list any node that is marked DOWN or OFF_LINE	*/
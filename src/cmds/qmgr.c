@@ -1297,6 +1297,7 @@ blanks(int number)
  *
  * valid syntax: name[@server][,name]
  *		example: batch@svr1,debug
+ *		or, for nodes only, a selector @[attribute=value]
  *
  * @return int
  * @retval	0	If the syntax of the list is correct for all commands.
@@ -1310,6 +1311,16 @@ check_list(char *list, int type)
 
 	backptr = list;
 
+	/* a node selector "@[attr=value]" stands alone */
+	if ((type == MGR_OBJ_NODE) && (strncmp(list, "@[", 2) == 0)) {
+		foreptr = strchr(list, ']');
+		if ((foreptr == NULL) || (foreptr[1] != '\0'))
+			return (foreptr ? foreptr - list + 1 : strlen(list));
+		if ((backptr = strchr(list, '=')) == NULL || backptr == list + 2 || backptr > foreptr)
+			return (backptr ? backptr - list : 2);
+		return 0;
+	}
+
 	while (!EOL(*backptr)) {
 		foreptr = backptr;
 
@@ -2177,6 +2188,8 @@ execute(int aopt, int oper, int type, char *names, struct attropl *attribs)
 	struct objname *pname = NULL;	/* Pointer to current object name */
 	struct objname *sname = NULL;	/* Pointer to current server name */
 	struct objname *svrs;		/* servers to loop through */
+	struct objname *bulk = NULL;	/* several vnodes in one request */
+	int bulk_unknode = 0;
 	struct attrl *sa;		/* Argument needed for status routines */
 	/* Argument used to request queue names */
 	struct server *sp;		/* Pointer to server structure */
@@ -2190,7 +2203,14 @@ execute(int aopt, int oper, int type, char *names, struct attropl *attribs)
 	char 			content_encoding[HOOK_BUF_SIZE];
 	char 			content_type[HOOK_BUF_SIZE];
 	error = 0;
-	name = commalist2objname(names, type);
+	if ((type == MGR_OBJ_NODE) && (names != NULL) && (strncmp(names, "@[", 2) == 0)) {
+		if ((oper != MGR_CMD_SET) && (oper != MGR_CMD_UNSET)) {
+			pstderr("qmgr: a node selector may only be used with set and unset\n");
+			return 1;
+		}
+		name = node_selector2objname(names);
+	} else
+		name = commalist2objname(names, type);
 
 	if (oper == MGR_CMD_ACTIVE)
 		return set_active(type, name);
@@ -2222,6 +2242,12 @@ execute(int aopt, int oper, int type, char *names, struct attropl *attribs)
 	else
 		pname = name;
 
+	/* set or unset of several vnodes goes to the server as one request */
+	if ((type == MGR_OBJ_NODE) && ((oper == MGR_CMD_SET) || (oper == MGR_CMD_UNSET)) &&
+		((bulk = node_list_objname(name)) != NULL))
+		pname = bulk;
+
+again:
 	for (; pname != NULL; pname = pname->next) {
 		if (pname->svr_name != NULL)
 			svrs = temp_objname(NULL, pname->svr_name, pname->svr);
@@ -2497,6 +2523,16 @@ execute(int aopt, int oper, int type, char *names, struct attropl *attribs)
 			}
 
 			errmsg = pbs_geterrmsg(sp->s_connect);
+			if (perr && (pname == bulk) && (pbs_errno == PBSE_UNKNODE)) {
+				/*
+				 * One of the vnodes is unknown, in which case nothing was
+				 * changed, or the server takes only one vnode per request.
+				 * Either way, go through the vnodes one at a time.
+				 */
+				bulk_unknode = 1;
+				temp_objname(NULL, NULL, NULL);
+				continue;
+			}
 			if (perr) {
 				/*
 				 ** IF
@@ -2571,6 +2607,14 @@ execute(int aopt, int oper, int type, char *names, struct attropl *attribs)
 			temp_objname(NULL, NULL, NULL);		/* clears reference count */
 		}
 	}
+	if (bulk != NULL) {
+		free_objname(bulk);
+		bulk = NULL;
+		if (bulk_unknode) {
+			pname = name;
+			goto again;
+		}
+	}
 	if (name != NULL)
 		free_objname_list(name);
 	return error;
@@ -2700,6 +2744,81 @@ commalist2objname(char *names, int type)
 	return objs;
 }
 
+/**
+ * @brief
+ *	node_selector2objname - convert a node selector "@[attr=value]" into
+ *				an objname of "attr=value" for the active servers,
+ *				which set or unset every vnode the selector matches
+ *
+ * @param[in] names - the selector, already checked by check_list()
+ *
+ * @return  structure
+ * @retval  objname struct
+ *
+ */
+struct objname *
+node_selector2objname(char *names)
+{
+	struct objname *obj;
+	int len;
+
+	obj = new_objname();
+	obj->obj_type = MGR_OBJ_NODE;
+	len = strlen(names) - 3;	/* less the "@[" and "]" */
+	Mstring(obj->obj_name, len + 1);
+	pbs_strncpy(obj->obj_name, names + 2, len + 1);
+
+	return obj;
+}
+
+/**
+ * @brief
+ *	node_list_objname - join a list of vnode names into a single objname
+ *			    "n1,n2,...", so that a set or unset of all of them
+ *			    is one request to the server
+ *
+ * @par
+ *	Only done when there is a single active server and none of the
+ *	names is for a specific server, so that falling back to one request
+ *	per vnode does not repeat the operation anywhere.
+ *
+ * @param[in] names - the list of vnode names
+ *
+ * @return  structure
+ * @retval  objname struct
+ * @retval  NULL if the names should be sent one at a time
+ *
+ */
+struct objname *
+node_list_objname(struct objname *names)
+{
+	struct objname *obj;
+	struct objname *pn;
+	int len = 0;
+
+	if ((names == NULL) || (names->next == NULL) ||
+		(active_servers == NULL) || (active_servers->next != NULL))
+		return NULL;
+
+	for (pn = names; pn != NULL; pn = pn->next) {
+		if ((pn->svr_name != NULL) || (pn->obj_name == NULL) || (pn->obj_name[0] == '\0'))
+			return NULL;
+		len += strlen(pn->obj_name) + 1;
+	}
+
+	obj = new_objname();
+	obj->obj_type = MGR_OBJ_NODE;
+	Mstring(obj->obj_name, len);
+	obj->obj_name[0] = '\0';
+	for (pn = names; pn != NULL; pn = pn->next) {
+		if (pn != names)
+			strcat(obj->obj_name, ",");
+		strcat(obj->obj_name, pn->obj_name);
+	}
+
+	return obj;
+}
+
 /**
  * @brief
  *	get_request - get a qmgr request from the standard input
@@ -3633,6 +3752,11 @@ parse_request(char *request, char ***req)
 			foreptr++;
 
 		backptr = foreptr;
+		/* a node selector "@[attr=value]" is one word, operator and all */
+		if (foreptr[0] == '@' && foreptr[1] == '[') {
+			while (*foreptr != ']' && !EOL(*foreptr))
+				foreptr++;
+		}
 		while (!White(*foreptr) && !Oper(foreptr) && !EOL(*foreptr))
 			foreptr++;
 
@@ -1469,6 +1469,9 @@ display_statjob(struct batch_status *status, struct batch_status *prtheader, int
 						return 1;
 				if (add_json_node(JSON_OBJECT_END, JSON_NULL, JSON_NOVALUE, NULL, NULL) == NULL)
 					return 1;
+				/* write each job out as it is done rather than hold all of them */
+				if (flush_json(stdout))
+					return 1;
 			}
 		} else {
 			if (p->name != NULL) {
@@ -1622,6 +1625,43 @@ display_statjob(struct batch_status *status, struct batch_status *prtheader, int
 	return 0;
 }
 
+#ifndef NAS /* localmod 071 */
+/* display_statjob() arguments, passed on by display_statjob_part() */
+struct statjob_args {
+	struct batch_status *prtheader;
+	int full;
+	int how_opt;
+	int alt_opt;
+	int wide;
+	int failed;
+};
+
+/**
+ * @brief
+ *	display_statjob_part - consumer given to pbs_stat_stream() for full job
+ *	status, displays each part of the status reply as soon as it is read so
+ *	qstat holds one part at a time instead of every job.
+ *
+ * @param[in] part - part of the job status reply
+ * @param[in] arg - struct statjob_args
+ *
+ * @return int
+ * @retval 0 - keep going
+ * @retval 1 - display failed, drop the rest of the reply
+ */
+static int
+display_statjob_part(struct batch_status *part, void *arg)
+{
+	struct statjob_args *sa = arg;
+
+	if (display_statjob(part, sa->prtheader, sa->full, sa->how_opt, sa->alt_opt, sa->wide)) {
+		sa->failed = 1;
+		return 1;
+	}
+	return 0;
+}
+#endif /* localmod 071 */
+
 
 
 #define TYPEL   4
@@ -2004,6 +2044,9 @@ char		flags[] = "flags";
 char		ops[] = "operands";
 char		error[] = "error";
 
+/* a Tcl script wants the whole status list, see tcl_stat() */
+#define tcl_active()	(interp != NULL)
+
 #ifdef NAS /* localmod 071 */
 char	log_buffer[4096];
 extern	int	quiet;
@@ -2333,6 +2376,7 @@ tcl_run(int f_opt)
 #else
 #define tcl_init()
 #define tcl_addarg(name, arg)
+#define tcl_active()	0
 #ifdef NAS /* localmod 071 */
 #define	tcl_stat(type, bs, tcl_opt) 1
 #define tcl_run(tcl_opt)
@@ -2394,6 +2438,10 @@ main(int argc, char **argv, char **envp) /* qstat */
 	char *job_list = NULL;
 	size_t job_list_size = 0;
 	char *query_job_list = NULL;
+#ifndef NAS /* localmod 071 */
+	int stream_jobs = 0;
+	struct statjob_args sj_args;
+#endif /* localmod 071 */
 
 #if !defined(PBS_NO_POSIX_VIOLATION)
 #ifdef NAS /* localmod 071 */
@@ -2962,14 +3010,39 @@ job_no_args:
 					}
 				}
 
+#ifndef NAS /* localmod 071 */
+				/*
+				 * Full job status goes out part by part as the reply is
+				 * read, unless a Tcl script is given the whole list.
+				 */
+				stream_jobs = f_opt && !((alt_opt & ~ALT_DISPLAY_w) != 0 && !(wide && f_opt)) &&
+					!tcl_active();
+				if (stream_jobs) {
+					sj_args.prtheader = p_server;
+					sj_args.full = f_opt;
+					sj_args.how_opt = how_opt;
+					sj_args.alt_opt = alt_opt;
+					sj_args.wide = wide;
+					sj_args.failed = 0;
+					if (pbs_stat_stream(display_statjob_part, &sj_args) != 0)
+						stream_jobs = 0;
+				}
+#endif /* localmod 071 */
 				if ((stat_single_job == 1) || (new_atropl == 0)) {
 					if (E_opt == 1)
 						p_status = pbs_statjob(conn, query_job_list, display_attribs, extend);
 					else
 						p_status = pbs_statjob(conn, job_id_out, display_attribs, extend);
 				} else {
-					p_status = pbs_selstat(conn, new_atropl, NULL, extend);
+					p_status = pbs_selstat(conn, new_atropl, display_attribs, extend);
 				}
+#ifndef NAS /* localmod 071 */
+				if (stream_jobs) {
+					pbs_stat_stream(NULL, NULL);
+					if (sj_args.failed)
+						exit_qstat("out of memory");
+				}
+#endif /* localmod 071 */
 
 				if (added_queue) {
 					/* added queue name as first entry in atropl list,  */
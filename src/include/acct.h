@@ -50,6 +50,7 @@ extern "C" {
 
 #define PBS_ACCT_MAX_RCD 4095
 #define  PBS_ACCT_LEAVE_EXTRA 500
+#define PBS_ACCT_PEND_MAX (64 * 1024)	/* flush records held past this size */
 
 /* for JOB accounting */
 
@@ -86,6 +87,7 @@ extern "C" {
 
 extern int  acct_open(char *filename);
 extern void acct_close(void);
+extern void acct_flush(void);
 extern void account_record(int acctype, const job *pjob, char *text);
 extern void write_account_record(int acctype, const char *jobid, char *text);
 
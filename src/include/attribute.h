@@ -250,8 +250,9 @@ typedef struct ecl_attribute_def ecl_attribute_def;
 #define ATR_VFLAG_TARGET	0x20	/* target of indirect resource  */
 #define ATR_VFLAG_HOOK		0x40	/* value set by a hook script   */
 #define ATR_VFLAG_IN_EXECVNODE_FLAG	0x80	/* resource key value pair was found in execvnode */
+#define ATR_VFLAG_MODSEQ	0x100	/* modified since owner's modify_seq taken */
 
-#define ATR_MOD_MCACHE (ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE)
+#define ATR_MOD_MCACHE (ATR_VFLAG_MODIFY | ATR_VFLAG_MODCACHE | ATR_VFLAG_MODSEQ)
 #define ATR_SET_MOD_MCACHE (ATR_VFLAG_SET | ATR_MOD_MCACHE)
 #define ATR_UNSET(X) (X)->at_flags = (((X)->at_flags & ~ATR_VFLAG_SET) | ATR_MOD_MCACHE)
 
@@ -321,6 +322,9 @@ extern svrattrl *attrlist_alloc(int szname, int szresc, int szval);
 extern svrattrl *attrlist_create(char *aname, char *rname, int szval);
 extern void free_svrattrl(svrattrl *pal);
 extern void free_attrlist(pbs_list_head *attrhead);
+extern void attrlist_free(svrattrl *pal);
+extern void attrlist_arena_begin(void);
+extern void attrlist_arena_end(void);
 extern void free_svrcache(struct attribute *attr);
 extern int  attr_atomic_set(svrattrl *plist, attribute *old,
 	attribute *nattr, void *adef_idx, attribute_def *pdef, int limit,
@@ -339,6 +343,7 @@ extern int add_to_svrattrl_list(pbs_list_head *phead, char *name_str, char *resc
 	char *val_str, unsigned int flag, char *name_prefix);
 extern int add_to_svrattrl_list_sorted(pbs_list_head *phead, char *name_str, char *resc_str,
 	char *val_str, unsigned int flag, char *name_prefix);
+extern int sort_svrattrl_list(pbs_list_head *phead);
 extern unsigned int get_svrattrl_flag(char *name, char *resc, char *val,
 	pbs_list_head *svrattrl_list, int hook_set_flag);
 extern int compare_svrattrl_list(pbs_list_head *l1, pbs_list_head *l2);
@@ -554,6 +559,7 @@ extern int set_max_job_sequence_id(attribute *pattr, void *pobj, int actmode);
 extern int set_cred_renew_enable(attribute *pattr, void *pobject, int actmode);
 extern int set_cred_renew_period(attribute *pattr, void *pobject, int actmode);
 extern int set_cred_renew_cache_period(attribute *pattr, void *pobject, int actmode);
+extern int action_auth_session_lifetime(attribute *pattr, void *pobject, int actmode);
 
 
 /* Extern functions from sched_attr_def*/
@@ -597,8 +603,12 @@ extern int action_resc_resv(attribute *pattr, void *pobject, int actmode);
 /* Functions used to save and recover the attributes from the database */
 extern int encode_single_attr_db(struct attribute_def *padef, struct attribute *pattr, pbs_db_attr_list_t *db_attr_list);
 extern int encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr,  pbs_db_attr_list_t *db_attr_list, int all);
+extern int encode_attr_db_split(struct attribute_def *padef, struct attribute *pattr, int numattr, pbs_db_attr_list_t *db_attr_list, pbs_db_attr_list_t *db_hot_list, char *hot, int all);
 extern int decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list,
 	void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown);
+extern int encode_attr_blob(struct attribute_def *padef, struct attribute *pattr, int numattr, pbs_db_blob_t *blob, int all, int force);
+extern int decode_attr_blob(void *parent, char *data, int len,
+	void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown);
 
 extern int is_attr(int, char *, int);
 
@@ -607,6 +617,10 @@ extern int set_attr_resc(struct attrl **attrib, char *attrib_name, char *attrib_
 
 extern svrattrl *make_attr(char *attr_name, char *attr_resc, char *attr_value, int attr_flags);
 extern void *cr_attrdef_idx(struct attribute_def *adef, int limit);
+extern void *def_hash_create(int count);
+extern int def_hash_insert(void *idx, char *name, void *def);
+extern int def_hash_delete(void *idx, char *name);
+extern void *def_hash_find(void *idx, char *name);
 
 /* Attr setters */
 int set_attr_generic(attribute *pattr, attribute_def *pdef, char *value, char *rescn, enum batch_op op);
@@ -54,6 +54,15 @@ extern "C" {
 #define FOR_AUTH 0
 #define FOR_ENCRYPT 1
 
+/*
+ * Items of the extend string of an authentication request and of the
+ * text of its reply, separated by ','. See PBS_AUTH_SESSIONS.
+ */
+#define AUTH_EXT_SESSION "session"		/* C: resume session "=<token>", or ask for one */
+#define AUTH_EXT_SESSION_OK "session_ok"	/* S: session resumed, no handshake follows */
+#define AUTH_EXT_SESSION_NEW "session_new"	/* S: "=<token>" usable once this handshake succeeds */
+#define AUTH_SESSION_TOKEN_LEN 32		/* hex digits in a session token */
+
 enum AUTH_CTX_STATUS {
 	AUTH_STATUS_UNKNOWN = 0,
 	AUTH_STATUS_CTX_ESTABLISHING,
@@ -125,6 +134,7 @@ pbs_auth_config_t *make_auth_config(char *, char *, char *, char *, void *);
 void free_auth_config(pbs_auth_config_t *);
 
 extern int engage_client_auth(int, char *, int , char *, size_t);
+extern int get_auth_ext(char *, char *, char *, size_t);
 extern int engage_server_auth(int, char *, char *, int, char *, size_t);
 
 #ifdef __cplusplus
@@ -50,12 +50,37 @@ extern "C" {
 
 #define PBS_SIGNAMESZ 16
 #define MAX_JOBS_PER_REPLY 500
+#define MAX_NODES_PER_REPLY 500
+#define MAX_JOBS_PER_SUBMIT 10000
+
+/* rq_held - state of a request whose reply keeps the order of its connection */
+#define RQ_HELD_WAIT	1	/* still being served */
+#define RQ_HELD_READY	2	/* reply built, waits for the earlier ones */
 
 /* QueueJob */
 struct rq_queuejob {
 	char rq_destin[PBS_MAXSVRRESVID + 1];
 	char rq_jid[PBS_MAXSVRJOBID + 1];
 	pbs_list_head rq_attr; /* svrattrlist */
+	char *rq_script;	/* script sent with a SubmitJob or ExecJob request */
+	size_t rq_scriptsz;
+	int rq_credtype;	/* credential sent with an ExecJob request */
+	char *rq_cred;
+	size_t rq_credsz;
+};
+
+/* SubmitJobList - many jobs sharing a set of attributes */
+struct rq_submitjob {
+	pbs_list_head rq_attr; /* svrattrlist, overrides the shared ones */
+	char *rq_script;
+	size_t rq_scriptsz;
+};
+
+struct rq_submitjoblist {
+	char rq_destin[PBS_MAXSVRRESVID + 1];
+	pbs_list_head rq_attr; /* svrattrlist shared by all the jobs */
+	int rq_count;
+	struct rq_submitjob *rq_jobs;
 };
 
 /* JobCredential */
@@ -107,6 +132,21 @@ struct rq_manage {
 struct rq_deletejoblist {
 	int rq_count;
 	char **rq_jobslist;
+	int rq_next;	/* next job to delete when resumed, see req_deletejob() */
+};
+
+/* ModifyJobList_Async - one ModifyJob request per job */
+struct rq_modifyjoblist {
+	int rq_count;
+	struct rq_manage *rq_jobs;
+};
+
+/* RunSubjobs_Async - run many subjobs of one array, each on its own vnodes */
+struct rq_runsubjobs {
+	char rq_jid[PBS_MAXSVRJOBID + 1]; /* id of the parent array job */
+	int rq_count;
+	int *rq_indices;  /* subjob indices */
+	char **rq_destins; /* exec_vnode of each subjob */
 };
 
 /* Management - used by PBS_BATCH_Manager requests */
@@ -186,6 +226,12 @@ struct rq_selstat {
 	pbs_list_head rq_rtnattr;
 };
 
+/* ModifyJobsSel - alter the jobs matching a selection */
+struct rq_modifysel {
+	pbs_list_head rq_selattr; /* svrattrl selection, as for SelectJobs */
+	pbs_list_head rq_attr;	  /* svrattrl to alter on each job */
+};
+
 /* TrackJob */
 struct rq_track {
 	int rq_hopcount;
@@ -274,8 +320,12 @@ struct rq_register_sched {
  */
 struct batch_request {
 	pbs_list_link rq_link;			/* linkage of all requests */
+	pbs_list_link rq_readlink;		/* linkage of deferred read-only and delete requests */
+	pbs_list_link rq_heldlink;		/* linkage of the scheduler's in order replies */
+	int rq_held;				/* RQ_HELD_* if on rq_heldlink, else 0 */
 	struct batch_request *rq_parentbr;	/* parent request for job array request */
 	int rq_refct;				/* reference count - child requests */
+	struct batch_request *rq_collectbr;	/* request that collects the reply of this one */
 	int rq_type;				/* type of request */
 	int rq_perm;				/* access permissions for the user */
 	int rq_fromsvr;				/* true if request from another server */
@@ -290,12 +340,14 @@ struct batch_request {
 	int prot;				/* PROT_TCP or PROT_TPP */
 	int tpp_ack;				/* send acks for this tpp stream? */
 	char *tppcmd_msgid;			/* msg id for tpp commands */
+	unsigned int rq_tag;			/* tag to echo in the reply, 0 if untagged */
 	struct batch_reply rq_reply;		/* the reply area for this request */
 	union indep_request {
 		struct rq_register_sched rq_register_sched;
 		struct rq_auth rq_auth;
 		int rq_connect;
 		struct rq_queuejob rq_queuejob;
+		struct rq_submitjoblist rq_submitjoblist;
 		struct rq_jobcred rq_jobcred;
 		struct rq_jobfile rq_jobfile;
 		char rq_rdytocommit[PBS_MAXSVRJOBID + 1];
@@ -311,6 +363,8 @@ struct batch_request {
 		struct rq_relnodes rq_relnodes;
 		struct rq_py_spawn rq_py_spawn;
 		struct rq_manage rq_modify;
+		struct rq_modifyjoblist rq_modifyjoblist;
+		struct rq_runsubjobs rq_runsubjobs;
 		struct rq_move rq_move;
 		struct rq_register rq_register;
 		struct rq_manage rq_release;
@@ -318,6 +372,7 @@ struct batch_request {
 		struct rq_rescq rq_rescq;
 		struct rq_runjob rq_run;
 		struct rq_selstat rq_select;
+		struct rq_modifysel rq_modifysel;
 		int rq_shutdown;
 		struct rq_signal rq_signal;
 		struct rq_status rq_status;
@@ -341,12 +396,16 @@ extern void reply_badattr(int, int, svrattrl *, struct batch_request *);
 extern void reply_badattr_msg(int, int, svrattrl *, struct batch_request *, int);
 extern int reply_text(struct batch_request *, int, char *);
 extern int reply_send(struct batch_request *);
+extern int reply_write_tcp(int, struct batch_reply *);
 extern int reply_send_status_part(struct batch_request *);
 extern int reply_jobid(struct batch_request *, char *, int);
 extern int reply_jobid_msg(struct batch_request *, char *, int, int);
 extern void reply_free(struct batch_reply *);
+extern void release_brp_enc(struct brp_enc *);
 extern void dispatch_request(int, struct batch_request *);
 extern void free_br(struct batch_request *);
+extern int serve_deferred_reads(void);
+extern int serve_deferred_deletes(void);
 extern int isode_request_read(int, struct batch_request *);
 extern void req_stat_job(struct batch_request *);
 extern void req_stat_resv(struct batch_request *);
@@ -369,7 +428,11 @@ extern void req_register(struct batch_request *);
 extern void req_releasejob(struct batch_request *);
 extern void req_rescq(struct batch_request *);
 extern void req_runjob(struct batch_request *);
+extern void req_runsubjobs(struct batch_request *);
+extern void req_submitjoblist(struct batch_request *);
+extern void req_subscribe(struct batch_request *);
 extern void req_selectjobs(struct batch_request *);
+extern void req_modifyjobs_sel(struct batch_request *);
 extern void req_stat_que(struct batch_request *);
 extern void req_stat_svr(struct batch_request *);
 extern void req_stat_sched(struct batch_request *);
@@ -398,11 +461,15 @@ extern int decode_DIS_DelHookFile(int, struct batch_request *);
 extern int decode_DIS_JobObit(int, struct batch_request *);
 extern int decode_DIS_Manage(int, struct batch_request *);
 extern int decode_DIS_DelJobList(int, struct batch_request *);
+extern int decode_DIS_ModifyJobList(int, struct batch_request *);
 extern int decode_DIS_MoveJob(int, struct batch_request *);
 extern int decode_DIS_MessageJob(int, struct batch_request *);
 extern int decode_DIS_ModifyResv(int, struct batch_request *);
 extern int decode_DIS_PySpawn(int, struct batch_request *);
 extern int decode_DIS_QueueJob(int, struct batch_request *);
+extern int decode_DIS_SubmitJob(int, struct batch_request *);
+extern int decode_DIS_ExecJob(int, struct batch_request *);
+extern int decode_DIS_SubmitJobList(int, struct batch_request *);
 extern int decode_DIS_Register(int, struct batch_request *);
 extern int decode_DIS_RelnodesJob(int, struct batch_request *);
 extern int decode_DIS_ReqExtend(int, struct batch_request *);
@@ -410,6 +477,7 @@ extern int decode_DIS_ReqHdr(int, struct batch_request *, int *, int *);
 extern int decode_DIS_Rescl(int, struct batch_request *);
 extern int decode_DIS_Rescq(int, struct batch_request *);
 extern int decode_DIS_Run(int, struct batch_request *);
+extern int decode_DIS_RunSubjobs(int, struct batch_request *);
 extern int decode_DIS_ShutDown(int, struct batch_request *);
 extern int decode_DIS_SignalJob(int, struct batch_request *);
 extern int decode_DIS_Status(int, struct batch_request *);
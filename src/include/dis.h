@@ -204,6 +204,8 @@ extern const char *dis_emsg[];
 extern void DIS_tcp_funcs();
 
 #define PBS_DIS_BUFSZ 8192
+/* write buffer size at which a complete packet is sent rather than grown */
+#define PBS_DIS_SEGSZ (8 * PBS_DIS_BUFSZ)
 
 #define DIS_WRITE_BUF 0
 #define DIS_READ_BUF 1
@@ -213,6 +215,7 @@ typedef struct pbs_dis_buf {
 	size_t tdis_len;
 	char *tdis_pos;
 	char *tdis_data;
+	int tdis_hold; /* no early send while > 0, see dis_hold_buf() */
 } pbs_dis_buf_t;
 
 typedef struct pbs_tcp_auth_data {
@@ -225,6 +228,7 @@ typedef struct pbs_tcp_chan {
 	pbs_dis_buf_t readbuf;
 	pbs_dis_buf_t writebuf;
 	int is_old_client; /* This is just for backward compatibility */
+	int is_binary; /* integers are sent as varints, see dis_put_binint() */
 	pbs_tcp_auth_data_t auths[2];
 } pbs_tcp_chan_t;
 
@@ -234,9 +238,22 @@ int disr_skip(int, size_t);
 int dis_getc(int);
 int dis_gets(int, char *, size_t);
 int dis_puts(int, const char *, size_t);
+char *dis_get_pending(int, size_t *);
+void dis_hold_buf(int, int);
 int dis_flush(int);
 void dis_setup_chan(int, pbs_tcp_chan_t * (*)(int));
 void dis_destroy_chan(int);
+int dis_is_binary(int);
+void dis_set_binary(int, int);
+int dis_put_binint(int, int, u_Long);
+int dis_get_binint(int, int *, u_Long *);
+
+/* returned by dis_put_binint()/dis_get_binint() on a text encoded stream */
+#define DIS_NOT_BINARY -1
+/* extend string used to negotiate the binary encoding at authentication */
+#define DIS_BINARY_EXTEND "dis_binary"
+/* longest varint, a 64 bit magnitude in 6 + 9 * 7 bits */
+#define DIS_BINARY_MAXLEN 10
 
 void transport_chan_set_ctx_status(int, int, int);
 int transport_chan_get_ctx_status(int, int);
@@ -251,9 +268,11 @@ extern pbs_tcp_chan_t * (*pfn_transport_get_chan)(int);
 extern int (*pfn_transport_set_chan)(int, pbs_tcp_chan_t *);
 extern int (*pfn_transport_recv)(int, void *, int);
 extern int (*pfn_transport_send)(int, void *, int);
+extern int (*pfn_transport_sendv)(int, void *, int, void *, int);
 
 #define transport_recv(x, y, z) (*pfn_transport_recv)(x, y, z)
 #define transport_send(x, y, z) (*pfn_transport_send)(x, y, z)
+#define transport_sendv(x, h, hl, d, dl) (*pfn_transport_sendv)(x, h, hl, d, dl)
 #define transport_get_chan(x) (*pfn_transport_get_chan)(x)
 #define transport_set_chan(x, y) (*pfn_transport_set_chan)(x, y)
 
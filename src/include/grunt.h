@@ -65,6 +65,27 @@ extern int parse_node_resc_r(char *str, char **nodep, int *pnelem, int *nlkv, st
 extern char *parse_plus_spec(char *selstr, int *rc);
 extern char *parse_plus_spec_r(char *selstr, char **last, int *hp);
 extern int parse_resc_equal_string(char *start, char **name, char **value, char **last);
+
+/* one chunk of a parsed select specification */
+typedef struct sel_chunk {
+	char *sc_str;			/* the chunk, as parse_chunk() leaves it */
+	int sc_rc;			/* what parse_chunk() returned for it */
+	int sc_nchk;			/* number of chunks asked for */
+	int sc_dflt;			/* sc_nchk was set to 1 by default */
+	int sc_nelem;			/* number of entries in sc_kv */
+	struct key_value_pair *sc_kv;
+} sel_chunk;
+
+/* a select specification broken into chunks, see get_parsed_select() */
+typedef struct parsed_select {
+	char *ps_select;		/* the select specification */
+	char *ps_buf;			/* copy of it the chunks point into */
+	int ps_rc;			/* error from walking the '+' list */
+	int ps_nchunks;
+	sel_chunk *ps_chunks;
+} parsed_select;
+
+extern parsed_select *get_parsed_select(char *selstr);
 #ifdef	__cplusplus
 }
 #endif
@@ -80,6 +80,12 @@ typedef enum hook_user hook_user;
 #define HOOK_FAIL_ACTION_CLEAR_VNODES			0x04
 #define HOOK_FAIL_ACTION_SCHEDULER_RESTART_CYCLE	0x08
 
+/* jobs handed to an exechost_periodic hook; none set means all jobs */
+#define HOOK_JOB_FILTER_ALL		0x00
+#define HOOK_JOB_FILTER_STARTED		0x01
+#define HOOK_JOB_FILTER_ENDED		0x02
+#define HOOK_JOB_FILTER_RESC_USED	0x04
+
 /* server hooks */
 
 #define HOOK_EVENT_QUEUEJOB 	0x01
@@ -112,6 +118,27 @@ typedef enum hook_user hook_user;
 #define MOM_EVENTS	(HOOK_EVENT_EXECJOB_BEGIN|HOOK_EVENT_EXECJOB_PROLOGUE|HOOK_EVENT_EXECJOB_EPILOGUE|HOOK_EVENT_EXECJOB_END|HOOK_EVENT_EXECJOB_PRETERM|HOOK_EVENT_EXECHOST_PERIODIC|HOOK_EVENT_EXECJOB_LAUNCH|HOOK_EVENT_EXECHOST_STARTUP|HOOK_EVENT_EXECJOB_ATTACH|HOOK_EVENT_EXECJOB_RESIZE|HOOK_EVENT_EXECJOB_ABORT|HOOK_EVENT_EXECJOB_POSTSUSPEND|HOOK_EVENT_EXECJOB_PRERESUME)
 #define USER_MOM_EVENTS	(HOOK_EVENT_EXECJOB_PROLOGUE|HOOK_EVENT_EXECJOB_EPILOGUE|HOOK_EVENT_EXECJOB_PRETERM)
 #define FAIL_ACTION_EVENTS (HOOK_EVENT_EXECJOB_BEGIN|HOOK_EVENT_EXECHOST_STARTUP|HOOK_EVENT_EXECJOB_PROLOGUE)
+/*
+ * Run statistics of a hook for one event type. Run times are counted
+ * in HOOK_STAT_BUCKETS buckets of doubling width, the first one holding
+ * runs under 1 millisecond, for estimating percentiles.
+ */
+#define	HOOK_STAT_BUCKETS	24
+#define	HOOK_STAT_EVENTS	32	/* one per HOOK_EVENT_* bit */
+
+struct hook_run_stats {
+	unsigned long	hs_runs;	/* times the hook ran */
+	unsigned long	hs_rejects;	/* runs that rejected the event */
+	unsigned long	hs_alarms;	/* runs stopped by the alarm */
+	double		hs_walltime;	/* total run time in seconds */
+	unsigned long	hs_hist[HOOK_STAT_BUCKETS];
+};
+
+/* outcome of a hook run, for hook_stats_record() */
+#define	HOOK_RUN_ACCEPT	0
+#define	HOOK_RUN_REJECT	1
+#define	HOOK_RUN_ALARM	2
+
 struct hook {
 	char 		*hook_name;	/* unique name of the hook */
 	hook_type	type;		/* site-defined or pbs builtin */
@@ -127,6 +154,8 @@ struct hook {
 	void		*script;	/* actual script content in some fmt */
 
 	int		freq;		/* # of seconds in between calls */
+	unsigned int	job_filter;	/* HOOK_JOB_FILTER_* for exechost_periodic */
+	unsigned long	job_seq;	/* job change pass seen by the last run */
 	/* install hook */
 	int		pending_delete; /* set to 1 if a mom hook and pending */
 	unsigned long	hook_control_checksum;	/* checksum for .HK file */
@@ -158,6 +187,7 @@ struct hook {
 	pbs_list_link	hi_execjob_postsuspend_hooks;
 	pbs_list_link	hi_execjob_preresume_hooks;
 	struct work_task *ptask;		    /* work task pointer, used in periodic hooks */
+	struct hook_run_stats *run_stats;	    /* HOOK_STAT_EVENTS entries, NULL if never run */
 };
 
 typedef struct hook hook;
@@ -195,6 +225,7 @@ typedef struct hook hook;
 #define	HOOK_ORDER_DEFAULT	1
 #define	HOOK_ALARM_DEFAULT	30
 #define	HOOK_FREQ_DEFAULT	120
+#define	HOOK_JOB_FILTER_DEFAULT	HOOK_JOB_FILTER_ALL
 #define	HOOK_PENDING_DELETE_DEFAULT 0
 
 /* Various attribute names in string format */
@@ -208,7 +239,9 @@ typedef struct hook hook;
 #define	HOOKATT_ALARM		"alarm"
 #define	HOOKATT_FREQ		"freq"
 #define	HOOKATT_FAIL_ACTION	"fail_action"
+#define	HOOKATT_JOB_FILTER	"job_list_filter"
 #define	HOOKATT_PENDING_DELETE  "pending_delete"
+#define	HOOKATT_RUN_STATS	"run_stats"	/* read-only, only when asked for */
 
 #define	HOOK_PBS_PREFIX		"PBS"  /* valid Hook name prefix for PBS hook */
 
@@ -228,6 +261,12 @@ typedef struct hook hook;
 #define	HOOKSTR_FAIL_ACTION_CLEAR_VNODES	"clear_vnodes_upon_recovery"
 #define	HOOKSTR_FAIL_ACTION_SCHEDULER_RESTART_CYCLE "scheduler_restart_cycle"
 
+/*  Valid Hook job_list_filter values */
+#define	HOOKSTR_JOB_FILTER_ALL		"all"
+#define	HOOKSTR_JOB_FILTER_STARTED	"started"
+#define	HOOKSTR_JOB_FILTER_ENDED	"ended"
+#define	HOOKSTR_JOB_FILTER_RESC_USED	"resources_used"
+
 /* Valid hook enabled or debug values */
 #define	HOOKSTR_TRUE		"true"
 #define	HOOKSTR_FALSE		"false"
@@ -301,6 +340,7 @@ typedef struct hook hook;
 #define	FMT_HOOK_RESCDEF "%s" FMT_HOOK_PREFIX "resourcedef%d"
 #define	FMT_HOOK_RESCDEF_COPY "%s" FMT_HOOK_PREFIX "resourcedef.%s"
 #define	FMT_HOOK_LOG "%s" FMT_HOOK_PREFIX "log%d"
+#define	FMT_HOOK_CODE_CACHE "%s" FMT_HOOK_PREFIX "%s.pyc"
 
 /* Special log levels  - values must not intersect PBS_EVENT* values in log.h */
 
@@ -340,6 +380,8 @@ extern int
 set_hook_alarm(hook *, char *, char *, size_t);
 extern int
 set_hook_freq(hook *, char *, char *, size_t);
+extern int
+set_hook_job_filter(hook *, char *, char *, size_t);
 
 extern int
 unset_hook_enabled(hook *, char *, size_t);
@@ -359,6 +401,8 @@ extern int
 unset_hook_alarm(hook *, char *, size_t);
 extern int
 unset_hook_freq(hook *, char *, size_t);
+extern int
+unset_hook_job_filter(hook *, char *, size_t);
 extern hook *hook_alloc(void);
 extern void hook_free(hook *, void (*)(struct python_script *));
 extern void hook_purge(hook *, void (*)(struct python_script *));
@@ -384,7 +428,10 @@ extern char *hook_freq_as_string(int);
 extern char *hook_order_as_string(short);
 extern char *hook_user_as_string(hook_user);
 extern char *hook_fail_action_as_string(unsigned int);
+extern char *hook_job_filter_as_string(unsigned int);
 extern int num_eligible_hooks(unsigned int);
+extern void hook_stats_record(hook *, unsigned int, double, int);
+extern char *hook_stats_as_string(hook *);
 
 #ifdef	_WORK_TASK_H
 extern void cleanup_hooks_workdir(struct work_task *);
@@ -98,6 +98,7 @@ extern mom_hook_action_t *find_mom_hook_action(mom_hook_action_t **,
 extern void add_pending_mom_hook_action(void *minfo, char *, unsigned int);
 
 extern void delete_pending_mom_hook_action(void *minfo, char *, unsigned int);
+extern void drop_synced_mom_hook_action(void *minfo, char *, unsigned int);
 
 extern void add_pending_mom_allhooks_action(void *minfo, unsigned int);
 
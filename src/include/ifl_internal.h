@@ -52,10 +52,30 @@ int __pbs_asyrunjob(int, char *, char *, char *);
 
 int __pbs_asyrunjob_ack(int c, char *jobid, char *location, char *extend);
 
+int __pbs_asyrunjob_pipe(int, char *, char *, char *);
+
+int __pbs_runjob_pipe(int, char *, char *, char *);
+
+struct batch_runjob_status *__pbs_asyrunjob_replies(int);
+
+int __pbs_asyrunsubjobs(int, char *, int, int *, char **, char *);
+
 int __pbs_alterjob(int, char *, struct attrl *, char *);
 
 int __pbs_asyalterjob(int, char *, struct attrl *, char *);
 
+int __pbs_asyalterjobs(int, struct batch_status *, char *);
+
+struct batch_deljob_status *__pbs_alterjob_sel(int, struct attropl *, struct attrl *, char *);
+
+unsigned int __pbs_async_statjob(int, char *, struct attrl *, char *);
+
+unsigned int __pbs_async_alterjob(int, char *, struct attrl *, char *);
+
+unsigned int __pbs_async_selstat(int, struct attropl *, struct attrl *, char *);
+
+struct batch_async_status *__pbs_async_wait(int, int, pbs_async_cb, void *);
+
 int __pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 int __pbs_connect(char *);
@@ -100,6 +120,12 @@ void __pbs_statfree(struct batch_status *);
 
 void __pbs_delstatfree(struct batch_deljob_status *);
 
+void __pbs_runjobstatfree(struct batch_runjob_status *);
+
+void __pbs_asyncstatfree(struct batch_async_status *);
+
+int __pbs_stat_stream(pbs_stat_cb, void *);
+
 struct batch_status *__pbs_statrsc(int, char *, struct attrl *, char *);
 
 struct batch_status *__pbs_statjob(int, char *, struct attrl *, char *);
@@ -108,6 +134,8 @@ struct batch_status *__pbs_selstat(int, struct attropl *, struct attrl *, char *
 
 struct batch_status *__pbs_statque(int, char *, struct attrl *, char *);
 
+struct batch_status *__pbs_statsnap(int, char *, struct attrl *);
+
 struct batch_status *__pbs_statserver(int, struct attrl *, char *);
 
 struct batch_status *__pbs_statsched(int, struct attrl *, char *);
@@ -122,10 +150,16 @@ struct batch_status *__pbs_statresv(int, char *, struct attrl *, char *);
 
 struct batch_status *__pbs_stathook(int, char *, struct attrl *, char *);
 
+int __pbs_subscribe(int, char *, struct attrl *, char *);
+
+struct batch_status *__pbs_get_events(int, int);
+
 struct ecl_attribute_errors * __pbs_get_attributes_in_error(int);
 
 char *__pbs_submit(int, struct attropl *, char *, char *, char *);
 
+struct batch_deljob_status *__pbs_submit_many(int, struct attropl *, int, struct attropl **, char **, char *, char *);
+
 char *__pbs_submit_resv(int, struct attropl *, char *);
 
 int __pbs_delresv(int, char *, char *);
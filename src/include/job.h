@@ -91,7 +91,9 @@ struct depend {
 	short	  dp_numreg;	/* num jobs registered (syncct only)     */
 	short	  dp_released;	/* This job released to run (syncwith)   */
 	short	  dp_numrun;    /* num jobs supposed to run		 */
+	short	  dp_noix;	/* dp_jobs not to be indexed (duplicates) */
 	pbs_list_head dp_jobs;	/* list of related jobs  (all)           */
+	void	 *dp_jobs_ix;	/* dp_jobs by job id, see find_dependjob() */
 };
 
 /*
@@ -101,6 +103,7 @@ struct depend {
 
 struct depend_job {
 	pbs_list_link dc_link;
+	struct depend *dc_depend; /* dependency set holding this job	 */
 	short	dc_state;	/* released / ready to run (syncct)	 */
 	long	dc_cost;	/* cost of this child (syncct)		 */
 	char	dc_child[PBS_MAXSVRJOBID+1]; /* child (dependent) job	 */
@@ -328,6 +331,14 @@ typedef struct	noderes {
 #define	MOM_SISTER_ERR		0x0004	/* a sisterhood operation failed */
 #define	MOM_NO_PROC		0x0008	/* no procs found for job */
 #define	MOM_RESTART_ACTIVE	0x0010	/* restart in progress */
+#define	MOM_TASK_EXITED		0x0020	/* a task session leader exited */
+
+/* bits of ji_limflags (mom only), 0 until the limits have been cached */
+
+#define	JOB_LIMIT_CACHED	0x0001	/* ji_*_limit reflect Resource_List */
+#define	JOB_LIMIT_CPUT		0x0002	/* ji_cput_limit is set */
+#define	JOB_LIMIT_WALLTIME	0x0004	/* ji_wall_limit is set */
+#define	JOB_LIMIT_MPP		0x0008	/* mppe or mppssp requested */
 
 
 #define PBS_MAX_POLL_DOWNTIME 300 /* 5 minutes by default */
@@ -337,16 +348,22 @@ typedef struct	noderes {
  * specific structures for Job Array attributes
  */
 
-/* individual entries in array job index table */
+/*
+ * individual entries in array job index table
+ * kept to a few bytes as arrays may hold millions of subjobs, the pointer
+ * to an instantiated subjob lives in the sparse tkm_subjobs index instead
+ */
 struct ajtrk {
-	char trk_status;		 /* status */
-	int trk_error;		 /* error code */
-	int trk_exitstat;	 /* if executed and exitstat set */
-	int trk_substate;	 /* sub state */
-	int trk_stgout;		 /* stageout status */
-	struct job *trk_psubjob; /* pointer to instantiated subjob */
+	char trk_status;	    /* status */
+	unsigned char trk_substate; /* sub state */
+	signed char trk_stgout;	    /* stageout status, -1 if not set */
+	unsigned char trk_flags;    /* TRKFLG_* below */
 };
 
+#define TRKFLG_EXITSTAT 0x01 /* if executed and exitstat set */
+#define TRKFLG_ERR_POS 0x02  /* subjob exited with a positive status */
+#define TRKFLG_ERR_NEG 0x04  /* subjob exited with a negative status */
+
 /* subjob index table */
 struct ajtrkhd {
 	size_t tkm_size;		  /* size of whole table */
@@ -358,6 +375,8 @@ struct ajtrkhd {
 	int tkm_subjsct[PBS_NUMJOBSTATE]; /* count of subjobs in various states */
 	int tkm_dsubjsct;		  /* count of deleted subjobs */
 	range *trk_rlist;			/* pointer to range list */
+	void *tkm_subjobs;		  /* index of instantiated subjobs by table offset */
+	pbs_list_head *tkm_tmpl;	  /* parent attributes encoded for new subjobs, see subjob_tmpl_begin() */
 	struct ajtrk tkm_tbl[1];	  /* ptr to array of individual entries */
 	/*
 	 * when table is malloced, room for the additional required number
@@ -469,9 +488,19 @@ struct job {
 	int ji_parent2child_job_update_status_pipe; /* write pipe for parent mom to send job update status to child starter process */
 	int ji_parent2child_moms_status_pipe;	    /* write pipe for parent mom to send sister moms status to child starter process */
 	int ji_updated;				    /* set to 1 if job's node assignment was updated */
+	pbs_list_head ji_ruu_sent;		    /* resources_used values last sent to the server */
+	int ji_joinscan;			    /* hosts before this one have no events left, MS only */
+	int ji_ruu_gen;				    /* ruu_sent_gen when ji_ruu_sent was last refreshed */
+	u_long ji_ruu_cput;			    /* total cput of the last poll update */
+	u_long ji_ruu_mem;			    /* total mem (kb) of the last poll update */
+	time_t ji_ruu_time;			    /* time of the last poll update */
 	time_t ji_walltime_stamp;		    /* time stamp for accumulating walltime */
 	struct work_task *ji_bg_hook_task;
 	struct work_task *ji_report_task;
+	struct work_task *ji_walltime_task;	    /* fires when walltime runs out, MS only */
+	int ji_limflags;			    /* JOB_LIMIT_* bits */
+	u_long ji_cput_limit;			    /* cached Resource_List.cput */
+	u_long ji_wall_limit;			    /* cached Resource_List.walltime */
 #ifdef WIN32
 	HANDLE		ji_momsubt;	/* process HANDLE to mom subtask */
 #else	/* not WIN32 */
@@ -507,6 +536,10 @@ struct job {
 	enum bg_hook_request ji_hook_running_bg_on; /* set when hook starts in the background*/
 	int		ji_msconnected; /* 0 - not connected, 1 - connected */
 	pbs_list_head	ji_multinodejobs;	/* links to recovered multinode jobs */
+	unsigned long	ji_hook_start_seq;	/* exechost_periodic change pass that */
+	unsigned long	ji_hook_end_seq;	/* saw the job start, end, and its */
+	unsigned long	ji_hook_used_seq;	/* resources_used change; 0 - none */
+	unsigned long	ji_hook_used_sum;	/* checksum of resources_used then */
 #else						    /* END Mom ONLY -  start Server ONLY */
 	struct batch_request *ji_pmt_preq; /* outstanding preempt job request for deleting jobs */
 	int ji_discarding;		   /* discarding job */
@@ -517,6 +550,7 @@ struct job {
 
 	int ji_lastdest;	     /* last destin tried by route */
 	int ji_retryok;		     /* ok to retry, some reject was temp */
+	long ji_routegen;	     /* routing generation it was last turned away at, see route_changed() */
 	int ji_terminated;	     /* job terminated by deljob batch req */
 	int ji_deletehistory;	     /* job history should not be saved */
 	pbs_list_head ji_rejectdest; /* list of rejected destinations */
@@ -546,6 +580,31 @@ struct job {
 	struct preempt_ordering *preempt_order;
 	int preempt_order_index;
 	struct work_task *ji_prov_startjob_task;
+	int ji_prov_pending;	/* vnodes of the job still provisioning */
+
+	/* link in the list of jobs with a deferred database save */
+	pbs_list_link ji_pendsave;
+	pbs_list_link ji_ownerjobs;	/* link in the owner's jobs, see find_owner_jobs() */
+	pbs_list_link ji_histjobs;	/* link in the history jobs, see svr_clean_job_history() */
+	int ji_attrblob;	/* attributes are saved as a binary blob */
+	int ji_histcompact;	/* finished job holds only part of its attributes, see histjob_compact() */
+	int ji_dbhist;		/* job was moved to the database history tables, see job_save_db_now() */
+	struct job_alloc *ji_alloc;	/* parsed exec_vnode, see job_alloc_get() */
+
+	/* encoded full status, [0] for users and [1] for operators/managers */
+	struct brp_enc *ji_stat_enc[2];
+	int ji_stat_key[2];	/* privilege and settings it was encoded for */
+	int ji_stat_cnt[2];	/* cached attribute encodings at that time */
+	u_Long ji_modseq;	/* modify_seq of the last change seen by a stat */
+	int ji_counted;		/* job is in svr_alljobs and the server's job counts */
+	int ji_ctstate;		/* state number the job is counted under in the state counts, -1 if none */
+
+	/* node release updates to the primary mom, see send_job_exec_update_to_mom() */
+	int ji_exec_update_out;		/* an exec_vnode update is out to the primary mom */
+	int ji_exec_update_again;	/* exec_vnode changed again while it was out */
+	struct batch_request **ji_exec_update_reqs; /* release requests waiting on updates */
+	int ji_exec_update_nreqs;	/* number of them */
+	int ji_exec_update_nout;	/* the first ones, answered by the update that is out */
 
 #endif /* END SERVER ONLY */
 
@@ -1029,8 +1088,15 @@ extern int   site_check_user_map(void *, int, char *);
 extern int   site_allow_u(char *user, char *host);
 extern void  svr_dequejob(job *);
 extern int   svr_enquejob(job *);
+extern job  *find_owner_jobs(char *);
+extern void  owner_unlink_job(job *);
+extern void  histjob_unlink(job *);
+extern void  histjob_compact(job *);
+extern int   histjob_expand(job *);
+extern int   histjob_attr_dropped(int);
 extern void  svr_evaljobstate(job *, char *, int *, int);
 extern int   svr_setjobstate(job *, char, int);
+extern void  svr_chgjobstate(job *, char);
 extern int   state_char2int(char);
 extern char	 state_int2char(int);
 extern int   uniq_nameANDfile(char*, char*, char*);
@@ -1085,6 +1151,12 @@ extern int job_save_fs(job *);
 
 extern job *job_recov_db(char *, job *pjob);
 extern int job_save_db(job *);
+extern void job_save_db_flush(void);
+extern void job_save_db_send(void);
+extern void job_save_db_sync(job *);
+extern void job_save_db_cancel(job *);
+extern void job_delete_db(job *);
+extern void job_hist_expire_db(time_t);
 
 #define job_save  job_save_db
 #define job_recov job_recov_db
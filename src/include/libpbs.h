@@ -62,6 +62,7 @@ extern "C" {
 
 #define PBS_BATCH_PROT_TYPE 2
 #define PBS_BATCH_PROT_VER  1
+#define PBS_BATCH_PROT_VER_TAGGED 2 /* header carries a tag echoed in the reply */
 #define SCRIPT_CHUNK_Z (65536)
 #ifndef TRUE
 #define TRUE  1
@@ -121,8 +122,26 @@ typedef struct pbs_conn {
 	char *ch_errtxt;	  /* pointer to last server error text	*/
 	pthread_mutex_t ch_mutex; /* serialize connection between threads */
 	pbs_tcp_chan_t *ch_chan;  /* pointer tcp chan structure for this connection */
+	struct batch_runjob_status *ch_rj_sent;	  /* pipelined run job requests awaiting a reply */
+	struct batch_runjob_status *ch_rj_sent_tail; /* last request in ch_rj_sent */
+	struct batch_runjob_status *ch_rj_failed; /* pipelined run job requests the server rejected */
+	struct pbs_async_req *ch_async_sent;	  /* tagged requests awaiting their last reply */
+	struct pbs_async_req *ch_async_sent_tail; /* last request in ch_async_sent */
+	struct batch_async_status *ch_async_done; /* tagged requests fully replied to */
+	unsigned int ch_async_tag;		  /* last tag handed out on this connection */
+	int ch_submitjob;			  /* server takes PBS_BATCH_SubmitJob */
 } pbs_conn_t;
 
+/*
+ * a tagged request sent with one of the pbs_async_*() calls,
+ * status parts are merged into ar_stat until the last one arrives
+ */
+struct pbs_async_req {
+	struct pbs_async_req *ar_next;
+	struct batch_async_status *ar_stat;	/* what is handed back to the caller */
+	struct batch_status *ar_last;		/* last object in ar_stat->status */
+};
+
 int destroy_connection(int);
 int set_conn_errtxt(int, const char *);
 char * get_conn_errtxt(int);
@@ -131,6 +150,16 @@ int get_conn_errno(int);
 pbs_tcp_chan_t * get_conn_chan(int);
 int set_conn_chan(int, pbs_tcp_chan_t *);
 pthread_mutex_t * get_conn_mutex(int);
+int add_conn_runjob(int, struct batch_runjob_status *);
+struct batch_runjob_status * get_conn_runjob(int);
+int add_conn_runjob_failure(int, struct batch_runjob_status *);
+struct batch_runjob_status * get_conn_runjob_failures(int);
+unsigned int add_conn_async(int, struct pbs_async_req *);
+struct pbs_async_req * get_conn_async(int, unsigned int, int);
+int add_conn_async_done(int, struct batch_async_status *);
+struct batch_async_status * get_conn_async_done(int);
+int set_conn_submitjob(int, int);
+int get_conn_submitjob(int);
 
 #define SVR_CONN_STATE_DOWN 0
 #define SVR_CONN_STATE_UP 1
@@ -163,12 +192,20 @@ struct brp_select {
 	char brp_jobid[PBS_MAXSVRJOBID + 1];
 };
 
+/* DIS encoded attribute list of a status object, shared between replies */
+struct brp_enc {
+	int be_refct;	/* number of holders (object and replies) */
+	size_t be_len;	/* length of be_data */
+	char *be_data;	/* NULL until the first reply is encoded */
+};
+
 /* reply to Status Job/Queue/Server Request */
 struct brp_status {
 	pbs_list_link brp_stlink;
 	int brp_objtype;
 	char brp_objname[(PBS_MAXSVRJOBID > PBS_MAXDEST ? PBS_MAXSVRJOBID : PBS_MAXDEST) + 1];
 	pbs_list_head brp_attr; /* head of svrattrlist */
+	struct brp_enc *brp_enc; /* if set, sent in place of brp_attr */
 };
 
 /* reply to Resource Query Request */
@@ -208,6 +245,7 @@ struct batch_reply
 	int brp_auxcode;
 	int brp_choice; /* the union discriminator */
 	int brp_is_part;
+	unsigned int brp_tag; /* tag of the request replied to, 0 if untagged */
 	int brp_count;
 	struct batch_status *last;
 	union {
@@ -306,6 +344,13 @@ struct batch_reply
 #define PBS_BATCH_RegisterSched	98
 #define PBS_BATCH_ModifyVnode       99
 #define PBS_BATCH_DeleteJobList	100
+#define PBS_BATCH_ModifyJobList_Async	101
+#define PBS_BATCH_RunSubjobs_Async	102
+#define PBS_BATCH_SubmitJob		103
+#define PBS_BATCH_SubmitJobList	104
+#define PBS_BATCH_Subscribe	105
+#define PBS_BATCH_ExecJob	106
+#define PBS_BATCH_ModifyJobsSel	107
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -329,6 +374,7 @@ struct batch_reply
 #define FAILOVER_SecdTakeOver	5 /* Primary down, secondary take over */
 
 #define EXTEND_OPT_IMPLICIT_COMMIT ":C:" /* option added to pbs_submit() extend parameter to request implicit commit */
+#define CONNECT_REPLY_SUBMITJOB "submit_job" /* Connect reply text of a server that takes PBS_BATCH_SubmitJob */
 
 int is_compose(int, int);
 int is_compose_cmd(int, int, char **);
@@ -345,6 +391,7 @@ int PBSD_mgr_put(int, int, int, int, char *, struct attropl *, char *, int, char
 int PBSD_deljoblist_put(int, int, char **, int, char *, int, char **);
 int PBSD_manager(int, int, int, int, char *, struct attropl *, char *);
 struct batch_deljob_status *PBSD_deljoblist(int, int, char **, int, char *);
+struct batch_deljob_status *PBSD_submitjoblist(int, char *, struct attropl *, int, struct attropl **, char **, size_t *, char *);
 int PBSD_msg_put(int, char *, int, char *, char *, int, char **);
 int PBSD_relnodes_put(int, char *, char *, char *, int, char **);
 int PBSD_py_spawn_put(int, char *, char **, char **, int, char **);
@@ -355,6 +402,12 @@ int PBSD_status_put(int, int, char *, struct attrl *, char *, int, char **);
 int PBSD_select_put(int, int, struct attropl *, struct attrl *, char *);
 struct batch_reply *PBSD_rdrpy(int);
 struct batch_reply *PBSD_rdrpy_sock(int, int *);
+struct batch_reply *PBSD_rdrpy_one(int, int *);
+unsigned int PBSD_async_add(int);
+void PBSD_async_cancel(int, unsigned int);
+int PBSD_async_reply(int, struct batch_reply *);
+int PBSD_readable(int, int);
+int PBSD_runjob_rdrpy(int);
 void PBSD_FreeReply(struct batch_reply *);
 struct batch_status *PBSD_status(int, int, char *, struct attrl *, char *);
 struct batch_status *PBSD_status_random(int c, int function, char *id, struct attrl *attrib, char *extend, int parent_object);
@@ -363,6 +416,8 @@ extern int random_srv_conn(svr_conn_t *);
 preempt_job_info *PBSD_preempt_jobs(int, char **);
 struct batch_status *PBSD_status_get(int, struct batch_status **last);
 char *PBSD_queuejob(int, char *, char *, struct attropl *, char *, int, char **, int *);
+char *PBSD_submitjob(int, char *, struct attropl *, char *, size_t, char *, int *);
+int PBSD_execjob(int, char *, char *, struct attropl *, char *, size_t, int, char *, size_t, char **);
 int decode_DIS_svrattrl(int, pbs_list_head *);
 int decode_DIS_attrl(int, struct attrl **);
 int decode_DIS_JobId(int, char *);
@@ -378,10 +433,13 @@ int encode_DIS_ModifyResv(int, char *, struct attropl *);
 int encode_DIS_RelnodesJob(int, char *, char *);
 int encode_DIS_PySpawn(int, char *, char **, char **);
 int encode_DIS_QueueJob(int, char *, char *, struct attropl *);
+int encode_DIS_SubmitJob(int, char *, struct attropl *, char *, size_t);
+int encode_DIS_ExecJob(int, char *, char *, struct attropl *, char *, size_t, int, char *, size_t);
 int encode_DIS_SubmitResv(int, char *, struct attropl *);
 int encode_DIS_JobCredential(int, int, char *, int);
 int encode_DIS_ReqExtend(int, char *);
 int encode_DIS_ReqHdr(int, int, char *);
+int encode_DIS_ReqHdr_tagged(int, int, char *, unsigned int);
 int encode_DIS_Rescq(int, char **, int);
 int encode_DIS_Run(int, char *, char *, unsigned long);
 int encode_DIS_ShutDown(int, int);
@@ -392,6 +450,9 @@ int encode_DIS_attropl(int, struct attropl *);
 int encode_DIS_CopyHookFile(int, int, char *, int, char *);
 int encode_DIS_DelHookFile(int, char *);
 int encode_DIS_JobsList(int, char **, int);
+int encode_DIS_ModifyJobList(int, struct batch_status *);
+int encode_DIS_RunSubjobs(int, char *, int, int *, char **);
+int encode_DIS_SubmitJobList(int, char *, struct attropl *, int, struct attropl **, char **, size_t *);
 char *PBSD_submit_resv(int, char *, struct attropl *, char *);
 int DIS_reply_read(int, struct batch_reply *, int);
 int tcp_pre_process(conn_t *);
@@ -85,10 +85,11 @@ int place_sharing_check(char *, char *);
 /* Memory Allocation Error Message */
 #define MALLOC_ERR_MSG "No memory available"
 
-/* Dictionary is a list of words */
+/* Dictionary is a list of words, indexed by name */
 typedef struct dict {
 	struct word *first;
 	struct word *last;
+	void *idx;
 	int count;
 	int length;
 	int max_idx;
@@ -99,6 +100,7 @@ struct word {
 	char *name;
 	struct word *next;
 	struct map *map;
+	struct map *map_last;
 	int count;
 };
 
@@ -124,6 +126,26 @@ int get_execvnodes_count(char *);
 /* Free the memory allocated to an unrolled string */
 void free_execvnode_seq(char **ptr);
 
+/*
+ * A parsed execvnode sequence: each occurrence refers by index to one of
+ * the unique execvnodes, so the execvnodes are only held once.
+ */
+typedef struct execvnode_seq {
+	int count;	/* number of occurrences */
+	int nvnodes;	/* number of unique execvnodes */
+	char **vnodes;	/* the unique execvnodes */
+	int *occr;	/* index in vnodes of each occurrence's execvnode */
+} execvnode_seq;
+
+/* Parse a condensed string into an execvnode_seq */
+execvnode_seq *parse_execvnode_seq(char *);
+
+/* Free an execvnode_seq */
+void free_execvnode_seq_info(execvnode_seq *);
+
+/* Copy the execvnode of one occurrence out of a condensed string */
+char *get_execvnode_occurrence(char *, int);
+
 
 /* pbs_ical specific */
 
@@ -140,6 +162,11 @@ int get_num_occurrences(char *rrule, time_t dtstart, char *tz);
  */
 time_t get_occurrence(char *, time_t, char *, int);
 
+/* Get the first occurrences defined by a recurrence rule and start time
+ * in one pass, as get_occurrence() would return them for indexes 1 and up.
+ */
+int get_occurrences(char *rrule, time_t dtstart, char *tz, int num_occr, time_t *occr_arr);
+
 /*
  * Check if a recurrence rule is valid and consistent.
  * The recurrence rule is verified against a start date and checks
@@ -250,6 +277,8 @@ lock_file(int fd, int op, char *filename, int lock_retry,
 /* RSHD/RCP related */
 /* Size of the buffer used in communication with rshd deamon */
 #define RCP_BUFFER_SIZE 65536
+/* Size of the buffer used to stream file data */
+#define RCP_DATA_BUFSIZE (1024 * 1024)
 
 
 #define MAXBUFLEN 1024
@@ -102,6 +102,18 @@ extern int has_hardlimits(void *);
  */
 extern int has_softlimits(void *);
 
+/**	@fn char *lim_liminfo_to_str(void *p)
+ *	@brief	create a string of all the limits set in a limit storage
+ *
+ *	@param p	the limit storage to print
+ *
+ *	@return	the limits as key=value pairs (must be freed by the caller)
+ *	@retval NULL	on error
+ *
+ *	@par MT-safe:	No
+ */
+extern char *lim_liminfo_to_str(void *);
+
 /**	@fn int is_reslimattr(const struct attrl *a)
  *	@brief	is the given attribute a new-style resource limit attribute?
  *
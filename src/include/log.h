@@ -74,6 +74,7 @@ extern "C" {
  * truncation warnings from certain compilers.
  */
 #define LOG_BUF_SIZE 4352
+#define LOG_FILE_BUFSZ (64 * 1024)	/* stdio buffer of the log file */
 
 /* The following macro assist in sharing code between the Server and Mom */
 #define LOG_EVENT log_event
@@ -113,6 +114,8 @@ extern struct log_net_info *get_if_info(char *msg);
 extern void free_if_info(struct log_net_info *ni);
 
 extern void log_close(int close_msg);
+extern void log_set_flush_severity(int sev);
+extern void log_flush(void);
 extern void log_err(int err, const char *func, const char *text);
 extern void log_errf(int errnum, const char *routine, const char *fmt, ...);
 extern void log_joberr(int err, const char *func, const char *text, const char *pjid);
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#ifndef _MEM_ACCT_H
+#define _MEM_ACCT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Counts of the live objects of each kind and of the bytes they hold,
+ * kept by the functions allocating and freeing them.  The server shows
+ * them in its server_memory attribute.  The counters are not locked and
+ * only mean something in the single threaded daemons.
+ */
+enum mem_acct_kind {
+	MEM_ACCT_JOB,		/* job structures, job_alloc() */
+	MEM_ACCT_SVRATTRL,	/* svrattrl entries, attrlist_alloc() */
+	MEM_ACCT_WORK_TASK,	/* work tasks, set_task() */
+	MEM_ACCT_HOOK,		/* hook structures, hook_alloc() */
+	MEM_ACCT_DIS,		/* DIS channels with their read and write buffers */
+	MEM_ACCT_BATCH_REQ,	/* batch requests, alloc_br() */
+	MEM_ACCT_KINDS
+};
+
+struct mem_acct {
+	long long ma_count;	/* live objects */
+	long long ma_bytes;	/* bytes they hold */
+	long long ma_peak;	/* most bytes held at once */
+	long long ma_allocs;	/* objects allocated so far */
+};
+
+extern struct mem_acct mem_acct[MEM_ACCT_KINDS];
+extern const char *mem_acct_names[MEM_ACCT_KINDS];
+
+/*
+ * Account for nobj objects of kind (negative when freed) and nbytes
+ * bytes (negative when given back).
+ */
+extern void mem_acct_add(enum mem_acct_kind kind, long nobj, long long nbytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MEM_ACCT_H */
@@ -140,6 +140,8 @@ enum hup_action {
 extern enum hup_action	call_hup;
 
 extern int mock_run;
+extern int mock_run_runtime_min;
+extern int mock_run_runtime_max;
 
 /* public funtions within MOM */
 
@@ -148,6 +150,8 @@ extern int mock_run;
 #define COMM_MATURITY_TIME  60 /* time when we consider a pbs_comm connection as mature */
 #define MOM_DELTA_NORMAL	1	/* Normal mode of operation for time_delta_hellosvr function */
 #define MOM_DELTA_RESET 	0	/* Reset the values of time_delta_hellosvr function back to 1 */
+#define MOM_HELLO_ADMIT_RATE	500	/* hellos per second the server is expected to take after an outage */
+#define MOM_HELLO_SPREAD_MAX	30	/* max secs the first hello after losing the server is spread over */
 
 typedef	int	(*pbs_jobfunc_t)(job *);
 typedef	int	(*pbs_jobnode_t)(job *, hnodent *);
@@ -212,6 +216,9 @@ extern int   site_mom_chkuser(job *);
 extern int   site_mom_postchk(job *, int);
 extern int   site_mom_prerst(job *);
 extern int   terminate_job(job *, int);
+extern int   job_over_limit(job *, int);
+extern void  kill_over_limit_job(job *);
+extern void  cache_job_limits(job *);
 extern int   mom_deljob_wait(job *);
 extern int   run_pelog(int which, char *file, job *pjob, int pe_io_type);
 extern int   is_joined(job *);
@@ -257,6 +264,7 @@ extern void	exec_bail(job *pjob, int code, char *txt);
 extern int	generate_pbs_nodefile(job *pjob, char *nodefile, int nodefile_sz, char *err_msg, int err_msg_sz);
 extern int	job_nodes_inner(struct job *pjob, hnodent **mynp);
 extern int	job_nodes(job *pjob);
+extern vmpiprocs *find_vmpiproc(job *pjob, tm_node_id nodeid);
 extern int	tm_reply(int stream, int version, int com, tm_event_t event);
 #ifdef WIN32
 extern void	end_proc(void);
@@ -351,6 +359,8 @@ extern int   impersonate_user(uid_t, gid_t);
 extern void  revert_from_user(void);
 extern int   open_file_as_user(char *path, int oflag, mode_t mode,
 	uid_t exuid, gid_t exgid);
+extern int   stage_file_start(int, int, char *, struct rqfpair *, int, cpy_files *, char *, char *);
+extern int   stage_file_finish(int, cpy_files *);
 #endif
 extern int  find_env_slot(struct var_table *, char *);
 extern void  bld_env_variables(struct var_table *, char *, char *);
@@ -389,6 +399,9 @@ extern int becomeuser(job *);
 extern int becomeuser_args(char *, uid_t, gid_t, gid_t);
 extern void close_update_pipes(job *);
 extern void mom_set_use_all(void);
+extern void mom_set_use_job(job *, int *);
+extern void track_job_pid(job *, pid_t);
+extern job *find_pid_owner(pid_t, pbs_task **);
 void job_purge_mom(job *pjob);
 
 /* From popen.c */
@@ -401,6 +414,7 @@ extern void start_walltime(job *);
 extern void update_walltime(job *);
 extern void stop_walltime(job *);
 extern void recover_walltime(job *);
+extern void arm_walltime_limit(job *);
 
 /* Define for max xauth data*/
 #define X_DISPLAY_LEN   512
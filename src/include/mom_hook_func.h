@@ -106,6 +106,10 @@ struct hook_vnl_action {
  * 			pbs.event().pid value.
  * @param[in]	jobs_list - list of jobs and their attributes/resources
  * 			    used by the exechost_periodic hook.
+ * @param[in]	job_filter - HOOK_JOB_FILTER_* bits limiting jobs_list to
+ *			     the jobs that changed after change pass
+ *			     'job_since'; HOOK_JOB_FILTER_ALL for all jobs.
+ * @param[in]	job_since - change pass of the hook's previous run.
  *
  */
 typedef struct mom_hook_input {
@@ -119,6 +123,8 @@ typedef struct mom_hook_input {
 	void *succeeded_mom_list;
 	pid_t pid;
 	pbs_list_head *jobs_list;
+	unsigned int job_filter;
+	unsigned long job_since;
 } mom_hook_input_t;
 
 /**
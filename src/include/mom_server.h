@@ -97,6 +97,10 @@ extern int job_obit(ruu *, int);
 extern int enqueue_update_for_send(job *, int);
 extern void send_resc_used(int cmd, int count, ruu *rud);
 extern void send_pending_updates(void);
+extern void send_full_updates(void);
+extern int resc_used_update_due(job *);
+extern int resc_used_change;
+extern int resc_used_max_interval;
 extern char mom_short_name[];
 
 #ifdef _PBS_JOB_H
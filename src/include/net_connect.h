@@ -229,5 +229,6 @@ struct connection {
 	char            cn_physhost[PBS_MAXHOSTNAME + 1];
 	pbs_auth_config_t   *cn_auth_config;
 	conn_origin_t	cn_origin; /* used to know the origin of the connection i.e. Scheduler, MOM etc. */
+	char		cn_session[AUTH_SESSION_TOKEN_LEN + 1]; /* session token issued, pending until authenticated */
 };
 #endif	/* _NET_CONNECT_H */
@@ -86,6 +86,8 @@ struct pbs_client_thread_connect_context {
 };
 
 
+struct batch_status;
+
 /**
  * @brief
  *  Structure used to store thread level context data (TLS)
@@ -116,6 +118,9 @@ struct pbs_client_thread_context {
 	int			th_pbs_tcp_interrupt;
 	int			th_pbs_tcp_errno;
 	int			th_pbs_mode;
+	/** consumer of status replies, see pbs_stat_stream() */
+	int			(*th_stat_cb)(struct batch_status *, void *);
+	void			*th_stat_arg;
 };
 
 
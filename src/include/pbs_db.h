@@ -97,6 +97,50 @@ struct pbs_db_attr_list {
 
 typedef struct pbs_db_attr_list pbs_db_attr_list_t;
 
+/* attributes stored as a binary blob, see db_binary_attributes */
+#define PBS_DB_BLOB_MAGIC	"PBA\001"
+#define PBS_DB_BLOB_MAGIC_LEN	4
+
+/* how the value of a blob entry is stored */
+#define PBS_DB_BLOB_TEXT	0	/* encoded string, given to at_decode */
+#define PBS_DB_BLOB_STR		1	/* string value */
+#define PBS_DB_BLOB_LONG	2	/* long, long long or time value */
+#define PBS_DB_BLOB_BOOL	3
+#define PBS_DB_BLOB_CHAR	4
+#define PBS_DB_BLOB_SIZE	5
+#define PBS_DB_BLOB_FLOAT	6
+
+/**
+ * @brief
+ *  One attribute value in a binary attribute blob
+ *
+ */
+struct pbs_db_blob_ent {
+	int       bl_type;	/* PBS_DB_BLOB_* */
+	int       bl_flags;	/* attribute flags */
+	char     *bl_name;	/* attribute name */
+	char     *bl_resc;	/* resource name, NULL if none */
+	char     *bl_str;	/* TEXT and STR value */
+	long long bl_long;	/* LONG, BOOL and CHAR value */
+	unsigned long long bl_size_num;	/* SIZE value */
+	int       bl_size_shift;
+	int       bl_size_units;
+	float     bl_float;	/* FLOAT value */
+};
+typedef struct pbs_db_blob_ent pbs_db_blob_ent_t;
+
+/**
+ * @brief
+ *  A binary attribute blob being built
+ *
+ */
+struct pbs_db_blob {
+	char *data;
+	int   len;
+	int   size;
+};
+typedef struct pbs_db_blob pbs_db_blob_t;
+
 /**
  * @brief
  *  Structure used to map database server structure to C
@@ -181,7 +225,11 @@ struct pbs_db_job_info {
 	char     ji_jid[8];	/* extended job save data */
 	INTEGER  ji_credtype;	/* credential type */
 	BIGINT   ji_qrank;	/* sort key for db query */
+	INTEGER  ji_hist;	/* job is in the history tables */
 	pbs_db_attr_list_t db_attr_list; /* list of attributes for database */
+	pbs_db_attr_list_t db_attr_hot;	/* often changed attributes, kept in a column of their own */
+	char    *db_attr_blob;	/* attributes in binary form, used instead of db_attr_list if set */
+	int      db_attr_bloblen;
 };
 typedef struct pbs_db_job_info pbs_db_job_info_t;
 
@@ -231,6 +279,9 @@ struct pbs_db_query_options {
 };
 typedef struct pbs_db_query_options pbs_db_query_options_t;
 
+/* job search flag: fetch the fixed job fields only, leave the attributes out */
+#define FIND_JOBS_KEYS_ONLY	0x2
+
 
 #define PBS_DB_SVR		0
 #define PBS_DB_SCHED		1
@@ -288,6 +339,7 @@ struct pbs_db_obj_info {
 };
 typedef struct pbs_db_obj_info pbs_db_obj_info_t;
 typedef void (*query_cb_t)(pbs_db_obj_info_t *, int *);
+typedef void (*pbs_db_async_cb_t)(void *conn, int rc, void *arg);
 
 #define PBS_DB_CNT_TIMEOUT_NORMAL	30
 #define PBS_DB_CNT_TIMEOUT_INFINITE	0
@@ -347,6 +399,89 @@ int pbs_db_disconnect(void *conn);
  */
 int pbs_db_save_obj(void *conn, pbs_db_obj_info_t *obj, int savetype);
 
+/**
+ * @brief
+ *	Start a (possibly nested) transaction on the database connection
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_begin_trx(void *conn);
+
+/**
+ * @brief
+ *	End a transaction, committing it if commit is set and no nested
+ *	transaction asked for a rollback
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	commit - 1 to commit, 0 to roll back
+ *
+ * @return      int
+ * @retval      -1  - Failure or rolled back
+ * @retval       0  - success
+ *
+ */
+int pbs_db_end_trx(void *conn, int commit);
+
+/**
+ * @brief
+ *	Start a batch of statements sent without waiting for their results.
+ *	Until pbs_db_async_end, saves on the connection are only queued.
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      int
+ * @retval      -1  - Failure, asynchronous batches are not available
+ * @retval       0  - success
+ *
+ */
+int pbs_db_async_begin(void *conn);
+
+/**
+ * @brief
+ *	End a batch started with pbs_db_async_begin and send it as one
+ *	transaction. cb is called with the outcome once its results are in.
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	cb   - Completion callback, may be NULL
+ * @param[in]	arg  - Argument for cb
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_async_end(void *conn, pbs_db_async_cb_t cb, void *arg);
+
+/**
+ * @brief
+ *	Collect the results of the batches sent with pbs_db_async_end and
+ *	call their completion callbacks
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	wait - 1 to wait for all outstanding batches, 0 to only
+ *		       process the results that already arrived
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - No batches outstanding
+ * @retval       1  - Batches still outstanding
+ *
+ */
+int pbs_db_async_poll(void *conn, int wait);
+
+/**
+ * @brief
+ *	When set, called with the time in seconds each round trip to the
+ *	database took: a statement run synchronously, or an asynchronous
+ *	batch from pbs_db_async_end until pbs_db_async_poll got its results.
+ */
+extern void (*pfn_db_round_trip)(double);
+
 /**
  * @brief
  *	Delete an existing object from the database
@@ -420,6 +555,36 @@ int pbs_db_search(void *conn, pbs_db_obj_info_t *obj, pbs_db_query_options_t *op
  */
 int pbs_db_load_obj(void *conn, pbs_db_obj_info_t *obj);
 
+/**
+ * @brief
+ *	Move a finished job to the history tables, which are partitioned by
+ *	the day the jobs finished on
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	obj  - Wrapper object of the job to move
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_move_job_hist(void *conn, pbs_db_obj_info_t *obj);
+
+/**
+ * @brief
+ *	Drop the partitions of the history tables whose jobs all finished
+ *	before a given time
+ *
+ * @param[in]	conn   - Connected database handle
+ * @param[in]	before - Expiry time
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval      >=0 - Number of partitions dropped
+ *
+ */
+int pbs_db_expire_job_hist(void *conn, time_t before);
+
 /**
  * @brief
  *	Function to check whether data-service is running
@@ -468,6 +633,62 @@ int pbs_stop_db(char *pbs_ds_host, int pbs_ds_port);
  */
 void pbs_db_get_errmsg(int err_code, char **err_msg);
 
+/**
+ * @brief
+ *	Append an attribute value to a binary attribute blob
+ *
+ * @param[in,out] blob - The blob, starts out zeroed
+ * @param[in]	ent  - The value to append
+ *
+ * @retval       -1 - Failure
+ * @retval        0  - Success
+ *
+ */
+int pbs_db_blob_add(pbs_db_blob_t *blob, pbs_db_blob_ent_t *ent);
+
+/**
+ * @brief
+ *	Read the next attribute value from a binary attribute blob
+ *
+ * @param[in]	data - The blob
+ * @param[in]	len  - Length of the blob
+ * @param[in,out] pos - Read position, 0 for the first entry
+ * @param[out]	ent  - The value read, its strings point into the blob
+ *
+ * @retval       -1 - The blob is corrupt
+ * @retval        0  - Success
+ * @retval        1  - No more entries
+ *
+ */
+int pbs_db_blob_next(char *data, int len, int *pos, pbs_db_blob_ent_t *ent);
+
+/**
+ * @brief
+ *	Return the value of a binary attribute blob entry as a string
+ *
+ * @param[in]	ent - The blob entry
+ * @param[out]	buf - Buffer for the values that are not stored as strings
+ * @param[in]	len - Size of buf
+ *
+ * @return	The value string
+ *
+ */
+char *pbs_db_blob_value(pbs_db_blob_ent_t *ent, char *buf, int len);
+
+/**
+ * @brief
+ *	Convert a binary attribute blob to a list of attributes
+ *
+ * @param[in]	data - The blob
+ * @param[in]	len  - Length of the blob
+ * @param[out]	attr_list - List of attributes
+ *
+ * @retval       -1 - Failure
+ * @retval        0  - Success
+ *
+ */
+int dbblob_to_attrlist(char *data, int len, pbs_db_attr_list_t *attr_list);
+
 /**
  * @brief
  *	Function to create new databse user or change password of current user.
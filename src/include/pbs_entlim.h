@@ -62,6 +62,9 @@ enum lim_keytypes {
 #define PBS_ALL_ENTITY	   "PBS_ALL"
 #define ETLIM_INVALIDCHAR  "/[]\";:|<>+,?*"
 
+/* resource id passed to entlim_get_id() for an entity's run limit */
+#define ENTLIM_RUN_ID 0
+
 /* Flags used for account_entity_limit_usages() */
 #define ETLIM_ACC_CT	 1 << 0 /* flag for set_entity_ct_sum_ */
 #define ETLIM_ACC_RES	 1 << 1 /* flag for set_entity_resc_sum_ */
@@ -84,6 +87,12 @@ void *entlim_initialize_ctx(void);
 /* get data record from an entry based on a key string */
 void *entlim_get(const char *keystr, void *ctx);
 
+/* get data record for an entity and resource id, without a key string */
+void *entlim_get_id(void *ctx, enum lim_keytypes kt, const char *entity, int rescid);
+
+/* id of a resource for entlim_get_id(), -1 if no limit was ever set on it */
+int entlim_resc_id(const char *resc);
+
 /* add a record including key and data, based on a key string */
 int entlim_add(const char *entity, const void *recptr, void *ctx);
 
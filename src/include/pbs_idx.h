@@ -45,6 +45,7 @@ extern "C" {
 
 #define PBS_IDX_DUPS_OK     0x01 /* duplicate key allowed in index */
 #define PBS_IDX_ICASE_CMP   0x02 /* set case-insensitive compare */
+#define PBS_IDX_HASH        0x04 /* unordered index, hashed exact-match lookups */
 
 #define PBS_IDX_RET_OK    0 /* index op succeed */
 #define PBS_IDX_RET_FAIL -1 /* index op failed */
@@ -60,6 +61,13 @@ extern "C" {
  * @retval !NULL - success
  * @retval NULL  - failure
  *
+ * @note
+ *	With PBS_IDX_HASH the index is a hash table: lookups by key take
+ *	constant time, but iteration is in no particular order and an insert
+ *	made while iterating may move entries, so the iteration has to be
+ *	started over.  Without it the index is an AVL tree and is iterated in
+ *	key order.  PBS_IDX_HASH is ignored together with PBS_IDX_DUPS_OK.
+ *
  */
 extern void *pbs_idx_create(int dups, int keylen);
 
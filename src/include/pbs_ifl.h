@@ -165,6 +165,8 @@ extern "C" {
 #define ATTR_max_run_soft	"max_run_soft"
 #define ATTR_max_run_res_soft	"max_run_res_soft"
 #define ATTR_total	"total_jobs"
+#define ATTR_modify_seq	"modify_seq"
+#define ATTR_event_time	"event_time"
 #define ATTR_comment	"comment"
 #define ATTR_cookie	"cookie"
 #define ATTR_qrank	"queue_rank"
@@ -312,6 +314,14 @@ extern "C" {
 #define ATTR_resv_retry_init	"reserve_retry_init"
 #define ATTR_JobHistoryEnable	"job_history_enable"
 #define ATTR_JobHistoryDuration	"job_history_duration"
+#define ATTR_DbBinaryAttrs	"db_binary_attributes"
+#define ATTR_AcctJson		"accounting_json"
+#define ATTR_MailDigest		"mail_digest_interval"
+#define ATTR_ServerStats	"server_stats"
+#define ATTR_ServerMemory	"server_memory"
+#define ATTR_StatsInterval	"server_stats_interval"
+#define ATTR_max_request_rate	"max_request_rate"
+#define ATTR_auth_session_lifetime	"auth_session_lifetime"
 #define ATTR_max_concurrent_prov	"max_concurrent_provision"
 #define ATTR_resv_post_processing "resv_post_processing_time"
 #define ATTR_backfill_depth     "backfill_depth"
@@ -345,6 +355,7 @@ extern "C" {
 
 #define ATTR_SchedHost	"sched_host"
 #define ATTR_sched_cycle_len "sched_cycle_length"
+#define ATTR_sched_cycle_profile "sched_cycle_profile"
 #define ATTR_do_not_span_psets "do_not_span_psets"
 #define ATTR_only_explicit_psets "only_explicit_psets"
 #define ATTR_sched_preempt_enforce_resumption "sched_preempt_enforce_resumption"
@@ -534,6 +545,40 @@ struct batch_deljob_status {
 	int	code;
 };
 
+/*
+ * consumer of a status reply, given each part of the reply as it arrives,
+ * see pbs_stat_stream()
+ */
+typedef int (*pbs_stat_cb)(struct batch_status *, void *);
+
+/* structure to hold a pipelined run job request the server rejected */
+struct batch_runjob_status {
+	struct batch_runjob_status *next;
+	char	*name;
+	int	code;
+	char	*text;
+};
+
+/* structure to hold the reply to a tagged request, see pbs_async_wait() */
+struct batch_async_status {
+	struct batch_async_status *next;
+	unsigned int	tag;		/* tag returned when the request was sent */
+	int	code;			/* PBSE_ error code of the reply */
+	char	*text;			/* error text, if the server sent any */
+	struct batch_status *status;	/* status objects of a status request */
+};
+
+/*
+ * consumer of the replies to tagged requests, given each reply as it
+ * completes, see pbs_async_wait()
+ */
+typedef void (*pbs_async_cb)(struct batch_async_status *, void *);
+
+/* event classes for pbs_subscribe(), given as a comma separated list */
+#define SUBSCRIBE_JOB	"job"	/* job state changes */
+#define SUBSCRIBE_NODE	"node"	/* vnode state changes */
+#define SUBSCRIBE_RESV	"resv"	/* reservation state changes */
+
 /* structure to hold an attribute that failed verification at ECL
  * and the associated errcode and errmsg
  */
@@ -603,6 +648,8 @@ DECLDIR int pbs_asyrunjob(int, char *, char *, char *);
 
 DECLDIR int pbs_alterjob(int, char *, struct attrl *, char *);
 
+DECLDIR struct batch_deljob_status *pbs_alterjob_sel(int, struct attropl *, struct attrl *, char *);
+
 DECLDIR int pbs_connect(char *);
 
 DECLDIR int pbs_connect_extend(char *, char *);
@@ -669,6 +716,8 @@ DECLDIR struct ecl_attribute_errors * pbs_get_attributes_in_error(int);
 
 DECLDIR char *pbs_submit(int, struct attropl *, char *, char *, char *);
 
+DECLDIR struct batch_deljob_status *pbs_submit_many(int, struct attropl *, int, struct attropl **, char **, char *, char *);
+
 DECLDIR char *pbs_submit_resv(int, struct attropl *, char *);
 
 DECLDIR int pbs_delresv(int, char *, char *);
@@ -697,10 +746,30 @@ extern int pbs_asyrunjob(int, char *, char *, char *);
 
 extern int pbs_asyrunjob_ack(int, char *, char *, char *);
 
+extern int pbs_asyrunjob_pipe(int, char *, char *, char *);
+
+extern int pbs_runjob_pipe(int, char *, char *, char *);
+
+extern struct batch_runjob_status *pbs_asyrunjob_replies(int);
+
+extern int pbs_asyrunsubjobs(int, char *, int, int *, char **, char *);
+
 extern int pbs_alterjob(int, char *, struct attrl *, char *);
 
 extern int pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend);
 
+extern int pbs_asyalterjobs(int, struct batch_status *, char *);
+
+extern struct batch_deljob_status *pbs_alterjob_sel(int, struct attropl *, struct attrl *, char *);
+
+extern unsigned int pbs_async_statjob(int, char *, struct attrl *, char *);
+
+extern unsigned int pbs_async_alterjob(int, char *, struct attrl *, char *);
+
+extern unsigned int pbs_async_selstat(int, struct attropl *, struct attrl *, char *);
+
+extern struct batch_async_status *pbs_async_wait(int, int, pbs_async_cb, void *);
+
 extern int pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 extern int pbs_connect(char *);
@@ -747,6 +816,12 @@ extern void pbs_statfree(struct batch_status *);
 
 extern void pbs_delstatfree(struct batch_deljob_status *);
 
+extern void pbs_runjobstatfree(struct batch_runjob_status *);
+
+extern void pbs_asyncstatfree(struct batch_async_status *);
+
+extern int pbs_stat_stream(pbs_stat_cb, void *);
+
 extern struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
@@ -755,6 +830,8 @@ extern struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, c
 
 extern struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
 
+extern struct batch_status *pbs_statsnap(int, char *, struct attrl *);
+
 extern struct batch_status *pbs_statserver(int, struct attrl *, char *);
 
 extern struct batch_status *pbs_statsched(int, struct attrl *, char *);
@@ -769,10 +846,16 @@ extern struct batch_status *pbs_statresv(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_stathook(int, char *, struct attrl *, char *);
 
+extern int pbs_subscribe(int, char *, struct attrl *, char *);
+
+extern struct batch_status *pbs_get_events(int, int);
+
 extern struct ecl_attribute_errors * pbs_get_attributes_in_error(int);
 
 extern char *pbs_submit(int, struct attropl *, char *, char *, char *);
 
+extern struct batch_deljob_status *pbs_submit_many(int, struct attropl *, int, struct attropl **, char **, char *, char *);
+
 extern char *pbs_submit_resv(int, struct attropl *, char *);
 
 extern int pbs_delresv(int, char *, char *);
@@ -787,8 +870,18 @@ extern preempt_job_info *pbs_preempt_jobs(int, char **);
 /* IFL function pointers */
 extern int (*pfn_pbs_asyrunjob)(int, char *, char *, char *);
 extern int (*pfn_pbs_asyrunjob_ack)(int, char *, char *, char *);
+extern int (*pfn_pbs_asyrunjob_pipe)(int, char *, char *, char *);
+extern int (*pfn_pbs_runjob_pipe)(int, char *, char *, char *);
+extern struct batch_runjob_status *(*pfn_pbs_asyrunjob_replies)(int);
+extern int (*pfn_pbs_asyrunsubjobs)(int, char *, int, int *, char **, char *);
 extern int (*pfn_pbs_alterjob)(int, char *, struct attrl *, char *);
 extern int (*pfn_pbs_asyalterjob)(int, char *, struct attrl *, char *);
+extern int (*pfn_pbs_asyalterjobs)(int, struct batch_status *, char *);
+extern struct batch_deljob_status *(*pfn_pbs_alterjob_sel)(int, struct attropl *, struct attrl *, char *);
+extern unsigned int (*pfn_pbs_async_statjob)(int, char *, struct attrl *, char *);
+extern unsigned int (*pfn_pbs_async_alterjob)(int, char *, struct attrl *, char *);
+extern unsigned int (*pfn_pbs_async_selstat)(int, struct attropl *, struct attrl *, char *);
+extern struct batch_async_status *(*pfn_pbs_async_wait)(int, int, pbs_async_cb, void *);
 extern int (*pfn_pbs_confirmresv)(int, char *, char *, unsigned long, char *);
 extern int (*pfn_pbs_connect)(char *);
 extern int (*pfn_pbs_connect_extend)(char *, char *);
@@ -811,10 +904,14 @@ extern char **(*pfn_pbs_selectjob)(int, struct attropl *, char *);
 extern int (*pfn_pbs_sigjob)(int, char *, char *, char *);
 extern void (*pfn_pbs_statfree)(struct batch_status *);
 extern void (*pfn_pbs_delstatfree)(struct batch_deljob_status *);
+extern void (*pfn_pbs_runjobstatfree)(struct batch_runjob_status *);
+extern void (*pfn_pbs_asyncstatfree)(struct batch_async_status *);
+extern int (*pfn_pbs_stat_stream)(pbs_stat_cb, void *);
 extern struct batch_status *(*pfn_pbs_statrsc)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statjob)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_selstat)(int, struct attropl *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statque)(int, char *, struct attrl *, char *);
+extern struct batch_status *(*pfn_pbs_statsnap)(int, char *, struct attrl *);
 extern struct batch_status *(*pfn_pbs_statserver)(int, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statsched)(int, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_stathost)(int, char *, struct attrl *, char *);
@@ -822,8 +919,11 @@ extern struct batch_status *(*pfn_pbs_statnode)(int, char *, struct attrl *, cha
 extern struct batch_status *(*pfn_pbs_statvnode)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statresv)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_stathook)(int, char *, struct attrl *, char *);
+extern int (*pfn_pbs_subscribe)(int, char *, struct attrl *, char *);
+extern struct batch_status *(*pfn_pbs_get_events)(int, int);
 extern struct ecl_attribute_errors * (*pfn_pbs_get_attributes_in_error)(int);
 extern char *(*pfn_pbs_submit)(int, struct attropl *, char *, char *, char *);
+extern struct batch_deljob_status *(*pfn_pbs_submit_many)(int, struct attropl *, int, struct attropl **, char **, char *, char *);
 extern char *(*pfn_pbs_submit_resv)(int, struct attropl *, char *);
 extern int (*pfn_pbs_delresv)(int, char *, char *);
 extern int (*pfn_pbs_terminate)(int, int, char *);
@@ -243,7 +243,7 @@ struct pbs_config
 	char *pbs_mail_host_name;	/* name of host to which to address mail */
 	char *pbs_smtp_server_name;   /* name of SMTP host to which to send mail */
 	char *pbs_output_host_name;	/* name of host to which to stage std out/err */
-	unsigned pbs_use_compression:1;	/* whether pbs should compress communication data */
+	unsigned pbs_use_compression:2;	/* compress communication data: 0 no, 1 zlib, 2 lz4 */
 	unsigned pbs_use_mcast:1;		/* whether pbs should multicast communication */
 	unsigned pbs_use_ft:1;		/* whether pbs should force use fault tolerant communications */
 	char *pbs_leaf_name;			/* non-default name of this leaf in the communication network */
@@ -252,6 +252,12 @@ struct pbs_config
 	char *pbs_comm_routers;		/* for this router, the optional list of other routers to talk to */
 	long  pbs_comm_log_events;      /* log_events for pbs_comm process, default 0 */
 	unsigned int pbs_comm_threads;	/* number of threads for router, default 4 */
+	unsigned int pbs_tpp_coalesce_delay;	/* ms a small TPP message may wait to be sent with others, default 0 */
+	unsigned int pbs_use_io_uring;	/* use io_uring instead of epoll for event monitoring, default 0 */
+	unsigned int pbs_dis_binary;	/* offer/accept binary DIS integers on batch connections, default 0 */
+	unsigned int pbs_auth_sessions;	/* resume authenticated sessions instead of a new handshake, default 0 */
+	unsigned int pbs_hot_standby;	/* secondary server keeps a replica of the jobs, default 0 */
+	unsigned int pbs_status_snapshot; /* seconds between status snapshots written by the server, default 0 (none) */
 	char *pbs_mom_node_name;	/* mom short name used for natural node, default NULL */
 	char *pbs_lr_save_path;		/* path to store undo live recordings */
 	unsigned int pbs_log_highres_timestamp; /* high resolution logging */
@@ -295,6 +301,12 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_COMM_ROUTERS		     "PBS_COMM_ROUTERS"
 #define PBS_CONF_COMM_THREADS		     "PBS_COMM_THREADS"
 #define PBS_CONF_COMM_LOG_EVENTS	     "PBS_COMM_LOG_EVENTS"
+#define PBS_CONF_TPP_COALESCE_DELAY	     "PBS_TPP_COALESCE_DELAY"
+#define PBS_CONF_USE_IO_URING		     "PBS_USE_IO_URING"
+#define PBS_CONF_DIS_BINARY		     "PBS_DIS_BINARY"
+#define PBS_CONF_AUTH_SESSIONS		     "PBS_AUTH_SESSIONS"
+#define PBS_CONF_HOT_STANDBY		     "PBS_HOT_STANDBY"
+#define PBS_CONF_STATUS_SNAPSHOT	     "PBS_STATUS_SNAPSHOT"
 #define PBS_CONF_HOME		"PBS_HOME"	 	 /* path to pbs home */
 #define PBS_CONF_EXEC		"PBS_EXEC"		 /* path to pbs exec */
 #define PBS_CONF_DEFAULT_NAME	"PBS_DEFAULT"	  /* old name for PBS_SERVER */
@@ -377,6 +389,40 @@ enum accrue_types {
 
 #define PBS_USE_IFF		1	/* pbs_connect() to call pbs_iff */
 
+/*
+ * pbs_statvnode() extend options used by the scheduler to be sent only the
+ * vnodes whose status changed since the last status sent on the connection.
+ * Unchanged vnodes are reported by name with no attributes.
+ */
+#define EXTEND_OPT_NODE_CHANGED	"c"	/* report only changed vnodes in full */
+#define EXTEND_OPT_NODE_RESYNC	"cr"	/* report all vnodes in full and track them */
+
+/*
+ * pbs_statvnode() extend option used by a scheduler to be sent only the
+ * vnodes of its own partition.  It may follow one of the options above,
+ * e.g. EXTEND_OPT_NODE_CHANGED EXTEND_OPT_NODE_PARTITION.
+ */
+#define EXTEND_OPT_NODE_PARTITION	"p"
+
+/*
+ * pbs_statvnode() extend options asking for totals over all the vnodes
+ * instead of the status of each: the number of vnodes, the number in each
+ * state and the summed numeric resources_available and resources_assigned.
+ * The totals for all the vnodes are reported under an empty name, then
+ * with EXTEND_OPT_NODE_SUMMARY_HOST the totals of each host under its name.
+ */
+#define EXTEND_OPT_NODE_SUMMARY		"summary"
+#define EXTEND_OPT_NODE_SUMMARY_HOST	"summary=host"
+#define ATTR_NODE_summary_vnodes	"vnodes"
+#define ATTR_NODE_summary_state		"state_count"
+
+/*
+ * Status extend option asking for the objects changed since the given
+ * modify_seq, e.g. "since=1234".  Other objects are reported by name with
+ * no attributes, objects reported in full carry their modify_seq.
+ */
+#define EXTEND_OPT_SINCE	"since="
+
 
 /* time flag 2030-01-01 01:01:00 for ASAP reservation */
 #define PBS_RESV_FUTURE_SCH 1893488460L
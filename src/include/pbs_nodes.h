@@ -116,6 +116,7 @@ struct mom_svrinfo {
 	struct job	**msr_jobindx;  /* index array of jobs on this Mom */
 	long		msr_vnode_pool;/* the pool of vnodes that belong to this Mom */
 	int		msr_has_inventory; /* Tells whether mom is an inventory reporting mom */
+	int		msr_no_execjob; /* mom rejected PBS_BATCH_ExecJob */
 };
 typedef struct mom_svrinfo mom_svrinfo_t;
 
@@ -255,6 +256,15 @@ struct pbsnode {
 	void *nd_lic_info;			/* information set and used for licensing */
 	int nd_added_to_unlicensed_list;/* To record if the node is added to the list of unlicensed node */
 	pbs_list_link un_lic_link;		/*Link to unlicense list */
+	int nd_stat_conn;		/* connection last sent a tracked status */
+	u_Long nd_stat_digest;		/* digest of the status sent on nd_stat_conn */
+	u_Long nd_modseq;		/* modify_seq of the last change seen by a stat */
+	struct pbs_sched *nd_sched;	/* scheduler of the vnode's partition, see find_assoc_sched_pnode() */
+	long nd_sched_gen;		/* generation of the schedulers nd_sched was found in */
+	struct resc_resv **nd_resv;	/* reservations with the vnode in any occurrence, see resv_vnode_index() */
+	int nd_nresv;			/* number of entries in nd_resv */
+	int nd_resvsz;			/* number of slots in nd_resv */
+	long nd_resv_gen;		/* generation of the reservations' vnodes nd_resv is of */
 };
 
 enum	warn_codes { WARN_none, WARN_ngrp_init, WARN_ngrp_ck, WARN_ngrp };
@@ -351,12 +361,31 @@ enum vnode_degraded_op {
 #define PBSNODE_NTYPE_MASK	0xf		 /* relevant ntype bits */
 
 
-/* tree for mapping contact info to node struture */
+/* index for mapping contact info to node struture, see tfind2() */
 struct tree {
+	void		  *t_idx;	/* pbs_idx of mominfo_t keyed by struct tree_key */
+};
+
+struct tree_key {
 	unsigned long	   key1;
 	unsigned long	   key2;
-	mominfo_t         *momp;
-	struct tree	  *left, *right;
+};
+
+/* one vnode entry of a job's parsed exec_vnode, see job_alloc_get() */
+struct job_alloc_ent {
+	char			*ae_vname;	/* vnode name */
+	int			 ae_nelem;	/* number of resource=value pairs */
+	struct key_value_pair	*ae_kv;		/* the pairs, point into ja_buf */
+};
+
+/* parsed exec_vnode kept on the job alongside the string attribute */
+struct job_alloc {
+	char			*ja_str;	/* string the entries were parsed from */
+	char			*ja_buf;	/* munged copy the entries point into */
+	int			 ja_nent;	/* number of vnode entries */
+	int			 ja_nhost;	/* number of "(...)" host chunks */
+	struct job_alloc_ent	*ja_ent;
+	struct key_value_pair	*ja_kv;		/* pairs of all the entries */
 };
 
 extern void *node_attr_idx;
@@ -379,6 +408,7 @@ extern	int find_degraded_occurrence(resc_resv *, struct pbsnode *, enum vnode_de
 extern	int find_vnode_in_execvnode(char *, char *);
 extern	void set_vnode_state(struct pbsnode *, unsigned long , enum vnode_state_op);
 extern	struct resvinfo *find_vnode_in_resvs(struct pbsnode *, enum vnode_degraded_op);
+extern	void resv_vnodes_changed(void);
 extern	void free_rinf_list(struct resvinfo *);
 extern	void degrade_offlined_nodes_reservations(void);
 extern	void degrade_downed_nodes_reservations(void);
@@ -423,6 +453,7 @@ extern 	int	fix_indirectness(resource *, struct pbsnode *, int);
 extern	int	chk_vnode_pool(attribute *, void *, int);
 extern	void	free_pnode(struct pbsnode *);
 extern	int	save_nodes_db(int, void *);
+extern	int	save_nodes_db_list(struct pbsnode **, int);
 extern void	propagate_socket_licensing(mominfo_t *);
 
 extern char *msg_daemonname;
@@ -431,6 +462,10 @@ extern char *msg_daemonname;
 #define	NODE_TOPOLOGY_TYPE_CRAY		"Cray-v1:"
 #define	NODE_TOPOLOGY_TYPE_WIN		"Windows:"
 
+/* hwloc XML saved by MoM in PBS_HOME/mom_priv, and the hardware fingerprint it belongs to */
+#define	MOM_TOPOLOGY_CACHE	"topology.xml"
+#define	MOM_TOPOLOGY_CACHE_FP	"topology.xml.fp"
+
 #define	CRAY_COMPUTE	"cray_compute"	/* vntype for a Cray compute node */
 #define	CRAY_LOGIN	"cray_login"	/* vntype for a Cray login node */
 
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#ifndef _PBS_PWCACHE_H
+#define _PBS_PWCACHE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cache of the passwd and group entries, and of the supplementary group
+ * lists, looked up by the daemons.  Entries are kept for pwcache_ttl
+ * seconds, failed lookups ("no such user/group") for pwcache_neg_ttl
+ * seconds.  When the name service itself fails, a cached entry is still
+ * returned for up to PWCACHE_STALE_FACTOR times its time to live.
+ *
+ * The returned structures belong to the cache and, like the ones of the
+ * C library routines, must not be modified or freed; they stay valid
+ * until the same entry is looked up again after it expired.
+ */
+
+#define PWCACHE_TTL_DFLT	300	/* seconds a found entry is kept */
+#define PWCACHE_NEG_TTL_DFLT	10	/* seconds a missing entry is kept */
+#define PWCACHE_STALE_FACTOR	10	/* entries may be served that many ttls on errors */
+#define PWCACHE_MAX_ENTRIES	8192	/* upper bound on the number of entries */
+
+extern long pwcache_ttl;	/* 0 disables the cache */
+extern long pwcache_neg_ttl;
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <pwd.h>
+#include <grp.h>
+
+extern struct passwd *pbs_getpwnam(const char *name);
+extern struct passwd *pbs_getpwuid(uid_t uid);
+extern struct group *pbs_getgrnam(const char *name);
+extern struct group *pbs_getgrgid(gid_t gid);
+extern gid_t *pbs_getgrouplist(const char *user, gid_t gid, int *ngroups);
+extern void pbs_pwcache_flush(void);
+#else
+#define pbs_getpwnam(n)	getpwnam(n)
+#define pbs_getpwuid(u)	getpwuid(u)
+#define pbs_getgrnam(n)	getgrnam(n)
+#define pbs_getgrgid(g)	getgrgid(g)
+#define pbs_pwcache_flush()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _PBS_PWCACHE_H */
@@ -106,6 +106,9 @@ struct python_script {
 					      * type is PyObject *
 					      */
 	struct stat cur_sbuf;                /* last modification time */
+	char   *code_cache;                  /* if set, file keeping the
+					      * compiled code across runs
+					      */
 };
 
 /**
@@ -258,6 +261,9 @@ extern int get_py_progname(char **);
 #define PY_ATTRIBUTES_HOOK_SET	"_attributes_hook_set"
 /* attributes that got set in */
 /* a hook script */
+#define PY_ATTRIBUTES_LAZY	"_attributes_lazy"
+/* attribute values are loaded */
+/* when first accessed */
 #define PY_READONLY_FLAG	"_readonly"	/* an object is read-only */
 #define PY_RERUNJOB_FLAG	"_rerun"	/* flag some job to rerun */
 #define PY_DELETEJOB_FLAG	"_delete"	/* flag some job to be deleted*/
@@ -378,6 +384,7 @@ extern int get_py_progname(char **);
 #define PY_MARK_VNODE_SET_METHOD "mark_vnode_set"
 #define PY_LOAD_RESOURCE_VALUE_METHOD "load_resource_value"
 #define PY_RESOURCE_STR_VALUE_METHOD "resource_str_value"
+#define PY_LOAD_ATTRIBUTE_VALUE_METHOD "load_attribute_value"
 #define PY_SET_C_MODE_METHOD 	"set_c_mode"
 #define PY_SET_PYTHON_MODE_METHOD "set_python_mode"
 #define PY_STR_TO_VNODE_STATE_METHOD "str_to_vnode_state"
@@ -93,6 +93,11 @@ typedef struct pbs_sched {
 	char sc_name[PBS_MAXSCHEDNAME + 1];			      /* name of sched this sched */
 	struct preempt_ordering preempt_order[PREEMPT_ORDER_MAX + 1]; /* preempt order for this sched */
 	int sc_cycle_started;					      /* indicates whether sched cycle is started or not, 0 - not started, 1 - started */
+	int sc_jobs_stat;					      /* set to 1 once sched queried jobs in a cycle */
+	int sc_am_used;						      /* number of jobs in sc_am_jobs */
+	int sc_am_max;						      /* number of slots in sc_am_jobs */
+	job **sc_am_jobs;					      /* jobs altered or moved during the cycle, see am_jobs_add() */
+	pbs_list_head sc_replyq;				      /* requests on sc_primary_conn answered in order, see hold_sched_reply() */
 	attribute sch_attr[SCHED_ATR_LAST];			      /* sched object's attributes  */
 	short newobj;						      /* is this new sched obj? */
 } pbs_sched;
@@ -102,12 +107,19 @@ extern	pbs_list_head	svr_allscheds;
 extern void set_scheduler_flag(int flag, pbs_sched *psched);
 extern int find_assoc_sched_jid(char *jid, pbs_sched **target_sched);
 extern int find_assoc_sched_pque(pbs_queue *pq, pbs_sched **target_sched);
+struct pbsnode;
+extern pbs_sched *find_assoc_sched_pnode(struct pbsnode *pnode);
+extern void sched_partitions_changed(void);
 extern pbs_sched *find_sched_from_sock(int sock, conn_origin_t which);
 extern pbs_sched *find_sched(char *sched_name);
 extern int validate_job_formula(attribute *pattr, void *pobject, int actmode);
 extern pbs_sched *find_sched_from_partition(char *partition);
 extern int recv_sched_cycle_end(int sock);
-extern void handle_deferred_cycle_close();
+extern void handle_deferred_cycle_close(pbs_sched *psched);
+struct batch_request;
+extern void hold_sched_reply(struct batch_request *preq, int always);
+extern void release_held_replies(int sock);
+extern void drop_held_replies(pbs_sched *psched);
 
 #ifdef	__cplusplus
 }
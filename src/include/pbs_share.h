@@ -51,6 +51,7 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "pbs_ifl.h"
 
 /* Formula special case constants */
@@ -115,6 +116,35 @@ extern "C" {
 #define RUN_WAIT_RUNJOB_HOOK "runjob_hook"
 #define RUN_WAIT_EXECJOB_HOOK "execjob_hook"
 
+/*
+ * Status snapshot written by the server when PBS_STATUS_SNAPSHOT is set, and
+ * read by pbs_statsnap() without going through the server.
+ *
+ * The file holds a struct snapshot_hdr followed by hdr_size - sizeof header
+ * bytes a newer writer may have added, then num_objs objects, each
+ *	objtype, num_attrs (uint32_t), name
+ *	num_attrs times: attribute name, resource, value
+ * Every string is a uint32_t length counting the terminating NUL, then its
+ * bytes.  An empty resource has length 0.  Integers are in host byte order;
+ * the file is only meant for the server host.
+ */
+#define SNAPSHOT_FILENAME	"status_snapshot"
+#define SNAPSHOT_PATH		"server_priv/" SNAPSHOT_FILENAME
+#define SNAPSHOT_MAGIC		"PBSSNAP"
+#define SNAPSHOT_VERSION	1
+
+struct snapshot_hdr {
+	char magic[8];		/* SNAPSHOT_MAGIC */
+	uint32_t version;	/* SNAPSHOT_VERSION */
+	uint32_t hdr_size;	/* bytes up to the first object */
+	uint64_t generation;	/* bumped by every snapshot the server writes */
+	int64_t taken;		/* time the snapshot was taken */
+	uint32_t interval;	/* seconds until the next snapshot */
+	uint32_t num_objs;	/* objects following the header */
+	uint64_t data_len;	/* bytes of objects following the header */
+	char server[PBS_MAXSERVERNAME + 1]; /* name of the server */
+};
+
 struct preempt_ordering
 {
 	unsigned high_range;            /* high end of the walltime range */
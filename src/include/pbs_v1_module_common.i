@@ -118,7 +118,6 @@ pbs_list_head svr_execjob_postsuspend_hooks;
 pbs_list_head svr_execjob_preresume_hooks;
 
 pbs_list_head task_list_immed;
-pbs_list_head task_list_timed;
 pbs_list_head task_list_event;
 
 char *path_hooks = NULL;
@@ -223,6 +222,11 @@ find_arrayparent(char *subjobid) {
 	return NULL;
 }
 
+int
+histjob_expand(job *pjob) {
+	return (0);
+}
+
 int
 ck_chkpnt(attribute *pattr, void *pobject, int mode) {
 	return (0);
@@ -713,6 +717,11 @@ int
 validate_job_formula(attribute *pattr, void *pobject, int actmode) {
 	return (PBSE_NONE);
 }
+
+int
+action_auth_session_lifetime(attribute *pattr, void *pobject, int actmode) {
+	return (PBSE_NONE);
+}
 #endif /* defined(PBS_V1_COMMON_MODULE_DEFINE_STUB_FUNCS) */
 
 #endif /* defined(PBS_v1_COMMON_I_INCLUDED) */
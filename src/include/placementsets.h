@@ -119,6 +119,7 @@ typedef struct vnode_list {
 
 typedef struct vnode_attrlist {
 	char		*vnal_id;	/* unique ID for this vnode */
+	void		*vnal_ix;	/* attribute name index, see attr2vnr() */
 	dl_t		vnal_dl;	/* current state of vna_t list */
 #define	vnal_nelem	vnal_dl.dl_nelem
 #define	vnal_used	vnal_dl.dl_used
@@ -198,6 +199,12 @@ extern int	vn_addvnr(vnl_t *, char *, char *, char *, int, int, callfunc_t);
  */
 extern char *	attr_exist(vnal_t *, char *);
 
+/**
+ * @return	vna_t	pointer to the name/value pair of an attribute in a vnal_t
+ * @retval	NULL	attribute does not exist
+ */
+extern vna_t *	attr2vnr(vnal_t *, char *);
+
 /**
  * @return	vnal_t	pointer to vnode
  * @retval	NULL	node does not exist
@@ -44,8 +44,10 @@ extern "C" {
 #endif
 
 /*Defines used by port_forwarding.c*/
-/* Max size of buffer to store data*/
-#define PF_BUF_SIZE 8192
+/* Max size of buffer to store data. Large enough to carry bulk X11 and
+ terminal output in few system calls; the NUM_SOCKS buffers are calloc'ed,
+ so the pages of unused ones are never touched. */
+#define PF_BUF_SIZE 65536
 
 /* Limits the number of simultaneous X applications that a single job
  can run in the background to 24 . 1 socket fd is used for storing
@@ -142,6 +142,8 @@ struct objname
 
 /* prototypes */
 struct objname *commalist2objname(char *, int);
+struct objname *node_selector2objname(char *);
+struct objname *node_list_objname(struct objname *);
 struct server *find_server(char *);
 struct server *make_connection();
 struct server *new_server();
@@ -349,7 +351,9 @@ void disconnect_from_server(struct server *);
 "Examples:\n" \
 "batch     - An object called batch\n" \
 "batch@s1  - An object called batch at the server s1\n" \
-"@s1       - All the objects of a cirtain type at the server s1\n"
+"@s1       - All the objects of a cirtain type at the server s1\n" \
+"For set and unset node, the vnodes can also be chosen by one attribute:\n" \
+"@[resources_available.host=h1] - All the vnodes whose attribute has the value\n"
 
 #define HELP_ATTRIBUTE \
 "The help for attributes are broken up into the following help subtopics:\n" \
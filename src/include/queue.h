@@ -83,6 +83,13 @@ struct pbs_queue {
 	int qu_numjobs;			 /* current numb jobs in queue */
 	int qu_njstate[PBS_NUMJOBSTATE]; /* # of jobs per state */
 	char qu_jobstbuf[150];
+	u_Long qu_modseq;		 /* modify_seq of the last change seen by a stat */
+	struct pbs_sched *qu_sched;	 /* scheduler of the queue's partition, see find_assoc_sched_pque() */
+	long qu_sched_gen;		 /* generation of the schedulers qu_sched was found in */
+	long qu_route_gen;		 /* routing generation of the last pass of queue_route() */
+	time_t qu_route_next;		 /* when queue_route() has to look at the queue again */
+	long *qu_route_destgen;		 /* per destination, routing generation it rejected all jobs at */
+	int qu_route_ndest;		 /* number of slots in qu_route_destgen */
 
 	/* the queue attributes */
 
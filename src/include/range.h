@@ -53,14 +53,13 @@ enum range_step_type {
 	ENABLE_SUBRANGE_STEPPING
 };
 
-typedef struct range
-{
-	int start;
-	int end;
-	int step;
-	int count;
-	struct range *next;
-} range;
+/*
+ * A range is a set of non-negative subjob indices.  It is kept as a
+ * compressed bitset: the values are split by their high 16 bits into
+ * containers which hold the low 16 bits as a sorted array, a bitmap or a
+ * list of runs, whichever is smaller.  The layout is private to range.c.
+ */
+typedef struct range range;
 
 /* Error message when we fail to allocate memory */
 #define RANGE_MEM_ERR_MSG "Unable to allocate memory (malloc error)"
@@ -68,28 +67,27 @@ typedef struct range
 #define INIT_RANGE_ARR_SIZE 2048
 
 /*
- *	new_range - allocate and initialize a range structure
+ *	new_range - allocate an empty range printed with the given step
  */
-
-range *new_range(int start, int end, int step, int count, range *next);
+range *new_range(int step);
 
 /*
- *	free_range_list - free a list of ranges
+ *	free_range_list - free a range
  */
 void free_range_list(range *r);
 
 /*
- *	free_range - free a range structure
+ *	free_range - free a range
  */
 void free_range(range *r);
 
 /*
- *	dup_range_list - duplicate a range list
+ *	dup_range_list - duplicate a range
  */
 range *dup_range_list(range *old_r);
 
 /*
- *	dup_range - duplicate a range structure
+ *	dup_range - duplicate a range
  */
 range *dup_range(range *old_r);
 
@@ -113,19 +111,23 @@ int range_next_value(range *r, int cur_value);
 int range_contains(range *r, int val);
 
 /*
- *	range_contains_single - is a value contained in a single range
- *				  structure
+ *	range_count - number of values in a range
+ */
+int range_count(range *r);
+
+/*
+ *	range_rank - number of values in a range smaller than a value
  */
-int range_contains_single(range *r, int val);
+int range_rank(range *r, int val);
 
 /*
- *	range_remove_value - remove a value from a range list
+ *	range_remove_value - remove a value from a range
  *
  */
 int range_remove_value(range **r, int val);
 
 /*
- *	range_add_value - add a value to a range list 
+ *	range_add_value - add a value to a range
  *
  */
 int range_add_value(range **r, int val, int range_step);
@@ -232,6 +232,7 @@ struct resc_resv {
 	 */
 	attribute		ri_wattr[RESV_ATR_LAST];  /*reservation's attributes*/
 	short			newobj;
+	u_Long			ri_modseq;	/* modify_seq of the last change seen by a stat */
 };
 
 /*
@@ -107,8 +107,31 @@ typedef struct resource_def {
 	unsigned int rs_entlimflg;	  /* tracking entity limits for this  */
 	struct resource_def *rs_next;
 	unsigned int rs_custom; /* bit flag to indicate custom resource or builtin */
+	int rs_index;		/* custom resources: slot in a resc_lookup */
 } resource_def;
 
+/*
+ * resc_lookup - a table addressed by resource definition index which maps
+ * a resource_def to its entry in one resource list attribute.  It lets the
+ * loops which match every entry of one list against another (limits,
+ * defaults, resources_assigned) find each entry in constant time rather
+ * than by walking the list.  Built-in resources are indexed by their
+ * position in svr_resc_def, custom ones by rs_index.  Entries are stamped
+ * with a generation so reloading the table does not need to clear it.
+ */
+typedef struct resc_lookup_ent {
+	unsigned int rle_gen;
+	resource    *rle_resc;
+} resc_lookup_ent;
+
+typedef struct resc_lookup {
+	resc_lookup_ent	*rl_ent;
+	int		 rl_size;
+	unsigned int	 rl_gen;
+	const attribute	*rl_attr;	/* list the table was loaded from */
+	int		 rl_linear;	/* table unusable, walk rl_attr */
+} resc_lookup;
+
 struct resc_sum {
 	struct resource_def *rs_def; /* ptr to this resources's def   */
 	struct resource *rs_prs;     /* ptr resource in Resource_List */
@@ -133,6 +156,11 @@ extern resource *add_resource_entry(attribute *, resource_def *);
 extern int cr_rescdef_idx(resource_def *resc_def, int limit);
 extern resource_def *find_resc_def(resource_def *, char *);
 extern resource *find_resc_entry(const attribute *, resource_def *);
+extern void resc_lookup_load(resc_lookup *, const attribute *);
+extern resource *resc_lookup_find(resc_lookup *, resource_def *);
+extern void resc_lookup_note(resc_lookup *, resource *);
+extern void resc_lookup_free(resc_lookup *);
+extern int resc_def_index(resource_def *);
 extern int update_resource_def_file(char *name, resdef_op_t op, int type, int perms);
 extern int add_resource_def(char *name, int type, int perms);
 extern int restart_python_interpreter(const char *);
@@ -47,6 +47,7 @@ extern "C" {
  * misc server function prototypes
  */
 
+#include <sys/time.h>
 #include "net_connect.h"
 #include "pbs_db.h"
 #include "reservation.h"
@@ -69,6 +70,7 @@ extern int check_num_cpus(void);
 extern int chk_hold_priv(long, int);
 extern void close_client(int);
 extern void scheduler_close(int);
+extern void route_changed(void);
 extern int send_sched_cmd(pbs_sched *, int, char *);
 extern void count_node_cpus(void);
 extern int ctcpus(char *, int *);
@@ -88,6 +90,7 @@ extern void save_setup(int);
 extern int save_struct(char *, unsigned int);
 extern int schedule_jobs(pbs_sched *);
 extern int schedule_high(pbs_sched *);
+extern int has_unsent_qrun(pbs_sched *);
 extern void shutdown_nodes(void);
 extern char *site_map_user(char *, char *);
 extern char *site_map_resvuser(char *, char *);
@@ -140,11 +143,17 @@ extern void reply_preempt_jobs_request(int, int, struct job *);
 extern int copy_params_from_job(char *, resc_resv *);
 extern int confirm_resv_locally(resc_resv *, struct batch_request *, char *);
 extern int set_select_and_place(int, void *, attribute *);
+extern int dup_svrattrl(pbs_list_head *, svrattrl *);
 extern int make_schedselect(attribute *, resource *, pbs_queue *, attribute *);
 extern long long get_next_svr_sequence_id(void);
 extern int compare_obj_hash(void *, int , void *);
 extern void panic_stop_db();
 extern void free_db_attr_list(pbs_db_attr_list_t *);
+extern void standby_refresh(time_t);
+extern int standby_recover_jobs(void *, pbs_db_obj_info_t *, query_cb_t);
+extern void standby_free(void);
+extern void snapshot_status(struct work_task *);
+extern void snapshot_remove(void);
 
 #ifdef _PROVISION_H
 extern int find_prov_vnode_list(job *, exec_vnode_listtype *, char **);
@@ -163,6 +172,7 @@ extern void tfree2(struct tree **);
 #ifdef _RESOURCE_H
 extern int fix_indirect_resc_targets(struct pbsnode *, resource *, int, int);
 #endif /* _RESOURCE_H */
+extern void svr_event_node(struct pbsnode *);
 #endif /* _PBS_NODES_H */
 
 #ifdef _PBS_JOB_H
@@ -179,19 +189,44 @@ extern void job_purge(job *);
 extern void check_block(job *, char *);
 extern void free_nodes(job *);
 extern int job_route(job *);
+extern void route_wakeup(job *);
 extern void rel_resc(job *);
 extern void remove_stagein(job *);
 extern size_t check_for_cred(job *, char **);
 extern void svr_mailowner(job *, int, int, char *);
 extern void svr_mailowner_id(char *, job *, int, int, char *);
+extern int svr_mail_helper_start(void);
+
+/* latencies kept by svr_stats.c besides those of requests and work tasks */
+enum svr_stat_kind {
+	SVR_STAT_LOOP,		/* main loop pass, less the wait for requests */
+	SVR_STAT_POLL,		/* waiting for requests */
+	SVR_STAT_DB,		/* database round trip */
+	SVR_STAT_HOOK,		/* server hook run */
+	SVR_STAT_KINDS
+};
+extern void svr_stats_init(void);
+extern void svr_stats_record(enum svr_stat_kind, double);
+extern void svr_stats_request(int, struct timeval *);
+extern double svr_stats_busy(void);
+extern double svr_stats_elapsed(struct timeval *);
+extern char *svr_stats_as_string(void);
+extern char *svr_mem_as_string(void);
+extern void svr_stats_write_file(void);
 extern char *lastname(char *);
 extern void chk_array_doneness(job *);
 extern void update_array_indices_remaining_attr(job *);
 extern job *create_subjob(job *, char *, int *);
+extern void subjob_tmpl_begin(job *);
+extern void subjob_tmpl_end(job *);
 extern char *cvt_range(job *, char);
 extern job *find_arrayparent(char *);
 extern char get_subjob_state(job *, int);
 extern int get_subjob_discarding(job *, int);
+extern job *get_subjob_ptr(job *, int);
+extern void set_subjob_ptr(job *, int, job *);
+extern int get_subjob_substate(job *, int);
+extern void set_subjob_substate(job *, int, int);
 extern char *mk_subjob_id(job *, int);
 extern void set_subjob_tblstate(job *, int, char);
 extern void update_subjob_state(job *, char);
@@ -200,12 +235,13 @@ extern char *subst_array_index(job *, char *);
 extern int numindex_to_offset(job *, int);
 extern int subjob_index_to_offset(job *, char *);
 #ifndef PBS_MOM
+extern void svr_event_job(job *);
 extern void svr_setjob_histinfo(job *, histjob_type);
 extern void svr_histjob_update(job *, char, int);
 extern char *form_attr_comment(const char *, const char *);
 extern void complete_running(job *);
 extern void am_jobs_add(job *);
-extern int was_job_alteredmoved(job *);
+extern int was_job_alteredmoved(pbs_sched *, job *);
 extern void check_failed_attempts(job *);
 #endif
 #ifdef _QUEUE_H
@@ -219,6 +255,7 @@ extern int set_entity_resc_sum_max(job *, pbs_queue *, attribute *, enum batch_o
 extern int set_entity_resc_sum_queued(job *, pbs_queue *, attribute *, enum batch_op);
 extern int account_entity_limit_usages(job *, pbs_queue *, attribute *, enum batch_op, int);
 extern void eval_chkpnt(job *pjob, attribute *queckp);
+extern void status_que_counts(pbs_queue *);
 #endif /* _QUEUE_H */
 
 #ifdef _BATCH_REQUEST_H
@@ -227,6 +264,7 @@ extern int svr_authorize_jobreq(struct batch_request *, job *);
 extern void dup_br_for_subjob(struct batch_request *, job *, void (*)(struct batch_request *, job *));
 extern void set_old_nodes(job *);
 extern int send_job_exec_update_to_mom(job *, char *, int, struct batch_request *);
+extern void reply_job_exec_update_reqs(job *, int, int, char *);
 extern int free_sister_vnodes(job *, char *, char *, char *, int, struct batch_request *);
 #ifdef _WORK_TASK_H
 extern int send_job(job *, pbs_net_t, int, int, void (*)(struct work_task *), struct batch_request *);
@@ -263,6 +301,7 @@ extern void req_messagejob(struct batch_request *);
 extern void req_py_spawn(struct batch_request *);
 extern void req_relnodesjob(struct batch_request *);
 extern void req_modifyjob(struct batch_request *);
+extern void req_modifyjoblist(struct batch_request *);
 extern void req_modifyReservation(struct batch_request *);
 extern void req_orderjob(struct batch_request *);
 extern void req_rescreserve(struct batch_request *);
@@ -292,6 +331,8 @@ extern int   deflt_chunk_action(attribute *pattr, void *pobj, int mode);
 extern int   action_svr_iteration(attribute *pattr, void *pobj, int mode);
 extern void  update_node_rassn(attribute *, enum batch_op);
 extern void  update_job_node_rassn(job *, attribute *, enum batch_op);
+extern struct job_alloc *job_alloc_get(job *, char *);
+extern void  job_alloc_free(job *);
 extern int   cvt_nodespec_to_select(char *, char **, size_t *, attribute *);
 extern int   is_valid_resource(attribute *pattr, void *pobject, int actmode);
 extern int   queuestart_action(attribute *pattr, void *pobject, int actmode);
@@ -334,6 +375,7 @@ extern int issue_Drequest(int, struct batch_request *, void (*)(), struct work_t
 #ifdef _RESERVATION_H
 extern void is_resv_window_in_future(resc_resv *);
 extern void resv_setResvState(resc_resv *, int, int);
+extern void svr_event_resv(resc_resv *);
 extern void is_resv_window_in_future(resc_resv *);
 extern int gen_task_EndResvWindow(resc_resv *);
 extern int gen_future_deleteResv(resc_resv *, long);
@@ -368,6 +410,7 @@ struct deferred_request {
 	char dr_id[PBS_MAXSVRJOBID + 1];
 	struct batch_request *dr_preq;
 	int dr_sent; /* sent to Scheduler */
+	pbs_sched *dr_sched; /* Scheduler it was sent to */
 };
 
 #endif /* _LIST_LINK_H */
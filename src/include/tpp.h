@@ -107,6 +107,10 @@ extern "C" {
 #define TPP_ROUTER_NODE         3  /* router */
 #define TPP_AUTH_NODE           4  /* authenticated, but yet unknown node type till a join happens */
 
+/* codecs used to compress data, selected by PBS_USE_COMPRESSION */
+#define TPP_CODEC_ZLIB          1
+#define TPP_CODEC_LZ4           2
+
 extern	int	tpp_fd;
 extern	int	rpp_retry;
 extern	int	rpp_highwater;
@@ -116,6 +120,8 @@ struct tpp_config {
 	int    numthreads;
 	char   *node_name; /* list of comma separated node names */
 	int    compress;
+	int    compress_codec; /* TPP_CODEC_* used to compress outgoing data */
+	int    coalesce_delay; /* ms a small message may wait to be sent along with others */
 	int    tcp_keepalive; /* use keepalive? */
 	int    tcp_keep_idle;
 	int    tcp_keep_intvl;
@@ -88,6 +88,8 @@ struct work_task  {
 	void		*wt_parm3;	/* used to store reply for deferred cmds TPP */
 	int		 wt_aux;	/* optional info: e.g. child status */
 	int		 wt_aux2;	/* optional info 2: e.g. *real* child pid (windows), tpp msgid etc */
+	pbs_list_link	 wt_linkparm1;	/* link to others with the same wt_parm1 */
+	int		 wt_heap_ind;	/* index in the timed task heap, -1 if not in it */
 };
 
 extern struct work_task *set_task(enum work_type, long event, void (*func)(), void *param);
@@ -96,7 +98,9 @@ extern void dispatch_task(struct work_task *);
 extern void delete_task(struct work_task *);
 extern void delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wtask_delete_option option);
 extern int  has_task_by_parm1(void *parm1);
+extern struct work_task *find_task_by_parm1(void *parm1, enum work_type type);
 extern time_t default_next_task(void);
+extern void (*pfn_task_dispatched)(void (*)(struct work_task *), double);
 
 #ifdef	__cplusplus
 }
@@ -54,6 +54,7 @@
 #include "list_link.h"
 #include "attribute.h"
 #include "pbs_error.h"
+#include "pbs_pwcache.h"
 
 
 /**
@@ -698,28 +699,22 @@ gacl_match(const char *can, const char *master)
 	int i, ng = 0;
 	struct passwd *pw;
 	struct group *gr;
-	gid_t *groups = NULL;
+	gid_t *groups;
 
-	if ((pw = getpwnam(can)) == NULL)
+	if ((pw = pbs_getpwnam(can)) == NULL)
 		return(1);
 
-	if (getgrouplist(can, pw->pw_gid, NULL, &ng) < 0) {
-		if ((groups = (gid_t *) malloc(ng * sizeof (gid_t))) == NULL)
-			return(1);
-		getgrouplist(can, pw->pw_gid, groups, &ng);
-	}
+	/* the list belongs to the cache, do not free it */
+	if ((groups = pbs_getgrouplist(can, pw->pw_gid, &ng)) == NULL)
+		return(1);
 
 	for (i = 0; i < ng; i++) {
-		if ((gr = getgrgid(groups[i])) != NULL) {
-			if (!strcmp(gr->gr_name, master)) {
-				free(groups);
+		if ((gr = pbs_getgrgid(groups[i])) != NULL) {
+			if (!strcmp(gr->gr_name, master))
 				return (0);
-			}
 		}
 	}
 
-	free(groups);
-
 	return (1);
 #endif
 }
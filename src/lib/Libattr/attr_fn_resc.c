@@ -53,7 +53,6 @@
 #include "attribute.h"
 #include "resource.h"
 #include "pbs_error.h"
-#include "pbs_idx.h"
 
 
 /**
@@ -386,6 +385,7 @@ comp_resc(struct attribute *attr, struct attribute *with)
 	resource *atresc;
 	resource *wiresc;
 	int rc;
+	static resc_lookup atlk;
 
 	comp_resc_gt = 0;
 	comp_resc_eq = 0;
@@ -395,10 +395,11 @@ comp_resc(struct attribute *attr, struct attribute *with)
 	if ((attr == NULL) || (with == NULL))
 		return (-1);
 
+	resc_lookup_load(&atlk, attr);
 	wiresc = (resource *)GET_NEXT(with->at_val.at_list);
 	while (wiresc != NULL) {
 		if (wiresc->rs_value.at_flags & ATR_VFLAG_SET) {
-			atresc = find_resc_entry(attr, wiresc->rs_defin);
+			atresc = resc_lookup_find(&atlk, wiresc->rs_defin);
 			if (atresc != NULL) {
 				if (atresc->rs_value.at_flags & ATR_VFLAG_SET) {
 					if ((rc=atresc->rs_defin->rs_comp(&atresc->rs_value, 				      &wiresc->rs_value)) > 0)
@@ -472,14 +473,14 @@ cr_rescdef_idx(resource_def *resc_def, int limit)
 	if (!resc_def)
 		return -1;
 
-	/* create the attribute index */
-	if ((resc_attrdef_idx = pbs_idx_create(PBS_IDX_ICASE_CMP, 0)) == NULL)
+	/* create the resource index, custom resources are added to it later */
+	if ((resc_attrdef_idx = def_hash_create(limit)) == NULL)
 		return -1;
 
-	/* add all attributes to the tree with key as the attr name */
+	/* add all resources to the table with key as the resource name */
 	for (i = 0; i < limit; i++) {
 		if (strcmp(resc_def->rs_name, RESC_NOOP_DEF) != 0) {
-			if (pbs_idx_insert(resc_attrdef_idx, resc_def->rs_name, resc_def) != PBS_IDX_RET_OK)
+			if (def_hash_insert(resc_attrdef_idx, resc_def->rs_name, resc_def) != 0)
 				return -1;
 		}
 		resc_def++;
@@ -502,12 +503,7 @@ cr_rescdef_idx(resource_def *resc_def, int limit)
 resource_def *
 find_resc_def(resource_def *resc_def, char *name)
 {
-	resource_def *found_def = NULL, *def = NULL;
-
-	if (pbs_idx_find(resc_attrdef_idx, (void **) &name, (void **)&found_def, NULL) == PBS_IDX_RET_OK)
-		def = &resc_def[found_def - resc_def];
-		
-	return def;
+	return (resource_def *)def_hash_find(resc_attrdef_idx, name);
 }
 
 /**
@@ -538,6 +534,146 @@ find_resc_entry(const attribute *pattr, resource_def *rscdf)
 	return (pr);
 }
 
+/**
+ * @brief
+ * 	resc_def_index - return the resc_lookup slot of a resource definition
+ *
+ * @param[in] prdef - pointer to resource_def structure
+ *
+ * @return	int
+ * @retval	>=0	slot index
+ * @retval	-1	definition is not part of svr_resc_def
+ *
+ */
+int
+resc_def_index(resource_def *prdef)
+{
+	if (prdef->rs_custom)
+		return (prdef->rs_index);
+	if ((prdef >= svr_resc_def) && (prdef < svr_resc_def + RESC_LAST))
+		return (int)(prdef - svr_resc_def);
+	return (-1);
+}
+
+/**
+ * @brief
+ * 	resc_lookup_note - record one resource entry in a lookup table,
+ *	used after add_resource_entry() so the table keeps matching its list
+ *
+ * @param[in,out] plk - lookup table
+ * @param[in] presc - entry of the list the table was loaded from
+ *
+ */
+void
+resc_lookup_note(resc_lookup *plk, resource *presc)
+{
+	int idx;
+	int newsz;
+	resc_lookup_ent *pent;
+
+	if (plk->rl_linear)
+		return;
+	idx = resc_def_index(presc->rs_defin);
+	if (idx < 0) {
+		plk->rl_linear = 1;
+		return;
+	}
+	if (idx >= plk->rl_size) {
+		newsz = (idx < RESC_LAST) ? RESC_LAST : idx + 16;
+		pent = realloc(plk->rl_ent, newsz * sizeof(resc_lookup_ent));
+		if (pent == NULL) {
+			plk->rl_linear = 1;
+			return;
+		}
+		memset(pent + plk->rl_size, 0, (newsz - plk->rl_size) * sizeof(resc_lookup_ent));
+		plk->rl_ent = pent;
+		plk->rl_size = newsz;
+	}
+	pent = &plk->rl_ent[idx];
+	if (pent->rle_gen != plk->rl_gen) {
+		/* the first entry wins, as it does in find_resc_entry() */
+		pent->rle_gen = plk->rl_gen;
+		pent->rle_resc = presc;
+	}
+}
+
+/**
+ * @brief
+ * 	resc_lookup_load - (re)load a lookup table from a resource list
+ *
+ * @par
+ *	The table is valid until the list gains or loses entries by any other
+ *	means than add_resource_entry() followed by resc_lookup_note().  It is
+ *	meant to be loaded for the duration of one matching loop.
+ *	If memory runs out, lookups quietly fall back to find_resc_entry().
+ *
+ * @param[in,out] plk - lookup table, zero initialized before first use
+ * @param[in] pattr - resource list attribute
+ *
+ */
+void
+resc_lookup_load(resc_lookup *plk, const attribute *pattr)
+{
+	resource *pr;
+
+	plk->rl_attr = pattr;
+	plk->rl_linear = 0;
+	if (++plk->rl_gen == 0) {
+		/* stamps wrapped, old ones could match again */
+		if (plk->rl_ent != NULL)
+			memset(plk->rl_ent, 0, plk->rl_size * sizeof(resc_lookup_ent));
+		plk->rl_gen = 1;
+	}
+	for (pr = (resource *)GET_NEXT(pattr->at_val.at_list); pr != NULL;
+		pr = (resource *)GET_NEXT(pr->rs_link)) {
+		resc_lookup_note(plk, pr);
+		if (plk->rl_linear)
+			break;
+	}
+}
+
+/**
+ * @brief
+ * 	resc_lookup_find - find the entry for a resource definition through
+ *	a table loaded by resc_lookup_load()
+ *
+ * @param[in] plk - lookup table
+ * @param[in] prdef - pointer to resource_def structure
+ *
+ * @return	structure handler
+ * @retval	pointer to struct resource 	Success
+ * @retval	NULL				not in the list
+ *
+ */
+resource *
+resc_lookup_find(resc_lookup *plk, resource_def *prdef)
+{
+	int idx;
+
+	if (plk->rl_linear)
+		return (find_resc_entry(plk->rl_attr, prdef));
+	idx = resc_def_index(prdef);
+	if (idx < 0)
+		return (find_resc_entry(plk->rl_attr, prdef));
+	if ((idx >= plk->rl_size) || (plk->rl_ent[idx].rle_gen != plk->rl_gen))
+		return (NULL);
+	return (plk->rl_ent[idx].rle_resc);
+}
+
+/**
+ * @brief
+ * 	resc_lookup_free - release the memory of a lookup table
+ *
+ * @param[in,out] plk - lookup table
+ *
+ */
+void
+resc_lookup_free(resc_lookup *plk)
+{
+	free(plk->rl_ent);
+	memset(plk, 0, sizeof(resc_lookup));
+}
+
 /**
  * @brief
  * 	add_resource_entry - add and "unset" entry for a resource type to a
@@ -159,7 +159,7 @@ encode_str(const attribute *attr, pbs_list_head *phead, char *atname, char *rsna
 		*rtnl = pal;
 
 	if ((phead == NULL) && (rtnl == NULL))
-		free(pal);
+		attrlist_free(pal);
 
 	return (1);
 }
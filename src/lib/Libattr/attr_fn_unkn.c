@@ -52,6 +52,7 @@
 #include "attribute.h"
 #include "resource.h"
 #include "pbs_error.h"
+#include "mem_acct.h"
 
 
 /**
@@ -181,6 +182,7 @@ encode_unkn(const attribute *attr, pbs_list_head *phead, char *atname, char *rsn
 		pnew = (svrattrl *)malloc(plist->al_tsize);
 		if (pnew == NULL)
 			return (-1);
+		mem_acct_add(MEM_ACCT_SVRATTRL, 1, plist->al_tsize);
 		CLEAR_LINK(pnew->al_link);
 		pnew->al_sister = NULL;
 		pnew->al_tsize  = plist->al_tsize;
@@ -305,7 +307,7 @@ free_unkn(attribute *pattr)
 		while ((plist = (svrattrl *)GET_NEXT(pattr->at_val.at_list)) !=
 			NULL) {
 			delete_link(&plist->al_link);
-			(void)free(plist);
+			attrlist_free(plist);
 		}
 	}
 	free_null(pattr);
@@ -52,9 +52,9 @@
 #include "attribute.h"
 #include "pbs_error.h"
 #include "libpbs.h"
-#include "pbs_idx.h"
 #include "pbs_entlim.h"
 #include "job.h"
+#include "mem_acct.h"
 
 /**
  *
@@ -90,6 +90,213 @@ clear_attr(attribute *pattr, struct attribute_def *pdef)
 		CLEAR_HEAD(pattr->at_val.at_list);
 }
 
+/*
+ * Name lookup of attribute and resource definitions
+ *
+ * The definitions are looked up by name for every attribute and resource
+ * of every request decoded, so the index is a hash table rather than a
+ * tree: open addressing with linear probing, kept at most a quarter full,
+ * so a lookup is one hash of the name and one compare in nearly all cases.
+ * Names compare without regard to case, as they always have.
+ */
+typedef struct def_hash_slot {
+	unsigned int dh_hash;	/* hash of dh_name */
+	char *dh_name;		/* name of the definition, NULL if empty */
+	void *dh_def;		/* the definition */
+} def_hash_slot;
+
+typedef struct def_hash {
+	unsigned int dh_size;	/* number of slots, a power of two */
+	unsigned int dh_used;	/* slots in use, deleted ones included */
+	def_hash_slot *dh_slots;
+} def_hash;
+
+static char def_hash_deleted[] = "";	/* name of a deleted slot */
+
+/**
+ * @brief
+ * 	Case insensitive FNV-1a hash of a definition name
+ *
+ * @param[in] name - the name
+ *
+ * @return	unsigned int - the hash
+ */
+static unsigned int
+def_hash_name(char *name)
+{
+	unsigned int h = 2166136261U;
+
+	while (*name) {
+		h ^= (unsigned char)tolower((unsigned char)*name++);
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/**
+ * @brief
+ * 	Find the slot of a name, or the empty slot where it would go
+ *
+ * @param[in] dh - the hash table
+ * @param[in] name - the name
+ * @param[in] h - hash of the name
+ *
+ * @return	def_hash_slot *
+ */
+static def_hash_slot *
+def_hash_slot_of(def_hash *dh, char *name, unsigned int h)
+{
+	unsigned int mask = dh->dh_size - 1;
+	unsigned int i;
+	def_hash_slot *ps;
+
+	for (i = h & mask; ; i = (i + 1) & mask) {
+		ps = &dh->dh_slots[i];
+		if (ps->dh_name == NULL)
+			return ps;
+		if ((ps->dh_hash == h) && (ps->dh_name != def_hash_deleted) &&
+			(strcasecmp(ps->dh_name, name) == 0))
+			return ps;
+	}
+}
+
+/**
+ * @brief
+ * 	Create an empty definition hash table
+ *
+ * @param[in] count - number of definitions expected
+ *
+ * @return	void *
+ * @retval	NULL	Failure
+ * @retval	!NULL	the table
+ */
+void *
+def_hash_create(int count)
+{
+	def_hash *dh;
+	unsigned int size = 16;
+
+	while (size < (unsigned int)count * 4)
+		size <<= 1;
+
+	if ((dh = malloc(sizeof(def_hash))) == NULL)
+		return NULL;
+	if ((dh->dh_slots = calloc(size, sizeof(def_hash_slot))) == NULL) {
+		free(dh);
+		return NULL;
+	}
+	dh->dh_size = size;
+	dh->dh_used = 0;
+	return dh;
+}
+
+/**
+ * @brief
+ * 	Add a definition to a definition hash table
+ *
+ * @param[in] idx - the table
+ * @param[in] name - name of the definition, must live as long as the entry
+ * @param[in] def - the definition
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	the name is already there, or out of memory
+ */
+int
+def_hash_insert(void *idx, char *name, void *def)
+{
+	def_hash *dh = idx;
+	def_hash_slot *ps;
+	def_hash_slot *old;
+	unsigned int h;
+	unsigned int i;
+	unsigned int oldsize;
+
+	if ((dh == NULL) || (name == NULL))
+		return -1;
+
+	h = def_hash_name(name);
+	if (def_hash_slot_of(dh, name, h)->dh_name != NULL)
+		return -1;
+
+	/* grow, which also drops the deleted slots, to stay a quarter full */
+	if ((dh->dh_used + 1) * 4 > dh->dh_size) {
+		old = dh->dh_slots;
+		oldsize = dh->dh_size;
+		if ((dh->dh_slots = calloc(oldsize * 2, sizeof(def_hash_slot))) == NULL) {
+			dh->dh_slots = old;
+			return -1;
+		}
+		dh->dh_size = oldsize * 2;
+		dh->dh_used = 0;
+		for (i = 0; i < oldsize; i++) {
+			if ((old[i].dh_name == NULL) || (old[i].dh_name == def_hash_deleted))
+				continue;
+			*def_hash_slot_of(dh, old[i].dh_name, old[i].dh_hash) = old[i];
+			dh->dh_used++;
+		}
+		free(old);
+	}
+
+	ps = def_hash_slot_of(dh, name, h);
+	ps->dh_hash = h;
+	ps->dh_name = name;
+	ps->dh_def = def;
+	dh->dh_used++;
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Remove a definition from a definition hash table
+ *
+ * @param[in] idx - the table
+ * @param[in] name - name of the definition
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	the name was not there
+ */
+int
+def_hash_delete(void *idx, char *name)
+{
+	def_hash *dh = idx;
+	def_hash_slot *ps;
+
+	if ((dh == NULL) || (name == NULL))
+		return -1;
+
+	ps = def_hash_slot_of(dh, name, def_hash_name(name));
+	if (ps->dh_name == NULL)
+		return -1;
+	/* keep the slot occupied so that the probe sequences through it hold */
+	ps->dh_name = def_hash_deleted;
+	ps->dh_def = NULL;
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Look up a definition by name in a definition hash table
+ *
+ * @param[in] idx - the table
+ * @param[in] name - name of the definition
+ *
+ * @return	void *
+ * @retval	the definition
+ * @retval	NULL	not found
+ */
+void *
+def_hash_find(void *idx, char *name)
+{
+	def_hash *dh = idx;
+
+	if ((dh == NULL) || (name == NULL))
+		return NULL;
+
+	return def_hash_slot_of(dh, name, def_hash_name(name))->dh_def;
+}
+
 /**
  * @brief
  * 	Create the search index for the provided attribute def array
@@ -112,14 +319,14 @@ cr_attrdef_idx(struct attribute_def *adef, int limit)
 		return NULL;
 
 	/* create the attribute index */
-	if ((attrdef_idx = pbs_idx_create(PBS_IDX_ICASE_CMP, 0)) == NULL)
+	if ((attrdef_idx = def_hash_create(limit)) == NULL)
 		return NULL;
 
-	/* add all attributes to the tree with key as the attr name */
+	/* add all attributes to the table with key as the attr name */
 	for (i = 0; i < limit; i++) {
-		if (pbs_idx_insert(attrdef_idx, adef->at_name, adef) != PBS_IDX_RET_OK)
+		if (def_hash_insert(attrdef_idx, adef->at_name, adef) != 0)
 			return NULL;
-		
+
 		adef++;
 	}
 	return attrdef_idx;
@@ -145,18 +352,18 @@ cr_attrdef_idx(struct attribute_def *adef, int limit)
 int
 find_attr(void *attrdef_idx, struct attribute_def *attr_def, char *name)
 {
-	int index = -1;
-	struct attribute_def *found_def = NULL;
+	struct attribute_def *found_def;
 
-	if (pbs_idx_find(attrdef_idx, (void **) &name, (void **)&found_def, NULL) == PBS_IDX_RET_OK)
-		index = (found_def - attr_def);
-		
-	return index;
+	if ((found_def = def_hash_find(attrdef_idx, name)) == NULL)
+		return -1;
+
+	return (found_def - attr_def);
 }
 
 /**
  * @brief
  * 	free_svrcache - free the cached svrattrl entries associated with an attribute
+ *	Dropping an encoding marks the attribute as changed for modify_seq.
  *
  * @param[in] attr - pointer to attribute structure
  *
@@ -170,6 +377,9 @@ free_svrcache(struct attribute *attr)
 	struct svrattrl *working;
 	struct svrattrl *sister;
 
+	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL)
+		attr->at_flags |= ATR_VFLAG_MODSEQ;
+
 	working = attr->at_user_encoded;
 	if ((working != NULL) && (--working->al_refct <= 0)) {
 		while (working) {
@@ -270,6 +480,141 @@ comp_null(struct attribute *attr, struct attribute *with)
 	return 0;
 }
 
+/*
+ * Block allocator for svrattrl entries which are all freed together, such
+ * as the lists encoded to save an object to the database.  Between
+ * attrlist_arena_begin() and attrlist_arena_end(), attrlist_alloc() carves
+ * entries out of a few large blocks instead of calling malloc() for each
+ * one.  free_svrattrl() does not free such an entry; the blocks are reused
+ * once every entry carved from them has been freed.
+ */
+#define ATTRLIST_ARENA_BLKSZ	(64 * 1024)
+#define ATTRLIST_ARENA_ALIGN(x)	(((x) + 7) & ~((size_t) 7))
+
+typedef struct attrlist_arena_blk {
+	struct attrlist_arena_blk *ab_next;
+	char *ab_free;	/* next free byte */
+	char *ab_end;	/* end of block */
+} attrlist_arena_blk;
+
+#define ATTRLIST_ARENA_START(blk) ((char *) (blk) + ATTRLIST_ARENA_ALIGN(sizeof(attrlist_arena_blk)))
+
+static attrlist_arena_blk *arena_head = NULL;	/* all blocks */
+static attrlist_arena_blk *arena_cur = NULL;	/* block being carved */
+static int arena_active = 0;
+static int arena_live = 0;	/* entries carved and not yet freed */
+
+/**
+ * @brief
+ *	attrlist_arena_reset - make all of the arena blocks free again
+ *
+ * @return void
+ */
+static void
+attrlist_arena_reset(void)
+{
+	arena_cur = arena_head;
+	if (arena_cur != NULL)
+		arena_cur->ab_free = ATTRLIST_ARENA_START(arena_cur);
+}
+
+/**
+ * @brief
+ *	attrlist_arena_begin - carve the svrattrl entries allocated from now on
+ *	out of the arena, see attrlist_arena_end()
+ *
+ * @return void
+ */
+void
+attrlist_arena_begin(void)
+{
+	if (arena_live == 0)
+		attrlist_arena_reset();
+	arena_active = 1;
+}
+
+/**
+ * @brief
+ *	attrlist_arena_end - go back to allocating svrattrl entries with
+ *	malloc().  Entries already carved stay valid until they are freed.
+ *
+ * @return void
+ */
+void
+attrlist_arena_end(void)
+{
+	arena_active = 0;
+	if (arena_live == 0)
+		attrlist_arena_reset();
+}
+
+/**
+ * @brief
+ *	attrlist_arena_get - carve space for an entry out of the arena
+ *
+ * @param[in] tsize - size of the entry
+ *
+ * @return void *
+ * @retval NULL - the entry does not fit in a block or out of memory
+ */
+static void *
+attrlist_arena_get(size_t tsize)
+{
+	attrlist_arena_blk *blk;
+	void *p;
+
+	tsize = ATTRLIST_ARENA_ALIGN(tsize);
+	if (tsize > ATTRLIST_ARENA_BLKSZ / 4)
+		return NULL;
+
+	while (arena_cur == NULL || arena_cur->ab_free + tsize > arena_cur->ab_end) {
+		if (arena_cur != NULL && arena_cur->ab_next != NULL) {
+			arena_cur = arena_cur->ab_next;
+			arena_cur->ab_free = ATTRLIST_ARENA_START(arena_cur);
+			continue;
+		}
+		blk = malloc(ATTRLIST_ARENA_BLKSZ);
+		if (blk == NULL)
+			return NULL;
+		blk->ab_next = NULL;
+		blk->ab_free = ATTRLIST_ARENA_START(blk);
+		blk->ab_end = (char *) blk + ATTRLIST_ARENA_BLKSZ;
+		if (arena_cur == NULL)
+			arena_head = blk;
+		else
+			arena_cur->ab_next = blk;
+		arena_cur = blk;
+	}
+	p = arena_cur->ab_free;
+	arena_cur->ab_free += tsize;
+	arena_live++;
+	return p;
+}
+
+/**
+ * @brief
+ *	attrlist_free - free a single svrattrl entry which is not linked in
+ *	a list, giving the space back to the arena if it was carved from it
+ *
+ * @param[in] pal - the entry
+ *
+ * @return void
+ */
+void
+attrlist_free(svrattrl *pal)
+{
+	attrlist_arena_blk *blk;
+
+	mem_acct_add(MEM_ACCT_SVRATTRL, -1, -(long long)pal->al_tsize);
+	for (blk = arena_head; blk != NULL; blk = blk->ab_next) {
+		if ((char *) pal >= ATTRLIST_ARENA_START(blk) && (char *) pal < blk->ab_end) {
+			if (--arena_live == 0 && !arena_active)
+				attrlist_arena_reset();
+			return;
+		}
+	}
+	free(pal);
+}
 
 /**
  * @brief
@@ -298,9 +643,14 @@ attrlist_alloc(int szname, int szresc, int szval)
 	if (szname < 0 || szresc < 0 || szval < 0)
 		return NULL;
 	tsize = sizeof(svrattrl) + szname + szresc + szval;
-	pal = (svrattrl *)malloc(tsize);
+	pal = NULL;
+	if (arena_active)
+		pal = (svrattrl *)attrlist_arena_get(tsize);
+	if (pal == NULL)
+		pal = (svrattrl *)malloc(tsize);
 	if (pal == NULL)
 		return NULL;
+	mem_acct_add(MEM_ACCT_SVRATTRL, 1, tsize);
 #ifdef DEBUG
 	memset(pal, 0, sizeof(svrattrl));
 #endif
@@ -406,14 +756,14 @@ free_svrattrl(svrattrl *pal)
 			while (sister) {
 				nxpal = sister->al_sister;
 				delete_link(&sister->al_link);
-				(void)free(sister);
+				attrlist_free(sister);
 				sister = nxpal;
 			}
 		}
 		nxpal = (struct svrattrl *)GET_NEXT(pal->al_link);
 		delete_link(&pal->al_link);
 		if (pal->al_refct <= 0)
-			(void)free(pal);
+			attrlist_free(pal);
 		pal = nxpal;
 	}
 }
@@ -729,6 +1079,72 @@ add_to_svrattrl_list_sorted(pbs_list_head *phead, char *name_str, char *resc_str
 	return 0;
 }
 
+/* entry of the array sorted by sort_svrattrl_list() */
+struct svrattrl_ord {
+	svrattrl *so_pal;
+	int so_ord;	/* position in the list, keeps equal names in order */
+};
+
+/**
+ * @brief
+ *	compare two entries by attribute name, then by list position
+ */
+static int
+cmp_svrattrl_ord(const void *a, const void *b)
+{
+	const struct svrattrl_ord *pa = a;
+	const struct svrattrl_ord *pb = b;
+	int rc;
+
+	if ((rc = strcmp(pa->so_pal->al_name, pb->so_pal->al_name)) != 0)
+		return rc;
+	return pa->so_ord - pb->so_ord;
+}
+
+/**
+ * @brief
+ * 	Sorts the 'phead' svrattrl list by name, in the same order
+ *	add_to_svrattrl_list_sorted() would have built it.  A long list is
+ *	cheaper to build with add_to_svrattrl_list() and sort once at the end
+ *	than to walk on every insert.
+ *
+ * @param[in,out] phead - list to sort
+ *
+ * @return int
+ * @retval 0	success
+ * @retval -1	out of memory, the list is left as it was
+ */
+int
+sort_svrattrl_list(pbs_list_head *phead)
+{
+	struct svrattrl_ord *arr;
+	svrattrl *pal;
+	int ct = 0;
+	int i;
+
+	for (pal = (svrattrl *)GET_NEXT(*phead); pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link))
+		ct++;
+	if (ct < 2)
+		return 0;
+
+	if ((arr = malloc(ct * sizeof(struct svrattrl_ord))) == NULL)
+		return -1;
+	i = 0;
+	for (pal = (svrattrl *)GET_NEXT(*phead); pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		arr[i].so_pal = pal;
+		arr[i].so_ord = i;
+		i++;
+	}
+	qsort(arr, ct, sizeof(struct svrattrl_ord), cmp_svrattrl_ord);
+
+	for (i = 0; i < ct; i++)
+		delete_link(&arr[i].so_pal->al_link);
+	for (i = 0; i < ct; i++)
+		append_link(phead, &arr[i].so_pal->al_link, arr[i].so_pal);
+	free(arr);
+	return 0;
+}
+
 /**
  * @brief
  * 	Copies contents of list headed by 'from_head' into 'to_head'
@@ -51,6 +51,13 @@ struct JsonLink{
 
 static JsonLink *head = NULL, *prev_link = NULL;
 
+/* output position kept by flush_json() between calls */
+static int gen_started = 0;
+static int indent = 0;
+static int prnt_comma = 0;
+static int arr_lvl[ARRAY_NESTING_LEVEL];
+static int curnt_arr_lvl = 0;
+
 /**
  * @brief
  *	create_json_node
@@ -372,10 +379,11 @@ add_json_node(JsonNodeType ntype, JsonValueType vtype, JsonEscapeType esc_type,
 
 /**
  * @brief
- *	generate_json_node
- *	Takes a JsonNode type link list and file stream as an input.
- * 	Reads the link-list node by node and write the json output
- * 	on the passed file stream.
+ *	flush_json
+ *	Writes out the json nodes added since the last flush on the passed
+ *	file stream and frees them.  The position in the output (nesting,
+ *	pending comma) is kept across calls, so a caller may flush after
+ *	every object instead of holding the whole list until generate_json().
  *
  * @param[in] stream - fd to which json o/p written
  *
@@ -385,20 +393,20 @@ add_json_node(JsonNodeType ntype, JsonValueType vtype, JsonEscapeType esc_type,
  *
  */
 int
-generate_json(FILE * stream) {
-	int	  indent = 0;
-	int	  prnt_comma = 0;
+flush_json(FILE *stream) {
 	int	  last_object_value = 0;
 	int	  last_array_value = 0;
-	int	 *arr_lvl = NULL;
-	int	  curnt_arr_lvl= 0;
 	JsonNode *node = NULL;
 	JsonLink *link = head;
 
-	fprintf(stream, "{");
-	indent += 4;
-	arr_lvl = malloc(ARRAY_NESTING_LEVEL * sizeof(int*));
-	memset(arr_lvl, 0, (ARRAY_NESTING_LEVEL * sizeof(int)));
+	if (!gen_started) {
+		fprintf(stream, "{");
+		indent += 4;
+		memset(arr_lvl, 0, sizeof(arr_lvl));
+		curnt_arr_lvl = 0;
+		prnt_comma = 0;
+		gen_started = 1;
+	}
 
 	while (link) {
 		node = link->node;
@@ -415,7 +423,10 @@ generate_json(FILE * stream) {
 				indent += 4;
 				prnt_comma = 0;
 				/*moving to next node since there's no value associated within an OBJECT type node*/
-				link = link->next;
+				head = link->next;
+				free_json_node(node);
+				free(link);
+				link = head;
 				continue;
 
 			case JSON_OBJECT_END:
@@ -433,6 +444,10 @@ generate_json(FILE * stream) {
 					fprintf(stream, "%*.*s\"%s\":[", indent, indent, " ", node->key);
 				indent += 4;
 				prnt_comma = 0;
+				if (curnt_arr_lvl + 1 >= ARRAY_NESTING_LEVEL) {
+					free_json_node_list();
+					return 1;
+				}
 				arr_lvl[curnt_arr_lvl+1] = indent;
 				curnt_arr_lvl++;
 				break;
@@ -445,7 +460,7 @@ generate_json(FILE * stream) {
 				break;
 
 			default:
-				free(arr_lvl);
+				free_json_node_list();
 				return 1;
 		}
 		switch (node->value_type) {
@@ -504,7 +519,7 @@ generate_json(FILE * stream) {
 				break;
 
 			default:
-				free(arr_lvl);
+				free_json_node_list();
 				return 1;
 		}
 
@@ -520,12 +535,41 @@ generate_json(FILE * stream) {
 			last_object_value = 0;
 			prnt_comma = 1;
 		}
-		link = link->next;
+		head = link->next;
+		free_json_node(node);
+		free(link);
+		link = head;
 	}
-	free(arr_lvl);
+	head = NULL;
+	prev_link = NULL;
+	return 0;
+}
+
+/**
+ * @brief
+ *	generate_json_node
+ *	Takes a JsonNode type link list and file stream as an input.
+ * 	Reads the link-list node by node and write the json output
+ * 	on the passed file stream, then closes the outermost object.
+ *
+ * @param[in] stream - fd to which json o/p written
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ *
+ */
+int
+generate_json(FILE * stream) {
+	int rc;
+
+	rc = flush_json(stream);
+	gen_started = 0;
 	indent -= 4;
-	if (indent != 0)
+	if (rc != 0 || indent != 0) {
+		indent = 0;
 		return 1;
+	}
 	fprintf(stream, "\n}\n");
 	return 0;
 }
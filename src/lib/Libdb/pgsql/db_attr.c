@@ -49,6 +49,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 #include "pbs_db.h"
 #include "db_postgres.h"
+#include "mem_acct.h"
 #include "assert.h"
 
 /*
@@ -120,6 +121,7 @@ make_attr(char *attr_name, char *attr_resc, char *attr_value, int attr_flags)
 
 	if ((psvrat = (svrattrl *) malloc(tsize)) == 0)
 		return NULL;
+	mem_acct_add(MEM_ACCT_SVRATTRL, 1, tsize);
 
 	CLEAR_LINK(psvrat->al_link);
 	psvrat->al_sister = NULL;
@@ -231,26 +233,29 @@ dbarray_to_attrlist(char *raw_array, pbs_db_attr_list_t *attr_list)
 /**
  * @brief
  *	Converts an PBS link list of attributes to DB hstore(array) format
+ *	in the given buffer
  *
  * @param[out]  raw_array - Array string which is in the form of postgres hstore
  * @param[in]	attr_list - List of pbs_db_attr_list_t objects
  * @param[in]	keys_only - if true, convert only the keys, not values also
+ * @param[in,out] parray  - The buffer, kept across calls
+ * @param[in,out] plen    - Size of the buffer
  *
  * @return      Error code
  * @retval	-1 - On Error
  * @retval	 length of array - On Success
  *
  */
-int
-attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys_only)
+static int
+attrlist_to_dbarray_buf(char **raw_array, pbs_db_attr_list_t *attr_list, int keys_only, struct pg_array **parray, int *plen)
 {
-	/* use static variables to improve performance by not allocating memory for each object save */
-	static struct pg_array *array = NULL, *tmp;
-	static int len = sizeof(struct pg_array) + DBARRAY_BUF_LEN;
+	struct pg_array *array = *parray, *tmp;
+	int len = *plen;
 	struct str_data *val = NULL;
 	svrattrl *pal;
 	char *p;
 	int spc_avl, spc_req;
+	int used;
 	/* (len_field * 2) + PBS_MAXATTRNAME + PBS_MAXATTRRESC + max 3 digits flags +  2 dots + 1 null terminator */
 	static int fixed_part_req = (sizeof(int32_t) * 2) + PBS_MAXATTRNAME + PBS_MAXATTRRESC + 3  + 2  + 1; 
 	
@@ -258,6 +263,7 @@ attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys
 		array = malloc(len);
 		if (!array)
 			return -1;
+		*parray = array;
 	}
 
 	array->ndim = htonl(1);
@@ -273,7 +279,8 @@ attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys
 	val = (struct str_data *)((char *) array + sizeof(struct pg_array));
 
 	for (pal = (svrattrl *)GET_NEXT(attr_list->attrs); pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
-		spc_avl =  len - ((char *) val - (char *) array);
+		used = (char *) val - (char *) array;
+		spc_avl =  len - used;
 		spc_req = fixed_part_req + (pal->al_atopl.value ? strlen(pal->al_atopl.value) : 0); /* value can have arbitrary length */
 		if (spc_avl <= spc_req) {
 			len += (spc_req > DBARRAY_BUF_LEN) ? spc_req : DBARRAY_BUF_LEN;
@@ -281,8 +288,10 @@ attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys
 			if (!tmp)
 				return -1;
 
-			val = (struct str_data *) ((char *) val + ((char *) tmp - (char *) array)); /* move val since array moved */	
+			val = (struct str_data *) ((char *) tmp + used); /* move val since array moved */
 			array = tmp;
+			*parray = array;
+			*plen = len;
 		}
 		p = pbs_strcpy(val->str, pal->al_atopl.name);
 		if (pal->al_atopl.resource && pal->al_atopl.resource[0] != '\0') {
@@ -307,6 +316,51 @@ attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys
 	return ((char *) val - (char *) array);
 }
 
+/**
+ * @brief
+ *	Converts an PBS link list of attributes to DB hstore(array) format
+ *
+ * @param[out]  raw_array - Array string which is in the form of postgres hstore
+ * @param[in]	attr_list - List of pbs_db_attr_list_t objects
+ * @param[in]	keys_only - if true, convert only the keys, not values also
+ *
+ * @return      Error code
+ * @retval	-1 - On Error
+ * @retval	 length of array - On Success
+ *
+ */
+int
+attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys_only)
+{
+	/* use static variables to improve performance by not allocating memory for each object save */
+	static struct pg_array *array = NULL;
+	static int len = sizeof(struct pg_array) + DBARRAY_BUF_LEN;
+
+	return (attrlist_to_dbarray_buf(raw_array, attr_list, keys_only, &array, &len));
+}
+
+/**
+ * @brief
+ *	Like attrlist_to_dbarray, but into a buffer of its own, for the
+ *	statements that take a second attribute array
+ *
+ * @param[out]  raw_array - Array string which is in the form of postgres hstore
+ * @param[in]	attr_list - List of pbs_db_attr_list_t objects
+ *
+ * @return      Error code
+ * @retval	-1 - On Error
+ * @retval	 length of array - On Success
+ *
+ */
+int
+attrlist_to_dbarray2(char **raw_array, pbs_db_attr_list_t *attr_list)
+{
+	static struct pg_array *array = NULL;
+	static int len = sizeof(struct pg_array) + DBARRAY_BUF_LEN;
+
+	return (attrlist_to_dbarray_buf(raw_array, attr_list, 0, &array, &len));
+}
+
 /**
  * @brief
  *	Converts an PBS link list of attributes to DB hstore(array) format
@@ -324,3 +378,342 @@ attrlist_to_dbarray(char **raw_array, pbs_db_attr_list_t *attr_list)
 {
 	return attrlist_to_dbarray_ex(raw_array, attr_list, 0);
 }
+
+/*
+ * Binary attribute blobs
+ *
+ * A blob starts with PBS_DB_BLOB_MAGIC and is followed by one entry per
+ * attribute value (one per resource for resource lists).  Every entry is
+ * the value type (1 byte), the attribute flags (4 bytes), the attribute
+ * name and the resource name (2 byte length, counting a terminating NUL,
+ * then the string; a zero length means no resource) and the value.
+ * Integers are in network byte order.  Values are stored as:
+ *	TEXT, STR	4 byte length, string and terminating NUL
+ *	LONG		8 bytes
+ *	BOOL, CHAR	1 byte
+ *	SIZE		8 byte number, 1 byte shift, 1 byte units
+ *	FLOAT		the 4 bytes of the float
+ */
+
+#define DBBLOB_BUF_LEN 2048
+
+static void
+blob_put(char *p, unsigned long long v, int n)
+{
+	while (n-- > 0) {
+		p[n] = (char)(v & 0xff);
+		v >>= 8;
+	}
+}
+
+static unsigned long long
+blob_get(char *p, int n)
+{
+	unsigned long long v = 0;
+	int i;
+
+	for (i = 0; i < n; i++)
+		v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+/**
+ * @brief
+ *	Append an attribute value to a binary attribute blob
+ *
+ * @param[in,out] blob - The blob, starts out zeroed
+ * @param[in]	ent  - The value to append
+ *
+ * @return      Error code
+ * @retval	-1 - Out of memory or bad entry
+ * @retval	 0 - Success
+ *
+ */
+int
+pbs_db_blob_add(pbs_db_blob_t *blob, pbs_db_blob_ent_t *ent)
+{
+	int nlen;
+	int rlen;
+	int vlen = 0;
+	int need;
+	char *p;
+
+	nlen = strlen(ent->bl_name) + 1;
+	rlen = ent->bl_resc ? strlen(ent->bl_resc) + 1 : 0;
+	if (nlen > 0xffff || rlen > 0xffff)
+		return -1;
+
+	switch (ent->bl_type) {
+		case PBS_DB_BLOB_TEXT:
+		case PBS_DB_BLOB_STR:
+			vlen = 4 + strlen(ent->bl_str) + 1;
+			break;
+		case PBS_DB_BLOB_LONG:
+			vlen = 8;
+			break;
+		case PBS_DB_BLOB_BOOL:
+		case PBS_DB_BLOB_CHAR:
+			vlen = 1;
+			break;
+		case PBS_DB_BLOB_SIZE:
+			vlen = 10;
+			break;
+		case PBS_DB_BLOB_FLOAT:
+			vlen = 4;
+			break;
+		default:
+			return -1;
+	}
+
+	need = 1 + 4 + 2 + nlen + 2 + rlen + vlen;
+	if (blob->len == 0)
+		need += PBS_DB_BLOB_MAGIC_LEN;
+
+	if (blob->len + need > blob->size) {
+		int size = blob->size ? blob->size : DBBLOB_BUF_LEN;
+
+		while (blob->len + need > size)
+			size *= 2;
+		if ((p = realloc(blob->data, size)) == NULL)
+			return -1;
+		blob->data = p;
+		blob->size = size;
+	}
+
+	p = blob->data + blob->len;
+	if (blob->len == 0) {
+		memcpy(p, PBS_DB_BLOB_MAGIC, PBS_DB_BLOB_MAGIC_LEN);
+		p += PBS_DB_BLOB_MAGIC_LEN;
+	}
+
+	*p++ = (char) ent->bl_type;
+	blob_put(p, (unsigned int) ent->bl_flags, 4);
+	p += 4;
+	blob_put(p, nlen, 2);
+	p += 2;
+	memcpy(p, ent->bl_name, nlen);
+	p += nlen;
+	blob_put(p, rlen, 2);
+	p += 2;
+	if (rlen) {
+		memcpy(p, ent->bl_resc, rlen);
+		p += rlen;
+	}
+
+	switch (ent->bl_type) {
+		case PBS_DB_BLOB_TEXT:
+		case PBS_DB_BLOB_STR:
+			blob_put(p, vlen - 4, 4);
+			memcpy(p + 4, ent->bl_str, vlen - 4);
+			break;
+		case PBS_DB_BLOB_LONG:
+			blob_put(p, (unsigned long long) ent->bl_long, 8);
+			break;
+		case PBS_DB_BLOB_BOOL:
+		case PBS_DB_BLOB_CHAR:
+			*p = (char) ent->bl_long;
+			break;
+		case PBS_DB_BLOB_SIZE:
+			blob_put(p, ent->bl_size_num, 8);
+			p[8] = (char) ent->bl_size_shift;
+			p[9] = (char) ent->bl_size_units;
+			break;
+		case PBS_DB_BLOB_FLOAT: {
+			uint32_t bits;
+
+			memcpy(&bits, &ent->bl_float, 4);
+			blob_put(p, bits, 4);
+			break;
+		}
+	}
+	p += vlen;
+
+	blob->len = p - blob->data;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Read the next attribute value from a binary attribute blob. The
+ *	strings in the entry point into the blob.
+ *
+ * @param[in]	data - The blob
+ * @param[in]	len  - Length of the blob
+ * @param[in,out] pos - Read position, 0 for the first entry
+ * @param[out]	ent  - The value read
+ *
+ * @return      Error code
+ * @retval	-1 - The blob is corrupt
+ * @retval	 0 - Success
+ * @retval	 1 - No more entries
+ *
+ */
+int
+pbs_db_blob_next(char *data, int len, int *pos, pbs_db_blob_ent_t *ent)
+{
+	char *p;
+	char *end = data + len;
+	int nlen;
+	int rlen;
+	int vlen;
+
+	if (*pos == 0) {
+		if (len < PBS_DB_BLOB_MAGIC_LEN || memcmp(data, PBS_DB_BLOB_MAGIC, PBS_DB_BLOB_MAGIC_LEN) != 0)
+			return -1;
+		*pos = PBS_DB_BLOB_MAGIC_LEN;
+	}
+	if (*pos >= len)
+		return 1;
+
+	p = data + *pos;
+	memset(ent, 0, sizeof(pbs_db_blob_ent_t));
+
+	if (end - p < 7)
+		return -1;
+	ent->bl_type = (unsigned char) *p++;
+	ent->bl_flags = (int) blob_get(p, 4);
+	p += 4;
+	nlen = (int) blob_get(p, 2);
+	p += 2;
+	if (nlen == 0 || end - p < nlen + 2 || p[nlen - 1] != '\0')
+		return -1;
+	ent->bl_name = p;
+	p += nlen;
+	rlen = (int) blob_get(p, 2);
+	p += 2;
+	if (rlen) {
+		if (end - p < rlen || p[rlen - 1] != '\0')
+			return -1;
+		ent->bl_resc = p;
+		p += rlen;
+	}
+
+	switch (ent->bl_type) {
+		case PBS_DB_BLOB_TEXT:
+		case PBS_DB_BLOB_STR:
+			if (end - p < 4)
+				return -1;
+			vlen = (int) blob_get(p, 4);
+			p += 4;
+			if (vlen == 0 || end - p < vlen || p[vlen - 1] != '\0')
+				return -1;
+			ent->bl_str = p;
+			break;
+		case PBS_DB_BLOB_LONG:
+			vlen = 8;
+			if (end - p < vlen)
+				return -1;
+			ent->bl_long = (long long) blob_get(p, 8);
+			break;
+		case PBS_DB_BLOB_BOOL:
+		case PBS_DB_BLOB_CHAR:
+			vlen = 1;
+			if (end - p < vlen)
+				return -1;
+			ent->bl_long = (ent->bl_type == PBS_DB_BLOB_CHAR) ? (char) *p : (unsigned char) *p;
+			break;
+		case PBS_DB_BLOB_SIZE:
+			vlen = 10;
+			if (end - p < vlen)
+				return -1;
+			ent->bl_size_num = blob_get(p, 8);
+			ent->bl_size_shift = (unsigned char) p[8];
+			ent->bl_size_units = (unsigned char) p[9];
+			break;
+		case PBS_DB_BLOB_FLOAT: {
+			uint32_t bits;
+
+			vlen = 4;
+			if (end - p < vlen)
+				return -1;
+			bits = (uint32_t) blob_get(p, 4);
+			memcpy(&ent->bl_float, &bits, 4);
+			break;
+		}
+		default:
+			return -1;
+	}
+	p += vlen;
+
+	*pos = p - data;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Return the value of a binary attribute blob entry as a string, in
+ *	the form the attribute's decode function accepts
+ *
+ * @param[in]	ent - The blob entry
+ * @param[out]	buf - Buffer for the values that are not stored as strings
+ * @param[in]	len - Size of buf
+ *
+ * @return	The value string, either ent->bl_str or buf
+ *
+ */
+char *
+pbs_db_blob_value(pbs_db_blob_ent_t *ent, char *buf, int len)
+{
+	static char *shift_sfx[] = {"", "k", "m", "g", "t", "p"};
+
+	switch (ent->bl_type) {
+		case PBS_DB_BLOB_TEXT:
+		case PBS_DB_BLOB_STR:
+			return ent->bl_str;
+		case PBS_DB_BLOB_LONG:
+			snprintf(buf, len, "%lld", ent->bl_long);
+			break;
+		case PBS_DB_BLOB_BOOL:
+			snprintf(buf, len, "%s", ent->bl_long ? "True" : "False");
+			break;
+		case PBS_DB_BLOB_CHAR:
+			snprintf(buf, len, "%c", (char) ent->bl_long);
+			break;
+		case PBS_DB_BLOB_SIZE:
+			snprintf(buf, len, "%llu%s%s", ent->bl_size_num,
+				(ent->bl_size_shift % 10 == 0 && ent->bl_size_shift <= 50) ? shift_sfx[ent->bl_size_shift / 10] : "",
+				ent->bl_size_units ? "w" : "b");
+			break;
+		case PBS_DB_BLOB_FLOAT:
+			snprintf(buf, len, "%f", ent->bl_float);
+			break;
+		default:
+			buf[0] = '\0';
+	}
+	return buf;
+}
+
+/**
+ * @brief
+ *	Convert a binary attribute blob to a PBS link list of attributes,
+ *	the same list dbarray_to_attrlist produces for the hstore form
+ *
+ * @param[in]	data - The blob
+ * @param[in]	len  - Length of the blob
+ * @param[out]	attr_list - List of attributes
+ *
+ * @return      Error code
+ * @retval	-1 - On Error
+ * @retval	 0 - On Success
+ *
+ */
+int
+dbblob_to_attrlist(char *data, int len, pbs_db_attr_list_t *attr_list)
+{
+	pbs_db_blob_ent_t ent;
+	char buf[256];
+	svrattrl *pal;
+	int pos = 0;
+	int rc;
+
+	CLEAR_HEAD(attr_list->attrs);
+	attr_list->attr_count = 0;
+
+	while ((rc = pbs_db_blob_next(data, len, &pos, &ent)) == 0) {
+		if (!(pal = make_attr(ent.bl_name, ent.bl_resc, pbs_db_blob_value(&ent, buf, sizeof(buf)), ent.bl_flags)))
+			return -1;
+		append_link(&(attr_list->attrs), &pal->al_link, pal);
+		attr_list->attr_count++;
+	}
+	return (rc == 1 ? 0 : -1);
+}
@@ -68,13 +68,16 @@ pg_conn_data_t *conn_data = NULL;
 pg_conn_trx_t *conn_trx = NULL;
 static char pg_ctl[MAXPATHLEN + 1] = "";
 static char *pg_user = NULL;
+void (*pfn_db_round_trip)(double) = NULL;
 
 static int is_conn_error(void *conn, int *failcode);
+static void db_async_drain(void *conn);
 static char *get_dataservice_password(char *user, char *errmsg, int len);
 static char *db_escape_str(void *conn, char *str);
 static char *get_db_connect_string(char *host, int timeout, int *err_code, char *errmsg, int len);
 static int db_prepare_sqls(void *conn);
 static int db_cursor_next(void *conn, void *state, pbs_db_obj_info_t *obj);
+static void db_round_trip_done(struct timeval *start);
 
 extern char *pbs_get_dataservice_usr(char *, int);
 extern int pbs_decrypt_pwd(char *, int, size_t, char **, const unsigned char *, const unsigned char *);
@@ -174,30 +177,118 @@ db_initialize_state(void *conn, query_cb_t query_cb)
 	state->res = NULL;
 	state->row = -1;
 	state->query_cb = query_cb;
+	state->cursor = NULL;
 	return state;
 }
 
 /**
  * @brief
  *	Destroy a query state variable.
- *	Clears the database resultset and free's the memory allocated to
- *	the state variable
+ *	Clears the database resultset, closes the server side cursor if the
+ *	rows came from one and free's the memory allocated to the state variable
  *
+ * @param[in]	conn - Database connection handle
  * @param[in]	st - Pointer to the state variable
  *
  * @return void
  */
 static void
-db_destroy_state(void *st)
+db_destroy_state(void *conn, void *st)
 {
 	db_query_state_t *state = st;
+	char conn_sql[MAX_SQL_LENGTH];
+
 	if (state) {
 		if (state->res)
 			PQclear(state->res);
+		if (state->cursor) {
+			snprintf(conn_sql, MAX_SQL_LENGTH, "close %s", state->cursor);
+			(void)db_execute_str(conn, conn_sql);
+		}
 		free(state);
 	}
 }
 
+/**
+ * @brief
+ *	Replace the resultset in the query state with the next batch of
+ *	rows from its server side cursor
+ *
+ * @param[in]	conn - Database connection handle
+ * @param[in]	state - The cursor state handle
+ *
+ * @return	Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ * @retval	 1 - Success but no more rows
+ *
+ */
+static int
+db_cursor_fetch(void *conn, db_query_state_t *state)
+{
+	char conn_sql[MAX_SQL_LENGTH];
+	PGresult *res;
+
+	if (state->res) {
+		PQclear(state->res);
+		state->res = NULL;
+	}
+	state->row = 0;
+	state->count = 0;
+
+	snprintf(conn_sql, MAX_SQL_LENGTH, "fetch %d from %s", DB_CURSOR_FETCH_ROWS, state->cursor);
+	db_async_drain(conn);
+	res = PQexecParams((PGconn *)conn, conn_sql, 0, NULL, NULL, NULL, NULL, 1);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+		char *sql_error = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+		db_set_error(conn, &errmsg_cache, "Fetch from cursor", conn_sql, sql_error);
+		PQclear(res);
+		return -1;
+	}
+
+	state->res = res;
+	state->count = PQntuples(res);
+
+	return (state->count > 0 ? 0 : 1);
+}
+
+/**
+ * @brief
+ *	Open a server side cursor for sql and fetch its first batch of rows
+ *	into the query state. The rest are fetched by db_cursor_next as the
+ *	rows are used up, so a large table never has to sit in memory as a
+ *	single resultset.
+ *
+ * @par
+ *	The cursor is declared WITH HOLD so that it does not need an open
+ *	transaction, and the objects loaded from it can be saved or deleted
+ *	on the same connection while it is being read.
+ *
+ * @param[in]	conn - Database connection handle
+ * @param[in]	st - The cursor state handle
+ * @param[in]	cursor - Name of the cursor
+ * @param[in]	sql - The query to run
+ *
+ * @return	Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ * @retval	 1 - Success but no rows
+ *
+ */
+int
+db_cursor_open(void *conn, void *st, char *cursor, char *sql)
+{
+	db_query_state_t *state = (db_query_state_t *) st;
+	char conn_sql[MAX_SQL_LENGTH];
+
+	snprintf(conn_sql, MAX_SQL_LENGTH, "declare %s binary cursor with hold for %s", cursor, sql);
+	if (db_execute_str(conn, conn_sql) == -1)
+		return -1;
+	state->cursor = cursor;
+
+	return (db_cursor_fetch(conn, state));
+}
+
 /**
  * @brief
  *	Search the database for exisitn objects and load the server structures.
@@ -233,7 +324,7 @@ pbs_db_search(void *conn, pbs_db_obj_info_t *obj, pbs_db_query_options_t *opts,
 	ret = db_fn_arr[obj->pbs_db_obj_type].pbs_db_find_obj(conn, st, obj, opts);
 	if (ret == -1) {
 		/* error in executing the sql */
-		db_destroy_state(st);
+		db_destroy_state(conn, st);
 		return -1;
 	}
 	totcount = 0;
@@ -243,7 +334,9 @@ pbs_db_search(void *conn, pbs_db_obj_info_t *obj, pbs_db_query_options_t *opts,
 			totcount++;
 	}
 
-	db_destroy_state(st);
+	db_destroy_state(conn, st);
+	if (rc == -1)
+		return -1;
 	return totcount;
 }
 
@@ -270,6 +363,12 @@ db_cursor_next(void *conn, void *st, pbs_db_obj_info_t *obj)
 	db_query_state_t *state = (db_query_state_t *)st;
 	int ret;
 
+	/* a full batch from a cursor means there may be more rows to fetch */
+	if (state->row >= state->count && state->cursor != NULL && state->count == DB_CURSOR_FETCH_ROWS) {
+		if ((ret = db_cursor_fetch(conn, state)) != 0)
+			return ret;
+	}
+
 	if (state->row < state->count) {
 		ret = db_fn_arr[obj->pbs_db_obj_type].pbs_db_next_obj(conn, st, obj);
 		state->row++;
@@ -368,8 +467,12 @@ db_execute_str(void *conn, char *sql)
 	PGresult *res;
 	char *rows_affected = NULL;
 	int status;
+	struct timeval start;
 
+	db_async_drain(conn);
+	gettimeofday(&start, NULL);
 	res = PQexec((PGconn *)conn, sql);
+	db_round_trip_done(&start);
 	status = PQresultStatus(res);
 	if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
 		char *sql_error = PQresultErrorField(res, PG_DIAG_SQLSTATE);
@@ -862,8 +965,10 @@ pbs_db_disconnect(void *conn)
 	if (!conn)
 		return -1;
 
-	if (conn)
+	if (conn) {
+		db_async_drain(conn);
 		PQfinish(conn);
+	}
 
 	free(conn_data);
 	free(conn_trx);
@@ -891,6 +996,287 @@ pbs_db_save_obj(void *conn, pbs_db_obj_info_t *obj, int savetype)
 	return (db_fn_arr[obj->pbs_db_obj_type].pbs_db_save_obj(conn, obj, savetype));
 }
 
+/**
+ * @brief
+ *	Start a transaction on the database connection. Transactions nest;
+ *	only the outermost call issues the BEGIN to the database.
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval	-1  - Failure
+ * @retval	 0  - Success
+ *
+ */
+int
+pbs_db_begin_trx(void *conn)
+{
+	if (conn_trx->conn_trx_nest == 0) {
+		if (db_execute_str(conn, "BEGIN") == -1)
+			return -1;
+		conn_trx->conn_trx_rollback = 0;
+	}
+	conn_trx->conn_trx_nest++;
+	return 0;
+}
+
+/**
+ * @brief
+ *	End a transaction started with pbs_db_begin_trx. The outermost call
+ *	commits, unless this or any nested call asked for a rollback.
+ *
+ * @param[in]	conn   - Connected database handle
+ * @param[in]	commit - 1 to commit, 0 to roll back
+ *
+ * @return      Error code
+ * @retval	-1  - Failure, or the transaction was rolled back
+ * @retval	 0  - Success
+ *
+ */
+int
+pbs_db_end_trx(void *conn, int commit)
+{
+	if (conn_trx->conn_trx_nest == 0)
+		return -1;
+
+	if (!commit)
+		conn_trx->conn_trx_rollback = 1;
+
+	if (--conn_trx->conn_trx_nest > 0)
+		return 0;
+
+	if (conn_trx->conn_trx_rollback) {
+		db_execute_str(conn, "ROLLBACK");
+		conn_trx->conn_trx_rollback = 0;
+		return -1;
+	}
+
+	if (db_execute_str(conn, "COMMIT") == -1)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Wait for the outstanding asynchronous batches, so that a synchronous
+ *	statement can be run on the connection
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return	void
+ */
+static void
+db_async_drain(void *conn)
+{
+	if (conn_trx && conn_trx->conn_async_head)
+		(void)pbs_db_async_poll(conn, 1);
+}
+
+/**
+ * @brief
+ *	Fail every outstanding asynchronous batch, when the connection
+ *	broke and their results will never arrive
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return	void
+ */
+static void
+db_async_fail_all(void *conn)
+{
+	db_async_batch_t *batch;
+
+	while ((batch = conn_trx->conn_async_head) != NULL) {
+		conn_trx->conn_async_head = batch->next;
+		if (conn_trx->conn_async_head == NULL)
+			conn_trx->conn_async_tail = NULL;
+		if (batch->cb)
+			batch->cb(conn, -1, batch->arg);
+		free(batch);
+	}
+}
+
+/**
+ * @brief
+ *	Start a batch of statements that is sent in libpq pipeline mode:
+ *	the statements saved until pbs_db_async_end are only queued on the
+ *	connection, and their results are collected by pbs_db_async_poll.
+ *
+ * @param[in]	conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval	-1  - Failure, or libpq does not support pipelines. The
+ *		      caller should save synchronously instead.
+ * @retval	 0  - Success
+ *
+ */
+int
+pbs_db_async_begin(void *conn)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	db_async_batch_t *batch;
+
+	if (conn_trx->conn_trx_async || conn_trx->conn_trx_nest > 0)
+		return -1;
+
+	if ((batch = calloc(1, sizeof(db_async_batch_t))) == NULL)
+		return -1;
+
+	if (PQpipelineStatus((PGconn *) conn) == PQ_PIPELINE_OFF &&
+		PQenterPipelineMode((PGconn *) conn) != 1) {
+		free(batch);
+		return -1;
+	}
+
+	if (PQsendQueryParams((PGconn *) conn, "BEGIN", 0, NULL, NULL, NULL, NULL, 0) != 1) {
+		db_set_error(conn, &errmsg_cache, "Sending of statement", "BEGIN", NULL);
+		batch->rc = -1;
+	}
+	conn_trx->conn_async_cur = batch;
+	conn_trx->conn_trx_async = 1;
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * @brief
+ *	End a batch started with pbs_db_async_begin: queue the COMMIT and a
+ *	pipeline sync point and send the batch to the database
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	cb   - Completion callback, called with 0 once the batch
+ *		       committed or -1 if any of its statements failed
+ * @param[in]	arg  - Argument for cb
+ *
+ * @return      Error code
+ * @retval	-1  - Failure, no batch was started
+ * @retval	 0  - Success, cb is called later by pbs_db_async_poll
+ *
+ */
+int
+pbs_db_async_end(void *conn, pbs_db_async_cb_t cb, void *arg)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	db_async_batch_t *batch = conn_trx->conn_async_cur;
+
+	if (!conn_trx->conn_trx_async || batch == NULL)
+		return -1;
+
+	conn_trx->conn_trx_async = 0;
+	conn_trx->conn_async_cur = NULL;
+	batch->cb = cb;
+	batch->arg = arg;
+
+	if (PQsendQueryParams((PGconn *) conn, "COMMIT", 0, NULL, NULL, NULL, NULL, 0) != 1) {
+		db_set_error(conn, &errmsg_cache, "Sending of statement", "COMMIT", NULL);
+		batch->rc = -1;
+	}
+	if (conn_trx->conn_async_tail)
+		conn_trx->conn_async_tail->next = batch;
+	else
+		conn_trx->conn_async_head = batch;
+	conn_trx->conn_async_tail = batch;
+
+	/* the sync point also flushes the batch out to the database */
+	gettimeofday(&batch->sent, NULL);
+	if (PQpipelineSync((PGconn *) conn) != 1) {
+		db_set_error(conn, &errmsg_cache, "Sending of pipeline sync", "", NULL);
+		db_async_fail_all(conn);
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * @brief
+ *	Collect the results of the batches sent with pbs_db_async_end, in
+ *	the order they were sent, and call their completion callbacks. When
+ *	no batch is outstanding any more the connection leaves pipeline mode
+ *	and synchronous statements can be run on it again.
+ *
+ * @param[in]	conn - Connected database handle
+ * @param[in]	wait - 1 to block until all outstanding batches completed,
+ *		       0 to only process the results that already arrived
+ *
+ * @return      Error code
+ * @retval	-1  - Failure, the connection broke
+ * @retval	 0  - No batches outstanding
+ * @retval	 1  - Batches still outstanding
+ *
+ */
+int
+pbs_db_async_poll(void *conn, int wait)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+	db_async_batch_t *batch;
+	PGresult *res;
+
+	if (conn == NULL || conn_trx == NULL || conn_trx->conn_async_head == NULL)
+		return 0;
+
+	if (!wait && PQconsumeInput((PGconn *) conn) != 1) {
+		db_set_error(conn, &errmsg_cache, "Reading of pipeline results", "", NULL);
+		db_async_fail_all(conn);
+		return -1;
+	}
+
+	while ((batch = conn_trx->conn_async_head) != NULL) {
+		if (!wait && PQisBusy((PGconn *) conn))
+			break;
+
+		if ((res = PQgetResult((PGconn *) conn)) == NULL) {
+			/* end of the results of one statement */
+			if (PQstatus((PGconn *) conn) != CONNECTION_OK) {
+				db_set_error(conn, &errmsg_cache, "Reading of pipeline results", "", NULL);
+				db_async_fail_all(conn);
+				return -1;
+			}
+			continue;
+		}
+
+		switch (PQresultStatus(res)) {
+			case PGRES_PIPELINE_SYNC:
+				conn_trx->conn_async_head = batch->next;
+				if (conn_trx->conn_async_head == NULL) {
+					conn_trx->conn_async_tail = NULL;
+					if (!conn_trx->conn_trx_async)
+						PQexitPipelineMode((PGconn *) conn);
+				}
+				PQclear(res);
+				db_round_trip_done(&batch->sent);
+				if (batch->rc != 0 && PQtransactionStatus((PGconn *) conn) == PQTRANS_INERROR)
+					PQclear(PQexec((PGconn *) conn, "ROLLBACK"));
+				if (batch->cb)
+					batch->cb(conn, batch->rc, batch->arg);
+				free(batch);
+				continue;
+
+			case PGRES_COMMAND_OK:
+			case PGRES_TUPLES_OK:
+				break;
+
+			case PGRES_PIPELINE_ABORTED:
+				batch->rc = -1;
+				break;
+
+			default:
+				if (batch->rc == 0)
+					db_set_error(conn, &errmsg_cache, "Execution of pipelined statement", "",
+						PQresultErrorField(res, PG_DIAG_SQLSTATE));
+				batch->rc = -1;
+		}
+		PQclear(res);
+	}
+	return (conn_trx->conn_async_head ? 1 : 0);
+#else
+	return 0;
+#endif
+}
+
 /**
  * @brief
  *	Delete attributes of an object from the database
@@ -983,6 +1369,25 @@ db_prepare_stmt(void *conn, char *stmt, char *sql, int num_vars)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Report a round trip to the database started at 'start' through
+ *	pfn_db_round_trip, if it is set.
+ *
+ * @param[in]	start - when the statement or batch was sent
+ */
+static void
+db_round_trip_done(struct timeval *start)
+{
+	struct timeval now;
+
+	if (pfn_db_round_trip == NULL)
+		return;
+	gettimeofday(&now, NULL);
+	pfn_db_round_trip((now.tv_sec - start->tv_sec) +
+		(now.tv_usec - start->tv_usec) / 1000000.0);
+}
+
 /**
  * @brief
  *	Execute a prepared DML (insert or update) statement
@@ -1003,11 +1408,30 @@ db_cmd(void *conn, char *stmt, int num_vars)
 {
 	PGresult *res;
 	char *rows_affected = NULL;
+	struct timeval start;
+
+#ifdef LIBPQ_HAS_PIPELINING
+	if (conn_trx->conn_trx_async) {
+		/* queue the statement, its result is checked by pbs_db_async_poll */
+		if (PQsendQueryPrepared((PGconn *)conn, stmt, num_vars,
+				conn_data->paramValues,
+				conn_data->paramLengths,
+				conn_data->paramFormats, 0) != 1) {
+			db_set_error(conn, &errmsg_cache, "Sending of Prepared statement", stmt, NULL);
+			conn_trx->conn_async_cur->rc = -1;
+			return -1;
+		}
+		return 0;
+	}
+#endif
+	db_async_drain(conn);
 
+	gettimeofday(&start, NULL);
 	res = PQexecPrepared((PGconn *)conn, stmt, num_vars,
 				conn_data->paramValues,
 				conn_data->paramLengths,
 				conn_data->paramFormats, 0);
+	db_round_trip_done(&start);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK) {
 		char *sql_error = PQresultErrorField(res, PG_DIAG_SQLSTATE);
 		db_set_error(conn, &errmsg_cache, "Execution of Prepared statement", stmt, sql_error);
@@ -1048,9 +1472,14 @@ int
 db_query(void *conn, char *stmt, int num_vars, PGresult **res)
 {
 	int conn_result_format = 1;
+	struct timeval start;
+
+	db_async_drain(conn);
+	gettimeofday(&start, NULL);
 	*res = PQexecPrepared((PGconn *)conn, stmt, num_vars,
 			conn_data->paramValues, conn_data->paramLengths,
 			conn_data->paramFormats, conn_result_format);
+	db_round_trip_done(&start);
 
 	if (PQresultStatus(*res) != PGRES_TUPLES_OK) {
 		char *sql_error = PQresultErrorField(*res, PG_DIAG_SQLSTATE);
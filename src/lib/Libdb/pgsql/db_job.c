@@ -63,6 +63,8 @@ int
 db_prepare_job_sqls(void *conn)
 {
 	char conn_sql[MAX_SQL_LENGTH];
+	int i;
+
 	snprintf(conn_sql, MAX_SQL_LENGTH, "insert into pbs.job ("
 		"ji_jobid,"
 		"ji_state,"
@@ -82,71 +84,155 @@ db_prepare_job_sqls(void *conn)
 		"ji_qrank,"
 		"ji_savetm,"
 		"ji_creattm,"
-		"attributes"
+		"attributes,"
+		"attributes_hot"
 		") "
 		"values ($1, $2, $3, $4, $5, $6, $7, $8, $9, "
 		"$10, $11, $12, $13, $14, $15, $16, "
-		"localtimestamp, localtimestamp, hstore($17::text[]))");
-	if (db_prepare_stmt(conn, STMT_INSERT_JOB, conn_sql, 17) != 0)
+		"localtimestamp, localtimestamp, hstore($17::text[]), hstore($18::text[]))");
+	if (db_prepare_stmt(conn, STMT_INSERT_JOB, conn_sql, 18) != 0)
 		return -1;
 
-	snprintf(conn_sql, MAX_SQL_LENGTH, "update pbs.job set "
-		"ji_state = $2,"
-		"ji_substate = $3,"
-		"ji_svrflags = $4,"
-		"ji_stime = $5,"
-		"ji_queue  = $6,"
-		"ji_destin = $7,"
-		"ji_un_type = $8,"
-		"ji_exitstat = $9,"
-		"ji_quetime = $10,"
-		"ji_rteretry = $11,"
-		"ji_fromsock = $12,"
-		"ji_fromaddr = $13,"
-		"ji_jid = $14,"
-		"ji_credtype = $15,"
-		"ji_qrank = $16,"
-		"ji_savetm = localtimestamp,"
-		"attributes = attributes || hstore($17::text[]) "
-		"where ji_jobid = $1");
-	if (db_prepare_stmt(conn, STMT_UPDATE_JOB, conn_sql, 17) != 0)
+	/*
+	 * Jobs with their attributes in binary form (db_binary_attributes)
+	 * write the whole blob on every save and leave the hstore empty
+	 */
+	snprintf(conn_sql, MAX_SQL_LENGTH, "insert into pbs.job ("
+		"ji_jobid,"
+		"ji_state,"
+		"ji_substate,"
+		"ji_svrflags,"
+		"ji_stime,"
+		"ji_queue,"
+		"ji_destin,"
+		"ji_un_type,"
+		"ji_exitstat,"
+		"ji_quetime,"
+		"ji_rteretry,"
+		"ji_fromsock,"
+		"ji_fromaddr,"
+		"ji_jid,"
+		"ji_credtype,"
+		"ji_qrank,"
+		"ji_savetm,"
+		"ji_creattm,"
+		"attributes_bin"
+		") "
+		"values ($1, $2, $3, $4, $5, $6, $7, $8, $9, "
+		"$10, $11, $12, $13, $14, $15, $16, "
+		"localtimestamp, localtimestamp, $17)");
+	if (db_prepare_stmt(conn, STMT_INSERT_JOB_BIN, conn_sql, 17) != 0)
 		return -1;
 
-	snprintf(conn_sql, MAX_SQL_LENGTH, "update pbs.job set "
-		"ji_savetm = localtimestamp,"
-		"attributes = attributes || hstore($2::text[]) "
-		"where ji_jobid = $1");
-	if (db_prepare_stmt(conn, STMT_UPDATE_JOB_ATTRSONLY, conn_sql, 2) != 0)
-		return -1;
+	/*
+	 * A finished job is moved to pbs.job_hist, see pbs_db_move_job_hist,
+	 * and is saved there from then on with the same updates.
+	 *
+	 * The attributes that change all the time ($18, or $3) go to
+	 * attributes_hot, the others ($17, or $2) to attributes.  A save
+	 * without any of the others assigns attributes to itself, which
+	 * keeps its stored, usually toasted, value as it is instead of
+	 * writing the whole column out again.
+	 */
+	for (i = 0; i < 2; i++) {
+		char *tbl = i ? "pbs.job_hist" : "pbs.job";
+
+		snprintf(conn_sql, MAX_SQL_LENGTH, "update %s set "
+			"ji_state = $2,"
+			"ji_substate = $3,"
+			"ji_svrflags = $4,"
+			"ji_stime = $5,"
+			"ji_queue  = $6,"
+			"ji_destin = $7,"
+			"ji_un_type = $8,"
+			"ji_exitstat = $9,"
+			"ji_quetime = $10,"
+			"ji_rteretry = $11,"
+			"ji_fromsock = $12,"
+			"ji_fromaddr = $13,"
+			"ji_jid = $14,"
+			"ji_credtype = $15,"
+			"ji_qrank = $16,"
+			"ji_savetm = localtimestamp,"
+			"attributes = case when array_length($17::text[], 1) is null then attributes "
+				"else attributes || hstore($17::text[]) end,"
+			"attributes_hot = attributes_hot || hstore($18::text[]) "
+			"where ji_jobid = $1", tbl);
+		if (db_prepare_stmt(conn, i ? STMT_UPDATE_JOBHIST : STMT_UPDATE_JOB, conn_sql, 18) != 0)
+			return -1;
+
+		snprintf(conn_sql, MAX_SQL_LENGTH, "update %s set "
+			"ji_savetm = localtimestamp,"
+			"attributes = case when array_length($2::text[], 1) is null then attributes "
+				"else attributes || hstore($2::text[]) end,"
+			"attributes_hot = attributes_hot || hstore($3::text[]) "
+			"where ji_jobid = $1", tbl);
+		if (db_prepare_stmt(conn, i ? STMT_UPDATE_JOBHIST_ATTRSONLY : STMT_UPDATE_JOB_ATTRSONLY, conn_sql, 3) != 0)
+			return -1;
+
+		snprintf(conn_sql, MAX_SQL_LENGTH, "update %s set "
+			"ji_state = $2,"
+			"ji_substate = $3,"
+			"ji_svrflags = $4,"
+			"ji_stime = $5,"
+			"ji_queue  = $6,"
+			"ji_destin = $7,"
+			"ji_un_type = $8,"
+			"ji_exitstat = $9,"
+			"ji_quetime = $10,"
+			"ji_rteretry = $11,"
+			"ji_fromsock = $12,"
+			"ji_fromaddr = $13,"
+			"ji_jid = $14,"
+			"ji_credtype = $15,"
+			"ji_qrank = $16,"
+			"ji_savetm = localtimestamp "
+			"where ji_jobid = $1", tbl);
+		if (db_prepare_stmt(conn, i ? STMT_UPDATE_JOBHIST_QUICK : STMT_UPDATE_JOB_QUICK, conn_sql, 16) != 0)
+			return -1;
+
+		snprintf(conn_sql, MAX_SQL_LENGTH, "update %s set "
+			"ji_state = $2,"
+			"ji_substate = $3,"
+			"ji_svrflags = $4,"
+			"ji_stime = $5,"
+			"ji_queue  = $6,"
+			"ji_destin = $7,"
+			"ji_un_type = $8,"
+			"ji_exitstat = $9,"
+			"ji_quetime = $10,"
+			"ji_rteretry = $11,"
+			"ji_fromsock = $12,"
+			"ji_fromaddr = $13,"
+			"ji_jid = $14,"
+			"ji_credtype = $15,"
+			"ji_qrank = $16,"
+			"ji_savetm = localtimestamp,"
+			"attributes = '',"
+			"attributes_hot = '',"
+			"attributes_bin = $17 "
+			"where ji_jobid = $1", tbl);
+		if (db_prepare_stmt(conn, i ? STMT_UPDATE_JOBHIST_BIN : STMT_UPDATE_JOB_BIN, conn_sql, 17) != 0)
+			return -1;
+
+		snprintf(conn_sql, MAX_SQL_LENGTH, "update %s set "
+			"ji_savetm = localtimestamp,"
+			"attributes = '',"
+			"attributes_hot = '',"
+			"attributes_bin = $2 "
+			"where ji_jobid = $1", tbl);
+		if (db_prepare_stmt(conn, i ? STMT_UPDATE_JOBHIST_BIN_ATTRSONLY : STMT_UPDATE_JOB_BIN_ATTRSONLY, conn_sql, 2) != 0)
+			return -1;
+	}
 
 	snprintf(conn_sql, MAX_SQL_LENGTH, "update pbs.job set "
 		"ji_savetm = localtimestamp,"
-		"attributes = attributes - hstore($2::text[]) "
+		"attributes = attributes - hstore($2::text[]),"
+		"attributes_hot = attributes_hot - hstore($2::text[]) "
 		"where ji_jobid = $1");
 	if (db_prepare_stmt(conn, STMT_REMOVE_JOBATTRS, conn_sql, 2) != 0)
 		return -1;
 
-	snprintf(conn_sql, MAX_SQL_LENGTH, "update pbs.job set "
-		"ji_state = $2,"
-		"ji_substate = $3,"
-		"ji_svrflags = $4,"
-		"ji_stime = $5,"
-		"ji_queue  = $6,"
-		"ji_destin = $7,"
-		"ji_un_type = $8,"
-		"ji_exitstat = $9,"
-		"ji_quetime = $10,"
-		"ji_rteretry = $11,"
-		"ji_fromsock = $12,"
-		"ji_fromaddr = $13,"
-		"ji_jid = $14,"
-		"ji_credtype = $15,"
-		"ji_qrank = $16,"
-		"ji_savetm = localtimestamp "
-		"where ji_jobid = $1");
-	if (db_prepare_stmt(conn, STMT_UPDATE_JOB_QUICK, conn_sql, 16) != 0)
-		return -1;
-
 	snprintf(conn_sql, MAX_SQL_LENGTH, "select "
 		"ji_jobid,"
 		"ji_state,"
@@ -164,8 +250,31 @@ db_prepare_job_sqls(void *conn)
 		"ji_jid,"
 		"ji_credtype,"
 		"ji_qrank,"
-		"hstore_to_array(attributes) as attributes "
-		"from pbs.job where ji_jobid = $1");
+		"hstore_to_array(attributes || attributes_hot) as attributes,"
+		"attributes_bin,"
+		"0 as ji_hist "
+		"from pbs.job where ji_jobid = $1 "
+		"union all select "
+		"ji_jobid,"
+		"ji_state,"
+		"ji_substate,"
+		"ji_svrflags,"
+		"ji_stime,"
+		"ji_queue,"
+		"ji_destin,"
+		"ji_un_type,"
+		"ji_exitstat,"
+		"ji_quetime,"
+		"ji_rteretry,"
+		"ji_fromsock,"
+		"ji_fromaddr,"
+		"ji_jid,"
+		"ji_credtype,"
+		"ji_qrank,"
+		"hstore_to_array(attributes || attributes_hot) as attributes,"
+		"attributes_bin,"
+		"1 as ji_hist "
+		"from pbs.job_hist where ji_jobid = $1");
 	if (db_prepare_stmt(conn, STMT_SELECT_JOB, conn_sql, 1) != 0)
 		return -1;
 
@@ -214,29 +323,9 @@ db_prepare_job_sqls(void *conn)
 		"ji_jid,"
 		"ji_credtype,"
 		"ji_qrank,"
-		"hstore_to_array(attributes) as attributes "
-		"from pbs.job order by ji_qrank");
-	if (db_prepare_stmt(conn, STMT_FINDJOBS_ORDBY_QRANK, conn_sql, 0) != 0)
-		return -1;
-
-	snprintf(conn_sql, MAX_SQL_LENGTH, "select "
-		"ji_jobid,"
-		"ji_state,"
-		"ji_substate,"
-		"ji_svrflags,"
-		"ji_stime,"
-		"ji_queue,"
-		"ji_destin,"
-		"ji_un_type,"
-		"ji_exitstat,"
-		"ji_quetime,"
-		"ji_rteretry,"
-		"ji_fromsock,"
-		"ji_fromaddr,"
-		"ji_jid,"
-		"ji_credtype,"
-		"ji_qrank,"
-		"hstore_to_array(attributes) as attributes "
+		"hstore_to_array(attributes || attributes_hot) as attributes,"
+		"attributes_bin,"
+		"0 as ji_hist "
 		"from pbs.job where ji_queue = $1"
 		" order by ji_qrank");
 	if (db_prepare_stmt(conn, STMT_FINDJOBS_BYQUE_ORDBY_QRANK,
@@ -247,10 +336,29 @@ db_prepare_job_sqls(void *conn)
 	if (db_prepare_stmt(conn, STMT_DELETE_JOB, conn_sql, 1) != 0)
 		return -1;
 
+	snprintf(conn_sql, MAX_SQL_LENGTH, "delete from pbs.job_hist where ji_jobid = $1");
+	if (db_prepare_stmt(conn, STMT_DELETE_JOBHIST, conn_sql, 1) != 0)
+		return -1;
+
 	snprintf(conn_sql, MAX_SQL_LENGTH, "delete from pbs.job_scr where ji_jobid = $1");
 	if (db_prepare_stmt(conn, STMT_DELETE_JOBSCR, conn_sql, 1) != 0)
 		return -1;
 
+	/*
+	 * The insert into pbs.job_hist is routed into the partition of the
+	 * day by a trigger, see pbs_db_schema.sql
+	 */
+	snprintf(conn_sql, MAX_SQL_LENGTH, "with moved as "
+		"(delete from pbs.job where ji_jobid = $1 returning *) "
+		"insert into pbs.job_hist select * from moved");
+	if (db_prepare_stmt(conn, STMT_MOVE_JOBHIST, conn_sql, 1) != 0)
+		return -1;
+
+	snprintf(conn_sql, MAX_SQL_LENGTH, "select pbs.job_hist_expire("
+		"to_timestamp($1::bigint)::timestamp) as dropped");
+	if (db_prepare_stmt(conn, STMT_EXPIRE_JOBHIST, conn_sql, 1) != 0)
+		return -1;
+
 	return 0;
 }
 
@@ -288,6 +396,8 @@ load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
 	static int ji_credtype_fnum;
 	static int ji_qrank_fnum;
 	static int attributes_fnum;
+	static int attributes_bin_fnum;
+	static int ji_hist_fnum;
 	static int fnums_inited = 0;
 
 	if (fnums_inited == 0) {
@@ -309,6 +419,8 @@ load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
 		ji_qrank_fnum = PQfnumber(res, "ji_qrank");
 		ji_credtype_fnum = PQfnumber(res, "ji_credtype");
 		attributes_fnum = PQfnumber(res, "attributes");
+		attributes_bin_fnum = PQfnumber(res, "attributes_bin");
+		ji_hist_fnum = PQfnumber(res, "ji_hist");
 		fnums_inited = 1;
 	}
 
@@ -328,8 +440,19 @@ load_job(const  PGresult *res, pbs_db_job_info_t *pj, int row)
 	GET_PARAM_STR(res, row, pj->ji_jid, ji_jid_fnum);
 	GET_PARAM_INTEGER(res, row, pj->ji_credtype, ji_credtype_fnum);
 	GET_PARAM_BIGINT(res, row, pj->ji_qrank, ji_qrank_fnum);
+	GET_PARAM_INTEGER(res, row, pj->ji_hist, ji_hist_fnum);
 	GET_PARAM_BIN(res, row, raw_array, attributes_fnum);
 
+	/* attributes in binary form are handed back as is, the caller frees them */
+	pj->db_attr_blob = NULL;
+	pj->db_attr_bloblen = 0;
+	if (!PQgetisnull(res, row, attributes_bin_fnum)) {
+		pj->db_attr_bloblen = PQgetlength(res, row, attributes_bin_fnum);
+		if ((pj->db_attr_blob = malloc(pj->db_attr_bloblen)) == NULL)
+			return -1;
+		memcpy(pj->db_attr_blob, PQgetvalue(res, row, attributes_bin_fnum), pj->db_attr_bloblen);
+	}
+
 	/* convert attributes from postgres raw array format */
 	return (dbarray_to_attrlist(raw_array, &pj->db_attr_list));
 }
@@ -376,30 +499,47 @@ pbs_db_save_job(void *conn, pbs_db_obj_info_t *obj, int savetype)
 		SET_PARAM_INTEGER(conn_data, pjob->ji_credtype, 14);
 		SET_PARAM_BIGINT(conn_data, pjob->ji_qrank, 15);
 
-		stmt = STMT_UPDATE_JOB_QUICK;
+		stmt = pjob->ji_hist ? STMT_UPDATE_JOBHIST_QUICK : STMT_UPDATE_JOB_QUICK;
 		params = 16;
 	}
 
-	if ((pjob->db_attr_list.attr_count > 0) || (savetype & OBJ_SAVE_NEW)) {
+	if (pjob->db_attr_blob) {
+		if (savetype & OBJ_SAVE_QS) {
+			SET_PARAM_BIN(conn_data, pjob->db_attr_blob, pjob->db_attr_bloblen, 16);
+			params = 17;
+			stmt = pjob->ji_hist ? STMT_UPDATE_JOBHIST_BIN : STMT_UPDATE_JOB_BIN;
+		} else {
+			SET_PARAM_BIN(conn_data, pjob->db_attr_blob, pjob->db_attr_bloblen, 1);
+			params = 2;
+			stmt = pjob->ji_hist ? STMT_UPDATE_JOBHIST_BIN_ATTRSONLY : STMT_UPDATE_JOB_BIN_ATTRSONLY;
+		}
+	} else if ((pjob->db_attr_list.attr_count > 0) || (pjob->db_attr_hot.attr_count > 0) ||
+		(savetype & OBJ_SAVE_NEW)) {
 		int len = 0;
+		int hot_len = 0;
+		char *hot_array = NULL;
 		/* convert attributes to postgres raw array format */
 
 		if ((len = attrlist_to_dbarray(&raw_array, &pjob->db_attr_list)) <= 0)
 			return -1;
+		if ((hot_len = attrlist_to_dbarray2(&hot_array, &pjob->db_attr_hot)) <= 0)
+			return -1;
 
 		if (savetype & OBJ_SAVE_QS) {
 			SET_PARAM_BIN(conn_data, raw_array, len, 16);
-			params = 17;
-			stmt = STMT_UPDATE_JOB;
+			SET_PARAM_BIN(conn_data, hot_array, hot_len, 17);
+			params = 18;
+			stmt = pjob->ji_hist ? STMT_UPDATE_JOBHIST : STMT_UPDATE_JOB;
 		} else {
 			SET_PARAM_BIN(conn_data, raw_array, len, 1);
-			params = 2;
-			stmt = STMT_UPDATE_JOB_ATTRSONLY;
+			SET_PARAM_BIN(conn_data, hot_array, hot_len, 2);
+			params = 3;
+			stmt = pjob->ji_hist ? STMT_UPDATE_JOBHIST_ATTRSONLY : STMT_UPDATE_JOB_ATTRSONLY;
 		}
 	}
 
 	if (savetype & OBJ_SAVE_NEW)
-		stmt = STMT_INSERT_JOB;
+		stmt = pjob->db_attr_blob ? STMT_INSERT_JOB_BIN : STMT_INSERT_JOB;
 
 	if (stmt)
 		rc = db_cmd(conn, stmt, params);
@@ -469,15 +609,61 @@ pbs_db_find_job(void *conn, void *st, pbs_db_obj_info_t *obj,
 	if (!state)
 		return -1;
 
-	if (opts != NULL && opts->flags == FIND_JOBS_BY_QUE) {
-		SET_PARAM_STR(conn_data, pdjob->ji_queue, 0);
-		params=1;
-		strcpy(conn_sql, STMT_FINDJOBS_BYQUE_ORDBY_QRANK);
-	} else {
-		strcpy(conn_sql, STMT_FINDJOBS_ORDBY_QRANK);
-		params=0;
+	if (opts == NULL || opts->flags != FIND_JOBS_BY_QUE) {
+		char since[96] = "";
+		char cols[MAX_SQL_LENGTH];
+		int n;
+		int keys_only = (opts != NULL && (opts->flags & FIND_JOBS_KEYS_ONLY));
+
+		/*
+		 * All the jobs are loaded at server start, stream them through a
+		 * cursor rather than holding the whole table in one resultset.
+		 * A timestamp limits the rows to the ones saved since then, and
+		 * keys only leaves the attributes out, so a caller keeping its own
+		 * copy of the jobs can cheaply catch up and find the deleted ones.
+		 * The finished jobs come from the history tables, ji_hist tells
+		 * them apart.
+		 */
+		if (opts != NULL && opts->timestamp > 0)
+			snprintf(since, sizeof(since), "where ji_savetm >= to_timestamp(%ld)::timestamp ",
+				(long) opts->timestamp);
+
+		n = snprintf(cols, sizeof(cols), "select "
+			"ji_jobid,"
+			"ji_state,"
+			"ji_substate,"
+			"ji_svrflags,"
+			"ji_stime,"
+			"ji_queue,"
+			"ji_destin,"
+			"ji_un_type,"
+			"ji_exitstat,"
+			"ji_quetime,"
+			"ji_rteretry,"
+			"ji_fromsock,"
+			"ji_fromaddr,"
+			"ji_jid,"
+			"ji_credtype,"
+			"ji_qrank,"
+			"%s,",
+			keys_only ? "hstore_to_array(''::hstore) as attributes, NULL::bytea as attributes_bin" :
+				"hstore_to_array(attributes || attributes_hot) as attributes, attributes_bin");
+		if (n < 0 || n >= sizeof(cols))
+			return -1;
+
+		/* never send a truncated query */
+		n = snprintf(conn_sql, sizeof(conn_sql), "%s0 as ji_hist from pbs.job %s"
+			"union all %s1 as ji_hist from pbs.job_hist %sorder by ji_qrank",
+			cols, since, cols, since);
+		if (n < 0 || n >= sizeof(conn_sql))
+			return -1;
+		return (db_cursor_open(conn, state, CURSOR_FINDJOBS_ORDBY_QRANK, conn_sql));
 	}
 
+	SET_PARAM_STR(conn_data, pdjob->ji_queue, 0);
+	params=1;
+	strcpy(conn_sql, STMT_FINDJOBS_BYQUE_ORDBY_QRANK);
+
 	if ((rc = db_query(conn, conn_sql, params, &res)) != 0)
 		return rc;
 
@@ -529,7 +715,7 @@ pbs_db_delete_job(void *conn, pbs_db_obj_info_t *obj)
 
 	SET_PARAM_STR(conn_data, pj->ji_jobid, 0);
 
-	if ((rc = db_cmd(conn, STMT_DELETE_JOB, 1)) == -1)
+	if ((rc = db_cmd(conn, pj->ji_hist ? STMT_DELETE_JOBHIST : STMT_DELETE_JOB, 1)) == -1)
 		goto err;
 
 	if (db_cmd(conn, STMT_DELETE_JOBSCR, 1) == -1)
@@ -540,6 +726,64 @@ err:
 	return -1;
 }
 
+/**
+ * @brief
+ *	Move a finished job from pbs.job to the history tables.  From then on
+ *	the job is saved with ji_hist set.
+ *
+ * @param[in]	conn - Connection handle
+ * @param[in]	obj  - Job information
+ *
+ * @return      Error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+int
+pbs_db_move_job_hist(void *conn, pbs_db_obj_info_t *obj)
+{
+	pbs_db_job_info_t *pj = obj->pbs_db_un.pbs_db_job;
+
+	SET_PARAM_STR(conn_data, pj->ji_jobid, 0);
+
+	/* the routing trigger swallows the row, so no rows is no error */
+	if (db_cmd(conn, STMT_MOVE_JOBHIST, 1) == -1)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Drop the partitions of the history tables that only hold jobs which
+ *	finished before a given time, along with the scripts of their jobs
+ *
+ * @param[in]	conn   - Connection handle
+ * @param[in]	before - Jobs that finished before this time have expired
+ *
+ * @return      Error code
+ * @retval	-1 - Failure
+ * @retval	>=0 - Number of partitions dropped
+ *
+ */
+int
+pbs_db_expire_job_hist(void *conn, time_t before)
+{
+	PGresult *res;
+	int dropped = 0;
+	int rc;
+
+	SET_PARAM_BIGINT(conn_data, before, 0);
+
+	if ((rc = db_query(conn, STMT_EXPIRE_JOBHIST, 1, &res)) != 0)
+		return (rc == 1 ? 0 : -1);
+
+	GET_PARAM_INTEGER(res, 0, dropped, PQfnumber(res, "dropped"));
+	PQclear(res);
+
+	return dropped;
+}
+
 /**
  * @brief
  *	Insert job script
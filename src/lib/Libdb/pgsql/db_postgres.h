@@ -61,6 +61,7 @@ extern "C" {
 #include <libpq-fe.h>
 #include <netinet/in.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <inttypes.h>
 #include "net_connect.h"
 #include "list_link.h"
@@ -88,7 +89,18 @@ extern "C" {
 #define STMT_UPDATE_JOB "update_job"
 #define STMT_UPDATE_JOB_ATTRSONLY "update_job_attrsonly"
 #define STMT_UPDATE_JOB_QUICK "update_job_quick"
-#define STMT_FINDJOBS_ORDBY_QRANK "findjobs_ordby_qrank"
+#define STMT_INSERT_JOB_BIN "insert_job_bin"
+#define STMT_UPDATE_JOB_BIN "update_job_bin"
+#define STMT_UPDATE_JOB_BIN_ATTRSONLY "update_job_bin_attrsonly"
+#define STMT_UPDATE_JOBHIST "update_jobhist"
+#define STMT_UPDATE_JOBHIST_ATTRSONLY "update_jobhist_attrsonly"
+#define STMT_UPDATE_JOBHIST_QUICK "update_jobhist_quick"
+#define STMT_UPDATE_JOBHIST_BIN "update_jobhist_bin"
+#define STMT_UPDATE_JOBHIST_BIN_ATTRSONLY "update_jobhist_bin_attrsonly"
+#define STMT_MOVE_JOBHIST "move_jobhist"
+#define STMT_DELETE_JOBHIST "delete_jobhist"
+#define STMT_EXPIRE_JOBHIST "expire_jobhist"
+#define CURSOR_FINDJOBS_ORDBY_QRANK "findjobs_ordby_qrank_cur"
 #define STMT_FINDJOBS_BYQUE_ORDBY_QRANK "findjobs_byque_ordby_qrank"
 #define STMT_DELETE_JOB "delete_job"
 #define STMT_REMOVE_JOBATTRS "remove_jobattrs"
@@ -184,6 +196,20 @@ struct postgres_conn_data {
 };
 typedef struct postgres_conn_data pg_conn_data_t;
 
+/**
+ * @brief
+ * A batch of statements sent in pipeline mode, waiting for its results.
+ */
+struct db_async_batch
+{
+	pbs_db_async_cb_t cb;	/* called once the batch completed */
+	void *arg;
+	int rc;			/* -1 if any statement of the batch failed */
+	struct timeval sent;	/* when the batch was sent, see pfn_db_round_trip */
+	struct db_async_batch *next;
+};
+typedef struct db_async_batch db_async_batch_t;
+
 /**
  * @brief
  * Postgres transaction management helper structure.
@@ -192,7 +218,10 @@ struct pg_conn_trx
 {
 	int conn_trx_nest;	   /* incr/decr with each begin/end trx */
 	int conn_trx_rollback; /* rollback flag in case of nested trx */
-	int conn_trx_async;	   /* 1 - async, 0 - sync, one-shot reset */
+	int conn_trx_async;	   /* 1 - statements are queued to the pipeline */
+	db_async_batch_t *conn_async_head; /* sent batches, oldest first */
+	db_async_batch_t *conn_async_tail;
+	db_async_batch_t *conn_async_cur;  /* batch being queued */
 };
 typedef struct pg_conn_trx pg_conn_trx_t;
 
@@ -212,9 +241,13 @@ struct db_query_state {
 	int row;
 	int count;
 	query_cb_t query_cb;
+	char *cursor;	/* name of the server side cursor the rows come from, if any */
 };
 typedef struct db_query_state db_query_state_t;
 
+/* rows fetched from a server side cursor at a time */
+#define DB_CURSOR_FETCH_ROWS 1000
+
 /**
  * @brief
  * Each database object type supports most of the following 6 operations:
@@ -338,10 +371,12 @@ void db_set_error(void *conn, char **conn_db_err, char *fnc, char *msg, char *ms
 int db_prepare_stmt(void *conn, char *stmt, char *sql, int num_vars);
 int db_cmd(void *conn, char *stmt, int num_vars);
 int db_query(void *conn, char *stmt, int num_vars, PGresult **res);
+int db_cursor_open(void *conn, void *st, char *cursor, char *sql);
 unsigned long long db_ntohll(unsigned long long);
 int dbarray_to_attrlist(char *raw_array, pbs_db_attr_list_t *attr_list);
 int attrlist_to_dbarray(char **raw_array, pbs_db_attr_list_t *attr_list);
 int attrlist_to_dbarray_ex(char **raw_array, pbs_db_attr_list_t *attr_list, int keys_only);
+int attrlist_to_dbarray2(char **raw_array, pbs_db_attr_list_t *attr_list);
 
 /* job functions */
 int pbs_db_save_job(void *conn, pbs_db_obj_info_t *obj, int savetype);
@@ -56,7 +56,7 @@ CREATE TABLE pbs.info (
     pbs_schema_version TEXT    NOT NULL
 );
 
-INSERT INTO pbs.info values('1.5.0'); /* schema version */
+INSERT INTO pbs.info values('1.8.0'); /* schema version */
 
 ---------------------- SERVER ------------------------------
 
@@ -179,8 +179,10 @@ CREATE TABLE pbs.job (
     ji_savetm       TIMESTAMP   NOT NULL,
     ji_creattm      TIMESTAMP   NOT NULL,
     attributes      hstore      NOT NULL default '',
+    attributes_bin  BYTEA,      /* attributes in binary form, see db_binary_attributes */
+    attributes_hot  hstore      NOT NULL default '', /* the often changed attributes */
     CONSTRAINT jobid_pk PRIMARY KEY (ji_jobid)
-);
+) WITH (fillfactor = 80); /* room for the updates to stay on the page */
 
 CREATE INDEX job_rank_idx
 ON pbs.job
@@ -190,6 +192,54 @@ ON pbs.job
 /*
  * Table pbs.job_scr holds the job script
  */
+/*
+ * Finished jobs are moved out of pbs.job into pbs.job_hist, so pbs.job only
+ * holds the active ones.  pbs.job_hist itself stays empty: its rows are
+ * routed into a table per day the jobs finished on, pbs.job_hist_YYYYMMDD,
+ * and expired history is dropped a day at a time by pbs.job_hist_expire()
+ * rather than deleted row by row.
+ */
+CREATE TABLE pbs.job_hist (LIKE pbs.job INCLUDING DEFAULTS);
+
+CREATE FUNCTION pbs.job_hist_route() RETURNS TRIGGER AS $$
+DECLARE
+    part TEXT := 'job_hist_' || to_char(localtimestamp, 'YYYYMMDD');
+BEGIN
+    IF NOT EXISTS (SELECT 1 FROM pg_tables WHERE schemaname = 'pbs' AND tablename = part) THEN
+        EXECUTE 'CREATE TABLE pbs.' || part || ' (CONSTRAINT ' || part ||
+            '_pk PRIMARY KEY (ji_jobid)) INHERITS (pbs.job_hist)';
+    END IF;
+    /* a reused jobid replaces the history of the earlier job */
+    DELETE FROM pbs.job_hist WHERE ji_jobid = NEW.ji_jobid;
+    EXECUTE 'INSERT INTO pbs.' || part || ' SELECT ($1).*' USING NEW;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER job_hist_route_trg
+BEFORE INSERT ON pbs.job_hist
+FOR EACH ROW EXECUTE PROCEDURE pbs.job_hist_route();
+
+CREATE FUNCTION pbs.job_hist_expire(before TIMESTAMP) RETURNS INTEGER AS $$
+DECLARE
+    part TEXT;
+    dropped INTEGER := 0;
+BEGIN
+    FOR part IN SELECT tablename FROM pg_tables
+        WHERE schemaname = 'pbs' AND tablename ~ '^job_hist_[0-9]{8}$'
+        AND to_date(substr(tablename, 10), 'YYYYMMDD') + 1 <= before
+    LOOP
+        EXECUTE 'DELETE FROM pbs.job_scr s USING pbs.' || part || ' h ' ||
+            'WHERE s.ji_jobid = h.ji_jobid AND NOT EXISTS ' ||
+            '(SELECT 1 FROM pbs.job j WHERE j.ji_jobid = h.ji_jobid)';
+        EXECUTE 'DROP TABLE pbs.' || part;
+        dropped := dropped + 1;
+    END LOOP;
+    RETURN dropped;
+END;
+$$ LANGUAGE plpgsql;
+
+
 CREATE TABLE pbs.job_scr (
     ji_jobid    TEXT       NOT NULL,
     script      TEXT
@@ -45,6 +45,7 @@
 #include "dis.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
+#include "mem_acct.h"
 
 #define PKT_MAGIC    "PKTV1"
 #define PKT_MAGIC_SZ sizeof(PKT_MAGIC)
@@ -53,6 +54,7 @@
 static pbs_dis_buf_t *dis_get_readbuf(int);
 static pbs_dis_buf_t *dis_get_writebuf(int);
 static int dis_resize_buf(pbs_dis_buf_t *, size_t);
+static int dis_can_send_early(pbs_dis_buf_t *);
 static int transport_chan_is_encrypted(int);
 
 /**
@@ -246,14 +248,17 @@ transport_chan_is_encrypted(int fd)
 
 /**
  * @brief
- * 	send pkt from given DIS buffer over network
- * 	after patching pkt header for data size and
- * 	if not encrypted already and chan is encrypted
- * 	then encrypt data before send
+ * 	send data straight from the caller's memory as a pkt of its own
+ *
+ * 	The header is built on the stack and sent together with the data
+ * 	through transport_sendv(), so the data is never copied into a DIS
+ * 	buffer. If the channel is encrypted, the data is encrypted first and
+ * 	the encrypted data is sent the same way.
  *
  * @param[in] fd - file descriptor
- * @param[in] tp - pointer to DIS buffer
- * @param[in] encrypt_done - is data already encrypted
+ * @param[in] type - type of pkt
+ * @param[in] data - pkt data
+ * @param[in] len - length of data
  *
  * @return int
  *
@@ -267,26 +272,72 @@ transport_chan_is_encrypted(int fd)
  *
  */
 static int
-__send_pkt(int fd, pbs_dis_buf_t *tp, int encrypt_done)
+__send_pkt_direct(int fd, int type, const char *data, size_t len)
 {
+	char pkthdr[PKT_HDR_SZ];
+	void *data_out = NULL;
+	size_t len_out;
 	int i;
 
-	if (!encrypt_done && transport_chan_is_encrypted(fd)) {
+	if (transport_chan_is_encrypted(fd)) {
 		void *authctx = transport_chan_get_authctx(fd, FOR_ENCRYPT);
 		auth_def_t *authdef = transport_chan_get_authdef(fd, FOR_ENCRYPT);
-		void *data_out;
-		size_t len_out;
 
 		if (authdef == NULL || authdef->encrypt_data == NULL)
 			return -1;
 
-		if (authdef->encrypt_data(authctx, (void *)(tp->tdis_data + PKT_HDR_SZ), tp->tdis_len - PKT_HDR_SZ, &data_out, &len_out) != 0)
+		if (authdef->encrypt_data(authctx, (void *) data, len, &data_out, &len_out) != 0)
 			return -1;
+		data = data_out;
+		len = len_out;
+	}
 
-		dis_resize_buf(tp, len_out + PKT_HDR_SZ);
-		memcpy((void *)(tp->tdis_data + PKT_HDR_SZ), data_out, len_out);
-		free(data_out);
-		tp->tdis_len = len_out + PKT_HDR_SZ;
+	memcpy(pkthdr, PKT_MAGIC, PKT_MAGIC_SZ);
+	pkthdr[PKT_MAGIC_SZ] = (char) type;
+	i = htonl(len);
+	memcpy((void *) &(pkthdr[PKT_HDR_SZ - sizeof(int)]), &i, sizeof(int));
+
+	i = transport_sendv(fd, pkthdr, PKT_HDR_SZ, (void *) data, len);
+	free(data_out);
+	if (i < 0)
+		return i;
+	if (i != PKT_HDR_SZ + len)
+		return -1;
+	return i;
+}
+
+/**
+ * @brief
+ * 	send pkt from given DIS buffer over network
+ * 	after patching pkt header for data size.
+ * 	If chan is encrypted then the data is encrypted
+ * 	and sent without copying it back into the buffer
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] tp - pointer to DIS buffer
+ *
+ * @return int
+ *
+ * @retval >= 0  - success
+ * @retval -1 - failure
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+__send_pkt(int fd, pbs_dis_buf_t *tp)
+{
+	int i;
+
+	if (transport_chan_is_encrypted(fd)) {
+		i = __send_pkt_direct(fd, *(tp->tdis_data + PKT_MAGIC_SZ),
+			tp->tdis_data + PKT_HDR_SZ, tp->tdis_len - PKT_HDR_SZ);
+		if (i >= 0)
+			dis_clear_buf(tp);
+		return i;
 	}
 
 	i = htonl(tp->tdis_len - PKT_HDR_SZ);
@@ -333,34 +384,7 @@ transport_send_pkt(int fd, int type, void *data_in, size_t len_in)
 		return -1;
 
 	dis_clear_buf(tp);
-	dis_resize_buf(tp, len_in + PKT_HDR_SZ);
-	strcpy(tp->tdis_data, PKT_MAGIC);
-	*(tp->tdis_data + PKT_MAGIC_SZ) = (char) type;
-	tp->tdis_pos = tp->tdis_data + PKT_HDR_SZ;
-
-	if (transport_chan_is_encrypted(fd)) {
-		void *authctx = transport_chan_get_authctx(fd, FOR_ENCRYPT);
-		auth_def_t *authdef = transport_chan_get_authdef(fd, FOR_ENCRYPT);
-		void *data_out;
-		size_t len_out;
-
-		if (authdef == NULL || authdef->encrypt_data == NULL)
-			return -1;
-
-		if (authdef->encrypt_data(authctx, data_in, len_in, &data_out, &len_out) != 0)
-			return -1;
-
-		dis_resize_buf(tp, len_out + PKT_HDR_SZ);
-		memcpy(tp->tdis_pos, data_out, len_out);
-		free(data_out);
-		tp->tdis_len = len_out;
-	} else {
-		memcpy(tp->tdis_pos, data_in, len_in);
-		tp->tdis_len = len_in;
-	}
-	tp->tdis_len += PKT_HDR_SZ;
-
-	return __send_pkt(fd, tp, 1);
+	return __send_pkt_direct(fd, type, data_in, len_in);
 }
 
 /**
@@ -422,6 +446,7 @@ __recv_pkt(int fd, int *type, pbs_dis_buf_t *tp)
 			return -1;
 
 		free(tp->tdis_data);
+		mem_acct_add(MEM_ACCT_DIS, 0, (long long)datasz - (long long)tp->tdis_bufsize);
 		tp->tdis_data = data;
 		tp->tdis_bufsize = datasz;
 	}
@@ -557,12 +582,41 @@ dis_resize_buf(pbs_dis_buf_t *tp, size_t needed)
 		} else {
 			tp->tdis_data = tmpcp;
 			tp->tdis_bufsize = tp->tdis_bufsize + needed + PBS_DIS_BUFSZ;
+			mem_acct_add(MEM_ACCT_DIS, 0, needed + PBS_DIS_BUFSZ);
 			tp->tdis_pos = tp->tdis_data + offset;
 		}
 	}
 	return 0;
 }
 
+/**
+ * @brief
+ * 	dis_can_send_early - tell whether data buffered for writing may be
+ * 	sent before dis_flush() is called
+ *
+ * 	Packets can only be cut between two dis_puts() calls on transports
+ * 	which read a DIS message across packets (TCP, see DIS_tcp_funcs()), and
+ * 	not while the caller holds the buffer to copy from it.
+ *
+ * @param[in] tp - write buffer
+ *
+ * @return int
+ *
+ * @retval 1 - buffered data may be sent early
+ * @retval 0 - data must stay in the buffer until dis_flush()
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+dis_can_send_early(pbs_dis_buf_t *tp)
+{
+	return (pfn_transport_sendv != NULL && tp->tdis_hold == 0);
+}
+
 /**
  * @brief
  * 	dis_clear_buf - reset dis buffer to empty by updating its counter
@@ -758,6 +812,19 @@ dis_puts(int fd, const char *str, size_t ct)
 
 	if (tp == NULL)
 		return -1;
+	if (dis_can_send_early(tp)) {
+		/* send the packet so far rather than growing the buffer for it */
+		if (tp->tdis_len > PKT_HDR_SZ && tp->tdis_len + ct > PBS_DIS_SEGSZ) {
+			if (__send_pkt(fd, tp) <= 0)
+				return -1;
+		}
+		/* and a large chunk goes out on its own, without being copied */
+		if (tp->tdis_len <= 0 && ct >= PBS_DIS_SEGSZ) {
+			if (__send_pkt_direct(fd, 0, str, ct) < 0)
+				return -1;
+			return ct;
+		}
+	}
 	if (tp->tdis_len <= 0) {
 		if (dis_resize_buf(tp, ct + PKT_HDR_SZ) != 0)
 			return -1;
@@ -774,6 +841,64 @@ dis_puts(int fd, const char *str, size_t ct)
 	return ct;
 }
 
+/**
+ * @brief
+ *	dis_get_pending - get the data buffered for writing but not yet flushed
+ *
+ *	The returned pointer is only valid until the next write to fd, as the
+ *	buffer may be moved when it grows.
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] len - number of bytes buffered, including the packet header
+ *
+ * @return char *
+ *
+ * @retval !NULL - start of the buffered data
+ * @retval NULL - no buffer is associated with fd
+ *
+ * @par MT-safe: Yes
+ *
+ */
+char *
+dis_get_pending(int fd, size_t *len)
+{
+	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+
+	*len = 0;
+	if (tp == NULL)
+		return NULL;
+	*len = tp->tdis_len;
+	return tp->tdis_data;
+}
+
+/**
+ * @brief
+ *	dis_hold_buf - keep data written to fd in its buffer until dis_flush()
+ *
+ *	Set around writes whose bytes are then read back with
+ *	dis_get_pending(), so that no part of them is sent early. Holds nest.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] hold - non-zero to take a hold, zero to release one
+ *
+ * @return void
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+dis_hold_buf(int fd, int hold)
+{
+	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+
+	if (tp == NULL)
+		return;
+	if (hold)
+		tp->tdis_hold++;
+	else if (tp->tdis_hold > 0)
+		tp->tdis_hold--;
+}
+
 /**
  * @brief
  *	flush dis write buffer
@@ -803,7 +928,7 @@ dis_flush(int fd)
 		return -1;
 	if (tp->tdis_len == 0)
 		return 0;
-	if (__send_pkt(fd, tp, 0) <= 0)
+	if (__send_pkt(fd, tp) <= 0)
 		return -1;
 	return 0;
 }
@@ -848,6 +973,8 @@ dis_destroy_chan(int fd)
 			chan->auths[FOR_ENCRYPT].def = NULL;
 			chan->auths[FOR_ENCRYPT].ctx_status = AUTH_STATUS_UNKNOWN;
 		}
+		mem_acct_add(MEM_ACCT_DIS, -1, -(long long)(sizeof(pbs_tcp_chan_t) +
+			chan->readbuf.tdis_bufsize + chan->writebuf.tdis_bufsize));
 		if (chan->readbuf.tdis_data) {
 			free(chan->readbuf.tdis_data);
 			chan->readbuf.tdis_data = NULL;
@@ -890,6 +1017,7 @@ dis_setup_chan(int fd, pbs_tcp_chan_t *(*inner_transport_get_chan)(int) )
 			return;
 		chan = (pbs_tcp_chan_t *) calloc(1, sizeof(pbs_tcp_chan_t));
 		assert(chan != NULL);
+		mem_acct_add(MEM_ACCT_DIS, 1, sizeof(pbs_tcp_chan_t));
 		dis_resize_buf(&(chan->readbuf), PBS_DIS_BUFSZ);
 		dis_resize_buf(&(chan->writebuf), PBS_DIS_BUFSZ);
 		rc = transport_set_chan(fd, chan);
@@ -900,3 +1028,177 @@ dis_setup_chan(int fd, pbs_tcp_chan_t *(*inner_transport_get_chan)(int) )
 	dis_clear_buf(&(chan->readbuf));
 	dis_clear_buf(&(chan->writebuf));
 }
+
+/**
+ * @brief
+ *	dis_is_binary - tell whether integers on fd use the binary encoding
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return int
+ * @retval 1 - binary encoding was negotiated for fd
+ * @retval 0 - fd uses the text encoding
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_is_binary(int fd)
+{
+	pbs_tcp_chan_t *chan;
+
+	if (fd < 0 || pfn_transport_get_chan == NULL)
+		return 0;
+	chan = transport_get_chan(fd);
+	if (chan == NULL)
+		return 0;
+	return chan->is_binary;
+}
+
+/**
+ * @brief
+ *	dis_set_binary - switch the integer encoding used on fd
+ *
+ *	Both peers must switch at the same point of the stream, i.e. right
+ *	after the authentication reply that accepted DIS_BINARY_EXTEND.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] on - non-zero for the binary encoding, zero for text
+ *
+ * @return void
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+dis_set_binary(int fd, int on)
+{
+	pbs_tcp_chan_t *chan;
+
+	if (fd < 0 || pfn_transport_get_chan == NULL)
+		return;
+	chan = transport_get_chan(fd);
+	if (chan != NULL)
+		chan->is_binary = (on != 0);
+}
+
+/**
+ * @brief
+ *	dis_put_binint - write an integer as a varint if fd is binary encoded
+ *
+ *	The first byte holds a continuation bit, the sign bit and the low
+ *	6 bits of the magnitude, each following byte a continuation bit and
+ *	the next 7 bits.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] negate - non-zero if the value is negative
+ * @param[in] value - magnitude of the value
+ *
+ * @return int
+ * @retval DIS_SUCCESS - value written
+ * @retval DIS_PROTO - write buffer error
+ * @retval DIS_NOT_BINARY - fd uses the text encoding, nothing written
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_put_binint(int fd, int negate, u_Long value)
+{
+	char buf[DIS_BINARY_MAXLEN];
+	unsigned char c;
+	int len = 0;
+
+	if (!dis_is_binary(fd))
+		return DIS_NOT_BINARY;
+
+	c = (unsigned char) (value & 0x3f);
+	if (negate)
+		c |= 0x40;
+	value >>= 6;
+	while (value != 0) {
+		buf[len++] = (char) (c | 0x80);
+		c = (unsigned char) (value & 0x7f);
+		value >>= 7;
+	}
+	buf[len++] = (char) c;
+	if (dis_puts(fd, buf, len) != len)
+		return DIS_PROTO;
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ *	dis_get_binint - read a varint written by dis_put_binint()
+ *
+ *	The whole varint is consumed even when its magnitude does not fit,
+ *	so the stream stays in sync for the caller.
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] negate - set to non-zero for a negative value
+ * @param[out] value - magnitude of the value
+ *
+ * @return int
+ * @retval DIS_SUCCESS - value read
+ * @retval DIS_OVERFLOW - magnitude does not fit in u_Long
+ * @retval DIS_PROTO - varint is longer than DIS_BINARY_MAXLEN
+ * @retval DIS_EOD/DIS_EOF - no more data, stream closed
+ * @retval DIS_NOT_BINARY - fd uses the text encoding, nothing read
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_get_binint(int fd, int *negate, u_Long *value)
+{
+	pbs_tcp_chan_t *chan;
+	pbs_dis_buf_t *tp;
+	unsigned char c;
+	unsigned shift = 6;
+	int len = 0;
+	int overflow = 0;
+	u_Long locval = 0;
+
+	if (fd < 0 || pfn_transport_get_chan == NULL)
+		return DIS_NOT_BINARY;
+	chan = transport_get_chan(fd);
+	if (chan == NULL || !chan->is_binary)
+		return DIS_NOT_BINARY;
+	tp = &chan->readbuf;
+
+	do {
+		if (tp->tdis_len <= 0) {
+			int unused;
+			int rc;
+
+			dis_clear_buf(tp);
+			if ((rc = __recv_pkt(fd, &unused, tp)) <= 0) {
+				dis_clear_buf(tp);
+				return (rc == -2) ? DIS_EOF : DIS_EOD;
+			}
+		}
+		c = (unsigned char) *tp->tdis_pos;
+		tp->tdis_pos++;
+		tp->tdis_len--;
+		if (len++ == 0) {
+			*negate = (c & 0x40) != 0;
+			locval = c & 0x3f;
+		} else if (len > DIS_BINARY_MAXLEN) {
+			return DIS_PROTO;
+		} else {
+			u_Long bits = c & 0x7f;
+
+			if (shift > 57 && (bits >> (64 - shift)) != 0)
+				overflow = 1;
+			locval |= bits << shift;
+			shift += 7;
+		}
+	} while (c & 0x80);
+
+	if (overflow) {
+		*value = ~((u_Long) 0);
+		return DIS_OVERFLOW;
+	}
+	*value = locval;
+	return DIS_SUCCESS;
+}
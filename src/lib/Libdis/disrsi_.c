@@ -73,6 +73,20 @@ disrsi_(int stream, int *negate, unsigned *value, unsigned count, int recursv)
 	assert(count);
 	assert(stream >= 0);
 
+	if (recursv == 0) {
+		/* top level call, the stream may carry binary integers */
+		u_Long binval = 0;
+		int rc = dis_get_binint(stream, negate, &binval);
+
+		if (rc != DIS_NOT_BINARY) {
+			if (rc == DIS_SUCCESS && binval > UINT_MAX)
+				rc = DIS_OVERFLOW;
+			if (rc == DIS_OVERFLOW)
+				binval = UINT_MAX;
+			*value = (unsigned) binval;
+			return (rc);
+		}
+	}
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 	/* dis_umaxd would be initialized by prior call to dis_init_tables */
@@ -75,6 +75,20 @@ disrsl_(int stream, int *negate, unsigned long *value, unsigned long count, int
 	assert(count);
 	assert(stream >= 0);
 
+	if (recursv == 0) {
+		/* top level call, the stream may carry binary integers */
+		u_Long binval = 0;
+		int rc = dis_get_binint(stream, negate, &binval);
+
+		if (rc != DIS_NOT_BINARY) {
+			if (rc == DIS_SUCCESS && binval > ULONG_MAX)
+				rc = DIS_OVERFLOW;
+			if (rc == DIS_OVERFLOW)
+				binval = ULONG_MAX;
+			*value = (unsigned long) binval;
+			return (rc);
+		}
+	}
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 
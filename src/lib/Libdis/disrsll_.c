@@ -92,6 +92,20 @@ disrsll_(int stream, int *negate, u_Long *value, unsigned long count, int recurs
 	assert(count);
 	assert(stream >= 0);
 
+	if (recursv == 0) {
+		/* top level call, the stream may carry binary integers */
+		u_Long binval = 0;
+		int rc = dis_get_binint(stream, negate, &binval);
+
+		if (rc != DIS_NOT_BINARY) {
+			if (rc == DIS_SUCCESS && binval > UlONG_MAX)
+				rc = DIS_OVERFLOW;
+			if (rc == DIS_OVERFLOW)
+				binval = UlONG_MAX;
+			*value = (u_Long) binval;
+			return (rc);
+		}
+	}
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 
@@ -96,8 +96,12 @@ diswl_(int stream, dis_long_double_t value, unsigned ndigs)
 
 	/* Make zero a special case.  If we don't it will blow exponent		*/
 	/* calculation.								*/
+	/* The exponent of zero is written by diswsi() so that it follows	*/
+	/* the binary encoding when one was negotiated.			*/
 	if (value == 0.0L) {
-		return (dis_puts(stream, "+0+0", 4) < 0 ? DIS_PROTO : DIS_SUCCESS);
+		if (dis_puts(stream, "+0", 2) < 0)
+			return (DIS_PROTO);
+		return (diswsi(stream, 0));
 	}
 	/* Extract the sign from the coefficient.				*/
 	ldval = (negate = value < 0.0L) ? -value : value;
@@ -103,6 +103,8 @@ diswsi(int stream, int value)
 		uval = value;
 		c = '+';
 	}
+	if ((retval = dis_put_binint(stream, c == '-', uval)) != DIS_NOT_BINARY)
+		return retval;
 	cp = discui_(&dis_buffer[DIS_BUFSIZ], uval, &ndigs);
 	*--cp = c;
 	while (ndigs > 1)
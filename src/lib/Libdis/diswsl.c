@@ -103,6 +103,8 @@ diswsl(int stream, long value)
 		ulval = value;
 		c = '+';
 	}
+	if ((retval = dis_put_binint(stream, c == '-', ulval)) != DIS_NOT_BINARY)
+		return retval;
 	cp = discul_(&dis_buffer[DIS_BUFSIZ], ulval, &ndigs);
 	*--cp = c;
 	while (ndigs > 1)
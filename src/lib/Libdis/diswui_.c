@@ -69,6 +69,14 @@ diswui_(int stream, unsigned value)
 
 	assert(stream >= 0);
 
+	switch (dis_put_binint(stream, 0, value)) {
+		case DIS_NOT_BINARY:
+			break;
+		case DIS_SUCCESS:
+			return (DIS_SUCCESS);
+		default:
+			return (DIS_PROTO);
+	}
 	cp = discui_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
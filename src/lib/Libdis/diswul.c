@@ -93,6 +93,8 @@ diswul(int stream, unsigned long value)
 	char		*cp;
 
 	assert(stream >= 0);
+	if ((retval = dis_put_binint(stream, 0, value)) != DIS_NOT_BINARY)
+		return retval;
 	cp = discul_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
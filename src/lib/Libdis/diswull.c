@@ -96,7 +96,8 @@ diswull(int stream, u_Long value)
 
 	assert(stream >= 0);
 
-
+	if ((retval = dis_put_binint(stream, 0, value)) != DIS_NOT_BINARY)
+		return retval;
 	cp = discull_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
 	*--cp = '+';
 	while (ndigs > 1)
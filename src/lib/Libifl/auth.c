@@ -44,6 +44,9 @@
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "dis.h"
 #include "pbs_ifl.h"
@@ -320,25 +323,158 @@ is_valid_encrypt_method(char *method)
 
 /**
  * @brief
- *	tcp_send_auth_req - encodes and sends PBS_BATCH_Authenticate request
+ *	get_auth_ext - look for an item in the extend string of an
+ *	authentication request, or in the text of its reply
+ *
+ *	Items are separated by ',' and are either "name" or "name=value".
+ *
+ * @param[in] ext - extend string, may be NULL
+ * @param[in] name - item name
+ * @param[out] val - value of the item, "" if it has none, may be NULL
+ * @param[in] valsz - size of val
+ *
+ * @return	int
+ * @retval	1 - item found
+ * @retval	0 - item not found
+ */
+int
+get_auth_ext(char *ext, char *name, char *val, size_t valsz)
+{
+	size_t nlen = strlen(name);
+	char *p = ext;
+
+	while (p != NULL && *p != '\0') {
+		char *end = strchr(p, ',');
+		size_t len = end ? (size_t) (end - p) : strlen(p);
+
+		if (len >= nlen && strncmp(p, name, nlen) == 0 && (len == nlen || p[nlen] == '=')) {
+			if (val != NULL && valsz > 0) {
+				size_t vlen = (len > nlen) ? len - nlen - 1 : 0;
+
+				if (vlen >= valsz)
+					vlen = valsz - 1;
+				memcpy(val, p + nlen + 1, vlen);
+				val[vlen] = '\0';
+			}
+			return 1;
+		}
+		p = end ? end + 1 : NULL;
+	}
+	return 0;
+}
+
+#ifndef WIN32
+/**
+ * @brief
+ *	_session_file - path of the file caching the session token for a server
+ *
+ * @param[in] host - server host name
+ * @param[in] port - server port
+ * @param[out] path - buffer for the path
+ * @param[in] pathsz - size of path
+ *
+ * @return	int
+ * @retval	0 - path set
+ * @retval	-1 - the user has no home directory to keep the token in
+ */
+static int
+_session_file(char *host, int port, char *path, size_t pathsz)
+{
+	char *home = getenv("HOME");
+
+	if (home == NULL || *home == '\0' || host == NULL)
+		return -1;
+	if (snprintf(path, pathsz, "%s/.pbs_session.%s.%d", home, host, port) >= pathsz)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	_session_load - read a cached session token
+ *
+ *	The file is ignored unless it is a regular file owned by the user
+ *	and not accessible to anybody else.
+ *
+ * @param[in] path - token file
+ * @param[out] token - buffer of AUTH_SESSION_TOKEN_LEN + 1 bytes, "" if none
+ *
+ * @return	void
+ */
+static void
+_session_load(char *path, char *token)
+{
+	struct stat sb;
+	int fd;
+	int n = 0;
+
+	token[0] = '\0';
+	if ((fd = open(path, O_RDONLY | O_NOFOLLOW)) == -1)
+		return;
+	if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_uid == geteuid() &&
+	    (sb.st_mode & (S_IRWXG | S_IRWXO)) == 0)
+		n = read(fd, token, AUTH_SESSION_TOKEN_LEN);
+	close(fd);
+	token[(n == AUTH_SESSION_TOKEN_LEN) ? n : 0] = '\0';
+}
+
+/**
+ * @brief
+ *	_session_save - cache a session token for later commands, best effort
+ *
+ * @param[in] path - token file
+ * @param[in] token - session token
+ *
+ * @return	void
+ */
+static void
+_session_save(char *path, char *token)
+{
+	struct stat sb;
+	int fd;
+
+	if ((fd = open(path, O_WRONLY | O_CREAT | O_NOFOLLOW, 0600)) == -1)
+		return;
+	if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_uid == geteuid() &&
+	    fchmod(fd, 0600) == 0 && ftruncate(fd, 0) == 0) {
+		if (write(fd, token, strlen(token)) == -1)
+			(void) unlink(path);
+	}
+	close(fd);
+}
+#endif
+
+/**
+ * @brief
+ *	_send_auth_req - encodes and sends PBS_BATCH_Authenticate request
+ *
+ *	Besides the binary DIS offer, the request can carry a session to
+ *	resume. On return session holds the token the server issued for this
+ *	connection, if any, and resumed tells whether the server took the
+ *	offered session so that no handshake is needed.
  *
  * @param[in] sock - socket descriptor
  * @param[in] port - parent port in pbs_iff (only used in resvport auth) else 0
  * @param[in] user - authenticating user name
  * @param[in] auth_method - auth method name
  * @param[in] encrypt_method - encrypt method name
+ * @param[in,out] session - cached token ("" for none), NULL to not use sessions
+ * @param[out] resumed - set to 1 if the session was resumed, may be NULL
  *
  * @return	int
  * @retval	0 on success
  * @retval	-1 on error
  */
-int
-tcp_send_auth_req(int sock, unsigned int port, char *user, char *auth_method, char *encrypt_method)
+static int
+_send_auth_req(int sock, unsigned int port, char *user, char *auth_method, char *encrypt_method,
+	       char *session, int *resumed)
 {
 	struct batch_reply *reply;
 	int rc;
 	int am_len;
 	int em_len = encrypt_method ? strlen(encrypt_method) : 0;
+	char ext[sizeof(DIS_BINARY_EXTEND) + sizeof(AUTH_EXT_SESSION) + AUTH_SESSION_TOKEN_LEN + 2] = "";
+	char *rtext;
 
 	if (auth_method == NULL || *auth_method == '\0') {
 		/* auth method can't be null or empty string */
@@ -362,8 +498,24 @@ tcp_send_auth_req(int sock, unsigned int port, char *user, char *auth_method, ch
 		return -1;
 	}
 
+	/* offer the binary integer encoding, only for this very connection */
+	if (port == 0 && pbs_conf.pbs_dis_binary)
+		strcpy(ext, DIS_BINARY_EXTEND);
+	if (session != NULL) {
+		if (ext[0] != '\0')
+			strcat(ext, ",");
+		strcat(ext, AUTH_EXT_SESSION);
+		if (session[0] != '\0') {
+			strcat(ext, "=");
+			strncat(ext, session, AUTH_SESSION_TOKEN_LEN);
+		}
+		session[0] = '\0';
+	}
+	if (resumed != NULL)
+		*resumed = 0;
+
 	if (diswui(sock, port) ||  /* port (only used in resvport auth) */
-		encode_DIS_ReqExtend(sock, NULL)) {
+		encode_DIS_ReqExtend(sock, ext[0] != '\0' ? ext : NULL)) {
 		pbs_errno = PBSE_SYSTEM;
 		return -1;
 	}
@@ -388,11 +540,40 @@ tcp_send_auth_req(int sock, unsigned int port, char *user, char *auth_method, ch
 		return -1;
 	}
 
+	rtext = (reply->brp_choice == BATCH_REPLY_CHOICE_Text) ? reply->brp_un.brp_txt.brp_str : NULL;
+	/* server accepted the offer, switch right after its reply */
+	if (get_auth_ext(rtext, DIS_BINARY_EXTEND, NULL, 0))
+		dis_set_binary(sock, 1);
+	if (session != NULL)
+		(void) get_auth_ext(rtext, AUTH_EXT_SESSION_NEW, session, AUTH_SESSION_TOKEN_LEN + 1);
+	if (resumed != NULL && get_auth_ext(rtext, AUTH_EXT_SESSION_OK, NULL, 0))
+		*resumed = 1;
+
 	PBSD_FreeReply(reply);
 
 	return 0;
 }
 
+/**
+ * @brief
+ *	tcp_send_auth_req - encodes and sends PBS_BATCH_Authenticate request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] port - parent port in pbs_iff (only used in resvport auth) else 0
+ * @param[in] user - authenticating user name
+ * @param[in] auth_method - auth method name
+ * @param[in] encrypt_method - encrypt method name
+ *
+ * @return	int
+ * @retval	0 on success
+ * @retval	-1 on error
+ */
+int
+tcp_send_auth_req(int sock, unsigned int port, char *user, char *auth_method, char *encrypt_method)
+{
+	return _send_auth_req(sock, port, user, auth_method, encrypt_method, NULL, NULL);
+}
+
 /*
  * @brief
  *	_invoke_pbs_iff - call pbs_iff(1) to authenticate user/connection to the PBS server.
@@ -733,6 +914,8 @@ engage_client_auth(int fd, char *hostname, int port, char *ebuf, size_t ebufsz)
 {
 	int rc;
 	static pbs_auth_config_t *config = NULL;
+	char session[AUTH_SESSION_TOKEN_LEN + 1] = "";
+	char session_path[MAXPATHLEN + 1] = "";
 
 	if (config == NULL) {
 		config = make_auth_config(pbs_conf.auth_method,
@@ -758,10 +941,25 @@ engage_client_auth(int fd, char *hostname, int port, char *ebuf, size_t ebufsz)
 			}
 		}
 	} else {
-		if (tcp_send_auth_req(fd, 0, pbs_current_user, pbs_conf.auth_method, pbs_conf.encrypt_method) != 0) {
+		char *sess = NULL;
+		int resumed = 0;
+
+#ifndef WIN32
+		/* sessions never skip setting up encryption */
+		if (pbs_conf.pbs_auth_sessions && pbs_conf.encrypt_method[0] == '\0' &&
+		    _session_file(hostname, port, session_path, sizeof(session_path)) == 0) {
+			_session_load(session_path, session);
+			sess = session;
+		}
+#endif
+		if (_send_auth_req(fd, 0, pbs_current_user, pbs_conf.auth_method, pbs_conf.encrypt_method, sess, &resumed) != 0) {
 			snprintf(ebuf, ebufsz, "Failed to send auth request");
 			return -1;
 		}
+		if (resumed)
+			return 0;
+		if (sess == NULL || session[0] == '\0')
+			session_path[0] = '\0';
 	}
 
 	if (pbs_conf.encrypt_method[0] != '\0') {
@@ -772,7 +970,13 @@ engage_client_auth(int fd, char *hostname, int port, char *ebuf, size_t ebufsz)
 
 	if (strcmp(pbs_conf.auth_method, AUTH_RESVPORT_NAME) != 0) {
 		if (strcmp(pbs_conf.auth_method, pbs_conf.encrypt_method) != 0) {
-			return _handle_client_handshake(fd, hostname, pbs_conf.auth_method, FOR_AUTH, config, ebuf, ebufsz);
+			rc = _handle_client_handshake(fd, hostname, pbs_conf.auth_method, FOR_AUTH, config, ebuf, ebufsz);
+#ifndef WIN32
+			/* the token issued with the reply is good from now on */
+			if (rc == 0 && session_path[0] != '\0')
+				_session_save(session_path, session);
+#endif
+			return rc;
 		} else {
 			transport_chan_set_ctx_status(fd, transport_chan_get_ctx_status(fd, FOR_ENCRYPT), FOR_AUTH);
 			transport_chan_set_authdef(fd, transport_chan_get_authdef(fd, FOR_ENCRYPT), FOR_AUTH);
@@ -49,6 +49,7 @@ static pbs_conn_t * get_connection(int);
 static int destroy_conntable(void);
 static void _destroy_connection(int);
 static int add_connection(int fd);
+static void free_async_reqs(struct pbs_async_req *);
 
 #ifdef WIN32
 #define INVALID_SOCK(x) (x == INVALID_SOCKET || x < 0 || x >= PBS_LOCAL_CONNECTION)
@@ -134,6 +135,18 @@ add_connection(int fd)
 			free(connection[fd]->ch_errtxt);
 		connection[fd]->ch_errtxt = NULL;
 		connection[fd]->ch_errno = 0;
+		pbs_runjobstatfree(connection[fd]->ch_rj_sent);
+		connection[fd]->ch_rj_sent = NULL;
+		connection[fd]->ch_rj_sent_tail = NULL;
+		pbs_runjobstatfree(connection[fd]->ch_rj_failed);
+		connection[fd]->ch_rj_failed = NULL;
+		free_async_reqs(connection[fd]->ch_async_sent);
+		connection[fd]->ch_async_sent = NULL;
+		connection[fd]->ch_async_sent_tail = NULL;
+		pbs_asyncstatfree(connection[fd]->ch_async_done);
+		connection[fd]->ch_async_done = NULL;
+		connection[fd]->ch_async_tag = 0;
+		connection[fd]->ch_submitjob = 0;
 	}
 
 	return 0;
@@ -160,6 +173,10 @@ _destroy_connection(int fd)
 	if (connection[fd]) {
 		if (connection[fd]->ch_errtxt)
 			free(connection[fd]->ch_errtxt);
+		pbs_runjobstatfree(connection[fd]->ch_rj_sent);
+		pbs_runjobstatfree(connection[fd]->ch_rj_failed);
+		free_async_reqs(connection[fd]->ch_async_sent);
+		pbs_asyncstatfree(connection[fd]->ch_async_done);
 		pthread_mutex_destroy(&(connection[fd]->ch_mutex));
 		/*
 		 * DON'T free connection[i]->ch_chan
@@ -416,6 +433,67 @@ get_conn_errno(int fd)
 	return err;
 }
 
+/**
+ * @brief
+ * 	set_conn_submitjob - record whether the server takes PBS_BATCH_SubmitJob
+ *
+ * @param[in] fd - socket number
+ * @param[in] on - non-zero if the server said so in its Connect reply
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - error
+ *
+ * @par MT-safe: Yes
+ */
+int
+set_conn_submitjob(int fd, int on)
+{
+	pbs_conn_t *p = NULL;
+
+	if (INVALID_SOCK(fd))
+		return -1;
+
+	LOCK_TABLE(-1);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(-1);
+		return -1;
+	}
+	p->ch_submitjob = (on != 0);
+	UNLOCK_TABLE(-1);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	get_conn_submitjob - tell whether the server takes PBS_BATCH_SubmitJob
+ *
+ * @param[in] fd - socket number
+ *
+ * @return int
+ * @retval 1 - it does
+ * @retval 0 - it does not, or it is not known
+ *
+ * @par MT-safe: Yes
+ */
+int
+get_conn_submitjob(int fd)
+{
+	pbs_conn_t *p = NULL;
+	int on = 0;
+
+	if (INVALID_SOCK(fd))
+		return 0;
+
+	LOCK_TABLE(0);
+	p = get_connection(fd);
+	if (p != NULL)
+		on = p->ch_submitjob;
+	UNLOCK_TABLE(0);
+	return on;
+}
+
 /**
  * @brief
  * 	set_conn_chan - set connection tcp chan synchronously
@@ -523,3 +601,365 @@ get_conn_mutex(int fd)
 	UNLOCK_TABLE(NULL);
 	return mutex;
 }
+
+/**
+ * @brief
+ * 	add_conn_runjob - queue a pipelined run job request whose reply
+ * 	has not been read yet on connection
+ *
+ * @param[in] fd - socket number
+ * @param[in] rs - the request, owned by the connection from now on
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+int
+add_conn_runjob(int fd, struct batch_runjob_status *rs)
+{
+	pbs_conn_t *p = NULL;
+
+	if (INVALID_SOCK(fd) || rs == NULL)
+		return -1;
+
+	LOCK_TABLE(-1);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(-1);
+		return -1;
+	}
+	rs->next = NULL;
+	if (p->ch_rj_sent_tail != NULL)
+		p->ch_rj_sent_tail->next = rs;
+	else
+		p->ch_rj_sent = rs;
+	p->ch_rj_sent_tail = rs;
+	UNLOCK_TABLE(-1);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	get_conn_runjob - take the oldest pipelined run job request
+ * 	whose reply has not been read yet off connection
+ *
+ * @param[in] fd - socket number
+ *
+ * @return struct batch_runjob_status *
+ * @retval !NULL - the request, now owned by the caller
+ * @retval NULL - no reply outstanding or error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+struct batch_runjob_status *
+get_conn_runjob(int fd)
+{
+	pbs_conn_t *p = NULL;
+	struct batch_runjob_status *rs = NULL;
+
+	if (INVALID_SOCK(fd))
+		return NULL;
+
+	LOCK_TABLE(NULL);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(NULL);
+		return NULL;
+	}
+	rs = p->ch_rj_sent;
+	if (rs != NULL) {
+		p->ch_rj_sent = rs->next;
+		if (p->ch_rj_sent == NULL)
+			p->ch_rj_sent_tail = NULL;
+		rs->next = NULL;
+	}
+	UNLOCK_TABLE(NULL);
+	return rs;
+}
+
+/**
+ * @brief
+ * 	add_conn_runjob_failure - keep a pipelined run job request the
+ * 	server rejected on connection until the caller asks for it
+ *
+ * @param[in] fd - socket number
+ * @param[in] rs - the rejected request, owned by the connection from now on
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+int
+add_conn_runjob_failure(int fd, struct batch_runjob_status *rs)
+{
+	pbs_conn_t *p = NULL;
+	struct batch_runjob_status **prev;
+
+	if (INVALID_SOCK(fd) || rs == NULL)
+		return -1;
+
+	LOCK_TABLE(-1);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(-1);
+		return -1;
+	}
+	/* failures are rare, keep them in the order the requests were sent */
+	for (prev = &(p->ch_rj_failed); *prev != NULL; prev = &((*prev)->next))
+		;
+	rs->next = NULL;
+	*prev = rs;
+	UNLOCK_TABLE(-1);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	get_conn_runjob_failures - take the list of pipelined run job
+ * 	requests the server rejected off connection
+ *
+ * @param[in] fd - socket number
+ *
+ * @return struct batch_runjob_status *
+ * @retval !NULL - the list, now owned by the caller
+ * @retval NULL - no failures or error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+struct batch_runjob_status *
+get_conn_runjob_failures(int fd)
+{
+	pbs_conn_t *p = NULL;
+	struct batch_runjob_status *failed = NULL;
+
+	if (INVALID_SOCK(fd))
+		return NULL;
+
+	LOCK_TABLE(NULL);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(NULL);
+		return NULL;
+	}
+	failed = p->ch_rj_failed;
+	p->ch_rj_failed = NULL;
+	UNLOCK_TABLE(NULL);
+	return failed;
+}
+
+/**
+ * @brief
+ * 	free_async_reqs - free a list of tagged requests
+ *
+ * @param[in] ar - the list
+ *
+ * @return void
+ */
+static void
+free_async_reqs(struct pbs_async_req *ar)
+{
+	struct pbs_async_req *next;
+
+	while (ar != NULL) {
+		next = ar->ar_next;
+		pbs_asyncstatfree(ar->ar_stat);
+		free(ar);
+		ar = next;
+	}
+}
+
+/**
+ * @brief
+ * 	add_conn_async - give a tagged request a tag and queue it on
+ * 	connection until its last reply is read
+ *
+ * @param[in] fd - socket number
+ * @param[in] ar - the request, owned by the connection from now on
+ *
+ * @return unsigned int
+ * @retval !0 - the tag of the request
+ * @retval 0 - error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+unsigned int
+add_conn_async(int fd, struct pbs_async_req *ar)
+{
+	pbs_conn_t *p = NULL;
+	unsigned int tag;
+
+	if (INVALID_SOCK(fd) || ar == NULL || ar->ar_stat == NULL)
+		return 0;
+
+	LOCK_TABLE(0);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(0);
+		return 0;
+	}
+	/* 0 marks an untagged request, skip it on wrap around */
+	if (++p->ch_async_tag == 0)
+		p->ch_async_tag = 1;
+	tag = ar->ar_stat->tag = p->ch_async_tag;
+	ar->ar_next = NULL;
+	if (p->ch_async_sent_tail != NULL)
+		p->ch_async_sent_tail->ar_next = ar;
+	else
+		p->ch_async_sent = ar;
+	p->ch_async_sent_tail = ar;
+	UNLOCK_TABLE(0);
+	return tag;
+}
+
+/**
+ * @brief
+ * 	get_conn_async - find a tagged request still waiting for a reply
+ * 	on connection
+ *
+ * @param[in] fd - socket number
+ * @param[in] tag - tag of the request, 0 for any
+ * @param[in] remove - if set, take the request off connection
+ *
+ * @return struct pbs_async_req *
+ * @retval !NULL - the request, owned by the caller if remove was set
+ * @retval NULL - no such request or error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+struct pbs_async_req *
+get_conn_async(int fd, unsigned int tag, int remove)
+{
+	pbs_conn_t *p = NULL;
+	struct pbs_async_req *prev = NULL;
+	struct pbs_async_req *ar = NULL;
+
+	if (INVALID_SOCK(fd))
+		return NULL;
+
+	LOCK_TABLE(NULL);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(NULL);
+		return NULL;
+	}
+	/* replies mostly come in the order the requests were sent */
+	for (ar = p->ch_async_sent; ar != NULL; prev = ar, ar = ar->ar_next) {
+		if (tag == 0 || ar->ar_stat->tag == tag)
+			break;
+	}
+	if (ar != NULL && remove) {
+		if (prev != NULL)
+			prev->ar_next = ar->ar_next;
+		else
+			p->ch_async_sent = ar->ar_next;
+		if (p->ch_async_sent_tail == ar)
+			p->ch_async_sent_tail = prev;
+		ar->ar_next = NULL;
+	}
+	UNLOCK_TABLE(NULL);
+	return ar;
+}
+
+/**
+ * @brief
+ * 	add_conn_async_done - keep the reply of a tagged request on
+ * 	connection until the caller asks for it
+ *
+ * @param[in] fd - socket number
+ * @param[in] as - the reply, owned by the connection from now on
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+int
+add_conn_async_done(int fd, struct batch_async_status *as)
+{
+	pbs_conn_t *p = NULL;
+
+	if (INVALID_SOCK(fd) || as == NULL)
+		return -1;
+
+	LOCK_TABLE(-1);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(-1);
+		return -1;
+	}
+	/* newest first, get_conn_async_done() puts them back in order */
+	as->next = p->ch_async_done;
+	p->ch_async_done = as;
+	UNLOCK_TABLE(-1);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	get_conn_async_done - take the list of replied tagged requests
+ * 	off connection
+ *
+ * @param[in] fd - socket number
+ *
+ * @return struct batch_async_status *
+ * @retval !NULL - the list in the order the replies came, now owned by the caller
+ * @retval NULL - nothing replied or error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ */
+struct batch_async_status *
+get_conn_async_done(int fd)
+{
+	pbs_conn_t *p = NULL;
+	struct batch_async_status *done = NULL;
+	struct batch_async_status *as;
+	struct batch_async_status *next;
+
+	if (INVALID_SOCK(fd))
+		return NULL;
+
+	LOCK_TABLE(NULL);
+	p = get_connection(fd);
+	if (p == NULL) {
+		UNLOCK_TABLE(NULL);
+		return NULL;
+	}
+	as = p->ch_async_done;
+	p->ch_async_done = NULL;
+	UNLOCK_TABLE(NULL);
+	for (; as != NULL; as = next) {
+		next = as->next;
+		as->next = done;
+		done = as;
+	}
+	return done;
+}
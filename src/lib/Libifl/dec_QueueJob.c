@@ -43,11 +43,13 @@
  * @file	dec_QueueJob.c
  * @brief
  * 	decode_DIS_QueueJob() - decode a Queue Job Batch Request
+ * 	decode_DIS_SubmitJob() - decode a Submit Job Batch Request
  *
  * @par Data items are:
  * 			string	job id
  *			string	destination
  *			list of attributes (attropl)
+ *			counted string	job script (Submit Job only)
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -85,6 +87,11 @@ decode_DIS_QueueJob(int sock, struct batch_request *preq)
 	int rc;
 
 	CLEAR_HEAD(preq->rq_ind.rq_queuejob.rq_attr);
+	preq->rq_ind.rq_queuejob.rq_script = NULL;
+	preq->rq_ind.rq_queuejob.rq_scriptsz = 0;
+	preq->rq_ind.rq_queuejob.rq_credtype = 0;
+	preq->rq_ind.rq_queuejob.rq_cred = NULL;
+	preq->rq_ind.rq_queuejob.rq_credsz = 0;
 	rc = disrfst(sock, PBS_MAXSVRJOBID+1, preq->rq_ind.rq_queuejob.rq_jid);
 	if (rc) return rc;
 
@@ -93,3 +100,82 @@ decode_DIS_QueueJob(int sock, struct batch_request *preq)
 
 	return (decode_DIS_svrattrl(sock, &preq->rq_ind.rq_queuejob.rq_attr));
 }
+
+/**
+ * @brief -
+ *	decode a Submit Job Batch Request
+ *
+ * @par	Functionality:
+ *		The body of a Queue Job request followed by the job script.
+ *		The script is left in the buffer disrcs() allocates for it,
+ *		the server takes that buffer over as the job's script.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+decode_DIS_SubmitJob(int sock, struct batch_request *preq)
+{
+	int rc;
+
+	if ((rc = decode_DIS_QueueJob(sock, preq)) != 0)
+		return rc;
+
+	preq->rq_ind.rq_queuejob.rq_script = disrcs(sock,
+		&preq->rq_ind.rq_queuejob.rq_scriptsz, &rc);
+	if (rc) {
+		free(preq->rq_ind.rq_queuejob.rq_script);
+		preq->rq_ind.rq_queuejob.rq_script = NULL;
+		preq->rq_ind.rq_queuejob.rq_scriptsz = 0;
+	}
+	return rc;
+}
+
+/**
+ * @brief -
+ *	decode an Exec Job Batch Request
+ *
+ * @par	Functionality:
+ *		The body of a Submit Job request followed by the credential type
+ *		and the credential.  An empty script or credential is left NULL.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+decode_DIS_ExecJob(int sock, struct batch_request *preq)
+{
+	int rc;
+
+	if ((rc = decode_DIS_SubmitJob(sock, preq)) != 0)
+		return rc;
+	if (preq->rq_ind.rq_queuejob.rq_scriptsz == 0) {
+		free(preq->rq_ind.rq_queuejob.rq_script);
+		preq->rq_ind.rq_queuejob.rq_script = NULL;
+	}
+
+	preq->rq_ind.rq_queuejob.rq_credtype = disrui(sock, &rc);
+	if (rc)
+		return rc;
+
+	preq->rq_ind.rq_queuejob.rq_cred = disrcs(sock,
+		&preq->rq_ind.rq_queuejob.rq_credsz, &rc);
+	if (rc || (preq->rq_ind.rq_queuejob.rq_credsz == 0)) {
+		free(preq->rq_ind.rq_queuejob.rq_cred);
+		preq->rq_ind.rq_queuejob.rq_cred = NULL;
+		preq->rq_ind.rq_queuejob.rq_credsz = 0;
+	}
+	return rc;
+}
@@ -48,6 +48,7 @@
  * @par	Fields are:
  * 			Protocol ID (unsigned integer)
  *			Protocol Version (unsigned integer)
+ *			Tag (unsigned integer, PBS_BATCH_PROT_VER_TAGGED only)
  *			Request Type (unsignded integer)
  *			User Name (string)
  *
@@ -75,6 +76,8 @@
  *
  * @param[in] sock - socket descriptor
  * @param[out] preq - pointer to batch_request structure
+ * @param[out] proto_type - protocol type
+ * @param[out] proto_ver - protocol version
  *
  * @return	int
  * @retval	-1    on EOF (end of file on first read only)
@@ -98,6 +101,11 @@ decode_DIS_ReqHdr(int sock, struct batch_request *preq, int *proto_type, int *pr
 	if (rc) {
 		return rc;
 	}
+	if (*proto_ver == PBS_BATCH_PROT_VER_TAGGED) {
+		preq->rq_tag = disrui(sock, &rc);
+		if (rc)
+			return rc;
+	}
 
 	preq->rq_type = disrui(sock, &rc);
 	if (rc) {
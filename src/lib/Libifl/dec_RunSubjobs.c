@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file	dec_RunSubjobs.c
+ * @brief
+ * decode_DIS_RunSubjobs() - decode a Run Subjobs Batch Request
+ *
+ *	The batch_request structure must already exist (be allocated by the
+ *	caller.   It is assumed that the header fields (protocol type,
+ *	protocol version, request type, and user name) have already be decoded.
+ *
+ * @par	Data items are:
+ * 			string		parent array job id
+ *			unsigned int	count
+ *			followed by count pairs of
+ *			unsigned int	subjob index
+ *			string		destination
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include "libpbs.h"
+#include "list_link.h"
+#include "server_limits.h"
+#include "attribute.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-decode a Run Subjobs Batch Request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+decode_DIS_RunSubjobs(int sock, struct batch_request *preq)
+{
+	int rc;
+	int count;
+	int i;
+	struct rq_runsubjobs *prs = &preq->rq_ind.rq_runsubjobs;
+
+	prs->rq_count = 0;
+	prs->rq_indices = NULL;
+	prs->rq_destins = NULL;
+
+	rc = disrfst(sock, PBS_MAXSVRJOBID+1, prs->rq_jid);
+	if (rc) return rc;
+
+	count = disrui(sock, &rc);
+	if (rc) return rc;
+	if (count == 0)
+		return DIS_SUCCESS;
+
+	prs->rq_indices = calloc(count, sizeof(int));
+	if (prs->rq_indices == NULL) return DIS_NOMALLOC;
+	prs->rq_destins = calloc(count, sizeof(char *));
+	if (prs->rq_destins == NULL) return DIS_NOMALLOC;
+	/* set the count now so free_br() cleans up a partial decode */
+	prs->rq_count = count;
+
+	for (i = 0; i < count; i++) {
+		prs->rq_indices[i] = disrui(sock, &rc);
+		if (rc) return rc;
+		prs->rq_destins[i] = disrst(sock, &rc);
+		if (rc) return rc;
+	}
+	return rc;
+}
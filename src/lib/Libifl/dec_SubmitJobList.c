@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+
+/**
+ * @file	dec_SubmitJobList.c
+ * @brief
+ * decode_DIS_SubmitJobList() - decode a Submit Job List Batch Request
+ *
+ *	The batch_request structure must already exist (be allocated by the
+ *	caller.   It is assumed that the header fields (protocol type,
+ *	protocol version, request type, and user name) have already be decoded.
+ *
+ * @par	Data items are:
+ *			string		destination
+ *			list of attributes (attropl) shared by all the jobs
+ *			unsigned int	count
+ *			followed by count pairs of
+ *			list of attributes (attropl) of the job
+ *			counted string	job script, empty if none
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include "libpbs.h"
+#include "list_link.h"
+#include "server_limits.h"
+#include "attribute.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-decode a Submit Job List Batch Request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+decode_DIS_SubmitJobList(int sock, struct batch_request *preq)
+{
+	int rc;
+	int count;
+	int i;
+	struct rq_submitjoblist *psj = &preq->rq_ind.rq_submitjoblist;
+	struct rq_submitjob *pj;
+
+	CLEAR_HEAD(psj->rq_attr);
+	psj->rq_count = 0;
+	psj->rq_jobs = NULL;
+
+	rc = disrfst(sock, PBS_MAXSVRJOBID+1, psj->rq_destin);
+	if (rc) return rc;
+
+	if ((rc = decode_DIS_svrattrl(sock, &psj->rq_attr)) != 0)
+		return rc;
+
+	count = disrui(sock, &rc);
+	if (rc) return rc;
+	if (count == 0)
+		return DIS_SUCCESS;
+	if (count > MAX_JOBS_PER_SUBMIT)
+		return DIS_PROTO;
+
+	psj->rq_jobs = calloc(count, sizeof(struct rq_submitjob));
+	if (psj->rq_jobs == NULL) return DIS_NOMALLOC;
+	for (i = 0; i < count; i++)
+		CLEAR_HEAD(psj->rq_jobs[i].rq_attr);
+	/* set the count now so free_br() cleans up a partial decode */
+	psj->rq_count = count;
+
+	for (i = 0; i < count; i++) {
+		pj = &psj->rq_jobs[i];
+		if ((rc = decode_DIS_svrattrl(sock, &pj->rq_attr)) != 0)
+			return rc;
+		pj->rq_script = disrcs(sock, &pj->rq_scriptsz, &rc);
+		if (rc || (pj->rq_scriptsz == 0)) {
+			free(pj->rq_script);
+			pj->rq_script = NULL;
+			pj->rq_scriptsz = 0;
+		}
+		if (rc) return rc;
+	}
+	return rc;
+}
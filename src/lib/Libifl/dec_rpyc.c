@@ -59,6 +59,7 @@
 #include <stdlib.h>
 #include "libpbs.h"
 #include "dis.h"
+#include "pbs_client_thread.h"
 
 /**
  * @brief-
@@ -95,6 +96,9 @@ decode_DIS_replyCmd(int sock, struct batch_reply *reply)
 	int rc = 0;
 	size_t txtlen;
 	preempt_job_info *ppj = NULL;
+	struct pbs_client_thread_context *ctx = NULL;
+	int objtype = MGR_OBJ_NONE;
+	int stream_stop = 0;
 
 	/* first decode "header" consisting of protocol type and version */
 again:
@@ -106,7 +110,11 @@ again:
 	i = disrui(sock, &rc);
 	if (rc != 0)
 		return rc;
-	if (i != PBS_BATCH_PROT_VER)
+	if (i == PBS_BATCH_PROT_VER_TAGGED) {
+		reply->brp_tag = disrui(sock, &rc);
+		if (rc != 0)
+			return rc;
+	} else if (i != PBS_BATCH_PROT_VER)
 		return DIS_PROTO;
 
 	/* next decode code, auxcode and choice (union type identifier) */
@@ -185,7 +193,7 @@ again:
 				pstcmd->text = NULL;
 				pstcmd->attribs = NULL;
 
-				i = disrui(sock, &rc); /* read and discard brp_objtype */
+				objtype = disrui(sock, &rc);
 				if (rc == 0)
 					pstcmd->name = disrst(sock, &rc);
 				if (rc) {
@@ -203,6 +211,27 @@ again:
 
 			if (reply->brp_un.brp_statc)
 				reply->last = pstcmd;
+
+			/*
+			 * Hand each part to the consumer set by pbs_stat_stream() so
+			 * only one part is held at a time.  Server and queue status
+			 * is not streamed, it is merged across servers by the caller.
+			 * Parts of a reply to a tagged request are handed back one
+			 * at a time, other replies may come between them.
+			 */
+			if (reply->brp_tag != 0)
+				break;
+			if (ctx == NULL)
+				ctx = pbs_client_thread_get_context_data();
+			if (ctx != NULL && ctx->th_stat_cb != NULL && reply->brp_un.brp_statc != NULL &&
+				objtype != MGR_OBJ_SERVER && objtype != MGR_OBJ_QUEUE) {
+				if (!stream_stop)
+					stream_stop = ctx->th_stat_cb(reply->brp_un.brp_statc, ctx->th_stat_arg);
+				pbs_statfree(reply->brp_un.brp_statc);
+				reply->brp_un.brp_statc = NULL;
+				reply->last = NULL;
+				pstcx = &reply->brp_un.brp_statc;
+			}
 			if (reply->brp_is_part)
 				goto again;
 			break;
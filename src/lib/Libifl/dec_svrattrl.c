@@ -75,6 +75,7 @@
 #include "list_link.h"
 #include "attribute.h"
 #include "dis.h"
+#include "mem_acct.h"
 
 /**
  * @brief-
@@ -135,6 +136,7 @@ decode_DIS_svrattrl(int sock, pbs_list_head *phead)
 		tsize = sizeof(svrattrl) + data_len;
 		if ((psvrat = (svrattrl *)malloc(tsize)) == 0)
 			return DIS_NOMALLOC;
+		mem_acct_add(MEM_ACCT_SVRATTRL, 1, tsize);
 
 		CLEAR_LINK(psvrat->al_link);
 		psvrat->al_sister = NULL;
@@ -181,7 +183,7 @@ decode_DIS_svrattrl(int sock, pbs_list_head *phead)
 	}
 
 	if (rc) {
-		(void)free(psvrat);
+		attrlist_free(psvrat);
 	}
 
 	return (rc);
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file	enc_ModifyJobList.c
+ * @brief
+ * encode_DIS_ModifyJobList() - encode a Modify Job List Batch Request
+ *
+ * @par	Data items are:
+ * 			unsigned int	count
+ *			followed by count Manage requests, one per job
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include "libpbs.h"
+#include "pbs_error.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-encode a Modify Job List Batch Request
+ *
+ * @par	Functionality:
+ *		Like a Modify Job request for each job in the list, sent as one
+ *		request.  Every job is encoded the way encode_DIS_Manage() would.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobs - list of jobs, name is the job id and attribs the
+ *		     attributes to set on the job
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+encode_DIS_ModifyJobList(int sock, struct batch_status *jobs)
+{
+	struct batch_status *pj;
+	unsigned int count = 0;
+	int rc;
+
+	for (pj = jobs; pj != NULL; pj = pj->next)
+		count++;
+
+	if ((rc = diswui(sock, count)) != 0)
+		return rc;
+
+	for (pj = jobs; pj != NULL; pj = pj->next) {
+		if ((rc = diswui(sock, MGR_CMD_SET)) ||
+			(rc = diswui(sock, MGR_OBJ_JOB)) ||
+			(rc = diswst(sock, pj->name)) ||
+			(rc = encode_DIS_attrl(sock, pj->attribs)))
+			return rc;
+	}
+
+	return DIS_SUCCESS;
+}
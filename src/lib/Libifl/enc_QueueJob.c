@@ -43,14 +43,17 @@
  * @file	enc_QueueJob.c
  * @brief
  * encode_DIS_QueueJob() - encode a Queue Job Batch Request
+ * encode_DIS_SubmitJob() - encode a Submit Job Batch Request
  *
- *	This request is used for the first step in submitting a job, sending
- *	the job attributes.
+ *	The Queue Job request is used for the first step in submitting a job,
+ *	sending the job attributes.  The Submit Job request carries the
+ *	attributes and the job script together.
  *
  * @par Data items are:
  * 			string	job id
  *			string	destination
  *			list of	attribute, see encode_DIS_attropl()
+ *			counted string	job script (Submit Job only)
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -93,3 +96,77 @@ encode_DIS_QueueJob(int sock, char *jobid, char *destin, struct attropl *aoplp)
 
 	return (encode_DIS_attropl(sock, aoplp));
 }
+
+/**
+ * @brief
+ *	-encode a Submit Job Batch Request
+ *
+ * @par	Functionality:
+ *		The body of a Queue Job request with a null job id, followed
+ *		by the whole job script, so a job can be queued in one request.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] destin - destination queue name
+ * @param[in] aoplp - pointer to attropl structure(list)
+ * @param[in] script - the job script
+ * @param[in] scriptsz - length of the job script
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_SubmitJob(int sock, char *destin, struct attropl *aoplp,
+	char *script, size_t scriptsz)
+{
+	int   rc;
+
+	if ((rc = encode_DIS_QueueJob(sock, "", destin, aoplp)) != 0)
+		return rc;
+
+	return (diswcs(sock, script, scriptsz));
+}
+
+/**
+ * @brief
+ *	-encode an Exec Job Batch Request
+ *
+ * @par	Functionality:
+ *		The body of a Queue Job request followed by the job script and the
+ *		job credential, so the server can hand a job to its Mother Superior
+ *		in one message.  The MoM commits the job as soon as it is queued.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobid - job id
+ * @param[in] destin - destination name
+ * @param[in] aoplp - pointer to attropl structure(list)
+ * @param[in] script - the job script, may be NULL
+ * @param[in] scriptsz - length of the job script
+ * @param[in] credtype - type of the credential
+ * @param[in] cred - the credential, may be NULL
+ * @param[in] credsz - length of the credential
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_ExecJob(int sock, char *jobid, char *destin, struct attropl *aoplp,
+	char *script, size_t scriptsz, int credtype, char *cred, size_t credsz)
+{
+	int   rc;
+
+	if (script == NULL)
+		scriptsz = 0;
+	if (cred == NULL)
+		credsz = 0;
+
+	if ((rc = encode_DIS_QueueJob(sock, jobid, destin, aoplp)) != 0 ||
+		(rc = diswcs(sock, script ? script : "", scriptsz)) != 0 ||
+		(rc = diswui(sock, credtype)) != 0)
+		return rc;
+
+	return (diswcs(sock, cred ? cred : "", credsz));
+}
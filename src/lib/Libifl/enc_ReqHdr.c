@@ -46,6 +46,7 @@
  * @par	Fields are:
  * 			Protocol ID (unsigned integer)
  *			Protocol Version (unsigned integer)
+ *			Tag (unsigned integer, PBS_BATCH_PROT_VER_TAGGED only)
  *			Request Type (unsignded integer)
  *			User Name (string)
  */
@@ -82,3 +83,35 @@ encode_DIS_ReqHdr(int sock, int reqt, char *user)
 	}
 	return 0;
 }
+
+/**
+ * @brief
+ *	-encode a Request Header carrying a tag, the server echoes the tag
+ *	in its reply so replies can be matched to requests sent on the
+ *	same connection, in whatever order they come back
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] reqt - request type
+ * @param[in] user - user name
+ * @param[in] tag - tag of the request, not 0
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_ReqHdr_tagged(int sock, int reqt, char *user, unsigned int tag)
+{
+	int rc;
+
+	if ((rc = diswui(sock, PBS_BATCH_PROT_TYPE))		||
+		(rc = diswui(sock, PBS_BATCH_PROT_VER_TAGGED))	||
+		(rc = diswui(sock, tag))			||
+		(rc = diswui(sock, reqt))			||
+		(rc = diswst(sock, user))) {
+		return rc;
+	}
+	return 0;
+}
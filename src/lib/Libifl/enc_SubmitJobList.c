@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+
+/**
+ * @file	enc_SubmitJobList.c
+ * @brief
+ * encode_DIS_SubmitJobList() - encode a Submit Job List Batch Request
+ *
+ * @par	Data items are:
+ *			string		destination
+ *			list of attributes (attropl) shared by all the jobs
+ *			unsigned int	count
+ *			followed by count pairs of
+ *			list of attributes (attropl) of the job
+ *			counted string	job script, empty if none
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include "libpbs.h"
+#include "pbs_error.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-encode a Submit Job List Batch Request
+ *
+ * @par	Functionality:
+ *		Like a Submit Job request for each of the jobs, sent as one
+ *		request.  The attributes shared by all the jobs are sent once.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] destin - destination queue name
+ * @param[in] attrib - attributes shared by all the jobs
+ * @param[in] count - number of jobs
+ * @param[in] job_attribs - attributes of each job, may be NULL
+ * @param[in] scripts - script of each job, may be NULL
+ * @param[in] scriptsz - length of each script
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+encode_DIS_SubmitJobList(int sock, char *destin, struct attropl *attrib, int count,
+	struct attropl **job_attribs, char **scripts, size_t *scriptsz)
+{
+	int i;
+	int rc;
+
+	if (destin == NULL)
+		destin = "";
+
+	if ((rc = diswst(sock, destin)) ||
+		(rc = encode_DIS_attropl(sock, attrib)) ||
+		(rc = diswui(sock, count)))
+		return rc;
+
+	for (i = 0; i < count; i++) {
+		if ((rc = encode_DIS_attropl(sock, job_attribs != NULL ? job_attribs[i] : NULL)))
+			return rc;
+		if ((scripts != NULL) && (scripts[i] != NULL))
+			rc = diswcs(sock, scripts[i], scriptsz[i]);
+		else
+			rc = diswcs(sock, "", 0);
+		if (rc)
+			return rc;
+	}
+
+	return DIS_SUCCESS;
+}
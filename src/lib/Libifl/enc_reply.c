@@ -50,6 +50,9 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "libpbs.h"
 #include "list_link.h"
 #include "attribute.h"
@@ -58,6 +61,51 @@
 
 int encode_DIS_svrattrl(int sock, svrattrl *psattl);
 
+/**
+ * @brief
+ *	encode_status_attrs - encode the attribute list of a status entry
+ *
+ *	If the entry carries an empty brp_enc, the encoded bytes are copied
+ *	into it so that later replies for the same object can send them as is.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] pstat - status entry
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval !0 - DIS error
+ */
+static int
+encode_status_attrs(int sock, struct brp_status *pstat)
+{
+	int rc;
+	size_t start;
+	size_t end;
+	char *data;
+	char *copy;
+
+	if (pstat->brp_enc == NULL || dis_get_pending(sock, &start) == NULL)
+		return encode_DIS_svrattrl(sock, (svrattrl *) GET_NEXT(pstat->brp_attr));
+
+	/* the bytes must still be in the buffer to be copied below */
+	dis_hold_buf(sock, 1);
+	rc = encode_DIS_svrattrl(sock, (svrattrl *) GET_NEXT(pstat->brp_attr));
+	dis_hold_buf(sock, 0);
+	if (rc != 0)
+		return rc;
+
+	data = dis_get_pending(sock, &end);
+	if (data == NULL || end <= start)
+		return 0;
+	/* failing to keep a copy only costs the next reply an encode */
+	if ((copy = malloc(end - start)) != NULL) {
+		memcpy(copy, data + start, end - start);
+		pstat->brp_enc->be_data = copy;
+		pstat->brp_enc->be_len = end - start;
+	}
+	return 0;
+}
+
 
 /**
  * @brief-
@@ -83,7 +131,6 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 	struct brp_select *psel;
 	struct brp_status *pstat;
 	struct batch_deljob_status *pdelstat;
-	svrattrl *psvrl;
 	preempt_job_info *ppj;
 
 	int rc;
@@ -139,8 +186,11 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 				if ((rc = diswui(sock, pstat->brp_objtype)) || (rc = diswst(sock, pstat->brp_objname)))
 					return rc;
 
-				psvrl = (svrattrl *) GET_NEXT(pstat->brp_attr);
-				if ((rc = encode_DIS_svrattrl(sock, psvrl)) != 0)
+				if ((pstat->brp_enc != NULL) && (pstat->brp_enc->be_data != NULL)) {
+					/* attributes already encoded by an earlier reply */
+					if (dis_puts(sock, pstat->brp_enc->be_data, pstat->brp_enc->be_len) != (int) pstat->brp_enc->be_len)
+						return DIS_PROTO;
+				} else if ((rc = encode_status_attrs(sock, pstat)) != 0)
 					return rc;
 				pstat = (struct brp_status *) GET_NEXT(pstat->brp_stlink);
 			}
@@ -240,7 +290,13 @@ encode_DIS_reply(int sock, struct batch_reply *reply)
 	int rc;
 	/* first encode "header" consisting of protocol type and version */
 
-	if ((rc = diswui(sock, PBS_BATCH_PROT_TYPE))   ||
+	if (reply->brp_tag != 0) {
+		/* a reply to a tagged request echoes its tag */
+		if ((rc = diswui(sock, PBS_BATCH_PROT_TYPE))   ||
+			(rc = diswui(sock, PBS_BATCH_PROT_VER_TAGGED)) ||
+			(rc = diswui(sock, reply->brp_tag)))
+				return rc;
+	} else if ((rc = diswui(sock, PBS_BATCH_PROT_TYPE))   ||
 		(rc = diswui(sock, PBS_BATCH_PROT_VER)))
 			return rc;
 
@@ -653,3 +653,142 @@ parse_plus_spec(char *selstr, int *rc)
 
 	return (parse_plus_spec_r(ps, &pe, &hp));
 }
+
+/*
+ * A small cache of parsed select specifications, direct mapped on a hash
+ * of the select string.  A job's select is parsed when it is queued,
+ * altered, given its defaults and summed into its job wide limits; with
+ * the cache the same string is broken up once.  A changed select hashes
+ * to a different entry, so nothing has to invalidate it.
+ */
+#define SELCACHE_SLOTS 64
+static parsed_select *selcache[SELCACHE_SLOTS];
+
+/**
+ * @brief
+ *	free_parsed_select - free a parsed select specification
+ *
+ * @param[in] ps - the parsed select to free
+ */
+static void
+free_parsed_select(parsed_select *ps)
+{
+	int i;
+
+	if (ps == NULL)
+		return;
+	for (i = 0; i < ps->ps_nchunks; i++)
+		free(ps->ps_chunks[i].sc_kv);
+	free(ps->ps_chunks);
+	free(ps->ps_buf);
+	free(ps->ps_select);
+	free(ps);
+}
+
+/**
+ * @brief
+ *	parse_select_spec - break a select specification into its chunks
+ *	the way walking it with parse_plus_spec() and parse_chunk() does
+ *
+ * @param[in] selstr - the select specification, not modified
+ *
+ * @return	parsed_select *
+ * @retval	the parsed select, see get_parsed_select() for its fields
+ * @retval	NULL on a malloc failure
+ */
+static parsed_select *
+parse_select_spec(char *selstr)
+{
+	parsed_select *ps;
+	sel_chunk *chunks;
+	char *chunk;
+	char *last;
+	int nalloc = 0;
+
+	if ((ps = calloc(1, sizeof(parsed_select))) == NULL)
+		return NULL;
+	if (((ps->ps_select = strdup(selstr)) == NULL) ||
+		((ps->ps_buf = strdup(selstr)) == NULL)) {
+		free_parsed_select(ps);
+		return NULL;
+	}
+
+	last = ps->ps_buf;
+	while (*last != '\0') {
+		sel_chunk *sc;
+		int nkve = 0;
+
+		if (*last == '+') {
+			/* invalid string, a chunk starts with + */
+			ps->ps_rc = PBSE_BADNODESPEC;
+			break;
+		}
+		if ((chunk = parse_plus_spec_r(last, &last, NULL)) == NULL)
+			break;
+
+		if (ps->ps_nchunks == nalloc) {
+			nalloc = nalloc ? nalloc * 2 : 4;
+			chunks = realloc(ps->ps_chunks, nalloc * sizeof(sel_chunk));
+			if (chunks == NULL) {
+				free_parsed_select(ps);
+				return NULL;
+			}
+			ps->ps_chunks = chunks;
+		}
+		sc = &ps->ps_chunks[ps->ps_nchunks++];
+		memset(sc, 0, sizeof(sel_chunk));
+		sc->sc_str = chunk;
+#ifdef NAS /* localmod 082 */
+		sc->sc_rc = parse_chunk_r(chunk, 0, &sc->sc_nchk, &sc->sc_nelem, &nkve, &sc->sc_kv, &sc->sc_dflt);
+#else
+		sc->sc_rc = parse_chunk_r(chunk, &sc->sc_nchk, &sc->sc_nelem, &nkve, &sc->sc_kv, &sc->sc_dflt);
+#endif /* localmod 082 */
+		if (sc->sc_rc == PBSE_SYSTEM) {
+			free_parsed_select(ps);
+			return NULL;
+		}
+		if (sc->sc_rc != 0)
+			sc->sc_nelem = 0;
+	}
+	return ps;
+}
+
+/**
+ * @brief
+ *	get_parsed_select - (not thread safe) return a select specification
+ *	broken into its chunks, parsing it only if it is not in the cache
+ *
+ * @par
+ *	The chunks are in ps_chunks in the order parse_plus_spec() returns
+ *	them.  A chunk parse_chunk() fails on has its error in sc_rc and no
+ *	key_value_pairs.  If walking the spec with parse_plus_spec() stops
+ *	on an error, ps_rc holds it and the chunks are those before it.
+ *
+ * @param[in] selstr - the select specification
+ *
+ * @return	parsed_select *
+ * @retval	the parsed select, owned by the cache and only valid until
+ *		the next call
+ * @retval	NULL if selstr is NULL or on a malloc failure
+ */
+parsed_select *
+get_parsed_select(char *selstr)
+{
+	unsigned int h = 5381;
+	parsed_select **slot;
+	char *p;
+
+	if (selstr == NULL)
+		return NULL;
+
+	for (p = selstr; *p != '\0'; p++)
+		h = (h << 5) + h + (unsigned char)*p;
+	slot = &selcache[h % SELCACHE_SLOTS];
+
+	if ((*slot != NULL) && (strcmp((*slot)->ps_select, selstr) == 0))
+		return *slot;
+
+	free_parsed_select(*slot);
+	*slot = parse_select_spec(selstr);
+	return *slot;
+}
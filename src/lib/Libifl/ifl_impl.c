@@ -89,6 +89,86 @@ int pbs_asyrunjob_ack(int c, char *jobid, char *location, char *extend)
 	return (*pfn_pbs_asyrunjob_ack)(c, jobid, location, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to send a pipelined run job batch request
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid- job identifier
+ * @param[in] location - string of vnodes/resources to be allocated to the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      !0      error
+ *
+ */
+int
+pbs_asyrunjob_pipe(int c, char *jobid, char *location, char *extend)
+{
+	return (*pfn_pbs_asyrunjob_pipe)(c, jobid, location, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a pipelined run job request whose reply
+ *	comes once the job reached its Mother Superior
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid- job identifier
+ * @param[in] location - string of vnodes/resources to be allocated to the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      !0      error
+ *
+ */
+int
+pbs_runjob_pipe(int c, char *jobid, char *location, char *extend)
+{
+	return (*pfn_pbs_runjob_pipe)(c, jobid, location, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to wait for the replies of pipelined run job requests
+ *
+ * @param[in] c - connection handle
+ *
+ * @return      struct batch_runjob_status *
+ * @retval      list of rejected requests
+ * @retval      NULL	- none rejected or error
+ *
+ */
+struct batch_runjob_status *
+pbs_asyrunjob_replies(int c)
+{
+	return (*pfn_pbs_asyrunjob_replies)(c);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to run many subjobs of an array in one async request
+ *
+ * @param[in] c - connection handle
+ * @param[in] arrayid - id of the parent array job
+ * @param[in] count - number of subjobs to run
+ * @param[in] indices - index of each subjob
+ * @param[in] locations - exec_vnode of each subjob
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      !0      error
+ *
+ */
+int
+pbs_asyrunsubjobs(int c, char *arrayid, int count, int *indices, char **locations, char *extend)
+{
+	return (*pfn_pbs_asyrunsubjobs)(c, arrayid, count, indices, locations, extend);
+}
+
 /**
  * @brief
  *	-Pass-through call to send alter Job request
@@ -129,6 +209,123 @@ pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_asyalterjob)(c, jobid, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to send alter Job requests for many jobs at once
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - list of job identifiers and their attributes to alter
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+pbs_asyalterjobs(int c, struct batch_status *jobs, char *extend) {
+	return (*pfn_pbs_asyalterjobs)(c, jobs, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to alter every job that matches a selection
+ *
+ * @param[in] c - connection handle
+ * @param[in] sel - the selection criteria
+ * @param[in] attrib - pointer to attribute list to alter
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	struct batch_deljob_status *
+ * @retval	job id and error code of each selected job	success
+ * @retval	NULL	no job selected or error
+ *
+ */
+struct batch_deljob_status *
+pbs_alterjob_sel(int c, struct attropl *sel, struct attrl *attrib, char *extend) {
+	return (*pfn_pbs_alterjob_sel)(c, sel, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a tagged status job request
+ *
+ * @param[in] c - connection handle
+ * @param[in] id - job identifier
+ * @param[in] attrib - attributes to return
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error
+ *
+ */
+unsigned int
+pbs_async_statjob(int c, char *id, struct attrl *attrib, char *extend)
+{
+	return (*pfn_pbs_async_statjob)(c, id, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a tagged alter job request
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid - job identifier
+ * @param[in] attrib - attributes to alter
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error
+ *
+ */
+unsigned int
+pbs_async_alterjob(int c, char *jobid, struct attrl *attrib, char *extend)
+{
+	return (*pfn_pbs_async_alterjob)(c, jobid, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to send a tagged selectable status request
+ *
+ * @param[in] c - connection handle
+ * @param[in] attrib - selection criteria
+ * @param[in] rattrib - attributes to return
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error
+ *
+ */
+unsigned int
+pbs_async_selstat(int c, struct attropl *attrib, struct attrl *rattrib, char *extend)
+{
+	return (*pfn_pbs_async_selstat)(c, attrib, rattrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to collect the replies of tagged requests
+ *
+ * @param[in] c - connection handle
+ * @param[in] timeout - seconds to wait for a reply, 0 to poll, < 0 forever
+ * @param[in] cb - if not NULL, given each reply instead of returning it
+ * @param[in] arg - passed to cb
+ *
+ * @return	struct batch_async_status *
+ * @retval	list of replied requests
+ * @retval	NULL	- none replied yet, cb set or error (see pbs_errno)
+ *
+ */
+struct batch_async_status *
+pbs_async_wait(int c, int timeout, pbs_async_cb cb, void *arg)
+{
+	return (*pfn_pbs_async_wait)(c, timeout, cb, arg);
+}
+
 /**
  * @brief
  * 	-pbs_confirmresv - this function is for exclusive use by the Scheduler
@@ -564,6 +761,52 @@ pbs_delstatfree(struct batch_deljob_status *bdsp) {
 	(*pfn_pbs_delstatfree)(bdsp);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to deallocates a "batch_runjob_status" structure
+ *
+ * @param[in] rsp - list of run job status
+ *
+ * @return	Void
+ *
+ */
+void
+pbs_runjobstatfree(struct batch_runjob_status *rsp) {
+	(*pfn_pbs_runjobstatfree)(rsp);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to deallocates a "batch_async_status" structure
+ *
+ * @param[in] asp - list of tagged request replies
+ *
+ * @return	Void
+ *
+ */
+void
+pbs_asyncstatfree(struct batch_async_status *asp) {
+	(*pfn_pbs_asyncstatfree)(asp);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to set the consumer of status replies
+ *
+ * @param[in] cb - function given each part of a status reply, NULL to unset
+ * @param[in] arg - passed on to cb
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+pbs_stat_stream(pbs_stat_cb cb, void *arg)
+{
+	return (*pfn_pbs_stat_stream)(cb, arg);
+}
+
 
 /**
  * @brief
@@ -641,6 +884,25 @@ pbs_statque(int c, char *id, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_statque)(c, id, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to get status of jobs, vnodes or queues from the
+ *	server's status snapshot.
+ *
+ * @param[in] obj_type - MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_QUEUE
+ * @param[in] id - object id
+ * @param[in] attrib - pointer to attribute list
+ *
+ * @return      structure handle
+ * @retval      pointer to batch_status struct          Success
+ * @retval      NULL                                    error
+ *
+ */
+struct batch_status *
+pbs_statsnap(int obj_type, char *id, struct attrl *attrib) {
+	return (*pfn_pbs_statsnap)(obj_type, id, attrib);
+}
+
 /**
  * @brief
  *	- Pass-through call to return the status of a server.
@@ -775,6 +1037,44 @@ pbs_stathook(int c, char *id, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_stathook)(c, id, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to subscribe a connection to server events
+ *
+ * @param[in] c - communication handle
+ * @param[in] events - comma separated list of SUBSCRIBE_* event classes
+ * @param[in] filter - only jobs and reservations matching these attributes
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+pbs_subscribe(int c, char *events, struct attrl *filter, char *extend)
+{
+	return (*pfn_pbs_subscribe)(c, events, filter, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to read the events pushed on a subscribed connection
+ *
+ * @param[in] c - communication handle
+ * @param[in] timeout - seconds to wait for events, 0 to poll, < 0 forever
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status list of events		Success
+ * @retval	NULL	no events in time (pbs_errno is 0) or error
+ *
+ */
+struct batch_status *
+pbs_get_events(int c, int timeout)
+{
+	return (*pfn_pbs_get_events)(c, timeout);
+}
+
 /**
  * @brief
  *	-Pass-through call to get the attributes that failed verification
@@ -811,6 +1111,29 @@ pbs_submit(int c, struct attropl  *attrib, char *script, char *destination, char
 	return (*pfn_pbs_submit)(c, attrib, script, destination, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to submit many jobs in one request
+ *
+ * @param[in] c - communication handle
+ * @param[in] attrib - attributes shared by all the jobs
+ * @param[in] njobs - number of jobs
+ * @param[in] job_attribs - attributes of each job
+ * @param[in] scripts - script of each job
+ * @param[in] destination - queue or server the jobs are submitted to
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      struct batch_deljob_status *
+ * @retval      job id and error code of each job   success
+ * @retval      NULL    error
+ *
+ */
+struct batch_deljob_status *
+pbs_submit_many(int c, struct attropl *attrib, int njobs, struct attropl **job_attribs,
+	char **scripts, char *destination, char *extend) {
+	return (*pfn_pbs_submit_many)(c, attrib, njobs, job_attribs, scripts, destination, extend);
+}
+
 /**
  * @brief
  *	Pass-through call to submit reservation request
@@ -45,8 +45,18 @@
 
 int (*pfn_pbs_asyrunjob)(int, char *, char *, char *) = __pbs_asyrunjob;
 int (*pfn_pbs_asyrunjob_ack)(int, char *, char *, char *) = __pbs_asyrunjob_ack;
+int (*pfn_pbs_asyrunjob_pipe)(int, char *, char *, char *) = __pbs_asyrunjob_pipe;
+int (*pfn_pbs_runjob_pipe)(int, char *, char *, char *) = __pbs_runjob_pipe;
+struct batch_runjob_status *(*pfn_pbs_asyrunjob_replies)(int) = __pbs_asyrunjob_replies;
+int (*pfn_pbs_asyrunsubjobs)(int, char *, int, int *, char **, char *) = __pbs_asyrunsubjobs;
 int (*pfn_pbs_alterjob)(int, char *, struct attrl *, char *) = __pbs_alterjob;
 int (*pfn_pbs_asyalterjob)(int, char *, struct attrl *, char *) = __pbs_asyalterjob;
+int (*pfn_pbs_asyalterjobs)(int, struct batch_status *, char *) = __pbs_asyalterjobs;
+struct batch_deljob_status *(*pfn_pbs_alterjob_sel)(int, struct attropl *, struct attrl *, char *) = __pbs_alterjob_sel;
+unsigned int (*pfn_pbs_async_statjob)(int, char *, struct attrl *, char *) = __pbs_async_statjob;
+unsigned int (*pfn_pbs_async_alterjob)(int, char *, struct attrl *, char *) = __pbs_async_alterjob;
+unsigned int (*pfn_pbs_async_selstat)(int, struct attropl *, struct attrl *, char *) = __pbs_async_selstat;
+struct batch_async_status *(*pfn_pbs_async_wait)(int, int, pbs_async_cb, void *) = __pbs_async_wait;
 int (*pfn_pbs_confirmresv)(int, char *, char *, unsigned long, char *) = __pbs_confirmresv;
 int (*pfn_pbs_connect)(char *) = __pbs_connect;
 int (*pfn_pbs_connect_extend)(char *, char *) = __pbs_connect_extend;
@@ -69,10 +79,14 @@ char **(*pfn_pbs_selectjob)(int, struct attropl *, char *) = __pbs_selectjob;
 int (*pfn_pbs_sigjob)(int, char *, char *, char *) = __pbs_sigjob;
 void (*pfn_pbs_statfree)(struct batch_status *) = __pbs_statfree;
 void (*pfn_pbs_delstatfree)(struct batch_deljob_status *) = __pbs_delstatfree;
+void (*pfn_pbs_runjobstatfree)(struct batch_runjob_status *) = __pbs_runjobstatfree;
+void (*pfn_pbs_asyncstatfree)(struct batch_async_status *) = __pbs_asyncstatfree;
+int (*pfn_pbs_stat_stream)(pbs_stat_cb, void *) = __pbs_stat_stream;
 struct batch_status *(*pfn_pbs_statrsc)(int, char *, struct attrl *, char *) = __pbs_statrsc;
 struct batch_status *(*pfn_pbs_statjob)(int, char *, struct attrl *, char *) = __pbs_statjob;
 struct batch_status *(*pfn_pbs_selstat)(int, struct attropl *, struct attrl *, char *) = __pbs_selstat;
 struct batch_status *(*pfn_pbs_statque)(int, char *, struct attrl *, char *) = __pbs_statque;
+struct batch_status *(*pfn_pbs_statsnap)(int, char *, struct attrl *) = __pbs_statsnap;
 struct batch_status *(*pfn_pbs_statserver)(int, struct attrl *, char *) = __pbs_statserver;
 struct batch_status *(*pfn_pbs_statsched)(int, struct attrl *, char *) = __pbs_statsched;
 struct batch_status *(*pfn_pbs_stathost)(int, char *, struct attrl *, char *) = __pbs_stathost;
@@ -80,8 +94,11 @@ struct batch_status *(*pfn_pbs_statnode)(int, char *, struct attrl *, char *) =
 struct batch_status *(*pfn_pbs_statvnode)(int, char *, struct attrl *, char *) = __pbs_statvnode;
 struct batch_status *(*pfn_pbs_statresv)(int, char *, struct attrl *, char *) = __pbs_statresv;
 struct batch_status *(*pfn_pbs_stathook)(int, char *, struct attrl *, char *) = __pbs_stathook;
+int (*pfn_pbs_subscribe)(int, char *, struct attrl *, char *) = __pbs_subscribe;
+struct batch_status *(*pfn_pbs_get_events)(int, int) = __pbs_get_events;
 struct ecl_attribute_errors * (*pfn_pbs_get_attributes_in_error)(int) = __pbs_get_attributes_in_error;
 char *(*pfn_pbs_submit)(int, struct attropl *, char *, char *, char *) = __pbs_submit;
+struct batch_deljob_status *(*pfn_pbs_submit_many)(int, struct attropl *, int, struct attropl **, char **, char *, char *) = __pbs_submit_many;
 char *(*pfn_pbs_submit_resv)(int, struct attropl *, char *) = __pbs_submit_resv;
 int (*pfn_pbs_delresv)(int, char *, char *) = __pbs_delresv;
 int (*pfn_pbs_terminate)(int, int, char *) = __pbs_terminate;
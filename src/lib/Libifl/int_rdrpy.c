@@ -60,7 +60,8 @@
 
 
 /**
- * @brief read a batch reply from the given socket
+ * @brief read the next batch reply from the given socket, it may be
+ *	the reply to a tagged request (brp_tag set)
  *
  * @param[in] sock - The socket fd to read from
  * @param[out] rc  - Return DIS error code
@@ -71,7 +72,7 @@
  *
  */
 struct batch_reply *
-PBSD_rdrpy_sock(int sock, int *rc)
+PBSD_rdrpy_one(int sock, int *rc)
 {
 	struct batch_reply *reply;
 	time_t old_timeout;
@@ -100,6 +101,34 @@ PBSD_rdrpy_sock(int sock, int *rc)
 	return reply;
 }
 
+/**
+ * @brief read the reply to an untagged batch request from the given
+ *	socket, replies to tagged requests read on the way are kept on the
+ *	connection for pbs_async_wait()
+ *
+ * @param[in] sock - The socket fd to read from
+ * @param[out] rc  - Return DIS error code
+ *
+ * @return Batch reply structure
+ * @retval  !NULL - Success
+ * @retval   NULL - Failure
+ *
+ */
+struct batch_reply *
+PBSD_rdrpy_sock(int sock, int *rc)
+{
+	struct batch_reply *reply;
+
+	while ((reply = PBSD_rdrpy_one(sock, rc)) != NULL && reply->brp_tag != 0) {
+		if (PBSD_async_reply(sock, reply) < 0) {
+			*rc = DIS_PROTO;
+			pbs_errno = PBSE_PROTOCOL;
+			return NULL;
+		}
+	}
+	return reply;
+}
+
 /**
  * @brief read a batch reply from the given connecction index
  *
@@ -121,6 +150,15 @@ PBSD_rdrpy(int c)
 		pbs_errno = PBSE_SYSTEM;
 		return NULL;
 	}
+	/* replies to pipelined run job requests sent before ours come first */
+	if (PBSD_runjob_rdrpy(c) != 0) {
+		if (set_conn_errno(c, PBSE_PROTOCOL) != 0) {
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
 	reply = PBSD_rdrpy_sock(c, &rc);
 	if (reply == NULL) {
 		if (set_conn_errno(c, PBSE_PROTOCOL) != 0) {
@@ -53,6 +53,7 @@
 #include "attribute.h"
 #include "cmds.h"
 #include "pbs_internal.h"
+#include "pbs_client_thread.h"
 
 
 extern char * PBS_get_server(char *, char *, uint *);
@@ -721,3 +722,37 @@ PBSD_status_get(int c, struct batch_status **last)
 	PBSD_FreeReply(reply);
 	return rbsp;
 }
+
+/**
+ * @brief
+ *	__pbs_stat_stream - set the consumer of the status replies read by the
+ *	calling thread.
+ *
+ *	While set, every part of a job, node, reservation, ... status reply is
+ *	passed to cb as soon as it is decoded and freed once cb returns, so the
+ *	client never holds more than one part.  The status call itself then
+ *	returns NULL, with pbs_errno left at 0 on success.  If cb returns non
+ *	zero, the rest of the reply is read and dropped.  Server and queue
+ *	status is not streamed.
+ *
+ * @param[in] cb - consumer, NULL to go back to returning the whole reply
+ * @param[in] arg - passed on to cb
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval !0 - pbs_errno, no thread context
+ */
+int
+__pbs_stat_stream(pbs_stat_cb cb, void *arg)
+{
+	struct pbs_client_thread_context *ctx;
+
+	if (pbs_client_thread_init_thread_context() != 0)
+		return pbs_errno;
+	if ((ctx = pbs_client_thread_get_context_data()) == NULL)
+		return (pbs_errno = PBSE_SYSTEM);
+
+	ctx->th_stat_cb = cb;
+	ctx->th_stat_arg = arg;
+	return 0;
+}
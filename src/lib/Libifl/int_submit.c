@@ -580,3 +580,171 @@ PBSD_queuejob(int c, char *jobid, char *destin, struct attropl *attrib, char *ex
 	PBSD_FreeReply(reply);
 	return return_jobid;
 }
+
+/**
+ * @brief
+ *	-Send a Submit Job request, the attributes and the whole script of
+ *	a job in one message, and read the reply.
+ *
+ * @param[in] c - socket descriptor
+ * @param[in] destin - destination name
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] script - the job script
+ * @param[in] scriptsz - length of the job script
+ * @param[in] extend - extention string for req encode
+ * @param[out] commit_done - 1 if job committed, 0 if a Commit is still needed
+ *
+ * @return      char *
+ * @retval      job id		Success
+ * @retval      NULL		error, pbs_errno set
+ */
+char *
+PBSD_submitjob(int c, char *destin, struct attropl *attrib, char *script, size_t scriptsz, char *extend, int *commit_done)
+{
+	struct batch_reply *reply;
+	char *return_jobid = NULL;
+	int rc;
+
+	*commit_done = 0;
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_SubmitJob, pbs_current_user)) ||
+		(rc = encode_DIS_SubmitJob(c, destin, attrib, script, scriptsz)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0) {
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	reply = PBSD_rdrpy(c);
+	if (reply == NULL) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if (reply->brp_choice &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Queue &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Commit) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if (get_conn_errno(c) == 0) {
+		return_jobid = strdup(reply->brp_un.brp_jid);
+		if (return_jobid == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+		}
+		if (reply->brp_choice == BATCH_REPLY_CHOICE_Commit)
+			*commit_done = 1;
+	}
+
+	PBSD_FreeReply(reply);
+	return return_jobid;
+}
+
+/**
+ * @brief
+ *	-Send an Exec Job request on a TPP stream, the attributes, script and
+ *	credential of a job in one message for the MoM to queue and commit
+ *	at once.
+ *	As with the other job requests over TPP the reply is not read here.
+ *
+ * @param[in] c - stream
+ * @param[in] jobid - job id
+ * @param[in] destin - destination name
+ * @param[in] attrib - job attributes
+ * @param[in] script - job script, may be NULL
+ * @param[in] scriptsz - length of the script
+ * @param[in] credtype - type of the credential
+ * @param[in] cred - credential, may be NULL
+ * @param[in] credsz - length of the credential
+ * @param[out] msgid - message id of the request
+ *
+ * @return      int
+ * @retval      0	success
+ * @retval      !0	error, pbs_errno set
+ */
+int
+PBSD_execjob(int c, char *jobid, char *destin, struct attropl *attrib, char *script,
+	size_t scriptsz, int credtype, char *cred, size_t credsz, char **msgid)
+{
+	int rc;
+
+	if ((rc = is_compose_cmd(c, IS_CMD, msgid)) != DIS_SUCCESS)
+		return (pbs_errno = PBSE_PROTOCOL);
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_ExecJob, pbs_current_user)) ||
+		(rc = encode_DIS_ExecJob(c, jobid, destin, attrib, script, scriptsz, credtype, cred, credsz)) ||
+		(rc = encode_DIS_ReqExtend(c, EXTEND_OPT_IMPLICIT_COMMIT)))
+		return (pbs_errno = PBSE_PROTOCOL);
+
+	pbs_errno = PBSE_NONE;
+	if (dis_flush(c))
+		pbs_errno = PBSE_PROTOCOL;
+
+	return (pbs_errno);
+}
+
+/**
+ * @brief
+ *	-Send a Submit Job List request, many jobs with their scripts in one
+ *	message, and read the reply.
+ *
+ * @param[in] c - socket descriptor
+ * @param[in] destin - destination name
+ * @param[in] attrib - attributes shared by all the jobs
+ * @param[in] njobs - number of jobs
+ * @param[in] job_attribs - attributes of each job, may be NULL
+ * @param[in] scripts - script of each job, may be NULL
+ * @param[in] scriptsz - length of each script
+ * @param[in] extend - extention string for req encode
+ *
+ * @return      struct batch_deljob_status *
+ * @retval      job id and error code of each job, in the order of the request
+ * @retval      NULL		error, pbs_errno set
+ */
+struct batch_deljob_status *
+PBSD_submitjoblist(int c, char *destin, struct attropl *attrib, int njobs,
+	struct attropl **job_attribs, char **scripts, size_t *scriptsz, char *extend)
+{
+	struct batch_reply *reply;
+	struct batch_deljob_status *rbsp = NULL;
+	int rc;
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_SubmitJobList, pbs_current_user)) ||
+		(rc = encode_DIS_SubmitJobList(c, destin, attrib, njobs, job_attribs, scripts, scriptsz)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0) {
+			pbs_errno = PBSE_SYSTEM;
+			return NULL;
+		}
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+
+	reply = PBSD_rdrpy(c);
+	if (reply == NULL) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if (reply->brp_choice &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Delete) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if ((get_conn_errno(c) == 0) && (reply->brp_choice == BATCH_REPLY_CHOICE_Delete)) {
+		rbsp = reply->brp_un.brp_deletejoblist.brp_delstatc;
+		reply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
+	}
+
+	PBSD_FreeReply(reply);
+	return rbsp;
+}
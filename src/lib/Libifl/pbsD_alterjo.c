@@ -49,6 +49,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "libpbs.h"
+#include "pbs_ecl.h"
 
 /**
  * @brief	Convenience function to create attropl list from attrl (shallow copy)
@@ -203,3 +204,229 @@ __pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend)
 	return i;
 
 }
+
+/**
+ * @brief	Send Alter Job requests for many jobs to the server as one
+ *		request, Asynchronously
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - list of jobs, name is the job identifier and attribs
+ *		     the attributes to alter on the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+__pbs_asyalterjobs(int c, struct batch_status *jobs, char *extend)
+{
+	int rc;
+
+	if (jobs == NULL)
+		return (pbs_errno = PBSE_IVALREQ);
+
+	/* initialize the thread context data, if not initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return pbs_errno;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return pbs_errno;
+
+	DIS_tcp_funcs();
+
+	/* send the modify job list request, no reply comes back */
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_ModifyJobList_Async, pbs_current_user)) ||
+		(rc = encode_DIS_ModifyJobList(c, jobs)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return pbs_errno;
+	}
+
+	if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return pbs_errno;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return pbs_errno;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	-Alter every job that matches a selection in one request
+ *
+ * @par	Functionality:
+ *		The server selects the jobs the way pbs_selectjob() does with
+ *		the same selection, and alters each of them as a Modify Job
+ *		request with attrib would.  The changes of all the jobs are
+ *		written to the database in one transaction.
+ *
+ * @param[in] c - connection handle
+ * @param[in] sel - the selection criteria
+ * @param[in] attrib - pointer to attribute list to alter
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	struct batch_deljob_status *
+ * @retval	one entry per selected job, with the job id in name and the
+ *		error of the alter in code.  To be freed with pbs_delstatfree().
+ * @retval	NULL	no job was selected (pbs_errno is 0), or error
+ *			(pbs_errno set)
+ *
+ */
+struct batch_deljob_status *
+__pbs_alterjob_sel(int c, struct attropl *sel, struct attrl *attrib, char *extend)
+{
+	struct attropl *attrib_opl = NULL;
+	struct batch_reply *reply;
+	struct batch_deljob_status *rbsp = NULL;
+	int rc;
+
+	if (attrib == NULL) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	/* initialize the thread context data, if not initialized */
+	if ((pbs_errno = pbs_client_thread_init_thread_context()) != 0)
+		return NULL;
+
+	/* the jobs of the other servers would be missed */
+	if (get_num_servers() > 1) {
+		pbs_errno = PBSE_NOSUP;
+		return NULL;
+	}
+
+	if ((attrib_opl = attrl_to_attropl(attrib)) == NULL)
+		return NULL;
+
+	/* first verify the attributes, if verification is enabled */
+	if ((pbs_verify_attributes(c, PBS_BATCH_SelectJobs, MGR_OBJ_JOB, MGR_CMD_NONE, sel) != 0) ||
+		(pbs_verify_attributes(c, PBS_BATCH_ModifyJob, MGR_OBJ_JOB, MGR_CMD_SET, attrib_opl) != 0)) {
+		__free_attropl(attrib_opl);
+		return NULL;
+	}
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0) {
+		__free_attropl(attrib_opl);
+		return NULL;
+	}
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_ModifyJobsSel, pbs_current_user)) ||
+		(rc = encode_DIS_attropl(c, sel)) ||
+		(rc = encode_DIS_attropl(c, attrib_opl)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		rc = DIS_PROTO;
+	}
+	__free_attropl(attrib_opl);
+
+	if (rc == 0) {
+		reply = PBSD_rdrpy(c);
+		if (reply == NULL) {
+			pbs_errno = PBSE_PROTOCOL;
+		} else if (reply->brp_choice &&
+			reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
+			reply->brp_choice != BATCH_REPLY_CHOICE_Delete) {
+			pbs_errno = PBSE_PROTOCOL;
+		} else if ((get_conn_errno(c) == 0) && (reply->brp_choice == BATCH_REPLY_CHOICE_Delete)) {
+			rbsp = reply->brp_un.brp_deletejoblist.brp_delstatc;
+			reply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
+		}
+		PBSD_FreeReply(reply);
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	(void)pbs_client_thread_unlock_connection(c);
+
+	return rbsp;
+}
+
+/**
+ * @brief
+ *	-send a tagged Alter Job request, the reply is collected later by
+ *	pbs_async_wait() under the tag returned
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid - job identifier
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error, pbs_errno set
+ *
+ */
+unsigned int
+__pbs_async_alterjob(int c, char *jobid, struct attrl *attrib, char *extend)
+{
+	struct attropl *attrib_opl = NULL;
+	unsigned int tag;
+	int rc;
+
+	if ((jobid == NULL) || (*jobid == '\0')) {
+		pbs_errno = PBSE_IVALREQ;
+		return 0;
+	}
+
+	/* initialize the thread context data, if not initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return 0;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return 0;
+
+	if ((tag = PBSD_async_add(c)) == 0) {
+		(void)pbs_client_thread_unlock_connection(c);
+		return 0;
+	}
+
+	DIS_tcp_funcs();
+
+	attrib_opl = attrl_to_attropl(attrib);
+	if ((rc = encode_DIS_ReqHdr_tagged(c, PBS_BATCH_ModifyJob, pbs_current_user, tag)) ||
+		(rc = encode_DIS_Manage(c, MGR_CMD_SET, MGR_OBJ_JOB, jobid, attrib_opl)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		rc = DIS_PROTO;
+	}
+	__free_attropl(attrib_opl);
+
+	if (rc != 0) {
+		PBSD_async_cancel(c, tag);
+		tag = 0;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return 0;
+
+	return tag;
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file	pbsD_async.c
+ * @brief
+ *	Tagged (multiplexed) requests.  Each request sent by one of the
+ *	pbs_async_*() calls carries a tag the server echoes in its reply, so
+ *	many requests can be in flight on one connection and the replies can
+ *	come back in any order.  The replies are collected by pbs_async_wait(),
+ *	or kept on the connection when read by a call waiting for the reply
+ *	to an untagged request.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(FD_SET_IN_SYS_SELECT_H)
+#include <sys/select.h>
+#endif
+#ifndef WIN32
+#include <poll.h>
+#endif
+#include "libpbs.h"
+#include "ifl_internal.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-queue a new tagged request on a connection, before it is sent
+ *
+ * @param[in] c - connection handle
+ *
+ * @return      unsigned int
+ * @retval      tag of the request	success
+ * @retval      0			error, pbs_errno set
+ *
+ */
+unsigned int
+PBSD_async_add(int c)
+{
+	struct pbs_async_req *ar;
+	unsigned int tag;
+
+	if ((ar = calloc(1, sizeof(struct pbs_async_req))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return 0;
+	}
+	if ((ar->ar_stat = calloc(1, sizeof(struct batch_async_status))) == NULL) {
+		free(ar);
+		pbs_errno = PBSE_SYSTEM;
+		return 0;
+	}
+	if ((tag = add_conn_async(c, ar)) == 0) {
+		free(ar->ar_stat);
+		free(ar);
+		pbs_errno = PBSE_SYSTEM;
+	}
+	return tag;
+}
+
+/**
+ * @brief
+ *	-drop a tagged request that could not be sent
+ *
+ * @param[in] c - connection handle
+ * @param[in] tag - tag of the request
+ *
+ * @return      void
+ *
+ */
+void
+PBSD_async_cancel(int c, unsigned int tag)
+{
+	struct pbs_async_req *ar;
+
+	if ((ar = get_conn_async(c, tag, 1)) != NULL) {
+		__pbs_asyncstatfree(ar->ar_stat);
+		free(ar);
+	}
+}
+
+/**
+ * @brief
+ *	-take in a reply (or one part of it) to a tagged request.  The status
+ *	objects of the parts are merged, once the last part is in the reply
+ *	is kept on the connection for pbs_async_wait().
+ *
+ * @param[in] c - connection handle
+ * @param[in] reply - the reply, freed here
+ *
+ * @return      int
+ * @retval      1	the request is fully replied to
+ * @retval      0	more parts are to come
+ * @retval      -1	the tag is not one of a request sent on c
+ *
+ */
+int
+PBSD_async_reply(int c, struct batch_reply *reply)
+{
+	struct pbs_async_req *ar;
+	struct batch_async_status *as;
+
+	if ((ar = get_conn_async(c, reply->brp_tag, 0)) == NULL) {
+		PBSD_FreeReply(reply);
+		return -1;
+	}
+	as = ar->ar_stat;
+	as->code = reply->brp_code;
+
+	if (reply->brp_choice == BATCH_REPLY_CHOICE_Status &&
+		reply->brp_un.brp_statc != NULL) {
+		if (as->status == NULL)
+			as->status = reply->brp_un.brp_statc;
+		else
+			ar->ar_last->next = reply->brp_un.brp_statc;
+		ar->ar_last = reply->last;
+		reply->brp_un.brp_statc = NULL;
+	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_Text &&
+		reply->brp_un.brp_txt.brp_str != NULL) {
+		free(as->text);
+		as->text = reply->brp_un.brp_txt.brp_str;
+		reply->brp_un.brp_txt.brp_str = NULL;
+	}
+
+	if (reply->brp_is_part) {
+		PBSD_FreeReply(reply);
+		return 0;
+	}
+	PBSD_FreeReply(reply);
+
+	/* like the untagged calls, a failed status request returns no objects */
+	if (as->code != PBSE_NONE && as->status != NULL) {
+		pbs_statfree(as->status);
+		as->status = NULL;
+	}
+	(void)get_conn_async(c, as->tag, 1);
+	free(ar);
+	if (add_conn_async_done(c, as) != 0)
+		__pbs_asyncstatfree(as);
+	return 1;
+}
+
+/**
+ * @brief
+ *	-wait for the connection to have a reply to read
+ *
+ * @param[in] c - connection handle
+ * @param[in] timeout - seconds to wait, 0 to poll, < 0 forever
+ *
+ * @return      int
+ * @retval      1	there is a reply to read
+ * @retval      0	timed out
+ * @retval      -1	error
+ *
+ */
+int
+PBSD_readable(int c, int timeout)
+{
+	int i;
+#ifdef WIN32
+	fd_set readset;
+	struct timeval tv;
+
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+	do {
+		FD_ZERO(&readset);
+		FD_SET((unsigned int)c, &readset);
+		i = select(FD_SETSIZE, &readset, NULL, NULL, (timeout < 0) ? NULL : &tv);
+	} while (i == -1 && ((errno = WSAGetLastError()) == WSAEINTR));
+#else
+	struct pollfd pollfds[1];
+
+	pollfds[0].fd = c;
+	pollfds[0].events = POLLIN;
+	pollfds[0].revents = 0;
+	do {
+		i = poll(pollfds, 1, (timeout < 0) ? -1 : timeout * 1000);
+	} while (i == -1 && errno == EINTR);
+#endif
+	return (i > 0) ? 1 : i;
+}
+
+/**
+ * @brief
+ *	-collect the replies to the tagged requests sent on a connection.
+ *	Waits up to timeout seconds for the first request to be fully replied
+ *	to, then reads whatever other replies are already there.
+ *
+ * @param[in] c - connection handle
+ * @param[in] timeout - seconds to wait, 0 to poll, < 0 forever
+ * @param[in] cb - if not NULL, given each replied request in turn, the
+ *		   request is freed once cb returns
+ * @param[in] arg - passed to cb
+ *
+ * @return      struct batch_async_status *
+ * @retval      list of replied requests, in the order the replies came.
+ *		The caller must free it with pbs_asyncstatfree().
+ * @retval      NULL	- nothing replied to in time, cb set (pbs_errno is 0)
+ *			  or error
+ *
+ */
+struct batch_async_status *
+__pbs_async_wait(int c, int timeout, pbs_async_cb cb, void *arg)
+{
+	struct batch_async_status *done = NULL;
+	struct batch_async_status *next;
+	struct batch_async_status **tail;
+	struct batch_reply *reply;
+	time_t deadline = 0;
+	int err = PBSE_NONE;
+	int replied;
+	int wait;
+	int rc;
+
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	if (set_conn_errtxt(c, NULL) != 0) {
+		err = PBSE_SYSTEM;
+		goto async_wait_done;
+	}
+
+	/* pipelined run job replies were asked for first, read them out of the way */
+	if (PBSD_runjob_rdrpy(c) != 0) {
+		err = PBSE_PROTOCOL;
+		goto async_wait_done;
+	}
+
+	/* replies already read by calls waiting for an untagged reply */
+	done = get_conn_async_done(c);
+	replied = (done != NULL);
+
+	if (timeout > 0)
+		deadline = time(NULL) + timeout;
+	while (get_conn_async(c, 0, 0) != NULL) {
+		if (replied)
+			wait = 0;
+		else if (timeout > 0)
+			wait = (deadline > time(NULL)) ? (int)(deadline - time(NULL)) : 0;
+		else
+			wait = timeout;
+		if ((rc = PBSD_readable(c, wait)) <= 0) {
+			if (rc < 0)
+				err = PBSE_PROTOCOL;
+			break;
+		}
+
+		if ((reply = PBSD_rdrpy_one(c, &rc)) == NULL) {
+			err = PBSE_PROTOCOL;
+			(void)set_conn_errtxt(c, dis_emsg[rc]);
+			break;
+		}
+		if (reply->brp_tag == 0) {
+			/* every untagged request was replied to before we got here */
+			PBSD_FreeReply(reply);
+			err = PBSE_PROTOCOL;
+			break;
+		}
+		if ((rc = PBSD_async_reply(c, reply)) < 0) {
+			err = PBSE_PROTOCOL;
+			break;
+		}
+		replied |= rc;
+	}
+	if (err != PBSE_NONE)
+		(void)set_conn_errno(c, err);
+
+async_wait_done:
+	for (tail = &done; *tail != NULL; tail = &((*tail)->next))
+		;
+	*tail = get_conn_async_done(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		__pbs_asyncstatfree(done);
+		return NULL;
+	}
+	pbs_errno = err;
+
+	if (cb != NULL) {
+		for (; done != NULL; done = next) {
+			next = done->next;
+			done->next = NULL;
+			cb(done, arg);
+			__pbs_asyncstatfree(done);
+		}
+	}
+	return done;
+}
+
+/**
+ * @brief
+ *	-free a list of tagged request replies
+ *
+ * @param[in] as - the list
+ *
+ * @return      void
+ *
+ */
+void
+__pbs_asyncstatfree(struct batch_async_status *as)
+{
+	struct batch_async_status *next;
+
+	while (as != NULL) {
+		next = as->next;
+		pbs_statfree(as->status);
+		free(as->text);
+		free(as);
+		as = next;
+	}
+}
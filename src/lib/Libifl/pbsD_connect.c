@@ -313,6 +313,10 @@ tcp_connect(char *hostname, int server_port, char *extend_data)
 
 	pbs_errno = PBSE_NONE;
 	reply = PBSD_rdrpy(sd);
+	/* an older server acks, it does not know PBS_BATCH_SubmitJob */
+	if (reply != NULL && reply->brp_choice == BATCH_REPLY_CHOICE_Text &&
+		get_auth_ext(reply->brp_un.brp_txt.brp_str, CONNECT_REPLY_SUBMITJOB, NULL, 0))
+		set_conn_submitjob(sd, 1);
 	PBSD_FreeReply(reply);
 	if (pbs_errno != PBSE_NONE) {
 		closesocket(sd);
@@ -975,6 +979,9 @@ err:
 		return -1;
 	}
 	reply = PBSD_rdrpy(sock);
+	if (reply != NULL && reply->brp_choice == BATCH_REPLY_CHOICE_Text &&
+		get_auth_ext(reply->brp_un.brp_txt.brp_str, CONNECT_REPLY_SUBMITJOB, NULL, 0))
+		set_conn_submitjob(sock, 1);
 	PBSD_FreeReply(reply);
 
 	if (engage_client_auth(sock, server, server_port, errbuf, sizeof(errbuf)) != 0) {
@@ -48,6 +48,7 @@
 #include "libpbs.h"
 #include "dis.h"
 #include "pbs_ecl.h"
+#include "ifl_internal.h"
 
 /**
  * @brief	Helper function for pbs_asynrunjob and pbs_asynrunjob_ack
@@ -57,22 +58,34 @@
  * @param[in] location - string of vnodes/resources to be allocated to the job
  * @param[in] extend - extend string for encoding req
  * @param[in] req_type - one of PBS_BATCH_AsyrunJob or PBS_BATCH_AsyrunJob_ack
+ * @param[in] pipe - do not wait for the reply, queue it on the connection
+ *		     to be read by PBSD_runjob_rdrpy()
  *
  * @return      int
  * @retval      0       success
  * @retval      !0      error
  */
 static int
-__runjob_helper(int c, char *jobid, char *location, char *extend, int req_type)
+__runjob_helper(int c, char *jobid, char *location, char *extend, int req_type, int pipe)
 {
 	int rc = 0;
 	unsigned long resch = 0;
+	struct batch_runjob_status *rs = NULL;
 
 	if ((jobid == NULL) || (*jobid == '\0'))
 		return (pbs_errno = PBSE_IVALREQ);
 	if (location == NULL)
 		location = "";
 
+	if (pipe) {
+		if ((rs = calloc(1, sizeof(struct batch_runjob_status))) == NULL)
+			return (pbs_errno = PBSE_SYSTEM);
+		if ((rs->name = strdup(jobid)) == NULL) {
+			free(rs);
+			return (pbs_errno = PBSE_SYSTEM);
+		}
+	}
+
 	/* initialize the thread context data, if not already initialized */
 	if (pbs_client_thread_init_thread_context() != 0)
 		return pbs_errno;
@@ -97,16 +110,24 @@ __runjob_helper(int c, char *jobid, char *location, char *extend, int req_type)
 			pbs_errno = PBSE_PROTOCOL;
 
 		pbs_client_thread_unlock_connection(c);
+		__pbs_runjobstatfree(rs);
 		return pbs_errno;
 	}
 
 	if (dis_flush(c)) {
 		pbs_errno = PBSE_PROTOCOL;
 		pbs_client_thread_unlock_connection(c);
+		__pbs_runjobstatfree(rs);
 		return pbs_errno;
 	}
 
-	if (req_type != PBS_BATCH_AsyrunJob) {
+	if (pipe) {
+		/* the reply is read the next time anything is read from c */
+		if (add_conn_runjob(c, rs) != 0) {
+			__pbs_runjobstatfree(rs);
+			rc = pbs_errno = PBSE_SYSTEM;
+		}
+	} else if (req_type != PBS_BATCH_AsyrunJob) {
 		struct batch_reply *reply = NULL;
 
 		/* Get reply */
@@ -138,7 +159,7 @@ __runjob_helper(int c, char *jobid, char *location, char *extend, int req_type)
  */
 int __pbs_asyrunjob(int c, char *jobid, char *location, char *extend)
 {
-	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_AsyrunJob);
+	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_AsyrunJob, 0);
 }
 
 /**
@@ -159,7 +180,69 @@ int __pbs_asyrunjob(int c, char *jobid, char *location, char *extend)
  */
 int __pbs_asyrunjob_ack(int c, char *jobid, char *location, char *extend)
 {
-	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_AsyrunJob_ack);
+	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_AsyrunJob_ack, 0);
+}
+
+/**
+ * @brief
+ *	-send one async request running many subjobs of an array, each on
+ *	its own vnodes.  Like pbs_asyrunjob(), no reply is read; the server
+ *	runs every subjob as if it got its own async run job request.
+ *
+ * @param[in] c - connection handle
+ * @param[in] arrayid - id of the parent array job
+ * @param[in] count - number of subjobs to run
+ * @param[in] indices - index of each subjob
+ * @param[in] locations - exec_vnode of each subjob
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      !0      error
+ *
+ */
+int
+__pbs_asyrunsubjobs(int c, char *arrayid, int count, int *indices, char **locations, char *extend)
+{
+	int rc;
+
+	if ((arrayid == NULL) || (*arrayid == '\0') || (count <= 0) ||
+		(indices == NULL) || (locations == NULL))
+		return (pbs_errno = PBSE_IVALREQ);
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return pbs_errno;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return pbs_errno;
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_RunSubjobs_Async, pbs_current_user)) ||
+		(rc = encode_DIS_RunSubjobs(c, arrayid, count, indices, locations)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+		pbs_client_thread_unlock_connection(c);
+		return pbs_errno;
+	}
+
+	if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		pbs_client_thread_unlock_connection(c);
+		return pbs_errno;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return pbs_errno;
+
+	return 0;
 }
 
 /**
@@ -180,5 +263,167 @@ int __pbs_asyrunjob_ack(int c, char *jobid, char *location, char *extend)
 int
 __pbs_runjob(int c, char *jobid, char *location, char *extend)
 {
-	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_RunJob);
+	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_RunJob, 0);
+}
+
+/**
+ * @brief
+ *	-send a run job batch request which gets an ack from the server
+ *	like pbs_asyrunjob_ack(), but do not wait for it.  Many requests
+ *	can be streamed to the server this way without a round trip each.
+ *	The replies are read in order the next time anything is read from
+ *	the connection, or by pbs_asyrunjob_replies().
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid- job identifier
+ * @param[in] location - string of vnodes/resources to be allocated to the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       request sent
+ * @retval      !0      error
+ *
+ */
+int
+__pbs_asyrunjob_pipe(int c, char *jobid, char *location, char *extend)
+{
+	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_AsyrunJob_ack, 1);
+}
+
+/**
+ * @brief
+ *	-send a run job batch request like pbs_runjob(), but do not wait for
+ *	the reply.  The server answers once the job reached its Mother
+ *	Superior and keeps the replies to a scheduler in the order of its
+ *	requests, so they are read back like those of pbs_asyrunjob_pipe().
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobid- job identifier
+ * @param[in] location - string of vnodes/resources to be allocated to the job
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return      int
+ * @retval      0       request sent
+ * @retval      !0      error
+ *
+ */
+int
+__pbs_runjob_pipe(int c, char *jobid, char *location, char *extend)
+{
+	return __runjob_helper(c, jobid, location, extend, PBS_BATCH_RunJob, 1);
+}
+
+/**
+ * @brief
+ *	-read the replies of all pipelined run job requests outstanding on
+ *	a connection.  Rejected requests are kept on the connection for
+ *	pbs_asyrunjob_replies().
+ *
+ * @note connection should be locked by caller
+ *
+ * @param[in] c - connection handle
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      PBSE_PROTOCOL	a reply could not be read.  All requests
+ *				still outstanding are marked as failed.
+ *
+ */
+int
+PBSD_runjob_rdrpy(int c)
+{
+	struct batch_runjob_status *rs;
+	struct batch_reply *reply;
+	int rc;
+
+	while ((rs = get_conn_runjob(c)) != NULL) {
+		reply = PBSD_rdrpy_sock(c, &rc);
+		if (reply == NULL) {
+			/* the replies are out of step from here on, fail them all */
+			do {
+				rs->code = PBSE_PROTOCOL;
+				rs->text = strdup(dis_emsg[rc]);
+				if (add_conn_runjob_failure(c, rs) != 0)
+					__pbs_runjobstatfree(rs);
+			} while ((rs = get_conn_runjob(c)) != NULL);
+			return PBSE_PROTOCOL;
+		}
+		if (reply->brp_code != 0) {
+			rs->code = reply->brp_code;
+			if (reply->brp_choice == BATCH_REPLY_CHOICE_Text &&
+				reply->brp_un.brp_txt.brp_str != NULL)
+				rs->text = strdup(reply->brp_un.brp_txt.brp_str);
+			if (add_conn_runjob_failure(c, rs) != 0)
+				__pbs_runjobstatfree(rs);
+		} else
+			__pbs_runjobstatfree(rs);
+		PBSD_FreeReply(reply);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	-wait for the replies of all pipelined run job requests sent on a
+ *	connection by pbs_asyrunjob_pipe() or pbs_runjob_pipe()
+ *
+ * @param[in] c - connection handle
+ *
+ * @return      struct batch_runjob_status *
+ * @retval      list of the requests the server rejected, with the error
+ *		code and text of each.  The caller must free it with
+ *		pbs_runjobstatfree().
+ * @retval      NULL	- all requests succeeded (pbs_errno is 0) or error
+ *
+ */
+struct batch_runjob_status *
+__pbs_asyrunjob_replies(int c)
+{
+	struct batch_runjob_status *failed;
+	int rc;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	rc = PBSD_runjob_rdrpy(c);
+	failed = get_conn_runjob_failures(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		__pbs_runjobstatfree(failed);
+		return NULL;
+	}
+
+	pbs_errno = rc;
+	return failed;
+}
+
+/**
+ * @brief
+ *	-The function that deallocates a "batch_runjob_status" structure
+ *
+ * @param[in] rsp - list of run job status
+ *
+ * @return	Void
+ *
+ */
+void
+__pbs_runjobstatfree(struct batch_runjob_status *rsp)
+{
+	struct batch_runjob_status *rsnxt;
+
+	while (rsp != NULL) {
+		free(rsp->name);
+		free(rsp->text);
+		rsnxt = rsp->next;
+		free(rsp);
+		rsp = rsnxt;
+	}
 }
@@ -292,6 +292,77 @@ __pbs_selstat(int c, struct attropl *attrib, struct attrl *rattrib, char *extend
 	return PBSD_status_aggregate(c, PBS_BATCH_SelStat, NULL, attrib, extend, MGR_OBJ_JOB, rattrib);
 }
 
+/**
+ * @brief
+ *	-send a tagged Selectable Status request, the reply is collected later
+ *	by pbs_async_wait() under the tag returned.  Unlike pbs_selstat() only
+ *	the server the connection is to is asked.
+ *
+ * @param[in] c - communication handle
+ * @param[in] attrib - pointer to attropl structure(selection criteria)
+ * @param[in] rattrib - list of attributes to return
+ * @param[in] extend - extend string to encode req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error, pbs_errno set
+ *
+ */
+unsigned int
+__pbs_async_selstat(int c, struct attropl *attrib, struct attrl *rattrib, char *extend)
+{
+	unsigned int tag;
+	int rc;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return 0;
+
+	/* the jobs of the other servers would be missed */
+	if (get_num_servers() > 1) {
+		pbs_errno = PBSE_NOSUP;
+		return 0;
+	}
+
+	/* first verify the attributes, if verification is enabled */
+	if (pbs_verify_attributes(c, PBS_BATCH_SelStat, MGR_OBJ_JOB, MGR_CMD_NONE, attrib))
+		return 0;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return 0;
+
+	if ((tag = PBSD_async_add(c)) == 0) {
+		(void)pbs_client_thread_unlock_connection(c);
+		return 0;
+	}
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr_tagged(c, PBS_BATCH_SelStat, pbs_current_user, tag)) ||
+		(rc = encode_DIS_attropl(c, attrib)) ||
+		(rc = encode_DIS_attrl(c, rattrib)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		rc = DIS_PROTO;
+	}
+
+	if (rc != 0) {
+		PBSD_async_cancel(c, tag);
+		tag = 0;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return 0;
+
+	return tag;
+}
+
 
 /**
  * @brief
@@ -68,3 +68,69 @@ __pbs_statjob(int c, char *id, struct attrl *attrib, char *extend)
 {
 	return PBSD_status_aggregate(c, PBS_BATCH_StatusJob, id, attrib, extend, MGR_OBJ_JOB, NULL);
 }
+
+/**
+ * @brief
+ *	-send a tagged Status Job request, the reply is collected later by
+ *	pbs_async_wait() under the tag returned
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - job id
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ *
+ * @return	unsigned int
+ * @retval	tag of the request	success
+ * @retval	0			error, pbs_errno set
+ *
+ */
+unsigned int
+__pbs_async_statjob(int c, char *id, struct attrl *attrib, char *extend)
+{
+	unsigned int tag;
+	int rc;
+
+	if (id == NULL)
+		id = "";
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return 0;
+
+	/* first verify the attributes, if verification is enabled */
+	if (pbs_verify_attributes(c, PBS_BATCH_StatusJob, MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib))
+		return 0;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return 0;
+
+	if ((tag = PBSD_async_add(c)) == 0) {
+		(void)pbs_client_thread_unlock_connection(c);
+		return 0;
+	}
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr_tagged(c, PBS_BATCH_StatusJob, pbs_current_user, tag)) ||
+		(rc = encode_DIS_Status(c, id, attrib)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		rc = DIS_PROTO;
+	}
+
+	if (rc != 0) {
+		PBSD_async_cancel(c, tag);
+		tag = 0;
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return 0;
+
+	return tag;
+}
@@ -49,6 +49,7 @@
 #include <strings.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <assert.h>
 #include "libpbs.h"
 #include "credential.h"
@@ -141,6 +142,48 @@ pbs_submit_with_cred(int c, struct attropl  *attrib, char *script,
 	return ret;
 }
 
+/**
+ * @brief
+ *	Read a whole job script into memory.
+ *
+ * @param[in] script - path of the script
+ * @param[out] len - length of the script
+ *
+ * @return	char *
+ * @retval	the script, NUL terminated, to be freed by the caller
+ * @retval	NULL on failure
+ */
+static char *
+read_script(char *script, size_t *len)
+{
+	struct stat sb;
+	char *buf;
+	ssize_t cc;
+	size_t have = 0;
+	int fd;
+
+	if ((fd = open(script, O_RDONLY, 0)) < 0)
+		return NULL;
+	if ((fstat(fd, &sb) == -1) || ((buf = malloc(sb.st_size + 1)) == NULL)) {
+		close(fd);
+		return NULL;
+	}
+	while (have < (size_t)sb.st_size) {
+		cc = read(fd, buf + have, sb.st_size - have);
+		if (cc <= 0)
+			break;
+		have += cc;
+	}
+	close(fd);
+	if (have != (size_t)sb.st_size) {
+		free(buf);
+		return NULL;
+	}
+	buf[have] = '\0';
+	*len = have;
+	return buf;
+}
+
 /**
  * @brief
  *	-submit job request
@@ -166,6 +209,8 @@ __pbs_submit(int c, struct attropl  *attrib, char *script, char *destination, ch
 	struct cred_info *cred_info = NULL;
 	int commit_done = 0;
 	char *lextend = NULL;
+	char *sbuf;
+	size_t slen;
 	svr_conn_t *svr_connections = get_conn_svr_instances(c);
 	c = random_srv_conn(svr_connections);
 
@@ -219,6 +264,28 @@ __pbs_submit(int c, struct attropl  *attrib, char *script, char *destination, ch
 			extend = EXTEND_OPT_IMPLICIT_COMMIT;
 	}	
 
+	if ((script != NULL) && (*script != '\0') && (!cred_info || (cred_info->cred_len <= 0)) &&
+		get_conn_submitjob(c)) {
+		/*
+		 * send the attributes and the script in one Submit Job request,
+		 * older servers close the connection on it, they get the sequence below
+		 */
+		if ((sbuf = read_script(script, &slen)) == NULL) {
+			pbs_errno = PBSE_BADSCRIPT;
+			goto error;
+		}
+		return_jobid = PBSD_submitjob(c, destination, attrib, sbuf, slen, extend, &commit_done);
+		free(sbuf);
+		if (return_jobid == NULL)
+			goto error;
+		/* a blocking job is not committed with the request */
+		if (!commit_done && (PBSD_commit(c, return_jobid, 0, NULL) != 0)) {
+			free(return_jobid);
+			return_jobid = NULL;
+		}
+		goto done;
+	}
+
 	/* Queue job with null string for job id */
 	return_jobid = PBSD_queuejob(c, "", destination, attrib, extend, PROT_TCP, NULL, &commit_done);
 	if (return_jobid == NULL)
@@ -262,3 +329,102 @@ done:
 	pbs_client_thread_unlock_connection(c);
 	return return_jobid;
 }
+
+/**
+ * @brief
+ *	-submit many jobs in one request
+ *
+ * @par	Functionality:
+ *		Every job gets the attributes in its own list of job_attribs plus
+ *		the ones of attrib it does not set itself, and the script of the
+ *		same index in scripts.  The server queues and commits all the
+ *		jobs at once and writes them to its database in one transaction.
+ *		Blocking jobs (block=true) can not be submitted this way.
+ *
+ * @param[in] c - communication handle
+ * @param[in] attrib - attributes shared by all the jobs
+ * @param[in] njobs - number of jobs
+ * @param[in] job_attribs - attributes of each job, NULL or a NULL entry for none
+ * @param[in] scripts - path of the script of each job, NULL or a NULL entry for none
+ * @param[in] destination - queue or server the jobs are submitted to
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	struct batch_deljob_status *
+ * @retval	one entry per job, in the order of the request, with the job id
+ *		in name, or an empty string and the error in code if the job
+ *		was rejected.  To be freed with pbs_delstatfree().
+ * @retval	NULL	error, pbs_errno set
+ *
+ */
+struct batch_deljob_status *
+__pbs_submit_many(int c, struct attropl *attrib, int njobs, struct attropl **job_attribs,
+	char **scripts, char *destination, char *extend)
+{
+	struct batch_deljob_status *ret = NULL;
+	struct attropl *pal;
+	char **sbufs = NULL;
+	size_t *slens = NULL;
+	int i;
+	svr_conn_t *svr_connections = get_conn_svr_instances(c);
+	c = random_srv_conn(svr_connections);
+
+	/* initialize the thread context data, if not already initialized */
+	if ((pbs_errno = pbs_client_thread_init_thread_context()) != 0)
+		return NULL;
+
+	if (njobs <= 0) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	/* first verify the attributes, if verification is enabled */
+	if (pbs_verify_attributes(c, PBS_BATCH_QueueJob, MGR_OBJ_JOB, MGR_CMD_NONE, attrib) != 0)
+		return NULL;
+	for (i = 0; job_attribs && i < njobs; i++) {
+		if (pbs_verify_attributes(c, PBS_BATCH_QueueJob, MGR_OBJ_JOB, MGR_CMD_NONE, job_attribs[i]) != 0)
+			return NULL;
+	}
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	for (pal = attrib; pal; pal = pal->next)
+		pal->op = SET;		/* force operator to SET */
+	for (i = 0; job_attribs && i < njobs; i++) {
+		for (pal = job_attribs[i]; pal; pal = pal->next)
+			pal->op = SET;
+	}
+
+	if (scripts != NULL) {
+		sbufs = calloc(njobs, sizeof(char *));
+		slens = calloc(njobs, sizeof(size_t));
+		if ((sbufs == NULL) || (slens == NULL)) {
+			pbs_errno = PBSE_SYSTEM;
+			goto done;
+		}
+		for (i = 0; i < njobs; i++) {
+			if ((scripts[i] == NULL) || (*scripts[i] == '\0'))
+				continue;
+			if ((sbufs[i] = read_script(scripts[i], &slens[i])) == NULL) {
+				pbs_errno = PBSE_BADSCRIPT;
+				if (set_conn_errtxt(c, "cannot access script file") != 0)
+					pbs_errno = PBSE_SYSTEM;
+				goto done;
+			}
+		}
+	}
+
+	ret = PBSD_submitjoblist(c, destination, attrib, njobs, job_attribs, sbufs, slens, extend);
+
+done:
+	for (i = 0; sbufs && i < njobs; i++)
+		free(sbufs[i]);
+	free(sbufs);
+	free(slens);
+
+	/* unlock the thread lock and update the thread context data */
+	pbs_client_thread_unlock_connection(c);
+	return ret;
+}
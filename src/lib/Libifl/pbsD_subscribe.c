@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	pbsD_subscribe.c
+ * @brief
+ *	Event subscriptions.  Once pbs_subscribe() is accepted, the server
+ *	pushes a status reply on the connection each time a job, vnode or
+ *	reservation the client subscribed to changes state, and the
+ *	connection is used only to read those with pbs_get_events().
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <string.h>
+#include <stdio.h>
+#include "libpbs.h"
+#include "ifl_internal.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-send a Subscribe request and wait for the server to accept it
+ *
+ * @param[in] c - connection handle
+ * @param[in] events - comma separated list of SUBSCRIBE_* event classes
+ * @param[in] filter - only jobs and reservations whose ATTR_euser and
+ *		       ATTR_queue match the values given here, may be NULL
+ * @param[in] extend - extend string to encode req
+ *
+ * @return      int
+ * @retval      0       success
+ * @retval      !0      error, pbs_errno set
+ *
+ */
+int
+__pbs_subscribe(int c, char *events, struct attrl *filter, char *extend)
+{
+	int rc;
+	struct batch_reply *reply;
+
+	if ((events == NULL) || (*events == '\0'))
+		return (pbs_errno = PBSE_IVALREQ);
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return pbs_errno;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return pbs_errno;
+
+	if ((rc = PBSD_status_put(c, PBS_BATCH_Subscribe, events, filter, extend, PROT_TCP, NULL)) != 0) {
+		(void)pbs_client_thread_unlock_connection(c);
+		return rc;
+	}
+
+	/* read reply from stream into presentation element */
+
+	reply = PBSD_rdrpy(c);
+	PBSD_FreeReply(reply);
+
+	rc = get_conn_errno(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return pbs_errno;
+
+	return rc;
+}
+
+/**
+ * @brief
+ *	-read the next batch of events pushed on a subscribed connection.
+ *	Each event is a batch_status named after the job, vnode or
+ *	reservation, holding its new state and ATTR_event_time.
+ *
+ * @param[in] c - connection handle
+ * @param[in] timeout - seconds to wait for events, 0 to poll, < 0 forever
+ *
+ * @return      struct batch_status *
+ * @retval      list of events, in the order they happened.  The caller
+ *		must free it with pbs_statfree().
+ * @retval      NULL	- no events in time (pbs_errno is 0) or error
+ *
+ */
+struct batch_status *
+__pbs_get_events(int c, int timeout)
+{
+	struct batch_status *events = NULL;
+	struct batch_reply *reply;
+	int rc;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	DIS_tcp_funcs();
+
+	pbs_errno = PBSE_NONE;
+	if ((rc = PBSD_readable(c, timeout)) < 0) {
+		pbs_errno = PBSE_PROTOCOL;
+	} else if (rc > 0) {
+		if ((reply = PBSD_rdrpy_one(c, &rc)) == NULL) {
+			(void)set_conn_errtxt(c, dis_emsg[rc]);
+			pbs_errno = PBSE_PROTOCOL;
+		} else {
+			if (reply->brp_choice != BATCH_REPLY_CHOICE_Status)
+				pbs_errno = PBSE_PROTOCOL;
+			else {
+				events = reply->brp_un.brp_statc;
+				reply->brp_un.brp_statc = NULL;
+			}
+			PBSD_FreeReply(reply);
+		}
+	}
+	rc = pbs_errno;
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		__pbs_statfree(events);
+		return NULL;
+	}
+	pbs_errno = rc;
+
+	return events;
+}
@@ -39,7 +39,217 @@
 %module pbs_ifl
 
 %{
+#include <stdlib.h>
+#include <string.h>
 #include "pbs_ifl.h"
+
+/* one requested attribute of pbs_status_columns() and its values */
+struct status_column {
+	const char *sc_name;
+	PyObject *sc_list;
+};
+
+static int
+status_column_cmp(const void *a, const void *b)
+{
+	return strcmp(((const struct status_column *)a)->sc_name,
+		((const struct status_column *)b)->sc_name);
+}
+
+/**
+ * @brief
+ *	Put one attribute value into the slot of the current row of a column.
+ *	An attribute that shows up more than once, like max_run, gets its
+ *	values joined by commas.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: Python error set
+ */
+static int
+status_column_set(PyObject *list, Py_ssize_t row, const char *value)
+{
+	PyObject *old = PyList_GET_ITEM(list, row);
+	PyObject *val;
+
+	if (value == NULL)
+		value = "";
+	val = PyUnicode_DecodeUTF8(value, strlen(value), "surrogateescape");
+	if (val == NULL)
+		return -1;
+	if (old != Py_None) {
+		PyObject *joined = PyUnicode_FromFormat("%U,%U", old, val);
+
+		Py_DECREF(val);
+		if (joined == NULL)
+			return -1;
+		val = joined;
+	}
+	/* steals the reference to val and releases the old item */
+	PyList_SET_ITEM(list, row, val);
+	Py_DECREF(old);
+	return 0;
+}
 %}
 
 %include "pbs_ifl.h"
+
+%inline %{
+/**
+ * @brief
+ *	Turn a batch status list into columns: a dict which maps "id" and
+ *	each attribute name to a list with one value per status entry, in
+ *	the order of the entries.  Resources are named "<attr>.<resource>",
+ *	values are strings and None where an entry lacks the attribute.
+ *	The whole reply is walked in C, so no attrl objects are created
+ *	for Python.  The batch status still has to be freed by the caller.
+ *
+ * @param[in]	bs	- the batch status, as returned by pbs_stat*()
+ * @param[in]	names	- sequence of the attribute names wanted, or None
+ *			  for every attribute that appears in the reply
+ *
+ * @return	PyObject *
+ * @retval	dict of lists	: success
+ * @retval	NULL	: Python error set
+ */
+PyObject *
+pbs_status_columns(struct batch_status *bs, PyObject *names)
+{
+	PyObject *result = NULL;
+	PyObject *ids;
+	PyObject *seq = NULL;
+	struct status_column *cols = NULL;
+	Py_ssize_t ncols = 0;
+	Py_ssize_t row;
+	Py_ssize_t i;
+	char *key = NULL;
+	size_t keysz = 0;
+
+	if ((result = PyDict_New()) == NULL)
+		return NULL;
+	if ((ids = PyList_New(0)) == NULL)
+		goto err;
+	i = PyDict_SetItemString(result, "id", ids);
+	Py_DECREF(ids);
+	if (i != 0)
+		goto err;
+
+	if (names != Py_None) {
+		if ((seq = PySequence_Fast(names, "names must be a sequence or None")) == NULL)
+			goto err;
+		ncols = PySequence_Fast_GET_SIZE(seq);
+		if (ncols > 0 && (cols = PyMem_Calloc(ncols, sizeof(struct status_column))) == NULL) {
+			PyErr_NoMemory();
+			goto err;
+		}
+		for (i = 0; i < ncols; i++) {
+			PyObject *name = PySequence_Fast_GET_ITEM(seq, i);
+
+			if ((cols[i].sc_name = PyUnicode_AsUTF8(name)) == NULL)
+				goto err;
+			if ((cols[i].sc_list = PyList_New(0)) == NULL)
+				goto err;
+			if (PyDict_SetItem(result, name, cols[i].sc_list) != 0) {
+				Py_DECREF(cols[i].sc_list);
+				goto err;
+			}
+			/* the dict keeps the list alive */
+			Py_DECREF(cols[i].sc_list);
+		}
+		if (ncols > 1)
+			qsort(cols, ncols, sizeof(struct status_column), status_column_cmp);
+	}
+
+	for (row = 0; bs != NULL; bs = bs->next, row++) {
+		struct attrl *pat;
+		PyObject *id;
+
+		if ((id = PyUnicode_DecodeUTF8(bs->name ? bs->name : "", bs->name ? strlen(bs->name) : 0, "surrogateescape")) == NULL)
+			goto err;
+		i = PyList_Append(ids, id);
+		Py_DECREF(id);
+		if (i != 0)
+			goto err;
+
+		if (cols != NULL) {
+			for (i = 0; i < ncols; i++)
+				if (PyList_Append(cols[i].sc_list, Py_None) != 0)
+					goto err;
+		} else if (names == Py_None) {
+			PyObject *k;
+			PyObject *list;
+
+			i = 0;
+			while (PyDict_Next(result, &i, &k, &list))
+				if (list != ids && PyList_Append(list, Py_None) != 0)
+					goto err;
+		}
+
+		for (pat = bs->attribs; pat != NULL; pat = pat->next) {
+			const char *kname = pat->name;
+			PyObject *list;
+
+			if (kname == NULL)
+				continue;
+			if (pat->resource != NULL && *pat->resource != '\0') {
+				size_t len = strlen(pat->name) + strlen(pat->resource) + 2;
+
+				if (len > keysz) {
+					char *nkey = PyMem_Realloc(key, len);
+
+					if (nkey == NULL) {
+						PyErr_NoMemory();
+						goto err;
+					}
+					key = nkey;
+					keysz = len;
+				}
+				sprintf(key, "%s.%s", pat->name, pat->resource);
+				kname = key;
+			}
+
+			if (names != Py_None) {
+				struct status_column want;
+				struct status_column *col;
+
+				if (ncols == 0)
+					break;
+				want.sc_name = kname;
+				col = bsearch(&want, cols, ncols, sizeof(struct status_column), status_column_cmp);
+				if (col == NULL)
+					continue;
+				list = col->sc_list;
+			} else if ((list = PyDict_GetItemString(result, kname)) == NULL) {
+				Py_ssize_t j;
+
+				/* first time this attribute is seen, earlier rows lack it */
+				if ((list = PyList_New(0)) == NULL)
+					goto err;
+				i = PyDict_SetItemString(result, kname, list);
+				Py_DECREF(list);
+				if (i != 0)
+					goto err;
+				for (j = 0; j <= row; j++)
+					if (PyList_Append(list, Py_None) != 0)
+						goto err;
+			} else if (list == ids)
+				continue;
+
+			if (status_column_set(list, row, pat->value) != 0)
+				goto err;
+		}
+	}
+
+	PyMem_Free(key);
+	PyMem_Free(cols);
+	Py_XDECREF(seq);
+	return result;
+
+err:
+	PyMem_Free(key);
+	PyMem_Free(cols);
+	Py_XDECREF(seq);
+	Py_XDECREF(result);
+	return NULL;
+}
+%}
@@ -130,6 +130,12 @@ struct pbs_config pbs_conf = {
 	NULL,					/* for router, default communication routers list */
 	0,					/* default comm logevent mask */
 	4,					/* default number of threads */
+	0,					/* default tpp coalesce delay (ms) */
+	0,					/* do not use io_uring by default */
+	0,					/* text DIS encoding by default */
+	0,					/* no authenticated sessions by default */
+	0,					/* no hot standby by default */
+	0,					/* no status snapshot by default */
 	NULL,					/* mom short name override */
 	NULL,					/* pbs_lr_save_path */
 	0,					/* high resolution timestamp logging */
@@ -524,7 +530,7 @@ __pbs_loadconf(int reload)
 			}
 			else if (!strcmp(conf_name, PBS_CONF_USE_COMPRESSION)) {
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
-					pbs_conf.pbs_use_compression = ((uvalue > 0) ? 1 : 0);
+					pbs_conf.pbs_use_compression = ((uvalue > 2) ? 1 : uvalue);
 			}
 			else if (!strcmp(conf_name, PBS_CONF_USE_MCAST)) {
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
@@ -562,6 +568,30 @@ __pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_comm_log_events = uvalue;
 			}
+			else if (!strcmp(conf_name, PBS_CONF_TPP_COALESCE_DELAY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_tpp_coalesce_delay = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_USE_IO_URING)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_use_io_uring = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_DIS_BINARY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_dis_binary = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_AUTH_SESSIONS)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_auth_sessions = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_HOT_STANDBY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_hot_standby = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_STATUS_SNAPSHOT)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_status_snapshot = uvalue;
+			}
 			else if (!strcmp(conf_name, PBS_CONF_HOME)) {
 				free(pbs_conf.pbs_home_path);
 				pbs_conf.pbs_home_path = shorten_and_cleanup_path(conf_value);
@@ -826,7 +856,7 @@ __pbs_loadconf(int reload)
 	}
 	if ((gvalue = getenv(PBS_CONF_USE_COMPRESSION)) != NULL) {
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
-			pbs_conf.pbs_use_compression = ((uvalue > 0) ? 1 : 0);
+			pbs_conf.pbs_use_compression = ((uvalue > 2) ? 1 : uvalue);
 	}
 	if ((gvalue = getenv(PBS_CONF_USE_MCAST)) != NULL) {
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
@@ -864,6 +894,30 @@ __pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_comm_log_events = uvalue;
 	}
+	if ((gvalue = getenv(PBS_CONF_TPP_COALESCE_DELAY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_tpp_coalesce_delay = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_USE_IO_URING)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_use_io_uring = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_DIS_BINARY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_dis_binary = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_AUTH_SESSIONS)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_auth_sessions = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_HOT_STANDBY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_hot_standby = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_STATUS_SNAPSHOT)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_status_snapshot = uvalue;
+	}
 	if ((gvalue = getenv(PBS_CONF_DATA_SERVICE_PORT)) != NULL) {
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_data_service_port =
@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	pbs_statsnap.c
+ * @brief
+ * Return the status of jobs, vnodes or queues from the status snapshot the
+ * server writes when PBS_STATUS_SNAPSHOT is set, without a request to the
+ * server.  The snapshot format is described in pbs_share.h.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "libpbs.h"
+#include "pbs_share.h"
+
+/* seconds a snapshot may be late before it is taken as stale */
+#define SNAPSHOT_GRACE	10
+
+/**
+ * @brief
+ *	-read an integer of the snapshot
+ *
+ * @param[in,out] pp - position in the snapshot, moved past the integer
+ * @param[in] end - end of the snapshot
+ * @param[out] val - the integer
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	the snapshot is truncated
+ */
+static int
+snap_get_u32(char **pp, char *end, uint32_t *val)
+{
+	if (end - *pp < (long) sizeof(uint32_t))
+		return -1;
+	memcpy(val, *pp, sizeof(uint32_t));
+	*pp += sizeof(uint32_t);
+	return 0;
+}
+
+/**
+ * @brief
+ *	-read a string of the snapshot
+ *
+ * @param[in,out] pp - position in the snapshot, moved past the string
+ * @param[in] end - end of the snapshot
+ * @param[out] str - the string, pointing into the snapshot, NULL if empty
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	the snapshot is truncated or corrupt
+ */
+static int
+snap_get_str(char **pp, char *end, char **str)
+{
+	uint32_t len;
+
+	if (snap_get_u32(pp, end, &len) != 0)
+		return -1;
+	*str = NULL;
+	if (len == 0)
+		return 0;
+	if (end - *pp < (long) len || (*pp)[len - 1] != '\0')
+		return -1;
+	*str = *pp;
+	*pp += len;
+	return 0;
+}
+
+/**
+ * @brief
+ *	-whether an object of the snapshot is the one asked for
+ *
+ * @param[in] obj_type - MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_QUEUE
+ * @param[in] id - the id asked for, a job may be given without its server
+ * @param[in] name - name of the object in the snapshot
+ *
+ * @return	int
+ * @retval	1	it is
+ * @retval	0	it is not
+ */
+static int
+snap_match_id(int obj_type, char *id, char *name)
+{
+	size_t len;
+
+	if (strcmp(id, name) == 0)
+		return 1;
+	if (obj_type != MGR_OBJ_JOB || strchr(id, '.') != NULL)
+		return 0;
+	len = strlen(id);
+	return (strncmp(id, name, len) == 0 && name[len] == '.');
+}
+
+/**
+ * @brief
+ *	-whether an attribute of the snapshot was asked for
+ *
+ * @param[in] attrib - attributes asked for, NULL for all
+ * @param[in] name - attribute name
+ * @param[in] resc - resource name or NULL
+ *
+ * @return	int
+ * @retval	1	it was
+ * @retval	0	it was not
+ */
+static int
+snap_match_attr(struct attrl *attrib, char *name, char *resc)
+{
+	if (attrib == NULL)
+		return 1;
+	for (; attrib != NULL; attrib = attrib->next) {
+		if (attrib->name == NULL || strcmp(attrib->name, name) != 0)
+			continue;
+		if (attrib->resource == NULL || *attrib->resource == '\0')
+			return 1;
+		if (resc != NULL && strcmp(attrib->resource, resc) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	-Return the status of jobs, vnodes or queues from the server's status
+ *	snapshot, without going through the server.
+ *
+ * @par
+ *	The snapshot is only found on the server host, readable by root, and
+ *	is as old as PBS_STATUS_SNAPSHOT seconds at most.  One missing, stale
+ *	or written by a newer server is not used, the caller should fall back
+ *	to pbs_statjob(), pbs_statvnode() or pbs_statque().
+ *
+ * @param[in] obj_type - MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_QUEUE
+ * @param[in] id - object id, NULL or "" for all the objects of the type
+ * @param[in] attrib - attributes to return, NULL for all
+ *
+ * @return	structure handle, free with pbs_statfree()
+ * @retval	pointer to batch_status struct		Success
+ * @retval	NULL	no object, or error with pbs_errno set:
+ *			PBSE_NOSERVER, no usable snapshot
+ *			PBSE_UNKJOBID, PBSE_UNKNODE, PBSE_UNKQUE, id not found
+ *			PBSE_PROTOCOL, snapshot of an unknown format
+ *			PBSE_SYSTEM, out of memory
+ */
+struct batch_status *
+__pbs_statsnap(int obj_type, char *id, struct attrl *attrib)
+{
+	struct snapshot_hdr hdr;
+	struct batch_status *ret = NULL;
+	struct batch_status **bstail = &ret;
+	struct stat sb;
+	char *path;
+	char *map;
+	char *p;
+	char *end;
+	uint32_t i;
+	int fd;
+
+	pbs_errno = PBSE_NONE;
+	if (obj_type != MGR_OBJ_JOB && obj_type != MGR_OBJ_NODE && obj_type != MGR_OBJ_QUEUE) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	if (pbs_loadconf(0) == 0) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	if (id != NULL && *id == '\0')
+		id = NULL;
+
+	if ((path = malloc(strlen(pbs_conf.pbs_home_path) + sizeof(SNAPSHOT_PATH) + 1)) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	sprintf(path, "%s/%s", pbs_conf.pbs_home_path, SNAPSHOT_PATH);
+	fd = open(path, O_RDONLY);
+	free(path);
+	if (fd == -1) {
+		pbs_errno = PBSE_NOSERVER;
+		return NULL;
+	}
+	if (fstat(fd, &sb) == -1 || sb.st_size < (off_t) sizeof(hdr)) {
+		close(fd);
+		pbs_errno = PBSE_NOSERVER;
+		return NULL;
+	}
+	map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+
+	memcpy(&hdr, map, sizeof(hdr));
+	if (memcmp(hdr.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+	    hdr.version != SNAPSHOT_VERSION || hdr.hdr_size < sizeof(hdr) ||
+	    hdr.hdr_size > (uint64_t) sb.st_size ||
+	    hdr.data_len > (uint64_t) sb.st_size - hdr.hdr_size) {
+		munmap(map, sb.st_size);
+		pbs_errno = PBSE_PROTOCOL;
+		return NULL;
+	}
+	if (time(NULL) - hdr.taken > 2 * (int64_t) hdr.interval + SNAPSHOT_GRACE) {
+		munmap(map, sb.st_size);
+		pbs_errno = PBSE_NOSERVER;
+		return NULL;
+	}
+
+	p = map + hdr.hdr_size;
+	end = p + hdr.data_len;
+	for (i = 0; i < hdr.num_objs; i++) {
+		struct batch_status *bs = NULL;
+		struct attrl **attail = NULL;
+		uint32_t objtype;
+		uint32_t num_attrs;
+		uint32_t j;
+		char *name;
+
+		if (snap_get_u32(&p, end, &objtype) != 0 ||
+		    snap_get_u32(&p, end, &num_attrs) != 0 ||
+		    snap_get_str(&p, end, &name) != 0 || name == NULL)
+			goto corrupt;
+
+		if ((int) objtype == obj_type && (id == NULL || snap_match_id(obj_type, id, name))) {
+			if ((bs = calloc(1, sizeof(struct batch_status))) == NULL ||
+			    (bs->name = strdup(name)) == NULL) {
+				free(bs);
+				goto nomem;
+			}
+			*bstail = bs;
+			bstail = &bs->next;
+			attail = &bs->attribs;
+		}
+
+		for (j = 0; j < num_attrs; j++) {
+			struct attrl *pat;
+			char *aname;
+			char *resc;
+			char *val;
+
+			if (snap_get_str(&p, end, &aname) != 0 || aname == NULL ||
+			    snap_get_str(&p, end, &resc) != 0 ||
+			    snap_get_str(&p, end, &val) != 0)
+				goto corrupt;
+			if (bs == NULL || !snap_match_attr(attrib, aname, resc))
+				continue;
+			if ((pat = calloc(1, sizeof(struct attrl))) == NULL)
+				goto nomem;
+			/* linked in first, so pbs_statfree() frees it on failure */
+			*attail = pat;
+			attail = &pat->next;
+			if ((pat->name = strdup(aname)) == NULL ||
+			    (resc != NULL && (pat->resource = strdup(resc)) == NULL) ||
+			    (pat->value = strdup(val != NULL ? val : "")) == NULL)
+				goto nomem;
+		}
+
+		/* a single object is asked for, no need to look further */
+		if (bs != NULL && id != NULL && obj_type != MGR_OBJ_JOB)
+			break;
+	}
+	munmap(map, sb.st_size);
+
+	if (ret == NULL && id != NULL) {
+		if (obj_type == MGR_OBJ_JOB)
+			pbs_errno = PBSE_UNKJOBID;
+		else if (obj_type == MGR_OBJ_NODE)
+			pbs_errno = PBSE_UNKNODE;
+		else
+			pbs_errno = PBSE_UNKQUE;
+	}
+	return ret;
+
+corrupt:
+	munmap(map, sb.st_size);
+	pbs_statfree(ret);
+	pbs_errno = PBSE_PROTOCOL;
+	return NULL;
+
+nomem:
+	munmap(map, sb.st_size);
+	pbs_statfree(ret);
+	pbs_errno = PBSE_SYSTEM;
+	return NULL;
+}
@@ -46,6 +46,7 @@
 #endif
 #include <unistd.h>
 #include <poll.h>
+#include <sys/uio.h>
 #include "libsec.h"
 #include "libpbs.h"
 #include "dis.h"
@@ -55,6 +56,7 @@ volatile int reply_timedout = 0; /* for reply_send.c -- was alarm handler called
 
 static int tcp_recv(int, void *, int);
 static int tcp_send(int, void *, int);
+static int tcp_sendv(int, void *, int, void *, int);
 
 /**
  * @brief
@@ -266,6 +268,66 @@ tcp_send(int fd, void *data, int len)
 	return len;
 }
 
+/**
+ * @brief
+ * 	tcp_sendv - send a packet header followed by its data to tcp stream
+ *
+ *	Both parts go out in one writev() where possible, so that large data
+ *	need not be copied behind the header first.
+ *
+ * @param[in] fd - socket descriptor
+ * @param[in] hdr - packet header
+ * @param[in] hdrlen - length of hdr
+ * @param[in] data - packet data
+ * @param[in] len - length of data
+ *
+ * @return	int
+ * @retval	>0	number of bytes sent
+ * @retval	-1	if error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+tcp_sendv(int fd, void *hdr, int hdrlen, void *data, int len)
+{
+#ifndef WIN32
+	struct iovec iov[2];
+	ssize_t i;
+
+	iov[0].iov_base = hdr;
+	iov[0].iov_len = hdrlen;
+	iov[1].iov_base = data;
+	iov[1].iov_len = len;
+	do {
+		i = writev(fd, iov, 2);
+	} while (i == -1 && errno == EINTR);
+	if (i == -1) {
+		if (errno != EAGAIN) {
+			pbs_tcp_errno = errno;
+			return (-1);
+		}
+		i = 0;
+	}
+	/* let tcp_send() wait for the socket to take whatever is left */
+	if (i < hdrlen) {
+		if (tcp_send(fd, (char *) hdr + i, hdrlen - i) < 0)
+			return (-1);
+		i = 0;
+	} else
+		i -= hdrlen;
+	if (i < len && tcp_send(fd, (char *) data + i, len - i) < 0)
+		return (-1);
+#else
+	if (tcp_send(fd, hdr, hdrlen) < 0 || tcp_send(fd, data, len) < 0)
+		return (-1);
+#endif
+	return (hdrlen + len);
+}
+
 /**
  * @brief
  *	sets tcp related functions.
@@ -278,4 +340,5 @@ DIS_tcp_funcs()
 	pfn_transport_set_chan = set_conn_chan;
 	pfn_transport_recv = tcp_recv;
 	pfn_transport_send = tcp_send;
+	pfn_transport_sendv = tcp_sendv;
 }
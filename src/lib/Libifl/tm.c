@@ -124,7 +124,7 @@ static	char		*localhost = LOCALHOST_SHORTNAME;
  **	are recorded and as information is received from MOM's, the
  **	event is updated and marked so tm_poll() can return it to the user.
  */
-#define	EVENT_HASH	128
+#define	EVENT_HASH	4096
 
 /*
  * a bit of code to map a tm_ error number to the symbol
@@ -314,7 +314,7 @@ add_event(tm_event_t event, tm_node_id node, int type, void *info)
  **	can be resolved into real tasks on real nodes.
  **	We will use a hash table.
  */
-#define	TASK_HASH	256
+#define	TASK_HASH	4096
 typedef	struct	task_info {
 	char			*t_jobid;	/* jobid */
 	tm_task_id		 t_task;	/* task id */
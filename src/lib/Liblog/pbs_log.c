@@ -109,6 +109,9 @@ static int	     log_auto_switch = 0;
 static int	     log_open_day;
 static FILE	    *logfile;		/* open stream for log file */
 static volatile int  log_opened = 0;
+static int	     log_flush_sev = -1;	/* write at once up to this severity, -1 for all */
+static time_t	     log_tm_sec = -1;	/* second log_tm is for */
+static struct tm     log_tm;		/* broken down time stamp of the last record */
 #if SYSLOG
 static int	     syslogopen = 0;
 #endif	/* SYSLOG */
@@ -360,6 +363,9 @@ void
 log_atfork_prepare()
 {
 	log_mutex_lock();
+	/* the child must not write the records held for log_flush() again */
+	if ((log_opened == 1) && (logfile != NULL))
+		(void)fflush(logfile);
 }
 
 /**
@@ -381,6 +387,8 @@ log_atfork_parent()
 void
 log_atfork_child()
 {
+	/* a child may leave through _exit(), write each of its records */
+	log_flush_sev = -1;
 	log_mutex_unlock();
 }
 #endif
@@ -637,7 +645,8 @@ log_open_main(char *filename, char *directory, int silent)
 #ifdef WIN32
 		(void)setvbuf(logfile, NULL, _IONBF, 0);	/* no buffering to get instant log */
 #else
-		(void)setvbuf(logfile, NULL, _IOLBF, 0);	/* set line buffering */
+		/* records are flushed by log_record() or log_flush() */
+		(void)setvbuf(logfile, NULL, _IOFBF, LOG_FILE_BUFSZ);
 #endif
 		log_opened = 1;			/* note that file is open */
 
@@ -986,16 +995,24 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 			snprintf(microsec_buf, sizeof(microsec_buf), ".%06ld", (long)tp.tv_usec);
 	}
 
-#ifdef WIN32
-	ptm = localtime(&now);
-#else
-	ptm = localtime_r(&now, &ltm);
-#endif
-
 	/* lock the log mutex */
 	if (log_mutex_lock() != 0)
 		goto sigunblock;
 
+	/* records come in bursts, break the time down once per second */
+	if (now != log_tm_sec) {
+#ifdef WIN32
+		ptm = localtime(&now);
+#else
+		ptm = localtime_r(&now, &ltm);
+#endif
+		if (ptm != NULL) {
+			log_tm = *ptm;
+			log_tm_sec = now;
+		}
+	}
+	ptm = &log_tm;
+
 	/* Do we need to switch the log? */
 	if (log_auto_switch && (ptm->tm_yday != log_open_day)) {
 		log_close(1);
@@ -1021,7 +1038,9 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 			     eventtype & ~PBSEVENT_FORCE, msg_daemonname,
 			     class_names[objclass], objname, text);
 
-		(void)fflush(logfile);
+		/* keep less severe records for log_flush() when asked to */
+		if ((log_flush_sev < 0) || (sev <= log_flush_sev))
+			(void)fflush(logfile);
 		if (rc < 0) {
 			rc = errno;
 			clearerr(logfile);
@@ -1058,6 +1077,50 @@ sigunblock:
 #endif
 }
 
+/**
+ * @brief
+ *	Let log_record() hold back records less severe than 'sev' (see
+ *	syslog(3)) until log_flush() is called, so a busy daemon writes its
+ *	log once per pass of its main loop instead of once per record.
+ *	More severe records, and those already held, are written at once.
+ *
+ * @param[in] sev - severity to write at once, -1 to write every record
+ *
+ * @return	Void
+ */
+void
+log_set_flush_severity(int sev)
+{
+	log_flush_sev = sev;
+}
+
+/**
+ * @brief
+ *	Write out the records held back by log_record(), see
+ *	log_set_flush_severity().
+ *
+ * @return	Void
+ */
+void
+log_flush(void)
+{
+#ifndef WIN32
+	sigset_t block_mask;
+	sigset_t old_mask;
+
+	sigfillset(&block_mask);
+	sigprocmask(SIG_BLOCK, &block_mask, &old_mask);
+#endif
+	if ((log_opened == 1) && (log_mutex_lock() == 0)) {
+		if (log_opened == 1)
+			(void)fflush(logfile);
+		log_mutex_unlock();
+	}
+#ifndef WIN32
+	sigprocmask(SIG_SETMASK, &old_mask, NULL);
+#endif
+}
+
 /**
  * @brief
  * 	log_close - close the current open log file
@@ -106,6 +106,7 @@ static int 	conn_find_usable_index(int);
 static int 	conn_find_actual_index(int);
 static void 	accept_conn();
 static void 	cleanup_conn(int);
+static int 	process_priority_sockets(void *);
 
 /**
  * @brief
@@ -512,6 +513,43 @@ process_socket(int sock)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Serve the priority sockets that are ready, without waiting
+ *
+ * @param[in] priority_context - context consists of high priority socket connections
+ *
+ * @return	int
+ * @retval	-1	- the poll failed
+ * @retval	>=0	- number of ready priority sockets
+ *
+ */
+static int
+process_priority_sockets(void *priority_context)
+{
+	em_event_t *pevents;
+	int pnfds;
+	int i;
+#ifndef WIN32
+	sigset_t emptyset;
+
+	/* wait after unblocking signals in an atomic call */
+	sigemptyset(&emptyset);
+	pnfds = tpp_em_pwait(priority_context, &pevents, 0, &emptyset);
+#else
+	pnfds = tpp_em_wait(priority_context, &pevents, 0);
+#endif /* WIN32 */
+	for (i = 0; i < pnfds; i++) {
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER,
+			LOG_DEBUG, __func__, "processing priority socket");
+		if (process_socket(EM_GET_FD(pevents, i)) == -1) {
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
+				LOG_DEBUG, __func__, "process priority socket failed");
+		}
+	}
+	return pnfds;
+}
+
 /**
  * @brief
  *	Waits for events on a set of sockets and calls processing function
@@ -523,6 +561,9 @@ process_socket(int sock)
  *	based on the platform on the socket fds.
  *	It loops through the socket fds which has events on them and the processing
  *	routine associated with the socket is invoked.
+ *	Sockets in the priority context (scheduler connections and TPP) are
+ *	served first, and again before each other socket, so they never wait
+ *	behind more than one non priority request.
  *
  * @param[in] waittime - Timeout for tpp_em_wait (poll)
  * @param[in] priority_context - context consists of high priority socket connections
@@ -541,13 +582,11 @@ int
 wait_request(float waittime, void *priority_context)
 {
 	int nfds;
-	int pnfds;
 	int i;
 	em_event_t *events;
 	int err;
-	int prio_sock_processed;
+	int prio_polled;
 	int em_fd;
-	int em_pfd;
 	int timeout = (int) (waittime * 1000); /* milli seconds */
 	/* Platform specific declarations */
 
@@ -572,31 +611,9 @@ wait_request(float waittime, void *priority_context)
 			return (-1);
 		}
 	} else {
-		prio_sock_processed = 0;
-		if (priority_context) {
-			em_event_t *pevents;
-			timeout = 0;
-#ifndef WIN32
-        		/* wait after unblocking signals in an atomic call */
-        		sigemptyset(&emptyset);
-        		pnfds = tpp_em_pwait(priority_context, &pevents, timeout, &emptyset);
-        		err = errno;
-#else
-        		pnfds = tpp_em_wait(priority_context, &pevents, timeout);
-        		err = errno;
-#endif /* WIN32 */
-                	for (i = 0; i < pnfds; i++) {
-                        	em_pfd = EM_GET_FD(pevents, i);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER,
-                                        LOG_DEBUG, __func__, "processing priority socket");
-				if (process_socket(em_pfd) == -1) {
-                                	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
-                                        	LOG_DEBUG, __func__, "process priority socket failed");
-                        	} else {
-					prio_sock_processed = 1;
-				}
-			}
-		}
+		prio_polled = 0;
+		if (priority_context)
+			prio_polled = (process_priority_sockets(priority_context) >= 0);
 
 		for (i = 0; i < nfds; i++) {
 			em_fd = EM_GET_FD(events, i);
@@ -617,12 +634,22 @@ wait_request(float waittime, void *priority_context)
 				}
 			}
 #endif
-			if (prio_sock_processed) {
+			if (prio_polled) {
 				int idx = conn_find_actual_index(em_fd);
 				if (idx < 0)
 					continue;
+				/* priority sockets are served by the priority polls only */
 				if (svr_conn[idx]->cn_prio_flag == 1)
 					continue;
+				/*
+				 * Let priority traffic that arrived while the previous
+				 * sockets were served go ahead of this one, so a burst of
+				 * client requests does not hold up the scheduler or MoMs.
+				 */
+				if (i > 0 && process_priority_sockets(priority_context) > 0) {
+					if (conn_find_actual_index(em_fd) < 0)
+						continue;
+				}
 			}
 			if (process_socket(em_fd) == -1) {
 				log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
@@ -150,6 +150,18 @@ port_forwarder(
 				FD_SET((socks + n)->sock, &rfdset);
 				maxsock = (socks + n)->sock > maxsock ?(socks + n)->sock : maxsock;
 			} else{
+				/*
+				 * Move unwritten data to the front once half the
+				 * buffer has been written out, so that reading
+				 * need not wait for the peer to drain it all.
+				 */
+				if ((socks + n)->bufwritten >= PF_BUF_SIZE / 2) {
+					memmove((socks + n)->buff,
+						(socks + n)->buff + (socks + n)->bufwritten,
+						(socks + n)->bufavail - (socks + n)->bufwritten);
+					(socks + n)->bufavail -= (socks + n)->bufwritten;
+					(socks + n)->bufwritten = 0;
+				}
 				if ((socks + n)->bufavail < PF_BUF_SIZE) {
 					FD_SET((socks + n)->sock, &rfdset);
 					maxsock = (socks + n)->sock > maxsock ?(socks + n)->sock : maxsock;
@@ -276,15 +288,17 @@ port_forwarder(
 					(socks + newsock)->peer = peersock;
 					(socks + peersock)->peer = newsock;
 				} else{
-					/* non-listening socket to be read */
-					rc = read(
-						(socks + n)->sock,
-						(socks + n)->buff + (socks + n)->bufavail,
-						PF_BUF_SIZE - (socks + n)->bufavail);
-					if (rc == -1) {
-						if ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR) || (errno == EINPROGRESS)) {
-							continue;
-						}
+					/* non-listening socket to be read, drain it while there is room */
+					do {
+						rc = read(
+							(socks + n)->sock,
+							(socks + n)->buff + (socks + n)->bufavail,
+							PF_BUF_SIZE - (socks + n)->bufavail);
+						if (rc > 0)
+							(socks + n)->bufavail += rc;
+					} while ((rc > 0) && ((socks + n)->bufavail < PF_BUF_SIZE));
+					if ((rc == -1) && (errno != EWOULDBLOCK) && (errno != EAGAIN) &&
+						(errno != EINTR) && (errno != EINPROGRESS)) {
 						shutdown((socks + n)->sock, SHUT_RDWR);
 						close((socks + n)->sock);
 						(socks + n)->active = 0;
@@ -296,18 +310,22 @@ port_forwarder(
 						shutdown((socks + n)->sock, SHUT_RDWR);
 						close((socks + n)->sock);
 						(socks + n)->active = 0;
-					} else{
-						(socks + n)->bufavail += rc;
 					}
 				}
 			} /* END if rfdset */
 			if (FD_ISSET((socks + n)->sock, &wfdset)) {
 				int peer = (socks + n)->peer;
 
-				rc = write(
-					(socks + n)->sock,
-					(socks + peer)->buff + (socks + peer)->bufwritten,
-					(socks + peer)->bufavail - (socks + peer)->bufwritten);
+				/* write out as much of the peer's data as the socket takes */
+				do {
+					rc = write(
+						(socks + n)->sock,
+						(socks + peer)->buff + (socks + peer)->bufwritten,
+						(socks + peer)->bufavail - (socks + peer)->bufwritten);
+					if (rc > 0)
+						(socks + peer)->bufwritten += rc;
+				} while ((rc > 0) &&
+					((socks + peer)->bufwritten < (socks + peer)->bufavail));
 
 				if (rc == -1) {
 					if ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR) || (errno == EINPROGRESS)) {
@@ -324,8 +342,6 @@ port_forwarder(
 					shutdown((socks + n)->sock, SHUT_RDWR);
 					close((socks + n)->sock);
 					(socks + n)->active = 0;
-				} else{
-					(socks + peer)->bufwritten += rc;
 				}
 			} /* END if wfdset */
 			if (!(socks + n)->listening) {
@@ -113,6 +113,10 @@ extern char pbsv1mod_meth_load_resource_value_doc[];
 extern PyObject * pbsv1mod_meth_load_resource_value(PyObject *self,
 	PyObject *args, PyObject *kwds);
 
+extern char pbsv1mod_meth_load_attribute_value_doc[];
+extern PyObject * pbsv1mod_meth_load_attribute_value(PyObject *self,
+	PyObject *args, PyObject *kwds);
+
 extern char pbsv1mod_meth_resource_str_value_doc[];
 extern PyObject * pbsv1mod_meth_resource_str_value(PyObject *self,
 	PyObject *args, PyObject *kwds);
@@ -557,6 +561,9 @@ static PyMethodDef pbs_v1_module_methods[] = {
 	{PY_LOAD_RESOURCE_VALUE_METHOD,
 		(PyCFunction) pbsv1mod_meth_load_resource_value,
 		METH_VARARGS | METH_KEYWORDS, pbsv1mod_meth_load_resource_value_doc},
+	{PY_LOAD_ATTRIBUTE_VALUE_METHOD,
+		(PyCFunction) pbsv1mod_meth_load_attribute_value,
+		METH_VARARGS | METH_KEYWORDS, pbsv1mod_meth_load_attribute_value_doc},
 	{PY_RESOURCE_STR_VALUE_METHOD,
 		(PyCFunction) pbsv1mod_meth_resource_str_value,
 		METH_VARARGS | METH_KEYWORDS, pbsv1mod_meth_resource_str_value_doc},
@@ -694,6 +701,36 @@ ERROR_EXIT:
 }
 
 
+/**
+ * @brief
+ *	Return the module object to put in the namespace of a hook run,
+ *	see pbs_python_ext_namespace_init().  It is built once per
+ *	interpreter; building it for every run cost a new module with all
+ *	its constants each time, and leaked it.
+ *
+ * @return	object
+ * @retval	The module object (borrowed reference), NULL on error
+ */
+PyObject *
+pbs_v1_module_namespace(void)
+{
+	if (PyPbsV1ModuleExtension_Obj == NULL)
+		(void)pbs_v1_module_init();
+	return PyPbsV1ModuleExtension_Obj;
+}
+
+/**
+ * @brief
+ *	Forget the module object of pbs_v1_module_namespace() and the
+ *	attribute values not yet loaded, for when the interpreter is stopped.
+ */
+void
+pbs_v1_module_clear(void)
+{
+	PyPbsV1ModuleExtension_Obj = NULL;
+	pbs_python_clear_attribute_values();
+}
+
 /**
  * @brief
  * 	The below is for embedded interpreter puts it in the __main__
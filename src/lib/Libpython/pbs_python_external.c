@@ -56,9 +56,11 @@
 
 #include <pbs_python_private.h> /* private python file  */
 #include <eval.h>               /* For PyEval_EvalCode  */
+#include <marshal.h>            /* For the compiled code cache */
 #include <pythonrun.h>          /* For Py_SetPythonHome */
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <unistd.h>
 #include <wchar.h>
@@ -74,7 +76,27 @@ static struct _inittab pbs_python_inittab_modules[] = {
 static PyObject *
 _pbs_python_compile_file(const char *file_name,
 	const char *compiled_code_file_name);
+#ifndef WIN32
+static PyObject *
+_pbs_python_load_code_cache(struct python_script *py_script);
+static void
+_pbs_python_save_code_cache(struct python_script *py_script);
+#endif
 extern int pbs_python_setup_namespace_dict(PyObject *globals);
+static void
+_pbs_python_save_hook_modules(void);
+static void
+_pbs_python_warm_hook_modules(void);
+
+/*
+ * Modules imported by hooks are remembered when the interpreter is stopped
+ * and imported again as soon as it is restarted, so the hook runs that
+ * follow a restart (done to bound memory use) find them already loaded.
+ */
+#define PBS_PYTHON_WARM_MODULES_MAX	256
+static PyObject *py_base_modules = NULL; /* sys.modules names at start */
+static char **warm_modules = NULL;
+static int warm_modules_num = 0;
 
 #endif      /* PYTHON */
 
@@ -241,6 +263,9 @@ pbs_python_ext_start_interpreter(struct python_interpreter_data *interp_data)
 
 	interp_data->pbs_python_types_loaded = 1; /* just in case */
 
+	if (!IS_PBS_PYTHON_CMD(pbs_python_daemon_name))
+		_pbs_python_warm_hook_modules();
+
 #ifdef LIBPYTHONSVR
 	PyObject *m, *d, *f, *handler, *sigint;
 	m = PyImport_ImportModule("signal");
@@ -316,9 +341,13 @@ pbs_python_ext_shutdown_interpreter(struct python_interpreter_data *interp_data)
 				LOG_INFO, interp_data->daemon_name,
 				"--> Stopping Python interpreter <--");
 
+			if (!IS_PBS_PYTHON_CMD(pbs_python_daemon_name))
+				_pbs_python_save_hook_modules();
+
 			/* before finalize clear global python objects */
 			pbs_python_event_unset();  /* clear Python event object */
 			pbs_python_unload_python_types(interp_data);
+			pbs_v1_module_clear();
 			Py_Finalize();
 		}
 		interp_data->destroy_interpreter_data(interp_data);
@@ -437,6 +466,7 @@ pbs_python_ext_quick_shutdown_interpreter(void)
 		PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 		LOG_INFO, "pbs_python_ext_quick_shutdown_interpreter",
 		"--> Stopping Python interpreter <--");
+	pbs_v1_module_clear();
 	Py_Finalize();
 #endif /* PYTHON */
 
@@ -449,6 +479,8 @@ pbs_python_ext_free_python_script(
 	if (py_script) {
 		if (py_script->path)
 			free(py_script->path);
+		if (py_script->code_cache)
+			free(py_script->code_cache);
 
 #ifdef PYTHON                 /* --- BEGIN PYTHON BLOCK --- */
 		if (py_script->py_code_obj)
@@ -559,7 +591,7 @@ pbs_python_ext_namespace_init(
 	 */
 	if ((PyDict_SetItemString(namespace_dict,
 		PBS_PYTHON_V1_MODULE_EXTENSION_NAME,
-		pbs_v1_module_init()) == -1)
+		pbs_v1_module_namespace()) == -1)
 		) {
 		snprintf(log_buffer, LOG_BUF_SIZE-1, "%s|adding extension object",
 			__func__);
@@ -620,7 +652,7 @@ pbs_python_check_and_compile_script(struct python_interpreter_data *interp_data,
 			break;
 		(void) memcpy(&obuf, &(py_script->cur_sbuf), sizeof(obuf));
 		if (py_script->check_for_recompile) {
-			if ((stat(py_script->path, &nbuf) != 1) &&
+			if ((stat(py_script->path, &nbuf) != -1) &&
 				(nbuf.st_ino   == obuf.st_ino) &&
 				(nbuf.st_size  == obuf.st_size) &&
 				(nbuf.st_mtime == obuf.st_mtime)) {
@@ -646,11 +678,21 @@ pbs_python_check_and_compile_script(struct python_interpreter_data *interp_data,
 				PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 				LOG_INFO, interp_data->daemon_name, log_buffer);
 
-		if (!(py_script->py_code_obj =
-			_pbs_python_compile_file(py_script->path,
-			"<embedded code object>"))) {
-			pbs_python_write_error_to_log("Failed to compile script");
-			return -2;
+#ifndef WIN32
+		if (py_script->code_cache != NULL)
+			py_script->py_code_obj = _pbs_python_load_code_cache(py_script);
+#endif
+		if (py_script->py_code_obj == NULL) {
+			if (!(py_script->py_code_obj =
+				_pbs_python_compile_file(py_script->path,
+				"<embedded code object>"))) {
+				pbs_python_write_error_to_log("Failed to compile script");
+				return -2;
+			}
+#ifndef WIN32
+			if (py_script->code_cache != NULL)
+				_pbs_python_save_code_cache(py_script);
+#endif
 		}
 	}
 
@@ -929,5 +971,248 @@ ERROR_EXIT:
 	return rv;
 }
 
+#ifndef WIN32
+/*
+ * Header of a compiled code cache file, followed by the marshalled code
+ * object. The cache is only good for the same Python and script file.
+ */
+struct code_cache_hdr {
+	long	magic;		/* PyImport_GetMagicNumber() */
+	ino_t	ino;		/* script file's inode */
+	off_t	size;		/* script file's size */
+	time_t	mtime;		/* script file's modification time */
+};
+
+/**
+ * @brief
+ *	Load the compiled code of 'py_script' from its code cache file,
+ *	if the file was made from the current version of the script.
+ *
+ * @param[in]	py_script - script whose 'cur_sbuf' and 'code_cache' are set
+ *
+ * @return	PyObject *
+ * @retval	code object	- new reference
+ * @retval	NULL		- no usable cache, script needs compiling
+ */
+static PyObject *
+_pbs_python_load_code_cache(struct python_script *py_script)
+{
+	FILE *fp;
+	struct stat sbuf;
+	struct code_cache_hdr hdr;
+	char *buf = NULL;
+	size_t len;
+	PyObject *rv = NULL;
+
+	if ((fp = fopen(py_script->code_cache, "rb")) == NULL)
+		return NULL;
+
+	/* only trust a cache file written by ourselves */
+	if ((fstat(fileno(fp), &sbuf) == -1) || (sbuf.st_uid != geteuid()) ||
+		(sbuf.st_mode & (S_IWGRP | S_IWOTH)) ||
+		(sbuf.st_size <= (off_t)sizeof(hdr)))
+		goto cache_exit;
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto cache_exit;
+	if ((hdr.magic != PyImport_GetMagicNumber()) ||
+		(hdr.ino != py_script->cur_sbuf.st_ino) ||
+		(hdr.size != py_script->cur_sbuf.st_size) ||
+		(hdr.mtime != py_script->cur_sbuf.st_mtime))
+		goto cache_exit;
+
+	len = sbuf.st_size - sizeof(hdr);
+	if ((buf = malloc(len)) == NULL)
+		goto cache_exit;
+	if (fread(buf, 1, len, fp) != len)
+		goto cache_exit;
+
+	rv = PyMarshal_ReadObjectFromString(buf, len);
+	if ((rv != NULL) && !PyCode_Check(rv))
+		Py_CLEAR(rv);
+	if (rv == NULL)
+		PyErr_Clear();
+
+cache_exit:
+	free(buf);
+	fclose(fp);
+	return rv;
+}
+
+/**
+ * @brief
+ *	Write the compiled code of 'py_script' to its code cache file, for
+ *	the next process running the same script.
+ *
+ * @param[in]	py_script - script with a compiled 'py_code_obj'
+ *
+ * @note
+ *	The file is written under a temporary name and renamed into place,
+ *	so a concurrent reader never sees a partial file. Failures are not
+ *	fatal, the script just gets compiled again next time.
+ */
+static void
+_pbs_python_save_code_cache(struct python_script *py_script)
+{
+	char tmp_path[MAXPATHLEN + 1];
+	struct code_cache_hdr hdr;
+	PyObject *py_data;
+	char *data;
+	Py_ssize_t len;
+	FILE *fp;
+	int fd;
+	int ok;
+
+	py_data = PyMarshal_WriteObjectToString((PyObject *)py_script->py_code_obj,
+		Py_MARSHAL_VERSION);
+	if (py_data == NULL) {
+		PyErr_Clear();
+		return;
+	}
+	if (PyBytes_AsStringAndSize(py_data, &data, &len) == -1) {
+		PyErr_Clear();
+		Py_DECREF(py_data);
+		return;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = PyImport_GetMagicNumber();
+	hdr.ino = py_script->cur_sbuf.st_ino;
+	hdr.size = py_script->cur_sbuf.st_size;
+	hdr.mtime = py_script->cur_sbuf.st_mtime;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%d", py_script->code_cache,
+		(int)getpid());
+	fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+	if ((fd == -1) || ((fp = fdopen(fd, "wb")) == NULL)) {
+		if (fd != -1) {
+			close(fd);
+			(void)unlink(tmp_path);
+		}
+		Py_DECREF(py_data);
+		return;
+	}
+	ok = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1) &&
+		(fwrite(data, 1, len, fp) == (size_t)len);
+	if (fclose(fp) != 0)
+		ok = 0;
+	if (!ok || (rename(tmp_path, py_script->code_cache) == -1))
+		(void)unlink(tmp_path);
+	Py_DECREF(py_data);
+}
+#endif /* WIN32 */
+
+
+/**
+ * @brief
+ *	Remember the names of the modules imported since the interpreter
+ *	was started, i.e. the ones brought in by hook scripts, so that
+ *	_pbs_python_warm_hook_modules() can import them into the next
+ *	interpreter.
+ *
+ * @note
+ *	Called just before the interpreter is finalized.
+ */
+static void
+_pbs_python_save_hook_modules(void)
+{
+	PyObject *py_modules;
+	PyObject *py_names = NULL;
+	PyObject *py_new = NULL;
+	PyObject *py_list = NULL;
+	Py_ssize_t i;
+	Py_ssize_t n;
+	const char *name;
+
+	for (i = 0; i < warm_modules_num; i++)
+		free(warm_modules[i]);
+	warm_modules_num = 0;
+
+	if (py_base_modules == NULL)
+		return;
+
+	py_modules = PySys_GetObject("modules"); /* borrowed */
+	if (py_modules == NULL || !PyDict_Check(py_modules))
+		goto done;
+
+	py_names = PySet_New(py_modules); /* the keys of sys.modules */
+	if (py_names == NULL)
+		goto done;
+	py_new = PyNumber_Subtract(py_names, py_base_modules);
+	if (py_new == NULL)
+		goto done;
+	py_list = PySequence_List(py_new);
+	/* sorted, so that a package is imported before its submodules */
+	if (py_list == NULL || PyList_Sort(py_list) == -1)
+		goto done;
+
+	n = PyList_GET_SIZE(py_list);
+	if (n > PBS_PYTHON_WARM_MODULES_MAX)
+		n = PBS_PYTHON_WARM_MODULES_MAX;
+	if (warm_modules == NULL) {
+		warm_modules = malloc(PBS_PYTHON_WARM_MODULES_MAX * sizeof(char *));
+		if (warm_modules == NULL)
+			goto done;
+	}
+	for (i = 0; i < n; i++) {
+		name = PyUnicode_AsUTF8(PyList_GET_ITEM(py_list, i));
+		if (name == NULL || name[0] == '\0' || name[0] == '_')
+			continue;
+		if ((warm_modules[warm_modules_num] = strdup(name)) == NULL)
+			break;
+		warm_modules_num++;
+	}
+
+done:
+	PyErr_Clear();
+	Py_XDECREF(py_list);
+	Py_XDECREF(py_new);
+	Py_XDECREF(py_names);
+	Py_CLEAR(py_base_modules);
+}
+
+/**
+ * @brief
+ *	Note which modules a freshly started interpreter has loaded, then
+ *	import again the modules hooks were using in the previous one.
+ *
+ * @note
+ *	A module that fails to import is skipped, the hook importing it
+ *	will report the error when it runs.
+ */
+static void
+_pbs_python_warm_hook_modules(void)
+{
+	PyObject *py_modules;
+	PyObject *py_mod;
+	int warmed = 0;
+	int i;
+
+	py_modules = PySys_GetObject("modules"); /* borrowed */
+	Py_CLEAR(py_base_modules);
+	if (py_modules != NULL && PyDict_Check(py_modules))
+		py_base_modules = PySet_New(py_modules);
+	if (py_base_modules == NULL) {
+		PyErr_Clear();
+		return;
+	}
+
+	for (i = 0; i < warm_modules_num; i++) {
+		py_mod = PyImport_ImportModule(warm_modules[i]);
+		if (py_mod == NULL) {
+			PyErr_Clear();
+			continue;
+		}
+		Py_DECREF(py_mod);
+		warmed++;
+	}
+	if (warm_modules_num > 0) {
+		snprintf(log_buffer, LOG_BUF_SIZE,
+			"Imported %d of %d modules used by hooks", warmed,
+			warm_modules_num);
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_INFO,
+			__func__, log_buffer);
+	}
+}
 
 #endif /* PYTHON */
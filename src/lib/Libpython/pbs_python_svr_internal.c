@@ -239,6 +239,13 @@ typedef struct _pbs_resource_value {
 static pbs_list_head pbs_resource_value_list;  	/* list of resource */
 						/* values to instantiate */
 
+/*
+ * Encoded values of job and vnode attributes not yet set on their Python
+ * objects, kept as { <object> : { <attribute name> : <value string> } }.
+ * A value is moved onto the object the first time a hook reads it.
+ */
+static PyObject *py_attr_value_cache = NULL;
+
 static PyObject  *PyPbsV1Module_Obj = NULL; /* pbs.v1 module object */
 
 /* an array holding all the vnode attribute descriptors (python pointers) */
@@ -1973,6 +1980,160 @@ py_resource_string_value(pbs_resource_value *resc_val)
  * ---------- ATTRIBUTE CONVERSION HELPER METHODS ------------
  */
 
+/**
+ * @brief
+ *	Save the encoded value of attribute 'name' of 'py_instance' so that it
+ *	gets set on the object only when first accessed.
+ *
+ * @param[in]	py_instance - the job or vnode Python object.
+ * @param[in]	name - attribute name.
+ * @param[in]	value - attribute value string.
+ *
+ * @return int
+ * @retval 0	- value cached.
+ * @retval -1	- failed to cache, value needs to be set right away.
+ */
+static int
+cache_attribute_value(PyObject *py_instance, char *name, char *value)
+{
+	PyObject *py_values;
+	PyObject *py_value;
+	int rc;
+
+	if (py_attr_value_cache == NULL) {
+		py_attr_value_cache = PyDict_New();
+		if (py_attr_value_cache == NULL) {
+			pbs_python_write_error_to_log(__func__);
+			return -1;
+		}
+	}
+
+	py_values = PyDict_GetItem(py_attr_value_cache, py_instance); /* borrowed */
+	if (py_values == NULL) {
+		py_values = PyDict_New();
+		if (py_values == NULL) {
+			pbs_python_write_error_to_log(__func__);
+			return -1;
+		}
+		rc = PyDict_SetItem(py_attr_value_cache, py_instance, py_values);
+		Py_DECREF(py_values);
+		if (rc == -1) {
+			pbs_python_write_error_to_log(__func__);
+			return -1;
+		}
+	}
+
+	py_value = PyUnicode_FromString(value);
+	if (py_value == NULL) {
+		pbs_python_write_error_to_log(__func__);
+		return -1;
+	}
+	rc = PyDict_SetItemString(py_values, name, py_value);
+	Py_DECREF(py_value);
+	if (rc == -1) {
+		pbs_python_write_error_to_log(__func__);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Drop all the attribute values saved by cache_attribute_value().
+ */
+void
+pbs_python_clear_attribute_values(void)
+{
+	Py_CLEAR(py_attr_value_cache);
+}
+
+/**
+ * @brief
+ *	Return the cached value of attribute 'name' of 'py_instance'
+ *	still waiting to be set on the object.
+ *
+ * @param[in]	py_instance - the job or vnode Python object.
+ * @param[in]	name - attribute name.
+ *
+ * @return char *
+ * @retval <value string>	- attribute not yet accessed
+ * @retval NULL			- no cached value
+ */
+static char *
+get_cached_attribute_value(PyObject *py_instance, char *name)
+{
+	PyObject *py_values;
+	PyObject *py_value;
+
+	if (py_attr_value_cache == NULL)
+		return NULL;
+
+	py_values = PyDict_GetItem(py_attr_value_cache, py_instance);
+	if (py_values == NULL)
+		return NULL;
+
+	py_value = PyDict_GetItemString(py_values, name);
+	if (py_value == NULL)
+		return NULL;
+
+	return ((char *)PyUnicode_AsUTF8(py_value));
+}
+
+/**
+ * @brief
+ *	Set the cached value of attribute 'name' on 'py_instance', or just
+ *	drop it if 'discard' is set, e.g. when the attribute is being
+ *	assigned a new value.
+ *
+ * @param[in]	py_instance - the job or vnode Python object.
+ * @param[in]	name - attribute name.
+ * @param[in]	discard - if set, drop the cached value without setting it.
+ *
+ * @return int
+ * @retval 1	- the cached value was set on the object.
+ * @retval 0	- no cached value, or value discarded.
+ * @retval -1	- failed to set the cached value.
+ */
+static int
+load_cached_attribute_value(PyObject *py_instance, char *name, int discard)
+{
+	PyObject *py_values;
+	PyObject *py_value;
+	int hook_set_mode_orig;
+	int rc = 0;
+
+	if (py_attr_value_cache == NULL)
+		return 0;
+
+	py_values = PyDict_GetItem(py_attr_value_cache, py_instance);
+	if (py_values == NULL)
+		return 0;
+
+	py_value = PyDict_GetItemString(py_values, name);
+	if (py_value == NULL)
+		return 0;
+
+	/* unlink it first, as setting the value comes back here */
+	Py_INCREF(py_value);
+	PyDict_DelItemString(py_values, name);
+
+	if (!discard) {
+		hook_set_mode_orig = hook_set_mode;
+		hook_set_mode = C_MODE;
+		rc = PyObject_SetAttrString(py_instance, name, py_value);
+		hook_set_mode = hook_set_mode_orig;
+		if (rc == -1) {
+			pbs_python_write_error_to_log(__func__);
+			LOG_ERROR_ARG2("%s:failed to set attribute <%s>", "", name);
+		} else {
+			rc = 1;
+		}
+	}
+	Py_DECREF(py_value);
+
+	return (rc);
+}
+
 /**
  * @brief
  *
@@ -2022,8 +2183,11 @@ pbs_python_populate_attributes_to_python_class(PyObject *py_instance,
 	char *value_str = NULL;
 	char *new_value_str = NULL;
 	pbs_resource_value *resc_val;
+	int lazy;
 
 	hook_perf_stat_start(perf_label, perf_action, 0);
+	/* job and vnode objects take plain attribute values on first access */
+	lazy = PyObject_HasAttrString(py_instance, PY_ATTRIBUTES_LAZY);
 	for (i = 0; i < attr_def_array_size; i++) {
 		attr_p = attr_data_array + i;
 		attr_def_p = attr_def_array + i;
@@ -2207,9 +2371,15 @@ pbs_python_populate_attributes_to_python_class(PyObject *py_instance,
 					} /* while */
 
 				} else {
-					rc = pbs_python_object_set_attr_string_value(py_instance,
-						attr_def_p->at_name,
-						svrattr_val->al_value);
+					rc = -1;
+					if (lazy)
+						rc = cache_attribute_value(py_instance,
+							attr_def_p->at_name,
+							svrattr_val->al_value);
+					if (rc == -1)
+						rc = pbs_python_object_set_attr_string_value(py_instance,
+							attr_def_p->at_name,
+							svrattr_val->al_value);
 
 					if ((rc != -1) && (hook_debug.data_fp != NULL)) {
 						fprintf(hook_debug.data_fp, "%s.%s=%s\n", (char *)hook_debug.objname,
@@ -2759,6 +2929,29 @@ pbs_python_populate_svrattrl_from_python_class(PyObject *py_instance,
 			continue;
 		}
 
+		/* never accessed in the hook, so pass on the value as it came */
+		if (strcmp(name_str, ATTR_v) != 0) {
+			char *cached_val;
+
+			cached_val = get_cached_attribute_value(py_instance, name_str);
+			if (cached_val != NULL) {
+				if (add_to_svrattrl_list(svrattrl_list, name_str, NULL, cached_val,
+					get_svrattrl_flag(name_str, NULL, cached_val,
+					&svrattrl_list2, 0), name_prefix) == -1) {
+					snprintf(log_buffer, LOG_BUF_SIZE-1, "failed to add_to_svrattrl_list(%s,null,%s)",
+						name_str, cached_val);
+					log_buffer[LOG_BUF_SIZE-1] = '\0';
+					log_err(errno, __func__, log_buffer);
+					goto svrattrl_exit;
+				}
+				if (hook_debug.output_fp != NULL)
+					fprintf(hook_debug.output_fp, "%s.%s=%s\n", objname, name_str, return_external_value(name_str, cached_val));
+				free(name_str_dup);
+				name_str_dup = NULL;
+				continue;
+			}
+		}
+
 		if (!PyObject_HasAttrString(py_instance, name_str)) {
 			if (name_str_dup) {
 				free(name_str_dup);
@@ -3600,6 +3793,8 @@ _pps_helper_get_job(job *pjob_o, const char *jobid, const char *qname, char *per
 		log_err(PBSE_INTERNAL, __func__, log_buffer);
 		return py_job;
 	}
+	/* a hook gets all the attributes of a compacted history job */
+	(void)histjob_expand(pjob);
 	if (qname && (qname[0] != '\0') &&
 		(strcmp(pjob->ji_qs.ji_queue, qname) != 0)) {
 		snprintf(log_buffer, LOG_BUF_SIZE-1, "job '%s' not in '%s'", jobid, qname);
@@ -5195,6 +5390,9 @@ _pbs_python_event_set(unsigned int hook_event, char *req_user, char *req_host,
 		resc_val = nxp_resc_val;
 	}
 
+	/* Drop the attribute values not loaded by the previous hooks */
+	pbs_python_clear_attribute_values();
+
 	/* py_hook_pbsevent is instantiated in C_MODE so I own it */
 	Py_CLEAR(py_hook_pbsevent);
 
@@ -8896,8 +9094,49 @@ getval_exit:
 	return (strval);
 }
 
+/**
+ * @brief
+ *	Return the first job, starting at pjob, that passes the job
+ *	filters of a pbs_iter, so that jobs the hook did not ask for are
+ *	skipped here rather than being turned into Python objects.
+ *	Only the server has jobs to filter, pbs_python returns pjob as is.
+ *
+ * @param[in]	pjob	- job to start from
+ * @param[in]	on_queue - walk the queue's job list if 1, else the server's
+ * @param[in]	states	- job state letters to keep, NULL or "" for all
+ * @param[in]	user	- euser to keep, NULL or "" for all
+ *
+ * @return	job *
+ * @retval	first matching job
+ * @retval	NULL	- no more matching jobs
+ */
+static job *
+iter_next_job(job *pjob, int on_queue, char *states, char *user)
+{
+#ifdef LIBPYTHONSVR
+	int by_state = (states != NULL && states[0] != '\0');
+	int by_user = (user != NULL && user[0] != '\0');
+	char *euser;
+
+	if (!by_state && !by_user)
+		return pjob;
+
+	for (; pjob != NULL; pjob = (job *)GET_NEXT(on_queue ? pjob->ji_jobque : pjob->ji_alljobs)) {
+		if (by_state && strchr(states, get_job_state(pjob)) == NULL)
+			continue;
+		if (by_user) {
+			euser = is_jattr_set(pjob, JOB_ATR_euser) ? get_jattr_str(pjob, JOB_ATR_euser) : NULL;
+			if (euser == NULL || strcmp(user, euser) != 0)
+				continue;
+		}
+		break;
+	}
+#endif
+	return pjob;
+}
+
 const char pbsv1mod_meth_iter_nextfunc_doc[] =
-"iter_nextfunc(meth_mode, obj_name, filter1, filter2)\n\
+"iter_nextfunc(meth_mode, obj_name, filter1, filter2[, filter_state, filter_user])\n\
 \n\
    meth_mode:	can be 1 if called from __init__() or 0 if from next()\n\
 		method of a pbs_iter type.\n\
@@ -8910,6 +9149,9 @@ const char pbsv1mod_meth_iter_nextfunc_doc[] =
 		being referenced. For example, this can be set to\n\
 		some <queue_name>, to have the iterator represents\n\
 		a list of jobs on <queue_name>@<server_name>\n\
+   filter_state: for \"jobs\", the job state letters (e.g. \"QR\") of the\n\
+		jobs to return; other jobs are skipped.\n\
+   filter_user: for \"jobs\", only return jobs with this euser.\n\
 \n\
    Returns the next PBS object in Python form to evaluate within a looping\n\
    construct. The idea is on a iterator instantiation, the following gets\n\
@@ -8933,7 +9175,7 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 	static char *kwlist[] = {"iter_obj", "meth_mode", "obj_name", "filter1", "filter2", "ignore_fin", "filter_user",
 		NULL};
 #else
-	static char *kwlist[] = {"iter_obj", "meth_mode", "obj_name", "filter1", "filter2",
+	static char *kwlist[] = {"iter_obj", "meth_mode", "obj_name", "filter1", "filter2", "filter_state", "filter_user",
 		NULL};
 #endif /* localmod 014 */
 	int  meth_mode;
@@ -8942,8 +9184,9 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 	char *filter2 = NULL;
 #ifdef NAS /* localmod 014 */
 	int  ignore_fin;
-	char *filter_user = NULL;
 #endif /* localmod 014 */
+	char *filter_state = NULL;
+	char *filter_user = NULL;
 	pbs_iter_item	*iter_entry = NULL;
 	pbs_queue	*pque = NULL;
 	PyObject	*py_object = NULL;
@@ -8964,13 +9207,15 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 		)) {
 #else
 	if (!PyArg_ParseTupleAndKeywords(args, kwds,
-		"Oisss:iter_nextfunc",
+		"Oisss|zz:iter_nextfunc",
 		kwlist,
 		&py_self,
 		&meth_mode,
 		&obj_name,
 		&filter1,
-		&filter2
+		&filter2,
+		&filter_state,
+		&filter_user
 		)) {
 #endif /* localmod 014 */
 		return NULL;
@@ -9039,7 +9284,8 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 							log_buffer);
 						return NULL;
 					}
-					iter_entry->data = (job *)GET_NEXT(pque->qu_jobs);
+					iter_entry->data = iter_next_job((job *)GET_NEXT(pque->qu_jobs), 1,
+						filter_state, filter_user);
 
 				} else { /* get jobs from server */
 					iter_entry->data = (job *)GET_NEXT(svr_alljobs);
@@ -9055,6 +9301,9 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 					}
 
 					iter_entry->data = njob;
+#else
+					iter_entry->data = iter_next_job((job *)iter_entry->data, 0,
+						filter_state, filter_user);
 #endif /* localmod 014 */
 				}
 			} else if (strcmp(obj_name, ITER_RESERVATIONS) == 0) {
@@ -9138,8 +9387,9 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 					/* of 1 above. So we need to return */
 					/* the jobs on the same queue       */
 					/* (i.e. use ji_jobque here)        */
-					iter_entry->data = (job *)GET_NEXT(\
-					((job *)iter_entry->data)->ji_jobque);
+					iter_entry->data = iter_next_job((job *)GET_NEXT(\
+					((job *)iter_entry->data)->ji_jobque), 1,
+						filter_state, filter_user);
 				} else {
 					iter_entry->data = (job *)GET_NEXT(\
 					((job *)iter_entry->data)->ji_alljobs);
@@ -9154,6 +9404,9 @@ pbsv1mod_meth_iter_nextfunc(PyObject *self, PyObject *args, PyObject *kwds)
 					}
 
 					iter_entry->data = njob;
+#else
+					iter_entry->data = iter_next_job((job *)iter_entry->data, 0,
+						filter_state, filter_user);
 #endif /* localmod 014 */
 				}
 			} else if (strcmp(obj_name, ITER_VNODES) == 0) {
@@ -9283,7 +9536,7 @@ pbsv1mod_meth_mark_vnode_set(PyObject *self, PyObject *args, PyObject *kwds)
 		/* to "extend" the svratrl entry!                */
 
 		delete_link(&plist->al_link);
-		free(plist);
+		attrlist_free(plist);
 
 	}
 
@@ -12123,6 +12376,62 @@ pbsv1mod_meth_load_resource_value(PyObject *self, PyObject *args, PyObject *kwds
 	Py_RETURN_NONE;
 }
 
+const char pbsv1mod_meth_load_attribute_value_doc[] =
+"load_attribute_value(object, name, discard=0)\n\
+\n\
+   object:  job or vnode object whose attribute value is to be set\n\
+   name:    attribute name\n\
+   discard: if set, drop the cached value instead of setting it\n\
+\n\
+   Load the attribute value internally cached for 'object'.\n\
+   Returns True if a value got set.\n\
+";
+
+/**
+ * @brief
+ *	This is callable in a Python script, for setting attribute 'name' of
+ *	a job or vnode object with the value cached in 'py_attr_value_cache'.
+ *
+ * @param[in]	args[1]	- the job or vnode Python object.
+ * @param[in]	args[2]	- the attribute name.
+ * @param[in]	args[3]	- if non-zero, only discard the cached value.
+ *
+ * @return	PyObject *
+ * @retval	Py_True - value was found and set.
+ * @retval	Py_False - no cached value.
+ * @retval	NULL	- with an accompanying AssertionError Python exception.
+ *
+ */
+PyObject *
+pbsv1mod_meth_load_attribute_value(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"object", "name", "discard", NULL};
+	PyObject *py_object = NULL;
+	char *name = NULL;
+	int discard = 0;
+	int rc;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds,
+		"Os|i:load_attribute_value",
+		kwlist,
+		&py_object,
+		&name,
+		&discard)) {
+		return NULL;
+	}
+
+	rc = load_cached_attribute_value(py_object, name, discard);
+	if (rc == -1) {
+		PyErr_SetString(PyExc_AssertionError,
+				"Failed to load cached value for attribute");
+		return NULL;
+	}
+
+	if (rc == 1)
+		Py_RETURN_TRUE;
+	Py_RETURN_FALSE;
+}
+
 const char pbsv1mod_meth_resource_str_value_doc[] =
 "str_resource_value(resc_object)\n\
 \n\
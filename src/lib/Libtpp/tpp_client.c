@@ -1158,12 +1158,22 @@ tpp_send(int sd, void *data, int len)
 			tpp_log_func(LOG_CRIT, __func__, "tpp deflate failed");
 			return -1;
 		}
-		pkt = tpp_cr_pkt(outbuf, cmprsd_len, 0);
-		if (pkt == NULL) {
+		/*
+		 * receivers tell compressed data by cmprsd_len != len,
+		 * so send data that did not shrink uncompressed
+		 */
+		if (cmprsd_len >= (unsigned int) len) {
 			free(outbuf);
-			return -1;
+		} else {
+			pkt = tpp_cr_pkt(outbuf, cmprsd_len, 0);
+			if (pkt == NULL) {
+				free(outbuf);
+				return -1;
+			}
 		}
+	}
 
+	if (pkt) {
 		p = pkt->data;
 		to_send = cmprsd_len;
 	} else {
@@ -3828,7 +3838,9 @@ free_stream(unsigned int sd)
  *	a prior registered "pre-send" handler. This pre-send handler (for leaves)
  *	piggy-backs any pending acks to this data packet. This function is also
  *	used to do the flow control (throttling) - by checking number of unacked
- *	packets against the setting "rpp_highwater"
+ *	packets against the setting "rpp_highwater". On an encrypted connection
+ *	the packet's data is replaced by the encrypted data, and the cleartext
+ *	kept in the packet for the post-send handler.
  *
  * @param[in] tfd - The actual IO connection on which data was about to be
  *			sent (unused)
@@ -3947,17 +3959,6 @@ leaf_pkt_presend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		char *pktdata = NULL;
 		size_t npktlen = 0;
 
-		if (authdata->cleartext != NULL)
-			free(authdata->cleartext);
-
-		authdata->cleartext = malloc(pkt->len);
-		if (authdata->cleartext == NULL) {
-			tpp_log_func(LOG_CRIT, __func__, "malloc failure");
-			return -1;
-		}
-		memcpy(authdata->cleartext, pkt->data, pkt->len);
-		authdata->cleartext_len = pkt->len;
-
 		if (authdata->encryptdef->encrypt_data(authdata->encryptctx, (void *)pkt->data, (size_t)pkt->len, &data_out, &len_out) != 0) {
 			return -1;
 		}
@@ -3973,7 +3974,10 @@ leaf_pkt_presend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 		newpktlen = len_out + sizeof(int) + 1;
 		pktdata = malloc(newpktlen);
 		if (pktdata != NULL) {
-			free(pkt->data);
+			/* the cleartext stays with the packet for the postsend handler */
+			free(pkt->cleartext);
+			pkt->cleartext = pkt->data;
+			pkt->cleartext_len = pkt->len;
 			pkt->data = pktdata;
 		} else {
 			free(data_out);
@@ -4032,20 +4036,18 @@ leaf_pkt_postsend_handler(int tfd, tpp_packet_t *pkt, void *extra)
 	stream_t *strm;
 
 	if (type == TPP_ENCRYPTED_DATA) {
-		conn_auth_t *authdata = (conn_auth_t *)extra;
-
-		if (authdata->cleartext == NULL) {
-			tpp_log_func(LOG_CRIT, __func__, "postsend called with encrypted data but no saved cleartext data in tls");
+		if (pkt->cleartext == NULL) {
+			tpp_log_func(LOG_CRIT, __func__, "postsend called with encrypted data but no saved cleartext data in packet");
 			return -1;
 		}
 
 		free(pkt->data);
-		pkt->data = authdata->cleartext;
-		pkt->len = authdata->cleartext_len;
+		pkt->data = pkt->cleartext;
+		pkt->len = pkt->cleartext_len;
 		pkt->pos = pkt->data;
 
-		authdata->cleartext = NULL;
-		authdata->cleartext_len = 0;
+		pkt->cleartext = NULL;
+		pkt->cleartext_len = 0;
 
 		/* re-calculate data, len and type as pkt changed */
 		data = (tpp_data_pkt_hdr_t *)(pkt->data + sizeof(int));
@@ -4772,8 +4774,6 @@ leaf_close_handler(int tfd, int error, void *c, void *extra)
 			authdata->authdef->destroy_ctx(authdata->authctx);
 		if (authdata->authdef != authdata->encryptdef && authdata->encryptctx && authdata->encryptdef)
 			authdata->encryptdef->destroy_ctx(authdata->encryptctx);
-		if (authdata->cleartext)
-			free(authdata->cleartext);
 		if (authdata->config)
 			free_auth_config(authdata->config);
 		/* DO NOT free authdef here, it will be done in unload_auths() */
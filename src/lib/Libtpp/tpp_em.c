@@ -75,6 +75,10 @@
 #ifdef HAVE_SYS_EVENTFD_H
 #include <sys/eventfd.h>
 #endif
+#ifdef PBS_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
 
 /********************************** START OF MULTIPLEXING CODE *****************************************/
 /**
@@ -110,9 +114,459 @@ tpp_em_wait(void *em_ctx, em_event_t **ev_array, int timeout)
 /****************************************** Linux EPOLL ************************************************/
 
 #if defined(PBS_USE_EPOLL)
+
+#ifdef PBS_HAVE_IO_URING
+/*
+ * io_uring backend. Monitoring is done with one-shot poll requests that are
+ * queued again for the reported fds at the start of the next wait, which
+ * keeps the level triggered behaviour callers expect from epoll, while all
+ * the requests queued since the previous wait are handed to the kernel
+ * together with the wait itself in a single io_uring_enter call.
+ */
+#define URING_SQ_ENTRIES	256
+#define URING_UD(fd, gen)	(((uint64_t) (gen) << 32) | (unsigned int) (fd))
+#define URING_UD_FD(ud)		((int) ((ud) & 0xffffffff))
+#define URING_UD_GEN(ud)	((unsigned int) ((ud) >> 32))
+
+static int
+uring_enter(uring_context_t *u, unsigned int to_submit, unsigned int min_complete,
+	    unsigned int flags, void *arg, size_t argsz)
+{
+	return (int) syscall(__NR_io_uring_enter, u->ring_fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/**
+ * @brief
+ *	Hand the requests queued so far to the kernel without waiting
+ *
+ * @param[in] u - The io_uring context
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+uring_submit(uring_context_t *u)
+{
+	int rc;
+
+	while (u->to_submit > 0) {
+		rc = uring_enter(u, u->to_submit, 0, 0, NULL, 0);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		u->to_submit -= rc;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Queue a poll or poll removal request for a fd
+ *
+ * @param[in] u - The io_uring context
+ * @param[in] opcode - IORING_OP_POLL_ADD or IORING_OP_POLL_REMOVE
+ * @param[in] ud - The fd and generation of the poll request
+ * @param[in] mask - The events to poll for (IORING_OP_POLL_ADD only)
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+uring_queue(uring_context_t *u, int opcode, uint64_t ud, int mask)
+{
+	unsigned int tail;
+	struct io_uring_sqe *sqe;
+
+	tail = *u->sq_tail;
+	if (tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) >= u->sq_entries) {
+		/* ring is full, hand what is queued to the kernel first */
+		if (uring_submit(u) == -1)
+			return -1;
+	}
+
+	sqe = &u->sqes[tail & *u->sq_mask];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode = opcode;
+	if (opcode == IORING_OP_POLL_ADD) {
+		sqe->fd = URING_UD_FD(ud);
+#if __BYTE_ORDER == __BIG_ENDIAN
+		sqe->poll32_events = ((unsigned int) mask << 16) | ((unsigned int) mask >> 16);
+#else
+		sqe->poll32_events = mask;
+#endif
+		sqe->user_data = ud;
+	} else {
+		/* completions of removals carry no fd and are ignored */
+		sqe->fd = -1;
+		sqe->addr = ud;
+		sqe->user_data = 0;
+	}
+
+	__atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	u->to_submit++;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Destroy an io_uring context, cancelling all its poll requests
+ *
+ * @param[in] u - The io_uring context
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+uring_destroy(uring_context_t *u)
+{
+	if (u->sqes)
+		munmap(u->sqes, u->sqes_sz);
+	if (u->cq_ring && u->cq_ring != u->sq_ring)
+		munmap(u->cq_ring, u->cq_ring_sz);
+	if (u->sq_ring)
+		munmap(u->sq_ring, u->sq_ring_sz);
+	if (u->ring_fd > -1)
+		close(u->ring_fd);
+	free(u->fds);
+	free(u->rearm);
+	free(u);
+}
+
+/**
+ * @brief
+ *	Create an io_uring context
+ *
+ * @param[in] max_events - max events returned by a single wait
+ *
+ * @return	io_uring context
+ * @retval  NULL Failure, or the kernel lacks the needed features
+ * @retval !NULL Success
+ *
+ * @par MT-safe: yes
+ *
+ */
+static uring_context_t *
+uring_init(int max_events)
+{
+	struct io_uring_params p;
+	uring_context_t *u;
+	void *ptr;
+	unsigned int i;
+	unsigned int *sq_array;
+
+	if ((u = calloc(1, sizeof(uring_context_t))) == NULL)
+		return NULL;
+	u->ring_fd = -1;
+	if ((u->rearm = malloc(sizeof(uint64_t) * max_events)) == NULL)
+		goto err;
+
+	memset(&p, 0, sizeof(p));
+	p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+	p.cq_entries = 2 * ((max_events > URING_SQ_ENTRIES) ? max_events : URING_SQ_ENTRIES);
+	if ((u->ring_fd = (int) syscall(__NR_io_uring_setup, URING_SQ_ENTRIES, &p)) == -1)
+		goto err;
+	tpp_set_close_on_exec(u->ring_fd);
+
+	/*
+	 * removed requests must not leave a completion to be lost, and the
+	 * wait needs a timeout, which older kernels cannot take
+	 */
+	if (!(p.features & IORING_FEAT_NODROP) || !(p.features & IORING_FEAT_EXT_ARG)) {
+		errno = ENOTSUP;
+		goto err;
+	}
+
+	u->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	u->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (u->cq_ring_sz > u->sq_ring_sz)
+			u->sq_ring_sz = u->cq_ring_sz;
+		u->cq_ring_sz = u->sq_ring_sz;
+	}
+
+	ptr = mmap(NULL, u->sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQ_RING);
+	if (ptr == MAP_FAILED)
+		goto err;
+	u->sq_ring = ptr;
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		u->cq_ring = u->sq_ring;
+	else {
+		ptr = mmap(NULL, u->cq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_CQ_RING);
+		if (ptr == MAP_FAILED)
+			goto err;
+		u->cq_ring = ptr;
+	}
+
+	u->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	ptr = mmap(NULL, u->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQES);
+	if (ptr == MAP_FAILED)
+		goto err;
+	u->sqes = ptr;
+
+	u->sq_head = (unsigned int *) ((char *) u->sq_ring + p.sq_off.head);
+	u->sq_tail = (unsigned int *) ((char *) u->sq_ring + p.sq_off.tail);
+	u->sq_mask = (unsigned int *) ((char *) u->sq_ring + p.sq_off.ring_mask);
+	u->cq_head = (unsigned int *) ((char *) u->cq_ring + p.cq_off.head);
+	u->cq_tail = (unsigned int *) ((char *) u->cq_ring + p.cq_off.tail);
+	u->cq_mask = (unsigned int *) ((char *) u->cq_ring + p.cq_off.ring_mask);
+	u->cqes = (struct io_uring_cqe *) ((char *) u->cq_ring + p.cq_off.cqes);
+	u->sq_entries = p.sq_entries;
+
+	/* sqes are always used in ring order, so the index array is fixed */
+	sq_array = (unsigned int *) ((char *) u->sq_ring + p.sq_off.array);
+	for (i = 0; i < p.sq_entries; i++)
+		sq_array[i] = i;
+
+	return u;
+
+err:
+	uring_destroy(u);
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Find the io_uring state of a fd, growing the fd table as needed
+ *
+ * @param[in] u - The io_uring context
+ * @param[in] fd - The file descriptor
+ * @param[in] grow - whether to grow the table if fd is beyond it
+ *
+ * @return	state of the fd
+ * @retval  NULL fd not in table (errno set)
+ * @retval !NULL Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static uring_fd_t *
+uring_get_fd(uring_context_t *u, int fd, int grow)
+{
+	uring_fd_t *tmp;
+	int sz;
+
+	if (fd < 0) {
+		errno = EBADF;
+		return NULL;
+	}
+	if (fd >= u->fds_sz) {
+		if (!grow) {
+			errno = ENOENT;
+			return NULL;
+		}
+		sz = (u->fds_sz > 0) ? u->fds_sz : 64;
+		while (sz <= fd)
+			sz *= 2;
+		if ((tmp = realloc(u->fds, sizeof(uring_fd_t) * sz)) == NULL)
+			return NULL;
+		memset(tmp + u->fds_sz, 0, sizeof(uring_fd_t) * (sz - u->fds_sz));
+		u->fds = tmp;
+		u->fds_sz = sz;
+	}
+	return &u->fds[fd];
+}
+
+/**
+ * @brief
+ *	Start polling a fd for its current mask under a new generation,
+ *	removing its outstanding poll request if any
+ *
+ * @param[in] u - The io_uring context
+ * @param[in] fd - The file descriptor
+ * @param[in] e - The io_uring state of the fd
+ *
+ * @return	Error code
+ * @retval -1	Failure
+ * @retval  0	Success
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+uring_arm(uring_context_t *u, int fd, uring_fd_t *e)
+{
+	if (e->armed) {
+		if (uring_queue(u, IORING_OP_POLL_REMOVE, URING_UD(fd, e->gen), 0) == -1)
+			return -1;
+		e->armed = 0;
+	}
+	if (++u->gen == 0)
+		u->gen = 1;
+	e->gen = u->gen;
+	if (uring_queue(u, IORING_OP_POLL_ADD, URING_UD(fd, e->gen), e->mask) == -1)
+		return -1;
+	e->armed = 1;
+	return 0;
+}
+
+static int
+uring_add_fd(uring_context_t *u, int fd, int event_mask)
+{
+	uring_fd_t *e;
+
+	if ((e = uring_get_fd(u, fd, 1)) == NULL)
+		return -1;
+	if (e->gen != 0) {
+		errno = EEXIST;
+		return -1;
+	}
+	e->mask = event_mask;
+	return uring_arm(u, fd, e);
+}
+
+static int
+uring_mod_fd(uring_context_t *u, int fd, int event_mask)
+{
+	uring_fd_t *e;
+
+	if ((e = uring_get_fd(u, fd, 0)) == NULL)
+		return -1;
+	if (e->gen == 0) {
+		errno = ENOENT;
+		return -1;
+	}
+	e->mask = event_mask;
+	return uring_arm(u, fd, e);
+}
+
+static int
+uring_del_fd(uring_context_t *u, int fd)
+{
+	uring_fd_t *e;
+
+	if ((e = uring_get_fd(u, fd, 0)) == NULL)
+		return -1;
+	if (e->gen == 0) {
+		errno = ENOENT;
+		return -1;
+	}
+	if (e->armed) {
+		if (uring_queue(u, IORING_OP_POLL_REMOVE, URING_UD(fd, e->gen), 0) == -1)
+			return -1;
+	}
+	e->gen = 0;
+	e->armed = 0;
+
+	/*
+	 * a poll request holds a reference to the file, so the removal is
+	 * handed to the kernel right away, as the caller is about to close
+	 * the fd and expects the socket to go away with it
+	 */
+	if (u->to_submit > 0)
+		return uring_submit(u);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Wait for events on an io_uring context
+ *
+ * @param[in] u - The io_uring context
+ * @param[out] events - Array to return the events in
+ * @param[in] max_events - size of events
+ * @param[in] timeout - The timeout in milliseconds to wait for
+ * @param[in] sigmask - The signal mask to atomically unblock before sleeping
+ *
+ * @return	Number of events returned
+ * @retval -1	Failure
+ * @retval  0	Timeout
+ * @retval >0   Success (some events occured)
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+uring_pwait(uring_context_t *u, em_event_t *events, int max_events, int timeout, const sigset_t *sigmask)
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	struct io_uring_cqe *cqe;
+	uring_fd_t *e;
+	unsigned int head;
+	unsigned int tail;
+	uint64_t ud;
+	int fd;
+	int i;
+	int n;
+	int rc;
+
+	/* poll again the fds reported by the last wait, unless changed since */
+	for (i = 0; i < u->nrearm; i++) {
+		fd = URING_UD_FD(u->rearm[i]);
+		e = &u->fds[fd];
+		if (e->gen == URING_UD_GEN(u->rearm[i]) && !e->armed) {
+			if (uring_queue(u, IORING_OP_POLL_ADD, u->rearm[i], e->mask) == -1)
+				return -1;
+			e->armed = 1;
+		}
+	}
+	u->nrearm = 0;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.sigmask = (uint64_t) (uintptr_t) sigmask;
+	arg.sigmask_sz = _NSIG / 8;
+	if (timeout >= 0) {
+		ts.tv_sec = timeout / 1000;
+		ts.tv_nsec = (timeout % 1000) * 1000000L;
+		arg.ts = (uint64_t) (uintptr_t) &ts;
+	}
+
+	do {
+		rc = uring_enter(u, u->to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+		if (rc >= 0)
+			u->to_submit -= rc;
+		else if (errno != ETIME)
+			return -1;
+
+		n = 0;
+		head = *u->cq_head;
+		tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail && n < max_events) {
+			cqe = &u->cqes[head & *u->cq_mask];
+			ud = cqe->user_data;
+			head++;
+
+			/* skip removals, and requests since modified or removed */
+			if (ud == 0)
+				continue;
+			fd = URING_UD_FD(ud);
+			if (fd >= u->fds_sz || u->fds[fd].gen != URING_UD_GEN(ud))
+				continue;
+
+			u->fds[fd].armed = 0;
+			events[n].data.fd = fd;
+			if (cqe->res < 0)
+				events[n].events = EPOLLERR;
+			else
+				events[n].events = cqe->res & (u->fds[fd].mask | EPOLLERR | EPOLLHUP);
+			u->rearm[u->nrearm++] = ud;
+			n++;
+		}
+		__atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+
+		/* only stale completions came in, keep waiting if told to wait forever */
+	} while (n == 0 && rc >= 0 && timeout < 0);
+
+	return n;
+}
+#endif /* PBS_HAVE_IO_URING */
+
 /**
  * @brief
  *	Initialize event monitoring
+ *	Uses io_uring instead of epoll if PBS_USE_IO_URING is set in pbs.conf,
+ *	falling back to epoll if the kernel cannot provide it.
  *
  * @param[in] - max_events - max events that needs to be handled
  *
@@ -139,6 +593,22 @@ tpp_em_init(int max_events)
 		return NULL;
 	}
 
+#ifdef PBS_HAVE_IO_URING
+	ctx->uring = NULL;
+	if (pbs_conf.pbs_use_io_uring) {
+		if ((ctx->uring = uring_init(max_events)) != NULL) {
+			ctx->epoll_fd = -1;
+			ctx->max_nfds = max_events;
+			ctx->init_pid = getpid();
+			return ((void *) ctx);
+		}
+		if (tpp_log_func) {
+			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "io_uring not available, errno=%d, using epoll", errno);
+			tpp_log_func(LOG_WARNING, __func__, tpp_get_logbuf());
+		}
+	}
+#endif
+
 #if defined(EPOLL_CLOEXEC)
 	ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
 #else
@@ -174,6 +644,11 @@ void
 tpp_em_destroy(void *em_ctx)
 {
 	epoll_context_t *ctx = (epoll_context_t *) em_ctx;
+#ifdef PBS_HAVE_IO_URING
+	if (ctx->uring)
+		uring_destroy(ctx->uring);
+	else
+#endif
 	close(ctx->epoll_fd);
 	free(ctx->events);
 	free(ctx);
@@ -212,6 +687,11 @@ tpp_em_add_fd(void *em_ctx, int fd, int event_mask)
 	if (ctx->init_pid != getpid())
 		return 0;
 
+#ifdef PBS_HAVE_IO_URING
+	if (ctx->uring)
+		return uring_add_fd(ctx->uring, fd, event_mask);
+#endif
+
 	memset(&ev, 0, sizeof(ev));
 	ev.events = event_mask;
 	ev.data.fd = fd;
@@ -255,6 +735,11 @@ tpp_em_mod_fd(void *em_ctx, int fd, int event_mask)
 	if (ctx->init_pid != getpid())
 		return 0;
 
+#ifdef PBS_HAVE_IO_URING
+	if (ctx->uring)
+		return uring_mod_fd(ctx->uring, fd, event_mask);
+#endif
+
 	memset(&ev, 0, sizeof(ev));
 	ev.events = event_mask;
 	ev.data.fd = fd;
@@ -297,6 +782,11 @@ tpp_em_del_fd(void *em_ctx, int fd)
 	if (ctx->init_pid != getpid())
 		return 0;
 
+#ifdef PBS_HAVE_IO_URING
+	if (ctx->uring)
+		return uring_del_fd(ctx->uring, fd);
+#endif
+
 	memset(&ev, 0, sizeof(ev));
 	ev.data.fd = fd;
 	if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_DEL, fd, &ev) < 0)
@@ -332,6 +822,10 @@ tpp_em_pwait(void *em_ctx, em_event_t **ev_array, int timeout, const sigset_t *s
 {
         epoll_context_t *ctx = (epoll_context_t *) em_ctx;
         *ev_array = ctx->events;
+#ifdef PBS_HAVE_IO_URING
+        if (ctx->uring)
+                return (uring_pwait(ctx->uring, ctx->events, ctx->max_nfds, timeout, sigmask));
+#endif
         return (epoll_pwait(ctx->epoll_fd, ctx->events, ctx->max_nfds, timeout, sigmask));
 }
 #else
@@ -342,6 +836,10 @@ tpp_em_pwait(void *em_ctx, em_event_t **ev_array, int timeout, const sigset_t *s
 	*ev_array = ctx->events;
 	sigset_t origmask;
 	int n;
+#ifdef PBS_HAVE_IO_URING
+	if (ctx->uring)
+		return (uring_pwait(ctx->uring, ctx->events, ctx->max_nfds, timeout, sigmask));
+#endif
 	sigprocmask(SIG_SETMASK, sigmask, &origmask);
 	n = epoll_wait(ctx->epoll_fd, ctx->events, ctx->max_nfds, timeout);
 	sigprocmask(SIG_SETMASK, &origmask, NULL);
@@ -927,6 +1425,7 @@ tpp_mbox_init(tpp_mbox_t *mbox)
 {
 	tpp_init_lock(&mbox->mbox_mutex);
 	TPP_QUE_CLEAR(&mbox->mbox_queue);
+	TPP_QUE_CLEAR(&mbox->mbox_local);
 
 #ifdef HAVE_SYS_EVENTFD_H
 	if ((mbox->mbox_eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
@@ -1083,21 +1582,32 @@ tpp_mbox_read(tpp_mbox_t *mbox, unsigned int *tfd, int *cmdval, void **data)
 	*cmdval = -1;
 	errno = 0;
 
-	tpp_lock(&mbox->mbox_mutex);
-
-	/* read the data from the mbox cmd queue head */
-	cmd = (tpp_cmd_t *) tpp_deque(&mbox->mbox_queue);
+	/* commands already taken out of the shared queue need no lock */
+	cmd = (tpp_cmd_t *) tpp_deque(&mbox->mbox_local);
 
-	/* if no more data, clear all notifications */
 	if (cmd == NULL) {
+		tpp_lock(&mbox->mbox_mutex);
+
+		/* take everything posted so far in one go */
+		mbox->mbox_local = mbox->mbox_queue;
+		TPP_QUE_CLEAR(&mbox->mbox_queue);
+		cmd = (tpp_cmd_t *) tpp_deque(&mbox->mbox_local);
+
+		/*
+		 * if no more data, clear all notifications; this is done
+		 * under the lock, so a post that finds the queue empty after
+		 * this will signal again
+		 */
+		if (cmd == NULL) {
 #ifdef HAVE_SYS_EVENTFD_H
-		read(mbox->mbox_eventfd, &u, sizeof(uint64_t));
+			read(mbox->mbox_eventfd, &u, sizeof(uint64_t));
 #else
-		while (tpp_pipe_read(mbox->mbox_pipe[0], &b, sizeof(char)) == sizeof(char));
+			while (tpp_pipe_read(mbox->mbox_pipe[0], &b, sizeof(char)) == sizeof(char));
 #endif
-	}
+		}
 
-	tpp_unlock(&mbox->mbox_mutex);
+		tpp_unlock(&mbox->mbox_mutex);
+	}
 
 	if (cmd == NULL) {
 		errno = EWOULDBLOCK;
@@ -1118,7 +1628,9 @@ tpp_mbox_read(tpp_mbox_t *mbox, unsigned int *tfd, int *cmdval, void **data)
  *	from this mbox
  *	Called usually when the connection got closed and
  *	the caller wants to clear the pending commands for
- *	that connection from this thread mbox
+ *	that connection from this thread mbox.
+ *	Must be called by the thread owning the mbox, since it also
+ *	searches the commands that thread already took off the queue.
  *
  * @param[in] - mbox   - The mbox to read from
  * @param[in] - n      - The node/position to start searching from
@@ -1139,12 +1651,26 @@ tpp_mbox_clear(tpp_mbox_t *mbox, tpp_que_elem_t **n, unsigned int tfd, int *cmdv
 	int ret = -1;
 	errno = 0;
 
+	/*
+	 * pull everything posted so far into the local queue, so there
+	 * is a single queue to search and *n stays valid across calls
+	 */
 	tpp_lock(&mbox->mbox_mutex);
+	if (TPP_QUE_HEAD(&mbox->mbox_queue)) {
+		if (TPP_QUE_TAIL(&mbox->mbox_local)) {
+			mbox->mbox_local.tail->next = mbox->mbox_queue.head;
+			mbox->mbox_queue.head->prev = mbox->mbox_local.tail;
+			mbox->mbox_local.tail = mbox->mbox_queue.tail;
+		} else
+			mbox->mbox_local = mbox->mbox_queue;
+		TPP_QUE_CLEAR(&mbox->mbox_queue);
+	}
+	tpp_unlock(&mbox->mbox_mutex);
 
-	while ((*n = TPP_QUE_NEXT(&mbox->mbox_queue, *n))) {
+	while ((*n = TPP_QUE_NEXT(&mbox->mbox_local, *n))) {
 		cmd = TPP_QUE_DATA(*n);
 		if (cmd && cmd->tfd == tfd) {
-			*n = tpp_que_del_elem(&mbox->mbox_queue, *n);
+			*n = tpp_que_del_elem(&mbox->mbox_local, *n);
 			*cmdval = cmd->cmdval;
 			*data = cmd->data;
 			free(cmd);
@@ -1153,8 +1679,6 @@ tpp_mbox_clear(tpp_mbox_t *mbox, tpp_que_elem_t **n, unsigned int tfd, int *cmdv
 		}
 	}
 
-	tpp_unlock(&mbox->mbox_mutex);
-
 	return ret;
 }
 
@@ -1182,6 +1706,7 @@ tpp_mbox_post(tpp_mbox_t *mbox, unsigned int tfd, int cmdval, void *data)
 {
 	tpp_cmd_t *cmd;
 	ssize_t s;
+	int was_empty;
 #ifdef HAVE_SYS_EVENTFD_H
 	uint64_t u;
 #else
@@ -1201,14 +1726,23 @@ tpp_mbox_post(tpp_mbox_t *mbox, unsigned int tfd, int cmdval, void *data)
 
 	/* add the cmd to the threads queue */
 	tpp_lock(&mbox->mbox_mutex);
+	was_empty = (TPP_QUE_HEAD(&mbox->mbox_queue) == NULL);
 	if (tpp_enque(&mbox->mbox_queue, cmd) == NULL) {
 		tpp_unlock(&mbox->mbox_mutex);
+		free(cmd);
 		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory in em_mbox_post");
 		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
 		return -1;
 	}
 	tpp_unlock(&mbox->mbox_mutex);
 
+	/*
+	 * the reader is already signalled if the queue had commands,
+	 * since it clears the signal only once it finds the queue empty
+	 */
+	if (!was_empty)
+		return 0;
+
 	while (1) {
 		/* send a notification to the thread */
 #ifdef HAVE_SYS_EVENTFD_H
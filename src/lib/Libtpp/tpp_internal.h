@@ -48,6 +48,13 @@ extern "C" {
 #include <time.h>
 #include <pthread.h>
 #include <sys/socket.h>
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+#ifdef PBS_HAVE_IO_URING
+#include <stdint.h>
+#include <linux/io_uring.h>
+#endif
 #include <netinet/in.h>
 #include "log.h"
 
@@ -67,6 +74,7 @@ extern "C" {
 #define tpp_sock_connect(a, b, c)      connect(a, b, c)
 #define tpp_sock_recv(a, b, c, d)       recv(a, b, c, d)
 #define tpp_sock_send(a, b, c, d)       send(a, b, c, d)
+#define tpp_sock_sendv(a, b, c)        writev(a, b, c)
 #define tpp_sock_select(a, b, c, d, e)   select(a, b, c, d, e)
 #define tpp_sock_close(a)            close(a)
 #define tpp_sock_getsockopt(a, b, c, d, e)   getsockopt(a, b, c, d, e)
@@ -89,6 +97,11 @@ int tpp_sock_bind(int, const struct sockaddr *, int);
 int tpp_sock_connect(int, const struct sockaddr *, int);
 int tpp_sock_recv(int, char *, int, int);
 int tpp_sock_send(int, const char *, int, int);
+struct iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+int tpp_sock_sendv(int, const struct iovec *, int);
 int tpp_sock_select(int, fd_set *, fd_set *, fd_set *, const struct timeval *);
 int tpp_sock_close(int);
 int tpp_sock_getsockopt(int, int, int, int *, int *);
@@ -145,6 +158,9 @@ typedef struct {
 	char *pos;	/* current position - till which data is consumed */
 	void *extra_data;	/* any additional data */
 	int ref_count;	/* number of accessors */
+	int presend_done;	/* presend handler already ran on this packet */
+	char *cleartext;	/* data before encryption, kept until the packet is sent */
+	int cleartext_len;	/* length of cleartext */
 } tpp_packet_t;
 
 /*
@@ -301,6 +317,7 @@ enum TPP_MSG_TYPES {
 
 #define TPP_DEF_ROUTER_PORT     17001
 #define TPP_SCRATCHSIZE         8192
+#define TPP_MAX_SEND_IOV        64   /* max packets coalesced into one send */
 
 #define TPP_ROUTER_STATE_DISCONNECTED	0   /* Leaf not connected to router */
 #define TPP_ROUTER_STATE_CONNECTING		1   /* Leaf is connecting to router */
@@ -380,10 +397,16 @@ typedef struct {
  * thread, it posts a message to that threads mbox.
  * That wakes up the thread from a poll/select
  * and allows to act on the message
+ *
+ * Posters only signal the mbox when they find it empty, and the owning
+ * thread takes everything posted so far in one go into mbox_local, which
+ * only it touches, so a burst of posts costs one wakeup and one lock
+ * round trip on the reading side.
  */
 typedef struct {
 	pthread_mutex_t mbox_mutex;
 	tpp_que_t mbox_queue;
+	tpp_que_t mbox_local; /* commands taken by the owning thread, not yet read */
 #ifdef HAVE_SYS_EVENTFD_H
 	int mbox_eventfd;
 #else
@@ -401,13 +424,12 @@ typedef struct {
 
 typedef struct {
 	void *td;
+	void *route_cache; /* per thread cache of resolved routes (routers only) */
 	char tpplogbuf[TPP_LOGBUF_SZ];
 	char tppstaticbuf[TPP_LOGBUF_SZ];
 } tpp_tls_t;
 
 typedef struct {
-	void *cleartext;
-	int cleartext_len;
 	void *authctx;
 	auth_def_t *authdef;
 	void *encryptctx;
@@ -539,11 +561,53 @@ typedef struct {
 
 #elif defined (PBS_USE_EPOLL)
 
+#ifdef PBS_HAVE_IO_URING
+/*
+ * io_uring backend, used in place of epoll when PBS_USE_IO_URING is set in
+ * pbs.conf and the kernel supports it. Every monitored fd has at most one
+ * poll request outstanding in the ring, tagged with the fd and a
+ * generation number so completions of requests since modified or removed
+ * can be told apart and dropped.
+ */
+typedef struct {
+	unsigned int gen;	/* generation of the fd's poll request, 0 if not monitored */
+	int mask;		/* events the fd is monitored for */
+	int armed;		/* a poll request for this fd is outstanding */
+} uring_fd_t;
+
+typedef struct {
+	int ring_fd;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ring;
+	size_t sq_ring_sz;
+	void *cq_ring;
+	size_t cq_ring_sz;
+	size_t sqes_sz;
+	unsigned int sq_entries;
+	unsigned int to_submit;	/* requests queued but not yet handed to the kernel */
+	unsigned int gen;	/* last generation number handed out */
+	uring_fd_t *fds;	/* indexed by fd */
+	int fds_sz;
+	uint64_t *rearm;	/* fds reported by the last wait, to be polled again */
+	int nrearm;
+} uring_context_t;
+#endif
+
 typedef struct {
 	int epoll_fd;
 	int max_nfds;
 	pid_t init_pid;
 	em_event_t *events;
+#ifdef PBS_HAVE_IO_URING
+	uring_context_t *uring;	/* NULL when using epoll */
+#endif
 } epoll_context_t;
 
 #elif defined (PBS_USE_POLLSET)
@@ -372,6 +372,34 @@ tpp_sock_send(int s, const char *buf, int len, int flags)
 	return ret;
 }
 
+/*
+ * emulate writev() on windows by calling send() on each buffer in
+ * turn, stopping at the first short send, so that callers see the
+ * same partial write semantics as on unix
+ */
+int
+tpp_sock_sendv(int s, const struct iovec *iov, int iovcnt)
+{
+	int i;
+	int ret;
+	int total = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len == 0)
+			continue;
+		ret = tpp_sock_send(s, iov[i].iov_base, (int) iov[i].iov_len, 0);
+		if (ret < 0) {
+			if (total > 0)
+				return total;
+			return -1;
+		}
+		total += ret;
+		if (ret < (int) iov[i].iov_len)
+			break;
+	}
+	return total;
+}
+
 /*
  * wrapper to call windows select() and map windows
  * error code to errno and massage the return value
@@ -84,6 +84,7 @@
 
 #define RLIST_INC 100
 #define TPP_MAX_ROUTERS 5000
+#define TPP_MCAST_MAX_HOPS 8 /* pbs_comm hops an mcast packet may travel */
 
 struct tpp_config *tpp_conf; /* copy of the global tpp_config */
 
@@ -108,6 +109,7 @@ static int router_pkt_handler(int phy_fd, void *data, int len, void *c, void *ex
 static int router_close_handler(int phy_con, int error, void *c, void *extra);
 static int send_leaves_to_router(tpp_router_t *parent, tpp_router_t *target);
 static tpp_router_t *get_preferred_router(tpp_leaf_t *l, tpp_router_t *this_router, int *fd);
+static tpp_router_t *find_route(tpp_addr_t *dest, int *fd, int *leaf_found);
 static int add_route_to_leaf(tpp_leaf_t *l, tpp_router_t *r, int index);
 static tpp_router_t *del_router_from_leaf(tpp_leaf_t *l, int tfd);
 static int leaf_get_router_index(tpp_leaf_t *l, tpp_router_t *r);
@@ -117,6 +119,27 @@ static int router_post_connect_handler(int tfd, void *data, void *c, void *extra
 /* structure identifying this router */
 static tpp_router_t *this_router = NULL;
 
+/*
+ * Each IO thread of the router keeps a small direct mapped cache of the
+ * routes it resolved, so that forwarding data does not serialize all the
+ * threads on router_lock. Every entry is stamped with route_gen, which is
+ * bumped under router_lock whenever the leaf or router tables change, so
+ * any such change invalidates the cached routes of all threads at once.
+ */
+#define TPP_ROUTE_CACHE_SZ 8192
+
+typedef struct {
+	tpp_addr_t dest;	/* address of the destination leaf */
+	unsigned long gen;	/* route_gen when resolved, 0 for an empty slot */
+	tpp_router_t *r;	/* router to go through */
+	int fd;			/* transport fd to send to */
+} route_cache_ent_t;
+
+static volatile unsigned long route_gen = 1;
+
+/* call with router_lock held after changing any route */
+#define routes_changed() (route_gen++)
+
 static tpp_router_t *
 alloc_router(char *name, tpp_addr_t *address)
 {
@@ -681,6 +704,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 
 		if (hop == 1) {
 			l->conn_fd = -1; /* reset my direct connection fd to -1 since its closing */
+			routes_changed();
 		}
 
 		if (l->num_routers > 0) {
@@ -812,6 +836,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			 */
 			r->conn_fd = -1;
 			r->state = TPP_ROUTER_STATE_DISCONNECTED;
+			routes_changed();
 
 			tpp_unlock(&router_lock);
 
@@ -884,6 +909,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			 **/
 			tpp_lock(&router_lock);
 			pbs_idx_delete(routers_idx, &r->router_addr);
+			routes_changed();
 			tpp_unlock(&router_lock);
 
 			/*
@@ -941,8 +967,6 @@ router_close_handler(int tfd, int error, void *c, void *extra)
 			authdata->authdef->destroy_ctx(authdata->authctx);
 		if (authdata->authdef != authdata->encryptdef && authdata->encryptctx && authdata->encryptdef)
 			authdata->encryptdef->destroy_ctx(authdata->encryptctx);
-		if (authdata->cleartext)
-			free(authdata->cleartext);
 		if (authdata->config)
 			free_auth_config(authdata->config);
 		/* DO NOT free authdef here, it will be done in unload_auths() */
@@ -1020,8 +1044,7 @@ router_timer_handler(time_t now)
  * @par Functionality
  *	When the IO thread is ready to send out a packet over the wire, it calls
  *	a prior registered "pre-send" handler. This pre-send handler (for routers)
- *	takes care of encrypting data and save unencrypted data for "post-send" handler
- *	in extra data associated with IO connection
+ *	takes care of encrypting data; routers do not keep the unencrypted data
  *
  * @param[in] tfd - The actual IO connection on which data was sent (unused)
  * @param[in] pkt - The data packet that is sent out by the IO thrd
@@ -1353,6 +1376,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 					}
 				}
 				r->conn_fd = tfd;
+				routes_changed();
 				r->initiator = 0;
 				r->state = TPP_ROUTER_STATE_CONNECTED;
 
@@ -1452,6 +1476,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 					l->num_addrs = hdr->num_addrs;
 
 					l->conn_fd = -1;
+					routes_changed();
 				}
 
 				if (hop == 1) {
@@ -1477,6 +1502,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 						return -1;
 					}
 					l->conn_fd = tfd;
+					routes_changed();
 
 					/*
 					 * Set a context only if the JOIN came from a direct connection
@@ -1755,7 +1781,6 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 			}
 #endif
 
-			mhdr->hop = 1; /* set hop=1 to forward, use orig_hop for checking */
 
 			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Total mcast member streams=%d", num_streams);
 			tpp_log_func(LOG_INFO, __func__, tpp_get_logbuf());
@@ -1767,7 +1792,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 			for (k = num_streams - 1; k >= 0; k--) {
 				tpp_addr_t *dest_host;
 				unsigned int src_sd;
-				tpp_leaf_t *l = NULL;
+				int leaf_found;
 
 				minfo = (tpp_mcast_pkt_info_t *)(((char *) minfo_base) + k * sizeof(tpp_mcast_pkt_info_t));
 
@@ -1776,21 +1801,16 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 
 				TPP_DBPRT(("MCAST data on fd=%u", src_sd));
 
-				tpp_lock(&router_lock);
-				pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
-				if (l == NULL) {
+				/* find a router that is still connected */
+				target_router = find_route(dest_host, &target_fd, &leaf_found);
+				if (!leaf_found) {
 					char msg[TPP_LOGBUF_SZ];
-					tpp_unlock(&router_lock);
 					snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: Dest not found at pbs_comm", tpp_netaddr(&this_router->router_addr));
 					log_noroute(src_host, dest_host, src_sd, msg);
 					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
 					continue;
 				}
 
-				/* find a router that is still connected */
-				target_router = get_preferred_router(l, this_router, &target_fd);
-				tpp_unlock(&router_lock);
-
 				if (target_router == NULL) {
 					char msg[TPP_LOGBUF_SZ];
 					snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: No target pbs_comm found", tpp_netaddr(&this_router->router_addr));
@@ -1822,8 +1842,21 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 							free(data_out);
 						return 0;
 					}
-				} else if (orig_hop == 0) {
-					/* add this to list of routers to whom we need to send */
+				} else if (target_fd == tfd || orig_hop >= TPP_MCAST_MAX_HOPS) {
+					/*
+					 * the next hop is the pbs_comm this packet came from, or the
+					 * packet has travelled too far; do not bounce it around the mesh
+					 */
+					char msg[TPP_LOGBUF_SZ];
+					snprintf(msg, TPP_LOGBUF_SZ, "pbs_comm:%s: mcast hop limit reached", tpp_netaddr(&this_router->router_addr));
+					log_noroute(src_host, dest_host, src_sd, msg);
+					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
+				} else {
+					/*
+					 * add this to list of routers to whom we need to send;
+					 * each downstream pbs_comm splits its share again, so a
+					 * packet crosses every inter pbs_comm link only once
+					 */
 					/**
 					 * now walk list backwards checking if router was already added.
 					 * Rationale for checking backwards is that the last router
@@ -1893,7 +1926,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c, void *extra)
 				tpp_mcast_pkt_hdr_t t_mhdr;
 				/* header data */
 				memcpy(&t_mhdr, mhdr, sizeof(tpp_mcast_pkt_hdr_t)); /* only to satisfy valgrind */
-				t_mhdr.hop = 1;
+				t_mhdr.hop = orig_hop + 1;
 
 				/* set the header chunk and data chunk one time for all target comms */
 				mchunks[0].data = &t_mhdr;
@@ -1960,7 +1993,7 @@ mcast_err:
 
 		case TPP_DATA:
 		case TPP_CLOSE_STRM: {
-			tpp_leaf_t *l = NULL;
+			int leaf_found;
 			tpp_addr_t *src_host, *dest_host;
 			unsigned int src_sd;
 			tpp_data_pkt_hdr_t *dhdr = (tpp_data_pkt_hdr_t *) data;
@@ -1969,12 +2002,10 @@ mcast_err:
 			dest_host = &dhdr->dest_addr;
 			src_sd = ntohl(dhdr->src_sd);
 
-			tpp_lock(&router_lock);
-
-			pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
-			if (l == NULL) {
+			/* find a router that is still connected */
+			target_router = find_route(dest_host, &target_fd, &leaf_found);
+			if (!leaf_found) {
 				char msg[TPP_LOGBUF_SZ];
-				tpp_unlock(&router_lock);
 
 				snprintf(msg, TPP_LOGBUF_SZ, "tfd=%d, pbs_comm:%s: Dest not found", tfd, tpp_netaddr(&this_router->router_addr));
 				log_noroute(src_host, dest_host, src_sd, msg);
@@ -1984,10 +2015,6 @@ mcast_err:
 				return 0;
 			}
 
-			/* find a router that is still connected */
-			target_router = get_preferred_router(l, this_router, &target_fd);
-
-			tpp_unlock(&router_lock);
 			if (target_router == NULL) {
 				char msg[TPP_LOGBUF_SZ];
 				snprintf(msg, TPP_LOGBUF_SZ, "tfd=%d, pbs_comm:%s: No target pbs_comm found", tfd, tpp_netaddr(&this_router->router_addr));
@@ -2026,7 +2053,7 @@ mcast_err:
 
 		case TPP_CTL_MSG: {
 			tpp_ctl_pkt_hdr_t *ehdr = (tpp_ctl_pkt_hdr_t *) data;
-			tpp_leaf_t *l = NULL;
+			int leaf_found;
 			int subtype = ehdr->code;
 
 			if (subtype == TPP_MSG_NOROUTE) {
@@ -2040,19 +2067,12 @@ mcast_err:
 				tpp_log_func(LOG_WARNING, __func__, tpp_get_logbuf());
 
 				/* find the fd to forward to via the associated router */
-				tpp_lock(&router_lock);
-
-				pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
-				if (l == NULL) {
-					tpp_unlock(&router_lock);
+				target_router = find_route(dest_host, &target_fd, &leaf_found);
+				if (!leaf_found) {
 					if (data_out)
 						free(data_out);
 					return 0;
 				}
-				/* find a router that is still connected */
-				target_router = get_preferred_router(l, this_router, &target_fd);
-
-				tpp_unlock(&router_lock);
 				if (target_router == NULL) {
 					snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "tfd=%d, No connections to send TPP_CTL_NOROUTE", tfd);
 					tpp_log_func(LOG_WARNING, NULL, tpp_get_logbuf());
@@ -2145,6 +2165,92 @@ get_preferred_router(tpp_leaf_t *l, tpp_router_t *this_router, int *fd)
 	return r;
 }
 
+/**
+ * @brief
+ *	Hash a leaf address to a slot of the per thread route cache
+ *
+ * @param[in] addr - The leaf address
+ *
+ * @return slot index
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static unsigned int
+route_cache_slot(tpp_addr_t *addr)
+{
+	unsigned int h = 2166136261u;
+	int i;
+
+	for (i = 0; i < 4; i++)
+		h = (h ^ (unsigned int) addr->ip[i]) * 16777619u;
+	h = (h ^ (unsigned short) addr->port) * 16777619u;
+
+	return h % TPP_ROUTE_CACHE_SZ;
+}
+
+/**
+ * @brief
+ *	Find the router, and the transport fd, through which a leaf is reached
+ *
+ * @par Functionality
+ *	Looks in the calling thread's route cache first. Only on a miss, or
+ *	when the routing tables changed since the entry was resolved, is the
+ *	router_lock taken to search cluster_leaves_idx, and the cache entry
+ *	refreshed. Failed lookups are not cached.
+ *
+ * @param[in]  dest - Address of the destination leaf
+ * @param[out] fd - The transport fd to send to
+ * @param[out] leaf_found - Set to 1 if the leaf is known, 0 otherwise
+ *
+ * @return	The router to send through
+ * @retval	NULL - No connected route to the leaf
+ * @retval	!NULL - The router (this_router if the leaf is connected to us)
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static tpp_router_t *
+find_route(tpp_addr_t *dest, int *fd, int *leaf_found)
+{
+	tpp_tls_t *tls = tpp_get_tls();
+	route_cache_ent_t *ent = NULL;
+	tpp_leaf_t *l = NULL;
+	tpp_router_t *r = NULL;
+
+	*fd = -1;
+	*leaf_found = 0;
+
+	if (tls) {
+		if (tls->route_cache == NULL)
+			tls->route_cache = calloc(TPP_ROUTE_CACHE_SZ, sizeof(route_cache_ent_t));
+		if (tls->route_cache) {
+			ent = ((route_cache_ent_t *) tls->route_cache) + route_cache_slot(dest);
+			if (ent->gen == route_gen && memcmp(&ent->dest, dest, sizeof(tpp_addr_t)) == 0) {
+				*leaf_found = 1;
+				*fd = ent->fd;
+				return ent->r;
+			}
+		}
+	}
+
+	tpp_lock(&router_lock);
+	pbs_idx_find(cluster_leaves_idx, (void **)&dest, (void **)&l, NULL);
+	if (l != NULL) {
+		*leaf_found = 1;
+		r = get_preferred_router(l, this_router, fd);
+		if (r && ent) {
+			memcpy(&ent->dest, dest, sizeof(tpp_addr_t));
+			ent->r = r;
+			ent->fd = *fd;
+			ent->gen = route_gen;
+		}
+	}
+	tpp_unlock(&router_lock);
+
+	return r;
+}
+
 /**
  * @brief
  *	Convenience function to delete a route from a leaf's list of routers at the
@@ -2177,6 +2283,7 @@ del_router_from_leaf(tpp_leaf_t *l, int tfd)
 			r = l->r[i];
 			l->r[i] = NULL;
 			l->num_routers--;
+			routes_changed();
 			if (l->num_routers == 0)
 				free(l->r);
 			TPP_DBPRT(("pbs_comm count for leaf=%s is %d", tpp_netaddr(&l->leaf_addrs[0]), l->num_routers));
@@ -2231,6 +2338,7 @@ add_route_to_leaf(tpp_leaf_t *l, tpp_router_t *r, int index)
 
 	l->r[index] = r;
 	l->num_routers++;
+	routes_changed();
 
 #ifdef DEBUG
 	{
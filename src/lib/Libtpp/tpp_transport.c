@@ -104,6 +104,7 @@ typedef struct {
  */
 typedef struct {
 	int thrd_index;			  /* thread index for debugging */
+	unsigned int rand_seed;		  /* seed for jittering lazy connects */
 	pthread_t worker_thrd_id; /* Thread id of this thread */
 	int listen_fd;		/* If this is the thread that is also doing
 				 * the listening, then the listening socket
@@ -145,10 +146,19 @@ typedef struct {
 	void *em_context;         /* the em context */
 	tpp_que_t lazy_conn_que;  /* The delayed connection queue on this thread */
 	tpp_que_t close_conn_que;  /* The closed connection queue on this thread */
+	tpp_que_t flush_que;  /* connections with queued data waiting to be sent */
 	tpp_mbox_t mbox;     /* message box for this thread */
 	tpp_tls_t *tpp_tls;	/* tls data related to tpp work */
+	unsigned long pkts_sent;	/* packets written out by this thread */
+	unsigned long bytes_sent;	/* bytes written out by this thread */
+	unsigned long pkts_recvd;	/* packets read in by this thread */
+	unsigned long bytes_recvd;	/* bytes read in by this thread */
+	time_t last_stats_log;	/* last time the counters above were logged */
 } thrd_data_t;
 
+#define TPP_THRD_STATS_INTERVAL 300 /* seconds between per thread stats logs */
+#define TPP_COALESCE_SIZE TPP_SCRATCHSIZE /* only messages smaller than this are held back */
+
 #ifdef NAS /* localmod 149 */
 static  char tpp_instr_flag_file[_POSIX_PATH_MAX] = "/PBS/flags/tpp_instrumentation";
 #endif /* localmod 149 */
@@ -186,6 +196,8 @@ typedef struct {
 
 	unsigned long send_queue_size;  /* total bytes waiting on send queue */
 	tpp_que_t send_queue;      /* queue of pkts to send */
+	tpp_que_elem_t *flush_node; /* node in the thread's flush_que, if queued there */
+	long long flush_at;        /* time (ms) by which the send queue must be sent */
 	tpp_packet_t scratch;      /* scratch to work on incoming data */
 	thrd_data_t *td;                  /* connections controller thread */
 
@@ -211,6 +223,8 @@ static int assign_to_worker(int tfd, int delay, thrd_data_t *td);
 static int handle_disconnect(phy_conn_t *conn);
 static void handle_incoming_data(phy_conn_t *conn);
 static void send_data(phy_conn_t *conn);
+static void schedule_flush(phy_conn_t *conn, int len);
+static int flush_sends(thrd_data_t *td);
 static void free_phy_conn(phy_conn_t *conn);
 static void handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data);
 static int add_pkts(phy_conn_t *conn);
@@ -245,6 +259,19 @@ enque_lazy_connect(thrd_data_t *td, int tfd, int delay)
 		tpp_log_func(LOG_CRIT, __func__, "Out of memory queueing a lazy connect");
 		return;
 	}
+	/*
+	 * Pick a time between half and one and a half times the delay, so
+	 * that the many nodes that lost the same router at the same time do
+	 * not all try to reconnect to it in the same second
+	 */
+	if (delay > 1) {
+#ifdef WIN32
+		delay = delay / 2 + rand() % (delay + 1);
+#else
+		delay = delay / 2 + rand_r(&td->rand_seed) % (delay + 1);
+#endif
+	}
+
 	conn_ev->tfd = tfd;
 	conn_ev->conn_time = time(0) + delay;
 
@@ -484,6 +511,9 @@ int
 tpp_transport_init(struct tpp_config *conf)
 {
 	int i;
+#ifndef WIN32
+	struct timeval tv;
+#endif
 
 	if (conf->node_type == TPP_LEAF_NODE || conf->node_type == TPP_LEAF_NODE_LISTEN) {
 		if (conf->numthreads != 1) {
@@ -578,6 +608,7 @@ tpp_transport_init(struct tpp_config *conf)
 		thrd_pool[i]->listen_fd = -1;
 		TPP_QUE_CLEAR(&thrd_pool[i]->lazy_conn_que);
 		TPP_QUE_CLEAR(&thrd_pool[i]->close_conn_que);
+		TPP_QUE_CLEAR(&thrd_pool[i]->flush_que);
 
 		if ((thrd_pool[i]->em_context = tpp_em_init(max_con)) == NULL) {
 			snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "em_init() error, errno=%d", errno);
@@ -598,6 +629,10 @@ tpp_transport_init(struct tpp_config *conf)
 		}
 
 		thrd_pool[i]->thrd_index = i;
+#ifndef WIN32
+		gettimeofday(&tv, NULL);
+		thrd_pool[i]->rand_seed = (unsigned int) (tv.tv_sec ^ tv.tv_usec ^ getpid() ^ (i << 16));
+#endif
 	}
 
 	if (conf->node_type == TPP_ROUTER_NODE) {
@@ -1431,6 +1466,13 @@ handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data)
 	}
 
 	if (cmd == TPP_CMD_CLOSE) {
+		/* send what was queued before the close, as it used to be */
+		if (conn && conn->flush_node) {
+			tpp_que_del_elem(&td->flush_que, conn->flush_node);
+			conn->flush_node = NULL;
+			send_data(conn);
+			conn = get_transport_atomic(tfd, &slot_state);
+		}
 		handle_disconnect(conn);
 	} else if (cmd == TPP_CMD_EXIT) {
 		int i;
@@ -1496,8 +1538,11 @@ handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data)
 		}
 		conn->send_queue_size += pkt->len;
 
-		/* handle socket add calls */
-		send_data(conn);
+		/*
+		 * do not write right away, so that other messages that are
+		 * already waiting in the mbox go out in the same send
+		 */
+		schedule_flush(conn, pkt->len);
 	}
 }
 
@@ -1528,6 +1573,56 @@ tpp_get_thrd_index()
 	return td->thrd_index;
 }
 
+/**
+ * @brief
+ *	Log the traffic counters of an IO thread along with the number of
+ *	connections it manages and the bytes waiting on their send queues,
+ *	so that the load on each thread of a router can be monitored.
+ *
+ * @param[in] td - The thread data of the calling thread
+ * @param[in] now - The current time
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static void
+log_thrd_stats(thrd_data_t *td, time_t now)
+{
+	int i;
+	int nconns = 0;
+	unsigned long queued = 0;
+	unsigned long max_queued = 0;
+
+	tpp_lock(&cons_array_lock);
+	for (i = 0; i < conns_array_size; i++) {
+		phy_conn_t *conn = conns_array[i].conn;
+
+		if (conns_array[i].slot_state != TPP_SLOT_BUSY || conn == NULL || conn->td != td)
+			continue;
+		nconns++;
+		queued += conn->send_queue_size;
+		if (conn->send_queue_size > max_queued)
+			max_queued = conn->send_queue_size;
+	}
+	tpp_unlock(&cons_array_lock);
+
+	snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+		"thrd=%d, last %d secs: pkts sent=%lu recvd=%lu, bytes sent=%lu recvd=%lu; conns=%d, queued bytes=%lu (max %lu)",
+		td->thrd_index, (int) (now - td->last_stats_log),
+		td->pkts_sent, td->pkts_recvd, td->bytes_sent, td->bytes_recvd,
+		nconns, queued, max_queued);
+	tpp_log_func(LOG_INFO, NULL, tpp_get_logbuf());
+
+	td->pkts_sent = 0;
+	td->pkts_recvd = 0;
+	td->bytes_sent = 0;
+	td->bytes_recvd = 0;
+	td->last_stats_log = now;
+}
+
 /**
  * @brief
  *	This is the IO threads "thread-function". It includes a loop of
@@ -1617,6 +1712,7 @@ work(void *v)
 	}
 #endif
 	tpp_log_func(LOG_CRIT, NULL, "Thread ready");
+	td->last_stats_log = time(0);
 
 	/* start processing loop */
 	for (;;) {
@@ -1625,6 +1721,10 @@ work(void *v)
 		while (1) {
 			now = time(0);
 
+			if (tpp_conf->node_type == TPP_ROUTER_NODE &&
+				now >= td->last_stats_log + TPP_THRD_STATS_INTERVAL)
+				log_thrd_stats(td, now);
+
 			/* trigger all delayed connects, and return the wait time till the next one to trigger */
 			timeout = trigger_lazy_connects(td, now);
 			if (the_timer_handler) {
@@ -1642,6 +1742,13 @@ work(void *v)
 				timeout = timeout * 1000; /* milliseconds */
 			}
 
+			/* send out queued data that is due, and find when the next is */
+			timeout2 = flush_sends(td);
+			if (timeout2 != -1) {
+				if (timeout == -1 || timeout2 < timeout)
+					timeout = timeout2;
+			}
+
 			errno = 0;
 			nfds = tpp_em_wait(td->em_context, &events, timeout);
 			if (nfds <= 0) {
@@ -1904,6 +2011,11 @@ handle_disconnect(phy_conn_t *conn)
 
 	tpp_unlock(&cons_array_lock);
 
+	if (conn->flush_node) {
+		tpp_que_del_elem(&conn->td->flush_que, conn->flush_node);
+		conn->flush_node = NULL;
+	}
+
 	/* now enque the connection structure to a queue to be
 	 * actually deleted at the end of the event loop for
 	 * this thread (fd will also be closed there)
@@ -2056,6 +2168,9 @@ add_pkts(phy_conn_t *conn)
 		if (avail_len < pkt_len)
 			break;
 
+		conn->td->pkts_recvd++;
+		conn->td->bytes_recvd += pkt_len;
+
 		data = pkt_start + sizeof(int);
 		if (the_pkt_handler) {
 			if ((rc = the_pkt_handler(conn->sock_fd, data, data_len, conn->ctx, conn->extra)) != 0) {
@@ -2083,215 +2198,251 @@ add_pkts(phy_conn_t *conn)
 	return rc;
 }
 
+#ifdef NAS /* localmod 149 */
 /**
  * @brief
- *	Loop over the list of queued data and send out packet by packet
- *	Stop if sending would block.
+ *	Account for a successful send in the NAS tpp instrumentation
+ *	counters and log them once each period has elapsed
  *
  * @param[in] conn - The physical connection
- *
- * @par Side Effects:
- *	None
+ * @param[in] tosend - Number of bytes that were attempted
+ * @param[in] rc - Number of bytes actually sent
  *
  * @par MT-safe: No
  *
  */
 static void
-send_data(phy_conn_t *conn)
+nas_account_send(phy_conn_t *conn, int tosend, int rc)
 {
-	tpp_packet_t *p = NULL;
-	int rc;
-	int can_send_more;
-	tpp_que_elem_t *n;
-#ifdef NAS /* localmod 149 */
 	time_t curr;
 	int rc_iflag;
-#endif /* localmod 149 */
 
+		curr = time(0);
 
-	/*
-	 * if a socket is still connecting, we will wait to send out data,
-	 * even if app called close - so check this first
-	 */
-	if (conn->net_state == TPP_CONN_CONNECTING || conn->net_state == TPP_CONN_INITIATING)
-		return;
+		conn->td->nas_kb_sent_A += ((double) rc) / 1024.0;
+		conn->td->nas_kb_sent_B += ((double) rc) / 1024.0;
+		conn->td->nas_kb_sent_C += ((double) rc) / 1024.0;
 
-	n = TPP_QUE_HEAD(&conn->send_queue);
-	p = TPP_QUE_DATA(n);
+		if (tosend > TPP_SCRATCHSIZE) {
+			conn->td->nas_num_lrg_sends_A++;
+			conn->td->nas_lrg_send_sum_kb_A += ((double) tosend) / 1024.0;
 
-	if (conn->can_send == 0)
-		return;
-
-	can_send_more = 1;
+			if (rc != tosend) {
+				conn->td->nas_num_qual_lrg_sends_A++;
+			}
 
-	while (p && can_send_more) {
-		int tosend;
+			if (tosend > conn->td->nas_max_bytes_lrg_send_A) {
+				conn->td->nas_max_bytes_lrg_send_A = tosend;
+			}
 
-		tosend = p->len - (p->pos - p->data);
-		if (p->pos == p->data) {
-			if (the_pkt_presend_handler) {
-				if (the_pkt_presend_handler(conn->sock_fd, p, conn->extra) != 0) {
-					/* handler asked not to send data, skip packet */
-					conn->send_queue_size -= tosend;
-					(void) tpp_que_del_elem(&conn->send_queue, n);
-					n = TPP_QUE_HEAD(&conn->send_queue);
-					p = TPP_QUE_DATA(n);
-					continue;
-				}
-				/* the_pkt_presend_handler could change the pkt size*/
-				tosend = p->len;
+			if (tosend < conn->td->nas_min_bytes_lrg_send_A) {
+				conn->td->nas_min_bytes_lrg_send_A = tosend;
 			}
-		}
 
-		while (tosend > 0) {
-			rc = tpp_sock_send(conn->sock_fd, p->pos, tosend, 0);
-#ifdef NAS /* localmod 149 */
-			if (rc > 0) {
-				curr = time(0);
 
-				conn->td->nas_kb_sent_A += ((double) rc) / 1024.0;
-				conn->td->nas_kb_sent_B += ((double) rc) / 1024.0;
-				conn->td->nas_kb_sent_C += ((double) rc) / 1024.0;
 
-				if (tosend > TPP_SCRATCHSIZE) {
-					conn->td->nas_num_lrg_sends_A++;
-					conn->td->nas_lrg_send_sum_kb_A += ((double) tosend) / 1024.0;
+			conn->td->nas_num_lrg_sends_B++;
+			conn->td->nas_lrg_send_sum_kb_B += ((double) tosend) / 1024.0;
 
-					if (rc != tosend) {
-						conn->td->nas_num_qual_lrg_sends_A++;
-					}
+			if (rc != tosend) {
+				conn->td->nas_num_qual_lrg_sends_B++;
+			}
 
-					if (tosend > conn->td->nas_max_bytes_lrg_send_A) {
-						conn->td->nas_max_bytes_lrg_send_A = tosend;
-					}
+			if (tosend > conn->td->nas_max_bytes_lrg_send_B) {
+				conn->td->nas_max_bytes_lrg_send_B = tosend;
+			}
 
-					if (tosend < conn->td->nas_min_bytes_lrg_send_A) {
-						conn->td->nas_min_bytes_lrg_send_A = tosend;
-					}
+			if (tosend < conn->td->nas_min_bytes_lrg_send_B) {
+				conn->td->nas_min_bytes_lrg_send_B = tosend;
+			}
 
 
 
-					conn->td->nas_num_lrg_sends_B++;
-					conn->td->nas_lrg_send_sum_kb_B += ((double) tosend) / 1024.0;
+			conn->td->nas_num_lrg_sends_C++;
+			conn->td->nas_lrg_send_sum_kb_C += ((double) tosend) / 1024.0;
 
-					if (rc != tosend) {
-						conn->td->nas_num_qual_lrg_sends_B++;
-					}
+			if (rc != tosend) {
+				conn->td->nas_num_qual_lrg_sends_C++;
+			}
 
-					if (tosend > conn->td->nas_max_bytes_lrg_send_B) {
-						conn->td->nas_max_bytes_lrg_send_B = tosend;
-					}
+			if (tosend > conn->td->nas_max_bytes_lrg_send_C) {
+				conn->td->nas_max_bytes_lrg_send_C = tosend;
+			}
 
-					if (tosend < conn->td->nas_min_bytes_lrg_send_B) {
-						conn->td->nas_min_bytes_lrg_send_B = tosend;
-					}
+			if (tosend < conn->td->nas_min_bytes_lrg_send_C) {
+				conn->td->nas_min_bytes_lrg_send_C = tosend;
+			}
+		}
 
+		if (curr > (conn->td->nas_last_time_A + conn->td->NAS_TPP_LOG_PERIOD_A)) {
+			rc_iflag = access(tpp_instr_flag_file, F_OK);
+			if (rc_iflag != 0) {
+				conn->td->nas_tpp_log_enabled = 0;
+			} else {
+				conn->td->nas_tpp_log_enabled = 1;
+			}
 
+			if (conn->td->nas_tpp_log_enabled) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+					 "tpp_instr period_A %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
+					 conn->td->NAS_TPP_LOG_PERIOD_A,
+					 (int) (curr - conn->td->nas_last_time_A),
+					 conn->td->nas_kb_sent_A / 1024.0,
+					 (conn->td->nas_kb_sent_A / 1024.0) / (((double) (curr - conn->td->nas_last_time_A)) / 60.0),
+					 TPP_SCRATCHSIZE,
+					 conn->td->nas_num_lrg_sends_A,
+					 conn->td->nas_num_qual_lrg_sends_A,
+					 conn->td->nas_num_lrg_sends_A > 0 ? conn->td->nas_min_bytes_lrg_send_A : 0,
+					 conn->td->nas_max_bytes_lrg_send_A,
+					 conn->td->nas_num_lrg_sends_A > 0 ? conn->td->nas_lrg_send_sum_kb_A / ((double) conn->td->nas_num_lrg_sends_A) : 0.0);
+				tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
+			}
 
-					conn->td->nas_num_lrg_sends_C++;
-					conn->td->nas_lrg_send_sum_kb_C += ((double) tosend) / 1024.0;
+			conn->td->nas_last_time_A = curr;
+			conn->td->nas_kb_sent_A = 0.0;
+			conn->td->nas_num_lrg_sends_A = 0;
+			conn->td->nas_num_qual_lrg_sends_A = 0;
+			conn->td->nas_max_bytes_lrg_send_A = 0;
+			conn->td->nas_min_bytes_lrg_send_A = INT_MAX - 1;
+			conn->td->nas_lrg_send_sum_kb_A = 0.0;
+		}
 
-					if (rc != tosend) {
-						conn->td->nas_num_qual_lrg_sends_C++;
-					}
+		if (curr > (conn->td->nas_last_time_B + conn->td->NAS_TPP_LOG_PERIOD_B)) {
+			if (conn->td->nas_tpp_log_enabled) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+					 "tpp_instr period_B %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
+					 conn->td->NAS_TPP_LOG_PERIOD_B,
+					 (int) (curr - conn->td->nas_last_time_B),
+					 conn->td->nas_kb_sent_B / 1024.0,
+					 (conn->td->nas_kb_sent_B / 1024.0) / (((double) (curr - conn->td->nas_last_time_B)) / 60.0),
+					 TPP_SCRATCHSIZE,
+					 conn->td->nas_num_lrg_sends_B,
+					 conn->td->nas_num_qual_lrg_sends_B,
+					 conn->td->nas_num_lrg_sends_B > 0 ? conn->td->nas_min_bytes_lrg_send_B : 0,
+					 conn->td->nas_max_bytes_lrg_send_B,
+					 conn->td->nas_num_lrg_sends_B > 0 ? conn->td->nas_lrg_send_sum_kb_B / ((double) conn->td->nas_num_lrg_sends_B) : 0.0);
+				tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
+			}
 
-					if (tosend > conn->td->nas_max_bytes_lrg_send_C) {
-						conn->td->nas_max_bytes_lrg_send_C = tosend;
-					}
+			conn->td->nas_last_time_B = curr;
+			conn->td->nas_kb_sent_B = 0.0;
+			conn->td->nas_num_lrg_sends_B = 0;
+			conn->td->nas_num_qual_lrg_sends_B = 0;
+			conn->td->nas_max_bytes_lrg_send_B = 0;
+			conn->td->nas_min_bytes_lrg_send_B = INT_MAX - 1;
+			conn->td->nas_lrg_send_sum_kb_B = 0.0;
+		}
 
-					if (tosend < conn->td->nas_min_bytes_lrg_send_C) {
-						conn->td->nas_min_bytes_lrg_send_C = tosend;
-					}
-				}
+		if (curr > (conn->td->nas_last_time_C + conn->td->NAS_TPP_LOG_PERIOD_C)) {
+			if (conn->td->nas_tpp_log_enabled) {
+				snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
+					 "tpp_instr period_C %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
+					conn->td->NAS_TPP_LOG_PERIOD_C,
+					(int) (curr - conn->td->nas_last_time_C),
+					conn->td->nas_kb_sent_C / 1024.0,
+					(conn->td->nas_kb_sent_C / 1024.0) / (((double) (
+					curr - conn->td->nas_last_time_C)) / 60.0),
+					TPP_SCRATCHSIZE,
+					conn->td->nas_num_lrg_sends_C,
+					conn->td->nas_num_qual_lrg_sends_C,
+					conn->td->nas_num_lrg_sends_C > 0 ? conn->td->nas_min_bytes_lrg_send_C : 0,
+					conn->td->nas_max_bytes_lrg_send_C,
+					conn->td->nas_num_lrg_sends_C > 0 ? conn->td->nas_lrg_send_sum_kb_C / ((double) conn->td->nas_num_lrg_sends_C) : 0.0);
+				tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
+			}
 
-				if (curr > (conn->td->nas_last_time_A + conn->td->NAS_TPP_LOG_PERIOD_A)) {
-					rc_iflag = access(tpp_instr_flag_file, F_OK);
-					if (rc_iflag != 0) {
-						conn->td->nas_tpp_log_enabled = 0;
-					} else {
-						conn->td->nas_tpp_log_enabled = 1;
-					}
+			conn->td->nas_last_time_C = curr;
+			conn->td->nas_kb_sent_C = 0.0;
+			conn->td->nas_num_lrg_sends_C = 0;
+			conn->td->nas_num_qual_lrg_sends_C = 0;
+			conn->td->nas_max_bytes_lrg_send_C = 0;
+			conn->td->nas_min_bytes_lrg_send_C = INT_MAX - 1;
+			conn->td->nas_lrg_send_sum_kb_C = 0.0;
+		}
+}
+#endif /* localmod 149 */
 
-					if (conn->td->nas_tpp_log_enabled) {
-						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
-							 "tpp_instr period_A %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
-							 conn->td->NAS_TPP_LOG_PERIOD_A,
-							 (int) (curr - conn->td->nas_last_time_A),
-							 conn->td->nas_kb_sent_A / 1024.0,
-							 (conn->td->nas_kb_sent_A / 1024.0) / (((double) (curr - conn->td->nas_last_time_A)) / 60.0),
-							 TPP_SCRATCHSIZE,
-							 conn->td->nas_num_lrg_sends_A,
-							 conn->td->nas_num_qual_lrg_sends_A,
-							 conn->td->nas_num_lrg_sends_A > 0 ? conn->td->nas_min_bytes_lrg_send_A : 0,
-							 conn->td->nas_max_bytes_lrg_send_A,
-							 conn->td->nas_num_lrg_sends_A > 0 ? conn->td->nas_lrg_send_sum_kb_A / ((double) conn->td->nas_num_lrg_sends_A) : 0.0);
-						tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
-					}
+/**
+ * @brief
+ *	Loop over the list of queued data and send it out, coalescing up to
+ *	TPP_MAX_SEND_IOV queued packets into a single vectored send.
+ *	Stop if sending would block.
+ *
+ * @par Functionality
+ *	The presend handler is run once per packet, the first time the packet
+ *	is picked up, and the packet is marked so a partially sent packet is
+ *	never handed to it again. An encrypted packet keeps its cleartext in
+ *	the packet itself until the postsend handler runs, so encrypted packets
+ *	are gathered into one send like any others.
+ *
+ * @param[in] conn - The physical connection
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+send_data(phy_conn_t *conn)
+{
+	struct iovec iov[TPP_MAX_SEND_IOV];
+	tpp_packet_t *p = NULL;
+	tpp_que_elem_t *n;
+	tpp_que_elem_t *next;
+	int niov;
+	int tosend;
+	int rc;
 
-					conn->td->nas_last_time_A = curr;
-					conn->td->nas_kb_sent_A = 0.0;
-					conn->td->nas_num_lrg_sends_A = 0;
-					conn->td->nas_num_qual_lrg_sends_A = 0;
-					conn->td->nas_max_bytes_lrg_send_A = 0;
-					conn->td->nas_min_bytes_lrg_send_A = INT_MAX - 1;
-					conn->td->nas_lrg_send_sum_kb_A = 0.0;
-				}
+	/*
+	 * if a socket is still connecting, we will wait to send out data,
+	 * even if app called close - so check this first
+	 */
+	if (conn->net_state == TPP_CONN_CONNECTING || conn->net_state == TPP_CONN_INITIATING)
+		return;
 
-				if (curr > (conn->td->nas_last_time_B + conn->td->NAS_TPP_LOG_PERIOD_B)) {
-					if (conn->td->nas_tpp_log_enabled) {
-						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
-							 "tpp_instr period_B %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
-							 conn->td->NAS_TPP_LOG_PERIOD_B,
-							 (int) (curr - conn->td->nas_last_time_B),
-							 conn->td->nas_kb_sent_B / 1024.0,
-							 (conn->td->nas_kb_sent_B / 1024.0) / (((double) (curr - conn->td->nas_last_time_B)) / 60.0),
-							 TPP_SCRATCHSIZE,
-							 conn->td->nas_num_lrg_sends_B,
-							 conn->td->nas_num_qual_lrg_sends_B,
-							 conn->td->nas_num_lrg_sends_B > 0 ? conn->td->nas_min_bytes_lrg_send_B : 0,
-							 conn->td->nas_max_bytes_lrg_send_B,
-							 conn->td->nas_num_lrg_sends_B > 0 ? conn->td->nas_lrg_send_sum_kb_B / ((double) conn->td->nas_num_lrg_sends_B) : 0.0);
-						tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
-					}
+	if (conn->can_send == 0)
+		return;
 
-					conn->td->nas_last_time_B = curr;
-					conn->td->nas_kb_sent_B = 0.0;
-					conn->td->nas_num_lrg_sends_B = 0;
-					conn->td->nas_num_qual_lrg_sends_B = 0;
-					conn->td->nas_max_bytes_lrg_send_B = 0;
-					conn->td->nas_min_bytes_lrg_send_B = INT_MAX - 1;
-					conn->td->nas_lrg_send_sum_kb_B = 0.0;
-				}
+	while (TPP_QUE_HEAD(&conn->send_queue)) {
+		/* gather packets from the head of the queue */
+		niov = 0;
+		tosend = 0;
+		n = TPP_QUE_HEAD(&conn->send_queue);
+		while (n && niov < TPP_MAX_SEND_IOV) {
+			next = TPP_QUE_NEXT(&conn->send_queue, n);
+			p = TPP_QUE_DATA(n);
 
-				if (curr > (conn->td->nas_last_time_C + conn->td->NAS_TPP_LOG_PERIOD_C)) {
-					if (conn->td->nas_tpp_log_enabled) {
-						snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ,
-							 "tpp_instr period_C %d last %d secs (mb=%.3f, mb/min=%.3f) lrg send over %d (sends=%d, qualified=%d, minbytes=%d, maxbytes=%d, avgkb=%.1f)",
-							conn->td->NAS_TPP_LOG_PERIOD_C,
-							(int) (curr - conn->td->nas_last_time_C),
-							conn->td->nas_kb_sent_C / 1024.0,
-							(conn->td->nas_kb_sent_C / 1024.0) / (((double) (
-							curr - conn->td->nas_last_time_C)) / 60.0),
-							TPP_SCRATCHSIZE,
-							conn->td->nas_num_lrg_sends_C,
-							conn->td->nas_num_qual_lrg_sends_C,
-							conn->td->nas_num_lrg_sends_C > 0 ? conn->td->nas_min_bytes_lrg_send_C : 0,
-							conn->td->nas_max_bytes_lrg_send_C,
-							conn->td->nas_num_lrg_sends_C > 0 ? conn->td->nas_lrg_send_sum_kb_C / ((double) conn->td->nas_num_lrg_sends_C) : 0.0);
-						tpp_log_func(LOG_ERR, __func__, tpp_get_logbuf());
-					}
+			if (p->presend_done == 0) {
+				if (the_pkt_presend_handler) {
+					int plen = p->len;
 
-					conn->td->nas_last_time_C = curr;
-					conn->td->nas_kb_sent_C = 0.0;
-					conn->td->nas_num_lrg_sends_C = 0;
-					conn->td->nas_num_qual_lrg_sends_C = 0;
-					conn->td->nas_max_bytes_lrg_send_C = 0;
-					conn->td->nas_min_bytes_lrg_send_C = INT_MAX - 1;
-					conn->td->nas_lrg_send_sum_kb_C = 0.0;
+					if (the_pkt_presend_handler(conn->sock_fd, p, conn->extra) != 0) {
+						/* handler asked not to send data, skip packet */
+						conn->send_queue_size -= plen;
+						(void) tpp_que_del_elem(&conn->send_queue, n);
+						n = next;
+						continue;
+					}
+					/* the_pkt_presend_handler could change the pkt size */
+					conn->send_queue_size += p->len - plen;
 				}
+				p->presend_done = 1;
 			}
-#endif /* localmod 149 */
 
+			iov[niov].iov_base = p->pos;
+			iov[niov].iov_len = p->len - (p->pos - p->data);
+			tosend += iov[niov].iov_len;
+			niov++;
+			n = next;
+		}
+
+		if (niov == 0)
+			break;
+
+		rc = 0;
+		if (tosend > 0) {
+			rc = tpp_sock_sendv(conn->sock_fd, iov, niov);
 			if (rc < 0) {
 				if (errno == EWOULDBLOCK || errno == EAGAIN) {
 					/* set this socket in POLLOUT */
@@ -2305,18 +2456,34 @@ send_data(phy_conn_t *conn)
 					conn->can_send = 0;
 				} else {
 					handle_disconnect(conn);
-					return;
 				}
-				can_send_more = 0;
-				break;
+				return;
 			}
-			TPP_DBPRT(("tfd=%d, sending out %d bytes", conn->sock_fd, rc));
-			p->pos += rc;
-			tosend -= rc;
+			TPP_DBPRT(("tfd=%d, sending out %d bytes in %d pkts", conn->sock_fd, rc, niov));
+			conn->td->bytes_sent += rc;
+#ifdef NAS /* localmod 149 */
+			if (rc > 0)
+				nas_account_send(conn, tosend, rc);
+#endif /* localmod 149 */
 		}
 
-		if (tosend == 0) {
+		/* retire the packets that went out completely */
+		while (niov > 0 && (n = TPP_QUE_HEAD(&conn->send_queue))) {
+			int left;
+
+			p = TPP_QUE_DATA(n);
+			left = p->len - (p->pos - p->data);
+			if (rc < left) {
+				p->pos += rc;
+				break;
+			}
+			rc -= left;
+			p->pos += left;
+			niov--;
+
 			conn->send_queue_size -= p->len;
+			conn->td->pkts_sent++;
+			p->presend_done = 0;
 
 			if (the_pkt_postsend_handler)
 				the_pkt_postsend_handler(conn->sock_fd, p, conn->extra);
@@ -2329,12 +2496,107 @@ send_data(phy_conn_t *conn)
 			 * delete this node and get next node in queue
 			 */
 			(void)tpp_que_del_elem(&conn->send_queue, n);
-			n = TPP_QUE_HEAD(&conn->send_queue);
-			p = TPP_QUE_DATA(n);
 		}
 	}
 }
 
+/**
+ * @brief
+ *	Return the current time in milliseconds
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static long long
+tpp_time_ms(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return ((long long) tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief
+ *	Arrange for the send queue of a connection to be flushed
+ *
+ * @par Functionality
+ *	Instead of writing each message as it is handed to the IO thread,
+ *	the connection is put on the thread's flush queue and written out
+ *	once the thread has drained its mbox, so that messages queued
+ *	together leave in a single vectored send. If a coalesce delay is
+ *	configured, a small message may additionally wait up to that many
+ *	milliseconds for further messages to the same connection. The
+ *	deadline is set by the first message and is never extended, so it
+ *	bounds the latency added to any message.
+ *
+ * @param[in] conn - The physical connection
+ * @param[in] len - Length of the packet just queued
+ *
+ * @par MT-safe: No
+ *
+ */
+static void
+schedule_flush(phy_conn_t *conn, int len)
+{
+	long long flush_at = tpp_time_ms();
+
+	/* routers forward right away, the delay only applies on leaves */
+	if (tpp_conf->node_type != TPP_ROUTER_NODE &&
+		len < TPP_COALESCE_SIZE && conn->send_queue_size < TPP_COALESCE_SIZE)
+		flush_at += tpp_conf->coalesce_delay;
+
+	if (conn->flush_node) {
+		if (flush_at < conn->flush_at)
+			conn->flush_at = flush_at;
+		return;
+	}
+
+	conn->flush_at = flush_at;
+	if ((conn->flush_node = tpp_enque(&conn->td->flush_que, conn)) == NULL)
+		send_data(conn); /* could not defer, so send now */
+}
+
+/**
+ * @brief
+ *	Send out the queued data of the connections whose flush is due
+ *
+ * @param[in] td - The thread data of the calling thread
+ *
+ * @return	milliseconds till the next flush is due
+ * @retval	-1 - no flush pending
+ *
+ * @par MT-safe: No
+ *
+ */
+static int
+flush_sends(thrd_data_t *td)
+{
+	tpp_que_elem_t *n;
+	tpp_que_elem_t *next;
+	phy_conn_t *conn;
+	long long now;
+	long long wait = -1;
+
+	if (TPP_QUE_HEAD(&td->flush_que) == NULL)
+		return -1;
+
+	now = tpp_time_ms();
+	n = TPP_QUE_HEAD(&td->flush_que);
+	while (n) {
+		next = n->next;
+		conn = TPP_QUE_DATA(n);
+		if (conn->flush_at <= now) {
+			(void) tpp_que_del_elem(&td->flush_que, n);
+			conn->flush_node = NULL;
+			send_data(conn);
+		} else if (wait == -1 || conn->flush_at - now < wait)
+			wait = conn->flush_at - now;
+		n = next;
+	}
+	return (int) wait;
+}
+
 /**
  * @brief
  *	Free a physical connection
@@ -72,12 +72,28 @@
 #ifdef PBS_COMPRESSION_ENABLED
 #include <zlib.h>
 #endif
+#ifdef PBS_LZ4_ENABLED
+#include <lz4.h>
+#endif
 
 /*
  *	Global Variables
  */
 int tpp_dbprt = 1; /* controls debug printing */
 
+#ifdef PBS_COMPRESSION_ENABLED
+/*
+ * Data compressed by tpp_deflate() is self describing, so a receiver can
+ * always decompress it, whichever codec the sender was configured with.
+ * A zlib stream always starts with a CMF byte whose low nibble is 8
+ * (deflate), so lz4 data is prefixed with a marker byte that can never
+ * start a zlib stream. zlib data is sent unchanged, as before.
+ */
+#define TPP_LZ4_MARKER 0x4c
+
+static int tpp_compress_codec = TPP_CODEC_ZLIB; /* codec used by tpp_deflate */
+#endif
+
 /* TLS data for each TPP thread */
 static pthread_key_t tpp_key_tls;
 static pthread_once_t tpp_once_ctrl = PTHREAD_ONCE_INIT; /* once ctrl to initialize tls key */
@@ -94,6 +110,8 @@ void (*tpp_log_func)(int level, const char *id, char *mess) = NULL;
 
 #define PBS_TCP_KEEPALIVE "PBS_TCP_KEEPALIVE" /* environment string to search for */
 
+#define TPP_MAX_COALESCE_DELAY 100 /* upper bound in ms on PBS_TPP_COALESCE_DELAY */
+
 /* extern functions called from this file into the tpp_transport.c */
 static pbs_tcp_chan_t * tppdis_get_user_data(int sd);
 
@@ -153,6 +171,7 @@ DIS_tpp_funcs()
 	pfn_transport_set_chan = (int (*)(int, pbs_tcp_chan_t *)) &tpp_set_user_data;
 	pfn_transport_recv = tpp_recv;
 	pfn_transport_send = tpp_send;
+	pfn_transport_sendv = NULL; /* a DIS message must stay in one TPP packet */
 }
 
 
@@ -358,9 +377,19 @@ set_tpp_config(void (*log_fn)(int, const char *, char *), struct pbs_config *pbs
 	}
 
 #ifdef PBS_COMPRESSION_ENABLED
-	tpp_conf->compress = pbs_conf->pbs_use_compression;
+	tpp_conf->compress = (pbs_conf->pbs_use_compression > 0) ? 1 : 0;
+	tpp_conf->compress_codec = TPP_CODEC_ZLIB;
+	if (pbs_conf->pbs_use_compression == TPP_CODEC_LZ4) {
+#ifdef PBS_LZ4_ENABLED
+		tpp_conf->compress_codec = TPP_CODEC_LZ4;
+#else
+		tpp_log_func(LOG_WARNING, NULL, "TPP not built with lz4 support, using zlib compression");
+#endif
+	}
+	tpp_compress_codec = tpp_conf->compress_codec;
 #else
 	tpp_conf->compress = 0;
+	tpp_conf->compress_codec = 0;
 #endif
 
 	/* set default parameters for keepalive */
@@ -415,6 +444,19 @@ set_tpp_config(void (*log_fn)(int, const char *, char *), struct pbs_config *pbs
 		tpp_log_func(LOG_CRIT, NULL, log_buffer);
 	}
 
+	/*
+	 * milliseconds a small message may be held back on a leaf so that it
+	 * goes out in the same send as other messages queued right after it
+	 */
+	tpp_conf->coalesce_delay = 0;
+	if (pbs_conf->pbs_tpp_coalesce_delay > 0) {
+		tpp_conf->coalesce_delay = pbs_conf->pbs_tpp_coalesce_delay;
+		if (tpp_conf->coalesce_delay > TPP_MAX_COALESCE_DELAY)
+			tpp_conf->coalesce_delay = TPP_MAX_COALESCE_DELAY;
+		snprintf(log_buffer, TPP_LOGBUF_SZ, "Using TPP coalesce delay of %d ms", tpp_conf->coalesce_delay);
+		tpp_log_func(LOG_INFO, NULL, log_buffer);
+	}
+
 	tpp_conf->buf_limit_per_conn = 5000; /* size in KB, TODO: load from pbs.conf */
 
 	if (pbs_conf->pbs_use_ft == 1)
@@ -692,6 +734,9 @@ tpp_cr_pkt(void *data, int len, int mk_data)
 	pkt->extra_data = NULL;
 	pkt->len = len;
 	pkt->ref_count = 1;
+	pkt->presend_done = 0;
+	pkt->cleartext = NULL;
+	pkt->cleartext_len = 0;
 
 	return pkt;
 }
@@ -719,6 +764,7 @@ tpp_free_pkt(tpp_packet_t *pkt)
 				free(pkt->data);
 			if (pkt->extra_data)
 				free(pkt->extra_data);
+			free(pkt->cleartext);
 			free(pkt);
 		}
 	}
@@ -1751,6 +1797,94 @@ tpp_multi_deflate_done(void *c, unsigned int *cmpr_len)
 	return data;
 }
 
+#ifdef PBS_LZ4_ENABLED
+/**
+ * @brief Compress data with lz4, prefixed with TPP_LZ4_MARKER
+ *
+ * @param[in] inbuf   - Ptr to buffer to compress
+ * @param[in] inlen   - The size of input buffer
+ * @param[out] outlen - The size of the compressed data
+ *
+ * @return      - Ptr to the compressed data buffer
+ * @retval  !NULL - Success
+ * @retval   NULL - Failure
+ *
+ * @par MT-safe: Yes
+ **/
+static void *
+tpp_lz4_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen)
+{
+	int bound;
+	int len;
+	char *data;
+	void *p;
+
+	bound = LZ4_compressBound((int) inlen);
+	if (bound <= 0) {
+		tpp_log_func(LOG_CRIT, __func__, "Compression failed");
+		return NULL;
+	}
+
+	data = malloc(bound + 1);
+	if (!data) {
+		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating deflate buffer %d bytes", bound + 1);
+		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+		return NULL;
+	}
+	data[0] = TPP_LZ4_MARKER;
+
+	len = LZ4_compress_default(inbuf, data + 1, (int) inlen, bound);
+	if (len <= 0) {
+		free(data);
+		tpp_log_func(LOG_CRIT, __func__, "Compression failed");
+		return NULL;
+	}
+
+	/* reduce the memory area occupied */
+	if ((p = realloc(data, len + 1)) != NULL)
+		data = p;
+
+	*outlen = len + 1;
+	return data;
+}
+
+/**
+ * @brief Decompress data produced by tpp_lz4_deflate
+ *
+ * @param[in] inbuf  - Ptr to compress data buffer
+ * @param[in] inlen  - The size of input buffer
+ * @param[in] totlen - The total size of the uncompress data
+ *
+ * @return      - Ptr to the uncompressed data buffer
+ * @retval  !NULL - Success
+ * @retval   NULL - Failure
+ *
+ * @par MT-safe: Yes
+ **/
+static void *
+tpp_lz4_inflate(void *inbuf, unsigned int inlen, unsigned int totlen)
+{
+	void *outbuf;
+	int ret;
+
+	outbuf = malloc(totlen > 0 ? totlen : 1);
+	if (!outbuf) {
+		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating inflate buffer %d bytes", totlen);
+		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+		return NULL;
+	}
+
+	ret = LZ4_decompress_safe((char *) inbuf + 1, outbuf, (int) inlen - 1, (int) totlen);
+	if (ret < 0 || (unsigned int) ret != totlen) {
+		free(outbuf);
+		snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Decompression (lz4) failed, ret = %d", ret);
+		tpp_log_func(LOG_CRIT, __func__, tpp_get_logbuf());
+		return NULL;
+	}
+	return outbuf;
+}
+#endif
+
 /**
  * @brief Deflate (compress) data
  *
@@ -1776,6 +1910,11 @@ tpp_deflate(void *inbuf, unsigned int inlen, unsigned int *outlen)
 
 	*outlen = 0;
 
+#ifdef PBS_LZ4_ENABLED
+	if (tpp_compress_codec == TPP_CODEC_LZ4)
+		return tpp_lz4_deflate(inbuf, inlen, outlen);
+#endif
+
 	/* allocate deflate state */
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
@@ -1870,6 +2009,15 @@ tpp_inflate(void *inbuf, unsigned int inlen, unsigned int totlen)
 	z_stream strm;
 	void *outbuf = NULL;
 
+	if (inlen > 0 && *((unsigned char *) inbuf) == TPP_LZ4_MARKER) {
+#ifdef PBS_LZ4_ENABLED
+		return tpp_lz4_inflate(inbuf, inlen, totlen);
+#else
+		tpp_log_func(LOG_CRIT, __func__, "Received lz4 compressed data, but TPP not built with lz4 support");
+		return NULL;
+#endif
+	}
+
 	/*
 	 * in some rare cases totlen < compressed_len (inlen)
 	 * so safer to malloc the larger of the two values
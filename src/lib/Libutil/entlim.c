@@ -40,15 +40,231 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 #include "pbs_entlim.h"
 #include <pbs_config.h>
 
+/*
+ * Besides the index by key string, which keeps the records in key order
+ * for listing, every context keeps a two level index used by
+ * entlim_get_id(): per key type, a hash from entity name to an array of
+ * records addressed by interned resource id.  Slot ENTLIM_RUN_ID holds
+ * the entity's run (job count) limit.  If that index cannot be kept up to
+ * date it is dropped and entlim_get_id() falls back to the key string.
+ */
+typedef struct _entlim_ent {
+	int ee_nslots;
+	void **ee_slots;
+} entlim_ent;
+
 /* entlim iteration context structure, opaque to caller */
 typedef struct _entlim_ctx {
 	void *idx;
 	void *idx_ctx;
+	void *ent_idx[LIM_OVERALL + 1]; /* entity name to entlim_ent, by key type */
+	int ent_ix_bad;			/* ent_idx given up, use idx */
 } entlim_ctx;
 
+/* resource names interned by entlim_resc_id(), shared by all contexts */
+static void *resc_ids = NULL;
+static char **resc_names = NULL; /* indexed by id */
+static int resc_nids = 0;
+
+/**
+ * @brief
+ * 	resc_intern - return the interned id of a resource name, assigning
+ *	the next one if the name has not been seen
+ *
+ * @return	int
+ * @retval	>0	id of the resource
+ * @retval	-1	out of memory
+ */
+static int
+resc_intern(const char *resc)
+{
+	char **tmp;
+	char *name;
+	int id;
+
+	if ((id = entlim_resc_id(resc)) > 0)
+		return id;
+	if (resc_ids == NULL && (resc_ids = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+		return -1;
+	id = resc_nids + 1;
+	if ((tmp = realloc(resc_names, (id + 1) * sizeof(char *))) == NULL)
+		return -1;
+	resc_names = tmp;
+	if ((name = strdup(resc)) == NULL)
+		return -1;
+	if (pbs_idx_insert(resc_ids, (void *)resc, (void *)(intptr_t)id) != PBS_IDX_RET_OK) {
+		free(name);
+		return -1;
+	}
+	resc_names[id] = name;
+	resc_nids = id;
+	return id;
+}
+
+/**
+ * @brief
+ * 	entlim_resc_id - return the id under which entity limits on a
+ *	resource are kept, for use with entlim_get_id()
+ *
+ * @param[in] resc - resource name
+ *
+ * @return	int
+ * @retval	>0	id of the resource
+ * @retval	-1	no limit on the resource has ever been added
+ */
+int
+entlim_resc_id(const char *resc)
+{
+	void *id;
+
+	if (resc_ids == NULL || resc == NULL)
+		return -1;
+	if (pbs_idx_find(resc_ids, (void **)&resc, &id, NULL) != PBS_IDX_RET_OK)
+		return -1;
+	return (int)(intptr_t)id;
+}
+
+/**
+ * @brief
+ * 	key_resc_intern - intern the resource named in a key string, if any,
+ *	so that every record kept has an id entlim_get_id() can find it by
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	out of memory
+ */
+static int
+key_resc_intern(const char *keystr)
+{
+	const char *pc;
+
+	if ((pc = strchr(keystr, ';')) != NULL && resc_intern(pc + 1) == -1)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ * 	ent_ix_drop - give up on the two level index of a context after it
+ *	could not be updated, lookups then go by key string
+ */
+static void
+ent_ix_drop(entlim_ctx *pctx)
+{
+	void *ictx;
+	entlim_ent *pent;
+	int kt;
+
+	for (kt = 0; kt <= LIM_OVERALL; kt++) {
+		if (pctx->ent_idx[kt] == NULL)
+			continue;
+		ictx = NULL;
+		while (pbs_idx_find(pctx->ent_idx[kt], NULL, (void **)&pent, &ictx) == PBS_IDX_RET_OK) {
+			free(pent->ee_slots);
+			free(pent);
+		}
+		pbs_idx_free_ctx(ictx);
+		pbs_idx_destroy(pctx->ent_idx[kt]);
+		pctx->ent_idx[kt] = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 	ent_ix_set - point the two level index slot for a key string at a
+ *	record, or clear it when recptr is NULL
+ *
+ * @param[in] pctx - pointer to context
+ * @param[in] keystr - key string made by entlim_mk_runkey/entlim_mk_reskey
+ * @param[in] recptr - the record, NULL if it is being deleted
+ */
+static void
+ent_ix_set(entlim_ctx *pctx, const char *keystr, void *recptr)
+{
+	enum lim_keytypes kt;
+	const char *pc;
+	char *entity;
+	entlim_ent *pent = NULL;
+	void **tmp;
+	int id = ENTLIM_RUN_ID;
+	int n;
+
+	if (pctx->ent_ix_bad)
+		return;
+
+	switch (keystr[0]) {
+		case 'u':
+			kt = LIM_USER;
+			break;
+		case 'g':
+			kt = LIM_GROUP;
+			break;
+		case 'p':
+			kt = LIM_PROJECT;
+			break;
+		case 'o':
+			kt = LIM_OVERALL;
+			break;
+		default:
+			goto bad;
+	}
+	if (keystr[1] != ':')
+		goto bad;
+	if ((pc = strchr(keystr + 2, ';')) != NULL) {
+		if ((id = entlim_resc_id(pc + 1)) == -1)
+			return;
+		entity = strndup(keystr + 2, pc - keystr - 2);
+	} else
+		entity = strdup(keystr + 2);
+	if (entity == NULL)
+		goto bad;
+
+	if (pctx->ent_idx[kt] == NULL) {
+		if (recptr == NULL) {
+			free(entity);
+			return;
+		}
+		if ((pctx->ent_idx[kt] = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+			free(entity);
+			goto bad;
+		}
+	}
+	if (pbs_idx_find(pctx->ent_idx[kt], (void **)&entity, (void **)&pent, NULL) != PBS_IDX_RET_OK) {
+		if (recptr == NULL) {
+			free(entity);
+			return;
+		}
+		if ((pent = calloc(1, sizeof(entlim_ent))) == NULL ||
+			pbs_idx_insert(pctx->ent_idx[kt], entity, pent) != PBS_IDX_RET_OK) {
+			free(pent);
+			free(entity);
+			goto bad;
+		}
+	}
+	free(entity);
+
+	if (id >= pent->ee_nslots) {
+		if (recptr == NULL)
+			return;
+		n = id + 8;
+		if ((tmp = realloc(pent->ee_slots, n * sizeof(void *))) == NULL)
+			goto bad;
+		memset(tmp + pent->ee_nslots, 0, (n - pent->ee_nslots) * sizeof(void *));
+		pent->ee_slots = tmp;
+		pent->ee_nslots = n;
+	}
+	pent->ee_slots[id] = recptr;
+	return;
+
+bad:
+	ent_ix_drop(pctx);
+	pctx->ent_ix_bad = 1;
+}
+
 /**
  * @brief
  * 	entlim_initialize_ctx - initialize the data context structure
@@ -56,10 +272,9 @@ typedef struct _entlim_ctx {
 void *
 entlim_initialize_ctx(void)
 {
-	entlim_ctx *pctx = malloc(sizeof(entlim_ctx));
+	entlim_ctx *pctx = calloc(1, sizeof(entlim_ctx));
 	if (pctx == NULL)
 		return NULL;
-	pctx->idx_ctx = NULL;
 	pctx->idx = pbs_idx_create(0, 0);
 	if (pctx->idx == NULL) {
 		free(pctx);
@@ -91,6 +306,54 @@ entlim_get(const char *keystr, void *ctx)
 	return NULL;
 }
 
+/**
+ * @brief
+ * 	entlim_get_id - get the record for an entity and resource without
+ *	building its key string: one hash lookup of the entity name and an
+ *	array index by resource id.
+ *
+ * @param[in] ctx - pointer to context
+ * @param[in] kt - key type of the entity
+ * @param[in] entity - entity name
+ * @param[in] rescid - id from entlim_resc_id(), or ENTLIM_RUN_ID for the
+ *		       entity's run limit
+ *
+ * @return	void *
+ * @retval	record	found
+ * @retval	NULL	no such record
+ */
+void *
+entlim_get_id(void *ctx, enum lim_keytypes kt, const char *entity, int rescid)
+{
+	entlim_ctx *pctx = (entlim_ctx *)ctx;
+	entlim_ent *pent;
+	char *kstr;
+	void *rtn;
+
+	if (rescid < 0 || rescid > resc_nids || kt < LIM_USER || kt > LIM_OVERALL)
+		return NULL;
+
+	if (pctx->ent_ix_bad) {
+		/* slow path: the index could not be kept, build the key */
+		if (rescid == ENTLIM_RUN_ID)
+			kstr = entlim_mk_runkey(kt, entity);
+		else
+			kstr = entlim_mk_reskey(kt, entity, resc_names[rescid]);
+		if (kstr == NULL)
+			return NULL;
+		rtn = entlim_get(kstr, ctx);
+		free(kstr);
+		return rtn;
+	}
+
+	if (pctx->ent_idx[kt] == NULL ||
+		pbs_idx_find(pctx->ent_idx[kt], (void **)&entity, (void **)&pent, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	if (rescid >= pent->ee_nslots)
+		return NULL;
+	return pent->ee_slots[rescid];
+}
+
 /**
  * @brief
  * 	entlim_add - add a record with a key based on the key-string
@@ -106,8 +369,12 @@ entlim_get(const char *keystr, void *ctx)
 int
 entlim_add(const char *keystr, const void *recptr, void *ctx)
 {
-	if (pbs_idx_insert(((entlim_ctx *)ctx)->idx, (void *)keystr, (void *)recptr) == PBS_IDX_RET_OK)
+	if (key_resc_intern(keystr) != 0)
+		return -1;
+	if (pbs_idx_insert(((entlim_ctx *)ctx)->idx, (void *)keystr, (void *)recptr) == PBS_IDX_RET_OK) {
+		ent_ix_set((entlim_ctx *)ctx, keystr, (void *)recptr);
 		return 0;
+	}
 	return -1;
 }
 
@@ -133,14 +400,20 @@ entlim_replace(const char *keystr, void *recptr, void *ctx, void fr_leaf(void *)
 	void *olddata;
 	entlim_ctx *pctx = (entlim_ctx *)ctx;
 
-	if (pbs_idx_insert(pctx->idx, (void *)keystr, recptr) == PBS_IDX_RET_OK)
+	if (key_resc_intern(keystr) != 0)
+		return -1;
+	if (pbs_idx_insert(pctx->idx, (void *)keystr, recptr) == PBS_IDX_RET_OK) {
+		ent_ix_set(pctx, keystr, recptr);
 		return 0;
-	else {
+	} else {
 		if (pbs_idx_find(pctx->idx, (void **)&keystr, &olddata, NULL) == PBS_IDX_RET_OK) {
 			if (pbs_idx_delete(pctx->idx, (void *)keystr) == PBS_IDX_RET_OK) {
+				ent_ix_set(pctx, keystr, NULL);
 				fr_leaf(olddata);
-				if (pbs_idx_insert(pctx->idx, (void *)keystr, recptr) == PBS_IDX_RET_OK)
+				if (pbs_idx_insert(pctx->idx, (void *)keystr, recptr) == PBS_IDX_RET_OK) {
+					ent_ix_set(pctx, keystr, recptr);
 					return 0;
+				}
 			}
 		}
 	}
@@ -168,6 +441,7 @@ entlim_delete(const char *keystr, void *ctx, void free_leaf(void *))
 
 	if (pbs_idx_find(((entlim_ctx *)ctx)->idx, (void **)&keystr, &prec, NULL) == PBS_IDX_RET_OK) {
 		if (pbs_idx_delete(((entlim_ctx *)ctx)->idx, (void *)keystr) == PBS_IDX_RET_OK) {
+			ent_ix_set((entlim_ctx *)ctx, keystr, NULL);
 			free_leaf(prec);
 			return 0;
 		}
@@ -245,6 +519,7 @@ entlim_free_ctx(void *ctx, void free_leaf(void *))
 	}
 	pbs_idx_free_ctx(pctx->idx_ctx);
 	pbs_idx_destroy(pctx->idx);
+	ent_ix_drop(pctx);
 	free(pctx);
 	return 0;
 }
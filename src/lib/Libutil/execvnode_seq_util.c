@@ -59,11 +59,18 @@
  *  unrolled_str = unroll_execvnode_seq(condensed_str, &tofree);
  *  ...access an arbitrary, say 2nd occurrence, index via unrolled_str[1]
  *  free_execvnode_seq(tofree);
+ *
+ *  When only some occurrences are needed, get_execvnode_occurrence() copies
+ *  one of them out of the condensed string, and parse_execvnode_seq() gives
+ *  each occurrence as an index into the unique execvnodes, so work done per
+ *  execvnode need not be repeated per occurrence.
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <libutil.h>
 #include <log.h>
+#include <pbs_idx.h>
+#include <ctype.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -119,6 +126,11 @@ new_dictionary()
 		DBPRT(("new_dictionary: %s\n", MALLOC_ERR_MSG))
 		return NULL;
 	}
+	if ((dict->idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+		DBPRT(("new_dictionary: %s\n", MALLOC_ERR_MSG))
+		free(dict);
+		return NULL;
+	}
 	dict->first = NULL;
 	dict->last = NULL;
 	dict->count = 0;
@@ -157,6 +169,7 @@ static struct word *new_word(char *str)
 	}
 	nw->next = NULL;
 	nw->map = NULL;
+	nw->map_last = NULL;
 	nw->count = 0;
 
 	return nw;
@@ -244,7 +257,7 @@ direct_map(dictionary *dict, char *str)
 
 /**
  * @brief
- * 	Find a word in a dictionary.
+ * 	Find a word in a dictionary, through its index of words by name.
  *
  * @param[in] dict - The dictionary in which to search
  * @param[in] str - The string to be found.
@@ -256,7 +269,8 @@ direct_map(dictionary *dict, char *str)
  */
 static struct word *find_word(dictionary *dict, char *str)
 {
-	struct word *cur;
+	struct word *w = NULL;
+	void *key;
 
 	if (dict == NULL || str == NULL)
 		return NULL;
@@ -264,12 +278,11 @@ static struct word *find_word(dictionary *dict, char *str)
 	if (dict->count == 0)
 		return NULL;
 
-	for (cur = dict->first; cur!=NULL; cur = cur->next) {
-		if (!strcmp(cur->name, str))
-			return cur;
-	}
+	key = str;
+	if (pbs_idx_find(dict->idx, &key, (void **)&w, NULL) != PBS_IDX_RET_OK)
+		return NULL;
 
-	return NULL;
+	return w;
 }
 
 /**
@@ -295,6 +308,12 @@ append_to_dict(dictionary *dict, char *str, int val)
 	if (nw == NULL)
 		return;
 
+	if (pbs_idx_insert(dict->idx, nw->name, nw) != PBS_IDX_RET_OK) {
+		free(nw->name);
+		free(nw);
+		return;
+	}
+
 	if (dict->first == NULL) {
 		dict->first = nw;
 		dict->last = nw;
@@ -309,6 +328,8 @@ append_to_dict(dictionary *dict, char *str, int val)
 	if (nw->map == NULL)
 		return;
 
+	nw->map_last = nw->map;
+
 	nw->count++;
 	dict->length += strlen(str);
 	dict->length += MAX_INT_LENGTH;
@@ -330,30 +351,23 @@ static void
 append_to_word(dictionary *dict, struct word *w, int val)
 {
 
-	struct map *m, *tmp;
+	struct map *m;
 
 	if (dict == NULL || w == NULL || val < 0)
 		return;
 
-	m = w->map;
-	tmp = m;
-	if (m == NULL) {
-		m = new_map(val);
+	m = new_map(val);
 
-		if (m == NULL)
-			return;
+	if (m == NULL)
+		return;
 
+	/* indices only grow, so the new one goes after the last */
+	if (w->map_last == NULL)
 		w->map = m;
-	}
-	else {
-		while (tmp->next!=NULL) {
-			tmp = tmp->next;
-		}
-		tmp->next = new_map(val);
+	else
+		w->map_last->next = m;
+	w->map_last = m;
 
-		if (tmp->next == NULL)
-			return;
-	}
 	w->count++;
 	/* MAX_INT_LENGTH is the length of a string representation of an index */
 	dict->length += MAX_INT_LENGTH;
@@ -547,24 +561,11 @@ unroll_execvnode_seq(char *str, char ***tofree)
 int
 get_execvnodes_count(char *str)
 {
-	int count;
-	char *word;
-	char *str_copy;
-
 	if (str == NULL)
 		return 0;
 
-	if ((str_copy = strdup(str)) == NULL)
-		return 0;
-	word = strtok(str_copy, COUNT_TOK);
-
-	if (word == NULL)
-		return 0;
-
-	count = atoi(word);
-	free(str_copy);
-
-	return count;
+	/* the count is the leading number, atoi() stops at COUNT_TOK */
+	return atoi(str);
 }
 
 /**
@@ -589,8 +590,8 @@ static char *
 dict_to_str(dictionary *dict)
 {
 	char *condensed;
+	char *end;	/* end of condensed, where the next part is written */
 	char *tmp;
-	char buf[1024];
 	struct word *w;
 	struct map *m;
 	int prev = 0, first = 0, cur;
@@ -612,19 +613,14 @@ dict_to_str(dictionary *dict)
 	}
 
 	/* Write the number of occurrences followed by COUNT_TOK */
-	sprintf(condensed, "%d%s", dict->max_idx, COUNT_TOK);
+	end = condensed + sprintf(condensed, "%d%s", dict->max_idx, COUNT_TOK);
 
 	m = w->map;
 
 	while (w != NULL) {
-		tmp = strdup(w->name);
-		if (tmp == NULL) {
-			break;
-		}
 		/* Concatenate the vnode followed by the separator
 		 * to start the range */
-		(void) strcat(condensed, tmp);
-		(void) strcat(condensed, WORD_TOK);
+		end += sprintf(end, "%s%s", w->name, WORD_TOK);
 
 		while (m != NULL) {
 			cur = m->val;
@@ -644,20 +640,18 @@ dict_to_str(dictionary *dict)
 			else {
 				/* Concatentate the range */
 				if (first==prev)
-					sprintf(buf, "%d%s", first, MAP_TOK);
+					end += sprintf(end, "%d%s", first, MAP_TOK);
 				else
-					sprintf(buf, "%d%s%d, ", first, RANGE_TOK, prev);
-				(void) strcat(condensed, buf);
+					end += sprintf(end, "%d%s%d, ", first, RANGE_TOK, prev);
 				begin_range=1;
 			}
 
 			prev = cur;
 		}
 		if (first==prev)
-			sprintf(buf, "%d", first);
+			end += sprintf(end, "%d", first);
 		else
-			sprintf(buf, "%d%s%d", first, RANGE_TOK, prev);
-		(void) strcat(condensed, buf);
+			end += sprintf(end, "%d%s%d", first, RANGE_TOK, prev);
 
 		begin_range=1;
 
@@ -665,13 +659,11 @@ dict_to_str(dictionary *dict)
 		if (w != NULL)
 			m = w->map;
 		/* Concatenate the closing separator of the range */
-		strcat(condensed, WORD_MAP_TOK);
-
-		free(tmp);
+		end += sprintf(end, "%s", WORD_MAP_TOK);
 	}
 	/* condensed was malloc'd dict->length which was an "overestimate" of the actual needed memory
 	 * resize to what's actually been used */
-	tmp = realloc(condensed, (strlen(condensed)+1)*sizeof(char));
+	tmp = realloc(condensed, (end - condensed + 1) * sizeof(char));
 	if (tmp == NULL) {
 		free(condensed);
 		DBPRT(("dict_to_str: %s\n", MALLOC_ERR_MSG));
@@ -680,8 +672,6 @@ dict_to_str(dictionary *dict)
 	else
 		condensed = tmp;
 
-	condensed[strlen(condensed)]='\0';
-
 	return condensed;
 }
 
@@ -701,6 +691,7 @@ free_dict(dictionary *dict)
 	if (dict == NULL)
 		return;
 
+	pbs_idx_destroy(dict->idx);
 	w = dict->first;
 
 	if (w == NULL) {
@@ -776,6 +767,231 @@ free_execvnode_seq(char **ptr)
 }
 
 
+/**
+ * @brief
+ * 	Step to the next <vnode>{range} word of a condensed string.
+ *
+ * @param[in]  p - where the word starts
+ * @param[out] name - the execvnode of the word
+ * @param[out] namelen - the length of the execvnode
+ * @param[out] map - the range of the word, up to WORD_MAP_TOK
+ *
+ * @return	char *
+ * @retval	where the following word starts
+ * @retval	NULL	no word is left
+ *
+ */
+static char *
+next_seq_word(char *p, char **name, int *namelen, char **map)
+{
+	char *open;
+	char *close;
+
+	if (p == NULL || *p == '\0')
+		return NULL;
+	if ((open = strchr(p, *WORD_TOK)) == NULL)
+		return NULL;
+	if ((close = strchr(open, *WORD_MAP_TOK)) == NULL)
+		return NULL;
+
+	*name = p;
+	*namelen = open - p;
+	*map = open + 1;
+
+	return close + 1;
+}
+
+/**
+ * @brief
+ * 	Read the next first[-last] indices of the range of a word.
+ *
+ * @param[in]  p - where to read from
+ * @param[out] first - first index
+ * @param[out] last - last index
+ *
+ * @return	char *
+ * @retval	where to read the following indices from
+ * @retval	NULL	the range has no more indices
+ *
+ */
+static char *
+next_seq_range(char *p, int *first, int *last)
+{
+	char *ep;
+
+	while (*p == ' ' || *p == *MAP_TOK)
+		p++;
+	if (!isdigit((int) *p))
+		return NULL;
+
+	*first = (int) strtol(p, &ep, 10);
+	*last = *first;
+	if (*ep == *RANGE_TOK)
+		*last = (int) strtol(ep + 1, &ep, 10);
+
+	return ep;
+}
+
+/**
+ * @brief
+ * 	Copy the execvnode of a single occurrence out of a condensed string,
+ * 	without unrolling the whole sequence.
+ *
+ * @param[in] str - The condensed execvnode sequence, it is not modified
+ * @param[in] idx - The occurrence index, starting at 0
+ *
+ * @return	char *
+ * @retval	a copy of the execvnode, to be freed by the caller
+ * @retval	NULL	if idx is not in the sequence or on malloc error
+ *
+ */
+char *
+get_execvnode_occurrence(char *str, int idx)
+{
+	char *p;
+	char *name;
+	char *map;
+	char *next;
+	char *xc;
+	int len;
+	int first;
+	int last;
+
+	if (str == NULL || idx < 0 || idx >= get_execvnodes_count(str))
+		return NULL;
+
+	if ((p = strchr(str, *COUNT_TOK)) == NULL)
+		return NULL;
+	p++;
+
+	while ((next = next_seq_word(p, &name, &len, &map)) != NULL) {
+		while ((map = next_seq_range(map, &first, &last)) != NULL) {
+			if (idx < first || idx > last)
+				continue;
+			if ((xc = malloc(len + 1)) == NULL) {
+				DBPRT(("get_execvnode_occurrence: %s\n", MALLOC_ERR_MSG));
+				return NULL;
+			}
+			memcpy(xc, name, len);
+			xc[len] = '\0';
+			return xc;
+		}
+		p = next;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 	Parse a condensed string into an execvnode_seq, in which each
+ * 	occurrence refers by index to one of the unique execvnodes.
+ * 	Unlike unroll_execvnode_seq() the string is not modified.
+ *
+ * @param[in] str - The condensed execvnode sequence
+ *
+ * @return	execvnode_seq *
+ * @retval	the parsed sequence, to be freed with free_execvnode_seq_info()
+ * @retval	NULL	on a malformed string or malloc error
+ *
+ */
+execvnode_seq *
+parse_execvnode_seq(char *str)
+{
+	execvnode_seq *seq;
+	char *p;
+	char *name;
+	char *map;
+	char *next;
+	int len;
+	int first;
+	int last;
+	int alloc = 0;
+	int i;
+
+	if (str == NULL || (p = strchr(str, *COUNT_TOK)) == NULL)
+		return NULL;
+	p++;
+
+	if ((seq = calloc(1, sizeof(execvnode_seq))) == NULL) {
+		DBPRT(("parse_execvnode_seq: %s\n", MALLOC_ERR_MSG));
+		return NULL;
+	}
+	seq->count = get_execvnodes_count(str);
+	if (seq->count <= 0 || (seq->occr = malloc(seq->count * sizeof(int))) == NULL) {
+		free(seq);
+		return NULL;
+	}
+	for (i = 0; i < seq->count; i++)
+		seq->occr[i] = -1;
+
+	while ((next = next_seq_word(p, &name, &len, &map)) != NULL) {
+		if (seq->nvnodes == alloc) {
+			char **tmp;
+
+			alloc = alloc ? alloc * 2 : 16;
+			if ((tmp = realloc(seq->vnodes, alloc * sizeof(char *))) == NULL) {
+				DBPRT(("parse_execvnode_seq: %s\n", MALLOC_ERR_MSG));
+				free_execvnode_seq_info(seq);
+				return NULL;
+			}
+			seq->vnodes = tmp;
+		}
+		if ((seq->vnodes[seq->nvnodes] = malloc(len + 1)) == NULL) {
+			DBPRT(("parse_execvnode_seq: %s\n", MALLOC_ERR_MSG));
+			free_execvnode_seq_info(seq);
+			return NULL;
+		}
+		memcpy(seq->vnodes[seq->nvnodes], name, len);
+		seq->vnodes[seq->nvnodes][len] = '\0';
+
+		while ((map = next_seq_range(map, &first, &last)) != NULL) {
+			if (first < 0 || last >= seq->count) {
+				seq->nvnodes++;
+				free_execvnode_seq_info(seq);
+				return NULL;
+			}
+			for (i = first; i <= last; i++)
+				seq->occr[i] = seq->nvnodes;
+		}
+		seq->nvnodes++;
+		p = next;
+	}
+
+	/* every occurrence must have an execvnode */
+	for (i = 0; i < seq->count; i++) {
+		if (seq->occr[i] == -1) {
+			free_execvnode_seq_info(seq);
+			return NULL;
+		}
+	}
+
+	return seq;
+}
+
+/**
+ * @brief
+ * 	Free an execvnode_seq returned by parse_execvnode_seq()
+ *
+ * @param[in] seq - The sequence to free
+ *
+ */
+void
+free_execvnode_seq_info(execvnode_seq *seq)
+{
+	int i;
+
+	if (seq == NULL)
+		return;
+
+	for (i = 0; i < seq->nvnodes; i++)
+		free(seq->vnodes[i]);
+	free(seq->vnodes);
+	free(seq->occr);
+	free(seq);
+}
+
+
 #ifdef DEBUG
 /**
  * @brief
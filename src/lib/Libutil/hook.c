@@ -71,6 +71,7 @@
 #include "tpp.h"
 #include <signal.h>
 #include "hook_func.h"
+#include "mem_acct.h"
 
 
 /**
@@ -537,6 +538,39 @@ hook_fail_action_as_string(unsigned int fail_action)
 	return (fail_actionstr);
 }
 
+/**
+ *
+ * @brief
+ *	Return a comma separated set of strings giving
+ *	the names of job_list_filter bits turned on in 'job_filter'.
+ *
+ * @param[in]	job_filter - input job_list_filter.
+ *
+ * @return char *
+ * @retval <string>	comma-separated job_list_filter names, or "all".
+ *
+ * @note
+ *	This returns a static string that will get overwritten on the
+ *	next call to this function.
+ */
+char *
+hook_job_filter_as_string(unsigned int job_filter)
+{
+	static char filterstr[HOOK_BUF_SIZE];
+
+	filterstr[0] = '\0';
+	if (job_filter & HOOK_JOB_FILTER_STARTED)
+		strcat(filterstr, "," HOOKSTR_JOB_FILTER_STARTED);
+	if (job_filter & HOOK_JOB_FILTER_ENDED)
+		strcat(filterstr, "," HOOKSTR_JOB_FILTER_ENDED);
+	if (job_filter & HOOK_JOB_FILTER_RESC_USED)
+		strcat(filterstr, "," HOOKSTR_JOB_FILTER_RESC_USED);
+
+	if (filterstr[0] == '\0')
+		return (HOOKSTR_JOB_FILTER_ALL);
+	return (filterstr + 1);
+}
+
 /*
  *	Returns the string representation of hook 'order' value.
  */
@@ -2052,6 +2086,85 @@ set_hook_freq(hook *phook, char *newval, char *msg, size_t msg_len)
 
 }
 
+/**
+ * @brief
+ *	Sets the hook 'phook's job_list_filter attribute to a value
+ *	representing 'newval', a comma-separated list of "started", "ended"
+ *	and "resources_used", or "all".
+ *
+ * @param[in/out]	phook - hook being operated on.
+ * @param[in]		newval - the hook job_list_filter value to set to
+ * @param[in/out]	msg - error message buffer
+ * @param[in]		msg_len - size of 'msg' buffer.
+ *
+ * @return int
+ * @retval 0 for success
+ * @retval 1 for failure with 'msg' of size 'msg_len' filled in.
+ */
+int
+set_hook_job_filter(hook *phook, char *newval, char *msg, size_t msg_len)
+{
+	char		*val, *newval_dup;
+	unsigned int	filter = HOOK_JOB_FILTER_ALL;
+	int		all = 0;
+
+	if (msg == NULL) { /* should not happen */
+		log_err(PBSE_INTERNAL, __func__, "'msg' buffer is NULL");
+		return (1);
+	}
+	memset(msg, '\0', msg_len);
+
+	if (phook  == NULL) {
+		snprintf(msg, msg_len-1,
+			"%s: hook parameter is NULL!", __func__);
+		return (1);
+	}
+	if (newval == NULL) {
+		snprintf(msg, msg_len-1,
+			"%s: hook's job_list_filter is NULL!", __func__);
+		return (1);
+	}
+
+	if ((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) == 0) {
+		snprintf(msg, msg_len-1,
+			"%s: Can't set hook job_list_filter value: hook event must contain '%s'",
+			__func__, HOOKSTR_EXECHOST_PERIODIC);
+		return (1);
+	}
+
+	if ((newval_dup = strdup(newval)) == NULL) {
+		snprintf(msg, msg_len-1,
+			"%s: failed to malloc newval=%s!", __func__, newval);
+		return (1);
+	}
+	for (val = strtok(newval_dup, ","); val; val = strtok(NULL, ",")) {
+		if (strcmp(val, HOOKSTR_JOB_FILTER_ALL) == 0)
+			all = 1;
+		else if (strcmp(val, HOOKSTR_JOB_FILTER_STARTED) == 0)
+			filter |= HOOK_JOB_FILTER_STARTED;
+		else if (strcmp(val, HOOKSTR_JOB_FILTER_ENDED) == 0)
+			filter |= HOOK_JOB_FILTER_ENDED;
+		else if (strcmp(val, HOOKSTR_JOB_FILTER_RESC_USED) == 0)
+			filter |= HOOK_JOB_FILTER_RESC_USED;
+		else
+			break;
+	}
+	free(newval_dup);
+
+	/* can't combine "all" with the other job_list_filter values */
+	if ((val != NULL) || (all && (filter != HOOK_JOB_FILTER_ALL))) {
+		snprintf(msg, msg_len-1,
+			"job_list_filter value of a hook "
+			"must be \"%s\" or one or more of \"%s\", \"%s\", \"%s\"",
+			HOOKSTR_JOB_FILTER_ALL, HOOKSTR_JOB_FILTER_STARTED,
+			HOOKSTR_JOB_FILTER_ENDED, HOOKSTR_JOB_FILTER_RESC_USED);
+		return (1);
+	}
+
+	phook->job_filter = filter;
+	return (0);
+}
+
 /*
  *
  * unset_hook* functions.
@@ -2523,6 +2636,38 @@ unset_hook_freq(hook *phook, char *msg, size_t msg_len)
 	return (0);
 }
 
+/**
+ * @brief
+ *	Unsets 'phook's job_list_filter value, resetting back to default.
+ *
+ * @param[in/out]	phook - hook being operated on.
+ * @param[in/out]	msg - error message buffer
+ * @param[in]		msg_len - size of 'msg' buffer.
+ *
+ * @return int
+ * @retval 0 for success
+ * @retval 1 for failure with 'msg' of size 'msg_len' filled in.
+ */
+int
+unset_hook_job_filter(hook *phook, char *msg, size_t msg_len)
+{
+	if (msg == NULL) { /* should not happen */
+		log_err(PBSE_INTERNAL, __func__, "'msg' buffer is NULL");
+		return (1);
+	}
+	memset(msg, '\0', msg_len);
+
+	if (phook == NULL) {
+		snprintf(msg, msg_len-1,
+			"%s: hook parameter is NULL", __func__);
+		return (1);
+	}
+
+	phook->job_filter = HOOK_JOB_FILTER_DEFAULT;
+
+	return (0);
+}
+
 /**
  *
  * @brief
@@ -2545,6 +2690,8 @@ hook_init(hook *phook, void (*pyfree_func)(struct python_script *))
 	phook->order = HOOK_ORDER_DEFAULT;
 	phook->alarm = HOOK_ALARM_DEFAULT;
 	phook->freq = HOOK_FREQ_DEFAULT;
+	phook->job_filter = HOOK_JOB_FILTER_DEFAULT;
+	phook->job_seq = 0;
 	phook->pending_delete = HOOK_PENDING_DELETE_DEFAULT;
 
 	if (phook->script != NULL) {
@@ -2580,6 +2727,7 @@ hook_alloc(void)
 		return NULL;
 	}
 	(void)memset((char *)phook, (int)0, (size_t)sizeof(hook));
+	mem_acct_add(MEM_ACCT_HOOK, 1, sizeof(hook));
 
 	phook->hook_name = NULL;
 
@@ -2610,7 +2758,121 @@ hook_free(hook *phook, void (*pyfree_func)(struct python_script *))
 	phook->hook_name = NULL;
 	hook_init(phook, pyfree_func);
 
+	free(phook->run_stats);
 	free(phook);	/* now free the main structure */
+	mem_acct_add(MEM_ACCT_HOOK, -1, -(long long)sizeof(hook));
+}
+
+/**
+ * @brief
+ *	Account for one run of 'phook' servicing 'event'.
+ *
+ * @param[in/out] phook   - the hook that ran.
+ * @param[in]	  event   - the HOOK_EVENT_* serviced.
+ * @param[in]	  walltime - how long the run took, in seconds.
+ * @param[in]	  outcome - HOOK_RUN_ACCEPT, HOOK_RUN_REJECT or HOOK_RUN_ALARM.
+ */
+void
+hook_stats_record(hook *phook, unsigned int event, double walltime, int outcome)
+{
+	struct hook_run_stats *hs;
+	double limit;
+	int i;
+
+	if ((phook == NULL) || (event == 0))
+		return;
+
+	if (phook->run_stats == NULL) {
+		phook->run_stats = calloc(HOOK_STAT_EVENTS, sizeof(struct hook_run_stats));
+		if (phook->run_stats == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return;
+		}
+	}
+
+	for (i = 0; !(event & (1U << i)); i++)
+		;
+	hs = &phook->run_stats[i];
+
+	hs->hs_runs++;
+	if (outcome == HOOK_RUN_REJECT)
+		hs->hs_rejects++;
+	else if (outcome == HOOK_RUN_ALARM)
+		hs->hs_alarms++;
+	if (walltime < 0)
+		walltime = 0;
+	hs->hs_walltime += walltime;
+
+	limit = 0.001;
+	for (i = 0; (i < HOOK_STAT_BUCKETS - 1) && (walltime >= limit); i++)
+		limit *= 2;
+	hs->hs_hist[i]++;
+}
+
+/**
+ * @brief
+ *	Returns the string representation of the run statistics of 'phook',
+ *	one entry per event type it ran for, separated by spaces:
+ *	<event>:runs=<n>,rejects=<n>,alarms=<n>,total=<s>,avg=<s>,p99=<s>
+ *
+ * @note
+ *	p99 is the upper bound of the histogram bucket holding the 99th
+ *	percentile run time. The returned string is in a static buffer.
+ *
+ * @return char *
+ * @retval <string>	- possibly empty if the hook never ran
+ * @retval NULL		- out of memory
+ */
+char *
+hook_stats_as_string(hook *phook)
+{
+	static char *stats_str = NULL;
+	static int stats_sz = 0;
+	struct hook_run_stats *hs;
+	char entry[HOOK_BUF_SIZE];
+	unsigned long want;
+	unsigned long seen;
+	double limit;
+	int i;
+	int j;
+
+	if (stats_str == NULL) {
+		stats_sz = HOOK_BUF_SIZE;
+		if ((stats_str = malloc(stats_sz)) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return NULL;
+		}
+	}
+	stats_str[0] = '\0';
+
+	if (phook->run_stats == NULL)
+		return stats_str;
+
+	for (i = 0; i < HOOK_STAT_EVENTS; i++) {
+		hs = &phook->run_stats[i];
+		if (hs->hs_runs == 0)
+			continue;
+
+		want = hs->hs_runs - hs->hs_runs / 100;
+		seen = 0;
+		limit = 0.001;
+		for (j = 0; j < HOOK_STAT_BUCKETS - 1; j++) {
+			seen += hs->hs_hist[j];
+			if (seen >= want)
+				break;
+			limit *= 2;
+		}
+
+		snprintf(entry, sizeof(entry),
+			"%s%s:runs=%lu,rejects=%lu,alarms=%lu,total=%.3f,avg=%.3f,p99=%.3f",
+			(stats_str[0] != '\0') ? " " : "",
+			hook_event_as_string(1U << i), hs->hs_runs, hs->hs_rejects,
+			hs->hs_alarms, hs->hs_walltime,
+			hs->hs_walltime / hs->hs_runs, limit);
+		if (pbs_strcat(&stats_str, &stats_sz, entry) == NULL)
+			return NULL;
+	}
+	return stats_str;
 }
 
 /**
@@ -2881,6 +3143,10 @@ hook_save(hook *phook)
 		fprintf(hkfp, "%s=%s\n", HOOKATT_FREQ,
 			hook_freq_as_string(phook->freq));
 
+	if (phook->job_filter != HOOK_JOB_FILTER_DEFAULT)
+		fprintf(hkfp, "%s=%s\n", HOOKATT_JOB_FILTER,
+			hook_job_filter_as_string(phook->job_filter));
+
 	/* need to save on disk that the hook is pending to be deleted */
 	if (phook->pending_delete != HOOK_PENDING_DELETE_DEFAULT) {
 		fprintf(hkfp, "%s=%d\n", "pending_delete", phook->pending_delete);
@@ -3451,7 +3717,7 @@ print_hook(hook	*phook, char *heading)
 
 	snprintf(log_buffer, sizeof(log_buffer),
 		"%s = {%s, %s=%d, %s=%d, %s=%d %s=%d, "
-		"%s=(%d) %s=(%d), %s=(%s), %s=%d, %s=%d}",
+		"%s=(%d) %s=(%d), %s=(%s), %s=%d, %s=%d, %s=%s}",
 		heading, phook->hook_name?phook->hook_name:"",
 		HOOKATT_ORDER, phook->order,
 		HOOKATT_TYPE, phook->type,
@@ -3461,7 +3727,8 @@ print_hook(hook	*phook, char *heading)
 		HOOKATT_FAIL_ACTION, phook->fail_action,
 		HOOKATT_EVENT, hook_event_as_string(phook->event),
 		HOOKATT_ALARM, phook->alarm,
-		HOOKATT_FREQ, phook->freq);
+		HOOKATT_FREQ, phook->freq,
+		HOOKATT_JOB_FILTER, hook_job_filter_as_string(phook->job_filter));
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_HOOK,
 		LOG_INFO, __func__, log_buffer);
 
@@ -3826,6 +4093,9 @@ hook_recov(char	*filename, FILE	*hookfp, char *msg, size_t msg_len,
 		} else if (strcmp(attname, HOOKATT_FREQ) == 0) {
 			if (set_hook_freq(phook, attval, msg, msg_len) != 0)
 				goto hook_recov_error;
+		} else if (strcmp(attname, HOOKATT_JOB_FILTER) == 0) {
+			if (set_hook_job_filter(phook, attval, msg, msg_len) != 0)
+				goto hook_recov_error;
 		} else if (strcmp(attname, HOOKATT_PENDING_DELETE) == 0) {
 			phook->pending_delete = atoi(attval);
 		} else {
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	mem_acct.c
+ *
+ * @brief
+ *	Counts of live objects and their bytes per kind, see mem_acct.h.
+ *
+ * Included public functions are:
+ *	mem_acct_add()
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include "mem_acct.h"
+
+struct mem_acct mem_acct[MEM_ACCT_KINDS];
+
+const char *mem_acct_names[MEM_ACCT_KINDS] = {
+	"jobs",
+	"svrattrl",
+	"work_tasks",
+	"hooks",
+	"dis_buffers",
+	"batch_requests"
+};
+
+/**
+ * @brief
+ *	Account for objects of a kind being allocated or freed.
+ *
+ * @param[in]	kind	- kind of the objects
+ * @param[in]	nobj	- number of objects allocated, negative when freed
+ * @param[in]	nbytes	- bytes allocated, negative when given back
+ *
+ * @return void
+ */
+void
+mem_acct_add(enum mem_acct_kind kind, long nobj, long long nbytes)
+{
+	struct mem_acct *ma = &mem_acct[kind];
+
+	ma->ma_count += nobj;
+	ma->ma_bytes += nbytes;
+	if (nobj > 0)
+		ma->ma_allocs += nobj;
+	if (ma->ma_bytes > ma->ma_peak)
+		ma->ma_peak = ma->ma_bytes;
+}
@@ -229,6 +229,92 @@ get_occurrence(char *rrule, time_t dtstart, char *tz, int idx)
 #endif
 }
 
+/**
+ * @brief
+ * 	Get the first occurrences defined by the given recurrence rule and
+ * 	start time in one pass over the recurrence.  occr_arr[i] is set to
+ * 	what get_occurrence() returns for index i + 1.
+ *
+ * @param[in] rrule - The recurrence rule as defined by the user
+ * @param[in] dtstart - The start time from which to start
+ * @param[in] tz - The timezone associated to the recurrence rule
+ * @param[in] num_occr - The number of occurrences to get
+ * @param[out] occr_arr - The occurrence start times, num_occr entries
+ *
+ * @return	int
+ * @retval	num_occr
+ * @retval	-1	: on error
+ *
+ */
+int
+get_occurrences(char *rrule, time_t dtstart, char *tz, int num_occr, time_t *occr_arr)
+{
+	int i;
+#ifdef LIBICAL
+	struct icalrecurrencetype rt;
+	struct icaltimetype start;
+	icaltimezone *localzone = NULL;
+	struct icaltimetype next;
+	struct icaltimetype occr;
+	struct icalrecur_iterator_impl *itr;
+#endif
+
+	if (num_occr < 0 || (num_occr > 0 && occr_arr == NULL))
+		return -1;
+
+#ifdef LIBICAL
+	if (rrule != NULL && tz != NULL) {
+		icalerror_clear_errno();
+
+		icalerror_set_error_state(ICAL_PARSE_ERROR, ICAL_ERROR_NONFATAL);
+#ifdef LIBICAL_API2
+		icalerror_set_errors_are_fatal(0);
+#else
+		icalerror_errors_are_fatal = 0;
+#endif
+		localzone = icaltimezone_get_builtin_timezone(tz);
+	}
+
+	if (rrule == NULL) {
+		for (i = 0; i < num_occr; i++)
+			occr_arr[i] = dtstart;
+		return num_occr;
+	}
+
+	if (tz == NULL || localzone == NULL) {
+		for (i = 0; i < num_occr; i++)
+			occr_arr[i] = -1;
+		return num_occr;
+	}
+
+	rt = icalrecurrencetype_from_string(rrule);
+
+	start = icaltime_from_timet_with_zone(dtstart, 0, NULL);
+	icaltimezone_convert_time(&start, icaltimezone_get_utc_timezone(), localzone);
+	next = start;
+
+	itr = (struct icalrecur_iterator_impl*) icalrecur_iterator_new(rt, start);
+	for (i = 0; i < num_occr; i++) {
+		if (!icaltime_is_null_time(next))
+			next = icalrecur_iterator_next(itr);
+
+		if (!icaltime_is_null_time(next)) {
+			occr = next;
+			icaltimezone_convert_time(&occr, localzone,
+				icaltimezone_get_utc_timezone());
+			occr_arr[i] = icaltime_as_timet(occr);
+		} else
+			occr_arr[i] = -1; /* reached end of possible date-time */
+	}
+	icalrecur_iterator_free(itr);
+#else
+	for (i = 0; i < num_occr; i++)
+		occr_arr[i] = dtstart;
+#endif
+
+	return num_occr;
+}
+
 /**
  * @brief
  * 	Check if a recurrence rule is valid and consistent.
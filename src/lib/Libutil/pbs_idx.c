@@ -39,16 +39,287 @@
 
 #include "pbs_idx.h"
 #include "avltree.h"
+#include <ctype.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+
+#define IDX_TYPE_AVL   0 /* ordered index, AVL tree */
+#define IDX_TYPE_HASH  1 /* unordered index, open addressing hash table */
+
+#define HASH_MIN_SIZE  64 /* initial number of slots, must be a power of 2 */
+
+/* marks a slot whose entry was deleted, so probing goes on past it */
+static char hash_deleted;
+#define HASH_DELETED ((void *) &hash_deleted)
+
+/* one slot of the hash table */
+typedef struct _hash_slot {
+	void *key;	   /* copy of the key, NULL if empty or HASH_DELETED */
+	void *data;	   /* data of entry */
+	unsigned int hash; /* cached hash of key */
+} hash_slot;
+
+/* hash table used for indexes created with PBS_IDX_HASH */
+typedef struct _hash_tbl {
+	int flags;	   /* index flags */
+	int keylen;	   /* zero for null-terminated strings */
+	size_t size;	   /* number of slots, a power of 2 */
+	size_t used;	   /* number of live entries */
+	size_t filled;	   /* number of live and deleted entries */
+	hash_slot *slots;
+} hash_tbl;
+
+/* index structure, opaque to application */
+typedef struct _pbs_idx {
+	int type; /* IDX_TYPE_AVL or IDX_TYPE_HASH */
+	union {
+		AVL_IX_DESC avl;
+		hash_tbl hash;
+	} u;
+} pbs_idx;
 
 /* iteration context structure, opaque to application */
 typedef struct _iter_ctx {
-	AVL_IX_DESC *idx; /* pointer to idx */
-	AVL_IX_REC *pkey; /* pointer to key used while iteration */
+	pbs_idx *idx;	  /* pointer to idx */
+	AVL_IX_REC *pkey; /* pointer to key used while iteration (AVL) */
+	size_t slot;	  /* current slot (hash) */
 } iter_ctx;
 
+/**
+ * @brief
+ *	compute the hash of a key, FNV-1a
+ *
+ * @param[in] - ht  - hash table
+ * @param[in] - key - key to hash
+ *
+ * @return unsigned int
+ *
+ */
+static unsigned int
+hash_key(hash_tbl *ht, void *key)
+{
+	unsigned char *p = (unsigned char *) key;
+	unsigned int h = 2166136261U;
+	int i;
+
+	if (ht->keylen != 0) {
+		for (i = 0; i < ht->keylen; i++) {
+			h ^= p[i];
+			h *= 16777619U;
+		}
+	} else if (ht->flags & PBS_IDX_ICASE_CMP) {
+		for (; *p; p++) {
+			h ^= (unsigned char) tolower(*p);
+			h *= 16777619U;
+		}
+	} else {
+		for (; *p; p++) {
+			h ^= *p;
+			h *= 16777619U;
+		}
+	}
+	return h;
+}
+
+/**
+ * @brief
+ *	compare a key with the key held in a slot
+ *
+ * @param[in] - ht   - hash table
+ * @param[in] - slot - slot holding a live entry
+ * @param[in] - key  - key to compare
+ * @param[in] - hash - hash of key
+ *
+ * @return int
+ * @retval 1 - same key
+ * @retval 0 - different key
+ *
+ */
+static int
+hash_match(hash_tbl *ht, hash_slot *slot, void *key, unsigned int hash)
+{
+	if (slot->hash != hash)
+		return 0;
+	if (ht->keylen != 0)
+		return memcmp(slot->key, key, ht->keylen) == 0;
+	if (ht->flags & PBS_IDX_ICASE_CMP)
+		return strcasecmp(slot->key, key) == 0;
+	return strcmp(slot->key, key) == 0;
+}
+
+/**
+ * @brief
+ *	find the slot of a key
+ *
+ * @param[in] - ht   - hash table
+ * @param[in] - key  - key to find
+ * @param[in] - hash - hash of key
+ *
+ * @return hash_slot *
+ * @retval !NULL - slot holding key
+ * @retval NULL  - key not in table
+ *
+ */
+static hash_slot *
+hash_lookup(hash_tbl *ht, void *key, unsigned int hash)
+{
+	size_t mask = ht->size - 1;
+	size_t i = hash & mask;
+	hash_slot *slot;
+
+	while ((slot = &ht->slots[i])->key != NULL) {
+		if (slot->key != HASH_DELETED && hash_match(ht, slot, key, hash))
+			return slot;
+		i = (i + 1) & mask;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ *	rebuild the table with nsize slots, dropping deleted entries
+ *
+ * @param[in] - ht    - hash table
+ * @param[in] - nsize - new number of slots, a power of 2
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure
+ *
+ */
+static int
+hash_resize(hash_tbl *ht, size_t nsize)
+{
+	hash_slot *nslots;
+	size_t i;
+	size_t j;
+
+	nslots = calloc(nsize, sizeof(hash_slot));
+	if (nslots == NULL)
+		return PBS_IDX_RET_FAIL;
+
+	for (i = 0; i < ht->size; i++) {
+		hash_slot *slot = &ht->slots[i];
+
+		if (slot->key == NULL || slot->key == HASH_DELETED)
+			continue;
+		j = slot->hash & (nsize - 1);
+		while (nslots[j].key != NULL)
+			j = (j + 1) & (nsize - 1);
+		nslots[j] = *slot;
+	}
+	free(ht->slots);
+	ht->slots = nslots;
+	ht->size = nsize;
+	ht->filled = ht->used;
+	return PBS_IDX_RET_OK;
+}
+
+/**
+ * @brief
+ *	add entry in hash table
+ *
+ * @param[in] - ht   - hash table
+ * @param[in] - key  - key of entry
+ * @param[in] - data - data of entry
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure, or key already in table
+ *
+ */
+static int
+hash_insert(hash_tbl *ht, void *key, void *data)
+{
+	unsigned int hash = hash_key(ht, key);
+	hash_slot *slot;
+	hash_slot *free_slot = NULL;
+	size_t mask;
+	size_t i;
+	void *kcopy;
+
+	/* keep at most 3/4 of the slots in use, live or deleted */
+	if ((ht->filled + 1) * 4 > ht->size * 3) {
+		size_t nsize = ht->size;
+
+		while ((ht->used + 1) * 2 > nsize)
+			nsize *= 2;
+		if (hash_resize(ht, nsize) != PBS_IDX_RET_OK)
+			return PBS_IDX_RET_FAIL;
+	}
+
+	mask = ht->size - 1;
+	i = hash & mask;
+	while ((slot = &ht->slots[i])->key != NULL) {
+		if (slot->key == HASH_DELETED) {
+			if (free_slot == NULL)
+				free_slot = slot;
+		} else if (hash_match(ht, slot, key, hash))
+			return PBS_IDX_RET_FAIL;
+		i = (i + 1) & mask;
+	}
+
+	if (ht->keylen != 0) {
+		if ((kcopy = malloc(ht->keylen)) != NULL)
+			memcpy(kcopy, key, ht->keylen);
+	} else
+		kcopy = strdup((char *) key);
+	if (kcopy == NULL)
+		return PBS_IDX_RET_FAIL;
+
+	if (free_slot == NULL) {
+		free_slot = slot;
+		ht->filled++;
+	}
+	free_slot->key = kcopy;
+	free_slot->data = data;
+	free_slot->hash = hash;
+	ht->used++;
+	return PBS_IDX_RET_OK;
+}
+
+/**
+ * @brief
+ *	delete the entry held in a slot
+ *
+ * @param[in] - ht   - hash table
+ * @param[in] - slot - slot holding a live entry
+ *
+ * @return void
+ *
+ */
+static void
+hash_remove(hash_tbl *ht, hash_slot *slot)
+{
+	free(slot->key);
+	slot->key = HASH_DELETED;
+	slot->data = NULL;
+	ht->used--;
+}
+
+/**
+ * @brief
+ *	return the first live slot at or after slot i
+ *
+ * @param[in] - ht - hash table
+ * @param[in] - i  - slot to start from
+ *
+ * @return size_t
+ * @retval index of slot, ht->size if there is none
+ *
+ */
+static size_t
+hash_next(hash_tbl *ht, size_t i)
+{
+	for (; i < ht->size; i++) {
+		if (ht->slots[i].key != NULL && ht->slots[i].key != HASH_DELETED)
+			break;
+	}
+	return i;
+}
+
 /**
  * @brief
  *	Create an empty index
@@ -60,17 +331,37 @@ typedef struct _iter_ctx {
  * @retval !NULL - success
  * @retval NULL  - failure
  *
+ * @note
+ *	PBS_IDX_HASH is ignored when PBS_IDX_DUPS_OK is set, duplicate keys
+ *	need the ordered index.
+ *
  */
 void *
 pbs_idx_create(int flags, int keylen)
 {
-	void *idx = NULL;
+	pbs_idx *idx = NULL;
 
-	idx = malloc(sizeof(AVL_IX_DESC));
+	idx = malloc(sizeof(pbs_idx));
 	if (idx == NULL)
 		return NULL;
 
-	if (avl_create_index(idx, flags, keylen)) {
+	if ((flags & PBS_IDX_HASH) && !(flags & PBS_IDX_DUPS_OK)) {
+		idx->type = IDX_TYPE_HASH;
+		idx->u.hash.flags = flags;
+		idx->u.hash.keylen = keylen;
+		idx->u.hash.size = HASH_MIN_SIZE;
+		idx->u.hash.used = 0;
+		idx->u.hash.filled = 0;
+		idx->u.hash.slots = calloc(HASH_MIN_SIZE, sizeof(hash_slot));
+		if (idx->u.hash.slots == NULL) {
+			free(idx);
+			return NULL;
+		}
+		return idx;
+	}
+
+	idx->type = IDX_TYPE_AVL;
+	if (avl_create_index(&idx->u.avl, flags & ~PBS_IDX_HASH, keylen)) {
 		free(idx);
 		return NULL;
 	}
@@ -90,9 +381,20 @@ pbs_idx_create(int flags, int keylen)
 void
 pbs_idx_destroy(void *idx)
 {
-	if (idx != NULL) {
-		avl_destroy_index(idx);
-		free(idx);
+	pbs_idx *pidx = (pbs_idx *) idx;
+
+	if (pidx != NULL) {
+		if (pidx->type == IDX_TYPE_HASH) {
+			size_t i;
+
+			for (i = 0; i < pidx->u.hash.size; i++) {
+				if (pidx->u.hash.slots[i].key != HASH_DELETED)
+					free(pidx->u.hash.slots[i].key);
+			}
+			free(pidx->u.hash.slots);
+		} else
+			avl_destroy_index(&pidx->u.avl);
+		free(pidx);
 		idx = NULL;
 	}
 }
@@ -113,17 +415,21 @@ pbs_idx_destroy(void *idx)
 int
 pbs_idx_insert(void *idx, void *key, void *data)
 {
+	pbs_idx *pidx = (pbs_idx *) idx;
 	AVL_IX_REC *pkey;
 
-	if (idx == NULL || key == NULL)
+	if (pidx == NULL || key == NULL)
 		return PBS_IDX_RET_FAIL;
 
-	pkey = avlkey_create(idx, key);
+	if (pidx->type == IDX_TYPE_HASH)
+		return hash_insert(&pidx->u.hash, key, data);
+
+	pkey = avlkey_create(&pidx->u.avl, key);
 	if (pkey == NULL)
 		return PBS_IDX_RET_FAIL;
 
 	pkey->recptr = data;
-	if (avl_add_key(pkey, idx) != AVL_IX_OK) {
+	if (avl_add_key(pkey, &pidx->u.avl) != AVL_IX_OK) {
 		free(pkey);
 		return PBS_IDX_RET_FAIL;
 	}
@@ -146,17 +452,27 @@ pbs_idx_insert(void *idx, void *key, void *data)
 int
 pbs_idx_delete(void *idx, void *key)
 {
+	pbs_idx *pidx = (pbs_idx *) idx;
 	AVL_IX_REC *pkey;
 
-	if (idx == NULL || key == NULL)
+	if (pidx == NULL || key == NULL)
 		return PBS_IDX_RET_FAIL;
 
-	pkey = avlkey_create(idx, key);
+	if (pidx->type == IDX_TYPE_HASH) {
+		hash_slot *slot;
+
+		slot = hash_lookup(&pidx->u.hash, key, hash_key(&pidx->u.hash, key));
+		if (slot != NULL)
+			hash_remove(&pidx->u.hash, slot);
+		return PBS_IDX_RET_OK;
+	}
+
+	pkey = avlkey_create(&pidx->u.avl, key);
 	if (pkey == NULL)
 		return PBS_IDX_RET_FAIL;
 
 	pkey->recptr = NULL;
-	avl_delete_key(pkey, idx);
+	avl_delete_key(pkey, &pidx->u.avl);
 	free(pkey);
 	return PBS_IDX_RET_OK;
 }
@@ -178,10 +494,82 @@ pbs_idx_delete_byctx(void *ctx)
 {
 	iter_ctx *pctx = (iter_ctx *) ctx;
 
-	if (pctx == NULL || pctx->idx == NULL || pctx->pkey == NULL)
+	if (pctx == NULL || pctx->idx == NULL)
+		return PBS_IDX_RET_FAIL;
+
+	if (pctx->idx->type == IDX_TYPE_HASH) {
+		hash_tbl *ht = &pctx->idx->u.hash;
+
+		if (pctx->slot >= ht->size || ht->slots[pctx->slot].key == NULL ||
+		    ht->slots[pctx->slot].key == HASH_DELETED)
+			return PBS_IDX_RET_FAIL;
+		hash_remove(ht, &ht->slots[pctx->slot]);
+		return PBS_IDX_RET_OK;
+	}
+
+	if (pctx->pkey == NULL)
 		return PBS_IDX_RET_FAIL;
 
-	avl_delete_key(pctx->pkey, pctx->idx);
+	avl_delete_key(pctx->pkey, &pctx->idx->u.avl);
+	return PBS_IDX_RET_OK;
+}
+
+/**
+ * @brief
+ *	find or iterate entry in a hash index, see pbs_idx_find()
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure
+ *
+ */
+static int
+hash_find(pbs_idx *pidx, void **key, void **data, void **ctx)
+{
+	hash_tbl *ht = &pidx->u.hash;
+	iter_ctx *pctx;
+	size_t i;
+
+	*data = NULL;
+
+	if (ctx != NULL && *ctx != NULL) {
+		pctx = (iter_ctx *) *ctx;
+		if (key)
+			*key = NULL;
+		if (pctx->idx != pidx)
+			return PBS_IDX_RET_FAIL;
+		i = hash_next(ht, pctx->slot + 1);
+	} else if (key != NULL && *key != NULL) {
+		hash_slot *slot;
+
+		slot = hash_lookup(ht, *key, hash_key(ht, *key));
+		if (slot == NULL)
+			return PBS_IDX_RET_FAIL;
+		i = slot - ht->slots;
+	} else
+		i = hash_next(ht, 0);
+
+	if (i >= ht->size) {
+		if (ctx != NULL && *ctx != NULL)
+			((iter_ctx *) *ctx)->slot = ht->size;
+		return PBS_IDX_RET_FAIL;
+	}
+
+	*data = ht->slots[i].data;
+	if (key != NULL && *key == NULL)
+		*key = ht->slots[i].key;
+
+	if (ctx != NULL) {
+		if (*ctx == NULL) {
+			pctx = (iter_ctx *) malloc(sizeof(iter_ctx));
+			if (pctx == NULL)
+				return PBS_IDX_RET_FAIL;
+			pctx->idx = pidx;
+			pctx->pkey = NULL;
+			*ctx = (void *) pctx;
+		}
+		((iter_ctx *) *ctx)->slot = i;
+	}
 	return PBS_IDX_RET_OK;
 }
 
@@ -211,13 +599,17 @@ pbs_idx_delete_byctx(void *ctx)
 int
 pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 {
+	pbs_idx *pidx = (pbs_idx *) idx;
 	iter_ctx *pctx;
 	AVL_IX_REC *pkey;
 	int rc = AVL_IX_FAIL;
 
-	if (idx == NULL || data == NULL)
+	if (pidx == NULL || data == NULL)
 		return PBS_IDX_RET_FAIL;
 
+	if (pidx->type == IDX_TYPE_HASH)
+		return hash_find(pidx, key, data, ctx);
+
 	if (ctx != NULL && *ctx != NULL) {
 		pctx = (iter_ctx *) *ctx;
 
@@ -225,10 +617,10 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 		if (key)
 			*key = NULL;
 
-		if (pctx->idx != idx || pctx->pkey == NULL)
+		if (pctx->idx != pidx || pctx->pkey == NULL)
 			return PBS_IDX_RET_FAIL;
 
-		if (avl_next_key(pctx->pkey, pctx->idx) != AVL_IX_OK)
+		if (avl_next_key(pctx->pkey, &pidx->u.avl) != AVL_IX_OK)
 			return PBS_IDX_RET_FAIL;
 
 		*data = pctx->pkey->recptr;
@@ -238,15 +630,15 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 		return PBS_IDX_RET_OK;
 	} else {
 		*data = NULL;
-		pkey = avlkey_create(idx, key ? *key : NULL);
+		pkey = avlkey_create(&pidx->u.avl, key ? *key : NULL);
 		if (pkey == NULL)
 			return PBS_IDX_RET_FAIL;
 
 		if (key != NULL && *key != NULL) {
-			rc = avl_find_key(pkey, idx);
+			rc = avl_find_key(pkey, &pidx->u.avl);
 		} else {
-			avl_first_key(idx);
-			rc = avl_next_key(pkey, idx);
+			avl_first_key(&pidx->u.avl);
+			rc = avl_next_key(pkey, &pidx->u.avl);
 		}
 
 		if (rc == AVL_IX_OK) {
@@ -259,8 +651,9 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 					free(pkey);
 					return PBS_IDX_RET_FAIL;
 				}
-				pctx->idx = idx;
+				pctx->idx = pidx;
 				pctx->pkey = pkey;
+				pctx->slot = 0;
 				*ctx = (void *) pctx;
 
 				return PBS_IDX_RET_OK;
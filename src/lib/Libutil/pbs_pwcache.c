@@ -0,0 +1,558 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	pbs_pwcache.c
+ * @brief
+ *	Time bounded cache in front of the passwd and group name service
+ *	lookups made by the daemons, see pbs_pwcache.h.
+ */
+
+#include <pbs_config.h>
+
+#ifndef WIN32
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <pwd.h>
+#include <grp.h>
+#include "list_link.h"
+#include "pbs_idx.h"
+#include "pbs_pwcache.h"
+#endif
+
+long pwcache_ttl = PWCACHE_TTL_DFLT;
+long pwcache_neg_ttl = PWCACHE_NEG_TTL_DFLT;
+
+#ifndef WIN32
+
+#define PWC_KEYLEN 280
+#define PWC_MAXGROUPS 65536
+
+/*
+ * errno values left by getpw*()/getgr*() when the entry simply does not
+ * exist, anything else is a failure of the name service
+ */
+#define PWC_NOTFOUND(e) ((e) == 0 || (e) == ENOENT || (e) == ESRCH || \
+			 (e) == EBADF || (e) == EPERM)
+
+struct pwc_entry {
+	pbs_list_link	pe_link;
+	time_t		pe_expire;	/* entry is fresh until then */
+	time_t		pe_stale;	/* may be served on errors until then */
+	int		pe_found;	/* 0 if a negative entry */
+	union {
+		struct passwd	pw;
+		struct group	gr;
+		struct {
+			gid_t	*gl_list;
+			int	gl_num;
+		} gl;
+	} pe_u;
+	void		*pe_buf;	/* strings and arrays of the entry */
+	char		pe_key[PWC_KEYLEN];
+};
+
+static void *pwc_idx = NULL;
+static pbs_list_head pwc_list;
+static int pwc_count = 0;
+
+/**
+ * @brief
+ *	Remove an entry from the cache and free it.
+ *
+ * @param[in]	pe - entry to remove
+ *
+ * @return void
+ */
+static void
+pwc_remove(struct pwc_entry *pe)
+{
+	pbs_idx_delete(pwc_idx, pe->pe_key);
+	delete_link(&pe->pe_link);
+	free(pe->pe_buf);
+	free(pe);
+	pwc_count--;
+}
+
+/**
+ * @brief
+ *	Find the entry of 'key' in the cache.
+ *
+ * @param[in]	key - key of the entry
+ *
+ * @return struct pwc_entry *
+ * @retval	entry	- found
+ * @retval	NULL	- not cached
+ */
+static struct pwc_entry *
+pwc_find(char *key)
+{
+	struct pwc_entry *pe = NULL;
+
+	if (pwc_idx == NULL)
+		return NULL;
+	if (pbs_idx_find(pwc_idx, (void **) &key, (void **) &pe, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	return pe;
+}
+
+/**
+ * @brief
+ *	Get the entry of 'key' ready to store a new lookup result.
+ *	An existing entry is emptied and reused so the cache never holds two
+ *	entries for the same key.  When the cache is full the expired entries
+ *	are dropped first; entries in use are never evicted, as callers may
+ *	still hold pointers into them.
+ *
+ * @param[in]	key - key of the entry
+ * @param[in]	pe - existing entry of 'key', NULL if none
+ * @param[in]	found - 1 if the lookup found the entry, 0 if not
+ * @param[in]	now - current time
+ *
+ * @return struct pwc_entry *
+ * @retval	entry	- to be filled by the caller if 'found'
+ * @retval	NULL	- the result cannot be cached
+ */
+static struct pwc_entry *
+pwc_store(char *key, struct pwc_entry *pe, int found, time_t now)
+{
+	long ttl;
+
+	if (pe == NULL) {
+		if (pwc_idx == NULL) {
+			pwc_idx = pbs_idx_create(PBS_IDX_HASH, 0);
+			if (pwc_idx == NULL)
+				return NULL;
+			CLEAR_HEAD(pwc_list);
+		}
+		if (pwc_count >= PWCACHE_MAX_ENTRIES) {
+			struct pwc_entry *next;
+
+			pe = (struct pwc_entry *) GET_NEXT(pwc_list);
+			while (pe != NULL) {
+				next = (struct pwc_entry *) GET_NEXT(pe->pe_link);
+				if (pe->pe_stale <= now)
+					pwc_remove(pe);
+				pe = next;
+			}
+			if (pwc_count >= PWCACHE_MAX_ENTRIES)
+				return NULL;
+		}
+		pe = calloc(1, sizeof(struct pwc_entry));
+		if (pe == NULL)
+			return NULL;
+		strcpy(pe->pe_key, key);
+		if (pbs_idx_insert(pwc_idx, pe->pe_key, pe) != PBS_IDX_RET_OK) {
+			free(pe);
+			return NULL;
+		}
+		CLEAR_LINK(pe->pe_link);
+		append_link(&pwc_list, &pe->pe_link, pe);
+		pwc_count++;
+	} else {
+		free(pe->pe_buf);
+		pe->pe_buf = NULL;
+		memset(&pe->pe_u, 0, sizeof(pe->pe_u));
+	}
+
+	ttl = found ? pwcache_ttl : pwcache_neg_ttl;
+	pe->pe_found = found;
+	pe->pe_expire = now + ttl;
+	pe->pe_stale = now + ttl * PWCACHE_STALE_FACTOR;
+	return pe;
+}
+
+/**
+ * @brief
+ *	Length of a possibly NULL string including its terminator.
+ */
+static size_t
+pwc_len(const char *s)
+{
+	return (s ? strlen(s) : 0) + 1;
+}
+
+/**
+ * @brief
+ *	Copy string 's' at '*pp', advance '*pp' past it.
+ *
+ * @return char *
+ * @retval	the copy
+ */
+static char *
+pwc_cpy(char **pp, const char *s)
+{
+	char *d = *pp;
+
+	if (s == NULL)
+		*d = '\0';
+	else
+		strcpy(d, s);
+	*pp += strlen(d) + 1;
+	return d;
+}
+
+/**
+ * @brief
+ *	Store a deep copy of passwd entry 'pw' in cache entry 'pe'.
+ *
+ * @return int
+ * @retval	0	- success
+ * @retval	-1	- out of memory
+ */
+static int
+pwc_copy_passwd(struct pwc_entry *pe, struct passwd *pw)
+{
+	char *p;
+
+	p = malloc(pwc_len(pw->pw_name) + pwc_len(pw->pw_passwd) +
+		pwc_len(pw->pw_gecos) + pwc_len(pw->pw_dir) +
+		pwc_len(pw->pw_shell));
+	if (p == NULL)
+		return -1;
+	pe->pe_buf = p;
+	pe->pe_u.pw = *pw;
+	pe->pe_u.pw.pw_name = pwc_cpy(&p, pw->pw_name);
+	pe->pe_u.pw.pw_passwd = pwc_cpy(&p, pw->pw_passwd);
+	pe->pe_u.pw.pw_gecos = pwc_cpy(&p, pw->pw_gecos);
+	pe->pe_u.pw.pw_dir = pwc_cpy(&p, pw->pw_dir);
+	pe->pe_u.pw.pw_shell = pwc_cpy(&p, pw->pw_shell);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Store a deep copy of group entry 'gr' in cache entry 'pe'.
+ *
+ * @return int
+ * @retval	0	- success
+ * @retval	-1	- out of memory
+ */
+static int
+pwc_copy_group(struct pwc_entry *pe, struct group *gr)
+{
+	size_t len;
+	int nmem = 0;
+	int i;
+	char **mem;
+	char *p;
+
+	len = pwc_len(gr->gr_name) + pwc_len(gr->gr_passwd);
+	if (gr->gr_mem != NULL) {
+		for (; gr->gr_mem[nmem] != NULL; nmem++)
+			len += pwc_len(gr->gr_mem[nmem]);
+	}
+	mem = malloc((nmem + 1) * sizeof(char *) + len);
+	if (mem == NULL)
+		return -1;
+	pe->pe_buf = mem;
+	p = (char *) (mem + nmem + 1);
+	pe->pe_u.gr = *gr;
+	pe->pe_u.gr.gr_name = pwc_cpy(&p, gr->gr_name);
+	pe->pe_u.gr.gr_passwd = pwc_cpy(&p, gr->gr_passwd);
+	for (i = 0; i < nmem; i++)
+		mem[i] = pwc_cpy(&p, gr->gr_mem[i]);
+	mem[nmem] = NULL;
+	pe->pe_u.gr.gr_mem = mem;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Look up a passwd entry through the cache.
+ *
+ * @param[in]	key - cache key of the entry
+ * @param[in]	name - user name, or NULL to look up by 'uid'
+ * @param[in]	uid - user id
+ *
+ * @return struct passwd *
+ * @retval	entry	- found
+ * @retval	NULL	- no such user, or name service failure
+ */
+static struct passwd *
+pwc_passwd(char *key, const char *name, uid_t uid)
+{
+	struct pwc_entry *pe;
+	struct passwd *pw;
+	time_t now = time(NULL);
+
+	pe = pwc_find(key);
+	if (pe != NULL && now < pe->pe_expire)
+		return (pe->pe_found ? &pe->pe_u.pw : NULL);
+
+	errno = 0;
+	pw = name ? getpwnam(name) : getpwuid(uid);
+	if (pw == NULL && !PWC_NOTFOUND(errno)) {
+		/* the name service is failing, hold on to what we knew */
+		if (pe != NULL && pe->pe_found && now < pe->pe_stale)
+			return &pe->pe_u.pw;
+		return NULL;
+	}
+	pe = pwc_store(key, pe, pw != NULL, now);
+	if (pe == NULL || pw == NULL)
+		return pw;
+	if (pwc_copy_passwd(pe, pw) != 0) {
+		pwc_remove(pe);
+		return pw;
+	}
+	return &pe->pe_u.pw;
+}
+
+/**
+ * @brief
+ *	Look up a group entry through the cache.
+ *
+ * @param[in]	key - cache key of the entry
+ * @param[in]	name - group name, or NULL to look up by 'gid'
+ * @param[in]	gid - group id
+ *
+ * @return struct group *
+ * @retval	entry	- found
+ * @retval	NULL	- no such group, or name service failure
+ */
+static struct group *
+pwc_group(char *key, const char *name, gid_t gid)
+{
+	struct pwc_entry *pe;
+	struct group *gr;
+	time_t now = time(NULL);
+
+	pe = pwc_find(key);
+	if (pe != NULL && now < pe->pe_expire)
+		return (pe->pe_found ? &pe->pe_u.gr : NULL);
+
+	errno = 0;
+	gr = name ? getgrnam(name) : getgrgid(gid);
+	if (gr == NULL && !PWC_NOTFOUND(errno)) {
+		/* the name service is failing, hold on to what we knew */
+		if (pe != NULL && pe->pe_found && now < pe->pe_stale)
+			return &pe->pe_u.gr;
+		return NULL;
+	}
+	pe = pwc_store(key, pe, gr != NULL, now);
+	if (pe == NULL || gr == NULL)
+		return gr;
+	if (pwc_copy_group(pe, gr) != 0) {
+		pwc_remove(pe);
+		return gr;
+	}
+	return &pe->pe_u.gr;
+}
+
+/**
+ * @brief
+ *	Cached getpwnam().
+ *
+ * @param[in]	name - user name
+ *
+ * @return struct passwd *
+ * @retval	entry	- found
+ * @retval	NULL	- no such user, or name service failure
+ */
+struct passwd *
+pbs_getpwnam(const char *name)
+{
+	char key[PWC_KEYLEN];
+
+	if (name == NULL)
+		return NULL;
+	if (pwcache_ttl <= 0 ||
+		snprintf(key, sizeof(key), "u:%s", name) >= (int) sizeof(key))
+		return getpwnam(name);
+	return pwc_passwd(key, name, 0);
+}
+
+/**
+ * @brief
+ *	Cached getpwuid().
+ *
+ * @param[in]	uid - user id
+ *
+ * @return struct passwd *
+ * @retval	entry	- found
+ * @retval	NULL	- no such user, or name service failure
+ */
+struct passwd *
+pbs_getpwuid(uid_t uid)
+{
+	char key[PWC_KEYLEN];
+
+	if (pwcache_ttl <= 0)
+		return getpwuid(uid);
+	snprintf(key, sizeof(key), "U:%lu", (unsigned long) uid);
+	return pwc_passwd(key, NULL, uid);
+}
+
+/**
+ * @brief
+ *	Cached getgrnam().
+ *
+ * @param[in]	name - group name
+ *
+ * @return struct group *
+ * @retval	entry	- found
+ * @retval	NULL	- no such group, or name service failure
+ */
+struct group *
+pbs_getgrnam(const char *name)
+{
+	char key[PWC_KEYLEN];
+
+	if (name == NULL)
+		return NULL;
+	if (pwcache_ttl <= 0 ||
+		snprintf(key, sizeof(key), "g:%s", name) >= (int) sizeof(key))
+		return getgrnam(name);
+	return pwc_group(key, name, 0);
+}
+
+/**
+ * @brief
+ *	Cached getgrgid().
+ *
+ * @param[in]	gid - group id
+ *
+ * @return struct group *
+ * @retval	entry	- found
+ * @retval	NULL	- no such group, or name service failure
+ */
+struct group *
+pbs_getgrgid(gid_t gid)
+{
+	char key[PWC_KEYLEN];
+
+	if (pwcache_ttl <= 0)
+		return getgrgid(gid);
+	snprintf(key, sizeof(key), "G:%lu", (unsigned long) gid);
+	return pwc_group(key, NULL, gid);
+}
+
+/**
+ * @brief
+ *	Cached getgrouplist(): the supplementary groups of 'user', with 'gid'
+ *	included, as initgroups() would set them.
+ *
+ * @param[in]	user - user name
+ * @param[in]	gid - group to include in the list
+ * @param[out]	ngroups - number of groups in the list
+ *
+ * @return gid_t *
+ * @retval	list	- owned by the cache (or a static buffer when the
+ *			  cache is disabled), valid until the next call
+ * @retval	NULL	- failure
+ */
+gid_t *
+pbs_getgrouplist(const char *user, gid_t gid, int *ngroups)
+{
+	static gid_t *nocache = NULL;
+	char key[PWC_KEYLEN];
+	struct pwc_entry *pe = NULL;
+	gid_t *list = NULL;
+	gid_t *tmp;
+	int ng = 32;
+	int cache;
+	time_t now = time(NULL);
+
+	if (user == NULL || ngroups == NULL)
+		return NULL;
+	cache = pwcache_ttl > 0 &&
+		snprintf(key, sizeof(key), "l:%lu:%s", (unsigned long) gid, user) < (int) sizeof(key);
+	if (cache) {
+		pe = pwc_find(key);
+		if (pe != NULL && now < pe->pe_expire) {
+			*ngroups = pe->pe_u.gl.gl_num;
+			return pe->pe_u.gl.gl_list;
+		}
+	}
+
+	for (;;) {
+		int n = ng;
+
+		tmp = realloc(list, ng * sizeof(gid_t));
+		if (tmp == NULL) {
+			free(list);
+			return NULL;
+		}
+		list = tmp;
+		if (getgrouplist(user, gid, list, &n) >= 0) {
+			ng = n;
+			break;
+		}
+		/* glibc returns the size needed in n, others do not */
+		ng = (n > ng) ? n : ng * 2;
+		if (ng > PWC_MAXGROUPS) {
+			free(list);
+			return NULL;
+		}
+	}
+
+	if (cache && (pe = pwc_store(key, pe, 1, now)) != NULL) {
+		pe->pe_buf = list;
+		pe->pe_u.gl.gl_list = list;
+		pe->pe_u.gl.gl_num = ng;
+	} else {
+		free(nocache);
+		nocache = list;
+	}
+	*ngroups = ng;
+	return list;
+}
+
+/**
+ * @brief
+ *	Drop every entry of the cache, e.g. when the daemon is told to
+ *	reread its configuration.
+ *
+ * @return void
+ */
+void
+pbs_pwcache_flush(void)
+{
+	struct pwc_entry *pe;
+
+	if (pwc_idx == NULL)
+		return;
+	while ((pe = (struct pwc_entry *) GET_NEXT(pwc_list)) != NULL)
+		pwc_remove(pe);
+}
+#endif /* WIN32 */
@@ -44,6 +44,18 @@
  * @brief
  * 		range.c -  contains functions which are related to range structure.
  *
+ *	A range is a compressed bitset of subjob indices.  A value is split into
+ *	its high 16 bits, which pick a container, and its low 16 bits, which the
+ *	container holds in one of three forms:
+ *	  - array:  a sorted array of values, used for up to RANGE_ARRAY_MAX values
+ *	  - bitmap: a 65536 bit map, used once an array would be larger
+ *	  - run:    a sorted list of [start, last] runs, used for contiguous
+ *		    indices such as a freshly submitted x-y array
+ *	Containers are kept sorted by key, so finding one is a binary search and
+ *	adding, removing or finding a value costs O(log n) at worst even for
+ *	arrays with millions of indices.  The string form is only built when
+ *	range_to_str() is asked for it and is cached until the range changes.
+ *
  * Functions included are:
  * 	new_range()
  * 	free_range_list()
@@ -53,7 +65,8 @@
  * 	range_parse()
  * 	range_next_value()
  * 	range_contains()
- * 	range_contains_single()
+ * 	range_count()
+ * 	range_rank()
  * 	range_remove_value()
  * 	range_add_value()
  * 	range_intersection()
@@ -64,6 +77,7 @@
 #include <pbs_config.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <errno.h>
 #include <string.h>
@@ -71,38 +85,620 @@
 #include <libutil.h>
 #include "range.h"
 
+#define RANGE_ARRAY_MAX		4096	/* most values in an array container */
+#define RANGE_BITMAP_WORDS	1024	/* 64 bit words in a bitmap container */
+#define RANGE_RUN_MAX		2048	/* most runs in a run container */
+#define RANGE_CONT_SPAN		65536	/* values covered by one container */
+
+enum range_cont_type {
+	RANGE_CONT_ARRAY,
+	RANGE_CONT_BITMAP,
+	RANGE_CONT_RUN
+};
+
+struct range_run {
+	uint16_t start;
+	uint16_t last;		/* inclusive */
+};
+
+typedef struct range_cont {
+	uint16_t key;		/* high 16 bits of every value held */
+	uint16_t type;		/* enum range_cont_type */
+	int card;		/* number of values held */
+	int len;		/* array: values used, run: runs used */
+	int alloc;		/* array: values allocated, run: runs allocated */
+	union {
+		uint16_t *arr;
+		uint64_t *bits;
+		struct range_run *runs;
+	} u;
+} range_cont;
+
+struct range {
+	int step;		/* step used when printing runs of values */
+	int count;		/* number of values in the range */
+	int ncont;		/* containers used */
+	int acont;		/* containers allocated */
+	range_cont *cont;	/* containers sorted by key */
+	char *str;		/* cached string form */
+	int str_size;
+	int str_valid;
+};
+
+static int
+popcount64(uint64_t w)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(w);
+#else
+	int n = 0;
+
+	for (; w != 0; w &= w - 1)
+		n++;
+	return n;
+#endif
+}
+
+static int
+lowbit64(uint64_t w)
+{
+#ifdef __GNUC__
+	return __builtin_ctzll(w);
+#else
+	int n = 0;
+
+	while (!(w & 1)) {
+		w >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/**
+ * @brief
+ *		first index in a sorted uint16_t array whose value is >= v
+ */
+static int
+arr_lower_bound(uint16_t *arr, int len, int v)
+{
+	int lo = 0;
+	int hi = len;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (arr[mid] < v)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * @brief
+ *		first run in a run container whose last value is >= v
+ */
+static int
+run_lower_bound(struct range_run *runs, int len, int v)
+{
+	int lo = 0;
+	int hi = len;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (runs[mid].last < v)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static void
+cont_free(range_cont *c)
+{
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			free(c->u.arr);
+			break;
+		case RANGE_CONT_BITMAP:
+			free(c->u.bits);
+			break;
+		case RANGE_CONT_RUN:
+			free(c->u.runs);
+			break;
+	}
+	c->u.arr = NULL;
+}
+
+/**
+ * @brief
+ *		turn an array or run container into a bitmap container
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: malloc error, container left as it was
+ */
+static int
+cont_to_bitmap(range_cont *c)
+{
+	uint64_t *bits;
+	int i;
+	int v;
+
+	if ((bits = calloc(RANGE_BITMAP_WORDS, sizeof(uint64_t))) == NULL) {
+		log_err(errno, __func__, RANGE_MEM_ERR_MSG);
+		return -1;
+	}
+
+	if (c->type == RANGE_CONT_ARRAY) {
+		for (i = 0; i < c->len; i++)
+			bits[c->u.arr[i] >> 6] |= (uint64_t) 1 << (c->u.arr[i] & 63);
+	} else {
+		for (i = 0; i < c->len; i++)
+			for (v = c->u.runs[i].start; v <= c->u.runs[i].last; v++)
+				bits[v >> 6] |= (uint64_t) 1 << (v & 63);
+	}
+
+	cont_free(c);
+	c->type = RANGE_CONT_BITMAP;
+	c->u.bits = bits;
+	c->len = 0;
+	c->alloc = 0;
+	return 0;
+}
+
+/**
+ * @brief
+ *		turn a bitmap container which has become sparse into an array
+ *		container.  Failing to do so only costs memory, so errors are ignored.
+ */
+static void
+bitmap_to_array(range_cont *c)
+{
+	uint16_t *arr;
+	int n = 0;
+	int i;
+
+	if ((arr = malloc(c->card * sizeof(uint16_t))) == NULL)
+		return;
+
+	for (i = 0; i < RANGE_BITMAP_WORDS; i++) {
+		uint64_t w = c->u.bits[i];
+		while (w != 0) {
+			arr[n++] = (uint16_t) (i * 64 + lowbit64(w));
+			w &= w - 1;
+		}
+	}
+
+	free(c->u.bits);
+	c->type = RANGE_CONT_ARRAY;
+	c->u.arr = arr;
+	c->len = n;
+	c->alloc = n;
+}
+
+/**
+ * @brief
+ *		make room for one more element in an array or run container
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: malloc error
+ */
+static int
+cont_grow(range_cont *c, size_t elsize)
+{
+	void *p;
+	int nalloc;
+
+	if (c->len < c->alloc)
+		return 0;
+
+	nalloc = c->alloc ? c->alloc * 2 : 4;
+	if ((p = realloc(c->u.arr, nalloc * elsize)) == NULL) {
+		log_err(errno, __func__, RANGE_MEM_ERR_MSG);
+		return -1;
+	}
+	c->u.arr = p;
+	c->alloc = nalloc;
+	return 0;
+}
+
+static int
+cont_contains(range_cont *c, int v)
+{
+	int i;
+
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			i = arr_lower_bound(c->u.arr, c->len, v);
+			return (i < c->len && c->u.arr[i] == v);
+		case RANGE_CONT_BITMAP:
+			return (c->u.bits[v >> 6] >> (v & 63)) & 1;
+		case RANGE_CONT_RUN:
+			i = run_lower_bound(c->u.runs, c->len, v);
+			return (i < c->len && c->u.runs[i].start <= v);
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *		add the low 16 bits of a value to a container
+ *
+ * @return	int
+ * @retval	1	: value added
+ * @retval	0	: value was already there
+ * @retval	-1	: malloc error
+ */
+static int
+cont_add(range_cont *c, int v)
+{
+	int i;
+
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			i = arr_lower_bound(c->u.arr, c->len, v);
+			if (i < c->len && c->u.arr[i] == v)
+				return 0;
+			if (c->len >= RANGE_ARRAY_MAX) {
+				if (cont_to_bitmap(c) != 0)
+					return -1;
+				return cont_add(c, v);
+			}
+			if (cont_grow(c, sizeof(uint16_t)) != 0)
+				return -1;
+			memmove(&c->u.arr[i + 1], &c->u.arr[i], (c->len - i) * sizeof(uint16_t));
+			c->u.arr[i] = (uint16_t) v;
+			c->len++;
+			break;
+
+		case RANGE_CONT_BITMAP:
+			if ((c->u.bits[v >> 6] >> (v & 63)) & 1)
+				return 0;
+			c->u.bits[v >> 6] |= (uint64_t) 1 << (v & 63);
+			break;
+
+		case RANGE_CONT_RUN:
+			/* i is the first run ending at or after v */
+			i = run_lower_bound(c->u.runs, c->len, v);
+			if (i < c->len && c->u.runs[i].start <= v)
+				return 0;
+			if (i > 0 && c->u.runs[i - 1].last + 1 == v) {
+				if (i < c->len && c->u.runs[i].start == v + 1) {
+					/* v joins two runs */
+					c->u.runs[i - 1].last = c->u.runs[i].last;
+					memmove(&c->u.runs[i], &c->u.runs[i + 1],
+						(c->len - i - 1) * sizeof(struct range_run));
+					c->len--;
+				} else
+					c->u.runs[i - 1].last = (uint16_t) v;
+			} else if (i < c->len && c->u.runs[i].start == v + 1)
+				c->u.runs[i].start = (uint16_t) v;
+			else {
+				if (c->len >= RANGE_RUN_MAX) {
+					if (cont_to_bitmap(c) != 0)
+						return -1;
+					return cont_add(c, v);
+				}
+				if (cont_grow(c, sizeof(struct range_run)) != 0)
+					return -1;
+				memmove(&c->u.runs[i + 1], &c->u.runs[i],
+					(c->len - i) * sizeof(struct range_run));
+				c->u.runs[i].start = (uint16_t) v;
+				c->u.runs[i].last = (uint16_t) v;
+				c->len++;
+			}
+			break;
+	}
+	c->card++;
+	return 1;
+}
+
+/**
+ * @brief
+ *		remove the low 16 bits of a value from a container
+ *
+ * @return	int
+ * @retval	1	: value removed
+ * @retval	0	: value was not there
+ * @retval	-1	: malloc error
+ */
+static int
+cont_remove(range_cont *c, int v)
+{
+	int i;
+	struct range_run *run;
+
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			i = arr_lower_bound(c->u.arr, c->len, v);
+			if (i >= c->len || c->u.arr[i] != v)
+				return 0;
+			memmove(&c->u.arr[i], &c->u.arr[i + 1], (c->len - i - 1) * sizeof(uint16_t));
+			c->len--;
+			break;
+
+		case RANGE_CONT_BITMAP:
+			if (!((c->u.bits[v >> 6] >> (v & 63)) & 1))
+				return 0;
+			c->u.bits[v >> 6] &= ~((uint64_t) 1 << (v & 63));
+			c->card--;
+			/* only go back to an array well below the limit so we don't flip-flop */
+			if (c->card > 0 && c->card <= RANGE_ARRAY_MAX / 2)
+				bitmap_to_array(c);
+			return 1;
+
+		case RANGE_CONT_RUN:
+			i = run_lower_bound(c->u.runs, c->len, v);
+			if (i >= c->len || c->u.runs[i].start > v)
+				return 0;
+			run = &c->u.runs[i];
+			if (run->start == v && run->last == v) {
+				memmove(run, run + 1, (c->len - i - 1) * sizeof(struct range_run));
+				c->len--;
+			} else if (run->start == v)
+				run->start++;
+			else if (run->last == v)
+				run->last--;
+			else {
+				/* v splits the run in two */
+				if (c->len >= RANGE_RUN_MAX) {
+					if (cont_to_bitmap(c) != 0)
+						return -1;
+					return cont_remove(c, v);
+				}
+				if (cont_grow(c, sizeof(struct range_run)) != 0)
+					return -1;
+				run = &c->u.runs[i];
+				memmove(run + 1, run, (c->len - i) * sizeof(struct range_run));
+				run[0].last = (uint16_t) (v - 1);
+				run[1].start = (uint16_t) (v + 1);
+				c->len++;
+			}
+			break;
+	}
+	c->card--;
+	return 1;
+}
+
+/**
+ * @brief
+ *		find the smallest value >= v held in a container
+ *
+ * @return	int
+ * @retval	the value
+ * @retval	-1	: there is none
+ */
+static int
+cont_next(range_cont *c, int v)
+{
+	int i;
+
+	if (v >= RANGE_CONT_SPAN)
+		return -1;
+
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			i = arr_lower_bound(c->u.arr, c->len, v);
+			return (i < c->len) ? c->u.arr[i] : -1;
+
+		case RANGE_CONT_BITMAP:
+			i = v >> 6;
+			if (c->u.bits[i] >> (v & 63))
+				return v + lowbit64(c->u.bits[i] >> (v & 63));
+			for (i++; i < RANGE_BITMAP_WORDS; i++)
+				if (c->u.bits[i] != 0)
+					return i * 64 + lowbit64(c->u.bits[i]);
+			return -1;
+
+		case RANGE_CONT_RUN:
+			i = run_lower_bound(c->u.runs, c->len, v);
+			if (i >= c->len)
+				return -1;
+			return (c->u.runs[i].start > v) ? c->u.runs[i].start : v;
+	}
+	return -1;
+}
+
+/**
+ * @brief
+ *		number of values smaller than v held in a container
+ */
+static int
+cont_rank(range_cont *c, int v)
+{
+	int i;
+	int n = 0;
+
+	switch (c->type) {
+		case RANGE_CONT_ARRAY:
+			return arr_lower_bound(c->u.arr, c->len, v);
+
+		case RANGE_CONT_BITMAP:
+			for (i = 0; i < (v >> 6); i++)
+				n += popcount64(c->u.bits[i]);
+			if (v & 63)
+				n += popcount64(c->u.bits[v >> 6] & (((uint64_t) 1 << (v & 63)) - 1));
+			return n;
+
+		case RANGE_CONT_RUN:
+			for (i = 0; i < c->len && c->u.runs[i].last < v; i++)
+				n += c->u.runs[i].last - c->u.runs[i].start + 1;
+			if (i < c->len && c->u.runs[i].start < v)
+				n += v - c->u.runs[i].start;
+			return n;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *		find the container of a range for a key
+ *
+ * @param[in]	r	-	the range
+ * @param[in]	key	-	high 16 bits of a value
+ * @param[out]	pos	-	where the container is or would be inserted
+ *
+ * @return	the container
+ * @retval	NULL	: the range has no container for key
+ */
+static range_cont *
+find_cont(range *r, int key, int *pos)
+{
+	int lo = 0;
+	int hi = r->ncont;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (r->cont[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (pos != NULL)
+		*pos = lo;
+	if (lo < r->ncont && r->cont[lo].key == key)
+		return &r->cont[lo];
+	return NULL;
+}
+
 /**
  * @brief
- *		new_range - allocate and initialize a range structure
+ *		insert an empty container at pos
+ *
+ * @return	the container
+ * @retval	NULL	: malloc error
+ */
+static range_cont *
+insert_cont(range *r, int pos, int key, int type)
+{
+	range_cont *c;
+
+	if (r->ncont == r->acont) {
+		int nalloc = r->acont ? r->acont * 2 : 4;
+		if ((c = realloc(r->cont, nalloc * sizeof(range_cont))) == NULL) {
+			log_err(errno, __func__, RANGE_MEM_ERR_MSG);
+			return NULL;
+		}
+		r->cont = c;
+		r->acont = nalloc;
+	}
+
+	memmove(&r->cont[pos + 1], &r->cont[pos], (r->ncont - pos) * sizeof(range_cont));
+	r->ncont++;
+
+	c = &r->cont[pos];
+	memset(c, 0, sizeof(range_cont));
+	c->key = (uint16_t) key;
+	c->type = (uint16_t) type;
+	return c;
+}
+
+static void
+remove_cont(range *r, int pos)
+{
+	cont_free(&r->cont[pos]);
+	memmove(&r->cont[pos], &r->cont[pos + 1], (r->ncont - pos - 1) * sizeof(range_cont));
+	r->ncont--;
+}
+
+/**
+ * @brief
+ *		add the values start, start + step, ... end to a range.  Spans of
+ *		consecutive values are added as runs a container at a time.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: malloc error
+ */
+static int
+range_add_span(range *r, int start, int end, int step)
+{
+	int v;
+	int pos;
+	range_cont *c;
+
+	if (step > 1) {
+		for (v = start; v <= end; v += step) {
+			if (range_add_value(&r, v, r->step) == 0 && !range_contains(r, v))
+				return -1;
+			if (v > end - step)
+				break;
+		}
+		return 0;
+	}
+
+	v = start;
+	while (v <= end) {
+		int key = v >> 16;
+		int last = (key << 16) + RANGE_CONT_SPAN - 1;
+
+		if (last > end)
+			last = end;
+
+		c = find_cont(r, key, &pos);
+		if (c == NULL) {
+			if ((c = insert_cont(r, pos, key, RANGE_CONT_RUN)) == NULL)
+				return -1;
+			if (cont_grow(c, sizeof(struct range_run)) != 0) {
+				remove_cont(r, pos);
+				return -1;
+			}
+			c->u.runs[0].start = (uint16_t) (v & 0xffff);
+			c->u.runs[0].last = (uint16_t) (last & 0xffff);
+			c->len = 1;
+			c->card = last - v + 1;
+			r->count += c->card;
+		} else {
+			int i;
+			for (i = v; i <= last; i++) {
+				int ret = cont_add(c, i & 0xffff);
+				if (ret < 0)
+					return -1;
+				r->count += ret;
+			}
+		}
+		if (last == end)
+			break;
+		v = last + 1;
+	}
+	r->str_valid = 0;
+	return 0;
+}
+
+/**
+ * @brief
+ *		new_range - allocate an empty range
+ *
+ * @param[in]	step	-	step used when printing runs of values
  *
  * @return	newly allocated range
  * @retval	NULL	: on error
  *
  */
 range *
-new_range(int start, int end, int step, int count, range *next)
+new_range(int step)
 {
 	range *r;
 
-	if ((r = malloc(sizeof(range))) == NULL) {
+	if ((r = calloc(1, sizeof(range))) == NULL) {
 		log_err(errno, __func__, RANGE_MEM_ERR_MSG);
 		return NULL;
 	}
 
-	r->start = start;
-	r->end = end;
-	r->step = step;
-	r->count = count;
-	r->next = next;
+	r->step = (step > 0) ? step : 1;
 
 	return r;
 }
 
 /**
  * @brief
- *		free_range_list - free a list of ranges
+ *		free_range_list - free a range
  *
- * @param[in,out]	r	-	range list to be freed.
+ * @param[in,out]	r	-	range to be freed.
  *
  * @return	nothing
  *
@@ -110,24 +706,14 @@ new_range(int start, int end, int step, int count, range *next)
 void
 free_range_list(range *r)
 {
-	range *cur_r;
-	range *next_r;
-
-	cur_r = r;
-
-	while (cur_r != NULL) {
-		next_r = cur_r->next;
-		free_range(cur_r);
-
-		cur_r = next_r;
-	}
+	free_range(r);
 }
 
 /**
  * @brief
- *		free_range - free a range structure
+ *		free_range - free a range and all its containers
  *
- * @param[in,out]	r	-	range structure to be freed.
+ * @param[in,out]	r	-	range to be freed.
  *
  * @return	nothing
  *
@@ -135,60 +721,40 @@ free_range_list(range *r)
 void
 free_range(range *r)
 {
+	int i;
+
 	if (r == NULL)
 		return;
 
+	for (i = 0; i < r->ncont; i++)
+		cont_free(&r->cont[i]);
+	free(r->cont);
+	free(r->str);
 	free(r);
 }
 
 /**
  * @brief
- *		dup_range_list - duplicate a range list
+ *		dup_range_list - duplicate a range
  *
  * @param[in]	old_r	-	range to dup;
  *
- * @return	newly duplicated range list
+ * @return	newly duplicated range
  *
  */
 range *
 dup_range_list(range *old_r)
 {
-	range *new_r;
-	range *new_r_head = NULL;
-	range *cur_old_r;
-	range *prev_new_r = NULL;
-
-	if (old_r == NULL)
-		return NULL;
-
-	cur_old_r = old_r;
-
-	while (cur_old_r != NULL) {
-		new_r = dup_range(cur_old_r);
-		if (new_r == NULL) {
-			free_range_list(new_r_head);
-			return NULL;
-		}
-
-		if (prev_new_r != NULL)
-			prev_new_r->next = new_r;
-		else
-			new_r_head = new_r;
-
-		cur_old_r = cur_old_r->next;
-		prev_new_r = new_r;
-	}
-
-	return new_r_head;
+	return dup_range(old_r);
 }
 
 /**
  * @brief
- *		dup_range - duplicate a range structure
+ *		dup_range - duplicate a range
  *
- * @param[in]	old_r	-	range structure to duplicate
+ * @param[in]	old_r	-	range to duplicate
  *
- * @return	new range structure
+ * @return	new range
  * @retval	NULL	: on error
  *
  */
@@ -196,12 +762,55 @@ range *
 dup_range(range *old_r)
 {
 	range *new_r;
+	int i;
 
-	new_r = new_range(old_r->start, old_r->end, old_r->step, old_r->count, NULL);
+	if (old_r == NULL)
+		return NULL;
 
-	if (new_r == NULL)
+	if ((new_r = new_range(old_r->step)) == NULL)
 		return NULL;
-		
+
+	if (old_r->ncont > 0) {
+		if ((new_r->cont = calloc(old_r->ncont, sizeof(range_cont))) == NULL) {
+			log_err(errno, __func__, RANGE_MEM_ERR_MSG);
+			free_range(new_r);
+			return NULL;
+		}
+		new_r->acont = old_r->ncont;
+	}
+
+	for (i = 0; i < old_r->ncont; i++) {
+		range_cont *oc = &old_r->cont[i];
+		range_cont *nc = &new_r->cont[i];
+		size_t sz;
+
+		*nc = *oc;
+		nc->u.arr = NULL;
+		switch (oc->type) {
+			case RANGE_CONT_ARRAY:
+				sz = oc->len * sizeof(uint16_t);
+				nc->alloc = oc->len;
+				break;
+			case RANGE_CONT_RUN:
+				sz = oc->len * sizeof(struct range_run);
+				nc->alloc = oc->len;
+				break;
+			default:
+				sz = RANGE_BITMAP_WORDS * sizeof(uint64_t);
+				break;
+		}
+		if (sz > 0) {
+			if ((nc->u.arr = malloc(sz)) == NULL) {
+				log_err(errno, __func__, RANGE_MEM_ERR_MSG);
+				free_range(new_r);
+				return NULL;
+			}
+			memcpy(nc->u.arr, oc->u.arr, sz);
+		}
+		new_r->ncont++;
+	}
+	new_r->count = old_r->count;
+
 	return new_r;
 }
 
@@ -212,16 +821,14 @@ dup_range(range *old_r)
  *
  * @param[in]	str	-	string of ranges to parse
  *
- * @return	list of ranges
- * @retval	NULL	: on error
+ * @return	range
+ * @retval	NULL	: on error or if the string holds no values
  *
  */
 range *
 range_parse(char *str)
 {
-	range *head = NULL;
-	range *cur = NULL;
-	range *r;
+	range *r = NULL;
 	char *p;
 	char *endp;
 	int ret;
@@ -239,42 +846,28 @@ range_parse(char *str)
 
 		ret = parse_subjob_index(p, &endp, &start, &end, &step, &count);
 		if (!ret) {
-			r = new_range(start, end, step, count, NULL);
-
-			if (r == NULL) {
-				free_range_list(head);
+			if (start < 0) {
+				free_range(r);
 				return NULL;
 			}
+			if (r == NULL && (r = new_range(step)) == NULL)
+				return NULL;
 
-			/* ensure the end value is contained in the range */
-			while (range_contains(r, end) == 0 && end > start)
-				end--;
-
-			if (range_contains(r, end))
-				r->end = end;
-			else { /* range is majorly hosed */
-				free_range_list(head);
+			if (range_add_span(r, start, end, step) != 0) {
 				free_range(r);
 				return NULL;
 			}
 
-			if (head == NULL)
-				head = cur = r;
-			else {
-				cur->next = r;
-				cur = r;
-			}
-
 			p = endp;
 		}
 	} while (!ret);
 
-	if (ret == -1) {
-		free_range_list(head);
+	if (ret == -1 || (r != NULL && r->count == 0)) {
+		free_range(r);
 		return NULL;
 	}
 
-	return head;
+	return r;
 }
 
 /**
@@ -294,33 +887,31 @@ range_parse(char *str)
 int
 range_next_value(range *r, int cur_value)
 {
-	range *cur;
-	int ret_val = -2;
+	int pos;
+	int v;
 
 	if (r == NULL)
 		return -1;
 
-	if (cur_value < 0)
-		return r->start;
+	if (cur_value < 0) {
+		if (r->ncont == 0)
+			return -2;
+		return (r->cont[0].key << 16) + cont_next(&r->cont[0], 0);
+	}
 
 	if (range_contains(r, cur_value) == 0)
 		return -1;
 
-	cur = r;
-	while (cur != NULL && ret_val < 0) {
-		if (range_contains_single(cur, cur_value)) {
-			if (cur_value == cur->end) {
-				if (cur->next != NULL)
-					ret_val = cur->next->start;
-			}
-			else
-				ret_val = cur_value + cur->step;
-		}
-		cur = cur->next;
-	}
+	find_cont(r, cur_value >> 16, &pos);
+	v = cont_next(&r->cont[pos], (cur_value & 0xffff) + 1);
+	if (v >= 0)
+		return (r->cont[pos].key << 16) + v;
+	if (pos + 1 < r->ncont)
+		return (r->cont[pos + 1].key << 16) + cont_next(&r->cont[pos + 1], 0);
 
-	return ret_val;
+	return -2;
 }
+
 /**
  * @brief
  *		range_contains - find if a range contains a value
@@ -336,144 +927,117 @@ range_next_value(range *r, int cur_value)
 int
 range_contains(range *r, int val)
 {
-	range *cur;
-	int found = 0;
+	range_cont *c;
 
-	cur = r;
+	if (r == NULL || val < 0)
+		return 0;
 
-	while (cur != NULL && !found) {
-		if (range_contains_single(cur, val))
-			found = 1;
+	if ((c = find_cont(r, val >> 16, NULL)) == NULL)
+		return 0;
 
-		cur = cur->next;
-	}
+	return cont_contains(c, val & 0xffff) ? 1 : 0;
+}
 
-	if (found)
-		return 1;
+/**
+ * @brief
+ *		range_count - number of values in a range
+ *
+ * @param[in]	r	-	the range
+ *
+ * @return	int
+ * @retval	number of values in r
+ *
+ */
+int
+range_count(range *r)
+{
+	if (r == NULL)
+		return 0;
 
-	return 0;
+	return r->count;
 }
 
 /**
  * @brief
- *		range_contains_single - is a value contained in a single range
- *				  structure
+ *		range_rank - number of values in a range smaller than val
  *
- * @param[in]	r	-	the range structure
+ * @param[in]	r	-	the range
  * @param[in]	val	-	the value
  *
  * @return	int
- * @retval	1	: if the value is in the single range structure
- * @retval	0	: if not
+ * @retval	number of values in r which are < val
  *
  */
 int
-range_contains_single(range *r, int val)
+range_rank(range *r, int val)
 {
-	if (r == NULL)
+	int pos;
+	int i;
+	int n = 0;
+
+	if (r == NULL || val <= 0)
 		return 0;
 
-	if (val >= r->start && val <= r->end)
-		if ((val - r->start) % r->step ==0)
-			return 1;
+	find_cont(r, val >> 16, &pos);
+	for (i = 0; i < pos; i++)
+		n += r->cont[i].card;
+	if (pos < r->ncont && r->cont[pos].key == (val >> 16))
+		n += cont_rank(&r->cont[pos], val & 0xffff);
 
-	return 0;
+	return n;
 }
 
 /**
  * @brief
- *		range_remove_value - remove a value from a range list
+ *		range_remove_value - remove a value from a range
  *
- * @param[in,out]	r	-	pointer to pointer to the head of the range
+ * @param[in,out]	r	-	pointer to pointer to the range
  * @param[in]	val	-	value to remove
  *
  * @return	int
  * @retval	1	: on success
- * @retval	0	: if not done (see note)
+ * @retval	0	: if the value is not in the range or on error
  *
- * @par	NOTE: value of r might be changed if the last value of first range
- *		  is removed. only supports removing values from either the start or end
- *	      of a range, not in the middle
+ * @par	NOTE: the range is freed and *r set to NULL when its last value
+ *		  is removed.
  *
  */
 
 int
 range_remove_value(range **r, int val)
 {
-	range *cur;
-	range *prev = NULL;
-	int done = 0;
+	range_cont *c;
+	int pos;
 
-	if (r == NULL || *r == NULL)
+	if (r == NULL || *r == NULL || val < 0)
 		return 0;
 
-	if (!range_contains(*r, val))
+	if ((c = find_cont(*r, val >> 16, &pos)) == NULL)
 		return 0;
 
-	cur = *r;
-	while (cur != NULL && !done) {
-		if (cur->start == val && cur->end == val) {
-			if (prev == NULL)  /* we're removing the first range struct in the list */
-				*r = (*r)->next;
-			else 
-				prev->next = cur->next;
-			free_range(cur);
-			return 1;
-		} else if (cur->start == val) {
-			cur->start += cur->step;
-			cur->count--;
-			done = 1;
-		} else if (cur->end == val) {
-			cur->end -= cur->step;
-			cur->count--;
-			done = 1;
-		} else if ((val > cur->start) && (val < cur->end)) {
-			range *next_range = NULL;
-			if ((next_range = new_range(0, 0, 1, 0, NULL)) == NULL)
-				return 0;
-				
-			next_range->count = (cur->end - val)/cur->step;
-			next_range->step = cur->step;
-			next_range->start = val + cur->step;
-			next_range->end = cur->end;
-			next_range->next = cur->next;
-
-			cur->count = (val - cur->start)/cur->step;
-			cur->end = val - cur->step;
-			cur->next = next_range;			
-			return 1;	
-		}
+	if (cont_remove(c, val & 0xffff) != 1)
+		return 0;
 
-		if (!done) {
-			prev = cur;
-			cur = cur->next;
-		}
-	}
+	if (c->card == 0)
+		remove_cont(*r, pos);
 
-	if (done) {
-		/* we removed the last value from this section of the range */
-		if (cur->start > cur->end) {
-			if (prev == NULL)   /* we're removing the first range struct in the list */
-				*r = (*r)->next;
-			else 
-				prev->next = cur->next;
-			free_range(cur);
-		}
-		return 1;
+	(*r)->str_valid = 0;
+	if (--(*r)->count == 0) {
+		free_range(*r);
+		*r = NULL;
 	}
 
-	/* we didn't remove it */
-	return 0;
+	return 1;
 }
 
 /**
  * @brief
- *		range_add_value - add a value to a range list by adding it to the end
- *			  of the list
+ *		range_add_value - add a value to a range
  *
- * @param[in,out]	r	-	pointer to pointer to the head of the range
+ * @param[in,out]	r	-	pointer to pointer to the range, a new range is
+ *				created if *r is NULL
  * @param[in]	val	-	value to add
- * @param[in]	type	-	enable/disable subrange stepping
+ * @param[in]	range_step	-	step used to print a range created here
  *
  * @return	int
  * @retval	1	: if successfully added value
@@ -483,99 +1047,39 @@ range_remove_value(range **r, int val)
 int
 range_add_value(range **r, int val, int range_step)
 {
-	range *cur;			/* current range structure in list */
-	range *next_range;
+	range_cont *c;
+	int pos;
+	int created = 0;
+	int ret;
 
-	if (r == NULL)
+	if (r == NULL || val < 0)
 		return 0;
 
 	if (*r == NULL) {
-		/* If there are no range structs in the list; create the new range for first value */
-		range *first_range = NULL;
-		if ((first_range = new_range(val, val, range_step, 1, NULL)) == NULL) {
+		if ((*r = new_range(range_step)) == NULL)
 			return 0;
-		}
-		*r = first_range;
-		return 1;
-	}
-
-	cur = *r;
-	/* Value falls before the first sub-range */
-	if (cur != NULL && val < cur->start) {
-		if (val == cur->start - cur->step) {
-			cur->start -= cur->step;
-			cur->count++;
-			return 1;
-		} else {
-			/* Add new range as the first element with same value */
-			range * first_range = NULL;
-			if ((first_range = new_range(val, val, cur->step, 1, cur)) == NULL) {
-				return 0;
-			}
-			*r = first_range;			
-			return 1;
-		}
-	}
-
-	/* The value that needs to be added is in between the cur and the next sub-ranges  */
-	
-	while (cur != NULL && cur->next != NULL ) {
-
-		next_range = cur->next;
-		if ((val > cur->end) && (val < next_range->start)) {
-			
-			if ((val == cur->end + cur->step) && (val == next_range->start - next_range->step)) {
-				/* Adding this value would coalesce these two sub-ranges  */
-				cur->end = next_range->end;
-				cur->next = next_range->next;
-				cur->count++;
-				free_range(next_range);	
-				return 1;
-
-			} else if (val == cur->end + cur->step) {
-				/* Value falls in the cur sub-range end  */
-				cur->end += cur->step;
-				cur->count++;
-				return 1; 
-	 
-			} else if (val == next_range->start - next_range->step) {
-				/* Value falls in the next sub-range start  */
-				next_range->start -= next_range->step;
-				next_range->count++;
-				return 1;
-
-			} else {
-				/* Value falls in this range; add new mid-range with same value */
-				range * mid_range = NULL;
-				if ((mid_range = new_range(val, val, cur->step, 1, cur->next)) == NULL) {
-					return 0;
-				}
-				cur->next = mid_range;
- 				return 1;
-			}		
-		}
-		cur = next_range;
+		created = 1;
 	}
 
-	/* Coming out of the loop and check the extreme right corner case */
-	
-	if (cur != NULL && val > cur->end) {
-		if (val == cur->end + cur->step) {
-			cur->end += cur->step;
-			cur->count++;
-			return 1;
-		} else {
-			/* Add new range at the end with same value */
-			range *end_range = NULL;
-			if ((end_range = new_range(val, val, cur->step, 1, NULL)) == NULL) {
-				return 0;
-			}
-			cur->next = end_range;
-			return 1;		
+	if ((c = find_cont(*r, val >> 16, &pos)) == NULL) {
+		if ((c = insert_cont(*r, pos, val >> 16, RANGE_CONT_ARRAY)) == NULL)
+			ret = -1;
+		else if ((ret = cont_add(c, val & 0xffff)) != 1)
+			remove_cont(*r, pos);
+	} else
+		ret = cont_add(c, val & 0xffff);
+
+	if (ret != 1) {
+		if (created) {
+			free_range(*r);
+			*r = NULL;
 		}
+		return 0;
 	}
 
-	return 0;
+	(*r)->count++;
+	(*r)->str_valid = 0;
+	return 1;
 }
 
 /**
@@ -593,18 +1097,42 @@ range *
 range_intersection(range *r1, range *r2)
 {
 	range *intersection = NULL;
-	int cur = 0;
+	int i = 0;
+	int j = 0;
 
 	if (r1 == NULL || r2 == NULL)
 		return NULL;
 
-	cur = range_next_value(r1, -1);
+	/* only containers with the same key can share values */
+	while (i < r1->ncont && j < r2->ncont) {
+		range_cont *c1 = &r1->cont[i];
+		range_cont *c2 = &r2->cont[j];
+		int v;
 
-	while (cur >= 0) {
-		if (range_contains(r2, cur)) {
-				range_add_value(&intersection, cur, r2->step);
+		if (c1->key < c2->key) {
+			i++;
+			continue;
+		}
+		if (c2->key < c1->key) {
+			j++;
+			continue;
+		}
+
+		if (c2->card < c1->card) {
+			range_cont *tmp = c1;
+			c1 = c2;
+			c2 = tmp;
+		}
+		for (v = cont_next(c1, 0); v >= 0; v = cont_next(c1, v + 1)) {
+			if (cont_contains(c2, v)) {
+				if (range_add_value(&intersection, (c1->key << 16) + v, r2->step) == 0) {
+					free_range(intersection);
+					return NULL;
+				}
+			}
 		}
-		cur = range_next_value(r1, cur);
+		i++;
+		j++;
 	}
 	return intersection;
 }
@@ -703,62 +1231,120 @@ parse_subjob_index(char *pc, char **ep, int *pstart, int *pend, int *pstep, int
 	return (0);
 }
 
+
 /**
  * @brief
- * 		Returns a string representation of a range structure.
+ *		append a run of values start, start + step, ... last to the string
+ *		form of a range
  *
- * @param[in]	r	-	The range for which a string representation is expected
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: malloc error
+ */
+static int
+range_str_run(range *r, int start, int last)
+{
+	char numbuf[128];
+
+	if (r->str[0] != '\0' && pbs_strcat(&r->str, &r->str_size, ",") == NULL)
+		return -1;
 
+	if (last == start)
+		sprintf(numbuf, "%d", start);
+	else if (r->step > 1)
+		sprintf(numbuf, "%d-%d:%d", start, last, r->step);
+	else
+		sprintf(numbuf, "%d-%d", start, last);
+
+	if (pbs_strcat(&r->str, &r->str_size, numbuf) == NULL)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Returns a string representation of a range.  Values which follow
+ *		each other by the range's step are printed as one x-y[:z] run.
+ *		The string is built on demand and kept until the range changes.
+ *
+ * @param[in]	r	-	The range for which a string representation is expected
+ *
  * @par MT-safe:	no
  *
- * @return	a string representation of the range
+ * @return	a string representation of the range, owned by the range and
+ *		valid until it is changed or freed
  * @retval	""	: on any malloc error
  *
  */
 char *
 range_to_str(range *r)
 {
-	static char *range_str = NULL;
-	static int size = 0;
-	range *cur_r = NULL;
-	char numbuf[128];
-	int len;
+	int run_start = -1;
+	int run_last = -1;
+	int i;
 
 	if (r == NULL)
 		return "";
 
-	if (range_str == NULL) {
-		if ((range_str = malloc(INIT_RANGE_ARR_SIZE+1)) == NULL) {
+	if (r->str_valid)
+		return r->str;
+
+	if (r->str == NULL) {
+		if ((r->str = malloc(INIT_RANGE_ARR_SIZE + 1)) == NULL) {
 			log_err(errno, __func__, RANGE_MEM_ERR_MSG);
 			return "";
 		}
-		size = INIT_RANGE_ARR_SIZE;
+		r->str_size = INIT_RANGE_ARR_SIZE;
 	}
-	range_str[0] = '\0';
+	r->str[0] = '\0';
+
+	for (i = 0; i < r->ncont; i++) {
+		range_cont *c = &r->cont[i];
+		int base = c->key << 16;
+		int v;
+
+		for (v = cont_next(c, 0); v >= 0; v = cont_next(c, v + 1)) {
+			int first = base + v;
+			int last = first;
+
+			/* a run container hands over a whole span of consecutive values */
+			if (c->type == RANGE_CONT_RUN) {
+				int j = run_lower_bound(c->u.runs, c->len, v);
+				last = base + c->u.runs[j].last;
+				v = c->u.runs[j].last;
+			}
 
-	for (cur_r = r; cur_r != NULL; cur_r = cur_r->next) {
-		if (cur_r->count > 1)
-			sprintf(numbuf, "%d-%d", cur_r->start, cur_r->end);
-		else
-			sprintf(numbuf, "%d", cur_r->start);
-
-		if (cur_r->step > 1 && cur_r->count > 1 ) {
-			if (pbs_strcat(&range_str, &size, numbuf) == NULL)
-				return "";
-			sprintf(numbuf, ":%d", cur_r->step);
-			if (pbs_strcat(&range_str, &size, numbuf) == NULL)
-				return "";
-		}
-		else
-			if (pbs_strcat(&range_str, &size, numbuf) == NULL)
-				return "";
+			if (r->step == 1) {
+				if (run_start >= 0 && first == run_last + 1) {
+					run_last = last;
+					continue;
+				}
+				if (run_start >= 0 && range_str_run(r, run_start, run_last) != 0)
+					return "";
+				run_start = first;
+				run_last = last;
+				continue;
+			}
 
-		if (pbs_strcat(&range_str, &size, ",") == NULL)
-			return "";
+			while (1) {
+				if (run_start >= 0 && first == run_last + r->step)
+					run_last = first;
+				else {
+					if (run_start >= 0 && range_str_run(r, run_start, run_last) != 0)
+						return "";
+					run_start = first;
+					run_last = first;
+				}
+				if (first == last)
+					break;
+				first++;
+			}
+		}
 	}
-	len = strlen(range_str);
-	if (range_str[len-1] == ',')
-		range_str[len-1] = '\0';
+	if (run_start >= 0 && range_str_run(r, run_start, run_last) != 0)
+		return "";
 
-	return range_str;
+	r->str_valid = 1;
+	return r->str;
 }
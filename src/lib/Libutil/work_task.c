@@ -41,35 +41,274 @@
  * @file	work_task.c
  * @brief
  * work_task.c - contains functions to deal with the server's task list
+ *
+ *	Timed tasks are kept in a binary heap ordered by their time, so adding
+ *	and removing one costs O(log n) rather than a walk of every timed task.
+ *	Tasks with a wt_parm1 are also hashed by it, so the tasks of one object
+ *	are found without scanning every task list.
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include "portability.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
+#include <sys/time.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include "server_limits.h"
 #include "list_link.h"
 #include "work_task.h"
+#include "mem_acct.h"
 
 
 /* Global Data Items: */
 
 extern pbs_list_head task_list_immed; /* list of tasks that can execute now */
-extern pbs_list_head task_list_timed; /* list of tasks that have set start times */
 extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+/* heap of tasks that have set start times */
+struct timed_entry {
+	struct work_task *te_task;
+	unsigned long	  te_seq;	/* keeps tasks with the same time in FIFO order */
+};
+static struct timed_entry *timed_heap = NULL;
+static int timed_heap_len = 0;
+static int timed_heap_max = 0;
+static unsigned long timed_seq = 0;
+
+/* hash of tasks by wt_parm1 */
+#define PARM1_HASH_INIT	1024
+static pbs_list_head *parm1_hash = NULL;
+static size_t parm1_hash_size = 0;
+static size_t parm1_count = 0;
+
+/* told how long each dispatched task ran, see dispatch_task() */
+void (*pfn_task_dispatched)(void (*)(struct work_task *), double) = NULL;
+
+/**
+ * @brief
+ * 	Compare two entries of the timed task heap
+ *
+ * @return int
+ * @retval 1 if a's task should be dispatched before b's
+ * @retval 0 otherwise
+ */
+static int
+timed_before(struct timed_entry *a, struct timed_entry *b)
+{
+	if (a->te_task->wt_event != b->te_task->wt_event)
+		return a->te_task->wt_event < b->te_task->wt_event;
+	return a->te_seq < b->te_seq;
+}
+
+/**
+ * @brief
+ * 	Place an entry at an index of the timed task heap
+ */
+static void
+timed_place(int ind, struct timed_entry *ent)
+{
+	timed_heap[ind] = *ent;
+	ent->te_task->wt_heap_ind = ind;
+}
+
+/**
+ * @brief
+ * 	Move the heap entry at ind up or down until the heap is ordered again
+ *
+ * @param[in]	ind	- index of the entry that is out of place
+ */
+static void
+timed_sift(int ind)
+{
+	struct timed_entry ent = timed_heap[ind];
+	int parent;
+	int child;
+
+	while (ind > 0) {
+		parent = (ind - 1) / 2;
+		if (!timed_before(&ent, &timed_heap[parent]))
+			break;
+		timed_place(ind, &timed_heap[parent]);
+		ind = parent;
+	}
+	for (;;) {
+		child = 2 * ind + 1;
+		if (child >= timed_heap_len)
+			break;
+		if (child + 1 < timed_heap_len && timed_before(&timed_heap[child + 1], &timed_heap[child]))
+			child++;
+		if (!timed_before(&timed_heap[child], &ent))
+			break;
+		timed_place(ind, &timed_heap[child]);
+		ind = child;
+	}
+	timed_place(ind, &ent);
+}
+
+/**
+ * @brief
+ * 	Add a task to the timed task heap
+ *
+ * @param[in]	ptask	- the task
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+timed_insert(struct work_task *ptask)
+{
+	struct timed_entry ent;
+
+	if (timed_heap_len == timed_heap_max) {
+		int newmax = timed_heap_max == 0 ? 1024 : timed_heap_max * 2;
+		struct timed_entry *tmp;
+
+		tmp = (struct timed_entry *)realloc(timed_heap, newmax * sizeof(struct timed_entry));
+		if (tmp == NULL)
+			return -1;
+		timed_heap = tmp;
+		timed_heap_max = newmax;
+	}
+	ent.te_task = ptask;
+	ent.te_seq = timed_seq++;
+	timed_place(timed_heap_len++, &ent);
+	timed_sift(timed_heap_len - 1);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Remove a task from the timed task heap, if it is in it
+ *
+ * @param[in]	ptask	- the task
+ */
+static void
+timed_remove(struct work_task *ptask)
+{
+	int ind = ptask->wt_heap_ind;
+
+	if (ind < 0 || ind >= timed_heap_len || timed_heap[ind].te_task != ptask)
+		return;
+	ptask->wt_heap_ind = -1;
+	if (--timed_heap_len > ind) {
+		timed_place(ind, &timed_heap[timed_heap_len]);
+		timed_sift(ind);
+	}
+}
+
+/**
+ * @brief
+ * 	Find the hash chain of a wt_parm1 value
+ *
+ * @param[in]	parm1	- the value
+ *
+ * @return pbs_list_head *
+ */
+static pbs_list_head *
+parm1_chain(void *parm1)
+{
+	uintptr_t h = (uintptr_t) parm1;
+
+	h = (h >> 4) * (uintptr_t) 0x9E3779B97F4A7C15ULL;
+	return &parm1_hash[(h >> 16) & (parm1_hash_size - 1)];
+}
+
+/**
+ * @brief
+ * 	Grow the wt_parm1 hash, or create it if it does not exist yet
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+parm1_grow(void)
+{
+	pbs_list_head *old = parm1_hash;
+	size_t oldsize = parm1_hash_size;
+	size_t newsize = oldsize == 0 ? PARM1_HASH_INIT : oldsize * 2;
+	struct work_task *ptask;
+	size_t i;
+
+	parm1_hash = (pbs_list_head *)malloc(newsize * sizeof(pbs_list_head));
+	if (parm1_hash == NULL) {
+		parm1_hash = old;
+		return -1;
+	}
+	parm1_hash_size = newsize;
+	for (i = 0; i < newsize; i++)
+		CLEAR_HEAD(parm1_hash[i]);
+
+	for (i = 0; i < oldsize; i++) {
+		while ((ptask = (struct work_task *)GET_NEXT(old[i])) != NULL) {
+			delete_link(&ptask->wt_linkparm1);
+			append_link(parm1_chain(ptask->wt_parm1), &ptask->wt_linkparm1, ptask);
+		}
+	}
+	free(old);
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Is a task on any of the task lists or in the timed task heap
+ *
+ * @param[in]	ptask	- the task
+ *
+ * @return int
+ * @retval 1 if it is
+ * @retval 0 if it was taken off the task lists by its owner
+ */
+static int
+task_is_listed(struct work_task *ptask)
+{
+	return (ptask->wt_heap_ind >= 0 || ptask->wt_linkall.ll_next != &ptask->wt_linkall);
+}
+
+/**
+ * @brief
+ * 	Unlink a task from the task lists, the timed task heap and the
+ *	wt_parm1 hash
+ *
+ * @param[in]	ptask	- the task
+ */
+static void
+unlink_task(struct work_task *ptask)
+{
+	delete_link(&ptask->wt_linkall);
+	delete_link(&ptask->wt_linkobj);
+	delete_link(&ptask->wt_linkobj2);
+	timed_remove(ptask);
+	if (ptask->wt_linkparm1.ll_next != &ptask->wt_linkparm1) {
+		delete_link(&ptask->wt_linkparm1);
+		parm1_count--;
+	}
+}
+
+/**
+ * @brief
+ *	Free a work task structure which is no longer linked anywhere.
+ */
+static void
+free_task(struct work_task *ptask)
+{
+	(void)free(ptask);
+	mem_acct_add(MEM_ACCT_WORK_TASK, -1, -(long long)sizeof(struct work_task));
+}
+
 /**
  *
  * @brief
  * 	Creates a task of type 'type', 'event_id', and when task is dispatched,
  *	execute func with argument 'parm'. The task is added to
- *	'task_list_immed' if 'type' is  WORK_Immed; otherwise, task is added
- *	'task_list_event'.
+ *	'task_list_immed' if 'type' is  WORK_Immed, to the timed task heap if
+ *	'type' is WORK_Timed; otherwise, task is added 'task_list_event'.
  *
  * @param[in]	type - of task
  * @param[in]	event_id - event id of the task
@@ -84,14 +323,15 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
 	pnew = (struct work_task *)malloc(sizeof(struct work_task));
 	if (pnew == NULL)
 		return NULL;
+	mem_acct_add(MEM_ACCT_WORK_TASK, 1, sizeof(struct work_task));
 	CLEAR_LINK(pnew->wt_linkall);
 	CLEAR_LINK(pnew->wt_linkobj);
 	CLEAR_LINK(pnew->wt_linkobj2);
+	CLEAR_LINK(pnew->wt_linkparm1);
 	pnew->wt_event = event_id;
 	pnew->wt_event2 = NULL;
 	pnew->wt_type  = type;
@@ -101,21 +341,25 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_parm3 = NULL;
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
+	pnew->wt_heap_ind = -1;
+
+	if (parm != NULL) {
+		if (parm1_count >= parm1_hash_size * 2 && parm1_grow() == -1 && parm1_hash == NULL) {
+			free_task(pnew);
+			return NULL;
+		}
+		append_link(parm1_chain(parm), &pnew->wt_linkparm1, pnew);
+		parm1_count++;
+	}
 
 	if (type == WORK_Immed)
 		append_link(&task_list_immed, &pnew->wt_linkall, pnew);
 	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkall);
+		if (timed_insert(pnew) == -1) {
+			unlink_task(pnew);
+			free_task(pnew);
+			return NULL;
 		}
-		if (pold)
-			insert_link(&pold->wt_linkall, &pnew->wt_linkall, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkall, pnew);
 	} else
 		append_link(&task_list_event, &pnew->wt_linkall, pnew);
 	return (pnew);
@@ -131,18 +375,30 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
  * @note:
  *	This also deletes the work task entry, calls the associated function
  *	with the parameters from the work task entry, and then frees the
- *	entry.
+ *	entry.  When pfn_task_dispatched is set it is told how long the
+ *	function ran.
  */
 
 void
 dispatch_task(struct work_task *ptask)
 {
-	delete_link(&ptask->wt_linkall);
-	delete_link(&ptask->wt_linkobj);
-	delete_link(&ptask->wt_linkobj2);
-	if (ptask->wt_func)
-		ptask->wt_func(ptask);		/* dispatch process function */
-	(void)free(ptask);
+	void (*func)(struct work_task *) = ptask->wt_func;
+	struct timeval start;
+	struct timeval end;
+
+	unlink_task(ptask);
+	if (func) {
+		if (pfn_task_dispatched == NULL)
+			func(ptask);		/* dispatch process function */
+		else {
+			gettimeofday(&start, NULL);
+			func(ptask);
+			gettimeofday(&end, NULL);
+			pfn_task_dispatched(func, (end.tv_sec - start.tv_sec) +
+				(end.tv_usec - start.tv_usec) / 1000000.0);
+		}
+	}
+	free_task(ptask);
 }
 
 /**
@@ -156,17 +412,15 @@ dispatch_task(struct work_task *ptask)
 void
 delete_task(struct work_task *ptask)
 {
-	delete_link(&ptask->wt_linkobj);
-	delete_link(&ptask->wt_linkobj2);
-	delete_link(&ptask->wt_linkall);
-	(void)free(ptask);
+	unlink_task(ptask);
+	free_task(ptask);
 }
 
 /**
  *
  * @brief
  *	Delete task found in task_list_event, task_list_immed, or
- *	task_list_timed by either its function pointer, parm1, or both.
+ *	the timed tasks by either its function pointer, parm1, or both.
  * 	At least one of the function pointer or parm1 must not be NULL.
  *
  * @param[in]	parm1	- wt->parm1 parameter to match (can be NULL)
@@ -176,31 +430,83 @@ delete_task(struct work_task *ptask)
  *			  matches parm1 values or just one.
  *
  * @return none
+ *
+ * @par
+ *	With DELETE_ONE, an event task is deleted before a timed task, and a
+ *	timed task before an immediate one.
  */
 void
 delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wtask_delete_option option)
 {
 	struct work_task  *ptask;
 	struct work_task  *ptask_next;
-	pbs_list_head task_lists[] = {task_list_event, task_list_timed, task_list_immed};
+	struct work_task  *found[3] = {NULL, NULL, NULL};
+	pbs_list_head task_lists[] = {task_list_event, task_list_immed};
 	int i;
 
 	if (parm1 == NULL && func == NULL)
 		return;
 
-	for (i = 0; i < 3; i++) {
-		for (ptask = (struct work_task *) GET_NEXT(task_lists[i]); ptask; ptask = ptask_next) {
-			ptask_next = (struct work_task *) GET_NEXT(ptask->wt_linkall);
+	if (parm1 != NULL) {
+		if (parm1_hash == NULL)
+			return;
+		for (ptask = (struct work_task *) GET_NEXT(*parm1_chain(parm1)); ptask; ptask = ptask_next) {
+			ptask_next = (struct work_task *) GET_NEXT(ptask->wt_linkparm1);
 
-			if ((parm1 != NULL) && (ptask->wt_parm1 != parm1))
+			if (ptask->wt_parm1 != parm1 || !task_is_listed(ptask))
 				continue;
 			if ((func != NULL) && (ptask->wt_func != func))
 				continue;
 
+			if (option == DELETE_ALL)
+				delete_task(ptask);
+			else if (ptask->wt_heap_ind >= 0) {
+				if (found[1] == NULL)
+					found[1] = ptask;
+			} else if (ptask->wt_type == WORK_Immed) {
+				if (found[2] == NULL)
+					found[2] = ptask;
+			} else {
+				delete_task(ptask);
+				return;
+			}
+		}
+		for (i = 1; i < 3; i++) {
+			if (found[i] != NULL) {
+				delete_task(found[i]);
+				return;
+			}
+		}
+		return;
+	}
+
+	for (i = 0; i < 2; i++) {
+		for (ptask = (struct work_task *) GET_NEXT(task_lists[i]); ptask; ptask = ptask_next) {
+			ptask_next = (struct work_task *) GET_NEXT(ptask->wt_linkall);
+
+			if (ptask->wt_func != func)
+				continue;
+
 			delete_task(ptask);
 			if (option == DELETE_ONE)
 				return;
 		}
+		if (i == 0) {
+			int j;
+
+			for (j = 0; j < timed_heap_len;) {
+				ptask = timed_heap[j].te_task;
+				if (ptask->wt_func != func) {
+					j++;
+					continue;
+				}
+				/* the last entry is moved into the deleted one's place */
+				delete_task(ptask);
+				if (option == DELETE_ONE)
+					return;
+				j = 0;
+			}
+		}
 	}
 }
 
@@ -208,7 +514,7 @@ delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wt
  *
  * @brief
  *	Check if some task in any of the task lists (task_list_event,
- *	task_list_timed, task_list_immed) has a wt_parm1 matching 'parm1'.
+ *	task_list_immed or the timed tasks) has a wt_parm1 matching 'parm1'.
  *
  * @param[in]	parm1	- parameter being matched.
  *
@@ -221,32 +527,47 @@ has_task_by_parm1(void *parm1)
 {
 	struct work_task  *ptask;
 
-	/* only 1 ptask can be possibly matched */
-	ptask = (struct work_task *)GET_NEXT(task_list_event);
-	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-	}
+	if (parm1 == NULL || parm1_hash == NULL)
+		return 0;
 
-	ptask = (struct work_task *)GET_NEXT(task_list_timed);
+	ptask = (struct work_task *)GET_NEXT(*parm1_chain(parm1));
 	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
+		if (ptask->wt_parm1 == parm1 && task_is_listed(ptask))
 			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
+		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkparm1);
 	}
 
-	ptask = (struct work_task *)GET_NEXT(task_list_immed);
+	return 0;
+}
+
+/**
+ *
+ * @brief
+ *	Find the listed task of type 'type' whose wt_parm1 is 'parm1'.
+ *
+ * @param[in]	parm1	- parameter being matched.
+ * @param[in]	type	- type of the task
+ *
+ * @return struct work_task *
+ * @retval	the task if found
+ * @retval	NULL otherwise
+ */
+struct work_task *
+find_task_by_parm1(void *parm1, enum work_type type)
+{
+	struct work_task  *ptask;
+
+	if (parm1 == NULL || parm1_hash == NULL)
+		return NULL;
+
+	ptask = (struct work_task *)GET_NEXT(*parm1_chain(parm1));
 	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
+		if (ptask->wt_parm1 == parm1 && ptask->wt_type == type && task_is_listed(ptask))
+			return ptask;
+		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkparm1);
 	}
 
-	return 0;
+	return NULL;
 }
 
 /**
@@ -255,7 +576,7 @@ has_task_by_parm1(void *parm1)
  *	1. If svr_delay_entry is set, then a delayed task in the
  *	   task_list_event is ready so find and process it.
  *	2. All items on the immediate list, then
- *	3. All items on the timed task list which have expired times
+ *	3. All timed tasks which have expired times
  *
  * @return time_t
  * @retval The amount of time till next task
@@ -292,13 +613,14 @@ default_next_task(void)
 	while ((ptask=(struct work_task *)GET_NEXT(task_list_immed)) != NULL)
 		dispatch_task(ptask);
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
+	while (timed_heap_len > 0) {
+		ptask = timed_heap[0].te_task;
 		if ((delay = ptask->wt_event - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
 			break;
 		} else {
-			dispatch_task(ptask);	/* will delete link */
+			dispatch_task(ptask);	/* will remove it from the heap */
 		}
 
 	}
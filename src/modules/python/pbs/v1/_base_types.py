@@ -171,6 +171,10 @@ class PbsAttributeDescriptor():
         #  _get_default_value() getting evaluatd every time.
 
         if obj not in self.__per_instance:
+            #: job and vnode attribute values are set by PBS on first access
+            if getattr(obj, "_attributes_lazy", False) and \
+                    _pbs_v1.load_attribute_value(obj, self._name):
+                return self.__per_instance[obj]
             v = self._get_default_value()
             self.__per_instance[obj] = v
 
@@ -210,6 +214,8 @@ class PbsAttributeDescriptor():
                 set_value = self._value_type[0](value)
         #:
         self.__per_instance[obj] = set_value
+        if getattr(obj, "_attributes_lazy", False):
+            _pbs_v1.load_attribute_value(obj, self._name, 1)
     #: m(__set__)
 
     def _set_resc_atttr(self, resc_attr, is_entity=0):
@@ -225,6 +231,8 @@ class PbsAttributeDescriptor():
         """__delete__, we just set the attribute value to None"""
 
         self.__per_instance[obj] = None
+        if getattr(obj, "_attributes_lazy", False):
+            _pbs_v1.load_attribute_value(obj, self._name, 1)
     #: m(__delete__)
 
     def _get_default_value(self):
@@ -103,6 +103,21 @@ def get_local_nodename():
     return(_pbs_v1.get_local_host_name())
 
 
+#
+# get_topology: returns the hwloc XML that pbs_mom saved for this host in
+#               PBS_HOME/mom_priv/topology.xml, or None if there is none.
+#               Lets hooks on the execution host skip their own hwloc probe.
+
+
+def get_topology():
+    home = pbs_conf['PBS_MOM_HOME'] or pbs_conf['PBS_HOME']
+    try:
+        with open(os.path.join(home, "mom_priv", "topology.xml")) as f:
+            return f.read()
+    except Exception:
+        return None
+
+
 #
 # pbs_statobj: general-purpose function that connects to server named
 #           'connect_server' or if None, use "localhost", and depending
@@ -287,6 +302,8 @@ class _job():
 
     attributes = PbsReadOnlyDescriptor('attributes', {})
     _attributes_hook_set = {}
+    #: attribute values are loaded from PBS when first accessed
+    _attributes_lazy = True
 
     def __new__(cls, value, connect_server=None):
         return object.__new__(cls)
@@ -419,6 +436,8 @@ class _vnode():
 
     attributes = PbsReadOnlyDescriptor('attributes', {})
     _attributes_hook_set = {}
+    #: attribute values are loaded from PBS when first accessed
+    _attributes_lazy = True
 
     def __new__(cls, value, connect_server=None):
         return object.__new__(cls)
@@ -628,11 +647,14 @@ class _queue():
             return _pbs_v1.get_job(jobid, self.name)
     #: m(job)
 
-    def jobs(self):
+    def jobs(self, state=None, username=None):
         """
             Returns an iterator that loops over the list of jobs on this queue.
+            As with pbs.server().jobs(), state (e.g. "QR") and username
+            restrict the jobs returned.
         """
-        return pbs_iter("jobs", "",  self.name, self._connect_server)
+        return pbs_iter("jobs", "",  self.name, self._connect_server,
+                        state, username)
     #: m(jobs)
 
 #: C(_queue)
@@ -768,13 +790,18 @@ class _server():
                             ignore_fin, username)
         #: m(jobs_nas)
     else:
-        def jobs(self):
+        def jobs(self, state=None, username=None):
             """
             Returns an iterator that loops over the list of jobs
             on this server.
+            Jobs are filtered before they are handed to the hook:
+            - state is a string of job state letters, e.g. "QR", and
+              only jobs in one of those states are returned
+            - username returns jobs with that euser
             """
 
-            return pbs_iter("jobs", "",  "", self._connect_server)
+            return pbs_iter("jobs", "",  "", self._connect_server,
+                            state, username)
         #: m(jobs)
 
     def vnodes(self):
@@ -970,6 +997,8 @@ class pbs_iter():
                 a list of jobs on <queue_name>@<server_name>
 
     connect_server Name of the pbs server to get various stats.
+    Pbs_state     for jobs, the job state letters (e.g. "QR") to return.
+    Pbs_username  for jobs, only return jobs with this euser.
     """
     # NAS localmod 014
     if NAS_mod != None and NAS_mod != 0:
@@ -1063,7 +1092,8 @@ class pbs_iter():
                     self.ignore_fin, self.filter_user)
     else:
         def __init__(self, pbs_obj_name, pbs_filter1,
-                     pbs_filter2, connect_server=None):
+                     pbs_filter2, connect_server=None,
+                     pbs_state=None, pbs_username=None):
 
             self._caller = _pbs_v1.get_python_daemon_name()
             if self._caller == "pbs_python":
@@ -1076,6 +1106,8 @@ class pbs_iter():
                     sn = connect_server
 
                 self.type = pbs_obj_name
+                self.filter_state = pbs_state
+                self.filter_user = pbs_username
                 if _pbs_v1.use_static_data():
                     if(self.type == "jobs"):
                         self.bs = iter(_pbs_v1.get_job_static("", sn, ""))
@@ -1121,9 +1153,30 @@ class pbs_iter():
                 self.obj_name = pbs_obj_name
                 self.filter1 = pbs_filter1
                 self.filter2 = pbs_filter2
+                self.filter_state = pbs_state
+                self.filter_user = pbs_username
                 # argument 1 below tells C function we're inside __init__
                 _pbs_v1.iter_nextfunc(
-                    self, 1, pbs_obj_name, pbs_filter1, pbs_filter2)
+                    self, 1, pbs_obj_name, pbs_filter1, pbs_filter2,
+                    pbs_state, pbs_username)
+
+    def _job_wanted(self, b):
+        """
+        pbs_python mode counterpart of the job filters applied by
+        iter_nextfunc(): True if the job batch_status b passes them.
+        """
+        state = getattr(self, "filter_state", None)
+        user = getattr(self, "filter_user", None)
+        if not state and not user:
+            return True
+        a = b.attribs
+        while a:
+            if state and a.name == ATTR_state and a.value not in state:
+                return False
+            if user and a.name == ATTR_euser and a.value != user:
+                return False
+            a = a.next
+        return True
 
     def __iter__(self):
         return self
@@ -1310,6 +1363,15 @@ class pbs_iter():
                 b = self.bs
                 job = None
 
+                if self.type == "jobs":
+                    while b and not self._job_wanted(b):
+                        b = b.next
+                    if not b:
+                        self.bs = None
+                        pbs_disconnect(self.con)
+                        self.con = -1
+                        raise StopIteration
+
                 _pbs_v1.set_c_mode()
 
                 server_data_fp = get_server_data_fp()
@@ -1415,7 +1477,9 @@ class pbs_iter():
             else:
                 # argument 0 below tells C function we're inside next
                 return _pbs_v1.iter_nextfunc(self, 0, self.obj_name,
-                                             self.filter1, self.filter2)
+                                             self.filter1, self.filter2,
+                                             self.filter_state,
+                                             self.filter_user)
 #: C(pbs_iter)
 
 #:------------------------------------------------------------------------
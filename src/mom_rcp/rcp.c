@@ -111,6 +111,11 @@
 #include <syslog.h>
 #include <arpa/inet.h>
 #endif        /* USELOG */
+#ifdef __linux__
+#include <sys/sendfile.h>
+
+#define	RCP_SENDFILE_MAX	(1024 * 1024 * 1024)	/* bytes per sendfile() call */
+#endif
 /**
  * @file	rcp.c
  */
@@ -655,6 +660,39 @@ tolocal(int argc, char *argv[])
 	}
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *	Write a whole buffer, continuing after short writes which become
+ *	likely on a socket with the large data buffer.
+ *
+ * @param[in]	fd - descriptor to write to
+ * @param[in]	buf - data to write
+ * @param[in]	len - number of bytes in buf
+ *
+ * @return	int
+ * @retval	len - everything written
+ * @retval	-1 - write error, errno is set
+ */
+static int
+write_all(int fd, char *buf, int len)
+{
+	int done = 0;
+	int rc;
+
+	while (done < len) {
+		rc = write(fd, buf + done, len - done);
+		if (rc == -1) {
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+		done += rc;
+	}
+	return (len);
+}
+#endif
+
 /**
  * @brief
  *	Send requested file(s) (or directory(s)) information to rshd server
@@ -756,14 +794,32 @@ source(int argc, char *argv[])
 #endif
 		if (response() < 0)
 			goto next;
-		if ((bp = allocbuf(&buffer, fd, RCP_BUFFER_SIZE)) == NULL) {
+		if ((bp = allocbuf(&buffer, fd, RCP_DATA_BUFSIZE)) == NULL) {
 			next:			if (fd > 0)(void)close(fd);
 			continue;
 		}
 
-		/* Keep writing after an error so that we stay sync'd up. */
 		haderr = 0;
-		for (i = 0; i < stb.st_size; i += bp->cnt) {
+		i = 0;
+#ifdef __linux__
+		/*
+		 * Have the kernel move the file data to the connection.  If
+		 * sendfile() is refused or stops early, the loop below carries
+		 * on from the file offset it reached.
+		 */
+		while (i < stb.st_size) {
+			ssize_t sent;
+
+			sent = sendfile(rem, fd, NULL, (stb.st_size - i > RCP_SENDFILE_MAX) ?
+				RCP_SENDFILE_MAX : (size_t)(stb.st_size - i));
+			if (sent <= 0)
+				break;
+			i += sent;
+		}
+#endif
+
+		/* Keep writing after an error so that we stay sync'd up. */
+		for (; i < stb.st_size; i += bp->cnt) {
 			amt = bp->cnt;
 			if (i + amt > stb.st_size)
 				amt = (int)(stb.st_size - i);
@@ -777,13 +833,13 @@ source(int argc, char *argv[])
 #ifdef WIN32
 				(void)send(rem, bp->buf, amt, 0);
 #else
-				(void)write(rem, bp->buf, amt);
+				(void)write_all(rem, bp->buf, amt);
 #endif
 			else {
 #ifdef WIN32
 				result = send(rem, bp->buf, amt, 0);
 #else
-				result = write(rem, bp->buf, amt);
+				result = write_all(rem, bp->buf, amt);
 #endif
 				if (result != amt)
 					haderr = result >= 0 ? EIO : errno;
@@ -1158,15 +1214,16 @@ sink(int argc, char *argv[])
 #else
 		(void)write(rem, "", 1);
 #endif
-		if ((bp = allocbuf(&buffer, ofd, RCP_BUFFER_SIZE)) == NULL) {
+		if ((bp = allocbuf(&buffer, ofd, RCP_DATA_BUFSIZE)) == NULL) {
 			(void)close(ofd);
 			continue;
 		}
 		cp = bp->buf;
 		wrerr = NO;
 		count = 0;
-		for (i = 0; i < size; i += RCP_BUFFER_SIZE) {
-			amt = RCP_BUFFER_SIZE;
+		/* fill the whole buffer before each write to the file */
+		for (i = 0; i < size; i += bp->cnt) {
+			amt = bp->cnt;
 			if (i + amt > size)
 				amt = (int)(size - i);
 			count += amt;
@@ -149,13 +149,46 @@ catch_child(int sig)
  */
 hnodent	*
 get_node(job *pjob, tm_node_id nodeid)
+{
+	vmpiprocs	*vp;
+
+	if ((vp = find_vmpiproc(pjob, nodeid)) == NULL)
+		return NULL;
+	return vp->vn_host;
+}
+
+/**
+ * @brief
+ *	returns the vnode entry of job pjob with the job relative id nodeid
+ *
+ * @par
+ *	job_nodes() numbers the entries of ji_vnods in order, so the entry
+ *	is looked up directly, without walking the whole list for each of
+ *	the many TM and IM messages of a job spanning thousands of vnodes.
+ *
+ * @param[in] pjob - job pointer to job
+ * @param[in] nodeid - job relative vnode id
+ *
+ * @return vmpiprocs *
+ * @retval  entry  SUCCESS
+ * @retval  NULL   Failure
+ *
+ */
+vmpiprocs *
+find_vmpiproc(job *pjob, tm_node_id nodeid)
 {
 	int		i;
 	vmpiprocs	*vp = pjob->ji_vnods;
 
+	if (vp == NULL)
+		return NULL;
+	if (nodeid >= 0 && nodeid < pjob->ji_numvnod &&
+		vp[nodeid].vn_node == nodeid)
+		return &vp[nodeid];
+
 	for (i=0; i<pjob->ji_numvnod; i++, vp++) {
 		if (vp->vn_node == nodeid)
-			return vp->vn_host;
+			return vp;
 	}
 	return NULL;
 }
@@ -294,6 +327,8 @@ update_jobs_status(void)
 			continue;
 		if (!check_job_substate(pjob, JOB_SUBSTATE_RUNNING))
 			continue;
+		if (!resc_used_update_due(pjob))
+			continue;
 		enqueue_update_for_send(pjob, IS_RESCUSED);
 	}
 }
@@ -780,6 +815,7 @@ end_loop:
 		if (cpid > 0) {
 			pjob->ji_sampletim = 0;
 			pjob->ji_momsubt = cpid;
+			track_job_pid(pjob, cpid);
 			pjob->ji_actalarm = 0;
 			pjob->ji_mompost = send_obit;
 			set_job_substate(pjob, JOB_SUBSTATE_RUNEPILOG);
@@ -1238,98 +1274,98 @@ del_job_hw(job *pjob)
 	int	sconn = -1;
 	struct work_task *wtask = NULL;
 
+	/* Nothing to release with ALPS, let server know right away */
+	if (pjob->ji_extended.ji_ext.ji_reservation < 0 ||
+		pjob->ji_extended.ji_ext.ji_pagg == 0) {
+		reply_ack(pjob->ji_preq);
+		pjob->ji_preq = NULL;
+		return;
+	}
+
 	/*
-	 * Try to cancel the reservation once as 'main MOM'.
-	 * If we got an acknowledgment from ALPS that the reservation
-	 * is actually gone, then send ACK to server.
-	 * Else, fork a child process that will continue to try to cancel
-	 * the reservation until the remaining processes count is zero.
-	 * Or until the ALPS reservation no longer exists.
+	 * Cancel the reservation in a child process, so that the ALPS round
+	 * trips do not hold up the main MOM.  The child keeps trying while
+	 * ALPS reports a "temporary" error, which could be due to one or
+	 * more of the following:
+	 * 	- the reservation still has claims on it
+	 * 	- ALPS is down
+	 * until success, a hard error, or alps_release_timeout is reached.
+	 * Once the child exits, the server's delete job request is answered
+	 * by post_alps_cancel_resv().
+	 * The job will remain in the 'E' state until then.
 	 */
-	if ((j = alps_cancel_reservation(pjob)) > 0) {
-		/*
-		 * alps reservation cancel failed with "temporary" error
-		 * This could be due to one of more of the following:
-		 * 	- the reservation still has claims on it
-		 * 	- ALPS is down
-		 * Retry in child until success, or a hard error is returned
-		 * Or alps_release_timeout is reached.
-		 * Once the ALPS reservation is successfully canceled,
-		 * respond to the server's delete job request.
-		 * The job will remain in the 'E' state until then.
-		 */
-		if (pjob->ji_preq != NULL)
-			sconn = pjob->ji_preq->rq_conn;
-
-		if ((pid = fork_me(sconn)) == 0) {
-			/* We are the child */
-			begin_time = time(NULL);
-			end_time = begin_time;
-			/* add jobid to the seed */
-			srandom((unsigned)(atoi(pjob->ji_qs.ji_jobid) + begin_time));
-			for (i = 1; (total_time = end_time - begin_time) < alps_release_timeout; ++i, end_time = time(NULL)) {
-				/* calculate time to sleep */
-				sleeptime = alps_release_wait_time;
-				/* Add randomness of 0 to 0.12 seconds to the
-				 * sleeptime so we don't overwhelm ALPS with
-				 * multiple ALPS release requests when jobs end
-				 * at the same time.
-				 */
-				jitter = random() % alps_release_jitter;
-				sleeptime += jitter;
-				usleep(sleeptime);
-				if ((j = alps_cancel_reservation(pjob)) <= 0)
-					break;
-			}
-			if (j > 0) {
-				sprintf(log_buffer,
-					"Timed out after %d attempts over "
-					"%ld seconds of attempting "
-					"to cancel ALPS reservation %ld",
-					i, total_time,
-					pjob->ji_extended.ji_ext.ji_reservation);
-				log_joberr(-1, __func__, log_buffer,
-					pjob->ji_qs.ji_jobid);
-				/* send a HUP to main MOM so she re-reads
-				 * the ALPS inventory
-				 */
-				parent_pid = getppid();
-				kill(parent_pid, SIGHUP);
-
-			} else if (j == 0) {
-				sprintf(log_buffer,
-					"Cancelled ALPS reservation %ld after a "
-					"total of %d tries",
-					pjob->ji_extended.ji_ext.ji_reservation, i + 1);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB,
-					LOG_DEBUG, pjob->ji_qs.ji_jobid,
-					log_buffer);
-			}
-
-			/* exit with the respective error code to the parent process
-			 * Parents (moms) post handler will handle this
+	if (pjob->ji_preq != NULL)
+		sconn = pjob->ji_preq->rq_conn;
+
+	if ((pid = fork_me(sconn)) == 0) {
+		/* We are the child */
+		begin_time = time(NULL);
+		/* add jobid to the seed */
+		srandom((unsigned)(atoi(pjob->ji_qs.ji_jobid) + begin_time));
+		i = 1;
+		j = alps_cancel_reservation(pjob);
+		while (j > 0) {
+			end_time = time(NULL);
+			if ((total_time = end_time - begin_time) >= alps_release_timeout)
+				break;
+			/* calculate time to sleep */
+			sleeptime = alps_release_wait_time;
+			/* Add randomness of 0 to 0.12 seconds to the
+			 * sleeptime so we don't overwhelm ALPS with
+			 * multiple ALPS release requests when jobs end
+			 * at the same time.
 			 */
-			exit(j);
-
-		} else if (pid > 0) {
-			/* we are the parent, the reply happens after the child exits */
-			if ((wtask = set_task(WORK_Deferred_Child, pid,
-					post_alps_cancel_resv, pjob->ji_preq)) == NULL) {
-				log_err(errno, NULL, "Failed to create deferred work task, Out of memory");
-				req_reject(PBSE_SYSTEM, 0, pjob->ji_preq);
-			}
-		} else if (pid < 0) {
-			/* fork failed, reply to the server so the job
-			 * doesn't stay in the "E" state
+			jitter = random() % alps_release_jitter;
+			sleeptime += jitter;
+			usleep(sleeptime);
+			++i;
+			j = alps_cancel_reservation(pjob);
+		}
+		if (j > 0) {
+			sprintf(log_buffer,
+				"Timed out after %d attempts over "
+				"%ld seconds of attempting "
+				"to cancel ALPS reservation %ld",
+				i, total_time,
+				pjob->ji_extended.ji_ext.ji_reservation);
+			log_joberr(-1, __func__, log_buffer,
+				pjob->ji_qs.ji_jobid);
+			/* send a HUP to main MOM so she re-reads
+			 * the ALPS inventory
 			 */
-			req_reject(PBSE_ALPSRELERR, j, pjob->ji_preq);
+			parent_pid = getppid();
+			kill(parent_pid, SIGHUP);
+
+		} else if ((j == 0) && (i > 1)) {
+			sprintf(log_buffer,
+				"Cancelled ALPS reservation %ld after a "
+				"total of %d tries",
+				pjob->ji_extended.ji_ext.ji_reservation, i);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB,
+				LOG_DEBUG, pjob->ji_qs.ji_jobid,
+				log_buffer);
+		}
+
+		/* exit with the respective error code to the parent process
+		 * Parents (moms) post handler will handle this
+		 */
+		exit(j);
+
+	} else if (pid > 0) {
+		/* we are the parent, the reply happens after the child exits */
+		if ((wtask = set_task(WORK_Deferred_Child, pid,
+				post_alps_cancel_resv, pjob->ji_preq)) == NULL) {
+			log_err(errno, NULL, "Failed to create deferred work task, Out of memory");
+			req_reject(PBSE_SYSTEM, 0, pjob->ji_preq);
 		}
-	} else if (j < 0) {
-		/* ALPS returned a PERMANENT error */
-		req_reject(PBSE_ALPSRELERR, j, pjob->ji_preq);
 	} else {
-		/* The reservation was canceled, let server know */
-		reply_ack(pjob->ji_preq);
+		/* fork failed, try once from here so the job
+		 * doesn't stay in the "E" state
+		 */
+		if ((j = alps_cancel_reservation(pjob)) == 0)
+			reply_ack(pjob->ji_preq);
+		else
+			req_reject(PBSE_ALPSRELERR, j, pjob->ji_preq);
 	}
 	pjob->ji_preq = NULL;
 #endif
@@ -1576,6 +1612,28 @@ send_sisters_deljob_wait(job *pjob)
 
 }
 
+/**
+ * @brief
+ * 		Tell whether the resource usage of a job is worth sampling,
+ *		i.e. the job has processes that may still be accounted for.
+ *
+ * @param[in]	pjob - the job
+ *
+ * @return	int
+ * @retval	1	usage should be updated
+ * @retval	0	job is not yet running or already past its obit
+ */
+static int
+job_wants_use(job *pjob)
+{
+	if ((check_job_state(pjob, JOB_STATE_LTR_EXITING) &&
+			(get_job_substate(pjob) >= JOB_SUBSTATE_OBIT ||
+					get_job_substate(pjob) == JOB_SUBSTATE_EXITED)) ||
+		(check_job_state(pjob, JOB_STATE_LTR_RUNNING) && get_job_substate(pjob) <= JOB_SUBSTATE_PRERUN))
+		return 0;
+	return 1;
+}
+
 /**
  * @brief
  * 		Convenience function to call mom_set_use() when all jobs need to be updated
@@ -1589,23 +1647,150 @@ mom_set_use_all(void)
 	job *pjob = NULL;
 
 	if (!mock_run) {
-		if (mom_get_sample() == PBSE_NONE) {
+		if (mom_begin_sample() == PBSE_NONE) {
 			pjob = (job *) GET_NEXT(svr_alljobs);
 			while (pjob) {
-				if ((check_job_state(pjob, JOB_STATE_LTR_EXITING) &&
-						(get_job_substate(pjob) >= JOB_SUBSTATE_OBIT ||
-								get_job_substate(pjob) == JOB_SUBSTATE_EXITED)) ||
-					(check_job_state(pjob, JOB_STATE_LTR_RUNNING) && get_job_substate(pjob) <= JOB_SUBSTATE_PRERUN)) {
-					pjob = (job *)GET_NEXT(pjob->ji_alljobs);
-					continue;
-				}
-				mom_set_use(pjob);
+				if (job_wants_use(pjob))
+					mom_set_use(pjob);
 				pjob = (job *)GET_NEXT(pjob->ji_alljobs);
 			}
 		}
 	}
 }
 
+/**
+ * @brief
+ * 		Update the resource usage of a single job, taking a new
+ *		process sample only the first time it is called for a
+ *		given reaping pass.
+ *
+ * @param[in]		pjob - the job to update
+ * @param[in,out]	sampled - 0 if no sample has been taken yet in this
+ *				  pass, set to 1 once one has (or failed to)
+ *
+ * @return	void
+ */
+void
+mom_set_use_job(job *pjob, int *sampled)
+{
+	static int sample_ok = 0;
+
+	if (mock_run || !job_wants_use(pjob))
+		return;
+	if (*sampled == 0) {
+		sample_ok = (mom_begin_sample() == PBSE_NONE);
+		*sampled = 1;
+	}
+	if (sample_ok)
+		mom_set_use(pjob);
+}
+
+/* child pid (task session leader or ji_momsubt) -> id of the owning job */
+static void *pid_idx = NULL;
+
+/**
+ * @brief
+ * 		Remember that the child process pid belongs to pjob so that
+ *		find_pid_owner() can map it back without walking every job
+ *		on the node.  Must be called in the parent after a fork that
+ *		sets ji_momsubt or a task's ti_sid.
+ *
+ * @param[in]	pjob - the job owning the child
+ * @param[in]	pid - the pid of the child
+ *
+ * @return	void
+ */
+void
+track_job_pid(job *pjob, pid_t pid)
+{
+	void *key = &pid;
+	char *jobid = NULL;
+
+	if (pjob == NULL || pid <= 0)
+		return;
+	if (pid_idx == NULL) {
+		pid_idx = pbs_idx_create(0, sizeof(pid_t));
+		if (pid_idx == NULL) {
+			log_err(errno, __func__, "Creating pid index failed");
+			return;
+		}
+	}
+	if (pbs_idx_find(pid_idx, &key, (void **)&jobid, NULL) == PBS_IDX_RET_OK) {
+		pbs_idx_delete(pid_idx, key);
+		free(jobid);
+	}
+	if ((jobid = strdup(pjob->ji_qs.ji_jobid)) == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		return;
+	}
+	if (pbs_idx_insert(pid_idx, key, jobid) != PBS_IDX_RET_OK)
+		free(jobid);
+}
+
+/**
+ * @brief
+ * 		Find the job, and the task if any, that a terminated child
+ *		belongs to.  The pid index built by track_job_pid() is tried
+ *		first and its entry is consumed; the list of all jobs is only
+ *		walked if the index has no valid answer.
+ *
+ * @param[in]	pid - the pid of the terminated child
+ * @param[out]	pptask - set to the task whose session leader is pid, or
+ *			 NULL if pid is the job's ji_momsubt
+ *
+ * @return	job *
+ * @retval	the owning job
+ * @retval	NULL if pid is not tracked by any job
+ */
+job *
+find_pid_owner(pid_t pid, task **pptask)
+{
+	job *pjob = NULL;
+	task *ptask = NULL;
+	void *key = &pid;
+	char *jobid = NULL;
+
+	*pptask = NULL;
+	if (pid_idx != NULL &&
+		pbs_idx_find(pid_idx, &key, (void **)&jobid, NULL) == PBS_IDX_RET_OK) {
+		pbs_idx_delete(pid_idx, key);
+		pjob = find_job(jobid);
+		free(jobid);
+		if (pjob != NULL) {
+			if (pid == pjob->ji_momsubt)
+				return pjob;
+			for (ptask = (task *)GET_NEXT(pjob->ji_tasks); ptask;
+				ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+				if (ptask->ti_qs.ti_sid == pid) {
+					*pptask = ptask;
+					return pjob;
+				}
+			}
+		}
+	}
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		/*
+		 ** see if process was a child doing a special
+		 ** function for MOM
+		 */
+		if (pid == pjob->ji_momsubt)
+			return pjob;
+		/*
+		 ** look for task
+		 */
+		for (ptask = (task *)GET_NEXT(pjob->ji_tasks); ptask;
+			ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+			if (ptask->ti_qs.ti_sid == pid) {
+				*pptask = ptask;
+				return pjob;
+			}
+		}
+	}
+	return NULL;
+}
+
 /**
  * @brief	Wrapper function to job purge
  *
@@ -310,6 +310,13 @@ static int basil_1_7_supported;
  */
 static basil_version_t basilver = 0;
 
+/*
+ * Set once an ENGINE query has found a BASIL version to speak, so later
+ * inventories skip the query. Cleared when a request in that version
+ * fails, in case ALPS was upgraded underneath us.
+ */
+static int basil_engine_known = 0;
+
 /**
  * Versions of BASIL that PBS supports.
  * It is a smaller subset that what ALPS likely provides in
@@ -6608,6 +6615,8 @@ alps_engine_query(void)
 		}
 	}
 
+	basil_engine_known = found_ver;
+
 	/*
 	 * We didn't find the right BASIL version.
 	 * Set basilversion to "UNDEFINED"
@@ -6651,8 +6660,9 @@ alps_inventory(void)
 	basil_response_t *brp;
 	first_compute_node = 1;
 
-	/* Determine what BASIL version we should speak */
-	alps_engine_query();
+	/* Determine what BASIL version we should speak, unless already known */
+	if (!basil_engine_known)
+		alps_engine_query();
 	new_alps_req();
 	sprintf(requestBuffer, "<?xml version=\"1.0\"?>\n"
 		"<" BASIL_ELM_REQUEST " "
@@ -6663,8 +6673,11 @@ alps_inventory(void)
 		sprintf(log_buffer, "ALPS inventory request failed.");
 		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
 			LOG_NOTICE, __func__, log_buffer);
+		basil_engine_known = 0;
 		return -1;
 	}
+	if (*brp->error != '\0')
+		basil_engine_known = 0;
 	if (basil_inventory != NULL)
 		free(basil_inventory);
 	basil_inventory = strdup(alps_client_out);
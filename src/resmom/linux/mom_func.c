@@ -69,6 +69,8 @@ extern char	*ret_string;
 
 extern void debug_report(void);
 extern void	scan_for_exiting(void);
+extern int	proc_exit_pending;
+extern void	scan_for_proc_exits(void);
 extern int read_config(char *);
 extern void cleanup(void);
 extern void initialize(void);
@@ -133,6 +135,8 @@ finish_loop(time_t waittime)
 		scan_for_terminated();
 		waittime = 1;	/* want faster time around to next loop */
 	}
+	if (proc_exit_pending)
+		scan_for_proc_exits();
 	if (exiting_tasks) {
 		scan_for_exiting();
 		waittime = 1;	/* want faster time around to next loop */
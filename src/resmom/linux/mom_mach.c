@@ -69,6 +69,11 @@
 #include <sys/utsname.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <mntent.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
 
 #include "pbs_error.h"
 #include "portability.h"
@@ -82,6 +87,7 @@
 #include "resmon.h"
 #include "../rm_dep.h"
 #include "tpp.h"
+#include "net_connect.h"
 #include "pbs_license.h"
 #include "pbs_ifl.h"
 #include "placementsets.h"
@@ -136,11 +142,37 @@ static long	hz;
 #define	JTOS(x)	(((x) + (hz/2)) / hz)
 
 static char	*choose_procflagsfmt(void);
+static void	proc_events_open(void);
 
 proc_stat_t	*proc_info = NULL;
 int		nproc = 0;
 int		max_proc = 0;
 
+/*
+ ** Index of proc_info by session id and by parent pid, rebuilt after each
+ ** sample.  Each hash bucket heads a chain of proc_info indexes linked
+ ** through proc_sid_next[] or proc_ppid_next[], in proc_info order.
+ */
+#define	PROC_HASH_MIN	256
+#define	PROC_HASH(x)	((unsigned int)(x) & (proc_hash_size - 1))
+static int	*proc_sid_head = NULL;
+static int	*proc_ppid_head = NULL;
+static int	*proc_sid_next = NULL;
+static int	*proc_ppid_next = NULL;
+static int	*proc_lnk_idx = NULL;	/* proc_info index -> Proc_lnks index */
+static int	proc_lnk_max = 0;
+static int	proc_hash_size = 0;
+static int	proc_next_max = 0;
+static int	proc_index_valid = 0;
+
+/*
+ ** Kernel proc connector, used to hear about the exit of task session
+ ** leaders that are not children of MoM without waiting for the next poll.
+ */
+static int	proc_event_fd = -1;
+int		proc_exit_pending = 0;
+extern pbs_list_head	svr_alljobs;
+
 extern	char	*ret_string;
 extern	char	extra_parm[];
 extern	char	no_parm[];
@@ -201,6 +233,20 @@ pbs_plinks	*Proc_lnks = NULL;	/* process links table head */
 static time_t	sampletime_ceil;
 static time_t	sampletime_floor;
 
+/*
+ ** Per-job cgroup accounting.  The cgroups hook places every job under
+ ** <mount>/<prefix>.service/jobid/<jobid>; when those directories exist
+ ** the polling loop reads the job's usage from them instead of walking
+ ** all of /proc.
+ */
+char	mom_cgroup_prefix[MAXPATHLEN + 1] = "pbs_jobs";
+static char	cg_cpu_root[MAXPATHLEN + 1];	/* cpuacct (v1) or unified (v2) mount */
+static char	cg_mem_root[MAXPATHLEN + 1];	/* memory (v1) or unified (v2) mount */
+static char	*cg_cpu_pfx = "cpuacct.";	/* v1 file name prefix, "" if noprefix */
+static char	*cg_mem_pfx = "memory.";
+static int	cg_unified = 0;			/* cgroup v2 hierarchy in use */
+static int	proc_sample_stale = 0;		/* proc_info predates the current poll */
+
 /*
  ** local resource array
  */
@@ -440,6 +486,193 @@ dep_topology(void)
 	}
 }
 
+/**
+ * @brief
+ *	Locate the cgroup hierarchies used for per-job accounting.
+ *
+ * @par
+ *	Prefers the v1 cpuacct and memory controllers when both are mounted,
+ *	otherwise falls back to a v2 unified hierarchy.  If neither is found
+ *	cg_cpu_root is left empty and sampling walks /proc as before.
+ *
+ * @return	Void
+ *
+ */
+static void
+cgroup_get_mounts(void)
+{
+	FILE		*fp;
+	struct mntent	*ent;
+	char		v2_root[MAXPATHLEN + 1];
+
+	cg_cpu_root[0] = '\0';
+	cg_mem_root[0] = '\0';
+	v2_root[0] = '\0';
+	cg_unified = 0;
+
+	if ((fp = setmntent("/proc/mounts", "r")) == NULL)
+		return;
+	while ((ent = getmntent(fp)) != NULL) {
+		if (strcmp(ent->mnt_type, "cgroup2") == 0) {
+			snprintf(v2_root, sizeof(v2_root), "%s", ent->mnt_dir);
+		} else if (strcmp(ent->mnt_type, "cgroup") == 0) {
+			if (hasmntopt(ent, "cpuacct") != NULL) {
+				snprintf(cg_cpu_root, sizeof(cg_cpu_root), "%s", ent->mnt_dir);
+				cg_cpu_pfx = hasmntopt(ent, "noprefix") ? "" : "cpuacct.";
+			}
+			if (hasmntopt(ent, "memory") != NULL) {
+				snprintf(cg_mem_root, sizeof(cg_mem_root), "%s", ent->mnt_dir);
+				cg_mem_pfx = hasmntopt(ent, "noprefix") ? "" : "memory.";
+			}
+		}
+	}
+	endmntent(fp);
+
+	if ((cg_cpu_root[0] == '\0') || (cg_mem_root[0] == '\0')) {
+		cg_cpu_root[0] = '\0';
+		cg_mem_root[0] = '\0';
+		if (v2_root[0] != '\0') {
+			strcpy(cg_cpu_root, v2_root);
+			strcpy(cg_mem_root, v2_root);
+			cg_unified = 1;
+		}
+	}
+	if (cg_cpu_root[0] != '\0') {
+		snprintf(log_buffer, sizeof(log_buffer), "job usage from cgroup %s accounting under %s",
+			cg_unified ? "v2" : "v1", cg_cpu_root);
+		log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__, log_buffer);
+	}
+}
+
+/**
+ * @brief
+ *	Read a number from a cgroup accounting file.
+ *
+ * @param[in]	dir - cgroup directory of the job
+ * @param[in]	file - file name within dir
+ * @param[in]	key - if not NULL, read the value of the "key value" line,
+ *			otherwise the first number in the file
+ * @param[out]	val - value read
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	file missing or value not found
+ *
+ */
+static int
+cgroup_read_value(char *dir, char *file, char *key, unsigned long long *val)
+{
+	FILE	*fp;
+	char	path[MAXPATHLEN + 1];
+	char	name[64];
+	int	rc = -1;
+	int	n;
+
+	n = snprintf(path, sizeof(path), "%s/%s", dir, file);
+	if ((n < 0) || (n >= sizeof(path)))
+		return -1;
+	if ((fp = fopen(path, "r")) == NULL)
+		return -1;
+	if (key == NULL) {
+		if (fscanf(fp, "%llu", val) == 1)
+			rc = 0;
+	} else {
+		while (fscanf(fp, "%63s %llu", name, val) == 2) {
+			if (strcmp(name, key) == 0) {
+				rc = 0;
+				break;
+			}
+		}
+	}
+	fclose(fp);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Get the cpu time and memory used by a job from its cgroup.
+ *
+ * @param[in]	pjob - job pointer
+ * @param[out]	cput - cpu seconds, adjusted by cputfactor
+ * @param[out]	mem - resident memory in bytes, excluding reclaimable page cache
+ * @param[out]	vmem - memory plus swap in bytes
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	no usable cgroup for the job, or it holds no processes;
+ *			the caller must use the /proc sample, which also
+ *			detects tasks that have exited
+ *
+ */
+static int
+cgroup_job_usage(job *pjob, ulong *cput, ulong *mem, ulong *vmem)
+{
+	char			cpudir[MAXPATHLEN + 1];
+	char			memdir[MAXPATHLEN + 1];
+	char			path[MAXPATHLEN + 1];
+	char			file[64];
+	unsigned long long	usage;
+	unsigned long long	inactive = 0;
+	unsigned long long	swap = 0;
+	FILE			*fp;
+	int			c;
+	int			n;
+
+	if (cg_cpu_root[0] == '\0')
+		return -1;
+
+	/* a truncated path would name some other file, use /proc instead */
+	n = snprintf(cpudir, sizeof(cpudir), "%s/%s.service/jobid/%s",
+		cg_cpu_root, mom_cgroup_prefix, pjob->ji_qs.ji_jobid);
+	if ((n < 0) || (n >= sizeof(cpudir)))
+		return -1;
+	n = snprintf(memdir, sizeof(memdir), "%s/%s.service/jobid/%s",
+		cg_mem_root, mom_cgroup_prefix, pjob->ji_qs.ji_jobid);
+	if ((n < 0) || (n >= sizeof(memdir)))
+		return -1;
+
+	n = snprintf(path, sizeof(path), "%s/cgroup.procs", cpudir);
+	if ((n < 0) || (n >= sizeof(path)))
+		return -1;
+	if ((fp = fopen(path, "r")) == NULL)
+		return -1;
+	c = fgetc(fp);
+	fclose(fp);
+	if (c == EOF)
+		return -1;
+
+	if (cg_unified) {
+		if (cgroup_read_value(cpudir, "cpu.stat", "usage_usec", &usage) != 0)
+			return -1;
+		*cput = (ulong)((double)(usage / 1000000) * cputfactor);
+
+		if (cgroup_read_value(memdir, "memory.current", NULL, &usage) != 0)
+			return -1;
+		(void)cgroup_read_value(memdir, "memory.stat", "inactive_file", &inactive);
+		(void)cgroup_read_value(memdir, "memory.swap.current", NULL, &swap);
+		*vmem = usage + swap;
+	} else {
+		snprintf(file, sizeof(file), "%susage", cg_cpu_pfx);
+		if (cgroup_read_value(cpudir, file, NULL, &usage) != 0)
+			return -1;
+		*cput = (ulong)((double)(usage / 1000000000) * cputfactor);
+
+		snprintf(file, sizeof(file), "%susage_in_bytes", cg_mem_pfx);
+		if (cgroup_read_value(memdir, file, NULL, &usage) != 0)
+			return -1;
+		snprintf(file, sizeof(file), "%sstat", cg_mem_pfx);
+		(void)cgroup_read_value(memdir, file, "total_inactive_file", &inactive);
+		/* memsw counts memory plus swap; absent when swap accounting is off */
+		snprintf(file, sizeof(file), "%smemsw.usage_in_bytes", cg_mem_pfx);
+		if ((cgroup_read_value(memdir, file, NULL, &swap) == 0) && (swap > usage))
+			*vmem = swap;
+		else
+			*vmem = usage;
+	}
+	*mem = (inactive < usage) ? usage - inactive : usage;
+	return 0;
+}
+
 /**
  * @brief
  *	initialize the platform-dependent topology information
@@ -459,6 +692,8 @@ dep_initialize(void)
 
 	proc_get_btime();
 
+	cgroup_get_mounts();
+
 	/*
 	 ** The global cpu counts are now set in ncpus()
 	 */
@@ -487,27 +722,150 @@ dep_cleanup(void)
 
 /**
  * @brief
- *	 Scan a list of tasks and return true if one of them matches sid
+ *	Build the session and parent pid index of the current proc_info sample.
+ *
+ * @par
+ *	On allocation failure the index stays invalid and the lookup
+ *	functions fall back to scanning proc_info.
+ *
+ * @return	Void
+ *
+ */
+static void
+proc_index_build(void)
+{
+	int	size;
+	int	i;
+	int	h;
+	void	*hold;
+
+	proc_index_valid = 0;
+
+	for (size = PROC_HASH_MIN; size < 2 * nproc; size <<= 1)
+		;
+	if (size != proc_hash_size) {
+		if ((hold = realloc(proc_sid_head, size * sizeof(int))) == NULL)
+			return;
+		proc_sid_head = (int *)hold;
+		if ((hold = realloc(proc_ppid_head, size * sizeof(int))) == NULL)
+			return;
+		proc_ppid_head = (int *)hold;
+		proc_hash_size = size;
+	}
+	if (proc_next_max < max_proc) {
+		if ((hold = realloc(proc_sid_next, max_proc * sizeof(int))) == NULL)
+			return;
+		proc_sid_next = (int *)hold;
+		if ((hold = realloc(proc_ppid_next, max_proc * sizeof(int))) == NULL)
+			return;
+		proc_ppid_next = (int *)hold;
+		proc_next_max = max_proc;
+	}
+
+	for (i = 0; i < proc_hash_size; i++) {
+		proc_sid_head[i] = -1;
+		proc_ppid_head[i] = -1;
+	}
+	/* insert backwards so each chain is in proc_info order */
+	for (i = nproc - 1; i >= 0; i--) {
+		h = PROC_HASH(proc_info[i].session);
+		proc_sid_next[i] = proc_sid_head[h];
+		proc_sid_head[h] = i;
+		h = PROC_HASH(proc_info[i].ppid);
+		proc_ppid_next[i] = proc_ppid_head[h];
+		proc_ppid_head[h] = i;
+	}
+	proc_index_valid = 1;
+}
+
+/**
+ * @brief
+ *	Return the proc_info index of the next process in session sid.
  *
- * @param[in] pjob - job pointer
  * @param[in] sid - session id
+ * @param[in] prev - index returned by the previous call, or -1 to start
+ *
+ * @return	int
+ * @retval	index of the next process in the session
+ * @retval	-1	no more processes
+ *
+ */
+static int
+proc_next_in_session(pid_t sid, int prev)
+{
+	int	i;
+
+	if (!proc_index_valid)
+		proc_index_build();
+	if (!proc_index_valid) {
+		for (i = prev + 1; i < nproc; i++) {
+			if (proc_info[i].session == sid)
+				return i;
+		}
+		return -1;
+	}
+
+	i = (prev < 0) ? proc_sid_head[PROC_HASH(sid)] : proc_sid_next[prev];
+	while ((i >= 0) && (proc_info[i].session != sid))
+		i = proc_sid_next[i];
+	return i;
+}
+
+/**
+ * @brief
+ *	Return the proc_info index of the next child of process ppid.
+ *
+ * @param[in] ppid - parent process id
+ * @param[in] prev - index returned by the previous call, or -1 to start
+ *
+ * @return	int
+ * @retval	index of the next child process
+ * @retval	-1	no more children
+ *
+ */
+static int
+proc_next_child(pid_t ppid, int prev)
+{
+	int	i;
+
+	if (!proc_index_valid)
+		proc_index_build();
+	if (!proc_index_valid) {
+		for (i = prev + 1; i < nproc; i++) {
+			if (proc_info[i].ppid == ppid)
+				return i;
+		}
+		return -1;
+	}
+
+	i = (prev < 0) ? proc_ppid_head[PROC_HASH(ppid)] : proc_ppid_next[prev];
+	while ((i >= 0) && (proc_info[i].ppid != ppid))
+		i = proc_ppid_next[i];
+	return i;
+}
+
+/**
+ * @brief
+ *	Check whether a task of the job earlier in the task list has the
+ *	same session, so that its processes are counted only once.
+ *
+ * @param[in] pjob - job pointer
+ * @param[in] ptask - task whose session is checked
  *
  * @return	Bool
- * @retval	TRUE
- * @retval	FALSE	Error
+ * @retval	TRUE	session already seen
+ * @retval	FALSE	first task with this session
  *
  */
 static int
-injob(job *pjob, pid_t sid)
+session_seen(job *pjob, task *ptask)
 {
-	task	*ptask;
+	task	*pt;
 
-	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
-		ptask;
-		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
-		if (ptask->ti_qs.ti_sid <= 1)
-			continue;
-		if (ptask->ti_qs.ti_sid == sid)
+	for (pt = (task *)GET_NEXT(pjob->ji_tasks);
+		pt != NULL && pt != ptask;
+		pt = (task *)GET_NEXT(pt->ti_jobtask)) {
+		if (pt->ti_qs.ti_sid == ptask->ti_qs.ti_sid)
 			return TRUE;
 	}
 	return FALSE;
@@ -549,13 +907,11 @@ cput_sum(job *pjob)
 		active_tasks++;
 		tcput = 0;
 		taskprocs = 0;
-		for (i=0; i<nproc; i++) {
+		for (i = proc_next_in_session(ptask->ti_qs.ti_sid, -1);
+			i >= 0;
+			i = proc_next_in_session(ptask->ti_qs.ti_sid, i)) {
 			ps = &proc_info[i];
 
-			/* is this process part of the task? */
-			if (ptask->ti_qs.ti_sid != ps->session)
-				continue;
-
 			nps++;
 			taskprocs++;
 
@@ -695,18 +1051,23 @@ mem_sum(job *pjob)
 	int		i;
 	ulong		segadd;
 	proc_stat_t	*ps;
+	task		*ptask;
 
 	segadd = 0;
 
-	for (i=0; i<nproc; i++) {
-
-		ps = &proc_info[i];
-
-		if (!injob(pjob, ps->session))
+	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+		ptask != NULL;
+		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+		if ((ptask->ti_qs.ti_sid <= 1) || session_seen(pjob, ptask))
 			continue;
-		segadd += ps->vsize;
-		DBPRT(("%s: pid: %d  pr_size: %lu  total: %lu\n",
-			__func__, ps->pid, (ulong)ps->vsize, segadd))
+		for (i = proc_next_in_session(ptask->ti_qs.ti_sid, -1);
+			i >= 0;
+			i = proc_next_in_session(ptask->ti_qs.ti_sid, i)) {
+			ps = &proc_info[i];
+			segadd += ps->vsize;
+			DBPRT(("%s: pid: %d  pr_size: %lu  total: %lu\n",
+				__func__, ps->pid, (ulong)ps->vsize, segadd))
+		}
 	}
 
 	return (segadd);
@@ -729,16 +1090,20 @@ resi_sum(job *pjob)
 	int		i;
 	ulong		resisize;
 	proc_stat_t	*ps;
+	task		*ptask;
 
 	resisize = 0;
-	for (i=0; i<nproc; i++) {
-
-		ps = &proc_info[i];
-
-		if (!injob(pjob, ps->session))
+	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+		ptask != NULL;
+		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+		if ((ptask->ti_qs.ti_sid <= 1) || session_seen(pjob, ptask))
 			continue;
-
-		resisize += ps->rss * pagesize;
+		for (i = proc_next_in_session(ptask->ti_qs.ti_sid, -1);
+			i >= 0;
+			i = proc_next_in_session(ptask->ti_qs.ti_sid, i)) {
+			ps = &proc_info[i];
+			resisize += ps->rss * pagesize;
+		}
 	}
 
 	return (resisize);
@@ -942,6 +1307,9 @@ mom_open_poll(void)
 	}
 	max_proc = TBL_INC;
 
+	if (!mock_run)
+		proc_events_open();
+
 	return (PBSE_NONE);
 }
 
@@ -983,6 +1351,11 @@ mom_get_sample(void)
 
 	rewinddir(pdir);
 	nproc = 0;
+	proc_index_valid = 0;
+	if (proc_event_fd != -1) {
+		close_conn(proc_event_fd);
+		proc_event_fd = -1;
+	}
 	fd = NULL;
 	if (hz == 0)
 		hz = sysconf(_SC_CLK_TCK);
@@ -1097,6 +1470,37 @@ mom_get_sample(void)
 		nprocs - 2, ncantstat, nnomem, nskipped,
 		ncached);
 	log_event(PBSEVENT_DEBUG4, 0, LOG_DEBUG, __func__, log_buffer);
+	proc_index_build();
+	proc_sample_stale = 0;
+	return (PBSE_NONE);
+}
+
+/**
+ * @brief
+ * 	Declare start of the periodic resource polling loop.
+ *
+ * @par
+ *	When per-job cgroup accounting is available the /proc walk is
+ *	deferred: mom_set_use() reads each job's cgroup and only takes a
+ *	/proc sample for a job whose cgroup cannot be read.
+ *
+ * @return	int
+ * @retval	PBSE_NONE	Success
+ * @retval	other		error from mom_get_sample()
+ *
+ */
+int
+mom_begin_sample(void)
+{
+	extern time_t	time_last_sample;
+
+	if (mock_run || (cg_cpu_root[0] == '\0'))
+		return (mom_get_sample());
+
+	time_last_sample = time(0);
+	sampletime_floor = time_last_sample;
+	sampletime_ceil = time_last_sample;
+	proc_sample_stale = 1;
 	return (PBSE_NONE);
 }
 
@@ -1128,6 +1532,8 @@ mom_set_use(job *pjob)
 	u_Long 		*lp_sz, lnum_sz;
 	ulong		*lp, lnum, oldcput;
 	long		ncpus_req;
+	ulong		cg_cput, cg_mem, cg_vmem;
+	int		use_cgroup;
 
 	assert(pjob != NULL);
 	at = &pjob->ji_wattr[(int)JOB_ATR_resc_used];
@@ -1140,6 +1546,10 @@ mom_set_use(job *pjob)
 
 	at->at_flags |= (ATR_VFLAG_MODIFY|ATR_VFLAG_SET);
 
+	use_cgroup = (cgroup_job_usage(pjob, &cg_cput, &cg_mem, &cg_vmem) == 0);
+	if (!use_cgroup && proc_sample_stale)
+		(void)mom_get_sample();
+
 	rd = &svr_resc_def[RESC_NCPUS];
 	pres = find_resc_entry(at, rd);
 	if (pres == NULL) {
@@ -1173,7 +1583,7 @@ mom_set_use(job *pjob)
 	}
 	lp = (ulong *)&pres->rs_value.at_val.at_long;
 	oldcput = *lp;
-	lnum = cput_sum(pjob);
+	lnum = use_cgroup ? cg_cput : cput_sum(pjob);
 	lnum = MAX(*lp, lnum);
 	if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		/* don't conflict with hook setting a value */
@@ -1205,7 +1615,7 @@ mom_set_use(job *pjob)
 		pres->rs_value.at_val.at_size.atsv_units = ATR_SV_BYTESZ;
 	} else if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		lp_sz = &pres->rs_value.at_val.at_size.atsv_num;
-		lnum_sz = (mem_sum(pjob) + 1023) >> 10;		/* as KB */
+		lnum_sz = ((use_cgroup ? cg_vmem : mem_sum(pjob)) + 1023) >> 10; /* as KB */
 		*lp_sz = MAX(*lp_sz, lnum_sz);
 	}
 
@@ -1222,7 +1632,7 @@ mom_set_use(job *pjob)
 		pres->rs_value.at_val.at_size.atsv_units = ATR_SV_BYTESZ;
 	} else if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		lp_sz = &pres->rs_value.at_val.at_size.atsv_num;
-		lnum_sz = (resi_sum(pjob) + 1023) >> 10; /* as KB */
+		lnum_sz = ((use_cgroup ? cg_mem : resi_sum(pjob)) + 1023) >> 10; /* as KB */
 		*lp_sz = MAX(*lp_sz, lnum_sz);
 	}
 
@@ -1262,43 +1672,60 @@ bld_ptree(pid_t sid)
 	 * First, load with the processes in the session.
 	 */
 
+	if (proc_lnk_max < max_proc) {
+		void	*hold;
+
+		hold = realloc((void *)proc_lnk_idx, max_proc * sizeof(int));
+		assert(hold != NULL);
+		proc_lnk_idx = (int *)hold;
+		proc_lnk_max = max_proc;
+	}
+
 	myproc_ct = 0;
-	for (i = 0; i < nproc; i++) {
+	for (i = proc_next_in_session(sid, -1); i >= 0;
+		i = proc_next_in_session(sid, i)) {
 		if (PBS_PROC_PID(i) <= 1)
 			continue;
-		if ((int)PBS_PROC_SID(i) == sid) {
-			Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
-			Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
-			Proc_lnks[myproc_ct].pl_parent = -1;
-			Proc_lnks[myproc_ct].pl_sib = -1;
-			Proc_lnks[myproc_ct].pl_child = -1;
-			Proc_lnks[myproc_ct].pl_done = 0;
-			if (++myproc_ct == myproc_max) {
-				void * hold;
-
-				myproc_max += TBL_INC;
-				hold = realloc((void *)Proc_lnks,
-					myproc_max*sizeof(pbs_plinks));
-				assert(hold != NULL);
-				Proc_lnks = (pbs_plinks *)hold;
-			}
+		proc_lnk_idx[i] = myproc_ct;
+		Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
+		Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
+		Proc_lnks[myproc_ct].pl_parent = -1;
+		Proc_lnks[myproc_ct].pl_sib = -1;
+		Proc_lnks[myproc_ct].pl_child = -1;
+		Proc_lnks[myproc_ct].pl_done = 0;
+		if (++myproc_ct == myproc_max) {
+			void * hold;
+
+			myproc_max += TBL_INC;
+			hold = realloc((void *)Proc_lnks,
+				myproc_max*sizeof(pbs_plinks));
+			assert(hold != NULL);
+			Proc_lnks = (pbs_plinks *)hold;
 		}
 	}
 
-	/* Now build the tree for those processes */
+	/*
+	 * Now build the tree for those processes, finding the children
+	 * of each through the parent pid index.
+	 */
+	for (i = proc_next_in_session(sid, -1); i >= 0;
+		i = proc_next_in_session(sid, i)) {
+		int	parent;
 
-	for (i = 0; i < myproc_ct; i++) {
-		/*
-		 * Find all the children for this process, establish links.
-		 */
-		for (j = 0; j < myproc_ct; j++) {
-			if (j == i)
+		if (PBS_PROC_PID(i) <= 1)
+			continue;
+		parent = proc_lnk_idx[i];
+		for (j = proc_next_child(PBS_PROC_PID(i), -1); j >= 0;
+			j = proc_next_child(PBS_PROC_PID(i), j)) {
+			int	child;
+
+			if ((j == i) || (PBS_PROC_PID(j) <= 1) ||
+				((int)PBS_PROC_SID(j) != sid))
 				continue;
-			if (Proc_lnks[j].pl_ppid == Proc_lnks[i].pl_pid) {
-				Proc_lnks[j].pl_parent = i;
-				Proc_lnks[j].pl_sib = Proc_lnks[i].pl_child;
-				Proc_lnks[i].pl_child = j;
-			}
+			child = proc_lnk_idx[j];
+			Proc_lnks[child].pl_parent = parent;
+			Proc_lnks[child].pl_sib = Proc_lnks[parent].pl_child;
+			Proc_lnks[parent].pl_child = child;
 		}
 	}
 	return (myproc_ct);	/* number of processes in session */
@@ -1413,6 +1840,182 @@ kill_session(pid_t sesid, int sig, int dir)
 	return ct;
 }
 
+/**
+ * @brief
+ *	Flag the jobs owning a task whose session leader has exited, so that
+ *	scan_for_proc_exits() checks them on the next pass of the main loop.
+ *
+ * @param[in] pid - pid of the exited process, or -1 to flag every job
+ *
+ * @return	Void
+ *
+ */
+static void
+flag_task_exit(pid_t pid)
+{
+	job	*pjob;
+	task	*ptask;
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs);
+		pjob != NULL;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+			ptask != NULL;
+			ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
+			if (ptask->ti_qs.ti_status != TI_STATE_RUNNING)
+				continue;
+			if ((pid == -1) || (ptask->ti_qs.ti_sid == pid)) {
+				pjob->ji_flags |= MOM_TASK_EXITED;
+				proc_exit_pending = 1;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Read the pending messages on the proc connector socket.
+ *
+ * @param[in] fd - proc connector socket
+ *
+ * @return	Void
+ *
+ */
+static void
+proc_event_request(int fd)
+{
+	char			buf[8192] __attribute__ ((aligned(NLMSG_ALIGNTO)));
+	struct nlmsghdr		*nlh;
+	struct cn_msg		*cnm;
+	struct proc_event	*ev;
+	ssize_t			len;
+
+	for (;;) {
+		len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+		if (len == -1) {
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+				return;
+			if (errno == ENOBUFS) {
+				/* events were dropped, check every job */
+				flag_task_exit(-1);
+				continue;
+			}
+		}
+		if (len <= 0) {
+			log_err(errno, __func__, "proc connector closed");
+			close_conn(fd);
+			proc_event_fd = -1;
+			return;
+		}
+		for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len);
+			nlh = NLMSG_NEXT(nlh, len)) {
+			if ((nlh->nlmsg_type == NLMSG_NOOP) ||
+				(nlh->nlmsg_type == NLMSG_ERROR))
+				continue;
+			cnm = (struct cn_msg *)NLMSG_DATA(nlh);
+			if ((cnm->id.idx != CN_IDX_PROC) || (cnm->id.val != CN_VAL_PROC))
+				continue;
+			ev = (struct proc_event *)cnm->data;
+			if ((ev->what == PROC_EVENT_EXIT) &&
+				(ev->event_data.exit.process_pid ==
+				ev->event_data.exit.process_tgid))
+				flag_task_exit(ev->event_data.exit.process_tgid);
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Subscribe to process exit events from the kernel proc connector.
+ *
+ * @par
+ *	This is optional: if the connector is not available, for example
+ *	without CAP_NET_ADMIN, exits of tasks that are not children of MoM
+ *	are found by the periodic poll as before.
+ *
+ * @return	Void
+ *
+ */
+static void
+proc_events_open(void)
+{
+	struct sockaddr_nl	sa;
+	struct {
+		struct nlmsghdr	nlh;
+		struct cn_msg	cnm;
+		enum proc_cn_mcast_op	op;
+	} __attribute__ ((packed)) msg;
+	int			fd;
+
+	if ((fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+		NETLINK_CONNECTOR)) == -1) {
+		log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__,
+			"proc connector not available");
+		return;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.nl_family = AF_NETLINK;
+	sa.nl_groups = CN_IDX_PROC;
+	sa.nl_pid = 0;
+	if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) == -1)
+		goto fail;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.nlh.nlmsg_len = sizeof(msg);
+	msg.nlh.nlmsg_type = NLMSG_DONE;
+	msg.cnm.id.idx = CN_IDX_PROC;
+	msg.cnm.id.val = CN_VAL_PROC;
+	msg.cnm.len = sizeof(enum proc_cn_mcast_op);
+	msg.op = PROC_CN_MCAST_LISTEN;
+	if (send(fd, &msg, sizeof(msg), 0) == -1)
+		goto fail;
+
+	if (add_conn(fd, ChildPipe, (pbs_net_t)0, 0, NULL,
+		proc_event_request) == NULL)
+		goto fail;
+
+	proc_event_fd = fd;
+	log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__,
+		"listening for process exit events");
+	return;
+
+fail:
+	sprintf(log_buffer, "proc connector not available: %s", strerror(errno));
+	log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__, log_buffer);
+	(void)close(fd);
+}
+
+/**
+ * @brief
+ *	Check the jobs flagged by the proc connector for tasks whose
+ *	processes have all gone, marking those tasks exited so that
+ *	scan_for_exiting() can finish them.
+ *
+ * @return	Void
+ *
+ */
+void
+scan_for_proc_exits(void)
+{
+	job	*pjob;
+
+	proc_exit_pending = 0;
+	if (mom_get_sample() != PBSE_NONE)
+		return;
+
+	for (pjob = (job *)GET_NEXT(svr_alljobs);
+		pjob != NULL;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		if ((pjob->ji_flags & MOM_TASK_EXITED) == 0)
+			continue;
+		pjob->ji_flags &= ~MOM_TASK_EXITED;
+		if (check_job_substate(pjob, JOB_SUBSTATE_RUNNING))
+			(void)mom_set_use(pjob);
+	}
+}
+
 /**
  * @brief
  *	Clean up everything related to polling.
@@ -1438,6 +2041,8 @@ mom_close_poll(void)
 		proc_info = NULL;
 		max_proc = 0;
 	}
+	nproc = 0;
+	proc_index_valid = 0;
 
 	return (PBSE_NONE);
 }
@@ -1519,11 +2124,10 @@ cput_job(pid_t jobid)
 	proc_stat_t	*ps;
 
 	cputime = 0.0;
-	for (i=0; i<nproc; i++) {
+	for (i = proc_next_in_session(jobid, -1); i >= 0;
+		i = proc_next_in_session(jobid, i)) {
 
 		ps = &proc_info[i];
-		if (jobid != ps->session)
-			continue;
 
 		found = 1;
 		addtime = dsecs(ps->cutime) + dsecs(ps->cstime);
@@ -1640,12 +2244,10 @@ mem_job(pid_t sid)
 	memsize = 0;
 
 	mom_get_sample();
-	for (i=0; i<nproc; i++) {
+	for (i = proc_next_in_session(sid, -1); i >= 0;
+		i = proc_next_in_session(sid, i)) {
 
 		ps = &proc_info[i];
-
-		if (sid != ps->session)
-			continue;
 		memsize += ps->vsize;
 	}
 
@@ -1756,13 +2358,11 @@ resi_job(pid_t jobid)
 	resisize = 0;
 	mom_get_sample();
 
-	for (i=0; i<nproc; i++) {
+	for (i = proc_next_in_session(jobid, -1); i >= 0;
+		i = proc_next_in_session(jobid, i)) {
 
 		ps = &proc_info[i];
 
-		if (jobid != ps->session)
-			continue;
-
 		found = 1;
 		resisize += ps->rss;
 	}
@@ -2009,13 +2609,12 @@ pids(struct rm_attribute *attrib)
 	fmt = ret_string;
 	num_pids = 0;
 
-	for (i=0; i<nproc; i++) {
+	for (i = proc_next_in_session(jobid, -1); i >= 0;
+		i = proc_next_in_session(jobid, i)) {
 
 		ps = &proc_info[i];
 		DBPRT(("%s[%d]: pid: %d sid %d\n",
 			__func__, num_pids, ps->pid, ps->session))
-		if (jobid != ps->session)
-			continue;
 
 		sprintf(fmt, "%d ", ps->pid);
 		fmt += strlen(fmt);
@@ -92,9 +92,21 @@ extern int bld_ptree(pid_t sid);
 /* struct startjob_rtn = used to pass error/session/other info 	*/
 /* 			child back to parent			*/
 
+/* phases of a job launch timed by the job starter, see finish_exec() */
+enum sj_phase {
+	SJ_PHASE_FORK,		/* finish_exec() up to the starter running */
+	SJ_PHASE_SETUP,		/* environment, nodefile, TMPDIR, job directory */
+	SJ_PHASE_PROLOGUE,	/* execjob_prologue hooks or prologue script */
+	SJ_PHASE_LIMITS,	/* session, resource limits, site setup */
+	SJ_PHASE_LAUNCH,	/* execjob_launch hooks */
+	SJ_PHASE_START,		/* up to reporting the job as started */
+	SJ_PHASE_NUM
+};
+
 struct startjob_rtn {
 	int   sj_code;		/* error code	*/
 	pid_t sj_session;	/* session	*/
+	long  sj_phase_ms[SJ_PHASE_NUM];	/* milliseconds spent per launch phase */
 
 #if	MOM_ALPS
 	jid_t	sj_jid;
@@ -108,6 +120,10 @@ extern int mom_do_poll(job *pjob);		/* Should limits be polled? */
 extern int mom_does_chkpnt;                     /* see if mom does chkpnt */
 extern int mom_open_poll();		/* Initialize poll ability */
 extern int mom_get_sample();		/* Sample kernel poll data */
+extern int mom_begin_sample(void);	/* Start of polling loop */
+extern char mom_cgroup_prefix[];	/* cgroups hook directory prefix */
+extern int proc_exit_pending;		/* proc connector saw a task exit */
+extern void scan_for_proc_exits(void);	/* check jobs flagged by it */
 extern int mom_over_limit(job *pjob);	/* Is polled job over limit? */
 extern int mom_set_use(job *pjob);		/* Set resource_used list */
 extern int mom_close_poll();		/* Terminate poll ability */
@@ -663,17 +663,29 @@ scan_for_terminated(void)
 	task		*ptask = NULL;
 	struct work_task *wtask = NULL;
 	int		statloc;
-
-	/* update the latest intelligence about the running jobs;         */
-	/* must be done before we reap the zombies, else we lose the info */
+	int		sampled = 0;
+	siginfo_t	si;
 
 	termin_child = 0;
 
-	mom_set_use_all();
+	/*
+	 * Peek at each zombie before reaping it so that the usage of the job
+	 * it belongs to can be updated first; once reaped we lose the info.
+	 * Only the job owning the zombie is sampled, and only once per pass.
+	 */
+	for (;;) {
+		si.si_pid = 0;
+		if ((waitid(P_ALL, 0, &si, WEXITED | WNOHANG | WNOWAIT) == -1) ||
+			(si.si_pid == 0))
+			break;
+		pid = si.si_pid;
 
-	/* Now figure out which task(s) have terminated (are zombies) */
+		pjob = find_pid_owner(pid, &ptask);
+		if ((pjob != NULL) && (ptask != NULL))
+			mom_set_use_job(pjob, &sampled);
 
-	while ((pid = waitpid(-1, &statloc, WNOHANG)) > 0) {
+		if (waitpid(pid, &statloc, WNOHANG) != pid)
+			break;
 		if (WIFEXITED(statloc))
 			exiteval = WEXITSTATUS(statloc);
 		else if (WIFSIGNALED(statloc))
@@ -694,35 +706,13 @@ scan_for_terminated(void)
 			wtask = (struct work_task *)GET_NEXT(wtask->wt_linkall);
 		}
 
-		pjob = (job *)GET_NEXT(svr_alljobs);
-		while (pjob) {
-			/*
-			 ** see if process was a child doing a special
-			 ** function for MOM
-			 */
-			if (pid == pjob->ji_momsubt)
-				break;
-			/*
-			 ** look for task
-			 */
-			ptask = (task *)GET_NEXT(pjob->ji_tasks);
-			while (ptask) {
-				if (ptask->ti_qs.ti_sid == pid)
-					break;
-				ptask = (task *)GET_NEXT(ptask->ti_jobtask);
-			}
-			if (ptask != NULL)
-				break;
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs);
-		}
-
 		if (pjob == NULL) {
 			DBPRT(("%s: pid %d not tracked, exit %d\n",
 				__func__, pid, exiteval))
 			continue;
 		}
 
-		if (pid == pjob->ji_momsubt) {
+		if (ptask == NULL) {
 			pjob->ji_momsubt = 0;
 			if (pjob->ji_mompost) {
 				pjob->ji_mompost(pjob, exiteval);
@@ -65,13 +65,24 @@ extern time_t time_resc_updated;
 extern int min_check_poll;
 extern int next_sample_time;
 
+/**
+ * @brief	pretend to start a job in mock run mode
+ *
+ * @par
+ *	The job ends after its walltime or, if $mock_run_runtime is set, after
+ *	a runtime taken from that setting, whichever comes first.
+ *
+ * @param[in]	pjob - the job being started
+ * @return void
+ */
 void
 mock_run_finish_exec(job *pjob)
 {
 	resource_def *rd;
 	attribute *wallt;
 	resource *wall_req;
-	int walltime = 0;
+	long walltime = -1;
+	long runtime;
 
 	rd = &svr_resc_def[RESC_WALLTIME];
 	wallt = &pjob->ji_wattr[(int)JOB_ATR_resource];
@@ -81,14 +92,22 @@ mock_run_finish_exec(job *pjob)
 		start_walltime(pjob);
 	}
 
+	if (mock_run_runtime_min >= 0) {
+		runtime = mock_run_runtime_min;
+		if (mock_run_runtime_max > mock_run_runtime_min)
+			runtime += random() % (mock_run_runtime_max - mock_run_runtime_min + 1);
+		if (walltime >= 0 && walltime < runtime)
+			runtime = walltime;
+	} else
+		runtime = walltime > 0 ? walltime : 0;
+
 	time_now = time(NULL);
 
 	/* Add a work task that runs when the job is supposed to end */
-	set_task(WORK_Timed, time_now + walltime, mock_run_end_job_task, pjob);
+	set_task(WORK_Timed, time_now + runtime, mock_run_end_job_task, pjob);
 
-	sprintf(log_buffer, "Started mock run of job");
-	log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB,
-		LOG_INFO, pjob->ji_qs.ji_jobid, log_buffer);
+	log_eventf(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->ji_qs.ji_jobid,
+		"Started mock run of job, runtime %ld seconds", runtime);
 
 	mock_run_record_finish_exec(pjob);
 
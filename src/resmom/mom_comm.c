@@ -1768,17 +1768,12 @@ if (reply) { \
 hnodent *
 find_node(job *pjob, int stream, tm_node_id vnodeid)
 {
-	int			i;
 	vmpiprocs		*vp;
 	hnodent			*hp;
 	struct  sockaddr_in     *node_addr;
 	struct  sockaddr_in     *stream_addr;
 
-	for (vp=pjob->ji_vnods, i=0; i<pjob->ji_numvnod; vp++, i++) {
-		if (vp->vn_node == vnodeid)
-			break;
-	}
-	if (i == pjob->ji_numvnod) {
+	if ((vp = find_vmpiproc(pjob, vnodeid)) == NULL) {
 		sprintf(log_buffer, "node %d not found", vnodeid);
 		log_joberr(-1, __func__, log_buffer, pjob->ji_qs.ji_jobid);
 		return NULL;
@@ -4180,29 +4175,22 @@ join_err:
 #ifdef PMIX
 		case	IM_PMIX:
 			/*
-			 * Sender is MOM requesting a PMIX operation
-			 * be carried out.
+			 * Sender is a MOM of the job taking part in a PMIx
+			 * fence or direct modex.  There is no reply, results
+			 * travel back as IM_PMIX requests of their own.
 			 *
 			 * auxiliary info (
 			 *	sending node	tm_node_id;
-			 *	taskid		tm_task_id;
-			 *	operation	string;
+			 *	operation	int;
+			 *	operation specific data, see pbs_pmix_im_request();
 			 * )
 			 */
-			sprintf(log_buffer, "IM_PMIX request received");
-			log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-				jobid, log_buffer);
-			/* TODO: Read aux info, processes request, and send response */
-			sprintf(log_buffer, "Handle IM_PMIX request");
-			log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-				jobid, log_buffer);
-			sprintf(log_buffer, "IM_PMIX replying IM_ALL_OK");
-			log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-				jobid, log_buffer);
-			ret = im_compose(stream, jobid, cookie, IM_ALL_OKAY,
-				event, fromtask, IM_OLD_PROTOCOL_VER);
-			if (ret != DIS_SUCCESS)
-				break;
+			ret = pbs_pmix_im_request(pjob, stream);
+			if (ret != DIS_SUCCESS) {
+				sprintf(log_buffer, "IM_PMIX read failed");
+				goto err;
+			}
+			reply = 0;
 			break;
 #endif
 
@@ -4495,12 +4483,20 @@ join_err:
 							goto err;
 					}
 
-					for (i=0; i<pjob->ji_numnodes; i++) {
+					/*
+					 ** Hosts before ji_joinscan answered already, no
+					 ** new events are added to them while the
+					 ** sisterhood joins, so start looking there and
+					 ** a wide job is not walked once per reply.
+					 */
+					ep = NULL;
+					for (i = pjob->ji_joinscan; i < pjob->ji_numnodes; i++) {
 						hnodent *xp = &pjob->ji_hosts[i];
 						if ((ep = (eventent *)GET_NEXT(xp->hn_events))
 							!= NULL)
 							break;
 					}
+					pjob->ji_joinscan = i;
 
 					if (do_tolerate_node_failures(pjob) &&
 					    (nodeidx > 0) && (nodeidx < pjob->ji_numnodes)) {
@@ -6173,12 +6169,7 @@ aterr:
 	tvnodeid = disrui(fd, &ret);
 	BAIL("tvnodeid")
 
-	pnode = pjob->ji_vnods;
-	for (i = 0; i < pjob->ji_numvnod; i++, pnode++) {
-		if (pnode->vn_node == tvnodeid)
-			break;
-	}
-	if (i == pjob->ji_numvnod) {
+	if ((pnode = find_vmpiproc(pjob, tvnodeid)) == NULL) {
 		sprintf(log_buffer, "node %d not found", tvnodeid);
 		log_joberr(-1, __func__, log_buffer, jobid);
 		ret = tm_reply(fd, version, TM_ERROR, event);
@@ -6188,8 +6179,9 @@ aterr:
 		if (ret != DIS_SUCCESS)
 			goto done;
 		prev_error = 1;
-	}
-	phost = pnode->vn_host;
+		phost = NULL;
+	} else
+		phost = pnode->vn_host;
 
 
 	switch (command) {
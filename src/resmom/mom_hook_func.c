@@ -124,7 +124,6 @@ extern pbs_list_head	svr_hook_job_actions;
 extern pbs_list_head	svr_hook_vnl_actions;
 
 extern	pbs_list_head       task_list_immed;
-extern	pbs_list_head       task_list_timed;
 extern	pbs_list_head       task_list_event;
 extern	pbs_list_head	svr_alljobs;
 
@@ -293,12 +292,18 @@ fprint_vnl(FILE *fp, char *head_str, vnl_t *vp)
  * @param[in] 	fp - pointer to file to dump output into
  * @param[in]	head_str - some string to prefix outputted data
  * @param[in]	joblist - pointer to a  list of jobs.
+ * @param[in]	filter - HOOK_JOB_FILTER_* bits: print only the jobs that
+ *			 started, ended or changed resources_used after
+ *			 change pass 'since'.  HOOK_JOB_FILTER_ALL prints all.
+ * @param[in]	since - change pass of the previous run of the hook; 0 for
+ *			a first run, which gets all the jobs.
  *
  * @return none
  *
  */
 void
-fprint_joblist(FILE *fp, char *head_str, pbs_list_head *joblist)
+fprint_joblist(FILE *fp, char *head_str, pbs_list_head *joblist,
+	unsigned int filter, unsigned long since)
 {
 	job		*pjob;
 	int		i;
@@ -316,6 +321,15 @@ fprint_joblist(FILE *fp, char *head_str, pbs_list_head *joblist)
 	for (pjob = (job *)GET_NEXT(*joblist); pjob;
 		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
 
+		if ((filter != HOOK_JOB_FILTER_ALL) && (since != 0) &&
+			!(((filter & HOOK_JOB_FILTER_STARTED) &&
+				(pjob->ji_hook_start_seq > since)) ||
+			((filter & HOOK_JOB_FILTER_ENDED) &&
+				(pjob->ji_hook_end_seq > since)) ||
+			((filter & HOOK_JOB_FILTER_RESC_USED) &&
+				(pjob->ji_hook_used_seq > since))))
+			continue;
+
 		jobid = pjob->ji_qs.ji_jobid;
 		/* Now print job attributes and resources */
 		CLEAR_HEAD(phead);
@@ -746,7 +760,9 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 	int vnl_created = 0;
 	job *pjob = NULL;
 	int matched_nvnode = 0; /* match natural vnode */
-	char *arg[14];
+	char *arg[16];
+	int narg;
+	char code_cache[MAXPATHLEN + 1];
 	pid_t myseq; /* just some unique sequence number */
 	char logmask[BUFSIZ];
 	char path_hooks_rescdef[MAXPATHLEN + 1];
@@ -766,6 +782,8 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 	char hook_config_path[MAXPATHLEN + 1];
 	char *p;
 	pbs_list_head *jobs_list = NULL;
+	unsigned int job_filter = HOOK_JOB_FILTER_ALL;
+	unsigned long job_since = 0;
 	char *pc;
 	int keeping = 0;
 	char *std_file = NULL;
@@ -823,6 +841,8 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 			break;
 		case HOOK_EVENT_EXECHOST_PERIODIC:
 			jobs_list = hook_input->jobs_list;
+			job_filter = hook_input->job_filter;
+			job_since = hook_input->job_since;
 			/* falls through */
 		case HOOK_EVENT_EXECHOST_STARTUP:
 			vnl = hook_input->vnl;
@@ -1201,7 +1221,8 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 					vnl_free(nv);
 				}
 
-				fprint_joblist(fp, EVENT_JOBLIST_OBJECT, jobs_list);
+				fprint_joblist(fp, EVENT_JOBLIST_OBJECT, jobs_list,
+					job_filter, job_since);
 
 				break;
 			case HOOK_EVENT_EXECHOST_STARTUP:
@@ -1241,41 +1262,46 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 		fclose(fp);
 		fp = NULL;
 
-		arg[0] = (char *) pypath;
-		arg[1] = "--hook";
-		arg[2] = "-i";
-		arg[3] = (char *) hook_inputfile;
-		arg[4] = "-o";
-		arg[5] = (char *) hook_outputfile;
+		narg = 0;
+		arg[narg++] = (char *) pypath;
+		arg[narg++] = "--hook";
+		arg[narg++] = "-i";
+		arg[narg++] = (char *) hook_inputfile;
+		arg[narg++] = "-o";
+		arg[narg++] = (char *) hook_outputfile;
 
 		if (log_file[0] == '\0') {
-			arg[6] = "-L";
-			arg[7] = (char *) path_log;
+			arg[narg++] = "-L";
+			arg[narg++] = (char *) path_log;
 		} else {
-			arg[6] = "-l";
-			arg[7] = (char *) log_file;
+			arg[narg++] = "-l";
+			arg[narg++] = (char *) log_file;
 		}
-		arg[8] = "-e";
+		arg[narg++] = "-e";
 		snprintf(logmask, sizeof(logmask), "%ld", *log_event_mask);
-		arg[9] = (char *) logmask;
+		arg[narg++] = (char *) logmask;
 
 		if (rescdef_file != NULL) {
-			arg[10] = "-r";
-			arg[11] = (char *) rescdef_file;
-			arg[12] = script_file;
-			snprintf(cmdline, sizeof(cmdline),
-				 "%s %s %s %s %s %s %s %s %s %s %s %s %s",
-				 arg[0], arg[1], arg[2], arg[3], arg[4], arg[5],
-				 arg[6], arg[7], arg[8], arg[9], arg[10], arg[11],
-				 arg[12]);
-			arg[13] = NULL;
-		} else {
-			arg[10] = script_file;
-			snprintf(cmdline, sizeof(cmdline),
-				 "%s %s %s %s %s %s %s %s %s %s %s",
-				 arg[0], arg[1], arg[2], arg[3], arg[4], arg[5],
-				 arg[6], arg[7], arg[8], arg[9], arg[10]);
-			arg[11] = NULL;
+			arg[narg++] = "-r";
+			arg[narg++] = (char *) rescdef_file;
+		}
+		/*
+		 * Hooks run as root share the compiled script through a file in
+		 * the hooks work directory, instead of each run compiling it.
+		 */
+		if (!runas_jobuser) {
+			snprintf(code_cache, sizeof(code_cache), FMT_HOOK_CODE_CACHE, path_hooks_workdir, phook->hook_name);
+			arg[narg++] = "-c";
+			arg[narg++] = (char *) code_cache;
+		}
+		arg[narg++] = script_file;
+		arg[narg] = NULL;
+
+		cmdline[0] = '\0';
+		for (k = 0; k < narg; k++) {
+			if (k > 0)
+				strncat(cmdline, " ", sizeof(cmdline) - strlen(cmdline) - 1);
+			strncat(cmdline, arg[k], sizeof(cmdline) - strlen(cmdline) - 1);
 		}
 		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK, LOG_INFO, phook->hook_name,
 			   "execve %s runas_jobuser=%d in child pid=%d", cmdline, runas_jobuser, myseq);
@@ -1601,6 +1627,93 @@ python_script_alloc_exit:
 }
 
 
+/* current exechost_periodic job change pass, see mark_job_changes() */
+static unsigned long job_change_seq = 0;
+
+/**
+ * @brief
+ *	Checksum the resources_used values of a job, leaving out walltime
+ *	which changes on every sample whether the job does anything or not.
+ *
+ * @param[in]	pjob - job in question
+ *
+ * @return unsigned long - checksum, never 0
+ *
+ */
+static unsigned long
+resc_used_sum(job *pjob)
+{
+	unsigned long	h = 5381;
+	attribute	*pattr = &pjob->ji_wattr[(int)JOB_ATR_resc_used];
+	resource	*presc;
+	char		*p;
+
+	if (!is_attr_set(pattr))
+		return (h);
+	for (presc = (resource *)GET_NEXT(pattr->at_val.at_list); presc;
+		presc = (resource *)GET_NEXT(presc->rs_link)) {
+		if (!is_attr_set(&presc->rs_value) ||
+			(strcmp(presc->rs_defin->rs_name, "walltime") == 0))
+			continue;
+		for (p = presc->rs_defin->rs_name; *p != '\0'; p++)
+			h = h * 33 + (unsigned char) *p;
+		switch (presc->rs_defin->rs_type) {
+			case ATR_TYPE_LONG:
+			case ATR_TYPE_BOOL:
+				h = h * 33 + (unsigned long) presc->rs_value.at_val.at_long;
+				break;
+			case ATR_TYPE_SIZE:
+				h = h * 33 + (unsigned long) presc->rs_value.at_val.at_size.atsv_num;
+				h = h * 33 + presc->rs_value.at_val.at_size.atsv_shift;
+				break;
+			case ATR_TYPE_FLOAT:
+				h = h * 33 + (unsigned long) (presc->rs_value.at_val.at_float * 1000);
+				break;
+			case ATR_TYPE_STR:
+				if (presc->rs_value.at_val.at_str != NULL)
+					for (p = presc->rs_value.at_val.at_str; *p != '\0'; p++)
+						h = h * 33 + (unsigned char) *p;
+				break;
+			default:
+				break;
+		}
+	}
+	return (h ? h : 1);
+}
+
+/**
+ * @brief
+ *	Start a new job change pass: note in each job whether it started,
+ *	ended or changed its resources_used since the previous pass.
+ *	exechost_periodic hooks with a job_list_filter then get only the jobs
+ *	whose change pass is newer than that of their own last run.
+ *
+ * @return void
+ *
+ */
+static void
+mark_job_changes(void)
+{
+	job		*pjob;
+	unsigned long	sum;
+
+	job_change_seq++;
+	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
+		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+		if ((pjob->ji_hook_start_seq == 0) &&
+			(get_job_substate(pjob) >= JOB_SUBSTATE_RUNNING))
+			pjob->ji_hook_start_seq = job_change_seq;
+		if ((pjob->ji_hook_end_seq == 0) &&
+			(get_job_substate(pjob) >= JOB_SUBSTATE_EXITING))
+			pjob->ji_hook_end_seq = job_change_seq;
+		sum = resc_used_sum(pjob);
+		if (sum != pjob->ji_hook_used_sum) {
+			pjob->ji_hook_used_sum = sum;
+			pjob->ji_hook_used_seq = job_change_seq;
+		}
+	}
+}
+
 /**
  * @brief
  *	Runs a periodic hook in the background.
@@ -1648,12 +1761,21 @@ run_periodic_hook_bg(hook *phook)
 	mom_hook_input_init(&hook_input);
 	hook_input.vnl = (vnl_t *)vnlp;
 	hook_input.jobs_list = &svr_alljobs;
+	if (phook->job_filter != HOOK_JOB_FILTER_ALL) {
+		mark_job_changes();
+		hook_input.job_filter = phook->job_filter;
+		hook_input.job_since = phook->job_seq;
+		phook->job_seq = job_change_seq;
+	}
 
 	rc = run_hook(phook, HOOK_EVENT_EXECHOST_PERIODIC, &hook_input,
 		PBS_MOM_SERVICE_NAME, mom_host, 0,
 		post_periodic_hook,
 		NULL, NULL, NULL, 0, NULL);
 	if (rc != 0) {
+		/* changes not delivered, offer them again next time */
+		if (hook_input.job_filter != HOOK_JOB_FILTER_ALL)
+			phook->job_seq = hook_input.job_since;
 		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
 			LOG_ERR, phook->hook_name,
 			"Failed to deploy periodic hook");
@@ -2322,7 +2444,7 @@ get_hook_results(char *input_file, int *accept_flag, int *reject_flag,
 							if (strcmp(plist->al_resc,
 								plist2->al_resc) == 0) {
 								delete_link(&plist->al_link);
-								free(plist);
+								attrlist_free(plist);
 								break;
 							}
 							plist2 = (svrattrl *)GET_NEXT(plist2->al_link);
@@ -3934,6 +4056,8 @@ mom_hook_input_init(mom_hook_input_t *hook_input)
 	hook_input->failed_mom_list = NULL;
 	hook_input->succeeded_mom_list = NULL;
 	hook_input->jobs_list = NULL;
+	hook_input->job_filter = HOOK_JOB_FILTER_ALL;
+	hook_input->job_since = 0;
 }
 
 /**
@@ -122,6 +122,7 @@
 #include	"mom_mach.h"
 #endif	/* MOM_ALPS */
 #include	"pbs_reliable.h"
+#include	"pbs_pwcache.h"
 #ifdef PMIX
 #include	"mom_pmix.h"
 #endif /* PMIX */
@@ -148,6 +149,8 @@
 
 /* Global Data Items */
 int mock_run = 0;
+int mock_run_runtime_min = -1;	/* $mock_run_runtime, -1 to use walltime */
+int mock_run_runtime_max = -1;
 enum hup_action	call_hup = HUP_CLEAR;
 static int      update_state_flag = 0;
 double		cputfactor = 1.00;
@@ -281,6 +284,7 @@ static		resource_def *rdcput;
 static		resource_def *rdwall;
 int		restart_background = FALSE;
 int		reject_root_scripts = FALSE;
+int		auto_direct_write = FALSE;	/* direct write output that goes to a local path */
 int		report_hook_checksums = TRUE;
 int		restart_transmogrify = FALSE;
 int		attach_allow = TRUE;
@@ -290,6 +294,7 @@ int		resume_signal;
 int		cycle_harvester = 0;   /* MOM configured for cycle harvesting */
 int		restrict_user = 0;		/* kill non PBS user procs */
 int		restrict_user_maxsys = 999;	/* largest system user id */
+int		stage_workers = 1;		/* file pairs of a copy request staged at once */
 int		vnode_additive = 1;
 momvmap_t     **mommap_array = NULL;
 int		mommap_array_size = 0;
@@ -364,7 +369,6 @@ pbs_list_head	svr_execjob_preresume_hooks;
 
 /* the task lists */
 pbs_list_head	task_list_immed;
-pbs_list_head	task_list_timed;
 pbs_list_head	task_list_event;
 
 #ifdef WIN32
@@ -457,22 +461,29 @@ static handler_ret_t	set_vnode_per_numa_node(char *);
 static handler_ret_t	set_alps_confirm_switch_timeout(char *);
 #endif	/* MOM_ALPS */
 static handler_ret_t	set_attach_allow(char *);
+static handler_ret_t	set_auto_direct_write(char *);
+static handler_ret_t	set_cgroup_prefix(char *);
 static handler_ret_t	set_checkpoint_path(char *);
 static handler_ret_t	set_enforcement(char *);
 static handler_ret_t	set_jobdir_root(char *);
 static handler_ret_t	set_kbd_idle(char *);
 static handler_ret_t	set_max_check_poll(char *);
 static handler_ret_t	set_min_check_poll(char *);
+static handler_ret_t	set_mock_run_runtime(char *);
 static handler_ret_t	set_momname(char *);
 static handler_ret_t	set_momport(char *);
 #ifdef	WIN32
 static handler_ret_t	set_nrun_factor(char *);
 #endif
+static handler_ret_t	set_resc_used_change(char *);
+static handler_ret_t	set_resc_used_max_interval(char *);
 static handler_ret_t	set_restart_background(char *);
 static handler_ret_t	set_restart_transmogrify(char *);
 static handler_ret_t	set_restrict_user(char *);
 static handler_ret_t	set_restrict_user_maxsys(char *);
+static handler_ret_t	set_pwd_cache_ttl(char *);
 static handler_ret_t	set_restrict_user_exceptions(char *);
+static handler_ret_t	set_stage_workers(char *);
 static handler_ret_t	set_suspend_signal(char *);
 static handler_ret_t	set_tmpdir(char *);
 static handler_ret_t	set_vnode_additive(char *);
@@ -513,6 +524,8 @@ static struct	specials {
 	{ "alps_confirm_switch_timeout",set_alps_confirm_switch_timeout },
 #endif	/* MOM_ALPS */
 	{ "attach_allow",		set_attach_allow },
+	{ "auto_direct_write",		set_auto_direct_write },
+	{ "cgroup_prefix",		set_cgroup_prefix },
 	{ "checkpoint_path",		set_checkpoint_path },
 	{ "clienthost",			addclient },
 	{ "configversion",		config_verscheck },
@@ -526,14 +539,18 @@ static struct	specials {
 	{ "max_load",			setmaxload },
 	{ "max_poll_downtime",		set_max_poll_downtime },
 	{ "min_check_poll",		set_min_check_poll },
+	{ "mock_run_runtime",		set_mock_run_runtime },
 	{ "momname",			set_momname },
 #ifdef	WIN32
 	{ "nrun_factor",		set_nrun_factor },
 #endif
 	{ "port",			set_momport },
 	{ "prologalarm",		prologalarm },
+	{ "pwd_cache_ttl",		set_pwd_cache_ttl },
 	{ "sister_join_job_alarm",	set_joinjob_alarm },
 	{ "job_launch_delay",		set_job_launch_delay },
+	{ "resc_used_change",		set_resc_used_change },
+	{ "resc_used_max_interval",	set_resc_used_max_interval },
 	{ "restart_background",		set_restart_background },
 	{ "restart_transmogrify",	set_restart_transmogrify },
 	{ "restrict_user",		set_restrict_user },
@@ -546,6 +563,7 @@ static struct	specials {
 	 */
 	{ "spool_size",			set_spoolsize },
 #endif /* localmod 015 */
+	{ "stage_workers",		set_stage_workers },
 	{ "suspendsig",			set_suspend_signal },
 	{ "tmpdir",			set_tmpdir },
 	{ "vnodedef_additive",		set_vnode_additive },
@@ -732,7 +750,7 @@ validuser(struct rm_attribute *attrib)
 		return NULL;
 	}
 
-	p = getpwnam(attrib->a_value);
+	p = pbs_getpwnam(attrib->a_value);
 	if (p) {
 		return "yes";
 	} else {
@@ -1669,6 +1687,24 @@ set_reject_root_scripts(char *value)
 	return (set_boolean(__func__, value, &reject_root_scripts));
 }
 
+/**
+ * @brief
+ *	Set the configuration flag that makes mom write a job's standard
+ *	output and error directly to their final destination when that maps
+ *	to a local path, even though the job did not request direct write.
+ *
+ * @param[in] value - boolean value
+ *
+ * @retval 0 failure
+ * @retval 1 success
+ *
+ */
+static handler_ret_t
+set_auto_direct_write(char *value)
+{
+	return (set_boolean(__func__, value, &auto_direct_write));
+}
+
 /**
  * @brief
  *	Set the configuration flag that tells the mom to send the checksums
@@ -2395,6 +2431,7 @@ do_mom_action_script(int ae,	      /* index into action table */
 	if (post != NULL) { /* post func means we do not wait */
 		rc = 1;
 		pjob->ji_momsubt = child;
+		track_job_pid(pjob, child);
 		pjob->ji_mompost = post;
 		if (ma->ma_timeout)
 			pjob->ji_actalarm = time_now + ma->ma_timeout;
@@ -2429,6 +2466,7 @@ do_mom_action_script(int ae,	      /* index into action table */
 		}
 		ptask->ti_qs.ti_sid = sjr.sj_session;
 		ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+		track_job_pid(pjob, ptask->ti_qs.ti_sid);
 		(void) task_save(ptask);
 		/* update the job with the new session id */
 		set_jattr_l_slim(pjob, JOB_ATR_session_id, sjr.sj_session, SET);
@@ -2772,6 +2810,40 @@ set_tmpdir(char *value)
 	return HANDLER_SUCCESS;
 }
 
+/**
+ * @brief
+ *	sets the directory prefix the cgroups hook uses for job cgroups,
+ *	so job usage can be read from <mount>/<prefix>.service/jobid/<jobid>
+ *
+ * @param[in] value - prefix, "pbs_jobs" by default
+ *
+ * @return      handler_ret_t
+ * @retval      HANDLER_FAIL            Failure
+ * @retval      HANDLER_SUCCESS         Success
+ *
+ */
+static handler_ret_t
+set_cgroup_prefix(char *value)
+{
+	char	*cleaned_value;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "cgroup_prefix", value);
+	cleaned_value = remove_quotes(value); /* remove quotes if any present */
+	if (cleaned_value == NULL)
+		return HANDLER_FAIL;
+
+	if ((*cleaned_value == '\0') || (strchr(cleaned_value, '/') != NULL) ||
+		(strlen(cleaned_value) > MAXPATHLEN)) {
+		free(cleaned_value);
+		return HANDLER_FAIL;
+	}
+
+	strcpy(mom_cgroup_prefix, cleaned_value);
+	free(cleaned_value);
+	return HANDLER_SUCCESS;
+}
+
 /**
  * @brief
  *      sets job dirctory
@@ -3341,6 +3413,69 @@ set_max_check_poll(char *value)
 	return (set_int(id, value, &max_check_poll));
 }
 
+/**
+ * @brief
+ *      sets the percentage by which a running job's cput or mem must
+ *      change before a poll sends its resources_used to the server
+ *
+ * @param[in] value - percentage, greater than zero
+ *
+ * @return      handler_ret_t
+ * @retval      HANDLER_SUCCESS         success
+ * @retval      HANDLER_FAIL            Failure
+ *
+ */
+
+static handler_ret_t
+set_resc_used_change(char *value)
+{
+	static	char	id[] = "resc_used_change";
+
+	return (set_int(id, value, &resc_used_change));
+}
+
+/**
+ * @brief
+ *      sets the most seconds between resources_used updates of a running
+ *      job when resc_used_change is set
+ *
+ * @param[in] value - seconds, greater than zero
+ *
+ * @return      handler_ret_t
+ * @retval      HANDLER_SUCCESS         success
+ * @retval      HANDLER_FAIL            Failure
+ *
+ */
+
+static handler_ret_t
+set_resc_used_max_interval(char *value)
+{
+	static	char	id[] = "resc_used_max_interval";
+
+	return (set_int(id, value, &resc_used_max_interval));
+}
+
+/**
+ * @brief
+ *      sets the number of file pairs of a stage-in or stage-out request
+ *      that are copied at the same time
+ *
+ * @param[in] value - number of transfer workers, greater than zero
+ *
+ * @return      handler_ret_t
+ * @retval      HANDLER_SUCCESS         success
+ * @retval      HANDLER_FAIL            Failure
+ *
+ */
+
+static handler_ret_t
+set_stage_workers(char *value)
+{
+	static	char	id[] = "stage_workers";
+
+	return (set_int(id, value, &stage_workers));
+}
+
 /**
  * @brief
  *      sets minimum poll checks
@@ -3415,6 +3550,76 @@ set_restrict_user(char *value)
 	return (set_boolean(__func__, value, &restrict_user));
 }
 
+/**
+ * @brief
+ *	Handler function for the $pwd_cache_ttl config option, the number
+ *	of seconds user and group entries are cached, 0 to disable.  A bad
+ *	value is refused and the cache keeps its ttl, it is not worth MoM
+ *	exiting on a HUP.
+ *
+ * @param[in]	value - the input given in config file.
+ *
+ * @return handler_ret_t
+ * @retval HANDLER_SUCCESS
+ */
+static handler_ret_t
+set_pwd_cache_ttl(char *value)
+{
+	long i;
+	char *endp;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
+		"pwd_cache_ttl", value);
+	i = strtol(value, &endp, 10);
+
+	if ((*endp != '\0') || (i < 0) || (i == LONG_MAX)) {
+		log_errf(-1, __func__, "Bad value %s, pwd_cache_ttl stays %ld", value, pwcache_ttl);
+		return HANDLER_SUCCESS;
+	}
+	pwcache_ttl = i;
+	pbs_pwcache_flush();
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * @brief
+ *	Handler function for the $mock_run_runtime config option: how long,
+ *	in seconds, a job run in mock run mode (-m) pretends to run.  The value
+ *	is either a fixed time or a range <min>-<max> from which each job's
+ *	runtime is drawn at random.  A job never runs past its walltime.
+ *
+ * @param[in]	value - the input given in config file.
+ *
+ * @return handler_ret_t
+ * @retval HANDLER_SUCCESS
+ * @retval HANDLER_FAIL
+ */
+static handler_ret_t
+set_mock_run_runtime(char *value)
+{
+	long min, max;
+	char *endp;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
+		"mock_run_runtime", value);
+	min = strtol(value, &endp, 10);
+	if (endp == value || min < 0 || min > INT_MAX)
+		return HANDLER_FAIL;
+	max = min;
+	if (*endp == '-') {
+		value = endp + 1;
+		max = strtol(value, &endp, 10);
+		if (endp == value || max < min || max > INT_MAX)
+			return HANDLER_FAIL;
+	}
+	if (*endp != '\0')
+		return HANDLER_FAIL;
+
+	mock_run_runtime_min = min;
+	mock_run_runtime_max = max;
+	return HANDLER_SUCCESS;
+}
+
 /**
  * @brief
  *      sets value for restrict maxsys user
@@ -3472,7 +3677,7 @@ set_restrict_user_exceptions(char *user_list)
 			break;
 		}
 
-		if (((pwent = getpwnam(p2)) == NULL)) {
+		if (((pwent = pbs_getpwnam(p2)) == NULL)) {
 			sprintf(log_buffer, "user %s doesn't exist", p2);
 			log_event(PBSEVENT_SYSTEM, 0, LOG_DEBUG, __func__,
 				log_buffer);
@@ -4003,6 +4208,8 @@ read_config(char *file)
 	strcpy(pbs_jobdir_root, "");
 	restrict_user = 0;
 	restrict_user_maxsys = 999;
+	pwcache_ttl = PWCACHE_TTL_DFLT;
+	pbs_pwcache_flush();
 	for (j=0; j < NUM_RESTRICT_USER_EXEMPT_UIDS; j++)
 		if (restrict_user_exempt_uids[j] != 0)
 			restrict_user_exempt_uids[j] = 0;
@@ -5836,6 +6043,43 @@ job	*pjob;
 }
 #endif /* localmod 015 */
 
+/**
+ * @brief
+ *	Cache the job wide limits of Resource_List that mom_over_limit()
+ *	checks on each poll, so that it does not have to walk the list and
+ *	compare resource names every time.  ji_limflags is reset whenever
+ *	the limits of the job may have changed.
+ *
+ * @param[in] pjob - pointer to job
+ *
+ * @return void
+ *
+ */
+void
+cache_job_limits(job *pjob)
+{
+	resource	*pres;
+	char		*pname;
+
+	pjob->ji_limflags = JOB_LIMIT_CACHED;
+	pjob->ji_cput_limit = 0;
+	pjob->ji_wall_limit = 0;
+	pres = (resource *)
+		GET_NEXT(pjob->ji_wattr[(int)JOB_ATR_resource].at_val.at_list);
+	for (; pres != NULL; pres = (resource *)GET_NEXT(pres->rs_link)) {
+		pname = pres->rs_defin->rs_name;
+		if (strcmp(pname, "cput") == 0) {
+			if (local_gettime(pres, &pjob->ji_cput_limit) == PBSE_NONE)
+				pjob->ji_limflags |= JOB_LIMIT_CPUT;
+		} else if (strcmp(pname, "walltime") == 0) {
+			if (local_gettime(pres, &pjob->ji_wall_limit) == PBSE_NONE)
+				pjob->ji_limflags |= JOB_LIMIT_WALLTIME;
+		} else if ((strcmp(pname, "mppe") == 0) ||
+			(strcmp(pname, "mppssp") == 0))
+			pjob->ji_limflags |= JOB_LIMIT_MPP;
+	}
+}
+
 /**
  * @brief
  *	Measure job resource usage and compare with its limits.
@@ -5868,8 +6112,6 @@ mom_over_limit(job *pjob)
 
 	assert(pjob != NULL);
 	assert(pjob->ji_wattr[(int)JOB_ATR_resource].at_type == ATR_TYPE_RESC);
-	pres = (resource *)
-		GET_NEXT(pjob->ji_wattr[(int)JOB_ATR_resource].at_val.at_list);
 
 	DBPRT(("%s: entered\n", __func__))
 
@@ -5975,55 +6217,56 @@ mom_over_limit(job *pjob)
 		}
 	}
 
-	pres = (resource *)
-		GET_NEXT(pjob->ji_wattr[(int)JOB_ATR_resource].at_val.at_list);
-
-	for (; pres != NULL; pres = (resource *)GET_NEXT(pres->rs_link)) {
-		assert(pres->rs_defin != NULL);
-		pname = pres->rs_defin->rs_name;
-		used = find_resc_entry(uattr, pres->rs_defin);
-		assert(pname != NULL);
-		assert(*pname != '\0');
+	if ((pjob->ji_limflags & JOB_LIMIT_CACHED) == 0)
+		cache_job_limits(pjob);
 
-		/* The checks for cput and walltime (job wide limits) should
-		 * only be done on the MS.  We are leaving the Cray specific
-		 * mppe and mppsse to be checked on all nodes though
-		 */
+	/* The checks for cput and walltime (job wide limits) should
+	 * only be done on the MS.  We are leaving the Cray specific
+	 * mppe and mppsse to be checked on all nodes though
+	 */
 
-		if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) != 0) {
-			if (strcmp(pname, "cput") == 0) {
-				retval = local_gettime(pres, &value);
-				if (retval != PBSE_NONE)
-					continue;
-				retval = local_gettime(used, &num);
-				if (retval != PBSE_NONE)
-					continue;
-				if (num > value) {
-					sprintf(log_buffer,
-						"cput %lu exceeded limit %lu",
-						num, value);
-					pjob->ji_qs.ji_un.ji_momt.ji_exitstat = JOB_EXEC_KILL_CPUT;
-					return (TRUE);
-				}
-			} else if (strcmp(pname, "walltime") == 0) {
-				retval = local_gettime(pres, &value);
-				if (retval != PBSE_NONE)
-					continue;
-				/* use the resources_used.walltime value */
-				retval = local_gettime(used, &num);
-				if (retval != PBSE_NONE)
-					continue;
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) != 0) {
+		if (pjob->ji_limflags & JOB_LIMIT_CPUT) {
+			used = find_resc_entry(uattr, &svr_resc_def[RESC_CPUT]);
+			if ((local_gettime(used, &num) == PBSE_NONE) &&
+				(num > pjob->ji_cput_limit)) {
+				sprintf(log_buffer,
+					"cput %lu exceeded limit %lu",
+					num, pjob->ji_cput_limit);
+				pjob->ji_qs.ji_un.ji_momt.ji_exitstat = JOB_EXEC_KILL_CPUT;
+				return (TRUE);
+			}
+		}
+		if (pjob->ji_limflags & JOB_LIMIT_WALLTIME) {
+			/* use the resources_used.walltime value */
+			used = find_resc_entry(uattr, &svr_resc_def[RESC_WALLTIME]);
+			if (local_gettime(used, &num) == PBSE_NONE) {
 				/* add time that has not been accumulated */
-				num += (time_now - pjob->ji_walltime_stamp) * wallfactor;
-				if (num > value) {
+				if (pjob->ji_walltime_stamp != 0)
+					num += (time_now - pjob->ji_walltime_stamp) * wallfactor;
+				if (num > pjob->ji_wall_limit) {
 					sprintf(log_buffer,
 						"walltime %lu exceeded limit %lu",
-						num, value);
+						num, pjob->ji_wall_limit);
 					pjob->ji_qs.ji_un.ji_momt.ji_exitstat = JOB_EXEC_KILL_WALLTIME;
 					return (TRUE);
 				}
 			}
 		}
+	}
+
+	if ((pjob->ji_limflags & JOB_LIMIT_MPP) == 0)
+		return (FALSE);
+
+	pres = (resource *)
+		GET_NEXT(pjob->ji_wattr[(int)JOB_ATR_resource].at_val.at_list);
+
+	for (; pres != NULL; pres = (resource *)GET_NEXT(pres->rs_link)) {
+		assert(pres->rs_defin != NULL);
+		pname = pres->rs_defin->rs_name;
+		used = find_resc_entry(uattr, pres->rs_defin);
+		assert(pname != NULL);
+		assert(*pname != '\0');
 
 		if (strcmp(pname, "mppe") == 0) {
 			retval = getlong(pres, &value);
@@ -6057,6 +6300,66 @@ mom_over_limit(job *pjob)
 	return (FALSE);
 }
 
+/**
+ * @brief
+ *	Kill a job found over one of its limits by job_over_limit(), telling
+ *	the user why on the job's stderr.  log_buffer holds the reason.
+ *
+ * @param[in] pjob - pointer to job
+ *
+ * @return void
+ *
+ */
+void
+kill_over_limit_job(job *pjob)
+{
+	char	*kill_msg;
+	int	c = pjob->ji_qs.ji_svrflags;
+	int	i;
+	int	fd;
+	u_long	ipaddr;
+
+	log_event(PBSEVENT_JOB | PBSEVENT_FORCE,
+		PBS_EVENTCLASS_JOB, LOG_INFO,
+		pjob->ji_qs.ji_jobid, log_buffer);
+
+	kill_msg = malloc(80 + strlen(log_buffer));
+	if (kill_msg != NULL) {
+		sprintf(kill_msg, "=>> PBS: job killed: %s\n", log_buffer);
+		if (c & JOB_SVFLG_HERE) {
+			message_job(pjob, StdErr, kill_msg);
+		} else {
+			/* Multi-mom scenario - adding a connection to demux for reporting error */
+
+			struct sockaddr_in *ap;
+			/* We always have a stream open to MS at node 0 */
+			i = pjob->ji_hosts[0].hn_stream;
+			if ((ap = tpp_getaddr(i)) == NULL) {
+				log_joberr(-1, "over_limit_message",
+					"cannot write to job stderr because there is no stream to MS",
+					pjob->ji_qs.ji_jobid);
+			} else {
+				ipaddr = ap->sin_addr.s_addr;
+				if ((fd = open_demux(ipaddr, pjob->ji_stderr)) == -1) {
+					(void)sprintf(log_buffer,
+						"over_limit_message: cannot write to job stderr because open_demux failed");
+					log_event(PBSEVENT_JOB | PBSEVENT_FORCE,
+						PBS_EVENTCLASS_JOB, LOG_INFO,
+						pjob->ji_qs.ji_jobid, log_buffer);
+				} else {
+					write(fd, get_jattr_str(pjob, JOB_ATR_Cookie),
+						strlen(get_jattr_str(pjob, JOB_ATR_Cookie)));
+					write(fd, kill_msg, strlen(kill_msg));
+					(void)close(fd);
+				}
+			}
+		}
+		free(kill_msg);
+	}
+
+	(void)terminate_job(pjob, 1);
+}
+
 /**
  * @brief
  *	check attr value limits of job
@@ -6332,7 +6635,7 @@ dorestrict_user(void)
 			 * user name using the  getpwnam() api
 			 */
 
-			if (((pwent = getpwnam(usr)) == NULL)) {
+			if (((pwent = pbs_getpwnam(usr)) == NULL)) {
 				sprintf(log_buffer, "user %s doesn't exist", usr);
 				log_event(PBSEVENT_SYSTEM, 0, LOG_DEBUG, id,
 					log_buffer);
@@ -6791,6 +7094,40 @@ time_delta_hellosvr(int mode)
 	return delta;
 }
 
+/**
+ * @brief
+ *      Return how long to wait before the first hello after losing the
+ *      server stream.
+ *
+ * @par
+ *	When the server or pbs_comm restarts, every mom loses the server at
+ *	the same moment. Each one picks a random delay within a window
+ *	sized from the complex, taken as the number of addresses the server
+ *	sent in its cluster address list, so that the server sees about
+ *	MOM_HELLO_ADMIT_RATE hellos a second, and recovery is bounded by
+ *	MOM_HELLO_SPREAD_MAX.
+ *
+ * @return int
+ * @retval >=0 : secs to wait
+ */
+static int
+hello_spread(void)
+{
+	extern int num_okclients;
+	int window;
+
+	window = num_okclients / MOM_HELLO_ADMIT_RATE;
+	if (window > MOM_HELLO_SPREAD_MAX)
+		window = MOM_HELLO_SPREAD_MAX;
+	if (window <= 0)
+		return 0;
+#ifdef WIN32
+	return (rand() % (window + 1));
+#else
+	return (random() % (window + 1));
+#endif
+}
+
 /**
  * @brief
  * 	Resume multinode job after one or more sisters has been restarted
@@ -6865,6 +7202,7 @@ main(int argc, char *argv[])
 	int			tppfd; /* fd for rm and im comm */
 	double			myla;
 	time_t			time_next_hello = 0;
+	int			had_server_stream = 0;
 	job			*nxpjob;
 	job			*pjob;
 	extern time_t		wait_time;
@@ -6877,8 +7215,6 @@ main(int argc, char *argv[])
 	resource		*prscput;
 	resource		*prswall;
 	char			*getopt_str;
-	int			fd;
-	u_long			ipaddr;
 	int			optindinc = 0;
 	mom_hook_input_t	hook_input;
 	char			path_hooks_rescdef[MAXPATHLEN+1];
@@ -7842,7 +8178,7 @@ main(int argc, char *argv[])
 
 	/* initialize variables */
 
-	if ((jobs_idx = pbs_idx_create(0, 0)) == NULL) {
+	if ((jobs_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 		log_err(-1, __func__, "Creating jobs index failed!");
 		fprintf(stderr, "Creating jobs index failed!\n");
 		return (-1);
@@ -7889,7 +8225,6 @@ main(int argc, char *argv[])
 	CLEAR_HEAD(svr_execjob_preresume_hooks);
 
 	CLEAR_HEAD(task_list_immed);
-	CLEAR_HEAD(task_list_timed);
 	CLEAR_HEAD(task_list_event);
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
@@ -8345,6 +8680,14 @@ main(int argc, char *argv[])
 
 		time_now = time(NULL);
 		if (server_stream == -1) {
+			if (had_server_stream) {
+				/* just lost the server, do not rush back with everyone else */
+				had_server_stream = 0;
+				time_next_hello = time_now + hello_spread();
+				if (time_next_hello > time_now)
+					log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname,
+						"Lost server, next HELLO in %ld seconds", (long) (time_next_hello - time_now));
+			}
 			if (time_now > time_next_hello) {
 				send_hellosvr(server_stream);
 				time_next_hello = time_now + time_delta_hellosvr(MOM_DELTA_NORMAL);
@@ -8363,8 +8706,10 @@ main(int argc, char *argv[])
 					CLEAR_HEAD(multinode_jobs);
 				}
 			}
-		} else
+		} else {
+			had_server_stream = 1;
 			send_pending_updates();
+		}
 
 		wait_time = default_next_task();
 #ifdef WIN32
@@ -8577,7 +8922,7 @@ main(int argc, char *argv[])
 		/* there are jobs so update status	 */
 		/* if we just got a sample, don't bother */
 		if (time_now > time_last_sample) {
-			if (mom_get_sample() != PBSE_NONE)
+			if (mom_begin_sample() != PBSE_NONE)
 				continue;
 		}
 
@@ -8751,49 +9096,8 @@ main(int argc, char *argv[])
 				if (c & (JOB_SVFLG_OVERLMT1 | JOB_SVFLG_OVERLMT2 | JOB_SVFLG_TERMJOB))
 					continue;
 
-				if (job_over_limit(pjob, recover)) {
-
-					char	*kill_msg;
-					log_event(PBSEVENT_JOB | PBSEVENT_FORCE,
-						PBS_EVENTCLASS_JOB, LOG_INFO,
-						pjob->ji_qs.ji_jobid, log_buffer);
-
-					kill_msg = malloc(80 + strlen(log_buffer));
-					if (kill_msg != NULL) {
-						sprintf(kill_msg, "=>> PBS: job killed: %s\n", log_buffer);
-						if (c & JOB_SVFLG_HERE) {
-							message_job(pjob, StdErr, kill_msg);
-						} else {
-							/* Multi-mom scenario - adding a connection to demux for reporting error */
-
-							struct sockaddr_in *ap;
-							/* We always have a stream open to MS at node 0 */
-							i = pjob->ji_hosts[0].hn_stream;
-							if ((ap = tpp_getaddr(i)) == NULL) {
-								log_joberr(-1, "over_limit_message",
-									"cannot write to job stderr because there is no stream to MS",
-									pjob->ji_qs.ji_jobid);
-							} else {
-								ipaddr = ap->sin_addr.s_addr;
-								if ((fd = open_demux(ipaddr, pjob->ji_stderr)) == -1) {
-									(void)sprintf(log_buffer,
-										"over_limit_message: cannot write to job stderr because open_demux failed");
-									log_event(PBSEVENT_JOB | PBSEVENT_FORCE,
-										PBS_EVENTCLASS_JOB, LOG_INFO,
-										pjob->ji_qs.ji_jobid, log_buffer);
-								} else {
-									write(fd, get_jattr_str(pjob, JOB_ATR_Cookie),
-										strlen(get_jattr_str(pjob, JOB_ATR_Cookie)));
-									write(fd, kill_msg, strlen(kill_msg));
-									(void)close(fd);
-								}
-							}
-						}
-						free(kill_msg);
-					}
-
-					(void)terminate_job(pjob, 1);
-				}
+				if (job_over_limit(pjob, recover))
+					kill_over_limit_job(pjob);
 			} /* for pjob in mom_polljobs */
 		} /* for pjob in svr_alljobs */
 	} /* Mom main loop */
@@ -9504,6 +9808,221 @@ check_busy(double mla)
 	}
 }
 
+#if !defined(NAS) && !defined(WIN32) /* localmod 113 */
+/* per-line prefixes left out of the fingerprint: they change at run time */
+static const char *topo_fp_skip[] = {"cpu MHz", "bogomips", "BogoMIPS", NULL};
+
+/**
+ * @brief
+ *	Fold the contents of a file into a running FNV-1a hash.
+ *
+ * @param[in]	h - hash so far
+ * @param[in]	path - file to read
+ * @param[in]	keep - if not NULL, only lines starting with this prefix are
+ *			hashed, otherwise all lines except those in topo_fp_skip
+ *
+ * @return	unsigned long long - the updated hash
+ *
+ */
+static unsigned long long
+topo_fp_file(unsigned long long h, const char *path, const char *keep)
+{
+	FILE	*fp;
+	char	line[1024];
+	char	*p;
+	int	i;
+
+	if ((fp = fopen(path, "r")) == NULL)
+		return h;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (keep != NULL) {
+			if (strncmp(line, keep, strlen(keep)) != 0)
+				continue;
+		} else {
+			for (i = 0; topo_fp_skip[i] != NULL; i++)
+				if (strncmp(line, topo_fp_skip[i], strlen(topo_fp_skip[i])) == 0)
+					break;
+			if (topo_fp_skip[i] != NULL)
+				continue;
+		}
+		for (p = line; *p != '\0'; p++) {
+			h ^= (unsigned char) *p;
+			h *= 1099511628211ULL;
+		}
+	}
+	fclose(fp);
+	return h;
+}
+
+/**
+ * @brief
+ *	Compute a fingerprint of the hardware hwloc would describe.
+ *
+ * @par
+ *	Covers the processor list, installed memory, NUMA nodes, PCI devices,
+ *	the kernel release and the hwloc API in use.  The PCI directory is
+ *	folded in order independently since readdir() order is not promised.
+ *
+ * @param[out]	buf - where the fingerprint is written
+ * @param[in]	len - size of buf
+ *
+ * @return	Void
+ *
+ */
+static void
+topology_fingerprint(char *buf, size_t len)
+{
+	unsigned long long	h = 14695981039346656037ULL;
+	unsigned long long	pci = 0;
+	unsigned long long	e;
+	struct utsname		un;
+	DIR			*dir;
+	struct dirent		*dent;
+	char			*p;
+
+	h = topo_fp_file(h, "/proc/cpuinfo", NULL);
+	h = topo_fp_file(h, "/proc/meminfo", "MemTotal:");
+	h = topo_fp_file(h, "/sys/devices/system/node/online", NULL);
+	if ((dir = opendir("/sys/bus/pci/devices")) != NULL) {
+		while ((dent = readdir(dir)) != NULL) {
+			if (dent->d_name[0] == '.')
+				continue;
+			e = 14695981039346656037ULL;
+			for (p = dent->d_name; *p != '\0'; p++) {
+				e ^= (unsigned char) *p;
+				e *= 1099511628211ULL;
+			}
+			pci += e;
+		}
+		closedir(dir);
+	}
+	if (uname(&un) == 0)
+		for (p = un.release; *p != '\0'; p++) {
+			h ^= (unsigned char) *p;
+			h *= 1099511628211ULL;
+		}
+	snprintf(buf, len, "%016llx%016llx%x", h, pci, HWLOC_API_VERSION);
+}
+
+/**
+ * @brief
+ *	Return the hwloc XML saved by an earlier MoM if it was produced on
+ *	hardware with the same fingerprint.
+ *
+ * @param[in]	fprint - fingerprint of the current hardware
+ * @param[out]	plen - length of the XML returned
+ *
+ * @return	char *
+ * @retval	malloc'ed, NUL terminated XML	cache is valid
+ * @retval	NULL				no usable cache
+ *
+ */
+static char *
+topology_cache_load(char *fprint, int *plen)
+{
+	char		path[MAXPATHLEN + 1];
+	char		saved[128];
+	struct stat	sb;
+	char		*buf;
+	ssize_t		n;
+	size_t		got = 0;
+	int		fd;
+
+	snprintf(path, sizeof(path), "%s/%s", mom_home, MOM_TOPOLOGY_CACHE_FP);
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return NULL;
+	n = read(fd, saved, sizeof(saved) - 1);
+	close(fd);
+	if (n <= 0)
+		return NULL;
+	saved[n] = '\0';
+	if (strcmp(saved, fprint) != 0) {
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+			"hardware changed, discarding saved topology");
+		return NULL;
+	}
+
+	snprintf(path, sizeof(path), "%s/%s", mom_home, MOM_TOPOLOGY_CACHE);
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return NULL;
+	if ((fstat(fd, &sb) == -1) || (sb.st_size <= 0) ||
+		((buf = malloc(sb.st_size + 1)) == NULL)) {
+		close(fd);
+		return NULL;
+	}
+	while (got < (size_t) sb.st_size) {
+		n = read(fd, buf + got, sb.st_size - got);
+		if (n <= 0)
+			break;
+		got += n;
+	}
+	close(fd);
+	if (got != (size_t) sb.st_size) {
+		free(buf);
+		return NULL;
+	}
+	buf[got] = '\0';
+	*plen = (int) got;
+	return buf;
+}
+
+/**
+ * @brief
+ *	Write one file of the topology cache through a temporary name.
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	failure
+ *
+ */
+static int
+topology_cache_write(char *name, char *data, size_t len)
+{
+	char	path[MAXPATHLEN + 1];
+	char	tmp[MAXPATHLEN + sizeof(".new")];
+	int	fd;
+	int	n;
+	int	rc = 0;
+
+	n = snprintf(path, sizeof(path), "%s/%s", mom_home, name);
+	if ((n < 0) || (n >= sizeof(path)))
+		return -1;
+	snprintf(tmp, sizeof(tmp), "%s.new", path);
+	if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1)
+		return -1;
+	if (write(fd, data, len) != (ssize_t) len)
+		rc = -1;
+	if (close(fd) == -1)
+		rc = -1;
+	if ((rc == 0) && (rename(tmp, path) == -1))
+		rc = -1;
+	if (rc == -1)
+		(void) unlink(tmp);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Save freshly discovered hwloc XML with the fingerprint it belongs to.
+ *	The fingerprint is removed first and written last so a partial save
+ *	is never taken as valid.
+ *
+ * @return	Void
+ *
+ */
+static void
+topology_cache_save(char *fprint, char *xmlbuf, int xmllen)
+{
+	char	path[MAXPATHLEN + 1];
+
+	snprintf(path, sizeof(path), "%s/%s", mom_home, MOM_TOPOLOGY_CACHE_FP);
+	(void) unlink(path);
+	if ((topology_cache_write(MOM_TOPOLOGY_CACHE, xmlbuf, xmllen) == -1) ||
+		(topology_cache_write(MOM_TOPOLOGY_CACHE_FP, fprint, strlen(fprint)) == -1))
+		log_err(errno, __func__, "unable to save topology");
+}
+#endif /* localmod 113 */
+
 /**
  * @fn mom_topology
  * @brief
@@ -9541,8 +10060,17 @@ mom_topology(void)
 	char *topology_type;
 	int fd[2];
 	int pid;
-
 #ifndef	WIN32
+	char fprint[128];
+
+	topology_fingerprint(fprint, sizeof(fprint));
+	if ((xmlbuf = topology_cache_load(fprint, &xmllen)) != NULL) {
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+			"using saved topology");
+		ret = 0;
+		goto have_xml;
+	}
+
 	pipe(fd);
 
 	if ((pid = fork()) == -1) {
@@ -9604,9 +10132,13 @@ mom_topology(void)
 
 		waitpid(pid, NULL, 0);
 	}
+	if (ret == 0)
+		topology_cache_save(fprint, xmlbuf, xmllen);
+have_xml:
 	if (ret < 0) {
 		/* on any failure above, issue log message */
 		log_err(PBSE_SYSTEM, __func__, "topology init/load/export failed");
+		free(xmlbuf);
 		return;
 	} else
 #endif
@@ -55,51 +55,22 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include "mom_pmix.h"
 #include "mom_func.h"
 #include "list_link.h"
 #include "log.h"
 #include "tm.h"
+#include "dis.h"
+#include "tpp.h"
+#include "net_connect.h"
 
 extern char *log_file;
 extern char *path_log;
 extern char mom_short_name[];
 extern pbs_list_head svr_alljobs;
 
-#if 0
-
-/*
- * Some operations like spawn and fence are not atomic and occur
- * over a series of steps. In some cases, data needs to be retained
- * and used in subsequent steps. We might choose to define a data
- * structure that houses both tracking information (e.g. namespace,
- * operation type, etc.) together with an opaque union to house the
- * underlying data. That is what is being suggested (but not yet
- * implemented) here.
- */
-
-/* Enumerate operations that require PBS to call back */
-typedef enum pbs_pmix_oper_type {
-	PBS_PMIX_OPER_NONE,
-	PBS_PMIX_FENCE,
-	PBS_PMIX_SPAWN,
-	/* Add new operations before PBS_PMIX_OPER_UNDEFINED */
-	PBS_PMIX_OPER_UNDEFINED
-} pbs_pmix_oper_type_t;
-
-/* Data structure to house auxiliary PMIx operation data */
-typedef struct pbs_pmix_oper {
-	pbs_pmix_oper_type_t type;
-	job *pjob;
-	struct pbs_pmix_oper *next;
-	union {
-		pbs_pmix_fence_data_t fence;
-		pbs_pmix_spawn_data_t spawn;
-	} data;
-} pbs_pmix_oper_t;
-
-#endif
-
 /* Locking structure and macros */
 typedef struct {
 	pthread_mutex_t mutex;
@@ -139,6 +110,869 @@ typedef struct {
 		pthread_mutex_unlock(&(lck)->mutex); \
 	} while(0)
 
+/*
+ * Fence and direct modex requests are made on the PMIx server thread
+ * but have to be carried out over TPP by the main thread. Each request
+ * is copied into a pbs_pmix_oper_t, queued, and the main thread is woken
+ * up through pbs_pmix_pipe, which is polled like any other connection.
+ */
+
+/* Enumerate operations that require PBS to call back */
+typedef enum pbs_pmix_oper_type {
+	PBS_PMIX_OPER_NONE,
+	PBS_PMIX_FENCE,		/* local server entered a fence */
+	PBS_PMIX_DMODEX,	/* local server wants the data of a remote rank */
+	PBS_PMIX_DMODEX_DATA,	/* local server produced data for a remote MoM */
+	/* Add new operations before PBS_PMIX_OPER_UNDEFINED */
+	PBS_PMIX_OPER_UNDEFINED
+} pbs_pmix_oper_type_t;
+
+/* Data structure to house auxiliary PMIx operation data */
+typedef struct pbs_pmix_oper {
+	pbs_pmix_oper_type_t type;
+	char nspace[PMIX_MAX_NSLEN + 1];
+	pmix_rank_t *ranks;	/* fence participants */
+	size_t nranks;
+	pmix_rank_t rank;	/* rank whose data is wanted */
+	int node;		/* MoM that asked for the data */
+	unsigned int id;	/* direct modex request id */
+	pmix_status_t status;
+	char *data;
+	size_t ndata;
+	pmix_modex_cbfunc_t cbfunc;
+	void *cbdata;
+	struct pbs_pmix_oper *next;
+} pbs_pmix_oper_t;
+
+/*
+ * A fence is carried out over a binary tree of the MoMs hosting its
+ * participants, ordered by node id: data flows up to the first of them
+ * and the combined data flows back down, so a fence takes a number of
+ * message hops logarithmic in the number of nodes.
+ */
+typedef struct pbs_pmix_fence {
+	pbs_list_link fe_link;
+	char fe_jobid[PBS_MAXSVRJOBID + 1];
+	unsigned long fe_sig;	/* signature of the participating nodes */
+	unsigned int fe_seq;	/* fence number among those with fe_sig */
+	int *fe_nodes;		/* participating node ids, ascending */
+	int fe_nnodes;
+	int fe_me;		/* my position in fe_nodes */
+	int fe_recvd;		/* number of children heard from */
+	bool fe_local;		/* local server has entered the fence */
+	char *fe_data;
+	size_t fe_ndata;
+	pmix_modex_cbfunc_t fe_cbfunc;
+	void *fe_cbdata;
+} pbs_pmix_fence_t;
+
+/* Number of fences entered so far for a job and set of nodes */
+typedef struct pbs_pmix_fence_seq {
+	pbs_list_link fs_link;
+	char fs_jobid[PBS_MAXSVRJOBID + 1];
+	unsigned long fs_sig;
+	unsigned int fs_count;
+} pbs_pmix_fence_seq_t;
+
+/* Direct modex request waiting for the reply of a remote MoM */
+typedef struct pbs_pmix_dmodex {
+	pbs_list_link dm_link;
+	char dm_jobid[PBS_MAXSVRJOBID + 1];
+	unsigned int dm_id;
+	pmix_modex_cbfunc_t dm_cbfunc;
+	void *dm_cbdata;
+} pbs_pmix_dmodex_t;
+
+/* IM_PMIX operations exchanged between MoMs */
+enum pbs_pmix_msg {
+	PBS_PMIX_MSG_FENCE_UP = 1,	/* data of a subtree, to parent */
+	PBS_PMIX_MSG_FENCE_DOWN,	/* data of all nodes, to children */
+	PBS_PMIX_MSG_DMODEX_REQ,	/* ask the host of a rank for its data */
+	PBS_PMIX_MSG_DMODEX_RESP	/* data of the rank asked for */
+};
+
+static pthread_mutex_t pbs_pmix_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pbs_pmix_oper_t *pbs_pmix_queue_head = NULL;
+static pbs_pmix_oper_t *pbs_pmix_queue_tail = NULL;
+static int pbs_pmix_pipe[2] = {-1, -1};
+
+static pbs_list_head pbs_pmix_fences;
+static pbs_list_head pbs_pmix_fence_seqs;
+static pbs_list_head pbs_pmix_dmodexes;
+
+/**
+ * @brief
+ * Free an operation and the data it owns
+ *
+ * @param[in] op - operation to free
+ *
+ * @return void
+ */
+static void
+pbs_pmix_oper_free(pbs_pmix_oper_t *op)
+{
+	if (!op)
+		return;
+	free(op->ranks);
+	free(op->data);
+	free(op);
+}
+
+/**
+ * @brief
+ * Hand an operation over to the main thread. May be called from the
+ * PMIx server thread.
+ *
+ * @param[in] op - operation to queue, owned by the queue from now on
+ *
+ * @return void
+ */
+static void
+pbs_pmix_queue(pbs_pmix_oper_t *op)
+{
+	op->next = NULL;
+	pthread_mutex_lock(&pbs_pmix_queue_lock);
+	if (pbs_pmix_queue_tail)
+		pbs_pmix_queue_tail->next = op;
+	else
+		pbs_pmix_queue_head = op;
+	pbs_pmix_queue_tail = op;
+	pthread_mutex_unlock(&pbs_pmix_queue_lock);
+	/* a full pipe already means the main thread has been woken up */
+	if ((write(pbs_pmix_pipe[1], "", 1) == -1) && (errno != EAGAIN))
+		log_err(errno, __func__, "write to PMIx pipe failed");
+}
+
+/**
+ * @brief
+ * Release function passed to PMIx along with data allocated by PBS
+ *
+ * @param[in] cbdata - the data to free
+ *
+ * @return void
+ */
+static void
+pbs_pmix_release(void *cbdata)
+{
+	free(cbdata);
+}
+
+/**
+ * @brief
+ * Pass the outcome of a fence or direct modex to the PMIx server, which
+ * stores it in its shared memory for the local clients to read.
+ *
+ * @param[in] cbfunc - callback provided by the PMIx server
+ * @param[in] cbdata - opaque data for cbfunc
+ * @param[in] status - outcome of the operation
+ * @param[in] data - data to hand over, freed by PMIx through its release
+ * @param[in] ndata - length of data
+ *
+ * @return void
+ */
+static void
+pbs_pmix_deliver(pmix_modex_cbfunc_t cbfunc, void *cbdata,
+	pmix_status_t status, char *data, size_t ndata)
+{
+	if (!cbfunc) {
+		free(data);
+		return;
+	}
+	cbfunc(status, data, ndata, cbdata, pbs_pmix_release, data);
+}
+
+/**
+ * @brief
+ * Append a block of data to a growing buffer
+ *
+ * @param[in,out] bufp - buffer, reallocated as needed
+ * @param[in,out] lenp - length of the buffer
+ * @param[in] data - data to append
+ * @param[in] ndata - length of data
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - out of memory
+ */
+static int
+pbs_pmix_append(char **bufp, size_t *lenp, const char *data, size_t ndata)
+{
+	char *nbuf;
+
+	if (ndata == 0)
+		return 0;
+	nbuf = realloc(*bufp, *lenp + ndata);
+	if (!nbuf) {
+		log_err(errno, __func__, "realloc failure");
+		return -1;
+	}
+	memcpy(nbuf + *lenp, data, ndata);
+	*bufp = nbuf;
+	*lenp += ndata;
+	return 0;
+}
+
+/**
+ * @brief
+ * Start an IM_PMIX message to another MoM of the job
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] node - node id of the destination
+ * @param[in] msg - the pbs_pmix_msg operation
+ * @param[out] streamp - stream to write the rest of the message on
+ *
+ * @return int
+ * @retval DIS_SUCCESS - message started
+ * @retval other - DIS error
+ */
+static int
+pbs_pmix_msg_start(job *pjob, int node, int msg, int *streamp)
+{
+	hnodent *np;
+	int ret;
+
+	*streamp = -1;
+	if ((node < 0) || (node >= pjob->ji_numnodes))
+		return DIS_PROTO;
+	np = &pjob->ji_hosts[node];
+	if (np->hn_stream == -1)
+		np->hn_stream = tpp_open(np->hn_host, np->hn_port);
+	*streamp = np->hn_stream;
+	ret = im_compose(np->hn_stream, pjob->ji_qs.ji_jobid,
+		get_jattr_str(pjob, JOB_ATR_Cookie), IM_PMIX,
+		TM_NULL_EVENT, TM_NULL_TASK, IM_PROTOCOL_VER);
+	if (ret != DIS_SUCCESS)
+		return ret;
+	ret = diswsi(np->hn_stream, pjob->ji_nodeid);
+	if (ret != DIS_SUCCESS)
+		return ret;
+	return diswsi(np->hn_stream, msg);
+}
+
+/**
+ * @brief
+ * Finish an IM_PMIX message started by pbs_pmix_msg_start()
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] node - node id of the destination
+ * @param[in] stream - stream the message was written on
+ * @param[in] ret - outcome of writing the message so far
+ *
+ * @return int
+ * @retval 0 - message sent
+ * @retval -1 - failure, the stream has been closed
+ */
+static int
+pbs_pmix_msg_end(job *pjob, int node, int stream, int ret)
+{
+	if ((ret == DIS_SUCCESS) && (dis_flush(stream) == 0))
+		return 0;
+	log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_ERR,
+		pjob->ji_qs.ji_jobid,
+		"Failed to send PMIx message to node %d", node);
+	if (stream >= 0) {
+		tpp_close(stream);
+		pjob->ji_hosts[node].hn_stream = -1;
+	}
+	return -1;
+}
+
+/**
+ * @brief
+ * Send the data of a fence to another MoM taking part in it
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] fp - the fence
+ * @param[in] node - node id of the destination
+ * @param[in] msg - PBS_PMIX_MSG_FENCE_UP or PBS_PMIX_MSG_FENCE_DOWN
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure
+ */
+static int
+pbs_pmix_fence_send(job *pjob, pbs_pmix_fence_t *fp, int node, int msg)
+{
+	int stream;
+	int ret;
+
+	ret = pbs_pmix_msg_start(pjob, node, msg, &stream);
+	if (ret == DIS_SUCCESS)
+		ret = diswul(stream, fp->fe_sig);
+	if (ret == DIS_SUCCESS)
+		ret = diswui(stream, fp->fe_seq);
+	if (ret == DIS_SUCCESS)
+		ret = diswcs(stream, fp->fe_data ? fp->fe_data : "", fp->fe_ndata);
+	return pbs_pmix_msg_end(pjob, node, stream, ret);
+}
+
+/**
+ * @brief
+ * Find the record of a fence, optionally creating it
+ *
+ * @param[in] jobid - job the fence belongs to
+ * @param[in] sig - signature of the participating nodes
+ * @param[in] seq - fence number among those with the same signature
+ * @param[in] create - create the record if it does not exist
+ *
+ * @return pbs_pmix_fence_t *
+ * @retval the fence record
+ * @retval NULL - not found or out of memory
+ */
+static pbs_pmix_fence_t *
+pbs_pmix_fence_find(char *jobid, unsigned long sig, unsigned int seq, int create)
+{
+	pbs_pmix_fence_t *fp;
+
+	for (fp = (pbs_pmix_fence_t *)GET_NEXT(pbs_pmix_fences); fp;
+		fp = (pbs_pmix_fence_t *)GET_NEXT(fp->fe_link)) {
+		if ((fp->fe_sig == sig) && (fp->fe_seq == seq) &&
+			(strcmp(fp->fe_jobid, jobid) == 0))
+			return fp;
+	}
+	if (!create)
+		return NULL;
+	fp = calloc(1, sizeof(*fp));
+	if (!fp) {
+		log_err(errno, __func__, "calloc failure");
+		return NULL;
+	}
+	CLEAR_LINK(fp->fe_link);
+	pbs_strncpy(fp->fe_jobid, jobid, sizeof(fp->fe_jobid));
+	fp->fe_sig = sig;
+	fp->fe_seq = seq;
+	fp->fe_me = -1;
+	append_link(&pbs_pmix_fences, &fp->fe_link, fp);
+	return fp;
+}
+
+/**
+ * @brief
+ * Free a fence record, failing the local fence if it is still pending
+ *
+ * @param[in] fp - the fence
+ * @param[in] status - status passed to the local server if pending
+ *
+ * @return void
+ */
+static void
+pbs_pmix_fence_free(pbs_pmix_fence_t *fp, pmix_status_t status)
+{
+	delete_link(&fp->fe_link);
+	if (fp->fe_local && fp->fe_cbfunc)
+		pbs_pmix_deliver(fp->fe_cbfunc, fp->fe_cbdata, status, NULL, 0);
+	free(fp->fe_data);
+	free(fp->fe_nodes);
+	free(fp);
+}
+
+/**
+ * @brief
+ * Send the combined data of a completed fence down the tree and hand
+ * it to the local server
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] fp - the fence, freed on return
+ *
+ * @return void
+ */
+static void
+pbs_pmix_fence_down(job *pjob, pbs_pmix_fence_t *fp)
+{
+	int child;
+
+	for (child = 2 * fp->fe_me + 1;
+		(child < fp->fe_nnodes) && (child <= 2 * fp->fe_me + 2); child++)
+		(void)pbs_pmix_fence_send(pjob, fp, fp->fe_nodes[child],
+			PBS_PMIX_MSG_FENCE_DOWN);
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+		pjob->ji_qs.ji_jobid, "PMIx fence %u complete, %lu bytes",
+		fp->fe_seq, (unsigned long)fp->fe_ndata);
+	pbs_pmix_deliver(fp->fe_cbfunc, fp->fe_cbdata, PMIX_SUCCESS,
+		fp->fe_data, fp->fe_ndata);
+	fp->fe_data = NULL;
+	fp->fe_cbfunc = NULL;
+	pbs_pmix_fence_free(fp, PMIX_SUCCESS);
+}
+
+/**
+ * @brief
+ * Move a fence on once the local server and all children in the tree
+ * have entered it: the root sends the result down, others pass the
+ * data of their subtree up to their parent.
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] fp - the fence
+ *
+ * @return void
+ */
+static void
+pbs_pmix_fence_check(job *pjob, pbs_pmix_fence_t *fp)
+{
+	int nchild = 0;
+
+	if (!fp->fe_local)
+		return;
+	if (2 * fp->fe_me + 1 < fp->fe_nnodes)
+		nchild++;
+	if (2 * fp->fe_me + 2 < fp->fe_nnodes)
+		nchild++;
+	if (fp->fe_recvd < nchild)
+		return;
+	if (fp->fe_me == 0) {
+		pbs_pmix_fence_down(pjob, fp);
+		return;
+	}
+	if (pbs_pmix_fence_send(pjob, fp, fp->fe_nodes[(fp->fe_me - 1) / 2],
+		PBS_PMIX_MSG_FENCE_UP) != 0)
+		pbs_pmix_fence_free(fp, PMIX_ERR_UNREACH);
+}
+
+/**
+ * @brief
+ * Process a fence entered by the local PMIx server
+ *
+ * @param[in] op - the queued fence operation
+ *
+ * @return void
+ */
+static void
+pbs_pmix_fence_start(pbs_pmix_oper_t *op)
+{
+	job *pjob;
+	pbs_pmix_fence_t *fp;
+	pbs_pmix_fence_seq_t *sp;
+	vmpiprocs *vp;
+	char *mark;
+	int *nodes;
+	int nnodes = 0;
+	int me = -1;
+	unsigned long sig = 2166136261UL;
+	size_t i;
+	int n;
+
+	pjob = find_job(op->nspace);
+	if (!pjob) {
+		log_eventf(PBSEVENT_ERROR, 0, LOG_ERR, __func__,
+			"Job not found: %s", op->nspace);
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOT_FOUND, NULL, 0);
+		return;
+	}
+	/* the MoMs hosting the participants, in node id order */
+	mark = calloc(pjob->ji_numnodes, 1);
+	nodes = calloc(pjob->ji_numnodes, sizeof(int));
+	if (!mark || !nodes) {
+		log_err(errno, __func__, "calloc failure");
+		free(mark);
+		free(nodes);
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOMEM, NULL, 0);
+		return;
+	}
+	for (i = 0; i < op->nranks; i++) {
+		if (op->ranks[i] == PMIX_RANK_WILDCARD) {
+			memset(mark, 1, pjob->ji_numnodes);
+			break;
+		}
+		vp = find_vmpiproc(pjob, (tm_node_id)op->ranks[i]);
+		if (vp && vp->vn_host)
+			mark[vp->vn_host->hn_node] = 1;
+	}
+	for (n = 0; n < pjob->ji_numnodes; n++) {
+		if (!mark[n])
+			continue;
+		if (n == pjob->ji_nodeid)
+			me = nnodes;
+		nodes[nnodes++] = n;
+		sig = (sig ^ (unsigned long)n) * 16777619UL;
+	}
+	free(mark);
+	if (me < 0) {
+		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_ERR,
+			pjob->ji_qs.ji_jobid,
+			"PMIx fence does not include the local node");
+		free(nodes);
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_BAD_PARAM, NULL, 0);
+		return;
+	}
+
+	/* all MoMs number the fences among a set of nodes the same way */
+	for (sp = (pbs_pmix_fence_seq_t *)GET_NEXT(pbs_pmix_fence_seqs); sp;
+		sp = (pbs_pmix_fence_seq_t *)GET_NEXT(sp->fs_link)) {
+		if ((sp->fs_sig == sig) &&
+			(strcmp(sp->fs_jobid, pjob->ji_qs.ji_jobid) == 0))
+			break;
+	}
+	if (!sp) {
+		sp = calloc(1, sizeof(*sp));
+		if (!sp) {
+			log_err(errno, __func__, "calloc failure");
+			free(nodes);
+			pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOMEM, NULL, 0);
+			return;
+		}
+		CLEAR_LINK(sp->fs_link);
+		pbs_strncpy(sp->fs_jobid, pjob->ji_qs.ji_jobid, sizeof(sp->fs_jobid));
+		sp->fs_sig = sig;
+		append_link(&pbs_pmix_fence_seqs, &sp->fs_link, sp);
+	}
+
+	fp = pbs_pmix_fence_find(pjob->ji_qs.ji_jobid, sig, sp->fs_count++, 1);
+	if (!fp || (pbs_pmix_append(&fp->fe_data, &fp->fe_ndata,
+		op->data, op->ndata) != 0)) {
+		free(nodes);
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOMEM, NULL, 0);
+		return;
+	}
+	fp->fe_nodes = nodes;
+	fp->fe_nnodes = nnodes;
+	fp->fe_me = me;
+	fp->fe_local = true;
+	fp->fe_cbfunc = op->cbfunc;
+	fp->fe_cbdata = op->cbdata;
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+		pjob->ji_qs.ji_jobid, "PMIx fence %u entered, %d node(s)",
+		fp->fe_seq, nnodes);
+	pbs_pmix_fence_check(pjob, fp);
+}
+
+/**
+ * @brief
+ * Ask the MoM hosting a rank for the data it published
+ *
+ * @param[in] op - the queued direct modex operation
+ *
+ * @return void
+ */
+static void
+pbs_pmix_dmodex_start(pbs_pmix_oper_t *op)
+{
+	static unsigned int dmodex_id = 0;
+	job *pjob;
+	vmpiprocs *vp;
+	pbs_pmix_dmodex_t *dp;
+	int node;
+	int stream;
+	int ret;
+
+	pjob = find_job(op->nspace);
+	vp = pjob ? find_vmpiproc(pjob, (tm_node_id)op->rank) : NULL;
+	if (!vp || !vp->vn_host ||
+		((node = vp->vn_host->hn_node) == pjob->ji_nodeid)) {
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOT_FOUND, NULL, 0);
+		return;
+	}
+	dp = calloc(1, sizeof(*dp));
+	if (!dp) {
+		log_err(errno, __func__, "calloc failure");
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_NOMEM, NULL, 0);
+		return;
+	}
+	CLEAR_LINK(dp->dm_link);
+	pbs_strncpy(dp->dm_jobid, pjob->ji_qs.ji_jobid, sizeof(dp->dm_jobid));
+	dp->dm_id = ++dmodex_id;
+	dp->dm_cbfunc = op->cbfunc;
+	dp->dm_cbdata = op->cbdata;
+
+	ret = pbs_pmix_msg_start(pjob, node, PBS_PMIX_MSG_DMODEX_REQ, &stream);
+	if (ret == DIS_SUCCESS)
+		ret = diswui(stream, dp->dm_id);
+	if (ret == DIS_SUCCESS)
+		ret = diswui(stream, op->rank);
+	if (pbs_pmix_msg_end(pjob, node, stream, ret) != 0) {
+		pbs_pmix_deliver(op->cbfunc, op->cbdata, PMIX_ERR_UNREACH, NULL, 0);
+		free(dp);
+		return;
+	}
+	append_link(&pbs_pmix_dmodexes, &dp->dm_link, dp);
+}
+
+/**
+ * @brief
+ * Send the data of a local rank back to the MoM that asked for it
+ *
+ * @param[in] op - the queued direct modex data operation
+ *
+ * @return void
+ */
+static void
+pbs_pmix_dmodex_reply(pbs_pmix_oper_t *op)
+{
+	job *pjob;
+	int stream;
+	int ret;
+
+	pjob = find_job(op->nspace);
+	if (!pjob)
+		return;
+	ret = pbs_pmix_msg_start(pjob, op->node, PBS_PMIX_MSG_DMODEX_RESP, &stream);
+	if (ret == DIS_SUCCESS)
+		ret = diswui(stream, op->id);
+	if (ret == DIS_SUCCESS)
+		ret = diswsi(stream, op->status);
+	if (ret == DIS_SUCCESS)
+		ret = diswcs(stream, op->data ? op->data : "", op->ndata);
+	(void)pbs_pmix_msg_end(pjob, op->node, stream, ret);
+}
+
+/**
+ * @brief
+ * Callback invoked by the PMIx server thread with the data of a local
+ * rank requested by a remote MoM
+ *
+ * @param[in] status - outcome of the request
+ * @param[in] data - the data, owned by PMIx
+ * @param[in] sz - length of data
+ * @param[in] cbdata - the pbs_pmix_oper_t to send the reply with
+ *
+ * @return void
+ */
+static void
+pbs_pmix_dmodex_cb(pmix_status_t status, char *data, size_t sz, void *cbdata)
+{
+	pbs_pmix_oper_t *op = (pbs_pmix_oper_t *)cbdata;
+
+	op->status = status;
+	if ((status == PMIX_SUCCESS) && (sz > 0)) {
+		op->data = malloc(sz);
+		if (op->data) {
+			memcpy(op->data, data, sz);
+			op->ndata = sz;
+		} else
+			op->status = PMIX_ERR_NOMEM;
+	}
+	pbs_pmix_queue(op);
+}
+
+/**
+ * @brief
+ * Read end of pbs_pmix_pipe is ready: run the operations queued by the
+ * PMIx server thread
+ *
+ * @param[in] fd - read end of the pipe
+ *
+ * @return void
+ */
+static void
+pbs_pmix_process_queue(int fd)
+{
+	char buf[64];
+	pbs_pmix_oper_t *op;
+	pbs_pmix_oper_t *next;
+
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+	pthread_mutex_lock(&pbs_pmix_queue_lock);
+	op = pbs_pmix_queue_head;
+	pbs_pmix_queue_head = pbs_pmix_queue_tail = NULL;
+	pthread_mutex_unlock(&pbs_pmix_queue_lock);
+
+	for (; op; op = next) {
+		next = op->next;
+		switch (op->type) {
+			case PBS_PMIX_FENCE:
+				pbs_pmix_fence_start(op);
+				break;
+			case PBS_PMIX_DMODEX:
+				pbs_pmix_dmodex_start(op);
+				break;
+			case PBS_PMIX_DMODEX_DATA:
+				pbs_pmix_dmodex_reply(op);
+				break;
+			default:
+				log_err(-1, __func__, "unknown PMIx operation");
+				break;
+		}
+		pbs_pmix_oper_free(op);
+	}
+}
+
+/**
+ * @brief
+ * Handle an IM_PMIX request sent by another MoM of the job
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] stream - stream to read the rest of the request from
+ *
+ * @return int
+ * @retval DIS_SUCCESS - request read
+ * @retval other - DIS error, the request could not be read
+ *
+ * @note
+ * auxiliary info (
+ *	sending node	tm_node_id;
+ *	operation	int;
+ *	fence:		signature u_long, fence number uint, data string;
+ *	dmodex request:	request id uint, rank uint;
+ *	dmodex reply:	request id uint, status int, data string;
+ * )
+ */
+int
+pbs_pmix_im_request(job *pjob, int stream)
+{
+	int ret;
+	int from;
+	int msg;
+	unsigned long sig;
+	unsigned int seq;
+	unsigned int id;
+	pmix_rank_t rank;
+	pmix_status_t status;
+	pmix_proc_t pproc;
+	char *data = NULL;
+	size_t ndata = 0;
+	pbs_pmix_fence_t *fp;
+	pbs_pmix_dmodex_t *dp;
+	pbs_pmix_oper_t *op;
+
+	from = disrsi(stream, &ret);
+	if (ret != DIS_SUCCESS)
+		return ret;
+	msg = disrsi(stream, &ret);
+	if (ret != DIS_SUCCESS)
+		return ret;
+
+	switch (msg) {
+		case PBS_PMIX_MSG_FENCE_UP:
+		case PBS_PMIX_MSG_FENCE_DOWN:
+			sig = disrul(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			seq = disrui(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			data = disrcs(stream, &ndata, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			fp = pbs_pmix_fence_find(pjob->ji_qs.ji_jobid, sig, seq,
+				msg == PBS_PMIX_MSG_FENCE_UP);
+			if (!fp) {
+				log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_ERR,
+					pjob->ji_qs.ji_jobid,
+					"PMIx fence %u from node %d not found", seq, from);
+				break;
+			}
+			if (msg == PBS_PMIX_MSG_FENCE_UP) {
+				if (pbs_pmix_append(&fp->fe_data, &fp->fe_ndata,
+					data, ndata) != 0) {
+					pbs_pmix_fence_free(fp, PMIX_ERR_NOMEM);
+					break;
+				}
+				fp->fe_recvd++;
+				pbs_pmix_fence_check(pjob, fp);
+			} else if (!fp->fe_local) {
+				log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_ERR,
+					pjob->ji_qs.ji_jobid,
+					"PMIx fence %u completed before it was entered", seq);
+				pbs_pmix_fence_free(fp, PMIX_ERROR);
+			} else {
+				free(fp->fe_data);
+				fp->fe_data = data;
+				fp->fe_ndata = ndata;
+				data = NULL;
+				pbs_pmix_fence_down(pjob, fp);
+			}
+			break;
+
+		case PBS_PMIX_MSG_DMODEX_REQ:
+			id = disrui(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			rank = (pmix_rank_t)disrui(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			op = calloc(1, sizeof(*op));
+			if (!op) {
+				log_err(errno, __func__, "calloc failure");
+				break;
+			}
+			op->type = PBS_PMIX_DMODEX_DATA;
+			pbs_strncpy(op->nspace, pjob->ji_qs.ji_jobid, sizeof(op->nspace));
+			op->node = from;
+			op->id = id;
+			PMIX_LOAD_PROCID(&pproc, pjob->ji_qs.ji_jobid, rank);
+			status = PMIx_server_dmodex_request(&pproc, pbs_pmix_dmodex_cb, op);
+			if (status != PMIX_SUCCESS) {
+				op->status = status;
+				pbs_pmix_dmodex_reply(op);
+				pbs_pmix_oper_free(op);
+			}
+			break;
+
+		case PBS_PMIX_MSG_DMODEX_RESP:
+			id = disrui(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			status = (pmix_status_t)disrsi(stream, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			data = disrcs(stream, &ndata, &ret);
+			if (ret != DIS_SUCCESS)
+				return ret;
+			for (dp = (pbs_pmix_dmodex_t *)GET_NEXT(pbs_pmix_dmodexes); dp;
+				dp = (pbs_pmix_dmodex_t *)GET_NEXT(dp->dm_link)) {
+				if ((dp->dm_id == id) &&
+					(strcmp(dp->dm_jobid, pjob->ji_qs.ji_jobid) == 0))
+					break;
+			}
+			if (!dp)
+				break;
+			delete_link(&dp->dm_link);
+			pbs_pmix_deliver(dp->dm_cbfunc, dp->dm_cbdata, status,
+				(status == PMIX_SUCCESS) ? data : NULL,
+				(status == PMIX_SUCCESS) ? ndata : 0);
+			if (status == PMIX_SUCCESS)
+				data = NULL;
+			free(dp);
+			break;
+
+		default:
+			log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_ERR,
+				pjob->ji_qs.ji_jobid,
+				"Unknown PMIx operation %d from node %d", msg, from);
+			break;
+	}
+	free(data);
+	return DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ * Fail and forget the fences and direct modex requests of a job
+ *
+ * @param[in] pjob - pointer to job structure
+ *
+ * @return void
+ */
+static void
+pbs_pmix_purge_opers(job *pjob)
+{
+	pbs_pmix_fence_t *fp, *nfp;
+	pbs_pmix_fence_seq_t *sp, *nsp;
+	pbs_pmix_dmodex_t *dp, *ndp;
+
+	for (fp = (pbs_pmix_fence_t *)GET_NEXT(pbs_pmix_fences); fp; fp = nfp) {
+		nfp = (pbs_pmix_fence_t *)GET_NEXT(fp->fe_link);
+		if (strcmp(fp->fe_jobid, pjob->ji_qs.ji_jobid) == 0)
+			pbs_pmix_fence_free(fp, PMIX_ERR_JOB_TERMINATED);
+	}
+	for (sp = (pbs_pmix_fence_seq_t *)GET_NEXT(pbs_pmix_fence_seqs); sp; sp = nsp) {
+		nsp = (pbs_pmix_fence_seq_t *)GET_NEXT(sp->fs_link);
+		if (strcmp(sp->fs_jobid, pjob->ji_qs.ji_jobid) == 0) {
+			delete_link(&sp->fs_link);
+			free(sp);
+		}
+	}
+	for (dp = (pbs_pmix_dmodex_t *)GET_NEXT(pbs_pmix_dmodexes); dp; dp = ndp) {
+		ndp = (pbs_pmix_dmodex_t *)GET_NEXT(dp->dm_link);
+		if (strcmp(dp->dm_jobid, pjob->ji_qs.ji_jobid) == 0) {
+			delete_link(&dp->dm_link);
+			pbs_pmix_deliver(dp->dm_cbfunc, dp->dm_cbdata,
+				PMIX_ERR_JOB_TERMINATED, NULL, 0);
+			free(dp);
+		}
+	}
+}
+
 /**
  * @brief
  * This callback function is invoked by the PMIx library after it
@@ -429,6 +1263,7 @@ pbs_pmix_fence_nb(
 {
 	int i;
 	job *pjob;
+	pbs_pmix_oper_t *op;
 
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "called");
 	if (!proc) {
@@ -459,16 +1294,33 @@ pbs_pmix_fence_nb(
 	log_eventf(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__,
 			"There are %lu data entries", ndata);
 	/*
-	 * If MS, find/create the barrier for this job. Otherwise, send
-	 * a message to MS that a fence has been encountered. Once all
-	 * ranks have been accounted for, invoke the callback function.
+	 * The fence is carried out by the main thread over a tree of the
+	 * MoMs hosting the participants, see pbs_pmix_fence_start(). Copy
+	 * what it needs since PMIx owns proc and data.
 	 */
-	log_eventf(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__,
-		"cbfunc %s NULL", cbfunc ? "is not" : "is");
-	log_eventf(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__,
-		"cbdata %s NULL", cbdata ? "is not" : "is");
+	op = calloc(1, sizeof(*op));
+	if (op)
+		op->ranks = calloc(nproc, sizeof(pmix_rank_t));
+	if (op && ndata)
+		op->data = malloc(ndata);
+	if (!op || !op->ranks || (ndata && !op->data)) {
+		log_err(errno, __func__, "malloc failure");
+		pbs_pmix_oper_free(op);
+		return PMIX_ERR_NOMEM;
+	}
+	op->type = PBS_PMIX_FENCE;
+	pbs_strncpy(op->nspace, proc->nspace, sizeof(op->nspace));
+	for (i = 0; i < nproc; i++)
+		op->ranks[i] = proc[i].rank;
+	op->nranks = nproc;
+	if (ndata)
+		memcpy(op->data, data, ndata);
+	op->ndata = ndata;
+	op->cbfunc = cbfunc;
+	op->cbdata = cbdata;
+	pbs_pmix_queue(op);
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "returning");
-	return PMIX_OPERATION_SUCCEEDED;
+	return PMIX_SUCCESS;
 }
 
 /**
@@ -496,9 +1348,25 @@ pbs_pmix_direct_modex(
 	pmix_modex_cbfunc_t cbfunc,
 	void *cbdata)
 {
+	pbs_pmix_oper_t *op;
+
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "called");
+	if (!proc || !cbfunc)
+		return PMIX_ERR_BAD_PARAM;
+	/* the main thread asks the MoM hosting the rank, see pbs_pmix_dmodex_start() */
+	op = calloc(1, sizeof(*op));
+	if (!op) {
+		log_err(errno, __func__, "calloc failure");
+		return PMIX_ERR_NOMEM;
+	}
+	op->type = PBS_PMIX_DMODEX;
+	pbs_strncpy(op->nspace, proc->nspace, sizeof(op->nspace));
+	op->rank = proc->rank;
+	op->cbfunc = cbfunc;
+	op->cbdata = cbdata;
+	pbs_pmix_queue(op);
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "returning");
-	return PMIX_ERR_NOT_IMPLEMENTED;
+	return PMIX_SUCCESS;
 }
 
 /**
@@ -785,6 +1653,7 @@ pbs_pmix_deregister_events(
 void
 pbs_pmix_server_init(char *name)
 {
+	int i;
 	pmix_status_t pstat;
 	pmix_server_module_t pbs_pmix_server_module = {
 		/* v1x interfaces */
@@ -828,6 +1697,23 @@ pbs_pmix_server_init(char *name)
 #endif
 	};
 
+	CLEAR_HEAD(pbs_pmix_fences);
+	CLEAR_HEAD(pbs_pmix_fence_seqs);
+	CLEAR_HEAD(pbs_pmix_dmodexes);
+	/* wakes the main thread up when the PMIx thread queues an operation */
+	if (pipe(pbs_pmix_pipe) == -1) {
+		log_err(errno, __func__, "Could not create PMIx pipe");
+		return;
+	}
+	for (i = 0; i < 2; i++) {
+		(void)fcntl(pbs_pmix_pipe[i], F_SETFD, FD_CLOEXEC);
+		(void)fcntl(pbs_pmix_pipe[i], F_SETFL, O_NONBLOCK);
+	}
+	if (add_conn(pbs_pmix_pipe[0], ChildPipe, (pbs_net_t)0, 0, NULL,
+		pbs_pmix_process_queue) == NULL) {
+		log_err(-1, __func__, "Could not add PMIx pipe to connection table");
+		return;
+	}
 	pstat = PMIx_server_init(&pbs_pmix_server_module, NULL, 0);
 	if (pstat != PMIX_SUCCESS) {
 		log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER,
@@ -1469,6 +2355,7 @@ int
 pbs_pmix_job_clean_extra(job *pjob)
 {
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "called");
+	pbs_pmix_purge_opers(pjob);
 	pbs_pmix_deregister_namespace(pjob);
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, "returning");
 	return 0;
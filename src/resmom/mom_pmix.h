@@ -69,6 +69,9 @@ pbs_pmix_job_join_extra(job *, hnodent *);
 extern int
 pbs_pmix_job_clean_extra(job *);
 
+extern int
+pbs_pmix_im_request(job *, int);
+
 #endif /* PMIX */
 
 #ifdef  __cplusplus
@@ -150,6 +150,7 @@ typedef struct node_t {
 	struct node_t	*left, *right;
 } node;
 node		*okclients = NULL;	/* tree of ip addrs */
+int		num_okclients = 0;	/* number of addrs in okclients */
 
 /**
  * @brief
@@ -208,6 +209,7 @@ addrinsert(const u_long key)
 		*rootp = q;			/* link new node to old */
 		q->key = key;			/* initialize new node */
 		q->left = q->right = NULL;
+		num_okclients++;
 		sprintf(log_buffer,
 			"Adding IP address %ld.%ld.%ld.%ld as authorized",
 			(key & 0xff000000) >> 24,
@@ -830,6 +832,8 @@ is_request(int stream, int version)
 			DBPRT(("%s: IS_REPLYHELLO, state=0x%x stream=%d\n", __func__,
 				internal_state, stream))
 			time_delta_hellosvr(MOM_DELTA_RESET);
+			/* the server may have restarted, send it all again */
+			send_full_updates();
 			need_inv = disrsi(stream, &ret);
 			if (ret != DIS_SUCCESS)
 				goto err;
@@ -45,6 +45,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 #include <Python.h>
 #include <time.h>
+#include <ctype.h>
 #include "resource.h"
 #include "job.h"
 #include "mom_func.h"
@@ -62,6 +63,12 @@ static ruu *get_job_update(job *pjob);
 static PyObject *json_loads(char *value, char *msg, size_t msg_len);
 static char *json_dumps(PyObject *py_val, char *msg, size_t msg_len);
 static void encode_used(job *pjob, pbs_list_head *phead);
+static void drop_unchanged_used(ruu *prused, int delta);
+
+static int ruu_sent_gen = 1;	/* see send_full_updates() */
+
+int resc_used_change = 0;		/* % change of cput or mem that makes a poll update due, 0 for every poll */
+int resc_used_max_interval = 300;	/* most seconds between poll updates when resc_used_change is set */
 
 static PyObject *py_json_name = NULL;
 static PyObject *py_json_module = NULL;
@@ -627,11 +634,15 @@ encode_used(job *pjob, pbs_list_head *phead)
 			if (val.at_type == ATR_TYPE_STR && pjob->ji_numnodes == 1) {
 				/* check if string value is a valid json string,
 				 * if it is then set the resource string within
-				 * single quotes.
+				 * single quotes.  Only a JSON object can change
+				 * on the way through, so skip Python for others.
 				 */
 
 				sval = val.at_val.at_str;
-				if ((py_jvalue = json_loads(sval, emsg, HOOK_BUF_SIZE - 1)) != NULL) {
+				while ((sval != NULL) && isspace((int)*sval))
+					sval++;
+				if ((sval != NULL) && (*sval == '{') &&
+					((py_jvalue = json_loads(sval, emsg, HOOK_BUF_SIZE - 1)) != NULL)) {
 					dumps = json_dumps(py_jvalue, emsg, HOOK_BUF_SIZE - 1);
 					if (dumps == NULL)
 						Py_CLEAR(py_jvalue);
@@ -956,6 +967,155 @@ err:
 	return;
 }
 
+/**
+ * @brief
+ * 	Make the next update of every job carry all of its resources_used
+ * 	values again, as when the server has (re)connected and may not have
+ * 	seen the ones before.
+ *
+ * @return void
+ */
+void
+send_full_updates(void)
+{
+	ruu_sent_gen++;
+}
+
+/**
+ * @brief
+ * 	Tell whether a value moved by at least resc_used_change percent.
+ *
+ * @param[in] now  - current value
+ * @param[in] then - value last sent
+ *
+ * @return int
+ * @retval 1 - changed enough
+ * @retval 0 - not
+ */
+static int
+resc_used_moved(u_long now, u_long then)
+{
+	u_long diff;
+
+	if (then == 0)
+		return (now != 0);
+	diff = (now > then) ? now - then : then - now;
+	return ((double)diff * 100.0 >= (double)then * resc_used_change);
+}
+
+/**
+ * @brief
+ * 	Decide whether the periodic resources_used update of a running job
+ * 	is due.
+ *
+ * @par
+ * 	With $resc_used_change set, a poll only updates the server when the
+ * 	job's total cput or mem moved by that percentage since the last poll
+ * 	update, or resc_used_max_interval seconds went by, or the server
+ * 	(re)connected.  Updates for state changes and obits are not affected.
+ *
+ * @param[in] pjob - running job, MS only
+ *
+ * @return int
+ * @retval 1 - send an update, and remember it as the last one
+ * @retval 0 - skip this poll
+ */
+int
+resc_used_update_due(job *pjob)
+{
+	u_long cput;
+	u_long mem;
+	int i;
+
+	cput = resc_used(pjob, "cput", gettime);
+	mem = resc_used(pjob, "mem", getsize);
+	for (i = 0; (pjob->ji_resources != NULL) && (i < pjob->ji_numrescs); i++) {
+		cput += pjob->ji_resources[i].nr_cput;
+		mem += pjob->ji_resources[i].nr_mem;
+	}
+
+	if ((resc_used_change > 0) &&
+		(pjob->ji_ruu_time != 0) &&
+		(pjob->ji_ruu_gen == ruu_sent_gen) &&
+		(time_now < pjob->ji_ruu_time + resc_used_max_interval) &&
+		!resc_used_moved(cput, pjob->ji_ruu_cput) &&
+		!resc_used_moved(mem, pjob->ji_ruu_mem))
+		return 0;
+
+	pjob->ji_ruu_cput = cput;
+	pjob->ji_ruu_mem = mem;
+	pjob->ji_ruu_time = time_now;
+	return 1;
+}
+
+/**
+ * @brief
+ * 	Remember the resources_used values of an update as sent to the server
+ * 	and, if asked to, take out of it those the server already has from
+ * 	the previous update of the job.
+ *
+ * @par
+ * 	The server merges resources_used values into what it has, so a value
+ * 	left out keeps what was sent before.  Most values of a running job,
+ * 	e.g. ncpus or a steady mem, do not change between two polls.
+ *
+ * @param[in,out] prused - the update
+ * @param[in]     delta  - take unchanged values out of the update
+ *
+ * @return void
+ */
+static void
+drop_unchanged_used(ruu *prused, int delta)
+{
+	job *pjob = prused->ru_pjob;
+	svrattrl *pal;
+	svrattrl *next;
+	svrattrl *psent;
+
+	if (pjob == NULL)
+		return;
+
+	if (pjob->ji_ruu_gen != ruu_sent_gen) {
+		/* the server may not have anything sent so far */
+		free_attrlist(&pjob->ji_ruu_sent);
+		pjob->ji_ruu_gen = ruu_sent_gen;
+		delta = 0;
+	}
+
+	for (pal = (svrattrl *) GET_NEXT(prused->ru_attr); pal != NULL; pal = next) {
+		next = (svrattrl *) GET_NEXT(pal->al_link);
+		if ((pal->al_resc == NULL) || (strcmp(pal->al_name, ATTR_used) != 0))
+			continue;
+
+		psent = (svrattrl *) GET_NEXT(pjob->ji_ruu_sent);
+		for (; psent != NULL; psent = (svrattrl *) GET_NEXT(psent->al_link)) {
+			if (strcmp(psent->al_resc, pal->al_resc) == 0)
+				break;
+		}
+		if ((psent != NULL) && (strcmp(psent->al_value, pal->al_value) == 0)) {
+			if (delta) {
+				delete_link(&pal->al_link);
+				attrlist_free(pal);
+			}
+			continue;
+		}
+		if (psent != NULL) {
+			delete_link(&psent->al_link);
+			attrlist_free(psent);
+		}
+		psent = attrlist_create(pal->al_name, pal->al_resc, strlen(pal->al_value) + 1);
+		if (psent == NULL) {
+			log_joberr(errno, __func__, "Out of memory", pjob->ji_qs.ji_jobid);
+			/* send everything next time */
+			free_attrlist(&pjob->ji_ruu_sent);
+			pjob->ji_ruu_gen = 0;
+			return;
+		}
+		strcpy(psent->al_value, pal->al_value);
+		append_link(&pjob->ji_ruu_sent, &psent->al_link, psent);
+	}
+}
+
 /**
  * @brief
  * 	generate pending update bundles and send it to server
@@ -974,6 +1134,10 @@ send_pending_updates(void)
 	ruu *next;
 
 	bundle_ruu(&r_cnt, &prused, &rh_cnt, &prhused, &obits_cnt, &obits);
+	for (next = prused; next != NULL; next = next->ru_next)
+		drop_unchanged_used(next, 1);
+	for (next = prhused; next != NULL; next = next->ru_next)
+		drop_unchanged_used(next, 0);
 	if (r_cnt > 0) {
 		send_resc_used(IS_RESCUSED, r_cnt, prused);
 		while (prused != NULL) {
@@ -69,6 +69,7 @@ extern unsigned int	pbs_mom_port;
 extern unsigned int	pbs_rm_port;
 extern vnl_t		*vnlp;					/* vnode list */
 static void		*cpuctx;
+static void		*cpunum_idx;	/* physical CPU number to mom_vninfo_t */
 static void		cpu_inuse(unsigned int, job *, int);
 static void		*new_ctx(void);
 static mom_vninfo_t	*new_vnid(const char *, void *);
@@ -261,6 +262,40 @@ mom_vnlp_report(vnl_t *vnl, char *header)
 	}
 }
 
+/**
+ * @brief
+ *	Remember which vnode owns CPU cpunum so that cpu_inuse() need not walk
+ *	every vnode's CPU list.  Should a CPU be listed for more than one vnode,
+ *	the first vnode it was added to keeps it.  If the index cannot be built
+ *	cpu_inuse() falls back to searching the lists.
+ *
+ * @param[in] cpunum - physical CPU number
+ * @param[in] mvp - vnode whose CPU list now contains cpunum
+ *
+ * @return Void
+ *
+ */
+static void
+cpunum_index(unsigned int cpunum, mom_vninfo_t *mvp)
+{
+	void		*key = &cpunum;
+	mom_vninfo_t	*owner = NULL;
+
+	if (cpunum_idx == NULL) {
+		if ((cpunum_idx = pbs_idx_create(PBS_IDX_HASH, sizeof(unsigned int))) == NULL) {
+			log_err(errno, __func__, "Creating CPU index failed");
+			return;
+		}
+	}
+	if (pbs_idx_find(cpunum_idx, &key, (void **)&owner, NULL) == PBS_IDX_RET_OK)
+		return;
+	if (pbs_idx_insert(cpunum_idx, key, mvp) != PBS_IDX_RET_OK) {
+		log_err(errno, __func__, "Adding CPU to index failed");
+		pbs_idx_destroy(cpunum_idx);
+		cpunum_idx = NULL;
+	}
+}
+
 /**
  * @brief
  *	Add a range of CPUs (an element of the form M or M-N where M and N are
@@ -326,6 +361,7 @@ add_CPUrange(mom_vninfo_t *mvp, char *cpurange)
 				mvp->mvi_cpulist = l;
 			mvp->mvi_cpulist[ncpus].mvic_cpunum = cpunum;
 			cpuindex_free(mvp, ncpus);
+			cpunum_index(cpunum, mvp);
 			mvp->mvi_ncpus++;
 			mvp->mvi_acpus++;
 			ncpus = mvp->mvi_ncpus;
@@ -413,83 +449,64 @@ static void
 resadj(vnl_t *vp, const char *vnid, const char *res, enum res_op op,
 	unsigned int adjval)
 {
-	int	i, j;
-	char	*vna_newval;
+	vnal_t		*vnalp;
+	vna_t		*vnap;
+	char		*vna_newval;
+	unsigned int	resval;
+	char		valbuf[BUFSIZ];
 
 	sprintf(log_buffer, "vnode %s, resource %s, res_op %d, adjval %u",
 		vnid, res, (int) op, adjval);
 	log_event(PBSEVENT_DEBUG3, 0, LOG_DEBUG, __func__, log_buffer);
-	for (i = 0; i < vp->vnl_used; i++) {
-		vnal_t	*vnalp;
-
-		vnalp = VNL_NODENUM(vp, i);
-		if (strcmp(vnalp->vnal_id, vnid) != 0)
-			continue;
-		for (j = 0; j < vnalp->vnal_used; j++) {
-			vna_t *vnap;
-
-			vnap = VNAL_NODENUM(vnalp, j);
-			if (strcmp(vnap->vna_name, res) == 0) {
-				unsigned int resval;
-				char valbuf[BUFSIZ];
-
-				resval = strtoul(vnap->vna_val, NULL, 0);
-				switch ((int) op) {
-					case RES_DECR:
-						resval -= adjval;
-						break;
-					case RES_INCR:
-						resval += adjval;
-						break;
-					case RES_SET:
-						resval = adjval;
-						break;
-					default:
-						sprintf(log_buffer, "unknown res_op %d",
-							(int) op);
-						log_event(PBSEVENT_ERROR, 0, LOG_ERR, __func__,
-							log_buffer);
-						return;
-				}
+	if (((vnalp = vn_vnode(vp, (char *) vnid)) == NULL) ||
+		((vnap = attr2vnr(vnalp, (char *) res)) == NULL)) {
+		sprintf(log_buffer, "vnode %s, resource %s not found", vnid, res);
+		log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__, log_buffer);
+		return;
+	}
 
-				/*
-				 *	Deal with two things that should never
-				 *	happen:  first, the result of adjusting
-				 *	the resource value should never be
-				 *	negative.  Second, BUFSIZ should always
-				 *	be sufficient to hold any unsigned
-				 *	quantity PBS deals with.
-				 */
-				if (((int) resval) < 0) {
-					log_event(PBSEVENT_ERROR, 0, LOG_ERR,
-						__func__, "res underflow");
-					return;
-				}
-				if (snprintf(valbuf, sizeof(valbuf), "%u",
-					resval) >= sizeof(valbuf)) {
-					log_event(PBSEVENT_ERROR, 0, LOG_ERR,
-						__func__, "res overflow");
-					return;
-				}
+	resval = strtoul(vnap->vna_val, NULL, 0);
+	switch ((int) op) {
+		case RES_DECR:
+			resval -= adjval;
+			break;
+		case RES_INCR:
+			resval += adjval;
+			break;
+		case RES_SET:
+			resval = adjval;
+			break;
+		default:
+			sprintf(log_buffer, "unknown res_op %d", (int) op);
+			log_event(PBSEVENT_ERROR, 0, LOG_ERR, __func__, log_buffer);
+			return;
+	}
 
-				/*
-				 *	We now replace the current value with
-				 *	the adjusted one.  This may involve
-				 *	surgery on the vna_t.
-				 */
-				vna_newval = strdup(valbuf);
-				if (vna_newval != NULL) {
-					free(vnap->vna_val);
-					vnap->vna_val = vna_newval;
-				} else
-					log_err(PBSE_SYSTEM, __func__, "vna_newval strdup failed");
-				return;
-			}
-		}
+	/*
+	 *	Deal with two things that should never happen:  first, the
+	 *	result of adjusting the resource value should never be
+	 *	negative.  Second, BUFSIZ should always be sufficient to hold
+	 *	any unsigned quantity PBS deals with.
+	 */
+	if (((int) resval) < 0) {
+		log_event(PBSEVENT_ERROR, 0, LOG_ERR, __func__, "res underflow");
+		return;
+	}
+	if (snprintf(valbuf, sizeof(valbuf), "%u", resval) >= sizeof(valbuf)) {
+		log_event(PBSEVENT_ERROR, 0, LOG_ERR, __func__, "res overflow");
+		return;
 	}
 
-	sprintf(log_buffer, "vnode %s, resource %s not found", vnid, res);
-	log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__, log_buffer);
+	/*
+	 *	We now replace the current value with the adjusted one.  This
+	 *	may involve surgery on the vna_t.
+	 */
+	vna_newval = strdup(valbuf);
+	if (vna_newval != NULL) {
+		free(vnap->vna_val);
+		vnap->vna_val = vna_newval;
+	} else
+		log_err(PBSE_SYSTEM, __func__, "vna_newval strdup failed");
 }
 
 /**
@@ -515,10 +532,48 @@ cpunum_outofservice(unsigned int cpunum)
 
 /**
  * @brief
- *	Common code for cpunum_inuse() and cpunum_outofservice():  to find
- *	the given CPU in our list of CPUs per vnode, we walk the list of
- *	mom_vninfo_t structures and for each of those, the attached CPU lists
- *	looking for a match.  If taking a CPU out of service, cpu_inuse() must
+ *	Mark CPU cpunum of vnode mvp in use, or out of service, if it is free.
+ *
+ * @param[in] mvp - vnode to search
+ * @param[in] cpunum - number of cpu
+ * @param[in] pjob - pointer to job structure
+ * @param[in] outofserviceflag - flag value to indicate whether cpu out of service
+ *
+ * @return int
+ * @retval 1 the CPU belongs to mvp
+ * @retval 0 the CPU is not in mvp's CPU list
+ *
+ */
+static int
+cpu_inuse_vnode(mom_vninfo_t *mvp, unsigned int cpunum, job *pjob, int outofserviceflag)
+{
+	static char ra_ncpus[] = "resources_available.ncpus";
+	unsigned int i;
+
+	for (i = 0; i < mvp->mvi_ncpus; i++) {
+		if (mvp->mvi_cpulist[i].mvic_cpunum != cpunum)
+			continue;
+		if (MVIC_CPUISFREE(mvp, i)) {
+			cpuindex_inuse(mvp, i, pjob);
+			if (outofserviceflag != 0) {
+				assert(vnlp != NULL);
+				assert(mvp->mvi_id != NULL);
+				resadj(vnlp, mvp->mvi_id, ra_ncpus, RES_DECR, 1);
+				mvp->mvi_acpus--;
+			}
+		}
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Common code for cpunum_inuse() and cpunum_outofservice():  the vnode
+ *	holding the given CPU is looked up in the index kept by add_CPUrange(),
+ *	or, if there is no index, found by walking the list of mom_vninfo_t
+ *	structures and their CPU lists.  If taking a CPU out of service, cpu_inuse() must
  *	also adjust the "resources_available.ncpus" for the vnode that contains
  *	the CPU being taken out of service.
  *
@@ -532,39 +587,32 @@ cpunum_outofservice(unsigned int cpunum)
 static void
 cpu_inuse(unsigned int cpunum, job *pjob, int outofserviceflag)
 {
-	static char ra_ncpus[] = "resources_available.ncpus";
 	void *idx_ctx = NULL;
+	void *key = &cpunum;
 	mominfo_t *mip = NULL;
+	mom_vninfo_t *mvp = NULL;
 
 	if (cpuctx == NULL)
 		return;
 
-	while (pbs_idx_find(cpuctx, NULL, (void **)&mip, &idx_ctx) == PBS_IDX_RET_OK) {
-		unsigned int i;
-		mom_vninfo_t *mvp;
-
-		assert(mip != NULL);
-		assert(mip->mi_data != NULL);
+	if (cpunum_idx != NULL) {
+		if (pbs_idx_find(cpunum_idx, &key, (void **)&mvp, NULL) == PBS_IDX_RET_OK &&
+			cpu_inuse_vnode(mvp, cpunum, pjob, outofserviceflag))
+			return;
+	} else {
+		while (pbs_idx_find(cpuctx, NULL, (void **)&mip, &idx_ctx) == PBS_IDX_RET_OK) {
+			assert(mip != NULL);
+			assert(mip->mi_data != NULL);
 
-		mvp = (mom_vninfo_t *) mip->mi_data;
-		for (i = 0; i < mvp->mvi_ncpus; i++) {
-			if (mvp->mvi_cpulist[i].mvic_cpunum == cpunum) {
-				if (MVIC_CPUISFREE(mvp, i)) {
-					cpuindex_inuse(mvp, i, pjob);
-					if (outofserviceflag != 0) {
-						assert(vnlp != NULL);
-						assert(mvp->mvi_id != NULL);
-						resadj(vnlp, mvp->mvi_id, ra_ncpus, RES_DECR, 1);
-						mvp->mvi_acpus--;
-					}
-				}
+			mvp = (mom_vninfo_t *) mip->mi_data;
+			if (cpu_inuse_vnode(mvp, cpunum, pjob, outofserviceflag)) {
 				pbs_idx_free_ctx(idx_ctx);
 				return;
 			}
 		}
-	}
 
-	pbs_idx_free_ctx(idx_ctx);
+		pbs_idx_free_ctx(idx_ctx);
+	}
 
 	/*
 	 *	If we get here, we didn't find the CPU in question.
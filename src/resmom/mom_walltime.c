@@ -37,10 +37,15 @@
  * subject to Altair's trademark licensing policies.
  */
 
+#include <pbs_config.h>   /* the master config generated by configure */
+
 #include "attribute.h"
 #include "job.h"
 #include "pbs_assert.h"
 #include "resource.h"
+#include "work_task.h"
+#include "log.h"
+#include "mom_func.h"
 #include <stdlib.h>
 #include <sys/types.h>
 #include <time.h>
@@ -48,6 +53,106 @@
 time_t time_now = 0;
 double wallfactor = 1.00;
 
+static void walltime_limit_task(struct work_task *);
+
+/**
+ * @brief
+ *
+ *		cancel_walltime_limit() removes the timer set by
+ *		arm_walltime_limit() for a job.
+ *
+ * @param[in] 	pjob	    - pointer to the job
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+static void
+cancel_walltime_limit(job *pjob)
+{
+	if (pjob->ji_walltime_task != NULL) {
+		delete_task(pjob->ji_walltime_task);
+		pjob->ji_walltime_task = NULL;
+	}
+}
+
+/**
+ * @brief
+ *
+ *		arm_walltime_limit() sets a timer for the moment the walltime
+ *		of a job reaches its limit, so that the job is killed then
+ *		rather than at the next poll of its usage.  Only mother
+ *		superior enforces walltime.
+ *
+ * @param[in] 	pjob	    - pointer to the job
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+void
+arm_walltime_limit(job *pjob)
+{
+	resource *used_walltime;
+	long used = 0;
+	time_t expiry;
+
+	cancel_walltime_limit(pjob);
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) == 0 ||
+		pjob->ji_walltime_stamp == 0 || wallfactor <= 0)
+		return;
+	if ((pjob->ji_limflags & JOB_LIMIT_CACHED) == 0)
+		cache_job_limits(pjob);
+	if ((pjob->ji_limflags & JOB_LIMIT_WALLTIME) == 0)
+		return;
+
+	used_walltime = find_resc_entry(&pjob->ji_wattr[(int)JOB_ATR_resc_used],
+		&svr_resc_def[RESC_WALLTIME]);
+	if (used_walltime != NULL && is_attr_set(&used_walltime->rs_value))
+		used = used_walltime->rs_value.at_val.at_long;
+
+	/* the limit is exceeded once the walltime counted so far goes past it */
+	expiry = pjob->ji_walltime_stamp + 1;
+	if ((long)pjob->ji_wall_limit > used)
+		expiry += (time_t)((pjob->ji_wall_limit - used) / wallfactor);
+	if (expiry <= time_now)
+		expiry = time_now + 1;
+	pjob->ji_walltime_task = set_task(WORK_Timed, expiry,
+		walltime_limit_task, pjob);
+}
+
+/**
+ * @brief
+ *
+ *		walltime_limit_task() runs when the walltime of a job should
+ *		have reached its limit.  The job is checked the same way the
+ *		periodic poll does and killed if over, otherwise the timer is
+ *		set again, e.g. after the limit was raised.
+ *
+ * @param[in] 	ptask	    - work task, wt_parm1 is the job
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+static void
+walltime_limit_task(struct work_task *ptask)
+{
+	job *pjob = (job *)ptask->wt_parm1;
+
+	pjob->ji_walltime_task = NULL;
+	if (!check_job_substate(pjob, JOB_SUBSTATE_RUNNING) ||
+		(pjob->ji_qs.ji_svrflags & (JOB_SVFLG_OVERLMT1 | JOB_SVFLG_OVERLMT2 | JOB_SVFLG_TERMJOB)))
+		return;
+
+	time_now = time(NULL);
+	log_buffer[0] = '\0';
+	if (job_over_limit(pjob, 0))
+		kill_over_limit_job(pjob);
+	else
+		arm_walltime_limit(pjob);
+}
+
 /**
  * @brief
  *
@@ -72,6 +177,7 @@ start_walltime(job *pjob)
 		time_now = time(NULL);
 
 	pjob->ji_walltime_stamp = time_now;
+	arm_walltime_limit(pjob);
 }
 
 /**
@@ -145,6 +251,7 @@ stop_walltime(job *pjob)
 	/* update walltime and stop accumulating */
 	update_walltime(pjob);
 	pjob->ji_walltime_stamp = 0;
+	cancel_walltime_limit(pjob);
 }
 
 /**
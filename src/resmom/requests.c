@@ -83,6 +83,7 @@
 #include "placementsets.h"
 #include "pbs_internal.h"
 #include "portability.h"
+#include "pbs_pwcache.h"
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 #include "renew_creds.h"
@@ -140,6 +141,7 @@ extern	int		update_job_launch_delay;
 extern	pbs_list_head	svr_allhooks;
 /* External Functions */
 extern int	is_direct_write(job *, enum job_file, char *, int *);
+extern int	auto_direct_write;
 extern unsigned char pbs_aes_key[][16];
 extern unsigned char pbs_aes_iv[][16];
 
@@ -230,7 +232,7 @@ fork_to_user(struct batch_request *preq, job *pjob)
 	}
 
 	if (pjob)
-		pwdp = getpwnam(get_jattr_str(pjob,  JOB_ATR_euser));
+		pwdp = pbs_getpwnam(get_jattr_str(pjob,  JOB_ATR_euser));
 
 	/* we're trying to reuse old pw_userlogin since a mapped UNC */
 	/* path maybe hanging off it. With pbs_mom running under     */
@@ -351,7 +353,7 @@ fork_to_user(struct batch_request *preq, job *pjob)
 		/* Account ID used to be set her for Cray via acctid(). */
 	} else {
 		/* Need to look up the uid, gid, and home directory */
-		if ((pwdp = getpwnam(rqcpf->rq_user)) == NULL)
+		if ((pwdp = pbs_getpwnam(rqcpf->rq_user)) == NULL)
 			frk_err(PBSE_BADUSER, preq); /* no return */
 		useruid = pwdp->pw_uid;
 		user_rgid = pwdp->pw_gid;
@@ -359,7 +361,7 @@ fork_to_user(struct batch_request *preq, job *pjob)
 		if (rqcpf->rq_group[0] == '\0')
 			usergid = pwdp->pw_gid; /* default to login group */
 		else {
-			if ((grpp = getgrnam(rqcpf->rq_group)) == NULL)
+			if ((grpp = pbs_getgrnam(rqcpf->rq_group)) == NULL)
 				frk_err(PBSE_BADUSER, preq); /* no return */
 			usergid = grpp->gr_gid;
 		}
@@ -1106,6 +1108,9 @@ req_modifyjob(struct batch_request *preq)
 		req_reject(rc, bad, preq);
 		return;
 	}
+	/* the limits may have changed, e.g. qalter of walltime */
+	pjob->ji_limflags = 0;
+	arm_walltime_limit(pjob);
 
 	(void)job_save(pjob);
 	(void)sprintf(log_buffer, msg_manager, msg_jobmod,
@@ -2666,7 +2671,7 @@ req_cpyfile(struct batch_request *preq)
 	dir  = (rqcpf->rq_dir & STAGE_DIRECTION)? STAGE_DIR_OUT : STAGE_DIR_IN;
 	stage_inout.sandbox_private = (rqcpf->rq_dir & STAGE_JOBDIR)? TRUE : FALSE;
 	if (pjob != NULL && (dir == STAGE_DIR_OUT)) {
-		direct_write = direct_write_requested(pjob);
+		direct_write = direct_write_requested(pjob) || auto_direct_write;
 	}
 
 	/*
@@ -2684,7 +2689,7 @@ req_cpyfile(struct batch_request *preq)
 		 * no homedir can be cached in job's gc_homedir/altid
 		 * attribute, so we call map_unc_path to get it now
 		 */
-		if ((pw=getpwnam(preq->rq_ind.rq_cpyfile.rq_user)) != NULL) {
+		if ((pw=pbs_getpwnam(preq->rq_ind.rq_cpyfile.rq_user)) != NULL) {
 			pbs_strncpy(actual_homedir,
 				map_unc_path(pw->pw_dir, pw), sizeof(actual_homedir));
 			pbs_jobdir = jobdirname(rqcpf->rq_jobid, actual_homedir);
@@ -3098,7 +3103,7 @@ req_cpyfile(struct batch_request *preq)
 	stage_inout.sandbox_private = (rqcpf->rq_dir & STAGE_JOBDIR)? TRUE : FALSE;
 
 	/* Call getpwnam for user info */
-	pwdp = getpwnam(rqcpf->rq_user);
+	pwdp = pbs_getpwnam(rqcpf->rq_user);
 	if (pwdp != NULL) {
 		pbs_jobdir = jobdirname(rqcpf->rq_jobid, pwdp->pw_dir);
 	} else {
@@ -3119,7 +3124,7 @@ req_cpyfile(struct batch_request *preq)
 		if (rqcpf->rq_group[0] == '\0') {
 			usergid = pwdp->pw_gid;	/* default to login group */
 		} else {
-			if ((grpp = getgrnam(rqcpf->rq_group)) == NULL) {
+			if ((grpp = pbs_getgrnam(rqcpf->rq_group)) == NULL) {
 				req_reject(PBSE_BADUSER, 0, preq);
 				return;
 			}
@@ -3136,7 +3141,8 @@ req_cpyfile(struct batch_request *preq)
 		}
 	}
 
-	if ((pjob != NULL) && (dir == STAGE_DIR_OUT) && direct_write_requested(pjob))
+	if ((pjob != NULL) && (dir == STAGE_DIR_OUT) &&
+		(direct_write_requested(pjob) || auto_direct_write))
 		stage_inout.direct_write = 1;
 	else
 		stage_inout.direct_write = 0;
@@ -3161,6 +3167,7 @@ req_cpyfile(struct batch_request *preq)
 				set_job_substate(pjob, JOB_SUBSTATE_EXITED);
 			pjob->ji_momsubt = pid;
 			pjob->ji_mompost = post_cpyfile;
+			track_job_pid(pjob, pid);
 			if (preq->prot == PROT_TPP)
 				pjob->ji_preq = preq; /* keep the batch request pointer */
 		} else {
@@ -3223,7 +3230,7 @@ req_cpyfile(struct batch_request *preq)
 			rmtflag = 1;
 		}
 
-		rc = stage_file(dir, rmtflag, rqcpf->rq_owner,
+		rc = stage_file_start(dir, rmtflag, rqcpf->rq_owner,
 			pair, preq->rq_conn, &stage_inout, prmt, rqcpf->rq_jobid);
 		/*
 		 ** Here we break out of the the loop on error.
@@ -3235,6 +3242,8 @@ req_cpyfile(struct batch_request *preq)
 		}
 		num_copies++;
 	}
+	/* wait for the pairs still being copied by transfer workers */
+	num_copies -= stage_file_finish(dir, &stage_inout);
 	copy_stop = time(0);
 
 	/* If there was a stage in failure, remove the job directory.
@@ -3416,6 +3425,7 @@ req_delfile(struct batch_request *preq)
 		if (pjob) {
 			pjob->ji_momsubt = pid;
 			pjob->ji_mompost = post_delfile;
+			track_job_pid(pjob, pid);
 			pjob->ji_sampletim = time(0);
 			set_job_substate(pjob, JOB_SUBSTATE_EXITED);
 		}
@@ -3537,13 +3547,13 @@ mom_checkpoint_job(job *pjob, int abort)
 		if ((is_jattr_set(pjob, JOB_ATR_sandbox)) &&
 			(strcasecmp(get_jattr_str(pjob, JOB_ATR_sandbox), "PRIVATE") ==0)) {
 			/* "sandbox=PRIVATE" mode is enabled, so restart job in PBS_JOBDIR */
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL) {
 				(void)chdir(jobdirname(pjob->ji_qs.ji_jobid,
 					save_actual_homedir(pwdp, pjob)));
 			}
 		} else {
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL)
 				(void)chdir(save_actual_homedir(pwdp, pjob));
 		}
@@ -3553,12 +3563,12 @@ mom_checkpoint_job(job *pjob, int abort)
 		if ((is_jattr_set(pjob, JOB_ATR_sandbox)) &&
 			(strcasecmp(get_jattr_str(pjob, JOB_ATR_sandbox), "PRIVATE") == 0)) {
 			/* "sandbox=PRIVATE" mode is enabled, so restart job in PBS_JOBDIR */
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL) {
 				(void)chdir(jobdirname(pjob->ji_qs.ji_jobid, pwdp->pw_dir));
 			}
 		} else {
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL)
 				chdir(pwdp->pw_dir);
 		}
@@ -3964,6 +3974,7 @@ local_checkpoint(job *pjob,
 		DBPRT(("local_checkpoint: %s pid %d\n", pjob->ji_qs.ji_jobid, pid))
 		pjob->ji_momsubt = pid;
 		pjob->ji_mompost = post_chkpt;
+		track_job_pid(pjob, pid);
 		pjob->ji_actalarm = 0;
 
 		/*
@@ -4118,13 +4129,13 @@ mom_restart_job(job *pjob)
 		if ((is_jattr_set(pjob, JOB_ATR_sandbox)) &&
 			(strcasecmp(get_jattr_str(pjob, JOB_ATR_sandbox), "PRIVATE") == 0)) {
 			/* "sandbox=PRIVATE" mode is enabled, so restart job in PBS_JOBDIR */
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL) {
 				(void)chdir(jobdirname(pjob->ji_qs.ji_jobid,
 					save_actual_homedir(pwdp, pjob)));
 			}
 		} else {
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL)
 				chdir(save_actual_homedir(pwdp, pjob));
 		}
@@ -4134,11 +4145,11 @@ mom_restart_job(job *pjob)
 		if ((is_jattr_set(pjob, JOB_ATR_sandbox)) &&
 			(strcasecmp(get_jattr_str(pjob, JOB_ATR_sandbox), "PRIVATE") == 0)) {
 			/* "sandbox=PRIVATE" mode is enabled, so restart job in PBS_JOBDIR */
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL)
 				(void)chdir(jobdirname(pjob->ji_qs.ji_jobid, pwdp->pw_dir));
 		} else {
-			pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 			if (pwdp != NULL)
 				chdir(pwdp->pw_dir);
 		}
@@ -4403,6 +4414,7 @@ local_restart(job *pjob,
 		DBPRT(("local_restart: %s pid %d\n", pjob->ji_qs.ji_jobid, pid))
 		pjob->ji_momsubt = pid;
 		pjob->ji_mompost = post_restart;
+		track_job_pid(pjob, pid);
 		pjob->ji_actalarm = 0;
 		pjob->ji_flags |= MOM_RESTART_ACTIVE;
 		(void)job_save(pjob);
@@ -51,6 +51,15 @@
 #include <time.h>
 #include <sys/wait.h>
 #include <dirent.h>
+#ifndef WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/sendfile.h>
+#endif
+#endif
 #include "tpp.h"
 #include "pbs_ifl.h"
 #include "list_link.h"
@@ -61,6 +70,7 @@
 #include "batch_request.h"
 #include "pbs_nodes.h"
 #include "mom_func.h"
+#include "pbs_pwcache.h"
 
 /**
  * @file	stage_func.c
@@ -76,11 +86,16 @@ extern size_t cred_len;				/* length of cred buffer */
 #ifndef WIN32
 extern int cred_pipe;
 extern char *pwd_buf;
+extern int stage_workers;			/* most file pairs copied at once */
 #endif
 extern char mom_host[PBS_MAXHOSTNAME+1];	/* MoM host name */
+extern int auto_direct_write;			/* direct write output that goes to a local path */
 
 int stage_file(int, int, char *, struct rqfpair *, int, cpy_files *, char *, char *);
 static int sys_copy(int, int, char *, char *, struct rqfpair *, int, char *, char *);
+#ifndef WIN32
+static int local_move(char *, char *);
+#endif
 
 /**
  * A path in windows is not case sensitive so do a define
@@ -92,6 +107,9 @@ static int sys_copy(int, int, char *, char *, struct rqfpair *, int, char *, cha
 #define	PATHCMP	strncmp
 #endif
 
+#define	STAGE_COPY_BUFSIZE	(1024 * 1024)	/* buffer size for local_copy() */
+#define	STAGE_SENDFILE_MAX	(1024 * 1024 * 1024)	/* bytes per sendfile() call */
+
 #ifdef WIN32
 /**
  * @brief
@@ -456,23 +474,22 @@ is_direct_write(job *pjob, enum job_file which, char *path, int *direct_write_po
 {
 	char working_path[MAXPATHLEN + PBS_MAXSVRJOBID + 3 + 1];
 	char *p = working_path;
+	char *keep = "";
+	char key;
+	int requested;
 
 	if (which == Chkpt) return(0); /* direct write of checkpoint not supported */
 
-	/* Check if direct_write requested. */
-	if (!((is_jattr_set(pjob, JOB_ATR_keep)) &&
-				(strchr(get_jattr_str(pjob, JOB_ATR_keep), 'd'))))
-		return(0);
+	if (is_jattr_set(pjob, JOB_ATR_keep))
+		keep = get_jattr_str(pjob, JOB_ATR_keep);
 
 	/* Figure out what the final destination path is */
 	switch(which)
 	{
 		case StdOut:
-			if(!strchr(get_jattr_str(pjob, JOB_ATR_keep), 'o'))
-				return(0);
-			else
-				/* Make local working copy of path for call to local_or_remote */
-				snprintf(working_path, MAXPATHLEN + 1, "%s", get_jattr_str(pjob, JOB_ATR_outpath));
+			key = 'o';
+			/* Make local working copy of path for call to local_or_remote */
+			snprintf(working_path, MAXPATHLEN + 1, "%s", get_jattr_str(pjob, JOB_ATR_outpath));
 			if (
 #ifdef WIN32
 					working_path[strlen(working_path) -1] == '\\'
@@ -485,11 +502,9 @@ is_direct_write(job *pjob, enum job_file which, char *path, int *direct_write_po
 			}
 			break;
 		case StdErr:
-			if(!strchr(get_jattr_str(pjob, JOB_ATR_keep), 'e'))
-				return(0);
-			else
-				/* Make local working copy of path for call to local_or_remote */
-				snprintf(working_path, MAXPATHLEN + 1, "%s", get_jattr_str(pjob, JOB_ATR_errpath));
+			key = 'e';
+			/* Make local working copy of path for call to local_or_remote */
+			snprintf(working_path, MAXPATHLEN + 1, "%s", get_jattr_str(pjob, JOB_ATR_errpath));
 		if (
 #ifdef WIN32
 				working_path[strlen(working_path) -1] == '\\'
@@ -505,7 +520,25 @@ is_direct_write(job *pjob, enum job_file which, char *path, int *direct_write_po
 			return(0);
 	}
 
+	/*
+	 * Direct write is requested for the file by keeping it with 'd'.
+	 * With $auto_direct_write the MoM also picks it for a file that
+	 * would otherwise be spooled and delivered at job end.
+	 */
+	if (strchr(keep, key) != NULL) {
+		if (strchr(keep, 'd') == NULL)
+			return(0);
+		requested = 1;
+	} else {
+		if (!auto_direct_write || (is_jattr_set(pjob, JOB_ATR_sandbox) &&
+			(strcasecmp(get_jattr_str(pjob, JOB_ATR_sandbox), "PRIVATE") == 0)))
+			return(0);
+		requested = 0;
+	}
+
 	if (local_or_remote(&p) == 1) {
+		if (!requested)
+			return (0);
 		*direct_write_possible = 0;
 		if (pjob->ji_hosts != NULL) {
 			log_eventf(PBSEVENT_DEBUG3,
@@ -527,6 +560,8 @@ is_direct_write(job *pjob, enum job_file which, char *path, int *direct_write_po
 	}
 
 	if (strlen(p) > MAXPATHLEN) {
+		if (!requested)
+			return (0);
 		*direct_write_possible = 0;
 		sprintf(log_buffer,
 				"Direct write is requested for job: %s, but the destination path is longer than %d",
@@ -795,6 +830,13 @@ copy_file(int dir, int rmtflag, char *owner, char *src, struct rqfpair *pair, in
 			pbs_strncpy(dest, pair->fp_local, sizeof(dest));
 	}
 
+#ifndef WIN32
+	/* spooled output staying on this host may just be renamed into place */
+	if ((dir == STAGE_DIR_OUT) && (rmtflag == 0) && stage_inout->from_spool &&
+		(local_move(src, prmt) == 0))
+		return 0;
+#endif
+
 	ret = sys_copy(dir, rmtflag, owner, src, pair, conn, prmt, jobid);
 
 	if (ret == 0) {
@@ -945,6 +987,33 @@ copy_file(int dir, int rmtflag, char *owner, char *src, struct rqfpair *pair, in
 	return rc;
 }
 
+/**
+ * @brief
+ *	stage_in_remove - delete the files already staged in by a request,
+ *	after one of its stage-in copies failed.
+ *
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ *
+ * @return void
+ *
+ */
+static void
+stage_in_remove(cpy_files *stage_inout)
+{
+	int i;
+
+	for (i=0; i<stage_inout->file_num; i++) {
+		DBPRT(("%s: delete %s\n", __func__, stage_inout->file_list[i]))
+		if (remtree(stage_inout->file_list[i]) != 0 && errno != ENOENT) {
+			char	temp[80 + MAXPATHLEN];
+
+			sprintf(temp, msg_err_unlink, "stage in", stage_inout->file_list[i]);
+			log_err(errno, "req_cpyfile", temp);
+			add_bad_list(&(stage_inout->bad_list), temp, 2);
+		}
+	}
+}
+
 /**
  * @brief
  *	stage_file - Handle file stage pair. The source could have a wildcard
@@ -970,7 +1039,6 @@ int
 stage_file(int dir, int	rmtflag, char *owner, struct rqfpair *pair, int conn, cpy_files *stage_inout, char *prmt, char *jobid)
 {
 	char *ps = NULL;
-	int i = 0;
 	int rc = 0;
 	int len = 0;
 	char dname[MAXPATHLEN+1] = {'\0'};
@@ -1154,20 +1222,351 @@ stage_file(int dir, int	rmtflag, char *owner, struct rqfpair *pair, int conn, cp
 	return 0;
 
 error:
-	/* delete all the files in the list */
-	for (i=0; i<stage_inout->file_num; i++) {
-		DBPRT(("%s: delete %s\n", __func__, stage_inout->file_list[i]))
-		if (remtree(stage_inout->file_list[i]) != 0 && errno != ENOENT) {
-			char	temp[80 + MAXPATHLEN];
+	stage_in_remove(stage_inout);
+	return rc;
+}
 
-			sprintf(temp, msg_err_unlink, "stage in", stage_inout->file_list[i]);
-			log_err(errno, "req_cpyfile", temp);
-			add_bad_list(&(stage_inout->bad_list), temp, 2);
+#ifndef WIN32
+/*
+ * Transfer worker pool.  With $stage_workers above one, each file pair of
+ * a copy request is staged by a forked worker, so that up to that many
+ * transfers are in flight at once.  A worker runs stage_file() on its own
+ * cpy_files struct and sends the outcome back over a pipe for the request
+ * process to merge into the request's cpy_files struct.
+ */
+struct stage_worker {
+	pid_t	sw_pid;			/* worker process */
+	int	sw_fd;			/* read end of the worker's result pipe */
+	char	*sw_buf;		/* result read so far */
+	size_t	sw_len;			/* bytes in sw_buf */
+	size_t	sw_size;		/* size of sw_buf */
+	char	sw_local[MAXPATHLEN+1];	/* local name of the file pair */
+};
+
+static struct stage_worker *stage_pool = NULL;
+static struct pollfd *stage_pool_pfd = NULL;	/* poll array, one per worker */
+static int stage_pool_num = 0;		/* workers in flight */
+static int stage_pool_failed = 0;	/* workers that failed to stage */
+
+/**
+ * @brief
+ *	stage_worker_run - body of a transfer worker, stage one file pair and
+ *	write the outcome to the result pipe.  Does not return.
+ *
+ *	The result is an array of ints: stage_file() return value, bad_files,
+ *	stageout_failed, number of staged in files and length of bad_list,
+ *	followed by bad_list and the staged in file names, each with its
+ *	terminating null.
+ *
+ * @param[in]	fd	-	write end of the result pipe
+ *
+ * For the other parameters see stage_file().
+ *
+ */
+static void
+stage_worker_run(int fd, int dir, int rmtflag, char *owner, struct rqfpair *pair, int conn, cpy_files *stage_inout, char *prmt, char *jobid)
+{
+	int i;
+	int hdr[5];
+	size_t len;
+	cpy_files mine;
+
+	mine = *stage_inout;
+	mine.stageout_failed = 0;
+	mine.bad_files = 0;
+	mine.from_spool = 0;
+	mine.file_num = 0;
+	mine.file_max = 0;
+	mine.file_list = NULL;
+	mine.bad_list = NULL;
+
+	hdr[0] = stage_file(dir, rmtflag, owner, pair, conn, &mine, prmt, jobid);
+	hdr[1] = mine.bad_files;
+	hdr[2] = mine.stageout_failed;
+	hdr[3] = mine.file_num;
+	hdr[4] = (mine.bad_list != NULL) ? strlen(mine.bad_list) : 0;
+
+	if (writepipe(fd, hdr, sizeof(hdr)) != sizeof(hdr))
+		_exit(1);
+	if ((hdr[4] > 0) && (writepipe(fd, mine.bad_list, hdr[4] + 1) != (ssize_t)hdr[4] + 1))
+		_exit(1);
+	for (i = 0; i < mine.file_num; i++) {
+		len = strlen(mine.file_list[i]) + 1;
+		if (writepipe(fd, mine.file_list[i], len) != (ssize_t)len)
+			_exit(1);
+	}
+	_exit(0);
+}
+
+/**
+ * @brief
+ *	stage_worker_merge - fold the result of a finished transfer worker
+ *	into the request's cpy_files struct.
+ *
+ * @param[in]		sw		-	the finished worker
+ * @param[in]		status		-	worker exit status from waitpid()
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ *
+ * @return void
+ *
+ */
+static void
+stage_worker_merge(struct stage_worker *sw, int status, cpy_files *stage_inout)
+{
+	int i;
+	int hdr[5];
+	char *pc;
+	char *end;
+	char **plist;
+
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0) ||
+		(sw->sw_len < sizeof(hdr))) {
+		snprintf(log_buffer, sizeof(log_buffer),
+			"Unable to copy file %s, transfer worker %d exited with status 0x%x",
+			sw->sw_local, (int)sw->sw_pid, status);
+		log_err(-1, __func__, log_buffer);
+		add_bad_list(&(stage_inout->bad_list), log_buffer, 2);
+		stage_inout->bad_files = 1;
+		stage_pool_failed++;
+		return;
+	}
+
+	memcpy(hdr, sw->sw_buf, sizeof(hdr));
+	if (hdr[0] != 0)
+		stage_pool_failed++;
+	if (hdr[1])
+		stage_inout->bad_files = 1;
+	if (hdr[2])
+		stage_inout->stageout_failed = TRUE;
+
+	pc = sw->sw_buf + sizeof(hdr);
+	end = sw->sw_buf + sw->sw_len;
+	if (hdr[4] > 0) {
+		if ((end - pc <= hdr[4]) || (pc[hdr[4]] != '\0'))
+			return;
+		add_bad_list(&(stage_inout->bad_list), pc, 0);
+		pc += hdr[4] + 1;
+	}
+	for (i = 0; (i < hdr[3]) && (pc < end); i++) {
+		if (memchr(pc, '\0', end - pc) == NULL)
+			break;
+		if (stage_inout->file_max == stage_inout->file_num) {
+			plist = (char **)realloc(stage_inout->file_list,
+				(stage_inout->file_max + 10) * sizeof(char *));
+			if (plist == NULL) {
+				log_err(ENOMEM, __func__, "Out of Memory!");
+				return;
+			}
+			stage_inout->file_list = plist;
+			stage_inout->file_max += 10;
+		}
+		if ((stage_inout->file_list[stage_inout->file_num] = strdup(pc)) == NULL) {
+			log_err(ENOMEM, __func__, "Out of Memory!");
+			return;
 		}
+		stage_inout->file_num++;
+		pc += strlen(pc) + 1;
 	}
-	return rc;
 }
 
+/**
+ * @brief
+ *	stage_pool_reap - wait until at least one transfer worker finishes,
+ *	collecting the results of any that write to their pipe meanwhile.
+ *
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ *
+ * @return void
+ *
+ */
+static void
+stage_pool_reap(cpy_files *stage_inout)
+{
+	int i;
+	int n;
+	int status;
+	int reaped = 0;
+	ssize_t nread;
+	char *pbuf;
+	struct pollfd *pfd = stage_pool_pfd;
+	struct stage_worker *sw;
+
+	while ((reaped == 0) && (stage_pool_num > 0)) {
+		n = stage_pool_num;
+		for (i = 0; i < n; i++) {
+			pfd[i].fd = stage_pool[i].sw_fd;
+			pfd[i].events = POLLIN;
+			pfd[i].revents = 0;
+		}
+		if (poll(pfd, n, -1) == -1) {
+			if (errno == EINTR)
+				continue;
+			log_err(errno, __func__, "poll");
+			/* read every pipe below, blocking until its worker is done */
+			for (i = 0; i < n; i++)
+				pfd[i].revents = POLLIN;
+		}
+
+		/* walk backwards so a finished worker can be replaced by the last */
+		for (i = n - 1; i >= 0; i--) {
+			if (pfd[i].revents == 0)
+				continue;
+			sw = &stage_pool[i];
+			nread = 0;
+			if (sw->sw_size - sw->sw_len < LOG_BUF_SIZE) {
+				pbuf = realloc(sw->sw_buf, sw->sw_size + 4 * LOG_BUF_SIZE);
+				if (pbuf == NULL) {
+					log_err(ENOMEM, __func__, "Out of Memory!");
+					nread = -1;
+				} else {
+					sw->sw_buf = pbuf;
+					sw->sw_size += 4 * LOG_BUF_SIZE;
+				}
+			}
+			if (sw->sw_size - sw->sw_len >= LOG_BUF_SIZE) {
+				nread = read(sw->sw_fd, sw->sw_buf + sw->sw_len,
+					sw->sw_size - sw->sw_len);
+				if (nread > 0) {
+					sw->sw_len += nread;
+					continue;
+				}
+				if ((nread == -1) && (errno == EINTR))
+					continue;
+			}
+
+			/* end of result, or unable to read any more of it */
+			close(sw->sw_fd);
+			while ((waitpid(sw->sw_pid, &status, 0) == -1) && (errno == EINTR))
+				;
+			if (nread == -1)
+				status = -1;
+			stage_worker_merge(sw, status, stage_inout);
+			free(sw->sw_buf);
+			stage_pool_num--;
+			if (i != stage_pool_num)
+				stage_pool[i] = stage_pool[stage_pool_num];
+			reaped++;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	stage_file_start - stage a file pair, in a transfer worker when the
+ *	pool is configured, otherwise directly with stage_file().
+ *	When all workers are busy, wait for one to finish first.
+ *
+ *	A worker's failure is only learned when it is reaped, call
+ *	stage_file_finish() after the last pair to collect the outcome.
+ *
+ * For the parameters see stage_file().
+ *
+ * @return	int
+ * @retval	0 - pair staged or handed to a worker
+ * @retval	!0 - error, or a worker already failed so no more are started
+ *
+ */
+int
+stage_file_start(int dir, int rmtflag, char *owner, struct rqfpair *pair, int conn, cpy_files *stage_inout, char *prmt, char *jobid)
+{
+	int fds[2];
+	pid_t pid;
+	struct stage_worker *sw;
+
+	/* the password is fed to each copy in turn, keep those to one at a time */
+	if ((stage_workers <= 1) || (cred_pipe != -1))
+		return (stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt, jobid));
+
+	if (stage_pool == NULL) {
+		stage_pool = (struct stage_worker *)calloc(stage_workers, sizeof(struct stage_worker));
+		stage_pool_pfd = (struct pollfd *)calloc(stage_workers, sizeof(struct pollfd));
+		if ((stage_pool == NULL) || (stage_pool_pfd == NULL)) {
+			log_err(ENOMEM, __func__, "Out of Memory!");
+			free(stage_pool);
+			free(stage_pool_pfd);
+			stage_pool = NULL;
+			stage_pool_pfd = NULL;
+			return (stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt, jobid));
+		}
+	}
+
+	for (;;) {
+		while (stage_pool_num >= stage_workers)
+			stage_pool_reap(stage_inout);
+		if (stage_pool_failed)
+			return -1;
+
+		if (pipe(fds) == -1) {
+			log_err(errno, __func__, "pipe");
+		} else if ((pid = fork()) == -1) {
+			log_err(errno, __func__, "fork");
+			close(fds[0]);
+			close(fds[1]);
+		} else
+			break;
+
+		/*
+		 * Unable to start a worker.  Wait for one to free up resources,
+		 * or with none running copy here, where sys_copy() may use wait().
+		 */
+		if (stage_pool_num == 0)
+			return (stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt, jobid));
+		stage_pool_reap(stage_inout);
+	}
+
+	if (pid == 0) {
+		int i;
+
+		close(fds[0]);
+		for (i = 0; i < stage_pool_num; i++)
+			close(stage_pool[i].sw_fd);
+		stage_worker_run(fds[1], dir, rmtflag, owner, pair, conn, stage_inout, prmt, jobid);
+	}
+
+	close(fds[1]);
+	sw = &stage_pool[stage_pool_num++];
+	memset(sw, 0, sizeof(*sw));
+	sw->sw_pid = pid;
+	sw->sw_fd = fds[0];
+	pbs_strncpy(sw->sw_local, pair->fp_local, sizeof(sw->sw_local));
+	return 0;
+}
+
+/**
+ * @brief
+ *	stage_file_finish - wait for the transfer workers started by
+ *	stage_file_start() and merge their results.  If a stage-in failed,
+ *	remove every file the request staged in, as stage_file() does when
+ *	copying directly.
+ *
+ * @param[in]		dir		-	direction of copy
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ *
+ * @return	int
+ * @retval	number of file pairs handed to workers that failed
+ *
+ */
+int
+stage_file_finish(int dir, cpy_files *stage_inout)
+{
+	int failed;
+
+	while (stage_pool_num > 0)
+		stage_pool_reap(stage_inout);
+
+	failed = stage_pool_failed;
+	if (failed && (dir == STAGE_DIR_IN))
+		stage_in_remove(stage_inout);
+
+	free(stage_pool);
+	free(stage_pool_pfd);
+	stage_pool = NULL;
+	stage_pool_pfd = NULL;
+	stage_pool_failed = 0;
+	return failed;
+}
+#endif	/* WIN32 */
+
 /**
  * @brief
  *	rmjobdir - Remove the staging and execution directory and any files
@@ -1408,6 +1807,181 @@ is_pbs_rcp_path(void)
 	return (0);
 }
 #endif
+#ifndef WIN32
+/**
+ * @brief
+ *	local_copy - copy a local regular file without running cp.
+ *	The data is cloned where the filesystem supports it, otherwise
+ *	moved by the kernel with copy_file_range() or sendfile(), and only
+ *	as a last resort read and written through a large buffer.  As with
+ *	"cp -p", the mode, ownership where permitted, and times are preserved.
+ *
+ * @param[in]	src	-	path of the source file
+ * @param[in]	dest	-	path of the destination file or directory
+ *
+ * @return	int
+ * @retval	0 - file copied
+ * @retval	1 - file not copied, caller should fall back to cp
+ *
+ * @note
+ *	Directories and anything other than a regular file are left to cp,
+ *	as are errors, so that cp reports them in the usual way.
+ */
+static int
+local_copy(char *src, char *dest)
+{
+	int ifd = -1;
+	int ofd = -1;
+	int done = 0;
+	ssize_t nread;
+	ssize_t nwrite;
+	char *buf = NULL;
+	char *slash;
+	char target[MAXPATHLEN+1];
+	struct stat sb;
+	struct stat db;
+	struct timespec times[2];
+#ifdef HAVE_COPY_FILE_RANGE
+	off_t left;
+#endif
+
+	if ((ifd = open(src, O_RDONLY)) == -1)
+		return 1;
+	if ((fstat(ifd, &sb) == -1) || !S_ISREG(sb.st_mode))
+		goto local_copy_fail;
+
+	/* if destination is a directory, copy into it under the same name */
+	pbs_strncpy(target, dest, sizeof(target));
+	if ((stat(target, &db) == 0) && S_ISDIR(db.st_mode)) {
+		slash = strrchr(src, '/');
+		slash = (slash != NULL) ? slash + 1 : src;
+		if (strlen(target) + strlen(slash) + 2 > sizeof(target))
+			goto local_copy_fail;
+		strcat(target, "/");
+		strcat(target, slash);
+	}
+	if ((stat(target, &db) == 0) &&
+		(db.st_dev == sb.st_dev) && (db.st_ino == sb.st_ino))
+		goto local_copy_fail;	/* same file, let cp complain */
+
+	if ((ofd = open(target, O_WRONLY|O_CREAT|O_TRUNC, sb.st_mode & 0777)) == -1)
+		goto local_copy_fail;
+
+#ifdef FICLONE
+	if (ioctl(ofd, FICLONE, ifd) == 0)
+		done = 1;
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+	/*
+	 * Whatever copy_file_range() moves advances both file offsets,
+	 * so a read/write loop can pick up where it stops.
+	 */
+	left = sb.st_size;
+	while (!done && (left > 0)) {
+		nwrite = copy_file_range(ifd, NULL, ofd, NULL, left, 0);
+		if (nwrite <= 0)
+			break;
+		left -= nwrite;
+	}
+	if (left <= 0)
+		done = 1;
+#endif
+
+#ifdef __linux__
+	/* older kernels refuse copy_file_range() across filesystems */
+	while (!done) {
+		nwrite = sendfile(ofd, ifd, NULL, STAGE_SENDFILE_MAX);
+		if (nwrite == 0)
+			done = 1;
+		else if (nwrite < 0)
+			break;
+	}
+#endif
+
+	if (!done) {
+		if ((buf = malloc(STAGE_COPY_BUFSIZE)) == NULL)
+			goto local_copy_fail;
+		while ((nread = read(ifd, buf, STAGE_COPY_BUFSIZE)) != 0) {
+			if (nread == -1) {
+				if (errno == EINTR)
+					continue;
+				goto local_copy_fail;
+			}
+			if (writepipe(ofd, buf, nread) != nread)
+				goto local_copy_fail;
+		}
+		free(buf);
+		buf = NULL;
+	}
+
+	if (fchown(ofd, sb.st_uid, sb.st_gid) == -1)
+		(void)fchown(ofd, -1, sb.st_gid);
+	(void)fchmod(ofd, sb.st_mode & 07777);
+	times[0] = sb.st_atim;
+	times[1] = sb.st_mtim;
+	(void)futimens(ofd, times);
+
+	close(ifd);
+	if (close(ofd) == -1)
+		return 1;
+	return 0;
+
+local_copy_fail:
+	free(buf);
+	if (ofd != -1)
+		close(ofd);
+	close(ifd);
+	return 1;
+}
+#endif
+
+#ifndef WIN32
+/**
+ * @brief
+ *	local_move - deliver a spooled output file to a local destination by
+ *	renaming it, which only works within one filesystem.
+ *
+ * @param[in]	src	-	path of the file in the spool
+ * @param[in]	dest	-	path of the destination file or directory
+ *
+ * @return	int
+ * @retval	0 - file moved, it is no longer in the spool
+ * @retval	1 - file not moved, caller should copy it
+ *
+ */
+static int
+local_move(char *src, char *dest)
+{
+	char *slash;
+	char target[MAXPATHLEN+1];
+	struct stat sb;
+	struct stat db;
+
+	replace(dest, "\\,", ",", target);
+	if (*target == '\0')
+		pbs_strncpy(target, dest, sizeof(target));
+
+	if ((lstat(src, &sb) == -1) || !S_ISREG(sb.st_mode))
+		return 1;
+	if ((stat(target, &db) == 0) && S_ISDIR(db.st_mode)) {
+		slash = strrchr(src, '/');
+		slash = (slash != NULL) ? slash + 1 : src;
+		if (strlen(target) + strlen(slash) + 2 > sizeof(target))
+			return 1;
+		strcat(target, "/");
+		strcat(target, slash);
+	}
+	/* cp writes through a symlink or hard link, keep doing so for those */
+	if ((lstat(target, &db) == 0) &&
+		(!S_ISREG(db.st_mode) || (db.st_nlink > 1)))
+		return 1;
+	if (rename(src, target) == -1)
+		return 1;
+	return 0;
+}
+#endif
+
 /**
  * @brief
  *	sys_copy
@@ -1503,7 +2077,7 @@ sys_copy(int dir, int rmtflg, char *owner, char *src, struct rqfpair *pair, int
 	si.cb = sizeof(si);
 	si.lpDesktop = PBS_DESKTOP_NAME;
 
-	if ((pw = getpwnam(owner)) == NULL) {
+	if ((pw = pbs_getpwnam(owner)) == NULL) {
 		log_errf(-1, __func__, "Failed to get %s password", owner);
 		rc = PBSE_BADUSER;
 		goto sys_copy_end;
@@ -1630,6 +2204,11 @@ sys_copy(int dir, int rmtflg, char *owner, char *src, struct rqfpair *pair, int
 	}
 
 #ifndef WIN32
+	/* a plain local file is copied in-process, without forking cp */
+	if ((rmtflg == 0) && (strcmp(ag3, "/dev/null") != 0) &&
+		(local_copy(ag2, ag3) == 0))
+		return (0);
+
 	for (loop = 1; loop < 5; ++loop) {
 		original = 0;
 		if (rmtflg == 0) {	/* local copy */
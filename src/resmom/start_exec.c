@@ -95,6 +95,7 @@
 #include "placementsets.h"
 #include "pbs_internal.h"
 #include "pbs_reliable.h"
+#include "pbs_pwcache.h"
 
 #include "renew_creds.h"
 
@@ -154,6 +155,7 @@ static pid_t	 writerpid;	/* writer side of interactive job */
 static pid_t	 shellpid;	/* shell part of interactive job  */
 static size_t	 cred_len;
 static char	*cred_buf;
+static struct timeval launch_mark;	/* end of the previous launch phase */
 
 char *variables_else[] = {	/* variables to add, value computed */
 	"HOME",
@@ -272,8 +274,9 @@ check_pwd(job *pjob)
 	struct passwd		*pwdp;
 	struct group		*grpp;
 	struct stat		sb;
+	int			ngroups;
 
-	pwdp = getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
+	pwdp = pbs_getpwnam(get_jattr_str(pjob, JOB_ATR_euser));
 	if (pwdp == NULL) {
 		(void)sprintf(log_buffer, "No Password Entry for User %s",
 			get_jattr_str(pjob, JOB_ATR_euser));
@@ -309,7 +312,7 @@ check_pwd(job *pjob)
 
 		/* execution group specified - not defaulting to login group */
 
-		grpp = getgrnam(get_jattr_str(pjob, JOB_ATR_egroup));
+		grpp = pbs_getgrnam(get_jattr_str(pjob, JOB_ATR_egroup));
 		if (grpp == NULL) {
 			(void)sprintf(log_buffer, "No Group Entry for Group %s",
 				get_jattr_str(pjob, JOB_ATR_egroup));
@@ -335,6 +338,12 @@ check_pwd(job *pjob)
 		pjob->ji_grpcache->gc_gid = pwdp->pw_gid;
 	}
 
+	/*
+	 * look up the supplementary groups now so the job starter, which
+	 * inherits the cache, does not have to ask the name service again
+	 */
+	(void)pbs_getgrouplist(pwdp->pw_name, pjob->ji_grpcache->gc_gid, &ngroups);
+
 	/* perform site specific check on validatity of account */
 	if (site_mom_chkuser(pjob))
 		return NULL;
@@ -883,6 +892,34 @@ internal_mkjobdir(char *jobid, char *jobdir)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Set the supplementary groups of the process to those of user 'name'
+ *	plus 'gid', like initgroups() but from the cached group list.
+ *
+ * @param[in] name - user name
+ * @param[in] gid - group to include
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	Error
+ *
+ */
+static int
+set_user_groups(const char *name, gid_t gid)
+{
+	gid_t *groups;
+	int ng;
+	long maxg;
+
+	if ((groups = pbs_getgrouplist(name, gid, &ng)) == NULL)
+		return -1;
+	maxg = sysconf(_SC_NGROUPS_MAX);
+	if (maxg > 0 && ng > maxg)
+		ng = (int) maxg;
+	return setgroups((size_t) ng, groups);
+}
+
 /**
  * @brief
  * 	Impersonate the user by changing effective uid and gid.
@@ -900,12 +937,12 @@ int
 impersonate_user(uid_t uid, gid_t gid)
 {
 #if defined(HAVE_GETPWUID) && defined(HAVE_INITGROUPS)
-	struct passwd *pwd = getpwuid(uid);
+	struct passwd *pwd = pbs_getpwuid(uid);
 	if (pwd == NULL)
 		return -1;
 
 	if ((geteuid() != uid) &&
-		(initgroups(pwd->pw_name, gid) == -1)) {
+		(set_user_groups(pwd->pw_name, gid) == -1)) {
 		return -1;
 	}
 
@@ -941,7 +978,7 @@ revert_from_user(void)
 #error No function to change effective UID
 #endif
 #if defined(HAVE_INITGROUPS)
-	(void)initgroups("root", pbsgroup);
+	(void)set_user_groups("root", pbsgroup);
 #endif
 #if defined(HAVE_SETEGID)
 	(void)setegid(pbsgroup);
@@ -1125,7 +1162,8 @@ lastname(char *shell)
 /**
  * @brief
  *	Become the user with specified user name, uid, and gids.
- *	Obtains the current supplement group list and if necessary adds
+ *	Obtains the user's supplementary group list (from the group cache,
+ *	as initgroups() would set it) and if necessary adds
  *	the user's login group to it,  then changes to the specified group,
  *	new group list, and the specified uid.
  *
@@ -1143,6 +1181,8 @@ int
 becomeuser_args(char *eusrname, uid_t euid, gid_t egid, gid_t rgid)
 {
 	gid_t *grplist = NULL;
+	gid_t *cached;
+	int numsup;
 	static int   maxgroups=0;
 
 #if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
@@ -1156,16 +1196,17 @@ becomeuser_args(char *eusrname, uid_t euid, gid_t egid, gid_t rgid)
 	if (maxgroups == 0)
 		maxgroups = (int)sysconf(_SC_NGROUPS_MAX);
 
-	if (initgroups(eusrname, egid) != -1) {
-		int numsup;
+	if ((cached = pbs_getgrouplist(eusrname, egid, &numsup)) != NULL) {
 		int i;
 
 		/* allocate an array for the group list */
 		grplist = calloc((size_t)maxgroups, sizeof(gid_t));
 		if (grplist == NULL)
 			return -1;
-		/* get the current list of groups */
-		numsup = getgroups(maxgroups, grplist);
+		/* copy the user's list of groups */
+		if (numsup > maxgroups)
+			numsup = maxgroups;
+		memcpy(grplist, cached, numsup * sizeof(gid_t));
 		for (i=0; i<numsup; ++i) {
 			if (grplist[i] == rgid)
 				break;
@@ -1510,6 +1551,28 @@ job_setup(job *pjob, struct passwd **pwdparm)
 	return JOB_EXEC_OK;
 }
 
+/**
+ * @brief
+ *	launch_phase - end a phase of the job launch, adding the time since
+ *	the end of the previous one to the starter return structure.
+ *
+ * @param[in,out]	sjrtn - starter return structure
+ * @param[in]		phase - the phase that ends now
+ *
+ * @return	None
+ *
+ */
+static void
+launch_phase(struct startjob_rtn *sjrtn, enum sj_phase phase)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	sjrtn->sj_phase_ms[phase] += (now.tv_sec - launch_mark.tv_sec) * 1000 +
+		(now.tv_usec - launch_mark.tv_usec) / 1000;
+	launch_mark = now;
+}
+
 /**
  * @brief
  *	record_finish_exec - record the results of finish_exec()
@@ -1783,6 +1846,7 @@ record_finish_exec(int sd)
 
 	ptask->ti_qs.ti_sid = sjr.sj_session;
 	ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+	track_job_pid(pjob, ptask->ti_qs.ti_sid);
 
 	strcpy(ptask->ti_qs.ti_parentjobid, pjob->ji_qs.ji_jobid);
 	if (task_save(ptask) == -1) {
@@ -1825,6 +1889,11 @@ record_finish_exec(int sd)
 	enqueue_update_for_send(pjob, IS_RESCUSED);
 	next_sample_time = min_check_poll;
 	log_eventf(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->ji_qs.ji_jobid, "Started, pid = %d", sjr.sj_session);
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, pjob->ji_qs.ji_jobid,
+		"launch phases (ms): fork=%ld setup=%ld prologue=%ld limits=%ld launch=%ld start=%ld",
+		sjr.sj_phase_ms[SJ_PHASE_FORK], sjr.sj_phase_ms[SJ_PHASE_SETUP],
+		sjr.sj_phase_ms[SJ_PHASE_PROLOGUE], sjr.sj_phase_ms[SJ_PHASE_LIMITS],
+		sjr.sj_phase_ms[SJ_PHASE_LAUNCH], sjr.sj_phase_ms[SJ_PHASE_START]);
 
 	return;
 }
@@ -1978,6 +2047,38 @@ read_pipe_data(int downfds, int data_size, int wait_sec)
 	return (buf);
 }
 
+/**
+ * @brief
+ *	Wait on pipe 'downfds' for the acknowledgement of 'data_size' bytes
+ *	sent, as written back by the receiving side.
+ *
+ * @param[in]	downfds - pipe descriptor downstream
+ * @param[in]	data_size - the size that is to be acknowledged
+ *
+ * @return int
+ * @retval  0	- for success
+ * @retval  1	- for failure
+ */
+static int
+receive_pipe_ack(int downfds, size_t data_size)
+{
+	void	*data_recv;
+	size_t	data_size_recv;
+
+	data_recv = read_pipe_data(downfds, sizeof(size_t), PIPE_READ_TIMEOUT);
+	if (data_recv == NULL) {
+		log_err(-1, __func__, "failed to get ack from pipe");
+		return (1);
+	}
+
+	memcpy(&data_size_recv, data_recv, sizeof(size_t));
+	if (data_size_recv != data_size) {
+		log_err(-1, __func__, "received data not match sent data");
+		return (1);
+	}
+	return (0);
+}
+
 /**
  * @brief
  *	Write a piece of data of size 'data_size' into pipe descriptors
@@ -1995,9 +2096,7 @@ read_pipe_data(int downfds, int data_size, int wait_sec)
 int
 write_pipe_data_ack(int upfds, int downfds, void *data, size_t data_size)
 {
-	void	*data_recv = NULL;
 	int	nwrite =  0;
-	size_t	data_size_recv;
 
 	if ((data  == NULL) || (data_size == 0)) {
 		return (1);
@@ -2011,18 +2110,7 @@ write_pipe_data_ack(int upfds, int downfds, void *data, size_t data_size)
 	}
 
 	/* wait for acknowledgement */
-	data_recv = read_pipe_data(downfds, sizeof(size_t), PIPE_READ_TIMEOUT);
-	if (data_recv == NULL) {
-		log_err(-1, __func__, "failed to get ack from pipe");
-		return (1);
-	}
-
-	memcpy(&data_size_recv, data_recv, sizeof(size_t));
-	if (data_size_recv != data_size) {
-		log_err(-1, __func__, "received data not match sent data");
-		return (1);
-	}
-	return (0);
+	return (receive_pipe_ack(downfds, data_size));
 }
 
 /**
@@ -2056,8 +2144,9 @@ write_pipe_data(int upfds, void *data, int data_size)
 
 /**
  * @brief
- *	Write 'r_size' first, and then the actual data 'r_buf' into pipe
- *	descriptors *	'upfds' (data write)  and 'downfds' (data ack).
+ *	Write 'r_size' followed by the actual data 'r_buf' into pipe
+ *	descriptor 'upfds' in one write, then wait on 'downfds' for the
+ *	single acknowledgement of 'r_size'.
  *
  * @param[in]	upfds - pipe descriptor upstream.
  * @param[in]	downfds - pipe descriptor downstream
@@ -2072,22 +2161,31 @@ write_pipe_data(int upfds, void *data, int data_size)
 int
 send_string_data(int upfds, int downfds, void *r_buf, size_t r_size)
 {
-	/* send new string size */
-	if (write_pipe_data_ack(upfds, downfds, &r_size, sizeof(size_t)) != 0) {
+	char	*msg;
+	int	rc;
+
+	if ((r_buf == NULL) || (r_size == 0))
 		return (1);
-	}
-	/* now send string data actual data */
-	if (write_pipe_data_ack(upfds, downfds, r_buf, r_size) != 0) {
+
+	/* size and data go out together, acknowledged once by the size */
+	if ((msg = malloc(sizeof(size_t) + r_size)) == NULL) {
+		log_err(errno, __func__, "malloc failure");
 		return (1);
 	}
+	memcpy(msg, &r_size, sizeof(size_t));
+	memcpy(msg + sizeof(size_t), r_buf, r_size);
+	rc = write_pipe_data(upfds, msg, sizeof(size_t) + r_size);
+	free(msg);
+	if (rc != 0)
+		return (1);
 
-	return (0);
+	return (receive_pipe_ack(downfds, r_size));
 }
 
 /**
  * @brief
- *	Read some string of data from 'downfds' pipe descriptor and using
- *	'upfds' for acknowledgement.
+ *	Read some string of data, its size followed by the data, from
+ *	'downfds' pipe descriptor and acknowledge it once using 'upfds'.
  *
  * @param[in]	downfds - the pipe descriptor to read from.
  * @param[in]	upfds - the pipe descriptor to use for acks.
@@ -2115,15 +2213,8 @@ receive_string_data(int downfds, int  upfds)
 		return (NULL);
 	}
 	memcpy(&r_size, r_buf, sizeof(size_t));
-	/* ack that we got the r_size */
-	ack_size = sizeof(size_t);
-	if (write_pipe_data(upfds, &ack_size, sizeof(size_t)) != 0) {
-		snprintf(log_buffer, sizeof(log_buffer), "write of length %lu bytes to pipe failed", (unsigned long)ack_size);
-		log_err(errno, __func__, log_buffer);
-		return (NULL);
-	}
 
-	/* now get the actual string data */
+	/* the string data follows its size, see send_string_data() */
 	r_buf = read_pipe_data(downfds, r_size, PIPE_READ_TIMEOUT);
 	if (r_buf == NULL) {
 		snprintf(log_buffer, sizeof(log_buffer), "read of pipe of size %lu bytes for failed", (unsigned long)r_size);
@@ -2179,6 +2270,28 @@ send_pipe_request(int upfds, int downfds, int cmd)
 	return (0);
 }
 
+/**
+ * @brief
+ *	Send a command 'cmd' request on pipe 'upfds' without waiting for
+ *	it to be acknowledged, for requests the job starter need not wait on.
+ *
+ * @param[in]	upfds - upstream pipe
+ * @param[in]	cmd - command request to send (e.g. IM_EXEC_PROLOGUE)
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval 1	- fail
+ */
+int
+post_pipe_request(int upfds, int cmd)
+{
+	if (write_pipe_data(upfds, &cmd, sizeof(int)) != 0) {
+		log_err(-1, __func__, "bad write to pipe");
+		return (1);
+	}
+	return (0);
+}
+
 /**
  * @brief
  *	Returns 1 (true) if sister moms have all replied IM_ALL_OKAY status in
@@ -2607,9 +2720,7 @@ receive_pipe_request(int sd)
 		return;
 	}
 
-	/* send back as an acknowledgement that MOM got it */
-	(void)writepipe(pjob->ji_mjspipe2, &cmd, sizeof(int));
-
+	/* IM_EXEC_PROLOGUE is posted, the job starter does not wait for an ack */
 	if (cmd == IM_EXEC_PROLOGUE) {
 
 		if (send_sisters(pjob, IM_EXEC_PROLOGUE, NULL) != pjob->ji_numnodes - 1) {
@@ -2845,6 +2956,7 @@ finish_exec(job *pjob)
 
 	ptc = -1; /* No current master pty */
 
+	gettimeofday(&launch_mark, NULL);
 	memset(&sjr, 0, sizeof(sjr));
 	pattr = &pjob->ji_wattr[(int)JOB_ATR_nodemux];
 	if (is_attr_set(pattr))
@@ -3442,6 +3554,7 @@ finish_exec(job *pjob)
 		(void)close(parent2child_moms_status_pipe[1]);
 
 	CLR_SJR(sjr)	/* clear structure used to return info to parent */
+	launch_phase(&sjr, SJ_PHASE_FORK);
 
 	/* unprotect the job from the vagaries of the kernel */
 	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
@@ -3810,6 +3923,7 @@ finish_exec(job *pjob)
 			}
 
 			/* run prolog */
+			launch_phase(&sjr, SJ_PHASE_SETUP);
 			if (prolo_hooks > 0) {
 
 				mom_hook_input_init(&hook_input);
@@ -3853,7 +3967,7 @@ finish_exec(job *pjob)
 					}
 					return;
 				case 1:   /* explicit accept */
-					if (send_pipe_request(upfds2, downfds2, IM_EXEC_PROLOGUE) != 0) {
+					if (post_pipe_request(upfds2, IM_EXEC_PROLOGUE) != 0) {
 						log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
 								LOG_INFO, pjob->ji_qs.ji_jobid,
 							"warning: send of IM_EXEC_PROLOGUE to parent mom failed");
@@ -3877,7 +3991,7 @@ finish_exec(job *pjob)
 					log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
 						LOG_INFO, "",
 						"prologue hook event: accept req by default");
-					if (send_pipe_request(upfds2, downfds2, IM_EXEC_PROLOGUE) != 0) {
+					if (post_pipe_request(upfds2, IM_EXEC_PROLOGUE) != 0) {
 						log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
 								LOG_INFO, pjob->ji_qs.ji_jobid,
 							"warning: send of IM_EXEC_PROLOGUE to parent mom failed");
@@ -4081,6 +4195,7 @@ finish_exec(job *pjob)
 		}
 		/* run prologue hooks */
 
+		launch_phase(&sjr, SJ_PHASE_SETUP);
 		if (prolo_hooks > 0) {
 			mom_hook_input_init(&hook_input);
 			hook_input.pjob = pjob;
@@ -4121,7 +4236,7 @@ finish_exec(job *pjob)
 						JOB_EXEC_FAILHOOK_RERUN, &sjr);
 				}
 			case 1:   /* explicit accept */
-				if (send_pipe_request(upfds2, downfds2, IM_EXEC_PROLOGUE) != 0) {
+				if (post_pipe_request(upfds2, IM_EXEC_PROLOGUE) != 0) {
 						log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
 								LOG_INFO, pjob->ji_qs.ji_jobid,
 							"warning: send of IM_EXEC_PROLOGUE to parent mom failed");
@@ -4148,7 +4263,7 @@ finish_exec(job *pjob)
 				log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
 					LOG_INFO, "",
 					"prologue hook event: accept req by default");
-				if (send_pipe_request(upfds2, downfds2, IM_EXEC_PROLOGUE) != 0) {
+				if (post_pipe_request(upfds2, IM_EXEC_PROLOGUE) != 0) {
 					log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
 							LOG_INFO, pjob->ji_qs.ji_jobid,
 							"warning: send of IM_EXEC_PROLOGUE to parent mom failed");
@@ -4164,6 +4279,8 @@ finish_exec(job *pjob)
 	/*	Both normal batch and interactive job come through here 	 */
 	/*************************************************************************/
 
+	launch_phase(&sjr, SJ_PHASE_PROLOGUE);
+
 	set_jattr_l_slim(pjob, JOB_ATR_session_id, sjr.sj_session, SET);
 if (site_job_setup(pjob) != 0) {
 		starter_return(upfds, downfds,
@@ -4269,6 +4386,7 @@ if (site_job_setup(pjob) != 0) {
 	CLEAR_HEAD(argv_list);
 	hook_output.argv = &argv_list;
 
+	launch_phase(&sjr, SJ_PHASE_LIMITS);
 	switch (mom_process_hooks(HOOK_EVENT_EXECJOB_LAUNCH,
 			PBS_MOM_SERVICE_NAME,
 			mom_host, &hook_input, &hook_output,
@@ -4357,6 +4475,7 @@ if (site_job_setup(pjob) != 0) {
 				LOG_INFO, "",
 				"execjob_launch hook event: accept req by default");
 	}
+	launch_phase(&sjr, SJ_PHASE_LAUNCH);
 
 	if (do_tolerate_node_failures(pjob))
 		FREE_VNLS(vnl_fails, vnl_good);
@@ -4429,6 +4548,7 @@ if (site_job_setup(pjob) != 0) {
 	}
 
 	/* tell mom we are going */
+	launch_phase(&sjr, SJ_PHASE_START);
 	starter_return(upfds, downfds, JOB_EXEC_OK, &sjr);
 	log_close(0);
 
@@ -4715,6 +4835,7 @@ start_process(task *ptask, char **argv, char **envp, bool nodemux)
 
 		ptask->ti_qs.ti_sid = sjr.sj_session;
 		ptask->ti_qs.ti_status = TI_STATE_RUNNING;
+		track_job_pid(pjob, ptask->ti_qs.ti_sid);
 
 		(void)task_save(ptask);
 		if (!check_job_substate(pjob, JOB_SUBSTATE_RUNNING)) {
@@ -5121,7 +5242,7 @@ start_process(task *ptask, char **argv, char **envp, bool nodemux)
 		char	*shname;
 		char	*args[4];
 
-		pwent = getpwuid(pjob->ji_qs.ji_un.ji_momt.ji_exuid);
+		pwent = pbs_getpwuid(pjob->ji_qs.ji_un.ji_momt.ji_exuid);
 		if (pwent != NULL && pwent->pw_shell[0] == '/')
 			shell = pwent->pw_shell;
 		shname = strrchr(shell, '/') + 1;	/* one past slash */
@@ -6195,6 +6316,8 @@ start_exec(job *pjob)
 			pjob->ji_extended.ji_ext.ji_stderr = pjob->ji_ports[1];
 		}
 
+		/* JOIN/RESTART replies are counted from the first sister on */
+		pjob->ji_joinscan = 0;
 		for (i = 1; i < nodenum; i++) {
 			np = &pjob->ji_hosts[i];
 
@@ -6212,7 +6335,8 @@ start_exec(job *pjob)
 				send_join_job_restart(com, ep, i, pjob, &phead);
 		}
 		if (pbs_conf.pbs_use_mcast == 1) {
-			send_join_job_restart_mcast(mtfd, com, ep, i, pjob, &phead);
+			/* one message for all, the header matches the last sister's */
+			send_join_job_restart_mcast(mtfd, com, ep, nodenum - 1, pjob, &phead);
 			tpp_mcast_close(mtfd);
 		}
 
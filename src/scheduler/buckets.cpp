@@ -39,6 +39,9 @@
 
 
 #include <pbs_config.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -513,6 +516,278 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 	return buckets;
 }
 
+/*
+ * The server's node buckets are kept from cycle to cycle.  Each cycle only
+ * the nodes whose bucket or state changed are moved between buckets and
+ * pools.  The cached buckets do not point to a queue because the queues are
+ * freed at the end of every cycle, so the queue name is kept alongside them.
+ */
+struct node_bucket_cache {
+	std::vector<node_bucket *> bkts;			/* cached buckets */
+	std::vector<std::string> qnames;			/* queue name of each bucket */
+	std::unordered_map<std::string, int> key_ind;		/* bucket key -> index into bkts */
+	std::vector<int> node_bkt;				/* bucket index of each node_ind */
+};
+static node_bucket_cache bucket_cache;
+
+/**
+ * @brief move a node in or out of a cached bucket and into the correct pool
+ * @param[in] nb - the bucket
+ * @param[in] node_ind - node_ind of the node
+ * @param[in] pool - the pool the node belongs in or NULL to remove the node from the bucket
+ * @return void
+ */
+static void
+set_cached_bucket_node(node_bucket *nb, int node_ind, bucket_bitpool *pool)
+{
+	bucket_bitpool *pools[] = {nb->free_pool, nb->busy_later_pool, nb->busy_pool};
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		if (pools[i] != pool && pbs_bitmap_get_bit(pools[i]->truth, node_ind)) {
+			pbs_bitmap_bit_off(pools[i]->truth, node_ind);
+			pools[i]->truth_ct--;
+		}
+	}
+
+	if (pool == NULL) {
+		if (pbs_bitmap_get_bit(nb->bkt_nodes, node_ind)) {
+			pbs_bitmap_bit_off(nb->bkt_nodes, node_ind);
+			nb->total--;
+		}
+		return;
+	}
+
+	if (!pbs_bitmap_get_bit(nb->bkt_nodes, node_ind)) {
+		pbs_bitmap_bit_on(nb->bkt_nodes, node_ind);
+		nb->total++;
+	}
+	if (!pbs_bitmap_get_bit(pool->truth, node_ind)) {
+		pbs_bitmap_bit_on(pool->truth, node_ind);
+		pool->truth_ct++;
+	}
+}
+
+/**
+ * @brief find or create the cached bucket for a node
+ * @param[in] policy - policy info
+ * @param[in] ninfo - the node
+ * @param[in] qinfo - the queue the node is associated with or NULL
+ * @return int
+ * @retval index into bucket_cache.bkts
+ * @retval -1 on error
+ */
+static int
+find_alloc_cached_bucket(status *policy, node_info *ninfo, queue_info *qinfo)
+{
+	std::string key(ninfo->nodesig);
+	node_bucket *nb;
+	schd_resource *cur_res;
+
+	key += ":priority=" + std::to_string(ninfo->priority);
+	if (qinfo != NULL)
+		key += std::string(":queue=") + qinfo->name;
+
+	auto it = bucket_cache.key_ind.find(key);
+	if (it != bucket_cache.key_ind.end())
+		return it->second;
+
+	nb = new_node_bucket(1);
+	if (nb == NULL)
+		return -1;
+
+	nb->res_spec = dup_selective_resource_list(ninfo->res, policy->resdef_to_check_no_hostvnode,
+						   (ADD_UNSET_BOOLS_FALSE | ADD_ALL_BOOL));
+	if (nb->res_spec == NULL) {
+		free_node_bucket(nb);
+		return -1;
+	}
+	for (cur_res = nb->res_spec; cur_res != NULL; cur_res = cur_res->next)
+		if (cur_res->type.is_consumable)
+			cur_res->assigned = 0;
+
+	nb->priority = ninfo->priority;
+	nb->queue = qinfo;
+	nb->name = create_node_bucket_name(policy, nb);
+	nb->queue = NULL;
+	if (nb->name == NULL) {
+		free_node_bucket(nb);
+		return -1;
+	}
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__, "Created node bucket %s", nb->name);
+
+	bucket_cache.bkts.push_back(nb);
+	bucket_cache.qnames.push_back(qinfo != NULL ? qinfo->name : "");
+	bucket_cache.key_ind[key] = bucket_cache.bkts.size() - 1;
+
+	return bucket_cache.bkts.size() - 1;
+}
+
+/**
+ * @brief free the node buckets kept across cycles.  This must be called
+ *	  when the resource definitions the buckets point to are freed.
+ * @return void
+ */
+void
+clear_node_bucket_cache(void)
+{
+	for (auto nb : bucket_cache.bkts)
+		free_node_bucket(nb);
+	bucket_cache.bkts.clear();
+	bucket_cache.qnames.clear();
+	bucket_cache.key_ind.clear();
+	bucket_cache.node_bkt.clear();
+}
+
+/**
+ * @brief create the server's node buckets.  The buckets from the previous
+ *	  cycle are updated for the nodes that changed and copied to the server.
+ *	  The buckets are sorted by the node_sort_key and each node's
+ *	  bucket_ind is set.
+ * @param[in] policy - policy info
+ * @param[in] sinfo - the server.  Nodes need to have their nodesig and node_ind set
+ * @return node_bucket **
+ * @retval array of node buckets
+ * @retval NULL on error or if there are no buckets
+ */
+node_bucket **
+query_node_buckets(status *policy, server_info *sinfo)
+{
+	node_bucket **buckets;
+	node_info **nodes;
+	std::vector<int> sorted_ind;
+	int node_ct;
+	int old_ct;
+	int ct;
+	int i;
+	int j;
+
+	if (policy == NULL || sinfo == NULL || sinfo->nodes == NULL)
+		return NULL;
+
+	nodes = sinfo->nodes;
+	node_ct = count_array(nodes);
+	for (i = 0; i < node_ct; i++) {
+		if (nodes[i]->nodesig == NULL || nodes[i]->node_ind != i) {
+			/* can't cache, do it the long way */
+			clear_node_bucket_cache();
+			buckets = create_node_buckets(policy, nodes, sinfo->queues, UPDATE_BUCKET_IND);
+			if (buckets != NULL)
+				qsort(buckets, count_array(buckets), sizeof(node_bucket *), multi_bkt_sort);
+			return buckets;
+		}
+	}
+
+	old_ct = bucket_cache.node_bkt.size();
+	bucket_cache.node_bkt.resize(node_ct > old_ct ? node_ct : old_ct, -1);
+	for (i = 0; i < static_cast<int>(bucket_cache.node_bkt.size()); i++) {
+		node_info *ninfo = (i < node_ct) ? nodes[i] : NULL;
+		int old_bkt = bucket_cache.node_bkt[i];
+		int new_bkt = -1;
+		node_bucket *nb;
+
+		if (ninfo != NULL) {
+			ninfo->bucket_ind = -1;
+			if (!ninfo->is_down && !ninfo->is_offline) {
+				queue_info *qinfo = NULL;
+
+				if (ninfo->queue_name != NULL)
+					qinfo = find_queue_info(sinfo->queues, ninfo->queue_name);
+				new_bkt = find_alloc_cached_bucket(policy, ninfo, qinfo);
+				if (new_bkt == -1) {
+					clear_node_bucket_cache();
+					return NULL;
+				}
+			}
+		}
+
+		if (old_bkt != -1 && old_bkt != new_bkt)
+			set_cached_bucket_node(bucket_cache.bkts[old_bkt], i, NULL);
+
+		bucket_cache.node_bkt[i] = new_bkt;
+
+		if (new_bkt == -1)
+			continue;
+
+		nb = bucket_cache.bkts[new_bkt];
+		if (ninfo->is_free && ninfo->num_jobs == 0 && ninfo->num_run_resv == 0) {
+			if (ninfo->node_events != NULL)
+				set_cached_bucket_node(nb, i, nb->busy_later_pool);
+			else
+				set_cached_bucket_node(nb, i, nb->free_pool);
+		} else
+			set_cached_bucket_node(nb, i, nb->busy_pool);
+	}
+	bucket_cache.node_bkt.resize(node_ct);
+
+	/* Drop buckets which no longer have any nodes */
+	std::vector<int> remap(bucket_cache.bkts.size(), -1);
+	for (i = 0, j = 0; i < static_cast<int>(bucket_cache.bkts.size()); i++) {
+		if (bucket_cache.bkts[i]->total == 0) {
+			free_node_bucket(bucket_cache.bkts[i]);
+			continue;
+		}
+		remap[i] = j;
+		bucket_cache.bkts[j] = bucket_cache.bkts[i];
+		bucket_cache.qnames[j] = bucket_cache.qnames[i];
+		j++;
+	}
+	if (j != static_cast<int>(bucket_cache.bkts.size())) {
+		bucket_cache.bkts.resize(j);
+		bucket_cache.qnames.resize(j);
+		for (auto it = bucket_cache.key_ind.begin(); it != bucket_cache.key_ind.end();) {
+			if (remap[it->second] == -1)
+				it = bucket_cache.key_ind.erase(it);
+			else {
+				it->second = remap[it->second];
+				it++;
+			}
+		}
+		for (auto &ind : bucket_cache.node_bkt)
+			if (ind != -1)
+				ind = remap[ind];
+	}
+
+	ct = bucket_cache.bkts.size();
+	if (ct == 0)
+		return NULL;
+
+	buckets = static_cast<node_bucket **>(malloc((ct + 1) * sizeof(node_bucket *)));
+	if (buckets == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	for (i = 0; i < ct; i++) {
+		buckets[i] = dup_node_bucket(bucket_cache.bkts[i], sinfo);
+		if (buckets[i] == NULL) {
+			free_node_bucket_array(buckets);
+			return NULL;
+		}
+		if (!bucket_cache.qnames[i].empty())
+			buckets[i]->queue = find_queue_info(sinfo->queues, const_cast<char *>(bucket_cache.qnames[i].c_str()));
+		/* keep the array terminated in case we need to free it */
+		buckets[i + 1] = NULL;
+	}
+
+	/* sort, then map the cache indices to the sorted indices */
+	{
+		std::unordered_map<node_bucket *, int> cache_ind;
+
+		for (i = 0; i < ct; i++)
+			cache_ind[buckets[i]] = i;
+		qsort(buckets, ct, sizeof(node_bucket *), multi_bkt_sort);
+		sorted_ind.resize(ct);
+		for (i = 0; i < ct; i++)
+			sorted_ind[cache_ind[buckets[i]]] = i;
+	}
+
+	for (i = 0; i < node_ct; i++)
+		if (bucket_cache.node_bkt[i] != -1)
+			nodes[i]->bucket_ind = sorted_ind[bucket_cache.node_bkt[i]];
+
+	return buckets;
+}
+
 /* chunk_map constructor */
 chunk_map *
 new_chunk_map() {
@@ -629,7 +904,10 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 	int j;
 	int k;
 	static pbs_bitmap *zeromap = NULL;
+	static pbs_bitmap *picked = NULL;	/* nodes picked from a free pool */
+	static pbs_bitmap *in_aoe = NULL;	/* free nodes already in the job's aoe */
 	server_info *sinfo;
+	aoe_group *aoe_grp = NULL;
 
 	if (cmap == NULL || resresv == NULL || resresv->select == NULL)
 		return 0;
@@ -639,8 +917,22 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 		if (zeromap == NULL)
 			return 0;
 	}
+	if (picked == NULL) {
+		picked = pbs_bitmap_alloc(NULL, 1);
+		if (picked == NULL)
+			return 0;
+	}
+
+	if (in_aoe == NULL) {
+		in_aoe = pbs_bitmap_alloc(NULL, 1);
+		if (in_aoe == NULL)
+			return 0;
+	}
 
 	sinfo = resresv->server;
+	/* avoid_provision prefers the nodes already in the aoe */
+	if (resresv->aoename != NULL && conf.provision_policy == AVOID_PROVISION)
+		aoe_grp = find_aoe_group(sinfo->aoe_groups, resresv->aoename);
 
 	for (i = 0; cmap[i] != NULL; i++) {
 		if (cmap[i]->bkt_cnts != NULL) {
@@ -667,8 +959,7 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 			     k = pbs_bitmap_next_on_bit(bkt->busy_later_pool->working, k)) {
 				clear_schd_error(err);
 				if (resresv->aoename != NULL) {
-					if (sinfo->unordered_nodes[k]->current_aoe == NULL ||
-					   strcmp(sinfo->unordered_nodes[k]->current_aoe, resresv->aoename) != 0)
+					if (node_aoe_rank(sinfo->unordered_nodes[k], resresv->aoename) != 1)
 						if (is_provisionable(sinfo->unordered_nodes[k], resresv, err) == NOT_PROVISIONABLE) {
 							continue;
 						}
@@ -684,23 +975,54 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 
 			}
 
-			for (k = pbs_bitmap_first_on_bit(bkt->free_pool->working);
-			     num_chunks_needed > chunks_added && k >= 0;
-			     k = pbs_bitmap_next_on_bit(bkt->free_pool->working, k)) {
-				clear_schd_error(err);
-				if (resresv->aoename != NULL) {
-					if (sinfo->unordered_nodes[k]->current_aoe == NULL ||
-					   strcmp(sinfo->unordered_nodes[k]->current_aoe, resresv->aoename) != 0)
-						if (is_provisionable(sinfo->unordered_nodes[k], resresv, err) == NOT_PROVISIONABLE) {
-							continue;
-						}
+			/* Free nodes need no per-node checks unless we have to provision.
+			 * Take all the nodes we need from the free pool at once.  A job
+			 * requesting an aoe under avoid_provision takes the free nodes
+			 * already in it this way.
+			 */
+			if (cmap[i]->bkt_cnts[j]->chunk_count > 0 && (resresv->aoename == NULL || aoe_grp != NULL)) {
+				int chunk_count = cmap[i]->bkt_cnts[j]->chunk_count;
+				long nodes_needed;
+				long taken;
+
+				nodes_needed = (num_chunks_needed - chunks_added + chunk_count - 1) / chunk_count;
+				if (nodes_needed > 0) {
+					if (aoe_grp != NULL) {
+						pbs_bitmap_assign(in_aoe, bkt->free_pool->working);
+						pbs_bitmap_and(in_aoe, aoe_grp->nodes);
+						taken = pbs_bitmap_first_n_on_bits(in_aoe, nodes_needed, picked);
+					} else
+						taken = pbs_bitmap_first_n_on_bits(bkt->free_pool->working, nodes_needed, picked);
+					if (taken > 0) {
+						clear_schd_error(err);
+						pbs_bitmap_andnot(bkt->free_pool->working, picked);
+						bkt->free_pool->working_ct -= taken;
+						pbs_bitmap_or(bkt->busy_pool->working, picked);
+						bkt->busy_pool->working_ct += taken;
+						pbs_bitmap_or(cmap[i]->node_bits, picked);
+						chunks_added += taken * chunk_count;
+					}
+				}
+			}
+			if (resresv->aoename != NULL || cmap[i]->bkt_cnts[j]->chunk_count <= 0) {
+				/* whatever is left of the free pool needs provisioning */
+				for (k = pbs_bitmap_first_on_bit(bkt->free_pool->working);
+				     num_chunks_needed > chunks_added && k >= 0;
+				     k = pbs_bitmap_next_on_bit(bkt->free_pool->working, k)) {
+					clear_schd_error(err);
+					if (resresv->aoename != NULL) {
+						if (node_aoe_rank(sinfo->unordered_nodes[k], resresv->aoename) != 1)
+							if (is_provisionable(sinfo->unordered_nodes[k], resresv, err) == NOT_PROVISIONABLE) {
+								continue;
+							}
+					}
+					pbs_bitmap_bit_off(bkt->free_pool->working, k);
+					bkt->free_pool->working_ct--;
+					pbs_bitmap_bit_on(bkt->busy_pool->working, k);
+					bkt->busy_pool->working_ct++;
+					pbs_bitmap_bit_on(cmap[i]->node_bits, k);
+					chunks_added += cmap[i]->bkt_cnts[j]->chunk_count;
 				}
-				pbs_bitmap_bit_off(bkt->free_pool->working, k);
-				bkt->free_pool->working_ct--;
-				pbs_bitmap_bit_on(bkt->busy_pool->working, k);
-				bkt->busy_pool->working_ct++;
-				pbs_bitmap_bit_on(cmap[i]->node_bits, k);
-				chunks_added += cmap[i]->bkt_cnts[j]->chunk_count;
 			}
 
 			if (chunks_added > 0)
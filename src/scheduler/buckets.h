@@ -64,6 +64,12 @@ int find_node_bucket_ind(node_bucket **buckets, schd_resource *rl, queue_info *q
 /* create node_buckets an array of nodes */
 node_bucket **create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsigned int flags);
 
+/* create the server's node buckets from the buckets kept across cycles */
+node_bucket **query_node_buckets(status *policy, server_info *sinfo);
+
+/* free the node buckets kept across cycles */
+void clear_node_bucket_cache(void);
+
 /* Create a name for the node bucket based on resources, queue, and priority */
 char *create_node_bucket_name(status *policy, node_bucket *nb);
 
@@ -57,6 +57,8 @@
  *	check_ded_time_boundary()
  *	dedtime_conflict()
  *	check_nodes()
+ *	job_is_simple()
+ *	check_simple_node_path()
  *	check_ded_time_queue()
  *	should_check_resvs()
  *	check_prime_queue()
@@ -179,7 +181,7 @@ time_to_ded_boundary(status *policy, resource_resv *njob)
 
 	duration = njob->duration;
 	ded_time = find_next_dedtime(njob->server->server_time);
-	ded = is_ded_time(njob->server->server_time);
+	ded = njob->server->server_time >= ded_time.from && njob->server->server_time < ded_time.to;
 	time_left = calc_time_left_STF(njob, &min_time_left);
 
 	if (!ded) {
@@ -733,10 +735,16 @@ is_ok_to_run(status *policy, server_info *sinfo,
 
 	if(resresv->is_job && sinfo->equiv_classes != NULL &&
 	   !(flags & (IGNORE_EQUIV_CLASS | RETURN_ALL_ERR)) &&
-	   resresv->ec_index != UNSPECIFIED &&
-	   sinfo->equiv_classes[resresv->ec_index]->can_not_run) {
-		copy_schd_error(err, sinfo->equiv_classes[resresv->ec_index]->err);
-		return NULL;
+	   resresv->ec_index != UNSPECIFIED) {
+		resresv_set *ec = sinfo->equiv_classes[resresv->ec_index];
+
+		/* The set may have failed the same way in the last cycle */
+		if (!ec->can_not_run)
+			find_resresv_set_failure(sinfo, ec);
+		if (ec->can_not_run) {
+			copy_schd_error(err, ec->err);
+			return NULL;
+		}
 	}
 
 	if (resresv->is_job) {
@@ -1362,7 +1370,7 @@ check_ded_time_boundary(resource_resv *resresv)
 	if (ded_time.from == 0 && ded_time.to == 0)
 		return SE_NONE;
 
-	ded = is_ded_time(resresv->server->server_time);
+	ded = resresv->server->server_time >= ded_time.from && resresv->server->server_time < ded_time.to;
 
 	if (!ded) {
 		if (dedtime_conflict(resresv)) /* has conflict or has no duration */
@@ -1600,6 +1608,23 @@ check_normal_node_path(status *policy, server_info *sinfo, queue_info *qinfo, re
 
 	get_resresv_spec(resresv, &spec, &pl);
 
+	/* Most jobs ask for one chunk on any vnode.  Place them first fit
+	 * without checking every node's eligibility up front.  If they can't
+	 * run, the normal path works out why.
+	 */
+	if (nodepart == NULL && job_is_simple(resresv, spec, pl, flags)) {
+		node_scan_hint *hint = NULL;
+
+		if (ninfo_arr == sinfo->unassoc_nodes)
+			hint = &sinfo->unassoc_hint;
+		else if (ninfo_arr == qinfo->nodes)
+			hint = &qinfo->node_hint;
+		nspec_arr = check_simple_node_path(policy, ninfo_arr, hint, spec, pl, resresv, flags, err);
+		if (nspec_arr != NULL)
+			return nspec_arr;
+		clear_schd_error(err);
+	}
+
 	err->status_code = NOT_RUN;
 	rc = eval_selspec(policy, spec, pl, ninfo_arr, nodepart, resresv,
 		flags, &nspec_arr, err);
@@ -1617,6 +1642,149 @@ check_normal_node_path(status *policy, server_info *sinfo, queue_info *qinfo, re
 	return NULL;
 }
 
+/**
+ * @brief
+ *		decide if a job can be placed by check_simple_node_path().  This is a
+ *		job asking for a single chunk with ncpus, not exclusively, on a
+ *		complex of single vnoded hosts.
+ *
+ * @param[in]	resresv	-	the job
+ * @param[in]	spec	-	the select spec the job is placed with
+ * @param[in]	pl	-	the place spec the job is placed with
+ * @param[in]	flags	-	flags passed to check_nodes()
+ *
+ * @return	int
+ * @retval	1	: the job can use the simple node path
+ * @retval	0	: the job needs the normal node path
+ */
+int
+job_is_simple(resource_resv *resresv, selspec *spec, place *pl, unsigned int flags)
+{
+	resource_req *req;
+
+	if (resresv == NULL || spec == NULL || pl == NULL)
+		return 0;
+
+	if (!resresv->is_job || resresv->job == NULL || resresv->job->resv != NULL)
+		return 0;
+
+	/* chunks may be broken up across the vnodes of a host */
+	if (resresv->server->has_multi_vnode)
+		return 0;
+
+	if (spec->total_chunks != 1 || resresv->ninfo_arr != NULL)
+		return 0;
+
+	/* pack reorders the nodes, excl and group use whole sets of nodes */
+	if (pl->pack || pl->excl || pl->exclhost || pl->group != NULL)
+		return 0;
+
+	if (resresv->aoename != NULL || (flags & EVAL_EXCLSET))
+		return 0;
+
+	req = find_resource_req(spec->chunks[0]->req, getallres(RES_NCPUS));
+	if (req == NULL || req->amount <= 0)
+		return 0;
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		place a simple job (see job_is_simple()) on the first vnode in
+ *		node sort order which can run it.  This is the vnode the normal
+ *		node path picks, but vnodes are only checked for eligibility as
+ *		they are reached, and vnodes without the ncpus for the job are
+ *		passed over without checking them at all.
+ *
+ *		The hint remembers how many vnodes at the front of the array have
+ *		no free ncpus.  While jobs are run, vnodes only lose resources, so
+ *		the next job starts its search after them.  The hint is dropped
+ *		when a vnode may gain resources (server's free_res_gen) or when the
+ *		nodes are resorted by unused resources.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	ninfo_arr	-	the nodes to search in node sort order
+ * @param[in,out]	hint	-	first fit hint for ninfo_arr or NULL
+ * @param[in]	spec	-	the job's select spec
+ * @param[in]	pl	-	the job's place spec
+ * @param[in]	resresv	-	the job
+ * @param[in]	flags	-	flags passed to check_nodes()
+ * @param[out]	err	-	error of the last vnode checked
+ *
+ * @return	nspec **
+ * @retval	node solution of where the job will run
+ * @retval	NULL	: the job can't run on any vnode or on error
+ */
+nspec **
+check_simple_node_path(status *policy, node_info **ninfo_arr, node_scan_hint *hint,
+	selspec *spec, place *pl, resource_resv *resresv, unsigned int flags, schd_error *err)
+{
+	nspec **nspec_arr;
+	node_info *one_node[2] = {NULL, NULL};
+	resource_req *ncpus_req;
+	int use_hint = 0;
+	int all_full = 1;	/* no vnode so far has any free ncpus */
+	int i = 0;
+
+	if (policy == NULL || ninfo_arr == NULL || spec == NULL || pl == NULL || resresv == NULL || err == NULL)
+		return NULL;
+
+	ncpus_req = find_resource_req(spec->chunks[0]->req, getallres(RES_NCPUS));
+	if (ncpus_req == NULL)
+		return NULL;
+
+	if ((nspec_arr = static_cast<nspec **>(calloc(2, sizeof(nspec *)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	if (hint != NULL && !conf.node_sort_unused) {
+		use_hint = 1;
+		if (hint->ninfo_arr == ninfo_arr && hint->gen == resresv->server->free_res_gen)
+			i = hint->first_free;
+		else {
+			hint->ninfo_arr = ninfo_arr;
+			hint->gen = resresv->server->free_res_gen;
+			hint->first_free = 0;
+		}
+	}
+
+	/* RETURN_ALL_ERR shares its bit with EVAL_OKBREAK */
+	flags &= ~RETURN_ALL_ERR;
+
+	for (; ninfo_arr[i] != NULL; i++) {
+		node_info *node = ninfo_arr[i];
+		schd_resource *ncpus;
+
+		ncpus = find_resource(node->res, getallres(RES_NCPUS));
+		if (ncpus != NULL && ncpus->indirect_res == NULL && ncpus->avail != SCHD_INFINITY_RES) {
+			sch_resource_t free_ncpus = dynamic_avail(ncpus);
+
+			if (free_ncpus == 0 && all_full && use_hint)
+				hint->first_free = i + 1;
+			if (free_ncpus < ncpus_req->amount) {
+				if (free_ncpus != 0)
+					all_full = 0;
+				continue;
+			}
+		}
+		all_full = 0;
+
+		clear_schd_error(err);
+		node->nscr = NSCR_NONE;
+		if (!is_vnode_eligible(node, resresv, pl, err))
+			continue;
+
+		one_node[0] = node;
+		if (eval_simple_selspec(policy, spec->chunks[0], one_node, pl, resresv, flags, &nspec_arr, err))
+			return nspec_arr;
+	}
+
+	free_nspecs(nspec_arr);
+	return NULL;
+}
+
 /**
  * @brief
  *		check_ded_time_queue - check if it is the appropriate time to run jobs
@@ -143,6 +143,14 @@ nspec **check_nodes(status *policy, server_info *sinfo, queue_info *qinfo, resou
 nspec **
 check_normal_node_path(status *policy, server_info *sinfo, queue_info *qinfo, resource_resv *resresv, unsigned int flags, schd_error *err);
 
+/* Can a job be placed by check_simple_node_path() */
+int job_is_simple(resource_resv *resresv, selspec *spec, place *pl, unsigned int flags);
+
+/* First fit node search for simple jobs */
+nspec **
+check_simple_node_path(status *policy, node_info **ninfo_arr, node_scan_hint *hint,
+	selspec *spec, place *pl, resource_resv *resresv, unsigned int flags, schd_error *err);
+
 
 /*
  *      is_node_available - determine that there is a node available to run
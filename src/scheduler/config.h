@@ -61,7 +61,10 @@
 
 /* usage file "magic number" - needs to be 8 chars */
 #define USAGE_MAGIC "PBS_MAG!"
-#define USAGE_VERSION 2
+#define USAGE_VERSION 3
+#define USAGE_JOURNAL_SUFFIX ".journal"
+/* journal entries after which the usage file is rewritten */
+#define USAGE_JOURNAL_MAX 4096
 #define USAGE_NAME_MAX 50
 
 #define UNKNOWN_GROUP_NAME "unknown"
@@ -134,6 +137,7 @@
 #define PARSE_NODE_SORT_KEY "node_sort_key"
 #define PARSE_SORT_NODES "sort_nodes"
 #define PARSE_SERVER_DYN_RES "server_dyn_res"
+#define PARSE_SERVER_DYN_RES_TTL "server_dyn_res_ttl"
 #define PARSE_PEER_QUEUE "peer_queue"
 #define PARSE_PEER_TRANSLATION "peer_translation"
 #define PARSE_NODE_GROUP_KEY "node_group_key"
@@ -164,6 +168,11 @@
 #define PARSE_UPDATE_COMMENTS "update_comments"
 #define PARSE_RESV_CONFIRM_IGNORE "resv_confirm_ignore"
 #define PARSE_ALLOW_AOE_CALENDAR "allow_aoe_calendar"
+#define PARSE_NODE_REFRESH_CYCLES "node_refresh_cycles"
+#define PARSE_CYCLE_PROFILE_FILE "cycle_profile_file"
+#define PARSE_CYCLE_CAPTURE_FILE "cycle_capture_file"
+#define PARSE_DECISION_TRACE_FILE "decision_trace_file"
+#define PARSE_PIN_THREADS "pin_threads"
 
 /* deprecated */
 #define PARSE_PREEMPT_STARVING "preempt_starving"
@@ -178,6 +187,8 @@
 /* max sizes */
 #define MAX_HOLIDAY_SIZE 50
 #define MAX_DEDTIME_SIZE 50
+#define MAX_PRIME_TRANS 64	/* prime status changes kept, see cache_prime_transitions() */
+#define DECISION_TRACE_SIZE 65536	/* job decisions kept in the decision trace */
 #define MAX_SERVER_DYN_RES 201    /* 200 elements + 1 sentinel */
 #define MAX_LOG_SIZE 1024
 #define MAX_RES_NAME_SIZE 256
@@ -185,6 +196,12 @@
 #define NUM_PPRIO 20
 #define NUM_PEERS 50
 #define MAX_DEF_REPLY 5
+#define MAX_PIPELINED_RUNJOBS 64	/* run job replies left unread before we wait */
+#define MAX_QUEUED_JOB_UPDATES 500	/* jobs sent in one attribute update request */
+#define MAX_BATCHED_SUBJOB_RUNS 64	/* subjobs of an array sent in one run request */
+#define RESORT_NODES_FRACTION 16	/* resort_nodes() uses qsort() past 1/N nodes out of place */
+#define SORT_JOBS_CHUNK 1024		/* jobs sorted at a time by sort_jobs_prefix() */
+#define MAX_OCCURRENCE_CACHE 1024	/* standing reservation rules find_occurrence() keeps */
 #define MAX_PTIME_SIZE 64
 
 /* resource names for sorting special cases */
@@ -65,6 +65,9 @@ extern "C" {
 #define FREE_DEEP 1		/* constant to pass to free_*_list */
 #define INITIALIZE -1
 
+/* number of resource structures new_resource() and new_resource_req() allocate at once */
+#define RES_ALLOC_CHUNK 256
+
 /* Constants used as flags to pass to next_job() function
  * Decision of Sorting jobs is taken on the basis of these constants */
 enum sort_status
@@ -0,0 +1,656 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file    cycle_capture.cpp
+ *
+ * @brief
+ * 		cycle_capture.cpp - capture the server's replies of a scheduling
+ *		cycle to a file so the cycle can be replayed offline
+ *
+ *	If the cycle_capture_file sched_config option is set, the replies to
+ *	the status calls the scheduler makes during a cycle are written to that
+ *	file.  pbs_sched_replay reads the file and replays the cycle through
+ *	scheduling_cycle() without a server.  The file is line based, one
+ *	record per line with tab separated fields:
+ *		capture	<version>
+ *		sched	<scheduler name>	<1 if the default scheduler>
+ *		reply	<call>	<key>	<pbs_errno>
+ *		object	<name>	<text>
+ *		attr	<name>	<resource>	<value>
+ *		end
+ *		time	<time the cycle ran at>
+ *	Each reply is followed by its objects and their attributes and closed
+ *	by an end line.  Tabs, newlines and backslashes in fields are escaped
+ *	with a backslash, and a NULL field is written as \N.
+ *
+ * Functions included are:
+ * 	capture_start()
+ * 	capture_end()
+ * 	read_capture()
+ * 	free_capture()
+ * 	capture_select_key()
+ * 	dup_batch_status_list()
+ *
+ */
+
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pbs_ifl.h>
+#include <pbs_error.h>
+#include <log.h>
+#include <libutil.h>
+#include "attribute.h"
+#include "data_types.h"
+#include "constant.h"
+#include "globals.h"
+#include "misc.h"
+#include "cycle_capture.h"
+
+static FILE *capture_fp;
+static char *capture_fname;
+static char *capture_tmpname;
+
+/* the IFL calls being captured */
+static struct batch_status *(*capture_statserver_orig)(int, struct attrl *, char *);
+static struct batch_status *(*capture_statsched_orig)(int, struct attrl *, char *);
+static struct batch_status *(*capture_statque_orig)(int, char *, struct attrl *, char *);
+static struct batch_status *(*capture_statvnode_orig)(int, char *, struct attrl *, char *);
+static struct batch_status *(*capture_statresv_orig)(int, char *, struct attrl *, char *);
+static struct batch_status *(*capture_statrsc_orig)(int, char *, struct attrl *, char *);
+static struct batch_status *(*capture_selstat_orig)(int, struct attropl *, struct attrl *, char *);
+static unsigned int (*capture_async_selstat_orig)(int, struct attropl *, struct attrl *, char *);
+
+/**
+ * @brief
+ * 		write a field to the capture file
+ *
+ * @param[in]	fp	-	capture file
+ * @param[in]	sep	-	separator to write before the field
+ * @param[in]	str	-	field to write, may be NULL
+ *
+ * @return	void
+ */
+static void
+write_field(FILE *fp, char sep, const char *str)
+{
+	const char *p;
+
+	putc(sep, fp);
+	if (str == NULL) {
+		fputs("\\N", fp);
+		return;
+	}
+	for (p = str; *p != '\0'; p++) {
+		switch (*p) {
+			case '\\':
+				fputs("\\\\", fp);
+				break;
+			case '\t':
+				fputs("\\t", fp);
+				break;
+			case '\n':
+				fputs("\\n", fp);
+				break;
+			default:
+				putc(*p, fp);
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		write a reply to the capture file
+ *
+ * @param[in]	call	-	IFL call the reply is for
+ * @param[in]	key	-	object the call was for, or NULL
+ * @param[in]	bs	-	the reply
+ *
+ * @return	void
+ */
+static void
+write_reply(const char *call, const char *key, struct batch_status *bs)
+{
+	struct batch_status *cur;
+	struct attrl *attrp;
+
+	if (capture_fp == NULL)
+		return;
+
+	fputs("reply", capture_fp);
+	write_field(capture_fp, '\t', call);
+	write_field(capture_fp, '\t', key);
+	fprintf(capture_fp, "\t%d\n", bs == NULL ? pbs_errno : 0);
+	for (cur = bs; cur != NULL; cur = cur->next) {
+		fputs("object", capture_fp);
+		write_field(capture_fp, '\t', cur->name);
+		write_field(capture_fp, '\t', cur->text);
+		putc('\n', capture_fp);
+		for (attrp = cur->attribs; attrp != NULL; attrp = attrp->next) {
+			fputs("attr", capture_fp);
+			write_field(capture_fp, '\t', attrp->name);
+			write_field(capture_fp, '\t', attrp->resource);
+			write_field(capture_fp, '\t', attrp->value);
+			putc('\n', capture_fp);
+		}
+	}
+	fputs("end\n", capture_fp);
+}
+
+static struct batch_status *
+capture_statserver(int c, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	bs = capture_statserver_orig(c, attrib, extend);
+	write_reply("statserver", NULL, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_statsched(int c, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	bs = capture_statsched_orig(c, attrib, extend);
+	write_reply("statsched", NULL, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_statque(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	bs = capture_statque_orig(c, id, attrib, extend);
+	write_reply("statque", id, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_statvnode(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	/* query_nodes() does not ask for only the changed vnodes while capturing */
+	bs = capture_statvnode_orig(c, id, attrib, extend);
+	write_reply("statvnode", id, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_statresv(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	bs = capture_statresv_orig(c, id, attrib, extend);
+	write_reply("statresv", id, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_statrsc(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+
+	bs = capture_statrsc_orig(c, id, attrib, extend);
+	write_reply("statrsc", id, bs);
+	return bs;
+}
+
+static struct batch_status *
+capture_selstat(int c, struct attropl *select, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+	char *key;
+
+	bs = capture_selstat_orig(c, select, attrib, extend);
+	key = capture_select_key(select);
+	write_reply("selstat", key, bs);
+	free(key);
+	return bs;
+}
+
+/* prefetched job queries would not be seen, have query_jobs() ask itself */
+static unsigned int
+capture_async_selstat(int c, struct attropl *select, struct attrl *attrib, char *extend)
+{
+	pbs_errno = PBSE_NOSUP;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		start capturing the server's replies to the status calls the
+ *		scheduler makes.  The scheduler object and the resource definitions
+ *		are captured up front, so the capture holds everything a replay
+ *		needs even if the cycle uses the scheduler's cached copies.
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	fname	-	capture file
+ *
+ * @return	int
+ * @retval	1	: capturing
+ * @retval	0	: on error
+ */
+int
+capture_start(int pbs_sd, const char *fname)
+{
+	struct batch_status *bs;
+
+	if (capture_fp != NULL)
+		return 1;
+
+	if ((capture_fname = string_dup(fname)) == NULL)
+		return 0;
+	if (pbs_asprintf(&capture_tmpname, "%s.new", fname) == -1) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(capture_fname);
+		capture_fname = NULL;
+		return 0;
+	}
+	if ((capture_fp = fopen(capture_tmpname, "w")) == NULL) {
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Can not open %s", capture_tmpname);
+		free(capture_fname);
+		free(capture_tmpname);
+		capture_fname = capture_tmpname = NULL;
+		return 0;
+	}
+
+	fprintf(capture_fp, "capture\t%d\n", CAPTURE_VERSION);
+	fputs("sched", capture_fp);
+	write_field(capture_fp, '\t', sc_name);
+	fprintf(capture_fp, "\t%d\n", dflt_sched);
+
+	capture_statserver_orig = pfn_pbs_statserver;
+	capture_statsched_orig = pfn_pbs_statsched;
+	capture_statque_orig = pfn_pbs_statque;
+	capture_statvnode_orig = pfn_pbs_statvnode;
+	capture_statresv_orig = pfn_pbs_statresv;
+	capture_statrsc_orig = pfn_pbs_statrsc;
+	capture_selstat_orig = pfn_pbs_selstat;
+	capture_async_selstat_orig = pfn_pbs_async_selstat;
+
+	pfn_pbs_statserver = capture_statserver;
+	pfn_pbs_statsched = capture_statsched;
+	pfn_pbs_statque = capture_statque;
+	pfn_pbs_statvnode = capture_statvnode;
+	pfn_pbs_statresv = capture_statresv;
+	pfn_pbs_statrsc = capture_statrsc;
+	pfn_pbs_selstat = capture_selstat;
+	pfn_pbs_async_selstat = capture_async_selstat;
+
+	bs = pbs_statsched(pbs_sd, NULL, NULL);
+	pbs_statfree(bs);
+	bs = pbs_statrsc(pbs_sd, NULL, NULL, const_cast<char *>("p"));
+	pbs_statfree(bs);
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		stop capturing the server's replies and move the capture file into
+ *		place.  The time the cycle ran at is written last since it is only
+ *		known once the cycle has started.
+ *
+ * @return	void
+ */
+void
+capture_end(void)
+{
+	int err;
+
+	if (capture_fp == NULL)
+		return;
+
+	pfn_pbs_statserver = capture_statserver_orig;
+	pfn_pbs_statsched = capture_statsched_orig;
+	pfn_pbs_statque = capture_statque_orig;
+	pfn_pbs_statvnode = capture_statvnode_orig;
+	pfn_pbs_statresv = capture_statresv_orig;
+	pfn_pbs_statrsc = capture_statrsc_orig;
+	pfn_pbs_selstat = capture_selstat_orig;
+	pfn_pbs_async_selstat = capture_async_selstat_orig;
+
+	fprintf(capture_fp, "time\t%ld\n", (long) cstat.current_time);
+	err = ferror(capture_fp);
+	if (fclose(capture_fp) != 0)
+		err = 1;
+	capture_fp = NULL;
+
+	if (err || rename(capture_tmpname, capture_fname) == -1) {
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Failed to write %s", capture_fname);
+		unlink(capture_tmpname);
+	}
+	free(capture_fname);
+	free(capture_tmpname);
+	capture_fname = capture_tmpname = NULL;
+}
+
+/**
+ * @brief
+ * 		split a line of the capture file into its fields and unescape them
+ *		in place
+ *
+ * @param[in,out]	line	-	line to split, modified
+ * @param[out]	fields	-	the fields, a NULL field for \N
+ * @param[in]	max	-	size of fields
+ *
+ * @return	int
+ * @retval	number of fields
+ */
+static int
+split_fields(char *line, char **fields, int max)
+{
+	char *src;
+	char *dst;
+	int n = 0;
+
+	src = dst = line;
+	fields[n++] = dst;
+	while (*src != '\0' && *src != '\n') {
+		if (*src == '\t') {
+			*dst++ = '\0';
+			src++;
+			if (n == max)
+				break;
+			fields[n++] = dst;
+		} else if (*src == '\\' && src[1] != '\0') {
+			src++;
+			switch (*src) {
+				case 't':
+					*dst++ = '\t';
+					break;
+				case 'n':
+					*dst++ = '\n';
+					break;
+				case 'N':
+					fields[n - 1] = NULL;
+					break;
+				default:
+					*dst++ = *src;
+			}
+			src++;
+		} else
+			*dst++ = *src++;
+	}
+	*dst = '\0';
+
+	return n;
+}
+
+/**
+ * @brief
+ * 		duplicate a field of the capture file
+ *
+ * @param[in]	field	-	field to duplicate, may be NULL
+ * @param[out]	err	-	set to 1 on a malloc failure
+ *
+ * @return	char *
+ * @retval	malloc'd copy of field or NULL if field is NULL
+ */
+static char *
+dup_field(const char *field, int *err)
+{
+	char *str;
+
+	if (field == NULL)
+		return NULL;
+	if ((str = strdup(field)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		*err = 1;
+	}
+	return str;
+}
+
+/**
+ * @brief
+ * 		read a capture file written by capture_start() and capture_end()
+ *
+ * @param[in]	fname	-	capture file
+ *
+ * @return	struct capture *
+ * @retval	the capture
+ * @retval	NULL	: on error
+ */
+struct capture *
+read_capture(const char *fname)
+{
+	struct capture *cap;
+	struct capture_reply *reply = NULL;
+	struct capture_reply **rtail;
+	struct batch_status *obj = NULL;
+	struct batch_status **otail = NULL;
+	struct attrl **atail = NULL;
+	char *fields[5];
+	char *line = NULL;
+	size_t linesz = 0;
+	int lineno = 0;
+	int err = 0;
+	FILE *fp;
+	int n;
+
+	if ((fp = fopen(fname, "r")) == NULL) {
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_ERR, __func__,
+			"Can not open %s: %s", fname, strerror(errno));
+		return NULL;
+	}
+	if ((cap = static_cast<struct capture *>(calloc(1, sizeof(struct capture)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		fclose(fp);
+		return NULL;
+	}
+	rtail = &cap->replies;
+
+	while (!err && getline(&line, &linesz, fp) != -1) {
+		lineno++;
+		n = split_fields(line, fields, 5);
+		if (fields[0] == NULL) {
+			err = 1;
+		} else if (strcmp(fields[0], "capture") == 0) {
+			if (n < 2 || fields[1] == NULL || atoi(fields[1]) != CAPTURE_VERSION)
+				err = 1;
+		} else if (strcmp(fields[0], "sched") == 0 && n >= 3 && fields[2] != NULL) {
+			free(cap->sched_name);
+			cap->sched_name = dup_field(fields[1], &err);
+			cap->dflt_sched = atoi(fields[2]);
+		} else if (strcmp(fields[0], "time") == 0 && n >= 2 && fields[1] != NULL) {
+			cap->time = strtol(fields[1], NULL, 10);
+		} else if (strcmp(fields[0], "reply") == 0 && n >= 4 && reply == NULL && fields[1] != NULL) {
+			if ((reply = static_cast<struct capture_reply *>(calloc(1, sizeof(struct capture_reply)))) == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				err = 1;
+				break;
+			}
+			*rtail = reply;
+			rtail = &reply->next;
+			reply->call = dup_field(fields[1], &err);
+			reply->key = dup_field(fields[2], &err);
+			reply->err = fields[3] != NULL ? atoi(fields[3]) : 0;
+			otail = &reply->bs;
+			obj = NULL;
+		} else if (strcmp(fields[0], "object") == 0 && n >= 3 && reply != NULL) {
+			if ((obj = static_cast<struct batch_status *>(calloc(1, sizeof(struct batch_status)))) == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				err = 1;
+				break;
+			}
+			*otail = obj;
+			otail = &obj->next;
+			obj->name = dup_field(fields[1], &err);
+			obj->text = dup_field(fields[2], &err);
+			atail = &obj->attribs;
+		} else if (strcmp(fields[0], "attr") == 0 && n >= 4 && obj != NULL) {
+			struct attrl *attrp;
+
+			if ((attrp = new_attrl()) == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				err = 1;
+				break;
+			}
+			*atail = attrp;
+			atail = &attrp->next;
+			attrp->name = dup_field(fields[1], &err);
+			attrp->resource = dup_field(fields[2], &err);
+			attrp->value = dup_field(fields[3], &err);
+		} else if (strcmp(fields[0], "end") == 0 && reply != NULL) {
+			reply = NULL;
+			obj = NULL;
+		} else
+			err = 1;
+	}
+	free(line);
+	fclose(fp);
+
+	if (err || reply != NULL || cap->sched_name == NULL) {
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_ERR, __func__,
+			"%s is not a valid capture file (line %d)", fname, lineno);
+		free_capture(cap);
+		return NULL;
+	}
+
+	return cap;
+}
+
+/**
+ * @brief
+ * 		free a capture read by read_capture()
+ *
+ * @param[in]	cap	-	capture to free
+ *
+ * @return	void
+ */
+void
+free_capture(struct capture *cap)
+{
+	struct capture_reply *reply;
+	struct capture_reply *next;
+
+	if (cap == NULL)
+		return;
+
+	for (reply = cap->replies; reply != NULL; reply = next) {
+		next = reply->next;
+		free(reply->call);
+		free(reply->key);
+		pbs_statfree(reply->bs);
+		free(reply);
+	}
+	free(cap->sched_name);
+	free(cap);
+}
+
+/**
+ * @brief
+ * 		create the key a pbs_selstat() call is captured under from its
+ *		selection criteria: name.resource=value pairs joined by commas
+ *
+ * @param[in]	opl	-	selection criteria
+ *
+ * @return	char *
+ * @retval	malloc'd key
+ * @retval	NULL	: no criteria or on error
+ */
+char *
+capture_select_key(struct attropl *opl)
+{
+	char *key = NULL;
+	int len = 0;
+
+	for (; opl != NULL; opl = opl->next) {
+		if ((key != NULL && pbs_strcat(&key, &len, ",") == NULL) ||
+			pbs_strcat(&key, &len, opl->name) == NULL ||
+			(opl->resource != NULL && (pbs_strcat(&key, &len, ".") == NULL ||
+			pbs_strcat(&key, &len, opl->resource) == NULL)) ||
+			pbs_strcat(&key, &len, "=") == NULL ||
+			pbs_strcat(&key, &len, opl->value != NULL ? opl->value : "") == NULL) {
+			free(key);
+			return NULL;
+		}
+	}
+
+	return key;
+}
+
+/**
+ * @brief
+ * 		duplicate a batch_status list.  The copy can be freed with
+ *		pbs_statfree().
+ *
+ * @param[in]	bs	-	list to duplicate
+ *
+ * @return	struct batch_status *
+ * @retval	the copy
+ * @retval	NULL	: bs is NULL or on error
+ */
+struct batch_status *
+dup_batch_status_list(struct batch_status *bs)
+{
+	struct batch_status *head = NULL;
+	struct batch_status **tail = &head;
+	struct batch_status *nbs;
+
+	for (; bs != NULL; bs = bs->next) {
+		if ((nbs = static_cast<struct batch_status *>(calloc(1, sizeof(struct batch_status)))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			pbs_statfree(head);
+			return NULL;
+		}
+		*tail = nbs;
+		tail = &nbs->next;
+		if (bs->name != NULL && (nbs->name = strdup(bs->name)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			pbs_statfree(head);
+			return NULL;
+		}
+		if (bs->text != NULL)
+			nbs->text = strdup(bs->text);
+		nbs->attribs = dup_attrl_list(bs->attribs);
+	}
+
+	return head;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+#ifndef SRC_SCHEDULER_CYCLE_CAPTURE_H_
+#define SRC_SCHEDULER_CYCLE_CAPTURE_H_
+
+#include <time.h>
+#include "pbs_ifl.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_VERSION 1
+
+/* a server reply captured from an IFL call */
+struct capture_reply {
+	char *call;			/* IFL call less the pbs_ prefix, e.g. "statvnode" */
+	char *key;			/* object the call was made for, or NULL */
+	int err;			/* pbs_errno of a NULL reply */
+	int used;			/* reply was replayed this cycle */
+	struct batch_status *bs;	/* the reply */
+	struct capture_reply *next;
+};
+
+/* the server replies of a captured scheduling cycle */
+struct capture {
+	time_t time;			/* the time the cycle ran at */
+	char *sched_name;		/* name of the scheduler which was captured */
+	int dflt_sched;			/* captured scheduler was the default scheduler */
+	struct capture_reply *replies;	/* replies in the order they were received */
+};
+
+/* start capturing the server's replies to the IFL calls of a cycle */
+int capture_start(int pbs_sd, const char *fname);
+
+/* stop capturing and move the capture file into place */
+void capture_end(void);
+
+/* read a capture file */
+struct capture *read_capture(const char *fname);
+
+/* free a capture read by read_capture() */
+void free_capture(struct capture *cap);
+
+/* key of a pbs_selstat() call */
+char *capture_select_key(struct attropl *opl);
+
+/* duplicate a batch_status list */
+struct batch_status *dup_batch_status_list(struct batch_status *bs);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif /* SRC_SCHEDULER_CYCLE_CAPTURE_H_ */
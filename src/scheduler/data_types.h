@@ -92,6 +92,8 @@ struct chunk;
 struct selspec;
 struct resdef;
 struct event_list;
+struct event_time_index;
+struct counts_index;
 struct status;
 struct fairshare_head;
 struct node_scratch;
@@ -101,6 +103,8 @@ struct bucket_bitpool;
 struct chunk_map;
 struct node_bucket_count;
 struct preempt_job_st;
+struct node_scan_hint;
+struct aoe_group;
 
 
 typedef struct state_count state_count;
@@ -118,6 +122,8 @@ typedef struct resv_info resv_info;
 typedef struct counts counts;
 typedef struct nspec nspec;
 typedef struct node_partition node_partition;
+typedef struct node_scan_hint node_scan_hint;
+typedef struct aoe_group aoe_group;
 typedef struct resource_resv resource_resv;
 typedef struct place place;
 typedef struct schd_error schd_error;
@@ -127,6 +133,8 @@ typedef struct selspec selspec;
 typedef struct resdef resdef;
 typedef struct timed_event timed_event;
 typedef struct event_list event_list;
+typedef struct event_time_index event_time_index;
+typedef struct counts_index counts_index;
 typedef struct status status;
 typedef struct fairshare_head fairshare_head;
 typedef struct node_scratch node_scratch;
@@ -210,6 +218,7 @@ struct th_data_query_ninfo
 	struct batch_status *nodes;
 	server_info *sinfo;
 	node_info **oarr;
+	char **sigs;		/* status signatures for the node cache (may be NULL) */
 	int sidx;
 	int eidx;
 };
@@ -289,6 +298,7 @@ struct place
 	unsigned int excl:1;		/* need nodes exclusively */
 	unsigned int exclhost:1;	/* need whole hosts exclusively */
 	unsigned int share:1;		/* will share nodes */
+	unsigned int is_interned:1;	/* shared read-only, see find_alloc_placespec() */
 
 	char *group;			/* resource to node group by */
 };
@@ -307,6 +317,7 @@ struct selspec
 	int total_cpus;			/* # of cpus requested in this select spec */
 	resdef **defs;			/* the resources requested by this select spec*/
 	chunk **chunks;
+	int is_interned;		/* shared read-only, see find_alloc_selspec() */
 };
 
 /* for description of these bits, check the PBS admin guide or scheduler IDS */
@@ -387,6 +398,22 @@ struct schedattrs
 	long server_dyn_res_alarm;
 };
 
+/* where a first fit search of a node array for a simple job may start,
+ * see check_simple_node_path()
+ */
+struct node_scan_hint
+{
+	node_info **ninfo_arr;		/* the array the hint is for */
+	int first_free;			/* vnodes before this one have no free ncpus */
+	int gen;			/* server's free_res_gen when the hint was taken */
+};
+
+struct aoe_group
+{
+	char *aoename;			/* current_aoe shared by the nodes */
+	pbs_bitmap *nodes;		/* node_ind of the nodes with this aoe */
+};
+
 struct server_info
 {
 	unsigned has_soft_limit:1;	/* server has a soft user/grp limit set */
@@ -425,7 +452,9 @@ struct server_info
 	resource_resv **resvs;		/* the reservations on the server */
 	resource_resv **running_jobs;	/* array of jobs which are in state R */
 	resource_resv **exiting_jobs;	/* array of jobs which are in state E */
+	resource_resv **preempt_ordered_jobs; /* running jobs in preemption order (see preempt_ordered_running_jobs()) */
 	resource_resv **jobs;		/* all the jobs in the server */
+	int jobs_sorted;		/* jobs in front of jobs[] which are sorted, see sort_jobs_prefix() */
 	resource_resv **all_resresv;	/* a list of all jobs and adv resvs */
 	event_list *calendar;		/* the calendar of events */
 	char *job_sort_formula;	/* set via the JSF attribute of either the sched, or the server */
@@ -476,6 +505,9 @@ struct server_info
 	resresv_set **equiv_classes;
 	node_bucket **buckets;		/* node bucket array */
 	node_info **unordered_nodes;
+	int free_res_gen;		/* bumped whenever a vnode may gain free resources */
+	node_scan_hint unassoc_hint;	/* first fit hint for unassoc_nodes */
+	aoe_group **aoe_groups;		/* nodes grouped by current_aoe */
 #ifdef NAS
 	/* localmod 034 */
 	share_head *share_head;	/* root of share info */
@@ -541,6 +573,7 @@ struct queue_info
 	int num_topjobs;		/* current number of top jobs in this queue */
 	int backfill_depth;		/* total allowable topjobs in this queue*/
 	char *partition;		/* partition to which queue belongs to */
+	node_scan_hint node_hint;	/* first fit hint for nodes */
 };
 
 struct job_info
@@ -679,12 +712,34 @@ struct node_info
 	unsigned is_sleeping:1;		/* node put to sleep through power on/off or ramp rate limit */
 	unsigned has_ghost_job:1;	/* race condition occurred: recalculate resources_assigned */
 
-	/* sharing */
+	/* The fields from here through name are the ones the node search and
+	 * sort loops (is_vnode_eligible(), resources_avail_on_vnode(),
+	 * node_sort_cmp()) read for every node.  They are kept together so a
+	 * node costs those loops a cache line or two rather than one per field.
+	 */
 	enum vnode_sharing sharing;	/* deflt or forced sharing/excl of the node */
+	int num_jobs;			/* number of jobs running on the node */
+	int num_run_resv;		/* number of running advanced reservations */
+	int max_running;		/* max number of jobs on the node */
+	int max_user_run;		/* max number of jobs running by a user */
+	int max_group_run;		/* max number of jobs running by a UNIX group */
+	int rank;			/* unique numeric identifier for node */
+	int priority;			/* node priority */
+	unsigned int nscr;		/* scratch space local to node search code */
+	int node_ind;			/* node's index into sinfo->unordered_nodes */
+	int bucket_ind;			/* index in server's bucket array */
+
+	schd_resource *res;		/* list of resources max/current usage */
+	schd_resource **sort_res;	/* resources of the node_sort keys, see find_node_amount() */
+	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
+	counts *group_counts;		/* group resource and running counts */
+	counts *user_counts;		/* user resource and running counts */
 
 	char *name;			/* name of the node */
 	char *mom;			/* host name on which mom resides */
 
+	int num_susp_jobs;		/* number of suspended jobs on the node */
+
 	char **jobs;			/* the name of the jobs currently on the node */
 	char **resvs;			/* the name of the reservations currently on the node */
 	resource_resv **job_arr;	/* ptrs to structs of the jobs on the node */
@@ -701,23 +756,6 @@ struct node_info
 	server_info *server;
 	char *queue_name;		/* the queue the node is associated with */
 
-	int num_jobs;			/* number of jobs running on the node */
-	int num_run_resv;		/* number of running advanced reservations */
-	int num_susp_jobs;		/* number of suspended jobs on the node */
-
-	int priority;			/* node priority */
-
-	counts *group_counts;		/* group resource and running counts */
-	counts *user_counts;		/* user resource and running counts */
-
-	int max_running;		/* max number of jobs on the node */
-	int max_user_run;		/* max number of jobs running by a user */
-	int max_group_run;		/* max number of jobs running by a UNIX group */
-
-	schd_resource *res;		/* list of resources max/current usage */
-
-	int rank;			/* unique numeric identifier for node */
-
 #ifdef NAS
 	/* localmod 034 */
 	int	sh_cls;			/* Share class supplied by node */
@@ -728,15 +766,12 @@ struct node_info
 	char *current_eoe;		/* EOE name instantiated on node */
 	char *nodesig;			/* resource signature */
 	int nodesig_ind;		/* resource signature index in server array */
-	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
 	node_partition *hostset;	/* other vnodes on on the same host */
-	unsigned int nscr;		/* scratch space local to node search code */
 	char *partition;		/* partition to which node belongs to */
 	time_t last_state_change_time;	/* Node state change at time stamp */
 	time_t last_used_time;		/* Node was last active at this time */
 	te_list *node_events;		/* list of run events that affect the node */
-	int bucket_ind;			/* index in server's bucket array */
-	int node_ind;			/* node's index into sinfo->unordered_nodes */
+	int home_thread;		/* worker thread which allocated the node, 0 for main */
 	node_partition **np_arr;	/* array of node partitions node is in */
 };
 
@@ -825,6 +860,8 @@ struct resource_resv
 	int resresv_ind;		   /* resource_resv index in all_resresv array */
 	timed_event *run_event;		   /* run event in calendar */
 	timed_event *end_event;		   /* end event in calendar */
+	sch_resource_t *sort_keys;	   /* job_sort_key values while sorting, see multi_sort() */
+	unsigned long sort_keys_gen;	   /* sort the sort_keys were set for */
 };
 
 struct resource_type
@@ -852,6 +889,7 @@ struct schd_resource
 
 	char *indirect_vnode_name;	/* name of vnode where to get value */
 	schd_resource *indirect_res;	/* ptr to indirect resource */
+	int indirect_node_ind;		/* node_ind of the vnode indirect_res is on, -1 if not known */
 
 	sch_resource_t avail;		/* availble amount of the resource */
 	char **str_avail;		/* the string form of avail */
@@ -860,6 +898,12 @@ struct schd_resource
 
 	resdef *def;			/* resource definition */
 
+	/* Only set on the head of an indexed list (see index_resource_list()):
+	 * the resources of the list indexed by their definition's index
+	 */
+	struct schd_resource **def_index;
+	int def_index_size;		/* number of entries in def_index */
+
 	struct schd_resource *next;	/* next resource in list */
 };
 
@@ -879,13 +923,7 @@ struct resdef
 	char *name;			/* name of resource */
 	struct resource_type type;	/* resource type */
 	unsigned int flags;		/* resource flags (see pbs_ifl.h) */
-};
-
-struct prev_job_info
-{
-	char *name;			/* name of job */
-	char *entity_name;		/* fair share entity of job */
-	resource_req *resused;	/* resources used by the job */
+	int index;			/* index of the definition in allres (-1 if not in it) */
 };
 
 struct counts
@@ -894,6 +932,7 @@ struct counts
 	int running;			/* count of running jobs in object */
 	int soft_limit_preempt_bit;	/* Place to store preempt bit if entity is over limits */
 	resource_count *rescts;		/* resources used */
+	counts_index *index;		/* index of the list by name - only on the head (defined in server_info.cpp) */
 	counts *next;
 };
 
@@ -913,6 +952,8 @@ struct fairshare_head
 {
 	group_info *root;			/* root of fairshare tree */
 	time_t last_decay;			/* last time tree was decayed */
+	long decays;				/* number of times the tree was decayed */
+	unsigned long ranked_gen;		/* fairshare generation fs_rank was set for */
 };
 
 /* a path from the root to a group_info in the tree */
@@ -940,6 +981,13 @@ struct group_info
 	usage_t usage;				/* calculated usage info */
 	usage_t temp_usage;			/* usage plus any temporary usage */
 	float usage_factor;			/* usage calculation taking parent's usage into account: number between 0 and 1 */
+	int fs_rank;				/* position in compare_path() order, see rank_fairshare_tree() */
+
+	/* usage as last written to the usage file and the number of tree decays
+	 * at that time.  Used to only journal entities whose usage changed.
+	 */
+	usage_t disk_usage;
+	long disk_decays;
 
 	struct group_path *gpath;		/* path from the root of the tree */
 
@@ -971,12 +1019,14 @@ struct node_partition
 {
 	unsigned int ok_break:1;	/* OK to break up chunks on this node part */
 	unsigned int excl:1;		/* partition should be allocated exclusively */
+	unsigned int stale:1;		/* a node changed, metadata needs node_partition_update() */
 	char *name;			/* res_name=res_val */
 	/* name of resource and value which define the node partition */
 	resdef *def;
 	char *res_val;
 	int tot_nodes;		/* the total number of nodes  */
 	int free_nodes;		/* the number of nodes in state Free  */
+	int busy_nodes;		/* the number of nodes running jobs or reservations */
 	schd_resource *res;		/* total amount of resources in node part */
 	node_info **ninfo_arr;	/* array of pointers to node structures  */
 	node_bucket **bkts;	/* node buckets for node part */
@@ -1024,6 +1074,20 @@ struct group_node_usage_v2
 	usage_t usage;
 };
 
+/* Usage file version 3 follows the header and last decay time with the
+ * number of times the tree has been decayed.  Each entry records the decay
+ * count its usage was written at, so decaying the tree does not require
+ * rewriting the file: each entry is decayed the missing number of times
+ * when it is read.  Changes between full writes are appended to a journal
+ * of the same entries (USAGE_JOURNAL).
+ */
+struct group_node_usage_v3
+{
+	char name[USAGE_NAME_MAX];
+	usage_t usage;
+	long decays;		/* tree decay count when usage was written */
+};
+
 struct usage_info
 {
 	char *name;			/* name of the user */
@@ -1136,6 +1200,7 @@ struct config
 	unsigned node_sort_unused:1;	/* node sorting by unused/assigned is used */
 	unsigned resv_conf_ignore:1;  /* if we want to ignore dedicated time when confirming reservations.  Move to enum if ever expanded */
 	unsigned allow_aoe_calendar:1;        /* allow jobs requesting aoe in calendar*/
+	unsigned pin_threads:1;		/* pin each worker thread to a cpu */
 #ifdef NAS /* localmod 034 */
 	unsigned prime_sto	:1;	/* shares_track_only--no enforce shares */
 	unsigned non_prime_sto:1;
@@ -1157,15 +1222,24 @@ struct config
 	int holiday_year;			/* the year the holidays are for */
 	int num_holidays;			/* number of actual holidays */
 	struct timegap ded_time[MAX_DEDTIME_SIZE];/* dedicated times */
+	time_t ded_time_max_to[MAX_DEDTIME_SIZE];/* running max of ded_time[].to, see index_ded_time() */
+	int num_ded_time;			/* number of dedicated times in ded_time */
+	time_t prime_trans[MAX_PRIME_TRANS];	/* coming prime status changes, see cache_prime_transitions() */
+	int num_prime_trans;			/* number of changes in prime_trans */
+	time_t prime_trans_from;		/* the time prime_trans starts at */
 	int unknown_shares;			/* unknown group shares */
 	int max_preempt_attempts;		/* max num of preempt attempts per cyc*/
 	int max_jobs_to_check;			/* max number of jobs to check in cyc*/
+	int node_refresh_cycles;		/* cycles between full node re-parses (0: no node cache) */
 	char ded_prefix[PBS_MAXQUEUENAME +1];	/* prefix to dedicated queues */
 	char pt_prefix[PBS_MAXQUEUENAME +1];	/* prefix to primetime queues */
 	char npt_prefix[PBS_MAXQUEUENAME +1];	/* prefix to non primetime queues */
 	char *fairshare_res;			/* resource to calc fairshare usage */
 	float fairshare_decay_factor;		/* decay factor used when decaying fairshare tree */
 	char *fairshare_ent;			/* job attribute to use as fs entity */
+	char *cycle_profile_file;		/* file to dump cycle phase times to */
+	char *cycle_capture_file;		/* file to capture the cycle's server replies to */
+	char *decision_trace_file;		/* file to dump the decision trace to */
 	char **res_to_check;			/* the resources schedule on */
 	resdef **resdef_to_check;		/* the res to schedule on in def form */
 	char **ignore_res;			/* resources - unset implies infinite */
@@ -1175,6 +1249,7 @@ struct config
 	struct sort_info *prime_node_sort;	/* node sorting primetime */
 	struct sort_info *non_prime_node_sort;	/* node sorting non primetime */
 	struct dyn_res dynamic_res[MAX_SERVER_DYN_RES]; /* for server_dyn_res */
+	time_t server_dyn_res_ttl;		/* how long a server_dyn_res value is reused */
 	struct peer_queue peer_queues[NUM_PEERS];/* peer local -> remote queue map */
 #ifdef NAS
 	/* localmod 034 */
@@ -1205,6 +1280,7 @@ struct event_list
 	timed_event *next_event;	/* the next event to be performed */
 	timed_event *first_run_event;	/* The first run event in the calendar */
 	time_t *current_time;		/* [reference] current time in the calendar */
+	event_time_index *time_index;	/* index of events by time (defined in simulate.cpp) */
 };
 
 struct timed_event
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file    decision_trace.cpp
+ *
+ * @brief
+ * 		decision_trace.cpp - keep a trace of the scheduler's job decisions
+ *
+ *	The outcome of each job considered to run is kept in a fixed size ring
+ *	of binary records: the cycle, whether the job ran, the schd_error codes
+ *	it did not run for and the time it took to consider it.  Unlike logging
+ *	the reasons at a verbose log level, this is cheap enough to always have
+ *	on.  The last DECISION_TRACE_SIZE decisions are written to the
+ *	decision_trace_file sched_config option (decision_trace in sched_priv
+ *	by default) when the scheduler receives a SIGUSR2 or crashes.  The file
+ *	can be read with pbs_sched_trace.
+ *
+ * Functions included are:
+ * 	trace_start_cycle()
+ * 	trace_job()
+ * 	trace_dump()
+ * 	trace_dump_sig()
+ *
+ */
+
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/param.h>
+#include <pbs_ifl.h>
+#include "data_types.h"
+#include "constant.h"
+#include "config.h"
+#include "globals.h"
+#include "decision_trace.h"
+
+#define TRACE_DEFAULT_FILE "decision_trace"
+
+static struct trace_rec trace_ring[DECISION_TRACE_SIZE];
+static unsigned long trace_count;	/* records written since startup */
+static int32_t trace_cycle;
+static uint32_t trace_time;
+/* copied from conf at the start of each cycle so a signal handler never
+ * follows a pointer which is being freed by a reconfigure
+ */
+static char trace_path[MAXPATHLEN + 1] = TRACE_DEFAULT_FILE;
+
+/**
+ * @brief
+ * 		start tracing a new scheduling cycle
+ *
+ * @param[in]	cycle_time	-	the time the cycle is scheduling at
+ *
+ * @return	void
+ */
+void
+trace_start_cycle(time_t cycle_time)
+{
+	const char *path = TRACE_DEFAULT_FILE;
+
+	if (conf.decision_trace_file != NULL)
+		path = conf.decision_trace_file;
+	if (strcmp(path, trace_path) != 0)
+		snprintf(trace_path, sizeof(trace_path), "%s", path);
+
+	trace_cycle++;
+	trace_time = (uint32_t) cycle_time;
+}
+
+/**
+ * @brief
+ * 		record the outcome of considering a job to run
+ *
+ * @param[in]	jobid	-	the job
+ * @param[in]	ran	-	the job was run
+ * @param[in]	err	-	the reason the job did not run
+ * @param[in]	secs	-	time spent considering the job
+ *
+ * @return	void
+ */
+void
+trace_job(const char *jobid, int ran, schd_error *err, double secs)
+{
+	struct trace_rec *tr = &trace_ring[trace_count % DECISION_TRACE_SIZE];
+
+	tr->cycle = trace_cycle;
+	tr->time = trace_time;
+	tr->ran = ran ? 1 : 0;
+	if (!ran && err != NULL) {
+		tr->error_code = err->error_code;
+		tr->status_code = err->status_code;
+	} else {
+		tr->error_code = SUCCESS;
+		tr->status_code = SCHD_UNKWN;
+	}
+	if (secs < 0)
+		secs = 0;
+	tr->usecs = secs * 1e6 > UINT32_MAX ? UINT32_MAX : (uint32_t) (secs * 1e6);
+	strncpy(tr->jobid, jobid, sizeof(tr->jobid) - 1);
+	tr->jobid[sizeof(tr->jobid) - 1] = '\0';
+
+	trace_count++;
+}
+
+/**
+ * @brief
+ * 		write the trace to the decision trace file, oldest decision first.
+ *		Only async-signal-safe calls are made so it can be called from a
+ *		signal handler.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: the file could not be written
+ */
+int
+trace_dump(void)
+{
+	struct trace_header th;
+	unsigned long first;
+	unsigned long nrecs;
+	int fd;
+	int rc = 0;
+
+	nrecs = trace_count < DECISION_TRACE_SIZE ? trace_count : DECISION_TRACE_SIZE;
+	first = trace_count < DECISION_TRACE_SIZE ? 0 : trace_count % DECISION_TRACE_SIZE;
+
+	if ((fd = open(trace_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1)
+		return -1;
+
+	memcpy(th.magic, TRACE_MAGIC, sizeof(th.magic));
+	th.rec_size = sizeof(struct trace_rec);
+	th.nrecs = nrecs;
+	if (write(fd, &th, sizeof(th)) != sizeof(th))
+		rc = -1;
+
+	/* the ring wraps, the oldest records are from first to the end */
+	if (rc == 0 && first > 0) {
+		ssize_t len = (DECISION_TRACE_SIZE - first) * sizeof(struct trace_rec);
+		if (write(fd, &trace_ring[first], len) != len)
+			rc = -1;
+	}
+	if (rc == 0 && nrecs > 0) {
+		ssize_t len = (first > 0 ? first : nrecs) * sizeof(struct trace_rec);
+		if (write(fd, trace_ring, len) != len)
+			rc = -1;
+	}
+
+	if (close(fd) == -1)
+		rc = -1;
+	return rc;
+}
+
+/**
+ * @brief
+ * 		signal handler which dumps the decision trace
+ *
+ * @param[in]	sig	-	signal
+ *
+ * @return	void
+ */
+void
+trace_dump_sig(int sig)
+{
+	trace_dump();
+}
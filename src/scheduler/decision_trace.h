@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+#ifndef SRC_SCHEDULER_DECISION_TRACE_H_
+#define SRC_SCHEDULER_DECISION_TRACE_H_
+
+#include <stdint.h>
+#include "data_types.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#define TRACE_MAGIC "PBSTRC01"
+#define TRACE_JOBID_SIZE 44
+
+/* header of a decision trace file, followed by nrecs trace_recs oldest first */
+struct trace_header {
+	char magic[8];			/* TRACE_MAGIC */
+	uint32_t rec_size;		/* sizeof(struct trace_rec) */
+	uint32_t nrecs;			/* number of records which follow */
+};
+
+/* the outcome of considering one job to run.  64 bytes */
+struct trace_rec {
+	int32_t cycle;			/* scheduling cycle number since startup */
+	uint32_t time;			/* time the cycle started */
+	int32_t error_code;		/* enum sched_error_code the job did not run for */
+	uint32_t usecs;			/* time spent considering the job */
+	uint8_t status_code;		/* enum schd_err_status */
+	uint8_t ran;			/* the job was run */
+	uint8_t pad[2];
+	char jobid[TRACE_JOBID_SIZE];	/* job id, truncated */
+};
+
+/* start tracing a new scheduling cycle */
+void trace_start_cycle(time_t cycle_time);
+
+/* record the outcome of considering a job */
+void trace_job(const char *jobid, int ran, schd_error *err, double secs);
+
+/* write the trace to a file.  Safe to call from a signal handler */
+int trace_dump(void);
+
+/* signal handler which dumps the trace */
+void trace_dump_sig(int sig);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif /* SRC_SCHEDULER_DECISION_TRACE_H_ */
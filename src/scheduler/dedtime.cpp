@@ -48,6 +48,8 @@
  * 	parse_ded_file()
  * 	cmp_ded_time()
  * 	is_ded_time()
+ * 	find_next_dedtime()
+ * 	index_ded_time()
  *
  */
 #include <pbs_config.h>
@@ -152,6 +154,7 @@ parse_ded_file(const char *filename)
 	}
 	/* sort dedtime in ascending order with all 0 elements at the end */
 	qsort(conf.ded_time, MAX_DEDTIME_SIZE, sizeof(struct timegap), cmp_ded_time);
+	index_ded_time();
 	fclose(fp);
 	return 0;
 }
@@ -222,10 +225,45 @@ is_ded_time(time_t t)
  */
 struct timegap find_next_dedtime(time_t t)
 {
-	int i;
+	static struct timegap none = {0, 0};
+	int lo = 0;
+	int hi = conf.num_ded_time;
+
+	/* The first dedtime (in start order) which ends after t.  The running
+	 * max of the end times only grows, so it can be binary searched.
+	 */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (conf.ded_time_max_to[mid] <= t)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == conf.num_ded_time)
+		return none;
+
+	return conf.ded_time[lo];
+}
 
-	for (i = 0; conf.ded_time[i].from != 0 && conf.ded_time[i].to <= t; i++)
-		;
+/**
+ * @brief
+ * 		index the dedicated times for find_next_dedtime().  It must be
+ *		called whenever conf.ded_time is changed and sorted again.
+ *
+ * @return void
+ */
+void
+index_ded_time(void)
+{
+	time_t max_to = 0;
+	int i;
 
-	return conf.ded_time[i];
+	for (i = 0; i < MAX_DEDTIME_SIZE && conf.ded_time[i].from != 0; i++) {
+		if (conf.ded_time[i].to > max_to)
+			max_to = conf.ded_time[i].to;
+		conf.ded_time_max_to[i] = max_to;
+	}
+	conf.num_ded_time = i;
 }
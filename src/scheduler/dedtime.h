@@ -76,6 +76,12 @@ int is_ded_time(time_t t);
  */
 struct timegap find_next_dedtime(time_t t);
 
+/*
+ *	index_ded_time - index the dedicated times for find_next_dedtime()
+ *			 after they change
+ */
+void index_ded_time(void);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -61,9 +61,11 @@
  * 	print_fairshare()
  * 	write_usage()
  * 	rec_write_usage()
+ * 	sync_usage()
  * 	read_usage()
  * 	read_usage_v1()
  * 	read_usage_v2()
+ * 	read_usage_v3()
  * 	new_group_path()
  * 	free_group_path_list()
  * 	create_group_path()
@@ -75,14 +77,22 @@
  * 	dup_fairshare_head()
  * 	free_fairshare_head()
  * 	reset_temp_usage()
+ * 	rank_fairshare_tree()
  *
  */
 #include <pbs_config.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <log.h>
 
@@ -98,6 +108,7 @@
 #include "fifo.h"
 #include "resource_resv.h"
 #include "resource.h"
+#include "multi_threading.h"
 #ifdef NAS /* localmod 041 */
 #include "sort.h"
 #endif
@@ -105,6 +116,83 @@
 
 extern time_t last_decay;
 
+/* Entity name to group_info indexes of whole fairshare trees, keyed by the
+ * root of the tree.  An index is built on the first lookup in a tree and is
+ * kept up to date by add_child().  Lookups are done from the query threads,
+ * so the indexes are only used under fairshare_lock.
+ */
+static std::unordered_map<group_info *, std::unordered_map<std::string, group_info *> > ginfo_indexes;
+
+/* The fairshare tree is read before the worker threads are set up and by
+ * pbsfs, which has none, so it has its own recursive lock rather than
+ * general_lock.
+ */
+static pthread_mutex_t fairshare_lock;
+static pthread_once_t fairshare_lock_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief
+ *		initialize fairshare_lock
+ */
+static void
+init_fairshare_lock(void)
+{
+	pthread_mutexattr_t attr;
+
+	if (init_mutex_attr_recursive(&attr) == 0)
+		pthread_mutexattr_init(&attr);
+	pthread_mutex_init(&fairshare_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+/**
+ * @brief
+ *		lock the fairshare name indexes
+ */
+static void
+lock_fairshare(void)
+{
+	pthread_once(&fairshare_lock_once, init_fairshare_lock);
+	pthread_mutex_lock(&fairshare_lock);
+}
+
+/**
+ * @brief
+ *		unlock the fairshare name indexes
+ */
+static void
+unlock_fairshare(void)
+{
+	pthread_mutex_unlock(&fairshare_lock);
+}
+
+/* Bumped whenever the usage, percentages or shape of any fairshare tree
+ * change.  The fs_rank of a tree is valid while its ranked_gen matches.
+ */
+static unsigned long fairshare_gen = 1;
+
+/**
+ * @brief
+ *		add a fairshare tree and its siblings to an entity name index in
+ *		the order find_group_info() walks it
+ *
+ * @param[in,out]	index	-	the index to add to
+ * @param[in]	root	-	the root of the current sub-tree
+ *
+ * @return	nothing
+ */
+static void
+index_fairshare_tree(std::unordered_map<std::string, group_info *> &index, group_info *root)
+{
+	if (root == NULL)
+		return;
+
+	if (root->name != NULL)
+		index.emplace(root->name, root);
+	index_fairshare_tree(index, root->sibling);
+	index_fairshare_tree(index, root->child);
+}
+
 /**
  * @brief
  *		add_child - add a group_info to the resource group tree
@@ -124,6 +212,19 @@ add_child(group_info *ginfo, group_info *parent)
 		ginfo->parent = parent;
 		ginfo->resgroup = parent->cresgroup;
 		ginfo->gpath = create_group_path(ginfo);
+		fairshare_gen++;
+
+		if (ginfo->name != NULL) {
+			group_info *root;
+
+			for (root = parent; root->parent != NULL; root = root->parent)
+				;
+			lock_fairshare();
+			auto it = ginfo_indexes.find(root);
+			if (it != ginfo_indexes.end())
+				it->second.emplace(ginfo->name, ginfo);
+			unlock_fairshare();
+		}
 	}
 }
 
@@ -150,7 +251,8 @@ add_unknown(group_info *ginfo, group_info *root)
 /**
  * @brief
  *		find_group_info - recursive function to find a group_info in the
- *			  resgroup tree
+ *			  resgroup tree.  Lookups from the root of a tree use the
+ *			  tree's entity name index instead of walking it.
  *
  * @param[in]	name	-	name of the ginfo to find
  * @param[in]	root	-	the root of the current sub-tree
@@ -165,6 +267,20 @@ find_group_info(const char *name, group_info *root)
 	if (root == NULL || name == NULL || !strcmp(name, root->name))
 		return root;
 
+	if (root->parent == NULL) {
+		lock_fairshare();
+		auto it = ginfo_indexes.find(root);
+		if (it == ginfo_indexes.end()) {
+			it = ginfo_indexes.emplace(root, std::unordered_map<std::string, group_info *>()).first;
+			index_fairshare_tree(it->second, root);
+		}
+		auto gi = it->second.find(name);
+		ginfo = (gi != it->second.end()) ? gi->second : NULL;
+		unlock_fairshare();
+
+		return ginfo;
+	}
+
 	ginfo = find_group_info(name, root->sibling);
 	if (ginfo == NULL)
 		ginfo = find_group_info(name, root->child);
@@ -192,16 +308,19 @@ find_alloc_ginfo(char *name, group_info *root)
 	if (name == NULL || root == NULL)
 		return NULL;
 
+	/* query threads may look for the same new entity at once */
+	lock_fairshare();
 	ginfo = find_group_info(name, root);
 
 	if (ginfo == NULL) {
-		if ((ginfo = new_group_info()) == NULL)
-			return NULL;
-
-		ginfo->name = string_dup(name);
-		ginfo->shares = 1;
-		add_unknown(ginfo, root);
+		if ((ginfo = new_group_info()) != NULL) {
+			ginfo->name = string_dup(name);
+			ginfo->shares = 1;
+			add_unknown(ginfo, root);
+		}
 	}
+	unlock_fairshare();
+
 	return ginfo;
 }
 
@@ -231,6 +350,9 @@ new_group_info()
 	ngi->usage = FAIRSHARE_MIN_USAGE;
 	ngi->temp_usage = FAIRSHARE_MIN_USAGE;
 	ngi->usage_factor = 0.0;
+	ngi->fs_rank = 0;
+	ngi->disk_usage = FAIRSHARE_MIN_USAGE;
+	ngi->disk_decays = 0;
 	ngi->gpath = NULL;
 	ngi->parent = NULL;
 	ngi->sibling = NULL;
@@ -449,6 +571,8 @@ calc_fair_share_perc(group_info *root, int shares)
 	if (root == NULL)
 		return 0;
 
+	fairshare_gen++;
+
 	if (shares == UNSPECIFIED)
 		cur_shares = count_shares(root);
 	else
@@ -493,6 +617,7 @@ update_usage_on_run(resource_resv *resresv)
 		return;
 
 	u = formula_evaluate(conf.fairshare_res, resresv, resresv->resreq);
+	fairshare_gen++;
 	if (resresv->job->ginfo !=NULL) {
 		gpath = resresv->job->ginfo->gpath;
 		while (gpath != NULL) {
@@ -590,10 +715,34 @@ compare_path(struct group_path *gp1, struct group_path *gp2)
 	return rc;
 }
 
+/**
+ * @brief
+ *		decay a usage value a number of times the way decay_fairshare_tree()
+ *		decays the tree
+ *
+ * @param[in]	usage	-	usage to decay
+ * @param[in]	decays	-	number of decays to apply
+ *
+ * @return	decayed usage
+ */
+static usage_t
+decayed_usage(usage_t usage, long decays)
+{
+	for (; decays > 0; decays--) {
+		usage *= conf.fairshare_decay_factor;
+		if (usage < FAIRSHARE_MIN_USAGE)
+			usage = FAIRSHARE_MIN_USAGE;
+	}
+
+	return usage;
+}
+
 /**
  * @brief
  *		write_usage - write the usage information to the usage file
- *		      This function uses a recursive helper function
+ *		      This function uses a recursive helper function.
+ *		      The file is written aside and renamed into place, and the
+ *		      usage journal is removed since the file now covers it.
  *
  * @param[in]	filename	-	usage file
  * @param[in]	fhead	-	Pointer to fairshare_head structure.
@@ -606,6 +755,8 @@ write_usage(const char *filename, fairshare_head *fhead)
 {
 	FILE *fp;		/* file pointer to usage file */
 	struct group_node_header head;
+	std::string tmpname;
+	int error;
 
 	if (fhead == NULL)
 		return 0;
@@ -613,30 +764,73 @@ write_usage(const char *filename, fairshare_head *fhead)
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
-	if ((fp = fopen(filename, "wb")) == NULL) {
-		sprintf(log_buffer, "Error opening file %s", filename);
+	tmpname = std::string(filename) + ".new";
+	if ((fp = fopen(tmpname.c_str(), "wb")) == NULL) {
+		sprintf(log_buffer, "Error opening file %s", tmpname.c_str());
 		log_err(errno, "write_usage", log_buffer);
 		return 0;
 	}
 
-	/* version 2:
+	/* version 3:
 	 * header
 	 * last_decay
-	 * group_node_usage_v2
-	 * group_node_usage_v2
+	 * decays
+	 * group_node_usage_v3
+	 * group_node_usage_v3
 	 * ...
 	 */
 
+	memset(&head, 0, sizeof(head));
 	pbs_strncpy(head.tag, USAGE_MAGIC, sizeof(head.tag));
 	head.version = USAGE_VERSION;
 	fwrite(&head, sizeof(struct group_node_header), 1, fp);
 	fwrite(&fhead->last_decay, sizeof(time_t), 1, fp);
+	fwrite(&fhead->decays, sizeof(long), 1, fp);
+
+	rec_write_usage(fhead->root, fp, fhead->decays);
+	error = ferror(fp);
+	if (fclose(fp) != 0 || error) {
+		sprintf(log_buffer, "Error writing file %s", tmpname.c_str());
+		log_err(errno, "write_usage", log_buffer);
+		remove(tmpname.c_str());
+		return 0;
+	}
+
+	if (rename(tmpname.c_str(), filename) == -1) {
+		sprintf(log_buffer, "Error renaming %s to %s", tmpname.c_str(), filename);
+		log_err(errno, "write_usage", log_buffer);
+		remove(tmpname.c_str());
+		return 0;
+	}
+	remove((std::string(filename) + USAGE_JOURNAL_SUFFIX).c_str());
 
-	rec_write_usage(fhead->root, fp);
-	fclose(fp);
 	return 1;
 }
 
+/**
+ * @brief
+ *		is a fairshare tree node an entity whose usage is kept in the
+ *		usage file
+ *
+ * @param[in]	ginfo	-	fairshare tree node
+ *
+ * @return	int
+ * @retval	1	: it is
+ * @retval	0	: it is not
+ */
+static int
+is_usage_entity(group_info *ginfo)
+{
+	/* only leaves of the tree (fairshare entities) are kept.
+	 * It is possible that the unknown group is empty.  Don't want to keep it
+	 */
+#ifdef NAS /* localmod 043 */
+	return ginfo->child == NULL;
+#else
+	return ginfo->child == NULL && strcmp(ginfo->name, UNKNOWN_GROUP_NAME) != 0;
+#endif /* localmod 043 */
+}
+
 /**
  * @brief
  *		rec_write_usage - recursive helper function which will write out all
@@ -644,41 +838,223 @@ write_usage(const char *filename, fairshare_head *fhead)
  *
  * @param[in]	root	-	the root of the current subtree
  * @param[in]	fp	-	the file to write the ginfo out to
+ * @param[in]	decays	-	the decay count of the tree
  *
  * @return nothing
  *
  */
 void
-rec_write_usage(group_info *root, FILE *fp)
+rec_write_usage(group_info *root, FILE *fp, long decays)
 {
-	struct group_node_usage_v2 grp;	/* used to write out usage info */
+	struct group_node_usage_v3 grp;	/* used to write out usage info */
 
 	if (root == NULL)
 		return;
 
-	/* only write out leaves of the tree (fairshare entities)
-	 * usage defaults to 1 so don't bother writing those out either
-	 * It is possible that the unknown group is empty.  Don't want to write it out
-	 */
-#ifdef NAS /* localmod 043 */
-	if (root->child == NULL) {
-#else
-	if (root->usage != 1 && root->child == NULL && strcmp(root->name, UNKNOWN_GROUP_NAME) != 0) {
+	if (is_usage_entity(root)) {
+		/* usage defaults to 1 so don't bother writing those out */
+#ifndef NAS /* localmod 043 */
+		if (root->usage != 1)
 #endif /* localmod 043 */
+		{
+			memset(&grp, 0, sizeof(grp));
+			snprintf(grp.name, sizeof(grp.name), "%s", root->name);
+			grp.usage = root->usage;
+			grp.decays = decays;
+
+			fwrite(&grp, sizeof(struct group_node_usage_v3), 1, fp);
+		}
+		root->disk_usage = root->usage;
+		root->disk_decays = decays;
+	}
+
+	rec_write_usage(root->sibling, fp, decays);
+	rec_write_usage(root->child, fp, decays);
+}
+
+/**
+ * @brief
+ *		append the entities whose usage differs from what the usage
+ *		file and journal hold to the journal
+ *
+ * @param[in]	root	-	the root of the current subtree
+ * @param[in]	fp	-	the journal
+ * @param[in]	decays	-	the decay count of the tree
+ *
+ * @return	number of entries appended
+ */
+static long
+rec_journal_usage(group_info *root, FILE *fp, long decays)
+{
+	struct group_node_usage_v3 grp;
+	long count = 0;
+
+	if (root == NULL)
+		return 0;
+
+	if (is_usage_entity(root) &&
+		root->usage != decayed_usage(root->disk_usage, decays - root->disk_decays)) {
+		memset(&grp, 0, sizeof(grp));
 		snprintf(grp.name, sizeof(grp.name), "%s", root->name);
 		grp.usage = root->usage;
+		grp.decays = decays;
 
-		fwrite(&grp, sizeof(struct group_node_usage_v2), 1, fp);
+		if (fwrite(&grp, sizeof(struct group_node_usage_v3), 1, fp) == 1) {
+			root->disk_usage = root->usage;
+			root->disk_decays = decays;
+			count++;
+		}
 	}
 
-	rec_write_usage(root->sibling, fp);
-	rec_write_usage(root->child, fp);
+	count += rec_journal_usage(root->sibling, fp, decays);
+	count += rec_journal_usage(root->child, fp, decays);
+
+	return count;
+}
+
+/**
+ * @brief
+ *		sync_usage - bring the usage file up to date with the tree without
+ *		     rewriting it.  The decay time and count are updated in
+ *		     place and the entities whose usage changed other than by
+ *		     decay are appended to the usage journal.  The file is
+ *		     rewritten with write_usage() when it is not a current
+ *		     version file or the journal grew past USAGE_JOURNAL_MAX
+ *		     entries.
+ *
+ * @param[in]	filename	-	usage file
+ * @param[in]	fhead	-	Pointer to fairshare_head structure.
+ *
+ * @return	success/failure
+ */
+int
+sync_usage(const char *filename, fairshare_head *fhead)
+{
+	FILE *fp;
+	struct group_node_header head;
+	std::string journal;
+	time_t last;
+	long decays;
+	long entries;
+	int error;
+
+	if (fhead == NULL)
+		return 0;
+
+	if (filename == NULL)
+		filename = USAGE_FILE;
+
+	if ((fp = fopen(filename, "r+b")) == NULL)
+		return write_usage(filename, fhead);
+
+	if (fread(&head, sizeof(struct group_node_header), 1, fp) != 1 ||
+		strncmp(head.tag, USAGE_MAGIC, sizeof(head.tag)) != 0 ||
+		head.version != USAGE_VERSION ||
+		fread(&last, sizeof(time_t), 1, fp) != 1 ||
+		fread(&decays, sizeof(long), 1, fp) != 1) {
+		fclose(fp);
+		return write_usage(filename, fhead);
+	}
+
+	if (last != fhead->last_decay || decays != fhead->decays) {
+		fseek(fp, sizeof(struct group_node_header), SEEK_SET);
+		fwrite(&fhead->last_decay, sizeof(time_t), 1, fp);
+		fwrite(&fhead->decays, sizeof(long), 1, fp);
+	}
+	error = ferror(fp);
+	if (fclose(fp) != 0 || error) {
+		sprintf(log_buffer, "Error updating file %s", filename);
+		log_err(errno, __func__, log_buffer);
+		return write_usage(filename, fhead);
+	}
+
+	journal = std::string(filename) + USAGE_JOURNAL_SUFFIX;
+	if ((fp = fopen(journal.c_str(), "ab")) == NULL) {
+		sprintf(log_buffer, "Error opening file %s", journal.c_str());
+		log_err(errno, __func__, log_buffer);
+		return write_usage(filename, fhead);
+	}
+
+	fseek(fp, 0, SEEK_END);
+	entries = ftell(fp);
+	if (entries <= 0) {
+		memset(&head, 0, sizeof(head));
+		pbs_strncpy(head.tag, USAGE_MAGIC, sizeof(head.tag));
+		head.version = USAGE_VERSION;
+		fwrite(&head, sizeof(struct group_node_header), 1, fp);
+		entries = 0;
+	} else
+		entries = (entries - sizeof(struct group_node_header)) / sizeof(struct group_node_usage_v3);
+
+	entries += rec_journal_usage(fhead->root, fp, fhead->decays);
+	error = ferror(fp);
+	if (fclose(fp) != 0 || error) {
+		sprintf(log_buffer, "Error writing file %s", journal.c_str());
+		log_err(errno, __func__, log_buffer);
+		return write_usage(filename, fhead);
+	}
+
+	/* compact the journal into the usage file */
+	if (entries > USAGE_JOURNAL_MAX)
+		return write_usage(filename, fhead);
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		set the usage of an entity read from the usage file and add it to
+ *		the usage of the groups above it
+ *
+ * @param[in]	name	-	name of the entity
+ * @param[in]	usage	-	usage of the entity
+ * @param[in]	flags	-	FS_TRIM to not add entities not already in the tree
+ * @param[in]	root	-	root of the fairshare tree
+ *
+ * @return	the entity's group_info
+ * @retval	NULL	: invalid or not added
+ */
+static group_info *
+load_usage_entry(char *name, usage_t usage, int flags, group_info *root)
+{
+	group_info *ginfo;
+	struct group_path *gpath;
+
+	if (usage < 0 || !is_valid_pbs_name(name, USAGE_NAME_MAX)) {
+		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+			  "fairshare usage", "Invalid entity");
+		return NULL;
+	}
+
+	/* if we're trimming the tree, don't add any new nodes which are not
+	 * already in the resource_group file
+	 */
+	if (flags & FS_TRIM)
+		ginfo = find_group_info(name, root);
+	else
+		ginfo = find_alloc_ginfo(name, root);
+
+	if (ginfo != NULL) {
+		ginfo->usage = usage;
+		ginfo->temp_usage = usage;
+		if (ginfo->child == NULL) {
+			gpath = ginfo->gpath;
+			/* add usage down the path from the root to our parent */
+			while (gpath->next != NULL) {
+				gpath->ginfo->usage += usage;
+				gpath->ginfo->temp_usage += usage;
+				gpath = gpath->next;
+			}
+		}
+	}
+
+	return ginfo;
 }
 
 /**
  * @brief
  *		read_usage - read the usage information and load it into the
- *		     resgroup tree.
+ *		     resgroup tree.  The usage file is mapped rather than read.
  *
  * @param[in]	filename	-	The file which stores the usage information.
  * @param[in]	flags	-	flags to check whether to trim or not.
@@ -690,60 +1066,89 @@ rec_write_usage(group_info *root, FILE *fp)
 void
 read_usage(const char *filename, int flags, fairshare_head *fhead)
 {
-	FILE *fp;				/* file pointer to usage file */
+	int fd;					/* usage file */
+	struct stat sb;
+	char *map;				/* the mapped usage file */
+	size_t size;
+	size_t off;
 	struct group_node_header head;		/* usage file header */
 	time_t last;				/* read the last sync from the file */
+	long decays;				/* decay count of the file */
 	int error = 0;				/* error reading in usage header */
 
 	if (fhead == NULL || fhead->root == NULL)
 		return;
 
+	fairshare_gen++;
+
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
-	if ((fp = fopen(filename, "r")) == NULL) {
+	if ((fd = open(filename, O_RDONLY)) == -1) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING, "fairshare usage",
 			  "Creating usage database for fairshare");
 		fprintf(stderr, "Creating usage database for fairshare.\n");
 		return;
 	}
 
+	if (fstat(fd, &sb) == -1 || sb.st_size < (off_t) sizeof(struct group_node_header)) {
+		close(fd);
+		return;
+	}
+	size = sb.st_size;
+
+	map = static_cast<char *>(mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0));
+	close(fd);
+	if (map == MAP_FAILED) {
+		sprintf(log_buffer, "Error mapping file %s", filename);
+		log_err(errno, __func__, log_buffer);
+		return;
+	}
+
 	/* read header */
-	if (fread(&head, sizeof(struct group_node_header), 1, fp) != 0) {
-		if (!strcmp(head.tag, USAGE_MAGIC)) { /* this is a header */
-			if (head.version == 2) {
-				if (fread(&last, sizeof(time_t), 1, fp) != 0) {
-					/* 946713600 = 1/1/2000 00:00 - before usage version 2 existed */
-					if (last == 0 || last > 946713600)
-						fhead->last_decay = last;
-					else
-						error = 1;
-				}
-				if (!error)
-					read_usage_v2(fp, flags, fhead->root);
-			}
+	memcpy(&head, map, sizeof(struct group_node_header));
+	off = sizeof(struct group_node_header);
+	if (!strncmp(head.tag, USAGE_MAGIC, sizeof(head.tag))) { /* this is a header */
+		if ((head.version == 2 || head.version == 3) && off + sizeof(time_t) <= size) {
+			memcpy(&last, map + off, sizeof(time_t));
+			off += sizeof(time_t);
+			/* 946713600 = 1/1/2000 00:00 - before usage version 2 existed */
+			if (last == 0 || last > 946713600)
+				fhead->last_decay = last;
 			else
 				error = 1;
+		} else
+			error = 1;
+
+		if (!error && head.version == 3) {
+			if (off + sizeof(long) <= size) {
+				memcpy(&decays, map + off, sizeof(long));
+				off += sizeof(long);
+				fhead->decays = decays;
+				read_usage_v3(map + off, size - off,
+					(std::string(filename) + USAGE_JOURNAL_SUFFIX).c_str(), flags, fhead);
+			} else
+				error = 1;
+		} else if (!error)
+			read_usage_v2(map + off, size - off, flags, fhead->root);
 
-			if (error)
-				log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
-					  "fairshare usage", "Invalid usage file header");
+		if (error)
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+				  "fairshare usage", "Invalid usage file header");
 
-		}
-		else	 { /* original headerless usage file */
-			rewind(fp);
-			read_usage_v1(fp, fhead->root);
-		}
 	}
+	else	 /* original headerless usage file */
+		read_usage_v1(map, size, fhead->root);
 
-	fclose(fp);
+	munmap(map, size);
 }
 
 /**
  * @brief
  * 		read version 1 usage file
  *
- * @param[in]	fp	-	the file pointer to the open file
+ * @param[in]	buf	-	the usage entries
+ * @param[in]	size	-	size of buf
  * @param[in]	root	-	root of the fairshare tree
  *
  * @return	int
@@ -752,35 +1157,17 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
  *
  */
 int
-read_usage_v1(FILE *fp, group_info *root)
+read_usage_v1(const char *buf, size_t size, group_info *root)
 {
 	struct group_node_usage_v1 grp;
-	group_info *ginfo;
-	struct group_path *gpath;
+	size_t off;
 
-	if (fp == NULL)
+	if (buf == NULL)
 		return 0;
 
-	while (fread(&grp, sizeof(struct group_node_usage_v1), 1, fp)) {
-		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
-			ginfo = find_alloc_ginfo(grp.name, root);
-			if (ginfo != NULL) {
-				ginfo->usage = grp.usage;
-				ginfo->temp_usage = grp.usage;
-				if (ginfo->child == NULL) {
-					gpath = ginfo->gpath;
-					/* add usage down the path from the root to our parent */
-					while (gpath->next != NULL) {
-						gpath->ginfo->usage += grp.usage;
-						gpath->ginfo->temp_usage += grp.usage;
-						gpath = gpath->next;
-					}
-				}
-			}
-		}
-		else
-			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
-				  "fairshare usage", "Invalid entity");
+	for (off = 0; off + sizeof(struct group_node_usage_v1) <= size; off += sizeof(struct group_node_usage_v1)) {
+		memcpy(&grp, buf + off, sizeof(struct group_node_usage_v1));
+		load_usage_entry(grp.name, grp.usage, NO_FLAGS, root);
 	}
 
 	return 1;
@@ -790,7 +1177,8 @@ read_usage_v1(FILE *fp, group_info *root)
  * @brief
  * 		read version 2 usage file
  *
- * @param[in]	fp	- the file pointer to the open file
+ * @param[in]	buf	- the usage entries
+ * @param[in]	size	- size of buf
  * @param[in]	flags	- flags to check whether to trim or not.
  * @param[in]	root	- root of the fairshare tree
  *
@@ -799,42 +1187,87 @@ read_usage_v1(FILE *fp, group_info *root)
  *
  */
 int
-read_usage_v2(FILE *fp, int flags, group_info *root)
+read_usage_v2(const char *buf, size_t size, int flags, group_info *root)
 {
 	struct group_node_usage_v2 grp;
+	size_t off;
+
+	if (buf == NULL)
+		return 0;
+
+	for (off = 0; off + sizeof(struct group_node_usage_v2) <= size; off += sizeof(struct group_node_usage_v2)) {
+		memcpy(&grp, buf + off, sizeof(struct group_node_usage_v2));
+		load_usage_entry(grp.name, grp.usage, flags, root);
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		read version 3 usage file and its journal.  Journal entries replace
+ * 		the file's entries of the same entity.  Each entry is decayed the
+ * 		number of times the tree was decayed since it was written.
+ *
+ * @param[in]	buf	- the usage entries
+ * @param[in]	size	- size of buf
+ * @param[in]	journal	- the usage journal file
+ * @param[in]	flags	- flags to check whether to trim or not.
+ * @param[in]	fhead	- the fairshare tree
+ *
+ *	@retval 1 success
+ *	@retval 0 failure
+ *
+ */
+int
+read_usage_v3(const char *buf, size_t size, const char *journal, int flags, fairshare_head *fhead)
+{
+	std::vector<struct group_node_usage_v3> entries;
+	std::unordered_map<std::string, size_t> pos;
+	struct group_node_usage_v3 grp;
+	struct group_node_header head;
 	group_info *ginfo;
-	struct group_path *gpath;
+	FILE *fp;
+	size_t off;
+	size_t i;
 
-	if (fp == NULL)
+	if (buf == NULL)
 		return 0;
 
-	while (fread(&grp, sizeof(struct group_node_usage_v2), 1, fp)) {
-		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
-			/* if we're trimming the tree, don't add any new nodes which are not
-			 * already in the resource_group file
-			 */
-			if (flags & FS_TRIM)
-				ginfo = find_group_info(grp.name, root);
-			else
-				ginfo = find_alloc_ginfo(grp.name, root);
-
-			if (ginfo != NULL) {
-				ginfo->usage = grp.usage;
-				ginfo->temp_usage = grp.usage;
-				if (ginfo->child == NULL) {
-					gpath = ginfo->gpath;
-					/* add usage down the path from the root to our parent */
-					while (gpath->next != NULL) {
-						gpath->ginfo->usage += grp.usage;
-						gpath->ginfo->temp_usage += grp.usage;
-						gpath = gpath->next;
-					}
+	for (off = 0; off + sizeof(struct group_node_usage_v3) <= size; off += sizeof(struct group_node_usage_v3)) {
+		memcpy(&grp, buf + off, sizeof(struct group_node_usage_v3));
+		grp.name[USAGE_NAME_MAX - 1] = '\0';
+		pos[grp.name] = entries.size();
+		entries.push_back(grp);
+	}
+
+	if (journal != NULL && (fp = fopen(journal, "rb")) != NULL) {
+		if (fread(&head, sizeof(struct group_node_header), 1, fp) == 1 &&
+			!strncmp(head.tag, USAGE_MAGIC, sizeof(head.tag)) && head.version == 3) {
+			while (fread(&grp, sizeof(struct group_node_usage_v3), 1, fp) == 1) {
+				grp.name[USAGE_NAME_MAX - 1] = '\0';
+				auto it = pos.find(grp.name);
+				if (it != pos.end())
+					entries[it->second] = grp;
+				else {
+					pos[grp.name] = entries.size();
+					entries.push_back(grp);
 				}
 			}
-		}
-		else
+		} else
 			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
-				  "fairshare usage", "Invalid entity");
+				  "fairshare usage", "Invalid usage journal header");
+		fclose(fp);
+	}
+
+	for (i = 0; i < entries.size(); i++) {
+		ginfo = load_usage_entry(entries[i].name,
+			decayed_usage(entries[i].usage, fhead->decays - entries[i].decays),
+			flags, fhead->root);
+		if (ginfo != NULL) {
+			ginfo->disk_usage = entries[i].usage;
+			ginfo->disk_decays = entries[i].decays;
+		}
 	}
 
 	return 1;
@@ -973,6 +1406,9 @@ dup_fairshare_tree(group_info *root, group_info *nparent)
 	nroot->usage = root->usage;
 	nroot->usage_factor = root->usage_factor;
 	nroot->temp_usage = root->temp_usage;
+	nroot->fs_rank = root->fs_rank;
+	nroot->disk_usage = root->disk_usage;
+	nroot->disk_decays = root->disk_decays;
 	nroot->name = string_dup(root->name);
 
 	if (nroot->name == NULL) {
@@ -1001,6 +1437,12 @@ free_fairshare_tree(group_info *root)
 	if (root == NULL)
 		return;
 
+	if (root->parent == NULL) {
+		lock_fairshare();
+		ginfo_indexes.erase(root);
+		unlock_fairshare();
+	}
+
 	free_fairshare_tree(root->sibling);
 	free_fairshare_tree(root->child);
 	free_fairshare_node(root);
@@ -1039,6 +1481,8 @@ new_fairshare_head()
 
 	fhead->root = NULL;
 	fhead->last_decay = 0;
+	fhead->decays = 0;
+	fhead->ranked_gen = 0;
 
 	return fhead;
 }
@@ -1056,6 +1500,7 @@ fairshare_head *
 dup_fairshare_head(fairshare_head *ofhead)
 {
 	fairshare_head *nfhead;
+	int ranked;
 
 	if (ofhead == NULL)
 		return NULL;
@@ -1065,8 +1510,13 @@ dup_fairshare_head(fairshare_head *ofhead)
 	if (nfhead == NULL)
 		return NULL;
 
+	ranked = (ofhead->ranked_gen == fairshare_gen);
 	nfhead->last_decay = ofhead->last_decay;
+	nfhead->decays = ofhead->decays;
 	nfhead->root = dup_fairshare_tree(ofhead->root, NULL);
+	/* dup_fairshare_tree() bumped the generation, the copied ranks still hold */
+	if (ranked)
+		nfhead->ranked_gen = fairshare_gen;
 	if (nfhead->root == NULL) {
 		free_fairshare_head(nfhead);
 		return NULL;
@@ -1106,6 +1556,7 @@ reset_temp_usage(group_info *head)
 	if (head == NULL)
 		return;
 
+	fairshare_gen++;
 	head->temp_usage = head->usage;
 	reset_temp_usage(head->sibling);
 	reset_temp_usage(head->child);
@@ -1172,8 +1623,69 @@ calc_usage_factor(fairshare_head *tree)
 void reset_usage(group_info *node) {
 	if(node == NULL)
 		return;
+	fairshare_gen++;
 	reset_usage(node->sibling);
 	reset_usage(node->child);
 	node->usage = 1;
 	node->temp_usage = 1;
+	node->disk_usage = 1;
+	node->disk_decays = 0;
+}
+
+/**
+ * @brief
+ *		qsort() helper to order fairshare tree nodes with compare_path()
+ */
+static int
+cmp_ginfo_path(const void *v1, const void *v2)
+{
+	return compare_path((*(group_info **) v1)->gpath, (*(group_info **) v2)->gpath);
+}
+
+/**
+ * @brief
+ *		add a fairshare tree and its siblings to an array of nodes
+ */
+static void
+collect_fairshare_tree(std::vector<group_info *> &nodes, group_info *root)
+{
+	if (root == NULL)
+		return;
+
+	nodes.push_back(root);
+	collect_fairshare_tree(nodes, root->sibling);
+	collect_fairshare_tree(nodes, root->child);
+}
+
+/**
+ * @brief
+ *		set the fs_rank of every node of a fairshare tree, so two entities
+ *		compare the same by fs_rank as by compare_path() on their paths.
+ *		This turns a path walk per job comparison into one tree sort each
+ *		time the usage changes.  Nothing is done if the ranks are current.
+ *
+ * @param[in,out]	fhead	-	fairshare tree to rank
+ *
+ * @return void
+ */
+void
+rank_fairshare_tree(fairshare_head *fhead)
+{
+	std::vector<group_info *> nodes;
+	size_t i;
+	int rank = 0;
+
+	if (fhead == NULL || fhead->root == NULL || fhead->ranked_gen == fairshare_gen)
+		return;
+
+	collect_fairshare_tree(nodes, fhead->root);
+	qsort(nodes.data(), nodes.size(), sizeof(group_info *), cmp_ginfo_path);
+
+	for (i = 0; i < nodes.size(); i++) {
+		if (i > 0 && cmp_ginfo_path(&nodes[i - 1], &nodes[i]) != 0)
+			rank++;
+		nodes[i]->fs_rank = rank;
+	}
+
+	fhead->ranked_gen = fairshare_gen;
 }
@@ -143,7 +143,13 @@ int write_usage(const char *filename, fairshare_head *fhead);
  *      rec_write_usage - recursive helper function which will write out all
  *                        the group_info structs of the resgroup tree
  */
-void rec_write_usage(group_info *root, FILE *fp);
+void rec_write_usage(group_info *root, FILE *fp, long decays);
+
+/*
+ *      sync_usage - bring the usage file up to date by journaling the
+ *                   entities whose usage changed
+ */
+int sync_usage(const char *filename, fairshare_head *fhead);
 
 /*
  *      read_usage - read the usage information and load it into the
@@ -154,12 +160,17 @@ void read_usage(const char *filename, int flags, fairshare_head *fhead);
 /*
  *      read_usage_v1 - read version 1 usage file
  */
-int read_usage_v1(FILE *fp, group_info *root);
+int read_usage_v1(const char *buf, size_t size, group_info *root);
 
 /*
  *      read_usage_v2 - read version 2 usage file
  */
-int read_usage_v2(FILE *fp, int flags, group_info *root);
+int read_usage_v2(const char *buf, size_t size, int flags, group_info *root);
+
+/*
+ *      read_usage_v3 - read version 3 usage file and its journal
+ */
+int read_usage_v3(const char *buf, size_t size, const char *journal, int flags, fairshare_head *fhead);
 
 /*
  *      new_group_path - create a new group_path structure and init it
@@ -265,6 +276,9 @@ void reset_usage(group_info *node);
 /* Calculate the arbitrary usage of the tree */
 void calc_usage_factor(fairshare_head *tree);
 
+/* order the fairshare tree for cmp_fairshare() */
+void rank_fairshare_tree(fairshare_head *fhead);
+
 
 
 #ifdef	__cplusplus
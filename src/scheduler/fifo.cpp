@@ -93,6 +93,9 @@
 #include "pbs_version.h"
 #include "buckets.h"
 #include "multi_threading.h"
+#include "profile.h"
+#include "decision_trace.h"
+#include "cycle_capture.h"
 #include "pbs_python.h"
 #include "libpbs.h"
 
@@ -102,7 +105,9 @@
 
 /* a list of running jobs from the last scheduling cycle */
 static prev_job_info *last_running = NULL;
-static int last_running_size = 0;
+
+/* pipelined run job requests whose replies have not been collected */
+static int pipelined_runjobs = 0;
 
 /**
  * @brief
@@ -209,6 +214,13 @@ schedinit(int nthreads)
 					  "", "Error initializing pthreads");
 			return -1;
 		}
+	} else if (num_threads > 1 && conf.pin_threads != threads_pinned) {
+		/* workers are pinned when they are launched */
+		if (init_multi_threading(num_threads) != 1) {
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
+					  "", "Error initializing pthreads");
+			return -1;
+		}
 	}
 
 	return 0;
@@ -256,6 +268,7 @@ update_cycle_status(struct status *policy, time_t current_time)
 		conf.ded_time[0].from = 0;
 		conf.ded_time[0].to = 0;
 		qsort(conf.ded_time, MAX_DEDTIME_SIZE, sizeof(struct timegap), cmp_ded_time);
+		index_ded_time();
 	}
 	policy->is_ded_time = dedtime;
 
@@ -274,6 +287,7 @@ update_cycle_status(struct status *policy, time_t current_time)
 			log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_FILE, LOG_NOTICE,
 				  HOLIDAYS_FILE, "The holiday file is out of date; please update it.");
 	}
+	cache_prime_transitions(policy->current_time);
 	policy->prime_status_end = end_prime_status(policy->current_time);
 
 	primetime = prime == PRIME ? "primetime" : "non-primetime";
@@ -320,13 +334,12 @@ update_cycle_status(struct status *policy, time_t current_time)
 int
 init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 {
-	group_info *user = NULL;	/* the user for the running jobs of the last cycle */
 	char decayed = 0;		/* boolean: have we decayed usage? */
 	time_t t;			/* used in decaying fair share */
 	usage_t delta;			/* the usage between last sch cycle and now */
 	struct group_path *gpath;	/* used to update usage with delta */
 	static schd_error *err;
-	int i, j;
+	int i;
 
 	if (err == NULL) {
 		err = new_schd_error();
@@ -351,33 +364,22 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 			 * one and calculate a new value
 			 */
 
-			for (i = 0; i < last_running_size ; i++) {
-				if (last_running[i].name != NULL) {
-					user = find_alloc_ginfo(last_running[i].entity_name,
-								sinfo->fairshare->root);
-
-					if (user != NULL) {
-						for (j = 0; sinfo->running_jobs[j] != NULL &&
-						     strcmp(last_running[i].name, sinfo->running_jobs[j]->name); j++)
-							;
+			for (i = 0; sinfo->running_jobs[i] != NULL; i++) {
+				resource_resv *rjob = sinfo->running_jobs[i];
+				sch_resource_t last_usage;
 
-						if (sinfo->running_jobs[j] != NULL &&
-							sinfo->running_jobs[j]->job != NULL) {
-							/* just in case the delta is negative just add 0 */
-							delta = formula_evaluate(conf.fairshare_res, sinfo->running_jobs[j], sinfo->running_jobs[j]->job->resused) -
-								formula_evaluate(conf.fairshare_res, sinfo->running_jobs[j], last_running[i].resused);
+				if (rjob->job == NULL || rjob->job->ginfo == NULL)
+					continue;
+				if (!find_prev_job_usage(last_running, rjob->name, &last_usage))
+					continue;
 
-							delta = IF_NEG_THEN_ZERO(delta);
+				/* just in case the delta is negative just add 0 */
+				delta = formula_evaluate(conf.fairshare_res, rjob, rjob->job->resused) - last_usage;
+				delta = IF_NEG_THEN_ZERO(delta);
 
-							gpath = user->gpath;
-							while (gpath != NULL) {
-								gpath->ginfo->usage += delta;
-								gpath = gpath->next;
-							}
-							resort = 1;
-						}
-					}
-				}
+				for (gpath = rjob->job->ginfo->gpath; gpath != NULL; gpath = gpath->next)
+					gpath->ginfo->usage += delta;
+				resort = 1;
 			}
 		}
 
@@ -391,8 +393,10 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 			(t - sinfo->fairshare->last_decay) > conf.decay_time) {
 			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 				  "Fairshare", "Decaying Fairshare Tree");
-			if (conf.fairshare != NULL)
+			if (conf.fairshare != NULL) {
 				decay_fairshare_tree(sinfo->fairshare->root);
+				sinfo->fairshare->decays++;
+			}
 			t -= conf.decay_time;
 			decayed = 1;
 			resort = 1;
@@ -406,7 +410,7 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 		}
 
 		if (policy->sync_fairshare_files && (decayed || last_running != NULL)) {
-			write_usage(USAGE_FILE, sinfo->fairshare);
+			sync_usage(USAGE_FILE, sinfo->fairshare);
 			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 				  "Fairshare", "Usage Sync");
 		}
@@ -559,7 +563,16 @@ intermediate_schedule(int sd, const sched_cmd *cmd)
 	int cycle_cnt = 0; /* count of cycles run */
 
 	do {
+		int capture = 0;
+
+		if (conf.cycle_capture_file != NULL)
+			capture = capture_start(sd, conf.cycle_capture_file);
+		prof_start_cycle();
+		trace_start_cycle(time(NULL));
 		ret = scheduling_cycle(sd, cmd);
+		prof_end_cycle(sd);
+		if (capture)
+			capture_end();
 
 		/* don't restart cycle if :- */
 
@@ -609,6 +622,7 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	int error = 0;			/* error happened, don't run main loop */
 	status *policy;			/* policy structure used for cycle */
 	schd_error *err = NULL;
+	double prof;
 
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		  "", "Starting Scheduling Cycle");
@@ -619,14 +633,17 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	else
 		send_job_attr_updates = 0;
 
-	update_cycle_status(&cstat, 0);
+	update_cycle_status(&cstat, replay_time);
 
 #ifdef NAS /* localmod 030 */
 	do_soft_cycle_interrupt = 0;
 	do_hard_cycle_interrupt = 0;
 #endif /* localmod 030 */
 	/* create the server / queue / job / node structures */
-	if ((sinfo = query_server(&cstat, sd)) == NULL) {
+	prof = prof_start();
+	sinfo = query_server(&cstat, sd);
+	prof_stop(PROF_QUERY, prof);
+	if (sinfo == NULL) {
 		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
 			  "", "Problem with creating server data structure");
 		end_cycle_tasks(sinfo);
@@ -763,7 +780,13 @@ get_high_prio_cmd(int *is_conn_lost, sched_cmd *high_prior_cmd)
 	int i;
 	sched_cmd cmd;
 	int num_conf_servers = get_num_servers();
-	svr_conn_t *svr_conns = static_cast<svr_conn_t *>(get_conn_svr_instances(clust_secondary_sock));
+	svr_conn_t *svr_conns;
+
+	/* not connected to the servers (replaying a cycle) */
+	if (clust_secondary_sock < 0)
+		return 0;
+
+	svr_conns = static_cast<svr_conn_t *>(get_conn_svr_instances(clust_secondary_sock));
 
 	for (i = 0; i < num_conf_servers; i++) {
 		int rc;
@@ -803,6 +826,77 @@ get_high_prio_cmd(int *is_conn_lost, sched_cmd *high_prior_cmd)
 	return 0;
 }
 
+/**
+ * @brief
+ * 		run further subjobs of an array, one after the other, for as long
+ *		as they fit.  The subjobs of an array are identical, so once one
+ *		of them ran, the array is what next_job() would hand back again.
+ *		Placing them here saves going around the main loop for each, and
+ *		their runs reach the server together through queue_subjob_run().
+ *
+ * @par
+ * 		Only done when running a subjob can not change which job comes
+ *		next: no fairshare, soft limits or round robin, and not for a qrun
+ *		or for an array in a reservation.  Stops at the first subjob which
+ *		does not fit, leaving it to the main loop to deal with.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sd	-	primary socket descriptor to the server pool
+ * @param[in]	sinfo	-	server the array is on
+ * @param[in]	qinfo	-	queue the array is in
+ * @param[in]	array	-	the array a subjob of which was just run
+ * @param[in]	flags	-	flags to pass to is_ok_to_run()
+ * @param[in]	max_run	-	most subjobs to run
+ * @param[in]	end_time -	time the scheduling cycle has to end
+ * @param[out]	err	-	error struct, cleared on return
+ *
+ * @return	int
+ * @retval	number of subjobs run
+ */
+static int
+run_array_subjobs(status *policy, int sd, server_info *sinfo, queue_info *qinfo,
+	resource_resv *array, unsigned int flags, int max_run, time_t end_time,
+	schd_error *err)
+{
+	int num_run = 0;
+
+	if (policy->fair_share || policy->round_robin || sinfo->has_soft_limit ||
+		qinfo->has_soft_limit || sinfo->qrun_job != NULL ||
+		array->job->resv != NULL || array->is_shrink_to_fit)
+		return 0;
+
+	while (num_run < max_run && in_runnable_state(array) && !array->can_not_run &&
+		pipelined_runjobs < MAX_PIPELINED_RUNJOBS && !got_sigpipe &&
+		time(NULL) < end_time) {
+		nspec **ns_arr;
+		resource_resv *tj;
+		double prof;
+
+		clear_schd_error(err);
+		prof = prof_start();
+		ns_arr = is_ok_to_run(policy, sinfo, qinfo, array, flags, err);
+		prof_stop(PROF_EVAL, prof);
+		if (ns_arr == NULL)
+			break;
+
+		tj = queue_subjob(array, sinfo, qinfo);
+		if (tj == NULL) {
+			free_nspecs(ns_arr);
+			break;
+		}
+		if (run_update_resresv(policy, sd, sinfo, qinfo, tj, ns_arr, RURR_ADD_END_EVENT, err) <= 0)
+			break;
+		num_run++;
+	}
+	clear_schd_error(err);
+
+	if (num_run > 0)
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, array->name,
+			"Ran %d more subjobs of the array in one pass", num_run);
+
+	return num_run;
+}
+
 /**
  * @brief
  * 		the main scheduler loop
@@ -872,6 +966,8 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		(njob = next_job(policy, sinfo, sort_again)) != NULL; i++) {
 		int should_use_buckets;		/* Should use node buckets for a job */
 		unsigned int flags = NO_FLAGS;	/* flags to is_ok_to_run @see is_ok_to_run() */
+		double prof;
+		double considered = prof_start();	/* when the job started being considered */
 
 #ifdef NAS /* localmod 030 */
 		if (check_for_cycle_interrupt(1)) {
@@ -894,11 +990,23 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		if(should_use_buckets)
 			flags = USE_BUCKETS;
 
-		if (njob->is_shrink_to_fit) {
-			/* Pass the suitable heuristic for shrinking */
-			ns_arr = is_ok_to_run_STF(policy, sinfo, qinfo, njob, flags, err, shrink_job_algorithm);
-		} else
-			ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+		for (;;) {
+			prof = prof_start();
+			if (njob->is_shrink_to_fit) {
+				/* Pass the suitable heuristic for shrinking */
+				ns_arr = is_ok_to_run_STF(policy, sinfo, qinfo, njob, flags, err, shrink_job_algorithm);
+			} else
+				ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+			prof_stop(PROF_EVAL, prof);
+
+			/* The job may only be blocked by pipelined jobs the server refused
+			 * to run.  Find out before acting on the failure.
+			 */
+			if (ns_arr != NULL || pipelined_runjobs == 0 ||
+				collect_run_job_replies(policy, sd, sinfo) <= 0)
+				break;
+			clear_schd_error(err);
+		}
 
 		if (err->status_code == NEVER_RUN)
 			njob->can_never_run = 1;
@@ -917,6 +1025,16 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 			if (rc != SCHD_ERROR) {
 				if(run_update_resresv(policy, sd, sinfo, qinfo, tj, ns_arr, RURR_ADD_END_EVENT, err) > 0 ) {
 					rc = SUCCESS;
+					if (njob->job->is_array) {
+						int max_run = MAX_BATCHED_SUBJOB_RUNS - 1;
+
+						/* each subjob counts as a job checked */
+						if (conf.max_jobs_to_check != SCHD_INFINITY &&
+							conf.max_jobs_to_check - (i + 1) < max_run)
+							max_run = conf.max_jobs_to_check - (i + 1);
+						i += run_array_subjobs(policy, sd, sinfo, qinfo, njob, flags,
+							max_run, cycle_end_time, err);
+					}
 					if (sinfo->has_soft_limit || qinfo->has_soft_limit)
 						sort_again = MUST_RESORT_JOBS;
 					else
@@ -932,12 +1050,14 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				free_nspecs(ns_arr);
 		}
 		else if (policy->preempting && in_runnable_state(njob) && (!njob -> can_never_run)) {
+			prof = prof_start();
 			if (find_and_preempt_jobs(policy, sd, njob, sinfo, err) > 0) {
 				rc = SUCCESS;
 				sort_again = MUST_RESORT_JOBS;
 			}
 			else
 				sort_again = SORTED;
+			prof_stop(PROF_PREEMPT, prof);
 		}
 
 #ifdef NAS /* localmod 034 */
@@ -949,6 +1069,11 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		}
 #endif /* localmod 034 */
 
+		/* don't let the replies of pipelined run job requests pile up */
+		if (pipelined_runjobs >= MAX_PIPELINED_RUNJOBS &&
+			collect_run_job_replies(policy, sd, sinfo) < 0)
+			rc = PBSE_PROTOCOL;
+
 		/* if run_update_resresv() returns an error, it's generally pretty serious.
 		 * lets bail out of the cycle now
 		 */
@@ -964,7 +1089,9 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 #else
 			if (should_backfill_with_job(policy, sinfo, njob, num_topjobs) != 0) {
 #endif
+				prof = prof_start();
 				cal_rc = add_job_to_calendar(sd, policy, sinfo, njob, should_use_buckets);
+				prof_stop(PROF_CALENDAR, prof);
 
 				if (cal_rc > 0) { /* Success! */
 #ifdef NAS /* localmod 034 */
@@ -1050,10 +1177,13 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				if (rc != RUN_FAILURE &&  !ec->can_not_run) {
 					ec->can_not_run = 1;
 					ec->err = dup_schd_error(err);
+					save_resresv_set_failure(sinfo, ec);
 				}
 			}
 		}
 
+		trace_job(njob->name, rc == SUCCESS, err, prof_start() - considered);
+
 		if (njob->can_never_run) {
 			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_WARNING,
 				njob->name, "Job will never run with the resources currently configured in the complex");
@@ -1124,6 +1254,10 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		send_job_updates(sd, njob);
 	}
 
+	/* whatever runs after the loop needs to know which jobs really ran */
+	collect_run_job_replies(policy, sd, sinfo);
+	flush_job_updates();
+
 	*rerr = err;
 
 	free_schd_error(chk_lim_err);
@@ -1185,10 +1319,14 @@ end_cycle_tasks(server_info *sinfo)
 	/* we copied in conf.fairshare into sinfo at the start of the cycle,
 	 * we don't want to free it now, or we'd lose all fairshare data
 	 */
+	/* send whatever job attribute updates are still queued */
+	flush_job_updates();
+
 	if (sinfo != NULL) {
 		sinfo->fairshare = NULL;
 		free_server(sinfo);	/* free server and queues and jobs */
 	}
+	free_interned_specs();
 
 	/* close any open connections to peers */
 	for (i = 0; (i < NUM_PEERS) &&
@@ -1227,11 +1365,9 @@ end_cycle_tasks(server_info *sinfo)
 int
 update_last_running(server_info *sinfo)
 {
-	free_pjobs(last_running, last_running_size);
+	free_prev_job_info(last_running);
 
-	last_running = create_prev_job_info(sinfo->running_jobs,
-		sinfo->sc.running);
-	last_running_size = sinfo->sc.running;
+	last_running = create_prev_job_info(sinfo->running_jobs);
 
 	if (last_running == NULL)
 		return 0;
@@ -1247,9 +1383,8 @@ update_last_running(server_info *sinfo)
 void
 clear_last_running()
 {
-	free_pjobs(last_running, last_running_size);
+	free_prev_job_info(last_running);
 	last_running = NULL;
-	last_running_size = 0;
 }
 
 /**
@@ -1322,12 +1457,138 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
 int
 send_run_job(int pbs_sd, int has_runjob_hook, char *jobid, char *execvnode)
 {
+	double prof = prof_start();
+	int rc;
+
+	/* a comment queued for the job must not land after the run's own */
+	flush_job_updates();
+
 	if (sc_attrs.runjob_mode == RJ_EXECJOB_HOOK)
-		return pbs_runjob(pbs_sd, jobid, execvnode, NULL);
+		rc = pbs_runjob(pbs_sd, jobid, execvnode, NULL);
 	else if ((sc_attrs.runjob_mode == RJ_RUNJOB_HOOK) && has_runjob_hook)
-		return pbs_asyrunjob_ack(pbs_sd, jobid, execvnode, NULL);
+		rc = pbs_asyrunjob_ack(pbs_sd, jobid, execvnode, NULL);
 	else
-		return pbs_asyrunjob(pbs_sd, jobid, execvnode, NULL);
+		rc = pbs_asyrunjob(pbs_sd, jobid, execvnode, NULL);
+
+	prof_stop(PROF_RUN_JOB, prof);
+	return rc;
+}
+
+/**
+ * @brief	Send a run job request to the server without waiting for its ack.
+ *		The job is treated as running until collect_run_job_replies()
+ *		says otherwise.  In execjob_hook mode the ack only comes once
+ *		the job reached its Mother Superior; the server keeps our
+ *		replies in order, so they are collected the same way.
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	jobid	-	id of the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ *
+ * @return	int
+ * @retval	return value of pbs_asyrunjob_pipe() or pbs_runjob_pipe()
+ */
+int
+send_pipelined_run_job(int pbs_sd, char *jobid, char *execvnode)
+{
+	double prof = prof_start();
+	int rc;
+
+	flush_job_updates();
+
+	if (sc_attrs.runjob_mode == RJ_EXECJOB_HOOK)
+		rc = pbs_runjob_pipe(pbs_sd, jobid, execvnode, NULL);
+	else
+		rc = pbs_asyrunjob_pipe(pbs_sd, jobid, execvnode, NULL);
+	if (rc == 0)
+		pipelined_runjobs++;
+
+	prof_stop(PROF_RUN_JOB, prof);
+	return rc;
+}
+
+/**
+ * @brief	Wait for the replies of the pipelined run job requests sent since
+ *		the last call.  Jobs the server refused to run are put back
+ *		into the queued state in our universe and marked can_not_run.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	sinfo	-	server the jobs were run in
+ *
+ * @return	int
+ * @retval	number of jobs which failed to run
+ * @retval	-1	: protocol error, the connection to the server is unusable
+ */
+int
+collect_run_job_replies(status *policy, int pbs_sd, server_info *sinfo)
+{
+	struct batch_runjob_status *failed;
+	struct batch_runjob_status *fs;
+	schd_error *err;
+	char comment[MAX_LOG_SIZE];
+	char log_msg[MAX_LOG_SIZE];
+	char buf[MAX_LOG_SIZE];
+	double prof;
+	int num_failed = 0;
+	int rc;
+
+	if (pipelined_runjobs == 0)
+		return 0;
+	pipelined_runjobs = 0;
+
+	prof = prof_start();
+	failed = pbs_asyrunjob_replies(pbs_sd);
+	rc = pbs_errno;
+	prof_stop(PROF_RUN_JOB, prof);
+
+	if (failed == NULL)
+		return (rc == PBSE_PROTOCOL) ? -1 : 0;
+
+	err = new_schd_error();
+	if (err == NULL) {
+		pbs_runjobstatfree(failed);
+		return -1;
+	}
+
+	for (fs = failed; fs != NULL; fs = fs->next) {
+		resource_resv *rr;
+
+		rr = find_resource_resv(sinfo->all_resresv, fs->name);
+		if (rr == NULL || !rr->is_job || !rr->job->is_running)
+			continue;
+
+		update_universe_on_end(policy, rr, "Q", NO_FLAGS);
+		rr->can_not_run = 1;
+		if (rr->job->parent_job != NULL)
+			rr->job->parent_job->can_not_run = 1;
+		num_failed++;
+
+		clear_schd_error(err);
+		set_schd_error_codes(err, NOT_RUN, RUN_FAILURE);
+		set_schd_error_arg(err, ARG1, fs->text != NULL ? fs->text : "");
+		snprintf(buf, sizeof(buf), "%d", fs->code);
+		set_schd_error_arg(err, ARG2, buf);
+#ifdef NAS /* localmod 031 */
+		set_schd_error_arg(err, ARG3, rr->name);
+#endif /* localmod 031 */
+
+		comment[0] = '\0';
+		log_msg[0] = '\0';
+		translate_fail_code(err, comment, log_msg);
+		if (comment[0] != '\0')
+			update_job_comment(pbs_sd, rr, comment);
+		if (log_msg[0] != '\0')
+			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, rr->name, log_msg);
+		send_job_updates(pbs_sd, rr);
+	}
+
+	free_schd_error(err);
+	pbs_runjobstatfree(failed);
+
+	if (rc == PBSE_PROTOCOL)
+		return -1;
+	return num_failed;
 }
 
 /**
@@ -1352,10 +1613,28 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int has_runjob_hook, s
 	char buf[100];	/* used to assemble queue@localserver */
 	const char *errbuf;		/* comes from pbs_geterrmsg() */
 	int rc = 0;
+	int pipeline;
+	int batch;
 
 	if (rjob == NULL || rjob->job == NULL || err == NULL)
 		return -1;
 
+	/* The runjob hook's verdict, or in execjob_hook mode whether the job
+	 * started on its Mother Superior, is only needed before the end of the
+	 * cycle.  The exception is a qrun request, which waits on whether the
+	 * job ran.
+	 */
+	pipeline = (((sc_attrs.runjob_mode == RJ_RUNJOB_HOOK) && has_runjob_hook) ||
+		    (sc_attrs.runjob_mode == RJ_EXECJOB_HOOK)) &&
+		   rjob->server->qrun_job == NULL;
+
+	/* Nothing is heard back from a plain async run, so the runs of the
+	 * subjobs of an array can go to the server together.
+	 */
+	batch = !pipeline && rjob->job->is_subjob && rjob->server->qrun_job == NULL &&
+		(sc_attrs.runjob_mode != RJ_EXECJOB_HOOK) &&
+		!((sc_attrs.runjob_mode == RJ_RUNJOB_HOOK) && has_runjob_hook);
+
 	/* Server most likely crashed */
 	if (got_sigpipe) {
 		set_schd_error_codes(err, NEVER_RUN, SCHD_ERROR);
@@ -1400,9 +1679,18 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int has_runjob_hook, s
 				if (strlen(timebuf) > 0)
 					log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, rjob->name,
 						"Job will run for duration=%s", timebuf);
-				rc = send_run_job(pbs_sd, has_runjob_hook, rjob->name, execvnode);
+				if (pipeline)
+					rc = send_pipelined_run_job(pbs_sd, rjob->name, execvnode);
+				else if (batch)
+					rc = queue_subjob_run(pbs_sd, rjob, execvnode);
+				else
+					rc = send_run_job(pbs_sd, has_runjob_hook, rjob->name, execvnode);
 			}
-		} else
+		} else if (pipeline)
+			rc = send_pipelined_run_job(pbs_sd, rjob->name, execvnode);
+		else if (batch)
+			rc = queue_subjob_run(pbs_sd, rjob, execvnode);
+		else
 			rc = send_run_job(pbs_sd, has_runjob_hook, rjob->name, execvnode);
 	}
 
@@ -1738,33 +2026,27 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 		}
 
 		if (ns != NULL) {
-			int sort_nodepart = 0;
-			for (i = 0; ns[i] != NULL; i++) {
-				int j;
+			int sort_nodepart;
+
+			for (i = 0; ns[i] != NULL; i++)
 				update_node_on_run(ns[i], rr, &old_state);
-				if (ns[i]->ninfo->np_arr != NULL) {
-					node_partition **npar = ns[i]->ninfo->np_arr;
-					for (j = 0; npar[j] != NULL; j++) {
-						modify_resource_list(npar[j]->res, ns[i]->resreq, SCHD_INCR);
-						if (!ns[i]->ninfo->is_free)
-							npar[j]->free_nodes--;
-						sort_nodepart = 1;
-						update_buckets_for_node(npar[j]->bkts, ns[i]->ninfo);
-					}
-				}
-				/* if the node is being provisioned, it's brought down in
-				 * update_node_on_run().  We need to add an event in the calendar to
-				 * bring it back up.
-				 */
-				if (ns[i]->go_provision) {
-					if (add_prov_event(sinfo->calendar, sinfo->server_time + PROVISION_DURATION, ns[i]->ninfo) == 0) {
-						set_schd_error_codes(err, NOT_RUN, SCHD_ERROR);
-						return -1;
-					}
-				}
+
+			sort_nodepart = update_nodepart_on_run(ns);
+			if (sort_nodepart == -1) {
+				set_schd_error_codes(err, NOT_RUN, SCHD_ERROR);
+				return -1;
 			}
 			if (sort_nodepart)
 				sort_all_nodepart(policy, sinfo);
+
+			/* the nodes being provisioned are brought down in update_node_on_run().
+			 * Add the events to the calendar to bring them back up.
+			 */
+			if (rr->aoename != NULL &&
+				add_prov_events(sinfo->calendar, sinfo->server_time + PROVISION_DURATION, ns) == 0) {
+				set_schd_error_codes(err, NOT_RUN, SCHD_ERROR);
+				return -1;
+			}
 		}
 
 		update_queue_on_run(qinfo, rr, &old_state);
@@ -2478,6 +2760,13 @@ next_job(status *policy, server_info *sinfo, int flag)
 		}
 	} else { /* treat the entire system as one large queue */
 		ind = find_runnable_resresv_ind(sinfo->jobs, last_job_index);
+		/* sort_jobs() only sorted the front of the jobs, sort more of them
+		 * until the next runnable job is in the sorted part
+		 */
+		while (ind >= sinfo->jobs_sorted) {
+			sinfo->jobs_sorted = sort_jobs_prefix(sinfo->jobs, sinfo->jobs_sorted);
+			ind = find_runnable_resresv_ind(sinfo->jobs, last_job_index);
+		}
 		if(ind != -1) {
 			rjob = sinfo->jobs[ind];
 			last_job_index = ind;
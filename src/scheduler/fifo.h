@@ -260,6 +260,14 @@ void clear_last_running();
 
 int send_run_job(int pbs_sd, int has_runjob_hook, char *jobid, char *execvnode);
 
+int send_pipelined_run_job(int pbs_sd, char *jobid, char *execvnode);
+
+/*
+ *	collect_run_job_replies - wait for the replies of pipelined run job
+ *		requests and undo the run of the jobs the server rejected
+ */
+int collect_run_job_replies(status *policy, int pbs_sd, server_info *sinfo);
+
 #ifdef	__cplusplus
 }
 #endif
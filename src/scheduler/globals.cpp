@@ -159,6 +159,7 @@ ds_queue *result_queue = NULL;
 pthread_t *threads = NULL;
 int threads_die = 0;
 int num_threads = 0;
+int threads_pinned = 0;
 pthread_key_t th_id_key;
 pthread_once_t key_once = PTHREAD_ONCE_INIT;
 
@@ -188,6 +189,8 @@ time_t last_attr_updates = 0;
 
 int send_job_attr_updates = 1;
 
+time_t replay_time = 0;
+
 /* primary socket descriptor to the server pool */
 int clust_primary_sock = -1;
 
@@ -96,6 +96,7 @@ extern ds_queue *result_queue;
 extern pthread_t *threads;
 extern int threads_die;
 extern int num_threads;
+extern int threads_pinned;
 extern pthread_key_t th_id_key;
 extern pthread_once_t key_once;
 
@@ -117,6 +118,8 @@ extern time_t last_attr_updates;    /* timestamp of the last time attr updates w
 
 extern int send_job_attr_updates;
 
+extern time_t replay_time;	/* time a replayed cycle runs at, 0 for now */
+
 extern int clust_primary_sock;
 
 extern int clust_secondary_sock;
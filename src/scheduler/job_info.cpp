@@ -44,6 +44,8 @@
  * 		job_info.c - This file contains functions related to job_info structure.
  *
  * Functions included are:
+ * 	prefetch_jobs()
+ * 	discard_prefetched_jobs()
  * 	query_jobs()
  * 	query_job()
  * 	new_job_info()
@@ -51,6 +53,9 @@
  * 	set_job_state()
  * 	update_job_attr()
  * 	send_job_updates()
+ * 	flush_job_updates()
+ * 	queue_subjob_run()
+ * 	flush_subjob_runs()
  * 	send_attr_updates()
  * 	unset_job_attr()
  * 	update_job_comment()
@@ -61,6 +66,8 @@
  * 	get_preemption_order()
  * 	preempt_job()
  * 	find_and_preempt_jobs()
+ * 	preempt_ordered_running_jobs()
+ * 	order_running_jobs_for_preemption()
  * 	find_jobs_to_preempt()
  * 	select_index_to_preempt()
  * 	preempt_level()
@@ -71,6 +78,9 @@
  * 	is_job_array()
  * 	modify_job_array_for_qrun()
  * 	queue_subjob()
+ * 	compile_formula()
+ * 	run_formula()
+ * 	clear_formula_cache()
  * 	formula_evaluate()
  * 	make_eligible()
  * 	make_ineligible()
@@ -91,6 +101,9 @@
 #include <Python.h>
 #endif
 
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -99,6 +112,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <math.h>
+#include <ctype.h>
 #include <pbs_ifl.h>
 #include <log.h>
 #include <libutil.h>
@@ -125,6 +139,7 @@
 #include "server_info.h"
 #include "attribute.h"
 #include "multi_threading.h"
+#include "profile.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -134,6 +149,21 @@
 
 extern char *pbse_to_txt(int err);
 
+/* job attribute updates waiting to be sent by flush_job_updates() */
+static struct batch_status *pending_updates = NULL;
+static struct batch_status *pending_updates_tail = NULL;
+static int num_pending_updates = 0;
+static int pending_updates_sd = -1;
+
+/* subjob runs waiting to be sent by flush_subjob_runs(), all of one array */
+static char *pending_runs_array = NULL;
+static int pending_runs_idx[MAX_BATCHED_SUBJOB_RUNS];
+static char *pending_runs_dest[MAX_BATCHED_SUBJOB_RUNS];
+static int num_pending_runs = 0;
+static int pending_runs_sd = -1;
+
+static int send_pending_updates(void);
+
 /**
  *	This table contains job comment and information messages that correspond
  *	to the sched_error_code enums in "constant.h".  The order of the strings in
@@ -883,6 +913,162 @@ alloc_tdata_jquery(status *policy, int pbs_sd, struct batch_status *jobs, queue_
 	return tdata;
 }
 
+/* tags of the job queries sent ahead by prefetch_jobs(), by queue name */
+static std::unordered_map<std::string, unsigned int> jobs_prefetched;
+
+/* replies to prefetched job queries read while waiting for another one */
+static std::unordered_map<unsigned int, struct batch_async_status *> jobs_replied;
+
+/**
+ * @brief
+ * 		the attributes the scheduler asks for when it queries jobs
+ *
+ * @return	attrl list, kept for the life of the scheduler
+ */
+static struct attrl *
+job_query_attrs(void)
+{
+	static struct attrl *attrib = NULL;
+	int i;
+
+	const char *jobattrs[] = {
+			ATTR_p,
+			ATTR_qtime,
+			ATTR_qrank,
+			ATTR_etime,
+			ATTR_stime,
+			ATTR_N,
+			ATTR_state,
+			ATTR_substate,
+			ATTR_sched_preempted,
+			ATTR_comment,
+			ATTR_released,
+			ATTR_euser,
+			ATTR_egroup,
+			ATTR_project,
+			ATTR_resv_ID,
+			ATTR_altid,
+			ATTR_SchedSelect,
+			ATTR_array_id,
+			ATTR_node_set,
+			ATTR_array,
+			ATTR_array_index,
+			ATTR_topjob_ineligible,
+			ATTR_array_indices_remaining,
+			ATTR_execvnode,
+			ATTR_l,
+			ATTR_rel_list,
+			ATTR_used,
+			ATTR_accrue_type,
+			ATTR_eligible_time,
+			ATTR_estimated,
+			ATTR_c,
+			ATTR_r,
+			ATTR_depend,
+			ATTR_A,
+			ATTR_max_run_subjobs,
+			NULL
+	};
+
+	if (attrib == NULL) {
+		for (i = 0; jobattrs[i] != NULL; i++) {
+			struct attrl *temp_attrl = NULL;
+
+			temp_attrl = new_attrl();
+			temp_attrl->name = strdup(jobattrs[i]);
+			temp_attrl->next = attrib;
+			temp_attrl->value = const_cast<char *>("");
+			attrib = temp_attrl;
+		}
+	}
+	return attrib;
+}
+
+/**
+ * @brief
+ * 		ask for the jobs of a queue ahead of query_jobs().  The query is
+ *		sent as a tagged request so the queries of all the queues of a
+ *		cycle are in flight at once, and the server answers the next one
+ *		while we turn the jobs of the last one into job_info structures.
+ *		If the request can not be sent, query_jobs() asks for the jobs
+ *		itself.
+ *
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ * @param[in]	queue_name	-	the local queue to ask for the jobs of
+ *
+ * @return	void
+ */
+void
+prefetch_jobs(int pbs_sd, char *queue_name)
+{
+	struct attropl opl = { NULL, const_cast<char *>(ATTR_q), NULL, queue_name, EQ };
+	unsigned int tag;
+
+	if (jobs_prefetched.find(queue_name) != jobs_prefetched.end())
+		return;
+
+	if ((tag = pbs_async_selstat(pbs_sd, &opl, job_query_attrs(), const_cast<char *>("S"))) != 0)
+		jobs_prefetched[queue_name] = tag;
+}
+
+/**
+ * @brief
+ * 		wait for the reply to a prefetched job query.  The replies to the
+ *		other prefetched queries read on the way are kept for later.
+ *
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ * @param[in]	tag	-	tag of the query
+ *
+ * @return	struct batch_async_status *
+ * @retval	the reply, to be freed with pbs_asyncstatfree()
+ * @retval	NULL	: the connection failed
+ */
+static struct batch_async_status *
+wait_prefetched_jobs(int pbs_sd, unsigned int tag)
+{
+	struct batch_async_status *as;
+	struct batch_async_status *next;
+	std::unordered_map<unsigned int, struct batch_async_status *>::iterator it;
+
+	while ((it = jobs_replied.find(tag)) == jobs_replied.end()) {
+		if ((as = pbs_async_wait(pbs_sd, -1, NULL, NULL)) == NULL)
+			return NULL;
+		for (; as != NULL; as = next) {
+			next = as->next;
+			as->next = NULL;
+			jobs_replied[as->tag] = as;
+		}
+	}
+	as = it->second;
+	jobs_replied.erase(it);
+	return as;
+}
+
+/**
+ * @brief
+ * 		drop the prefetched job queries query_jobs() did not use, so their
+ *		replies are not left on the connection
+ *
+ * @param[in]	pbs_sd	-	connection to pbs_server
+ *
+ * @return	void
+ */
+void
+discard_prefetched_jobs(int pbs_sd)
+{
+	struct batch_async_status *as;
+
+	for (auto &pf : jobs_prefetched) {
+		if ((as = wait_prefetched_jobs(pbs_sd, pf.second)) == NULL)
+			break;
+		pbs_asyncstatfree(as);
+	}
+	jobs_prefetched.clear();
+	for (auto &r : jobs_replied)
+		pbs_asyncstatfree(r.second);
+	jobs_replied.clear();
+}
+
 /**
  * @brief
  * 		create an array of jobs in a specified queue
@@ -911,7 +1097,8 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 	struct attropl opl = { NULL, const_cast<char *>(ATTR_q), NULL, NULL, EQ };
 	static struct attropl opl2[2] = { { &opl2[1], const_cast<char *>(ATTR_state), NULL, const_cast<char *>("Q"), EQ},
 		{ NULL, const_cast<char *>(ATTR_array), NULL, const_cast<char *>("True"), NE} };
-	static struct attrl *attrib = NULL;
+	std::unordered_map<std::string, unsigned int>::iterator pf;
+	unsigned int tag;
 	int i;
 
 	/* linked list of jobs returned from pbs_selstat() */
@@ -943,45 +1130,6 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 	resource_resv ***jinfo_arrs_tasks;
 	int tid;
 
-	const char *jobattrs[] = {
-			ATTR_p,
-			ATTR_qtime,
-			ATTR_qrank,
-			ATTR_etime,
-			ATTR_stime,
-			ATTR_N,
-			ATTR_state,
-			ATTR_substate,
-			ATTR_sched_preempted,
-			ATTR_comment,
-			ATTR_released,
-			ATTR_euser,
-			ATTR_egroup,
-			ATTR_project,
-			ATTR_resv_ID,
-			ATTR_altid,
-			ATTR_SchedSelect,
-			ATTR_array_id,
-			ATTR_node_set,
-			ATTR_array,
-			ATTR_array_index,
-			ATTR_topjob_ineligible,
-			ATTR_array_indices_remaining,
-			ATTR_execvnode,
-			ATTR_l,
-			ATTR_rel_list,
-			ATTR_used,
-			ATTR_accrue_type,
-			ATTR_eligible_time,
-			ATTR_estimated,
-			ATTR_c,
-			ATTR_r,
-			ATTR_depend,
-			ATTR_A,
-			ATTR_max_run_subjobs,
-			NULL
-	};
-
 	if (policy == NULL || qinfo == NULL || queue_name == NULL)
 		return pjobs;
 
@@ -990,20 +1138,31 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 	if (qinfo->is_peer_queue)
 		opl.next = &opl2[0];
 
-	if (attrib == NULL) {
-		for (i = 0; jobattrs[i] != NULL; i++) {
-			struct attrl *temp_attrl = NULL;
+	/* the jobs of a local queue may have been asked for already */
+	if (!qinfo->is_peer_queue &&
+		(pf = jobs_prefetched.find(queue_name)) != jobs_prefetched.end()) {
+		struct batch_async_status *as;
 
-			temp_attrl = new_attrl();
-			temp_attrl->name = strdup(jobattrs[i]);
-			temp_attrl->next = attrib;
-			temp_attrl->value = const_cast<char *>("");
-			attrib = temp_attrl;
+		tag = pf->second;
+		jobs_prefetched.erase(pf);
+		if ((as = wait_prefetched_jobs(pbs_sd, tag)) == NULL) {
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, "job_info",
+					"pbs_selstat failed: lost the reply to the jobs of %s (%d)", queue_name, pbs_errno);
+			return pjobs;
 		}
-	}
-
-	/* get jobs from PBS server */
-	if ((jobs = pbs_selstat(pbs_sd, &opl, attrib, const_cast<char *>("S"))) == NULL) {
+		if (as->code != PBSE_NONE) {
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, "job_info",
+					"pbs_selstat failed: %s (%d)", as->text != NULL ? as->text : "", as->code);
+			pbs_asyncstatfree(as);
+			return pjobs;
+		}
+		jobs = as->status;
+		as->status = NULL;
+		pbs_asyncstatfree(as);
+		if (jobs == NULL)
+			return pjobs;
+	} else if ((jobs = pbs_selstat(pbs_sd, &opl, job_query_attrs(), const_cast<char *>("S"))) == NULL) {
+		/* get jobs from PBS server */
 		if (pbs_errno > 0) {
 			errmsg = pbs_geterrmsg(pbs_sd);
 			if (errmsg == NULL)
@@ -1059,9 +1218,7 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 		free(tdata);
 		resresv_arr[jidx] = NULL;
 	} else {
-		chunk_size = num_new_jobs / num_threads;
-		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
-		chunk_size = (chunk_size < MT_CHUNK_SIZE_MAX) ? chunk_size : MT_CHUNK_SIZE_MAX;
+		chunk_size = mt_chunk_size(num_new_jobs, MT_CHUNK_SIZE_MAX);
 		for (j = 0, num_tasks = 0; num_new_jobs > 0;
 				num_tasks++, j += chunk_size, num_new_jobs -= chunk_size) {
 			tdata = alloc_tdata_jquery(policy, pbs_sd, jobs, qinfo, j, j + chunk_size - 1);
@@ -1092,6 +1249,9 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 		}
 		/* Get results from worker threads */
 		for (i = 0; i < num_tasks;) {
+			/* help out with the queued work rather than wait for it */
+			while (run_queued_task())
+				;
 			pthread_mutex_lock(&result_lock);
 			while (ds_queue_is_empty(result_queue))
 				pthread_cond_wait(&result_cond, &result_lock);
@@ -1152,6 +1312,9 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 	long count;			/* long used in string->long conversion */
 	char *endp;			/* used for strtol() */
 	resource_req *resreq;		/* resource_req list for resources requested  */
+	struct attrl *released_attr = NULL;	/* resources_released, parsed after the state is known */
+	struct attrl *execvnode_attr = NULL;	/* exec_vnode, parsed after the state is known */
+	int has_resused = 0;		/* job has resources_used entries */
 
 	if ((resresv = new_resource_resv()) == NULL)
 		return NULL;
@@ -1273,7 +1436,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 		else if (!strcmp(attrp->name, ATTR_comment))	/* job comment */
 			resresv->job->comment = string_dup(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_released)) /* resources_released */
-			resresv->job->resreleased = parse_execvnode(attrp->value, sinfo, NULL);
+			released_attr = attrp;
 		else if (!strcmp(attrp->name, ATTR_euser))	/* account name */
 			resresv->user = string_dup(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_egroup))	/* group name */
@@ -1290,7 +1453,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			resresv->job->schedsel = string_dup(attrp->value);
 #endif /* localmod 031 */
 
-			resresv->select = parse_selspec(attrp->value);
+			resresv->select = find_alloc_selspec(attrp->value);
 #ifdef NAS /* localmod 031 */
 		}
 #endif /* localmod 031 */
@@ -1323,15 +1486,9 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			if (*endp == '\0')
 				resresv->job->max_run_subjobs = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_execvnode)) {
-			nspec **tmp_nspec_arr;
-			tmp_nspec_arr = parse_execvnode(attrp->value, sinfo, NULL);
-			resresv->nspec_arr = combine_nspec_array(tmp_nspec_arr);
-			free_nspecs(tmp_nspec_arr);
-
-			if (resresv->nspec_arr != NULL)
-				resresv->ninfo_arr = create_node_array_from_nspec(resresv->nspec_arr);
-		} else if (!strcmp(attrp->name, ATTR_l)) { /* resources requested*/
+		else if (!strcmp(attrp->name, ATTR_execvnode))
+			execvnode_attr = attrp;
+		else if (!strcmp(attrp->name, ATTR_l)) { /* resources requested*/
 			resreq = find_alloc_resource_req_by_str(resresv->resreq, attrp->resource);
 			if (resreq == NULL) {
 				free_resource_resv(resresv);
@@ -1358,7 +1515,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 				}
 #endif
 				if (!strcmp(attrp->resource, "place")) {
-					resresv->place_spec = parse_placespec(attrp->value);
+					resresv->place_spec = find_alloc_placespec(attrp->value);
 					if (resresv->place_spec == NULL) {
 						set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
 						set_schd_error_arg(err, SPECMSG, "invalid placement spec");
@@ -1373,14 +1530,9 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 				set_resource_req(resreq, attrp->value);
 			if (resresv->job->resreq_rel == NULL)
 				resresv->job->resreq_rel = resreq;
-		} else if (!strcmp(attrp->name, ATTR_used)) { /* resources used */
-			resreq =
-				find_alloc_resource_req_by_str(resresv->job->resused, attrp->resource);
-			if (resreq != NULL)
-				set_resource_req(resreq, attrp->value);
-			if (resresv->job->resused ==NULL)
-				resresv->job->resused = resreq;
-		} else if (!strcmp(attrp->name, ATTR_accrue_type)) {
+		} else if (!strcmp(attrp->name, ATTR_used)) /* resources used */
+			has_resused = 1;
+		else if (!strcmp(attrp->name, ATTR_accrue_type)) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				resresv->job->accrue_type = count;
@@ -1411,6 +1563,37 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 		attrp = attrp->next;
 	}
 
+	/* Held and waiting jobs hold no resources and will not be run this
+	 * cycle, so the vnode lists and usage they carry (e.g., from a checkpoint)
+	 * are not needed.  They are parsed when the job is queried in a cycle
+	 * where it is in a state to use them.
+	 */
+	if (resresv->is_invalid || resresv->job->is_held || resresv->job->is_waiting)
+		return resresv;
+
+	if (released_attr != NULL)
+		resresv->job->resreleased = parse_execvnode(released_attr->value, sinfo, NULL);
+
+	if (execvnode_attr != NULL) {
+		nspec **tmp_nspec_arr;
+		tmp_nspec_arr = parse_execvnode(execvnode_attr->value, sinfo, NULL);
+		resresv->nspec_arr = combine_nspec_array(tmp_nspec_arr);
+		free_nspecs(tmp_nspec_arr);
+
+		if (resresv->nspec_arr != NULL)
+			resresv->ninfo_arr = create_node_array_from_nspec(resresv->nspec_arr);
+	}
+
+	for (attrp = job->attribs; has_resused && attrp != NULL; attrp = attrp->next) {
+		if (strcmp(attrp->name, ATTR_used))
+			continue;
+		resreq = find_alloc_resource_req_by_str(resresv->job->resused, attrp->resource);
+		if (resreq != NULL)
+			set_resource_req(resreq, attrp->value);
+		if (resresv->job->resused == NULL)
+			resresv->job->resused = resreq;
+	}
+
 	return resresv;
 }
 
@@ -1783,24 +1966,26 @@ update_job_attr(int pbs_sd, resource_resv *resresv, const char *attr_name,
 
 /**
  * @brief
- * 		send delayed job attribute updates for job using send_attr_updates().
+ * 		queue delayed job attribute updates for job to be sent to the server.
  *
  * @par
  * 		The main reason to use this function over a direct send_attr_update()
  *      call is so that the job's attr_updates list gets free'd and NULL'd.
- *      We don't want to send the attr updates multiple times
+ *      We don't want to send the attr updates multiple times.
+ *      The updates are handed over to a list which flush_job_updates() sends
+ *      to the server in one request, rather than a request per job.
  *
  * @param[in]	pbs_sd	-	server connection descriptor
  * @param[in]	job	-	job to send attributes to
  *
- * @return	int(ret val from send_attr_updates)
+ * @return	int
  * @retval	1	- success
  * @retval	0	- failure to update
  */
 int send_job_updates(int pbs_sd, resource_resv *job)
 {
-	int rc;
 	struct attrl *iter_attr = NULL;
+	struct batch_status *bs;
 
 	if(job == NULL)
 		return 0;
@@ -1817,10 +2002,222 @@ int send_job_updates(int pbs_sd, resource_resv *job)
 			return 0;
 	}
 
-	rc = send_attr_updates(pbs_sd, job->name, job->job->attr_updates);
+	if (job->job->attr_updates == NULL)
+		return 0;
+
+	if (pbs_sd == SIMULATE_SD) {
+		free_attrl_list(job->job->attr_updates);
+		job->job->attr_updates = NULL;
+		return 1; /* simulation always successful */
+	}
+
+	/* runs queued so far are older than this update */
+	flush_subjob_runs();
 
-	free_attrl_list(job->job->attr_updates);
+	if (pending_updates != NULL && pending_updates_sd != pbs_sd)
+		flush_job_updates();
+
+	bs = static_cast<struct batch_status *>(calloc(1, sizeof(struct batch_status)));
+	if (bs == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	bs->name = string_dup(job->name);
+	if (bs->name == NULL) {
+		free(bs);
+		return 0;
+	}
+	bs->attribs = job->job->attr_updates;
 	job->job->attr_updates = NULL;
+
+	if (pending_updates == NULL)
+		pending_updates = bs;
+	else
+		pending_updates_tail->next = bs;
+	pending_updates_tail = bs;
+	pending_updates_sd = pbs_sd;
+
+	if (++num_pending_updates >= MAX_QUEUED_JOB_UPDATES)
+		return flush_job_updates();
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		send the subjob runs queued by queue_subjob_run() and the job
+ *		attribute updates queued by send_job_updates() to the server.
+ *
+ * @par
+ * 		Queueing either one sends the other first, so at most one of
+ *		them has anything to send and the order they were made in is kept.
+ *
+ * @return	int
+ * @retval	1	- success or nothing to send
+ * @retval	0	- failure to send
+ */
+int
+flush_job_updates(void)
+{
+	int rc;
+
+	rc = flush_subjob_runs();
+	if (send_pending_updates() == 0)
+		rc = 0;
+	return rc;
+}
+
+/**
+ * @brief
+ * 		send the job attribute updates queued by send_job_updates()
+ *		to the server in one request.
+ *
+ * @par
+ * 		The server does not reply to the request, so failures on
+ *		individual jobs are not reported back.
+ *
+ * @return	int
+ * @retval	1	- success or nothing to send
+ * @retval	0	- failure to update
+ */
+static int
+send_pending_updates(void)
+{
+	int rc = 1;
+	int count = num_pending_updates;
+	const char *errbuf;
+
+	if (pending_updates == NULL)
+		return 1;
+
+	/* leave the list for pbs_statfree() before anything is logged */
+	if (got_sigpipe)
+		rc = 0;
+	else if (pbs_asyalterjobs(pending_updates_sd, pending_updates, NULL) == 0)
+		last_attr_updates = time(NULL);
+	else
+		rc = 0;
+
+	if (rc == 0 && !got_sigpipe) {
+		errbuf = pbs_geterrmsg(pending_updates_sd);
+		if (errbuf == NULL)
+			errbuf = "";
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+			"Failed to update attributes of %d jobs: %s (%d)",
+			count, errbuf, pbs_errno);
+	}
+
+	pbs_statfree(pending_updates);
+	pending_updates = NULL;
+	pending_updates_tail = NULL;
+	num_pending_updates = 0;
+
+	return rc;
+}
+
+/**
+ * @brief
+ * 		queue the run of a subjob.  The subjobs of an array are usually
+ *		run one after the other, so rather than a run job request each,
+ *		they are sent together by flush_subjob_runs().
+ *
+ * @par
+ * 		Like pbs_asyrunjob(), nothing is heard back from the server.
+ *		The runs are sent when a subjob of another array is queued,
+ *		MAX_BATCHED_SUBJOB_RUNS are queued, or anything else is sent
+ *		through flush_job_updates().
+ *
+ * @param[in]	pbs_sd	-	connection descriptor to the server
+ * @param[in]	rjob	-	the subjob to run
+ * @param[in]	execvnode	-	the execvnode to run the subjob on
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	!0	- pbs_errno, on failure
+ */
+int
+queue_subjob_run(int pbs_sd, resource_resv *rjob, char *execvnode)
+{
+	char *dest;
+
+	if (rjob == NULL || rjob->job == NULL || rjob->job->array_id == NULL || execvnode == NULL)
+		return (pbs_errno = PBSE_IVALREQ);
+
+	if (num_pending_runs > 0 &&
+		(pending_runs_sd != pbs_sd || strcmp(pending_runs_array, rjob->job->array_id) != 0))
+		flush_subjob_runs();
+
+	/* updates queued so far are older than this run */
+	send_pending_updates();
+
+	if ((dest = string_dup(execvnode)) == NULL)
+		return (pbs_errno = PBSE_SYSTEM);
+
+	if (num_pending_runs == 0) {
+		if ((pending_runs_array = string_dup(rjob->job->array_id)) == NULL) {
+			free(dest);
+			return (pbs_errno = PBSE_SYSTEM);
+		}
+		pending_runs_sd = pbs_sd;
+	}
+	pending_runs_idx[num_pending_runs] = rjob->job->array_index;
+	pending_runs_dest[num_pending_runs] = dest;
+
+	if (++num_pending_runs >= MAX_BATCHED_SUBJOB_RUNS)
+		flush_subjob_runs();
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		send the subjob runs queued by queue_subjob_run() to the server
+ *		in one request.  A lone subjob goes as a plain async run job
+ *		request.
+ *
+ * @return	int
+ * @retval	1	- success or nothing to send
+ * @retval	0	- failure to send
+ */
+int
+flush_subjob_runs(void)
+{
+	int rc = 1;
+	int i;
+	char *name = NULL;
+	const char *errbuf;
+	double prof;
+
+	if (num_pending_runs == 0)
+		return 1;
+
+	prof = prof_start();
+	if (got_sigpipe)
+		rc = 0;
+	else if (num_pending_runs == 1) {
+		name = create_subjob_name(pending_runs_array, pending_runs_idx[0]);
+		if (name == NULL || pbs_asyrunjob(pending_runs_sd, name, pending_runs_dest[0], NULL) != 0)
+			rc = 0;
+	} else if (pbs_asyrunsubjobs(pending_runs_sd, pending_runs_array, num_pending_runs,
+			pending_runs_idx, pending_runs_dest, NULL) != 0)
+		rc = 0;
+	prof_stop(PROF_RUN_JOB, prof);
+
+	if (rc == 0 && !got_sigpipe) {
+		errbuf = pbs_geterrmsg(pending_runs_sd);
+		if (errbuf == NULL)
+			errbuf = "";
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_WARNING, pending_runs_array,
+			"Failed to run %d subjobs: %s (%d)", num_pending_runs, errbuf, pbs_errno);
+	}
+
+	free(name);
+	for (i = 0; i < num_pending_runs; i++)
+		free(pending_runs_dest[i]);
+	free(pending_runs_array);
+	pending_runs_array = NULL;
+	num_pending_runs = 0;
+
 	return rc;
 }
 
@@ -1849,6 +2246,9 @@ send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr)
 	if (pbs_sd == SIMULATE_SD)
 		return 1; /* simulation always successful */
 
+	/* queued updates are older and must not overwrite this one */
+	flush_job_updates();
+
 	if (pattr->next == NULL)
 		one_attr = 1;
 
@@ -2359,12 +2759,12 @@ dup_resresv_set(resresv_set *oset, server_info *nsinfo)
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->select_spec = dup_selspec(oset->select_spec);
+	rset->select_spec = share_selspec(oset->select_spec);
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->place_spec = dup_place(oset->place_spec);
+	rset->place_spec = share_place(oset->place_spec);
 	if (rset->place_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2609,12 +3009,12 @@ create_resresv_set_by_resresv(status *policy, server_info *sinfo, resource_resv
 	if (resresv_set_use_proj(sinfo, rset->qinfo))
 		rset->project = string_dup(resresv->project);
 
-	rset->select_spec = dup_selspec(resresv_set_which_selspec(resresv));
+	rset->select_spec = share_selspec(resresv_set_which_selspec(resresv));
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->place_spec = dup_place(resresv->place_spec);
+	rset->place_spec = share_place(resresv->place_spec);
 	if (rset->place_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2785,6 +3185,287 @@ create_resresv_sets(status *policy, server_info *sinfo)
 	return rsets;
 }
 
+/*
+ * The failures of resresv_sets are kept from one cycle to the next.  A
+ * failure is only reused when the universe the next cycle starts with is
+ * the same one the failure was found in (see resresv_set_universe()) and
+ * the calendar has the same top jobs.  Failures are only recorded and reused
+ * until the first job is run or preempted in a cycle since either changes
+ * the universe out from under them.
+ */
+struct resresv_set_failure {
+	schd_error *err;			/* why the set could not run */
+	std::vector<std::string> top_jobs;	/* top jobs in the calendar when it failed */
+};
+static std::unordered_map<std::string, resresv_set_failure> rset_failures;
+static std::string rset_universe;		/* universe the failures were found in */
+static server_info *rset_sinfo = NULL;		/* [reference] universe of the current cycle */
+static int rset_running;			/* running jobs in rset_sinfo when the cycle started */
+static int rset_preempted;			/* preempted jobs in rset_sinfo when the cycle started */
+
+/**
+ * @brief create the key a resresv_set is remembered by across cycles
+ * @param[in] rset - resresv_set
+ * @return the key
+ */
+static std::string
+resresv_set_key(resresv_set *rset)
+{
+	std::string key;
+	resource_req *req;
+	int i;
+
+	key = std::string(rset->qinfo != NULL ? rset->qinfo->name : "") + ':';
+	key += std::string(rset->user != NULL ? rset->user : "") + ':';
+	key += std::string(rset->group != NULL ? rset->group : "") + ':';
+	key += std::string(rset->project != NULL ? rset->project : "") + ':';
+	for (i = 0; rset->select_spec->chunks[i] != NULL; i++)
+		key += std::to_string(rset->select_spec->chunks[i]->num_chunks) + '#' +
+			rset->select_spec->chunks[i]->str_chunk + '+';
+	key += ':' + std::to_string(rset->place_spec->free) + std::to_string(rset->place_spec->pack) +
+		std::to_string(rset->place_spec->scatter) + std::to_string(rset->place_spec->vscatter) +
+		std::to_string(rset->place_spec->excl) + std::to_string(rset->place_spec->exclhost) +
+		std::to_string(rset->place_spec->share) +
+		(rset->place_spec->group != NULL ? rset->place_spec->group : "") + ':';
+	for (req = rset->req; req != NULL; req = req->next)
+		key += std::string(req->name) + '=' + (req->res_str != NULL ? req->res_str : "") + ',';
+
+	return key;
+}
+
+/**
+ * @brief append a resource list to a universe description
+ * @param[in,out] str - the description
+ * @param[in] res - resource list
+ */
+static void
+append_resources(std::string &str, schd_resource *res)
+{
+	for (; res != NULL; res = res->next) {
+		str += std::string(res->name) + '=' + std::to_string(res->avail) + '/' +
+			std::to_string(res->assigned);
+		if (res->orig_str_avail != NULL)
+			str += std::string("/") + res->orig_str_avail;
+		str += ',';
+	}
+}
+
+/**
+ * @brief append a limit storage to a universe description
+ * @param[in,out] str - the description
+ * @param[in] liminfo - limit storage
+ */
+static void
+append_limits(std::string &str, void *liminfo)
+{
+	char *lims;
+
+	lims = lim_liminfo_to_str(liminfo);
+	if (lims != NULL) {
+		str += lims;
+		free(lims);
+	}
+	str += ';';
+}
+
+/**
+ * @brief describe everything a resresv_set's failure can depend on.  Two
+ *		cycles which start with the same description of their universe
+ *		will come to the same conclusions about the same resresv_sets.
+ * @param[in] policy - policy info
+ * @param[in] sinfo - server universe
+ * @return the description
+ */
+static std::string
+resresv_set_universe(status *policy, server_info *sinfo)
+{
+	std::string str;
+	int i;
+
+	str = std::to_string(policy->is_prime) + std::to_string(policy->is_ded_time) +
+		std::to_string(policy->backfill) + std::to_string(policy->strict_ordering) +
+		std::to_string(policy->help_starving_jobs) + std::to_string(policy->preempting) +
+		std::to_string(policy->backfill_depth) + std::to_string(sc_attrs.do_not_span_psets) +
+		std::to_string(sc_attrs.only_explicit_psets) + std::to_string(sc_attrs.opt_backfill_fuzzy) + ';';
+
+	append_resources(str, sinfo->res);
+	append_limits(str, sinfo->liminfo);
+
+	for (i = 0; sinfo->queues != NULL && sinfo->queues[i] != NULL; i++) {
+		queue_info *qinfo = sinfo->queues[i];
+
+		str += std::string(qinfo->name) + ':' + std::to_string(qinfo->is_started) +
+			std::to_string(qinfo->is_ok_to_run) + ':';
+		append_resources(str, qinfo->qres);
+		append_limits(str, qinfo->liminfo);
+	}
+
+	for (i = 0; sinfo->nodes != NULL && sinfo->nodes[i] != NULL; i++) {
+		node_info *ninfo = sinfo->nodes[i];
+
+		str += std::string(ninfo->name) + ':' + std::to_string(ninfo->is_down) +
+			std::to_string(ninfo->is_free) + std::to_string(ninfo->is_offline) +
+			std::to_string(ninfo->is_unknown) + std::to_string(ninfo->is_job_exclusive) +
+			std::to_string(ninfo->is_resv_exclusive) + std::to_string(ninfo->is_busy) +
+			std::to_string(ninfo->is_job_busy) + std::to_string(ninfo->is_stale) +
+			std::to_string(ninfo->is_maintenance) + std::to_string(ninfo->is_provisioning) +
+			std::to_string(ninfo->is_sleeping) + ':' +
+			(ninfo->queue_name != NULL ? ninfo->queue_name : "") + ':';
+		append_resources(str, ninfo->res);
+	}
+
+	for (i = 0; sinfo->running_jobs != NULL && sinfo->running_jobs[i] != NULL; i++)
+		str += std::string(sinfo->running_jobs[i]->name) + ',';
+	str += ';';
+
+	for (i = 0; i < sinfo->num_resvs; i++) {
+		resource_resv *resv = sinfo->resvs[i];
+
+		str += std::string(resv->name) + ':' + std::to_string(resv->resv->resv_state) + ':' +
+			std::to_string(resv->start) + ':' + std::to_string(resv->end) + ',';
+	}
+
+	return str;
+}
+
+/**
+ * @brief list the top jobs which have been added to the calendar
+ * @param[in] sinfo - server universe
+ * @return the names and start times of the top jobs
+ */
+static std::vector<std::string>
+calendar_top_jobs(server_info *sinfo)
+{
+	std::vector<std::string> top_jobs;
+	timed_event *te;
+
+	if (sinfo->calendar == NULL)
+		return top_jobs;
+
+	for (te = sinfo->calendar->first_run_event; te != NULL; te = te->next) {
+		resource_resv *resresv = (resource_resv *) te->event_ptr;
+
+		if (te->event_type == TIMED_RUN_EVENT && resresv != NULL && resresv->is_job)
+			top_jobs.push_back(std::string(resresv->name) + '@' + std::to_string(te->event_time));
+	}
+
+	return top_jobs;
+}
+
+/**
+ * @brief can the resresv_set failures be recorded or reused right now
+ * @param[in] sinfo - server universe
+ * @return int
+ * @retval 1 yes
+ * @retval 0 no
+ */
+static int
+resresv_set_failures_usable(server_info *sinfo)
+{
+	return sinfo != NULL && sinfo == rset_sinfo &&
+		sinfo->sc.running == rset_running && sinfo->num_preempted == rset_preempted;
+}
+
+/**
+ * @brief start using the resresv_set failures for a new cycle.  If the
+ *		universe has changed since the failures were found, they are forgotten.
+ * @param[in] policy - policy info
+ * @param[in] sinfo - the universe of the new cycle
+ */
+void
+start_resresv_set_failures(status *policy, server_info *sinfo)
+{
+	std::string universe;
+
+	rset_sinfo = NULL;
+	if (policy == NULL || sinfo == NULL || sinfo->equiv_classes == NULL)
+		return;
+
+	universe = resresv_set_universe(policy, sinfo);
+	if (universe != rset_universe) {
+		clear_resresv_set_failures();
+		rset_universe = universe;
+	} else if (!rset_failures.empty())
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Reusing %d job equivalence class failures from the last cycle",
+			static_cast<int>(rset_failures.size()));
+
+	rset_sinfo = sinfo;
+	rset_running = sinfo->sc.running;
+	rset_preempted = sinfo->num_preempted;
+}
+
+/**
+ * @brief remember why a resresv_set could not run for the next cycle
+ * @param[in] sinfo - server universe
+ * @param[in] rset - resresv_set which could not run
+ */
+void
+save_resresv_set_failure(server_info *sinfo, resresv_set *rset)
+{
+	resresv_set_failure failure;
+	std::string key;
+
+	if (rset == NULL || rset->err == NULL || !resresv_set_failures_usable(sinfo))
+		return;
+
+	failure.err = dup_schd_error(rset->err);
+	if (failure.err == NULL)
+		return;
+	failure.top_jobs = calendar_top_jobs(sinfo);
+
+	key = resresv_set_key(rset);
+	auto ent = rset_failures.find(key);
+	if (ent != rset_failures.end()) {
+		free_schd_error(ent->second.err);
+		ent->second = failure;
+	} else
+		rset_failures.emplace(key, failure);
+}
+
+/**
+ * @brief mark a resresv_set can not run if it failed the same way last cycle
+ * @param[in] sinfo - server universe
+ * @param[in,out] rset - resresv_set to check
+ * @return int
+ * @retval 1 the set was marked can not run
+ * @retval 0 the set needs to be evaluated
+ */
+int
+find_resresv_set_failure(server_info *sinfo, resresv_set *rset)
+{
+	if (rset == NULL || rset->can_not_run || rset_failures.empty() ||
+	    !resresv_set_failures_usable(sinfo))
+		return 0;
+
+	auto ent = rset_failures.find(resresv_set_key(rset));
+	if (ent == rset_failures.end())
+		return 0;
+
+	if (ent->second.top_jobs != calendar_top_jobs(sinfo))
+		return 0;
+
+	rset->err = dup_schd_error(ent->second.err);
+	if (rset->err == NULL)
+		return 0;
+	rset->can_not_run = 1;
+
+	return 1;
+}
+
+/**
+ * @brief forget all the resresv_set failures
+ */
+void
+clear_resresv_set_failures(void)
+{
+	for (auto &ent : rset_failures)
+		free_schd_error(ent.second.err);
+	rset_failures.clear();
+	rset_universe.clear();
+	rset_sinfo = NULL;
+}
+
 /**
  * @brief
  * 		job_info copy constructor
@@ -2867,7 +3548,7 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
 	else
 		njinfo->ginfo = NULL;
 
-	njinfo->depend_job_str = string_dup(njinfo->depend_job_str);
+	njinfo->depend_job_str = string_dup(ojinfo->depend_job_str);
 
 #ifdef RESC_SPEC
 	njinfo->rspec = dup_rescspec(ojinfo->rspec);
@@ -3100,6 +3781,9 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 			}
 		}
 
+		/* queued subjob runs go out before anything is preempted */
+		flush_job_updates();
+
 		if ((preempt_jobs_reply = pbs_preempt_jobs(pbs_sd, preempt_jobs_list)) == NULL) {
 			free_string_array(preempt_jobs_list);
 			free(preempted_list);
@@ -3214,6 +3898,99 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 }
 
 
+/**
+ * @brief
+ *		the running jobs sorted in the order preemption considers them:
+ *		ascending preemption priority.  The order is kept in the server
+ *		and only re-sorted when a job started, ended or changed its
+ *		preemption priority since it was last sorted.
+ *
+ * @param[in]	sinfo	-	the server
+ *
+ * @return	resource_resv **
+ * @retval	the running jobs in preemption order (not to be freed, reference)
+ * @retval	NULL	: on error
+ */
+static resource_resv **
+preempt_ordered_running_jobs(server_info *sinfo)
+{
+	int (*cmp)(const void *, const void *);
+	resource_resv **ordered;
+	int num_running;
+	int i;
+
+	if (sinfo == NULL || sinfo->running_jobs == NULL)
+		return NULL;
+
+	if (sc_attrs.preempt_sort == PS_MIN_T_SINCE_START)
+		cmp = cmp_preempt_stime_asc;
+	else
+		cmp = cmp_preempt_priority_asc;
+
+	num_running = count_array(sinfo->running_jobs);
+	ordered = sinfo->preempt_ordered_jobs;
+	if (ordered != NULL) {
+		for (i = 0; ordered[i] != NULL && ordered[i]->job->is_running; i++)
+			if (i > 0 && cmp(&ordered[i - 1], &ordered[i]) > 0)
+				break;
+		if (i == num_running && ordered[i] == NULL)
+			return ordered;
+		free(ordered);
+	}
+
+	ordered = static_cast<resource_resv **>(malloc((num_running + 1) * sizeof(resource_resv *)));
+	sinfo->preempt_ordered_jobs = ordered;
+	if (ordered == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	memcpy(ordered, sinfo->running_jobs, (num_running + 1) * sizeof(resource_resv *));
+	qsort(ordered, num_running, sizeof(resource_resv *), cmp);
+
+	return ordered;
+}
+
+/**
+ * @brief
+ *		put the running jobs of a copy of a server into the same order as
+ *		the preemption order of the original server's running jobs
+ *
+ * @param[in,out]	nsinfo	-	copy of the server
+ * @param[in]	ordered	-	running jobs of the original in preemption order
+ *
+ * @return	int
+ * @retval	1	: nsinfo->running_jobs were reordered
+ * @retval	0	: the running jobs don't match and were left alone
+ */
+static int
+order_running_jobs_for_preemption(server_info *nsinfo, resource_resv **ordered)
+{
+	resource_resv **rjobs = nsinfo->running_jobs;
+	resource_resv *rj;
+	int num_running;
+	int i;
+
+	if (ordered == NULL || rjobs == NULL || nsinfo->all_resresv == NULL)
+		return 0;
+
+	num_running = count_array(rjobs);
+	if (count_array(ordered) != num_running)
+		return 0;
+
+	for (i = 0; i < num_running; i++) {
+		if (ordered[i]->resresv_ind < 0)
+			return 0;
+		rj = nsinfo->all_resresv[ordered[i]->resresv_ind];
+		if (rj == NULL || rj->rank != ordered[i]->rank || !rj->is_job || !rj->job->is_running)
+			return 0;
+	}
+
+	for (i = 0; i < num_running; i++)
+		rjobs[i] = nsinfo->all_resresv[ordered[i]->resresv_ind];
+
+	return 1;
+}
+
 /**
  * @brief
  * 		find jobs to preempt in order to run a high priority job.
@@ -3270,6 +4047,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	resource_req *preempt_targets_req = NULL;
 	char **preempt_targets_list = NULL;
 	resource_resv **prjobs = NULL;
+	resource_resv **ordered = NULL;	/* the running jobs in preemption order */
 	int rjobs_count = 0;
 
 
@@ -3387,6 +4165,52 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		}
 	}
 
+	/* Duplicating the universe is by far the most expensive part of a
+	 * preemption attempt.  The candidate filters only read the universe, so
+	 * first make sure there is anything to preempt in the real one.
+	 */
+	if (preempt_targets_req != NULL) {
+		prjobs = resource_resv_filter(sinfo->running_jobs,
+			count_array(sinfo->running_jobs),
+			preempt_job_set_filter,
+			(void *) preempt_targets_list, NO_FLAGS);
+		if (prjobs != NULL && prjobs[0] == NULL) {
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, hjob->name,
+				"Limited running jobs used for preemption from %d to 0: No jobs to preempt", sinfo->sc.running);
+			free_schd_error_list(full_err);
+			free(pjobs);
+			free(prjobs);
+			free_string_array(preempt_targets_list);
+			return NULL;
+		}
+	}
+	ordered = preempt_ordered_running_jobs(sinfo);
+	if (prjobs == NULL && ordered != NULL) {
+		/* Only jobs of a lower preemption priority can be preempted.  They
+		 * are at the front of the ordered running jobs.
+		 */
+		for (i = 0; ordered[i] != NULL && ordered[i]->job->preempt < hjob->job->preempt; i++)
+			;
+		prjobs = static_cast<resource_resv **>(malloc((i + 1) * sizeof(resource_resv *)));
+		if (prjobs != NULL) {
+			memcpy(prjobs, ordered, i * sizeof(resource_resv *));
+			prjobs[i] = NULL;
+		}
+	}
+	rjobs_subset = filter_preemptable_jobs(prjobs != NULL ? prjobs : sinfo->running_jobs, hjob, full_err);
+	free(prjobs);
+	prjobs = NULL;
+	if (rjobs_subset == NULL || rjobs_subset[0] == NULL) {
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_INFO, hjob->name, "Found no preemptable candidates");
+		free_schd_error_list(full_err);
+		free(pjobs);
+		free(rjobs_subset);
+		free_string_array(preempt_targets_list);
+		return NULL;
+	}
+	free(rjobs_subset);
+	rjobs_subset = NULL;
+
 	/* use locally dup'd copy of sinfo so we don't modify the original */
 	if ((nsinfo = dup_server_info(sinfo)) == NULL) {
 		free_schd_error_list(full_err);
@@ -3429,18 +4253,21 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	}
 
 	/* sort jobs in ascending preemption priority and starttime... we want to preempt them
-	 * from lowest prio to highest
+	 * from lowest prio to highest.  All the running jobs are already in
+	 * that order in the real universe, so copy its order if we can.
 	 */
-	if (sc_attrs.preempt_sort == PS_MIN_T_SINCE_START) {
-		qsort(rjobs, rjobs_count, sizeof(job_info *),
-			cmp_preempt_stime_asc);
-	}
-	else {
-		/* sort jobs in ascending preemption priority... we want to preempt them
-		 * from lowest prio to highest
-		 */
-		qsort(rjobs, rjobs_count, sizeof(job_info *),
-		cmp_preempt_priority_asc);
+	if (prjobs != NULL || !order_running_jobs_for_preemption(nsinfo, ordered)) {
+		if (sc_attrs.preempt_sort == PS_MIN_T_SINCE_START) {
+			qsort(rjobs, rjobs_count, sizeof(job_info *),
+				cmp_preempt_stime_asc);
+		}
+		else {
+			/* sort jobs in ascending preemption priority... we want to preempt them
+			 * from lowest prio to highest
+			 */
+			qsort(rjobs, rjobs_count, sizeof(job_info *),
+			cmp_preempt_priority_asc);
+		}
 	}
 
 	err = dup_schd_error(full_err);	/* only first element */
@@ -4292,22 +5119,441 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 	return rresv;
 }
 
+/*
+ * Formulas are compiled into a small stack program the first time they are
+ * evaluated.  The compiler understands the arithmetic subset of python that
+ * formulas are normally written in: numbers, resource and special keyword
+ * names, parentheses, unary +/- and the + - * / // % ** operators.  Anything
+ * else (function calls, comparisons, unknown names...) is left to the
+ * embedded python interpreter, as are evaluations which would raise an
+ * exception in python (e.g. division by zero).
+ */
+enum formula_opcode {
+	FOP_CONST,		/* push a constant */
+	FOP_RES,		/* push the amount of a consumable resource */
+	FOP_ELIGIBLE_TIME,	/* push a special keyword value... */
+	FOP_QUEUE_PRIO,
+	FOP_JOB_PRIO,
+	FOP_FSPERC,
+	FOP_TREE_USAGE,
+	FOP_FSFACTOR,
+	FOP_ACCRUE_TYPE,
+	FOP_NEG,		/* unary operators */
+	FOP_ADD,		/* binary operators */
+	FOP_SUB,
+	FOP_MUL,
+	FOP_DIV,
+	FOP_FLOORDIV,
+	FOP_MOD,
+	FOP_POW
+};
+
+struct formula_op {
+	enum formula_opcode op;
+	double val;		/* FOP_CONST */
+	resdef *def;		/* FOP_RES */
+};
+
+struct formula_prog {
+	int compiled;		/* if 0, the formula has to be evaluated by python */
+	int depth;		/* stack depth the program needs */
+	std::vector<formula_op> ops;
+};
+
+/* compiled formulas, keyed by formula.  They point to resource definitions,
+ * so they are flushed by clear_formula_cache() when those are freed.
+ */
+static std::unordered_map<std::string, formula_prog> formula_cache;
+
+/* parser state for compile_formula() */
+struct formula_parser {
+	const char *p;		/* current position in the formula */
+	int depth;		/* current stack depth */
+	formula_prog *prog;
+};
+
+static int parse_formula_expr(formula_parser *fp);
+
+static void
+skip_formula_space(formula_parser *fp)
+{
+	while (*fp->p == ' ' || *fp->p == '\t' || *fp->p == '\n' || *fp->p == '\r')
+		fp->p++;
+}
+
+static void
+add_formula_op(formula_parser *fp, enum formula_opcode op, double val, resdef *def)
+{
+	formula_op fop;
+
+	fop.op = op;
+	fop.val = val;
+	fop.def = def;
+	fp->prog->ops.push_back(fop);
+
+	if (op < FOP_NEG) {
+		if (++fp->depth > fp->prog->depth)
+			fp->prog->depth = fp->depth;
+	} else if (op > FOP_NEG)
+		fp->depth--;
+}
+
+/* atom := number | name | '(' expr ')' */
+static int
+parse_formula_atom(formula_parser *fp)
+{
+	skip_formula_space(fp);
+
+	if (*fp->p == '(') {
+		fp->p++;
+		if (!parse_formula_expr(fp))
+			return 0;
+		skip_formula_space(fp);
+		if (*fp->p != ')')
+			return 0;
+		fp->p++;
+		return 1;
+	}
+
+	if (isdigit(*fp->p) || (*fp->p == '.' && isdigit(fp->p[1]))) {
+		char *endp;
+		double val;
+
+		/* python number syntax we don't handle (0x10, 1_000, 2j) */
+		if (fp->p[0] == '0' && (fp->p[1] == 'x' || fp->p[1] == 'X'))
+			return 0;
+		val = strtod(fp->p, &endp);
+		if (isalnum(*endp) || *endp == '_' || *endp == '.')
+			return 0;
+		fp->p = endp;
+		add_formula_op(fp, FOP_CONST, val, NULL);
+		return 1;
+	}
+
+	if (isalpha(*fp->p) || *fp->p == '_') {
+		std::string name;
+		int i;
+
+		while (isalnum(*fp->p) || *fp->p == '_')
+			name += *fp->p++;
+		skip_formula_space(fp);
+		/* function call or attribute access */
+		if (*fp->p == '(' || *fp->p == '.' || *fp->p == '[')
+			return 0;
+
+		/* special keywords are set after the resources, so they win */
+		if (name == FORMULA_ELIGIBLE_TIME)
+			add_formula_op(fp, FOP_ELIGIBLE_TIME, 0, NULL);
+		else if (name == FORMULA_QUEUE_PRIO)
+			add_formula_op(fp, FOP_QUEUE_PRIO, 0, NULL);
+		else if (name == FORMULA_JOB_PRIO)
+			add_formula_op(fp, FOP_JOB_PRIO, 0, NULL);
+		else if (name == FORMULA_FSPERC || name == FORMULA_FSPERC_DEP)
+			add_formula_op(fp, FOP_FSPERC, 0, NULL);
+		else if (name == FORMULA_TREE_USAGE)
+			add_formula_op(fp, FOP_TREE_USAGE, 0, NULL);
+		else if (name == FORMULA_FSFACTOR)
+			add_formula_op(fp, FOP_FSFACTOR, 0, NULL);
+		else if (name == FORMULA_ACCRUE_TYPE)
+			add_formula_op(fp, FOP_ACCRUE_TYPE, 0, NULL);
+		else {
+			for (i = 0; consres[i] != NULL; i++)
+				if (name == consres[i]->name)
+					break;
+			if (consres[i] == NULL)
+				return 0;
+			add_formula_op(fp, FOP_RES, 0, consres[i]);
+		}
+		return 1;
+	}
+
+	return 0;
+}
+
+/* unary := ('+' | '-') unary | power
+ * power := atom ['**' unary]
+ */
+static int
+parse_formula_unary(formula_parser *fp)
+{
+	skip_formula_space(fp);
+
+	if (*fp->p == '-' || *fp->p == '+') {
+		int neg = (*fp->p == '-');
+
+		fp->p++;
+		if (!parse_formula_unary(fp))
+			return 0;
+		if (neg)
+			add_formula_op(fp, FOP_NEG, 0, NULL);
+		return 1;
+	}
+
+	if (!parse_formula_atom(fp))
+		return 0;
+
+	skip_formula_space(fp);
+	if (fp->p[0] == '*' && fp->p[1] == '*') {
+		fp->p += 2;
+		if (!parse_formula_unary(fp))
+			return 0;
+		add_formula_op(fp, FOP_POW, 0, NULL);
+	}
+
+	return 1;
+}
+
+/* term := unary (('*' | '/' | '//' | '%') unary)* */
+static int
+parse_formula_term(formula_parser *fp)
+{
+	if (!parse_formula_unary(fp))
+		return 0;
+
+	for (;;) {
+		enum formula_opcode op;
+
+		skip_formula_space(fp);
+		if (fp->p[0] == '*' && fp->p[1] != '*' && fp->p[1] != '=') {
+			op = FOP_MUL;
+			fp->p++;
+		} else if (fp->p[0] == '/' && fp->p[1] == '/' && fp->p[2] != '=') {
+			op = FOP_FLOORDIV;
+			fp->p += 2;
+		} else if (fp->p[0] == '/' && fp->p[1] != '/' && fp->p[1] != '=') {
+			op = FOP_DIV;
+			fp->p++;
+		} else if (fp->p[0] == '%' && fp->p[1] != '=') {
+			op = FOP_MOD;
+			fp->p++;
+		} else
+			return 1;
+
+		if (!parse_formula_unary(fp))
+			return 0;
+		add_formula_op(fp, op, 0, NULL);
+	}
+}
+
+/* expr := term (('+' | '-') term)* */
+static int
+parse_formula_expr(formula_parser *fp)
+{
+	if (!parse_formula_term(fp))
+		return 0;
+
+	for (;;) {
+		enum formula_opcode op;
+
+		skip_formula_space(fp);
+		if (fp->p[0] == '+' && fp->p[1] != '=')
+			op = FOP_ADD;
+		else if (fp->p[0] == '-' && fp->p[1] != '=')
+			op = FOP_SUB;
+		else
+			return 1;
+		fp->p++;
+
+		if (!parse_formula_term(fp))
+			return 0;
+		add_formula_op(fp, op, 0, NULL);
+	}
+}
+
 /**
  * @brief
- * 		evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ * 		compile a formula into a formula_prog
  *
- * @param[in]	formula	-	formula to evaluate
+ * @param[in]	formula	-	formula to compile
+ * @param[out]	prog	-	the compiled formula.  prog->compiled is 0
+ *				if the formula needs to be evaluated by python
+ *
+ * @return	void
+ */
+static void
+compile_formula(const char *formula, formula_prog *prog)
+{
+	formula_parser fp;
+
+	prog->compiled = 0;
+	prog->depth = 0;
+	prog->ops.clear();
+
+	if (consres == NULL)
+		return;
+
+	fp.p = formula;
+	fp.depth = 0;
+	fp.prog = prog;
+
+	if (parse_formula_expr(&fp)) {
+		skip_formula_space(&fp);
+		if (*fp.p == '\0' && fp.depth == 1)
+			prog->compiled = 1;
+	}
+
+	if (!prog->compiled)
+		prog->ops.clear();
+}
+
+/**
+ * @brief
+ * 		round a value the same way it is when it is printed into the
+ *		python globals dictionary for formula evaluation
+ *
+ * @param[in]	val	-	value to round
+ * @param[in]	digits	-	number of digits after the decimal point
+ *
+ * @return	rounded value
+ */
+static double
+formula_round(double val, int digits)
+{
+	char buf[1024];
+
+	snprintf(buf, sizeof(buf), "%.*f", digits, val);
+	return strtod(buf, NULL);
+}
+
+/**
+ * @brief
+ * 		run a compiled formula for a job
+ *
+ * @param[in]	prog	-	the compiled formula
  * @param[in]	resresv	-	job for special case key words
  * @param[in]	resreq	-	resources to use when evaluating
+ * @param[out]	ans	-	the answer
  *
- * @return	evaluated formula answer or 0 on exception
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: python would have raised an exception or returned
+ *			  something other than a real number
+ */
+static int
+run_formula(formula_prog *prog, resource_resv *resresv, resource_req *resreq, double *ans)
+{
+	std::vector<double> stack(prog->depth);
+	group_info *ginfo = resresv->job->ginfo;
+	resource_req *req;
+	double a, b;
+	int sp = 0;
+
+	for (auto &fop : prog->ops) {
+		switch (fop.op) {
+			case FOP_CONST:
+				stack[sp++] = fop.val;
+				continue;
+			case FOP_RES:
+				req = find_resource_req(resreq, fop.def);
+				stack[sp++] = (req != NULL) ?
+					formula_round(req->amount, float_digits(req->amount, FLOAT_NUM_DIGITS)) : 0;
+				continue;
+			case FOP_ELIGIBLE_TIME:
+				stack[sp++] = resresv->job->eligible_time;
+				continue;
+			case FOP_QUEUE_PRIO:
+				stack[sp++] = resresv->job->queue->priority;
+				continue;
+			case FOP_JOB_PRIO:
+				stack[sp++] = resresv->job->priority;
+				continue;
+			case FOP_FSPERC:
+				stack[sp++] = formula_round(ginfo->tree_percentage, 6);
+				continue;
+			case FOP_TREE_USAGE:
+				stack[sp++] = formula_round(ginfo->usage_factor, 6);
+				continue;
+			case FOP_FSFACTOR:
+				stack[sp++] = formula_round(ginfo->tree_percentage == 0 ? 0 :
+					pow(2, -(ginfo->usage_factor / ginfo->tree_percentage)), 6);
+				continue;
+			case FOP_ACCRUE_TYPE:
+				stack[sp++] = resresv->job->accrue_type;
+				continue;
+			case FOP_NEG:
+				stack[sp - 1] = -stack[sp - 1];
+				continue;
+			default:
+				break;
+		}
+
+		b = stack[--sp];
+		a = stack[sp - 1];
+		switch (fop.op) {
+			case FOP_ADD:
+				a = a + b;
+				break;
+			case FOP_SUB:
+				a = a - b;
+				break;
+			case FOP_MUL:
+				a = a * b;
+				break;
+			case FOP_DIV:
+				if (b == 0)
+					return 0;
+				a = a / b;
+				break;
+			case FOP_FLOORDIV:
+				if (b == 0)
+					return 0;
+				a = floor(a / b);
+				break;
+			case FOP_MOD:
+				if (b == 0)
+					return 0;
+				/* python's modulo takes the sign of the divisor */
+				a = fmod(a, b);
+				if (a != 0 && ((a < 0) != (b < 0)))
+					a += b;
+				break;
+			case FOP_POW:
+				/* python raises or returns a complex number for these */
+				if ((a == 0 && b < 0) || (a < 0 && b != floor(b)))
+					return 0;
+				a = pow(a, b);
+				break;
+			default:
+				return 0;
+		}
+		stack[sp - 1] = a;
+	}
+
+	if (!isfinite(stack[0]))
+		return 0;
+
+	*ans = stack[0];
+	return 1;
+}
+
+/**
+ * @brief
+ * 		free the compiled formulas.  This must be called when the
+ *		resource definitions they point to are freed.
  *
+ * @return	void
  */
+void
+clear_formula_cache(void)
+{
+	formula_cache.clear();
+}
 
 #ifdef PYTHON
-sch_resource_t
-formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+/**
+ * @brief
+ * 		evaluate a math formula for jobs through the embedded python
+ *		interpreter
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ *
+ * @return	evaluated formula answer or 0 on exception
+ *
+ */
+static sch_resource_t
+formula_evaluate_python(char *formula, resource_resv *resresv, resource_req *resreq)
 {
 	char buf[1024];
 	char *globals;
@@ -4424,13 +5670,45 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 
 	return ans;
 }
-#else
+#endif /* PYTHON */
+
+/**
+ * @brief
+ * 		evaluate a math formula for jobs based on their resources
+ *		NOTE: formulas the native compiler can't handle are evaluated
+ *		through the embedded python interpreter
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ *
+ * @return	evaluated formula answer or 0 on exception
+ *
+ */
 sch_resource_t
 formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 {
+	double ans;
+
+	if (formula == NULL || resresv == NULL ||
+		resresv->job == NULL || consres == NULL)
+		return 0;
+
+	auto ent = formula_cache.find(formula);
+	if (ent == formula_cache.end()) {
+		ent = formula_cache.emplace(formula, formula_prog()).first;
+		compile_formula(formula, &ent->second);
+	}
+
+	if (ent->second.compiled && run_formula(&ent->second, resresv, resreq, &ans))
+		return ans;
+
+#ifdef PYTHON
+	return formula_evaluate_python(formula, resresv, resreq);
+#else
 	return 0;
-}
 #endif
+}
 
 /**
  * @brief
@@ -5463,101 +6741,139 @@ resource_resv **filter_preemptable_jobs(resource_resv **arr, resource_resv *job,
 	return NULL;
 }
 
+/* runone groups parsed from depend attribute strings, keyed by the string.
+ * The jobs of a group all carry the same string, and it rarely changes
+ * between cycles, so a string is parsed once and not every cycle.
+ */
+static std::unordered_map<std::string, std::vector<std::string> > runone_groups;
+
 /**
- * @brief   This function looks at the job's depend attribute string and creates
- *	    an array of job ids having runone dependency.
+ * @brief   This function looks at the job's depend attribute string and fills
+ *	    in the job ids having runone dependency.
  * @param[in] depend_val - job's dependency string
+ * @param[out] group - job ids of the runone dependency, without their server
  *
- * @return - char **
- * @retval - a newly allocated list of jobs with runone dependeny
- * @retval - NULL in case of error
+ * @return - void
  */
-static char **parse_runone_job_list(char *depend_val) {
-	char *start;
+static void parse_runone_job_list(const char *depend_val, std::vector<std::string> &group) {
 	const char *depend_type = "runone:";
-	int i;
-	int len = 1;
-	char *r;
-	char **ret = NULL;
-	char *depend_str = NULL;
-	int  job_delim = 0;
-	int  svr_delim = 0;
-
-	if (depend_val == NULL)
-		return NULL;
-	else
-	    depend_str = string_dup(depend_val);
-
-	start = strstr(depend_str, depend_type);
-	if (start == NULL) {
-		free(depend_str);
-		return NULL;
-	}
+	const char *r;
 
-	r = start + strlen(depend_type);
-	for (i = 0; r[i] != '\0'; i++) {
-		if (r[i] == ':')
-			len++;
-	}
+	r = strstr(depend_val, depend_type);
+	if (r == NULL)
+		return;
 
-	ret = static_cast<char **>(calloc(len + 1, sizeof(char *)));
-	if (ret == NULL) {
-		free(depend_str);
-		return NULL;
-	}
-	for (i = 0;  i < len; i++) {
-		job_delim = strcspn(r, ":");
-		r[job_delim] = '\0';
-		svr_delim = strcspn(r, "@");
-		r[svr_delim] = '\0';
-		ret[i] = string_dup(r);
-		if (ret[i] == NULL) {
-			free_ptr_array(ret);
-			free(depend_str);
-			return NULL;
+	r += strlen(depend_type);
+	/* job_id[@server][:job_id[@server]...] up to the next dependency type,
+	 * a ':' within a job id or server is escaped by a '\'
+	 */
+	while (*r != '\0' && *r != ',') {
+		std::string jobid;
+		int in_svr = 0;
+
+		for (; *r != '\0' && *r != ':' && *r != ','; r++) {
+			if (*r == '\\' && r[1] != '\0')
+				r++;
+			else if (*r == '@')
+				in_svr = 1;
+			if (!in_svr)
+				jobid.push_back(*r);
 		}
-		r = r + job_delim + 1;
+		if (!jobid.empty())
+			group.push_back(jobid);
+		if (*r == ':')
+			r++;
 	}
-	free(depend_str);
-	return ret;
 }
 
 /**
  * @brief   This function processes every job's depend attribute and
  *	    associate the jobs with runone dependency to its dependent_jobs list.
+ *
+ * @par	The runone groups are cached across cycles by depend string, and the
+ *	jobs of a group are found through a job name index built once, so a
+ *	large number of dependencies does not cost a search of every job per
+ *	dependency.
+ *
  * @param[in] sinfo - server info structure
  *
  * @return - void
  */
 void associate_dependent_jobs(server_info *sinfo) {
+	std::unordered_map<std::string, std::vector<std::string> > new_groups;
+	std::unordered_map<std::string, resource_resv *> jobs_by_name;
 	int i;
-	char **job_arr = NULL;
 
-	if (sinfo == NULL)
+	if (sinfo == NULL || sinfo->jobs == NULL)
 		return;
 	for (i = 0; sinfo->jobs[i] != NULL; i++) {
-		if (sinfo->jobs[i]->job->depend_job_str != NULL) {
-			job_arr = parse_runone_job_list(sinfo->jobs[i]->job->depend_job_str);
-			if (job_arr != NULL) {
-				int j;
-				int len = count_array(job_arr);
-				sinfo->jobs[i]->job->dependent_jobs = static_cast<resource_resv **>(calloc((len + 1), sizeof(resource_resv *)));
-				sinfo->jobs[i]->job->dependent_jobs[len] = NULL;
-				for (j = 0; job_arr[j] != NULL; j++) {
-					resource_resv *jptr = NULL;
-					jptr = find_resource_resv(sinfo->jobs, job_arr[j]);
-					if (jptr != NULL)
-						sinfo->jobs[i]->job->dependent_jobs[j] = jptr;
-					free(job_arr[j]);
-				}
+		job_info *jinfo = sinfo->jobs[i]->job;
+		const char *depend = jinfo->depend_job_str;
+		size_t j;
+		size_t k;
+
+		if (depend == NULL || strstr(depend, "runone:") == NULL)
+			continue;
+
+		auto grp = new_groups.find(depend);
+		if (grp == new_groups.end()) {
+			auto old = runone_groups.find(depend);
+			if (old != runone_groups.end()) {
+				grp = new_groups.emplace(depend, std::move(old->second)).first;
+				runone_groups.erase(old);
+			} else {
+				grp = new_groups.emplace(depend, std::vector<std::string>()).first;
+				parse_runone_job_list(depend, grp->second);
 			}
 		}
-		if (job_arr != NULL) {
-			free(job_arr);
-			job_arr = NULL;
+
+		if (jobs_by_name.empty()) {
+			int n;
+
+			for (n = 0; sinfo->jobs[n] != NULL; n++)
+				jobs_by_name.emplace(sinfo->jobs[n]->name, sinfo->jobs[n]);
+		}
+
+		free(jinfo->dependent_jobs);
+		jinfo->dependent_jobs = static_cast<resource_resv **>(calloc(grp->second.size() + 1, sizeof(resource_resv *)));
+		if (jinfo->dependent_jobs == NULL) {
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG, __func__, MEM_ERR_MSG);
+			continue;
+		}
+		/* jobs of the group not known to us are left out */
+		for (j = 0, k = 0; j < grp->second.size(); j++) {
+			auto job = jobs_by_name.find(grp->second[j]);
+			if (job != jobs_by_name.end())
+				jinfo->dependent_jobs[k++] = job->second;
 		}
 	}
-	return;
+	runone_groups.swap(new_groups);
+}
+
+/**
+ * @brief   This function associates the jobs of a copied server with the jobs
+ *	    of their runone dependency, the same way as the jobs of the server
+ *	    they were copied from.
+ * @param[in] nsinfo - the copied server
+ * @param[in] osinfo - the server copied from
+ *
+ * @return - void
+ */
+void dup_dependent_jobs(server_info *nsinfo, server_info *osinfo) {
+	int i;
+
+	if (nsinfo == NULL || osinfo == NULL || nsinfo->jobs == NULL)
+		return;
+	for (i = 0; nsinfo->jobs[i] != NULL; i++) {
+		resource_resv *njob = nsinfo->jobs[i];
+		resource_resv *ojob;
+
+		ojob = find_resource_resv_by_indrank(osinfo->all_resresv, njob->resresv_ind, njob->rank);
+		if (ojob == NULL || ojob->job->dependent_jobs == NULL)
+			continue;
+		free(njob->job->dependent_jobs);
+		njob->job->dependent_jobs = copy_resresv_array(ojob->job->dependent_jobs, nsinfo->all_resresv);
+	}
 }
 
 /**
@@ -59,6 +59,12 @@ void query_jobs_chunk(th_data_query_jinfo *data);
 /* create an array of jobs for a particular queue */
 resource_resv **query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs, char *queue_name);
 
+/* ask for the jobs of a queue ahead of query_jobs() */
+void prefetch_jobs(int pbs_sd, char *queue_name);
+
+/* drop the prefetched job queries query_jobs() did not use */
+void discard_prefetched_jobs(int pbs_sd);
+
 
 /*
  *	new_job_info  - allocate and initialize new job_info structure
@@ -86,9 +92,18 @@ int
 update_job_attr(int pbs_sd, resource_resv *resresv, const char *attr_name,
 	const char *attr_resc, const char *attr_value, struct attrl *extra, unsigned int flags );
 
-/* send delayed job attribute updates for job using send_attr_updates() */
+/* queue delayed job attribute updates for job to be sent by flush_job_updates() */
 int send_job_updates(int pbs_sd, resource_resv *job);
 
+/* send all queued job attribute updates and subjob runs to the server */
+int flush_job_updates(void);
+
+/* queue the run of a subjob to be sent by flush_subjob_runs() */
+int queue_subjob_run(int pbs_sd, resource_resv *rjob, char *execvnode);
+
+/* send the queued subjob runs to the server in one request */
+int flush_subjob_runs(void);
+
 /* send delayed attributes to the server for a job */
 int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr);
 
@@ -244,11 +259,17 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 	queue_info *qinfo);
 /*
  *	formula_evaluate - evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ *		NOTE: simple arithmetic formulas are compiled and cached, anything
+ *		      else is done through embedded python interpreter
  */
 
 sch_resource_t formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq);
 
+/*
+ *	clear_formula_cache - free the compiled formulas
+ */
+void clear_formula_cache(void);
+
 /*
  *
  *      update_accruetype - Updates accrue_type of job on server.
@@ -381,6 +402,18 @@ resdef **create_resresv_sets_resdef(status *policy, server_info *sinfo);
 
 /* Create an array of resresv_sets based on sinfo*/
 resresv_set **create_resresv_sets(status *policy, server_info *sinfo);
+
+/* start reusing the last cycle's resresv_set failures if the universe hasn't changed */
+void start_resresv_set_failures(status *policy, server_info *sinfo);
+
+/* remember why a resresv_set could not run for the next cycle */
+void save_resresv_set_failure(server_info *sinfo, resresv_set *rset);
+
+/* mark a resresv_set can not run if it failed the same way last cycle */
+int find_resresv_set_failure(server_info *sinfo, resresv_set *rset);
+
+/* forget all the resresv_set failures */
+void clear_resresv_set_failures(void);
 /*
  * This function creates a string and update resources_released job
  *  attribute.
@@ -412,6 +445,12 @@ resource_resv **filter_preemptable_jobs(resource_resv **arr, resource_resv *job,
  */
 void associate_dependent_jobs(server_info *sinfo);
 
+/*
+ * This function associates the jobs of a copied server with the jobs of
+ * their runone dependency, as they are on the server copied from.
+ */
+void dup_dependent_jobs(server_info *nsinfo, server_info *osinfo);
+
 /* This function associated the job passed in to its parent job */
 int associate_array_parent(resource_resv *pjob, server_info *sinfo);
 
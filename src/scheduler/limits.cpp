@@ -91,10 +91,9 @@
  * 	lim_setrunlimits()
  * 	lim_setoldlimits()
  * 	lim_dup_ctx()
+ * 	lim_ctx_to_str()
+ * 	lim_liminfo_to_str()
  * 	is_hardlimit()
- * 	lim_gengroupreskey()
- * 	lim_genprojectreskey()
- * 	lim_genuserreskey()
  * 	lim_callback()
  * 	lim_get()
  * 	schderr_args_q()
@@ -367,9 +366,6 @@ static int
 lim_callback(void *, enum lim_keytypes, char *, char *,
 	char *, char *);
 static void		*lim_dup_ctx(void *);
-static char		*lim_gengroupreskey(const char *);
-static char		*lim_genprojectreskey(const char *);
-static char		*lim_genuserreskey(const char *);
 static void		schderr_args_q(const char *, const char *, schd_error *);
 static void
 schderr_args_q_res(const char *, const char *, char *,
@@ -378,7 +374,7 @@ static void		schderr_args_server(const char *, schd_error *);
 static void
 schderr_args_server_res(const char *, const char *,
 	schd_error *);
-static sch_resource_t	lim_get(const char *, void *);
+static sch_resource_t	lim_get(enum lim_keytypes, const char *, const char *, void *);
 static int		lim_setoldlimits(const struct attrl *, void *);
 static int		lim_setreslimits(const struct attrl *, void *);
 static int		lim_setrunlimits(const struct attrl *, void *);
@@ -719,6 +715,68 @@ has_softlimits(void *p)
 
 	return (0);
 }
+/**
+ * @brief
+ *		append every key=value pair of a limit storage context to a string
+ *
+ * @param[in]	ctx	-	the limit storage context
+ * @param[in,out]	str	-	string to append to
+ * @param[in,out]	size	-	size of str
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+lim_ctx_to_str(void *ctx, char **str, int *size)
+{
+	char *key = NULL;
+	char *value;
+
+	while ((value = static_cast<char *>(entlim_get_next(ctx, (void **)&key))) != NULL) {
+		if (pbs_strcat(str, size, key) == NULL ||
+		    pbs_strcat(str, size, "=") == NULL ||
+		    pbs_strcat(str, size, value) == NULL ||
+		    pbs_strcat(str, size, ",") == NULL) {
+			free(key);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ *		create a string of all the limits set in a limit storage
+ *
+ * @param[in]	p	-	the limit storage
+ *
+ * @return	char *
+ * @retval	string of the limits (must be freed by caller)
+ * @retval	NULL	: on error
+ */
+char *
+lim_liminfo_to_str(void *p)
+{
+	struct limit_info	*lip = static_cast<limit_info *>(p);
+	char *str = NULL;
+	int size = 0;
+
+	if (lip == NULL)
+		return NULL;
+
+	if (pbs_strcat(&str, &size, "hard:") == NULL)
+		return NULL;
+	if (!lim_ctx_to_str(LI2RESCTX(lip), &str, &size) ||
+	    pbs_strcat(&str, &size, "soft:") == NULL ||
+	    !lim_ctx_to_str(LI2RESCTXSOFT(lip), &str, &size)) {
+		free(str);
+		return NULL;
+	}
+
+	return str;
+}
+
 /**
  * @brief
  *		create a new limit count structure and initialize it.
@@ -1257,7 +1315,6 @@ static int
 check_server_max_user_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*user = rr->user;
 	int		used;
 	int		max_user_run, max_genuser_run;
@@ -1271,15 +1328,9 @@ check_server_max_user_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = sc->user;
 
-	if ((key = entlim_mk_runkey(LIM_USER, user)) == NULL)
-		return (SCHD_ERROR);
-	max_user_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_user_run = (int) lim_get(LIM_USER, user, NULL, LI2RUNCTX(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_USER, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_genuser_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_genuser_run = (int) lim_get(LIM_USER, genparam, NULL, LI2RUNCTX(si->liminfo));
 
 	if ((max_user_run == SCHD_INFINITY) &&
 		(max_genuser_run == SCHD_INFINITY))
@@ -1327,7 +1378,6 @@ static int
 check_server_max_group_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*group = rr->group;
 	int		used;
 	int		max_group_run, max_gengroup_run;
@@ -1341,15 +1391,9 @@ check_server_max_group_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = sc->group;
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, group)) == NULL)
-		return (SCHD_ERROR);
-	max_group_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_group_run = (int) lim_get(LIM_GROUP, group, NULL, LI2RUNCTX(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_gengroup_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_gengroup_run = (int) lim_get(LIM_GROUP, genparam, NULL, LI2RUNCTX(si->liminfo));
 
 	if ((max_group_run == SCHD_INFINITY) &&
 		(max_gengroup_run == SCHD_INFINITY))
@@ -1509,7 +1553,6 @@ static int
 check_queue_max_user_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*user = rr->user;
 	int		used;
 	int		max_user_run, max_genuser_run;
@@ -1523,15 +1566,9 @@ check_queue_max_user_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = qc->user;
 
-	if ((key = entlim_mk_runkey(LIM_USER, user)) == NULL)
-		return (SCHD_ERROR);
-	max_user_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_user_run = (int) lim_get(LIM_USER, user, NULL, LI2RUNCTX(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_USER, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_genuser_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_genuser_run = (int) lim_get(LIM_USER, genparam, NULL, LI2RUNCTX(qi->liminfo));
 
 	if ((max_user_run == SCHD_INFINITY) &&
 		(max_genuser_run == SCHD_INFINITY))
@@ -1579,7 +1616,6 @@ static int
 check_queue_max_group_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*group = rr->group;
 	int		used;
 	int		max_group_run, max_gengroup_run;
@@ -1593,15 +1629,9 @@ check_queue_max_group_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = qc->group;
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, group)) == NULL)
-		return (SCHD_ERROR);
-	max_group_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_group_run = (int) lim_get(LIM_GROUP, group, NULL, LI2RUNCTX(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_gengroup_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_gengroup_run = (int) lim_get(LIM_GROUP, genparam, NULL, LI2RUNCTX(qi->liminfo));
 
 	if ((max_group_run == SCHD_INFINITY) &&
 		(max_gengroup_run == SCHD_INFINITY))
@@ -1763,7 +1793,6 @@ static int
 check_queue_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*reskey;
 	sch_resource_t	max_res;
 	sch_resource_t	used;
 	schd_resource	*res;
@@ -1788,11 +1817,7 @@ check_queue_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if ((req = find_resource_req(rr->resreq, res->def)) == NULL)
 			continue;
 
-		if ((reskey = entlim_mk_reskey(LIM_OVERALL, allparam,
-			res->name)) == NULL)
-			return (SCHD_ERROR);
-		max_res = lim_get(reskey, LI2RESCTX(qi->liminfo));
-		free(reskey);
+		max_res = lim_get(LIM_OVERALL, allparam, res->name, LI2RESCTX(qi->liminfo));
 
 		if (max_res == SCHD_INFINITY)
 			continue;
@@ -1837,7 +1862,6 @@ static int
 check_server_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*reskey;
 	sch_resource_t	max_res;
 	sch_resource_t	used;
 	schd_resource	*res;
@@ -1862,11 +1886,7 @@ check_server_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if ((req = find_resource_req(rr->resreq, res->def)) == NULL)
 			continue;
 
-		if ((reskey = entlim_mk_reskey(LIM_OVERALL, allparam,
-			res->name)) == NULL)
-			return (SCHD_ERROR);
-		max_res = lim_get(reskey, LI2RESCTX(si->liminfo));
-		free(reskey);
+		max_res = lim_get(LIM_OVERALL, allparam, res->name, LI2RESCTX(si->liminfo));
 
 		if (max_res == SCHD_INFINITY)
 			continue;
@@ -1911,7 +1931,6 @@ check_server_max_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
 	int	max_running;
-	char	*key;
 	counts	*cts = NULL;
 	int	running;
 
@@ -1923,10 +1942,7 @@ check_server_max_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = sc->all;
 
-	if ((key = entlim_mk_runkey(LIM_OVERALL, allparam)) == NULL)
-		return (SCHD_ERROR);
-	max_running = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_running = (int) lim_get(LIM_OVERALL, allparam, NULL, LI2RUNCTX(si->liminfo));
 
 
 	running = find_counts_elm(cts, PBS_ALL_ENTITY, NULL, NULL, NULL);
@@ -1965,7 +1981,6 @@ check_queue_max_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
 	int	max_running;
-	char	*key;
 	counts	*cts = NULL;
 	int	running;
 
@@ -1977,11 +1992,7 @@ check_queue_max_run(server_info *si, queue_info *qi, resource_resv *rr,
 
 	cts = qc->all;
 
-	if ((key = entlim_mk_runkey(LIM_OVERALL, allparam)) == NULL)
-		return (SCHD_ERROR);
-
-	max_running = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_running = (int) lim_get(LIM_OVERALL, allparam, NULL, LI2RUNCTX(qi->liminfo));
 
 
 	running = find_counts_elm(cts, PBS_ALL_ENTITY, NULL, NULL, NULL);
@@ -2016,7 +2027,6 @@ static int
 check_queue_max_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 {
 	int	max_running;
-	char	*key;
 	counts	*cnt = NULL;
 	int used = 0;
 
@@ -2027,10 +2037,7 @@ check_queue_max_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 	if (!qi->has_all_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_OVERALL, allparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_running = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_running = (int) lim_get(LIM_OVERALL, allparam, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
 	/* at this point, we know a limit is set for PBS_ALL*/
 	used = find_counts_elm(qi->alljobcounts, PBS_ALL_ENTITY, NULL, &cnt, NULL);
@@ -2065,7 +2072,6 @@ check_queue_max_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 static int
 check_queue_max_user_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 {
-	char		*key;
 	char		*user = rr->user;
 	int		used;
 	int		max_user_run_soft, max_genuser_run_soft;
@@ -2077,15 +2083,9 @@ check_queue_max_user_run_soft(server_info *si, queue_info *qi, resource_resv *rr
 	if (!qi->has_user_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_USER, user)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_user_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_user_run_soft = (int) lim_get(LIM_USER, user, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_USER, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_genuser_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_genuser_run_soft = (int) lim_get(LIM_USER, genparam, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
 	if ((max_user_run_soft == SCHD_INFINITY) &&
 		(max_genuser_run_soft == SCHD_INFINITY))
@@ -2139,7 +2139,6 @@ static int
 check_queue_max_group_run_soft(server_info *si, queue_info *qi,
 	resource_resv *rr)
 {
-	char		*key;
 	char		*group = rr->group;
 	int		used;
 	int		max_group_run_soft, max_gengroup_run_soft;
@@ -2151,15 +2150,9 @@ check_queue_max_group_run_soft(server_info *si, queue_info *qi,
 	if (!qi->has_grp_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, group)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_group_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_group_run_soft = (int) lim_get(LIM_GROUP, group, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_gengroup_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_gengroup_run_soft = (int) lim_get(LIM_GROUP, genparam, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
 	if ((max_group_run_soft == SCHD_INFINITY) &&
 		(max_gengroup_run_soft == SCHD_INFINITY))
@@ -2271,7 +2264,6 @@ static int
 check_server_max_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 {
 	int	max_running;
-	char	*key;
 	counts	*cnt = NULL;
 	int used = 0;
 
@@ -2281,10 +2273,7 @@ check_server_max_run_soft(server_info *si, queue_info *qi, resource_resv *rr)
 	if (!si->has_all_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_OVERALL, allparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_running = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_running = (int) lim_get(LIM_OVERALL, allparam, NULL, LI2RUNCTXSOFT(si->liminfo));
 
 	/* at this point, we know a limit is set for PBS_ALL*/
 	used = find_counts_elm(si->alljobcounts, PBS_ALL_ENTITY , NULL, &cnt, NULL);
@@ -2319,7 +2308,6 @@ static int
 check_server_max_user_run_soft(server_info *si, queue_info *qi,
 	resource_resv *rr)
 {
-	char		*key;
 	char		*user = rr->user;
 	int		used;
 	int		max_user_run_soft, max_genuser_run_soft;
@@ -2331,15 +2319,9 @@ check_server_max_user_run_soft(server_info *si, queue_info *qi,
 	if (!si->has_user_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_USER, user)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_user_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_user_run_soft = (int) lim_get(LIM_USER, user, NULL, LI2RUNCTXSOFT(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_USER, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_genuser_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_genuser_run_soft = (int) lim_get(LIM_USER, genparam, NULL, LI2RUNCTXSOFT(si->liminfo));
 
 	if ((max_user_run_soft == SCHD_INFINITY) &&
 		(max_genuser_run_soft == SCHD_INFINITY))
@@ -2392,7 +2374,6 @@ static int
 check_server_max_group_run_soft(server_info *si, queue_info *qi,
 	resource_resv *rr)
 {
-	char		*key;
 	char		*group = rr->group;
 	int		used;
 	int		max_group_run_soft, max_gengroup_run_soft;
@@ -2404,15 +2385,9 @@ check_server_max_group_run_soft(server_info *si, queue_info *qi,
 	if (!si->has_grp_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, group)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_group_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_group_run_soft = (int) lim_get(LIM_GROUP, group, NULL, LI2RUNCTXSOFT(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_GROUP, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_gengroup_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_gengroup_run_soft = (int) lim_get(LIM_GROUP, genparam, NULL, LI2RUNCTXSOFT(si->liminfo));
 
 	if ((max_group_run_soft == SCHD_INFINITY) &&
 		(max_gengroup_run_soft == SCHD_INFINITY))
@@ -2524,7 +2499,6 @@ check_server_max_group_res_soft(server_info *si, queue_info *qi,
 static int
 check_server_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 {
-	char		*reskey;
 	sch_resource_t	max_res_soft;
 	sch_resource_t	used;
 	schd_resource	*res;
@@ -2543,11 +2517,7 @@ check_server_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if ((req = find_resource_req(rr->resreq, res->def)) == NULL)
 			continue;
 
-		if ((reskey = entlim_mk_reskey(LIM_OVERALL, allparam,
-			res->name)) == NULL)
-			return (PREEMPT_TO_BIT(PREEMPT_ERR));
-		max_res_soft = lim_get(reskey, LI2RESCTXSOFT(si->liminfo));
-		free(reskey);
+		max_res_soft = lim_get(LIM_OVERALL, allparam, res->name, LI2RESCTXSOFT(si->liminfo));
 
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
@@ -2593,7 +2563,6 @@ check_server_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 static int
 check_queue_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 {
-	char		*reskey;
 	sch_resource_t	max_res_soft;
 	sch_resource_t	used;
 	schd_resource	*res;
@@ -2612,11 +2581,7 @@ check_queue_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if ((req = find_resource_req(rr->resreq, res->def)) == NULL)
 			continue;
 
-		if ((reskey = entlim_mk_reskey(LIM_OVERALL, allparam,
-			res->name)) == NULL)
-			return (PREEMPT_TO_BIT(PREEMPT_ERR));
-		max_res_soft = lim_get(reskey, LI2RESCTXSOFT(qi->liminfo));
-		free(reskey);
+		max_res_soft = lim_get(LIM_OVERALL, allparam, res->name, LI2RESCTXSOFT(qi->liminfo));
 
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
@@ -2664,8 +2629,6 @@ static int
 check_max_group_res(resource_resv *rr, counts *cts_list,
 	resdef **rdef, void *limitctx)
 {
-	char		*groupreskey;
-	char		*gengroupreskey;
 	char		*group = rr->group;
 	resource_req	*req;
 	schd_resource	*res;
@@ -2683,17 +2646,10 @@ check_max_group_res(resource_resv *rr, counts *cts_list,
 			continue;
 
 		/* individual group limit check */
-		if ((groupreskey = entlim_mk_reskey(LIM_GROUP, group,
-			res->name)) == NULL)
-			return (-1);
-		max_group_res = lim_get(groupreskey, limitctx);
-		free(groupreskey);
+		max_group_res = lim_get(LIM_GROUP, group, res->name, limitctx);
 
 		/* generic group limit check */
-		if ((gengroupreskey = lim_gengroupreskey(res->name)) == NULL)
-			return (-1);
-		max_gengroup_res = lim_get(gengroupreskey, limitctx);
-		free(gengroupreskey);
+		max_gengroup_res = lim_get(LIM_GROUP, genparam, res->name, limitctx);
 
 		if ((max_group_res == SCHD_INFINITY) &&
 			(max_gengroup_res == SCHD_INFINITY))
@@ -2740,8 +2696,6 @@ check_max_group_res(resource_resv *rr, counts *cts_list,
 static int
 check_max_group_res_soft(resource_resv *rr, counts *cts_list, void *limitctx, int preempt_bit)
 {
-	char		*groupreskey;
-	char		*gengroupreskey;
 	char		*group = rr->group;
 	resource_req	*req;
 	schd_resource	*res;
@@ -2761,17 +2715,10 @@ check_max_group_res_soft(resource_resv *rr, counts *cts_list, void *limitctx, in
 			continue;
 
 		/* individual group limit check */
-		if ((groupreskey = entlim_mk_reskey(LIM_GROUP, group,
-			res->name)) == NULL)
-			return (-1);
-		max_group_res_soft = lim_get(groupreskey, limitctx);
-		free(groupreskey);
+		max_group_res_soft = lim_get(LIM_GROUP, group, res->name, limitctx);
 
 		/* generic group limit check */
-		if ((gengroupreskey = lim_gengroupreskey(res->name)) == NULL)
-			return (-1);
-		max_gengroup_res_soft = lim_get(gengroupreskey, limitctx);
-		free(gengroupreskey);
+		max_gengroup_res_soft = lim_get(LIM_GROUP, genparam, res->name, limitctx);
 
 		if ((max_group_res_soft == SCHD_INFINITY) &&
 			(max_gengroup_res_soft == SCHD_INFINITY))
@@ -2828,8 +2775,6 @@ static int
 check_max_user_res(resource_resv *rr, counts *cts_list, resdef **rdef,
 	void *limitctx)
 {
-	char		*userreskey;
-	char		*genuserreskey;
 	char		*user = rr->user;
 	resource_req	*req;
 	schd_resource	*res;
@@ -2847,17 +2792,10 @@ check_max_user_res(resource_resv *rr, counts *cts_list, resdef **rdef,
 			continue;
 
 		/* individual user limit check */
-		if ((userreskey = entlim_mk_reskey(LIM_USER, user,
-			res->name)) == NULL)
-			return (-1);
-		max_user_res = lim_get(userreskey, limitctx);
-		free(userreskey);
+		max_user_res = lim_get(LIM_USER, user, res->name, limitctx);
 
 		/* generic user limit check */
-		if ((genuserreskey = lim_genuserreskey(res->name)) == NULL)
-			return (-1);
-		max_genuser_res = lim_get(genuserreskey, limitctx);
-		free(genuserreskey);
+		max_genuser_res = lim_get(LIM_USER, genparam, res->name, limitctx);
 
 		if ((max_user_res == SCHD_INFINITY) &&
 			(max_genuser_res == SCHD_INFINITY))
@@ -2906,8 +2844,6 @@ static int
 check_max_user_res_soft(resource_resv **rr_arr, resource_resv *rr,
 	counts *cts_list, void *limitctx, int preempt_bit)
 {
-	char		*userreskey;
-	char		*genuserreskey;
 	char		*user = rr->user;
 	resource_req	*req;
 	schd_resource	*res;
@@ -2927,17 +2863,10 @@ check_max_user_res_soft(resource_resv **rr_arr, resource_resv *rr,
 			continue;
 
 		/* individual user limit check */
-		if ((userreskey = entlim_mk_reskey(LIM_USER, user,
-			res->name)) == NULL)
-			return (-1);
-		max_user_res_soft = lim_get(userreskey, limitctx);
-		free(userreskey);
+		max_user_res_soft = lim_get(LIM_USER, user, res->name, limitctx);
 
 		/* generic user limit check */
-		if ((genuserreskey = lim_genuserreskey(res->name)) == NULL)
-			return (-1);
-		max_genuser_res_soft = lim_get(genuserreskey, limitctx);
-		free(genuserreskey);
+		max_genuser_res_soft = lim_get(LIM_USER, genparam, res->name, limitctx);
 
 		if ((max_user_res_soft == SCHD_INFINITY) &&
 			(max_genuser_res_soft == SCHD_INFINITY))
@@ -3239,54 +3168,6 @@ is_hardlimit(const struct attrl *a)
 		return (0);
 }
 
-/**
- * @brief
- *		lim_gengroupreskey	special-purpose shortcut function to construct a
- *				generic group resource key
- *
- * @param[in]	res	-	the resource
- *
- * @return	a resource limit key if successful
- * @retval	NULL	: if not
- */
-static char *
-lim_gengroupreskey(const char *res)
-{
-	return (entlim_mk_reskey(LIM_GROUP, genparam, res));
-}
-
-/**
- * @brief
- *		lim_genprojectreskey	special-purpose shortcut function to construct a
- *				generic project resource key
- *
- * @param[in]	res	-	the resource
- *
- * @return	a resource limit key if successful
- * @retval	NULL	: if not
- */
-static char *
-lim_genprojectreskey(const char *res)
-{
-	return (entlim_mk_reskey(LIM_PROJECT, genparam, res));
-}
-
-/**
- * @brief
- *		lim_genuserreskey	special-purpose shortcut function to construct a
- *				generic user resource key
- *
- * @param[in]	res	-	the resource
- *
- * @return	a resource limit key on success
- * @retval	NULL	: on failure
- */
-static char *
-lim_genuserreskey(const char *res)
-{
-	return (entlim_mk_reskey(LIM_USER, genparam, res));
-}
-
 /**
  * @brief
  *		lim_callback install a new key of the given type and value
@@ -3348,19 +3229,25 @@ lim_callback(void *ctx, enum lim_keytypes kt, char *param, char *namestring,
  * @brief
  *		lim_get	fetch a limit value
  *
- * @param[in]	param	-	the requested limit
+ * @param[in]	kt	-	the entity type of the requested limit
+ * @param[in]	entity	-	the entity name, genparam or allparam
+ * @param[in]	res	-	the resource limited, NULL for a run limit
  * @param[in]	ctx	-	the limit storage context
  *
  * @return	sch_resource_t
  * @retval	the value of the limit, if no error occurs fetching it
  * @retval	SCHD_INFINITY if no such limit exists in the named context
+ *
+ * @par	The limit is found by entity and interned resource id, without
+ *	building its key string.
  */
 static sch_resource_t
-lim_get(const char *param, void *ctx)
+lim_get(enum lim_keytypes kt, const char *entity, const char *res, void *ctx)
 {
 	char		*retptr;
 
-	retptr = static_cast<char *>(entlim_get(param, ctx));
+	retptr = static_cast<char *>(entlim_get_id(ctx, kt, entity,
+		res != NULL ? entlim_resc_id(res) : ENTLIM_RUN_ID));
 	if (retptr != NULL) {
 		sch_resource_t	v;
 
@@ -3459,8 +3346,6 @@ static int
 check_max_project_res(resource_resv *rr, counts *cts_list,
 	resdef **rdef, void *limitctx)
 {
-	char		*projectreskey;
-	char		*genprojectreskey;
 	resource_req	*req;
 	schd_resource	*res;
 	char		*project;
@@ -3479,17 +3364,10 @@ check_max_project_res(resource_resv *rr, counts *cts_list,
 			continue;
 
 		/* individual project limit check */
-		if ((projectreskey = entlim_mk_reskey(LIM_PROJECT,
-			project, res->name)) == NULL)
-			return (-1);
-		max_project_res = lim_get(projectreskey, limitctx);
-		free(projectreskey);
+		max_project_res = lim_get(LIM_PROJECT, project, res->name, limitctx);
 
 		/* generic project limit check */
-		if ((genprojectreskey = lim_genprojectreskey(res->name)) == NULL)
-			return (-1);
-		max_genproject_res = lim_get(genprojectreskey, limitctx);
-		free(genprojectreskey);
+		max_genproject_res = lim_get(LIM_PROJECT, genparam, res->name, limitctx);
 
 		if ((max_project_res == SCHD_INFINITY) &&
 			(max_genproject_res == SCHD_INFINITY))
@@ -3536,8 +3414,6 @@ check_max_project_res(resource_resv *rr, counts *cts_list,
 static int
 check_max_project_res_soft(resource_resv *rr, counts *cts_list, void *limitctx, int preempt_bit)
 {
-	char		*projectreskey;
-	char		*genprojectreskey;
 	char		*project;
 	resource_req	*req;
 	schd_resource	*res;
@@ -3558,17 +3434,10 @@ check_max_project_res_soft(resource_resv *rr, counts *cts_list, void *limitctx,
 			continue;
 
 		/* individual project limit check */
-		if ((projectreskey = entlim_mk_reskey(LIM_PROJECT, project,
-			res->name)) == NULL)
-			return (-1);
-		max_project_res_soft = lim_get(projectreskey, limitctx);
-		free(projectreskey);
+		max_project_res_soft = lim_get(LIM_PROJECT, project, res->name, limitctx);
 
 		/* generic project limit check */
-		if ((genprojectreskey = lim_genprojectreskey(res->name)) == NULL)
-			return (-1);
-		max_genproject_res_soft = lim_get(genprojectreskey, limitctx);
-		free(genprojectreskey);
+		max_genproject_res_soft = lim_get(LIM_PROJECT, genparam, res->name, limitctx);
 
 		if ((max_project_res_soft == SCHD_INFINITY) &&
 			(max_genproject_res_soft == SCHD_INFINITY))
@@ -3687,7 +3556,6 @@ static int
 check_server_max_project_run_soft(server_info *si, queue_info *qi,
 	resource_resv *rr)
 {
-	char		*key;
 	char		*project;
 	int		used;
 	int		max_project_run_soft, max_genproject_run_soft;
@@ -3703,15 +3571,9 @@ check_server_max_project_run_soft(server_info *si, queue_info *qi,
 	    return (0);
 
 	project = rr->project;
-	if ((key = entlim_mk_runkey(LIM_PROJECT, project)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_project_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_project_run_soft = (int) lim_get(LIM_PROJECT, project, NULL, LI2RUNCTXSOFT(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_PROJECT, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_genproject_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(si->liminfo));
-	free(key);
+	max_genproject_run_soft = (int) lim_get(LIM_PROJECT, genparam, NULL, LI2RUNCTXSOFT(si->liminfo));
 
 	if ((max_project_run_soft == SCHD_INFINITY) &&
 		(max_genproject_run_soft == SCHD_INFINITY))
@@ -3854,7 +3716,6 @@ static int
 check_queue_max_project_run_soft(server_info *si, queue_info *qi,
 	resource_resv *rr)
 {
-	char		*key;
 	char		*project;
 	int		used;
 	int		max_project_run_soft, max_genproject_run_soft;
@@ -3870,15 +3731,9 @@ check_queue_max_project_run_soft(server_info *si, queue_info *qi,
 	    return (0);
 
 	project = rr->project;
-	if ((key = entlim_mk_runkey(LIM_PROJECT, project)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_project_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_project_run_soft = (int) lim_get(LIM_PROJECT, project, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_PROJECT, genparam)) == NULL)
-		return (PREEMPT_TO_BIT(PREEMPT_ERR));
-	max_genproject_run_soft = (int) lim_get(key, LI2RUNCTXSOFT(qi->liminfo));
-	free(key);
+	max_genproject_run_soft = (int) lim_get(LIM_PROJECT, genparam, NULL, LI2RUNCTXSOFT(qi->liminfo));
 
 	if ((max_project_run_soft == SCHD_INFINITY) &&
 		(max_genproject_run_soft == SCHD_INFINITY))
@@ -3967,7 +3822,6 @@ static int
 check_server_max_project_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*project;
 	int		used;
 	int		max_project_run, max_genproject_run;
@@ -3985,15 +3839,9 @@ check_server_max_project_run(server_info *si, queue_info *qi, resource_resv *rr,
 	    return (0);
 
 	project = rr->project;
-	if ((key = entlim_mk_runkey(LIM_PROJECT, project)) == NULL)
-		return (SCHD_ERROR);
-	max_project_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_project_run = (int) lim_get(LIM_PROJECT, project, NULL, LI2RUNCTX(si->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_PROJECT, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_genproject_run = (int) lim_get(key, LI2RUNCTX(si->liminfo));
-	free(key);
+	max_genproject_run = (int) lim_get(LIM_PROJECT, genparam, NULL, LI2RUNCTX(si->liminfo));
 
 	if ((max_project_run == SCHD_INFINITY) &&
 		(max_genproject_run == SCHD_INFINITY))
@@ -4044,7 +3892,6 @@ static int
 check_queue_max_project_run(server_info *si, queue_info *qi, resource_resv *rr,
 	limcounts *sc, limcounts *qc, schd_error *err)
 {
-	char		*key;
 	char		*project;
 	int		used;
 	int		max_project_run, max_genproject_run;
@@ -4062,15 +3909,9 @@ check_queue_max_project_run(server_info *si, queue_info *qi, resource_resv *rr,
 	if (!qi->has_proj_limit)
 	    return (0);
 
-	if ((key = entlim_mk_runkey(LIM_PROJECT, project)) == NULL)
-		return (SCHD_ERROR);
-	max_project_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_project_run = (int) lim_get(LIM_PROJECT, project, NULL, LI2RUNCTX(qi->liminfo));
 
-	if ((key = entlim_mk_runkey(LIM_PROJECT, genparam)) == NULL)
-		return (SCHD_ERROR);
-	max_genproject_run = (int) lim_get(key, LI2RUNCTX(qi->liminfo));
-	free(key);
+	max_genproject_run = (int) lim_get(LIM_PROJECT, genparam, NULL, LI2RUNCTX(qi->liminfo));
 
 	if ((max_project_run == SCHD_INFINITY) &&
 		(max_genproject_run == SCHD_INFINITY))
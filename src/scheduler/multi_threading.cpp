@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
 #include <signal.h>
 
@@ -60,6 +61,10 @@
 #include "resource_resv.h"
 #include "multi_threading.h"
 
+/* with pinned threads, the work queued for each worker thread by
+ * queue_work_for_thread().  Indexed by thread id, 0 is unused.
+ */
+static ds_queue **thread_queues = NULL;
 
 /**
  * @brief	initialize a mutex attr object
@@ -117,6 +122,90 @@ create_id_key(void)
 	pthread_setspecific(th_id_key, (void *) mainid);
 }
 
+/**
+ * @brief	free the per-thread work queues
+ *
+ * @return	void
+ */
+static void
+free_thread_queues(void)
+{
+	int i;
+
+	if (thread_queues == NULL)
+		return;
+
+	for (i = 1; i <= num_threads; i++)
+		free_ds_queue(thread_queues[i]);
+	free(thread_queues);
+	thread_queues = NULL;
+}
+
+/**
+ * @brief	create the per-thread work queues
+ *
+ * @return	int
+ * @retval	1 for success
+ * @retval	0 for malloc error
+ */
+static int
+create_thread_queues(void)
+{
+	int i;
+
+	thread_queues = static_cast<ds_queue **>(calloc(num_threads + 1, sizeof(ds_queue *)));
+	if (thread_queues == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	for (i = 1; i <= num_threads; i++) {
+		if ((thread_queues[i] = new_ds_queue()) == NULL) {
+			free_thread_queues();
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief	pin the calling worker thread to one of the cpus the scheduler
+ *		may run on.  Workers are handed the cpus in turn.  Since memory is
+ *		placed on the NUMA node of the cpu which first touches it, the
+ *		nodes a worker allocates stay local to it.
+ *
+ * @param[in]	ntid - thread id of the calling worker thread
+ *
+ * @return	void
+ */
+static void
+pin_thread(int ntid)
+{
+#if defined (linux)
+	cpu_set_t allowed;
+	cpu_set_t cpu;
+	int n;
+	int c;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) <= 1)
+		return;
+
+	n = (ntid - 1) % CPU_COUNT(&allowed);
+	for (c = 0; c < CPU_SETSIZE; c++)
+		if (CPU_ISSET(c, &allowed) && n-- == 0)
+			break;
+
+	CPU_ZERO(&cpu);
+	CPU_SET(c, &cpu);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(cpu), &cpu) != 0)
+		log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_SCHED, LOG_ERR, __func__,
+			"Unable to pin thread %d to cpu %d", ntid, c);
+	else
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Thread %d pinned to cpu %d", ntid, c);
+#endif
+}
+
 /**
  * @brief	convenience function to kill worker threads
  *
@@ -149,6 +238,7 @@ kill_threads(void)
 	free(threads);
 	free_ds_queue(work_queue);
 	free_ds_queue(result_queue);
+	free_thread_queues();
 	threads = NULL;
 	num_threads = 0;
 	work_queue = NULL;
@@ -202,6 +292,7 @@ init_multi_threading(int nthreads)
 	else
 		num_threads = nthreads;
 
+	threads_pinned = conf.pin_threads;
 	if (num_threads <= 1) {
 		num_threads = 1;
 		return 1; /* main thread will act as the only worker thread */
@@ -229,6 +320,14 @@ init_multi_threading(int nthreads)
 		work_queue = NULL;
 		return 0;
 	}
+	if (threads_pinned && !create_thread_queues()) {
+		free(threads);
+		free_ds_queue(work_queue);
+		free_ds_queue(result_queue);
+		work_queue = NULL;
+		result_queue = NULL;
+		return 0;
+	}
 
 	pthread_once(&key_once, create_id_key);
 	for (i = 0; i < num_threads; i++) {
@@ -239,6 +338,7 @@ init_multi_threading(int nthreads)
 			free(threads);
 			free_ds_queue(work_queue);
 			free_ds_queue(result_queue);
+			free_thread_queues();
 			work_queue = NULL;
 			result_queue = NULL;
 			log_err(errno, __func__, MEM_ERR_MSG);
@@ -251,6 +351,61 @@ init_multi_threading(int nthreads)
 	return 1;
 }
 
+/**
+ * @brief	run a task on the calling thread
+ *
+ * @param[in]	work - the task to run
+ * @param[in]	ntid - thread id of the calling thread (for logging)
+ *
+ * @return void
+ */
+static void
+execute_task(th_task_info *work, int ntid)
+{
+	char buf[1024];
+
+	switch (work->task_type) {
+	case TS_IS_ND_ELIGIBLE:
+		snprintf(buf, sizeof(buf), "Thread %d calling check_node_eligibility_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		check_node_eligibility_chunk((th_data_nd_eligible *) work->thread_data);
+		break;
+	case TS_DUP_ND_INFO:
+		snprintf(buf, sizeof(buf), "Thread %d calling dup_node_info_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		dup_node_info_chunk((th_data_dup_nd_info *) work->thread_data);
+		break;
+	case TS_QUERY_ND_INFO:
+		snprintf(buf, sizeof(buf), "Thread %d calling query_node_info_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		query_node_info_chunk((th_data_query_ninfo *) work->thread_data);
+		break;
+	case TS_FREE_ND_INFO:
+		snprintf(buf, sizeof(buf), "Thread %d calling free_node_info_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		free_node_info_chunk((th_data_free_ninfo *) work->thread_data);
+		break;
+	case TS_DUP_RESRESV:
+		snprintf(buf, sizeof(buf), "Thread %d calling dup_resource_resv_array_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		dup_resource_resv_array_chunk((th_data_dup_resresv *) work->thread_data);
+		break;
+	case TS_QUERY_JOB_INFO:
+		snprintf(buf, sizeof(buf), "Thread %d calling query_jobs_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		query_jobs_chunk((th_data_query_jinfo *) work->thread_data);
+		break;
+	case TS_FREE_RESRESV:
+		snprintf(buf, sizeof(buf), "Thread %d calling free_resource_resv_array_chunk()", ntid);
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+		free_resource_resv_array_chunk((th_data_free_resresv *) work->thread_data);
+		break;
+	default:
+		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SCHED, LOG_ERR, __func__,
+				"Invalid task type passed to worker thread");
+	}
+}
+
 /**
  * @brief	Main pthread routine for worker threads
  *
@@ -262,13 +417,19 @@ void *
 worker(void *tid)
 {
 	th_task_info *work = NULL;
+	ds_queue *own_queue = NULL;
 	sigset_t set;
 	int ntid;
-	char buf[1024];
 
 	pthread_setspecific(th_id_key, tid);
 	ntid = *(int *)tid;
 
+	/* pin before anything is allocated so the thread's memory is local to it */
+	if (threads_pinned) {
+		pin_thread(ntid);
+		own_queue = thread_queues[ntid];
+	}
+
 	/* Block HUPs, if we ever unblock this, we'll need to modify 'restart()' to handle MT */
 	sigemptyset(&set);
 	sigaddset(&set, SIGHUP);
@@ -282,54 +443,20 @@ worker(void *tid)
 	while (!threads_die) {
 		/* Get the next work task from work queue */
 		pthread_mutex_lock(&work_lock);
-		while (ds_queue_is_empty(work_queue) && !threads_die) {
+		while (ds_queue_is_empty(work_queue) &&
+			(own_queue == NULL || ds_queue_is_empty(own_queue)) && !threads_die) {
 			pthread_cond_wait(&work_cond, &work_lock);
 		}
-		work = static_cast<th_task_info *>(ds_dequeue(work_queue));
+		work = NULL;
+		if (own_queue != NULL && !ds_queue_is_empty(own_queue))
+			work = static_cast<th_task_info *>(ds_dequeue(own_queue));
+		else if (!ds_queue_is_empty(work_queue))
+			work = static_cast<th_task_info *>(ds_dequeue(work_queue));
 		pthread_mutex_unlock(&work_lock);
 
 		/* find out what task we need to do */
 		if (work != NULL) {
-			switch (work->task_type) {
-			case TS_IS_ND_ELIGIBLE:
-				snprintf(buf, sizeof(buf), "Thread %d calling check_node_eligibility_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				check_node_eligibility_chunk((th_data_nd_eligible *) work->thread_data);
-				break;
-			case TS_DUP_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling dup_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				dup_node_info_chunk((th_data_dup_nd_info *) work->thread_data);
-				break;
-			case TS_QUERY_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling query_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				query_node_info_chunk((th_data_query_ninfo *) work->thread_data);
-				break;
-			case TS_FREE_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling free_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				free_node_info_chunk((th_data_free_ninfo *) work->thread_data);
-				break;
-			case TS_DUP_RESRESV:
-				snprintf(buf, sizeof(buf), "Thread %d calling dup_resource_resv_array_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				dup_resource_resv_array_chunk((th_data_dup_resresv *) work->thread_data);
-				break;
-			case TS_QUERY_JOB_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling query_jobs_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				query_jobs_chunk((th_data_query_jinfo *) work->thread_data);
-				break;
-			case TS_FREE_RESRESV:
-				snprintf(buf, sizeof(buf), "Thread %d calling free_resource_resv_array_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				free_resource_resv_array_chunk((th_data_free_resresv *) work->thread_data);
-				break;
-			default:
-				log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SCHED, LOG_ERR, __func__,
-						"Invalid task type passed to worker thread");
-			}
+			execute_task(work, ntid);
 
 			/* Post results */
 			pthread_mutex_lock(&result_lock);
@@ -357,3 +484,96 @@ queue_work_for_threads(th_task_info *task)
 	pthread_cond_signal(&work_cond);
 	pthread_mutex_unlock(&work_lock);
 }
+
+/**
+ * @brief	Queue up work for a specific worker thread.  Only the thread
+ *		runs the task, so work on memory the thread allocated stays on
+ *		its NUMA node.  Without pinned threads the task goes to any thread.
+ *
+ * @param[in]	task - the task to queue up
+ * @param[in]	th - id of the thread to run the task, 0 for any thread
+ *
+ * @return void
+ */
+void
+queue_work_for_thread(th_task_info *task, int th)
+{
+	if (!threads_pinned || thread_queues == NULL || th < 1 || th > num_threads) {
+		queue_work_for_threads(task);
+		return;
+	}
+
+	pthread_mutex_lock(&work_lock);
+	ds_enqueue(thread_queues[th], (void *) task);
+	/* the condition is shared, make sure the thread it is for wakes up */
+	pthread_cond_broadcast(&work_cond);
+	pthread_mutex_unlock(&work_lock);
+}
+
+/**
+ * @brief	Run a task from the work queue on the calling thread.  The main
+ *		thread calls this while it waits for the results of the tasks it
+ *		queued, so it does its share of the work instead of sleeping and
+ *		the last chunks get done sooner.
+ *
+ * @return int
+ * @retval 1 if a task was run
+ * @retval 0 if the work queue was empty
+ */
+int
+run_queued_task(void)
+{
+	static int helper_id = -1;
+	th_task_info *work;
+	void *id;
+
+	if (work_queue == NULL)
+		return 0;
+
+	pthread_mutex_lock(&work_lock);
+	work = static_cast<th_task_info *>(ds_dequeue(work_queue));
+	pthread_mutex_unlock(&work_lock);
+	if (work == NULL)
+		return 0;
+
+	/* Look like a worker thread while running the task so nothing it calls
+	 * tries to queue up work of its own and wait on the result queue.
+	 */
+	id = pthread_getspecific(th_id_key);
+	pthread_setspecific(th_id_key, (void *) &helper_id);
+	execute_task(work, 0);
+	pthread_setspecific(th_id_key, id);
+
+	pthread_mutex_lock(&result_lock);
+	ds_enqueue(result_queue, (void *) work);
+	pthread_cond_signal(&result_cond);
+	pthread_mutex_unlock(&result_lock);
+
+	return 1;
+}
+
+/**
+ * @brief	Compute the size of the chunks to split work into.  Work is split
+ *		into several chunks per thread so that threads which are handed
+ *		cheap chunks come back for more while others are busy with
+ *		expensive ones.
+ *
+ * @param[in]	num_items - number of items of work
+ * @param[in]	max_size - largest chunk size, or 0 for no limit
+ *
+ * @return int
+ * @retval chunk size
+ */
+int
+mt_chunk_size(int num_items, int max_size)
+{
+	int chunk_size;
+
+	chunk_size = num_items / (num_threads * MT_CHUNKS_PER_THREAD);
+	if (chunk_size < MT_CHUNK_SIZE_MIN)
+		chunk_size = MT_CHUNK_SIZE_MIN;
+	if (max_size > 0 && chunk_size > max_size)
+		chunk_size = max_size;
+
+	return chunk_size;
+}
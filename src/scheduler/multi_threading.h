@@ -48,11 +48,15 @@ extern "C" {
 
 #define MT_CHUNK_SIZE_MIN 1024
 #define MT_CHUNK_SIZE_MAX 8192
+#define MT_CHUNKS_PER_THREAD 4	/* chunks of work queued per thread by mt_chunk_size() */
 
 int init_multi_threading(int nthreads);
 void kill_threads(void);
 void *worker(void *);
 void queue_work_for_threads(th_task_info *task);
+void queue_work_for_thread(th_task_info *task, int th);
+int run_queued_task(void);
+int mt_chunk_size(int num_items, int max_size);
 int init_mutex_attr_recursive(pthread_mutexattr_t *attr);
 
 #ifdef	__cplusplus
@@ -47,6 +47,7 @@
  * Functions included are:
  * 	query_nodes()
  * 	query_node_info()
+ * 	clear_node_query_cache()
  * 	new_node_info()
  * 	free_nodes()
  * 	free_node_info()
@@ -107,6 +108,12 @@
  * 	sim_exclhost()
  * 	sim_exclhost_func()
  * 	set_current_aoe()
+ * 	is_aoe_grouped()
+ * 	find_aoe_group()
+ * 	add_node_to_aoe_group()
+ * 	create_aoe_groups()
+ * 	free_aoe_groups()
+ * 	node_aoe_rank()
  * 	is_exclhost()
  * 	check_node_array_eligibility()
  * 	is_powerok()
@@ -116,6 +123,9 @@
  */
 #include <pbs_config.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -159,6 +169,255 @@
 /* name of the last node a job ran on - used in smp_dist = round robin */
 static char last_node_name[PBS_MAXSVRJOBID];
 
+/*
+ * Cache of the vnodes parsed by the last query_nodes(), keyed by vnode name.
+ * If the server reports a vnode with exactly the same status as it did when
+ * the vnode was cached, the cached node_info is duplicated instead of being
+ * re-parsed from the batch_status.  The cache is only modified by the main
+ * thread while no query tasks are running.
+ */
+struct node_cache_entry
+{
+	std::string sig;		/* status signature the node was parsed from */
+	node_info *ninfo;		/* pristine copy of the parsed node */
+};
+static std::unordered_map<std::string, node_cache_entry> node_cache;
+static int node_cache_cycles = 0;	/* cycles since the cache was last flushed */
+
+/*
+ * Status of the vnodes last sent by the server, keyed by vnode name.  While
+ * the node cache is in use, the server is only asked for the vnodes whose
+ * status changed (EXTEND_OPT_NODE_CHANGED).  Unchanged vnodes come back with
+ * no attributes and get their attributes from here.
+ */
+static std::unordered_map<std::string, struct attrl *> node_status_cache;
+
+/* Per-cycle intern tables of job select and place specs keyed by the spec
+ * string.  Jobs with the same spec share one read-only parsed copy.  Lookups
+ * are done from the query threads, so they are done under general_lock.
+ */
+static std::unordered_map<std::string, selspec *> selspec_interns;
+static std::unordered_map<std::string, place *> placespec_interns;
+
+/**
+ * @brief	create the status signature of a node.  Two batch_status
+ *		entries with the same signature parse into the same node_info.
+ *
+ * @param[in]	node	-	node returned from pbs_statvnode()
+ * @param[in]	sinfo	-	server information
+ *
+ * @return char *
+ * @retval	malloc'd signature string
+ * @retval	NULL	: node can not be cached or on error
+ */
+static char *
+create_node_status_sig(struct batch_status *node, server_info *sinfo)
+{
+	struct attrl *attrp;
+	std::string sig;
+
+	/* node states depend on whether power provisioning is enabled */
+	sig = sinfo->power_provisioning ? "P" : "-";
+	for (attrp = node->attribs; attrp != NULL; attrp = attrp->next) {
+		/* cloud license validity depends on the current time */
+		if (!strcmp(attrp->name, ATTR_NODE_License) && attrp->value != NULL &&
+			attrp->value[0] == ND_LIC_TYPE_cloud)
+			return NULL;
+		sig += attrp->name;
+		sig += '\t';
+		if (attrp->resource != NULL)
+			sig += attrp->resource;
+		sig += '\t';
+		if (attrp->value != NULL)
+			sig += attrp->value;
+		sig += '\n';
+	}
+
+	return strdup(sig.c_str());
+}
+
+/**
+ * @brief	duplicate a node from the node cache if its status has not
+ *		changed since it was cached
+ *
+ * @param[in]	name	-	name of the node
+ * @param[in]	sig	-	status signature of the node this cycle
+ * @param[in]	sinfo	-	server the node will belong to
+ *
+ * @return node_info *
+ * @retval	duplicated node
+ * @retval	NULL	: cache miss or on error
+ *
+ * @par MT-Safe:	yes, as long as the cache is not being modified
+ */
+static node_info *
+find_cached_node(const char *name, const char *sig, server_info *sinfo)
+{
+	node_info *ninfo;
+
+	auto ent = node_cache.find(name);
+	if (ent == node_cache.end() || ent->second.sig != sig)
+		return NULL;
+
+	if ((ninfo = dup_node_info(ent->second.ninfo, sinfo, NO_FLAGS)) == NULL)
+		return NULL;
+
+	/* server bits query_node_info() would have set while parsing */
+	if (ninfo->lic_lock)
+		sinfo->has_nonCPU_licenses = 1;
+	if (ninfo->is_multivnoded)
+		sinfo->has_multi_vnode = 1;
+
+	return ninfo;
+}
+
+/**
+ * @brief	rebuild the node cache from the nodes queried this cycle.
+ *		Nodes which are no longer reported are dropped from the cache.
+ *
+ * @param[in]	nodes	-	batch_status of nodes queried from server
+ * @param[in]	sigs	-	signatures of nodes (same order as nodes)
+ * @param[in]	ninfo_arr	-	nodes parsed from nodes (same order, partition filtered)
+ *
+ * @return void
+ */
+static void
+update_node_cache(struct batch_status *nodes, char **sigs, node_info **ninfo_arr)
+{
+	std::unordered_map<std::string, node_cache_entry> new_cache;
+	struct batch_status *cur_node;
+	int i;
+	int k;
+
+	new_cache.reserve(node_cache.size());
+	for (cur_node = nodes, i = 0, k = 0; cur_node != NULL && ninfo_arr[k] != NULL; cur_node = cur_node->next, i++) {
+		node_info *ninfo;
+
+		/* nodes filtered out by partition are not in ninfo_arr */
+		if (strcmp(cur_node->name, ninfo_arr[k]->name))
+			continue;
+		ninfo = ninfo_arr[k++];
+		if (sigs[i] == NULL)
+			continue;
+
+		auto ent = node_cache.find(ninfo->name);
+		if (ent != node_cache.end() && ent->second.sig == sigs[i]) {
+			new_cache[ninfo->name] = ent->second;
+			node_cache.erase(ent);
+		} else {
+			node_info *pristine;
+
+			if ((pristine = dup_node_info(ninfo, ninfo->server, NO_FLAGS)) == NULL)
+				continue;
+			pristine->server = NULL;
+			new_cache[ninfo->name] = {sigs[i], pristine};
+		}
+	}
+
+	clear_node_query_cache();
+	node_cache.swap(new_cache);
+}
+
+/**
+ * @brief	free an array of node status signatures.  Unlike a string
+ *		array, the array may contain NULL entries for uncached nodes.
+ *
+ * @param[in]	sigs	-	signatures to free
+ * @param[in]	num	-	number of entries in sigs
+ *
+ * @return void
+ */
+static void
+free_node_status_sigs(char **sigs, int num)
+{
+	int i;
+
+	if (sigs == NULL)
+		return;
+
+	for (i = 0; i < num; i++)
+		free(sigs[i]);
+	free(sigs);
+}
+
+/**
+ * @brief	free the vnode statuses kept from the last query.  The next
+ *		query asks the server for the status of all vnodes.
+ *
+ * @return void
+ */
+static void
+clear_node_status_cache(void)
+{
+	for (auto &ent : node_status_cache)
+		free_attrl_list(ent.second);
+	node_status_cache.clear();
+}
+
+/**
+ * @brief	fill in the status of the vnodes the server reported as
+ *		unchanged from the statuses kept from the last query
+ *
+ * @param[in,out]	nodes	-	batch_status of nodes queried from server
+ *
+ * @return int
+ * @retval	0	: all vnodes have their status
+ * @retval	-1	: a vnode's status was not kept, the vnodes must be requeried
+ */
+static int
+fill_node_status(struct batch_status *nodes)
+{
+	struct batch_status *cur_node;
+
+	for (cur_node = nodes; cur_node != NULL; cur_node = cur_node->next) {
+		if (cur_node->attribs != NULL)
+			continue;
+
+		auto ent = node_status_cache.find(cur_node->name);
+		if (ent == node_status_cache.end() || ent->second == NULL)
+			return -1;
+		cur_node->attribs = ent->second;
+		ent->second = NULL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief	keep the status of the vnodes queried this cycle for the next
+ *		query.  The attributes are moved out of nodes.
+ *
+ * @param[in,out]	nodes	-	batch_status of nodes queried from server
+ *
+ * @return void
+ */
+static void
+save_node_status(struct batch_status *nodes)
+{
+	struct batch_status *cur_node;
+
+	clear_node_status_cache();
+	for (cur_node = nodes; cur_node != NULL; cur_node = cur_node->next) {
+		node_status_cache[cur_node->name] = cur_node->attribs;
+		cur_node->attribs = NULL;
+	}
+}
+
+/**
+ * @brief	free the node cache.  This must be called when the resource
+ *		definitions the cached nodes point to are freed.
+ *
+ * @return void
+ */
+void
+clear_node_query_cache(void)
+{
+	for (auto &ent : node_cache)
+		free_node_info(ent.second.ninfo);
+	node_cache.clear();
+	node_cache_cycles = 0;
+}
+
 void
 query_node_info_chunk(th_data_query_ninfo *data)
 {
@@ -191,8 +450,15 @@ query_node_info_chunk(th_data_query_ninfo *data)
 		;
 
 	for (i = start, nidx = 0; i <= end && cur_node != NULL; cur_node = cur_node->next, i++) {
+		ninfo = NULL;
+		if (data->sigs != NULL) {
+			data->sigs[i] = create_node_status_sig(cur_node, sinfo);
+			if (data->sigs[i] != NULL)
+				ninfo = find_cached_node(cur_node->name, data->sigs[i], sinfo);
+		}
+
 		/* get node info from the batch_status */
-		if ((ninfo = query_node_info(cur_node, sinfo)) == NULL) {
+		if (ninfo == NULL && (ninfo = query_node_info(cur_node, sinfo)) == NULL) {
 			free_nodes(ninfo_arr);
 			data->error = 1;
 			return;
@@ -213,6 +479,7 @@ query_node_info_chunk(th_data_query_ninfo *data)
  *
  * @param[in]	nodes	-	batch_status of nodes queried from server
  * @param[in]	sinfo	-	server information
+ * @param[out]	sigs	-	array to store node status signatures in or NULL
  * @param[in]	sidx	-	start index for the jobs list for the thread
  * @param[in]	eidx	-	end index for the jobs list for the thread
  *
@@ -221,7 +488,7 @@ query_node_info_chunk(th_data_query_ninfo *data)
  * @retval NULL for malloc error
  */
 static inline th_data_query_ninfo *
-alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, int sidx, int eidx)
+alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, char **sigs, int sidx, int eidx)
 {
 	th_data_query_ninfo *tdata = NULL;
 
@@ -234,6 +501,7 @@ alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, int sidx, i
 	tdata->nodes = nodes;
 	tdata->oarr = NULL; /* Will be filled by the thread routine */
 	tdata->sinfo = sinfo;
+	tdata->sigs = sigs;
 	tdata->sidx = sidx;
 	tdata->eidx = eidx;
 
@@ -268,7 +536,10 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	int num_tasks;
 	int th_err = 0;
 	node_info ***ninfo_arrs_tasks = NULL;
+	char **sigs = NULL;			/* node status signatures for the node cache */
 	int tid;
+	int track;				/* only ask the server for changed vnodes */
+	char *extend;
 	const char *nodeattrs[] = {
 			ATTR_NODE_state,
 			ATTR_NODE_Mom,
@@ -311,11 +582,49 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		}
 	}
 
+	tid = *((int *) pthread_getspecific(th_id_key));
+
+	/* Reuse the nodes from the last query whose status has not changed.
+	 * Every node_refresh_cycles cycles all nodes are queried and parsed
+	 * from scratch.  A cycle capture needs the status of all of them.
+	 */
+	track = 0;
+	if (tid == 0 && conf.node_refresh_cycles > 0 && conf.cycle_capture_file == NULL) {
+		track = 1;
+		if (++node_cache_cycles > conf.node_refresh_cycles) {
+			clear_node_query_cache();
+			clear_node_status_cache();
+		}
+	} else if (tid == 0) {
+		if (!node_cache.empty())
+			clear_node_query_cache();
+		if (!node_status_cache.empty())
+			clear_node_status_cache();
+	}
+
 	/* get nodes from PBS server */
-	if ((nodes = pbs_statvnode(pbs_sd, NULL, attrib, NULL)) == NULL) {
-		err = pbs_geterrmsg(pbs_sd);
-		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, "", "Error getting nodes: %s", err);
-		return NULL;
+	while (1) {
+		/* only the vnodes of our partition are of any use to us */
+		if (track)
+			extend = const_cast<char *>(node_status_cache.empty() ?
+				EXTEND_OPT_NODE_RESYNC EXTEND_OPT_NODE_PARTITION :
+				EXTEND_OPT_NODE_CHANGED EXTEND_OPT_NODE_PARTITION);
+		else
+			extend = const_cast<char *>(EXTEND_OPT_NODE_PARTITION);
+		if ((nodes = pbs_statvnode(pbs_sd, NULL, attrib, extend)) == NULL) {
+			err = pbs_geterrmsg(pbs_sd);
+			log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, "", "Error getting nodes: %s", err);
+			if (track)
+				clear_node_status_cache();
+			return NULL;
+		}
+		if (!track || fill_node_status(nodes) == 0)
+			break;
+		/* we lost track of a vnode the server thinks we have */
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+			"Missing status of an unchanged vnode, requerying all vnodes");
+		pbs_statfree(nodes);
+		clear_node_status_cache();
 	}
 
 	cur_node = nodes;
@@ -324,11 +633,18 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		cur_node = cur_node->next;
 	}
 
-	tid = *((int *) pthread_getspecific(th_id_key));
+	if (track) {
+		if ((sigs = static_cast<char **>(calloc(num_nodes, sizeof(char *)))) == NULL)
+			log_err(errno, __func__, MEM_ERR_MSG);
+	}
+
 	if (tid != 0 || num_threads <= 1) {
 		/* don't use multi-threading if I am a worker thread or num_threads is 1 */
-		tdata = alloc_tdata_nd_query(nodes, sinfo, 0, num_nodes - 1);
+		tdata = alloc_tdata_nd_query(nodes, sinfo, sigs, 0, num_nodes - 1);
 		if (tdata == NULL) {
+			free_node_status_sigs(sigs, num_nodes);
+			if (track)
+				clear_node_status_cache();
 			pbs_statfree(nodes);
 			return NULL;
 		}
@@ -343,15 +659,17 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	} else {
 		if ((ninfo_arr = static_cast<node_info **>(malloc((num_nodes + 1) * sizeof(node_info *)))) == NULL) {
 			log_err(errno, __func__, MEM_ERR_MSG);
+			free_node_status_sigs(sigs, num_nodes);
+			if (track)
+				clear_node_status_cache();
 			pbs_statfree(nodes);
 			return NULL;
 		}
 		ninfo_arr[0] = NULL;
-		chunk_size = num_nodes / num_threads;
-		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
-		for (j = 0, num_tasks = 0; num_nodes > 0;
-				j += chunk_size, num_tasks++, num_nodes -= chunk_size) {
-			tdata = alloc_tdata_nd_query(nodes, sinfo, j, j + chunk_size - 1);
+		chunk_size = mt_chunk_size(num_nodes, 0);
+		for (j = 0, num_tasks = 0; j < num_nodes;
+				j += chunk_size, num_tasks++) {
+			tdata = alloc_tdata_nd_query(nodes, sinfo, sigs, j, j + chunk_size - 1);
 			if (tdata == NULL) {
 				th_err = 1;
 				break;
@@ -367,7 +685,7 @@ query_nodes(int pbs_sd, server_info *sinfo)
 			task->task_type = TS_QUERY_ND_INFO;
 			task->thread_data = (void *) tdata;
 
-			queue_work_for_threads(task);
+			queue_work_for_thread(task, num_tasks % num_threads + 1);
 		}
 		ninfo_arrs_tasks = static_cast<node_info ***>(malloc(num_tasks * sizeof(node_info **)));
 		if (ninfo_arrs_tasks == NULL) {
@@ -376,6 +694,9 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		}
 		/* Get results from worker threads */
 		for (i = 0; i < num_tasks;) {
+			/* help out with the queued work rather than wait for it */
+			while (run_queued_task())
+				;
 			pthread_mutex_lock(&result_lock);
 			while (ds_queue_is_empty(result_queue))
 				pthread_cond_wait(&result_cond, &result_lock);
@@ -392,6 +713,9 @@ query_nodes(int pbs_sd, server_info *sinfo)
 			pthread_mutex_unlock(&result_lock);
 		}
 		if (th_err) {
+			free_node_status_sigs(sigs, num_nodes);
+			if (track)
+				clear_node_status_cache();
 			pbs_statfree(nodes);
 			free_nodes(ninfo_arr);
 			return NULL;
@@ -415,16 +739,27 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	if (nidx == 0) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
 			"No nodes found in partitions serviced by scheduler");
+		free_node_status_sigs(sigs, num_nodes);
+		if (track)
+			save_node_status(nodes);
 		pbs_statfree(nodes);
 		free(ninfo_arr);
 		return NULL;
 	}
 
+	/* cache the nodes before indirect resources are resolved */
+	if (sigs != NULL) {
+		update_node_cache(nodes, sigs, ninfo_arr);
+		free_node_status_sigs(sigs, num_nodes);
+	}
+
 #ifdef NAS /* localmod 062 */
 	site_vnode_inherit(ninfo_arr);
 #endif /* localmod 062 */
 	resolve_indirect_resources(ninfo_arr);
 	sinfo->num_nodes = nidx;
+	if (track)
+		save_node_status(nodes);
 	pbs_statfree(nodes);
 	return ninfo_arr;
 }
@@ -626,6 +961,7 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 			sinfo->has_nonCPU_licenses = 1;
 		}
 	}
+	index_resource_list(ninfo->res);
 	return ninfo;
 }
 
@@ -640,6 +976,7 @@ node_info *
 new_node_info()
 {
 	node_info *nnode;
+	int *tid;
 
 	if ((nnode = static_cast<node_info *>(malloc(sizeof(node_info)))) == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
@@ -684,6 +1021,8 @@ new_node_info()
 
 	nnode->rank = 0;
 
+	nnode->sort_res = NULL;
+
 	nnode->nodesig_ind = -1;
 
 	nnode->name = NULL;
@@ -714,6 +1053,11 @@ new_node_info()
 	nnode->node_events = NULL;
 	nnode->bucket_ind = -1;
 	nnode->node_ind = -1;
+	/* with pinned threads, work on the node is queued to the thread whose
+	 * memory it was allocated from
+	 */
+	tid = static_cast<int *>(pthread_getspecific(th_id_key));
+	nnode->home_thread = (tid != NULL && *tid > 0) ? *tid : 0;
 
 	nnode->nscr = NSCR_NONE;
 
@@ -817,8 +1161,7 @@ free_nodes(node_info **ninfo_arr)
 		free(ninfo_arr);
 		return;
 	}
-	chunk_size = num_nodes / num_threads;
-	chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
+	chunk_size = mt_chunk_size(num_nodes, 0);
 	for (i = 0, num_tasks = 0; num_nodes > 0;
 			num_tasks++, i += chunk_size, num_nodes -= chunk_size) {
 		tdata = alloc_tdata_free_nodes(ninfo_arr, i, i + chunk_size - 1);
@@ -834,11 +1177,14 @@ free_nodes(node_info **ninfo_arr)
 		task->task_type = TS_FREE_ND_INFO;
 		task->thread_data = (void *) tdata;
 
-		queue_work_for_threads(task);
+		queue_work_for_thread(task, ninfo_arr[i]->home_thread);
 	}
 
 	/* Get results from worker threads */
 	for (i = 0; i < num_tasks;) {
+		/* help out with the queued work rather than wait for it */
+		while (run_queued_task())
+			;
 		pthread_mutex_lock(&result_lock);
 		while (ds_queue_is_empty(result_queue))
 			pthread_cond_wait(&result_cond, &result_lock);
@@ -870,6 +1216,8 @@ free_node_info(node_info *ninfo)
 		if (ninfo->name != NULL)
 			free(ninfo->name);
 
+		free(ninfo->sort_res);
+
 		if (ninfo->mom != NULL)
 			free(ninfo->mom);
 
@@ -1367,8 +1715,7 @@ dup_nodes(node_info **onodes, server_info *nsinfo, unsigned int flags)
 		free(tdata);
 	} else { /* We are multithreading */
 		j = 0;
-		chunk_size = num_nodes / num_threads;
-		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
+		chunk_size = mt_chunk_size(num_nodes, 0);
 		for (j = 0, num_tasks = 0; thread_node_ct_left > 0;
 				num_tasks++, j+= chunk_size, thread_node_ct_left -= chunk_size) {
 			tdata = alloc_tdata_dup_nodes(flags, nsinfo, onodes, nnodes, j, j + chunk_size - 1);
@@ -1387,11 +1734,14 @@ dup_nodes(node_info **onodes, server_info *nsinfo, unsigned int flags)
 			task->task_type = TS_DUP_ND_INFO;
 			task->thread_data = (void *) tdata;
 
-			queue_work_for_threads(task);
+			queue_work_for_thread(task, num_tasks % num_threads + 1);
 		}
 
 		/* Get results from worker threads */
 		for (i = 0; i < num_tasks;) {
+			/* help out with the queued work rather than wait for it */
+			while (run_queued_task())
+				;
 			pthread_mutex_lock(&result_lock);
 			while (ds_queue_is_empty(result_queue))
 				pthread_cond_wait(&result_cond, &result_lock);
@@ -1416,6 +1766,17 @@ dup_nodes(node_info **onodes, server_info *nsinfo, unsigned int flags)
 
 
 	if (!(flags & DUP_INDIRECT)) {
+		/* the copies keep the node_ind their indirect resources are bound to */
+		std::vector<node_info *> by_ind;
+
+		for (i = 0; nnodes[i] != NULL; i++) {
+			if (nnodes[i]->node_ind < 0)
+				continue;
+			if (static_cast<size_t>(nnodes[i]->node_ind) >= by_ind.size())
+				by_ind.resize(nnodes[i]->node_ind + 1, NULL);
+			by_ind[nnodes[i]->node_ind] = nnodes[i];
+		}
+
 		for (i = 0; nnodes[i] != NULL; i++) {
 			/* since the node list we're duplicating may have indirect resources
 			 * which point to resources not in our node list, we need to detect it
@@ -1424,7 +1785,15 @@ dup_nodes(node_info **onodes, server_info *nsinfo, unsigned int flags)
 			nres = nnodes[i]->res;
 			while (nres != NULL) {
 				if (nres->indirect_vnode_name != NULL) {
-					ninfo = find_node_info(nnodes, nres->indirect_vnode_name);
+					ninfo = NULL;
+					if (nres->indirect_node_ind >= 0 &&
+						static_cast<size_t>(nres->indirect_node_ind) < by_ind.size()) {
+						ninfo = by_ind[nres->indirect_node_ind];
+						if (ninfo != NULL && strcmp(ninfo->name, nres->indirect_vnode_name) != 0)
+							ninfo = NULL;
+					}
+					if (ninfo == NULL)
+						ninfo = find_node_info(nnodes, nres->indirect_vnode_name);
 					/* we found the problem -- first time we see it, we set the value
 					 * of THIS node to the indirect value.  We'll then set all the rest
 					 * to point to THIS node.
@@ -1511,6 +1880,7 @@ dup_node_info(node_info *onode, server_info *nsinfo,
 	nnode->is_stale = onode->is_stale;
 	nnode->is_maintenance = onode->is_maintenance;
 	nnode->is_provisioning = onode->is_provisioning;
+	nnode->is_sleeping = onode->is_sleeping;
 	nnode->is_multivnoded = onode->is_multivnoded;
 
 	nnode->sharing = onode->sharing;
@@ -1538,6 +1908,7 @@ dup_node_info(node_info *onode, server_info *nsinfo,
 		nnode->res = dup_ind_resource_list(onode->res);
 	else
 		nnode->res = dup_resource_list(onode->res);
+	index_resource_list(nnode->res);
 
 	nnode->max_running = onode->max_running;
 	nnode->max_user_run = onode->max_user_run;
@@ -1649,15 +2020,44 @@ copy_node_ptr_array(node_info  **oarr, node_info  **narr)
 int
 collect_resvs_on_nodes(node_info **ninfo_arr, resource_resv **resresv_arr, int size)
 {
+	std::unordered_map<std::string, node_info *> nodes_by_name;
 	int i;
+	int j;
 
 	if (ninfo_arr == NULL || ninfo_arr[0] == NULL)
 		return 0;
 
 	for (i = 0; ninfo_arr[i] != NULL; i++) {
-		ninfo_arr[i]->run_resvs_arr = resource_resv_filter(resresv_arr, size,
-			check_resv_running_on_node, ninfo_arr[i]->name, 0);
-		/* the count of running resvs on the node is set in query_reservations */
+		ninfo_arr[i]->run_resvs_arr = NULL;
+		nodes_by_name[ninfo_arr[i]->name] = ninfo_arr[i];
+	}
+
+	/* Walk each running resv's nodes once rather than filtering every resv
+	 * for every node.  Nodes without a running resv are left with a NULL array.
+	 * The count of running resvs on the node is set in query_reservations
+	 */
+	for (i = 0; i < size; i++) {
+		resource_resv *resv = resresv_arr[i];
+
+		if (!resv->is_resv || resv->resv == NULL || resv->ninfo_arr == NULL)
+			continue;
+		if (!resv->resv->is_running && resv->resv->resv_state != RESV_BEING_DELETED)
+			continue;
+
+		for (j = 0; resv->ninfo_arr[j] != NULL; j++) {
+			auto it = nodes_by_name.find(resv->ninfo_arr[j]->name);
+			node_info *ninfo;
+			resource_resv **tmp_arr;
+
+			if (it == nodes_by_name.end())
+				continue;
+			ninfo = it->second;
+
+			tmp_arr = add_resresv_to_array(ninfo->run_resvs_arr, resv, NO_FLAGS);
+			if (tmp_arr == NULL)
+				return 0;
+			ninfo->run_resvs_arr = tmp_arr;
+		}
 	}
 	return 1;
 }
@@ -1834,6 +2234,10 @@ update_node_on_run(nspec *ns, resource_resv *resresv, const char *job_state)
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
 
+	/* the host can no longer be had exclusively */
+	if (ninfo->hostset != NULL && ninfo->num_jobs == 0 && ninfo->num_run_resv == 0)
+		ninfo->hostset->busy_nodes++;
+
 	if (resresv->is_job) {
 		ninfo->num_jobs++;
 		if (find_resource_resv_by_indrank(ninfo->job_arr, resresv->resresv_ind, resresv->rank) == NULL) {
@@ -1987,6 +2391,13 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv, const char *job_sta
 	if (ninfo == NULL || resresv == NULL || resresv->nspec_arr == NULL)
 		return;
 
+	/* the vnode (or the one it takes indirect resources from) frees up */
+	if (ninfo->server != NULL)
+		ninfo->server->free_res_gen++;
+	mark_node_psets_stale(ninfo);
+	if (ninfo->svr_node != NULL)
+		mark_node_psets_stale(ninfo->svr_node);
+
 	/* Don't account for resources of a node that is unavailable */
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
@@ -2034,8 +2445,12 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv, const char *job_sta
 				if (resreq->type.is_consumable) {
 					res = find_resource(ninfo->res, resreq->def);
 					if (res != NULL) {
-						if (res->indirect_res != NULL)
+						if (res->indirect_res != NULL) {
+							/* the vnode holding the resource changes too */
+							if (ninfo->server != NULL)
+								mark_node_psets_stale(find_node_info(ninfo->server->nodes, res->indirect_vnode_name));
 							res = res->indirect_res;
+						}
 						res->assigned -= resreq->amount;
 						if (res->assigned < 0) {
 							log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, LOG_DEBUG, ninfo->name,
@@ -2294,6 +2709,29 @@ find_nspec_by_rank(nspec **nspec_arr, int rank)
 	return nspec_arr[i];
 }
 
+/**
+ * @brief	check if any node in an array has not been marked ineligible
+ *		by check_node_array_eligibility()
+ *
+ * @param[in]	ninfo_arr - the nodes to check
+ *
+ * @return	int
+ * @retval	1	: at least one node may be eligible
+ * @retval	0	: all nodes are ineligible
+ */
+static int
+has_eligible_node(node_info **ninfo_arr)
+{
+	int i;
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		if (!(ninfo_arr[i]->nscr & NSCR_INELIGIBLE))
+			return 1;
+	}
+
+	return 0;
+}
+
 /**
  *	@brief
  *		eval a select spec to see if it is satisfiable
@@ -2377,12 +2815,6 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 		return 0;
 	}
 
-	check_node_array_eligibility(ninfo_arr, resresv, pl, tot_nodes, err);
-
-	if (failerr->status_code == SCHD_UNKWN)
-		move_schd_error(failerr, err);
-	clear_schd_error(err);
-
 	/* If we are not node grouping or we only have 1 chunk packed onto a single
 	 * host, then we should try and satisfy over all nodes in the list
 	 *
@@ -2390,6 +2822,11 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 	 * broken into vchunks
 	 */
 	if (nodepart == NULL) {
+		check_node_array_eligibility(ninfo_arr, resresv, pl, tot_nodes, err);
+		if (failerr->status_code == SCHD_UNKWN)
+			move_schd_error(failerr, err);
+		clear_schd_error(err);
+
 		if (resresv->server->has_multi_vnode && ok_break_chunk(resresv, ninfo_arr))
 			pass_flags |= EVAL_OKBREAK;
 
@@ -2412,11 +2849,33 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 		return rc;
 	}
 
-	/* Otherwise we're node grouping... */
+	/* Otherwise we're node grouping...
+	 * Node eligibility is only checked for the placement sets the job can
+	 * fit in.  Most jobs are placed in one of the first few sets, so there is
+	 * no need to check every node in the complex up front.
+	 */
 
 	for (i = 0; nodepart[i] != NULL && rc == 0; i++) {
 		clear_schd_error(err);
 		if (resresv_can_fit_nodepart(policy, nodepart[i], resresv, flags, err)) {
+			check_node_array_eligibility(nodepart[i]->ninfo_arr, resresv, pl,
+				nodepart[i]->tot_nodes, err);
+			if (failerr->status_code == SCHD_UNKWN)
+				move_schd_error(failerr, err);
+			clear_schd_error(err);
+
+			/* check_node_array_eligibility() ruled out every node in the
+			 * placement set, no need to walk through it chunk by chunk
+			 */
+			if (!has_eligible_node(nodepart[i]->ninfo_arr)) {
+				log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
+					"Placement set %s has no eligible nodes", nodepart[i]->name);
+				if (!can_fit &&
+					resresv_can_fit_nodepart(policy, nodepart[i], resresv, flags|COMPARE_TOTAL, err))
+					can_fit = 1;
+				pass_flags = NO_FLAGS;
+				continue;
+			}
 			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
 				"Evaluating placement set: %s", nodepart[i]->name);
 			if (nodepart[i]->ok_break)
@@ -2471,6 +2930,12 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 			if (resresv->server->has_multi_vnode && ok_break_chunk(resresv, ninfo_arr))
 				pass_flags |= EVAL_OKBREAK;
 
+			clear_schd_error(err);
+			check_node_array_eligibility(ninfo_arr, resresv, pl, tot_nodes, err);
+			if (failerr->status_code == SCHD_UNKWN)
+				move_schd_error(failerr, err);
+			clear_schd_error(err);
+
 			rc = eval_placement(policy, spec, ninfo_arr, pl, resresv, pass_flags, nspec_arr, err);
 		}
 		else {
@@ -2620,6 +3085,18 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 				flags |= EVAL_EXCLSET;
 			}
 
+			/* an exclusive host with anything running on it is out as a whole */
+			if (do_exclhost && dninfo_arr[0] != NULL && dninfo_arr[0]->hostset != NULL &&
+				dninfo_arr[0]->hostset->busy_nodes > 0) {
+				log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG,
+					resresv->name, "Host %s is not free for exclusive use", hostsets[i]->res_val);
+				if (failerr->status_code == SCHD_UNKWN) {
+					set_schd_error_codes(failerr, NOT_RUN, NODE_NOT_EXCL);
+					set_schd_error_arg(failerr, ARG1, resresv->is_job ? "Job":"Reservation");
+				}
+				continue;
+			}
+
 			rc = any_succ_rc = 0;
 			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG,
 				resresv->name, "Evaluating host %s", hostsets[i]->res_val);
@@ -3025,7 +3502,7 @@ eval_complex_selspec(status *policy, selspec *spec, node_info **ninfo_arr, place
 				 */
 				if (conf.provision_policy != AVOID_PROVISION &&
 					cstat.node_sort[0].res_name != NULL && conf.node_sort_unused)
-					qsort(nodes, tot_nodes, sizeof(node_info *), multi_node_sort);
+					resort_nodes(nodes, tot_nodes);
 			}
 			chunks_needed--;
 		}
@@ -3947,7 +4424,7 @@ check_resources_for_node(resource_req *resreq, node_info *ninfo,
 int
 compare_place(place *pl1, place *pl2)
 {
-	if (pl1 == NULL && pl2 == NULL)
+	if (pl1 == pl2)
 		return 1;
 	else if (pl1 == NULL || pl2 == NULL)
 		return 0;
@@ -4217,6 +4694,103 @@ parse_selspec(char *select_spec)
 	return spec;
 }
 
+/**
+ * @brief
+ *		find a select spec in the per-cycle intern table, or parse it
+ *		with parse_selspec() and add it.
+ *
+ * @param[in]	select_spec	-	the select spec to find
+ *
+ * @return	selspec *
+ * @retval	read-only selspec shared by all holders of the same spec
+ * @retval	NULL	: on error or invalid spec
+ *
+ * @par MT-safe: Yes
+ */
+selspec *
+find_alloc_selspec(char *select_spec)
+{
+	selspec *spec;
+
+	if (select_spec == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&general_lock);
+	auto it = selspec_interns.find(select_spec);
+	if (it != selspec_interns.end())
+		spec = it->second;
+	else {
+		spec = parse_selspec(select_spec);
+		if (spec != NULL) {
+			spec->is_interned = 1;
+			selspec_interns[select_spec] = spec;
+		}
+	}
+	pthread_mutex_unlock(&general_lock);
+
+	return spec;
+}
+
+/**
+ * @brief
+ *		find a placement spec in the per-cycle intern table, or parse it
+ *		with parse_placespec() and add it.
+ *
+ * @param[in]	place_str	-	placespec as a string
+ *
+ * @return	place *
+ * @retval	read-only place shared by all holders of the same spec
+ * @retval	NULL	: invalid placement spec
+ *
+ * @par MT-safe: Yes
+ */
+place *
+find_alloc_placespec(char *place_str)
+{
+	place *pl;
+
+	if (place_str == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&general_lock);
+	auto it = placespec_interns.find(place_str);
+	if (it != placespec_interns.end())
+		pl = it->second;
+	else {
+		pl = parse_placespec(place_str);
+		if (pl != NULL) {
+			pl->is_interned = 1;
+			placespec_interns[place_str] = pl;
+		}
+	}
+	pthread_mutex_unlock(&general_lock);
+
+	return pl;
+}
+
+/**
+ * @brief
+ *		free the select and place specs interned this cycle.  Must be
+ *		called after everything holding them has been freed.
+ *
+ * @return void
+ */
+void
+free_interned_specs(void)
+{
+	for (auto &si : selspec_interns) {
+		si.second->is_interned = 0;
+		free_selspec(si.second);
+	}
+	selspec_interns.clear();
+
+	for (auto &pi : placespec_interns) {
+		pi.second->is_interned = 0;
+		free_place(pi.second);
+	}
+	placespec_interns.clear();
+}
+
 /**
  *	@brief compare two chunks for equality
  *	@param[in] c1 - first chunk
@@ -4253,7 +4827,7 @@ int compare_selspec(selspec *s1, selspec *s2) {
 	int i;
 	int ret = 1;
 
-	if(s1 == NULL && s2 == NULL)
+	if(s1 == s2)
 		return 1;
 	else if(s1 == NULL || s2 == NULL)
 		return 0;
@@ -4777,13 +5351,23 @@ reorder_nodes(node_info **nodes, resource_resv *resresv)
 
 	if (resresv != NULL) {
 		if (resresv->aoename != NULL && conf.provision_policy == AVOID_PROVISION) {
-			memcpy(nptr, nodes, (nsize+1) * sizeof(node_info *));
-
-			if (cmp_aoename != NULL)
-				free(cmp_aoename);
+			int rank;
+			int run_start;
 
-			cmp_aoename = string_dup(resresv->aoename);
-			qsort(nptr, nsize, sizeof(node_info *), cmp_aoe);
+			/* Same order as sorting with cmp_aoe(): the nodes already in the
+			 * aoe, then the ones without an aoe, then the rest.  Group the
+			 * nodes by aoe first so the sort only compares within a group.
+			 */
+			k = 0;
+			for (rank = 1; rank >= -1; rank--) {
+				run_start = k;
+				for (i = 0; i < nsize; i++)
+					if (node_aoe_rank(nodes[i], resresv->aoename) == rank)
+						nptr[k++] = nodes[i];
+				if (k - run_start > 1)
+					sort_nodes(nptr + run_start, k - run_start);
+			}
+			nptr[k] = NULL;
 
 			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
 				"Re-sorted the nodes on aoe %s, since aoe was requested", resresv->aoename);
@@ -5316,11 +5900,7 @@ node_up_event(node_info *node, void *arg)
 		set_node_info_state(node, ND_free);
 
 	sinfo = node->server;
-	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
+	mark_node_psets_stale(node);
 	update_all_nodepart(sinfo->policy, sinfo, NO_ALLPART);
 
 	return 1;
@@ -5364,11 +5944,7 @@ node_down_event(node_info *node, void *arg)
 
 	set_node_info_state(node, ND_down);
 
-	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
+	mark_node_psets_stale(node);
 	update_all_nodepart(sinfo->policy, sinfo, NO_ALLPART);
 
 	return 1;
@@ -5595,6 +6171,14 @@ set_current_aoe(node_info *node, char *aoe)
 {
 	if (node == NULL)
 		return;
+	if (is_aoe_grouped(node)) {
+		aoe_group *grp;
+
+		if ((grp = find_aoe_group(node->server->aoe_groups, node->current_aoe)) != NULL)
+			pbs_bitmap_bit_off(grp->nodes, node->node_ind);
+		if (aoe != NULL)
+			add_node_to_aoe_group(&node->server->aoe_groups, node, aoe);
+	}
 	if (node->current_aoe != NULL)
 		free(node->current_aoe);
 	if (aoe == NULL)
@@ -5603,6 +6187,191 @@ set_current_aoe(node_info *node, char *aoe)
 		node->current_aoe = string_dup(aoe);
 }
 
+/**
+ * @brief is a node one of the server's nodes in sinfo->aoe_groups
+ *
+ * @param[in] node - the node
+ *
+ * @return int
+ * @retval 1 - yes
+ * @retval 0 - no, e.g. a reservation's copy of the node
+ */
+int
+is_aoe_grouped(node_info *node)
+{
+	server_info *sinfo;
+
+	if (node == NULL || node->server == NULL)
+		return 0;
+
+	sinfo = node->server;
+	if (sinfo->aoe_groups == NULL || node->node_ind < 0 || node->node_ind >= sinfo->num_nodes)
+		return 0;
+
+	return sinfo->unordered_nodes[node->node_ind] == node;
+}
+
+/**
+ * @brief find the group of nodes with a current_aoe
+ *
+ * @param[in] groups - the groups to search
+ * @param[in] aoename - the aoe
+ *
+ * @return aoe_group *
+ * @retval the group
+ * @retval NULL if no node has the aoe
+ */
+aoe_group *
+find_aoe_group(aoe_group **groups, const char *aoename)
+{
+	int i;
+
+	if (groups == NULL || aoename == NULL)
+		return NULL;
+
+	for (i = 0; groups[i] != NULL; i++)
+		if (strcmp(groups[i]->aoename, aoename) == 0)
+			return groups[i];
+
+	return NULL;
+}
+
+/**
+ * @brief add a node to the group of its aoe, creating the group if needed
+ *
+ * @param[in,out] groups - the groups, possibly reallocated
+ * @param[in] node - the node
+ * @param[in] aoename - the aoe the node has
+ *
+ * @return int
+ * @retval 1 - success
+ * @retval 0 - error
+ */
+int
+add_node_to_aoe_group(aoe_group ***groups, node_info *node, const char *aoename)
+{
+	aoe_group *grp;
+	aoe_group **tmp;
+	int ct;
+
+	if (groups == NULL || *groups == NULL || node == NULL || node->node_ind < 0 || aoename == NULL)
+		return 0;
+
+	if ((grp = find_aoe_group(*groups, aoename)) == NULL) {
+		grp = static_cast<aoe_group *>(calloc(1, sizeof(aoe_group)));
+		if (grp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		grp->aoename = string_dup(aoename);
+		grp->nodes = pbs_bitmap_alloc(NULL, node->node_ind + 1);
+		ct = count_array(*groups);
+		tmp = static_cast<aoe_group **>(realloc(*groups, (ct + 2) * sizeof(aoe_group *)));
+		if (grp->aoename == NULL || grp->nodes == NULL || tmp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(grp->aoename);
+			pbs_bitmap_free(grp->nodes);
+			free(grp);
+			if (tmp != NULL)
+				*groups = tmp;
+			return 0;
+		}
+		tmp[ct] = grp;
+		tmp[ct + 1] = NULL;
+		*groups = tmp;
+	}
+
+	pbs_bitmap_bit_on(grp->nodes, node->node_ind);
+	return 1;
+}
+
+/**
+ * @brief group the nodes by their current_aoe.  Jobs requesting an aoe
+ *	look up the nodes already in it rather than comparing the aoe of
+ *	each node.  Kept up to date by set_current_aoe().
+ *
+ * @param[in] unordered_nodes - the server's nodes, indexed by node_ind
+ *
+ * @return aoe_group **
+ * @retval the groups, an empty array if no node has an aoe
+ * @retval NULL on error
+ */
+aoe_group **
+create_aoe_groups(node_info **unordered_nodes)
+{
+	aoe_group **groups;
+	int i;
+
+	if (unordered_nodes == NULL)
+		return NULL;
+
+	groups = static_cast<aoe_group **>(calloc(1, sizeof(aoe_group *)));
+	if (groups == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0; unordered_nodes[i] != NULL; i++) {
+		if (unordered_nodes[i]->current_aoe != NULL &&
+			add_node_to_aoe_group(&groups, unordered_nodes[i], unordered_nodes[i]->current_aoe) == 0) {
+			free_aoe_groups(groups);
+			return NULL;
+		}
+	}
+
+	return groups;
+}
+
+/**
+ * @brief free an array of aoe groups
+ *
+ * @param[in] groups - the groups to free
+ *
+ * @return void
+ */
+void
+free_aoe_groups(aoe_group **groups)
+{
+	int i;
+
+	if (groups == NULL)
+		return;
+
+	for (i = 0; groups[i] != NULL; i++) {
+		free(groups[i]->aoename);
+		pbs_bitmap_free(groups[i]->nodes);
+		free(groups[i]);
+	}
+	free(groups);
+}
+
+/**
+ * @brief how a node's current_aoe compares to an aoe
+ *
+ * @param[in] node - the node
+ * @param[in] aoename - the aoe
+ *
+ * @return int
+ * @retval 1 - the node has the aoe
+ * @retval 0 - the node has no aoe
+ * @retval -1 - the node has another aoe
+ */
+int
+node_aoe_rank(node_info *node, const char *aoename)
+{
+	if (node->current_aoe == NULL)
+		return 0;
+
+	if (is_aoe_grouped(node)) {
+		aoe_group *grp;
+
+		grp = find_aoe_group(node->server->aoe_groups, aoename);
+		return (grp != NULL && pbs_bitmap_get_bit(grp->nodes, node->node_ind)) ? 1 : -1;
+	}
+
+	return strcmp(node->current_aoe, aoename) == 0 ? 1 : -1;
+}
+
 /**
  * @brief set current_eoe on a node.  Free existing value if set
  * @param[in] node - node to set
@@ -5770,6 +6539,52 @@ alloc_tdata_nd_eligible(place *pl, resource_resv *resresv, node_info **ninfo_arr
 	return tdata;
 }
 
+/**
+ * @brief
+ * 		mark the vnodes of the hosts resresv would need exclusively but
+ *		which run a job or reservation ineligible, a whole host at a time.
+ *		This spares checking each vnode of a busy host on its own.
+ *
+ * @param[in]	ninfo_arr	-	array to check
+ * @param[in]	resresv	-	resresv to check to place on nodes
+ * @param[in]	pl	-	the placement object
+ * @param[out]	err	-	error structure, set if no error is there yet
+ *
+ * @return	void
+ */
+static void
+mark_busy_exclhosts(node_info **ninfo_arr, resource_resv *resresv, place *pl, schd_error *err)
+{
+	schd_error *hosterr;
+	int i, j;
+
+	hosterr = new_schd_error();
+	if (hosterr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return;
+	}
+	set_schd_error_codes(hosterr, NOT_RUN, NODE_NOT_EXCL);
+	set_schd_error_arg(hosterr, ARG1, resresv->is_job ? "Job":"Reservation");
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		node_info *node = ninfo_arr[i];
+		node_partition *host = node->hostset;
+
+		if (host == NULL || host->busy_nodes == 0 || (node->nscr & NSCR_INELIGIBLE))
+			continue;
+		if (!is_exclhost(pl, node->sharing))
+			continue;
+
+		for (j = 0; host->ninfo_arr[j] != NULL; j++)
+			host->ninfo_arr[j]->nscr |= NSCR_INELIGIBLE;
+		schdlogerr(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, host->res_val, NULL, hosterr);
+		if (err->status_code == SCHD_UNKWN)
+			copy_schd_error(err, hosterr);
+	}
+
+	free_schd_error(hosterr);
+}
+
 /**
  * @brief
  * 		check nodes for eligibility and mark them ineligible if not
@@ -5802,6 +6617,9 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 	if (num_nodes == -1)
 		num_nodes = count_array(ninfo_arr);
 
+	if (resresv->server->hostsets != NULL)
+		mark_busy_exclhosts(ninfo_arr, resresv, pl, err);
+
 	tid = *((int *) pthread_getspecific(th_id_key));
 	if (tid != 0 || num_threads <= 1) {
 		/* don't use multi-threading if I am a worker thread or num_threads is 1 */
@@ -5813,8 +6631,7 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 		free_schd_error(tdata->err);
 		free(tdata);
 	} else {	 /* We are multithreading */
-		chunk_size = num_nodes / num_threads;
-		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
+		chunk_size = mt_chunk_size(num_nodes, 0);
 		for (j = 0, num_tasks = 0; num_nodes > 0;
 				num_tasks++, j += chunk_size, num_nodes -= chunk_size) {
 			tdata = alloc_tdata_nd_eligible(pl, resresv, ninfo_arr, j, j + chunk_size - 1);
@@ -5830,11 +6647,15 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 			task->task_type = TS_IS_ND_ELIGIBLE;
 			task->thread_data = (void *) tdata;
 
-			queue_work_for_threads(task);
+			/* check the nodes on the thread which allocated them */
+			queue_work_for_thread(task, ninfo_arr[j]->home_thread);
 		}
 
 		/* Get results from worker threads */
 		for (i = 0; i < num_tasks;) {
+			/* help out with the queued work rather than wait for it */
+			while (run_queued_task())
+				;
 			pthread_mutex_lock(&result_lock);
 			while (ds_queue_is_empty(result_queue))
 				pthread_cond_wait(&result_cond, &result_lock);
@@ -59,6 +59,11 @@ node_info **query_nodes(int pbs_sd, server_info *sinfo);
  */
 node_info *query_node_info(struct batch_status *node, server_info *sinfo);
 
+/*
+ *      clear_node_query_cache - free the nodes cached by query_nodes()
+ */
+void clear_node_query_cache(void);
+
 /*
  * pthread routine for freeing up a node_info array
  */
@@ -321,6 +326,15 @@ selspec *parse_selspec(char *selspec);
 /* compare two selspecs to see if they are equal*/
 int compare_selspec(selspec *sel1, selspec *sel2);
 
+/* find or parse a select spec shared read-only for this cycle */
+selspec *find_alloc_selspec(char *select_spec);
+
+/* find or parse a placement spec shared read-only for this cycle */
+place *find_alloc_placespec(char *place_str);
+
+/* free the select and place specs shared this cycle */
+void free_interned_specs(void);
+
 /*
  *	combine_nspec_array - find and combine any nspec's for the same node
  *				in an nspec array
@@ -613,6 +627,24 @@ int sim_exclhost_func(timed_event *te, void *arg1, void *arg2);
  */
 void set_current_aoe(node_info *node, char *aoe);
 
+/* is a node one of the server's nodes in sinfo->aoe_groups */
+int is_aoe_grouped(node_info *node);
+
+/* find the group of nodes with a current_aoe */
+aoe_group *find_aoe_group(aoe_group **groups, const char *aoename);
+
+/* add a node to the group of its aoe, creating the group if needed */
+int add_node_to_aoe_group(aoe_group ***groups, node_info *node, const char *aoename);
+
+/* group the nodes by their current_aoe */
+aoe_group **create_aoe_groups(node_info **unordered_nodes);
+
+/* free an array of aoe groups */
+void free_aoe_groups(aoe_group **groups);
+
+/* how a node's current_aoe compares to an aoe: 1 same, 0 none, -1 other */
+int node_aoe_rank(node_info *node, const char *aoename);
+
 /**
  * set current_eoe on a node.  Free existing value if set
  */
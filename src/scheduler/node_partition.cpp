@@ -55,6 +55,9 @@
  * 	create_node_partitions()
  * 	node_partition_update_array()
  * 	node_partition_update()
+ * 	node_partition_update_stale()
+ * 	mark_node_psets_stale()
+ * 	update_nodepart_on_run()
  * 	new_np_cache()
  * 	free_np_cache_array()
  * 	free_np_cache()
@@ -67,6 +70,9 @@
  */
 #include <pbs_config.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -112,11 +118,13 @@ new_node_partition()
 
 	np->ok_break = 1;
 	np->excl = 0;
+	np->stale = 0;
 	np->name = NULL;
 	np->def = NULL;
 	np->res_val = NULL;
 	np->tot_nodes = 0;
 	np->free_nodes = 0;
+	np->busy_nodes = 0;
 	np->res = NULL;
 	np->ninfo_arr = NULL;
 	np->bkts = NULL;
@@ -255,8 +263,10 @@ dup_node_partition(node_partition *onp, server_info *nsinfo)
 
 	nnp->ok_break = onp->ok_break;
 	nnp->excl = onp->excl;
+	nnp->stale = onp->stale;
 	nnp->tot_nodes = onp->tot_nodes;
 	nnp->free_nodes = onp->free_nodes;
+	nnp->busy_nodes = onp->busy_nodes;
 	nnp->res = dup_resource_list(onp->res);
 	nnp->ninfo_arr = copy_node_ptr_array(onp->ninfo_arr, nsinfo->nodes);
 
@@ -381,16 +391,11 @@ node_partition **
 create_node_partitions(status *policy, node_info **nodes, const char * const *resnames, unsigned int flags, int *num_parts)
 {
 	node_partition **np_arr;
-	node_partition *np;
 	node_partition **tmp_arr;
-	char buf[1024];
-	char *str;
-	int free_str = 0;
 	int np_arr_size = 0;
 	schd_resource *res;
 
 	int num_nodes;
-	int reslen;
 	int i;
 
 	schd_resource *hostres;
@@ -408,6 +413,14 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 
 	queue_info **queues = NULL;
 
+	/* partition name to index into np_arr, and the nodes of each partition.
+	 * The nodes are collected in one pass over the nodes rather than a
+	 * search of the partitions for every node and a pass over the nodes
+	 * for every partition.
+	 */
+	std::unordered_map<std::string, int> np_index;
+	std::vector<std::vector<int> > np_nodes;
+
 	if (nodes == NULL || resnames == NULL)
 		return NULL;
 
@@ -434,8 +447,13 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 	}
 
 	for (res_i = 0; resnames[res_i] != NULL; res_i++) {
+		/* a resource named twice makes the same partitions again */
+		for (i = 0; i < res_i && strcmp(resnames[i], resnames[res_i]) != 0; i++)
+			;
+		if (i < res_i)
+			continue;
+
 		def = find_resdef(allres, resnames[res_i]);
-		reslen = strlen(resnames[res_i]);
 		for (node_i = 0; nodes[node_i] != NULL; node_i++) {
 			if (nodes[node_i]->is_stale)
 				continue;
@@ -451,28 +469,19 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 				if (res->indirect_res != NULL)
 					res = res->indirect_res;
 				for (val_i = 0; res->str_avail[val_i] != NULL; val_i++) {
-					/* 2: 1 for '=' 1 for '\0' */
-					if (reslen + strlen(res->str_avail[val_i]) + 2 < 1024) {
-						sprintf(buf, "%s=%s", resnames[res_i], res->str_avail[val_i]);
-						str = buf;
-					}
-					else {
-						pbs_asprintf(&str, "%s=%s", resnames[res_i], res->str_avail[val_i]);
-						free_str = 1;
-					}
+					std::string name = std::string(resnames[res_i]) + "=" + res->str_avail[val_i];
+					auto it = np_index.find(name);
+
 					/* If we find the partition, we've already created it - add the node
 					 * to the existing partition.  If we don't find it, we create it.
 					 */
-					np = find_node_partition(np_arr, str);
-					if (np == NULL) {
+					if (it == np_index.end()) {
 						if (np_i >= np_arr_size) {
 							tmp_arr = static_cast<node_partition **>(realloc(np_arr,
 								(np_arr_size * 2 + 1) * sizeof(node_partition *)));
 							if (tmp_arr == NULL) {
 								log_err(errno, __func__, MEM_ERR_MSG);
 								free_node_partition_array(np_arr);
-								if (free_str == 1)
-									free(str);
 								return NULL;
 							}
 							np_arr = tmp_arr;
@@ -480,45 +489,28 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 						}
 
 						np_arr[np_i] = new_node_partition();
-						if (np_arr[np_i] != NULL) {
-							if (free_str) {
-								np_arr[np_i]->name = str;
-								free_str = 0;
-							}
-							else
-								np_arr[np_i]->name = string_dup(str);
-
-							np_arr[np_i]->def = def;
-							np_arr[np_i]->res_val = string_dup(res->str_avail[val_i]);
-							np_arr[np_i]->tot_nodes = 1;
-							if (nodes[node_i]->is_free)
-								np_arr[np_i]->free_nodes = 1;
-							np_arr[np_i]->rank = get_sched_rank();
-
-							if (np_arr[np_i]->res_val == NULL) {
-								np_arr[np_i + 1] = NULL;
-								free_node_partition_array(np_arr);
-								return NULL;
-							}
-
-							np_i++;
-							np_arr[np_i] = NULL;
+						if (np_arr[np_i] == NULL) {
+							free_node_partition_array(np_arr);
+							return NULL;
 						}
-						else {
+						np_arr[np_i]->name = string_dup(name.c_str());
+						np_arr[np_i]->def = def;
+						np_arr[np_i]->res_val = string_dup(res->str_avail[val_i]);
+						np_arr[np_i]->rank = get_sched_rank();
+						np_arr[np_i + 1] = NULL;
+
+						if (np_arr[np_i]->name == NULL || np_arr[np_i]->res_val == NULL) {
 							free_node_partition_array(np_arr);
 							return NULL;
 						}
-					}
-					else {
-						np->tot_nodes++;
-						if (nodes[node_i]->is_free)
-							np->free_nodes++;
-					}
-					if (free_str) {
-						free(str);
-						free_str = 0;
-					}
 
+						it = np_index.emplace(name, np_i).first;
+						np_nodes.emplace_back();
+						np_i++;
+					}
+					/* a node listing a value more than once is in the partition once */
+					if (np_nodes[it->second].empty() || np_nodes[it->second].back() != node_i)
+						np_nodes[it->second].push_back(node_i);
 				}
 			}
 			/* else we ignore nodes without the node partition resource set
@@ -528,13 +520,15 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 	}
 
 
-	/* now that we have a list of node partitions and number of nodes in each
+	/* now that we have a list of node partitions and the nodes in each
 	 * lets allocate a node array and fill it
 	 */
 
 	for (np_i = 0; np_arr[np_i] != NULL; np_i++) {
-		i = 0;
+		std::vector<int> &members = np_nodes[np_i];
+
 		np_arr[np_i]->ok_break = 1;
+		np_arr[np_i]->tot_nodes = members.size();
 		hostres = NULL;
 
 		np_arr[np_i]->ninfo_arr =
@@ -545,53 +539,33 @@ create_node_partitions(status *policy, node_info **nodes, const char * const *re
 			return NULL;
 		}
 
-		np_arr[np_i]->ninfo_arr[0] = NULL;
-
-		for (node_i = 0; nodes[node_i] != NULL &&
-			i < np_arr[np_i]->tot_nodes; node_i++) {
-			if (nodes[node_i]->is_stale)
-				continue;
+		for (i = 0; i < np_arr[np_i]->tot_nodes; i++) {
+			node_info *ninfo = nodes[members[i]];
 
-			res = find_resource(nodes[node_i]->res, np_arr[np_i]->def);
-			if (res == NULL && (flags & NP_CREATE_REST)) {
-				unset_res.name = resnames[res_i];
-				res = &unset_res;
-			}
-			if (res != NULL) {
-				/* Incase of indirect resource, point it to the right place */
-				if (res->indirect_res != NULL)
-					res = res->indirect_res;
-				if (compare_res_to_str(res, np_arr[np_i]->res_val, CMP_CASE)) {
-					if (np_arr[np_i]->ok_break) {
-						tmpres = find_resource(nodes[node_i]->res, getallres(RES_HOST));
-						if (tmpres != NULL) {
-							if (hostres == NULL)
-								hostres = tmpres;
-							else {
-								if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS))
-									np_arr[np_i]->ok_break = 0;
-							}
-						}
-					}
-					if (!(NP_NO_ADD_NP_ARR & flags)) {
-						tmp_arr = static_cast<node_partition **>(add_ptr_to_array(nodes[node_i]->np_arr, np_arr[np_i]));
-						if (tmp_arr == NULL) {
-							free_node_partition_array(np_arr);
-							return NULL;
-						}
-						nodes[node_i]->np_arr = tmp_arr;
+			if (np_arr[np_i]->ok_break) {
+				tmpres = find_resource(ninfo->res, getallres(RES_HOST));
+				if (tmpres != NULL) {
+					if (hostres == NULL)
+						hostres = tmpres;
+					else {
+						if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS))
+							np_arr[np_i]->ok_break = 0;
 					}
-
-					np_arr[np_i]->ninfo_arr[i] = nodes[node_i];
-					i++;
-					np_arr[np_i]->ninfo_arr[i] = NULL;
 				}
 			}
+			if (!(NP_NO_ADD_NP_ARR & flags)) {
+				tmp_arr = static_cast<node_partition **>(add_ptr_to_array(ninfo->np_arr, np_arr[np_i]));
+				if (tmp_arr == NULL) {
+					free_node_partition_array(np_arr);
+					return NULL;
+				}
+				ninfo->np_arr = tmp_arr;
+			}
+
+			np_arr[np_i]->ninfo_arr[i] = ninfo;
 		}
-		/* if multiple resource values are present, tot_nodes may be incorrect.
-		 * recalculating tot_nodes for each node partition.
-		 */
-		np_arr[np_i]->tot_nodes = count_array(np_arr[np_i]->ninfo_arr);
+		np_arr[np_i]->ninfo_arr[i] = NULL;
+
 		np_arr[np_i]->bkts = create_node_buckets(policy, np_arr[np_i]->ninfo_arr, queues, NO_PRINT_BUCKETS);
 		node_partition_update(policy, np_arr[np_i]);
 	}
@@ -704,6 +678,61 @@ node_partition_update_array(status *policy, node_partition **nodepart)
 }
 
 
+/**
+ * @brief
+ * 		update the node partitions of an array whose metadata is stale,
+ *		either because one of their nodes changed or it was never created.
+ *		The others are left alone.
+ *
+ * @param[in] policy	-	policy info
+ * @param[in] nodepart	-	partition array to update
+ *
+ * @return	int
+ * @retval	1	: on all success
+ * @retval	0	: on any failure
+ */
+int
+node_partition_update_stale(status *policy, node_partition **nodepart)
+{
+	int i;
+	int rc = 1;
+
+	if (policy == NULL || nodepart == NULL)
+		return 0;
+
+	for (i = 0; nodepart[i] != NULL; i++) {
+		if (!nodepart[i]->stale && nodepart[i]->res != NULL)
+			continue;
+		if (node_partition_update(policy, nodepart[i]) == 0)
+			rc = 0;
+		update_buckets_for_node_array(nodepart[i]->bkts, nodepart[i]->ninfo_arr);
+	}
+
+	return rc;
+}
+
+/**
+ * @brief
+ * 		mark the node partitions a node is in as needing an update.  Called
+ *		when a node's resources or state change other than through a job or
+ *		reservation being run on it, which updates the partitions in place.
+ *
+ * @param[in] ninfo	-	the node
+ *
+ * @return	void
+ */
+void
+mark_node_psets_stale(node_info *ninfo)
+{
+	int i;
+
+	if (ninfo == NULL || ninfo->np_arr == NULL)
+		return;
+
+	for (i = 0; ninfo->np_arr[i] != NULL; i++)
+		ninfo->np_arr[i]->stale = 1;
+}
+
 /**
  * @brief
  * 		update the meta data about a node partition
@@ -743,6 +772,8 @@ node_partition_update(status *policy, node_partition *np)
 		arl_flags |= ADD_UNSET_BOOLS_FALSE;
 
 	np->free_nodes = 0;
+	np->busy_nodes = 0;
+	np->stale = 0;
 
 	for (i = 0; i < np->tot_nodes; i++) {
 		if (np->ninfo_arr[i]->is_free) {
@@ -750,6 +781,8 @@ node_partition_update(status *policy, node_partition *np)
 			arl_flags &= ~ADD_AVAIL_ASSIGNED;
 		} else
 			arl_flags |= ADD_AVAIL_ASSIGNED;
+		if (np->ninfo_arr[i]->num_jobs > 0 || np->ninfo_arr[i]->num_run_resv > 0)
+			np->busy_nodes++;
 
 		if (np->res == NULL)
 			np->res = dup_selective_resource_list(np->ninfo_arr[i]->res,
@@ -762,8 +795,7 @@ node_partition_update(status *policy, node_partition *np)
 
 	if (policy->node_sort[0].res_name != NULL && conf.node_sort_unused) {
 		/* Resort the nodes in the partition so that selection works correctly. */
-		qsort(np->ninfo_arr, np->tot_nodes, sizeof(node_info *),
-			multi_node_sort);
+		resort_nodes(np->ninfo_arr, np->tot_nodes);
 	}
 
 	return rc;
@@ -1348,6 +1380,106 @@ sort_all_nodepart(status *policy, server_info *sinfo)
 	}
 }
 
+/**
+ * @brief
+ *		add the consumable resources of a chunk to a placement set's
+ *		allocation delta
+ *
+ * @param[in,out]	delta	-	the delta, summed by resource
+ * @param[in]		reqlist	-	the chunk's resources
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: malloc error
+ */
+static int
+add_to_alloc_delta(resource_req **delta, resource_req *reqlist)
+{
+	resource_req *req;
+	resource_req *dreq;
+
+	for (req = reqlist; req != NULL; req = req->next) {
+		if (!req->type.is_consumable)
+			continue;
+		dreq = find_resource_req(*delta, req->def);
+		if (dreq != NULL)
+			dreq->amount += req->amount;
+		else {
+			if ((dreq = dup_resource_req(req)) == NULL)
+				return 0;
+			dreq->next = *delta;
+			*delta = dreq;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ *		update the placement sets of the nodes a job or reservation was
+ *		run on.  The chunks' resources are first summed into one allocation
+ *		delta per placement set so each placement set's resource list is
+ *		walked once per run rather than once per chunk.
+ *
+ * @param[in]	nspec_arr	-	the combined nspecs of the job or reservation
+ *
+ * @return	int
+ * @retval	1	: placement sets were updated and need to be sorted
+ * @retval	0	: no placement sets were updated
+ * @retval	-1	: malloc error
+ *
+ * @note update_node_on_run() must already have been called for the nodes
+ */
+int
+update_nodepart_on_run(nspec **nspec_arr)
+{
+	std::unordered_map<node_partition *, resource_req *> delta;
+	std::vector<node_partition *> order;
+	int rc = 0;
+	int i;
+	int j;
+
+	if (nspec_arr == NULL)
+		return 0;
+
+	for (i = 0; nspec_arr[i] != NULL; i++) {
+		node_info *ninfo = nspec_arr[i]->ninfo;
+
+		if (ninfo->np_arr == NULL)
+			continue;
+		for (j = 0; ninfo->np_arr[j] != NULL; j++) {
+			node_partition *np = ninfo->np_arr[j];
+			auto d = delta.find(np);
+
+			if (d == delta.end()) {
+				d = delta.emplace(np, (resource_req *) NULL).first;
+				order.push_back(np);
+			}
+			if (!add_to_alloc_delta(&d->second, nspec_arr[i]->resreq))
+				rc = -1;
+			if (!ninfo->is_free)
+				np->free_nodes--;
+			update_buckets_for_node(np->bkts, ninfo);
+		}
+	}
+
+	for (auto np : order) {
+		resource_req *dreq = delta[np];
+
+		if (dreq != NULL) {
+			modify_resource_list(np->res, dreq, SCHD_INCR);
+			free_resource_req_list(dreq);
+		}
+	}
+
+	if (rc == -1) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return -1;
+	}
+
+	return order.empty() ? 0 : 1;
+}
+
 /**
  *
  *	@brief update all node partitions of all queues on the server
@@ -1377,15 +1509,16 @@ update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags)
 	if(sinfo->allpart == NULL)
 		return;
 
+	/* Only the placement sets with a node that changed need an update */
 	if (sinfo->node_group_enable && sinfo->node_group_key != NULL)
-		node_partition_update_array(policy, sinfo->nodepart);
+		node_partition_update_stale(policy, sinfo->nodepart);
 
 	/* Update and resort the placement sets on the queues */
 	for (i = 0; sinfo->queues[i] != NULL; i++) {
 		qinfo = sinfo->queues[i];
 
 		if (sinfo->node_group_enable && qinfo->node_group_key != NULL)
-			node_partition_update_array(policy, qinfo->nodepart);
+			node_partition_update_stale(policy, qinfo->nodepart);
 
 		if ((flags & NO_ALLPART) == 0) {
 			if(qinfo->allpart != NULL && qinfo->allpart->res == NULL)
@@ -1394,9 +1527,10 @@ update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags)
 	}
 
 	/* Update and resort the hostsets */
-	node_partition_update_array(policy, sinfo->hostsets);
+	if (sinfo->hostsets != NULL)
+		node_partition_update_stale(policy, sinfo->hostsets);
 
-	if ((flags & NO_ALLPART) == 0)
+	if ((flags & NO_ALLPART) == 0 && (sinfo->allpart->stale || sinfo->allpart->res == NULL))
 		node_partition_update(policy, sinfo->allpart);
 
 	sort_all_nodepart(policy, sinfo);
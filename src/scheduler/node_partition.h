@@ -160,6 +160,12 @@ int node_partition_update_array(status *policy, node_partition **nodepart);
  */
 int node_partition_update(status *policy, node_partition *np);
 
+/* update the node partitions of an array whose metadata is stale */
+int node_partition_update_stale(status *policy, node_partition **nodepart);
+
+/* mark the node partitions a node is in as needing an update */
+void mark_node_psets_stale(node_info *ninfo);
+
 /*
  *	new_np_cache - constructor
  */
@@ -221,6 +227,9 @@ node_partition *create_specific_nodepart(status *policy, const char *name, node_
 /* create the placement sets for the server and queues */
 int create_placement_sets(status *policy, server_info *sinfo);
 
+/* update the placement sets of the nodes a job or reservation was run on */
+int update_nodepart_on_run(nspec **nspec_arr);
+
 /* Update placement sets and allparts */
 void update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags);
 
@@ -248,6 +248,9 @@ parse_config(const char *fname)
 				else if (!strcmp(config_name, PARSE_UPDATE_COMMENTS)) {
 					conf.update_comments = num ? 1 : 0;
 				}
+				else if (!strcmp(config_name, PARSE_PIN_THREADS)) {
+					conf.pin_threads = num ? 1 : 0;
+				}
 				else if (!strcmp(config_name, PARSE_BACKFILL_PRIME)) {
 					if (prime == PRIME || prime == PT_ALL)
 						conf.prime_bp = num ? 1 : 0;
@@ -297,6 +300,11 @@ parse_config(const char *fname)
 					if (!type.is_time)
 						error = 1;
 				}
+				else if (!strcmp(config_name, PARSE_SERVER_DYN_RES_TTL)) {
+					conf.server_dyn_res_ttl = res_to_num(config_value, &type);
+					if (!type.is_time)
+						error = 1;
+				}
 				else if (!strcmp(config_name, PARSE_UNKNOWN_SHARES))
 					conf.unknown_shares = num;
 				else if (!strcmp(config_name, PARSE_FAIRSHARE_DECAY_FACTOR)) {
@@ -317,6 +325,21 @@ parse_config(const char *fname)
 						free(conf.fairshare_res);
 					conf.fairshare_res = string_dup(config_value);
 				}
+				else if (!strcmp(config_name, PARSE_CYCLE_PROFILE_FILE)) {
+					if (conf.cycle_profile_file != NULL)
+						free(conf.cycle_profile_file);
+					conf.cycle_profile_file = string_dup(config_value);
+				}
+				else if (!strcmp(config_name, PARSE_CYCLE_CAPTURE_FILE)) {
+					if (conf.cycle_capture_file != NULL)
+						free(conf.cycle_capture_file);
+					conf.cycle_capture_file = string_dup(config_value);
+				}
+				else if (!strcmp(config_name, PARSE_DECISION_TRACE_FILE)) {
+					if (conf.decision_trace_file != NULL)
+						free(conf.decision_trace_file);
+					conf.decision_trace_file = string_dup(config_value);
+				}
 				else if (!strcmp(config_name, PARSE_FAIRSHARE_ENT)) {
 					if (strcmp(config_value, ATTR_euser) &&
 						strcmp(config_value, ATTR_egroup) &&
@@ -711,6 +734,11 @@ parse_config(const char *fname)
 						conf.max_jobs_to_check = SCHD_INFINITY;
 					else
 						conf.max_jobs_to_check = num;
+				} else if (!strcmp(config_name, PARSE_NODE_REFRESH_CYCLES)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.node_refresh_cycles = num;
 				} else if (!strcmp(config_name, PARSE_CPUS_PER_SSINODE) ||
 					   !strcmp(config_name, PARSE_MEM_PER_SSINODE)) {
 					obsolete[0] = config_name;
@@ -865,6 +893,18 @@ init_config()
 		free(conf.fairshare_ent);
 		conf.fairshare_ent = NULL;
 	}
+	if (conf.cycle_profile_file != NULL) {
+		free(conf.cycle_profile_file);
+		conf.cycle_profile_file = NULL;
+	}
+	if (conf.cycle_capture_file != NULL) {
+		free(conf.cycle_capture_file);
+		conf.cycle_capture_file = NULL;
+	}
+	if (conf.decision_trace_file != NULL) {
+		free(conf.decision_trace_file);
+		conf.decision_trace_file = NULL;
+	}
 	if (conf.res_to_check != NULL)
 		free_string_array(conf.res_to_check);
 
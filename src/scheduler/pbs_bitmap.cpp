@@ -44,6 +44,35 @@
 #include "pbs_bitmap.h"
 
 #define BYTES_TO_BITS(x) ((x) * 8)
+#define BITS_PER_LONG BYTES_TO_BITS(sizeof(unsigned long))
+
+/* Count trailing zeros and on bits of a word.  Compilers turn the builtins
+ * into single instructions on the platforms we care about.
+ */
+#if defined(__GNUC__)
+#define WORD_CTZ(w) __builtin_ctzl(w)
+#define WORD_POPCOUNT(w) __builtin_popcountl(w)
+#else
+static int
+WORD_CTZ(unsigned long w)
+{
+	int i;
+
+	for (i = 0; !(w & 1UL); i++)
+		w >>= 1;
+	return i;
+}
+
+static int
+WORD_POPCOUNT(unsigned long w)
+{
+	int i;
+
+	for (i = 0; w != 0; i++)
+		w &= w - 1;
+	return i;
+}
+#endif
 
 
 /**
@@ -216,45 +245,26 @@ int
 pbs_bitmap_next_on_bit(pbs_bitmap *pbm, unsigned long start_bit)
 {
 	unsigned long long_ind;
-	long bit;
-	size_t i;
+	unsigned long w;
 
 	if (pbm == NULL)
 		return -1;
 
-	if (start_bit >= pbm->num_bits)
+	if (start_bit + 1 >= pbm->num_bits)
 		return -1;
 
-	long_ind = start_bit / BYTES_TO_BITS(sizeof(unsigned long));
-	bit = start_bit % BYTES_TO_BITS(sizeof(unsigned long));
-
-	/* special case - look at first long that contains start_bit */
-	if (pbm->bits[long_ind] != 0) {
-		for (i = bit + 1; i < BYTES_TO_BITS(sizeof(unsigned long)); i++) {
-			if (pbm->bits[long_ind] & (1UL << i)) {
-				return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-			}
-		}
+	start_bit++;
+	long_ind = start_bit / BITS_PER_LONG;
 
-		/* didn't find an on bit after start_bit_index in the long that contained start_bit */
-		if (long_ind < pbm->num_longs) {
-			long_ind++;
-		}
+	/* mask off the bits up to start_bit in its word */
+	w = pbm->bits[long_ind] & (~0UL << (start_bit % BITS_PER_LONG));
+	while (w == 0) {
+		if (++long_ind >= pbm->num_longs)
+			return -1;
+		w = pbm->bits[long_ind];
 	}
 
-	for( ; long_ind < pbm->num_longs && pbm->bits[long_ind] == 0; long_ind++)
-		;
-
-	if (long_ind == pbm->num_longs)
-		return -1;
-
-	for (i = 0 ; i < BYTES_TO_BITS(sizeof(unsigned long)) ; i++) {
-		if (pbm->bits[long_ind] & (1UL << i)) {
-			return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-		}
-	}
-
-	return -1;
+	return (long_ind * BITS_PER_LONG + WORD_CTZ(w));
 }
 
 /**
@@ -334,3 +344,160 @@ pbs_bitmap_is_equal(pbs_bitmap *L, pbs_bitmap *R)
 
 	return 1;
 }
+
+/**
+ * @brief make sure L has room for all of R's words
+ * @param L - bitmap to grow
+ * @param R - bitmap to fit
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+static int
+pbs_bitmap_fit(pbs_bitmap *L, pbs_bitmap *R)
+{
+	if (R->num_longs > L->num_longs)
+		if (pbs_bitmap_alloc(L, BYTES_TO_BITS(R->num_longs * sizeof(unsigned long))) == NULL)
+			return 0;
+	if (R->num_bits > L->num_bits)
+		L->num_bits = R->num_bits;
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L |= R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_or(pbs_bitmap *L, pbs_bitmap *R)
+{
+	unsigned long i;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	if (pbs_bitmap_fit(L, R) == 0)
+		return 0;
+
+	for (i = 0; i < R->num_longs; i++)
+		L->bits[i] |= R->bits[i];
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L &= ~R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_andnot(pbs_bitmap *L, pbs_bitmap *R)
+{
+	unsigned long i;
+	unsigned long n;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	n = (L->num_longs < R->num_longs) ? L->num_longs : R->num_longs;
+	for (i = 0; i < n; i++)
+		L->bits[i] &= ~R->bits[i];
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L &= R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_and(pbs_bitmap *L, pbs_bitmap *R)
+{
+	unsigned long i;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	for (i = 0; i < L->num_longs; i++)
+		L->bits[i] &= (i < R->num_longs) ? R->bits[i] : 0;
+
+	return 1;
+}
+
+/**
+ * @brief count the number of on bits in a bitmap
+ * @param pbm - the bitmap
+ * @return unsigned long
+ * @retval number of on bits
+ */
+unsigned long
+pbs_bitmap_count_on_bits(pbs_bitmap *pbm)
+{
+	unsigned long i;
+	unsigned long count = 0;
+
+	if (pbm == NULL)
+		return 0;
+
+	for (i = 0; i < pbm->num_longs; i++)
+		count += WORD_POPCOUNT(pbm->bits[i]);
+
+	return count;
+}
+
+/**
+ * @brief set result to the first n on bits of a bitmap
+ * @param pbm - the bitmap
+ * @param n - number of on bits to find
+ * @param[out] result - the first n on bits of pbm.  All other bits are off.
+ * @return long
+ * @retval the number of bits found (less than n if pbm has fewer on bits)
+ * @retval -1 on error
+ */
+long
+pbs_bitmap_first_n_on_bits(pbs_bitmap *pbm, unsigned long n, pbs_bitmap *result)
+{
+	unsigned long i;
+	unsigned long found = 0;
+
+	if (pbm == NULL || result == NULL)
+		return -1;
+
+	if (pbs_bitmap_fit(result, pbm) == 0)
+		return -1;
+	result->num_bits = pbm->num_bits;
+
+	for (i = 0; i < result->num_longs; i++) {
+		unsigned long w = 0;
+
+		if (i < pbm->num_longs && found < n) {
+			w = pbm->bits[i];
+			if (found + WORD_POPCOUNT(w) <= n)
+				found += WORD_POPCOUNT(w);
+			else {
+				/* only keep the lowest on bits needed to reach n */
+				unsigned long keep = 0;
+
+				for (; found < n; found++) {
+					keep |= w & (~w + 1);
+					w &= w - 1;
+				}
+				w = keep;
+			}
+		}
+		result->bits[i] = w;
+	}
+
+	return found;
+}
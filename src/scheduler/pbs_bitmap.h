@@ -80,6 +80,21 @@ int pbs_bitmap_assign(pbs_bitmap *L, pbs_bitmap *R);
 /* pbs_bitmap's version of L == R */
 int pbs_bitmap_is_equal(pbs_bitmap *L, pbs_bitmap *R);
 
+/* pbs_bitmap's version of L |= R */
+int pbs_bitmap_or(pbs_bitmap *L, pbs_bitmap *R);
+
+/* pbs_bitmap's version of L &= R */
+int pbs_bitmap_and(pbs_bitmap *L, pbs_bitmap *R);
+
+/* pbs_bitmap's version of L &= ~R */
+int pbs_bitmap_andnot(pbs_bitmap *L, pbs_bitmap *R);
+
+/* Count the on bits in a bitmap */
+unsigned long pbs_bitmap_count_on_bits(pbs_bitmap *pbm);
+
+/* Get the first n on bits of a bitmap */
+long pbs_bitmap_first_n_on_bits(pbs_bitmap *pbm, unsigned long n, pbs_bitmap *result);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,694 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file    pbs_sched_replay.cpp
+ *
+ * @brief
+ * 		pbs_sched_replay - replay a scheduling cycle captured with the
+ *		cycle_capture_file sched_config option, without a server or moms.
+ *
+ *	The captured server replies are fed to scheduling_cycle() through the
+ *	IFL function pointers, and requests the scheduler would have sent to
+ *	the server are printed instead, one decision per line:
+ *		run	<job>	<exec_vnode>
+ *		preempt	<job>
+ *		confirm	<reservation>	<vnodes>	<start>
+ *		alter	<job>	<attribute>=<value>
+ *		signal, move and delete	<job>	<arg>
+ *	Decisions of two scheduler versions can be compared by diffing their
+ *	outputs.  Each cycle's phase times are printed to stderr, and the
+ *	cycles' decision trace is written for pbs_sched_trace.
+ *
+ *	With -f, the capture is a snapshot to simulate forward from.  The
+ *	universe is built once and cycles are run on it one after another, each
+ *	at the time the next job ends in the one before, with the jobs that ended
+ *	printed as
+ *		end	<job>	<time>
+ *	and each cycle's line giving the time it ran at.  Pointing -d at a copy
+ *	of sched_priv with a changed sched_config shows how a policy change,
+ *	e.g. to the job sort keys or preemption, plays out over the cycles.
+ *
+ *	The cycle runs in a sched_priv directory like the scheduler would.  Since
+ *	the cycle may update files such as the fairshare usage, point it at a
+ *	copy of the captured scheduler's sched_priv.
+ *
+ * Functions included are:
+ * 	main()
+ *
+ */
+#include <pbs_config.h> /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <libpbs.h>
+#include <pbs_ifl.h>
+#include <pbs_ecl.h>
+#include "pbs_client_thread.h"
+#include "pbs_version.h"
+#include "sched_cmds.h"
+#include "log.h"
+#include "data_types.h"
+#include "constant.h"
+#include "globals.h"
+#include "fifo.h"
+#include "profile.h"
+#include "decision_trace.h"
+#include "cycle_capture.h"
+#include "job_info.h"
+#include "server_info.h"
+#include "resv_info.h"
+#include "simulate.h"
+#include "sort.h"
+#include "misc.h"
+
+/* connection descriptor the replayed cycle is given */
+#define REPLAY_SD 0
+
+static struct capture *cap;
+static FILE *decisions;
+
+/**
+ * @brief
+ * 		find the captured reply of a call.  Replies are handed out in the
+ *		order they were captured.  If a call is made more times than it was
+ *		captured, its last reply is handed out again.
+ *
+ * @param[in]	call	-	IFL call
+ * @param[in]	key	-	object the call is for, or NULL
+ *
+ * @return	struct batch_status *
+ * @retval	copy of the reply
+ * @retval	NULL	: a NULL reply or no reply was captured, pbs_errno is set
+ */
+static struct batch_status *
+replay_reply(const char *call, const char *key)
+{
+	struct capture_reply *reply;
+	struct capture_reply *last = NULL;
+
+	for (reply = cap->replies; reply != NULL; reply = reply->next) {
+		if (strcmp(reply->call, call) != 0)
+			continue;
+		if ((reply->key == NULL) != (key == NULL) ||
+			(key != NULL && strcmp(reply->key, key) != 0))
+			continue;
+		last = reply;
+		if (!reply->used)
+			break;
+	}
+	if (reply == NULL)
+		reply = last;
+
+	if (reply == NULL) {
+		pbs_errno = PBSE_UNKNODE;
+		return NULL;
+	}
+	reply->used = 1;
+	pbs_errno = reply->err;
+
+	return dup_batch_status_list(reply->bs);
+}
+
+static struct batch_status *
+replay_statserver(int c, struct attrl *attrib, char *extend)
+{
+	return replay_reply("statserver", NULL);
+}
+
+static struct batch_status *
+replay_statsched(int c, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+	struct batch_status *cur;
+
+	bs = replay_reply("statsched", NULL);
+
+	/* stay in the sched_priv the replay was started in */
+	for (cur = bs; cur != NULL; cur = cur->next) {
+		struct attrl **prev = &cur->attribs;
+
+		while (*prev != NULL) {
+			struct attrl *attrp = *prev;
+
+			if (!strcmp(attrp->name, ATTR_sched_priv) || !strcmp(attrp->name, ATTR_sched_log)) {
+				*prev = attrp->next;
+				attrp->next = NULL;
+				free_attrl(attrp);
+			} else
+				prev = &attrp->next;
+		}
+	}
+	return bs;
+}
+
+static struct batch_status *
+replay_statque(int c, char *id, struct attrl *attrib, char *extend)
+{
+	return replay_reply("statque", id);
+}
+
+static struct batch_status *
+replay_statvnode(int c, char *id, struct attrl *attrib, char *extend)
+{
+	return replay_reply("statvnode", id);
+}
+
+static struct batch_status *
+replay_statresv(int c, char *id, struct attrl *attrib, char *extend)
+{
+	return replay_reply("statresv", id);
+}
+
+static struct batch_status *
+replay_statrsc(int c, char *id, struct attrl *attrib, char *extend)
+{
+	return replay_reply("statrsc", id);
+}
+
+static struct batch_status *
+replay_selstat(int c, struct attropl *select, struct attrl *attrib, char *extend)
+{
+	struct batch_status *bs;
+	char *key;
+
+	key = capture_select_key(select);
+	bs = replay_reply("selstat", key);
+	free(key);
+	return bs;
+}
+
+static unsigned int
+replay_async_selstat(int c, struct attropl *select, struct attrl *attrib, char *extend)
+{
+	pbs_errno = PBSE_NOSUP;
+	return 0;
+}
+
+static int
+replay_runjob(int c, char *jobid, char *location, char *extend)
+{
+	fprintf(decisions, "run\t%s\t%s\n", jobid, location != NULL ? location : "");
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_asyrunsubjobs(int c, char *arrayid, int count, int *indices, char **locations, char *extend)
+{
+	int i;
+	char *name;
+
+	/* decisions read the same as if each subjob was run on its own */
+	for (i = 0; i < count; i++) {
+		name = create_subjob_name(arrayid, indices[i]);
+		fprintf(decisions, "run\t%s\t%s\n", name != NULL ? name : arrayid,
+			locations[i] != NULL ? locations[i] : "");
+		free(name);
+	}
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static struct batch_runjob_status *
+replay_asyrunjob_replies(int c)
+{
+	/* every pipelined run request succeeded */
+	pbs_errno = PBSE_NONE;
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		print the attributes an alter job request sets
+ *
+ * @param[in]	jobid	-	job
+ * @param[in]	attrib	-	attributes
+ *
+ * @return	void
+ */
+static void
+print_alter(const char *jobid, struct attrl *attrib)
+{
+	for (; attrib != NULL; attrib = attrib->next) {
+		if (attrib->resource != NULL)
+			fprintf(decisions, "alter\t%s\t%s.%s=%s\n", jobid, attrib->name, attrib->resource,
+				attrib->value != NULL ? attrib->value : "");
+		else
+			fprintf(decisions, "alter\t%s\t%s=%s\n", jobid, attrib->name,
+				attrib->value != NULL ? attrib->value : "");
+	}
+}
+
+static int
+replay_alterjob(int c, char *jobid, struct attrl *attrib, char *extend)
+{
+	print_alter(jobid, attrib);
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_asyalterjobs(int c, struct batch_status *jobs, char *extend)
+{
+	for (; jobs != NULL; jobs = jobs->next)
+		print_alter(jobs->name, jobs->attribs);
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_confirmresv(int c, char *resvid, char *location, unsigned long start, char *extend)
+{
+	fprintf(decisions, "confirm\t%s\t%s\t%lu\n", resvid, location != NULL ? location : "", start);
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static preempt_job_info *
+replay_preempt_jobs(int c, char **jobs)
+{
+	preempt_job_info *reply;
+	int n;
+	int i;
+
+	for (n = 0; jobs[n] != NULL; n++)
+		;
+	if ((reply = static_cast<preempt_job_info *>(calloc(n + 1, sizeof(preempt_job_info)))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	/* the server would use its preempt_order, suspension is the default */
+	for (i = 0; i < n; i++) {
+		fprintf(decisions, "preempt\t%s\n", jobs[i]);
+		pbs_strncpy(reply[i].job_id, jobs[i], sizeof(reply[i].job_id));
+		reply[i].order[0] = 'S';
+	}
+	pbs_errno = PBSE_NONE;
+	return reply;
+}
+
+static int
+replay_sigjob(int c, char *jobid, char *sig, char *extend)
+{
+	fprintf(decisions, "signal\t%s\t%s\n", jobid, sig);
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_movejob(int c, char *jobid, char *dest, char *extend)
+{
+	fprintf(decisions, "move\t%s\t%s\n", jobid, dest != NULL ? dest : "");
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_deljob(int c, char *jobid, char *extend)
+{
+	fprintf(decisions, "delete\t%s\t\n", jobid);
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_manager(int c, int command, int objtype, char *objname, struct attropl *attrib, char *extend)
+{
+	pbs_errno = PBSE_NONE;
+	return 0;
+}
+
+static int
+replay_connect(char *server)
+{
+	return REPLAY_SD;
+}
+
+static int
+replay_disconnect(int c)
+{
+	return 0;
+}
+
+static char *
+replay_geterrmsg(int c)
+{
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		point the IFL calls the scheduler makes at the replay
+ *
+ * @return	void
+ */
+static void
+install_replay(void)
+{
+	pfn_pbs_statserver = replay_statserver;
+	pfn_pbs_statsched = replay_statsched;
+	pfn_pbs_statque = replay_statque;
+	pfn_pbs_statvnode = replay_statvnode;
+	pfn_pbs_statresv = replay_statresv;
+	pfn_pbs_statrsc = replay_statrsc;
+	pfn_pbs_selstat = replay_selstat;
+	pfn_pbs_async_selstat = replay_async_selstat;
+	pfn_pbs_runjob = replay_runjob;
+	pfn_pbs_asyrunjob = replay_runjob;
+	pfn_pbs_asyrunjob_ack = replay_runjob;
+	pfn_pbs_asyrunjob_pipe = replay_runjob;
+	pfn_pbs_runjob_pipe = replay_runjob;
+	pfn_pbs_asyrunjob_replies = replay_asyrunjob_replies;
+	pfn_pbs_asyrunsubjobs = replay_asyrunsubjobs;
+	pfn_pbs_alterjob = replay_alterjob;
+	pfn_pbs_asyalterjob = replay_alterjob;
+	pfn_pbs_asyalterjobs = replay_asyalterjobs;
+	pfn_pbs_confirmresv = replay_confirmresv;
+	pfn_pbs_preempt_jobs = replay_preempt_jobs;
+	pfn_pbs_sigjob = replay_sigjob;
+	pfn_pbs_movejob = replay_movejob;
+	pfn_pbs_deljob = replay_deljob;
+	pfn_pbs_manager = replay_manager;
+	pfn_pbs_connect = replay_connect;
+	pfn_pbs_disconnect = replay_disconnect;
+	pfn_pbs_geterrmsg = replay_geterrmsg;
+}
+
+/**
+ * @brief
+ * 		advance a universe to the time the next job ends so the next cycle
+ *		can be run on it.  Jobs which end are printed as decisions.  The
+ *		start times planned for top jobs are dropped, the next cycle plans
+ *		them again.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the universe
+ *
+ * @return	int
+ * @retval	1	: the universe was advanced
+ * @retval	0	: no job is left to end
+ */
+static int
+advance_universe(status *policy, server_info *sinfo)
+{
+	timed_event *te;
+	timed_event *end_te;
+	time_t end_time;
+	time_t sim_time;
+	int i;
+
+	if (sinfo->calendar == NULL)
+		return 0;
+
+	for (te = sinfo->calendar->next_event; te != NULL; te = te->next) {
+		if (te->event_type == TIMED_RUN_EVENT &&
+			((resource_resv *) te->event_ptr)->is_job)
+			set_timed_event_disabled(te, 1);
+	}
+
+	end_te = find_init_timed_event(sinfo->calendar->next_event, IGNORE_DISABLED_EVENTS, TIMED_END_EVENT);
+	if (end_te == NULL)
+		return 0;
+	end_time = end_te->event_time;
+
+	for (te = end_te; te != NULL && te->event_time <= end_time; te = te->next) {
+		if (!te->disabled && te->event_type == TIMED_END_EVENT &&
+			((resource_resv *) te->event_ptr)->is_job)
+			fprintf(decisions, "end\t%s\t%ld\n", te->name, (long) te->event_time);
+	}
+
+	if (simulate_events(policy, sinfo, SIM_TIME, &end_time, &sim_time) & TIMED_ERROR)
+		return 0;
+
+	update_cycle_status(policy, sim_time);
+	sinfo->server_time = sim_time;
+
+	for (i = 0; sinfo->jobs[i] != NULL; i++) {
+		resource_resv *resresv = sinfo->jobs[i];
+
+		if (resresv->job != NULL && resresv->job->is_queued) {
+			resresv->can_not_run = 0;
+			resresv->start = UNSPECIFIED;
+			resresv->end = UNSPECIFIED;
+		}
+	}
+	if (sinfo->equiv_classes != NULL) {
+		for (i = 0; sinfo->equiv_classes[i] != NULL; i++) {
+			sinfo->equiv_classes[i]->can_not_run = 0;
+			clear_schd_error(sinfo->equiv_classes[i]->err);
+		}
+	}
+	for (i = 0; sinfo->queues[i] != NULL; i++)
+		sinfo->queues[i]->num_topjobs = 0;
+	memset(sinfo->preempt_count, 0, (NUM_PPRIO + 1) * sizeof(int));
+	sort_jobs(policy, sinfo);
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		run cycles forward from a replayed universe.  Rather than building
+ *		each cycle from the capture, one universe is built and the next
+ *		cycle runs on it after it is advanced to the next job end, with the
+ *		decisions of the cycles before it in place.
+ *
+ * @param[in]	sd	-	connection descriptor
+ * @param[in]	cycles	-	number of cycles to run
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: the universe could not be built
+ */
+static int
+forward_cycles(int sd, int cycles)
+{
+	server_info *sinfo;
+	status *policy;
+	schd_error *err = NULL;
+	int i;
+
+	update_cycle_status(&cstat, replay_time);
+	if ((sinfo = query_server(&cstat, sd)) == NULL)
+		return -1;
+	policy = sinfo->policy;
+
+	if (check_new_reservations(policy, sd, sinfo->resvs, sinfo) < 0) {
+		end_cycle_tasks(sinfo);
+		return -1;
+	}
+
+	for (i = 0; i < cycles; i++) {
+		fprintf(decisions, "cycle\t%d\t%ld\n", i + 1, (long) sinfo->server_time);
+		prof_start_cycle();
+		trace_start_cycle(sinfo->server_time);
+		if (init_scheduling_cycle(policy, sd, sinfo) == 0)
+			break;
+		main_sched_loop(policy, sd, sinfo, &err);
+		free_schd_error(err);
+		err = NULL;
+		flush_job_updates();
+		prof_end_cycle(sd);
+		fflush(decisions);
+
+		fprintf(stderr, "cycle %d\n", i + 1);
+		prof_print_cycle(stderr);
+
+		if (i + 1 < cycles && !advance_universe(policy, sinfo))
+			break;
+	}
+	end_cycle_tasks(sinfo);
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		the main program of pbs_sched_replay
+ *
+ * @param[in]	argc	-	argument count
+ * @param[in]	argv	-	argument values
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: error
+ */
+int
+main(int argc, char *argv[])
+{
+	char path_buf[MAXPATHLEN + 1];
+	char *priv_dir = NULL;
+	char *log_file = NULL;
+	int iterations = 1;
+	int forward = 0;
+	int nthreads = -1;
+	int errflg = 0;
+	sched_cmd cmd;
+	int c;
+	int i;
+
+	/* the real deal or output version and exit? */
+	PRINT_VERSION_AND_EXIT(argc, argv);
+	set_msgdaemonname(const_cast<char *>("pbs_sched_replay"));
+
+	while ((c = getopt(argc, argv, "d:f:L:n:t:")) != -1)
+		switch (c) {
+			case 'd':
+				priv_dir = optarg;
+				break;
+			case 'f':
+				forward = atoi(optarg);
+				if (forward <= 0)
+					errflg = 1;
+				break;
+			case 'L':
+				log_file = optarg;
+				break;
+			case 'n':
+				iterations = atoi(optarg);
+				if (iterations <= 0)
+					errflg = 1;
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				if (nthreads <= 0)
+					errflg = 1;
+				break;
+			default:
+				errflg = 1;
+		}
+
+	if (forward && iterations != 1)
+		errflg = 1;
+
+	if (errflg || (argc - optind) != 1) {
+		fprintf(stderr, "Usage: %s [-d sched_priv] [-f cycles | -n iterations] [-L logfile] [-t threads] capture_file\n", argv[0]);
+		fprintf(stderr, "       %s --version\n", argv[0]);
+		return 1;
+	}
+
+	if (pbs_loadconf(0) <= 0)
+		return 1;
+
+	set_no_attribute_verification();
+	if (pbs_client_thread_init_thread_context() != 0) {
+		fprintf(stderr, "%s: Unable to initialize thread context\n", argv[0]);
+		return 1;
+	}
+
+	if (log_file != NULL) {
+		set_log_conf(pbs_conf.pbs_leaf_name, pbs_conf.pbs_mom_node_name,
+			     pbs_conf.locallog, pbs_conf.syslogfac,
+			     pbs_conf.syslogsvr, pbs_conf.pbs_log_highres_timestamp);
+		if (log_open(log_file, const_cast<char *>(".")) == -1) {
+			fprintf(stderr, "%s: Unable to open log file %s\n", argv[0], log_file);
+			return 1;
+		}
+	}
+
+	if ((cap = read_capture(argv[optind])) == NULL) {
+		fprintf(stderr, "%s: Unable to read capture file %s\n", argv[0], argv[optind]);
+		return 1;
+	}
+	sc_name = cap->sched_name;
+	dflt_sched = cap->dflt_sched;
+	replay_time = cap->time;
+	decisions = stdout;
+
+	if (priv_dir == NULL) {
+		if (dflt_sched)
+			snprintf(path_buf, sizeof(path_buf), "%s/sched_priv", pbs_conf.pbs_home_path);
+		else
+			snprintf(path_buf, sizeof(path_buf), "%s/sched_priv_%s", pbs_conf.pbs_home_path, sc_name);
+		priv_dir = path_buf;
+	}
+	if (chdir(priv_dir) == -1) {
+		fprintf(stderr, "%s: Unable to access %s: %s\n", argv[0], priv_dir, strerror(errno));
+		return 1;
+	}
+
+	install_replay();
+
+	if (nthreads == -1)
+		nthreads = pbs_conf.pbs_sched_threads;
+	if (schedinit(nthreads) != 0) {
+		fprintf(stderr, "%s: Scheduler initialization failed\n", argv[0]);
+		return 1;
+	}
+	if (!set_validate_sched_attrs(REPLAY_SD)) {
+		fprintf(stderr, "%s: No attributes captured for scheduler %s\n", argv[0], sc_name);
+		return 1;
+	}
+
+	if (forward) {
+		if (forward_cycles(REPLAY_SD, forward) != 0)
+			fprintf(stderr, "%s: Unable to build the captured universe\n", argv[0]);
+		iterations = 0;
+	}
+
+	cmd.cmd = SCH_SCHEDULE_NEW;
+	cmd.jid = NULL;
+	for (i = 0; i < iterations; i++) {
+		struct capture_reply *reply;
+
+		for (reply = cap->replies; reply != NULL; reply = reply->next)
+			reply->used = 0;
+
+		fprintf(decisions, "cycle\t%d\n", i + 1);
+		prof_start_cycle();
+		trace_start_cycle(cap->time);
+		scheduling_cycle(REPLAY_SD, &cmd);
+		prof_end_cycle(REPLAY_SD);
+		fflush(decisions);
+
+		fprintf(stderr, "cycle %d\n", i + 1);
+		prof_print_cycle(stderr);
+	}
+	if (trace_dump() != 0)
+		fprintf(stderr, "%s: Unable to write the decision trace\n", argv[0]);
+
+	schedexit();
+	free_capture(cap);
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file    pbs_sched_trace.cpp
+ *
+ * @brief
+ * 		pbs_sched_trace - print a decision trace written by the scheduler
+ *		on SIGUSR2 or a crash, or by pbs_sched_replay.
+ *
+ *	One decision is printed per line, oldest first:
+ *		<cycle>	<cycle time>	<job>	<outcome>	<error code>	<usecs>	<reason>
+ *	where the outcome is run, not_run or never_run and the reason is the
+ *	comment the scheduler would have set on the job.  The -j option only
+ *	prints the decisions for one job, to follow why it has not run.
+ */
+
+#include <pbs_config.h> /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "pbs_version.h"
+#include "data_types.h"
+#include "constant.h"
+#include "config.h"
+#include "misc.h"
+#include "job_info.h"
+#include "decision_trace.h"
+
+static const char *outcome_names[] = {
+	"unknown",	/* SCHD_UNKWN */
+	"not_run",	/* NOT_RUN */
+	"never_run"	/* NEVER_RUN */
+};
+
+/**
+ * @brief
+ * 		print one decision of the trace
+ *
+ * @param[in]	tr	-	the decision
+ * @param[in]	err	-	scratch schd_error used to translate the error code
+ *
+ * @return	void
+ */
+static void
+print_trace_rec(struct trace_rec *tr, schd_error *err)
+{
+	char comment[MAX_LOG_SIZE];
+	char timebuf[64];
+	time_t t = tr->time;
+	const char *outcome = "run";
+	struct tm *ptm;
+
+	comment[0] = '\0';
+	if (!tr->ran) {
+		outcome = outcome_names[SCHD_UNKWN];
+		if (tr->status_code < SCHD_STATUS_HIGH)
+			outcome = outcome_names[tr->status_code];
+		clear_schd_error(err);
+		set_schd_error_codes(err, (enum schd_err_status) tr->status_code,
+			(enum sched_error_code) tr->error_code);
+		translate_fail_code(err, comment, NULL);
+	}
+
+	timebuf[0] = '\0';
+	if ((ptm = localtime(&t)) != NULL)
+		strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", ptm);
+
+	printf("%d\t%s\t%s\t%s\t%d\t%u\t%s\n", tr->cycle, timebuf, tr->jobid,
+		outcome, tr->error_code, tr->usecs, comment);
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct trace_header th;
+	struct trace_rec tr;
+	char *jobid = NULL;
+	schd_error *err;
+	int errflg = 0;
+	FILE *fp;
+	uint32_t i;
+	int c;
+
+	/* the real deal or output version and exit? */
+	PRINT_VERSION_AND_EXIT(argc, argv);
+
+	while ((c = getopt(argc, argv, "j:")) != -1)
+		switch (c) {
+			case 'j':
+				jobid = optarg;
+				break;
+			default:
+				errflg = 1;
+		}
+
+	if (errflg || (argc - optind) != 1) {
+		fprintf(stderr, "Usage: %s [-j job] trace_file\n", argv[0]);
+		fprintf(stderr, "       %s --version\n", argv[0]);
+		return 1;
+	}
+
+	if ((fp = fopen(argv[optind], "r")) == NULL) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	if (fread(&th, sizeof(th), 1, fp) != 1 ||
+		memcmp(th.magic, TRACE_MAGIC, sizeof(th.magic)) != 0 ||
+		th.rec_size != sizeof(struct trace_rec)) {
+		fprintf(stderr, "%s: %s is not a decision trace\n", argv[0], argv[optind]);
+		fclose(fp);
+		return 1;
+	}
+
+	if ((err = new_schd_error()) == NULL) {
+		fclose(fp);
+		return 1;
+	}
+
+	for (i = 0; i < th.nrecs && fread(&tr, sizeof(tr), 1, fp) == 1; i++) {
+		tr.jobid[sizeof(tr.jobid) - 1] = '\0';
+		if (jobid != NULL && strcmp(tr.jobid, jobid) != 0)
+			continue;
+		print_trace_rec(&tr, err);
+	}
+	if (i < th.nrecs)
+		fprintf(stderr, "%s: %s is truncated\n", argv[0], argv[optind]);
+
+	free_schd_error(err);
+	fclose(fp);
+
+	return i < th.nrecs;
+}
@@ -75,6 +75,7 @@
 
 #include "auth.h"
 #include "config.h"
+#include "decision_trace.h"
 #include "fifo.h"
 #include "globals.h"
 #include "libpbs.h"
@@ -151,6 +152,9 @@ on_segv(int sig)
 	if (ret_lock != 0)
 		pthread_exit(NULL);
 
+	/* keep the decisions which led up to the crash */
+	trace_dump();
+
 	/* we crashed less then 5 minutes ago, lets not restart ourself */
 	if ((segv_last_time - segv_start_time) < 300) {
 		log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
@@ -1020,6 +1024,14 @@ sched_main(int argc, char *argv[], schedule_func sched_ptr)
 	act.sa_handler = hard_cycle_interrupt; /* do a cycle interrupt on */
 					       /* SIGUSR2                 */
 	sigaction(SIGUSR2, &act, NULL);
+#else
+	/* dump the decision trace on SIGUSR2.  Restart interrupted calls so
+	 * a dump in the middle of a cycle does not fail the cycle's requests
+	 */
+	act.sa_handler = trace_dump_sig;
+	act.sa_flags = SA_RESTART;
+	sigaction(SIGUSR2, &act, NULL);
+	act.sa_flags = 0;
 #endif /* localmod 030 */
 
 	act.sa_handler = die; /* bite the biscuit for all following */
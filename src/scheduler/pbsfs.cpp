@@ -228,8 +228,10 @@ main(int argc, char *argv[])
 		printf("Fairshare usage units are in: %s\n", conf.fairshare_res);
 		print_fairshare(conf.fairshare->root, -1);
 	}
-	else if (flags & FS_DECAY)
+	else if (flags & FS_DECAY) {
 		decay_fairshare_tree(conf.fairshare->root);
+		conf.fairshare->decays++;
+	}
 	else if (flags & (FS_GET | FS_SET | FS_COMP)) {
 		ginfo = find_group_info(argv[optind], conf.fairshare->root);
 
@@ -39,79 +39,72 @@
 
 
 /**
- * @file    prev_job_info.c
+ * @file    prev_job_info.cpp
  *
  * @brief
- * 		prev_job_info.c -  contains functions which are related to prev_job_info array.
+ * 		prev_job_info.cpp -  contains functions which are related to the
+ *		fairshare usage the running jobs had at the end of the last cycle.
+ *
+ *	The usage is kept as the value of the fairshare_usage_res formula,
+ *	hashed by job name, so the next cycle finds the usage delta of each of
+ *	its running jobs with one lookup.
  *
  * Functions included are:
  * 	create_prev_job_info()
+ * 	find_prev_job_usage()
  * 	free_prev_job_info()
- * 	free_pjobs()
  */
 #include <pbs_config.h>
 
+#include <new>
+#include <string>
+#include <unordered_map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <log.h>
 #include "prev_job_info.h"
 #include "job_info.h"
+#include "globals.h"
 #include "misc.h"
-#include "resource_resv.h"
 
 
+struct prev_job_info
+{
+	std::unordered_map<std::string, sch_resource_t> usage;	/* usage of each job by name */
+};
+
 /**
  * @brief
- *		create_prev_job_info - create the prev_job_info array from an array
- *				of jobs
+ *		create_prev_job_info - record the fairshare usage of the running
+ *				jobs for the next cycle
  *
- * @param[in,out]	jobs	-	job array
- * @param[in]	size	-	size of jinfo_arr or UNSPECIFIED if unknown
+ * @param[in]	jobs	-	running jobs
  *
- * @return	new prev_job_array
- * @retval	NULL	: on error
- *
- * @par	NOTE: jinfo_arr is modified
+ * @return	new prev_job_info
+ * @retval	NULL	: no jobs or on error
  *
  */
 prev_job_info *
-create_prev_job_info(resource_resv **jobs, int size)
+create_prev_job_info(resource_resv **jobs)
 {
-	prev_job_info *npji;		/* new prev_job_info array */
-	int local_size;		/* the size of the array */
+	prev_job_info *npji;
 	int i;
 
-	if (jobs == NULL)
-		return NULL;
-
-	if (size == UNSPECIFIED) {
-		for (i = 0; jobs[i] != NULL; i++)
-			;
-
-		local_size = i;
-	}
-	else
-		local_size = size;
-
-	if (local_size == 0)
+	if (jobs == NULL || jobs[0] == NULL)
 		return NULL;
 
-	if ((npji = static_cast<prev_job_info *>(calloc(local_size, sizeof(prev_job_info)))) == NULL) {
+	npji = new (std::nothrow) prev_job_info;
+	if (npji == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
 	}
 
+	npji->usage.reserve(count_array(jobs));
 	for (i = 0; jobs[i] != NULL; i++) {
-		if(jobs[i]->job != NULL) {
-			npji[i].name = jobs[i]->name;
-			npji[i].resused = jobs[i]->job->resused;
-			npji[i].entity_name = string_dup(jobs[i]->job->ginfo->name);
-
-			/* so the memory is not freed at the end of the scheduling cycle */
-			jobs[i]->name = NULL;
-			jobs[i]->job->resused = NULL;
-		}
+		if (jobs[i]->job != NULL)
+			npji->usage[jobs[i]->name] =
+				formula_evaluate(conf.fairshare_res, jobs[i], jobs[i]->job->resused);
 	}
 
 	return npji;
@@ -119,45 +112,43 @@ create_prev_job_info(resource_resv **jobs, int size)
 
 /**
  * @brief
- *		free_prev_job_info - free a prev_job_info struct
+ *		find_prev_job_usage - find the fairshare usage a job had at the end
+ *				of the last cycle
  *
- * @param[in,out]	pjinfo	-	prev_job_info to free
+ * @param[in]	pjinfo	-	usage of the last cycle
+ * @param[in]	name	-	name of the job
+ * @param[out]	usage	-	the job's usage
  *
- * @return	nothing
+ * @return	int
+ * @retval	1	: the job was running last cycle
+ * @retval	0	: it was not
  *
  */
-void
-free_prev_job_info(prev_job_info *pjinfo)
+int
+find_prev_job_usage(prev_job_info *pjinfo, const char *name, sch_resource_t *usage)
 {
-	if (pjinfo->name != NULL)
-		free(pjinfo->name);
+	if (pjinfo == NULL || name == NULL || usage == NULL)
+		return 0;
 
-	if (pjinfo->entity_name != NULL)
-		free(pjinfo->entity_name);
+	auto it = pjinfo->usage.find(name);
+	if (it == pjinfo->usage.end())
+		return 0;
 
-	free_resource_req_list(pjinfo->resused);
+	*usage = it->second;
+	return 1;
 }
 
 /**
  * @brief
- *		free_pjobs - free a list of prev_job_info structs
+ *		free_prev_job_info - free a prev_job_info
  *
- * @param[in,out]	pjinfo_arr	-	array of prev_job_info structs to free
- * @param[in]	previous job info array.
+ * @param[in,out]	pjinfo	-	prev_job_info to free
  *
  * @return	nothing
  *
  */
 void
-free_pjobs(prev_job_info *pjinfo_arr, int size)
+free_prev_job_info(prev_job_info *pjinfo)
 {
-	int i;
-
-	if (pjinfo_arr == NULL)
-		return;
-
-	for (i = 0; i < size; i++)
-		free_prev_job_info(&pjinfo_arr[i]);
-
-	free(pjinfo_arr);
+	delete pjinfo;
 }
@@ -46,20 +46,20 @@ extern "C" {
 #include "data_types.h"
 
 /*
- *      create_prev_job_info - create the prev_job_info array from an array
- *                              of jobs
+ *      create_prev_job_info - record the fairshare usage of the running jobs
+ *                              for the next cycle
  */
-prev_job_info *create_prev_job_info(resource_resv **resresv_arr, int size);
+prev_job_info *create_prev_job_info(resource_resv **jobs);
 
 /*
- *      free_prev_job_info - free a prev_job_info struct
+ *      find_prev_job_usage - find the fairshare usage a job had last cycle
  */
-void free_prev_job_info(prev_job_info *pjinfo);
+int find_prev_job_usage(prev_job_info *pjinfo, const char *name, sch_resource_t *usage);
 
 /*
- *      free_pjobs - free a list of prev_job_info structs
+ *      free_prev_job_info - free a prev_job_info
  */
-void free_pjobs(prev_job_info *pjinfo_arr, int size);
+void free_prev_job_info(prev_job_info *pjinfo);
 #ifdef	__cplusplus
 }
 #endif
@@ -52,6 +52,7 @@
  * 	load_day()
  * 	end_prime_status_rec()
  * 	end_prime_status()
+ * 	cache_prime_transitions()
  * 	init_prime_time()
  * 	init_non_prime_time()
  *
@@ -658,6 +659,25 @@ time_t
 end_prime_status(time_t date)
 {
 	enum prime_time p;
+	int lo = 0;
+	int hi = conf.num_prime_trans;
+
+	/* Find the first cached change after date.  The cache holds every
+	 * change from prime_trans_from to its last entry, so any date in that
+	 * span ends at the next one.
+	 */
+	if (hi > 0 && date >= conf.prime_trans_from) {
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+
+			if (conf.prime_trans[mid] <= date)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo < conf.num_prime_trans && conf.prime_trans[lo] != SCHD_INFINITY)
+			return conf.prime_trans[lo];
+	}
 
 	p = is_prime_time(date);
 
@@ -668,6 +688,42 @@ end_prime_status(time_t date)
 	return end_prime_status_rec(date, date, p);
 }
 
+/**
+ * @brief
+ * 		compute the coming prime status changes from date once, so
+ *		end_prime_status() can look them up.  The calendar asks for the
+ *		end of the prime status on every prime status event of every
+ *		simulation.
+ *
+ * @param[in]	date	-	the time to start from
+ *
+ * @return void
+ */
+void
+cache_prime_transitions(time_t date)
+{
+	time_t t;
+	time_t next;
+	int n = 0;
+
+	conf.num_prime_trans = 0;
+
+	t = end_prime_status(date);
+	while (n < MAX_PRIME_TRANS) {
+		conf.prime_trans[n++] = t;
+		if (t == SCHD_INFINITY)
+			break;
+		next = end_prime_status(t);
+		/* the prime status did not change at t, the changes end here */
+		if (next <= t)
+			break;
+		t = next;
+	}
+
+	conf.prime_trans_from = date;
+	conf.num_prime_trans = n;
+}
+
 /**
  * @brief
  * 		do any initializations that need to happen at the
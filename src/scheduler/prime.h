@@ -109,6 +109,12 @@ int init_non_prime_time(struct status *, char *);
  */
 time_t end_prime_status(time_t date);
 
+/*
+ *	cache_prime_transitions - compute the coming prime status changes
+ *				  once for end_prime_status()
+ */
+void cache_prime_transitions(time_t date);
+
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file    profile.cpp
+ *
+ * @brief
+ * 		profile.cpp - time the phases of the scheduling cycle
+ *
+ *	The times are logged at the end of each cycle and reported to the server
+ *	in the sched object's sched_cycle_profile attribute.  For each phase the
+ *	attribute holds the total seconds spent in the phase, the number of
+ *	times it was timed and a histogram of those times since the scheduler
+ *	started:
+ *		phase:total:count:h0/h1/.../h7,phase:...
+ *	If the cycle_profile_file sched_config option is set, each cycle's
+ *	times are also appended to that file as a line of JSON.
+ *
+ * Functions included are:
+ * 	prof_start()
+ * 	prof_stop()
+ * 	prof_start_cycle()
+ * 	prof_end_cycle()
+ * 	prof_print_cycle()
+ *
+ */
+
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pbs_ifl.h>
+#include <log.h>
+#include <libutil.h>
+#include "data_types.h"
+#include "constant.h"
+#include "config.h"
+#include "globals.h"
+#include "misc.h"
+#include "profile.h"
+
+static const char *prof_phase_names[PROF_NUM_PHASES] = {
+	"cycle",
+	"query",
+	"sort_jobs",
+	"create_placement_sets",
+	"buckets",
+	"eval",
+	"preemption",
+	"calendar",
+	"send_run_job"
+};
+
+struct prof_stat {
+	double cycle_secs;		/* time spent in the phase this cycle */
+	long cycle_count;		/* times the phase was timed this cycle */
+	double total_secs;		/* time spent in the phase since startup */
+	long total_count;		/* times the phase was timed since startup */
+	long hist[PROF_HIST_SIZE];	/* histogram of the times since startup */
+};
+
+static struct prof_stat prof_stats[PROF_NUM_PHASES];
+static double prof_cycle_start;
+static long prof_cycle_num;
+
+/**
+ * @brief
+ * 		get a timestamp to pass to prof_stop()
+ *
+ * @return	double
+ * @retval	seconds from an arbitrary point in the past
+ */
+double
+prof_start(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief
+ * 		add the time since start to the phase's times
+ *
+ * @param[in]	phase	-	phase being timed
+ * @param[in]	start	-	timestamp from prof_start()
+ *
+ * @return	void
+ */
+void
+prof_stop(enum prof_phase phase, double start)
+{
+	struct prof_stat *ps = &prof_stats[phase];
+	double secs;
+	double limit;
+	int i;
+
+	secs = prof_start() - start;
+	if (secs < 0)
+		secs = 0;
+
+	ps->cycle_secs += secs;
+	ps->cycle_count++;
+	ps->total_secs += secs;
+	ps->total_count++;
+
+	for (i = 0, limit = 0.00001; i < PROF_HIST_SIZE - 1 && secs >= limit; i++)
+		limit *= 10;
+	ps->hist[i]++;
+}
+
+/**
+ * @brief
+ * 		reset the per-cycle times at the start of a scheduling cycle
+ *
+ * @return	void
+ */
+void
+prof_start_cycle(void)
+{
+	int i;
+
+	for (i = 0; i < PROF_NUM_PHASES; i++) {
+		prof_stats[i].cycle_secs = 0;
+		prof_stats[i].cycle_count = 0;
+	}
+	prof_cycle_num++;
+	prof_cycle_start = prof_start();
+}
+
+/**
+ * @brief
+ * 		append this cycle's times to the cycle_profile_file as JSON
+ *
+ * @return	void
+ */
+static void
+dump_cycle_profile(void)
+{
+	FILE *fp;
+	int i;
+
+	if ((fp = fopen(conf.cycle_profile_file, "a")) == NULL) {
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Can not open %s", conf.cycle_profile_file);
+		return;
+	}
+
+	fprintf(fp, "{\"time\": %ld, \"cycle\": %ld, \"phases\": {", (long) time(NULL), prof_cycle_num);
+	for (i = 0; i < PROF_NUM_PHASES; i++)
+		fprintf(fp, "%s\"%s\": {\"secs\": %.6f, \"count\": %ld}", i == 0 ? "" : ", ",
+			prof_phase_names[i], prof_stats[i].cycle_secs, prof_stats[i].cycle_count);
+	fprintf(fp, "}}\n");
+
+	fclose(fp);
+}
+
+/**
+ * @brief
+ * 		update the sched object's sched_cycle_profile attribute
+ *
+ * @param[in]	connector	-	connection to the server
+ *
+ * @return	void
+ */
+static void
+send_cycle_profile(int connector)
+{
+	char buf[128];
+	char *value;
+	int len = 0;
+	struct attropl attr;
+	int i;
+	int j;
+
+	if ((value = static_cast<char *>(calloc(1, 1))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return;
+	}
+
+	for (i = 0; i < PROF_NUM_PHASES; i++) {
+		struct prof_stat *ps = &prof_stats[i];
+
+		if (ps->total_count == 0)
+			continue;
+
+		snprintf(buf, sizeof(buf), "%s%s:%.6f:%ld:", value[0] == '\0' ? "" : ",",
+			prof_phase_names[i], ps->total_secs, ps->total_count);
+		for (j = 0; j < PROF_HIST_SIZE; j++) {
+			int l = strlen(buf);
+			snprintf(buf + l, sizeof(buf) - l, "%s%ld", j == 0 ? "" : "/", ps->hist[j]);
+		}
+		if (pbs_strcat(&value, &len, buf) == NULL) {
+			free(value);
+			return;
+		}
+	}
+
+	attr.name = const_cast<char *>(ATTR_sched_cycle_profile);
+	attr.resource = NULL;
+	attr.value = value;
+	attr.op = SET;
+	attr.next = NULL;
+
+	if (pbs_manager(connector, MGR_CMD_SET, MGR_OBJ_SCHED,
+		const_cast<char *>(sc_name), &attr, NULL) != 0)
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Failed to update %s at the server", ATTR_sched_cycle_profile);
+
+	free(value);
+}
+
+/**
+ * @brief
+ * 		finish timing a scheduling cycle.  Log the cycle's times, and
+ *		report them to the server and the cycle_profile_file
+ *
+ * @param[in]	connector	-	connection to the server
+ *
+ * @return	void
+ */
+void
+prof_end_cycle(int connector)
+{
+	char buf[MAX_LOG_SIZE];
+	int len;
+	int i;
+
+	prof_stop(PROF_CYCLE, prof_cycle_start);
+
+	len = snprintf(buf, sizeof(buf), "Cycle phase times:");
+	for (i = 0; i < PROF_NUM_PHASES && len < (int) sizeof(buf); i++) {
+		if (prof_stats[i].cycle_count > 0)
+			len += snprintf(buf + len, sizeof(buf) - len, " %s=%.3fs/%ld",
+				prof_phase_names[i], prof_stats[i].cycle_secs, prof_stats[i].cycle_count);
+	}
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+
+	if (conf.cycle_profile_file != NULL)
+		dump_cycle_profile();
+
+	if (send_job_attr_updates && !got_sigpipe)
+		send_cycle_profile(connector);
+}
+
+/**
+ * @brief
+ * 		print the times of the last cycle, one phase per line:
+ *		<phase> <seconds> <count>
+ *
+ * @param[in]	fp	-	file to print to
+ *
+ * @return	void
+ */
+void
+prof_print_cycle(FILE *fp)
+{
+	int i;
+
+	for (i = 0; i < PROF_NUM_PHASES; i++)
+		fprintf(fp, "%-22s %10.6f %8ld\n", prof_phase_names[i],
+			prof_stats[i].cycle_secs, prof_stats[i].cycle_count);
+}
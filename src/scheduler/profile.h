@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+#ifndef SRC_SCHEDULER_PROFILE_H_
+#define SRC_SCHEDULER_PROFILE_H_
+
+#include <stdio.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/* phases of the scheduling cycle which are timed.  Phases can nest:
+ * e.g. PROF_QUERY includes PROF_PLACEMENT_SETS and PROF_BUCKETS
+ */
+enum prof_phase {
+	PROF_CYCLE,		/* the whole scheduling cycle */
+	PROF_QUERY,		/* query_server() */
+	PROF_SORT_JOBS,		/* sort_jobs() */
+	PROF_PLACEMENT_SETS,	/* create_placement_sets() */
+	PROF_BUCKETS,		/* creating the server's node buckets */
+	PROF_EVAL,		/* is_ok_to_run() for one job */
+	PROF_PREEMPT,		/* find_and_preempt_jobs() */
+	PROF_CALENDAR,		/* add_job_to_calendar() */
+	PROF_RUN_JOB,		/* send_run_job() */
+	PROF_NUM_PHASES
+};
+
+/* number of histogram buckets.  The buckets are powers of 10 starting
+ * at 10us: <10us, <100us, <1ms, <10ms, <100ms, <1s, <10s, >=10s
+ */
+#define PROF_HIST_SIZE 8
+
+/* get a timestamp to pass to prof_stop() */
+double prof_start(void);
+
+/* add the time since start to a phase */
+void prof_stop(enum prof_phase phase, double start);
+
+/* reset the per-cycle times at the start of a cycle */
+void prof_start_cycle(void);
+
+/* log the cycle's times, update the sched object and dump them to a file */
+void prof_end_cycle(int connector);
+
+/* print the last cycle's times, one phase per line */
+void prof_print_cycle(FILE *fp);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif /* SRC_SCHEDULER_PROFILE_H_ */
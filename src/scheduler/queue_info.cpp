@@ -113,6 +113,9 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 	/* array of pointers to internal scheduling structure for queues */
 	queue_info **qinfo_arr;
 
+	/* every queue on the server, before they are filtered by partition */
+	queue_info **all_qinfo;
+
 	/* the current queue we are working on */
 	queue_info *qinfo;
 
@@ -175,16 +178,38 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 	}
 	qinfo_arr[0] = NULL;
 
-	cur_queue = queues;
-
-	for (i = 0, qidx=0; cur_queue != NULL && !err; i++) {
-		/* convert queue information from batch_status to queue_info */
-		if ((qinfo = query_queue_info(policy, cur_queue, sinfo)) == NULL) {
+	if ((all_qinfo = static_cast<queue_info **>(malloc(sizeof(queue_info *) * (num_queues + 1)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pbs_statfree(queues);
+		free_schd_error(sch_err);
+		free(qinfo_arr);
+		return NULL;
+	}
+	all_qinfo[0] = NULL;
+
+	/* convert queue information from batch_status to queue_info.  All the
+	 * queues are converted before any jobs are queried so the jobs of every
+	 * queue we will look at can be asked for up front, in one pipeline.
+	 */
+	for (i = 0, cur_queue = queues; cur_queue != NULL; i++, cur_queue = cur_queue->next) {
+		if ((all_qinfo[i] = query_queue_info(policy, cur_queue, sinfo)) == NULL) {
 			free_schd_error(sch_err);
 			pbs_statfree(queues);
-			free_queues(qinfo_arr);
+			free_queues(all_qinfo);
+			free(qinfo_arr);
 			return NULL;
 		}
+		all_qinfo[i + 1] = NULL;
+	}
+
+	for (i = 0; all_qinfo[i] != NULL; i++) {
+		if (all_qinfo[i]->is_exec && queue_in_partition(all_qinfo[i], sc_attrs.partition))
+			prefetch_jobs(pbs_sd, all_qinfo[i]->name);
+	}
+
+	for (i = 0, qidx=0; i < num_queues && !err; i++) {
+		qinfo = all_qinfo[i];
+		all_qinfo[i] = NULL;
 
 		if (queue_in_partition(qinfo, sc_attrs.partition)) {
 			/* check if the queue is a dedicated time queue */
@@ -313,11 +338,14 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 
 		} else
 			free_queue_info(qinfo);
-
-		cur_queue = cur_queue->next;
 	}
 	qinfo_arr[qidx] = NULL;
 
+	/* the queues an error left us short of */
+	for (; i < num_queues; i++)
+		free_queue_info(all_qinfo[i]);
+	free(all_qinfo);
+	discard_prefetched_jobs(pbs_sd);
 
 	pbs_statfree(queues);
 	free_schd_error(sch_err);
@@ -589,6 +617,7 @@ new_queue_info(int limallocflag)
 	qinfo->ignore_nodect_sort	 = 0;
 #endif
 	qinfo->partition = NULL;
+	memset(&qinfo->node_hint, 0, sizeof(qinfo->node_hint));
 	return qinfo;
 }
 
@@ -659,8 +688,7 @@ update_queue_on_run(queue_info *qinfo, resource_resv *resresv, char *job_state)
 
 	if (cstat.node_sort[0].res_name != NULL &&
 		conf.node_sort_unused && qinfo->nodes != NULL)
-		qsort(qinfo->nodes, qinfo->num_nodes, sizeof(node_info *),
-			multi_node_sort);
+		sort_nodes(qinfo->nodes, qinfo->num_nodes);
 
 
 	if ((job_state != NULL) && (*job_state == 'S') && (resresv->job->resreq_rel != NULL))
@@ -978,9 +1006,9 @@ dup_queue_info(queue_info *oqinfo, server_info *nsinfo)
 	nqinfo->jobs = dup_resource_resv_array(oqinfo->jobs,
 		nqinfo->server, nqinfo);
 
-	if (nqinfo->jobs != NULL)
-		nqinfo->running_jobs = resource_resv_filter(nqinfo->jobs,
-			nqinfo->sc.total, check_run_job, NULL, 0);
+	/* nqinfo->running_jobs is mapped from oqinfo's by dup_server_info() once
+	 * the server's all_resresv array exists
+	 */
 
 	if (oqinfo->nodes != NULL)
 		nqinfo->nodes = node_filter(nsinfo->nodes, nsinfo->num_nodes,
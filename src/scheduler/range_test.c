@@ -221,13 +221,7 @@ print_range_list(range *r)
 		return;
 	}
 
-	while (r != NULL) {
-		printf("s: %-5d e: %-5d st: %-5d ct: %-5d\n", r->start,
-			r->end,
-			r->step,
-			r->count);
-		r = r->next;
-	}
+	printf("%s ct: %d\n", range_to_str(r), range_count(r));
 }
 
 /**
@@ -282,7 +276,7 @@ handle_command(range *r, char *cmd, char *arg)
 		printf("next: %d\n", num);
 	}
 	else if (strncmp("add", cmd, len) == 0) {
-		if (range_add_value(r, num_arg, ENABLE_SUBRANGE_STEPPING) == 0)
+		if (range_add_value(&r, num_arg, ENABLE_SUBRANGE_STEPPING) == 0)
 			printf("Could not add value\n");
 	}
 	else if (strncmp("remove", cmd, len) == 0) {
@@ -94,6 +94,9 @@
 #include "parse.h"
 #include "limits_if.h"
 #include "fifo.h"
+#include "node_info.h"
+#include "job_info.h"
+#include "buckets.h"
 
 
 
@@ -215,6 +218,9 @@ query_resources(int pbs_sd)
 		}
 	}
 
+	for (i = 0; defarr[i] != NULL; i++)
+		defarr[i]->index = i;
+
 	pbs_statfree(bs);
 
 	if (error) {
@@ -327,6 +333,7 @@ new_resdef(void)
 	}
 
 	newdef->name = NULL;
+	newdef->index = -1;
 	/* calloc will have zeroed flags and the type structure */
 
 	return newdef;
@@ -579,6 +586,10 @@ reset_global_resource_ptrs(void)
 	update_sorting_defs(SD_FREE);
 
 	clear_last_running();
+	clear_node_query_cache();
+	clear_formula_cache();
+	clear_node_bucket_cache();
+	clear_resresv_set_failures();
 
 	/* The above references into this array.  We now free the memory */
 	if (allres != NULL) {
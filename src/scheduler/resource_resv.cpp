@@ -195,6 +195,8 @@ new_resource_resv()
 	resresv->resresv_ind = -1;
 	resresv->run_event = NULL;
 	resresv->end_event = NULL;
+	resresv->sort_keys = NULL;
+	resresv->sort_keys_gen = 0;
 
 	return resresv;
 }
@@ -290,9 +292,7 @@ free_resource_resv_array(resource_resv **resresv_arr)
 		return;
 	}
 
-	chunk_size = num_jobs / num_threads;
-	chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
-	chunk_size = (chunk_size < MT_CHUNK_SIZE_MAX) ? chunk_size : MT_CHUNK_SIZE_MAX;
+	chunk_size = mt_chunk_size(num_jobs, MT_CHUNK_SIZE_MAX);
 	for (i = 0, num_tasks = 0; num_jobs > 0;
 			num_tasks++, i += chunk_size, num_jobs -= chunk_size) {
 		tdata = alloc_tdata_free_rr_arr(resresv_arr, i, i + chunk_size - 1);
@@ -308,6 +308,9 @@ free_resource_resv_array(resource_resv **resresv_arr)
 
 	/* Get results from worker threads */
 	for (i = 0; i < num_tasks;) {
+		/* help out with the queued work rather than wait for it */
+		while (run_queued_task())
+			;
 		pthread_mutex_lock(&result_lock);
 		while (ds_queue_is_empty(result_queue))
 			pthread_cond_wait(&result_cond, &result_lock);
@@ -342,6 +345,8 @@ free_resource_resv(resource_resv *resresv)
 	if (resresv->name != NULL)
 		free(resresv->name);
 
+	free(resresv->sort_keys);
+
 	if (resresv->user != NULL)
 		free(resresv->user);
 
@@ -530,9 +535,7 @@ dup_resource_resv_array(resource_resv **oresresv_arr,
 			free(tdata);
 		}
 	} else { /* We are multithreading */
-		chunk_size = num_resresv / num_threads;
-		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN)? chunk_size: MT_CHUNK_SIZE_MIN;
-		chunk_size = (chunk_size < MT_CHUNK_SIZE_MAX)? chunk_size: MT_CHUNK_SIZE_MAX;
+		chunk_size = mt_chunk_size(num_resresv, MT_CHUNK_SIZE_MAX);
 		for (j = 0, num_tasks = 0; thread_job_ct_left > 0;
 				num_tasks++, j += chunk_size, thread_job_ct_left -= chunk_size) {
 			tdata = alloc_tdata_dup_nodes(oresresv_arr, nresresv_arr, nsinfo, nqinfo, j, j + chunk_size - 1);
@@ -550,6 +553,9 @@ dup_resource_resv_array(resource_resv **oresresv_arr,
 
 		/* Get results from worker threads */
 		for (i = 0; i < num_tasks;) {
+			/* help out with the queued work rather than wait for it */
+			while (run_queued_task())
+				;
 			pthread_mutex_lock(&result_lock);
 			while (ds_queue_is_empty(result_queue))
 				pthread_cond_wait(&result_cond, &result_lock);
@@ -617,7 +623,7 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 	nresresv->project = string_dup(oresresv->project);
 
 	nresresv->nodepart_name = string_dup(oresresv->nodepart_name);
-	nresresv->select = dup_selspec(oresresv->select); /* must come before calls to dup_nspecs() below */
+	nresresv->select = share_selspec(oresresv->select); /* must come before calls to dup_nspecs() below */
 	nresresv->execselect = dup_selspec(oresresv->execselect);
 
 	nresresv->is_invalid = oresresv->is_invalid;
@@ -644,7 +650,7 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 
 	nresresv->resreq = dup_resource_req_list(oresresv->resreq);
 
-	nresresv->place_spec = dup_place(oresresv->place_spec);
+	nresresv->place_spec = share_place(oresresv->place_spec);
 
 	nresresv->aoename = string_dup(oresresv->aoename);
 	nresresv->eoename = string_dup(oresresv->eoename);
@@ -1116,12 +1122,20 @@ resource_count *dup_resource_count(resource_count *orcount)
 	return nrcount;
 }
 
+/*
+ * resource_reqs are allocated in chunks and reused once freed.  Like
+ * schd_resources, all threads share one free list under its own lock.
+ */
+static resource_req *resource_req_free_list = NULL;
+static pthread_mutex_t resource_req_free_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * @brief
  *		new_resource_req - allocate and initalize new resource_req
  *
  * @return	the new resource_req
  *
+ * @par MT-Safe:	yes
  */
 
 resource_req *
@@ -1129,12 +1143,26 @@ new_resource_req()
 {
 	resource_req *resreq;
 
-	if ((resreq = static_cast<resource_req *>(calloc(1, sizeof(resource_req)))) == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
-		return NULL;
+	pthread_mutex_lock(&resource_req_free_lock);
+	if (resource_req_free_list == NULL) {
+		int i;
+
+		if ((resreq = static_cast<resource_req *>(malloc(RES_ALLOC_CHUNK * sizeof(resource_req)))) == NULL) {
+			pthread_mutex_unlock(&resource_req_free_lock);
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		for (i = 0; i < RES_ALLOC_CHUNK - 1; i++)
+			resreq[i].next = &resreq[i + 1];
+		resreq[i].next = NULL;
+		resource_req_free_list = resreq;
 	}
+	resreq = resource_req_free_list;
+	resource_req_free_list = resreq->next;
+	pthread_mutex_unlock(&resource_req_free_lock);
+	memset(resreq, 0, sizeof(resource_req));
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by memset() */
 
 	resreq->name = NULL;
 	resreq->res_str = NULL;
@@ -1500,7 +1528,10 @@ free_resource_req(resource_req *req)
 	if (req->res_str != NULL)
 		free(req->res_str);
 
-	free(req);
+	pthread_mutex_lock(&resource_req_free_lock);
+	req->next = resource_req_free_list;
+	resource_req_free_list = req;
+	pthread_mutex_unlock(&resource_req_free_lock);
 }
 
 /**
@@ -1774,7 +1805,7 @@ update_resresv_on_end(resource_resv *resresv, const char *job_state)
 				 * left to next occurrence if one exists
 				 */
 				if (resresv->resv->resv_idx < resresv->resv->count) {
-					next_occr_time = get_occurrence(resresv->resv->rrule,
+					next_occr_time = find_occurrence(resresv->resv->rrule,
 						resresv->resv->req_start, resresv->resv->timezone, 2);
 					if (next_occr_time >= 0) {
 						next_occr = find_resource_resv_by_time(resresv->server->resvs,
@@ -2066,6 +2097,7 @@ new_place()
 	pl->scatter = 0;
 	pl->vscatter = 0;
 	pl->exclhost = 0;
+	pl->is_interned = 0;
 
 	pl->group = NULL;
 
@@ -2074,7 +2106,8 @@ new_place()
 
 /**
  * @brief
- *		free_place - free a placement spec
+ *		free_place - free a placement spec.  Interned place specs are
+ *		owned by the intern table and are left alone.
  *
  * @param[in,out]	pl	-	the placement spec to free
  *
@@ -2084,7 +2117,7 @@ new_place()
 void
 free_place(place *pl)
 {
-	if (pl == NULL)
+	if (pl == NULL || pl->is_interned)
 		return;
 
 	if (pl->group != NULL)
@@ -2128,6 +2161,25 @@ dup_place(place *pl)
 	return newpl;
 }
 
+/**
+ * @brief
+ *		share_place - copy a place structure for another holder.
+ *		Interned place structures are read-only and returned as is.
+ *
+ * @param[in]	pl	-	the place structure to share
+ *
+ * @return	place structure for the new holder
+ *
+ */
+place *
+share_place(place *pl)
+{
+	if (pl != NULL && pl->is_interned)
+		return pl;
+
+	return dup_place(pl);
+}
+
 /**
  * @brief
  *		new_chunk - constructor for chunk
@@ -2313,6 +2365,7 @@ new_selspec()
 	spec->total_cpus = 0;
 	spec->defs = NULL;
 	spec->chunks = NULL;
+	spec->is_interned = 0;
 
 	return spec;
 }
@@ -2354,14 +2407,34 @@ dup_selspec(selspec *oldspec)
 
 /**
  * @brief
- *		free_selspec - destructor for selspec
+ *		share_selspec - copy a selspec for another holder.
+ *		Interned selspecs are read-only and returned as is.
+ *
+ * @param[in]	spec	-	selspec to share
+ *
+ * @return	selspec for the new holder
+ * @retval	NULL	: Fail
+ */
+selspec *
+share_selspec(selspec *spec)
+{
+	if (spec != NULL && spec->is_interned)
+		return spec;
+
+	return dup_selspec(spec);
+}
+
+/**
+ * @brief
+ *		free_selspec - destructor for selspec.  Interned selspecs are
+ *		owned by the intern table and are left alone.
  *
  * @param[in,out]	spec	-	selspec to be freed.
  */
 void
 free_selspec(selspec *spec)
 {
-	if (spec == NULL)
+	if (spec == NULL || spec->is_interned)
 		return;
 
 	if (spec->defs != NULL)
@@ -278,6 +278,11 @@ void free_place(place *pl);
  */
 place *dup_place(place *pl);
 
+/*
+ *	share_place - dup_place() unless the place structure is interned
+ */
+place *share_place(place *pl);
+
 /*
  *	compare_res_to_str - compare a resource structure of type string to
  *			     a character array string
@@ -342,6 +347,11 @@ selspec *new_selspec();
  */
 selspec *dup_selspec(selspec *oldspec);
 
+/*
+ *	share_selspec - dup_selspec() unless the selspec is interned
+ */
+selspec *share_selspec(selspec *spec);
+
 /*
  *	free_selspec - destructor for selspec
  */
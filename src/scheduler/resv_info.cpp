@@ -46,6 +46,7 @@
  * 	resv_info.c - This file contains functions related to advance reservations.
  *
  * Functions included are:
+ *	find_occurrence()
  *	stat_resvs()
  *	query_reservations()
  *	query_resv()
@@ -62,6 +63,10 @@
  */
 #include <pbs_config.h>
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -87,6 +92,62 @@
 #include "constant.h"
 #include "node_partition.h"
 #include "pbs_internal.h"
+#include "config.h"
+
+/* Occurrence start times of standing reservations already expanded from
+ * their recurrence rule, keyed by the rule, start time and timezone.
+ * A standing reservation is re-read every cycle and ical can only compute
+ * an occurrence by stepping through all the ones before it.
+ */
+static std::unordered_map<std::string, std::vector<time_t> > occurrence_cache;
+
+/**
+ * @brief
+ * 		find_occurrence - get_occurrence() using occurrences already
+ * 		expanded for the same recurrence rule, start time and timezone
+ *
+ * @param[in]	rrule	-	the recurrence rule
+ * @param[in]	dtstart	-	the start time from which to start
+ * @param[in]	tz	-	the timezone of the recurrence rule
+ * @param[in]	idx	-	the index of the occurrence, starting at 1
+ *
+ * @return	time_t
+ * @retval	the start time of the occurrence, as get_occurrence()
+ *
+ * @par MT-safe: No
+ */
+time_t
+find_occurrence(char *rrule, time_t dtstart, char *tz, int idx)
+{
+	std::string key;
+	size_t num_occr;
+
+	if (rrule == NULL || tz == NULL || idx < 1)
+		return get_occurrence(rrule, dtstart, tz, idx);
+
+	key = std::string(rrule) + '\n' + tz + '\n' + std::to_string((long long) dtstart);
+
+	auto it = occurrence_cache.find(key);
+	if (it == occurrence_cache.end()) {
+		/* entries of gone reservations are dropped wholesale */
+		if (occurrence_cache.size() >= MAX_OCCURRENCE_CACHE)
+			occurrence_cache.clear();
+		it = occurrence_cache.emplace(key, std::vector<time_t>()).first;
+	}
+
+	std::vector<time_t> &occrs = it->second;
+	if (occrs.size() < (size_t) idx) {
+		/* expand ahead so walking every occurrence stays linear */
+		num_occr = std::max((size_t) idx, 2 * occrs.size());
+		occrs.resize(num_occr);
+		if (get_occurrences(rrule, dtstart, tz, num_occr, occrs.data()) == -1) {
+			occurrence_cache.erase(it);
+			return get_occurrence(rrule, dtstart, tz, idx);
+		}
+	}
+
+	return occrs[idx - 1];
+}
 
 /**
  * @brief
@@ -373,9 +434,8 @@ query_reservations(int pbs_sd, server_info *sinfo, struct batch_status *resvs)
 				free(jobs_in_reservations);
 
 				/* Sort the nodes to ensure correct job placement. */
-				qsort(resresv->resv->resv_nodes,
-					count_array(resresv->resv->resv_nodes),
-					sizeof(node_info *), multi_node_sort);
+				sort_nodes(resresv->resv->resv_nodes,
+					count_array(resresv->resv->resv_nodes));
 			}
 		}
 		/* The server's info only gives information about a single reservation
@@ -500,7 +560,7 @@ query_reservations(int pbs_sd, server_info *sinfo, struct batch_status *resvs)
 				 * The last argument (j+1) indicates the occurrence index from dtstart
 				 * starting at 1. Returns dtstart if it's an advance reservation.
 				 */
-				next = get_occurrence(rrule, dtstart, tz, j + 1);
+				next = find_occurrence(rrule, dtstart, tz, j + 1);
 
 				/* Duplicate the "master" resv only for subsequent occurrences */
 				if (j == 0)
@@ -1440,7 +1500,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 		 * See call to same function in query_reservations for a more in-depth
 		 * description.
 		 */
-		next = get_occurrence(rrule, dtstart, tz, j + 1);
+		next = find_occurrence(rrule, dtstart, tz, j + 1);
 		/* keep track of each occurrence's start time */
 		occr_start_arr[j] = next;
 
@@ -1743,7 +1803,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 			 * so we only care about the remaining ones
 			 */
 			for (; cur_count < occr_count; cur_count++) {
-				next = get_occurrence(rrule, dtstart, tz, cur_count + 1);
+				next = find_occurrence(rrule, dtstart, tz, cur_count + 1);
 				occr_start_arr[cur_count] = next;
 			}
 		}
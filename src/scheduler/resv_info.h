@@ -121,6 +121,9 @@ int ralter_reduce_chunks(resource_resv *resv);
 /* Will we try and confirm this reservation in this cycle */
 int will_confirm(resource_resv *resv, time_t server_time);
 
+/* get_occurrence() with the expanded occurrences kept between calls */
+time_t find_occurrence(char *rrule, time_t dtstart, char *tz, int idx);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -53,6 +53,7 @@
  * 	find_alloc_resource_by_str()
  * 	find_resource_by_str()
  * 	find_resource()
+ * 	index_resource_list()
  * 	free_server_info()
  * 	free_resource_list()
  * 	free_resource()
@@ -85,6 +86,7 @@
  * 	free_counts_list()
  * 	dup_counts()
  * 	dup_counts_list()
+ * 	index_counts_list()
  * 	find_counts()
  * 	find_alloc_counts()
  * 	update_counts_on_run()
@@ -94,6 +96,7 @@
  * 	set_resource()
  * 	find_indirect_resource()
  * 	resolve_indirect_resources()
+ * 	bind_indirect_resources()
  * 	update_preemption_on_run()
  * 	read_formula()
  * 	new_status()
@@ -112,10 +115,15 @@
  */
 #include <pbs_config.h>
 
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <ctype.h>
 #include <signal.h>
 #include <sys/wait.h>
@@ -148,6 +156,7 @@
 // #include "pbs_sched.h"
 #include "fifo.h"
 #include "buckets.h"
+#include "profile.h"
 #include "parse.h"
 #include "hook.h"
 #ifdef NAS
@@ -191,6 +200,7 @@ query_server(status *pol, int pbs_sd)
 	resource_resv **jobs_alive;
 	status *policy;
 	int job_arrays_associated = FALSE;
+	double prof;
 
 	if (pol == NULL)
 		return NULL;
@@ -229,6 +239,7 @@ query_server(status *pol, int pbs_sd)
 		free_server(sinfo);
 		return NULL;
 	}
+	index_resource_list(sinfo->res);
 
 	if (!dflt_sched && (sc_attrs.partition == NULL)) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_ERR, __func__, "Scheduler does not contain a partition");
@@ -257,8 +268,7 @@ query_server(status *pol, int pbs_sd)
 
 	/* sort the nodes before we filter them down to more useful lists */
 	if (policy->node_sort[0].res_name != NULL)
-		qsort(sinfo->nodes, sinfo->num_nodes, sizeof(node_info *),
-			multi_node_sort);
+		sort_nodes(sinfo->nodes, sinfo->num_nodes);
 
 	/* get the queues */
 	if ((sinfo->queues = query_queues(policy, pbs_sd, sinfo)) == NULL) {
@@ -449,6 +459,9 @@ query_server(status *pol, int pbs_sd)
 		sinfo->unordered_nodes[i] = ninfo;
 	}
 	sinfo->unordered_nodes[i] = NULL;
+	bind_indirect_resources(sinfo->nodes);
+
+	sinfo->aoe_groups = create_aoe_groups(sinfo->unordered_nodes);
 
 
 	generic_sim(sinfo->calendar, TIMED_RUN_EVENT, 0, 0, add_node_events, NULL, NULL);
@@ -456,15 +469,15 @@ query_server(status *pol, int pbs_sd)
 	/* Create placement sets  after collecting jobs on nodes because
 	 * we don't want to account for resources consumed by ghost jobs
 	 */
+	prof = prof_start();
 	create_placement_sets(policy, sinfo);
+	prof_stop(PROF_PLACEMENT_SETS, prof);
 
-	sinfo->buckets = create_node_buckets(policy, sinfo->nodes, sinfo->queues, UPDATE_BUCKET_IND);
+	prof = prof_start();
+	sinfo->buckets = query_node_buckets(policy, sinfo);
+	prof_stop(PROF_BUCKETS, prof);
 
-	if (sinfo->buckets != NULL) {
-		int ct;
-		ct = count_array(sinfo->buckets);
-		qsort(sinfo->buckets, ct, sizeof(node_bucket *), multi_bkt_sort);
-	}
+	start_resresv_set_failures(policy, sinfo);
 
 	pbs_statfree(server);
 
@@ -644,176 +657,469 @@ query_server_info(status *pol, struct batch_status *server)
 	return sinfo;
 }
 
+/*
+ * State of a server_dyn_res script.  When server_dyn_res_ttl is set a
+ * script's value is reused for that long and its next run may outlive the
+ * cycle which started it, so the state is kept across cycles here rather
+ * than on the per-cycle server_info.
+ */
+struct dyn_res_run {
+	char *command_line;	/* command the state belongs to */
+	pid_t pid;		/* pid of the running script, 0 if not running */
+	int fd;			/* read end of the script's stdout */
+	time_t started;		/* when the running script was started */
+	char buf[256];		/* output of the running script read so far */
+	int len;		/* number of bytes in buf */
+	char value[256];	/* last value the script returned */
+	int have_value;		/* value is valid */
+	time_t updated;		/* when value was read */
+};
+
+static struct dyn_res_run dyn_res_runs[MAX_SERVER_DYN_RES];
+
+/* scripts which did not exit when their value was read */
+static pid_t dyn_res_reap[MAX_SERVER_DYN_RES];
+static int dyn_res_nreap;
+
 /**
  * @brief
- * 		execute all configured server_dyn_res scripts
+ * 		stop a running server_dyn_res script.  The script is sent a SIGTERM
+ *		and reaped at the end of query_server_dyn_res() if it has not yet
+ *		exited.
  *
- * @param[in]	sinfo	-	server info
+ * @param[in]	run	-	script to stop
  *
- * @retval	0	: on success
- * @retval -1	: on error
+ * @return	void
  */
-int
-query_server_dyn_res(server_info *sinfo)
+static void
+stop_dyn_res(struct dyn_res_run *run)
 {
-	int i, k;
-	int pipe_err;
-	char res_zero[] = "0";	/* dynamic res failure implies resource <-0 */
-	char buf[256];		/* buffer for reading from pipe */
-	schd_resource *res;		/* used for updating node resources */
-	FILE *fp;			/* for popen() for res_assn */
-
-
-	for (i = 0; (i < MAX_SERVER_DYN_RES) && (conf.dynamic_res[i].res != NULL); i++) {
-		res = find_alloc_resource_by_str(sinfo->res, conf.dynamic_res[i].res);
-		if (res != NULL) {
-			int ret;
-			fd_set set;
-			sigset_t allsigs;
-			pid_t pid;			/* pid of child */
-			int pdes[2];
-			k = 0;
-			#if !defined(DEBUG) && !defined(NO_SECURITY_CHECK)
-				int err;
-				char *filename;
-			#endif
+	if (run->pid > 0) {
+		kill(-run->pid, SIGTERM);
+		if (waitpid(run->pid, NULL, WNOHANG) == 0 && dyn_res_nreap < MAX_SERVER_DYN_RES)
+			dyn_res_reap[dyn_res_nreap++] = run->pid;
+		close(run->fd);
+	}
+	run->pid = 0;
+	run->fd = -1;
+	run->len = 0;
+}
 
-			if (sinfo->res == NULL)
-				sinfo->res = res;
-
-			pipe_err = errno = 0;
-			pid = 0;
-
-			/* Make sure file does not have open permissions */
-			#if !defined(DEBUG) && !defined(NO_SECURITY_CHECK)
-				filename = conf.dynamic_res[i].script_name;
-				err = tmp_file_sec_user(filename, 0, 1, S_IWGRP|S_IWOTH, 1, getuid());
-				if (err != 0) {
-					log_eventf(PBSEVENT_SECURITY, PBS_EVENTCLASS_SERVER, LOG_ERR, "server_dyn_res",
-						"error: %s file has a non-secure file access, setting resource %s to 0, errno: %d",
-						filename, res->name, err);
-					set_resource(res, res_zero, RF_AVAIL);
-					continue;
-				}
-			#endif
+/**
+ * @brief
+ * 		record the value of a server_dyn_res script
+ *
+ * @param[in]	run	-	script
+ * @param[in]	value	-	value the script returned
+ *
+ * @return	void
+ */
+static void
+set_dyn_res_value(struct dyn_res_run *run, const char *value)
+{
+	pbs_strncpy(run->value, value, sizeof(run->value));
+	run->have_value = 1;
+	run->updated = time(NULL);
+}
 
-			if (pipe(pdes) < 0) {
-				pipe_err = errno;
-			}
-			if (!pipe_err) {
-				switch(pid = fork()) {
-				case -1:	/* error */
-					close(pdes[0]);
-					close(pdes[1]);
-					pipe_err = errno;
-					break;
-				case 0:		/* child */
-					close(pdes[0]);
-					if (pdes[1] != STDOUT_FILENO) {
-						dup2(pdes[1], STDOUT_FILENO);
-						close(pdes[1]);
-					}
-					setpgid(0, 0);
-					if (sigemptyset(&allsigs) == -1) {
-						log_err(errno, __func__, "sigemptyset failed");
-					}
-					if (sigprocmask(SIG_SETMASK, &allsigs, NULL) == -1) {	/* unblock all signals */
-						log_err(errno, __func__, "sigprocmask(UNBLOCK)");
-					}
+/**
+ * @brief
+ * 		finish a server_dyn_res script: take the first line of its output as
+ *		its value and stop it.  Bad or missing output sets the value to 0.
+ *
+ * @param[in]	run	-	script to finish
+ * @param[in]	res	-	resource the script sets, used to validate its output
+ * @param[in]	pipe_err	-	errno of a failed read, or 0
+ *
+ * @return	void
+ */
+static void
+finish_dyn_res(struct dyn_res_run *run, schd_resource *res, int pipe_err)
+{
+	char *nl;
+	int k;
+
+	run->buf[run->len] = '\0';
+	if ((nl = strchr(run->buf, '\n')) != NULL)
+		nl[1] = '\0';
+	k = strlen(run->buf);
+
+	if (pipe_err == 0 && k > 0) {
+		/* chop \r or \n from buf so that is_num() doesn't think it's a str */
+		while (--k) {
+			if ((run->buf[k] != '\n') && (run->buf[k] != '\r'))
+				break;
+			run->buf[k] = '\0';
+		}
+		if (set_resource(res, run->buf, RF_AVAIL) == 0) {
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+				"Script %s returned bad output", run->command_line);
+			set_dyn_res_value(run, "0");
+		} else
+			set_dyn_res_value(run, run->buf);
+	} else {
+		if (pipe_err != 0)
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+				"Can't pipe to program %s: %s", run->command_line, strerror(pipe_err));
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+			"Setting resource %s to 0", res->name);
+		set_dyn_res_value(run, "0");
+	}
+	stop_dyn_res(run);
+}
+
+/**
+ * @brief
+ * 		start a server_dyn_res script.  Its output is collected by
+ *		wait_dyn_res().
+ *
+ * @param[in]	dr	-	configured server_dyn_res
+ * @param[in]	run	-	state of the script
+ * @param[in]	res	-	resource the script sets
+ *
+ * @return	void
+ */
+static void
+start_dyn_res(struct dyn_res *dr, struct dyn_res_run *run, schd_resource *res)
+{
+	sigset_t allsigs;
+	int pdes[2];
+	pid_t pid;
+
+	/* Make sure file does not have open permissions */
+#if !defined(DEBUG) && !defined(NO_SECURITY_CHECK)
+	int err;
+
+	err = tmp_file_sec_user(dr->script_name, 0, 1, S_IWGRP|S_IWOTH, 1, getuid());
+	if (err != 0) {
+		log_eventf(PBSEVENT_SECURITY, PBS_EVENTCLASS_SERVER, LOG_ERR, "server_dyn_res",
+			"error: %s file has a non-secure file access, setting resource %s to 0, errno: %d",
+			dr->script_name, res->name, err);
+		set_dyn_res_value(run, "0");
+		return;
+	}
+#endif
 
-					char *argv[4];
-					argv[0] = const_cast<char *>("/bin/sh");
-					argv[1] = const_cast<char *>("-c");
-					argv[2] = conf.dynamic_res[i].command_line;
-					argv[3] = NULL;
+	if (pipe(pdes) < 0) {
+		finish_dyn_res(run, res, errno);
+		return;
+	}
 
-					execve("/bin/sh", argv, environ);
-					_exit(127);
-				}
+	switch (pid = fork()) {
+		case -1:	/* error */
+			close(pdes[0]);
+			close(pdes[1]);
+			finish_dyn_res(run, res, errno);
+			return;
+		case 0:		/* child */
+			close(pdes[0]);
+			if (pdes[1] != STDOUT_FILENO) {
+				dup2(pdes[1], STDOUT_FILENO);
+				close(pdes[1]);
+			}
+			setpgid(0, 0);
+			if (sigemptyset(&allsigs) == -1) {
+				log_err(errno, __func__, "sigemptyset failed");
 			}
+			if (sigprocmask(SIG_SETMASK, &allsigs, NULL) == -1) {	/* unblock all signals */
+				log_err(errno, __func__, "sigprocmask(UNBLOCK)");
+			}
+
+			char *argv[4];
+			argv[0] = const_cast<char *>("/bin/sh");
+			argv[1] = const_cast<char *>("-c");
+			argv[2] = dr->command_line;
+			argv[3] = NULL;
 
-			k = 0;
-			if (!pipe_err) {
-				FD_ZERO(&set);
-				FD_SET(pdes[0], &set);
+			execve("/bin/sh", argv, environ);
+			_exit(127);
+	}
+
+	/* parent: scripts started later must not hold this pipe open */
+	close(pdes[1]);
+	fcntl(pdes[0], F_SETFD, FD_CLOEXEC);
+	run->pid = pid;
+	run->fd = pdes[0];
+	run->started = time(NULL);
+	run->len = 0;
+}
+
+/**
+ * @brief
+ * 		collect the output of the running server_dyn_res scripts.  All the
+ *		scripts are waited on together, each up to server_dyn_res_alarm.
+ *		Scripts whose value is still within server_dyn_res_ttl are only
+ *		polled; they are left running when nothing else needs waiting for.
+ *
+ * @param[in]	res	-	resources the scripts set, indexed like conf.dynamic_res
+ * @param[in]	num	-	number of configured server_dyn_res
+ *
+ * @return	void
+ */
+static void
+wait_dyn_res(schd_resource **res, int num)
+{
+	while (1) {
+		struct timeval timeout;
+		struct timeval *tp;
+		time_t now;
+		time_t wait = -1;
+		int needed = 0;
+		int running = 0;
+		fd_set set;
+		int ret;
+		int i;
+
+		now = time(NULL);
+		FD_ZERO(&set);
+		for (i = 0; i < num; i++) {
+			struct dyn_res_run *run = &dyn_res_runs[i];
+
+			if (run->pid <= 0)
+				continue;
+			if (sc_attrs.server_dyn_res_alarm && now - run->started >= sc_attrs.server_dyn_res_alarm) {
+				log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+					"Program %s timed out", run->command_line);
+				run->len = 0;
+				finish_dyn_res(run, res[i], 0);
+				continue;
+			}
+			FD_SET(run->fd, &set);
+			running++;
+			if (conf.server_dyn_res_ttl == 0 || !run->have_value) {
+				needed++;
 				if (sc_attrs.server_dyn_res_alarm) {
-					struct timeval timeout;
-					timeout.tv_sec = sc_attrs.server_dyn_res_alarm;
-					timeout.tv_usec = 0;
-					ret = select(FD_SETSIZE, &set, NULL, NULL, &timeout);
-				} else {
-					ret = select(FD_SETSIZE, &set, NULL, NULL, NULL);
+					time_t left = run->started + sc_attrs.server_dyn_res_alarm - now;
+					if (wait == -1 || left < wait)
+						wait = left;
 				}
-				if (ret == -1) {
+			}
+		}
+		if (running == 0)
+			return;
+
+		if (needed == 0) {
+			/* only poll the scripts refreshing a cached value */
+			timeout.tv_sec = 0;
+			timeout.tv_usec = 0;
+			tp = &timeout;
+		} else if (wait != -1) {
+			timeout.tv_sec = wait;
+			timeout.tv_usec = 0;
+			tp = &timeout;
+		} else
+			tp = NULL;
+
+		ret = select(FD_SETSIZE, &set, NULL, NULL, tp);
+		if (ret == -1) {
+			if (errno == EINTR)
+				continue;
+			for (i = 0; i < num; i++) {
+				if (dyn_res_runs[i].pid > 0) {
 					log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-					"Select() failed for script %s", conf.dynamic_res[i].command_line);
-				} else if (ret == 0) {
-					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-					"Program %s timed out", conf.dynamic_res[i].command_line);
-				}
-				if (pid > 0 && ret > 0) {
-					/* Parent; only open if child created and select showed sth to read,
-					 * but assume fdopen can't fail
-					 */
-					fp = fdopen(pdes[0], "r");
-					close(pdes[1]);
-					if (fgets(buf, sizeof(buf), fp) == NULL) {
-						pipe_err = errno;
-					} else
-						k = strlen(buf);
-					if (fp != NULL)
-						fclose(fp);
+						"Select() failed for script %s", dyn_res_runs[i].command_line);
+					dyn_res_runs[i].len = 0;
+					finish_dyn_res(&dyn_res_runs[i], res[i], 0);
 				}
 			}
+			return;
+		}
 
-			if (k > 0) {
-				buf[k] = '\0';
-				/* chop \r or \n from buf so that is_num() doesn't think it's a str */
-				while (--k) {
-					if ((buf[k] != '\n') && (buf[k] != '\r'))
-						break;
-					buf[k] = '\0';
-				}
-				if (set_resource(res, buf, RF_AVAIL) == 0) {
-					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-						"Script %s returned bad output", conf.dynamic_res[i].command_line);
-					(void) set_resource(res, res_zero, RF_AVAIL);
-				}
-			} else {
-				if (pipe_err != 0)
-					log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-						"Can't pipe to program %s: %s", conf.dynamic_res[i].command_line, strerror(pipe_err));
-				log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-					"Setting resource %s to 0", res->name);
-				(void) set_resource(res, res_zero, RF_AVAIL);
+		for (i = 0; i < num && ret > 0; i++) {
+			struct dyn_res_run *run = &dyn_res_runs[i];
+			ssize_t n;
+
+			if (run->pid <= 0 || !FD_ISSET(run->fd, &set))
+				continue;
+			n = read(run->fd, run->buf + run->len, sizeof(run->buf) - 1 - run->len);
+			if (n < 0) {
+				if (errno != EINTR && errno != EAGAIN)
+					finish_dyn_res(run, res[i], errno);
+				continue;
 			}
-			if (res->type.is_non_consumable)
-				log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-					"%s = %s", conf.dynamic_res[i].command_line, res_to_str(res, RF_AVAIL));
-			else
-				log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
-					"%s = %s (\"%s\")", conf.dynamic_res[i].command_line, res_to_str(res, RF_AVAIL), buf);
-
-			if (pid > 0) {
-				kill(-pid, SIGTERM);
-				if (waitpid(pid, NULL, WNOHANG) == 0) {
-					usleep(250000);
-					if (waitpid(pid, NULL, WNOHANG) == 0) {
-						kill(-pid, SIGKILL);
-						waitpid(pid, NULL, 0);
-					}
-				}
+			run->len += n;
+			run->buf[run->len] = '\0';
+			/* the first line is all we want */
+			if (n == 0 || strchr(run->buf, '\n') != NULL || run->len == sizeof(run->buf) - 1)
+				finish_dyn_res(run, res[i], 0);
+		}
+
+		if (needed == 0)
+			return;
+	}
+}
+
+/**
+ * @brief
+ * 		execute all configured server_dyn_res scripts.  The scripts are run
+ *		in parallel.  If server_dyn_res_ttl is set, a script's value is
+ *		reused until it is older than the ttl; the script is then rerun in
+ *		the background and its old value used until the new one is read.
+ *
+ * @param[in]	sinfo	-	server info
+ *
+ * @retval	0	: on success
+ * @retval -1	: on error
+ */
+int
+query_server_dyn_res(server_info *sinfo)
+{
+	int i, num;
+	time_t now;
+	schd_resource *res[MAX_SERVER_DYN_RES];	/* used for updating server resources */
+
+	dyn_res_nreap = 0;
+	now = time(NULL);
+	for (num = 0; (num < MAX_SERVER_DYN_RES) && (conf.dynamic_res[num].res != NULL); num++) {
+		struct dyn_res_run *run = &dyn_res_runs[num];
+
+		res[num] = find_alloc_resource_by_str(sinfo->res, conf.dynamic_res[num].res);
+		if (res[num] == NULL)
+			continue;
+		if (sinfo->res == NULL)
+			sinfo->res = res[num];
+
+		/* the sched_config was reread and the script changed */
+		if (run->command_line == NULL || strcmp(run->command_line, conf.dynamic_res[num].command_line) != 0) {
+			stop_dyn_res(run);
+			free(run->command_line);
+			run->command_line = string_dup(conf.dynamic_res[num].command_line);
+			run->have_value = 0;
+			if (run->command_line == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				res[num] = NULL;
+				continue;
 			}
 		}
+
+		if (run->pid == 0 && (!run->have_value || now - run->updated >= conf.server_dyn_res_ttl))
+			start_dyn_res(&conf.dynamic_res[num], run, res[num]);
+	}
+
+	/* scripts which are no longer configured */
+	for (i = num; i < MAX_SERVER_DYN_RES && dyn_res_runs[i].command_line != NULL; i++) {
+		stop_dyn_res(&dyn_res_runs[i]);
+		free(dyn_res_runs[i].command_line);
+		dyn_res_runs[i].command_line = NULL;
+		dyn_res_runs[i].have_value = 0;
+	}
+
+	/* a resource we could not allocate has no script running */
+	for (i = 0; i < num; i++) {
+		if (res[i] == NULL && dyn_res_runs[i].pid > 0)
+			stop_dyn_res(&dyn_res_runs[i]);
 	}
 
-	if (i == MAX_SERVER_DYN_RES) /* reached max and stopped */
+	wait_dyn_res(res, num);
+
+	now = time(NULL);
+	for (i = 0; i < num; i++) {
+		struct dyn_res_run *run = &dyn_res_runs[i];
+		const char *value;
+
+		if (res[i] == NULL)
+			continue;
+		value = run->have_value ? run->value : "0";
+		(void) set_resource(res[i], value, RF_AVAIL);
+
+		if (res[i]->type.is_non_consumable)
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+				"%s = %s", run->command_line, res_to_str(res[i], RF_AVAIL));
+		else
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+				"%s = %s (\"%s\")", run->command_line, res_to_str(res[i], RF_AVAIL), value);
+		if (conf.server_dyn_res_ttl && run->have_value && now - run->updated > 0)
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "server_dyn_res",
+				"%s value is %ld seconds old", run->command_line, (long)(now - run->updated));
+	}
+
+	/* give the scripts we stopped a moment to exit before killing them */
+	if (dyn_res_nreap > 0) {
+		usleep(250000);
+		for (i = 0; i < dyn_res_nreap; i++) {
+			if (waitpid(dyn_res_reap[i], NULL, WNOHANG) == 0) {
+				kill(-dyn_res_reap[i], SIGKILL);
+				waitpid(dyn_res_reap[i], NULL, 0);
+			}
+		}
+		dyn_res_nreap = 0;
+	}
+
+	if (num == MAX_SERVER_DYN_RES) /* reached max and stopped */
 		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO, "server_dyn_res",
 			"Reached max number of server_dyn_res of %d", MAX_SERVER_DYN_RES);
 
 	return 0;
 }
 
+/**
+ * @brief
+ * 		index a resource list by resource definition.  Once a list is
+ *		indexed, find_resource() on it is a single lookup instead of a
+ *		walk of the list.  The index is kept on the head of the list.
+ *		Resources must only be added to an indexed list through
+ *		find_alloc_resource() or find_alloc_resource_by_str().
+ *
+ * @param[in,out]	reslist	-	the resource list to index
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure (the list is left unindexed)
+ *
+ * @par MT-Safe:	no
+ */
+int
+index_resource_list(schd_resource *reslist)
+{
+	schd_resource *resp;
+	int size = 0;
+
+	if (reslist == NULL)
+		return 0;
+
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		if (resp->def != NULL && resp->def->index >= size)
+			size = resp->def->index + 1;
+	}
+
+	free(reslist->def_index);
+	reslist->def_index_size = 0;
+	if ((reslist->def_index = static_cast<schd_resource **>(calloc(size + 1, sizeof(schd_resource *)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	reslist->def_index_size = size + 1;
+
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		if (resp->def != NULL && resp->def->index >= 0 &&
+			reslist->def_index[resp->def->index] == NULL)
+			reslist->def_index[resp->def->index] = resp;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		add a resource which was appended to a list to the list's index
+ *
+ * @param[in,out]	reslist	-	head of the resource list
+ * @param[in]	resp	-	resource appended to reslist
+ *
+ * @return	void
+ */
+static void
+add_resource_to_index(schd_resource *reslist, schd_resource *resp)
+{
+	if (reslist->def_index == NULL || resp->def == NULL || resp->def->index < 0)
+		return;
+
+	if (resp->def->index >= reslist->def_index_size)
+		index_resource_list(reslist);
+	else if (reslist->def_index[resp->def->index] == NULL)
+		reslist->def_index[resp->def->index] = resp;
+}
+
 /**
  * @brief
  * 		try and find a resource by resdef, and if it is not
@@ -848,8 +1154,10 @@ find_alloc_resource(schd_resource *resplist, resdef *def)
 		resp->type = def->type;
 		resp->name = def->name;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			add_resource_to_index(resplist, resp);
+		}
 	}
 
 	return resp;
@@ -886,8 +1194,10 @@ find_alloc_resource_by_str(schd_resource *resplist, char *name)
 		if ((resp = create_resource(name, NULL, RF_NONE)) == NULL)
 			return NULL;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			add_resource_to_index(resplist, resp);
+		}
 	}
 
 	return resp;
@@ -938,6 +1248,15 @@ find_resource(schd_resource *reslist, resdef *def)
 	if (reslist == NULL || def == NULL)
 		return NULL;
 
+	if (reslist->def_index != NULL && def->index >= 0) {
+		if (def->index >= reslist->def_index_size)
+			return NULL;
+		resp = reslist->def_index[def->index];
+		/* a copy of a definition has the same index but is not the same resource */
+		if (resp == NULL || resp->def == def)
+			return resp;
+	}
+
 	resp = reslist;
 
 	while (resp != NULL && resp->def != def)
@@ -970,6 +1289,7 @@ free_server_info(server_info *sinfo)
 		free(sinfo->running_jobs);
 	if (sinfo->exiting_jobs != NULL)
 		free(sinfo->exiting_jobs);
+	free(sinfo->preempt_ordered_jobs);
 	/* if we don't have nodes associated with queues, this is a reference */
 	if (sinfo->has_nodes_assoc_queue == 0)
 		sinfo->unassoc_nodes = NULL;
@@ -1023,6 +1343,8 @@ free_server_info(server_info *sinfo)
 	if(sinfo->unordered_nodes != NULL)
 		free(sinfo->unordered_nodes);
 
+	free_aoe_groups(sinfo->aoe_groups);
+
 	free_resource_list(sinfo->res);
 	free(sinfo->job_sort_formula);
 
@@ -1056,6 +1378,18 @@ free_resource_list(schd_resource *reslist)
 	}
 }
 
+/*
+ * Resources are the most numerous objects in the universe and are created
+ * and freed by the hundreds of thousands every cycle.  Rather than going
+ * through malloc() for each one, they are carved out of chunks of
+ * RES_ALLOC_CHUNK and freed resources are kept for reuse.  A resource is
+ * often freed by another thread than the one which created it, so there
+ * is one free list for all threads, under resource_free_lock.  The chunks
+ * are never returned to the system.
+ */
+static schd_resource *resource_free_list = NULL;
+static pthread_mutex_t resource_free_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * @brief
  * 		free_resource - frees the memory used by a resource structure
@@ -1064,7 +1398,7 @@ free_resource_list(schd_resource *reslist)
  *
  * @return	void
  *
- * @par MT-Safe:	no
+ * @par MT-Safe:	yes
  */
 void
 free_resource(schd_resource *resp)
@@ -1084,7 +1418,13 @@ free_resource(schd_resource *resp)
 	if (resp->str_assigned != NULL)
 		free(resp->str_assigned);
 
-	free(resp);
+	if (resp->def_index != NULL)
+		free(resp->def_index);
+
+	pthread_mutex_lock(&resource_free_lock);
+	resp->next = resource_free_list;
+	resource_free_list = resp;
+	pthread_mutex_unlock(&resource_free_lock);
 }
 
 /**
@@ -1137,10 +1477,12 @@ new_server_info(int limallocflag)
 	sinfo->queues = NULL;
 	sinfo->queue_list = NULL;
 	sinfo->jobs = NULL;
+	sinfo->jobs_sorted = 0;
 	sinfo->all_resresv = NULL;
 	sinfo->calendar = NULL;
 	sinfo->running_jobs = NULL;
 	sinfo->exiting_jobs = NULL;
+	sinfo->preempt_ordered_jobs = NULL;
 	sinfo->nodes = NULL;
 	sinfo->unassoc_nodes = NULL;
 	sinfo->resvs = NULL;
@@ -1164,6 +1506,9 @@ new_server_info(int limallocflag)
 	sinfo->equiv_classes = NULL;
 	sinfo->buckets = NULL;
 	sinfo->unordered_nodes = NULL;
+	sinfo->free_res_gen = 0;
+	memset(&sinfo->unassoc_hint, 0, sizeof(sinfo->unassoc_hint));
+	sinfo->aoe_groups = NULL;
 	sinfo->num_queues = 0;
 	sinfo->num_nodes = 0;
 	sinfo->num_resvs = 0;
@@ -1198,12 +1543,26 @@ new_resource()
 {
 	schd_resource *resp;		/* the new resource */
 
-	if ((resp = static_cast<schd_resource *>(calloc(1,  sizeof(schd_resource)))) == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
-		return NULL;
+	pthread_mutex_lock(&resource_free_lock);
+	if (resource_free_list == NULL) {
+		int i;
+
+		if ((resp = static_cast<schd_resource *>(malloc(RES_ALLOC_CHUNK * sizeof(schd_resource)))) == NULL) {
+			pthread_mutex_unlock(&resource_free_lock);
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		for (i = 0; i < RES_ALLOC_CHUNK - 1; i++)
+			resp[i].next = &resp[i + 1];
+		resp[i].next = NULL;
+		resource_free_list = resp;
 	}
+	resp = resource_free_list;
+	resource_free_list = resp->next;
+	pthread_mutex_unlock(&resource_free_lock);
+	memset(resp, 0, sizeof(schd_resource));
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by memset() */
 
 	resp->name = NULL;
 	resp->next = NULL;
@@ -1211,6 +1570,7 @@ new_resource()
 	resp->orig_str_avail = NULL;
 	resp->indirect_vnode_name = NULL;
 	resp->indirect_res = NULL;
+	resp->indirect_node_ind = -1;
 	resp->str_avail = NULL;
 	resp->str_assigned = NULL;
 	resp->assigned = RES_DEFAULT_ASSN;
@@ -1367,6 +1727,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 				if (end_r1->next == NULL)
 					return 0;
 				end_r1 = end_r1->next;
+				add_resource_to_index(r1, end_r1);
 			}
 		} else if (cur_r1->type.is_consumable) {
 			if ((flags & ADD_AVAIL_ASSIGNED)) {
@@ -1408,6 +1769,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 								;
 						end_r1->next = nres;
 						end_r1 = nres;
+						add_resource_to_index(r1, nres);
 					} else {
 						nres = false_res();
 						if (nres == NULL)
@@ -1643,16 +2005,13 @@ update_server_on_run(status *policy, server_info *sinfo,
 
 				resv_nodes = resresv->job->resv->resv->resv_nodes;
 				num_resv_nodes = count_array(resv_nodes);
-				qsort(resv_nodes, num_resv_nodes, sizeof(node_info *),
-					multi_node_sort);
+				resort_nodes(resv_nodes, num_resv_nodes);
 			} else {
-				qsort(sinfo->nodes, sinfo->num_nodes, sizeof(node_info *),
-					multi_node_sort);
+				resort_nodes(sinfo->nodes, sinfo->num_nodes);
 
 				if (sinfo->nodes != sinfo->unassoc_nodes) {
 					num_unassoc = count_array(sinfo->unassoc_nodes);
-					qsort(sinfo->unassoc_nodes, num_unassoc, sizeof(node_info *),
-						multi_node_sort);
+					resort_nodes(sinfo->unassoc_nodes, num_unassoc);
 				}
 			}
 		}
@@ -2179,6 +2538,7 @@ dup_server_info(server_info *osinfo)
 	nsinfo->liminfo = lim_dup_liminfo(osinfo->liminfo);
 	nsinfo->server_time = osinfo->server_time;
 	nsinfo->res = dup_resource_list(osinfo->res);
+	index_resource_list(nsinfo->res);
 	nsinfo->alljobcounts = dup_counts_list(osinfo->alljobcounts);
 	nsinfo->group_counts = dup_counts_list(osinfo->group_counts);
 	nsinfo->project_counts = dup_counts_list(osinfo->project_counts);
@@ -2204,6 +2564,7 @@ dup_server_info(server_info *osinfo)
 		nsinfo->unassoc_nodes = nsinfo->nodes;
 
 	nsinfo->unordered_nodes = dup_unordered_nodes(osinfo->unordered_nodes, nsinfo->nodes);
+	nsinfo->aoe_groups = create_aoe_groups(nsinfo->unordered_nodes);
 
 	/* dup the reservations */
 	nsinfo->resvs = dup_resource_resv_array(osinfo->resvs, nsinfo, NULL);
@@ -2256,13 +2617,27 @@ dup_server_info(server_info *osinfo)
 		return NULL;
 	}
 
-	nsinfo->running_jobs =
-		resource_resv_filter(nsinfo->jobs, nsinfo->sc.total,
-		check_run_job, NULL, FILTER_FULL);
+	/* The running and exiting jobs are the same jobs as in osinfo.  Map the
+	 * old arrays through all_resresv rather than filtering every job again.
+	 */
+	nsinfo->running_jobs = copy_resresv_array(osinfo->running_jobs, nsinfo->all_resresv);
+	nsinfo->exiting_jobs = copy_resresv_array(osinfo->exiting_jobs, nsinfo->all_resresv);
+	if (nsinfo->running_jobs == NULL || nsinfo->exiting_jobs == NULL) {
+		free_server(nsinfo);
+		return NULL;
+	}
+	for (i = 0; i < nsinfo->num_queues; i++) {
+		queue_info *oqinfo = osinfo->queues[i];
+		queue_info *nqinfo = nsinfo->queues[i];
 
-	nsinfo->exiting_jobs =
-		resource_resv_filter(nsinfo->jobs, nsinfo->sc.total,
-		check_exit_job, NULL, 0);
+		if (oqinfo->running_jobs != NULL && nqinfo->jobs != NULL) {
+			nqinfo->running_jobs = copy_resresv_array(oqinfo->running_jobs, nsinfo->all_resresv);
+			if (nqinfo->running_jobs == NULL) {
+				free_server(nsinfo);
+				return NULL;
+			}
+		}
+	}
 
 	nsinfo->num_preempted = osinfo->num_preempted;
 
@@ -2329,7 +2704,7 @@ dup_server_info(server_info *osinfo)
 	/* Now that all job information has been created, time to associate
 	 * jobs to each other if they have runone dependency
 	 */
-	associate_dependent_jobs(nsinfo);
+	dup_dependent_jobs(nsinfo, osinfo);
 
 	for (i = 0; nsinfo->running_jobs[i] != NULL; i++) {
 		if ((nsinfo->running_jobs[i]->job->is_subjob) &&
@@ -2513,6 +2888,7 @@ dup_resource(schd_resource *res)
 
 	if (res->indirect_vnode_name != NULL)
 		nres->indirect_vnode_name = string_dup(res->indirect_vnode_name);
+	nres->indirect_node_ind = res->indirect_node_ind;
 
 	if (res->orig_str_avail != NULL)
 		nres->orig_str_avail = string_dup(res->orig_str_avail);
@@ -2577,11 +2953,24 @@ new_counts(void)
 	cts->running = 0;
 	cts->rescts = NULL;
 	cts->soft_limit_preempt_bit = 0;
+	cts->index = NULL;
 	cts->next = NULL;
 
 	return cts;
 }
 
+/*
+ * Limits are checked by looking up the counts of an entity by name.  Once
+ * a counts list is long enough, the lookups would be a big part of checking
+ * limits.  The head of such a list keeps an index of the list by name and
+ * a pointer to the end of the list for appending.
+ */
+#define COUNTS_INDEX_MIN 16
+struct counts_index {
+	std::unordered_map<std::string, counts *> by_name;
+	counts *last;		/* last counts in the list */
+};
+
 /**
  * @brief
  * 		free_counts - free a counts structure
@@ -2604,6 +2993,8 @@ free_counts(counts *cts)
 	if (cts->rescts != NULL)
 		free_resource_count_list(cts->rescts);
 
+	delete cts->index;
+
 	cts->next = NULL;
 
 	free(cts);
@@ -2702,6 +3093,35 @@ dup_counts_list(counts *ctslist)
 	return nhead;
 }
 
+/**
+ * @brief
+ * 		index_counts_list - index a counts list by name
+ *
+ * @param[in,out]	ctslist - the counts list to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+static void
+index_counts_list(counts *ctslist)
+{
+	counts *cur;
+
+	delete ctslist->index;
+	ctslist->index = new (std::nothrow) counts_index;
+	if (ctslist->index == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return;
+	}
+
+	for (cur = ctslist; cur != NULL; cur = cur->next) {
+		if (cur->name != NULL)
+			ctslist->index->by_name.emplace(cur->name, cur);
+		ctslist->index->last = cur;
+	}
+}
+
 /**
  * @brief
  * 		find_counts - find a counts structure by name
@@ -2718,14 +3138,27 @@ counts *
 find_counts(counts *ctslist, const char *name)
 {
 	counts *cur;
+	int len = 0;
 
 	if (ctslist == NULL || name == NULL)
 		return NULL;
 
+	if (ctslist->index != NULL) {
+		auto ent = ctslist->index->by_name.find(name);
+		if (ent == ctslist->index->by_name.end())
+			return NULL;
+		return ent->second;
+	}
+
 	cur = ctslist;
 
-	while (cur != NULL && strcmp(cur->name, name))
+	while (cur != NULL && strcmp(cur->name, name)) {
 		cur = cur->next;
+		len++;
+	}
+
+	if (len >= COUNTS_INDEX_MIN)
+		index_counts_list(ctslist);
 
 	return cur;
 }
@@ -2752,6 +3185,22 @@ find_alloc_counts(counts *ctslist, const char *name)
 	if (name == NULL)
 		return NULL;
 
+	if (ctslist != NULL && ctslist->index != NULL) {
+		cur = find_counts(ctslist, name);
+		if (cur != NULL)
+			return cur;
+
+		ncounts = new_counts();
+		if (ncounts != NULL) {
+			ncounts->name = string_dup(name);
+			ctslist->index->last->next = ncounts;
+			ctslist->index->last = ncounts;
+			if (ncounts->name != NULL)
+				ctslist->index->by_name.emplace(ncounts->name, ncounts);
+		}
+		return ncounts;
+	}
+
 	prev = cur = ctslist;
 
 	while (cur != NULL && strcmp(cur->name, name)) {
@@ -2881,7 +3330,7 @@ counts_max(counts *cmax, counts *ncounts)
 	cmax_head = cmax;
 
 	for (cur = ncounts; cur != NULL; cur = cur->next) {
-		cur_fmax = find_counts(cmax, cur->name);
+		cur_fmax = find_counts(cmax_head, cur->name);
 		if (cur_fmax == NULL) {
 			cur_fmax = dup_counts(cur);
 			if (cur_fmax == NULL) {
@@ -2890,6 +3339,13 @@ counts_max(counts *cmax, counts *ncounts)
 			}
 
 			cur_fmax->next = cmax_head;
+			/* the index belongs to the head of the list */
+			if (cmax_head->index != NULL) {
+				cur_fmax->index = cmax_head->index;
+				cmax_head->index = NULL;
+				if (cur_fmax->name != NULL)
+					cur_fmax->index->by_name.emplace(cur_fmax->name, cur_fmax);
+			}
 			cmax_head = cur_fmax;
 		} else {
 			if (cur->running > cur_fmax->running)
@@ -2977,6 +3433,8 @@ update_universe_on_end(status *policy, resource_resv *resresv, const char *job_s
 						q->allpart->res = NULL;
 					}
 				}
+				for (j = 0; sinfo->nodes[j] != NULL; j++)
+					mark_node_psets_stale(sinfo->nodes[j]);
 			}
 		}
 	}
@@ -3050,6 +3508,7 @@ set_resource(schd_resource *res, const char *val, enum resource_fields field)
 			free(res->indirect_vnode_name);
 			res->indirect_vnode_name = NULL;
 		}
+		res->indirect_node_ind = -1;
 		if (res->str_avail != NULL) {
 			free_string_array(res->str_avail);
 			res->str_avail = NULL;
@@ -3109,21 +3568,90 @@ set_resource(schd_resource *res, const char *val, enum resource_fields field)
 	return 1;
 }
 
+/* the nodes an indirect resource may point to, see find_indirect_node() */
+struct indirect_lookup {
+	node_info **nodes;
+	std::vector<node_info *> by_ind;	/* nodes by node_ind */
+	std::unordered_map<std::string, node_info *> by_name;	/* filled on first use */
+};
+
 /**
  * @brief
- * 		find_indirect_resource - follow the indirect resource pointers
- *		to find the real resource at the end
+ * 		set up an indirect_lookup for a node array.  The nodes are indexed
+ *		by node_ind so a resource bound to its target vnode finds it again
+ *		without a search, also in a copy of the nodes made by dup_nodes().
+ *
+ * @param[out]	lk	-	the lookup
+ * @param[in]	nodes	-	the nodes to search
+ *
+ * @return	void
+ */
+static void
+init_indirect_lookup(struct indirect_lookup &lk, node_info **nodes)
+{
+	int i;
+
+	lk.nodes = nodes;
+	for (i = 0; nodes[i] != NULL; i++) {
+		if (nodes[i]->node_ind < 0)
+			continue;
+		if (static_cast<size_t>(nodes[i]->node_ind) >= lk.by_ind.size())
+			lk.by_ind.resize(nodes[i]->node_ind + 1, NULL);
+		lk.by_ind[nodes[i]->node_ind] = nodes[i];
+	}
+}
+
+/**
+ * @brief
+ * 		find the vnode an indirect resource points to.  The node_ind the
+ *		resource was bound to is tried first, then the vnode's name.
+ *
+ * @param[in]	lk	-	the lookup for the nodes to search
+ * @param[in]	res	-	the indirect resource
+ *
+ * @return	node_info *
+ * @retval	the vnode
+ * @retval	NULL	: not in the nodes
+ */
+static node_info *
+find_indirect_node(struct indirect_lookup &lk, schd_resource *res)
+{
+	node_info *ninfo;
+	std::unordered_map<std::string, node_info *>::iterator it;
+	int i;
+
+	if (res->indirect_node_ind >= 0 &&
+		static_cast<size_t>(res->indirect_node_ind) < lk.by_ind.size()) {
+		ninfo = lk.by_ind[res->indirect_node_ind];
+		if (ninfo != NULL && strcmp(ninfo->name, res->indirect_vnode_name) == 0)
+			return ninfo;
+	}
+
+	if (lk.by_name.empty()) {
+		for (i = 0; lk.nodes[i] != NULL; i++)
+			lk.by_name.insert(std::make_pair(std::string(lk.nodes[i]->name), lk.nodes[i]));
+	}
+	it = lk.by_name.find(res->indirect_vnode_name);
+	if (it == lk.by_name.end())
+		return NULL;
+
+	return it->second;
+}
+
+/**
+ * @brief
+ * 		follow the indirect resource pointers to find the real resource at
+ *		the end.  The resource is bound to the node_ind of the vnode it
+ *		points to.
  *
  * @param[in]	res 	- the indirect resource
- * @param[in]	nodes 	- the nodes to search
+ * @param[in]	lk 	- the lookup for the nodes to search
  *
  * @return	the indirect resource
  * @retval	NULL	: on error
- *
- * @par MT-Safe:	no
  */
-schd_resource *
-find_indirect_resource(schd_resource *res, node_info **nodes)
+static schd_resource *
+find_indirect_resource_lk(schd_resource *res, struct indirect_lookup &lk)
 {
 	node_info *ninfo;
 	schd_resource *cur_res = NULL;
@@ -3131,15 +3659,13 @@ find_indirect_resource(schd_resource *res, node_info **nodes)
 	int error = 0;
 	const int max = 10;
 
-	if (res == NULL || nodes == NULL)
-		return NULL;
-
 	cur_res = res;
 
 	for (i = 0; i < max && cur_res != NULL &&
 		cur_res->indirect_vnode_name != NULL && !error; i++) {
-		ninfo = find_node_info(nodes, cur_res->indirect_vnode_name);
+		ninfo = find_indirect_node(lk, cur_res);
 		if (ninfo != NULL) {
+			cur_res->indirect_node_ind = ninfo->node_ind;
 			cur_res = find_resource(ninfo->res, cur_res->def);
 			if (cur_res == NULL) {
 				error = 1;
@@ -3169,10 +3695,38 @@ find_indirect_resource(schd_resource *res, node_info **nodes)
 	return cur_res;
 }
 
+/**
+ * @brief
+ * 		find_indirect_resource - follow the indirect resource pointers
+ *		to find the real resource at the end
+ *
+ * @param[in]	res 	- the indirect resource
+ * @param[in]	nodes 	- the nodes to search
+ *
+ * @return	the indirect resource
+ * @retval	NULL	: on error
+ *
+ * @par MT-Safe:	no
+ */
+schd_resource *
+find_indirect_resource(schd_resource *res, node_info **nodes)
+{
+	struct indirect_lookup lk;
+
+	if (res == NULL || nodes == NULL)
+		return NULL;
+
+	init_indirect_lookup(lk, nodes);
+	return find_indirect_resource_lk(res, lk);
+}
+
 /**
  * @brief
  * 		resolve_indirect_resources - resolve indirect resources for node
- *		array
+ *		array.  Each indirect resource is bound to the node_ind of its
+ *		target vnode the first time it is resolved.  The binding is kept
+ *		by dup_resource(), so resolving a copy of the nodes does not
+ *		search for the targets by name again.
  *
  * @param[in,out]	nodes	-	the nodes to resolve
  *
@@ -3185,6 +3739,7 @@ find_indirect_resource(schd_resource *res, node_info **nodes)
 int
 resolve_indirect_resources(node_info **nodes)
 {
+	struct indirect_lookup lk;
 	int i;
 	schd_resource *cur_res;
 	int error = 0;
@@ -3192,11 +3747,13 @@ resolve_indirect_resources(node_info **nodes)
 	if (nodes == NULL)
 		return 0;
 
+	init_indirect_lookup(lk, nodes);
+
 	for (i = 0; nodes[i] != NULL; i++) {
 		cur_res = nodes[i]->res;
 		while (cur_res != NULL) {
 			if (cur_res->indirect_vnode_name) {
-				cur_res->indirect_res = find_indirect_resource(cur_res, nodes);
+				cur_res->indirect_res = find_indirect_resource_lk(cur_res, lk);
 				if (cur_res->indirect_res == NULL)
 					error = 1;
 			}
@@ -3210,6 +3767,42 @@ resolve_indirect_resources(node_info **nodes)
 	return 1;
 }
 
+/**
+ * @brief
+ * 		bind_indirect_resources - bind the resolved indirect resources of a
+ *		node array to the node_ind of their target vnodes.  Called once the
+ *		nodes have their node_ind, so the copies made by dup_nodes() find
+ *		their targets by index.
+ *
+ * @param[in,out]	nodes	-	the nodes, with their node_ind set
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+bind_indirect_resources(node_info **nodes)
+{
+	struct indirect_lookup lk;
+	node_info *ninfo;
+	schd_resource *cur_res;
+	int i;
+
+	if (nodes == NULL)
+		return;
+
+	init_indirect_lookup(lk, nodes);
+
+	for (i = 0; nodes[i] != NULL; i++) {
+		for (cur_res = nodes[i]->res; cur_res != NULL; cur_res = cur_res->next) {
+			if (cur_res->indirect_vnode_name == NULL || cur_res->indirect_res == NULL)
+				continue;
+			if ((ninfo = find_indirect_node(lk, cur_res)) != NULL)
+				cur_res->indirect_node_ind = ninfo->node_ind;
+		}
+	}
+}
+
 /**
  * @brief
  * 		update_preemption_priority - update preemption status when a
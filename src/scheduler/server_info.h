@@ -88,6 +88,11 @@ schd_resource *find_resource_by_str(schd_resource *reslist, const char *name);
  */
 schd_resource *find_resource(schd_resource *reslist, resdef *def);
 
+/*
+ *	index a resource list by resource definition for find_resource()
+ */
+int index_resource_list(schd_resource *reslist);
+
 /*
  *	free_server_info - free the space used by a server_info structure
  */
@@ -394,6 +399,12 @@ schd_resource *find_indirect_resource(schd_resource *res, node_info **nodes);
  */
 int resolve_indirect_resources(node_info **nodes);
 
+/*
+ *	bind_indirect_resources - bind indirect resources to the node_ind of
+ *				  their target vnodes
+ */
+void bind_indirect_resources(node_info **nodes);
+
 /*
  *	read_formula - read the formula from a well known file
  *
@@ -57,6 +57,7 @@
  * 	find_timed_event()
  * 	perform_event()
  * 	exists_run_event()
+ * 	earliest_free_time()
  * 	calc_run_time()
  * 	create_event_list()
  * 	create_events()
@@ -69,6 +70,9 @@
  * 	dup_timed_event_list()
  * 	free_timed_event()
  * 	free_timed_event_list()
+ * 	index_event_list()
+ * 	insert_timed_event()
+ * 	unindex_timed_event()
  * 	add_event()
  * 	add_timed_event()
  * 	delete_event()
@@ -81,11 +85,15 @@
  * 	policy_change_info()
  * 	describe_simret()
  * 	add_prov_event()
+ * 	add_prov_events()
  * 	generic_sim()
  *
  */
 #include <pbs_config.h>
 
+#include <map>
+#include <new>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -109,6 +117,7 @@
 #include "globals.h"
 #include "check.h"
 #include "buckets.h"
+#include "resource.h"
 #ifdef NAS /* localmod 030 */
 #include "site_code.h"
 #endif /* localmod 030 */
@@ -681,6 +690,155 @@ exists_resv_event(event_list *calendar, time_t end)
 	return 0;
 }
 
+/*
+ * One consumable resource a job needs from the nodes along with an upper
+ * bound of how much of it the nodes will have free.
+ */
+struct free_resource_bound {
+	resdef *def;
+	sch_resource_t needed;	/* total amount requested across all chunks */
+	sch_resource_t free;	/* upper bound of the amount free on the nodes */
+};
+
+/**
+ * @brief
+ *		find the earliest time the nodes could have enough free consumable
+ *		resources to run a job.
+ *
+ * @par
+ *		The free amount of each resource across the nodes only goes up when
+ *		an object which is running now ends.  Anything which starts in the
+ *		future ends in the future as well, so it can only lower the free
+ *		amount.  Walking the end events of the running objects in the calendar
+ *		gives an upper bound of the free resources over time.  The job can
+ *		not fit on the nodes before this bound covers its request, so the
+ *		simulation does not need to ask is_ok_to_run() before then.
+ *
+ * @param[in]	sinfo	-	the server being simulated
+ * @param[in]	resresv	-	the job to find the time for
+ *
+ * @return	time_t
+ * @retval	the earliest time the job could fit on the nodes
+ * @retval	sinfo->server_time	: if any time could work
+ */
+static time_t
+earliest_free_time(server_info *sinfo, resource_resv *resresv)
+{
+	std::vector<free_resource_bound> bounds;
+	resdef **checklist;
+	timed_event *te;
+	time_t last_release;
+	int check_down;
+	int i, j, k;
+
+	if (resresv->job == NULL || resresv->job->resv != NULL ||
+	    resresv->job->resv_id != NULL || resresv->select == NULL ||
+	    resresv->select->chunks == NULL || sinfo->nodes == NULL ||
+	    sinfo->calendar == NULL || sinfo->calendar->next_event == NULL)
+		return sinfo->server_time;
+
+	checklist = sinfo->policy->resdef_to_check;
+	for (i = 0; resresv->select->chunks[i] != NULL; i++) {
+		chunk *chk = resresv->select->chunks[i];
+		resource_req *req;
+
+		for (req = chk->req; req != NULL; req = req->next) {
+			if (!req->type.is_consumable || req->amount <= 0)
+				continue;
+			if (checklist != NULL && !resdef_exists_in_array(checklist, req->def))
+				continue;
+			for (j = 0; j < (int) bounds.size() && bounds[j].def != req->def; j++)
+				;
+			if (j == (int) bounds.size())
+				bounds.push_back({req->def, 0, 0});
+			bounds[j].needed += req->amount * chk->num_chunks;
+		}
+	}
+
+	/* Nodes which are down now can only come back through a provisioning node up event */
+	check_down = 1;
+	for (te = sinfo->calendar->next_event; te != NULL; te = te->next) {
+		if (te->event_type == TIMED_NODE_UP_EVENT) {
+			check_down = 0;
+			break;
+		}
+	}
+
+	for (j = 0; j < (int) bounds.size(); ) {
+		int drop = 0;
+
+		for (i = 0; sinfo->nodes[i] != NULL && !drop; i++) {
+			node_info *ninfo = sinfo->nodes[i];
+			schd_resource *res;
+
+			if (check_down && (ninfo->is_down || ninfo->is_offline))
+				continue;
+			res = find_resource(ninfo->res, bounds[j].def);
+			/* unset or infinite resources are not something we can bound */
+			if (res == NULL || res->avail == SCHD_INFINITY_RES)
+				drop = 1;
+			/* an oversubscribed node has nothing free, not less than nothing */
+			else if (res->indirect_res == NULL && res->avail > res->assigned)
+				bounds[j].free += res->avail - res->assigned;
+		}
+		if (drop || bounds[j].free >= bounds[j].needed)
+			bounds.erase(bounds.begin() + j);
+		else
+			j++;
+	}
+
+	if (bounds.empty())
+		return sinfo->server_time;
+
+	last_release = sinfo->server_time;
+	for (te = sinfo->calendar->next_event; te != NULL; te = te->next) {
+		resource_resv *rr;
+		int satisfied = 1;
+
+		if (te->disabled || te->event_type != TIMED_END_EVENT)
+			continue;
+		rr = (resource_resv *) te->event_ptr;
+		if (rr == NULL || rr->nspec_arr == NULL)
+			continue;
+		if (rr->is_job) {
+			if (rr->job == NULL || !rr->job->is_running || rr->job->resv != NULL)
+				continue;
+		} else if (rr->is_resv) {
+			if (rr->resv == NULL || !rr->resv->is_running)
+				continue;
+		} else
+			continue;
+
+		for (i = 0; rr->nspec_arr[i] != NULL; i++) {
+			resource_req *req;
+			node_info *ninfo = rr->nspec_arr[i]->ninfo;
+
+			if (check_down && ninfo != NULL && (ninfo->is_down || ninfo->is_offline))
+				continue;
+			for (req = rr->nspec_arr[i]->resreq; req != NULL; req = req->next) {
+				for (k = 0; k < (int) bounds.size(); k++) {
+					if (bounds[k].def == req->def) {
+						bounds[k].free += req->amount;
+						break;
+					}
+				}
+			}
+		}
+		last_release = te->event_time;
+
+		for (k = 0; k < (int) bounds.size() && satisfied; k++)
+			if (bounds[k].free < bounds[k].needed)
+				satisfied = 0;
+		if (satisfied)
+			return te->event_time;
+	}
+
+	/* The job never fits on the nodes.  Check it once after the last release
+	 * so the reason it can't run is reported.
+	 */
+	return last_release;
+}
+
 /**
  * @brief
  * 		calculate the run time of a resresv through simulation of
@@ -715,6 +873,7 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	nspec **ns = NULL;
 	unsigned int ok_flags = NO_ALLPART;
 	queue_info *qinfo = NULL;
+	time_t free_time;		/* the earliest time resresv could fit on the nodes */
 
 	if (name == NULL || sinfo == NULL)
 		return (time_t) -1;
@@ -738,13 +897,19 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	if(err == NULL)
 		return (time_t) 0;
 
+	free_time = earliest_free_time(sinfo, resresv);
+
 	do {
 		/* policy is used from sinfo instead of being passed into calc_run_time()
 		 * because it's being simulated/updated in simulate_events()
 		 */
 
 		desc = describe_simret(ret);
-		if (desc > 0 || (desc == 0 && policy_change_info(sinfo, resresv))) {
+		if (event_time < free_time)
+			desc = -1;
+		else if (desc == 0 && policy_change_info(sinfo, resresv))
+			desc = 1;
+		if (desc > 0) {
 			clear_schd_error(err);
 			ns = is_ok_to_run(sinfo->policy, sinfo, qinfo, resresv, ok_flags, err);
 		}
@@ -816,6 +981,126 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	return event_time;
 }
 
+/*
+ * The calendar is a doubly linked list sorted by time.  To keep inserts
+ * from having to walk the list, it is indexed by a map of each distinct
+ * event time to the first event at that time, plus the last event in the
+ * list.  Inserting, deleting and finding the first event at a time are
+ * logarithmic in the number of distinct event times.
+ */
+struct event_time_index {
+	std::map<time_t, timed_event *> first;	/* first event at each time */
+	timed_event *last;			/* last event in the list */
+};
+
+/**
+ * @brief
+ * 		build the time index of an event_list from its events
+ *
+ * @param[in,out]	elist	-	event list to index
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure (the event list is left without an index)
+ */
+static int
+index_event_list(event_list *elist)
+{
+	timed_event *te;
+
+	delete elist->time_index;
+	elist->time_index = new (std::nothrow) event_time_index;
+	if (elist->time_index == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	elist->time_index->last = NULL;
+
+	for (te = elist->events; te != NULL; te = te->next) {
+		/* events are sorted, so the new time always goes at the end */
+		if (te->prev == NULL || te->prev->event_time != te->event_time)
+			elist->time_index->first.emplace_hint(elist->time_index->first.end(), te->event_time, te);
+		elist->time_index->last = te;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		insert an event into a sorted list of events using its time index.
+ *		This is the indexed version of add_timed_event()
+ *
+ * @note
+ *		ASSUMPTION: if multiple events are at the same time, all
+ *		    end events will come first
+ *
+ * @param[in,out]	idx	-	time index of the list
+ * @param[in]	events	-	event list to add event to
+ * @param[in]	te	-	timed_event to add to list
+ *
+ * @return	head of timed_event list
+ */
+static timed_event *
+insert_timed_event(event_time_index *idx, timed_event *events, timed_event *te)
+{
+	std::map<time_t, timed_event *>::iterator it;
+	timed_event *next;
+	timed_event *prev;
+
+	/* end events go before every other event at the same time */
+	if (te->event_type == TIMED_END_EVENT)
+		it = idx->first.lower_bound(te->event_time);
+	else
+		it = idx->first.upper_bound(te->event_time);
+
+	next = (it == idx->first.end()) ? NULL : it->second;
+	prev = (next == NULL) ? idx->last : next->prev;
+
+	te->prev = prev;
+	te->next = next;
+	if (prev != NULL)
+		prev->next = te;
+	else
+		events = te;
+	if (next != NULL)
+		next->prev = te;
+	else
+		idx->last = te;
+
+	if (next != NULL && next->event_time == te->event_time)
+		it->second = te;
+	else if (prev == NULL || prev->event_time != te->event_time)
+		idx->first.emplace_hint(it, te->event_time, te);
+
+	return events;
+}
+
+/**
+ * @brief
+ * 		remove an event from the time index of its list.  The event
+ *		is not unlinked from the list.
+ *
+ * @param[in,out]	idx	-	time index of the list
+ * @param[in]	te	-	timed_event being removed
+ *
+ * @return	void
+ */
+static void
+unindex_timed_event(event_time_index *idx, timed_event *te)
+{
+	auto it = idx->first.find(te->event_time);
+
+	if (it != idx->first.end() && it->second == te) {
+		if (te->next != NULL && te->next->event_time == te->event_time)
+			it->second = te->next;
+		else
+			idx->first.erase(it);
+	}
+	if (idx->last == te)
+		idx->last = te->prev;
+}
+
 /**
  * @brief
  * 		create an event_list from running jobs and confirmed resvs
@@ -835,6 +1120,7 @@ create_event_list(server_info *sinfo)
 		return NULL;
 
 	elist->events = create_events(sinfo);
+	index_event_list(elist);
 
 	elist->next_event = elist->events;
 	elist->first_run_event = find_timed_event(elist->events, 0, NULL, TIMED_RUN_EVENT, 0);
@@ -865,6 +1151,9 @@ create_events(server_info *sinfo)
 	time_t 		end = 0;
 	resource_resv	**all_resresv_copy;
 	int		all_resresv_len;
+	event_time_index idx;
+
+	idx.last = NULL;
 
 	/* create a temporary copy of all_resresv array which is sorted such that
 	 * the timed events are in the front of the array.
@@ -892,7 +1181,7 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			events = insert_timed_event(&idx, events, te);
 		}
 
 		if (sinfo->use_hard_duration)
@@ -904,7 +1193,7 @@ create_events(server_info *sinfo)
 			errflag++;
 			break;
 		}
-		events = add_timed_event(events, te);
+		events = insert_timed_event(&idx, events, te);
 	}
 
 	/* for nodes that are in state=sleep add a timed event */
@@ -917,7 +1206,7 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			events = insert_timed_event(&idx, events, te);
 		}
 	}
 
@@ -954,6 +1243,7 @@ new_event_list()
 	elist->next_event = NULL;
 	elist->first_run_event = NULL;
 	elist->current_time = NULL;
+	elist->time_index = NULL;
 
 	return elist;
 }
@@ -991,6 +1281,8 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 			return NULL;
 		}
 	}
+	if (oelist->time_index != NULL)
+		index_event_list(nelist);
 
 	if (oelist->next_event != NULL) {
 		nelist->next_event = find_timed_event(nelist->events, 0,
@@ -1035,6 +1327,7 @@ free_event_list(event_list *elist)
 		return;
 
 	free_timed_event_list(elist->events);
+	delete elist->time_index;
 	free(elist);
 }
 
@@ -1431,7 +1724,10 @@ add_event(event_list *calendar, timed_event *te)
 	if (calendar->events == NULL)
 		events_is_null = 1;
 
-	calendar->events = add_timed_event(calendar->events, te);
+	if (calendar->time_index != NULL)
+		calendar->events = insert_timed_event(calendar->time_index, calendar->events, te);
+	else
+		calendar->events = add_timed_event(calendar->events, te);
 
 	/* empty event list - the new event is the only event */
 	if (events_is_null)
@@ -1444,9 +1740,12 @@ add_event(event_list *calendar, timed_event *te)
 			if (te->event_time < calendar->next_event->event_time)
 				calendar->next_event = te;
 			else if (te->event_time == calendar->next_event->event_time) {
-				calendar->next_event =
-					find_timed_event(calendar->events, 0, NULL,
-					TIMED_NOEVENT, te->event_time);
+				if (calendar->time_index != NULL)
+					calendar->next_event = calendar->time_index->first[te->event_time];
+				else
+					calendar->next_event =
+						find_timed_event(calendar->events, 0, NULL,
+						TIMED_NOEVENT, te->event_time);
 			}
 		}
 	}
@@ -1542,8 +1841,12 @@ delete_event(server_info *sinfo, timed_event *e)
 	if (calendar->next_event == e)
 		calendar->next_event = e->next;
 
+	/* there are no run events before the first one, so start from e */
 	if (calendar->first_run_event == e)
-		calendar->first_run_event = find_timed_event(calendar->events, 0, NULL, TIMED_RUN_EVENT, 0);
+		calendar->first_run_event = find_timed_event(e->next, 0, NULL, TIMED_RUN_EVENT, 0);
+
+	if (calendar->time_index != NULL)
+		unindex_timed_event(calendar->time_index, e);
 
 	if (e->prev == NULL)
 		calendar->events = e->next;
@@ -2014,6 +2317,36 @@ add_prov_event(event_list *calendar, time_t event_time, node_info *node)
 	return 1;
 }
 
+/**
+ * @brief
+ * 		adds the events for bringing back up all the nodes a job or
+ *		reservation provisions.  They all come up at the same time.
+ *
+ * @param[in] calendar 		- event list to add events to
+ * @param[in] event_time 	- time of the events
+ * @param[in] ns_arr 		- the nspecs of the job, only the ones to provision are looked at
+ *
+ * @return	success/failure
+ * @retval 	1 : on sucess
+ * @retval 	0 : in failure/error
+ */
+int
+add_prov_events(event_list *calendar, time_t event_time, nspec **ns_arr)
+{
+	int i;
+
+	if (calendar == NULL || ns_arr == NULL)
+		return 0;
+
+	for (i = 0; ns_arr[i] != NULL; i++) {
+		if (ns_arr[i]->go_provision &&
+			add_prov_event(calendar, event_time, ns_arr[i]->ninfo) == 0)
+			return 0;
+	}
+
+	return 1;
+}
+
 /**
  * @brief
  * 		generic simulation function which will call a function pointer over
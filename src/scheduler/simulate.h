@@ -437,6 +437,11 @@ int describe_simret(unsigned int simret);
  */
 int add_prov_event(event_list *calendar, time_t event_time, node_info *node);
 
+/*
+ *       adds the events for bringing back up all the nodes a job provisions
+ */
+int add_prov_events(event_list *calendar, time_t event_time, nspec **ns_arr);
+
 /*
  * generic simulation function which will call a function pointer over
  * a calendar from now to an end time.  The simulation will continue
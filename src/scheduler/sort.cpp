@@ -58,6 +58,8 @@
  * 	multi_sort()
  * 	cmp_job_sort_formula()
  * 	multi_node_sort()
+ * 	resort_nodes()
+ * 	sort_nodes()
  * 	multi_nodepart_sort()
  * 	resresv_sort_cmp()
  * 	node_sort_cmp()
@@ -69,6 +71,7 @@
  * 	cmp_aoe()
  * 	cmp_job_preemption_time_asc()
  * 	cmp_starving_jobs()
+ * 	sort_jobs_prefix()
  * 	sort_jobs()
  * 	swapfunc()
  * 	med3()
@@ -77,6 +80,7 @@
  */
 #include <pbs_config.h>
 
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -92,8 +96,10 @@
 #include "node_info.h"
 #include "check.h"
 #include "constant.h"
+#include "config.h"
 #include "server_info.h"
 #include "resource.h"
+#include "profile.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -383,7 +389,7 @@ cmp_fairshare(const void *j1, const void *j2)
 	resource_resv *r2 = *(resource_resv**)j2;
 	if (r1->job != NULL && r1->job->ginfo != NULL &&
 		r2->job != NULL && r2->job->ginfo != NULL)
-		return compare_path(r1->job->ginfo->gpath , r2->job->ginfo->gpath);
+		return r1->job->ginfo->fs_rank - r2->job->ginfo->fs_rank;
 
 	return 0;
 }
@@ -492,6 +498,137 @@ cmp_preemption(resource_resv *r1, resource_resv *r2)
  * repeat for all keys
  */
 
+/* Generation of the job sort in progress.  sort_job_array() sets the sort
+ * keys of the jobs it sorts under a new generation and moves past it when
+ * done, so multi_sort() only trusts keys set for the sort calling it.
+ */
+static unsigned long job_sort_keys_gen = 0;
+
+/**
+ * @brief
+ *		compare two values of a sort key
+ *
+ * @param[in]	v1	-	first value
+ * @param[in]	v2	-	second value
+ * @param[in]	order	-	ASC or DESC
+ *
+ * @return int
+ * @retval -1, 0, 1 : standard qsort() cmp
+ */
+static int
+cmp_sort_value(sch_resource_t v1, sch_resource_t v2, enum sort_order order)
+{
+	if (v1 == v2)
+		return 0;
+
+	if (order == ASC) {
+		if (v1 < v2)
+			return -1;
+		else
+			return 1;
+	}
+	else {
+		if (v1 < v2)
+			return 1;
+		else
+			return -1;
+	}
+}
+
+/**
+ * @brief
+ *		set the job_sort_key values of jobs about to be sorted, so
+ *		multi_sort() compares numbers instead of looking the resources
+ *		up on every comparison.
+ *
+ * @param[in,out]	jobs	-	the jobs
+ * @param[in]	num_jobs	-	number of jobs
+ *
+ * @return void
+ */
+static void
+set_job_sort_keys(resource_resv **jobs, int num_jobs)
+{
+	resource_resv *resresv;
+	int num_keys;
+	int i, j;
+
+	job_sort_keys_gen++;
+
+	for (num_keys = 0; num_keys <= MAX_SORTS && cstat.sort_by[num_keys].res_name != NULL; num_keys++)
+		;
+	if (num_keys == 0)
+		return;
+
+	for (i = 0; i < num_jobs; i++) {
+		resresv = jobs[i];
+		/* cstat.sort_by does not change during the life of a job */
+		if (resresv->sort_keys == NULL) {
+			resresv->sort_keys = static_cast<sch_resource_t *>(malloc(num_keys * sizeof(sch_resource_t)));
+			if (resresv->sort_keys == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				continue;
+			}
+		}
+		for (j = 0; j < num_keys; j++)
+			resresv->sort_keys[j] = find_resresv_amount(resresv, cstat.sort_by[j].res_name, cstat.sort_by[j].def);
+		resresv->sort_keys_gen = job_sort_keys_gen;
+	}
+}
+
+/**
+ * @brief
+ *		std::partial_sort() wrapper for cmp_sort()
+ */
+static bool
+cmp_sort_less(resource_resv *r1, resource_resv *r2)
+{
+	return cmp_sort(&r1, &r2) < 0;
+}
+
+/**
+ * @brief
+ *		sort the first jobs of a job array with cmp_sort() using
+ *		precomputed sort keys
+ *
+ * @param[in,out]	jobs	-	the jobs
+ * @param[in]	num_jobs	-	number of jobs
+ * @param[in]	num_first	-	only put this many first jobs in order,
+ *					the rest are left behind them unsorted
+ *
+ * @return void
+ */
+static void
+partial_sort_job_array(resource_resv **jobs, int num_jobs, int num_first)
+{
+	if (jobs == NULL || num_jobs < 2)
+		return;
+
+	set_job_sort_keys(jobs, num_jobs);
+
+	if (num_first < num_jobs)
+		std::partial_sort(jobs, jobs + num_first, jobs + num_jobs, cmp_sort_less);
+	else
+		qsort(jobs, num_jobs, sizeof(resource_resv *), cmp_sort);
+
+	/* the job values can change once the sort is done */
+	job_sort_keys_gen++;
+}
+
+/**
+ * @brief
+ *		sort a job array with cmp_sort() using precomputed sort keys
+ *
+ * @param[in,out]	jobs	-	the jobs
+ * @param[in]	num_jobs	-	number of jobs
+ *
+ * @return void
+ */
+static void
+sort_job_array(resource_resv **jobs, int num_jobs)
+{
+	partial_sort_job_array(jobs, num_jobs, num_jobs);
+}
 
 /**
  * @brief
@@ -509,6 +646,15 @@ multi_sort(resource_resv *r1, resource_resv *r2)
 	int ret = 0;
 	int i;
 
+	/* sort_job_array() set the keys of both jobs for this sort */
+	if (r1 != NULL && r2 != NULL && r1->sort_keys_gen != 0 &&
+		r1->sort_keys_gen == job_sort_keys_gen && r2->sort_keys_gen == job_sort_keys_gen) {
+		for (i = 0; i <= MAX_SORTS && ret == 0 && cstat.sort_by[i].res_name != NULL; i++)
+			ret = cmp_sort_value(r1->sort_keys[i], r2->sort_keys[i], cstat.sort_by[i].order);
+
+		return ret;
+	}
+
 	for (i = 0; i <= MAX_SORTS && ret == 0 && cstat.sort_by[i].res_name != NULL; i++)
 		ret = resresv_sort_cmp(r1, r2, &cstat.sort_by[i]);
 
@@ -560,6 +706,95 @@ multi_node_sort(const void *n1, const void *n2)
 	return ret;
 }
 
+/**
+ * @brief
+ *		resort_nodes - sort a node array with multi_node_sort() that was
+ *		sorted before some of its nodes' sort keys changed.
+ *
+ * @par
+ *		Running or ending a job only changes the nodes it ran on, which leaves
+ *		the rest of the array in order.  Instead of a full qsort(), the nodes
+ *		which are out of place are taken out in one pass and put back with a
+ *		binary search.  If too many are out of place, qsort() is used.
+ *
+ * @param[in,out]	nodes	-	the node array to sort
+ * @param[in]	num_nodes	-	the number of nodes in the array
+ *
+ * @return void
+ */
+void
+resort_nodes(node_info **nodes, int num_nodes)
+{
+	node_info **moved;
+	node_info *ninfo;
+	int max_moved;
+	int num_moved = 0;
+	int kept = 0;
+	int lo, hi, mid;
+	int i, j;
+
+	if (nodes == NULL || num_nodes < 2)
+		return;
+
+	max_moved = num_nodes / RESORT_NODES_FRACTION;
+	if (max_moved == 0) {
+		sort_nodes(nodes, num_nodes);
+		return;
+	}
+
+	moved = static_cast<node_info **>(malloc(max_moved * sizeof(node_info *)));
+	if (moved == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		qsort(nodes, num_nodes, sizeof(node_info *), multi_node_sort);
+		return;
+	}
+
+	/* Keep the nodes which are in order in front of the array.  A node is
+	 * out of place if it sorts before the last node kept, or after the next
+	 * node when that one is in order with the last node kept.
+	 */
+	for (i = 0; i < num_nodes; i++) {
+		ninfo = nodes[i];
+		if ((kept > 0 && multi_node_sort(&nodes[kept - 1], &ninfo) > 0) ||
+			(i + 1 < num_nodes && multi_node_sort(&ninfo, &nodes[i + 1]) > 0 &&
+			(kept == 0 || multi_node_sort(&nodes[kept - 1], &nodes[i + 1]) <= 0))) {
+			if (num_moved == max_moved) {
+				/* put the array back together and sort it all */
+				memcpy(&nodes[kept], moved, num_moved * sizeof(node_info *));
+				free(moved);
+				sort_nodes(nodes, num_nodes);
+				return;
+			}
+			moved[num_moved++] = ninfo;
+		} else
+			nodes[kept++] = ninfo;
+	}
+
+	if (num_moved > 1)
+		sort_nodes(moved, num_moved);
+
+	/* Insert the moved nodes from the last one down.  The kept nodes after
+	 * the insertion point move up by the number of moved nodes left.
+	 */
+	i = kept;
+	for (j = num_moved - 1; j >= 0; j--) {
+		lo = 0;
+		hi = i;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if (multi_node_sort(&nodes[mid], &moved[j]) > 0)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		memmove(&nodes[lo + j + 1], &nodes[lo], (i - lo) * sizeof(node_info *));
+		nodes[lo + j] = moved[j];
+		i = lo;
+	}
+
+	free(moved);
+}
+
 
 /**
  * @brief
@@ -636,21 +871,79 @@ resresv_sort_cmp(resource_resv *r1, resource_resv *r2, struct sort_info *si)
 	v1 = find_resresv_amount(r1, si->res_name, si->def);
 	v2 = find_resresv_amount(r2, si->res_name, si->def);
 
-	if (v1 == v2)
+	return cmp_sort_value(v1, v2, si->order);
+}
+
+/**
+ * @brief
+ * 		return the value of a node resource based on res_type
+ *
+ * @param[in] nres 		- the node's resource
+ * @param[in] res_type 	- type of resource value to use
+ *
+ * @return sch_resource_t
+ * @retval	0	: error
+ */
+static sch_resource_t
+node_res_amount(schd_resource *nres, enum resource_fields res_type)
+{
+	if(nres -> indirect_res != NULL)
+		nres = nres -> indirect_res;
+	if (res_type == RF_AVAIL)
+		return nres->avail;
+	else if (res_type == RF_ASSN)
+		return nres->assigned;
+	else if (res_type == RF_UNUSED)
+		return nres->avail - nres->assigned;
+	else /* error */
 		return 0;
+}
 
-	if (si->order == ASC) {
-		if (v1 < v2)
-			return -1;
-		else
-			return 1;
-	}
-	else {
-		if (v1 < v2)
-			return 1;
-		else
-			return -1;
+/**
+ * @brief
+ * 		return the value of a node_sort_key for a node.  The node's
+ *		resources for the keys are looked up once and kept in the node,
+ *		their values change as jobs are placed so they are read each time.
+ *
+ * @param[in] ninfo 	- node
+ * @param[in] si 		- the sort key
+ *
+ * @return sch_resource_t
+ * @retval	0	: error
+ */
+static sch_resource_t
+find_node_sort_amount(node_info *ninfo, struct sort_info *si)
+{
+	schd_resource *nres;
+	int num_keys;
+	int key;
+
+	/* special case sort keys and keys other than node_sort_key */
+	if (si->def == NULL || si < cstat.node_sort || si > &cstat.node_sort[MAX_SORTS])
+		return find_node_amount(ninfo, si->res_name, si->def, si->res_type);
+
+	key = si - cstat.node_sort;
+	if (ninfo->sort_res == NULL) {
+		/* cstat.node_sort does not change during the life of a node */
+		for (num_keys = 0; num_keys <= MAX_SORTS && cstat.node_sort[num_keys].res_name != NULL; num_keys++)
+			;
+		if (key >= num_keys)
+			return find_node_amount(ninfo, si->res_name, si->def, si->res_type);
+		ninfo->sort_res = static_cast<schd_resource **>(calloc(num_keys, sizeof(schd_resource *)));
+		if (ninfo->sort_res == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return find_node_amount(ninfo, si->res_name, si->def, si->res_type);
+		}
 	}
+
+	/* resources are only added to a node, so a found resource stays valid */
+	if (ninfo->sort_res[key] == NULL)
+		ninfo->sort_res[key] = find_resource(ninfo->res, si->def);
+	nres = ninfo->sort_res[key];
+	if (nres == NULL)
+		return 0;
+
+	return node_res_amount(nres, si->res_type);
 }
 
 /**
@@ -695,8 +988,8 @@ node_sort_cmp(const void *vp1, const void *vp2, struct sort_info *si, enum sort_
 		case SOBJ_NODE:
 			n1 = (node_info **) vp1;
 			n2 = (node_info **) vp2;
-			v1 = find_node_amount(*n1, si->res_name, si->def, si->res_type);
-			v2 = find_node_amount(*n2, si->res_name, si->def, si->res_type);
+			v1 = find_node_sort_amount(*n1, si);
+			v2 = find_node_sort_amount(*n2, si);
 			rank1 = (*n1)->rank;
 			rank2 = (*n2)->rank;
 			break;
@@ -750,6 +1043,84 @@ node_sort_cmp(const void *vp1, const void *vp2, struct sort_info *si, enum sort_
 	}
 }
 
+/* a node and the values of its node_sort_keys, see sort_nodes() */
+struct node_sort_entry {
+	sch_resource_t key[MAX_SORTS + 1];
+	node_info *ninfo;
+};
+
+/* multi_node_sort() order of node_sort_entry structures */
+struct node_sort_entry_less {
+	int num_keys;
+
+	bool operator()(const node_sort_entry &e1, const node_sort_entry &e2) const
+	{
+		int i;
+
+		for (i = 0; i < num_keys; i++) {
+			if (e1.key[i] == e2.key[i])
+				continue;
+			if (cstat.node_sort[i].order == ASC)
+				return e1.key[i] < e2.key[i];
+			return e1.key[i] > e2.key[i];
+		}
+		return false;
+	}
+};
+
+/**
+ * @brief
+ *		sort_nodes - sort a node array in multi_node_sort() order.
+ *
+ * @par
+ *		A qsort() with multi_node_sort() looks each sort key up in both
+ *		nodes on every compare, which touches the node, its sort_res array
+ *		and the resource for every key each time.  Here the key values are
+ *		read once per node into a flat table and the table is sorted.  Like
+ *		the qsort() it replaces the sort is stable.
+ *
+ * @param[in,out]	nodes	-	the node array to sort
+ * @param[in]	num_nodes	-	the number of nodes in the array
+ *
+ * @return void
+ */
+void
+sort_nodes(node_info **nodes, int num_nodes)
+{
+	node_sort_entry *entries;
+	node_sort_entry_less less;
+	int i, k;
+
+	if (nodes == NULL || num_nodes < 2)
+		return;
+
+	for (less.num_keys = 0; less.num_keys <= MAX_SORTS &&
+		cstat.node_sort[less.num_keys].res_name != NULL; less.num_keys++)
+		;
+	if (less.num_keys == 0)
+		return;
+
+	entries = static_cast<node_sort_entry *>(malloc(num_nodes * sizeof(node_sort_entry)));
+	if (entries == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		qsort(nodes, num_nodes, sizeof(node_info *), multi_node_sort);
+		return;
+	}
+
+	for (i = 0; i < num_nodes; i++) {
+		entries[i].ninfo = nodes[i];
+		for (k = 0; k < less.num_keys; k++)
+			entries[i].key[k] = find_node_sort_amount(nodes[i], &cstat.node_sort[k]);
+	}
+
+	std::stable_sort(entries, entries + num_nodes, less);
+
+	for (i = 0; i < num_nodes; i++)
+		nodes[i] = entries[i].ninfo;
+
+	free(entries);
+}
+
 /**
  * @brief
  * 		entrypoint into job sort used by qsort
@@ -937,18 +1308,8 @@ find_node_amount(node_info *ninfo, char *res, resdef *def,
 		schd_resource*nres;
 		nres = find_resource(ninfo->res, def);
 
-		if (nres != NULL) {
-			if(nres -> indirect_res != NULL)
-				nres = nres -> indirect_res;
-			if (res_type == RF_AVAIL)
-				return nres->avail;
-			else if (res_type == RF_ASSN)
-				return nres->assigned;
-			else if (res_type == RF_UNUSED)
-				return nres->avail - nres->assigned;
-			else /* error */
-				return 0;
-		}
+		if (nres != NULL)
+			return node_res_amount(nres, res_type);
 
 	} else if (!strcmp(res, SORT_PRIORITY))
 		return ninfo->priority;
@@ -1231,6 +1592,50 @@ cmp_resv_state(const void *r1, const void *r2)
 		return 0;
 }
 
+/**
+ * @brief
+ *		sort_jobs_prefix - sort the next jobs of a job array which is only
+ *		sorted up to an index.  Jobs are selected on demand instead of
+ *		sorting the whole array when only the first jobs are considered.
+ * @par
+ *		The jobs in front of the index are in cmp_sort() order and sort
+ *		before all the jobs after it.  The next SORT_JOBS_CHUNK jobs, or
+ *		as many as are already sorted if that is more, are selected out of
+ *		the rest and sorted, so sorting the whole array a chunk at a time
+ *		costs about as much as sorting it at once.
+ *
+ * @param[in,out]	jobs	-	the job array
+ * @param[in]	sorted	-	the number of jobs already sorted
+ *
+ * @return	int
+ * @retval	the number of jobs sorted now
+ */
+int
+sort_jobs_prefix(resource_resv **jobs, int sorted)
+{
+	int num_jobs;
+	int chunk;
+
+	if (jobs == NULL)
+		return 0;
+
+	num_jobs = count_array(jobs);
+	if (sorted >= num_jobs)
+		return num_jobs;
+	if (sorted < 0)
+		sorted = 0;
+
+	chunk = sorted > SORT_JOBS_CHUNK ? sorted : SORT_JOBS_CHUNK;
+	if (num_jobs - sorted <= chunk) {
+		sort_job_array(jobs + sorted, num_jobs - sorted);
+		return num_jobs;
+	}
+
+	partial_sort_job_array(jobs + sorted, num_jobs - sorted, chunk);
+
+	return sorted + chunk;
+}
+
 /**
  * @brief
  * 		sort_jobs - This function sorts all jobs according to their preemption
@@ -1251,11 +1656,18 @@ sort_jobs(status *policy, server_info *sinfo)
 	int job_index = 0;
 	int index = 0;
 	int count = 0;
+	double prof = prof_start();
+
+	/* only sorting all jobs at once sorts part of sinfo->jobs */
+	sinfo->jobs_sorted = count_array(sinfo->jobs);
 
 	/** sort jobs in such a way that Higher Priority jobs come on top
 	 * followed by preempted jobs and then starving jobs and normal jobs
 	 */
 	if (policy->fair_share) {
+		/* cmp_fairshare() compares by the ranks of the fairshare tree nodes */
+		rank_fairshare_tree(sinfo->fairshare);
+
 		/** sort per queue basis and then use these jobs (combined from all the queues)
 		 * to select the next job.
 		 */
@@ -1265,8 +1677,7 @@ sort_jobs(status *policy, server_info *sinfo)
 			 */
 			for (; i < sinfo->num_queues; i++) {
 				if (sinfo->queues[i]->sc.total > 0) {
-					qsort(sinfo->queues[i]->jobs, sinfo->queues[i]->sc.total,
-						sizeof(resource_resv*), cmp_sort);
+					sort_job_array(sinfo->queues[i]->jobs, sinfo->queues[i]->sc.total);
 				}
 			}
 			for (count = 0; count != sinfo->num_queues; count++) {
@@ -1277,16 +1688,16 @@ sort_jobs(status *policy, server_info *sinfo)
 			}
 			sinfo->jobs[job_index] = NULL;
 		}
-		/** Sort on entire complex **/
+		/** Sort on entire complex, next_job() sorts the rest on demand **/
 		else if (!policy->by_queue && !policy->round_robin) {
-			qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv *), cmp_sort);
+			sinfo->jobs_sorted = sort_jobs_prefix(sinfo->jobs, 0);
 		}
 	}
 	else if (policy->by_queue) {
 		for (i = 0; i < sinfo->num_queues; i++) {
-			qsort(sinfo->queues[i]->jobs, count_array(sinfo->queues[i]->jobs), sizeof(resource_resv *), cmp_sort);
+			sort_job_array(sinfo->queues[i]->jobs, count_array(sinfo->queues[i]->jobs));
 		}
-		qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sort_job_array(sinfo->jobs, count_array(sinfo->jobs));
 	}
 	else if (policy->round_robin) {
 		if (sinfo -> queue_list != NULL) {
@@ -1297,13 +1708,14 @@ sort_jobs(status *policy, server_info *sinfo)
 				int queue_index_size = count_array(sinfo->queue_list[i]);
 				for (j = 0; j < queue_index_size; j++)
 				{
-				    qsort(sinfo->queue_list[i][j]->jobs, count_array(sinfo->queue_list[i][j]->jobs),
-					    sizeof(resource_resv *), cmp_sort);
+				    sort_job_array(sinfo->queue_list[i][j]->jobs, count_array(sinfo->queue_list[i][j]->jobs));
 				}
 			}
 
 		}
 	}
 	else
-		qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sinfo->jobs_sorted = sort_jobs_prefix(sinfo->jobs, 0);
+
+	prof_stop(PROF_SORT_JOBS, prof);
 }
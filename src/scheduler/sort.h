@@ -151,6 +151,17 @@ int resresv_sort_cmp(resource_resv *r1, resource_resv *r2, struct sort_info *si)
  */
 int multi_node_sort(const void *n1, const void *n2);
 
+/*
+ *      resort_nodes - sort a node array whose nodes were sorted before
+ *                     some of their sort keys changed
+ */
+void resort_nodes(node_info **nodes, int num_nodes);
+
+/*
+ *      sort_nodes - sort a node array in multi_node_sort() order
+ */
+void sort_nodes(node_info **nodes, int num_nodes);
+
 
 /* qsort() compare function for multi-resource node partition sorting */
 int multi_nodepart_sort(const void *n1, const void *n2);
@@ -200,6 +211,11 @@ int cmp_resv_state(const void *r1, const void *r2);
  */
 void sort_jobs(status *policy, server_info *sinfo);
 
+/*
+ * sort_jobs_prefix - sort the next chunk of a partly sorted job array
+ */
+int sort_jobs_prefix(resource_resv **jobs, int sorted);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -48,6 +48,8 @@
  *	acct_open()
  *	acct_record()
  *	acct_close()
+ *	acct_flush()
+ *	acct_json_record()
  */
 
 
@@ -85,6 +87,19 @@ static int acct_opened_day;
 static int acct_auto_switch = 0;
 static char *acct_buf = 0;
 static int acct_bufsize = PBS_ACCT_MAX_RCD;
+
+/* records not written yet, see acct_flush() */
+struct acct_pend {
+	char *ap_buf;
+	size_t ap_len;
+	size_t ap_size;
+};
+static struct acct_pend acct_pend = {NULL, 0, 0};
+
+/* JSON lines copy of the records, see accounting_json */
+static FILE *acct_json = NULL;
+static int acct_json_day = -1;
+static struct acct_pend acct_json_pend = {NULL, 0, 0};
 static const char *do_not_emit_alter[] = {ATTR_estimated, ATTR_used, NULL};
 
 /* Global Data */
@@ -715,7 +730,7 @@ acct_job(const job *pjob, int type, char *buf, int len)
 		cpy_quote_value(pb, pal->al_value);
 		(void)strcat(pb, " ");
 		delete_link(&pal->al_link);
-		(void)free(pal);
+		attrlist_free(pal);
 		pb += strlen(pb);
 	}
 	return (pb);
@@ -905,7 +920,7 @@ acct_resv(resc_resv *presv, char *buf, int len)
 		cpy_quote_value(pb, pal->al_value);
 		(void)strcat(pb, " ");
 		delete_link(&pal->al_link);
-		(void)free(pal);
+		attrlist_free(pal);
 		pb += strlen(pb);
 	}
 	return (pb);
@@ -982,9 +997,408 @@ void
 acct_close()
 {
 	if (acct_opened == 1) {
+		acct_flush();
 		(void)fclose(acctfile);
 		acct_opened = 0;
 	}
+	if (acct_json != NULL) {
+		(void)fclose(acct_json);
+		acct_json = NULL;
+	}
+}
+
+/**
+ * @brief
+ *	Make room for 'need' more bytes in a buffer of pending records.
+ *
+ * @param[in,out]	pp - the pending records
+ * @param[in]	need - bytes to add
+ *
+ * @return	int
+ * @retval	0	- room was made
+ * @retval	-1	- out of memory
+ */
+static int
+acct_pend_room(struct acct_pend *pp, size_t need)
+{
+	char *newbuf;
+	size_t newsize;
+
+	if (pp->ap_len + need <= pp->ap_size)
+		return 0;
+	newsize = pp->ap_len + need + PBS_ACCT_MAX_RCD;
+	if ((newbuf = realloc(pp->ap_buf, newsize)) == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		return -1;
+	}
+	pp->ap_buf = newbuf;
+	pp->ap_size = newsize;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Write a buffer of pending records to its file.
+ *
+ * @param[in,out]	pp - the pending records
+ * @param[in]	fp - the file, may be NULL to drop them
+ *
+ * @return	void
+ */
+static void
+acct_pend_write(struct acct_pend *pp, FILE *fp)
+{
+	if (pp->ap_len == 0)
+		return;
+	if (fp != NULL) {
+		(void)fwrite(pp->ap_buf, 1, pp->ap_len, fp);
+		(void)fflush(fp);
+	}
+	pp->ap_len = 0;
+}
+
+/**
+ * @brief
+ * acct_flush - write out the records kept by write_account_record()
+ *
+ * @par
+ *	Records are gathered in memory and written with one call, once per
+ *	pass of the main loop, rather than each with its own write.  They are
+ *	not left in the stdio buffer, which forked children would write again
+ *	when they exit.
+ *
+ * @return	void
+ */
+void
+acct_flush(void)
+{
+	acct_pend_write(&acct_pend, (acct_opened == 1) ? acctfile : NULL);
+	acct_pend_write(&acct_json_pend, acct_json);
+}
+
+/**
+ * @brief
+ *	Append a string to pending JSON output as a JSON string.
+ *
+ * @param[in,out]	pp - the pending output
+ * @param[in]	str - the string
+ * @param[in]	len - its length
+ *
+ * @return	void
+ */
+static void
+json_add_str(struct acct_pend *pp, const char *str, size_t len)
+{
+	size_t i;
+
+	/* at worst every byte becomes \u00XX */
+	if (acct_pend_room(pp, len * 6 + 3) != 0)
+		return;
+	pp->ap_buf[pp->ap_len++] = '"';
+	for (i = 0; i < len; i++) {
+		unsigned char c = (unsigned char)str[i];
+
+		if (c == '"' || c == '\\') {
+			pp->ap_buf[pp->ap_len++] = '\\';
+			pp->ap_buf[pp->ap_len++] = c;
+		} else if (c < 0x20)
+			pp->ap_len += sprintf(pp->ap_buf + pp->ap_len, "\\u%04x", c);
+		else
+			pp->ap_buf[pp->ap_len++] = c;
+	}
+	pp->ap_buf[pp->ap_len++] = '"';
+}
+
+/**
+ * @brief
+ *	Append raw text to pending JSON output.
+ *
+ * @param[in,out]	pp - the pending output
+ * @param[in]	text - the text
+ *
+ * @return	void
+ */
+static void
+json_add_raw(struct acct_pend *pp, const char *text)
+{
+	size_t len = strlen(text);
+
+	if (acct_pend_room(pp, len + 1) != 0)
+		return;
+	memcpy(pp->ap_buf + pp->ap_len, text, len);
+	pp->ap_len += len;
+}
+
+/**
+ * @brief
+ *	Append an exec_vnode value as an array of
+ *	{"vnode":..., "resources":{...}} objects.
+ *
+ * @param[in,out]	pp - the pending output
+ * @param[in]	val - the exec_vnode string
+ * @param[in]	len - its length
+ *
+ * @return	void
+ */
+static void
+json_add_exec_vnode(struct acct_pend *pp, const char *val, size_t len)
+{
+	const char *end = val + len;
+	const char *p = val;
+	int first = 1;
+
+	json_add_raw(pp, "[");
+	while (p < end) {
+		const char *chunk_end;
+		const char *q;
+		int nres = 0;
+
+		while (p < end && (*p == '(' || *p == '+'))
+			p++;
+		if (p >= end)
+			break;
+		for (chunk_end = p; chunk_end < end && *chunk_end != '+'; chunk_end++)
+			;
+		q = chunk_end;
+		if (q > p && *(q - 1) == ')')
+			q--;
+
+		json_add_raw(pp, first ? "{\"vnode\":" : ",{\"vnode\":");
+		first = 0;
+		{
+			const char *name_end = memchr(p, ':', q - p);
+			const char *r;
+
+			if (name_end == NULL)
+				name_end = q;
+			json_add_str(pp, p, name_end - p);
+			json_add_raw(pp, ",\"resources\":{");
+			r = name_end;
+			while (r < q) {
+				const char *kv_end;
+				const char *eq;
+
+				r++;	/* past ':' */
+				kv_end = memchr(r, ':', q - r);
+				if (kv_end == NULL)
+					kv_end = q;
+				if ((eq = memchr(r, '=', kv_end - r)) != NULL) {
+					if (nres++)
+						json_add_raw(pp, ",");
+					json_add_str(pp, r, eq - r);
+					json_add_raw(pp, ":");
+					json_add_str(pp, eq + 1, kv_end - eq - 1);
+				}
+				r = kv_end;
+			}
+		}
+		json_add_raw(pp, "}}");
+		p = chunk_end;
+	}
+	json_add_raw(pp, "]");
+}
+
+/* one key=value pair of an accounting record text */
+struct acct_kv {
+	const char *kv_key;
+	size_t kv_klen;
+	const char *kv_val;
+	size_t kv_vlen;
+	size_t kv_plen;		/* length of the "prefix." of the key, 0 if none */
+};
+
+#define ACCT_JSON_MAXKV	256
+
+/**
+ * @brief
+ *	Split the text of an accounting record into its key=value pairs.
+ *	Values may be quoted with " or ', see cpy_quote_value().
+ *
+ * @param[in]	text - the record text
+ * @param[out]	kv - the pairs found
+ * @param[in]	max - room in kv
+ *
+ * @return	int
+ * @retval	>=0	- number of pairs
+ * @retval	-1	- text is not a list of key=value pairs
+ */
+static int
+acct_split_kv(const char *text, struct acct_kv *kv, int max)
+{
+	const char *p = text;
+	int n = 0;
+
+	while (*p) {
+		const char *eq;
+		const char *dot;
+
+		while (*p == ' ')
+			p++;
+		if (*p == '\0')
+			break;
+		if (n == max)
+			return -1;
+		for (eq = p; *eq && *eq != '=' && *eq != ' '; eq++)
+			;
+		if (*eq != '=' || eq == p)
+			return -1;
+		kv[n].kv_key = p;
+		kv[n].kv_klen = eq - p;
+		kv[n].kv_plen = 0;
+		if ((dot = memchr(p, '.', eq - p)) != NULL)
+			kv[n].kv_plen = dot - p;
+		p = eq + 1;
+		if (*p == '"' || *p == '\'') {
+			const char *close = strchr(p + 1, *p);
+
+			if (close == NULL)
+				return -1;
+			kv[n].kv_val = p + 1;
+			kv[n].kv_vlen = close - p - 1;
+			p = close + 1;
+		} else {
+			kv[n].kv_val = p;
+			while (*p && *p != ' ')
+				p++;
+			kv[n].kv_vlen = p - kv[n].kv_val;
+		}
+		n++;
+	}
+	return n;
+}
+
+/**
+ * @brief
+ *	Append the value of one pair, exec_vnode as structured data.
+ *
+ * @param[in,out]	pp - the pending output
+ * @param[in]	kv - the pair
+ * @param[in]	key - the key without its prefix
+ * @param[in]	klen - length of key
+ *
+ * @return	void
+ */
+static void
+json_add_kv(struct acct_pend *pp, struct acct_kv *kv, const char *key, size_t klen)
+{
+	json_add_str(pp, key, klen);
+	json_add_raw(pp, ":");
+	if ((klen == strlen(ATTR_execvnode)) && (strncmp(key, ATTR_execvnode, klen) == 0))
+		json_add_exec_vnode(pp, kv->kv_val, kv->kv_vlen);
+	else
+		json_add_str(pp, kv->kv_val, kv->kv_vlen);
+}
+
+/**
+ * @brief
+ *	Add the JSON line of one accounting record to the pending output of
+ *	the accounting_json file.  Pairs with a common "prefix." in their
+ *	key, like resources_used.cput, become members of one object under
+ *	the prefix.  A text that is not a list of pairs is kept as "text".
+ *
+ * @param[in]	ptm - time of the record
+ * @param[in]	acctype - record type
+ * @param[in]	id - record id
+ * @param[in]	text - record text
+ *
+ * @return	void
+ */
+static void
+acct_json_record(struct tm *ptm, int acctype, const char *id, char *text)
+{
+	struct acct_kv kv[ACCT_JSON_MAXKV];
+	struct acct_pend *pp = &acct_json_pend;
+	char head[80];
+	char type[2];
+	int n;
+	int i;
+	int j;
+
+	snprintf(head, sizeof(head),
+		"{\"time\":\"%04d-%02d-%02dT%02d:%02d:%02d\",\"epoch\":%ld,\"type\":",
+		ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday,
+		ptm->tm_hour, ptm->tm_min, ptm->tm_sec, (long)time_now);
+	json_add_raw(pp, head);
+	type[0] = (char)acctype;
+	type[1] = '\0';
+	json_add_str(pp, type, 1);
+	json_add_raw(pp, ",\"id\":");
+	json_add_str(pp, id, strlen(id));
+
+	if ((n = acct_split_kv(text, kv, ACCT_JSON_MAXKV)) < 0) {
+		json_add_raw(pp, ",\"text\":");
+		json_add_str(pp, text, strlen(text));
+		json_add_raw(pp, "}\n");
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (kv[i].kv_key == NULL)
+			continue;	/* already written with its prefix */
+		json_add_raw(pp, ",");
+		if (kv[i].kv_plen == 0) {
+			json_add_kv(pp, &kv[i], kv[i].kv_key, kv[i].kv_klen);
+			continue;
+		}
+		/* all pairs of this prefix go in one object */
+		json_add_str(pp, kv[i].kv_key, kv[i].kv_plen);
+		json_add_raw(pp, ":{");
+		for (j = i; j < n; j++) {
+			size_t plen = kv[i].kv_plen;
+			const char *prefix = kv[i].kv_key;
+
+			if ((kv[j].kv_key == NULL) || (kv[j].kv_plen != plen) ||
+				(strncmp(kv[j].kv_key, prefix, plen) != 0))
+				continue;
+			if (j != i)
+				json_add_raw(pp, ",");
+			json_add_kv(pp, &kv[j], kv[j].kv_key + plen + 1, kv[j].kv_klen - plen - 1);
+			if (j != i)
+				kv[j].kv_key = NULL;
+		}
+		kv[i].kv_key = NULL;
+		json_add_raw(pp, "}");
+	}
+	json_add_raw(pp, "}\n");
+}
+
+/**
+ * @brief
+ *	Open the accounting_json file next to the day's accounting file,
+ *	or close it when accounting_json was unset.
+ *
+ * @param[in]	ptm - time of the record about to be written
+ *
+ * @return	void
+ */
+static void
+acct_json_open(struct tm *ptm)
+{
+	char filen[_POSIX_PATH_MAX];
+
+	if (!(is_attr_set(&server.sv_attr[SVR_ATR_AcctJson]) &&
+		server.sv_attr[SVR_ATR_AcctJson].at_val.at_long)) {
+		if (acct_json != NULL) {
+			acct_pend_write(&acct_json_pend, acct_json);
+			(void)fclose(acct_json);
+			acct_json = NULL;
+		}
+		return;
+	}
+	if ((acct_json != NULL) && (acct_json_day == ptm->tm_yday))
+		return;
+
+	if (acct_json != NULL) {
+		acct_pend_write(&acct_json_pend, acct_json);
+		(void)fclose(acct_json);
+	}
+	snprintf(filen, sizeof(filen), "%s%04d%02d%02d.json", path_acct,
+		ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday);
+	if ((acct_json = fopen(filen, "a")) == NULL) {
+		log_err(errno, __func__, filen);
+		return;
+	}
+	acct_json_day = ptm->tm_yday;
 }
 
 /**
@@ -1000,12 +1414,25 @@ acct_close()
 void
 write_account_record(int acctype, const char *id, char *text)
 {
-	struct tm *ptm;
+	static time_t tm_time = 0;
+	static struct tm tm_now;
+	struct tm *ptm = &tm_now;
+	char	stamp[32];
+	size_t	need;
+	int	len;
+	struct acct_pend *pp = &acct_pend;
 
 	if (acct_opened == 0)
 		return;		/* file not open, don't bother */
 
-	ptm = localtime(&time_now);
+	/* many records share the second they are written in */
+	if ((tm_time != time_now) || (tm_time == 0)) {
+		struct tm *pt;
+
+		if ((pt = localtime(&time_now)) != NULL)
+			tm_now = *pt;
+		tm_time = time_now;
+	}
 
 	/* Do we need to switch files */
 
@@ -1016,11 +1443,26 @@ write_account_record(int acctype, const char *id, char *text)
 	if (text == NULL)
 		text = "";
 
-	(void)fprintf(acctfile,
-		"%02d/%02d/%04d %02d:%02d:%02d;%c;%s;%s\n",
+	len = snprintf(stamp, sizeof(stamp), "%02d/%02d/%04d %02d:%02d:%02d;%c;",
 		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
-		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
-		(char)acctype, id, text);
+		ptm->tm_hour, ptm->tm_min, ptm->tm_sec, (char)acctype);
+	need = len + strlen(id) + strlen(text) + 3;
+
+	if (acct_pend_room(pp, need) != 0) {
+		/* write out what we have and this one directly */
+		acct_flush();
+		(void)fprintf(acctfile, "%s%s;%s\n", stamp, id, text);
+		(void)fflush(acctfile);
+	} else
+		pp->ap_len += sprintf(pp->ap_buf + pp->ap_len, "%s%s;%s\n", stamp, id, text);
+
+	acct_json_open(ptm);
+	if (acct_json != NULL)
+		acct_json_record(ptm, acctype, id, text);
+
+	/* do not sit on a large amount */
+	if ((pp->ap_len > PBS_ACCT_PEND_MAX) || (acct_json_pend.ap_len > PBS_ACCT_PEND_MAX))
+		acct_flush();
 }
 
 /**
@@ -1126,7 +1568,7 @@ account_jobstr(const job *pjob, int type)
 				cpy_quote_value(pb, pal->al_value);
 				strcat(pb, " ");
 				delete_link(&pal->al_link);
-				free(pal);
+				attrlist_free(pal);
 				pb += strlen(pb);
 			}
 		}
@@ -1775,7 +2217,7 @@ build_common_data_for_job_update(const job *pjob, int type, char *buf, int len)
 			cpy_quote_value(pb, pal->al_value);
 			(void)strcat(pb, " ");
 			delete_link(&pal->al_link);
-			(void)free(pal);
+			attrlist_free(pal);
 			pb += strlen(pb);
 		}
 	} else {
@@ -1874,7 +2316,7 @@ build_common_data_for_job_update(const job *pjob, int type, char *buf, int len)
 			cpy_quote_value(pb, pal->al_value);
 			(void)strcat(pb, " ");
 			delete_link(&pal->al_link);
-			(void)free(pal);
+			attrlist_free(pal);
 			pb += strlen(pb);
 		}
 
@@ -68,6 +68,7 @@
 #include "acct.h"
 #include <sys/time.h>
 #include "range.h"
+#include "pbs_idx.h"
 
 
 /* External data */
@@ -434,9 +435,9 @@ chk_array_doneness(job *parent)
 		/* Array Job all done, do simple eoj processing */
 
 		for (e=i=0; i<ptbl->tkm_ct; ++i) {
-			if (ptbl->tkm_tbl[i].trk_error > 0)
+			if (ptbl->tkm_tbl[i].trk_flags & TRKFLG_ERR_POS)
 				e = 1;
-			else if (ptbl->tkm_tbl[i].trk_error < 0) {
+			else if (ptbl->tkm_tbl[i].trk_flags & TRKFLG_ERR_NEG) {
 				e = 2;
 				break;
 			}
@@ -505,17 +506,22 @@ update_subjob_state(job *pjob, char newstate)
 
 	set_subjob_tblstate(parent, pjob->ji_subjindx, newstate);
 	if (newstate == JOB_STATE_LTR_EXPIRED) {
-		ptbl->tkm_tbl[pjob->ji_subjindx].trk_error =
-			pjob->ji_qs.ji_un.ji_exect.ji_exitstat;
+		struct ajtrk *ptrk = &ptbl->tkm_tbl[pjob->ji_subjindx];
+
+		ptrk->trk_flags &= ~(TRKFLG_ERR_POS | TRKFLG_ERR_NEG);
+		if (pjob->ji_qs.ji_un.ji_exect.ji_exitstat > 0)
+			ptrk->trk_flags |= TRKFLG_ERR_POS;
+		else if (pjob->ji_qs.ji_un.ji_exect.ji_exitstat < 0)
+			ptrk->trk_flags |= TRKFLG_ERR_NEG;
 
 		if (svr_chk_history_conf()) {
 			if (is_jattr_set(pjob, JOB_ATR_stageout_status))
-				ptbl->tkm_tbl[pjob->ji_subjindx].trk_stgout = get_jattr_long(pjob, JOB_ATR_stageout_status);
+				ptrk->trk_stgout = get_jattr_long(pjob, JOB_ATR_stageout_status);
 
 			if (is_jattr_set(pjob, JOB_ATR_exit_status))
-				ptbl->tkm_tbl[pjob->ji_subjindx].trk_exitstat = 1;
+				ptrk->trk_flags |= TRKFLG_EXITSTAT;
 		}
-		ptbl->tkm_tbl[pjob->ji_subjindx].trk_substate = get_job_substate(pjob);
+		ptrk->trk_substate = get_job_substate(pjob);
 	}
 	chk_array_doneness(parent);
 }
@@ -533,10 +539,12 @@ update_subjob_state(job *pjob, char newstate)
 int
 get_subjob_discarding(job *parent, int iindx)
 {
+	job *psubjob;
+
 	if (iindx == -1)
 		return -1;
-	if (parent->ji_ajtrk->tkm_tbl[iindx].trk_psubjob)
-		return (parent->ji_ajtrk->tkm_tbl[iindx].trk_psubjob->ji_discarding);
+	if ((psubjob = get_subjob_ptr(parent, iindx)) != NULL)
+		return (psubjob->ji_discarding);
 	return 0;
 }
 /**
@@ -557,6 +565,98 @@ get_subjob_state(job *parent, int iindx)
 		return -1;
 	return (parent->ji_ajtrk->tkm_tbl[iindx].trk_status);
 }
+/**
+ * @brief
+ * 		get_subjob_ptr - return the instantiated subjob at the given
+ * 		offset into the tracking table of the parent job
+ *
+ * @param[in]	parent - pointer to the parent job
+ * @param[in]	offset - offset of the subjob in the table
+ *
+ * @return	job *
+ * @retval	NULL	- subjob is not instantiated
+ */
+job *
+get_subjob_ptr(job *parent, int offset)
+{
+	void *key = &offset;
+	job *psubjob = NULL;
+
+	if (offset == -1 || parent->ji_ajtrk == NULL || parent->ji_ajtrk->tkm_subjobs == NULL)
+		return NULL;
+	if (pbs_idx_find(parent->ji_ajtrk->tkm_subjobs, &key, (void **)&psubjob, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	return psubjob;
+}
+/**
+ * @brief
+ * 		set_subjob_ptr - record (or forget, if subj is NULL) the
+ * 		instantiated subjob at the given offset of the tracking table.
+ * 		Only instantiated subjobs are kept, so the index stays small
+ * 		even for very large arrays.
+ *
+ * @param[in]	parent - pointer to the parent job
+ * @param[in]	offset - offset of the subjob in the table
+ * @param[in]	subj - pointer to the subjob or NULL
+ *
+ * @return	void
+ */
+void
+set_subjob_ptr(job *parent, int offset, job *subj)
+{
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+
+	if (offset == -1 || ptbl == NULL)
+		return;
+	if (ptbl->tkm_subjobs == NULL) {
+		if (subj == NULL)
+			return;
+		ptbl->tkm_subjobs = pbs_idx_create(0, sizeof(int));
+		if (ptbl->tkm_subjobs == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return;
+		}
+	}
+	pbs_idx_delete(ptbl->tkm_subjobs, &offset);
+	if (subj != NULL && pbs_idx_insert(ptbl->tkm_subjobs, &offset, subj) != PBS_IDX_RET_OK)
+		log_err(errno, __func__, "Out of memory");
+}
+/**
+ * @brief
+ * 		get_subjob_substate - return the substate recorded in the tracking
+ * 		table for the subjob at the given offset
+ *
+ * @param[in]	parent - pointer to the parent job
+ * @param[in]	offset - offset of the subjob in the table
+ *
+ * @return	int
+ * @retval	-1	-  error
+ */
+int
+get_subjob_substate(job *parent, int offset)
+{
+	if (offset == -1)
+		return -1;
+	return (parent->ji_ajtrk->tkm_tbl[offset].trk_substate);
+}
+/**
+ * @brief
+ * 		set_subjob_substate - set the substate recorded in the tracking
+ * 		table for the subjob at the given offset
+ *
+ * @param[in]	parent - pointer to the parent job
+ * @param[in]	offset - offset of the subjob in the table
+ * @param[in]	substate - new substate
+ *
+ * @return	void
+ */
+void
+set_subjob_substate(job *parent, int offset, int substate)
+{
+	if (offset == -1)
+		return;
+	parent->ji_ajtrk->tkm_tbl[offset].trk_substate = substate;
+}
 /**
  * @brief
  * 		update_subjob_state_ct - update the "array_state_count" attribute of an
@@ -681,14 +781,15 @@ mk_subjob_index_tbl(char *range, char initalstate, int *pbserror, int mode)
 		trktbl->tkm_subjsct[i] = 0;
 	trktbl->tkm_subjsct[JOB_STATE_QUEUED] = count;
 	trktbl->tkm_dsubjsct = 0;
+	trktbl->trk_rlist = NULL;
+	trktbl->tkm_subjobs = NULL;
+	trktbl->tkm_tmpl = NULL;
 	j = 0;
 	for (i = start; i <= end; i += step, j++) {
 		trktbl->tkm_tbl[j].trk_status = initalstate;
-		trktbl->tkm_tbl[j].trk_error = 0;
 		trktbl->tkm_tbl[j].trk_substate = JOB_SUBSTATE_FINISHED;
 		trktbl->tkm_tbl[j].trk_stgout = -1;
-		trktbl->tkm_tbl[j].trk_exitstat = 0;
-		trktbl->tkm_tbl[j].trk_psubjob = NULL;
+		trktbl->tkm_tbl[j].trk_flags = 0;
 	}
 	return trktbl;
 }
@@ -717,8 +818,12 @@ setup_arrayjob_attrs(attribute *pattr, void *pobj, int mode)
 
 	if ((mode == ATR_ACTION_NEW) || (mode == ATR_ACTION_RECOV)) {
 		int pbs_error = PBSE_BADATVAL;
-		if (pjob->ji_ajtrk)
+		if (pjob->ji_ajtrk) {
+			subjob_tmpl_end(pjob);
+			free_range_list(pjob->ji_ajtrk->trk_rlist);
+			pbs_idx_destroy(pjob->ji_ajtrk->tkm_subjobs);
 			free(pjob->ji_ajtrk);
+		}
 		if ((pjob->ji_ajtrk = mk_subjob_index_tbl(get_jattr_str(pjob, JOB_ATR_array_indices_submitted),
 			                                      JOB_STATE_LTR_QUEUED, &pbs_error, mode)) == NULL)
 			return pbs_error;
@@ -787,6 +892,7 @@ fixup_arrayindicies(attribute *pattr, void *pobj, int mode)
 	char *ep;
 	char *str;
 	job *pjob = pobj;
+	struct ajtrkhd *ptbl;
 
 	if (!pjob || !(pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) || !pjob->ji_ajtrk)
 		return PBSE_BADATVAL;
@@ -794,9 +900,19 @@ fixup_arrayindicies(attribute *pattr, void *pobj, int mode)
 	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) && mode == ATR_ACTION_NEW)
 		return PBSE_NONE;
 
-	/* set all sub jobs expired, then reset queued the ones in "remaining" */
-	for (i = 0; i < pjob->ji_ajtrk->tkm_ct; i++)
-		set_subjob_tblstate(pjob, i, JOB_STATE_LTR_EXPIRED);
+	/*
+	 * set all sub jobs expired, then reset queued the ones in "remaining";
+	 * the table is reset in one pass rather than a subjob at a time
+	 */
+	ptbl = pjob->ji_ajtrk;
+	for (i = 0; i < ptbl->tkm_ct; i++)
+		ptbl->tkm_tbl[i].trk_status = JOB_STATE_LTR_EXPIRED;
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		ptbl->tkm_subjsct[i] = 0;
+	ptbl->tkm_subjsct[JOB_STATE_EXPIRED] = ptbl->tkm_ct;
+	free_range_list(ptbl->trk_rlist);
+	ptbl->trk_rlist = NULL;
+	ptbl->tkm_flags |= TKMFLG_REVAL_IND_REMAINING;
 
 	str = pattr->at_val.at_str;
 	while (1) {
@@ -809,6 +925,95 @@ fixup_arrayindicies(attribute *pattr, void *pobj, int mode)
 
 	return (PBSE_NONE);
 }
+/**
+ * @brief
+ * 		subjob_attr_is_live - is the attribute one which changes on the
+ *		parent while its subjobs are started, so that it is never taken
+ *		from the encoding of subjob_tmpl_begin()
+ *
+ * @param[in]	attr_idx - index of the job attribute
+ *
+ * @return	int
+ * @retval	1 - encode from the parent for every subjob
+ * @retval	0 - may come from the template
+ */
+static int
+subjob_attr_is_live(int attr_idx)
+{
+	switch (attr_idx) {
+		case JOB_ATR_state:
+		case JOB_ATR_substate:
+		case JOB_ATR_resc_used:
+		case JOB_ATR_eligible_time:
+		case JOB_ATR_sample_starttime:
+			return 1;
+	}
+	return 0;
+}
+/**
+ * @brief
+ * 		subjob_tmpl_begin - encode the parent attributes copied into new
+ *		subjobs once, for a request which starts many subjobs of the
+ *		array.  create_subjob() decodes from these until
+ *		subjob_tmpl_end() is called, saving an encode per attribute and
+ *		subjob.
+ *
+ * @param[in]	parent - pointer to parent Job
+ *
+ * @return	void
+ */
+void
+subjob_tmpl_begin(job *parent)
+{
+	int i;
+	int j;
+	attribute_def *pdef;
+	svrattrl *psatl;
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+
+	if (ptbl == NULL || ptbl->tkm_tmpl != NULL)
+		return;
+
+	ptbl->tkm_tmpl = malloc(sizeof(attrs_to_copy) / sizeof(attrs_to_copy[0]) * sizeof(pbs_list_head));
+	if (ptbl->tkm_tmpl == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		return;
+	}
+
+	resc_access_perm = ATR_DFLAG_ACCESS;
+	for (i = 0; attrs_to_copy[i] != JOB_ATR_LAST; i++) {
+		CLEAR_HEAD(ptbl->tkm_tmpl[i]);
+		j = (int)attrs_to_copy[i];
+		if (subjob_attr_is_live(j))
+			continue;
+		pdef = &job_attr_def[j];
+		(void)pdef->at_encode(&parent->ji_wattr[j], &ptbl->tkm_tmpl[i], pdef->at_name,
+			NULL, ATR_ENCODE_MOM, &psatl);
+	}
+}
+/**
+ * @brief
+ * 		subjob_tmpl_end - drop the encoding made by subjob_tmpl_begin(),
+ *		new subjobs copy the parent attributes again
+ *
+ * @param[in]	parent - pointer to parent Job
+ *
+ * @return	void
+ */
+void
+subjob_tmpl_end(job *parent)
+{
+	int i;
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+
+	if (ptbl == NULL || ptbl->tkm_tmpl == NULL)
+		return;
+
+	for (i = 0; attrs_to_copy[i] != JOB_ATR_LAST; i++)
+		free_attrlist(&ptbl->tkm_tmpl[i]);
+	free(ptbl->tkm_tmpl);
+	ptbl->tkm_tmpl = NULL;
+}
 /**
  * @brief
  * 		create_subjob - create a Subjob from the parent Array Job
@@ -869,7 +1074,7 @@ create_subjob(job *parent, char *newjid, int *rc)
 		return NULL;
 	}
 	subj->ji_qs = parent->ji_qs;	/* copy the fixed save area */
-	parent->ji_ajtrk->tkm_tbl[indx].trk_psubjob = subj;
+	set_subjob_ptr(parent, indx, subj);
 	subj->ji_qhdr     = parent->ji_qhdr;
 	subj->ji_myResv   = parent->ji_myResv;
 	subj->ji_parentaj = parent;
@@ -891,6 +1096,18 @@ create_subjob(job *parent, char *newjid, int *rc)
 		psub = &subj->ji_wattr[j];
 		pdef = &job_attr_def[j];
 
+		/* use the encoding of a batched run if there is one */
+		if (parent->ji_ajtrk->tkm_tmpl != NULL && !subjob_attr_is_live(j)) {
+			for (psatl = (svrattrl *)GET_NEXT(parent->ji_ajtrk->tkm_tmpl[i]); psatl;
+				psatl = ((svrattrl *)GET_NEXT(psatl->al_link))) {
+				pdef->at_decode(psub, psatl->al_name, psatl->al_resc,
+					psatl->al_value);
+			}
+			if (is_attr_set(psub))
+				psub->at_flags |= (ppar->at_flags & ATR_VFLAG_DEFLT);
+			continue;
+		}
+
 		if (pdef->at_encode(ppar, &attrl, pdef->at_name, NULL,
 			ATR_ENCODE_MOM, &psatl) > 0) {
 			for (psatl = (svrattrl *)GET_NEXT(attrl); psatl;
@@ -992,6 +1209,7 @@ dup_br_for_subjob(struct batch_request *opreq, job *pjob, void (*func)(struct ba
 		case PBS_BATCH_DeleteJobList:
 			npreq->rq_ind.rq_deletejoblist = opreq->rq_ind.rq_deletejoblist;
 			npreq->rq_ind.rq_deletejoblist.rq_count = 1;
+			npreq->rq_ind.rq_deletejoblist.rq_next = 0;
 			npreq->rq_ind.rq_deletejoblist.rq_jobslist = break_comma_list(pjob->ji_qs.ji_jobid);
 			break;
 		case PBS_BATCH_DeleteJob:
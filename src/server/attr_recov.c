@@ -56,6 +56,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "list_link.h"
 #include "attribute.h"
 #include "log.h"
@@ -262,7 +264,7 @@ save_attr_fs(struct attribute_def *padef, struct attribute *pattr, int numattr)
 				if (save_struct((char *)pal, pal->al_tsize) < 0)
 					errct++;
 				delete_link(&pal->al_link);
-				(void)free(pal);
+				attrlist_free(pal);
 			}
 		}
 	}
@@ -284,13 +286,73 @@ save_attr_fs(struct attribute_def *padef, struct attribute *pattr, int numattr)
 }
 
 
+/**
+ * @brief
+ *		read the rest of a file into memory
+ *
+ *		The attribute section of a save file is read with as few reads
+ *		as possible instead of two reads per attribute, which is what
+ *		made recovering many jobs slow on busy file systems.
+ *
+ * @param[in]	fd - The file descriptor positioned at the data to read
+ * @param[out]	plen - number of bytes read
+ *
+ * @return	char *
+ * @retval	buffer - malloc-ed, to be freed by the caller
+ * @retval	NULL   - failure, errno set
+ */
+static char *
+recov_read_rest(int fd, size_t *plen)
+{
+	struct stat sb;
+	off_t	 cur;
+	size_t	 bufsz;
+	size_t	 used = 0;
+	ssize_t	 len;
+	char	*buf;
+	char	*tmp;
+
+	if (fstat(fd, &sb) == 0 && (cur = lseek(fd, 0, SEEK_CUR)) >= 0 &&
+		sb.st_size > cur)
+		bufsz = (size_t)(sb.st_size - cur) + 1;
+	else
+		bufsz = PKBUFSIZE;
+	if ((buf = malloc(bufsz)) == NULL)
+		return NULL;
+
+	for (;;) {
+		if (used == bufsz) {
+			/* the file grew, or its size was not known */
+			tmp = realloc(buf, bufsz * 2);
+			if (tmp == NULL) {
+				free(buf);
+				return NULL;
+			}
+			buf = tmp;
+			bufsz *= 2;
+		}
+		len = read(fd, buf + used, bufsz - used);
+		if (len == -1) {
+			if (errno == EINTR)
+				continue;
+			free(buf);
+			return NULL;
+		}
+		if (len == 0)
+			break;
+		used += len;
+	}
+	*plen = used;
+	return buf;
+}
+
 /**
  * @brief
  *		read attributes from disk file
  *
  *		Recover (reload) attribute from file written by save_attr().
- *		Since this is not often done (only on server initialization),
- *		Buffering the reads isn't done.
+ *		The attribute section is read into memory at once and each
+ *		attribute is decoded from there.
  *
  * @param[in]	fd - The file descriptor of the file to write to
  * @param[in] 	parent - void pointer to one of the PBS objects
@@ -310,16 +372,19 @@ int
 recov_attr_fs(int fd, void *parent, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown)
 {
 	int	  amt;
-	int	  len;
 	int	  index;
-	svrattrl *pal = NULL;
-	int	  palsize = 0;
-	svrattrl *tmpal = NULL;
-
-	pal = (svrattrl *)malloc(sizeof(svrattrl));
-	if (!pal)
-		return (-1);
-	palsize = sizeof(svrattrl);
+	char	 *buf;
+	size_t	  buflen = 0;
+	size_t	  off = 0;
+	svrattrl  hdr;
+	svrattrl *pal = &hdr;
+
+	errno = -1;
+	if ((buf = recov_read_rest(fd, &buflen)) == NULL) {
+		sprintf(log_buffer, "read error of %s", pbs_recov_filename);
+		log_err(errno, __func__, log_buffer);
+		return (errno);
+	}
 
 	/* set all privileges (read and write) for decoding resources	*/
 	/* This is a special (kludge) flag for the recovery case, see	*/
@@ -327,19 +392,19 @@ recov_attr_fs(int fd, void *parent, void *padef_idx, struct attribute_def *padef
 
 	resc_access_perm = ATR_DFLAG_ACCESS;
 
-	/* For each attribute, read in the attr_extern header */
+	/* For each attribute, take the attr_extern header */
 
 	while (1) {
 		errno = -1;
-		memset(pal, 0, palsize);
-		len = read(fd, (char *)pal, sizeof(svrattrl));
-		if (len != sizeof(svrattrl)) {
+		if (buflen - off < sizeof(svrattrl)) {
 			sprintf(log_buffer, "read1 error of %s",
 				pbs_recov_filename);
 			log_err(errno, __func__, log_buffer);
-			free(pal);
+			free(buf);
 			return (errno);
 		}
+		/* records are not aligned in the file, copy the header out */
+		memcpy(pal, buf + off, sizeof(svrattrl));
 		if (pal->al_tsize == ENDATTRIBUTES)
 			break;		/* hit dummy attribute that is eof */
 		amt = pal->al_tsize - sizeof(svrattrl);
@@ -347,43 +412,21 @@ recov_attr_fs(int fd, void *parent, void *padef_idx, struct attribute_def *padef
 			sprintf(log_buffer, "Invalid attr list size in %s",
 				pbs_recov_filename);
 			log_err(errno, __func__, log_buffer);
-			free(pal);
+			free(buf);
 			return (errno);
 		}
-
-		/* read in the attribute chunk (name and encoded value) */
-
-		if (palsize < pal->al_tsize) {
-			tmpal = (svrattrl *)realloc(pal, pal->al_tsize);
-			if (tmpal == NULL) {
-				sprintf(log_buffer,
-					"Unable to alloc attr list size in %s",
-					pbs_recov_filename);
-				log_err(errno, __func__, log_buffer);
-				free(pal);
-				return (errno);
-			}
-			pal = tmpal;
-			palsize = pal->al_tsize;
-		}
-		if (!pal)
-			return (errno);
-		CLEAR_LINK(pal->al_link);
-
-		/* read in the actual attribute data */
-
-		len = read(fd, (char *)pal + sizeof(svrattrl), amt);
-		if (len != amt) {
+		if (buflen - off - sizeof(svrattrl) < (size_t)amt) {
 			sprintf(log_buffer, "read2 error of %s",
 				pbs_recov_filename);
 			log_err(errno, __func__, log_buffer);
-			free(pal);
+			free(buf);
 			return (errno);
 		}
+		CLEAR_LINK(pal->al_link);
 
 		/* the pointer into the data are of course bad, so reset them */
 
-		pal->al_name = (char *)pal + sizeof(svrattrl);
+		pal->al_name = buf + off + sizeof(svrattrl);
 		if (pal->al_rescln)
 			pal->al_resc = pal->al_name + pal->al_nameln;
 		else
@@ -395,6 +438,7 @@ recov_attr_fs(int fd, void *parent, void *padef_idx, struct attribute_def *padef
 			pal->al_value = NULL;
 
 		pal->al_refct = 1;	/* ref count reset to 1 */
+		off += pal->al_tsize;
 
 		/* find the attribute definition based on the name */
 
@@ -451,6 +495,6 @@ recov_attr_fs(int fd, void *parent, void *padef_idx, struct attribute_def *padef
 		(pattr+index)->at_flags = pal->al_flags & ~ATR_VFLAG_MODIFY;
 	}
 
-	(void)free(pal);
+	(void)free(buf);
 	return (0);
 }
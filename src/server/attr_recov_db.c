@@ -137,19 +137,50 @@ encode_single_attr_db(struct attribute_def *padef, struct attribute *pattr, pbs_
  */
 int
 encode_attr_db(struct attribute_def *padef, struct attribute *pattr, int numattr, pbs_db_attr_list_t *db_attr_list, int all)
+{
+	return (encode_attr_db_split(padef, pattr, numattr, db_attr_list, NULL, NULL, all));
+}
+
+/**
+ * @brief
+ *	Encode the modified attributes to the database like encode_attr_db,
+ *	but put the ones flagged in hot to a list of their own.  The object
+ *	keeps those in a column of their own, so saving only them leaves the
+ *	column of the others, usually much the larger, as it is.
+ *
+ * @param[in]	padef - Address of parent's attribute definition array
+ * @param[in]	pattr - Address of the parent objects attribute array
+ * @param[in]	numattr - Number of attributes in the list
+ * @param[out]	db_attr_list - The other attributes
+ * @param[out]	db_hot_list - The attributes flagged in hot
+ * @param[in]	hot  - numattr flags, NULL to encode all to db_attr_list
+ * @param[in]	all  - Encode all attributes
+ *
+ * @return  error code
+ * @retval   -1 - Failure
+ * @retval    0 - Success
+ *
+ */
+int
+encode_attr_db_split(struct attribute_def *padef, struct attribute *pattr, int numattr, pbs_db_attr_list_t *db_attr_list,
+	pbs_db_attr_list_t *db_hot_list, char *hot, int all)
 {
 	int i;
 
 	db_attr_list->attr_count = 0;
-
 	CLEAR_HEAD(db_attr_list->attrs);
+	if (db_hot_list) {
+		db_hot_list->attr_count = 0;
+		CLEAR_HEAD(db_hot_list->attrs);
+	}
 
 	for (i = 0; i < numattr; i++) {
 		if (!((pattr + i)->at_flags & ATR_VFLAG_MODIFY))
 			continue;
 
 		if ((((padef + i)->at_flags & ATR_DFLAG_NOSAVM) == 0) || all) {
-			if (encode_single_attr_db((padef + i), (pattr + i), db_attr_list) != 0)
+			if (encode_single_attr_db((padef + i), (pattr + i),
+				(hot && hot[i]) ? db_hot_list : db_attr_list) != 0)
 				return -1;
 			
 			(pattr+i)->at_flags &= ~ATR_VFLAG_MODIFY;
@@ -216,7 +247,7 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 			} else {
 				snprintf(log_buffer,LOG_BUF_SIZE, "unknown attribute \"%s\" discarded", pal->al_name);
 				log_err(-1, __func__, log_buffer);
-				(void)free(pal);
+				attrlist_free(pal);
 				continue;
 			}
 		}
@@ -274,7 +305,7 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 							for ( index++; index <= limit; index++) {
 								while (pal) {
 									tmp_pal = pal->al_sister;
-									free(pal);
+									attrlist_free(pal);
 									pal = tmp_pal;
 								}
 								if (index < limit)
@@ -288,7 +319,7 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 						}
 				}
 			}
-			(pattr+index)->at_flags = (pal->al_flags & ~ATR_VFLAG_MODIFY) | ATR_VFLAG_MODCACHE;
+			(pattr+index)->at_flags = (pal->al_flags & ~ATR_VFLAG_MODIFY) | ATR_VFLAG_MODCACHE | ATR_VFLAG_MODSEQ;
 
 			tmp_pal = pal->al_sister;
 			pal = tmp_pal;
@@ -298,3 +329,410 @@ decode_attr_db(void *parent, pbs_db_attr_list_t *db_attr_list, void *padef_idx,
 
 	return 0;
 }
+
+/**
+ * @brief
+ *	Return how a value with the given type and codec is stored in a
+ *	binary attribute blob.  Only values handled by the generic decode and
+ *	encode functions are stored directly, everything else is stored as
+ *	the string its encode function produces.
+ *
+ * @param[in]	type   - ATR_TYPE_* of the value
+ * @param[in]	decode - Decode function of the value
+ * @param[in]	encode - Encode function of the value
+ *
+ * @return	PBS_DB_BLOB_* type
+ *
+ */
+static int
+blob_value_type(int type, void *decode, void *encode)
+{
+	switch (type) {
+		case ATR_TYPE_LONG:
+			if ((decode == (void *) decode_l && encode == (void *) encode_l) ||
+				(decode == (void *) decode_time && encode == (void *) encode_time))
+				return PBS_DB_BLOB_LONG;
+			break;
+		case ATR_TYPE_LL:
+			if (decode == (void *) decode_ll && encode == (void *) encode_ll)
+				return PBS_DB_BLOB_LONG;
+			break;
+		case ATR_TYPE_BOOL:
+			if (decode == (void *) decode_b && encode == (void *) encode_b)
+				return PBS_DB_BLOB_BOOL;
+			break;
+		case ATR_TYPE_CHAR:
+			if (decode == (void *) decode_c && encode == (void *) encode_c)
+				return PBS_DB_BLOB_CHAR;
+			break;
+		case ATR_TYPE_SIZE:
+			if (decode == (void *) decode_size && encode == (void *) encode_size)
+				return PBS_DB_BLOB_SIZE;
+			break;
+		case ATR_TYPE_FLOAT:
+			if (decode == (void *) decode_f && encode == (void *) encode_f)
+				return PBS_DB_BLOB_FLOAT;
+			break;
+		case ATR_TYPE_STR:
+			if (decode == (void *) decode_str && encode == (void *) encode_str)
+				return PBS_DB_BLOB_STR;
+			break;
+	}
+	return PBS_DB_BLOB_TEXT;
+}
+
+/**
+ * @brief
+ *	Append a directly stored value to a binary attribute blob
+ *
+ * @param[in]	blob  - The blob
+ * @param[in]	btype - PBS_DB_BLOB_* type of the value
+ * @param[in]	type  - ATR_TYPE_* of the value
+ * @param[in]	pattr - The value
+ * @param[in]	name  - Attribute name
+ * @param[in]	resc  - Resource name or NULL
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+blob_add_value(pbs_db_blob_t *blob, int btype, int type, attribute *pattr, char *name, char *resc)
+{
+	pbs_db_blob_ent_t ent;
+
+	memset(&ent, 0, sizeof(ent));
+	ent.bl_type = btype;
+	ent.bl_flags = pattr->at_flags;
+	ent.bl_name = name;
+	ent.bl_resc = resc;
+	switch (btype) {
+		case PBS_DB_BLOB_STR:
+			ent.bl_str = pattr->at_val.at_str ? pattr->at_val.at_str : "";
+			break;
+		case PBS_DB_BLOB_LONG:
+			ent.bl_long = (type == ATR_TYPE_LL) ? pattr->at_val.at_ll : pattr->at_val.at_long;
+			break;
+		case PBS_DB_BLOB_BOOL:
+			ent.bl_long = pattr->at_val.at_long;
+			break;
+		case PBS_DB_BLOB_CHAR:
+			ent.bl_long = pattr->at_val.at_char;
+			break;
+		case PBS_DB_BLOB_SIZE:
+			ent.bl_size_num = pattr->at_val.at_size.atsv_num;
+			ent.bl_size_shift = pattr->at_val.at_size.atsv_shift;
+			ent.bl_size_units = pattr->at_val.at_size.atsv_units;
+			break;
+		case PBS_DB_BLOB_FLOAT:
+			ent.bl_float = pattr->at_val.at_float;
+			break;
+	}
+	return pbs_db_blob_add(blob, &ent);
+}
+
+/**
+ * @brief
+ *	Append the entries of an encoded attribute list to a binary
+ *	attribute blob as TEXT values, and free the list
+ *
+ * @param[in]	blob - The blob
+ * @param[in]	phead - The encoded list
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+blob_add_list(pbs_db_blob_t *blob, pbs_list_head *phead)
+{
+	pbs_db_blob_ent_t ent;
+	svrattrl *pal;
+	int rc = 0;
+
+	for (pal = (svrattrl *) GET_NEXT(*phead); pal != NULL && rc == 0; pal = (svrattrl *) GET_NEXT(pal->al_link)) {
+		memset(&ent, 0, sizeof(ent));
+		ent.bl_type = PBS_DB_BLOB_TEXT;
+		ent.bl_flags = pal->al_flags;
+		ent.bl_name = pal->al_name;
+		ent.bl_resc = pal->al_resc;
+		ent.bl_str = pal->al_value ? pal->al_value : "";
+		rc = pbs_db_blob_add(blob, &ent);
+	}
+	free_attrlist(phead);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Append one attribute to a binary attribute blob.  Resource lists
+ *	are stored one entry per resource, keyed by the resource name.
+ *
+ * @param[in]	padef - Attribute definition
+ * @param[in]	pattr - The attribute
+ * @param[in]	blob  - The blob
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+blob_add_attr(attribute_def *padef, attribute *pattr, pbs_db_blob_t *blob)
+{
+	pbs_list_head head;
+	resource *prs;
+	resource_def *prdef;
+	int btype;
+
+	CLEAR_HEAD(head);
+
+	if (padef->at_type == ATR_TYPE_RESC && padef->at_encode == encode_resc) {
+		for (prs = (resource *) GET_NEXT(pattr->at_val.at_list); prs != NULL; prs = (resource *) GET_NEXT(prs->rs_link)) {
+			if (!(prs->rs_value.at_flags & ATR_VFLAG_SET))
+				continue;
+			prdef = prs->rs_defin;
+			if (prs->rs_value.at_flags & ATR_VFLAG_INDIRECT)
+				btype = PBS_DB_BLOB_TEXT;
+			else
+				btype = blob_value_type(prdef->rs_type, (void *) prdef->rs_decode, (void *) prdef->rs_encode);
+			if (btype != PBS_DB_BLOB_TEXT) {
+				if (blob_add_value(blob, btype, prdef->rs_type, &prs->rs_value, padef->at_name, prdef->rs_name) != 0)
+					return -1;
+				continue;
+			}
+			if (prs->rs_value.at_flags & ATR_VFLAG_INDIRECT) {
+				if (encode_str(&prs->rs_value, &head, padef->at_name, prdef->rs_name, ATR_ENCODE_DB, NULL) < 0)
+					return -1;
+			} else if (prdef->rs_encode(&prs->rs_value, &head, padef->at_name, prdef->rs_name, ATR_ENCODE_DB, NULL) < 0) {
+				free_attrlist(&head);
+				return -1;
+			}
+			if (blob_add_list(blob, &head) != 0)
+				return -1;
+		}
+		return 0;
+	}
+
+	btype = blob_value_type(padef->at_type, (void *) padef->at_decode, (void *) padef->at_encode);
+	if (btype != PBS_DB_BLOB_TEXT)
+		return blob_add_value(blob, btype, padef->at_type, pattr, padef->at_name, NULL);
+
+	if (padef->at_encode(pattr, &head, padef->at_name, NULL, ATR_ENCODE_DB, NULL) < 0) {
+		free_attrlist(&head);
+		return -1;
+	}
+	return blob_add_list(blob, &head);
+}
+
+/**
+ * @brief
+ *	Encode the given attributes to a binary attribute blob.  Unlike
+ *	encode_attr_db, the blob always holds all the saved attributes, so
+ *	it is rebuilt whenever any of them was modified.
+ *
+ * @param[in]	padef - Address of parent's attribute definition array
+ * @param[in]	pattr - Address of the parent objects attribute array
+ * @param[in]	numattr - Number of attributes in the list
+ * @param[out]	blob - The blob, its data is reused if already allocated
+ * @param[in]	all  - Encode all attributes
+ * @param[in]	force - Build the blob even if nothing was modified
+ *
+ * @return  error code
+ * @retval   -1 - Failure
+ * @retval    0 - Nothing was modified, no blob built
+ * @retval    1 - Success
+ *
+ */
+int
+encode_attr_blob(struct attribute_def *padef, struct attribute *pattr, int numattr, pbs_db_blob_t *blob, int all, int force)
+{
+	int i;
+	int modified = force;
+
+	for (i = 0; i < numattr && !modified; i++) {
+		if (((pattr + i)->at_flags & ATR_VFLAG_MODIFY) &&
+			((((padef + i)->at_flags & ATR_DFLAG_NOSAVM) == 0) || all))
+			modified = 1;
+	}
+	if (!modified)
+		return 0;
+
+	blob->len = 0;
+	for (i = 0; i < numattr; i++) {
+		if ((((padef + i)->at_flags & ATR_DFLAG_NOSAVM) != 0) && !all)
+			continue;
+		if (((pattr + i)->at_flags & ATR_VFLAG_SET) &&
+			(blob_add_attr(padef + i, pattr + i, blob) != 0))
+			return -1;
+		(pattr + i)->at_flags &= ~ATR_VFLAG_MODIFY;
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ *	Set an attribute value from a directly stored blob entry
+ *
+ * @param[in]	pent  - The blob entry
+ * @param[in]	type  - ATR_TYPE_* of the value
+ * @param[out]	pattr - The value
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+static int
+blob_set_value(pbs_db_blob_ent_t *pent, int type, attribute *pattr)
+{
+	switch (pent->bl_type) {
+		case PBS_DB_BLOB_STR:
+			if ((pattr->at_val.at_str = strdup(pent->bl_str)) == NULL) {
+				log_err(errno, __func__, "Out of memory");
+				return -1;
+			}
+			break;
+		case PBS_DB_BLOB_LONG:
+			if (type == ATR_TYPE_LL)
+				pattr->at_val.at_ll = pent->bl_long;
+			else
+				pattr->at_val.at_long = (long) pent->bl_long;
+			break;
+		case PBS_DB_BLOB_BOOL:
+			pattr->at_val.at_long = pent->bl_long ? 1 : 0;
+			break;
+		case PBS_DB_BLOB_CHAR:
+			pattr->at_val.at_char = (char) pent->bl_long;
+			break;
+		case PBS_DB_BLOB_SIZE:
+			pattr->at_val.at_size.atsv_num = pent->bl_size_num;
+			pattr->at_val.at_size.atsv_shift = pent->bl_size_shift;
+			pattr->at_val.at_size.atsv_units = pent->bl_size_units;
+			break;
+		case PBS_DB_BLOB_FLOAT:
+			pattr->at_val.at_float = pent->bl_float;
+			break;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Decode a binary attribute blob from the database to the regular
+ *	attribute structure.  Directly stored values are set as they are,
+ *	the TEXT ones (and any the server does not know how to set directly
+ *	any more) are collected and handed to decode_attr_db.
+ *
+ * @param[in]	  parent - pointer to parent object
+ * @param[in]	  data - The blob
+ * @param[in]	  len - Length of the blob
+ * @param[in]     padef_idx - Search index of this attribute array
+ * @param[in]	  padef - Address of parent's attribute definition array
+ * @param[in/out] pattr - Address of the parent objects attribute array
+ * @param[in]	  limit - Number of attributes in the list
+ * @param[in]	  unknown	- The index of the unknown attribute if any
+ *
+ * @return      Error code
+ * @retval	 0  - Success
+ * @retval	-1  - Failure
+ *
+ */
+int
+decode_attr_blob(void *parent, char *data, int len, void *padef_idx, struct attribute_def *padef, struct attribute *pattr, int limit, int unknown)
+{
+	pbs_db_attr_list_t text_list;
+	pbs_db_blob_ent_t ent;
+	attribute *pa;
+	attribute_def *pd;
+	resource_def *prdef;
+	resource *prs;
+	svrattrl *pal;
+	char buf[256];
+	int pos = 0;
+	int index;
+	int rc;
+
+	CLEAR_HEAD(text_list.attrs);
+	text_list.attr_count = 0;
+
+	while ((rc = pbs_db_blob_next(data, len, &pos, &ent)) == 0) {
+		index = -1;
+		prdef = NULL;
+		if (ent.bl_type != PBS_DB_BLOB_TEXT)
+			index = find_attr(padef_idx, padef, ent.bl_name);
+		if (index >= 0) {
+			pd = padef + index;
+			pa = pattr + index;
+			if (ent.bl_resc == NULL) {
+				if (blob_value_type(pd->at_type, (void *) pd->at_decode, (void *) pd->at_encode) != ent.bl_type)
+					index = -1;
+			} else if (pd->at_type != ATR_TYPE_RESC || pd->at_encode != encode_resc ||
+				(prdef = find_resc_def(svr_resc_def, ent.bl_resc)) == NULL ||
+				blob_value_type(prdef->rs_type, (void *) prdef->rs_decode, (void *) prdef->rs_encode) != ent.bl_type)
+				index = -1;
+		}
+
+		if (index < 0) {
+			/* let the regular decode path deal with it */
+			pal = attrlist_create(ent.bl_name, ent.bl_resc, strlen(pbs_db_blob_value(&ent, buf, sizeof(buf))) + 1);
+			if (pal == NULL) {
+				log_err(errno, __func__, "Out of memory");
+				rc = -1;
+				break;
+			}
+			strcpy(pal->al_value, pbs_db_blob_value(&ent, buf, sizeof(buf)));
+			pal->al_flags = ent.bl_flags;
+			append_link(&text_list.attrs, &pal->al_link, pal);
+			text_list.attr_count++;
+			continue;
+		}
+
+		if (prdef == NULL) {
+			if (pa->at_flags & ATR_VFLAG_SET)
+				pd->at_free(pa);
+			if (blob_set_value(&ent, pd->at_type, pa) != 0) {
+				rc = -1;
+				break;
+			}
+		} else {
+			if (!(pa->at_flags & ATR_VFLAG_SET))
+				CLEAR_HEAD(pa->at_val.at_list);
+			if ((prs = find_resc_entry(pa, prdef)) != NULL) {
+				prdef->rs_free(&prs->rs_value);
+			} else if ((prs = add_resource_entry(pa, prdef)) == NULL) {
+				log_err(errno, __func__, "Out of memory");
+				rc = -1;
+				break;
+			}
+			if (blob_set_value(&ent, prdef->rs_type, &prs->rs_value) != 0) {
+				rc = -1;
+				break;
+			}
+			prs->rs_value.at_flags |= ATR_SET_MOD_MCACHE;
+		}
+		pa->at_flags = (ent.bl_flags & ~ATR_VFLAG_MODIFY) | ATR_VFLAG_MODCACHE | ATR_VFLAG_MODSEQ;
+		if (pd->at_action) {
+			int act_rc;
+
+			if ((act_rc = pd->at_action(pa, parent, ATR_ACTION_RECOV))) {
+				log_errf(act_rc, __func__, "Action function failed for %s attr, errn %d", pd->at_name, act_rc);
+				rc = -1;
+				break;
+			}
+		}
+	}
+
+	if (rc != 1) {
+		if (rc != -1)
+			log_err(-1, __func__, "corrupt attribute blob");
+		free_db_attr_list(&text_list);
+		return -1;
+	}
+
+	rc = decode_attr_db(parent, &text_list, padef_idx, padef, pattr, limit, unknown);
+	free_db_attr_list(&text_list);
+	return rc;
+}
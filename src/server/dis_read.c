@@ -348,6 +348,7 @@ decode_DIS_replySvr_inner(int sock, struct batch_reply *reply)
 				CLEAR_LINK(pstsvr->brp_stlink);
 				pstsvr->brp_objname[0] = '\0';
 				CLEAR_HEAD(pstsvr->brp_attr);
+				pstsvr->brp_enc = NULL;
 
 				pstsvr->brp_objtype = disrui(sock, &rc);
 				if (rc == 0) {
@@ -494,7 +495,7 @@ dis_request_read(int sfds, struct batch_request *request)
 		return PBSE_DISPROTO;
 	}
 
-	if (proto_ver > PBS_BATCH_PROT_VER)
+	if (proto_ver > PBS_BATCH_PROT_VER_TAGGED)
 		return PBSE_DISPROTO;
 
 	/* Decode the Request Body based on the type */
@@ -512,6 +513,32 @@ dis_request_read(int sfds, struct batch_request *request)
 			rc = decode_DIS_QueueJob(sfds, request);
 			break;
 
+#ifndef PBS_MOM
+		case PBS_BATCH_SubmitJob:
+			/*
+			 * A Queue Job request with the script, from here on it
+			 * is handled as a Queue Job that carries its script
+			 */
+			CLEAR_HEAD(request->rq_ind.rq_queuejob.rq_attr);
+			rc = decode_DIS_SubmitJob(sfds, request);
+			request->rq_type = PBS_BATCH_QueueJob;
+			break;
+
+		case PBS_BATCH_SubmitJobList:
+			rc = decode_DIS_SubmitJobList(sfds, request);
+			break;
+#else
+		case PBS_BATCH_ExecJob:
+			/*
+			 * A job from the server with its script and credential,
+			 * handled as a Queue Job that is committed right away
+			 */
+			CLEAR_HEAD(request->rq_ind.rq_queuejob.rq_attr);
+			rc = decode_DIS_ExecJob(sfds, request);
+			request->rq_type = PBS_BATCH_QueueJob;
+			break;
+#endif	/* PBS_MOM */
+
 		case PBS_BATCH_JobCred:
 			rc = decode_DIS_JobCred(sfds, request);
 			break;
@@ -535,6 +562,14 @@ dis_request_read(int sfds, struct batch_request *request)
 			rc = decode_DIS_DelJobList(sfds, request);
 			break;
 
+		case PBS_BATCH_ModifyJobList_Async:
+			rc = decode_DIS_ModifyJobList(sfds, request);
+			break;
+
+		case PBS_BATCH_RunSubjobs_Async:
+			rc = decode_DIS_RunSubjobs(sfds, request);
+			break;
+
 		case PBS_BATCH_DeleteJob:
 		case PBS_BATCH_DeleteResv:
 		case PBS_BATCH_ResvOccurEnd:
@@ -623,6 +658,16 @@ dis_request_read(int sfds, struct batch_request *request)
 				&request->rq_ind.rq_select.rq_rtnattr);
 			break;
 
+		case PBS_BATCH_ModifyJobsSel:
+			CLEAR_HEAD(request->rq_ind.rq_modifysel.rq_selattr);
+			CLEAR_HEAD(request->rq_ind.rq_modifysel.rq_attr);
+			rc = decode_DIS_svrattrl(sfds,
+				&request->rq_ind.rq_modifysel.rq_selattr);
+			if (rc == 0)
+				rc = decode_DIS_svrattrl(sfds,
+					&request->rq_ind.rq_modifysel.rq_attr);
+			break;
+
 		case PBS_BATCH_StatusNode:
 		case PBS_BATCH_StatusResv:
 		case PBS_BATCH_StatusQue:
@@ -630,6 +675,7 @@ dis_request_read(int sfds, struct batch_request *request)
 		case PBS_BATCH_StatusSched:
 		case PBS_BATCH_StatusRsc:
 		case PBS_BATCH_StatusHook:
+		case PBS_BATCH_Subscribe:
 			rc = decode_DIS_Status(sfds, request);
 			break;
 
@@ -1123,7 +1123,8 @@ be_secondary(time_t delay)
 					sprintf(log_buffer, "Secondary has not received handshake in %ld seconds", time_now - hd_time);
 					log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
 						LOG_WARNING, msg_daemonname, log_buffer);
-				}
+				} else
+					standby_refresh(time_now);	/* Primary is up, catch up on its jobs */
 				break;
 
 			case SECONDARY_STATE_nohsk:
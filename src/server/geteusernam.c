@@ -66,6 +66,7 @@
 #include "pbs_error.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
+#include "pbs_pwcache.h"
 
 /* External Data */
 
@@ -310,7 +311,7 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 	if ((puser = determine_euser(pobj, objtype, pattr, &isowner)) == NULL)
 		return (bad_euser);
 
-	pwent = getpwnam(puser);
+	pwent = pbs_getpwnam(puser);
 	if (pwent == NULL) {
 		if (!server.sv_attr[(int)SVR_ATR_FlatUID].at_val.at_long)
 			return (bad_euser);
@@ -357,7 +358,7 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 			/* user specified a group, group must exists and either	   */
 			/* must be user's primary group	 or the user must be in it */
 
-			gpent = getgrnam(pgrpn);
+			gpent = pbs_getgrnam(pgrpn);
 			if (gpent == NULL) {
 				if (pwent != NULL)	/* no such group is allowed */
 					return (bad_egrp);	/* only when no user (flatuid)*/
@@ -377,7 +378,7 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 		} else {
 
 			/* Use user login group */
-			gpent = getgrgid(pwent->pw_gid);
+			gpent = pbs_getgrgid(pwent->pw_gid);
 			if (gpent != NULL) {
 				pgrpn = gpent->gr_name;		/* use group name */
 			} else {
@@ -89,6 +89,7 @@
  * sync_mom_hookfilesTPP
  * mc_sync_mom_hookfiles
  * add_pending_mom_allhooks_action
+ * drop_synced_mom_hook_action
  * next_sync_mom_hookfiles
  * mark_mom_hooks_seen
  * mom_hooks_seen_count
@@ -103,6 +104,7 @@
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/wait.h>
 #include <ctype.h>
 #include <errno.h>
@@ -761,6 +763,7 @@ mgr_hook_create(struct batch_request *preq)
 	char		*hook_user_val = NULL;
 	char		*hook_fail_action_val = NULL;
 	char		*hook_freq_val = NULL;
+	char		*hook_job_filter_val = NULL;
 
 	if (strlen(preq->rq_ind.rq_manager.rq_objname) == 0) {
 		reply_text(preq, PBSE_HOOKERROR, "no hook name specified");
@@ -861,6 +864,17 @@ mgr_hook_create(struct batch_request *preq)
 					plx->al_value, errno);
 				goto mgr_hook_create_error;
 			}
+		} else if (strcasecmp(plx->al_name, HOOKATT_JOB_FILTER) == 0) {
+			/* deferred like freq, as it depends on exechost_periodic */
+			if (hook_job_filter_val != NULL)
+				free(hook_job_filter_val);
+			hook_job_filter_val = strdup(plx->al_value);
+			if (hook_job_filter_val == NULL) {
+				snprintf(hook_msg, sizeof(hook_msg),
+					"strdup(%s) failed: errno %d",
+					plx->al_value, errno);
+				goto mgr_hook_create_error;
+			}
 		} else {
 			snprintf(hook_msg, sizeof(hook_msg)-1, "%s - %s",
 				msg_noattr, plx->al_name);
@@ -893,6 +907,13 @@ mgr_hook_create(struct batch_request *preq)
 		free(hook_freq_val);
 		hook_freq_val = NULL;
 	}
+	if (hook_job_filter_val != NULL) {
+		if (set_hook_job_filter(phook, hook_job_filter_val,
+			hook_msg, sizeof(hook_msg)) != 0)
+			goto mgr_hook_create_error;
+		free(hook_job_filter_val);
+		hook_job_filter_val = NULL;
+	}
 
 	sprintf(log_buffer, msg_manager, msg_man_cre,
 		preq->rq_user, preq->rq_host);
@@ -928,6 +949,8 @@ mgr_hook_create_error:
 		free(hook_fail_action_val);
 	if (hook_freq_val != NULL)
 		free(hook_freq_val);
+	if (hook_job_filter_val != NULL)
+		free(hook_job_filter_val);
 
 	if (phook)
 		hook_purge(phook, pbs_python_ext_free_python_script);
@@ -1644,6 +1667,7 @@ copy_hook(hook *src_hook, hook *dst_hook, int mode)
 			dst_hook->event = src_hook->event;
 			dst_hook->alarm = src_hook->alarm;
 			dst_hook->freq = src_hook->freq;
+			dst_hook->job_filter = src_hook->job_filter;
 			break;
 		case COPY_HOOK_RESTORE:
 			(void)set_hook_order(dst_hook,
@@ -1673,6 +1697,7 @@ copy_hook(hook *src_hook, hook *dst_hook, int mode)
 			(void)set_hook_freq(dst_hook,
 				hook_freq_as_string(src_hook->freq), hook_msg,
 				sizeof(hook_msg));
+			dst_hook->job_filter = src_hook->job_filter;
 			break;
 	}
 }
@@ -1709,6 +1734,7 @@ mgr_hook_set(struct batch_request *preq)
 	char *hook_fail_action_val = NULL;
 	enum batch_op hook_fail_action_op = DFLT;
 	char *hook_freq_val = NULL;
+	char *hook_job_filter_val = NULL;
 	int hook_obj;
 
 	hook_obj = preq->rq_ind.rq_manager.rq_objtype;
@@ -1852,6 +1878,7 @@ mgr_hook_set(struct batch_request *preq)
 					/* unset hook freq value */
 					if((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) == 0) {
 						phook->freq = HOOK_FREQ_DEFAULT;
+						phook->job_filter = HOOK_JOB_FILTER_DEFAULT;
 					}
 
 					if ((phook->event & USER_MOM_EVENTS) == 0) {
@@ -1877,6 +1904,7 @@ mgr_hook_set(struct batch_request *preq)
 					/* unset hook freq value */
 					if((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) == 0) {
 						phook->freq = HOOK_FREQ_DEFAULT;
+						phook->job_filter = HOOK_JOB_FILTER_DEFAULT;
 					}
 
 					if ((phook->event & USER_MOM_EVENTS) == 0) {
@@ -1934,6 +1962,19 @@ mgr_hook_set(struct batch_request *preq)
 					plx->al_value, errno);
 				goto mgr_hook_set_error;
 			}
+		} else if (strcasecmp(plx->al_name, HOOKATT_JOB_FILTER) == 0) {
+			if (plx->al_op != SET)
+				goto opnotequal;
+			/* deferred like freq, as it depends on exechost_periodic */
+			if (hook_job_filter_val != NULL)
+				free(hook_job_filter_val);
+			hook_job_filter_val = strdup(plx->al_value);
+			if (hook_job_filter_val == NULL) {
+				snprintf(hook_msg, sizeof(hook_msg),
+					"strdup(%s) failed: errno %d",
+					plx->al_value, errno);
+				goto mgr_hook_set_error;
+			}
 		} else {
 			snprintf(hook_msg, sizeof(hook_msg)-1, "%s - %s",
 				msg_noattr, plx->al_name);
@@ -1998,6 +2039,15 @@ mgr_hook_set(struct batch_request *preq)
 		free(hook_freq_val);
 		hook_freq_val = NULL;
 	}
+	if (hook_job_filter_val != NULL) {
+		if (set_hook_job_filter(phook, hook_job_filter_val,
+			hook_msg, sizeof(hook_msg)) != 0)
+			goto mgr_hook_set_error;
+		else
+			num_set++;
+		free(hook_job_filter_val);
+		hook_job_filter_val = NULL;
+	}
 
 	if (num_set > 0) {
 		if (hook_save(phook) != 0) {
@@ -2061,6 +2111,8 @@ mgr_hook_set_error:
 		free(hook_fail_action_val);
 	if (hook_freq_val != NULL)
 		free(hook_freq_val);
+	if (hook_job_filter_val != NULL)
+		free(hook_job_filter_val);
 
 	if ((num_set > 0) || got_event) {
 		/*
@@ -2188,6 +2240,7 @@ mgr_hook_unset(struct batch_request *preq)
 			/* which are dependent on certain events being */
 			/* present. */
 			phook->freq = HOOK_FREQ_DEFAULT;
+			phook->job_filter = HOOK_JOB_FILTER_DEFAULT;
 			phook->user = HOOK_USER_DEFAULT;
 			phook->fail_action = HOOK_FAIL_ACTION_DEFAULT;
 			num_unset++;
@@ -2206,6 +2259,11 @@ mgr_hook_unset(struct batch_request *preq)
 				sizeof(hook_msg)) != 0)
 				goto mgr_hook_unset_error;
 			num_unset++;
+		} else if (strcasecmp(plx->al_name, HOOKATT_JOB_FILTER) == 0) {
+			if (unset_hook_job_filter(phook, hook_msg,
+				sizeof(hook_msg)) != 0)
+				goto mgr_hook_unset_error;
+			num_unset++;
 		} else {
 			snprintf(hook_msg, sizeof(hook_msg)-1, "%s - %s",
 				msg_noattr, plx->al_name);
@@ -2287,6 +2345,7 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 	char		  val_str[HOOK_BUF_SIZE];
 	char		   *hookname;
 	int		  hook_obj;
+	char		  *p;
 
 	/* status_hook() request will not have the object type directly. The extend */
 	/* field will determine the object type */
@@ -2314,6 +2373,7 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 	(void)strcpy(pstat->brp_objname, hookname);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -2341,10 +2401,21 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 				(((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) != 0) ||
 				 ((phook->event & HOOK_EVENT_PERIODIC) != 0))) {
 				strcpy(val_str, hook_freq_as_string(phook->freq));
+			} else if ((strcmp(pal->al_name, HOOKATT_JOB_FILTER) == 0) &&
+				((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) != 0)) {
+				strcpy(val_str, hook_job_filter_as_string(phook->job_filter));
 			} else if (strcmp(pal->al_name, HOOKATT_DEBUG) == 0) {
 				strcpy(val_str, hook_debug_as_string(phook->debug));
 			} else if (strcmp(pal->al_name, HOOKATT_FAIL_ACTION) == 0) {
 				strcpy(val_str, hook_fail_action_as_string(phook->fail_action));
+			} else if (strcmp(pal->al_name, HOOKATT_RUN_STATS) == 0) {
+				/* can outgrow val_str */
+				p = hook_stats_as_string(phook);
+				if ((p == NULL) ||
+					(attrlist_add(&pstat->brp_attr, pal->al_name, p) != 0))
+					return (PBSE_INTERNAL);
+				pal = (svrattrl *)GET_NEXT(pal->al_link);
+				continue;
 			} else {
 				snprintf(hook_msg, msg_len-1,
 					"unknown hook attribute %s", pal->al_name);
@@ -2374,6 +2445,9 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 			  ((phook->event & HOOK_EVENT_PERIODIC) != 0))&&
 			(attrlist_add(&pstat->brp_attr, HOOKATT_FREQ,
 			hook_freq_as_string(phook->freq)) != 0)) ||
+			(((phook->event & HOOK_EVENT_EXECHOST_PERIODIC) != 0) &&
+			(attrlist_add(&pstat->brp_attr, HOOKATT_JOB_FILTER,
+			hook_job_filter_as_string(phook->job_filter)) != 0)) ||
 			(attrlist_add(&pstat->brp_attr, HOOKATT_ORDER,
 			hook_order_as_string(phook->order)) != 0) ||
 			(attrlist_add(&pstat->brp_attr, HOOKATT_DEBUG,
@@ -3966,6 +4040,9 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 	pbs_list_head 		event_vnode;
 	pbs_list_head 		event_resv;
 	char			perf_label[MAXBUFLEN];
+	struct timeval		run_start;
+	struct timeval		run_end;
+	double			run_time;
 
 	if (phook == NULL) {
 		log_event(PBSEVENT_DEBUG3,
@@ -4312,8 +4389,19 @@ int server_process_hooks(int rq_type, char *rq_user, char *rq_host, hook *phook,
 	/* let rc pass through */
 	if (rc == 0) {
 		hook_perf_stat_start(perf_label, "run_code", 0);
+		gettimeofday(&run_start, NULL);
 		rc = pbs_python_run_code_in_namespace(&svr_interp_data, phook->script, 0);
+		gettimeofday(&run_end, NULL);
+		run_time = (run_end.tv_sec - run_start.tv_sec) +
+			(run_end.tv_usec - run_start.tv_usec) / 1000000.0;
 		hook_perf_stat_stop(perf_label, "run_code", 0);
+		svr_stats_record(SVR_STAT_HOOK, run_time);
+		if (rc == -3)
+			hook_stats_record(phook, hook_event, run_time, HOOK_RUN_ALARM);
+		else if ((rc == -2) || ((rc == 0) && (pbs_python_event_get_accept_flag() == FALSE)))
+			hook_stats_record(phook, hook_event, run_time, HOOK_RUN_REJECT);
+		else if (rc == 0)
+			hook_stats_record(phook, hook_event, run_time, HOOK_RUN_ACCEPT);
 	}
 
 	if (fp_debug != NULL) {
@@ -5130,6 +5218,51 @@ delete_pending_mom_hook_action(void *minfo, char *hookname,
 
 }
 
+/**
+ * @brief
+ *		Drops the pending send actions to the mom in 'minfo' for 'hookname'
+ *		that the checksums reported by the mom show are not needed, as the
+ *		mom already has that part of the hook as the server has it.  Sends
+ *		already made and waiting for the mom's reply are left alone.
+ *
+ * @see
+ * 		is_request
+ *
+ * @param[in]	minfo		- the mom that reported its hook checksums
+ * @param[in]	hookname	- the hook in question
+ * @param[in] 	action		- the send actions the mom does not need
+ *				(MOM_HOOK_ACTION_SEND_ATTRS,
+ *				MOM_HOOK_ACTION_SEND_SCRIPT, etc...)
+ *
+ * @return void
+ */
+void
+drop_synced_mom_hook_action(void *minfo, char *hookname, unsigned int action)
+{
+	mominfo_t		*pmom = (mominfo_t *)minfo;
+	mom_hook_action_t	*pact;
+	int			i;
+
+	if ((pmom == NULL) || (hookname == NULL))
+		return;
+
+	for (i = 0; i < pmom->mi_num_action; i++) {
+		pact = pmom->mi_action[i];
+		if ((pact == NULL) || (strcmp(pact->hookname, hookname) != 0))
+			continue;
+
+		action &= pact->action & ~pact->reply_expected;
+		if (action != 0) {
+			pact->action &= ~action;
+			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK, LOG_INFO,
+				hookname, "mom %s already has the hook, not resending (action=0x%x)",
+				pmom->mi_host, action);
+			hook_track_save(pmom, i);
+		}
+		return;
+	}
+}
+
 /**
  * @brief
  *		Determines if 'hookname' has a pending MOM_HOOK_ACTION_DELETE to
@@ -92,6 +92,8 @@
 #include "credential.h"
 #include "net_connect.h"
 #include "pbs_reliable.h"
+#include "pbs_pwcache.h"
+#include "mem_acct.h"
 
 #if defined(PBS_MOM) && defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 #include "renew_creds.h"
@@ -240,7 +242,7 @@ job_abt(job *pjob, char *text)
 			log_err(-1, __func__, log_buffer);
 			if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) == 0) {
 				/* notify creator that job is exited */
-				set_job_state(pjob, JOB_STATE_LTR_EXITING);
+				svr_chgjobstate(pjob, JOB_STATE_LTR_EXITING);
 				issue_track(pjob);
 			}
 			/*
@@ -303,6 +305,7 @@ job_alloc(void)
 		return NULL;
 	}
 	(void)memset((char *)pj, (int)0, (size_t)sizeof(job));
+	mem_acct_add(MEM_ACCT_JOB, 1, sizeof(job));
 
 	CLEAR_LINK(pj->ji_alljobs);
 	CLEAR_LINK(pj->ji_jobque);
@@ -337,9 +340,13 @@ job_alloc(void)
 	pj->ji_parent2child_job_update_status_pipe = -1;
 	pj->ji_parent2child_moms_status_pipe = -1;
 	pj->ji_updated = 0;
+	CLEAR_HEAD(pj->ji_ruu_sent);
+	pj->ji_ruu_gen = 0;
 	pj->ji_hook_running_bg_on = BG_NONE;
 	pj->ji_bg_hook_task = NULL;
 	pj->ji_report_task = NULL;
+	pj->ji_walltime_task = NULL;
+	pj->ji_limflags = 0;
 	pj->ji_env.v_envp = NULL;
 #ifdef WIN32
 	pj->ji_hJob = NULL;
@@ -364,6 +371,23 @@ job_alloc(void)
 	pj->ji_deletehistory = 0;
 	pj->ji_script = NULL;
 	pj->ji_prov_startjob_task = NULL;
+	pj->ji_prov_pending = 0;
+	CLEAR_LINK(pj->ji_pendsave);
+	CLEAR_LINK(pj->ji_ownerjobs);
+	CLEAR_LINK(pj->ji_histjobs);
+	pj->ji_histcompact = 0;
+	pj->ji_dbhist = 0;
+	pj->ji_alloc = NULL;
+	pj->ji_attrblob = 0;
+	pj->ji_stat_enc[0] = NULL;
+	pj->ji_stat_enc[1] = NULL;
+	pj->ji_counted = 0;
+	pj->ji_ctstate = -1;
+	pj->ji_exec_update_out = 0;
+	pj->ji_exec_update_again = 0;
+	pj->ji_exec_update_reqs = NULL;
+	pj->ji_exec_update_nreqs = 0;
+	pj->ji_exec_update_nout = 0;
 #endif
 	pj->ji_qs.ji_jsversion = JSVERSION;
 	pj->ji_momhandle = -1;		/* mark mom connection invalid */
@@ -459,7 +483,20 @@ job_free(job *pj)
 {
 	int i;
 
+#ifndef PBS_MOM
+	/* write out a deferred save while the attributes are still there */
+	job_save_db_sync(pj);
+	release_brp_enc(pj->ji_stat_enc[0]);
+	release_brp_enc(pj->ji_stat_enc[1]);
+	owner_unlink_job(pj);
+	histjob_unlink(pj);
+	job_alloc_free(pj);
+	reply_job_exec_update_reqs(pj, pj->ji_exec_update_nreqs, PBSE_UNKJOBID, NULL);
+	free(pj->ji_exec_update_reqs);
+#endif
+
 #ifdef PBS_MOM
+	free_attrlist(&pj->ji_ruu_sent);
 
 #ifdef WIN32
 	if (is_jattr_set(pj,  JOB_ATR_altid)) {
@@ -471,7 +508,7 @@ job_free(job *pj)
 			struct passwd *pwdp = NULL;
 
 			if ((get_jattr_str(pj, JOB_ATR_euser)) &&
-				(pwdp = getpwnam(get_jattr_str(pj, JOB_ATR_euser)))) {
+				(pwdp = pbs_getpwnam(get_jattr_str(pj, JOB_ATR_euser)))) {
 				if (pwdp->pw_userlogin != INVALID_HANDLE_VALUE) {
 					if (impersonate_user(pwdp->pw_userlogin) == 0) {
 						sprintf(log_buffer, "Failed to ImpersonateLoggedOnUser user: %s", pwdp->pw_name);
@@ -513,14 +550,19 @@ job_free(job *pj)
 	}
 	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) {
 		if ((pj->ji_parentaj) && (pj->ji_parentaj->ji_ajtrk))
-			pj->ji_parentaj->ji_ajtrk->tkm_tbl[pj->ji_subjindx].trk_psubjob = NULL;
+			set_subjob_ptr(pj->ji_parentaj, pj->ji_subjindx, NULL);
 	} else if (pj->ji_ajtrk) {
 		/* if Arrayjob, free the tracking table structure */
-		for (i = 0; i < pj->ji_ajtrk->tkm_ct; i++) {
-			job *psubj = pj->ji_ajtrk->tkm_tbl[i].trk_psubjob;
-			if (psubj)
+		if (pj->ji_ajtrk->tkm_subjobs != NULL) {
+			void *idx_ctx = NULL;
+			job *psubj = NULL;
+
+			while (pbs_idx_find(pj->ji_ajtrk->tkm_subjobs, NULL, (void **)&psubj, &idx_ctx) == PBS_IDX_RET_OK)
 				psubj->ji_parentaj = NULL;
+			pbs_idx_free_ctx(idx_ctx);
+			pbs_idx_destroy(pj->ji_ajtrk->tkm_subjobs);
 		}
+		subjob_tmpl_end(pj);
 		free_range_list(pj->ji_ajtrk->trk_rlist);
 		free(pj->ji_ajtrk);
 		pj->ji_ajtrk = NULL;
@@ -578,6 +620,9 @@ job_free(job *pj)
 	if (pj->ji_report_task)
 		delete_task(pj->ji_report_task);
 
+	if (pj->ji_walltime_task)
+		delete_task(pj->ji_walltime_task);
+
 	/*
 	 ** This gets rid of any dependent job structure(s) from ji_setup.
 	 */
@@ -600,6 +645,7 @@ job_free(job *pj)
 
 	pj->ji_qs.ji_jobid[0] = 'X';	/* as a "freed" marker */
 	free(pj);	/* now free the main structure */
+	mem_acct_add(MEM_ACCT_JOB, -1, -(long long)sizeof(job));
 }
 
 /**
@@ -1013,11 +1059,6 @@ job_purge(job *pjob)
 	pid_t pid = -1;
 	int child_process = 0;
 
-#else
-	extern char *msg_err_purgejob_db;
-	pbs_db_obj_info_t obj;
-	pbs_db_job_info_t dbjob;
-	void *conn = (void *) svr_db_conn;
 #endif	/* PBS_MOM */
 
 	if (pjob->ji_rerun_preq != NULL) {
@@ -1207,13 +1248,7 @@ job_purge(job *pjob)
 
 #else
 	/* delete job and dependants from database */
-	obj.pbs_db_obj_type = PBS_DB_JOB;
-	obj.pbs_db_un.pbs_db_job = &dbjob;
-	strcpy(dbjob.ji_jobid, pjob->ji_qs.ji_jobid);
-	if (pbs_db_delete_obj(conn, &obj) == -1) {
-		log_joberr(-1, __func__, msg_err_purgejob_db,
-			pjob->ji_qs.ji_jobid);
-	}
+	job_delete_db(pjob);
 
 	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HasNodes)
 		free_nodes(pjob);
@@ -1738,6 +1773,9 @@ resv_free(resc_resv *presv)
 	char *dot = NULL;
 	char *resvid = presv->ri_qs.ri_resvID;
 
+	/* the vnodes may no longer point to it */
+	resv_vnodes_changed();
+
 	/* remove any malloc working attribute space */
 
 	for (i=0; i < (int)RESV_ATR_LAST; i++) {
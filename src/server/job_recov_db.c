@@ -58,6 +58,7 @@
 #include "job.h"
 #include "reservation.h"
 #include "queue.h"
+#include "server.h"
 #include "log.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
@@ -68,18 +69,54 @@
 
 #define MAX_SAVE_TRIES 3
 
+/* flush the deferred job saves once this many are waiting */
+#define JOB_SAVE_BATCH 256
+
 extern void *svr_db_conn;
 extern int server_init_type;
+extern struct server server;
 extern pbs_list_head svr_allresvs;
 #define BACKTRACE_BUF_SIZE 50
 void print_backtrace(char *);
 
 /* global data items */
 extern time_t time_now;
+extern char *msg_err_purgejob_db;
+
+/* jobs with a deferred database save, see job_save_db() */
+static pbs_list_head svr_pendsave_jobs = {&svr_pendsave_jobs, &svr_pendsave_jobs, NULL};
+static int svr_pendsave_ct = 0;
+
+/* ids of purged jobs whose database rows are not deleted yet, see job_delete_db() */
+static char svr_penddel_jobs[JOB_SAVE_BATCH][PBS_MAXSVRJOBID + 1];
+static char svr_penddel_hist[JOB_SAVE_BATCH];	/* the pending delete is of a history table row */
+static int svr_penddel_ct = 0;
+
+/* buffer the binary attribute blob of a job is built in */
+static pbs_db_blob_t job_attr_blob = {NULL, 0, 0};
 
 job *recov_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 resc_resv *recov_resv_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 
+/*
+ * The job attributes that change with nearly every save.  They are kept
+ * in a column of their own, so a save of only them, by far the most
+ * common one, does not write all the other attributes out again.
+ */
+static int job_hot_attrs[] = {
+	JOB_ATR_mtime,
+	JOB_ATR_state,
+	JOB_ATR_substate,
+	JOB_ATR_Comment,
+	JOB_ATR_resc_used,
+	JOB_ATR_eligible_time,
+	JOB_ATR_accrue_type,
+	JOB_ATR_sample_starttime,
+	JOB_ATR_session_id,
+	JOB_ATR_exit_status,
+	JOB_ATR_LAST
+};
+
 /**
  * @brief
  *		convert job structure to DB format
@@ -100,12 +137,39 @@ job_to_db(job *pjob, pbs_db_job_info_t *dbjob)
 	int save_all_attrs = 0;
 
 	strcpy(dbjob->ji_jobid, pjob->ji_qs.ji_jobid);
+	dbjob->ji_hist = pjob->ji_dbhist;
 
 	if (check_job_state(pjob, JOB_STATE_LTR_FINISHED))
 		save_all_attrs = 1;
 
-	if ((encode_attr_db(job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, &dbjob->db_attr_list, save_all_attrs)) != 0)
-		return -1;
+	if (pjob->newobj && (server.sv_attr[SVR_ATR_DbBinaryAttrs].at_flags & ATR_VFLAG_SET) &&
+		server.sv_attr[SVR_ATR_DbBinaryAttrs].at_val.at_long)
+		pjob->ji_attrblob = 1;
+
+	if (pjob->ji_attrblob) {
+		int rc;
+
+		/* the blob buffer is kept across saves */
+		if ((rc = encode_attr_blob(job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, &job_attr_blob, save_all_attrs, pjob->newobj)) == -1)
+			return -1;
+		if (rc == 1) {
+			dbjob->db_attr_blob = job_attr_blob.data;
+			dbjob->db_attr_bloblen = job_attr_blob.len;
+		}
+	} else {
+		static char hot[JOB_ATR_LAST];
+		static int hot_init = 0;
+		int i;
+
+		if (!hot_init) {
+			for (i = 0; job_hot_attrs[i] != JOB_ATR_LAST; i++)
+				hot[job_hot_attrs[i]] = 1;
+			hot_init = 1;
+		}
+		if ((encode_attr_db_split(job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, &dbjob->db_attr_list,
+			&dbjob->db_attr_hot, hot, save_all_attrs)) != 0)
+			return -1;
+	}
 
 	if (pjob->newobj) /* object was never saved/loaded before */
 		savetype |= (OBJ_SAVE_NEW | OBJ_SAVE_QS);
@@ -205,11 +269,16 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 	strcpy(pjob->ji_extended.ji_ext.ji_jid, dbjob->ji_jid);
 	pjob->ji_extended.ji_ext.ji_credtype = dbjob->ji_credtype;
 
-	if ((decode_attr_db(pjob, &dbjob->db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
+	if (dbjob->db_attr_blob) {
+		if ((decode_attr_blob(pjob, dbjob->db_attr_blob, dbjob->db_attr_bloblen, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
+			return -1;
+		pjob->ji_attrblob = 1;
+	} else if ((decode_attr_db(pjob, &dbjob->db_attr_list, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
 		return -1;
 
 	compare_obj_hash(&pjob->ji_qs, sizeof(pjob->ji_qs), pjob->qs_hash);
 
+	pjob->ji_dbhist = dbjob->ji_hist;
 	pjob->newobj = 0;
 
 	return 0;
@@ -217,7 +286,7 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 
 /**
  * @brief
- *		Save job to database
+ *		Write a job to the database right away
  *
  * @param[in]	pjob - The job to save
  *
@@ -227,8 +296,8 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
  * @retval	 1 - Jobid clash, retry with new jobid
  *
  */
-int
-job_save_db(job *pjob)
+static int
+job_save_db_now(job *pjob)
 {
 	pbs_db_job_info_t dbjob = {{0}};
 	pbs_db_obj_info_t obj;
@@ -241,6 +310,8 @@ job_save_db(job *pjob)
 	old_mtime = get_jattr_long(pjob, JOB_ATR_mtime);
 	old_flags = pjob->ji_wattr[JOB_ATR_mtime].at_flags;
 
+	/* the encoded attributes only live until the save is sent */
+	attrlist_arena_begin();
 	if ((savetype = job_to_db(pjob, &dbjob)) == -1)
 		goto done;
 
@@ -249,11 +320,26 @@ job_save_db(job *pjob)
 
 	/* update mtime before save, so the same value gets to the DB as well */
 	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
-	if ((rc = pbs_db_save_obj(conn, &obj, savetype)) == 0)
+	if ((rc = pbs_db_save_obj(conn, &obj, savetype)) == 0) {
 		pjob->newobj = 0;
 
+		/*
+		 * A finished job leaves the active jobs table for the history
+		 * tables.  A moved job stays behind, it is only purged once it
+		 * finished at the remote server, whatever its age.
+		 */
+		if (!pjob->ji_dbhist && pjob->ji_histjobs.ll_next != NULL &&
+			pjob->ji_histjobs.ll_next != &pjob->ji_histjobs &&
+			!check_job_state(pjob, JOB_STATE_LTR_MOVED)) {
+			if ((rc = pbs_db_move_job_hist(conn, &obj)) == 0)
+				pjob->ji_dbhist = 1;
+		}
+	}
+
 done:
 	free_db_attr_list(&dbjob.db_attr_list);
+	free_db_attr_list(&dbjob.db_attr_hot);
+	attrlist_arena_end();
 
 	if (rc != 0) {
 		/* revert mtime, flags update */
@@ -275,6 +361,264 @@ done:
 	return (rc);
 }
 
+/**
+ * @brief
+ *		Save job to database
+ *
+ * @par
+ *		A job that is already in the database is not written right away,
+ *		it is put on the list of deferred saves instead.  Saving the same
+ *		job again before the list is flushed costs nothing, and the list
+ *		is written in a single transaction by job_save_db_flush(), which
+ *		runs before any reply goes out to a client, or sent without
+ *		waiting by job_save_db_send(), once per pass of the server main
+ *		loop.  A new job is always written right away, so
+ *		a jobid clash is still reported to the caller.
+ *
+ * @param[in]	pjob - The job to save
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ * @retval	 1 - Jobid clash, retry with new jobid
+ *
+ */
+int
+job_save_db(job *pjob)
+{
+	/* a compacted history job must write all of its attributes */
+	if (pjob->ji_histcompact && histjob_expand(pjob) != 0)
+		return -1;
+
+	if (pjob->newobj) {
+		/* a pending delete may still hold the same jobid */
+		if (svr_penddel_ct > 0)
+			job_save_db_send();
+		return (job_save_db_now(pjob));
+	}
+
+	/* keep mtime current in memory, the deferred save writes it out */
+	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
+
+	if (pjob->ji_pendsave.ll_next != &pjob->ji_pendsave)
+		return 0;
+
+	append_link(&svr_pendsave_jobs, &pjob->ji_pendsave, pjob);
+	if (++svr_pendsave_ct >= JOB_SAVE_BATCH)
+		job_save_db_send();
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		Completion callback of a batch of deferred job saves sent by
+ *		job_save_db_send
+ *
+ * @param[in]	conn - The database connection
+ * @param[in]	rc   - 0 if the batch committed
+ * @param[in]	arg  - Unused
+ *
+ * @return	void
+ */
+static void
+job_save_db_done(void *conn, int rc, void *arg)
+{
+	char *conn_db_err = NULL;
+
+	if (rc == 0)
+		return;
+
+	pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+	log_errf(PBSE_INTERNAL, __func__, "Failed to commit deferred job saves %s", conn_db_err ? conn_db_err : "");
+	free(conn_db_err);
+	panic_stop_db();
+}
+
+/**
+ * @brief
+ *		Send all deferred job saves to the database in one transaction,
+ *		without waiting for the database to complete it.  The outcome
+ *		is collected later from the server main loop, or by the next
+ *		statement that has to wait for the database anyway.  Falls back
+ *		to a synchronous transaction if the connection cannot pipeline.
+ *
+ * @see
+ *		job_save_db_flush
+ *
+ * @return	void
+ */
+void
+job_save_db_send(void)
+{
+	job *pjob;
+	int trx = 0;
+	int async;
+	int i;
+	pbs_db_job_info_t dbjob;
+	pbs_db_obj_info_t obj;
+
+	if (svr_pendsave_ct == 0 && svr_penddel_ct == 0)
+		return;
+
+	if (!(async = (pbs_db_async_begin(svr_db_conn) == 0)))
+		trx = (pbs_db_begin_trx(svr_db_conn) == 0);
+
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &dbjob;
+	for (i = 0; i < svr_penddel_ct; i++) {
+		strcpy(dbjob.ji_jobid, svr_penddel_jobs[i]);
+		dbjob.ji_hist = svr_penddel_hist[i];
+		if (pbs_db_delete_obj(svr_db_conn, &obj) == -1)
+			log_joberr(-1, __func__, msg_err_purgejob_db, svr_penddel_jobs[i]);
+	}
+	svr_penddel_ct = 0;
+
+	while ((pjob = (job *)GET_NEXT(svr_pendsave_jobs)) != NULL) {
+		delete_link(&pjob->ji_pendsave);
+		svr_pendsave_ct--;
+		(void)job_save_db_now(pjob);
+		/* the database has all of a history job now */
+		histjob_compact(pjob);
+	}
+	svr_pendsave_ct = 0;
+
+	if (async)
+		(void)pbs_db_async_end(svr_db_conn, job_save_db_done, NULL);
+	else if (trx)
+		job_save_db_done(svr_db_conn, pbs_db_end_trx(svr_db_conn, 1), NULL);
+}
+
+/**
+ * @brief
+ *		Write all deferred job saves to the database in one transaction
+ *		and wait until it is committed.  Used before a reply goes out,
+ *		so a client never sees a change the database does not have yet.
+ *		Also waits for the batches already in flight, a full batch sent
+ *		by job_save_db may hold changes of the request being replied to.
+ *
+ * @see
+ *		job_save_db
+ *
+ * @return	void
+ */
+void
+job_save_db_flush(void)
+{
+	job_save_db_send();
+	/* returns right away when no batch is outstanding */
+	(void)pbs_db_async_poll(svr_db_conn, 1);
+}
+
+/**
+ * @brief
+ *		Write the deferred save of one job, if it has one, right away
+ *
+ * @param[in]	pjob - The job
+ *
+ * @return	void
+ */
+void
+job_save_db_sync(job *pjob)
+{
+	if (pjob->ji_pendsave.ll_next == &pjob->ji_pendsave)
+		return;
+
+	delete_link(&pjob->ji_pendsave);
+	svr_pendsave_ct--;
+	(void)job_save_db_now(pjob);
+}
+
+/**
+ * @brief
+ *		Drop the deferred save of a job that is being removed from
+ *		the database
+ *
+ * @param[in]	pjob - The job
+ *
+ * @return	void
+ */
+void
+job_save_db_cancel(job *pjob)
+{
+	if (pjob->ji_pendsave.ll_next == &pjob->ji_pendsave)
+		return;
+
+	delete_link(&pjob->ji_pendsave);
+	svr_pendsave_ct--;
+}
+
+/**
+ * @brief
+ *		Tell whether a job in the database history tables has expired.
+ *		Its row stays until the day it finished on is dropped.
+ *
+ * @param[in]	pjob - The job
+ *
+ * @return	int
+ * @retval	1 - the history job expired
+ * @retval	0 - otherwise
+ */
+static int
+job_hist_expired_db(job *pjob)
+{
+	return (pjob->ji_dbhist && svr_history_enable &&
+		time_now >= get_jattr_long(pjob, JOB_ATR_history_timestamp) + svr_history_duration);
+}
+
+/**
+ * @brief
+ *		Delete a purged job and its script from the database.  Like
+ *		the deferred saves, the delete is only queued, and goes to the
+ *		database in the same transaction as them, so purging many jobs
+ *		at once costs a single commit.
+ *
+ * @param[in]	pjob - The job being purged
+ *
+ * @return	void
+ */
+void
+job_delete_db(job *pjob)
+{
+	job_save_db_cancel(pjob);
+
+	/* expired history goes with its partition, see job_hist_expire_db() */
+	if (job_hist_expired_db(pjob))
+		return;
+
+	if (svr_penddel_ct >= JOB_SAVE_BATCH)
+		job_save_db_send();
+	svr_penddel_hist[svr_penddel_ct] = pjob->ji_dbhist;
+	strcpy(svr_penddel_jobs[svr_penddel_ct++], pjob->ji_qs.ji_jobid);
+}
+
+/**
+ * @brief
+ *		Drop the days of job history that expired before a given time
+ *		from the database.  Purging an expired history job leaves its
+ *		row alone, see job_delete_db(), the whole day it finished on is
+ *		dropped here instead once all of its jobs expired.
+ *
+ * @param[in]	before - History jobs that finished before this time expired
+ *
+ * @return	void
+ */
+void
+job_hist_expire_db(time_t before)
+{
+	int dropped;
+	char *conn_db_err = NULL;
+
+	if ((dropped = pbs_db_expire_job_hist(svr_db_conn, before)) == -1) {
+		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+		log_errf(PBSE_INTERNAL, __func__, "Failed to drop expired job history %s", conn_db_err ? conn_db_err : "");
+		free(conn_db_err);
+	} else if (dropped > 0) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, msg_daemonname,
+			"Dropped %d expired day(s) of job history", dropped);
+	}
+}
+
 /**
  * @brief
  *	Utility function called inside job_recov_db
@@ -332,6 +676,8 @@ job_recov_db(char *jid, job *pjob)
 	char *conn_db_err = NULL;
 	
 	strcpy(dbjob.ji_jobid, jid);
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &dbjob;
 
 	rc = pbs_db_load_obj(conn, &obj);
 	if (rc == -2)
@@ -346,6 +692,7 @@ job_recov_db(char *jid, job *pjob)
 	}
 
 	free_db_attr_list(&dbjob.db_attr_list);
+	free(dbjob.db_attr_blob);
 
 	return (pjob);
 }
@@ -456,6 +803,8 @@ resv_save_db(resc_resv *presv)
 	old_mtime = presv->ri_wattr[RESV_ATR_mtime].at_val.at_long;
 	old_flags = presv->ri_wattr[RESV_ATR_mtime].at_flags;
 
+	/* the encoded attributes only live until the save is sent */
+	attrlist_arena_begin();
 	if ((savetype = resv_to_db(presv, &dbresv)) == -1)
 		goto done;
 
@@ -470,6 +819,7 @@ resv_save_db(resc_resv *presv)
 
 done:
 	free_db_attr_list(&dbresv.db_attr_list);
+	attrlist_arena_end();
 
 	if (rc != 0) {
 		presv->ri_wattr[RESV_ATR_mtime].at_val.at_long = old_mtime;
@@ -586,6 +936,8 @@ recov_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed)
 
 err:
 	free_db_attr_list(&dbjob->db_attr_list);
+	free(dbjob->db_attr_blob);
+	dbjob->db_attr_blob = NULL;
 	if (pj == NULL)
 		log_errf(PBSE_SYSTEM, __func__, "Failed to recover job %s", dbjob->ji_jobid);
 	return pj;
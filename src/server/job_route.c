@@ -49,6 +49,8 @@
  *	is_bad_dest()	- Check the job for a match of dest in the list of rejected destinations.
  *	default_router()	- basic function for "routing" jobs.
  *	queue_route()	- route any "ready" jobs in a specific queue
+ *	route_changed()	- something a routing decision depends on changed
+ *	route_wakeup()	- a job in a routing queue wants to be routed
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -78,6 +80,7 @@
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include <memory.h>
+#include <limits.h>
 
 
 /* Local Functions */
@@ -85,6 +88,14 @@
 
 /* Global Data */
 
+/*
+ * Generation of the things a local routing decision depends on: queue and
+ * server attributes, queue contents and job states.  A job, or a whole
+ * destination, turned away at the current generation is not tried again
+ * until it changes, see route_changed().
+ */
+static long route_gen = 1;
+
 extern char	*msg_badstate;
 extern char	*msg_routexceed;
 extern char	*msg_routebad;
@@ -150,6 +161,84 @@ is_bad_dest(job	*jobp, char *dest)
 }
 
 
+/**
+ * @brief
+ * 		Note that something a routing decision depends on changed, so that
+ *		jobs and destinations which were turned away are tried again.
+ *
+ * @return	void
+ */
+void
+route_changed(void)
+{
+	route_gen++;
+}
+
+/**
+ * @brief
+ * 		A job entered a routing queue, or changed so that it may be routed
+ *		now: make queue_route() look at it on its next pass.
+ *
+ * @param[in,out]	pjob - job
+ *
+ * @return	void
+ */
+void
+route_wakeup(job *pjob)
+{
+	pbs_queue *pque = pjob->ji_qhdr;
+
+	pjob->ji_routegen = 0;
+	if (pque != NULL && pque->qu_qs.qu_type == QTYPE_RoutePush)
+		pque->qu_route_next = 0;
+}
+
+/**
+ * @brief
+ * 		Check whether a destination of a routing queue turned away every
+ *		job since the last change, see dest_rejects_all_set().
+ *
+ * @param[in]	qp - routing queue
+ * @param[in]	i - index of the destination in route_destinations
+ *
+ * @return	int
+ * @retval	1	- the destination rejects any job
+ * @retval	0	- it has to be tried
+ */
+static int
+dest_rejects_all(pbs_queue *qp, int i)
+{
+	return (i < qp->qu_route_ndest && qp->qu_route_destgen[i] == route_gen);
+}
+
+/**
+ * @brief
+ * 		Remember that a destination turned a job away for a reason which
+ *		does not depend on the job (it is disabled or full), so the other
+ *		jobs of the routing queue skip it until something changes.
+ *
+ * @param[in,out]	qp - routing queue
+ * @param[in]	i - index of the destination in route_destinations
+ * @param[in]	ndest - number of destinations
+ *
+ * @return	void
+ */
+static void
+dest_rejects_all_set(pbs_queue *qp, int i, int ndest)
+{
+	long *gens;
+
+	if (i >= qp->qu_route_ndest) {
+		gens = realloc(qp->qu_route_destgen, ndest * sizeof(long));
+		if (gens == NULL)
+			return;
+		memset(gens + qp->qu_route_ndest, 0, (ndest - qp->qu_route_ndest) * sizeof(long));
+		qp->qu_route_destgen = gens;
+		qp->qu_route_ndest = ndest;
+	}
+	qp->qu_route_destgen[i] = route_gen;
+}
+
 /**
  * @brief
  * 		default_router - basic function for "routing" jobs.
@@ -159,6 +248,10 @@ is_bad_dest(job	*jobp, char *dest)
  *		If no destination will accept the job, PBSE_ROUTEREJ is returned,
  *		otherwise 0 is returned.
  *
+ *		A job turned away by local destinations only is not tried again
+ *		before something changes, see route_changed().  Remote
+ *		destinations are retried after retry_time.
+ *
  * @see
  * 		site_alt_router and job_route.
  *
@@ -177,6 +270,7 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 	struct array_strings *dest_attr = NULL;
 	char		     *destination;
 	int		      last;
+	int		      remote = 0;
 
 	if (qp->qu_attr[(int)QR_ATR_RouteDestin].at_flags & ATR_VFLAG_SET) {
 		dest_attr = qp->qu_attr[(int)QR_ATR_RouteDestin].at_val.at_arst;
@@ -200,6 +294,12 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 				/* set time to retry job */
 				jobp->ji_qs.ji_un.ji_routet.ji_rteretry = retry_time;
 				jobp->ji_retryok = 0;
+				if (remote) {
+					jobp->ji_routegen = 0;
+					if (retry_time < qp->qu_route_next)
+						qp->qu_route_next = retry_time;
+				} else
+					jobp->ji_routegen = route_gen;
 				return (0);
 			}
 		}
@@ -209,6 +309,11 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 		if (is_bad_dest(jobp, destination))
 			continue;
 
+		if (dest_rejects_all(qp, jobp->ji_lastdest - 1)) {
+			jobp->ji_retryok = 1;
+			continue;
+		}
+
 		switch (svr_movejob(jobp, destination, NULL)) {
 
 			case -1:		/* permanent failure */
@@ -221,11 +326,34 @@ default_router(job *jobp, struct pbs_queue *qp, long retry_time)
 
 			case 1:		/* failed, but try destination again */
 				jobp->ji_retryok = 1;
+				if (strchr(destination, '@') != NULL)
+					remote = 1;
+				else if ((pbs_errno == PBSE_QUNOENB) || (pbs_errno == PBSE_MAXQUED))
+					dest_rejects_all_set(qp, jobp->ji_lastdest - 1, last);
 				break;
 		}
 	}
 }
 
+/**
+ * @brief
+ * 		Time at which a job has been too long in its routing queue.
+ *
+ * @param[in]	jobp - job
+ * @param[in]	qp - routing queue of the job
+ *
+ * @return	time_t
+ * @retval	0	- the job may stay forever
+ */
+static time_t
+route_life(job *jobp, pbs_queue *qp)
+{
+	if (qp->qu_attr[(int)QR_ATR_RouteLifeTime].at_flags & ATR_VFLAG_SET)
+		return (jobp->ji_qs.ji_un.ji_routet.ji_quetime +
+			qp->qu_attr[(int)QR_ATR_RouteLifeTime].at_val.at_long);
+	return 0;	/* forever */
+}
+
 /**
  * @brief
  * 		job_route - route a job to another queue
@@ -296,13 +424,17 @@ job_route(job *jobp)
 	/* check the queue limits, can we route any (more) */
 
 	qp = jobp->ji_qhdr;
-	if (qp->qu_attr[(int)QA_ATR_Started].at_val.at_long == 0)
+	if (qp->qu_attr[(int)QA_ATR_Started].at_val.at_long == 0) {
+		jobp->ji_routegen = route_gen;
 		return (0);	/* queue not started - no routing */
+	}
 
 	if ((qp->qu_attr[(int)QA_ATR_MaxRun].at_flags & ATR_VFLAG_SET) &&
 		(qp->qu_attr[(int)QA_ATR_MaxRun].at_val.at_long <=
-		qp->qu_njstate[JOB_STATE_TRANSIT]))
+		qp->qu_njstate[JOB_STATE_TRANSIT])) {
+		jobp->ji_routegen = route_gen;
 		return (0);	/* max number of jobs being routed */
+	}
 
 	/* what is the retry time and life time of a job in this queue */
 
@@ -312,21 +444,17 @@ job_route(job *jobp)
 	else
 		retry_time = (long)time_now + PBS_NET_RETRY_TIME;
 
-	if (qp->qu_attr[(int)QR_ATR_RouteLifeTime].at_flags & ATR_VFLAG_SET)
-
-		life = jobp->ji_qs.ji_un.ji_routet.ji_quetime +
-			qp->qu_attr[(int)QR_ATR_RouteLifeTime].at_val.at_long;
-	else
-		life = 0;	/* forever */
-
+	life = route_life(jobp, qp);
 	if (life && (life < time_now)) {
 		log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 			jobp->ji_qs.ji_jobid, msg_routexceed);
 		return (PBSE_ROUTEEXPD);   /* job too long in queue */
 	}
 
-	if (bad_state) 	/* not currently routing this job */
+	if (bad_state) {	/* not currently routing this job */
+		jobp->ji_routegen = route_gen;
 		return (0);		   /* else ignore this job */
+	}
 
 	if (qp->qu_attr[(int)QR_ATR_AltRouter].at_val.at_long == 0)
 		return (default_router(jobp, qp, retry_time));
@@ -346,6 +474,11 @@ job_route(job *jobp)
  *		Transiting state is less than the max_running limit, then
  *		attempt to route it.
  *
+ *		A job which could not be routed at the current generation waits
+ *		for route_changed() unless its route_lifetime runs out.  The
+ *		queue itself is only looked at again when something changed,
+ *		a job arrived (route_wakeup()) or the earliest timed retry is due.
+ *
  * @see
  * 		main
  *
@@ -360,12 +493,28 @@ queue_route(pbs_queue *pque)
 	job *nxjb;
 	job *pjob;
 	int  rc;
+	int  alt;
+	time_t life;
 
+	/* a site router keeps its own retry times, look at it on every pass */
+	alt = (pque->qu_attr[(int)QR_ATR_AltRouter].at_val.at_long != 0);
+	if (!alt && (pque->qu_route_gen == route_gen) && (pque->qu_route_next > time_now))
+		return;
+	pque->qu_route_gen = route_gen;
+	pque->qu_route_next = LONG_MAX;
 
 	pjob = (job *)GET_NEXT(pque->qu_jobs);
 	while (pjob) {
 		nxjb = (job *)GET_NEXT(pjob->ji_jobque);
-		if (pjob->ji_qs.ji_un.ji_routet.ji_rteretry <= time_now) {
+		if (!alt && (pjob->ji_routegen == route_gen) &&
+			(((life = route_life(pjob, pque)) == 0) || (life >= time_now))) {
+			/* nothing changed since it was turned away */
+			if (life && (life + 1 < pque->qu_route_next))
+				pque->qu_route_next = life + 1;
+		} else if (pjob->ji_qs.ji_un.ji_routet.ji_rteretry > time_now) {
+			if (pjob->ji_qs.ji_un.ji_routet.ji_rteretry < pque->qu_route_next)
+				pque->qu_route_next = pjob->ji_qs.ji_un.ji_routet.ji_rteretry;
+		} else {
 			if ((rc = job_route(pjob)) == PBSE_ROUTEREJ)
 				job_abt(pjob, msg_routebad);
 			else if (rc == PBSE_ROUTEEXPD)
@@ -312,6 +312,10 @@ initialize_pbsnode(struct pbsnode *pnode, char *pname, int ntype)
 	pnode->newobj = 1;
 	pnode->nd_lic_info = NULL;
 	pnode->nd_added_to_unlicensed_list = 0;
+	pnode->nd_stat_conn = -1;
+	pnode->nd_stat_digest = 0;
+	pnode->nd_sched = NULL;
+	pnode->nd_sched_gen = 0;
 	pnode->nd_moms    = (struct mominfo **)calloc(1, sizeof(struct mominfo *));
 	if (pnode->nd_moms == NULL)
 		return (PBSE_SYSTEM);
@@ -511,6 +515,7 @@ free_pnode(struct pbsnode *pnode)
 		(void)free(pnode->nd_name);
 		(void)free(pnode->nd_hostname);
 		(void)free(pnode->nd_moms);
+		(void)free(pnode->nd_resv);
 		(void)free(pnode); /* delete the pnode from memory */
 	}
 }
@@ -785,6 +790,55 @@ save_nodes_db_inner(void)
 	return 0;
 }
 
+/**
+ * @brief
+ *		Clear the ATR_VFLAG_MODIFY bit on each attribute of the given nodes
+ *		and on the node_group_key resource, for those nodes that possess a
+ *		node_group_key resource, once they have been saved.
+ *
+ * @param[in]	nodes - the saved nodes
+ * @param[in]	count - number of entries in nodes
+ *
+ * @return	void
+ */
+static void
+clear_nodes_modify(struct pbsnode **nodes, int count)
+{
+	struct pbsnode *np;
+	attribute    *pattr;
+	resource     *resc;
+	char         *rname;
+	resource_def *rscdef;
+	int	i;
+	int	num;
+
+	if (server.sv_attr[SVR_ATR_NodeGroupKey].at_flags & ATR_VFLAG_SET  &&
+		server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str)
+		rname = server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str;
+	else
+		rname = NULL;
+
+	if (rname)
+		rscdef = find_resc_def(svr_resc_def, rname);
+	else
+		rscdef = NULL;
+
+	for (i = 0; i < count; i++) {
+		np = nodes[i];
+		if (np->nd_state & INUSE_DELETED)
+			continue;
+
+		for (num = 0; num < ND_ATR_LAST; num++)
+			np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
+
+		if (rscdef != NULL) {
+			pattr = &np->nd_attr[ND_ATR_ResourceAvail];
+			if ((resc = find_resc_entry(pattr, rscdef)))
+				resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
+		}
+	}
+}
+
 /**
  * @brief
  *		When called, this function will update
@@ -806,15 +860,8 @@ save_nodes_db_inner(void)
 int
 save_nodes_db(int changemodtime, void *p)
 {
-	struct pbsnode  *np;
 	pbs_db_mominfo_time_t mom_tm = {0, 0};
 	pbs_db_obj_info_t obj;
-	int           num;
-	attribute    *pattr;
-	resource     *resc;
-	char         *rname;
-	resource_def *rscdef;
-	int	i;
 	mominfo_t    *pmom = (mominfo_t *) p;
 	char *conn_db_err = NULL;
 
@@ -836,6 +883,9 @@ save_nodes_db(int changemodtime, void *p)
 		return (-1);
 	}
 
+	if (pbs_db_begin_trx(svr_db_conn) != 0)
+		goto db_err;
+
 	/* insert/update the mominfo_time to db */
 	mom_tm.mit_time = mominfo_time.mit_time;
 	mom_tm.mit_gen = mominfo_time.mit_gen;
@@ -844,52 +894,70 @@ save_nodes_db(int changemodtime, void *p)
 
 	if (pbs_db_save_obj(svr_db_conn, &obj, OBJ_SAVE_QS) == 1) {/* no row updated */
 		if (pbs_db_save_obj(svr_db_conn, &obj, OBJ_SAVE_NEW) != 0) /* insert also failed */
-			goto db_err;
+			goto db_trx_err;
 	}
 
 	if (pmom) {
 		if (save_nodes_db_mom(pmom) == -1)
-			goto db_err;
+			goto db_trx_err;
 	} else {
 		if (save_nodes_db_inner() == -1)
-			goto db_err;
+			goto db_trx_err;
 	}
 
-	/*
-	 * Clear the ATR_VFLAG_MODIFY bit on each node attribute
-	 * and on the node_group_key resource, for those nodes
-	 * that possess a node_group_key resource
-	 */
-
-	if (server.sv_attr[SVR_ATR_NodeGroupKey].at_flags & ATR_VFLAG_SET  &&
-		server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str)
-		rname = server.sv_attr[SVR_ATR_NodeGroupKey].at_val.at_str;
-	else
-		rname = NULL;
-
-	if (rname)
-		rscdef = find_resc_def(svr_resc_def, rname);
-	else
-		rscdef = NULL;
+	if (pbs_db_end_trx(svr_db_conn, 1) != 0)
+		goto db_err;
 
-	for (i=0; i<svr_totnodes; i++) {
-		np = pbsndlist[i];
-		if (np->nd_state & INUSE_DELETED)
-			continue;
+	clear_nodes_modify(pbsndlist, svr_totnodes);
+	return (0);
 
-		for (num=0; num<ND_ATR_LAST; num++) {
+db_trx_err:
+	(void) pbs_db_end_trx(svr_db_conn, 0);
+db_err:
+	pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+	log_errf(-1, __func__, "Unable to save node to the database %s", conn_db_err ? conn_db_err: "");
+	free(conn_db_err);
+	panic_stop_db();
+	return (-1);
+}
 
-			np->nd_attr[num].at_flags &= ~ATR_VFLAG_MODIFY;
+/**
+ * @brief
+ *		Save just the given vnodes to the db, under a single transaction.
+ *		Used by bulk manager requests which change a known set of vnodes,
+ *		so that they need not rewrite every node on the server.
+ *
+ * @param[in]	nodes - the vnodes to save
+ * @param[in]	count - number of entries in nodes
+ *
+ * @return	error code
+ * @retval	-1 - Failure
+ * @retval	 0 - Success
+ *
+ */
+int
+save_nodes_db_list(struct pbsnode **nodes, int count)
+{
+	int	i;
+	char *conn_db_err = NULL;
 
-			if (num == ND_ATR_ResourceAvail)
-				if (rname != NULL && rscdef != NULL) {
-					pattr = &np->nd_attr[ND_ATR_ResourceAvail];
-					if ((resc = find_resc_entry(pattr, rscdef)))
-						resc->rs_value.at_flags &= ~ATR_VFLAG_MODIFY;
-				}
+	if (pbs_db_begin_trx(svr_db_conn) != 0)
+		goto db_err;
 
+	for (i = 0; i < count; i++) {
+		if (nodes[i]->nd_state & INUSE_DELETED)
+			continue;
+		if (node_save_db(nodes[i]) != 0) {
+			log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, LOG_WARNING, "nodes", nodeerrtxt);
+			(void) pbs_db_end_trx(svr_db_conn, 0);
+			goto db_err;
 		}
 	}
+
+	if (pbs_db_end_trx(svr_db_conn, 1) != 0)
+		goto db_err;
+
+	clear_nodes_modify(nodes, count);
 	return (0);
 
 db_err:
@@ -91,6 +91,7 @@
 #include	"provision.h"
 #include 	"pbs_sched.h"
 #include	"svrfunc.h"
+#include	"pbs_idx.h"
 
 #if !defined(H_ERRNO_DECLARED)
 extern int h_errno;
@@ -155,18 +156,10 @@ extern void propagate_licenses_to_vnodes(mominfo_t *pmom);
 #define MAX_NODE_WAIT 600
 
 /*
- * Tree search generalized from Knuth (6.2.2) Algorithm T just like
- * the AT&T man page says.
- *
- * The tree structure is for internal use only, lint doesn't grok it.
- *
- * Written by reading the System V Interface Definition, not the code.
- *
- */
-/*LINTLIBRARY*/
-
-/*
- **      Modified by Tom Proett for PBS.
+ * The "trees" map a pair of numbers (ip address and port, or stream
+ * number and 0) to the mominfo_t of a Mom.  They are kept in a pbs_idx,
+ * which stays balanced; the unbalanced search tree used before degenerated
+ * to a list for the sequential addresses most clusters use.
  */
 
 struct	tree	*ipaddrs = NULL;	/* tree of ip addrs */
@@ -174,22 +167,6 @@ struct	tree	*streams = NULL;	/* tree of stream numbers */
 
 extern pntPBS_IP_LIST pbs_iplist;
 
-static int
-comp_keys(u_long key1, u_long key2, struct tree *pt)
-{
-	if (key1 == pt->key1) {
-		if (key2 == pt->key2)
-			return 0;
-		else if (key2 < pt->key2)
-			return -1;
-		else
-			return 1;
-	} else if (key1 < pt->key1)
-		return -1;
-	else
-		return 1;
-}
-
 /**
  * @brief
  *  	find value in tree, return NULL if not found
@@ -207,67 +184,61 @@ comp_keys(u_long key1, u_long key2, struct tree *pt)
 mominfo_t *
 tfind2(const u_long key1, const u_long key2, struct tree **rootp)
 {
-	if (rootp == NULL)
-		return NULL;
+	struct tree_key tk;
+	void *key = &tk;
+	mominfo_t *momp = NULL;
 
-	while (*rootp != NULL) {		/* Knuth's T1: */
-		int i;
+	if (rootp == NULL || *rootp == NULL)
+		return NULL;
 
-		i = comp_keys(key1, key2, *rootp);
-		if (i == 0)
-			return (*rootp)->momp;	/* we found it! */
-		else if (i < 0)
-			rootp = &(*rootp)->left; /* T3: follow left branch */
-		else
-			rootp = &(*rootp)->right; /* T4: follow right branch */
-	}
-	return NULL;
+	tk.key1 = key1;
+	tk.key2 = key2;
+	if (pbs_idx_find((*rootp)->t_idx, &key, (void **)&momp, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	return momp;
 }
 /**
  * @brief
- *  	insert a mom on the tree.
+ *  	insert a mom on the tree.  The tree is an index so that mass
+ *	lookups, such as the hellos of all Moms after a network outage,
+ *	do not depend on the order the addresses came in.
  *
  * @param[in]	key1	-	key to be located
  * @param[in]	key2	-	key to be located
  * @param[in]	momp 	-	key to be located
  * @param[in,out]	rootp 	-	address of tree root
  *
- * @return	mominfo_t *
- * @retval	a pointer to the mominfo_t object located in the tree	- found
- * @retval	NULL	- not found
+ * @return	void
  *
  * @par MT-safe: No
  */
 void
 tinsert2(const u_long key1, const u_long key2, mominfo_t *momp, struct tree **rootp)
 {
-	int		 i;
-	struct	tree	*q;
+	struct tree_key tk;
 
 	DBPRT(("tinsert2: %lu|%lu %s stream %d\n", key1, key2,
 		momp->mi_host, ((mom_svrinfo_t *)(momp->mi_data))->msr_stream))
 
 	if (rootp == NULL)
 		return;
-	while (*rootp != NULL) {	/* Knuth's T1: */
-		i = comp_keys(key1, key2, *rootp);
-		if (i == 0)
-			return;			/* we found it! */
-		else if (i < 0)
-			rootp = &(*rootp)->left; /* T3: follow left branch */
-		else
-			rootp = &(*rootp)->right; /* T4: follow right branch */
-	}
-	q = (struct tree *)malloc(sizeof(struct tree));
-	/* T5: key not found */
-	if (q != NULL) {			/* make new node */
-		*rootp = q;			/* link new node to old */
-		q->key1 = key1;			/* initialize new node */
-		q->key2 = key2;			/* initialize new node */
-		q->momp = momp;
-		q->left = q->right = NULL;
+	if (*rootp == NULL) {
+		if ((*rootp = (struct tree *)malloc(sizeof(struct tree))) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return;
+		}
+		if (((*rootp)->t_idx = pbs_idx_create(0, sizeof(struct tree_key))) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			free(*rootp);
+			*rootp = NULL;
+			return;
+		}
 	}
-	return;
+
+	tk.key1 = key1;
+	tk.key2 = key2;
+	/* an existing entry stays */
+	(void)pbs_idx_insert((*rootp)->t_idx, &tk, momp);
 }
 
 /**
@@ -408,41 +379,17 @@ reply_hellosvr(int stream, int need_inv)
 void *
 tdelete2(const u_long key1, const u_long key2, struct tree **rootp)
 {
-	struct	tree	*p;
-	struct	tree	*q;
-	struct	tree	*r;
-	int		 i;
+	struct tree_key tk;
 
 	DBPRT(("tdelete2: %lu|%lu\n", key1, key2))
-	if (rootp == NULL || (p = *rootp) == NULL)
+	if (rootp == NULL || *rootp == NULL)
 		return NULL;
-	while ((i = comp_keys(key1, key2, *rootp)) != 0) {
-		p = *rootp;
-		rootp = (i < 0) ?
-			&(*rootp)->left :		/* left branch */
-		&(*rootp)->right;		/* right branch */
-		if (*rootp == NULL)
-			return NULL;		/* key not found */
-	}
-	r = (*rootp)->right;				/* D1: */
-	if ((q = (*rootp)->left) == NULL)		/* Left */
-		q = r;
-	else if (r != NULL) {		/* Right is null? */
-		if (r->left == NULL) {	/* D2: Find successor */
-			r->left = q;
-			q = r;
-		}
-		else {		/* D3: Find NULL link */
-			for (q = r->left; q->left != NULL; q = r->left)
-				r = q;
-			r->left = q->right;
-			q->left = (*rootp)->left;
-			q->right = (*rootp)->right;
-		}
-	}
-	free((struct tree *) *rootp);	/* D4: Free node */
-	*rootp = q;			/* link parent to new node */
-	return (p);
+
+	tk.key1 = key1;
+	tk.key2 = key2;
+	if (pbs_idx_delete((*rootp)->t_idx, &tk) != PBS_IDX_RET_OK)
+		return NULL;
+	return (*rootp);
 }
 /**
  * @brief
@@ -457,8 +404,7 @@ tfree2(struct tree **rootp)
 {
 	if (rootp == NULL || *rootp == NULL)
 		return;
-	tfree2(&(*rootp)->left);
-	tfree2(&(*rootp)->right);
+	pbs_idx_destroy((*rootp)->t_idx);
 	free(*rootp);
 	*rootp = NULL;
 }
@@ -483,6 +429,7 @@ get_addr_of_nodebyname(char *name, unsigned int *port)
 {
 	char        *nodename;
 	struct pbsnode *np;
+	mom_svrinfo_t *psvrmom;
 
 	nodename = parse_servername(name, NULL);
 	/* ignore the port which might have been found in the string */
@@ -490,8 +437,11 @@ get_addr_of_nodebyname(char *name, unsigned int *port)
 	if ((np == 0) ||
 		((np->nd_attr[(int)ND_ATR_Mom].at_flags & ATR_VFLAG_SET) == 0))
 		return (0);
-	/* address and port from mom_svrinfo */
+	/* address and port from mom_svrinfo, resolved when the Mom was created */
 	*port = np->nd_moms[0]->mi_port;
+	psvrmom = (mom_svrinfo_t *)np->nd_moms[0]->mi_data;
+	if ((psvrmom != NULL) && (psvrmom->msr_addrs != NULL) && (psvrmom->msr_addrs[0] != 0))
+		return ((pbs_net_t)psvrmom->msr_addrs[0]);
 	return (get_hostaddr(np->nd_moms[0]->mi_host));
 }
 
@@ -502,6 +452,64 @@ enum Set_All_State_When {
 	Set_All_State_All_Offline /* set on vnodes when all Moms are offline */
 };
 
+/**
+ * @brief
+ *	Set the default comment of a vnode for set_all_state().
+ *
+ * @par
+ *	The comment is changed only if it is a default comment (set by the
+ *	server and not the Manager); if "txt" is null, it is just cleared
+ *	(unset).  Comments set as part of INUSE_OFFLINE_BY_MOM state action
+ *	should not be touched.
+ *
+ * @param[in]	pvnd	- the vnode
+ * @param[in]	do_set	- the state bits are being set, not cleared
+ * @param[in]	bits	- the state bits
+ * @param[in]	txt	- the comment, may be NULL
+ * @param[in]	check	- only tell whether the comment would change
+ *
+ * @return int
+ * @retval	1	- the comment is, or would be, changed
+ * @retval	0	- the comment stays as it is
+ */
+static int
+set_all_state_comment(struct pbsnode *pvnd, int do_set, unsigned long bits, char *txt, int check)
+{
+	attribute *pat = &pvnd->nd_attr[(int)ND_ATR_Comment];
+	int	   dflt;
+
+	if (!((bits & INUSE_OFFLINE_BY_MOM) ||
+		((is_attr_set(pat)) == 0) ||
+		((pat->at_flags & ATR_VFLAG_DEFLT) != 0)))
+		return 0;
+
+	/* ATR_VFLAG_DEFLT means server set comment itself */
+	dflt = !(do_set && (bits & INUSE_OFFLINE_BY_MOM));
+	if (check) {
+		if (txt == NULL)
+			return (is_attr_set(pat) != 0);
+		return (!is_attr_set(pat) || (strcmp(pat->at_val.at_str, txt) != 0) ||
+			(((pat->at_flags & ATR_VFLAG_DEFLT) != 0) != dflt));
+	}
+
+	/* default comment */
+	node_attr_def[(int)ND_ATR_Comment].at_free(pat);
+	if (txt) {
+		node_attr_def[(int)ND_ATR_Comment].at_decode(pat, NULL,
+			NULL, txt);
+	}
+	if (!dflt) {
+		/* this means not directly set by the server */
+		/* This means server did not set comment */
+		/* directly but as done per mom */
+		pat->at_flags &= ~ATR_VFLAG_DEFLT;
+		mark_attr_set(pat);
+	} else {
+		pat->at_flags |= ATR_VFLAG_DEFLT;
+	}
+	return 1;
+}
+
 /**
  * @brief
  * 		set or clear state bits on the mominfo entry and all
@@ -526,7 +534,6 @@ set_all_state(mominfo_t *pmom, int do_set, unsigned long bits, char *txt,
 	unsigned long	mstate;
 	mom_svrinfo_t  *psvrmom = (mom_svrinfo_t *)(pmom->mi_data);
 	struct pbsnode *pvnd;
-	attribute	*pat;
 	int		nchild;
 	unsigned long	inuse_flag = 0;
 
@@ -575,7 +582,16 @@ set_all_state(mominfo_t *pmom, int do_set, unsigned long bits, char *txt,
 		if (do_this_vnode == 0)
 			continue;	/* skip setting state on this vnode */
 
-		if (do_set) {
+		/*
+		 * Every update from a Mom comes through here, mostly not
+		 * changing anything; leave such a vnode alone so it is not
+		 * marked modified and saved for nothing.
+		 */
+		if ((do_set && ((pvnd->nd_state & bits) == bits)) ||
+			(!do_set && ((pvnd->nd_state & bits) == 0))) {
+			if (!set_all_state_comment(pvnd, do_set, bits, txt, 1))
+				continue;
+		} else if (do_set) {
 			set_vnode_state(pvnd, bits, Nd_State_Or);
 		} else {
 			set_vnode_state(pvnd, ~bits, Nd_State_And);
@@ -590,41 +606,98 @@ set_all_state(mominfo_t *pmom, int do_set, unsigned long bits, char *txt,
 		}
 
 		pvnd->nd_attr[(int)ND_ATR_state].at_flags |= ATR_SET_MOD_MCACHE;
-		pat = &pvnd->nd_attr[(int)ND_ATR_Comment];
+		(void)set_all_state_comment(pvnd, do_set, bits, txt, 0);
+	}
+}
 
-		/*
-		 * change the comment only if it is a default comment (set by
-		 * the serve and not the Manager;  if "txt" is null, just
-		 * clear (unset) the comment
-		 *
-		 * comments set as part of INUSE_OFFLINE_BY_MOM state
-		 * action should not be touched.
-		 */
+/**
+ * @brief
+ * 		qsort compare of job pointers, to bring the entries of a job together
+ */
+static int
+cmp_job_ptr(const void *a, const void *b)
+{
+	const job *ja = *(job * const *)a;
+	const job *jb = *(job * const *)b;
 
-		if ((bits & INUSE_OFFLINE_BY_MOM) ||
-			((is_attr_set(pat))   == 0)  ||
-			((pat->at_flags & ATR_VFLAG_DEFLT) != 0)) {
-
-			/* default comment */
-			node_attr_def[(int)ND_ATR_Comment].at_free(pat);
-			if (txt) {
-				node_attr_def[(int)ND_ATR_Comment].at_decode(pat, NULL,
-					NULL, txt);
-			}
-			if (do_set && (bits & INUSE_OFFLINE_BY_MOM)) {
-				/* this means not directly set by the server */
-				/* This means server did not set comment */
-				/* directly but as done per mom */
-				pat->at_flags &= ~ATR_VFLAG_DEFLT;
-				mark_attr_set(pat);
-			} else {
-				/* ATR_VFLAG_DEFLT means server set comment */
-				/* itself */
-				pat->at_flags |= ATR_VFLAG_DEFLT;
+	return (ja < jb) ? -1 : (ja > jb);
+}
+
+/**
+ * @brief
+ * 		Collect the jobs running on the vnodes of a Mom, each once.
+ *
+ * @par
+ *		The Mom's job index already holds each job on her once, see
+ *		add_job_index_to_mom().  The vnodes of a Mom in a vnode pool are
+ *		shared with the other Moms of the pool, so for her the job lists
+ *		of the subnodes are gathered instead.  The array is a copy, as
+ *		dealing with a job changes these lists.
+ *
+ * @param[in]	pmom	- the Mom
+ * @param[out]	pjobs	- the jobs, to be freed by the caller
+ *
+ * @return	int
+ * @retval	number of jobs in *pjobs
+ */
+static int
+mom_jobs(mominfo_t *pmom, job ***pjobs)
+{
+	mom_svrinfo_t	*psvrmom = (mom_svrinfo_t *)pmom->mi_data;
+	struct pbsnode	*np;
+	struct pbssubn	*psn;
+	struct jobinfo	*pji;
+	job		**jobs;
+	int		 nchild;
+	int		 nj = 0;
+	int		 i;
+	int		 n;
+
+	*pjobs = NULL;
+
+	if (psvrmom->msr_vnode_pool == 0) {
+		n = psvrmom->msr_jbinxsz;
+	} else {
+		n = 0;
+		for (nchild = 0; nchild < psvrmom->msr_numvnds; ++nchild) {
+			for (psn = psvrmom->msr_children[nchild]->nd_psn; psn; psn = psn->next) {
+				for (pji = psn->jobs; pji; pji = pji->next)
+					n++;
 			}
+		}
+	}
+	if (n == 0)
+		return 0;
 
+	if ((jobs = malloc(n * sizeof(job *))) == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		return 0;
+	}
+
+	if (psvrmom->msr_vnode_pool == 0) {
+		for (i = 0; i < psvrmom->msr_jbinxsz; i++) {
+			if (psvrmom->msr_jobindx[i] != NULL)
+				jobs[nj++] = psvrmom->msr_jobindx[i];
+		}
+	} else {
+		for (nchild = 0; nchild < psvrmom->msr_numvnds; ++nchild) {
+			np = psvrmom->msr_children[nchild];
+			for (psn = np->nd_psn; psn; psn = psn->next) {
+				for (pji = psn->jobs; pji; pji = pji->next)
+					jobs[nj++] = pji->job;
+			}
 		}
 	}
+
+	/* a job has an entry for each of its chunks, keep one */
+	qsort(jobs, nj, sizeof(job *), cmp_job_ptr);
+	for (i = 0, n = 0; i < nj; i++) {
+		if ((n == 0) || (jobs[n - 1] != jobs[i]))
+			jobs[n++] = jobs[i];
+	}
+
+	*pjobs = jobs;
+	return n;
 }
 
 /**
@@ -633,7 +706,10 @@ set_all_state(mominfo_t *pmom, int do_set, unsigned long bits, char *txt,
  *
  * @par Functionality:
  *		If the primary, Mother Superior, node of a job goes down, it
- *		should be requeued if possible or delete.
+ *		should be requeued if possible or delete.  Only the jobs of the
+ *		Mom are looked at, see mom_jobs().  The saves of all the jobs
+ *		go to the database in one transaction at the end of the pass,
+ *		see job_save_db().
  *
  *		Called via a work-task set up in momptr_down()
  * @see
@@ -652,10 +728,10 @@ node_down_requeue(struct work_task *pwt)
 	mom_svrinfo_t		*svmp;
 	job			*pj;
 	struct pbsnode		*np;
-	struct pbssubn		*psn;
-	struct jobinfo		*pjinfo;
-	struct jobinfo		*pjinfo_nxt;
-	int			 nchild;
+	job			**jobs;
+	int			 nj;
+	int			 j;
+	int			 nmom;
 	int			 cnt;
 	int			 i;
 	char			*tmp_acctrec = NULL;
@@ -695,91 +771,86 @@ node_down_requeue(struct work_task *pwt)
 
 	DBPRT(("node_down_requeue node still down\n"))
 
-	for (nchild = 0; nchild < svmp->msr_numvnds; ++nchild) {
-		np = svmp->msr_children[nchild];
-		/* is node still provisioning? If yes, leave jobs as is */
-		if ((np->nd_state & INUSE_PROV) == 0) {
-			DBPRT(("node_down_requeue node still provisioning\n"))
-
-			for (psn = np->nd_psn; psn; psn = psn->next) {
-				for (pjinfo = psn->jobs; pjinfo; pjinfo = pjinfo_nxt) {
-					pj = pjinfo->job;
-					pjinfo_nxt = pjinfo->next;
-					while (pjinfo_nxt && (pjinfo_nxt->job == pj)) {
-						/* skip over next occurrence of same job in list*/
-						/* if it is deleted in discard_job(), we would	*/
-						/* have a pointer to nothingness		*/
-						pjinfo_nxt = pjinfo_nxt->next;
-					}
+	/* handle the jobs from a copy, discarding one changes the lists */
+	nj = mom_jobs(mp, &jobs);
+	for (j = 0; j < nj; j++) {
+		pj = jobs[j];
 
-					nname = parse_servername(
-						get_jattr_str(pj, JOB_ATR_exec_vnode), NULL);
-					if (nname && (strcasecmp(np->nd_name, nname) == 0)) {
-						/* node is Mother Superior for job */
-						set_jattr_l_slim(pj, JOB_ATR_exit_status, JOB_EXEC_RERUN_MS_FAIL, SET);
-
-						sprintf(log_buffer, msg_job_end_stat , JOB_EXEC_RERUN_MS_FAIL);
-						log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, pj->ji_qs.ji_jobid, log_buffer);
-
-						/* If Job is  in wait Provision state, then fail_vnode_provisioning should be called.
-						 * Since this job is going to get requed and can run on different set of vnodes
-						 * hence to make sure provisioning failure on previous set of vnodes doesn't create problem.
-						 */
-						if(check_job_substate(pj, JOB_SUBSTATE_PROVISION)) {
-							cnt = parse_prov_vnode(get_jattr_str(pj, JOB_ATR_prov_vnode),
-												   &prov_vnode_list);
-
-							/* Check if any node associated to the provisioned job is still in provisioning state. */
-							for (i = 0; i < cnt; i++) {
-								if ((vnode = find_nodebyname(prov_vnode_list[i]))) {
-									if ((ptracking = get_prov_record_by_vnode(vnode->nd_name))) {
-										prov_vnode_info = ptracking->prov_vnode_info;
-										if (prov_vnode_info){
-											fail_vnode_job(prov_vnode_info, -1);/* Passing -1 so that fail_vnode_job neither hold nor requeue the job */
-											break;
-										}
-									}
-								}
-							}
-						}
-						/* Set for requeuing the job if job is rerunnable */
-						if (get_jattr_long(pj, JOB_ATR_rerunable) != 0) {
-							set_job_substate(pj, JOB_SUBSTATE_RERUN3);
-							if (pj->ji_acctrec != NULL) {
-								if (pbs_asprintf(&tmp_acctrec, "%s %s", pj->ji_acctrec, log_buffer) == -1) {
-									free(tmp_acctrec); /* free 1 byte malloc'd in pbs_asprintf() */
-								} else {
-									free(pj->ji_acctrec);
-									pj->ji_acctrec = tmp_acctrec;
-								}
-							} else {
-								pj->ji_acctrec = strdup(log_buffer);
-							}
-						}
+		/* is the first vnode of the job, its Mother Superior, one of */
+		/* this Mom's and not still provisioning?                      */
+		if (!is_jattr_set(pj, JOB_ATR_exec_vnode))
+			continue;
+		nname = parse_servername(get_jattr_str(pj, JOB_ATR_exec_vnode), NULL);
+		if ((nname == NULL) || ((np = find_nodebyname(nname)) == NULL))
+			continue;
+		for (nmom = 0; nmom < np->nd_nummoms; ++nmom) {
+			if (np->nd_moms[nmom] == mp)
+				break;
+		}
+		if ((nmom == np->nd_nummoms) || (np->nd_state & INUSE_PROV))
+			continue;
 
-						/* When job is non-rerunnable and if job has any dependencies,
-						 *register dependency request to delete the dependent jobs.
-						 */
-						if (get_jattr_long(pj, JOB_ATR_rerunable) == 0 &&
-							(is_jattr_set(pj, JOB_ATR_depend))) {
-								/* set job exit status from MOM */
-								pj->ji_qs.ji_un.ji_exect.ji_exitstat = JOB_EXEC_RERUN_MS_FAIL;
-								(void)depend_on_term(pj);
-						}
+		/* node is Mother Superior for job */
+		set_jattr_l_slim(pj, JOB_ATR_exit_status, JOB_EXEC_RERUN_MS_FAIL, SET);
 
-						/* notify all sisters to discard the job */
-						discard_job(pj, "on node down requeue", 0);
+		sprintf(log_buffer, msg_job_end_stat , JOB_EXEC_RERUN_MS_FAIL);
+		log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, pj->ji_qs.ji_jobid, log_buffer);
 
-						/* Clear "resources_used" only if not waiting on any mom */
-						if (!pj->ji_jdcd_waiting && ((pj->ji_qs.ji_svrflags & (JOB_SVFLG_CHKPT | JOB_SVFLG_ChkptMig)) == 0)) {
-							free_jattr(pj, JOB_ATR_resc_used);
+		/* If Job is  in wait Provision state, then fail_vnode_provisioning should be called.
+		 * Since this job is going to get requed and can run on different set of vnodes
+		 * hence to make sure provisioning failure on previous set of vnodes doesn't create problem.
+		 */
+		if(check_job_substate(pj, JOB_SUBSTATE_PROVISION)) {
+			cnt = parse_prov_vnode(get_jattr_str(pj, JOB_ATR_prov_vnode),
+								   &prov_vnode_list);
+
+			/* Check if any node associated to the provisioned job is still in provisioning state. */
+			for (i = 0; i < cnt; i++) {
+				if ((vnode = find_nodebyname(prov_vnode_list[i]))) {
+					if ((ptracking = get_prov_record_by_vnode(vnode->nd_name))) {
+						prov_vnode_info = ptracking->prov_vnode_info;
+						if (prov_vnode_info){
+							fail_vnode_job(prov_vnode_info, -1);/* Passing -1 so that fail_vnode_job neither hold nor requeue the job */
+							break;
 						}
-
 					}
 				}
 			}
 		}
+		/* Set for requeuing the job if job is rerunnable */
+		if (get_jattr_long(pj, JOB_ATR_rerunable) != 0) {
+			set_job_substate(pj, JOB_SUBSTATE_RERUN3);
+			if (pj->ji_acctrec != NULL) {
+				if (pbs_asprintf(&tmp_acctrec, "%s %s", pj->ji_acctrec, log_buffer) == -1) {
+					free(tmp_acctrec); /* free 1 byte malloc'd in pbs_asprintf() */
+				} else {
+					free(pj->ji_acctrec);
+					pj->ji_acctrec = tmp_acctrec;
+				}
+			} else {
+				pj->ji_acctrec = strdup(log_buffer);
+			}
+		}
+
+		/* When job is non-rerunnable and if job has any dependencies,
+		 *register dependency request to delete the dependent jobs.
+		 */
+		if (get_jattr_long(pj, JOB_ATR_rerunable) == 0 &&
+			(is_jattr_set(pj, JOB_ATR_depend))) {
+				/* set job exit status from MOM */
+				pj->ji_qs.ji_un.ji_exect.ji_exitstat = JOB_EXEC_RERUN_MS_FAIL;
+				(void)depend_on_term(pj);
+		}
+
+		/* notify all sisters to discard the job */
+		discard_job(pj, "on node down requeue", 0);
+
+		/* Clear "resources_used" only if not waiting on any mom */
+		if (!pj->ji_jdcd_waiting && ((pj->ji_qs.ji_svrflags & (JOB_SVFLG_CHKPT | JOB_SVFLG_ChkptMig)) == 0)) {
+			free_jattr(pj, JOB_ATR_resc_used);
+		}
 	}
+	free(jobs);
 }
 
 /**
@@ -966,13 +1037,10 @@ void
 momptr_down(mominfo_t *pmom, char *why)
 {
 	int		 i;
-	int		 j;
 	int		 nj;
 	int		 nchild;
 	struct pbsnode  *np;
-	struct  jobinfo *pji;
 	job	       **parray;
-	struct  pbssubn *psn;
 	mom_svrinfo_t   *psvrmom = (mom_svrinfo_t *)(pmom->mi_data);
 	long		 sec;
 	int		 setwktask = 0;
@@ -1019,52 +1087,16 @@ momptr_down(mominfo_t *pmom, char *why)
 	}
 #endif /* localmod 023 */
 
-	for (nchild = 0; nchild < psvrmom->msr_numvnds; ++nchild) {
-
-		np = psvrmom->msr_children[nchild];
-
-		for (psn = np->nd_psn; psn; psn = psn->next) {
-			if (psn->jobs) {
-				setwktask = 1;
-				nj = 0;
-				/* find list of jobs on this sub-node */
-				/* first, how many are they */
-				for (pji = psn->jobs; pji; pji = pji->next) {
-					if (pji->job->ji_discard)
-						++nj;
-				}
-				/* if any, save pointer to the jobs in an array as the    */
-				/* list may be distrubed by the post_discard_job function */
-				if (nj != 0) {
-					parray = (job **)calloc((size_t)nj, sizeof(job *));
-					if (parray) {
-						i = 0;
-						for (pji = psn->jobs; pji; pji = pji->next) {
-							if (pji->job->ji_discard) {
-								/* we only want one entry per job */
-								for (j=0; j<i; ++j) {
-									if (*(parray+j) == pji->job)
-										break;
-								}
-								if (j == i) {
-									*(parray+i) = pji->job; /* new, add it */
-									++i;
-								}
-							}
-						}
-
-						for (i = 0; i < nj; ++i)
-							if (*(parray+i))
-								post_discard_job(*(parray+i), pmom, JDCD_DOWN);
-
-						free(parray);
-						parray = NULL;
-					}
-				}
-			}
-		}
-
+	/* the Mom's jobs waiting on her to discard them need not wait any longer; */
+	/* the list may be disturbed by post_discard_job(), so use a copy          */
+	nj = mom_jobs(pmom, &parray);
+	if (nj != 0)
+		setwktask = 1;
+	for (i = 0; i < nj; ++i) {
+		if (parray[i]->ji_discard)
+			post_discard_job(parray[i], pmom, JDCD_DOWN);
 	}
+	free(parray);
 
 	/* If this Mom is in a vnode pool and is the inventory Mom for that pool */
 	/* remove her from that role and if another Mom in the pool is up make   */
@@ -1290,6 +1322,7 @@ set_vnode_state(struct pbsnode *pnode, unsigned long state_bits, enum vnode_stat
 		set_attr_generic(&(pnode->nd_attr[(int)ND_ATR_last_state_change_time]),
 			&node_attr_def[(int) ND_ATR_last_state_change_time], str_val, NULL,
 			SET);
+		svr_event_node(pnode);
 	}
 
 	/* Write the vnode state change event to server log */
@@ -1583,6 +1616,131 @@ vnode_unavailable(struct pbsnode *np, int account_vnode)
 	free_rinf_list(rinfp_hd);
 }
 
+/*
+ * The vnodes of any occurrence of each reservation are indexed by vnode, see
+ * resv_vnode_index().  The index is rebuilt when resv_vnodes_changed() was
+ * called since it was built.
+ */
+static long resv_vnodes_gen = 1;	/* generation of the reservations' vnodes */
+static long resv_vnodes_idx_gen = 0;	/* generation the index was built at */
+
+/**
+ * @brief
+ * 		Note that the vnodes of a reservation changed, or that it is gone,
+ *		so the vnode to reservation index has to be rebuilt.
+ *
+ * @return	void
+ */
+void
+resv_vnodes_changed(void)
+{
+	resv_vnodes_gen++;
+}
+
+/**
+ * @brief
+ * 		Add a reservation to the index entry of a vnode, once.
+ *
+ * @param[in,out]	np	- the vnode
+ * @param[in]	presv	- the reservation
+ *
+ * @return	void
+ */
+static void
+resv_vnode_add(struct pbsnode *np, resc_resv *presv)
+{
+	resc_resv **tmp;
+	int sz;
+
+	/* an entry of an older index is empty */
+	if (np->nd_resv_gen != resv_vnodes_gen) {
+		np->nd_resv_gen = resv_vnodes_gen;
+		np->nd_nresv = 0;
+	}
+
+	/* the reservations are indexed one after the other */
+	if ((np->nd_nresv > 0) && (np->nd_resv[np->nd_nresv - 1] == presv))
+		return;
+
+	if (np->nd_nresv == np->nd_resvsz) {
+		sz = (np->nd_resvsz == 0) ? 4 : np->nd_resvsz * 2;
+		tmp = realloc(np->nd_resv, sz * sizeof(resc_resv *));
+		if (tmp == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return;
+		}
+		np->nd_resv = tmp;
+		np->nd_resvsz = sz;
+	}
+	np->nd_resv[np->nd_nresv++] = presv;
+}
+
+/**
+ * @brief
+ * 		Bring the vnode to reservation index up to date.
+ *
+ * @par
+ *		An advance reservation is indexed under the vnodes it has.  A
+ *		standing reservation is indexed under the vnodes of each of its
+ *		occurrences, so that a vnode going up or down finds every
+ *		reservation it may degrade without parsing the execvnode sequence
+ *		of all of them.  The reservations of a vnode keep the order of
+ *		svr_allresvs.
+ *
+ * @return	void
+ *
+ * @par MT-safe: No
+ */
+static void
+resv_vnode_index(void)
+{
+	resc_resv *presv;
+	pbsnode_list_t *pl;
+	execvnode_seq *seq;
+	struct pbsnode *np;
+	struct key_value_pair *pkvp;
+	char *execvnode;
+	char *chunk;
+	char *last;
+	char *noden;
+	int hasprn;
+	int nelem;
+	int i;
+
+	if (resv_vnodes_idx_gen == resv_vnodes_gen)
+		return;
+
+	for (presv = (resc_resv *) GET_NEXT(svr_allresvs); presv != NULL;
+		presv = (resc_resv *) GET_NEXT(presv->ri_allresvs)) {
+		if (presv->ri_wattr[RESV_ATR_resv_standing].at_val.at_long == 0) {
+			for (pl = presv->ri_pbsnode_list; pl; pl = pl->next)
+				resv_vnode_add(pl->vnode, presv);
+			continue;
+		}
+		if ((presv->ri_wattr[RESV_ATR_resv_execvnodes].at_flags & ATR_VFLAG_SET) == 0)
+			continue;
+		if ((seq = parse_execvnode_seq(presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str)) == NULL)
+			continue;
+		/* many occurrences share an execvnode, each is only indexed once */
+		for (i = 0; i < seq->nvnodes; i++) {
+			if ((execvnode = strdup(seq->vnodes[i])) == NULL) {
+				log_err(errno, __func__, "Out of memory");
+				break;
+			}
+			for (chunk = parse_plus_spec_r(execvnode, &last, &hasprn);
+				chunk != NULL;
+				chunk = parse_plus_spec_r(last, &last, &hasprn)) {
+				if ((parse_node_resc(chunk, &noden, &nelem, &pkvp) == 0) &&
+					((np = find_nodebyname(noden)) != NULL))
+					resv_vnode_add(np, presv);
+			}
+			free(execvnode);
+		}
+		free_execvnode_seq_info(seq);
+	}
+	resv_vnodes_idx_gen = resv_vnodes_gen;
+}
+
 /**
  * @brief
  * 		Search all reservations for an associated node that matches the one
@@ -1598,7 +1756,8 @@ vnode_unavailable(struct pbsnode *np, int account_vnode)
  *
  * @note
  * 		if none are found. This function allocates memory that has to be freed by
- * 		the caller.
+ * 		the caller.  Only the reservations indexed under the node are looked
+ * 		at, see resv_vnode_index().
  *
  * @par MT-safe: No
  */
@@ -1611,10 +1770,15 @@ find_vnode_in_resvs(struct pbsnode *np, enum vnode_degraded_op degraded_op)
 	pbsnode_list_t *pl;
 	int match = 0;
 	int is_degraded = 0;
+	int r;
 
 	if (np == NULL)
 		return NULL;
 
+	resv_vnode_index();
+	if ((np->nd_resv_gen != resv_vnodes_gen) || (np->nd_nresv == 0))
+		return NULL;
+
 	/* Walk all reservations and check if the node is associated to an
 	 * occurrence of a standing reservation
 	 *
@@ -1630,8 +1794,8 @@ find_vnode_in_resvs(struct pbsnode *np, enum vnode_degraded_op degraded_op)
 
 	parent_rinfp = rinfp;
 
-	for (presv = (resc_resv *) GET_NEXT(svr_allresvs); presv != NULL;
-		presv = (resc_resv *) GET_NEXT(presv->ri_allresvs)) {
+	for (r = 0; r < np->nd_nresv; r++) {
+		presv = np->nd_resv[r];
 		/* When processing an advance reservation, set the degraded time to be
 		 * the start time of the reservation and process the next reservation
 		 */
@@ -1731,9 +1895,8 @@ int
 find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 	enum vnode_degraded_op degraded_op)
 {
-	char **execvnodes_seq;
-	char *short_execvnodes_seq = NULL;
-	char **tofree = NULL;
+	execvnode_seq *seq;
+	char *in_xc;	/* per unique execvnode: 0 not checked, 1 has np, 2 does not */
 	char *rrule;
 	char *tz;
 	char *execvnodes;
@@ -1758,12 +1921,12 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 	dtstart = presv->ri_wattr[RESV_ATR_start].at_val.at_long;
 	execvnodes = presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str;
 
-	if ((short_execvnodes_seq = strdup(execvnodes)) == NULL)
+	/* If an error occurred during parsing, this reservation is ignored */
+	if ((seq = parse_execvnode_seq(execvnodes)) == NULL)
 		return -1;
-	execvnodes_seq = unroll_execvnode_seq(short_execvnodes_seq, &tofree);
-	/* If an error occurred during unrolling, this reservation is ignored */
-	if (!(*execvnodes_seq)) {
-		free(short_execvnodes_seq);
+	/* many occurrences share an execvnode, each is only searched once */
+	if ((in_xc = calloc(seq->nvnodes, sizeof(char))) == NULL) {
+		free_execvnode_seq_info(seq);
 		return -1;
 	}
 
@@ -1772,7 +1935,7 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 	/* A reconfirmed degraded reservation reports the number of
 	 * reconfirmed occurrences from the time of degradation.
 	 */
-	rcount_adjusted = get_execvnodes_count(execvnodes);
+	rcount_adjusted = seq->count;
 
 	ridx_adjusted = ridx - (rcount - rcount_adjusted);
 	occr_found = 0;
@@ -1780,7 +1943,11 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 
 	/* Search for a match for this node in each occurrence's execvnode */
 	for (i = ridx_adjusted - 1, j = 1; i < rcount_adjusted; i++, j++) {
-		if (find_vnode_in_execvnode(execvnodes_seq[i], np->nd_name)) {
+		int x = seq->occr[i];
+
+		if (in_xc[x] == 0)
+			in_xc[x] = find_vnode_in_execvnode(seq->vnodes[x], np->nd_name) ? 1 : 2;
+		if (in_xc[x] == 1) {
 			occr_found = 1;
 			if (degraded_op == Set_Degraded_Time) {
 				/* we keep track of the occurrence time to determine the earliest
@@ -1796,13 +1963,9 @@ find_degraded_occurrence(resc_resv *presv, struct pbsnode *np,
 				break;
 		}
 	}
-	/* clean up unrolled execvnodes sequence helpers */
-	free(execvnodes_seq);
-	execvnodes_seq = NULL;
-	free(short_execvnodes_seq);
-	short_execvnodes_seq = NULL;
-	free_execvnode_seq(tofree);
-	tofree = NULL;
+	/* clean up the parsed execvnodes sequence */
+	free(in_xc);
+	free_execvnode_seq_info(seq);
 
 	/* No matching vnode name was found in any occurrence */
 	if (!occr_found)
@@ -2180,11 +2343,11 @@ stat_update(int stream)
 
 			if (execvnode_entry != NULL) {
 				delete_link(&execvnode_entry->al_link);
-				free(execvnode_entry);
+				attrlist_free(execvnode_entry);
 			}
 			if (schedselect_entry != NULL) {
 				delete_link(&schedselect_entry->al_link);
-				free(schedselect_entry);
+				attrlist_free(schedselect_entry);
 			}
 			if (is_jattr_set(pjob, JOB_ATR_session_id))
 				old_sid = get_jattr_long(pjob, JOB_ATR_session_id);
@@ -2637,6 +2800,157 @@ recv_wk_job_idle(int stream)
 	free(jobid);
 }
 
+/**
+ * @brief
+ *	Free a parsed exec_vnode built by job_alloc_parse().
+ *
+ * @param[in]	palloc	- the parse, may be NULL
+ *
+ * @return void
+ */
+static void
+job_alloc_release(struct job_alloc *palloc)
+{
+	if (palloc == NULL)
+		return;
+	free(palloc->ja_str);
+	free(palloc->ja_buf);
+	free(palloc->ja_ent);
+	free(palloc->ja_kv);
+	free(palloc);
+}
+
+/**
+ * @brief
+ *	Parse an exec_vnode string of the form
+ *	(vnA:resc=val:resc=val+vnB:resc=val)+(vnC:...) into its vnode
+ *	entries and their resource=value pairs.
+ *
+ * @par
+ *	All the names and values point into a single munged copy of the
+ *	string, so the whole parse is freed with job_alloc_release().
+ *
+ * @param[in]	execvnode	- the string to parse
+ *
+ * @return struct job_alloc *
+ * @retval	the parse
+ * @retval	NULL	- out of memory or bad syntax
+ */
+static struct job_alloc *
+job_alloc_parse(char *execvnode)
+{
+	struct job_alloc *palloc;
+	struct key_value_pair *pkvp = NULL;
+	int	nkvp = 0;
+	int	maxent = 1;
+	int	maxkv = 0;
+	int	nelem;
+	int	hasprn;
+	char	*chunk;
+	char	*last;
+	char	*vname;
+	char	*pc;
+
+	if (execvnode == NULL)
+		return NULL;
+
+	palloc = calloc(1, sizeof(struct job_alloc));
+	if (palloc == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		return NULL;
+	}
+
+	/* upper bounds of the number of entries and of resource pairs */
+	for (pc = execvnode; *pc != '\0'; pc++) {
+		if ((*pc == '+') || (*pc == ')'))
+			maxent++;
+		else if (*pc == '=')
+			maxkv++;
+		else if (*pc == '(')
+			palloc->ja_nhost++;
+	}
+	palloc->ja_str = strdup(execvnode);
+	palloc->ja_buf = strdup(execvnode);
+	palloc->ja_ent = calloc(maxent, sizeof(struct job_alloc_ent));
+	palloc->ja_kv = calloc(maxkv + 1, sizeof(struct key_value_pair));
+	if ((palloc->ja_str == NULL) || (palloc->ja_buf == NULL) ||
+		(palloc->ja_ent == NULL) || (palloc->ja_kv == NULL)) {
+		log_err(errno, __func__, "Out of memory");
+		job_alloc_release(palloc);
+		return NULL;
+	}
+
+	maxkv = 0;
+	for (chunk = parse_plus_spec_r(palloc->ja_buf, &last, &hasprn);
+		chunk != NULL;
+		chunk = parse_plus_spec_r(last, &last, &hasprn)) {
+		vname = NULL;
+		if (parse_node_resc_r(chunk, &vname, &nelem, &nkvp, &pkvp) != 0) {
+			free(pkvp);
+			job_alloc_release(palloc);
+			return NULL;
+		}
+		if (vname == NULL)
+			continue;
+		palloc->ja_ent[palloc->ja_nent].ae_vname = vname;
+		palloc->ja_ent[palloc->ja_nent].ae_nelem = nelem;
+		palloc->ja_ent[palloc->ja_nent].ae_kv = &palloc->ja_kv[maxkv];
+		memcpy(&palloc->ja_kv[maxkv], pkvp, nelem * sizeof(struct key_value_pair));
+		maxkv += nelem;
+		palloc->ja_nent++;
+	}
+	free(pkvp);
+	return palloc;
+}
+
+/**
+ * @brief
+ *	Return the parsed form of an exec_vnode string of the job.
+ *
+ * @par
+ *	The parse is kept in ji_alloc and reused for as long as the job asks
+ *	for the same string, so the run, the obit and the end of the job all
+ *	share the one parse done when the job was run.  A different string,
+ *	e.g. after nodes were released, replaces it.
+ *
+ * @param[in]	pjob	- the job
+ * @param[in]	execvnode	- exec_vnode value of the job
+ *
+ * @return struct job_alloc *
+ * @retval	the parse, owned by the job
+ * @retval	NULL	- out of memory or bad syntax
+ */
+struct job_alloc *
+job_alloc_get(job *pjob, char *execvnode)
+{
+	if ((pjob == NULL) || (execvnode == NULL))
+		return NULL;
+
+	if ((pjob->ji_alloc != NULL) && (strcmp(pjob->ji_alloc->ja_str, execvnode) == 0))
+		return pjob->ji_alloc;
+
+	job_alloc_release(pjob->ji_alloc);
+	pjob->ji_alloc = job_alloc_parse(execvnode);
+	return pjob->ji_alloc;
+}
+
+/**
+ * @brief
+ *	Drop the parsed exec_vnode the job keeps, see job_alloc_get().
+ *
+ * @param[in]	pjob	- the job
+ *
+ * @return void
+ */
+void
+job_alloc_free(job *pjob)
+{
+	if (pjob == NULL)
+		return;
+	job_alloc_release(pjob->ji_alloc);
+	pjob->ji_alloc = NULL;
+}
+
 /**
  * @brief
  *	Clears job 'pjob' from the pnode's list of jobs.
@@ -2692,18 +3006,20 @@ deallocate_job_from_node(job *pjob, struct pbsnode *pnode)
 			np->inuse &= ~(INUSE_JOB|INUSE_JOBEXCL);
 		}
 	}
+	/* clear the state bits only when set, set_vnode_state() is costly */
 	if (still_has_jobs) {
 		/* if the vnode still has jobs, then don't clear */
 		/* JOBEXCL */
-		if (pnode->nd_nsnfree > 0) {
+		if ((pnode->nd_nsnfree > 0) && (pnode->nd_state & INUSE_JOB)) {
 			/* some cpus free, clear "job-busy" state */
 			set_vnode_state(pnode, ~INUSE_JOB, Nd_State_And);
 		}
 	} else {
 		/* no jobs at all, clear both JOBEXCL and "job-busy" */
-		set_vnode_state(pnode,
-			~(INUSE_JOB|INUSE_JOBEXCL),
-			Nd_State_And);
+		if (pnode->nd_state & (INUSE_JOB|INUSE_JOBEXCL))
+			set_vnode_state(pnode,
+				~(INUSE_JOB|INUSE_JOBEXCL),
+				Nd_State_And);
 
 		/* call function to check and free the node from the */
 		/* prov list and reset wait_prov flag, if set */
@@ -2903,6 +3219,7 @@ deallocate_job(mominfo_t *pmom, job *pjob)
 	attribute deallocated_attr;
 	char	*jobid;
 	pbs_sched *psched;
+	struct job_alloc *palloc = NULL;
 
 	if ((pmom == NULL) || (pjob == NULL)) {
 		return;
@@ -2912,10 +3229,19 @@ deallocate_job(mominfo_t *pmom, job *pjob)
 	if ((jobid == NULL) || (*jobid == '\0'))
 		return;
 
-	for (i = 0; i < svr_totnodes; i++) {
+	/* only the vnodes the job was given can hold it, no need to go */
+	/* through every vnode of the complex */
+	if (is_jattr_set(pjob, JOB_ATR_exec_vnode_orig))
+		palloc = job_alloc_get(pjob, get_jattr_str(pjob, JOB_ATR_exec_vnode_orig));
+	else if (is_jattr_set(pjob, JOB_ATR_exec_vnode))
+		palloc = job_alloc_get(pjob, get_jattr_str(pjob, JOB_ATR_exec_vnode));
+	if (palloc == NULL)
+		return;
+
+	for (i = 0; i < palloc->ja_nent; i++) {
 		pbsnode *pnode;
 
-		pnode = pbsndlist[i];
+		pnode = find_nodebyname(palloc->ja_ent[i].ae_vname);
 
 		if ((pnode != NULL) && !(pnode->nd_state & INUSE_DELETED)
 			&& is_parent_mom_of_node(pmom, pnode)) {
@@ -2927,7 +3253,7 @@ deallocate_job(mominfo_t *pmom, job *pjob)
 				log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG,
 								pmom->mi_host, log_buffer);
 			}
-			if (i != 0) {
+			if (freed_vnode_list != NULL) {
 				if (pbs_strcat(&freed_vnode_list, &freed_sz, "+") == NULL) {
 					log_err(-1, __func__, "pbs_strcat failed");
 					free(freed_vnode_list);
@@ -3417,6 +3743,53 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
 #define	UPDATE2_U		"UPDATE2"
 #define	UPDATE_FROM_MOM_HOOK	"update from mom hook"
 #define	UPDATE			"update"
+/**
+ * @brief
+ *	Tell whether a value reported by a Mom is the one an attribute or
+ *	resource of a vnode already holds.
+ *
+ * @par
+ *	Moms report their whole vnode inventory again and again; decoding an
+ *	unchanged value over the old one only marks the vnode modified.
+ *
+ * @param[in]	pcur	- the current value
+ * @param[in]	type	- ATR_TYPE_* of the value
+ * @param[in]	decode	- decode function of the attribute or resource
+ * @param[in]	comp	- compare function of the attribute or resource
+ * @param[in]	freef	- free function of the attribute or resource
+ * @param[in]	name	- attribute name
+ * @param[in]	rn	- resource name or NULL
+ * @param[in]	val	- the reported value
+ *
+ * @return int
+ * @retval	1	- the value is unchanged
+ * @retval	0	- the value differs or cannot be compared
+ */
+static int
+mom_value_unchanged(attribute *pcur, int type,
+	int (*decode)(attribute *, char *, char *, char *),
+	int (*comp)(attribute *, attribute *), void (*freef)(attribute *),
+	char *name, char *rn, char *val)
+{
+	attribute tmp;
+	int	  same;
+
+	if ((comp == NULL) || (val == NULL) || (val[0] == '@') ||
+		!is_attr_set(pcur) || (pcur->at_flags & ATR_VFLAG_INDIRECT))
+		return 0;
+
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.at_type = type;
+	if (decode(&tmp, name, rn, val) != 0) {
+		freef(&tmp);
+		return 0;
+	}
+	/* compare both ways, string arrays compare as "contained in" */
+	same = is_attr_set(&tmp) && (comp(pcur, &tmp) == 0) && (comp(&tmp, pcur) == 0);
+	freef(&tmp);
+	return same;
+}
+
 /**
  * @brief
  * 		create/update vnodes from the information sent by Mom in the UPDATE2
@@ -3429,15 +3802,20 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
  * @param[out] from_hook - set non-zero if request coming from hook
  *			  Normally set to 1 for regular vnoded request;
  *			  2 for qmgr-like (non-vnoded) request.
+ * @param[out] rescs_added - incremented for each resource defined on the fly
  *
  * @return int
  * @retval	zero	- ok
  * @retval	PBSE_ number	- error
  *
+ * @note
+ *	New resource definitions are only counted here, the caller,
+ *	update2_to_vnodes(), reloads them once for the whole message.
+ *
  * @par MT-safe: No
  */
 static int
-update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook)
+update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook, int *rescs_added)
 {
 	int bad;
 	int i;
@@ -3462,7 +3840,6 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	char	*p;
 	char	hook_name[HOOK_BUF_SIZE+1];
 	int	vn_state_updates = 0;
-	int	vn_resc_added = 0;
 
 	CLEAR_HEAD(atrlist);
 
@@ -3691,7 +4068,7 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 						"adding resource %s, type %d, in update for vnode %s", resc, psrp->vna_type,  pnode->nd_name);
 					log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE,
 						LOG_INFO, pmom->mi_host, log_buffer);
-					vn_resc_added++;
+					(*rescs_added)++;
 				}
 				/* now find the new resource definition */
 				prdef = find_resc_def(svr_resc_def, resc);
@@ -3709,6 +4086,12 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 			/* add resource entry to Resources_Available for the vnode */
 
 			prs = add_resource_entry(pRA, prdef);
+			if (prs && !from_hook &&
+				((prs->rs_value.at_flags & ATR_VFLAG_DEFLT) != 0) &&
+				mom_value_unchanged(&prs->rs_value, prdef->rs_type,
+					prdef->rs_decode, prdef->rs_comp, prdef->rs_free,
+					buf, resc, psrp->vna_val))
+				continue;	/* Mom reports what is already there */
 			if (prs) {
 				bad = 0;
 				if (from_hook ||
@@ -3871,8 +4254,11 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 				continue;
 			}
 			pattr = &pnode->nd_attr[j];
-			if (from_hook || ((pattr->at_flags & \
-			   (ATR_VFLAG_SET|ATR_VFLAG_DEFLT)) != ATR_VFLAG_SET)) {
+			if ((from_hook || ((pattr->at_flags & \
+			   (ATR_VFLAG_SET|ATR_VFLAG_DEFLT)) != ATR_VFLAG_SET)) &&
+			   (from_hook || !mom_value_unchanged(pattr, node_attr_def[j].at_type,
+				node_attr_def[j].at_decode, node_attr_def[j].at_comp,
+				node_attr_def[j].at_free, psrp->vna_name, NULL, psrp->vna_val))) {
 				/* if not from_hook, will only set attribute */
 				/* values that have the ATR_VFLAG_DEFLT flag */
 				/* only, which means it wasn't set externally */
@@ -3961,19 +4347,6 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 		}
 	}
 
-	if (vn_resc_added > 0) {
-		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
-			LOG_INFO, "update2_to_vnode",
-			"Restarting Python interpreter as resourcedef file has changed.");
-		pbs_python_ext_shutdown_interpreter(&svr_interp_data);
-		if (pbs_python_ext_start_interpreter(&svr_interp_data) != 0) {
-			log_err(PBSE_INTERNAL, __func__, "Failed to restart Python interpreter");
-			return PBSE_INTERNAL;
-		}
-
-		send_rescdef(1);
-	}
-
 	if (pnode) {
 		int	states_to_clear = 0;
 
@@ -4004,6 +4377,61 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	}
 }
 
+/**
+ * @brief
+ * 		apply all the vnodes of an UPDATE2 or UPDATE_FROM_HOOK message
+ *
+ * @par
+ *	Each vnode is handed to update2_to_vnode().  A Mom reporting many
+ *	vnodes with a new custom resource defines it on the first vnode,
+ *	so the Python interpreter is restarted and the resource definitions
+ *	are sent out once, after the whole list has been applied.
+ *
+ * @param[in]  vnlp 	- vnode list from Mom
+ * @param[in]  new   	- true if ok to create new vnodes
+ * @param[in]  pmom  	- the Mom which sent this update
+ * @param[out] madenew 	- set non-zero if any new vnodes were created
+ * @param[in]  from_hook - as for update2_to_vnode()
+ *
+ * @return int
+ * @retval	zero	- ok
+ * @retval	PBSE_PERM	- a hook requestor lacked privilege, the
+ *				  rest of the list was not applied
+ * @retval	PBSE_INTERNAL	- the Python interpreter could not be restarted
+ *
+ * @par MT-safe: No
+ */
+static int
+update2_to_vnodes(vnl_t *vnlp, int new, mominfo_t *pmom, int *madenew, int from_hook)
+{
+	unsigned long	i;
+	int		rc = 0;
+	int		rescs_added = 0;
+
+	for (i = 0; i < vnlp->vnl_used; i++) {
+		if (update2_to_vnode(VNL_NODENUM(vnlp, i), new, pmom, madenew,
+			from_hook, &rescs_added) == PBSE_PERM) {
+			rc = PBSE_PERM;
+			break; /* encountered a bad permission */
+		}
+	}
+
+	if (rescs_added > 0) {
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
+			LOG_INFO, __func__,
+			"Restarting Python interpreter as resourcedef file has changed.");
+		pbs_python_ext_shutdown_interpreter(&svr_interp_data);
+		if (pbs_python_ext_start_interpreter(&svr_interp_data) != 0) {
+			log_err(PBSE_INTERNAL, __func__, "Failed to restart Python interpreter");
+			return PBSE_INTERNAL;
+		}
+
+		send_rescdef(1);
+	}
+
+	return rc;
+}
+
 /**
  * @brief
  * 		Check if vnode shares the resource "host" with any other vnode, and
@@ -4508,8 +4936,13 @@ found:
 			if (psvrmom->msr_numvnds > 0) {
 				np = psvrmom->msr_children[0];	/* the "one" */
 				np->nd_ncpus = psvrmom->msr_pcpus;
-				np->nd_attr[(int)ND_ATR_pcpus].at_val.at_long = psvrmom->msr_pcpus;
-				np->nd_attr[(int)ND_ATR_pcpus].at_flags |= ATR_SET_MOD_MCACHE;
+				/* most updates repeat the last one, only a */
+				/* change needs to be saved and re-encoded  */
+				if (!is_attr_set(&np->nd_attr[(int)ND_ATR_pcpus]) ||
+					(np->nd_attr[(int)ND_ATR_pcpus].at_val.at_long != psvrmom->msr_pcpus)) {
+					np->nd_attr[(int)ND_ATR_pcpus].at_val.at_long = psvrmom->msr_pcpus;
+					np->nd_attr[(int)ND_ATR_pcpus].at_flags |= ATR_SET_MOD_MCACHE;
+				}
 			}
 
 			i = disrui(stream, &ret);	/* num of avail CPUs on host */
@@ -4588,8 +5021,10 @@ found:
 					prc = find_resc_entry(pala, prd);
 					if (prc == NULL)
 						prc = add_resource_entry(pala, prd);
-					if (((is_attr_set(&prc->rs_value)) == 0) ||
-						((prc->rs_value.at_flags & ATR_VFLAG_DEFLT) != 0)) {
+					if ((((is_attr_set(&prc->rs_value)) == 0) ||
+						((prc->rs_value.at_flags & ATR_VFLAG_DEFLT) != 0)) &&
+						(((is_attr_set(&prc->rs_value)) == 0) ||
+						(prc->rs_value.at_val.at_long != i))) {
 						mod_node_ncpus(np, i, ATR_ACTION_ALTER);
 						prc->rs_value.at_val.at_long = i;
 						prc->rs_value.at_flags |= (ATR_SET_MOD_MCACHE | ATR_VFLAG_DEFLT);
@@ -4600,8 +5035,11 @@ found:
 					prc = find_resc_entry(pala, prd);
 					if (prc == NULL)
 						prc = add_resource_entry(pala, prd);
-					if ((prc->rs_value.at_flags & ATR_VFLAG_DEFLT) ||
-						((is_attr_set(&prc->rs_value)) == 0)) {
+					if (((prc->rs_value.at_flags & ATR_VFLAG_DEFLT) ||
+						((is_attr_set(&prc->rs_value)) == 0)) &&
+						(((is_attr_set(&prc->rs_value)) == 0) ||
+						(prc->rs_value.at_val.at_size.atsv_num != psvrmom->msr_pmem) ||
+						(prc->rs_value.at_val.at_size.atsv_shift != 10))) {
 						/* set size in KB */
 						prc->rs_value.at_val.at_size.atsv_num  =
 							psvrmom->msr_pmem;
@@ -4645,11 +5083,11 @@ found:
 					if (vnlp->vnl_used > 1)
 						check_other_moms_time = 1;
 
+					/* create/update the vnodes */
+					(void)update2_to_vnodes(vnlp, cr_node, pmom, &made_new_vnodes, 0);
 					for (i = 0; i < vnlp->vnl_used; i++) {
 						vnal_t	*vnrlp;
 						vnrlp = VNL_NODENUM(vnlp, i);
-						/* create vnode */
-						(void)update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 0);
 						for (j = 0; j < vnrlp->vnal_used; j++) {
 							vna_t	*psrp;
 
@@ -4697,6 +5135,8 @@ found:
 			val = disrst(stream, &ret);
 			if (ret == DIS_SUCCESS) {
 				DBPRT(("mom's pbs_version %s ", val))
+				/* a restarted mom may have been upgraded */
+				psvrmom->msr_no_execjob = 0;
 				free(psvrmom->msr_pbs_ver);
 				psvrmom->msr_pbs_ver = val;
 			} else if (ret == DIS_EOD) {
@@ -5075,15 +5515,9 @@ found:
 			/* is_update2 also records the received vnlp's vnl_modtime in pmom->mi_modtime. */
 			if (vnlp->vnl_modtime >= pmom->mi_modtime)
 				cr_node = 1;
-			for (i = 0; i < vnlp->vnl_used; i++) {
-				vnal_t	*vnrlp;
-				vnrlp = VNL_NODENUM(vnlp, i);
-				/* update vnode */
-				made_new_vnodes = 0;
-				if (update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, (command == IS_UPDATE_FROM_HOOK2)?2:1) == PBSE_PERM) {
-					break; /* encountered a bad permission */
-				}
-			}
+			/* update vnodes, stops at a bad permission */
+			made_new_vnodes = 0;
+			(void)update2_to_vnodes(vnlp, cr_node, pmom, &made_new_vnodes, (command == IS_UPDATE_FROM_HOOK2)?2:1);
 			vnl_free(vnlp);
 			vnlp = NULL;
 
@@ -5126,6 +5560,7 @@ found:
 				unsigned long chksum_py;
 				unsigned long chksum_cf;
 				unsigned int  haction;
+				unsigned int  hsynced;
 
 				haction = 0;
 				/* hook name */
@@ -5227,6 +5662,25 @@ found:
 						hname, haction);
 				}
 
+				/*
+				 * what the mom already has need not be sent
+				 * again, e.g. everything queued for every mom
+				 * when the server restarted
+				 */
+				hsynced = 0;
+				if ((phook->hook_control_checksum > 0) &&
+				    (phook->hook_control_checksum == chksum_hk))
+					hsynced |= MOM_HOOK_ACTION_SEND_ATTRS;
+				if ((phook->hook_script_checksum > 0) &&
+				    (phook->hook_script_checksum == chksum_py))
+					hsynced |= MOM_HOOK_ACTION_SEND_SCRIPT;
+				if ((phook->hook_config_checksum > 0) &&
+				    (phook->hook_config_checksum == chksum_cf))
+					hsynced |= MOM_HOOK_ACTION_SEND_CONFIG;
+				if (hsynced != 0)
+					drop_synced_mom_hook_action(pmom,
+						hname, hsynced);
+
 				if (add_to_svrattrl_list(&reported_hooks, hname,
 					NULL, NULL, 0, NULL) == -1) {
 					log_event(PBSEVENT_DEBUG3,
@@ -5263,6 +5717,10 @@ found:
 					add_pending_mom_hook_action(pmom,
 						PBS_RESCDEF,
 						MOM_HOOK_ACTION_SEND_RESCDEF);
+			} else if ((hook_rescdef_checksum > 0) &&
+				(hook_rescdef_checksum == chksum_rescdef)) {
+				drop_synced_mom_hook_action(pmom, PBS_RESCDEF,
+					MOM_HOOK_ACTION_SEND_RESCDEF);
 			}
 
 			/* Look for mom hooks known to the server that are */
@@ -6938,6 +7396,7 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 			}
 		}
 		presv->ri_qs.ri_svrflags |= RESV_SVFLG_HasNodes;
+		resv_vnodes_changed();
 	}
 
 	*execvnod_out = execvnod;
@@ -6986,14 +7445,10 @@ free_nodes(job *pjob)
 	struct pbsnode *pnode;
 	mom_svrinfo_t *psvrmom;
 	char *execvnod_in = NULL;
-	char *execvncopy;
-	char *chunk;
-	char *last;
-	int hasprn;
-	char *vname;
-	int nelem;
-	struct key_value_pair *pkvp;
 	char *execvnod = NULL;
+	struct job_alloc *palloc;
+	mominfo_t *plastmom = NULL;
+	int i;
 
 	/* decrement number of jobs on the Mom who is the first Mom */
 	/* for the job, Mother Superior; incremented in set_nodes() */
@@ -7028,21 +7483,22 @@ free_nodes(job *pjob)
 	} else {
 		execvnod = execvnod_in;
 	}
-	execvncopy = strdup(execvnod);
-	if (execvncopy == NULL)
+	palloc = job_alloc_get(pjob, execvnod);
+	if (palloc == NULL)
 		return;
 
-	chunk = parse_plus_spec_r(execvncopy, &last, &hasprn);
-
-	while (chunk) {
-		if (parse_node_resc(chunk, &vname, &nelem, &pkvp) == 0) {
-			pnode = find_nodebyname(vname);
+	for (i = 0; i < palloc->ja_nent; i++) {
+		pnode = find_nodebyname(palloc->ja_ent[i].ae_vname);
+		if (pnode == NULL)
+			continue;
+		/* the vnodes of a Mom come one after the other in exec_vnode, */
+		/* go through her job index only for the first of them	      */
+		if ((pnode->nd_nummoms != 1) || (pnode->nd_moms[0] != plastmom)) {
 			remove_job_index_from_mom(pjob, pnode);
-			deallocate_job_from_node(pjob, pnode);
-			chunk = parse_plus_spec_r(last, &last, &hasprn);
+			plastmom = (pnode->nd_nummoms == 1) ? pnode->nd_moms[0] : NULL;
 		}
+		deallocate_job_from_node(pjob, pnode);
 	}
-	free(execvncopy);
 	pjob->ji_qs.ji_svrflags &= ~JOB_SVFLG_HasNodes;
 }
 
@@ -7276,7 +7732,8 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
  *		Each "chunk" (subspec between plus signs) is broken into the vnode
  *		name and a key_value_pair array of resources and values.  For each
  *		resource, the corresponding resource (if present) in the vnodes's
- *		resources_assigned is adjusted.
+ *		resources_assigned is adjusted.  For the exec_vnode of a job, the
+ *		parse is the one the job keeps in ji_alloc, see job_alloc_get().
  *
  * @param[in]	pjob	- job to update
  * @param[in]	pexech	- exec_vnode string
@@ -7288,114 +7745,102 @@ void
 update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 {
 	int	  asgn = ATR_DFLAG_ANASSN | ATR_DFLAG_FNASSN;
-	char     *chunk;
+	int       i;
 	int       j;
-	int       nelem;
-	char	 *noden;
 	int	  rc;
 	resource_def	*prdef = NULL;
 	struct key_value_pair *pkvp;
+	struct job_alloc *palloc;
+	struct job_alloc *ptmp = NULL;
 	attribute	*queru = NULL;
 	attribute	*sysru = NULL;
 	resource	*pr = NULL;
 	attribute	tmpattr;
 	int		nchunk = 0;
 
-	/* Parse the exec_vnode string */
+	/* Parse the exec_vnode string, or use what the job has parsed already */
 
 	if (!is_attr_set(pexech))
 		return;
 
+	if ((pjob != NULL) && (pexech == &pjob->ji_wattr[(int) JOB_ATR_exec_vnode]))
+		palloc = job_alloc_get(pjob, pexech->at_val.at_str);
+	else
+		palloc = ptmp = job_alloc_parse(pexech->at_val.at_str);
+	if (palloc == NULL)
+		return;
+
 	if ((pjob != NULL) &&
 		(pexech == &pjob->ji_wattr[(int) JOB_ATR_exec_vnode_deallocated])) {
-		char *pc;
 		sysru = &server.sv_attr[(int)SVR_ATR_resource_assn];
 		queru = &pjob->ji_qhdr->qu_attr[(int)QE_ATR_ResourceAssn];
 
-		pc = pexech->at_val.at_str;
-		while (*pc != '\0') {
-			/* given exec_vnode format: (<chunk1>+<chunk2>)+(<chunk3), 	*/
-			/* <chunk1> and <chunk2> belong to the same node host,      	*/
-			/* while  <chunk3> belongs to another node host. 		*/
-			/* The number of node host chunks can be determined by # of     */
-			/* left parentheses */
-			if (*pc == '(') {
-				nchunk++;
-			}
-			pc++;
-		}
+		/* given exec_vnode format: (<chunk1>+<chunk2>)+(<chunk3), 	*/
+		/* <chunk1> and <chunk2> belong to the same node host,      	*/
+		/* while  <chunk3> belongs to another node host. 		*/
+		nchunk = palloc->ja_nhost;
 	}
-	chunk = parse_plus_spec(pexech->at_val.at_str, &rc);
-	if (rc != 0)
-		return;
-	while (chunk) {
-		if (parse_node_resc(chunk, &noden, &nelem, &pkvp) == 0) {
-			for (j=0; j<nelem; ++j) {
-				prdef = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
-				if (prdef == NULL)
-					return;
+	for (i = 0; i < palloc->ja_nent; i++) {
+		char *noden = palloc->ja_ent[i].ae_vname;
 
-				/* skip all non-consumable resources (e.g. aoe) */
-				if ((prdef->rs_flags & asgn) == 0) {
-					continue;
-				}
+		pkvp = palloc->ja_ent[i].ae_kv;
+		for (j = 0; j < palloc->ja_ent[i].ae_nelem; ++j) {
+			prdef = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
+			if (prdef == NULL)
+				goto update_rassn_exit;
 
-				if ((rc = adj_resc_on_node(noden, asgn, op, prdef, pkvp[j].kv_val, 0)) != 0)
-					return;
-				/* update system attribute of resources assigned */
+			/* skip all non-consumable resources (e.g. aoe) */
+			if ((prdef->rs_flags & asgn) == 0) {
+				continue;
+			}
 
-				if (sysru || queru) {
-					if ((rc = prdef->rs_decode(&tmpattr, ATTR_rescassn, pkvp[j].kv_keyw,
-											pkvp[j].kv_val)) != 0)
-						return;
-				}
+			if ((rc = adj_resc_on_node(noden, asgn, op, prdef, pkvp[j].kv_val, 0)) != 0)
+				goto update_rassn_exit;
+			/* update system attribute of resources assigned */
 
-				if (sysru) {
-					pr = find_resc_entry(sysru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(sysru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					sysru->at_flags |= ATR_SET_MOD_MCACHE;
+			if (sysru || queru) {
+				if ((rc = prdef->rs_decode(&tmpattr, ATTR_rescassn, pkvp[j].kv_keyw,
+										pkvp[j].kv_val)) != 0)
+					goto update_rassn_exit;
+			}
+
+			if (sysru) {
+				pr = find_resc_entry(sysru, prdef);
+				if (pr == NULL) {
+					pr = add_resource_entry(sysru, prdef);
+					if (pr == NULL)
+						goto update_rassn_exit;
 				}
+				prdef->rs_set(&pr->rs_value, &tmpattr, op);
+				if (op == DECR) {
+					check_for_negative_resource(prdef, pr, NULL);
+				}
+				sysru->at_flags |= ATR_SET_MOD_MCACHE;
+			}
 
-				/* update queue attribute of resources assigned */
+			/* update queue attribute of resources assigned */
 
-				if (queru) {
-					pr = find_resc_entry(queru, prdef);
-					if (pr == NULL) {
-						pr = add_resource_entry(queru, prdef);
-						if (pr == NULL)
-							return;
-					}
-					prdef->rs_set(&pr->rs_value, &tmpattr, op);
-					if (op == DECR) {
-						check_for_negative_resource(prdef, pr, NULL);
-					}
-					queru->at_flags |= ATR_SET_MOD_MCACHE;
+			if (queru) {
+				pr = find_resc_entry(queru, prdef);
+				if (pr == NULL) {
+					pr = add_resource_entry(queru, prdef);
+					if (pr == NULL)
+						goto update_rassn_exit;
 				}
-
+				prdef->rs_set(&pr->rs_value, &tmpattr, op);
+				if (op == DECR) {
+					check_for_negative_resource(prdef, pr, NULL);
+				}
+				queru->at_flags |= ATR_SET_MOD_MCACHE;
 			}
-		} else {
-			return;
+
 		}
 		asgn = ATR_DFLAG_ANASSN;
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return;
 	}
 
 	if (sysru || queru) {
 		/* set pseudo-resource "nodect" to the number of chunks */
 		prdef = &svr_resc_def[RESC_NODECT];
-		if (prdef == NULL) {
-			return;
-		}
 	}
 	if (sysru) {
 		pr = find_resc_entry(sysru, prdef);
@@ -7426,7 +7871,8 @@ update_job_node_rassn(job *pjob, attribute *pexech, enum batch_op op)
 			pr->rs_value.at_flags |= ATR_VFLAG_DEFLT | ATR_SET_MOD_MCACHE;
 		}
 	}
-	return;
+update_rassn_exit:
+	job_alloc_release(ptmp);
 }
 
 /**
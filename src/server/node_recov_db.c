@@ -253,7 +253,7 @@ node_to_db(struct pbsnode *pnode, pbs_db_node_info_t *pdbnd)
 			/* check for pcpus if needed after loop end */
 			tmp = (svrattrl *)GET_NEXT(psvrl->al_link); /* store next node pointer */
 			delete_link(&psvrl->al_link);
-			free(psvrl);
+			attrlist_free(psvrl);
 			pdbnd->db_attr_list.attr_count--;
 			psvrl = tmp;
 			continue;
@@ -263,7 +263,7 @@ node_to_db(struct pbsnode *pnode, pbs_db_node_info_t *pdbnd)
 			if ((psvrl->al_flags & ATR_VFLAG_DEFLT) != 0) {
 				tmp = (svrattrl *)GET_NEXT(psvrl->al_link); /* store next node pointer */
 				delete_link(&psvrl->al_link);
-				free(psvrl);
+				attrlist_free(psvrl);
 				pdbnd->db_attr_list.attr_count--;
 				psvrl = tmp;
 				continue;
@@ -333,6 +333,8 @@ node_save_db(struct pbsnode *pnode)
 	int savetype;
 	int rc = -1;
 
+	/* the encoded attributes only live until the save is sent */
+	attrlist_arena_begin();
 	if ((savetype = node_to_db(pnode, &dbnode))  == -1)
 		goto done;
 
@@ -349,6 +351,7 @@ node_save_db(struct pbsnode *pnode)
 
 done:
 	free_db_attr_list(&dbnode.db_attr_list);
+	attrlist_arena_end();
 	
 	if (rc != 0) {
 		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
@@ -111,6 +111,7 @@
 
 extern char	*msg_startup3;
 extern char *msg_daemonname;
+extern u_Long svr_modseq;
 extern char	*msg_init_abt;
 extern char	*msg_init_queued;
 extern char	*msg_init_substate;
@@ -508,6 +509,9 @@ pbsd_init(int type)
 
 	time_now = time(NULL);
 
+	/* start modify_seq above any handed out before this restart */
+	svr_modseq = (u_Long)time_now << 20;
+
 	rc = setup_resc(1);
 	if (rc != 0) {
 		/* log_buffer set in setup_resc */
@@ -666,7 +670,7 @@ pbsd_init(int type)
 	 * 8A. If not a "create" initialization, recover queues.
 	 *    If a create, remove any queues that might be there.
 	 */
-	if ((queues_idx = pbs_idx_create(0, 0)) == NULL) {
+	if ((queues_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 		log_err(-1, __func__, "Creating queue index failed!");
 		return (-1);
 	}
@@ -708,7 +712,7 @@ pbsd_init(int type)
 	set_ical_zoneinfo(zone_dir);
 
 	/* load reservations */
-	if ((resvs_idx = pbs_idx_create(0, 0)) == NULL) {
+	if ((resvs_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 		log_err(-1, __func__, "Creating reservations index failed!");
 		return (-1);
 	}
@@ -730,7 +734,7 @@ pbsd_init(int type)
 	 *    If a create or clean recovery, delete any jobs.
 	 *    Before job creation/recovery, create the jobs index.
 	 */
-	if ((jobs_idx = pbs_idx_create(0, 0)) == NULL) {
+	if ((jobs_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 		log_err(-1, __func__, "Creating jobs index failed!");
 		return (-1);
 	}
@@ -740,7 +744,10 @@ pbsd_init(int type)
 	/* get jobs from DB */
 	obj.pbs_db_obj_type = PBS_DB_JOB;
 	obj.pbs_db_un.pbs_db_job = &dbjob;
-	rc = pbs_db_search(conn, &obj, NULL, (query_cb_t)&recov_job_cb);
+	/* a hot standby Secondary taking over already holds most of them */
+	rc = standby_recover_jobs(conn, &obj, (query_cb_t)&recov_job_cb);
+	if (rc == -2)
+		rc = pbs_db_search(conn, &obj, NULL, (query_cb_t)&recov_job_cb);
 	if (rc == -1) {
 		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
 		if (conn_db_err != NULL) {
@@ -932,6 +939,11 @@ pbsd_init(int type)
 	(void)set_task(WORK_Timed, (long)(time_now + PBS_SAVE_TRACK_TM),
 		track_save, 0);
 
+	/* set work task to periodically write the status snapshot */
+
+	if (pbs_conf.pbs_status_snapshot > 0)
+		(void)set_task(WORK_Timed, time_now, snapshot_status, NULL);
+
 	fd = open(path_prov_track, O_RDONLY | O_CREAT, 0600);
 	if (fd < 0) {
 		log_err(errno, __func__, "unable to open prov_tracking file");
@@ -1328,7 +1340,7 @@ pbsd_init_job(job *pjob, int type)
 			}
 
 			pjob->ji_subjindx = subjob_index_to_offset(pjob->ji_parentaj, get_index_from_jid(pjob->ji_qs.ji_jobid));
-			pjob->ji_parentaj->ji_ajtrk->tkm_tbl[pjob->ji_subjindx].trk_psubjob = pjob;
+			set_subjob_ptr(pjob->ji_parentaj, pjob->ji_subjindx, pjob);
 			/* update the tracking table */
 			set_subjob_tblstate(pjob->ji_parentaj, pjob->ji_subjindx, get_job_state(pjob));
 		}
@@ -1540,6 +1552,7 @@ pbsd_init_resv(resc_resv *presv, int type)
 
 	/* add resv to server list */
 	append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+	resv_vnodes_changed();
 	if (attach_queue_to_reservation(presv))
 		/* reservation needed queue; failed to find it */
 		log_eventf(PBSEVENT_SYSTEM | PBSEVENT_ADMIN | PBSEVENT_DEBUG, PBS_EVENTCLASS_RESV,
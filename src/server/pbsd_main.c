@@ -173,8 +173,10 @@ pbs_list_head	svr_deferred_req;
 pbs_list_head	svr_newjobs;           /* list of incomming new jobs       */
 pbs_list_head	svr_allscheds;
 extern pbs_list_head	svr_creds_cache; /* all credentials available to send */
+extern pbs_list_head	svr_creds_acquiring; /* renew tool runs in progress */
 struct batch_request	*saved_takeover_req;
 int svr_unsent_qrun_req = 0;	/* Set to 1 for scheduling unsent qrun requests */
+u_Long svr_modseq = 0;		/* last modify_seq handed out to a changed object */
 
 void *jobs_idx;
 void *queues_idx;
@@ -613,6 +615,10 @@ main(int argc, char **argv)
 	pid_t sid = -1;
 	long *state;
 	time_t waittime;
+	struct timeval pass_start;	/* for the main loop statistics */
+	struct timeval wait_start;
+	double busy;
+	double waited;
 #ifdef _POSIX_MEMLOCK
 	int do_mlockall = 0;
 #endif /* _POSIX_MEMLOCK */
@@ -630,6 +636,8 @@ main(int argc, char **argv)
 		{ "",		RECOV_Invalid }
 	};
 	static int		first_run = 1;
+	int			more_reads = 0;	/* deferred read-only requests waiting */
+	int			more_deletes = 0; /* job lists waiting to be deleted */
 
 	extern int		optind;
 	extern char		*optarg;
@@ -867,7 +875,6 @@ main(int argc, char **argv)
 
 	CLEAR_HEAD(svr_requests);
 	CLEAR_HEAD(task_list_immed);
-	CLEAR_HEAD(task_list_timed);
 	CLEAR_HEAD(task_list_event);
 	CLEAR_HEAD(svr_queues);
 	CLEAR_HEAD(svr_alljobs);
@@ -900,6 +907,7 @@ main(int argc, char **argv)
 	CLEAR_HEAD(svr_execjob_preresume_hooks);
 	CLEAR_HEAD(svr_allscheds);
 	CLEAR_HEAD(svr_creds_cache);
+	CLEAR_HEAD(svr_creds_acquiring);
 	CLEAR_HEAD(unlicensed_nodes_list);
 
 	/* initialize paths that we will need */
@@ -1063,6 +1071,9 @@ main(int argc, char **argv)
 	prctl(PR_SET_FPEMU, PR_FPEMU_NOPRINT, 0, 0, 0);
 #endif
 
+	/* Start the mailer helper while the server is still small */
+	(void)svr_mail_helper_start();
+
 	/* Setup db connection here */
 	if (server_init_type != RECOV_CREATE && !stalone && !already_forked)
 		background = 1;
@@ -1212,7 +1223,8 @@ main(int argc, char **argv)
 		return (3);
 	}
 
-	(void)add_conn(tppfd, TppComm, (pbs_net_t)0, 0, NULL, tpp_request);
+	/* MoM traffic is served ahead of client requests, see wait_request() */
+	(void)set_conn_as_priority(add_conn(tppfd, TppComm, (pbs_net_t)0, 0, NULL, tpp_request));
 
 	/* record the fact that the Secondary is up and active (running) */
 
@@ -1314,6 +1326,8 @@ main(int argc, char **argv)
 	}
 	process_hooks(periodic_req, hook_msg, sizeof(hook_msg), pbs_python_set_interrupt);
 
+	svr_stats_init();
+
 	/*
 	 * main loop of server
 	 * stays in this loop until server's state is either
@@ -1323,8 +1337,15 @@ main(int argc, char **argv)
 	 * If state includes SV_STATE_PRIMDLY, stay in loop; this will be
 	 * cleared when Secondary Server responds to a request.
 	 */
+
+	/* from here on the log is written once per pass, errors at once */
+	log_set_flush_severity(LOG_ERR);
+
 	while ((*state != SV_STATE_DOWN) && (*state != SV_STATE_SECIDLE)) {
 
+		gettimeofday(&pass_start, NULL);
+		waited = 0;
+
 		/*
 		 * double check that if we are an active Secondary Server, that
 		 * that the Primary has not come back alive; if it did it will
@@ -1369,17 +1390,17 @@ main(int argc, char **argv)
 							   "sent scheduler restart scheduling cycle request to %s", psched->sc_name);
 					} else
 						psched->svr_do_schedule = SCH_SCHEDULE_NULL;
-				} else if (svr_unsent_qrun_req || (psched->svr_do_schedule != SCH_SCHEDULE_NULL && psched->sch_attr[SCHED_ATR_scheduling].at_val.at_long)) {
+				} else if ((svr_unsent_qrun_req && has_unsent_qrun(psched)) || (psched->svr_do_schedule != SCH_SCHEDULE_NULL && psched->sch_attr[SCHED_ATR_scheduling].at_val.at_long)) {
 					/*
 					 * If svr_unsent_qrun_req is set to one there are pending qrun
 					 * request, then do schedule_jobs irrespective of the server scheduling
-					 * state.
+					 * state, for the scheduler of each job to run.
 					 * If svr_unsent_qrun_req is not set then do the existing checking and do
 					 * scheduling only if server scheduling is turned on.
 					 */
 
 					psched->sch_next_schedule = time_now + psched->sch_attr[SCHED_ATR_schediteration].at_val.at_long;
-					if (schedule_jobs(psched) == 0 && svr_unsent_qrun_req)
+					if (schedule_jobs(psched) == 0 && svr_unsent_qrun_req && !has_unsent_qrun(NULL))
 						svr_unsent_qrun_req = 0;
 				}
 			}
@@ -1414,10 +1435,37 @@ main(int argc, char **argv)
 		if (reap_child_flag)
 			reap_child();
 
+		/* send the job saves deferred during this pass, the database */
+		/* completes them while we wait for requests                  */
+		job_save_db_send();
+
+		/* write the accounting and log records gathered during this pass */
+		acct_flush();
+		log_flush();
+		svr_stats_write_file();
+
+		/* do not sleep while read-only or delete requests are waiting */
+		if (more_reads || more_deletes)
+			waittime = 0;
+
 		/* wait for a request and process it */
+		gettimeofday(&wait_start, NULL);
+		busy = svr_stats_busy();
 		if (wait_request(waittime, priority_context) != 0) {
 			log_err(-1, msg_daemonname, "wait_requst failed");
 		}
+		/* the wait is what was not spent serving requests */
+		waited = svr_stats_elapsed(&wait_start) - (svr_stats_busy() - busy);
+		svr_stats_record(SVR_STAT_POLL, waited);
+
+		/* pick up the outcome of the saves sent so far */
+		(void)pbs_db_async_poll(svr_db_conn, 0);
+
+		/* then serve one of the deferred read-only requests */
+		more_reads = serve_deferred_reads();
+
+		/* and the next slice of a long job delete list */
+		more_deletes = serve_deferred_deletes();
 
 		if (reap_child_flag)	/* check again incase signal arrived */
 			reap_child();	/* before they were blocked          */
@@ -1441,13 +1489,21 @@ main(int argc, char **argv)
 			(server.sv_jobstates[JOB_STATE_EXITING] == 0) &&
 			((void *)GET_NEXT(task_list_event) == NULL))
 			*state = SV_STATE_DOWN;
+
+		svr_stats_record(SVR_STAT_LOOP, svr_stats_elapsed(&pass_start) - waited);
 	}
 	DBPRT(("Server out of main loop, state is %ld\n", *state))
+	log_flush();
+	log_set_flush_severity(-1);
+
+	job_save_db_flush();
+	(void)pbs_db_async_poll(svr_db_conn, 1);
 
 	/* set the current seq id to the last id before final save */
 	server.sv_qs.sv_lastid = server.sv_qs.sv_jobidnumber;
 	svr_save_db(&server);	/* final recording of server */
 	track_save(NULL);	/* save tracking data	     */
+	snapshot_remove();	/* clients must not read a stale status */
 
 	/* if brought up the Secondary Scheduler, take it down */
 
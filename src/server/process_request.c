@@ -58,6 +58,12 @@
  *	process_request()
  *	set_to_non_blocking()
  *	clear_non_blocking()
+ *	now_secs()
+ *	find_read_client()
+ *	sweep_read_clients()
+ *	client_over_rate()
+ *	defer_read_request()
+ *	serve_deferred_reads()
  *	dispatch_request()
  *	close_client()
  *	alloc_br()
@@ -110,10 +116,36 @@
 #include <libutil.h>
 #include "pbs_sched.h"
 #include "auth.h"
+#include "pbs_idx.h"
+#include "mem_acct.h"
 
 /* global data items */
 
 pbs_list_head svr_requests;
+#ifndef PBS_MOM
+#define READ_CLIENT_IDLE 60	/* seconds before an idle client entry is dropped */
+
+/*
+ * A client of read-only requests: a user at a host.  It holds the
+ * requests of the client waiting to be served and its allowance of
+ * requests under max_request_rate.
+ */
+struct read_client {
+	pbs_list_link	rc_turn;	/* on svr_read_clients while requests wait */
+	pbs_list_link	rc_all;		/* on svr_all_read_clients */
+	pbs_list_head	rc_reqs;	/* waiting requests, oldest first */
+	double		rc_tokens;	/* requests the client may send now */
+	double		rc_stamp;	/* when rc_tokens was last brought up to date */
+	char		rc_key[PBS_MAXUSER + PBS_MAXHOSTNAME + 2]; /* user@host */
+};
+
+/* clients with read-only requests waiting, served in turn, see defer_read_request() */
+static pbs_list_head svr_read_clients = {&svr_read_clients, &svr_read_clients, NULL};
+static pbs_list_head svr_all_read_clients = {&svr_all_read_clients, &svr_all_read_clients, NULL};
+static void *read_clients_idx = NULL;
+static time_t read_clients_swept = 0;
+static int serving_deferred_read = 0;
+#endif
 
 
 extern struct server server;
@@ -178,12 +210,327 @@ get_credential(char *remote, job *jobp, int from, char **data, size_t *dsize)
 	return ret;
 }
 
+#ifndef PBS_MOM
+/* authenticated sessions a client may resume, see PBS_AUTH_SESSIONS */
+#define AUTH_SESSION_MAX	4096	/* most sessions kept at a time */
+#define AUTH_SESSION_IDLE	600	/* seconds an unused session stays valid */
+#define AUTH_SESSION_PENDING	60	/* seconds its first connection has to authenticate */
+#define AUTH_SESSION_LIFETIME	3600	/* seconds a session lasts, unless auth_session_lifetime */
+
+typedef struct auth_session {
+	char as_token[AUTH_SESSION_TOKEN_LEN + 1];
+	char as_user[PBS_MAXUSER + 1];
+	char as_host[PBS_MAXHOSTNAME + 1];	/* host the handshake authenticated */
+	char as_method[MAXAUTHNAME + 1];	/* authentication method of the handshake */
+	char *as_credid;	/* GSS principal, user@realm, NULL for other methods */
+	pbs_net_t as_addr;	/* client host the session is bound to */
+	int as_sock;		/* connection still authenticating, -1 once usable */
+	time_t as_issued;	/* time issued */
+	time_t as_lasttime;	/* time issued or last resumed */
+} auth_session_t;
+
+static void *auth_sessions = NULL;
+static int auth_sessions_ct = 0;
+
+/**
+ * @brief
+ *	auth_session_lifetime - seconds a session lasts from when it was
+ *	issued, however often it is resumed, see auth_session_lifetime
+ *
+ * @return	long
+ * @retval	0 - sessions are not issued nor resumed
+ */
+static long
+auth_session_lifetime(void)
+{
+	attribute *pattr = &server.sv_attr[(int)SVR_ATR_auth_session_lifetime];
+
+	if (is_attr_set(pattr))
+		return pattr->at_val.at_long;
+	return AUTH_SESSION_LIFETIME;
+}
+
+/**
+ * @brief
+ *	auth_session_expired - tell whether a session can no longer be used
+ *
+ * @param[in]	as - session
+ *
+ * @return	int
+ * @retval	1 - expired
+ * @retval	0 - still valid
+ */
+static int
+auth_session_expired(auth_session_t *as)
+{
+	if (as->as_sock != -1)
+		return (as->as_lasttime + AUTH_SESSION_PENDING < time_now);
+	if (as->as_issued + auth_session_lifetime() <= time_now)
+		return 1;
+	return (as->as_lasttime + AUTH_SESSION_IDLE < time_now);
+}
+
+/**
+ * @brief
+ *	auth_session_del - forget a session
+ *
+ * @param[in]	as - session
+ *
+ * @return	void
+ */
+static void
+auth_session_del(auth_session_t *as)
+{
+	pbs_idx_delete(auth_sessions, as->as_token);
+	auth_sessions_ct--;
+	free(as->as_credid);
+	free(as);
+}
+
+/**
+ * @brief
+ *	auth_session_sweep - forget all expired sessions, or all sessions
+ *
+ * @param[in]	all - forget every session, clients have to authenticate anew
+ *
+ * @return	void
+ */
+static void
+auth_session_sweep(int all)
+{
+	void *idx_ctx = NULL;
+	auth_session_t *as = NULL;
+	auth_session_t **expired;
+	int ct = 0;
+	int i;
+
+	if (auth_sessions_ct == 0)
+		return;
+	if ((expired = malloc(auth_sessions_ct * sizeof(auth_session_t *))) == NULL)
+		return;
+	while (ct < auth_sessions_ct &&
+	       pbs_idx_find(auth_sessions, NULL, (void **)&as, &idx_ctx) == PBS_IDX_RET_OK) {
+		if (all || auth_session_expired(as))
+			expired[ct++] = as;
+	}
+	pbs_idx_free_ctx(idx_ctx);
+	for (i = 0; i < ct; i++)
+		auth_session_del(expired[i]);
+	free(expired);
+}
+
+/**
+ * @brief
+ *	auth_session_new - issue a session token for a connection which is
+ *	about to authenticate the usual way; it can be resumed once that
+ *	connection sends its first authenticated request
+ *
+ * @param[in]	conn - connection
+ *
+ * @return	char *
+ * @retval	token - stored in conn->cn_session
+ * @retval	NULL - no session issued
+ */
+static char *
+auth_session_new(conn_t *conn)
+{
+	static const char hexdigits[] = "0123456789abcdef";
+	unsigned char rnd[AUTH_SESSION_TOKEN_LEN / 2];
+	auth_session_t *as;
+	int fd;
+	int i;
+
+	if (auth_sessions == NULL && (auth_sessions = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+		return NULL;
+	if (auth_session_lifetime() <= 0)
+		return NULL;
+	if (auth_sessions_ct >= AUTH_SESSION_MAX) {
+		auth_session_sweep(0);
+		if (auth_sessions_ct >= AUTH_SESSION_MAX)
+			return NULL;
+	}
+
+	if ((fd = open("/dev/urandom", O_RDONLY)) == -1)
+		return NULL;
+	i = read(fd, rnd, sizeof(rnd));
+	close(fd);
+	if (i != sizeof(rnd))
+		return NULL;
+
+	if ((as = calloc(1, sizeof(auth_session_t))) == NULL)
+		return NULL;
+	for (i = 0; i < (int) sizeof(rnd); i++) {
+		as->as_token[2 * i] = hexdigits[rnd[i] >> 4];
+		as->as_token[2 * i + 1] = hexdigits[rnd[i] & 0xf];
+	}
+	if (conn->cn_auth_config != NULL && conn->cn_auth_config->auth_method != NULL)
+		snprintf(as->as_method, sizeof(as->as_method), "%s", conn->cn_auth_config->auth_method);
+	as->as_addr = conn->cn_addr;
+	as->as_sock = conn->cn_sock;
+	as->as_issued = time_now;
+	as->as_lasttime = time_now;
+	if (pbs_idx_insert(auth_sessions, as->as_token, as) != PBS_IDX_RET_OK) {
+		free(as);
+		return NULL;
+	}
+	auth_sessions_ct++;
+	strcpy(conn->cn_session, as->as_token);
+	return conn->cn_session;
+}
+
+/**
+ * @brief
+ *	auth_session_activate - make the session issued to a connection
+ *	resumable, now that the connection has authenticated its user
+ *
+ * @param[in]	conn - connection
+ *
+ * @return	void
+ */
+static void
+auth_session_activate(conn_t *conn)
+{
+	char *token = conn->cn_session;
+	auth_session_t *as = NULL;
+
+	if (auth_sessions != NULL &&
+	    pbs_idx_find(auth_sessions, (void **)&token, (void **)&as, NULL) == PBS_IDX_RET_OK &&
+	    as->as_sock == conn->cn_sock) {
+		if (auth_session_expired(as))
+			auth_session_del(as);
+		else {
+			strcpy(as->as_user, conn->cn_username);
+			strcpy(as->as_host, conn->cn_hostname);
+			if (conn->cn_credid != NULL && (as->as_credid = strdup(conn->cn_credid)) == NULL)
+				auth_session_del(as);
+			else {
+				as->as_sock = -1;
+				as->as_lasttime = time_now;
+			}
+		}
+	}
+	conn->cn_session[0] = '\0';
+}
+
+/**
+ * @brief
+ *	auth_session_resume - check a session offered in place of a handshake
+ *
+ *	A session offered by another user or from another host is revoked, its
+ *	token has leaked.
+ *
+ * @param[in]	conn - connection
+ * @param[in]	token - session token
+ * @param[in]	user - user the request claims to come from
+ * @param[in]	host - host the request claims to come from
+ * @param[in]	method - authentication method the request asks for
+ *
+ * @return	auth_session_t *
+ * @retval	session - valid for this user, client host and method
+ * @retval	NULL - the client has to authenticate
+ */
+static auth_session_t *
+auth_session_resume(conn_t *conn, char *token, char *user, char *host, char *method)
+{
+	auth_session_t *as = NULL;
+
+	if (auth_sessions == NULL ||
+	    pbs_idx_find(auth_sessions, (void **)&token, (void **)&as, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	if (auth_session_expired(as)) {
+		auth_session_del(as);
+		return NULL;
+	}
+	if (as->as_sock != -1)
+		return NULL;
+	if (as->as_addr != conn->cn_addr || strcmp(as->as_user, user) != 0) {
+		log_eventf(PBSEVENT_SECURITY, PBS_EVENTCLASS_REQUEST, LOG_WARNING, __func__,
+			"session of %s@%s offered by %s@%s, revoked", as->as_user, as->as_host,
+			user, host);
+		auth_session_del(as);
+		return NULL;
+	}
+	if (strcmp(as->as_method, method) != 0)
+		return NULL;
+	as->as_lasttime = time_now;
+	return as;
+}
+
+/**
+ * @brief
+ *	action_auth_session_lifetime - action function for the
+ *	auth_session_lifetime server attribute.  Changing it revokes every
+ *	session: clients authenticate anew on their next connection.
+ *
+ * @param[in]	pattr - attribute being set
+ * @param[in]	pobject - server
+ * @param[in]	actmode - action mode
+ *
+ * @return	int
+ * @retval	PBSE_NONE - always
+ */
+int
+action_auth_session_lifetime(attribute *pattr, void *pobject, int actmode)
+{
+	if (actmode == ATR_ACTION_ALTER && auth_sessions_ct > 0) {
+		log_eventf(PBSEVENT_SECURITY, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
+			"%d authenticated sessions revoked", auth_sessions_ct);
+		auth_session_sweep(1);
+	}
+	return PBSE_NONE;
+}
+#endif	/* PBS_MOM */
+
+/**
+ * @brief
+ *	reply_authenticate - accept an authentication request, with the
+ *	items the client offered that are taken up
+ *
+ *	The binary DIS offer is echoed, and the connection switches to it
+ *	once the (text) reply is sent.
+ *
+ * @param[in]	conn - connection authenticating
+ * @param[in]	request - authentication request, freed
+ * @param[in]	items - items to return besides the DIS one, "" if none
+ *
+ * @return	void
+ */
+static void
+reply_authenticate(conn_t *conn, struct batch_request *request, char *items)
+{
+	char rtext[sizeof(DIS_BINARY_EXTEND) + sizeof(AUTH_EXT_SESSION_NEW) + AUTH_SESSION_TOKEN_LEN + 2] = "";
+	int sock = conn->cn_sock;
+	int binary = 0;
+
+	if (pbs_conf.pbs_dis_binary && get_auth_ext(request->rq_extend, DIS_BINARY_EXTEND, NULL, 0)) {
+		strcpy(rtext, DIS_BINARY_EXTEND);
+		binary = 1;
+	}
+	if (items[0] != '\0') {
+		if (rtext[0] != '\0')
+			strcat(rtext, ",");
+		strncat(rtext, items, sizeof(rtext) - strlen(rtext) - 1);
+	}
+	if (rtext[0] == '\0') {
+		reply_ack(request);
+		return;
+	}
+	if (reply_text(request, 0, rtext) == 0 && binary)
+		dis_set_binary(sock, 1);
+}
+
 static void
 req_authenticate(conn_t *conn, struct batch_request *request)
 {
 	auth_def_t *authdef = NULL;
 	auth_def_t *encryptdef = NULL;
 	conn_t *cp = NULL;
+	char items[sizeof(AUTH_EXT_SESSION_NEW) + AUTH_SESSION_TOKEN_LEN + 1] = "";
+#ifndef PBS_MOM
+	char token[AUTH_SESSION_TOKEN_LEN + 1];
+	auth_session_t *as;
+	int want_session = 0;
+#endif
 
 	if (!is_string_in_arr(pbs_conf.supported_auth_methods, request->rq_ind.rq_auth.rq_auth_method)) {
 		req_reject(PBSE_NOSUP, 0, request);
@@ -208,6 +555,37 @@ req_authenticate(conn_t *conn, struct batch_request *request)
 			return;
 		}
 		cp = conn;
+#ifndef PBS_MOM
+		/* a session carries no encryption context */
+		want_session = pbs_conf.pbs_auth_sessions && encryptdef == NULL &&
+			get_auth_ext(request->rq_extend, AUTH_EXT_SESSION, token, sizeof(token));
+		if (want_session && token[0] != '\0' &&
+		    (as = auth_session_resume(conn, token, request->rq_user,
+						request->rq_host, request->rq_ind.rq_auth.rq_auth_method)) != NULL) {
+			/* no handshake, the session vouches for the user */
+			(void) strcpy(conn->cn_username, request->rq_user);
+			(void) strcpy(conn->cn_hostname, request->rq_host);
+			if (as->as_credid != NULL) {
+				/* as the GSS handshake would, see process_request() */
+				(void) strcpy(conn->cn_username, as->as_user);
+				(void) strcpy(conn->cn_hostname, as->as_host);
+				conn->cn_credid = strdup(as->as_credid);
+				conn->cn_auth_config = make_auth_config(as->as_method, "",
+					pbs_conf.pbs_exec_path, pbs_conf.pbs_home_path, (void *)log_event);
+				if (conn->cn_credid == NULL || conn->cn_auth_config == NULL) {
+					req_reject(PBSE_SYSTEM, 0, request);
+					close_client(conn->cn_sock);
+					return;
+				}
+			}
+			conn->cn_timestamp = time_now;
+			conn->cn_authen |= PBS_NET_CONN_AUTHENTICATED;
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_REQUEST, LOG_DEBUG, __func__,
+				"session resumed for %s@%s on socket %d", conn->cn_username, conn->cn_hostname, conn->cn_sock);
+			reply_authenticate(conn, request, AUTH_EXT_SESSION_OK);
+			return;
+		}
+#endif
 	} else {
 		/* ensure resvport auth request is coming from priv port */
 		if ((conn->cn_authen & PBS_NET_CONN_FROM_PRIVIL) == 0) {
@@ -259,7 +637,20 @@ req_authenticate(conn_t *conn, struct batch_request *request)
 	if (strcmp(request->rq_ind.rq_auth.rq_auth_method, AUTH_RESVPORT_NAME) == 0) {
 		transport_chan_set_ctx_status(cp->cn_sock, AUTH_STATUS_CTX_READY, FOR_AUTH);
 	}
-	reply_ack(request);
+	if (cp != conn) {
+		reply_ack(request);
+		return;
+	}
+
+#ifndef PBS_MOM
+	if (want_session) {
+		char *newtoken = auth_session_new(conn);
+
+		if (newtoken != NULL)
+			sprintf(items, "%s=%s", AUTH_EXT_SESSION_NEW, newtoken);
+	}
+#endif
+	reply_authenticate(conn, request, items);
 }
 
 #ifndef PBS_MOM
@@ -525,6 +916,8 @@ process_request(int sfds)
 			}
 		}
 
+		if (conn->cn_session[0] != '\0')
+			auth_session_activate(conn);
 		conn->cn_authen |= PBS_NET_CONN_AUTHENTICATED;
 	}
 
@@ -644,10 +1037,12 @@ process_request(int sfds)
 		switch (request->rq_type) {
 			case PBS_BATCH_AsyrunJob:
 			case PBS_BATCH_AsyrunJob_ack:
+			case PBS_BATCH_RunSubjobs_Async:
 			case PBS_BATCH_JobCred:
 			case PBS_BATCH_UserCred:
 			case PBS_BATCH_MoveJob:
 			case PBS_BATCH_QueueJob:
+			case PBS_BATCH_SubmitJobList:
 			case PBS_BATCH_RunJob:
 			case PBS_BATCH_StageIn:
 			case PBS_BATCH_jobscript:
@@ -751,6 +1146,253 @@ clear_non_blocking(conn_t *conn)
 		conn->cn_sockflgs = 0;
 	}
 }
+
+/**
+ * @brief
+ *		Returns the current time in seconds, with microseconds.
+ */
+static double
+now_secs(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/**
+ * @brief
+ *		Find the entry of the client, the user at the host, of a request,
+ *		creating it if it is not known yet.
+ *
+ * @param[in]	request - the request
+ *
+ * @return	struct read_client *
+ * @retval	NULL	- out of memory
+ */
+static struct read_client *
+find_read_client(struct batch_request *request)
+{
+	struct read_client *pclient = NULL;
+	char key[PBS_MAXUSER + PBS_MAXHOSTNAME + 2];
+	void *pkey = key;
+
+	if (read_clients_idx == NULL &&
+		(read_clients_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+		return NULL;
+
+	snprintf(key, sizeof(key), "%s@%s", request->rq_user, request->rq_host);
+	if (pbs_idx_find(read_clients_idx, &pkey, (void **)&pclient, NULL) == PBS_IDX_RET_OK)
+		return pclient;
+
+	if ((pclient = calloc(1, sizeof(struct read_client))) == NULL) {
+		log_err(errno, __func__, msg_err_malloc);
+		return NULL;
+	}
+	CLEAR_LINK(pclient->rc_turn);
+	CLEAR_LINK(pclient->rc_all);
+	CLEAR_HEAD(pclient->rc_reqs);
+	pclient->rc_tokens = -1;	/* a full allowance, see client_over_rate() */
+	pclient->rc_stamp = now_secs();
+	strcpy(pclient->rc_key, key);
+	if (pbs_idx_insert(read_clients_idx, pclient->rc_key, pclient) != PBS_IDX_RET_OK) {
+		free(pclient);
+		return NULL;
+	}
+	append_link(&svr_all_read_clients, &pclient->rc_all, pclient);
+	return pclient;
+}
+
+/**
+ * @brief
+ *		Drop the entries of clients with no requests waiting which have
+ *		not sent any for READ_CLIENT_IDLE seconds.  Their allowance is
+ *		full again by then, so a new entry is just the same.
+ */
+static void
+sweep_read_clients(void)
+{
+	struct read_client *pclient;
+	struct read_client *pnext;
+	double now;
+
+	if (time_now < read_clients_swept + READ_CLIENT_IDLE)
+		return;
+	read_clients_swept = time_now;
+
+	now = now_secs();
+	for (pclient = (struct read_client *)GET_NEXT(svr_all_read_clients); pclient; pclient = pnext) {
+		pnext = (struct read_client *)GET_NEXT(pclient->rc_all);
+		if (GET_NEXT(pclient->rc_reqs) != NULL || now < pclient->rc_stamp + READ_CLIENT_IDLE)
+			continue;
+		delete_link(&pclient->rc_turn);
+		delete_link(&pclient->rc_all);
+		pbs_idx_delete(read_clients_idx, pclient->rc_key);
+		free(pclient);
+	}
+}
+
+/**
+ * @brief
+ *		Check a status, select or job list delete request from a client
+ *		against max_request_rate.  Each user at each host has an
+ *		allowance of that many requests, which refills at that many per
+ *		second, and every request takes one from it.
+ *
+ * @param[in]	conn	- connection of the request
+ * @param[in]	request - the request
+ *
+ * @return	int
+ * @retval	1	- the client is over its rate, reject the request
+ * @retval	0	- serve the request
+ */
+static int
+client_over_rate(conn_t *conn, struct batch_request *request)
+{
+	struct read_client *pclient;
+	attribute *pattr = &server.sv_attr[(int)SVR_ATR_max_request_rate];
+	double rate;
+	double now;
+
+	if (!is_attr_set(pattr) || pattr->at_val.at_long <= 0)
+		return 0;
+	if (conn == NULL || request->prot != PROT_TCP || request->rq_fromsvr)
+		return 0;
+	if (conn->cn_origin != CONN_UNKNOWN || conn->cn_prio_flag)
+		return 0;
+
+	switch (request->rq_type) {
+		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusQue:
+		case PBS_BATCH_StatusNode:
+		case PBS_BATCH_StatusResv:
+		case PBS_BATCH_SelectJobs:
+		case PBS_BATCH_SelStat:
+		case PBS_BATCH_DeleteJobList:
+			break;
+		default:
+			return 0;
+	}
+
+	if ((pclient = find_read_client(request)) == NULL)
+		return 0;
+
+	rate = pattr->at_val.at_long;
+	now = now_secs();
+	if (pclient->rc_tokens < 0)
+		pclient->rc_tokens = rate;
+	else
+		pclient->rc_tokens += (now - pclient->rc_stamp) * rate;
+	if (pclient->rc_tokens > rate)
+		pclient->rc_tokens = rate;
+	pclient->rc_stamp = now;
+
+	if (pclient->rc_tokens < 1) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_REQUEST, LOG_DEBUG, __func__,
+			"%s over %s, request type %d rejected", pclient->rc_key,
+			ATTR_max_request_rate, request->rq_type);
+		return 1;
+	}
+	pclient->rc_tokens -= 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		Put a read-only request from a client on the list of deferred
+ *		reads instead of serving it right away.
+ * @par
+ *		Status and select requests from clients can be expensive and
+ *		do not change anything, so they are served one per pass of the
+ *		server main loop by serve_deferred_reads(), after the requests
+ *		that do change something.  A storm of qstat then does not hold
+ *		up qsub, qdel or the MoMs.  Requests from the scheduler are
+ *		never deferred.
+ * @par
+ *		The requests wait per client, the user at the host, and the
+ *		clients take turns, so one user's storm of qstat does not hold
+ *		up another user's either.
+ *
+ * @param[in]	conn	- connection of the request
+ * @param[in]	request - the request
+ *
+ * @return	int
+ * @retval	1	- the request was deferred
+ * @retval	0	- serve the request now
+ */
+static int
+defer_read_request(conn_t *conn, struct batch_request *request)
+{
+	struct read_client *pclient;
+
+	if (conn == NULL || request->prot != PROT_TCP)
+		return 0;
+	if (conn->cn_origin != CONN_UNKNOWN || conn->cn_prio_flag)
+		return 0;
+
+	switch (request->rq_type) {
+		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusQue:
+		case PBS_BATCH_StatusNode:
+		case PBS_BATCH_StatusResv:
+		case PBS_BATCH_SelectJobs:
+		case PBS_BATCH_SelStat:
+			break;
+		default:
+			return 0;
+	}
+
+	if ((pclient = find_read_client(request)) == NULL)
+		return 0;
+
+	append_link(&pclient->rc_reqs, &request->rq_readlink, request);
+	/* a cleared link points to itself: the client is not waiting its turn yet */
+	if (pclient->rc_turn.ll_next == &pclient->rc_turn)
+		append_link(&svr_read_clients, &pclient->rc_turn, pclient);
+	return 1;
+}
+
+/**
+ * @brief
+ *		Serve the oldest deferred read-only request of the client whose
+ *		turn it is, see defer_read_request().  The client goes to the back
+ *		of the line if it has more requests waiting.  A request whose
+ *		client went away in the meantime is dropped.
+ *
+ * @return	int
+ * @retval	1	- more deferred requests are waiting
+ * @retval	0	- no deferred requests left
+ */
+int
+serve_deferred_reads(void)
+{
+	struct read_client *pclient;
+	struct batch_request *preq = NULL;
+
+	sweep_read_clients();
+
+	while ((pclient = (struct read_client *)GET_NEXT(svr_read_clients)) != NULL) {
+		delete_link(&pclient->rc_turn);
+		/* the requests of a client can be freed while they wait */
+		if ((preq = (struct batch_request *)GET_NEXT(pclient->rc_reqs)) == NULL)
+			continue;
+		delete_link(&preq->rq_readlink);
+		if (GET_NEXT(pclient->rc_reqs) != NULL)
+			append_link(&svr_read_clients, &pclient->rc_turn, pclient);
+		break;
+	}
+
+	if (preq != NULL) {
+		if (preq->rq_conn < 0)
+			free_br(preq);
+		else {
+			serving_deferred_read = 1;
+			dispatch_request(preq->rq_conn, preq);
+			serving_deferred_read = 0;
+		}
+	}
+	return (GET_NEXT(svr_read_clients) != NULL);
+}
 #endif	/* !PBS_MOM */
 
 /**
@@ -772,6 +1414,10 @@ dispatch_request(int sfds, struct batch_request *request)
 
 	conn_t *conn = NULL;
 	int prot = request->prot;
+#ifndef PBS_MOM
+	int rq_type = request->rq_type;	/* the request may be freed when served */
+	struct timeval start;
+#endif
 
 	if (prot == PROT_TCP) {
 		if (sfds != PBS_LOCAL_CONNECTION) {
@@ -785,6 +1431,20 @@ dispatch_request(int sfds, struct batch_request *request)
 		}
 	}
 
+#ifndef PBS_MOM
+	if (!serving_deferred_read) {
+		if (client_over_rate(conn, request)) {
+			req_reject(PBSE_TRYAGAIN, 0, request);
+			return;
+		}
+		if (defer_read_request(conn, request))
+			return;
+	}
+	if (conn && conn->cn_origin == CONN_SCHED_PRIMARY)
+		hold_sched_reply(request, 0);
+	gettimeofday(&start, NULL);
+#endif
+
 	switch (request->rq_type) {
 
 		case PBS_BATCH_QueueJob:
@@ -915,6 +1575,10 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_rerunjob(request);
 			break;
 #ifndef PBS_MOM
+		case PBS_BATCH_ModifyJobList_Async:
+			req_modifyjoblist(request);
+			break;
+
 		case PBS_BATCH_MoveJob:
 			req_movejob(request);
 			break;
@@ -947,6 +1611,18 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_runjob(request);
 			break;
 
+		case PBS_BATCH_RunSubjobs_Async:
+			req_runsubjobs(request);
+			break;
+
+		case PBS_BATCH_SubmitJobList:
+			req_submitjoblist(request);
+			break;
+
+		case PBS_BATCH_Subscribe:
+			req_subscribe(request);
+			break;
+
 		case PBS_BATCH_DefSchReply:
 			req_defschedreply(request);
 			break;
@@ -960,6 +1636,10 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_selectjobs(request);
 			break;
 
+		case PBS_BATCH_ModifyJobsSel:
+			req_modifyjobs_sel(request);
+			break;
+
 #endif /* !PBS_MOM */
 
 		case PBS_BATCH_Shutdown:
@@ -1132,6 +1812,9 @@ dispatch_request(int sfds, struct batch_request *request)
 			close_client(sfds);
 			break;
 	}
+#ifndef PBS_MOM
+	svr_stats_request(rq_type, &start);
+#endif
 	return;
 }
 
@@ -1178,8 +1861,11 @@ struct batch_request *alloc_br(int type)
 		log_err(errno, "alloc_br", msg_err_malloc);
 	else {
 		memset((void *)req, (int)0, sizeof(struct batch_request));
+		mem_acct_add(MEM_ACCT_BATCH_REQ, 1, sizeof(struct batch_request));
 		req->rq_type = type;
 		CLEAR_LINK(req->rq_link);
+		CLEAR_LINK(req->rq_readlink);
+		CLEAR_LINK(req->rq_heldlink);
 		req->rq_conn = -1;		/* indicate not connected */
 		req->rq_orgconn = -1;		/* indicate not connected */
 		req->rq_time = time_now;
@@ -1417,8 +2103,19 @@ decode_DIS_RelnodesJob(int sock, struct batch_request *preq)
 void
 free_br(struct batch_request *preq)
 {
+	int i;
+
 	delete_link(&preq->rq_link);
+	delete_link(&preq->rq_readlink);
 	reply_free(&preq->rq_reply);
+#ifndef PBS_MOM
+	if (preq->rq_held) {
+		/* the next replies to the scheduler may have been waiting on this one */
+		delete_link(&preq->rq_heldlink);
+		preq->rq_held = 0;
+		release_held_replies(preq->rq_conn);
+	}
+#endif
 
 	if (preq->rq_parentbr) {
 		/*
@@ -1443,6 +2140,7 @@ free_br(struct batch_request *preq)
 			free(preq->tppcmd_msgid);
 
 		(void)free(preq);
+		mem_acct_add(MEM_ACCT_BATCH_REQ, -1, -(long long)sizeof(struct batch_request));
 		return;
 	}
 
@@ -1457,6 +2155,8 @@ free_br(struct batch_request *preq)
 	switch (preq->rq_type) {
 		case PBS_BATCH_QueueJob:
 			free_attrlist(&preq->rq_ind.rq_queuejob.rq_attr);
+			free(preq->rq_ind.rq_queuejob.rq_script);
+			free(preq->rq_ind.rq_queuejob.rq_cred);
 			break;
 		case PBS_BATCH_JobCred:
 			if (preq->rq_ind.rq_jobcred.rq_data)
@@ -1511,6 +2211,7 @@ free_br(struct batch_request *preq)
 		case PBS_BATCH_StatusHook:
 		case PBS_BATCH_StatusRsc:
 		case PBS_BATCH_StatusResv:
+		case PBS_BATCH_Subscribe:
 			if (preq->rq_ind.rq_status.rq_id)
 				free(preq->rq_ind.rq_status.rq_id);
 			free_attrlist(&preq->rq_ind.rq_status.rq_attr);
@@ -1519,6 +2220,25 @@ free_br(struct batch_request *preq)
 			if (preq->rq_ind.rq_deletejoblist.rq_jobslist)
 				free(preq->rq_ind.rq_deletejoblist.rq_jobslist);
 			break;
+		case PBS_BATCH_ModifyJobList_Async:
+			for (i = 0; i < preq->rq_ind.rq_modifyjoblist.rq_count; i++)
+				freebr_manage(&preq->rq_ind.rq_modifyjoblist.rq_jobs[i]);
+			free(preq->rq_ind.rq_modifyjoblist.rq_jobs);
+			break;
+		case PBS_BATCH_RunSubjobs_Async:
+			for (i = 0; i < preq->rq_ind.rq_runsubjobs.rq_count; i++)
+				free(preq->rq_ind.rq_runsubjobs.rq_destins[i]);
+			free(preq->rq_ind.rq_runsubjobs.rq_destins);
+			free(preq->rq_ind.rq_runsubjobs.rq_indices);
+			break;
+		case PBS_BATCH_SubmitJobList:
+			free_attrlist(&preq->rq_ind.rq_submitjoblist.rq_attr);
+			for (i = 0; i < preq->rq_ind.rq_submitjoblist.rq_count; i++) {
+				free_attrlist(&preq->rq_ind.rq_submitjoblist.rq_jobs[i].rq_attr);
+				free(preq->rq_ind.rq_submitjoblist.rq_jobs[i].rq_script);
+			}
+			free(preq->rq_ind.rq_submitjoblist.rq_jobs);
+			break;
 		case PBS_BATCH_CopyFiles:
 		case PBS_BATCH_DelFiles:
 			freebr_cpyfile(&preq->rq_ind.rq_cpyfile);
@@ -1563,6 +2283,10 @@ free_br(struct batch_request *preq)
 			free_attrlist(&preq->rq_ind.rq_select.rq_selattr);
 			free_attrlist(&preq->rq_ind.rq_select.rq_rtnattr);
 			break;
+		case PBS_BATCH_ModifyJobsSel:
+			free_attrlist(&preq->rq_ind.rq_modifysel.rq_selattr);
+			free_attrlist(&preq->rq_ind.rq_modifysel.rq_attr);
+			break;
 		case PBS_BATCH_PreemptJobs:
 			free(preq->rq_ind.rq_preempt.ppj_list);
 			free(preq->rq_reply.brp_un.brp_preempt_jobs.ppj_list);
@@ -1572,6 +2296,7 @@ free_br(struct batch_request *preq)
 	if (preq->tppcmd_msgid)
 		free(preq->tppcmd_msgid);
 	(void)free(preq);
+	mem_acct_add(MEM_ACCT_BATCH_REQ, -1, -(long long)sizeof(struct batch_request));
 }
 /**
  * @brief
@@ -173,6 +173,8 @@ que_free(pbs_queue *pq)
 		free(pkvp);
 	}
 
+	free(pq->qu_route_destgen);
+
 	/* now free the main structure */
 	server.sv_qs.sv_numque--;
 	delete_link(&pq->qu_link);
@@ -221,7 +223,6 @@ que_purge(pbs_queue *pque)
 
 			job 	*pjob = NULL;
 			job 	*nxpjob = NULL;
-			int state_num;
 
 			pjob = (job *)GET_NEXT(pque->qu_jobs);
 			while (pjob) {
@@ -243,13 +244,12 @@ que_purge(pbs_queue *pque)
 			 * header pointer of job(pjob->ji_qhdr) to NULL.
 			 */
 			pjob = (job *)GET_NEXT(pque->qu_jobs);
-			state_num = get_job_state_num(pjob);
 			while (pjob) {
 				nxpjob = (job *)GET_NEXT(pjob->ji_jobque);
 				delete_link(&pjob->ji_jobque);
 				--pque->qu_numjobs;
-				if (state_num != -1)
-					--pque->qu_njstate[state_num];
+				if (pjob->ji_ctstate != -1)
+					--pque->qu_njstate[pjob->ji_ctstate];
 				pjob->ji_qhdr = NULL;
 				pjob = nxpjob;
 			}
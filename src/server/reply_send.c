@@ -50,6 +50,7 @@
  *	reply_text()  - send a return with a supplied text string
  *	reply_jobid() - used by several requests where the job id must be sent
  *	reply_free()  - free the substructure that might hang from a reply
+ *	release_brp_enc() - drop a reference to a shared encoded status
  *	set_err_msg() - set a message relating to the error "code"
  *	dis_reply_write()	- reply is sent to a remote client
  *	reply_badattr()	- Create a reject (error) reply for a request including the name of the bad attribute/resource.
@@ -86,9 +87,9 @@ extern char *msg_daemonname;
 extern char *msg_system;
 
 #ifndef PBS_MOM
-extern pbs_list_head task_list_event;
 extern pbs_list_head task_list_immed;
 extern char *resc_in_err;
+extern void job_save_db_flush(void);
 #endif	/* PBS_MOM */
 
 #ifndef WIN32
@@ -184,59 +185,81 @@ reply_alarm(int sig)
 
 /**
  * @brief
- * 		reply is to be sent to a remote client
+ * 		write a reply to a TCP connection, giving up after
+ *		PBS_DIS_TCP_TIMEOUT_REPLY seconds.  Also used to push replies
+ *		no request is waiting for, see req_subscribe.c.
  *
  * @param[in]	sfds - connection socket
- * @param[in]	preq - batch_request which contains the reply for the request
+ * @param[in]	preply - the reply
  *
  * @return	return code
+ * @retval	0	: success
+ * @retval	!0	: DIS error, or PBS_NET_RC_RETRY
  */
-static int
-dis_reply_write(int sfds, struct batch_request *preq)
+int
+reply_write_tcp(int sfds, struct batch_reply *preply)
 {
 	int rc;
-	struct batch_reply *preply = &preq->rq_reply;
 #ifndef WIN32
 	struct sigaction act, oact;
 	time_t  old_tcp_timeout = pbs_tcp_timeout ;
-#endif
 
-	if (preq->prot == PROT_TPP) {
-		rc = encode_DIS_replyTPP(sfds, preq->tppcmd_msgid, preply);
-	} else {
-#ifndef WIN32
-		reply_timedout = 0;
-		/* set alarm to interrupt poll() etc. while flushing out data */
-		sigemptyset(&act.sa_mask);
-		act.sa_flags = 0;
-		act.sa_handler = reply_alarm;
-		if (sigaction(SIGALRM, &act, &oact) == -1)
-			return (PBS_NET_RC_RETRY);
-		alarm(PBS_DIS_TCP_TIMEOUT_REPLY);
-		pbs_tcp_timeout = PBS_DIS_TCP_TIMEOUT_REPLY;
+	reply_timedout = 0;
+	/* set alarm to interrupt poll() etc. while flushing out data */
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = 0;
+	act.sa_handler = reply_alarm;
+	if (sigaction(SIGALRM, &act, &oact) == -1)
+		return (PBS_NET_RC_RETRY);
+	alarm(PBS_DIS_TCP_TIMEOUT_REPLY);
+	pbs_tcp_timeout = PBS_DIS_TCP_TIMEOUT_REPLY;
 #endif
-		/*
-		 * clear pbs_tcp_errno - set on error in dis_flush when called
-		 * either in encode_DIS_reply() or directly below.
-		 */
-		pbs_tcp_errno = 0;
-		DIS_tcp_funcs();		/* setup for DIS over tcp */
-
-		rc = encode_DIS_reply(sfds, preply);
-	}
-
-	if (rc == 0) {
+	/*
+	 * clear pbs_tcp_errno - set on error in dis_flush when called
+	 * either in encode_DIS_reply() or directly below.
+	 */
+	pbs_tcp_errno = 0;
+	DIS_tcp_funcs();		/* setup for DIS over tcp */
+
+	rc = encode_DIS_reply(sfds, preply);
+	if (rc == 0)
 		rc = dis_flush(sfds);
-	}
 
 #ifndef WIN32
 	reply_timedout = 0; /* Resetting the value for next tcp connection */
-	if (preq->prot == PROT_TCP) {
-		alarm(0);
-		(void)sigaction(SIGALRM, &oact, NULL);  /* reset handler for SIGALRM */
-	}
+	alarm(0);
+	(void)sigaction(SIGALRM, &oact, NULL);  /* reset handler for SIGALRM */
 	pbs_tcp_timeout = old_tcp_timeout;
 #endif
+	return rc;
+}
+
+/**
+ * @brief
+ * 		reply is to be sent to a remote client
+ *
+ * @param[in]	sfds - connection socket
+ * @param[in]	preq - batch_request which contains the reply for the request
+ *
+ * @return	return code
+ */
+static int
+dis_reply_write(int sfds, struct batch_request *preq)
+{
+	int rc;
+	struct batch_reply *preply = &preq->rq_reply;
+
+	if (preq->prot == PROT_TPP) {
+		rc = encode_DIS_replyTPP(sfds, preq->tppcmd_msgid, preply);
+		if (rc == 0)
+			rc = dis_flush(sfds);
+	} else {
+		preply->brp_tag = preq->rq_tag;
+		rc = reply_write_tcp(sfds, preply);
+		if (rc == PBS_NET_RC_RETRY)
+			return rc;
+	}
+
 	if (rc) {
 		char hn[PBS_MAXHOSTNAME+1];
 
@@ -300,13 +323,57 @@ reply_send(struct batch_request *request)
 	int		    sfds = request->rq_conn;		/* socket */
 
 	if (request && (request->rq_type == PBS_BATCH_ModifyJob_Async ||
-			request->rq_type == PBS_BATCH_AsyrunJob)) {
+			request->rq_type == PBS_BATCH_ModifyJobList_Async ||
+			request->rq_type == PBS_BATCH_AsyrunJob ||
+			request->rq_type == PBS_BATCH_RunSubjobs_Async)) {
 		free_br(request);
 		return 0;
 	}
 
 	request->rq_reply.brp_is_part = 0;
 
+#ifndef PBS_MOM
+	/*
+	 * whatever the request changed must be in the database before the
+	 * reply; a reply to ourselves is not seen by any client, so its saves
+	 * may wait to go out with the rest of the batch
+	 */
+	if (sfds != PBS_LOCAL_CONNECTION)
+		job_save_db_flush();
+#endif
+
+	/*
+	 * the reply goes into the list of another request, see
+	 * req_submitjoblist() and req_modifyjobs_sel(); the last reply a
+	 * collecting request holds a reference for sends it
+	 */
+	if (request->rq_collectbr) {
+		struct batch_deljob_status *pstat;
+		struct batch_request *pcollect = request->rq_collectbr;
+		struct batch_reply *preply = &pcollect->rq_reply;
+		char *name = "";
+
+		if (request->rq_type == PBS_BATCH_ModifyJob)
+			name = request->rq_ind.rq_modify.rq_objname;
+		else if (request->rq_reply.brp_choice == BATCH_REPLY_CHOICE_Commit)
+			name = request->rq_reply.brp_un.brp_jid;
+
+		pstat = malloc(sizeof(struct batch_deljob_status));
+		if (pstat == NULL || (pstat->name = strdup(name)) == NULL) {
+			log_err(errno, __func__, "Unable to allocate Memory!");
+			free(pstat);
+			rc = PBSE_SYSTEM;
+		} else {
+			pstat->code = request->rq_reply.brp_code;
+			pstat->next = preply->brp_un.brp_deletejoblist.brp_delstatc;
+			preply->brp_un.brp_deletejoblist.brp_delstatc = pstat;
+			preply->brp_count++;
+		}
+		free_br(request);
+		if ((pcollect->rq_refct > 0) && (--pcollect->rq_refct == 0))
+			(void)reply_send(pcollect);
+		return rc;
+	}
 
 	/* if this is a child request, just move the error to the parent */
 	if (request->rq_parentbr) {
@@ -342,16 +409,12 @@ reply_send(struct batch_request *request)
 		 * for freeing the batch_request structure.
 		 */
 
-		ptask = (struct work_task *)GET_NEXT(task_list_event);
-		while (ptask) {
-			if ((ptask->wt_type == WORK_Deferred_Local) &&
-				(ptask->wt_parm1 == (void *)request)) {
-				delete_link(&ptask->wt_linkall);
-				append_link(&task_list_immed,
-					&ptask->wt_linkall, ptask);
-				return (0);
-			}
-			ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
+		ptask = find_task_by_parm1((void *)request, WORK_Deferred_Local);
+		if (ptask) {
+			delete_link(&ptask->wt_linkall);
+			append_link(&task_list_immed,
+				&ptask->wt_linkall, ptask);
+			return (0);
 		}
 
 		/* Uh Oh, should have found a task and didn't */
@@ -365,6 +428,13 @@ reply_send(struct batch_request *request)
 		/*
 		 * Otherwise, the reply is to be sent to a remote client
 		 */
+#ifndef PBS_MOM
+		/* an earlier request of the scheduler still waits for its reply */
+		if (request->rq_held && GET_PRIOR(request->rq_heldlink) != NULL) {
+			request->rq_held = RQ_HELD_READY;
+			return (rc);
+		}
+#endif
 		if (rc == PBSE_NONE) {
 			rc = dis_reply_write(sfds, request);
 		}
@@ -390,7 +460,8 @@ reply_ack(struct batch_request *preq)
 	if (preq == NULL)
 		return;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_AsyrunJob) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_ModifyJobList_Async ||
+		preq->rq_type == PBS_BATCH_AsyrunJob || preq->rq_type == PBS_BATCH_RunSubjobs_Async) {
 		free_br(preq);
 		return;
 	}
@@ -413,6 +484,24 @@ reply_ack(struct batch_request *preq)
 	(void)reply_send(preq);
 }
 
+/**
+ * @brief
+ * 		Drop one reference to a shared encoded status attribute list,
+ * 		freeing it when the last holder lets go.
+ *
+ * @param[in]	penc	- encoded attribute list, may be NULL
+ */
+void
+release_brp_enc(struct brp_enc *penc)
+{
+	if (penc == NULL)
+		return;
+	if (--penc->be_refct > 0)
+		return;
+	free(penc->be_data);
+	free(penc);
+}
+
 /**
  * @brief
  * 		Free any sub-structures that might hang from the basic
@@ -450,6 +539,7 @@ reply_free(struct batch_reply *prep)
 		while (pstat) {
 			pstatx = (struct brp_status *)GET_NEXT(pstat->brp_stlink);
 			free_attrlist(&pstat->brp_attr);
+			release_brp_enc(pstat->brp_enc);
 			(void)free(pstat);
 			pstat = pstatx;
 		}
@@ -458,6 +548,7 @@ reply_free(struct batch_reply *prep)
 		pdelstat = prep->brp_un.brp_deletejoblist.brp_delstatc;
 		while (pdelstat) {
 			pdelstatx = pdelstat->next;
+			free(pdelstat->name);
 			free(pdelstat);
 			pdelstat = pdelstatx;
 	}
@@ -492,7 +583,8 @@ req_reject(int code, int aux, struct batch_request *preq)
 	if (preq == NULL)
 		return;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_AsyrunJob) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_ModifyJobList_Async ||
+		preq->rq_type == PBS_BATCH_AsyrunJob || preq->rq_type == PBS_BATCH_RunSubjobs_Async) {
 		free_br(preq);
 		return;
 	}
@@ -556,7 +648,7 @@ reply_badattr(int code, int aux, svrattrl *pal,
 	if (preq == NULL)
 		return;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_ModifyJobList_Async) {
 		free_br(preq);
 		return;
 	}
@@ -614,7 +706,7 @@ reply_text(struct batch_request *preq, int code, char *text)
 	if (preq == NULL)
 		return 0;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async || preq->rq_type == PBS_BATCH_ModifyJobList_Async) {
 		free_br(preq);
 		return 0;
 	}
@@ -54,6 +54,9 @@
 #include "log.h"
 #include "pbs_nodes.h"
 #include "server.h"
+#include "work_task.h"
+#include "net_connect.h"
+#include "tpp.h"
 
 #define	CRED_DATA_SIZE	4096
 
@@ -67,6 +70,7 @@ extern int relay_to_mom(job *, struct batch_request *, void (*)(struct work_task
 extern time_t time_now;
 pbs_list_head svr_creds_cache;	/* all credentials cached and available to send */
 extern long svr_cred_renew_cache_period;
+extern char *path_spool;
 
 struct cred_cache {
 	pbs_list_link cr_link;
@@ -78,39 +82,41 @@ struct cred_cache {
 };
 typedef struct cred_cache cred_cache;
 
+/* a run of SVR_ATR_cred_renew_tool in a child, shared by all jobs of a credid */
+struct cred_acquire {
+	pbs_list_link ca_link;
+	char ca_credid[PBS_MAXUSER + 1];
+	char ca_cmd[MAXPATHLEN + PBS_MAXUSER + 2]; /* +1 for space and +1 for EOL */
+	char ca_outfile[MAXPATHLEN + 1];	/* where the child writes the tool output */
+	char **ca_jobids;	/* jobs waiting for the credentials */
+	int ca_njobs;
+	int ca_size;
+};
+typedef struct cred_acquire cred_acquire;
+pbs_list_head svr_creds_acquiring;	/* renew tool runs in progress */
+
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 /* @brief
- *	First, this function checks whether the credentials for credid (e.g. principal) of the
- *	job are stored in server's memory cache and whether the credentials are
- *	not too old. Such credentials are returned. If they are not present
- *	in cache or are too old new credentials are requested with the
- *	SVR_ATR_cred_renew_tool and renewed credentials are stored in the cache
- *	(server's memory).
+ *	Look up the cached credentials of credid which are not too old. Too old
+ *	credentials met on the way are deleted from the cache.
  *
- * @param[in] pjob - pointer to job, the credentials are requested for this job
+ * @param[in] credid - cred id (e.g. principal)
  *
  * @return	cred_cache
- * @retval	structure with credentials on success
- * @retval	NULL otherwise
+ * @retval	cached credentials
+ * @retval	NULL if none are usable
  */
-static struct cred_cache *
-get_cached_cred(job  *pjob)
+static cred_cache *
+find_cached_cred(char *credid)
 {
-#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
 	cred_cache *cred = NULL;
 	cred_cache *nxcred = NULL;
-	char cmd[MAXPATHLEN + PBS_MAXUSER + 2]; /* +1 for space and +1 for EOL */
-	char buf[CRED_DATA_SIZE];
-	FILE *fp;
-	long validity = 0;
-	int cred_type = CRED_NONE;
-	int ret = 0;
 
-	/* try the cache first */
 	cred = (cred_cache *)GET_NEXT(svr_creds_cache);
 	while (cred) {
 		nxcred = (cred_cache *)GET_NEXT(cred->cr_link);
 
-		if (strcmp(cred->credid, get_jattr_str(pjob, JOB_ATR_cred_id)) == 0 &&
+		if (strcmp(cred->credid, credid) == 0 &&
 			cred->validity - svr_cred_renew_cache_period >  time_now) {
 			/* valid credential found */
 			return cred;
@@ -126,56 +132,92 @@ get_cached_cred(job  *pjob)
 		cred = nxcred;
 	}
 
-	/* valid credentials not cached, get new one */
+	return NULL;
+}
 
+/* @brief
+ *	Build the SVR_ATR_cred_renew_tool command acquiring credentials for credid.
+ *
+ * @param[in]  credid - cred id (e.g. principal)
+ * @param[out] cmd - buffer for the command
+ * @param[in]  len - size of cmd
+ *
+ * @return	int
+ * @retval	0 on success
+ * @retval	-1 if the tool is not set
+ */
+static int
+cred_tool_cmd(char *credid, char *cmd, size_t len)
+{
 	if ((server.sv_attr[(int)SVR_ATR_cred_renew_tool].at_flags & ATR_VFLAG_SET) == 0) {
 		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
 			LOG_ERR, msg_daemonname, "%s is not set", ATTR_cred_renew_tool);
-		return NULL;
+		return -1;
 	}
 
 	log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER,
 		LOG_DEBUG, msg_daemonname, "using %s '%s' to acquire credentials for user: %s",
 		ATTR_cred_renew_tool,
 		server.sv_attr[(int)SVR_ATR_cred_renew_tool].at_val.at_str,
-		get_jattr_str(pjob, JOB_ATR_cred_id));
+		credid);
 
-	snprintf(cmd, MAXPATHLEN + PBS_MAXUSER + 2, "%s %s", /* +1 for space and +1 for EOL */
+	snprintf(cmd, len, "%s %s",
 		server.sv_attr[(int)SVR_ATR_cred_renew_tool].at_val.at_str,
-		get_jattr_str(pjob, JOB_ATR_cred_id));
+		credid);
 
-	if ((fp = popen(cmd, "r")) == NULL) {
-		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
-			LOG_ERR, msg_daemonname, "%s failed to open pipe, command: '%s'",
-			ATTR_cred_renew_tool, cmd);
-		return NULL;
-	}
+	return 0;
+}
 
+/* @brief
+ *	Read the output of SVR_ATR_cred_renew_tool.
+ *
+ * @param[in]  fp - output of the tool
+ * @param[out] buf - the last line, i.e. the credential in base64
+ * @param[out] validity - end of validity of the credential
+ * @param[out] cred_type - type of the credential
+ *
+ */
+static void
+read_cred(FILE *fp, char *buf, long *validity, int *cred_type)
+{
+	buf[0] = '\0';
 	while (fgets(buf, CRED_DATA_SIZE, fp) != NULL) {
 		strtok(buf, "\n");
 		if (strncmp(buf, "Valid until:", strlen("Valid until:")) == 0)
-			validity = strtol(buf + strlen("Valid until:"), NULL, 10);
+			*validity = strtol(buf + strlen("Valid until:"), NULL, 10);
 
 		if (strncmp(buf, "Type: ", strlen("Type: ")) == 0) {
 			if (strncmp(buf + strlen("Type: "), "Kerberos", strlen("Kerberos")) == 0)
-				cred_type = CRED_KRB5;
+				*cred_type = CRED_KRB5;
 		}
 
 		/* last line in buf is credential in base64 - will be read later */
 	}
+}
 
-	if ((ret = pclose(fp))) {
-		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
-			LOG_ERR, msg_daemonname, "%s command '%s' failed, exitcode: %d",
-			ATTR_cred_renew_tool, cmd, WEXITSTATUS(ret));
-		return NULL;
-	}
+/* @brief
+ *	Check the credentials read from SVR_ATR_cred_renew_tool and store them
+ *	in the cache.
+ *
+ * @param[in] credid - cred id (e.g. principal)
+ * @param[in] cmd - the tool command, for logging
+ * @param[in] buf - the credential in base64
+ * @param[in] validity - end of validity of the credential
+ * @param[in] cred_type - type of the credential
+ *
+ * @return	cred_cache
+ * @retval	the cached credentials on success
+ * @retval	NULL otherwise
+ */
+static cred_cache *
+cache_cred(char *credid, char *cmd, char *buf, long validity, int cred_type)
+{
+	cred_cache *cred;
 
-	if (buf == NULL || strlen(buf) <= 1 || validity < time_now) {
+	if (strlen(buf) <= 1 || validity < time_now) {
 		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
 			LOG_ERR, msg_daemonname, "%s command '%s' returned invalid credentials for %s",
-			ATTR_cred_renew_tool, cmd,
-			get_jattr_str(pjob, JOB_ATR_cred_id));
+			ATTR_cred_renew_tool, cmd, credid);
 
 		return NULL;
 	}
@@ -185,7 +227,7 @@ get_cached_cred(job  *pjob)
 		return NULL;
 	}
 
-	strncpy(cred->credid, get_jattr_str(pjob, JOB_ATR_cred_id), PBS_MAXUSER);
+	strncpy(cred->credid, credid, PBS_MAXUSER);
 	cred->credid[PBS_MAXUSER] = '\0';
 	cred->type = cred_type;
 	cred->validity = validity;
@@ -204,6 +246,62 @@ get_cached_cred(job  *pjob)
 	CLEAR_LINK(cred->cr_link);
 	append_link(&svr_creds_cache, &cred->cr_link, cred);
 	return cred;
+}
+#endif
+
+/* @brief
+ *	First, this function checks whether the credentials for credid (e.g. principal) of the
+ *	job are stored in server's memory cache and whether the credentials are
+ *	not too old. Such credentials are returned. If they are not present
+ *	in cache or are too old new credentials are requested with the
+ *	SVR_ATR_cred_renew_tool and renewed credentials are stored in the cache
+ *	(server's memory).
+ *
+ * @param[in] pjob - pointer to job, the credentials are requested for this job
+ *
+ * @return	cred_cache
+ * @retval	structure with credentials on success
+ * @retval	NULL otherwise
+ */
+static struct cred_cache *
+get_cached_cred(job  *pjob)
+{
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
+	cred_cache *cred = NULL;
+	char *credid = get_jattr_str(pjob, JOB_ATR_cred_id);
+	char cmd[MAXPATHLEN + PBS_MAXUSER + 2]; /* +1 for space and +1 for EOL */
+	char buf[CRED_DATA_SIZE];
+	FILE *fp;
+	long validity = 0;
+	int cred_type = CRED_NONE;
+	int ret = 0;
+
+	/* try the cache first */
+	if ((cred = find_cached_cred(credid)) != NULL)
+		return cred;
+
+	/* valid credentials not cached, get new one */
+
+	if (cred_tool_cmd(credid, cmd, sizeof(cmd)) != 0)
+		return NULL;
+
+	if ((fp = popen(cmd, "r")) == NULL) {
+		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+			LOG_ERR, msg_daemonname, "%s failed to open pipe, command: '%s'",
+			ATTR_cred_renew_tool, cmd);
+		return NULL;
+	}
+
+	read_cred(fp, buf, &validity, &cred_type);
+
+	if ((ret = pclose(fp))) {
+		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+			LOG_ERR, msg_daemonname, "%s command '%s' failed, exitcode: %d",
+			ATTR_cred_renew_tool, cmd, WEXITSTATUS(ret));
+		return NULL;
+	}
+
+	return cache_cred(credid, cmd, buf, validity, cred_type);
 #else
 	return NULL;
 #endif
@@ -215,15 +313,14 @@ get_cached_cred(job  *pjob)
  *
  * @param[in] preq - batch request
  * @param[in] pjob - pointer to job
+ * @param[in] cred - credentials to send, NULL to get them by get_cached_cred()
  *
  * @return	preq
  * @retval	structure with batch request
  */
 static struct batch_request *
-setup_cred(struct batch_request *preq, job  *pjob)
+setup_cred(struct batch_request *preq, job  *pjob, cred_cache *cred)
 {
-	cred_cache *cred;
-
 	if (preq == NULL) {
 		preq = alloc_br(PBS_BATCH_Cred);
 
@@ -234,7 +331,7 @@ setup_cred(struct batch_request *preq, job  *pjob)
 
 	preq->rq_ind.rq_cred.rq_cred_data = NULL;
 
-	if ((cred = get_cached_cred(pjob)) == NULL){
+	if (cred == NULL && (cred = get_cached_cred(pjob)) == NULL) {
 		free_br(preq);
 		return NULL;
 	}
@@ -294,26 +391,22 @@ post_cred(struct work_task *pwt)
 }
 
 /* @brief
- *	Retrieve and send credentials for a particular job to the superior
- *	mom of the job.
+ *	Send credentials to the superior mom of a job.
  *
  * @param[in] pjob - pointer to job
+ * @param[in] cred - credentials to send, NULL to get them by get_cached_cred()
  *
  * @return	int
  * @retval	0 on success
  * @retval	!= 0 on error
  */
-int
-send_cred(job *pjob)
+static int
+relay_cred(job *pjob, cred_cache *cred)
 {
 	struct batch_request *credreq = NULL;
 	int rc;
 
-	if (pjob == NULL) {
-	    return PBSE_SYSTEM;
-	}
-
-	credreq = setup_cred(credreq, pjob);
+	credreq = setup_cred(credreq, pjob, cred);
 	if (credreq) {
 		rc = relay_to_mom(pjob, credreq, post_cred);
 		if (rc == PBSE_NORELYMOM) /* otherwise the post_cred will free the request */
@@ -323,3 +416,221 @@ send_cred(job *pjob)
 
 	return PBSE_IVALREQ;
 }
+
+/* @brief
+ *	Retrieve and send credentials for a particular job to the superior
+ *	mom of the job.
+ *
+ * @param[in] pjob - pointer to job
+ *
+ * @return	int
+ * @retval	0 on success
+ * @retval	!= 0 on error
+ */
+int
+send_cred(job *pjob)
+{
+	if (pjob == NULL) {
+	    return PBSE_SYSTEM;
+	}
+
+	return relay_cred(pjob, NULL);
+}
+
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
+/* @brief
+ *	Free an acquisition of credentials and the job ids waiting on it.
+ *
+ * @param[in] acq - the acquisition
+ *
+ */
+static void
+free_cred_acquire(cred_acquire *acq)
+{
+	int i;
+
+	for (i = 0; i < acq->ca_njobs; i++)
+		free(acq->ca_jobids[i]);
+	free(acq->ca_jobids);
+	delete_link(&acq->ca_link);
+	free(acq);
+}
+
+/* @brief
+ *	Deferred child work task run when SVR_ATR_cred_renew_tool started by
+ *	start_cred_acquire() exits. The credentials it wrote are cached and sent
+ *	to the superior moms of all the jobs which waited for them.
+ *
+ * @param[in] pwt - work task structure, wt_parm1 is the acquisition
+ *
+ */
+static void
+post_cred_acquire(struct work_task *pwt)
+{
+	cred_acquire *acq = (cred_acquire *)pwt->wt_parm1;
+	cred_cache *cred = NULL;
+	char buf[CRED_DATA_SIZE];
+	long validity = 0;
+	int cred_type = CRED_NONE;
+	FILE *fp;
+	job *pjob;
+	int rc;
+	int i;
+
+	if (pwt->wt_aux != 0) {
+		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
+			LOG_ERR, msg_daemonname, "%s command '%s' failed, exitcode: %d",
+			ATTR_cred_renew_tool, acq->ca_cmd, WEXITSTATUS(pwt->wt_aux));
+	} else if ((fp = fopen(acq->ca_outfile, "r")) == NULL) {
+		log_err(errno, __func__, acq->ca_outfile);
+	} else {
+		read_cred(fp, buf, &validity, &cred_type);
+		fclose(fp);
+		cred = cache_cred(acq->ca_credid, acq->ca_cmd, buf, validity, cred_type);
+	}
+	(void)unlink(acq->ca_outfile);
+
+	for (i = 0; cred != NULL && i < acq->ca_njobs; i++) {
+		if ((pjob = find_job(acq->ca_jobids[i])) == NULL ||
+			!check_job_state(pjob, JOB_STATE_LTR_RUNNING) ||
+			!is_jattr_set(pjob, JOB_ATR_cred_id) ||
+			strcmp(get_jattr_str(pjob, JOB_ATR_cred_id), acq->ca_credid) != 0)
+			continue;
+
+		if ((rc = relay_cred(pjob, cred)) != 0)
+			log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB,
+				LOG_NOTICE, pjob->ji_qs.ji_jobid,
+				"renewed credential not sent, returned: %d", rc);
+	}
+
+	free_cred_acquire(acq);
+}
+
+/* @brief
+ *	Start SVR_ATR_cred_renew_tool for credid in a child process, its output
+ *	going to a file in the spool directory. post_cred_acquire() picks the
+ *	output up once the child exits.
+ *
+ * @param[in] credid - cred id (e.g. principal)
+ *
+ * @return	cred_acquire
+ * @retval	the acquisition in progress
+ * @retval	NULL on error
+ */
+static cred_acquire *
+start_cred_acquire(char *credid)
+{
+	cred_acquire *acq;
+	int fd;
+	pid_t pid;
+
+	if ((acq = (cred_acquire *)calloc(1, sizeof(cred_acquire))) == NULL) {
+		log_err(errno, __func__, "Unable to allocate Memory!\n");
+		return NULL;
+	}
+	CLEAR_LINK(acq->ca_link);
+	strncpy(acq->ca_credid, credid, PBS_MAXUSER);
+
+	if (cred_tool_cmd(credid, acq->ca_cmd, sizeof(acq->ca_cmd)) != 0) {
+		free(acq);
+		return NULL;
+	}
+
+	snprintf(acq->ca_outfile, sizeof(acq->ca_outfile), "%scred.XXXXXX", path_spool);
+	if ((fd = mkstemp(acq->ca_outfile)) == -1) {
+		log_err(errno, __func__, acq->ca_outfile);
+		free(acq);
+		return NULL;
+	}
+
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork failed");
+		close(fd);
+		(void)unlink(acq->ca_outfile);
+		free(acq);
+		return NULL;
+	}
+
+	if (pid == 0) {
+		/* the child runs the tool with its output in the file */
+		net_close(-1);
+		tpp_terminate();
+		daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+		if (dup2(fd, STDOUT_FILENO) == -1)
+			exit(1);
+		close(fd);
+		execl("/bin/sh", "sh", "-c", acq->ca_cmd, (char *)NULL);
+		exit(127);
+	}
+
+	close(fd);
+	if (set_task(WORK_Deferred_Child, (long)pid, post_cred_acquire, acq) == NULL) {
+		log_err(errno, __func__, "Unable to set task for credential acquisition");
+		(void)unlink(acq->ca_outfile);
+		free(acq);
+		return NULL;
+	}
+	append_link(&svr_creds_acquiring, &acq->ca_link, acq);
+
+	return acq;
+}
+#endif
+
+/* @brief
+ *	Renew the credentials of a running job without blocking the server.
+ *	Cached credentials are sent to the superior mom at once. Otherwise
+ *	the job waits for SVR_ATR_cred_renew_tool, which is run once for all
+ *	the jobs of the same credid whose credentials are being renewed.
+ *
+ * @param[in] pjob - pointer to job
+ *
+ * @return	int
+ * @retval	0 on success, the credentials are sent or will be
+ * @retval	!= 0 on error
+ */
+int
+renew_cred(job *pjob)
+{
+#if defined(PBS_SECURITY) && (PBS_SECURITY == KRB5)
+	char *credid;
+	cred_cache *cred;
+	cred_acquire *acq;
+	char **tmp;
+
+	if (pjob == NULL || !is_jattr_set(pjob, JOB_ATR_cred_id))
+		return PBSE_IVALREQ;
+
+	credid = get_jattr_str(pjob, JOB_ATR_cred_id);
+	if ((cred = find_cached_cred(credid)) != NULL)
+		return relay_cred(pjob, cred);
+
+	for (acq = (cred_acquire *)GET_NEXT(svr_creds_acquiring); acq != NULL;
+		acq = (cred_acquire *)GET_NEXT(acq->ca_link)) {
+		if (strcmp(acq->ca_credid, credid) == 0)
+			break;
+	}
+	if (acq == NULL && (acq = start_cred_acquire(credid)) == NULL)
+		return PBSE_SYSTEM;
+
+	if (acq->ca_njobs == acq->ca_size) {
+		int size = acq->ca_size ? acq->ca_size * 2 : 8;
+
+		if ((tmp = (char **)realloc(acq->ca_jobids, size * sizeof(char *))) == NULL) {
+			log_err(errno, __func__, "Unable to allocate Memory!\n");
+			return PBSE_SYSTEM;
+		}
+		acq->ca_jobids = tmp;
+		acq->ca_size = size;
+	}
+	if ((acq->ca_jobids[acq->ca_njobs] = strdup(pjob->ji_qs.ji_jobid)) == NULL) {
+		log_err(errno, __func__, "Unable to allocate Memory!\n");
+		return PBSE_SYSTEM;
+	}
+	acq->ca_njobs++;
+
+	return PBSE_NONE;
+#else
+	return send_cred(pjob);
+#endif
+}
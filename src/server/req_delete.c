@@ -48,6 +48,7 @@
  *	check_deletehistoryjob()
  *	issue_delete()
  *	req_deletejob()
+ *	serve_deferred_deletes()
  *	req_deletejob2()
  *	req_deleteReservation()
  *	post_delete_route()
@@ -58,6 +59,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 #include "portability.h"
 #include "libpbs.h"
@@ -118,6 +120,12 @@ static char *sigtj =  SIG_TermJob;
 static char *acct_fmt = "requestor=%s@%s";
 static int qdel_mail = 1; /* true: sending mail */
 
+/* DeleteJobList requests waiting for their next slice, see req_deletejob() */
+static pbs_list_head svr_deferred_deletes = {&svr_deferred_deletes, &svr_deferred_deletes, NULL};
+
+#define DELJOB_SLICE_USEC	100000	/* time one slice of a job list may take */
+#define DELJOB_SLICE_CHECK	32	/* jobs deleted between looks at the clock */
+
 
 /**
  * @brief
@@ -258,7 +266,7 @@ check_deletehistoryjob(struct batch_request * preq, char * jid)
 					char *sjid = mk_subjob_id(histpjob, i);
 					job  *psjob;
 
-					if ((psjob = histpjob->ji_ajtrk->tkm_tbl[i].trk_psubjob)) {
+					if ((psjob = get_subjob_ptr(histpjob, i))) {
 						snprintf(log_buffer, sizeof(log_buffer),
 							msg_job_history_delete, preq->rq_user,
 							preq->rq_host);
@@ -365,12 +373,62 @@ int update_deletejob_stat(char *jid, struct batch_request *preq, int errcode)
 	return 0;
 }
 
+/**
+ * @brief
+ *		Has the current slice of a DeleteJobList request used up its time?
+ *
+ * @param[in]	pstart	- when the slice started
+ *
+ * @return	int
+ * @retval	1	- yes, leave the rest for the next pass of the main loop
+ * @retval	0	- no
+ */
+static int
+deljob_slice_over(struct timeval *pstart)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (((now.tv_sec - pstart->tv_sec) * 1000000L +
+		(now.tv_usec - pstart->tv_usec)) >= DELJOB_SLICE_USEC);
+}
+
+/**
+ * @brief
+ *		Delete the next slice of jobs of the oldest DeleteJobList request
+ *		that did not fit in one slice, see req_deletejob().  Called once
+ *		per pass of the server main loop, so the other requests and the
+ *		MoMs are served in between.
+ *
+ * @return	int
+ * @retval	1	- more requests are waiting for a slice
+ * @retval	0	- none left
+ */
+int
+serve_deferred_deletes(void)
+{
+	struct batch_request *preq;
+
+	if ((preq = (struct batch_request *)GET_NEXT(svr_deferred_deletes)) != NULL) {
+		delete_link(&preq->rq_readlink);
+		req_deletejob(preq);
+	}
+	return (GET_NEXT(svr_deferred_deletes) != NULL);
+}
+
 /**
  * @brief
  * 		req_deletejob - service the Delete Job Request
  *
  *		This request deletes a job.
  *
+ * @par
+ *		The jobs of a DeleteJobList request are deleted in slices of
+ *		about DELJOB_SLICE_USEC.  When a slice runs out the request is
+ *		put aside and served again from serve_deferred_deletes(), so a
+ *		qdel of many thousand jobs does not hold up the server.  The
+ *		reply goes out once the last job is done, as before.
+ *
  * @param[in]	preq	- Job Request
  */
 
@@ -393,23 +451,31 @@ req_deletejob(struct batch_request *preq)
 	char **jobids;
 	int count;
 	int j;
+	int start = 0;
+	struct timeval slice_start;
 	struct batch_reply *preply = &preq->rq_reply;
-	preply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
-	preply->brp_count = 0;
 
 	if (preq->rq_type == PBS_BATCH_DeleteJobList) {
-		preply->brp_choice = BATCH_REPLY_CHOICE_Delete;
 		jobids = preq->rq_ind.rq_deletejoblist.rq_jobslist;
 		count = preq->rq_ind.rq_deletejoblist.rq_count;
+		start = preq->rq_ind.rq_deletejoblist.rq_next;
 	} else {
 		jobids = break_comma_list(preq->rq_ind.rq_delete.rq_objname);
 		count = 1;
 	}
-	
-	preply->brp_un.brp_deletejoblist.tot_jobs = count;
-	preply->brp_un.brp_deletejoblist.tot_arr_jobs = 0;
-	preply->brp_un.brp_deletejoblist.tot_rpys = 0;
-	
+
+	/* a request resumed by serve_deferred_deletes() keeps its reply so far */
+	if (start == 0) {
+		preply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
+		preply->brp_count = 0;
+		if (preq->rq_type == PBS_BATCH_DeleteJobList)
+			preply->brp_choice = BATCH_REPLY_CHOICE_Delete;
+		preply->brp_un.brp_deletejoblist.tot_jobs = count;
+		preply->brp_un.brp_deletejoblist.tot_arr_jobs = 0;
+		preply->brp_un.brp_deletejoblist.tot_rpys = 0;
+	}
+	gettimeofday(&slice_start, NULL);
+
 	if (preq->rq_extend && strstr(preq->rq_extend, DELETEHISTORY))
 		delhist = 1;
 	if (preq->rq_extend && strstr(preq->rq_extend, FORCE))
@@ -422,7 +488,15 @@ req_deletejob(struct batch_request *preq)
 	else
 		qdel_mail = 1;
 
-	for (j = 0; j < count; j++) {	
+	for (j = start; j < count; j++) {
+		/* leave the rest of a long list for the next pass of the main loop */
+		if ((j > start) && ((j - start) % DELJOB_SLICE_CHECK == 0) &&
+			deljob_slice_over(&slice_start)) {
+			preq->rq_ind.rq_deletejoblist.rq_next = j;
+			append_link(&svr_deferred_deletes, &preq->rq_readlink, preq);
+			return;
+		}
+
 		snprintf(jid, sizeof(jid), "%s", jobids[j]);
 		parent = chk_job_request(jid, preq, &jt, &err);
 		if (parent == NULL) {
@@ -499,7 +573,7 @@ req_deletejob(struct batch_request *preq)
 					return;
 				} else
 					continue;
-			} else if ((pjob = parent->ji_ajtrk->tkm_tbl[offset].trk_psubjob)) {
+			} else if ((pjob = get_subjob_ptr(parent, offset))) {
 				/*
 				 * If the request is to also purge the history of the sub job then set ji_deletehistory to 1
 				 */
@@ -508,7 +582,7 @@ req_deletejob(struct batch_request *preq)
 				req_deletejob2(preq, pjob);
 			} else {
 				acct_del_write(jid, parent, preq, 0);
-				parent->ji_ajtrk->tkm_tbl[offset].trk_substate = JOB_SUBSTATE_TERMINATED;
+				set_subjob_substate(parent, offset, JOB_SUBSTATE_TERMINATED);
 				set_subjob_tblstate(parent, offset, JOB_STATE_LTR_EXPIRED);
 				parent->ji_ajtrk->tkm_dsubjsct++;
 
@@ -542,7 +616,7 @@ req_deletejob(struct batch_request *preq)
 				sjst = get_subjob_state(parent, i);
 				if ((sjst == JOB_STATE_LTR_EXITING) && !forcedel)
 					continue;
-				if ((pjob = parent->ji_ajtrk->tkm_tbl[i].trk_psubjob)) {
+				if ((pjob = get_subjob_ptr(parent, i))) {
 					if (delhist)
 						pjob->ji_deletehistory = 1;
 					if (check_job_state(pjob, JOB_STATE_LTR_EXPIRED)) {
@@ -560,7 +634,7 @@ req_deletejob(struct batch_request *preq)
 				} else {
 					/* Queued, Waiting, Held, just set to expired */
 					if (sjst != JOB_STATE_LTR_EXPIRED) {
-						parent->ji_ajtrk->tkm_tbl[i].trk_substate = JOB_SUBSTATE_TERMINATED;
+						set_subjob_substate(parent, i, JOB_SUBSTATE_TERMINATED);
 						set_subjob_tblstate(parent, i, JOB_STATE_LTR_EXPIRED);
 						decr_single_subjob_usage(parent);
 					}
@@ -641,7 +715,7 @@ req_deletejob(struct batch_request *preq)
 				if ((sjst == JOB_STATE_LTR_EXITING) && !forcedel)
 					continue;
 
-				if ((pjob = parent->ji_ajtrk->tkm_tbl[idx].trk_psubjob)) {
+				if ((pjob = get_subjob_ptr(parent, idx))) {
 					if (delhist)
 						pjob->ji_deletehistory = 1;
 					if (check_job_state(pjob, JOB_STATE_LTR_EXPIRED)) {
@@ -652,7 +726,7 @@ req_deletejob(struct batch_request *preq)
 				} else {
 					/* Queued, Waiting, Held, just set to expired */
 					if (sjst != JOB_STATE_LTR_EXPIRED) {
-						parent->ji_ajtrk->tkm_tbl[idx].trk_substate = JOB_SUBSTATE_TERMINATED;
+						set_subjob_substate(parent, idx, JOB_SUBSTATE_TERMINATED);
 						set_subjob_tblstate(parent, idx, JOB_STATE_LTR_EXPIRED);
 						decr_single_subjob_usage(parent);
 					}
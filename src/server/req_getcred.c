@@ -81,5 +81,6 @@ req_connect(struct batch_request *preq)
 			conn->cn_authen |= PBS_NET_CONN_FROM_QSUB_DAEMON;
 	}
 
-	reply_ack(preq);
+	/* let the client know it can send PBS_BATCH_SubmitJob, older ones ignore the text */
+	reply_text(preq, 0, CONNECT_REPLY_SUBMITJOB);
 }
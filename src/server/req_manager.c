@@ -1411,6 +1411,7 @@ mgr_server_set(struct batch_request *preq, conn_t *conn)
 		reply_badattr(rc, bad_attr, plist, preq);
 	else {
 		svr_save_db(&server);
+		route_changed();
 done:
 		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname, msg_manager, msg_man_set, preq->rq_user, preq->rq_host);
 		mgr_log_attr(msg_man_set, plist, PBS_EVENTCLASS_SERVER, msg_daemonname, NULL);
@@ -1593,6 +1594,7 @@ mgr_server_unset(struct batch_request *preq, conn_t *conn)
 					    &svr_attr_def[(int) SVR_ATR_scheduling], "TRUE", NULL, SET);
 		}
 		svr_save_db(&server);
+		route_changed();
 		log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, LOG_INFO,
 			msg_daemonname, msg_manager, msg_man_uns,
 			preq->rq_user, preq->rq_host);
@@ -1819,6 +1821,7 @@ mgr_queue_set(struct batch_request *preq)
 				return;
 			} else {
 				que_save_db(pque);
+				route_changed();
 				mgr_log_attr(msg_man_set, plist, PBS_EVENTCLASS_QUEUE, pque->qu_qs.qu_name, NULL);
 			}
 		}
@@ -1907,6 +1910,7 @@ mgr_queue_unset(struct batch_request *preq)
 				(void)deflt_chunk_action(&pque->qu_attr[QE_ATR_DefaultChunk], (void *)pque, ATR_ACTION_ALTER);
 			}
 			que_save_db(pque);
+			route_changed();
 			mgr_log_attr(msg_man_uns, plist, PBS_EVENTCLASS_QUEUE, pque->qu_qs.qu_name, NULL);
 			if ((pque->qu_attr[(int)QA_ATR_QType].at_flags &
 				ATR_VFLAG_SET) == 0)
@@ -1920,12 +1924,131 @@ mgr_queue_unset(struct batch_request *preq)
 	reply_ack(preq);
 }
 
+/**
+ * @brief
+ *		Find the vnodes named by a bulk set/unset node request.  The object
+ *		name is either a comma separated list of vnode names, all of which
+ *		must exist, or a selector of the form "attribute=value", which picks
+ *		every vnode whose attribute (or resources_available.<resource>)
+ *		is set to that value.  Neither ',' nor '=' is legal in a vnode name.
+ *
+ * @param[in]	objname	- the object name of the request
+ * @param[out]	pnodes	- malloc-ed array of the vnodes found
+ * @param[out]	pcount	- number of entries in *pnodes
+ *
+ * @return	int
+ * @retval	0	: success, *pcount may be zero for a selector
+ * @retval	PBSE_*	: error code
+ *
+ * @par MT-safe: No
+ */
+static int
+select_vnodes(char *objname, struct pbsnode ***pnodes, int *pcount)
+{
+	struct pbsnode **nodes;
+	struct pbsnode *np;
+	char *copy;
+	char *name;
+	char *value;
+	char *rescn;
+	char *save = NULL;
+	attribute sel;
+	attribute_def *pdef;
+	resource_def *prdef = NULL;
+	resource *pr;
+	int index;
+	int max;
+	int n = 0;
+	int i;
+	int rc = 0;
+
+	*pnodes = NULL;
+	*pcount = 0;
+
+	if ((copy = strdup(objname)) == NULL)
+		return PBSE_SYSTEM;
+
+	if ((value = strchr(copy, '=')) == NULL) {
+		for (max = 1, name = copy; *name; name++)
+			if (*name == ',')
+				max++;
+		if ((nodes = malloc(max * sizeof(struct pbsnode *))) == NULL) {
+			free(copy);
+			return PBSE_SYSTEM;
+		}
+		for (name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)) {
+			if ((np = find_nodebyname(name)) == NULL) {
+				free(nodes);
+				free(copy);
+				return PBSE_UNKNODE;
+			}
+			nodes[n++] = np;
+		}
+		free(copy);
+		*pnodes = nodes;
+		*pcount = n;
+		return 0;
+	}
+
+	*value++ = '\0';
+	if ((rescn = strchr(copy, '.')) != NULL)
+		*rescn++ = '\0';
+
+	index = find_attr(node_attr_idx, node_attr_def, copy);
+	/* attributes such as state have no comparison function to match with */
+	if ((index < 0) || (node_attr_def[index].at_comp == comp_null)) {
+		free(copy);
+		return PBSE_NOATTR;
+	}
+	pdef = &node_attr_def[index];
+	if (rescn != NULL) {
+		if ((pdef->at_type != ATR_TYPE_RESC) ||
+			((prdef = find_resc_def(svr_resc_def, rescn)) == NULL)) {
+			free(copy);
+			return PBSE_UNKRESC;
+		}
+	}
+
+	clear_attr(&sel, pdef);
+	if (pdef->at_decode(&sel, copy, rescn, value) != 0) {
+		pdef->at_free(&sel);
+		free(copy);
+		return PBSE_BADATVAL;
+	}
+
+	if ((nodes = malloc((svr_totnodes + 1) * sizeof(struct pbsnode *))) == NULL)
+		rc = PBSE_SYSTEM;
+	for (i = 0; nodes != NULL && i < svr_totnodes; i++) {
+		np = pbsndlist[i];
+		if (np->nd_state & INUSE_DELETED)
+			continue;
+		if (prdef != NULL) {
+			pr = find_resc_entry(&np->nd_attr[index], prdef);
+			if ((pr == NULL) || !is_attr_set(&pr->rs_value) ||
+				(prdef->rs_comp(&pr->rs_value, &find_resc_entry(&sel, prdef)->rs_value) != 0))
+				continue;
+		} else if (!is_attr_set(&np->nd_attr[index]) ||
+			(pdef->at_comp(&np->nd_attr[index], &sel) != 0))
+			continue;
+		nodes[n++] = np;
+	}
+
+	pdef->at_free(&sel);
+	free(copy);
+	*pnodes = nodes;
+	*pcount = n;
+	return rc;
+}
+
 /**
  * @brief
  *		Set vnode attributes
  *
- * 		Finds the set of vnodes, either one specified, all for a host or all.
- * 		Sets the request attributes on that set.
+ * 		Finds the set of vnodes, either one specified, a list or selector
+ * 		(see select_vnodes()), all for a host or all.
+ * 		Sets the request attributes on that set.  A list or selector is
+ * 		saved to the database as a single transaction covering just those
+ * 		vnodes.
  * 		returns a reply to the sender of the batch_request
  *
  * 		Note the use of the ':' to indicate a port number as part of a host name
@@ -1962,6 +2085,7 @@ mgr_node_set(struct batch_request *preq)
 	struct pbsnode **warn_nodes = NULL;
 	int warn_idx = 0;
 	int replied = 0; /* boolean */
+	struct pbsnode **sel_nodes = NULL; /* vnodes of a bulk request */
 
 	nodename = preq->rq_ind.rq_manager.rq_objname;
 
@@ -2012,12 +2136,21 @@ mgr_node_set(struct batch_request *preq)
 			req_reject(PBSE_UNKNODE, 0, preq);
 			return;
 		}
+	} else if (strpbrk(nodename, ",=") != NULL) {
+		/* a list of vnodes or an attribute selector */
+		if ((rc = select_vnodes(nodename, &sel_nodes, &numnodes)) != 0) {
+			free(sel_nodes);
+			req_reject(rc, 0, preq);
+			return;
+		}
+		pnode = (numnodes > 0) ? sel_nodes[0] : NULL;
 	} else {
 		/* Else one and only one vnode */
 		pnode = find_nodebyname(nodename);
 	}
 
 	if (pnode == NULL) {
+		free(sel_nodes);
 		req_reject(PBSE_UNKNODE, 0, preq);
 		return;
 	}
@@ -2044,6 +2177,7 @@ mgr_node_set(struct batch_request *preq)
 		problem_nodes = (struct pbsnode **)malloc(numnodes * sizeof(struct pbsnode *));
 		if (problem_nodes == NULL) {
 			log_err(ENOMEM, __func__, "out of memory");
+			free(sel_nodes);
 			return;
 		}
 		problem_cnt = 0;
@@ -2054,6 +2188,7 @@ mgr_node_set(struct batch_request *preq)
 	if (warn_nodes == NULL) {
 		log_err(ENOMEM, __func__, "out of memory");
 		free(problem_nodes);
+		free(sel_nodes);
 		return;
 	}
 	warnings_update(WARN_ngrp_init, warn_nodes, &warn_idx, pnode);
@@ -2076,7 +2211,7 @@ mgr_node_set(struct batch_request *preq)
 					if (numnodes > 1) {
 						if (problem_nodes) {
 							/*we have an array in which to save*/
-							if (problem_nodes[problem_cnt - 1] != pnode) {
+							if ((problem_cnt == 0) || (problem_nodes[problem_cnt - 1] != pnode)) {
 								/* and this node was not saved already */
 								problem_nodes[ problem_cnt ] = pnode;
 								++problem_cnt;
@@ -2113,6 +2248,7 @@ mgr_node_set(struct batch_request *preq)
 								req_reject(rc, 0, preq);
 						}
 						free(warn_nodes);
+						free(sel_nodes);
 						free_attrlist(&unsetlist);
 						free_attrlist(&setlist);
 						return;
@@ -2158,6 +2294,10 @@ mgr_node_set(struct batch_request *preq)
 			if (update_mom_only) {
 				break;	/* all done */
 			}
+		} else if (sel_nodes != NULL) {
+			if (++i == numnodes)
+				break;	/* all done */
+			pnode = sel_nodes[i];	/* next selected vnode */
 		} else {
 			if (++i == svr_totnodes)
 				break;	/* all done */
@@ -2170,7 +2310,10 @@ mgr_node_set(struct batch_request *preq)
 
 	warnmsg = warn_msg_build(WARN_ngrp, warn_nodes, warn_idx);
 
-	save_nodes_db(0, NULL);
+	if (sel_nodes != NULL)
+		save_nodes_db_list(sel_nodes, numnodes);
+	else
+		save_nodes_db(0, NULL);
 
 	if (numnodes > 1) {          /*modification was for multiple vnodes  */
 
@@ -2218,6 +2361,7 @@ mgr_node_set(struct batch_request *preq)
 
 	free(problem_nodes);
 	free(warn_nodes);
+	free(sel_nodes);
 
 }
 
@@ -2226,7 +2370,8 @@ mgr_node_set(struct batch_request *preq)
  * @brief
  *		Unset node attributes
  *
- * 		Finds the node, unsets the attributes and
+ * 		Finds the node (or the vnodes of a list or selector, see
+ * 		select_vnodes()), unsets the attributes and
  * 		returns a reply to the sender of the batch_request
  *
  * @note
@@ -2261,6 +2406,7 @@ mgr_node_unset(struct batch_request *preq)
 	struct pbsnode  **warn_nodes = NULL;
 	int		warn_idx = 0;
 	int		replied = 0;	/* boolean */
+	struct pbsnode  **sel_nodes = NULL;	/* vnodes of a bulk request */
 	attribute	 *patr;
 	resource_def	 *prd;
 	resource	 *prc;
@@ -2313,11 +2459,20 @@ mgr_node_unset(struct batch_request *preq)
 			pnode = NULL;
 		}
 
+	} else if (strpbrk(nodename, ",=") != NULL) {
+		/* a list of vnodes or an attribute selector */
+		if ((rc = select_vnodes(nodename, &sel_nodes, &numnodes)) != 0) {
+			free(sel_nodes);
+			req_reject(rc, 0, preq);
+			return;
+		}
+		pnode = (numnodes > 0) ? sel_nodes[0] : NULL;
 	} else {
 		pnode = find_nodebyname(nodename);
 	}
 
 	if (pnode == NULL) {
+		free(sel_nodes);
 		req_reject(PBSE_UNKNODE, 0, preq);
 		return;
 	}
@@ -2337,6 +2492,7 @@ mgr_node_unset(struct batch_request *preq)
 			((plist->al_resc == NULL) ||
 			(strcasecmp(plist->al_resc, "host") == 0)))) {
 			reply_badattr(PBSE_BADNDATVAL, bad, plist, preq);
+			free(sel_nodes);
 			return;
 		}
 
@@ -2358,6 +2514,7 @@ mgr_node_unset(struct batch_request *preq)
 		problem_nodes = (struct pbsnode **)malloc(numnodes * sizeof(struct pbsnode *));
 		if (problem_nodes == NULL) {
 			log_err(ENOMEM, __func__, "out of memory");
+			free(sel_nodes);
 			return;
 		}
 		problem_cnt = 0;
@@ -2368,6 +2525,7 @@ mgr_node_unset(struct batch_request *preq)
 	if (warn_nodes == NULL) {
 		log_err(ENOMEM, __func__, "out of memory");
 		free(problem_nodes);
+		free(sel_nodes);
 		return;
 	}
 	warnings_update(WARN_ngrp_init, warn_nodes, &warn_idx, pnode);
@@ -2415,6 +2573,7 @@ mgr_node_unset(struct batch_request *preq)
 							req_reject(rc, 0, preq);
 					}
 					free(warn_nodes);
+					free(sel_nodes);
 					return;
 				}
 
@@ -2466,6 +2625,10 @@ mgr_node_unset(struct batch_request *preq)
 			if (++momidx >= psvrmom->msr_numvnds)
 				break;
 			pnode = psvrmom->msr_children[momidx];
+		} else if (sel_nodes != NULL) {
+			if (++i == numnodes)
+				break;
+			pnode = sel_nodes[i];
 		} else {
 			if (++i == svr_totnodes)
 				break;
@@ -2475,7 +2638,10 @@ mgr_node_unset(struct batch_request *preq)
 
 	warnmsg = warn_msg_build(WARN_ngrp, warn_nodes, warn_idx);
 
-	save_nodes_db(0, NULL);
+	if (sel_nodes != NULL)
+		save_nodes_db_list(sel_nodes, numnodes);
+	else
+		save_nodes_db(0, NULL);
 
 	if (numnodes > 1) {          /*modification was for all nodes  */
 
@@ -2523,6 +2689,7 @@ mgr_node_unset(struct batch_request *preq)
 
 	free(problem_nodes);
 	free(warn_nodes);
+	free(sel_nodes);
 }
 
 /**
@@ -2631,7 +2798,7 @@ make_host_addresses_list(char *phost, u_long **pul)
 	memmove(tpul->pul, *pul, tpul->len);
 
 	if (hostaddr_idx == NULL) {
-		if ((hostaddr_idx = pbs_idx_create(0, 0)) == NULL) {
+		if ((hostaddr_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 			free(tpul->pul);
 			free(tpul);
 			strcat(log_buffer, "out of  memory");
@@ -2785,7 +2952,7 @@ create_pbs_node2(char *objname, svrattrl *plist, int perms, int *bad, struct pbs
 
 		/* create node index if not already done */
 		if (node_idx == NULL) {
-			if ((node_idx = pbs_idx_create(0, 0)) == NULL) {
+			if ((node_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
 				svr_totnodes--;
 				free_pnode(pnode);
 				free(pname);
@@ -3896,7 +4063,7 @@ mgr_resource_delete(struct batch_request *preq)
 			} else {
 				svr_resc_def = svr_rd->rs_next;
 			}
-			if (pbs_idx_delete(resc_attrdef_idx, prdef->rs_name) != PBS_IDX_RET_OK)
+			if (def_hash_delete(resc_attrdef_idx, prdef->rs_name) != 0)
 				log_errf(-1, __func__, "Could not remove %s from server resource index", prdef->rs_name);
 			free(prdef->rs_name);
 			free(prdef);
@@ -85,8 +85,8 @@ extern int   comp_resc_gt;
 extern int   comp_resc_lt;
 extern char *resc_in_err;
 
-extern int scheduler_jobs_stat;
 extern int resc_access_perm;
+extern time_t time_now;
 extern char *msg_nostf_resv;
 
 int modify_resv_attr(resc_resv *presv, svrattrl *plist, int perm, int *bad);
@@ -157,6 +157,7 @@ req_modifyjob(struct batch_request *preq)
 	int		 sendmom = 0;
 	char		hook_msg[HOOK_MSG_SIZE];
 	int		mod_project = 0;
+	int		nosave_only = 1;
 	pbs_sched	*psched;
 
 	switch (process_hooks(preq, hook_msg, sizeof(hook_msg),
@@ -236,11 +237,11 @@ req_modifyjob(struct batch_request *preq)
 		 * Is the attribute being altered one which could change
 		 * scheduling (ATR_DFLAG_SCGALT set) and if a scheduling
 		 * cycle is in progress, then set flag to add the job to list
-		 * of jobs which cannot be run in this cycle.
+		 * of jobs which cannot be run in this cycle, see am_jobs_add().
 		 * If the scheduler itself sends a modify job request,
 		 * no need to delay the job until next cycle.
 		 */
-		if ((psched == NULL) && (scheduler_jobs_stat) && (job_attr_def[i].at_flags & ATR_DFLAG_SCGALT))
+		if ((psched == NULL) && (job_attr_def[i].at_flags & ATR_DFLAG_SCGALT))
 			add_to_am_list = 1;
 
 		/* Is the attribute modifiable in RUN state ? */
@@ -249,6 +250,8 @@ req_modifyjob(struct batch_request *preq)
 			reply_badattr(PBSE_NOATTR, 1, plist, preq);
 			return;
 		}
+		if ((job_attr_def[i].at_flags & ATR_DFLAG_NOSAVM) == 0)
+			nosave_only = 0;
 		if ((running == 1) &&
 			((job_attr_def[i].at_flags & ATR_DFLAG_ALTRUN) == 0)) {
 
@@ -373,13 +376,24 @@ req_modifyjob(struct batch_request *preq)
 	if (find_sched_from_sock(preq->rq_conn, CONN_SCHED_PRIMARY) == NULL)
 		log_alter_records_for_attrs(pjob, plist);
 
-	/* if job is not running, may need to change its state */
-	if (!check_job_state(pjob, JOB_STATE_LTR_RUNNING)) {
-		svr_evaljobstate(pjob, &newstate, &newsubstate, 0);
-		svr_setjobstate(pjob, newstate, newsubstate);
-	}
+	/*
+	 * Attributes which are not saved on modify, like the estimates and
+	 * comments the scheduler sets every cycle, are only kept in memory.
+	 * They cannot change the job state and need no database write of
+	 * their own, mtime goes out with the next save of the job.
+	 */
+	if (nosave_only)
+		set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
+	else {
+		/* if job is not running, may need to change its state */
+		if (!check_job_state(pjob, JOB_STATE_LTR_RUNNING)) {
+			svr_evaljobstate(pjob, &newstate, &newsubstate, 0);
+			svr_setjobstate(pjob, newstate, newsubstate);
+		}
 
-	job_save_db(pjob); /* we must save the updates anyway, if any */
+		job_save_db(pjob); /* we must save the updates anyway, if any */
+	}
+	route_changed();
 
 	log_eventf(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->ji_qs.ji_jobid, msg_manager, msg_jobmod, preq->rq_user, preq->rq_host);
 
@@ -394,6 +408,57 @@ req_modifyjob(struct batch_request *preq)
 	reply_ack(preq);
 }
 
+/**
+ * @brief
+ * 		Service the Modify Job List Request from the scheduler.
+ *
+ * @par	Functionality:
+ *		The request carries one set of attribute modifications per job.
+ *		Each of them is split off into its own asynchronous Modify Job
+ *		request and handed to req_modifyjob(), so the per-job permission
+ *		checks and hooks are the same as for single requests.  The sender
+ *		does not wait for a reply, so none is sent for the list request.
+ *
+ * @param[in] preq - pointer to batch request from the scheduler
+ */
+
+void
+req_modifyjoblist(struct batch_request *preq)
+{
+	int i;
+	struct rq_manage *pjobmod;
+	struct batch_request *npreq;
+
+	for (i = 0; i < preq->rq_ind.rq_modifyjoblist.rq_count; i++) {
+		pjobmod = &preq->rq_ind.rq_modifyjoblist.rq_jobs[i];
+
+		npreq = alloc_br(PBS_BATCH_ModifyJob_Async);
+		if (npreq == NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			break;
+		}
+
+		npreq->rq_perm = preq->rq_perm;
+		npreq->rq_fromsvr = preq->rq_fromsvr;
+		npreq->rq_conn = preq->rq_conn;
+		npreq->rq_orgconn = preq->rq_orgconn;
+		npreq->rq_time = preq->rq_time;
+		strcpy(npreq->rq_user, preq->rq_user);
+		strcpy(npreq->rq_host, preq->rq_host);
+		npreq->rq_extend = NULL;
+
+		npreq->rq_ind.rq_modify.rq_cmd = pjobmod->rq_cmd;
+		npreq->rq_ind.rq_modify.rq_objtype = pjobmod->rq_objtype;
+		strcpy(npreq->rq_ind.rq_modify.rq_objname, pjobmod->rq_objname);
+		CLEAR_HEAD(npreq->rq_ind.rq_modify.rq_attr);
+		list_move(&pjobmod->rq_attr, &npreq->rq_ind.rq_modify.rq_attr);
+
+		req_modifyjob(npreq);
+	}
+
+	free_br(preq);
+}
+
 /**
  * @brief
  * 		Returns the svrattrl entry matching attribute 'name', or NULL if not found.
@@ -622,9 +687,6 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 		 * We only want to call the action functions for attributes which are being modified by this function.
 		 */
 		if (newattr[i].at_flags & ATR_VFLAG_MODIFY) {
-			if ((job_attr_def[i].at_flags & ATR_DFLAG_NOSAVM))
-				continue;
-
 			if (job_attr_def[i].at_action) {
 				rc = job_attr_def[i].at_action(&newattr[i],
 					pjob, ATR_ACTION_ALTER);
@@ -139,7 +139,7 @@ static struct batch_request *create_ckpt_request(char *job_id)
 		if (newreq != NULL)
 			free_br(newreq);
 		if (hold_svrattrl != NULL)
-			free(hold_svrattrl);
+			attrlist_free(hold_svrattrl);
 		return NULL;
 	}
 	snprintf(newreq->rq_ind.rq_hold.rq_orig.rq_objname, sizeof(newreq->rq_ind.rq_hold.rq_orig.rq_objname), "%s", job_id);
@@ -254,6 +254,16 @@ static void clear_preempt_hold(job *pjob)
 		free_jattr(pjob, JOB_ATR_Comment);
 }
 
+/**
+ * @brief
+ *	qsort comparison of jobs by the host of their Mother Superior
+ */
+static int
+cmp_job_ms(const void *a, const void *b)
+{
+	return strcmp((*(job **)a)->ji_qs.ji_destin, (*(job **)b)->ji_qs.ji_destin);
+}
+
 /**
  * @brief
  * req_preemptjobs- service the Preempt Jobs Request
@@ -261,6 +271,12 @@ static void clear_preempt_hold(job *pjob)
  * This request tries to preempt multiple jobs.
  * The state of the job may change as a result.
  *
+ * Jobs which are already out of the way are answered first.  The running
+ * jobs are then preempted all at once, in the order of their Mother
+ * Superior, so the requests bound for one Mom are queued back to back and
+ * leave in the same TPP flush.  The reply is sent by
+ * reply_preempt_jobs_request() once every job has an answer.
+ *
  * @param[in,out]	preq	- The Request
  */
 
@@ -275,6 +291,8 @@ req_preemptjobs(struct batch_request *preq)
 	int preempt_index = 0;
 	int preempt_total;
 	preempt_job_info *preempt_jobs_list;
+	job **run_jobs;
+	int nrun = 0;
 
 	preq->rq_reply.brp_code = 0;
 	count = preq->rq_ind.rq_preempt.count;
@@ -292,6 +310,13 @@ req_preemptjobs(struct batch_request *preq)
 		return;
 	}
 
+	if ((run_jobs = calloc(sizeof(job *), preempt_total + 1)) == NULL) {
+		free(preempt_jobs_list);
+		req_reject(PBSE_SYSTEM, 0, preq);
+		log_err(errno, __func__, "Unable to allocate memory");
+		return;
+	}
+
 	preq->rq_reply.brp_un.brp_preempt_jobs.ppj_list = preempt_jobs_list;
 	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_PreemptJobs;
 	preq->rq_reply.brp_un.brp_preempt_jobs.count = 0;
@@ -325,6 +350,7 @@ req_preemptjobs(struct batch_request *preq)
 					preempt_index++;
 					break;
 				default:
+					preq->rq_reply.brp_un.brp_preempt_jobs.count = preempt_index;
 					job_preempt_fail(preq, ppj->job_id);
 					preempt_index++;
 			}
@@ -332,16 +358,31 @@ req_preemptjobs(struct batch_request *preq)
 		}
 
 		pjob->ji_pmt_preq = preq;
+		run_jobs[nrun++] = pjob;
+	}
+	preq->rq_reply.brp_un.brp_preempt_jobs.count = preempt_index;
 
+	/* check if all jobs failed or were already out of the way */
+	if (nrun == 0) {
+		free(run_jobs);
+		reply_send(preq);
+		return;
+	}
+
+	qsort(run_jobs, nrun, sizeof(job *), cmp_job_ms);
+
+	/*
+	 * The last job answered replies to the scheduler and frees preq,
+	 * so preq is not touched after the last request is issued.
+	 */
+	for (i = 0; i < nrun; i++) {
+		pjob = run_jobs[i];
 		pjob->preempt_order = svr_get_preempt_order(pjob, psched);
 		pjob->preempt_order_index = 0;
 		if (issue_preempt_request((int)pjob->preempt_order[0].order[0], pjob, preq))
 			reply_preempt_jobs_request(PBSE_SYSTEM, (int)pjob->preempt_order[0].order[0], pjob);
 	}
-	preq->rq_reply.brp_un.brp_preempt_jobs.count = preempt_index;
-	/* check if all jobs failed */
-	if (preempt_index == preempt_total)
-		reply_send(preq);
+	free(run_jobs);
 }
 
 /**
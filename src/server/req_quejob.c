@@ -99,6 +99,7 @@
 
 #include <pwd.h>
 #include "mom_func.h"
+#include "pbs_pwcache.h"
 
 extern	char mom_host[PBS_MAXHOSTNAME+1];
 #endif	/* PBS_MOM */
@@ -155,6 +156,9 @@ extern char *msg_nostf_jobarray;
 /* Private Functions in this file */
 
 static	job	*locate_new_job(struct batch_request *preq, char *jobid);
+#ifdef PBS_MOM
+static	int	write_job_script(job *pj, char *data, size_t size);
+#endif
 
 #ifndef PBS_MOM	/* SERVER only */
 static	void	handle_qmgr_reply_to_resvQcreate(struct work_task *);
@@ -191,50 +195,37 @@ static char *pbs_o_que = "PBS_O_QUEUE=";
 int
 validate_perm_res_in_select(char *val, int val_exist)
 {
-	char        *chunk;
-	int 	     nchk;
-	int	     nelem;
-	struct key_value_pair *pkvp;
-	int	     rc = 0;
+	parsed_select *ps;
+	int	     k;
 	int	     j;
 	resource_def *presc;
 
 	if (val == NULL)
 		return (0);	/* nothing to validate */
 
-	chunk = parse_plus_spec(val, &rc); /* break '+' seperated substrings */
-	if (rc != 0)
-		return (rc);
+	if ((ps = get_parsed_select(val)) == NULL)
+		return PBSE_SYSTEM;
 
-	while (chunk) {
+	for (k = 0; k < ps->ps_nchunks; k++) {
+		sel_chunk *sc = &ps->ps_chunks[k];
 
-#ifdef NAS /* localmod 082 */
-		if (parse_chunk(chunk, 0, &nchk, &nelem, &pkvp, NULL) == 0) {
-#else
-		if (parse_chunk(chunk, &nchk, &nelem, &pkvp, NULL) == 0) {
-#endif /* localmod 082 */
-
-			/* first check for any invalid resources in the select */
-			for (j=0; j<nelem; ++j) {
-				presc = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
-				if (presc) {
-					if ((presc->rs_flags & resc_access_perm) == 0) {
-						if ((resc_in_err = strdup(pkvp[j].kv_keyw)) == NULL)
-							return PBSE_SYSTEM;
-						return PBSE_INVALSELECTRESC; /* for freeing resc_in_err please read "NOTE" above in function brief*/
-					}
-				} else if (val_exist) {
-					if ((resc_in_err = strdup(pkvp[j].kv_keyw)) == NULL)
+		/* first check for any invalid resources in the select */
+		for (j=0; j<sc->sc_nelem; ++j) {
+			presc = find_resc_def(svr_resc_def, sc->sc_kv[j].kv_keyw);
+			if (presc) {
+				if ((presc->rs_flags & resc_access_perm) == 0) {
+					if ((resc_in_err = strdup(sc->sc_kv[j].kv_keyw)) == NULL)
 						return PBSE_SYSTEM;
-					return PBSE_UNKRESC; /* for freeing resc_in_err please read "NOTE" above in function brief*/
+					return PBSE_INVALSELECTRESC; /* for freeing resc_in_err please read "NOTE" above in function brief*/
 				}
-			} /* for */
-		} /* if */
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return (rc);
-	} /* while */
-	return (0);
+			} else if (val_exist) {
+				if ((resc_in_err = strdup(sc->sc_kv[j].kv_keyw)) == NULL)
+					return PBSE_SYSTEM;
+				return PBSE_UNKRESC; /* for freeing resc_in_err please read "NOTE" above in function brief*/
+			}
+		} /* for */
+	}
+	return (ps->ps_rc);
 }
 #endif
 
@@ -1036,7 +1027,7 @@ req_quejob(struct batch_request *preq)
 #else
 		struct passwd		*pwdp;
 
-		pwdp = getpwnam(get_jattr_str(pj, JOB_ATR_euser));
+		pwdp = pbs_getpwnam(get_jattr_str(pj, JOB_ATR_euser));
 		if ((pwdp != NULL) && (pwdp->pw_uid == 0))
 #endif
 		{
@@ -1088,8 +1079,54 @@ req_quejob(struct batch_request *preq)
 	}
 #endif
 
+#ifndef PBS_MOM
+	/*
+	 * A SubmitJob request brought the script along, the job takes over
+	 * the buffer it was decoded into and is committed right away
+	 */
+	if (preq->rq_ind.rq_queuejob.rq_script != NULL) {
+		if (preq->rq_ind.rq_queuejob.rq_scriptsz > get_bytes_from_attr(&attr_jobscript_max_size)) {
+			job_purge(pj);
+			req_reject(PBSE_JOBSCRIPTMAXSIZE, 0, preq);
+			return;
+		}
+		pj->ji_script = preq->rq_ind.rq_queuejob.rq_script;
+		pj->ji_qs.ji_un.ji_newt.ji_scriptsz = preq->rq_ind.rq_queuejob.rq_scriptsz;
+		preq->rq_ind.rq_queuejob.rq_script = NULL;
+		pj->ji_qs.ji_svrflags = (pj->ji_qs.ji_svrflags & ~JOB_SVFLG_CHKPT) |
+			JOB_SVFLG_SCRIPT;
+		if ((is_jattr_set(pj, JOB_ATR_block)) == 0)
+			implicit_commit = 1;
+	}
+#else
+	/*
+	 * An ExecJob request brought the script and the credential along,
+	 * keep them as the JobScript and JobCred requests would, the request
+	 * asks for an implicit commit
+	 */
+	if ((preq->rq_ind.rq_queuejob.rq_script != NULL) &&
+		((pj->ji_qs.ji_svrflags & JOB_SVFLG_CHKPT) == 0)) {
+		if ((rc = write_job_script(pj, preq->rq_ind.rq_queuejob.rq_script,
+			preq->rq_ind.rq_queuejob.rq_scriptsz)) != 0) {
+			job_purge(pj);
+			req_reject(rc, 0, preq);
+			return;
+		}
+		pj->ji_qs.ji_svrflags |= JOB_SVFLG_SCRIPT;
+	}
+	if (preq->rq_ind.rq_queuejob.rq_cred != NULL) {
+		pj->ji_extended.ji_ext.ji_credtype = preq->rq_ind.rq_queuejob.rq_credtype;
+		if (write_cred(pj, preq->rq_ind.rq_queuejob.rq_cred,
+			preq->rq_ind.rq_queuejob.rq_credsz) == -1) {
+			job_purge(pj);
+			req_reject(PBSE_SYSTEM, 0, preq);
+			return;
+		}
+	}
+#endif
+
 	/* check implicit commit only not blocking job */
-	if ((is_jattr_set(pj, JOB_ATR_block)) == 0)
+	if ((is_jattr_set(pj, JOB_ATR_block)) == 0 && !implicit_commit)
 		implicit_commit = ((preq->rq_extend) && (strstr(preq->rq_extend, EXTEND_OPT_IMPLICIT_COMMIT)));
 
 	/* acknowledge the request with the job id */
@@ -1234,56 +1271,25 @@ req_jobcredential(struct batch_request *preq)
 	return;
 }
 
+#ifdef PBS_MOM
 /**
  * @brief
- *		Receive job script section
- * @par Functionality:
- *		For Mom, each section is appended to the file
- *		For Server, its appended to the ji_script member
- *		of the job structure, to be later saved to the DB
+ *		Append a section of the job script to the job's script file
  *
- *  @param[in,out]	preq	-	Pointer to batch request structure
+ * @param[in,out]	pj	-	the new job, its script size is updated
+ * @param[in]	data	-	the script section
+ * @param[in]	size	-	length of the section
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_* : error to reject the request with, the error is logged
  */
-
-void
-req_jobscript(struct batch_request *preq)
+static int
+write_job_script(job *pj, char *data, size_t size)
 {
-	job	*pj;
-#ifdef PBS_MOM
 	int	 filemode = 0700;
 	int	 fds;
 	char namebuf[MAXPATHLEN];
-#else
-	char *temp;
-	u_Long size;
-#endif
-
-	pj = locate_new_job(preq, NULL);
-	if (pj == NULL) {
-		req_reject(PBSE_IVALREQ, 0, preq);
-		return;
-	}
-	if (!check_job_substate(pj, JOB_SUBSTATE_TRANSIN)) {
-		delete_link(&pj->ji_alljobs);
-		req_reject(PBSE_IVALREQ, 0, preq);
-		return;
-	}
-#ifndef PBS_MOM
-	if (svr_authorize_jobreq(preq, pj) == -1) {
-		req_reject(PBSE_PERM, 0, preq);
-		return;
-	}
-#else
-	/* mom - if job has been checkpointed, discard script,already have it */
-	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_CHKPT) {
-		/* do nothing, ignore script */
-		reply_ack(preq);
-		return;
-	}
-#endif		/* PBS_MOM */
-
-#ifdef PBS_MOM
-
 
 	if (reject_root_scripts == TRUE) {
 		if ((pj->ji_wattr[(int)JOB_ATR_euser].at_flags & \
@@ -1296,16 +1302,14 @@ req_jobscript(struct batch_request *preq)
 #else
 			struct passwd		*pwdp;
 
-			pwdp = getpwnam(get_jattr_str(pj, JOB_ATR_euser));
+			pwdp = pbs_getpwnam(get_jattr_str(pj, JOB_ATR_euser));
 			if ((pwdp != NULL) && (pwdp->pw_uid == 0))
 #endif
 			{
 
 				log_err(-1, "req_jobscript",
 					msg_mom_reject_root_scripts);
-				delete_link(&pj->ji_alljobs);
-				req_reject(PBSE_MOM_REJECT_ROOT_SCRIPTS, 0, preq);
-				return;
+				return PBSE_MOM_REJECT_ROOT_SCRIPTS;
 			}
 		}
 	}
@@ -1324,9 +1328,7 @@ req_jobscript(struct batch_request *preq)
 	}
 	if (fds < 0) {
 		log_err(errno, "req_jobscript", msg_script_open);
-		delete_link(&pj->ji_alljobs);
-		req_reject(PBSE_SYSTEM, 0, preq);
-		return;
+		return PBSE_SYSTEM;
 	}
 
 #ifdef WIN32
@@ -1334,16 +1336,70 @@ req_jobscript(struct batch_request *preq)
 	setmode(fds, O_BINARY);
 #endif /* WIN32 */
 
-	if (write(fds, preq->rq_ind.rq_jobfile.rq_data,
-		(unsigned)preq->rq_ind.rq_jobfile.rq_size) !=
-		preq->rq_ind.rq_jobfile.rq_size) {
+	if (write(fds, data, (unsigned)size) != size) {
 		log_err(errno, "req_jobscript", msg_script_write);
-		delete_link(&pj->ji_alljobs);
-		req_reject(PBSE_SYSTEM, 0, preq);
 		(void)close(fds);
-		return;
+		return PBSE_SYSTEM;
 	}
 	(void)close(fds);
+	pj->ji_qs.ji_un.ji_newt.ji_scriptsz += size;
+	return 0;
+}
+#endif /* PBS_MOM */
+
+/**
+ * @brief
+ *		Receive job script section
+ * @par Functionality:
+ *		For Mom, each section is appended to the file
+ *		For Server, its appended to the ji_script member
+ *		of the job structure, to be later saved to the DB
+ *
+ *  @param[in,out]	preq	-	Pointer to batch request structure
+ */
+
+void
+req_jobscript(struct batch_request *preq)
+{
+	job	*pj;
+#ifdef PBS_MOM
+	int	 rc;
+#else
+	char *temp;
+	u_Long size;
+#endif
+
+	pj = locate_new_job(preq, NULL);
+	if (pj == NULL) {
+		req_reject(PBSE_IVALREQ, 0, preq);
+		return;
+	}
+	if (!check_job_substate(pj, JOB_SUBSTATE_TRANSIN)) {
+		delete_link(&pj->ji_alljobs);
+		req_reject(PBSE_IVALREQ, 0, preq);
+		return;
+	}
+#ifndef PBS_MOM
+	if (svr_authorize_jobreq(preq, pj) == -1) {
+		req_reject(PBSE_PERM, 0, preq);
+		return;
+	}
+#else
+	/* mom - if job has been checkpointed, discard script,already have it */
+	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_CHKPT) {
+		/* do nothing, ignore script */
+		reply_ack(preq);
+		return;
+	}
+#endif		/* PBS_MOM */
+
+#ifdef PBS_MOM
+	if ((rc = write_job_script(pj, preq->rq_ind.rq_jobfile.rq_data,
+		(size_t)preq->rq_ind.rq_jobfile.rq_size)) != 0) {
+		delete_link(&pj->ji_alljobs);
+		req_reject(rc, 0, preq);
+		return;
+	}
 #else /* server - server - server - server */
 	/* add the script to the job */
 	size = get_bytes_from_attr(&attr_jobscript_max_size);
@@ -1363,10 +1419,7 @@ req_jobscript(struct batch_request *preq)
 	memmove(pj->ji_script + pj->ji_qs.ji_un.ji_newt.ji_scriptsz,
 		preq->rq_ind.rq_jobfile.rq_data,
 		(size_t)preq->rq_ind.rq_jobfile.rq_size);
-#endif
 	pj->ji_qs.ji_un.ji_newt.ji_scriptsz += preq->rq_ind.rq_jobfile.rq_size;
-
-#ifndef PBS_MOM
 	pj->ji_script[pj->ji_qs.ji_un.ji_newt.ji_scriptsz] = '\0';
 #endif
 
@@ -1807,6 +1860,183 @@ req_commit(struct batch_request *preq)
 	req_commit_now(preq, pj);
 }
 
+#ifndef PBS_MOM
+/**
+ * @brief
+ *		Copy a svrattrl entry to the end of a list
+ *
+ * @param[in,out]	phead - list to copy the entry to
+ * @param[in]	psatl - entry to copy
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: out of memory
+ */
+int
+dup_svrattrl(pbs_list_head *phead, svrattrl *psatl)
+{
+	svrattrl *pnew;
+
+	pnew = attrlist_create(psatl->al_name, psatl->al_resc, psatl->al_valln);
+	if (pnew == NULL)
+		return -1;
+	if (psatl->al_valln > 0)
+		memcpy(pnew->al_value, psatl->al_value, psatl->al_valln);
+	pnew->al_op = psatl->al_op;
+	pnew->al_flags = psatl->al_flags;
+	append_link(phead, &pnew->al_link, pnew);
+	return 0;
+}
+
+/**
+ * @brief
+ *		Is there an entry for the same attribute and resource in a list?
+ *
+ * @param[in]	phead - list to look in
+ * @param[in]	psatl - entry to look for
+ *
+ * @return	int
+ * @retval	1	: found
+ * @retval	0	: not found
+ */
+static int
+svrattrl_in_list(pbs_list_head *phead, svrattrl *psatl)
+{
+	svrattrl *pal;
+
+	for (pal = (svrattrl *)GET_NEXT(*phead); pal; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if (strcmp(pal->al_name, psatl->al_name) != 0)
+			continue;
+		if ((pal->al_resc == NULL) && (psatl->al_resc == NULL))
+			return 1;
+		if (pal->al_resc && psatl->al_resc && (strcmp(pal->al_resc, psatl->al_resc) == 0))
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *		Submit Job List Batch Request processing routine
+ *
+ * @par	Functionality:
+ *		Each job of the request is queued by a Queue Job request of its
+ *		own, so the checks and queuejob hooks are the same as for single
+ *		submissions.  A job gets the attributes of its list entry plus the
+ *		shared attributes it does not set itself, and is committed at once.
+ *		All the jobs are written to the database in one transaction.
+ *
+ *		The reply lists the job id, or an empty string, and the error
+ *		code of every job in the order of the request.  If the
+ *		transaction fails none of the jobs are kept and the whole request
+ *		is rejected.
+ *
+ * @param[in] preq - pointer to the decoded request
+ */
+void
+req_submitjoblist(struct batch_request *preq)
+{
+	int i;
+	int ok = 1;
+	struct rq_submitjoblist *psj = &preq->rq_ind.rq_submitjoblist;
+	struct rq_submitjob *pjr;
+	struct batch_request *npreq;
+	struct batch_deljob_status *pstat;
+	svrattrl *psatl;
+	job *pj;
+
+	/* a blocking job needs a connection of its own to wait on */
+	if (find_svrattrl_list_entry(&psj->rq_attr, ATTR_block, NULL) != NULL) {
+		req_reject(PBSE_IVALREQ, 0, preq);
+		return;
+	}
+	for (i = 0; i < psj->rq_count; i++) {
+		if (find_svrattrl_list_entry(&psj->rq_jobs[i].rq_attr, ATTR_block, NULL) != NULL) {
+			req_reject(PBSE_IVALREQ, 0, preq);
+			return;
+		}
+	}
+
+	if (pbs_db_begin_trx(svr_db_conn) != 0) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_Delete;
+	preq->rq_reply.brp_un.brp_deletejoblist.brp_delstatc = NULL;
+	preq->rq_reply.brp_count = 0;
+
+	for (i = 0; i < psj->rq_count; i++) {
+		pjr = &psj->rq_jobs[i];
+
+		npreq = alloc_br(PBS_BATCH_QueueJob);
+		if (npreq == NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			ok = 0;
+			break;
+		}
+
+		npreq->rq_perm = preq->rq_perm;
+		npreq->rq_fromsvr = preq->rq_fromsvr;
+		npreq->rq_conn = preq->rq_conn;
+		npreq->rq_orgconn = preq->rq_orgconn;
+		npreq->rq_time = preq->rq_time;
+		npreq->prot = preq->prot;
+		strcpy(npreq->rq_user, preq->rq_user);
+		strcpy(npreq->rq_host, preq->rq_host);
+		npreq->rq_collectbr = preq;
+
+		CLEAR_HEAD(npreq->rq_ind.rq_queuejob.rq_attr);
+		strcpy(npreq->rq_ind.rq_queuejob.rq_destin, psj->rq_destin);
+
+		/* the job's own attributes, then the shared ones it does not set */
+		while ((psatl = (svrattrl *)GET_NEXT(pjr->rq_attr)) != NULL) {
+			delete_link(&psatl->al_link);
+			append_link(&npreq->rq_ind.rq_queuejob.rq_attr, &psatl->al_link, psatl);
+		}
+		for (psatl = (svrattrl *)GET_NEXT(psj->rq_attr); psatl;
+			psatl = (svrattrl *)GET_NEXT(psatl->al_link)) {
+			if (svrattrl_in_list(&npreq->rq_ind.rq_queuejob.rq_attr, psatl))
+				continue;
+			if (dup_svrattrl(&npreq->rq_ind.rq_queuejob.rq_attr, psatl) != 0)
+				break;
+		}
+		if (psatl != NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			free_br(npreq);
+			ok = 0;
+			break;
+		}
+
+		/* the script, if any, makes the job commit with its Queue Job */
+		if (pjr->rq_script != NULL) {
+			npreq->rq_ind.rq_queuejob.rq_script = pjr->rq_script;
+			npreq->rq_ind.rq_queuejob.rq_scriptsz = pjr->rq_scriptsz;
+			pjr->rq_script = NULL;
+		} else if ((npreq->rq_extend = strdup(EXTEND_OPT_IMPLICIT_COMMIT)) == NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			free_br(npreq);
+			ok = 0;
+			break;
+		}
+
+		req_quejob(npreq);
+	}
+
+	if ((pbs_db_end_trx(svr_db_conn, ok) != 0) || !ok) {
+		/* none of the jobs made it to the database, drop them all */
+		for (pstat = preq->rq_reply.brp_un.brp_deletejoblist.brp_delstatc; pstat; pstat = pstat->next) {
+			if ((pstat->code == PBSE_NONE) && ((pj = find_job(pstat->name)) != NULL))
+				job_purge(pj);
+		}
+		req_reject(ok ? PBSE_SAVE_ERR : PBSE_SYSTEM, 0, preq);
+		return;
+	}
+
+	(void)reply_send(preq);
+}
+#endif	/* PBS_MOM */
+
 /**
  * @brief
  * 		locate_new_job - locate a "new" job which has been set up req_quejob on
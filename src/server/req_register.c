@@ -57,6 +57,8 @@
  * 	make_depend()
  * 	register_dep()
  * 	unregister_dep()
+ * 	depend_ix_drop()
+ * 	link_dependjob()
  * 	find_dependjob()
  * 	make_dependjob()
  * 	send_depend_req()
@@ -98,6 +100,7 @@
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "net_connect.h"
+#include "pbs_idx.h"
 
 
 
@@ -112,6 +115,7 @@ static int register_dep(attribute *, struct batch_request *, int, int *);
 static int unregister_dep(attribute *, struct batch_request *);
 static struct depend *make_depend(int type, attribute *pattr);
 static struct depend_job *make_dependjob(struct depend *, char *jobid, char *host);
+static void   link_dependjob(struct depend *, struct depend_job *);
 static void   del_depend_job(struct depend_job *pdj);
 static int    build_depend(attribute *, char *);
 static void   clear_depend(struct depend *, int type, int exists);
@@ -139,6 +143,7 @@ extern char  log_buffer[];
 
 #define DEPEND_ADD	1
 #define DEPEND_REMOVE	2
+#define DEPEND_JOBS_IX_MIN	16	/* jobs of a dependency before find_dependjob() indexes them */
 /**
  * @brief
  * 		post_run_depend - this function is called via a work task when a
@@ -1308,10 +1313,57 @@ unregister_dep(attribute *pattr, struct batch_request *preq)
 	return (0);
 }
 
+/**
+ * @brief
+ * 		depend_ix_drop - drop the job id index of a dependency set
+ *
+ * @param[in,out]	pdep	-	dependency set
+ * @param[in]	noix	-	if set, the jobs of the set are not to be indexed
+ *				again, e.g. because a job id occurs twice
+ */
+
+static void
+depend_ix_drop(struct depend *pdep, int noix)
+{
+	if (pdep->dp_jobs_ix != NULL) {
+		pbs_idx_destroy(pdep->dp_jobs_ix);
+		pdep->dp_jobs_ix = NULL;
+	}
+	if (noix)
+		pdep->dp_noix = 1;
+}
+
+/**
+ * @brief
+ * 		link_dependjob - append a depend_job structure to a dependency set
+ *		and to its job id index, if it has one
+ *
+ * @param[in,out]	pdep	-	dependency set
+ * @param[in]	pdj	-	depend_job structure to add
+ */
+
+static void
+link_dependjob(struct depend *pdep, struct depend_job *pdj)
+{
+	pdj->dc_depend = pdep;
+	append_link(&pdep->dp_jobs, &pdj->dc_link, pdj);
+	if ((pdep->dp_jobs_ix != NULL) &&
+		(pbs_idx_insert(pdep->dp_jobs_ix, pdj->dc_child, pdj) != PBS_IDX_RET_OK))
+		depend_ix_drop(pdep, 1);
+}
+
 /**
  * @brief
  * 		find_dependjob - find a child dependent job with a certain job id
  *
+ * @par
+ *		A dependency on only a few jobs is searched in order.  Once a
+ *		search passes DEPEND_JOBS_IX_MIN of them, an index keyed by job id
+ *		is built and kept up to date by link_dependjob() and
+ *		del_depend_job(), so a job with a wide fan-in or fan-out of
+ *		dependencies is registered and released in constant time per
+ *		dependency.
+ *
  * @param[in]	pdep	-	dependent jobs
  * @param[in]	name	-	job id to be matched
  *
@@ -1322,15 +1374,44 @@ unregister_dep(attribute *pattr, struct batch_request *preq)
 struct depend_job *find_dependjob(struct depend *pdep, char *name)
 {
 	struct depend_job *pdj;
+	int		   n = 0;
 
 	if ((pdep == NULL) || (name == NULL))
 		return NULL;
 
+	if (pdep->dp_jobs_ix == NULL) {
+		pdj = (struct depend_job *)GET_NEXT(pdep->dp_jobs);
+		while (pdj) {
+			if (!strcmp(name, pdj->dc_child))
+				return (pdj);
+			if ((++n >= DEPEND_JOBS_IX_MIN) && (pdep->dp_noix == 0))
+				break;
+			pdj = (struct depend_job *)GET_NEXT(pdj->dc_link);
+		}
+		if (pdj == NULL)
+			return NULL;
+		if ((pdep->dp_jobs_ix = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+			goto scan;
+		pdj = (struct depend_job *)GET_NEXT(pdep->dp_jobs);
+		while (pdj) {
+			if (pbs_idx_insert(pdep->dp_jobs_ix, pdj->dc_child, pdj) != PBS_IDX_RET_OK) {
+				depend_ix_drop(pdep, 1);
+				goto scan;
+			}
+			pdj = (struct depend_job *)GET_NEXT(pdj->dc_link);
+		}
+	}
+
+	pdj = NULL;
+	if (pbs_idx_find(pdep->dp_jobs_ix, (void **)&name, (void **)&pdj, NULL) == PBS_IDX_RET_OK)
+		return (pdj);
+	return NULL;
+
+scan:
 	pdj = (struct depend_job *)GET_NEXT(pdep->dp_jobs);
 	while (pdj) {
 		if (!strcmp(name, pdj->dc_child))
 			break;
-
 		pdj = (struct depend_job *)GET_NEXT(pdj->dc_link);
 	}
 	return (pdj);
@@ -1359,7 +1440,7 @@ static struct depend_job *make_dependjob(struct depend *pdep, char *jobid, char
 		pdj->dc_cost    = 0;
 		(void)strcpy(pdj->dc_child, jobid);
 		(void)strcpy(pdj->dc_svr, host);
-		append_link(&pdep->dp_jobs, &pdj->dc_link, pdj);
+		link_dependjob(pdep, pdj);
 	}
 	return (pdj);
 }
@@ -1669,7 +1750,7 @@ encode_depend(const attribute *attr, pbs_list_head *phead, char *atname, char *r
 	} else {
 		/* there are no dependencies, just the base structure,	*/
 		/* so remove this svrattrl from ths list		*/
-		(void)free(pal);
+		attrlist_free(pal);
 		if (rtnl)
 			*rtnl = NULL;
 		return (0);
@@ -1772,6 +1853,7 @@ free_depend(struct attribute *attr)
 			delete_link(&pdjb->dc_link);
 			(void)free(pdjb);
 		}
+		depend_ix_drop(pdp, 0);
 		delete_link(&pdp->dp_link);
 		(void)free(pdp);
 	}
@@ -1923,7 +2005,7 @@ build_depend(attribute *pattr, char *value)
 					}
 				}
 
-				append_link(&pd->dp_jobs, &pdjb->dc_link, pdjb);
+				link_dependjob(pd, pdjb);
 			} else {
 				return (PBSE_SYSTEM);
 			}
@@ -1956,10 +2038,13 @@ clear_depend(struct depend *pd, int type, int exist)
 			GET_NEXT(pd->dp_jobs)) != NULL) {
 			del_depend_job(pdj);
 		}
+		depend_ix_drop(pd, 0);
 	} else {
 		CLEAR_HEAD(pd->dp_jobs);
 		CLEAR_LINK(pd->dp_link);
+		pd->dp_jobs_ix = NULL;
 	}
+	pd->dp_noix = 0;
 	pd->dp_type = type;
 	pd->dp_numexp = 0;
 	pd->dp_numreg = 0;
@@ -1979,6 +2064,7 @@ del_depend(struct depend *pd)
 {
 	struct depend_job *pdj;
 
+	depend_ix_drop(pd, 0);
 	while ((pdj = (struct depend_job *)GET_NEXT(pd->dp_jobs)) != NULL) {
 		del_depend_job(pdj);
 	}
@@ -1996,6 +2082,8 @@ del_depend(struct depend *pd)
 static void
 del_depend_job(struct depend_job *pdj)
 {
+	if ((pdj->dc_depend != NULL) && (pdj->dc_depend->dp_jobs_ix != NULL))
+		(void)pbs_idx_delete(pdj->dc_depend->dp_jobs_ix, pdj->dc_child);
 	delete_link(&pdj->dc_link);
 	(void)free(pdj);
 }
@@ -529,10 +529,7 @@ req_confirmresv(struct batch_request *preq)
 	int resv_count = 0;
 	int is_degraded = 0;
 	int is_confirmed = 0;
-	char *execvnodes = NULL;
 	char *next_execvnode = NULL;
-	char **short_xc = NULL;
-	char **tofree = NULL;
 	extern char server_host[];
 	int is_being_altered = 0;
 	char *tmp_buf = NULL;
@@ -682,41 +679,20 @@ req_confirmresv(struct batch_request *preq)
 			return;
 		}
 
-		execvnodes = strdup(preq->rq_ind.rq_run.rq_destin);
-		if (execvnodes == NULL) {
-			req_reject(PBSE_SYSTEM, 0, preq);
-			return;
-		}
-		DBPRT(("stdg_resv conf: execvnodes_seq is %s\n", execvnodes));
+		DBPRT(("stdg_resv conf: execvnodes_seq is %s\n", preq->rq_ind.rq_run.rq_destin));
 
-		/* execvnodes is of the form:
+		/* rq_destin is of the form:
 		 *       <num_resv>#<(execvnode1)>[<range>]<(exevnode2)>[...
-		 * this "condensed" string is unrolled into a pointer array of
-		 * execvnodes per occurrence, e.g. short_xc[0] are the execvnodes
-		 * for 1st occurrence, short_xc[1] for the 2nd etc...
-		 * If something goes wrong during unrolling then NULL is returned.
-		 * which causes the confirmation message to be rejected
+		 * Only the execvnode of the soonest (i.e., next) occurrence is
+		 * needed here, it is copied out without unrolling the sequence.
+		 * If something goes wrong then NULL is returned, which causes
+		 * the confirmation message to be rejected
 		 */
-		short_xc = unroll_execvnode_seq(execvnodes, &tofree);
-		if (short_xc == NULL) {
-			free(execvnodes);
-			req_reject(PBSE_SYSTEM, 0, preq);
-			return;
-		}
-		/* The execvnode of the soonest (i.e., next) occurrence */
-		next_execvnode = strdup(short_xc[0]);
+		next_execvnode = get_execvnode_occurrence(preq->rq_ind.rq_run.rq_destin, 0);
 		if (next_execvnode == NULL) {
-			free(short_xc);
-			free_execvnode_seq(tofree);
-			free(execvnodes);
 			req_reject(PBSE_SYSTEM, 0, preq);
 			return;
 		}
-		/* Release the now obsolete allocations used to manipulate the
-		 * unrolled string */
-		free(short_xc);
-		free_execvnode_seq(tofree);
-		free(execvnodes);
 
 		/* When confirming for the first time, set the index and count */
 		if (!is_degraded) {
@@ -757,6 +733,7 @@ req_confirmresv(struct batch_request *preq)
 					NULL,
 					NULL,
 					preq->rq_ind.rq_run.rq_destin);
+				resv_vnodes_changed();
 			}
 		}
 	} else { /* Advance reservation */
@@ -311,6 +311,9 @@ req_runjob(struct batch_request *preq)
 	struct deferred_request *pdefr;
 	char hook_msg[HOOK_MSG_SIZE];
 	pbs_sched *psched;
+#ifndef NAS /* localmod 133 */
+	pbs_sched *psched_run;
+#endif /* localmod 133 */
 
 	if ((preq->rq_perm & (ATR_DFLAG_MGWR | ATR_DFLAG_OPWR)) == 0) {
 		req_reject(PBSE_PERM, 0, preq);
@@ -336,7 +339,10 @@ req_runjob(struct batch_request *preq)
 	}
 
 #ifndef NAS /* localmod 133 */
-	if ((psched->sc_cycle_started != -1) && was_job_alteredmoved(parent)) {
+	/* the job was altered or moved during the cycle of the scheduler asking to run it */
+	if ((psched_run = find_sched_from_sock(preq->rq_conn, CONN_SCHED_PRIMARY)) == NULL)
+		psched_run = psched;
+	if ((psched->sc_cycle_started != -1) && was_job_alteredmoved(psched_run, parent)) {
 		/* Reject run request for altered/moved jobs if job_run_wait is set to "execjob_hook" */
 		if (!(psched->sch_attr[SCHED_ATR_job_run_wait].at_flags & ATR_VFLAG_SET) ||
 		    (!strcmp(psched->sch_attr[SCHED_ATR_job_run_wait].at_val.at_str, RUN_WAIT_EXECJOB_HOOK))) {
@@ -455,6 +461,7 @@ req_runjob(struct batch_request *preq)
 		pdefr->dr_id[PBS_MAXSVRJOBID] = '\0';
 		pdefr->dr_preq = preq;
 		pdefr->dr_sent = 0;
+		pdefr->dr_sched = NULL;
 		append_link(&svr_deferred_req, &pdefr->dr_link, pdefr);
 		/* ensure that request is removed if client connect is closed */
 		net_add_close_func(preq->rq_conn, clear_from_defr);
@@ -497,7 +504,7 @@ req_runjob(struct batch_request *preq)
 		clear_attr(&sub_prev_res, &job_attr_def[JOB_ATR_resource]);
 
 		/* single subjob, if parent qeueud, it can be run */
-		if ((pjobsub = parent->ji_ajtrk->tkm_tbl[offset].trk_psubjob) != NULL) {
+		if ((pjobsub = get_subjob_ptr(parent, offset)) != NULL) {
 			sub_runcount = pjobsub->ji_wattr[JOB_ATR_runcount];
 			sub_run_version = pjobsub->ji_wattr[JOB_ATR_run_version];
 			if (is_jattr_set(pjobsub, JOB_ATR_resource))
@@ -549,6 +556,7 @@ req_runjob(struct batch_request *preq)
 	}
 
 	++preq->rq_refct;
+	subjob_tmpl_begin(parent);
 
 	while (1) {
 		if ((i = parse_subjob_index(range, &pc, &start, &end, &step, &count)) == -1) {
@@ -567,7 +575,7 @@ req_runjob(struct batch_request *preq)
 				attribute sub_run_version = {0};
 
 				jid = mk_subjob_id(parent, idx);
-				if ((pjobsub = parent->ji_ajtrk->tkm_tbl[idx].trk_psubjob) != NULL) {
+				if ((pjobsub = get_subjob_ptr(parent, idx)) != NULL) {
 					sub_runcount = pjobsub->ji_wattr[JOB_ATR_runcount];
 					sub_run_version = pjobsub->ji_wattr[JOB_ATR_run_version];
 					job_purge(pjobsub);
@@ -586,6 +594,7 @@ req_runjob(struct batch_request *preq)
 
 				if (call_to_process_hooks(preq, hook_msg, sizeof(hook_msg), pbs_python_set_interrupt) == 0) {
 					/* subjob reject from hook*/
+					subjob_tmpl_end(parent);
 					reply_text(preq, PBSE_HOOKERROR, hook_msg);
 					return;
 				}
@@ -597,6 +606,7 @@ req_runjob(struct batch_request *preq)
 		}
 		range = pc;
 	}
+	subjob_tmpl_end(parent);
 
 	/*
 	 * if not waiting on any running subjobs, can reply; else
@@ -606,6 +616,77 @@ req_runjob(struct batch_request *preq)
 		reply_send(preq);
 	return;
 }
+/**
+ * @brief
+ * 		Service the Run Subjobs Request from the scheduler.
+ *
+ * @par	Functionality:
+ *		The request names the subjobs of one array which are to run and
+ *		the vnodes of each.  Every subjob is split off into its own
+ *		asynchronous Run Job request for req_runjob(), so the checks and
+ *		runjob hooks are the same as for single requests.  While they are
+ *		started, the parent attributes copied into each new subjob are
+ *		encoded only once.  The sender does not wait for a reply, so none
+ *		is sent for the request itself.
+ *
+ * @param[in] preq - pointer to batch request from the scheduler
+ */
+void
+req_runsubjobs(struct batch_request *preq)
+{
+	int i;
+	int offset;
+	job *parent;
+	struct rq_runsubjobs *prs = &preq->rq_ind.rq_runsubjobs;
+	struct batch_request *npreq;
+
+	parent = find_job(prs->rq_jid);
+	if ((parent == NULL) || !(parent->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) ||
+		(parent->ji_ajtrk == NULL)) {
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_INFO, prs->rq_jid,
+			"run subjobs request for unknown array job");
+		free_br(preq);
+		return;
+	}
+
+	subjob_tmpl_begin(parent);
+	for (i = 0; i < prs->rq_count; i++) {
+		offset = numindex_to_offset(parent, prs->rq_indices[i]);
+		if (offset == -1)
+			continue;
+
+		npreq = alloc_br(PBS_BATCH_AsyrunJob);
+		if (npreq == NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			break;
+		}
+
+		npreq->rq_perm = preq->rq_perm;
+		npreq->rq_fromsvr = preq->rq_fromsvr;
+		npreq->rq_conn = preq->rq_conn;
+		npreq->rq_orgconn = preq->rq_orgconn;
+		npreq->rq_time = preq->rq_time;
+		strcpy(npreq->rq_user, preq->rq_user);
+		strcpy(npreq->rq_host, preq->rq_host);
+		npreq->rq_extend = NULL;
+
+		pbs_strncpy(npreq->rq_ind.rq_run.rq_jid, mk_subjob_id(parent, offset),
+			sizeof(npreq->rq_ind.rq_run.rq_jid));
+		npreq->rq_ind.rq_run.rq_destin = prs->rq_destins[i];
+		prs->rq_destins[i] = NULL;
+		npreq->rq_ind.rq_run.rq_resch = 0;
+
+		req_runjob(npreq);
+
+		/* the parent could have gone away with a failed subjob */
+		if ((parent = find_job(prs->rq_jid)) == NULL)
+			break;
+	}
+	if (parent != NULL)
+		subjob_tmpl_end(parent);
+
+	free_br(preq);
+}
 /**
  * @brief
  * 		req_runjob - service the Run Job and Asyc Run Job Requests
@@ -683,6 +764,10 @@ req_runjob2(struct batch_request *preq, job *pjob)
 		preq = 0;	/* cleared so we don't try to reuse */
 	}
 
+	/* keep the scheduler's later replies behind the deferred one of this run */
+	if (preq)
+		hold_sched_reply(preq, 1);
+
 	if (((rc = svr_startjob(pjob, preq)) != 0) &&
 		((rq_type == PBS_BATCH_AsyrunJob_ack) || preq)) {
 		free_nodes(pjob);
@@ -1397,6 +1482,20 @@ post_sendmom(struct work_task *pwt)
 		case PBSE_HOOK_REJECT_DELETEJOB:
 			r = SEND_JOB_HOOK_REJECT_DELETEJOB;
 			break;
+		case PBSE_UNKREQ: {
+			/*
+			 * a MoM older than the server rejected the Exec Job
+			 * request, the job is requeued and sent to it in
+			 * separate requests from now on
+			 */
+			mominfo_t *pmom = tfind2((unsigned long) jobp->ji_qs.ji_un.ji_exect.ji_momaddr,
+				jobp->ji_qs.ji_un.ji_exect.ji_momport, &ipaddrs);
+
+			if (pmom != NULL)
+				((mom_svrinfo_t *) pmom->mi_data)->msr_no_execjob = 1;
+			r = SEND_JOB_RETRY;
+			break;
+		}
 		default:
 			r = SEND_JOB_FATAL;
 			break;
@@ -1569,7 +1668,7 @@ post_sendmom(struct work_task *pwt)
 					/* Need to force queued state so */
 					/* job_abt() call does not try   */
 					/* to issue a kill job signal to mom */
-					set_job_state(jobp, JOB_STATE_LTR_QUEUED);
+					svr_chgjobstate(jobp, JOB_STATE_LTR_QUEUED);
 					set_job_substate(jobp, JOB_SUBSTATE_QUEUED);
 					job_abt(jobp, msg_hook_reject_deletejob);
 					break;
@@ -40,8 +40,8 @@
 /**
  *
  * @brief
- * 		Functions relating to the Select Job Batch Request and the Select-Status
- * 		(SelStat) Batch Request.
+ * 		Functions relating to the Select Job Batch Request, the Select-Status
+ * 		(SelStat) Batch Request and the Modify Jobs by Selection Batch Request.
  *
  */
 
@@ -68,6 +68,7 @@
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "pbs_sched.h"
+#include "pbs_db.h"
 
 /* Private Data */
 
@@ -78,7 +79,6 @@ extern pbs_list_head svr_alljobs;
 extern time_t	 time_now;
 extern char	 statechars[];
 extern long svr_history_enable;
-extern int scheduler_jobs_stat;
 
 /* Private Functions  */
 
@@ -89,6 +89,8 @@ static void free_sellist(struct select_list *pslist);
 static int  sel_attr(attribute *, struct select_list *);
 static int  select_job(job *, struct select_list *, int, int);
 static int  select_subjob(char, struct select_list *);
+static char *sel_owner(struct select_list *);
+static job *next_sel_job(job *, pbs_queue *, char *);
 
 
 /**
@@ -317,10 +319,12 @@ req_selectjobs(struct batch_request *preq)
 	struct brp_select **pselx;
 	int dosubjobs = 0;
 	int dohistjobs = 0;
+	int compact;
 	char *pstate = NULL;
 	int rc;
 	struct select_list *selistp;
 	pbs_sched *psched;
+	char *owner;
 
 	if (preq->rq_extend != NULL) {
 		/*
@@ -357,8 +361,8 @@ req_selectjobs(struct batch_request *preq)
 	 * instead of a per-queue selstat()
 	 */
 	psched = find_sched_from_sock(preq->rq_conn, CONN_SCHED_PRIMARY);
-	if (psched != NULL && psched == dflt_scheduler && !scheduler_jobs_stat)
-		scheduler_jobs_stat = 1;
+	if (psched != NULL && !psched->sc_jobs_stat)
+		psched->sc_jobs_stat = 1;
 
 	plist = (svrattrl *) GET_NEXT(preq->rq_ind.rq_select.rq_selattr);
 	rc = build_selist(plist, preq->rq_perm, &selistp, &pque, &bad, &pstate);
@@ -381,11 +385,10 @@ req_selectjobs(struct batch_request *preq)
 	preply->brp_count = 0;
 
 	/* now start checking for jobs that match the selection criteria */
-	if (pque)
-		pjob = (job *) GET_NEXT(pque->qu_jobs);
-	else
-		pjob = (job *) GET_NEXT(svr_alljobs);
+	owner = sel_owner(selistp);
+	pjob = next_sel_job(NULL, pque, owner);
 	while (pjob) {
+		compact = pjob->ji_histcompact;
 		if (server.sv_attr[SVR_ATR_query_others].at_val.at_long || svr_authorize_jobreq(preq, pjob) == 0) {
 
 			/*
@@ -434,10 +437,9 @@ req_selectjobs(struct batch_request *preq)
 				}
 			}
 		}
-		if (pque)
-			pjob = (job *) GET_NEXT(pjob->ji_jobque);
-		else
-			pjob = (job *) GET_NEXT(pjob->ji_alljobs);
+		if (compact && !pjob->ji_histcompact)
+			histjob_compact(pjob);
+		pjob = next_sel_job(pjob, pque, owner);
 		if (preq->rq_type != PBS_BATCH_SelectJobs && preply->brp_count >= MAX_JOBS_PER_REPLY && pjob) {
 			rc = reply_send_status_part(preq);
 			if (rc != PBSE_NONE)
@@ -452,6 +454,212 @@ out:
 		reply_send(preq);
 }
 
+/**
+ * @brief
+ * 	Service the Modify Jobs by Selection request, see pbs_alterjob_sel()
+ *
+ *	The jobs are selected as for a Select Job request without extend
+ *	flags, so no subjobs and no history jobs, and only the ones the user
+ *	may alter.  Each job gets a Modify Job request of its own carrying a
+ *	copy of the attributes, handed to req_modifyjob(), so the checks and
+ *	modifyjob hooks are those of single requests.  The job saves of the
+ *	whole set are written to the database in one transaction.
+ *
+ *	The reply has the job id and error code of every job, collected from
+ *	the Modify Job replies.  A modify that is relayed to the MOM of a
+ *	running job replies later; the request holds a reference for each
+ *	job, and the last reply to come in sends it.
+ *
+ * @param[in] preq - Modify Jobs by Selection request
+ *
+ * @return void
+ */
+void
+req_modifyjobs_sel(struct batch_request *preq)
+{
+	int bad = 0;
+	int i;
+	int rc;
+	int njobs = 0;
+	int nalloc = 0;
+	char **jobids = NULL;
+	char **tmp;
+	char *pstate = NULL;
+	char *owner;
+	job *pjob;
+	svrattrl *plist;
+	svrattrl *psatl;
+	pbs_queue *pque;
+	struct select_list *selistp;
+	struct batch_request *npreq;
+	struct batch_reply *preply;
+
+	plist = (svrattrl *) GET_NEXT(preq->rq_ind.rq_modifysel.rq_selattr);
+	rc = build_selist(plist, preq->rq_perm, &selistp, &pque, &bad, &pstate);
+	if (rc != 0) {
+		reply_badattr(rc, bad, plist, preq);
+		free_sellist(selistp);
+		return;
+	}
+
+	/* the modifies could change what is selected, pick the jobs first */
+	owner = sel_owner(selistp);
+	for (pjob = next_sel_job(NULL, pque, owner); pjob; pjob = next_sel_job(pjob, pque, owner)) {
+		if (svr_authorize_jobreq(preq, pjob) != 0 || !select_job(pjob, selistp, 0, 0))
+			continue;
+		if (njobs == nalloc) {
+			nalloc = nalloc ? nalloc * 2 : 64;
+			if ((tmp = realloc(jobids, nalloc * sizeof(char *))) == NULL)
+				break;
+			jobids = tmp;
+		}
+		if ((jobids[njobs] = strdup(pjob->ji_qs.ji_jobid)) == NULL)
+			break;
+		njobs++;
+	}
+	free_sellist(selistp);
+	if (pjob != NULL) {
+		log_err(errno, __func__, "Failed to allocate memory");
+		rc = PBSE_SYSTEM;
+		goto done;
+	}
+
+	if (pbs_db_begin_trx(svr_db_conn) != 0) {
+		rc = PBSE_SYSTEM;
+		goto done;
+	}
+
+	preply = &preq->rq_reply;
+	preply->brp_choice = BATCH_REPLY_CHOICE_Delete;
+	preply->brp_un.brp_deletejoblist.brp_delstatc = NULL;
+	preply->brp_count = 0;
+
+	/* held until all the jobs are walked */
+	preq->rq_refct = 1;
+
+	for (i = 0; i < njobs; i++) {
+		npreq = alloc_br(PBS_BATCH_ModifyJob);
+		if (npreq == NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			break;
+		}
+
+		npreq->rq_perm = preq->rq_perm;
+		npreq->rq_fromsvr = preq->rq_fromsvr;
+		npreq->rq_conn = preq->rq_conn;
+		npreq->rq_orgconn = preq->rq_orgconn;
+		npreq->rq_time = preq->rq_time;
+		npreq->prot = preq->prot;
+		strcpy(npreq->rq_user, preq->rq_user);
+		strcpy(npreq->rq_host, preq->rq_host);
+		npreq->rq_collectbr = preq;
+
+		npreq->rq_ind.rq_modify.rq_cmd = MGR_CMD_SET;
+		npreq->rq_ind.rq_modify.rq_objtype = MGR_OBJ_JOB;
+		strcpy(npreq->rq_ind.rq_modify.rq_objname, jobids[i]);
+		CLEAR_HEAD(npreq->rq_ind.rq_modify.rq_attr);
+		for (psatl = (svrattrl *) GET_NEXT(preq->rq_ind.rq_modifysel.rq_attr); psatl;
+			psatl = (svrattrl *) GET_NEXT(psatl->al_link)) {
+			if (dup_svrattrl(&npreq->rq_ind.rq_modify.rq_attr, psatl) != 0)
+				break;
+		}
+		if (psatl != NULL) {
+			log_err(errno, __func__, "Failed to allocate memory");
+			free_br(npreq);
+			break;
+		}
+
+		preq->rq_refct++;
+		req_modifyjob(npreq);
+	}
+
+	/*
+	 * the jobs are changed in memory already, so the saves are committed
+	 * even if not every job could be handed on; a failed commit leaves
+	 * the database behind the server, as for any deferred save
+	 */
+	job_save_db_send();
+	if (pbs_db_end_trx(svr_db_conn, 1) != 0) {
+		log_err(PBSE_SAVE_ERR, __func__, "Failed to commit the altered jobs");
+		panic_stop_db();
+	}
+
+	for (i = 0; i < njobs; i++)
+		free(jobids[i]);
+	free(jobids);
+
+	if (--preq->rq_refct == 0)
+		(void)reply_send(preq);
+	return;
+
+done:
+	for (i = 0; i < njobs; i++)
+		free(jobids[i]);
+	free(jobids);
+	req_reject(rc, 0, preq);
+}
+
+/**
+ * @brief
+ * 		sel_owner - find the one user a selection is limited to, so only the
+ *		jobs of that user need to be looked at.
+ *
+ * @param[in]	psel	-	selection list
+ *
+ * @return	char *
+ * @retval	user name (may carry @host, which the index ignores)
+ * @retval	NULL	: no User_List criterion naming a single user
+ */
+
+static char *
+sel_owner(struct select_list *psel)
+{
+	struct array_strings *parst;
+
+	for (; psel; psel = psel->sl_next) {
+		if (psel->sl_atindx != (int)JOB_ATR_userlst || !is_attr_set(&psel->sl_attr))
+			continue;
+		parst = psel->sl_attr.at_val.at_arst;
+		/*
+		 * the user part of an acl entry is matched exactly, see user_match(),
+		 * but a leading + or - allows or denies and is left to acl_check()
+		 */
+		if (parst != NULL && parst->as_usedptr == 1 && *parst->as_string[0] != '@' &&
+			*parst->as_string[0] != '+' && *parst->as_string[0] != '-')
+			return parst->as_string[0];
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		next_sel_job - get the next job a selection has to look at
+ *
+ *		The jobs of a single owner are walked if the selection names one,
+ *		else those of the queue if it names one, else every job.
+ *
+ * @param[in]	pjob	-	current job, NULL for the first one
+ * @param[in]	pque	-	queue the selection is limited to, or NULL
+ * @param[in]	owner	-	user the selection is limited to, or NULL
+ *
+ * @return	job *
+ * @retval	NULL	: no more jobs
+ */
+
+static job *
+next_sel_job(job *pjob, pbs_queue *pque, char *owner)
+{
+	if (owner) {
+		pjob = pjob ? (job *) GET_NEXT(pjob->ji_ownerjobs) : find_owner_jobs(owner);
+		while (pque && pjob && pjob->ji_qhdr != pque)
+			pjob = (job *) GET_NEXT(pjob->ji_ownerjobs);
+		return pjob;
+	}
+	if (pque)
+		return (job *) GET_NEXT(pjob ? pjob->ji_jobque : pque->qu_jobs);
+	return (job *) GET_NEXT(pjob ? pjob->ji_alljobs : svr_alljobs);
+}
+
 /**
  * @brief
  * 		select_job - determine if a single job matches the selection criteria
@@ -492,6 +700,18 @@ select_job(job *pjob, struct select_list *psel, int dosubjobs, int dohistjobs)
 		(pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob))
 		return 0;	/* don't bother to look at sub job */
 
+	if (pjob->ji_histcompact) {
+		struct select_list *ps;
+
+		/* selecting on an attribute a compacted history job gave up */
+		for (ps = psel; ps; ps = ps->sl_next) {
+			if (histjob_attr_dropped(ps->sl_atindx)) {
+				(void)histjob_expand(pjob);
+				break;
+			}
+		}
+	}
+
 	for (; psel; psel = psel->sl_next) {
 
 		if (psel->sl_atindx == (int)JOB_ATR_userlst) {
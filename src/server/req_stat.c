@@ -49,6 +49,7 @@
  * 	stat_a_jobidname()
  * 	req_stat_job()
  * 	req_stat_que()
+ * 	status_que_counts()
  * 	status_que()
  * 	req_stat_node()
  * 	status_node()
@@ -84,6 +85,7 @@
 #include "pbs_entlim.h"
 #include "pbs_error.h"
 #include "pbs_nodes.h"
+#include "pbs_idx.h"
 #include "svrfunc.h"
 #include "net_connect.h"
 #include "pbs_license.h"
@@ -112,6 +114,11 @@ extern pbs_license_counts license_counts;
 
 extern int status_attrib(svrattrl *, void *, attribute_def *, attribute *, int, int, pbs_list_head *, int *);
 extern int status_nodeattrib(svrattrl *, struct pbsnode *, int, int, pbs_list_head *, int *);
+extern u_Long modseq_update(attribute *, int, u_Long *);
+extern void modseq_clear(attribute *, int);
+extern u_Long stat_since(struct batch_request *);
+extern int status_modseq(u_Long, pbs_list_head *);
+extern int status_unchanged(int, char *, struct batch_request *, pbs_list_head *);
 
 extern int svr_chk_histjob(job *);
 
@@ -120,10 +127,16 @@ extern int svr_chk_histjob(job *);
 
 static int bad;
 
+/* how status_node() tracks the status it sends */
+#define NODE_STAT_FULL		0	/* not tracked */
+#define NODE_STAT_CHANGED	1	/* unchanged nodes sent by name only */
+#define NODE_STAT_RESYNC	2	/* all nodes sent in full and tracked */
+
 /* The following private support functions are included */
 
 static int status_que(pbs_queue *, struct batch_request *, pbs_list_head *);
-static int status_node(struct pbsnode *, struct batch_request *, pbs_list_head *);
+static int status_node(struct pbsnode *, struct batch_request *, pbs_list_head *, int);
+static void req_stat_node_summary(struct batch_request *, int);
 static int status_resv(resc_resv *, struct batch_request *, pbs_list_head *);
 
 /**
@@ -476,6 +489,35 @@ req_stat_que(struct batch_request *preq)
 	}
 }
 
+/**
+ * @brief
+ * 		status_que_counts - bring a queue's total_jobs and state_count
+ *		attributes up to date with its job counts, before it is statused.
+ *
+ * @param[in,out]	pque	-	ptr to the queue
+ */
+void
+status_que_counts(pbs_queue *pque)
+{
+	long total;
+
+	if (!svr_chk_history_conf()) {
+		total = pque->qu_numjobs;
+	} else {
+		total = pque->qu_numjobs -
+			(pque->qu_njstate[JOB_STATE_MOVED] + pque->qu_njstate[JOB_STATE_FINISHED] + pque->qu_njstate[JOB_STATE_EXPIRED]);
+	}
+	if (!(pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags & ATR_VFLAG_SET) ||
+		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long != total) {
+		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = total;
+		pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags |= ATR_SET_MOD_MCACHE;
+	}
+
+	update_state_ct(&pque->qu_attr[(int)QA_ATR_JobsByState],
+		pque->qu_njstate,
+		pque->qu_jobstbuf);
+}
+
 /**
  * @brief
  * 		status_que - Build the status reply for a single queue.
@@ -494,23 +536,16 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 {
 	struct brp_status *pstat;
 	svrattrl	  *pal;
+	u_Long		   since = stat_since(preq);
 
 	if ((preq->rq_perm & ATR_DFLAG_RDACC) == 0)
 		return (PBSE_PERM);
 
 	/* ok going to do status, update count and state counts from qu_qs */
+	status_que_counts(pque);
 
-	if (!svr_chk_history_conf()) {
-		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = pque->qu_numjobs;
-	} else {
-		pque->qu_attr[(int)QA_ATR_TotalJobs].at_val.at_long = pque->qu_numjobs -
-			(pque->qu_njstate[JOB_STATE_MOVED] + pque->qu_njstate[JOB_STATE_FINISHED] + pque->qu_njstate[JOB_STATE_EXPIRED]);
-	}
-	pque->qu_attr[(int)QA_ATR_TotalJobs].at_flags |= ATR_SET_MOD_MCACHE;
-
-	update_state_ct(&pque->qu_attr[(int)QA_ATR_JobsByState],
-		pque->qu_njstate,
-		pque->qu_jobstbuf);
+	if (modseq_update(pque->qu_attr, QA_ATR_LAST, &pque->qu_modseq) <= since)
+		return (status_unchanged(MGR_OBJ_QUEUE, pque->qu_qs.qu_name, preq, pstathd));
 
 	/* allocate status sub-structure and fill in header portion */
 
@@ -521,9 +556,13 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	strcpy(pstat->brp_objname, pque->qu_qs.qu_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
+	if (since != 0 && status_modseq(pque->qu_modseq, &pstat->brp_attr) != 0)
+		return (PBSE_SYSTEM);
+
 	/* add attributes to the status reply */
 
 	bad = 0;
@@ -531,6 +570,7 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	if (status_attrib(pal, que_attr_idx, que_attr_def, pque->qu_attr, QA_ATR_LAST,
 		preq->rq_perm, &pstat->brp_attr, &bad))
 		return (PBSE_NOATTR);
+	modseq_clear(pque->qu_attr, QA_ATR_LAST);
 
 	return (0);
 }
@@ -556,6 +596,8 @@ req_stat_node(struct batch_request *preq)
 	struct pbsnode	    *pnode = NULL;
 	int		    rc   = 0;
 	int		    type = 0;
+	int		    track = NODE_STAT_FULL;
+	pbs_sched	   *psched = NULL;
 	int		    i;
 
 	/*
@@ -570,6 +612,30 @@ req_stat_node(struct batch_request *preq)
 		return;
 	}
 
+	/*
+	 * the scheduler may ask to be sent only the nodes which changed,
+	 * and only those of its partition
+	 */
+	if (preq->rq_extend != NULL) {
+		size_t len = strlen(preq->rq_extend);
+
+		if (strcmp(preq->rq_extend, EXTEND_OPT_NODE_SUMMARY) == 0) {
+			req_stat_node_summary(preq, 0);
+			return;
+		} else if (strcmp(preq->rq_extend, EXTEND_OPT_NODE_SUMMARY_HOST) == 0) {
+			req_stat_node_summary(preq, 1);
+			return;
+		}
+		if (len > 0 && strcmp(preq->rq_extend + len - 1, EXTEND_OPT_NODE_PARTITION) == 0) {
+			psched = find_sched_from_sock(preq->rq_conn, CONN_SCHED_PRIMARY);
+			len--;
+		}
+		if (strncmp(preq->rq_extend, EXTEND_OPT_NODE_RESYNC, len) == 0 && len == strlen(EXTEND_OPT_NODE_RESYNC))
+			track = NODE_STAT_RESYNC;
+		else if (strncmp(preq->rq_extend, EXTEND_OPT_NODE_CHANGED, len) == 0 && len == strlen(EXTEND_OPT_NODE_CHANGED))
+			track = NODE_STAT_CHANGED;
+	}
+
 	resc_access_perm = preq->rq_perm;
 
 	name = preq->rq_ind.rq_status.rq_id;
@@ -590,15 +656,25 @@ req_stat_node(struct batch_request *preq)
 	preply->brp_count = 0;
 
 	if (type == 0) {		/* get status of the named node */
-		rc = status_node(pnode, preq, &preply->brp_un.brp_status);
+		rc = status_node(pnode, preq, &preply->brp_un.brp_status, track);
 
 	} else {			/* get status of all nodes */
 
 		for (i = 0; i < svr_totnodes; i++) {
 			pnode = pbsndlist[i];
 
+			/* a scheduler is not told of other partitions' nodes */
+			if (psched != NULL && find_assoc_sched_pnode(pnode) != psched)
+				continue;
+
+			/* send what we have so far rather than hold every node */
+			if (preply->brp_count >= MAX_NODES_PER_REPLY) {
+				rc = reply_send_status_part(preq);
+				if (rc != PBSE_NONE)
+					return;
+			}
 			rc = status_node(pnode, preq,
-				&preply->brp_un.brp_status);
+				&preply->brp_un.brp_status, track);
 			if (rc)
 				break;
 		}
@@ -620,13 +696,370 @@ req_stat_node(struct batch_request *preq)
 
 
 
+/*
+ * Totals over a set of vnodes, reported by req_stat_node_summary()
+ */
+struct node_state_count {
+	unsigned long	nsc_state;
+	long		nsc_count;
+};
+
+struct node_summary {
+	char			*ns_name;	/* host, "" for all vnodes */
+	long			 ns_vnodes;
+	int			 ns_nstates;
+	struct node_state_count	*ns_states;
+	attribute		 ns_avail;	/* summed resources_available */
+	attribute		 ns_assn;	/* summed resources_assigned */
+};
+
+/**
+ * @brief
+ * 		summary_add_resc - add the numeric resources of a vnode's resource
+ *		list to a summed list.  Indirect resources are counted on the
+ *		vnode they point to.
+ *
+ * @param[in,out]	sum	-	the summed resource list
+ * @param[in]	pattr	-	resources_available or resources_assigned of a vnode
+ */
+
+static void
+summary_add_resc(attribute *sum, attribute *pattr)
+{
+	resource *pr;
+	resource *ps;
+
+	if (!is_attr_set(pattr))
+		return;
+
+	for (pr = (resource *)GET_NEXT(pattr->at_val.at_list); pr != NULL;
+		pr = (resource *)GET_NEXT(pr->rs_link)) {
+		switch (pr->rs_defin->rs_type) {
+			case ATR_TYPE_LONG:
+			case ATR_TYPE_LL:
+			case ATR_TYPE_SHORT:
+			case ATR_TYPE_SIZE:
+			case ATR_TYPE_FLOAT:
+				break;
+			default:
+				continue;
+		}
+		if (!is_attr_set(&pr->rs_value) ||
+			(pr->rs_value.at_flags & ATR_VFLAG_INDIRECT))
+			continue;
+		if ((ps = add_resource_entry(sum, pr->rs_defin)) == NULL)
+			continue;
+		(void)pr->rs_defin->rs_set(&ps->rs_value, &pr->rs_value, INCR);
+	}
+}
+
+/**
+ * @brief
+ * 		summary_new - add an empty summary to an array of them
+ *
+ * @param[in,out]	psums	-	the array of summaries
+ * @param[in,out]	pnsums	-	number of entries in *psums
+ * @param[in]	name	-	name of the summary
+ * @param[in]	idx	-	if not NULL, index of name to array position
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+
+static int
+summary_new(struct node_summary **psums, int *pnsums, char *name, void *idx)
+{
+	struct node_summary *tmp;
+	struct node_summary *ns;
+
+	tmp = realloc(*psums, (*pnsums + 1) * sizeof(struct node_summary));
+	if (tmp == NULL)
+		return (PBSE_SYSTEM);
+	*psums = tmp;
+	ns = &tmp[*pnsums];
+	memset(ns, 0, sizeof(struct node_summary));
+	clear_attr(&ns->ns_avail, &node_attr_def[(int)ND_ATR_ResourceAvail]);
+	clear_attr(&ns->ns_assn, &node_attr_def[(int)ND_ATR_ResourceAssn]);
+	if ((ns->ns_name = strdup(name)) == NULL)
+		return (PBSE_SYSTEM);
+	(*pnsums)++;
+	if ((idx != NULL) && (pbs_idx_insert(idx, ns->ns_name, (void *)(long)(*pnsums - 1)) != PBS_IDX_RET_OK))
+		return (PBSE_SYSTEM);
+
+	return (0);
+}
+
+/**
+ * @brief
+ * 		summary_add_node - count a vnode in a summary
+ *
+ * @param[in,out]	ns	-	the summary
+ * @param[in]	pnode	-	the vnode
+ * @param[in]	state	-	the state of the vnode as it is reported
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+
+static int
+summary_add_node(struct node_summary *ns, struct pbsnode *pnode, unsigned long state)
+{
+	struct node_state_count *tmp;
+	int i;
+
+	ns->ns_vnodes++;
+
+	/* there are only ever a few distinct states */
+	for (i = 0; i < ns->ns_nstates; i++) {
+		if (ns->ns_states[i].nsc_state == state)
+			break;
+	}
+	if (i == ns->ns_nstates) {
+		tmp = realloc(ns->ns_states, (i + 1) * sizeof(struct node_state_count));
+		if (tmp == NULL)
+			return (PBSE_SYSTEM);
+		ns->ns_states = tmp;
+		ns->ns_states[i].nsc_state = state;
+		ns->ns_states[i].nsc_count = 0;
+		ns->ns_nstates++;
+	}
+	ns->ns_states[i].nsc_count++;
+
+	summary_add_resc(&ns->ns_avail, &pnode->nd_attr[(int)ND_ATR_ResourceAvail]);
+	summary_add_resc(&ns->ns_assn, &pnode->nd_attr[(int)ND_ATR_ResourceAssn]);
+
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_node_summary - Build the status reply for a summary
+ *
+ *		The status carries "vnodes", the number of vnodes, one
+ *		"state_count.<state>" per distinct state, and the summed numeric
+ *		resources_available and resources_assigned.
+ *
+ * @param[in]	ns	-	the summary
+ * @param[in]	preq	-	ptr to the decoded request
+ * @param[in,out]	pstathd	-	head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+
+static int
+status_node_summary(struct node_summary *ns, struct batch_request *preq, pbs_list_head *pstathd)
+{
+	struct brp_status *pstat;
+	attribute	   st;
+	svrattrl	  *pal;
+	svrattrl	  *pstate;
+	char		   buf[32];
+	int		   i;
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return (PBSE_SYSTEM);
+
+	pstat->brp_objtype = MGR_OBJ_NODE;
+	pbs_strncpy(pstat->brp_objname, ns->ns_name, sizeof(pstat->brp_objname));
+	CLEAR_LINK(pstat->brp_stlink);
+	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+	preq->rq_reply.brp_count++;
+
+	sprintf(buf, "%ld", ns->ns_vnodes);
+	if ((pal = attrlist_create(ATTR_NODE_summary_vnodes, NULL, strlen(buf) + 1)) == NULL)
+		return (PBSE_SYSTEM);
+	strcpy(pal->al_value, buf);
+	pal->al_flags = ATR_VFLAG_SET;
+	append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+	clear_attr(&st, &node_attr_def[(int)ND_ATR_state]);
+	st.at_flags = ATR_VFLAG_SET;
+	for (i = 0; i < ns->ns_nstates; i++) {
+		st.at_val.at_long = ns->ns_states[i].nsc_state;
+		pstate = NULL;
+		if (encode_state(&st, NULL, ATTR_NODE_state, NULL, ATR_ENCODE_CLIENT, &pstate) <= 0)
+			return (PBSE_SYSTEM);
+		sprintf(buf, "%ld", ns->ns_states[i].nsc_count);
+		pal = attrlist_create(ATTR_NODE_summary_state, pstate->al_value, strlen(buf) + 1);
+		free_svrattrl(pstate);
+		if (pal == NULL)
+			return (PBSE_SYSTEM);
+		strcpy(pal->al_value, buf);
+		pal->al_flags = ATR_VFLAG_SET;
+		append_link(&pstat->brp_attr, &pal->al_link, pal);
+	}
+
+	if (is_attr_set(&ns->ns_avail))
+		(void)node_attr_def[(int)ND_ATR_ResourceAvail].at_encode(&ns->ns_avail,
+			&pstat->brp_attr, ATTR_rescavail, NULL, ATR_ENCODE_CLIENT, NULL);
+	if (is_attr_set(&ns->ns_assn))
+		(void)node_attr_def[(int)ND_ATR_ResourceAssn].at_encode(&ns->ns_assn,
+			&pstat->brp_attr, ATTR_rescassn, NULL, ATR_ENCODE_CLIENT, NULL);
+
+	return (0);
+}
+
+/**
+ * @brief
+ * 		req_stat_node_summary - service a Status Node Request asking for a
+ *		summary of all the vnodes rather than the status of each one.
+ *
+ *		The first status reported is for all the vnodes and has an empty
+ *		name.  With by_host, it is followed by one status per host, named
+ *		by the host's resources_available.host, totalled over its vnodes.
+ *		This lets a client watch the occupancy of the complex without
+ *		fetching and adding up the status of every vnode.
+ *
+ * @param[in]	preq	-	ptr to the decoded request
+ * @param[in]	by_host	-	also report a summary per host
+ */
+
+static void
+req_stat_node_summary(struct batch_request *preq, int by_host)
+{
+	struct batch_reply  *preply = &preq->rq_reply;
+	struct node_summary *sums = NULL;
+	struct pbsnode	    *pnode;
+	resource	    *phost;
+	void		    *host_idx = NULL;
+	void		    *data;
+	char		    *host;
+	unsigned long	     state;
+	int		     nsums = 0;
+	int		     rc = 0;
+	int		     i;
+	int		     j;
+
+	if ((preq->rq_perm & ATR_DFLAG_RDACC) == 0) {
+		req_reject(PBSE_PERM, 0, preq);
+		return;
+	}
+	resc_access_perm = preq->rq_perm;
+
+	if (by_host && (host_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+
+	rc = summary_new(&sums, &nsums, "", NULL);
+
+	for (i = 0; (rc == 0) && (i < svr_totnodes); i++) {
+		pnode = pbsndlist[i];
+		if (pnode->nd_state & INUSE_DELETED)
+			continue;
+
+		/* as status_node() reports it, see there */
+		state = pnode->nd_state;
+		if (state & (INUSE_PROV | INUSE_WAIT_PROV))
+			state &= ~(INUSE_DOWN | INUSE_UNKNOWN | INUSE_JOB |
+				INUSE_JOBEXCL | INUSE_RESVEXCL);
+
+		if ((rc = summary_add_node(&sums[0], pnode, state)) != 0)
+			break;
+		if (!by_host)
+			continue;
+
+		phost = find_resc_entry(&pnode->nd_attr[(int)ND_ATR_ResourceAvail], &svr_resc_def[RESC_HOST]);
+		if ((phost != NULL) && is_attr_set(&phost->rs_value) && (phost->rs_value.at_val.at_str != NULL))
+			host = phost->rs_value.at_val.at_str;
+		else
+			host = pnode->nd_name;
+		if (pbs_idx_find(host_idx, (void **)&host, &data, NULL) == PBS_IDX_RET_OK)
+			j = (long)data;
+		else if ((rc = summary_new(&sums, &nsums, host, host_idx)) == 0)
+			j = nsums - 1;
+		else
+			break;
+		rc = summary_add_node(&sums[j], pnode, state);
+	}
+
+	preply->brp_choice = BATCH_REPLY_CHOICE_Status;
+	CLEAR_HEAD(preply->brp_un.brp_status);
+	preply->brp_count = 0;
+
+	for (j = 0; (rc == 0) && (j < nsums); j++) {
+		/* send what we have so far rather than hold every host */
+		if (preply->brp_count >= MAX_NODES_PER_REPLY) {
+			if (reply_send_status_part(preq) != PBSE_NONE) {
+				rc = -1;	/* request already disposed of */
+				break;
+			}
+		}
+		rc = status_node_summary(&sums[j], preq, &preply->brp_un.brp_status);
+	}
+
+	for (j = 0; j < nsums; j++) {
+		free(sums[j].ns_name);
+		free(sums[j].ns_states);
+		node_attr_def[(int)ND_ATR_ResourceAvail].at_free(&sums[j].ns_avail);
+		node_attr_def[(int)ND_ATR_ResourceAssn].at_free(&sums[j].ns_assn);
+	}
+	free(sums);
+	if (host_idx != NULL)
+		pbs_idx_destroy(host_idx);
+
+	if (rc == 0)
+		reply_send(preq);
+	else if (rc > 0)
+		req_reject(rc, 0, preq);
+}
+
+/**
+ * @brief
+ * 		status_digest - compute a digest of an encoded status so two
+ *		statuses can be compared without keeping the old one around.
+ *
+ * @param[in]	phead	-	head of the svrattrl list of the status
+ *
+ * @return	u_Long
+ * @retval	64 bit FNV-1a hash of the names, resources and values
+ */
+
+static u_Long
+status_digest(pbs_list_head *phead)
+{
+	u_Long hash = 14695981039346656037ULL;
+	svrattrl *pal;
+	const char *p;
+	int len;
+
+	for (pal = (svrattrl *)GET_NEXT(*phead); pal != NULL;
+		pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		for (p = pal->al_name; p != NULL && *p != '\0'; p++)
+			hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+		hash = (hash ^ '\t') * 1099511628211ULL;
+		for (p = pal->al_resc; p != NULL && *p != '\0'; p++)
+			hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+		hash = (hash ^ '\t') * 1099511628211ULL;
+		/* values may contain embedded nulls */
+		for (p = pal->al_value, len = 0; p != NULL && len < pal->al_valln; p++, len++)
+			hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+		hash = (hash ^ '\n') * 1099511628211ULL;
+	}
+
+	return (hash);
+}
+
 /**
  * @brief
  * 		status_node - Build the status reply for a single node.
  *
+ *		If the status is tracked, a digest of the status is kept on
+ *		the node for the requesting connection.  With NODE_STAT_CHANGED,
+ *		a node whose status is the same as the one last sent on the
+ *		connection is reported by name only.
+ *
  * @param[in,out]	pnode	-	ptr to node receiving status query
  * @param[in]	preq	-	ptr to the decoded request
  * @param[in,out]	pstathd	-	head of list to append status to
+ * @param[in]	track	-	NODE_STAT_FULL, NODE_STAT_CHANGED or NODE_STAT_RESYNC
  *
  * @return	int
  * @retval	0	: success
@@ -634,12 +1067,13 @@ req_stat_node(struct batch_request *preq)
  */
 
 static int
-status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *pstathd)
+status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *pstathd, int track)
 {
 	int		   rc = 0;
 	struct brp_status *pstat;
 	svrattrl	  *pal;
 	unsigned long		   old_nd_state = VNODE_UNAVAILABLE;
+	u_Long		   since = stat_since(preq);
 
 	if (pnode->nd_state & INUSE_DELETED)  /*node no longer valid*/
 		return  (0);
@@ -654,6 +1088,9 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 		pnode->nd_attr[(int)ND_ATR_state].at_flags |= ATR_MOD_MCACHE;
 	}
 
+	if (modseq_update(pnode->nd_attr, ND_ATR_LAST, &pnode->nd_modseq) <= since)
+		return (status_unchanged(MGR_OBJ_NODE, pnode->nd_name, preq, pstathd));
+
 	/*node is provisioning - mask out the DOWN/UNKNOWN flags while prov is on*/
 	if (pnode->nd_attr[(int)ND_ATR_state].at_val.at_long &
 		(INUSE_PROV | INUSE_WAIT_PROV)) {
@@ -675,6 +1112,7 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 	strcpy(pstat->brp_objname, pnode->nd_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 
 	/*add this new brp_status structure to the list hanging off*/
 	/*the request's reply substructure                         */
@@ -682,6 +1120,9 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
+	if (since != 0 && status_modseq(pnode->nd_modseq, &pstat->brp_attr) != 0)
+		return (PBSE_SYSTEM);
+
 	/*point to the list of node-attributes about which we want status*/
 	/*hang that status information from the brp_attr field for this  */
 	/*brp_status structure                                           */
@@ -690,10 +1131,24 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 
 	rc = status_nodeattrib(pal, pnode, ND_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad);
 
+	if (rc == 0 && track != NODE_STAT_FULL) {
+		u_Long digest;
+
+		digest = status_digest(&pstat->brp_attr);
+		if (track == NODE_STAT_CHANGED && pnode->nd_stat_conn == preq->rq_conn &&
+			pnode->nd_stat_digest == digest) {
+			free_attrlist(&pstat->brp_attr);
+			CLEAR_HEAD(pstat->brp_attr);
+		}
+		pnode->nd_stat_conn = preq->rq_conn;
+		pnode->nd_stat_digest = digest;
+	}
+
 	/*reverting back the state*/
 
 	if (pnode->nd_attr[(int)ND_ATR_state].at_val.at_long & INUSE_PROV)
 		pnode->nd_attr[(int)ND_ATR_state].at_val.at_long = old_nd_state ;
+	modseq_clear(pnode->nd_attr, ND_ATR_LAST);
 
 
 	return (rc);
@@ -746,6 +1201,7 @@ req_stat_svr(struct batch_request *preq)
 	struct batch_reply *preply;
 	struct brp_status *pstat;
 	conn_t *conn;
+	int rc;
 
 	/* update count and state counts from sv_numjobs and sv_jobstates */
 
@@ -785,15 +1241,42 @@ req_stat_svr(struct batch_request *preq)
 	strcpy(pstat->brp_objname, server_name);
 	pstat->brp_objtype = MGR_OBJ_SERVER;
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(&preply->brp_un.brp_status, &pstat->brp_stlink, pstat);
 	preply->brp_count++;
 
+	/* server_stats and server_memory are only filled in when asked */
+	/* for by name, they are long and "print server" output can be */
+	/* fed back to qmgr; server_memory walks every object */
+
+	for (pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr); pal;
+		pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if (strcmp(pal->al_name, ATTR_ServerStats) == 0) {
+			server.sv_attr[(int)SVR_ATR_ServerStats].at_val.at_str = svr_stats_as_string();
+			if (server.sv_attr[(int)SVR_ATR_ServerStats].at_val.at_str != NULL)
+				server.sv_attr[(int)SVR_ATR_ServerStats].at_flags |= ATR_SET_MOD_MCACHE;
+		} else if (strcmp(pal->al_name, ATTR_ServerMemory) == 0) {
+			server.sv_attr[(int)SVR_ATR_ServerMemory].at_val.at_str = svr_mem_as_string();
+			if (server.sv_attr[(int)SVR_ATR_ServerMemory].at_val.at_str != NULL)
+				server.sv_attr[(int)SVR_ATR_ServerMemory].at_flags |= ATR_SET_MOD_MCACHE;
+		}
+	}
+
 	/* add attributes to the status reply */
 
 	bad = 0;
 	pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
-	if (status_attrib(pal, svr_attr_idx, svr_attr_def, server.sv_attr, SVR_ATR_LAST,
-		preq->rq_perm, &pstat->brp_attr, &bad))
+	rc = status_attrib(pal, svr_attr_idx, svr_attr_def, server.sv_attr, SVR_ATR_LAST,
+		preq->rq_perm, &pstat->brp_attr, &bad);
+
+	/* the values are svr_stats_as_string()'s and svr_mem_as_string()'s */
+	/* static buffers */
+	server.sv_attr[(int)SVR_ATR_ServerStats].at_val.at_str = NULL;
+	mark_attr_not_set(&server.sv_attr[(int)SVR_ATR_ServerStats]);
+	server.sv_attr[(int)SVR_ATR_ServerMemory].at_val.at_str = NULL;
+	mark_attr_not_set(&server.sv_attr[(int)SVR_ATR_ServerMemory]);
+
+	if (rc)
 		reply_badattr(PBSE_NOATTR, bad, pal, preq);
 	else
 		reply_send(preq);
@@ -829,6 +1312,7 @@ status_sched(pbs_sched *psched, struct batch_request *preq, pbs_list_head *pstat
 
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -902,6 +1386,10 @@ req_stat_sched(struct batch_request *preq)
  * @param[in]	ct_array	-	number of jobs per state
  * @param[out]	buf	-	job string buffer
  *
+ * @par
+ *	The attribute is only marked modified when the counts changed, so the
+ *	cached encoding and the owner's modify_seq are kept otherwise.
+ *
  * @par MT-safe: No
  */
 
@@ -912,18 +1400,23 @@ update_state_ct(attribute *pattr, int *ct_array, char *buf)
 		"Running", "Exiting", "Expired", "Begun",
 		"Moved", "Finished" };
 	int  index;
+	char newbuf[150];	/* size of qu_jobstbuf and sv_jobstbuf */
 
-	buf[0] = '\0';
+	newbuf[0] = '\0';
 	for (index=0; index < (PBS_NUMJOBSTATE); index++) {
 		if ((index == JOB_STATE_EXPIRED) ||
 			(index == JOB_STATE_MOVED) ||
 			(index == JOB_STATE_FINISHED))
 			continue;	/* skip over Expired/Moved/Finished */
-		sprintf(buf+strlen(buf), "%s:%d ", statename[index],
+		sprintf(newbuf+strlen(newbuf), "%s:%d ", statename[index],
 			*(ct_array + index));
 	}
-	pattr->at_val.at_str = buf;
-	pattr->at_flags |= ATR_SET_MOD_MCACHE;
+	if (!(pattr->at_flags & ATR_VFLAG_SET) || pattr->at_val.at_str != buf ||
+		strcmp(buf, newbuf) != 0) {
+		strcpy(buf, newbuf);
+		pattr->at_val.at_str = buf;
+		pattr->at_flags |= ATR_SET_MOD_MCACHE;
+	}
 }
 
 /**
@@ -1032,6 +1525,7 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 {
 	struct brp_status *pstat;
 	svrattrl	  *pal;
+	u_Long		   since = stat_since(preq);
 
 	if ((preq->rq_perm & ATR_DFLAG_RDACC) == 0)
 		return (PBSE_PERM);
@@ -1040,6 +1534,9 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	 *"quick save" area of the resc_resv structure
 	 */
 
+	if (modseq_update(presv->ri_wattr, RESV_ATR_LAST, &presv->ri_modseq) <= since)
+		return (status_unchanged(MGR_OBJ_RESV, presv->ri_qs.ri_resvID, preq, pstathd));
+
 	/*now allocate status sub-structure and fill header portion*/
 
 	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
@@ -1050,18 +1547,23 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	strcpy(pstat->brp_objname, presv->ri_qs.ri_resvID);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
+	if (since != 0 && status_modseq(presv->ri_modseq, &pstat->brp_attr) != 0)
+		return (PBSE_SYSTEM);
+
 	/*finally, add the requested attributes to the status reply*/
 
 	bad = 0;	/*global: record ordinal position where got error*/
 	pal = (svrattrl *) GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 
 	if (status_attrib(pal, resv_attr_idx, resv_attr_def, presv->ri_wattr,
-		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) == 0)
+		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) == 0) {
+		modseq_clear(presv->ri_wattr, RESV_ATR_LAST);
 		return (0);
-	else
+	} else
 		return (PBSE_NOATTR);
 }
 
@@ -1103,6 +1605,7 @@ status_resc(struct resource_def *prd, struct batch_request *preq, pbs_list_head
 	strcpy(pstat->brp_objname, prd->rs_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 
 	/* add attributes to the status reply */
 	if (private) {
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	req_subscribe.c
+ *
+ * @brief
+ * 	req_subscribe.c - Functions relating to the Subscribe Batch Request
+ *	and to the events pushed to the subscribed clients.
+ *
+ *	A client subscribes a connection to job, vnode and/or reservation
+ *	state changes, optionally only for the jobs and reservations of one
+ *	owner or queue.  From then on, each state change is queued on the
+ *	matching subscribers and the queued events are pushed to each of them
+ *	as one status reply, once per pass of the main loop.  The connection
+ *	stays open until the client closes it.
+ *
+ * Included functions are:
+ *	req_subscribe()
+ *	svr_event_job()
+ *	svr_event_node()
+ *	svr_event_resv()
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libpbs.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "server.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "job.h"
+#include "reservation.h"
+#include "queue.h"
+#include "work_task.h"
+#include "pbs_error.h"
+#include "pbs_nodes.h"
+#include "svrfunc.h"
+#include "net_connect.h"
+#include "log.h"
+
+/* event classes a connection subscribed to */
+#define SUB_JOB		0x1
+#define SUB_NODE	0x2
+#define SUB_RESV	0x4
+
+/* events queued on a subscriber that does not keep up before it is dropped */
+#define SUB_MAX_PENDING	10000
+
+/* a connection subscribed to events */
+struct subscriber {
+	pbs_list_link	sb_link;
+	int		sb_conn;		/* the subscribed connection */
+	int		sb_events;		/* SUB_* classes */
+	int		sb_perm;		/* privilege of the subscriber */
+	char		sb_user[PBS_MAXUSER + 1]; /* user who subscribed */
+	char		*sb_owner;		/* only jobs/resvs of this euser */
+	char		*sb_queue;		/* only jobs/resvs in this queue */
+	int		sb_npending;		/* number of events queued */
+	pbs_list_head	sb_pending;		/* brp_status of the queued events */
+};
+
+extern struct server server;
+extern attribute_def job_attr_def[];
+extern attribute_def node_attr_def[];
+extern attribute_def resv_attr_def[];
+extern time_t time_now;
+
+static pbs_list_head svr_subscribers;
+static int subscribers_init = 0;
+static int subscribers_flush_set = 0;	/* work task to push events is set */
+
+/**
+ * @brief
+ * 		find_subscriber - find the subscription of a connection.
+ *
+ * @param[in]	sock	-	connection
+ *
+ * @return	struct subscriber *
+ * @retval	the subscription	: found
+ * @retval	NULL			: the connection did not subscribe
+ */
+static struct subscriber *
+find_subscriber(int sock)
+{
+	struct subscriber *psub;
+
+	if (!subscribers_init)
+		return NULL;
+	for (psub = (struct subscriber *)GET_NEXT(svr_subscribers);
+		psub != NULL; psub = (struct subscriber *)GET_NEXT(psub->sb_link)) {
+		if (psub->sb_conn == sock)
+			return psub;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		free_subscriber - unlink and free a subscription, with its queued
+ *		events.
+ *
+ * @param[in]	psub	-	the subscription
+ */
+static void
+free_subscriber(struct subscriber *psub)
+{
+	struct brp_status *pstat;
+
+	delete_link(&psub->sb_link);
+	while ((pstat = (struct brp_status *)GET_NEXT(psub->sb_pending)) != NULL) {
+		delete_link(&pstat->brp_stlink);
+		free_attrlist(&pstat->brp_attr);
+		free(pstat);
+	}
+	free(psub->sb_owner);
+	free(psub->sb_queue);
+	free(psub);
+}
+
+/**
+ * @brief
+ * 		subscriber_close - connection close function of a subscribed
+ *		connection, forgets the subscription.
+ *
+ * @param[in]	sock	-	the connection being closed
+ */
+static void
+subscriber_close(int sock)
+{
+	struct subscriber *psub;
+
+	if ((psub = find_subscriber(sock)) != NULL)
+		free_subscriber(psub);
+}
+
+/**
+ * @brief
+ * 		req_subscribe - service the Subscribe Request
+ *
+ *		rq_status.rq_id is the comma separated list of SUBSCRIBE_* event
+ *		classes, rq_status.rq_attr may hold an ATTR_euser and an
+ *		ATTR_queue the jobs and reservations must match.  A connection
+ *		subscribing again replaces its subscription.
+ *
+ * @param[in]	preq	-	ptr to the decoded request
+ */
+void
+req_subscribe(struct batch_request *preq)
+{
+	struct subscriber *psub;
+	svrattrl *pal;
+	conn_t *conn;
+	char *ids;
+	char *tok;
+	char *save = NULL;
+	int events = 0;
+
+	if ((preq->rq_perm & ATR_DFLAG_RDACC) == 0) {
+		req_reject(PBSE_PERM, 0, preq);
+		return;
+	}
+	if ((conn = get_conn(preq->rq_conn)) == NULL) {
+		req_reject(PBSE_IVALREQ, 0, preq);
+		return;
+	}
+
+	if ((ids = strdup(preq->rq_ind.rq_status.rq_id)) == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	for (tok = strtok_r(ids, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+		if (strcmp(tok, SUBSCRIBE_JOB) == 0)
+			events |= SUB_JOB;
+		else if (strcmp(tok, SUBSCRIBE_NODE) == 0)
+			events |= SUB_NODE;
+		else if (strcmp(tok, SUBSCRIBE_RESV) == 0)
+			events |= SUB_RESV;
+		else {
+			events = 0;
+			break;
+		}
+	}
+	free(ids);
+	if (events == 0) {
+		req_reject(PBSE_IVALREQ, 0, preq);
+		return;
+	}
+
+	if ((psub = calloc(1, sizeof(struct subscriber))) == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	CLEAR_LINK(psub->sb_link);
+	CLEAR_HEAD(psub->sb_pending);
+	psub->sb_conn = preq->rq_conn;
+	psub->sb_events = events;
+	psub->sb_perm = preq->rq_perm;
+	strcpy(psub->sb_user, preq->rq_user);
+
+	for (pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
+		pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if (strcmp(pal->al_name, ATTR_euser) == 0 && psub->sb_owner == NULL)
+			psub->sb_owner = strdup(pal->al_value);
+		else if (strcmp(pal->al_name, ATTR_queue) == 0 && psub->sb_queue == NULL)
+			psub->sb_queue = strdup(pal->al_value);
+		else {
+			free(psub->sb_owner);
+			free(psub->sb_queue);
+			free(psub);
+			req_reject(PBSE_NOATTR, 0, preq);
+			return;
+		}
+	}
+
+	if (!subscribers_init) {
+		CLEAR_HEAD(svr_subscribers);
+		subscribers_init = 1;
+	}
+	subscriber_close(preq->rq_conn);
+	append_link(&svr_subscribers, &psub->sb_link, psub);
+
+	/* the connection now waits for events, never time it out */
+	conn->cn_authen |= PBS_NET_CONN_NOTIMEOUT;
+	net_add_close_func(preq->rq_conn, subscriber_close);
+
+	log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_INFO, __func__,
+		"%s@%s subscribed to %s", preq->rq_user, preq->rq_host,
+		preq->rq_ind.rq_status.rq_id);
+	reply_ack(preq);
+}
+
+/**
+ * @brief
+ * 		push_events - work task pushing the queued events to each
+ *		subscriber, as one status reply per subscriber.  A subscriber
+ *		the reply cannot be written to is closed.
+ *
+ * @param[in]	ptask	-	work task
+ */
+static void
+push_events(struct work_task *ptask)
+{
+	struct subscriber *psub;
+	struct subscriber *pnext;
+	struct batch_reply reply;
+	struct brp_status *pstat;
+	int sock;
+
+	subscribers_flush_set = 0;
+	for (psub = (struct subscriber *)GET_NEXT(svr_subscribers); psub != NULL; psub = pnext) {
+		pnext = (struct subscriber *)GET_NEXT(psub->sb_link);
+		if (psub->sb_npending == 0)
+			continue;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.brp_code = PBSE_NONE;
+		reply.brp_choice = BATCH_REPLY_CHOICE_Status;
+		CLEAR_HEAD(reply.brp_un.brp_status);
+		while ((pstat = (struct brp_status *)GET_NEXT(psub->sb_pending)) != NULL) {
+			delete_link(&pstat->brp_stlink);
+			append_link(&reply.brp_un.brp_status, &pstat->brp_stlink, pstat);
+		}
+		reply.brp_count = psub->sb_npending;
+		psub->sb_npending = 0;
+
+		sock = psub->sb_conn;
+		if (reply_write_tcp(sock, &reply) != 0) {
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_WARNING, __func__,
+				"could not push events to subscriber %s, closing its connection",
+				psub->sb_user);
+			close_client(sock);	/* frees psub */
+		}
+		reply_free(&reply);
+	}
+}
+
+/**
+ * @brief
+ * 		queue_event - queue an event on every subscriber it is for, with
+ *		the current value of the given attributes of the object.
+ *
+ * @param[in]	class	-	SUB_* class of the event
+ * @param[in]	objtype	-	MGR_OBJ_* type of the object
+ * @param[in]	name	-	object name
+ * @param[in]	euser	-	owner of a job or reservation, else NULL
+ * @param[in]	queue	-	queue of a job or reservation, else NULL
+ * @param[in]	pattr	-	the object's attributes
+ * @param[in]	pdef	-	the object's attribute definitions
+ * @param[in]	idx	-	attributes sent with the event
+ * @param[in]	nidx	-	number of entries in idx
+ */
+static void
+queue_event(int class, int objtype, char *name, char *euser, char *queue,
+	attribute *pattr, attribute_def *pdef, int *idx, int nidx)
+{
+	struct subscriber *psub;
+	struct subscriber *pnext;
+	struct brp_status *pstat;
+	svrattrl *pal;
+	char buf[32];
+	int i;
+	int priv;
+
+	for (psub = (struct subscriber *)GET_NEXT(svr_subscribers); psub != NULL; psub = pnext) {
+		pnext = (struct subscriber *)GET_NEXT(psub->sb_link);
+		if ((psub->sb_events & class) == 0)
+			continue;
+		if (psub->sb_owner != NULL && (euser == NULL || strcmp(euser, psub->sb_owner) != 0))
+			continue;
+		if (psub->sb_queue != NULL && (queue == NULL || strcmp(queue, psub->sb_queue) != 0))
+			continue;
+		priv = psub->sb_perm & (ATR_DFLAG_MGRD | ATR_DFLAG_OPRD);
+		if (class != SUB_NODE && !priv &&
+			!server.sv_attr[(int)SVR_ATR_query_others].at_val.at_long &&
+			(euser == NULL || strcmp(euser, psub->sb_user) != 0))
+			continue;
+
+		if (psub->sb_npending >= SUB_MAX_PENDING) {
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_WARNING, __func__,
+				"subscriber %s has %d events queued, closing its connection",
+				psub->sb_user, psub->sb_npending);
+			close_client(psub->sb_conn);	/* frees psub */
+			continue;
+		}
+
+		if ((pstat = malloc(sizeof(struct brp_status))) == NULL) {
+			log_err(errno, __func__, "no memory for an event");
+			return;
+		}
+		CLEAR_LINK(pstat->brp_stlink);
+		pstat->brp_objtype = objtype;
+		snprintf(pstat->brp_objname, sizeof(pstat->brp_objname), "%s", name);
+		CLEAR_HEAD(pstat->brp_attr);
+		pstat->brp_enc = NULL;
+
+		for (i = 0; i < nidx; i++) {
+			if (is_attr_set(&pattr[idx[i]]))
+				(void)pdef[idx[i]].at_encode(&pattr[idx[i]], &pstat->brp_attr,
+					pdef[idx[i]].at_name, NULL, ATR_ENCODE_CLIENT, NULL);
+		}
+		snprintf(buf, sizeof(buf), "%ld", (long)time_now);
+		if ((pal = attrlist_create(ATTR_event_time, NULL, strlen(buf) + 1)) != NULL) {
+			strcpy(pal->al_value, buf);
+			append_link(&pstat->brp_attr, &pal->al_link, pal);
+		}
+
+		append_link(&psub->sb_pending, &pstat->brp_stlink, pstat);
+		psub->sb_npending++;
+	}
+
+	if (!subscribers_flush_set && set_task(WORK_Immed, 0, push_events, NULL) != NULL)
+		subscribers_flush_set = 1;
+}
+
+/**
+ * @brief
+ * 		svr_event_job - tell the subscribers a job changed state.
+ *
+ * @param[in]	pjob	-	the job, with its new state set
+ */
+void
+svr_event_job(job *pjob)
+{
+	static int idx[] = { JOB_ATR_state, JOB_ATR_substate, JOB_ATR_in_queue };
+
+	if (!subscribers_init || GET_NEXT(svr_subscribers) == NULL)
+		return;
+	queue_event(SUB_JOB, MGR_OBJ_JOB, pjob->ji_qs.ji_jobid,
+		is_jattr_set(pjob, JOB_ATR_euser) ? get_jattr_str(pjob, JOB_ATR_euser) : NULL,
+		pjob->ji_qs.ji_queue, pjob->ji_wattr, job_attr_def, idx,
+		sizeof(idx) / sizeof(idx[0]));
+}
+
+/**
+ * @brief
+ * 		svr_event_node - tell the subscribers a vnode changed state.
+ *
+ * @param[in]	pnode	-	the vnode, with its state attribute in sync
+ */
+void
+svr_event_node(struct pbsnode *pnode)
+{
+	static int idx[] = { ND_ATR_state };
+
+	if (!subscribers_init || GET_NEXT(svr_subscribers) == NULL)
+		return;
+	queue_event(SUB_NODE, MGR_OBJ_NODE, pnode->nd_name, NULL, NULL,
+		pnode->nd_attr, node_attr_def, idx, sizeof(idx) / sizeof(idx[0]));
+}
+
+/**
+ * @brief
+ * 		svr_event_resv - tell the subscribers a reservation changed state.
+ *
+ * @param[in]	presv	-	the reservation, with its new state set
+ */
+void
+svr_event_resv(resc_resv *presv)
+{
+	static int idx[] = { RESV_ATR_state, RESV_ATR_substate, RESV_ATR_queue };
+	attribute *pattr = presv->ri_wattr;
+
+	if (!subscribers_init || GET_NEXT(svr_subscribers) == NULL)
+		return;
+	queue_event(SUB_RESV, MGR_OBJ_RESV, presv->ri_qs.ri_resvID,
+		is_attr_set(&pattr[RESV_ATR_euser]) ? pattr[RESV_ATR_euser].at_val.at_str : NULL,
+		is_attr_set(&pattr[RESV_ATR_queue]) ? pattr[RESV_ATR_queue].at_val.at_str : NULL,
+		pattr, resv_attr_def, idx, sizeof(idx) / sizeof(idx[0]));
+}
@@ -816,7 +816,7 @@ int zero_or_positive_action(resource *presc, attribute *pattr, void *pobj, int t
  *      It applies rules to validate all individual resources in all the chunks.
  *
  * @par Functionality:
- *      1. Parses select specification by calling parse_chunk function.
+ *      1. Gets the parsed select specification from get_parsed_select().
  *      2. Decodes each chunk
  *      3. Calls resource action function for each resource in a chunk if
  *	   the resource is of type long.
@@ -837,46 +837,37 @@ int zero_or_positive_action(resource *presc, attribute *pattr, void *pobj, int t
  */
 int apply_select_inchunk_rules(resource *presc, attribute *pattr, void *pobj, int type, int actmode)
 {
-	char        *chunk;
-	int          nchk;
-	int          nelem;
-	struct       key_value_pair *pkvp;
+	int          k;
 	int          rc = 0;
 	int          j;
 	struct       resource     tmp_resc;
 	char         *select_str = NULL;
+	parsed_select *ps;
 
 	select_str = presc->rs_value.at_val.at_str;
 	if ((select_str == NULL) || (select_str[0] == '\0'))
 		return PBSE_BADATVAL;
-	chunk = parse_plus_spec(select_str, &rc); /* break '+' seperated substrings */
-	if (rc != 0)
-		return (rc);
-	while (chunk) {
-#ifdef NAS
-		if (parse_chunk(chunk, 0, &nchk, &nelem, &pkvp, NULL) == 0)
-#else
-		if (parse_chunk(chunk, &nchk, &nelem, &pkvp, NULL) == 0)
-#endif
-		{
-			for (j = 0; j < nelem; ++j) {
-			    	tmp_resc.rs_defin = find_resc_def(svr_resc_def, pkvp[j].kv_keyw);
-				if ((tmp_resc.rs_defin != NULL) && (tmp_resc.rs_defin->rs_type == ATR_TYPE_LONG)) {
-					tmp_resc.rs_value.at_val.at_long = atol(pkvp[j].kv_val);
-					if (tmp_resc.rs_defin->rs_action) {
-						if ((rc=tmp_resc.rs_defin->rs_action(&tmp_resc, pattr, pobj,
-							type, actmode))!=0)
-							return (rc);
-					}
+	if ((ps = get_parsed_select(select_str)) == NULL)
+		return PBSE_SYSTEM;
+	for (k = 0; k < ps->ps_nchunks; k++) {
+		sel_chunk *sc = &ps->ps_chunks[k];
+
+		if (sc->sc_rc != 0)
+			return PBSE_BADATVAL;
+		for (j = 0; j < sc->sc_nelem; ++j) {
+			tmp_resc.rs_defin = find_resc_def(svr_resc_def, sc->sc_kv[j].kv_keyw);
+			if ((tmp_resc.rs_defin != NULL) && (tmp_resc.rs_defin->rs_type == ATR_TYPE_LONG)) {
+				tmp_resc.rs_value.at_val.at_long = atol(sc->sc_kv[j].kv_val);
+				if (tmp_resc.rs_defin->rs_action) {
+					if ((rc=tmp_resc.rs_defin->rs_action(&tmp_resc, pattr, pobj,
+						type, actmode))!=0)
+						return (rc);
 				}
 			}
-		} else {
-			return PBSE_BADATVAL;
 		}
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return (rc);
-	} /* while */
+	}
+	if (ps->ps_rc != 0)
+		return (ps->ps_rc);
 	return PBSE_NONE;
 }
 /**
@@ -41,6 +41,7 @@
 #include "libpbs.h"
 #include "server.h"
 #include "svrfunc.h"
+#include "pbs_nodes.h"
 
 /* Global Data */
 
@@ -49,22 +50,14 @@ extern char server_name[];
 extern char *msg_sched_called;
 extern pbs_list_head svr_deferred_req;
 
-int scheduler_jobs_stat = 0; /* set to 1 once scheduler queried jobs in a cycle*/
 extern int svr_unsent_qrun_req;
 
-/**
- * @brief
- * 		am_jobs - array of pointers to jobs which were moved or which had certain
- * 		attributes altered (qalter) while a schedule cycle was in progress.
- *		If a job in the array is run by the scheduler in the cycle, that run
- *		request is rejected as the move/modification may impact the job's
- *		requirements and placement.
+/*
+ * Generation of the set of schedulers, bumped when a scheduler is added
+ * or freed.  A scheduler cached on a queue or vnode is trusted only if it
+ * was found in the current generation.
  */
-static struct am_jobs {
-	int am_used;	/* number of jobs in the array  */
-	int am_max;	/* number of slots in the array */
-	job **am_array; /* pointer the malloc-ed array  */
-} am_jobs = {0, 0, NULL};
+static long sched_gen = 1;
 
 /**
  * @brief
@@ -111,6 +104,55 @@ err:
 	return 0;
 }
 
+/**
+ * @brief
+ * 		partition_sched - find the scheduler of a partition attribute of a
+ * 		queue or vnode.  An unset partition, or the default one, belongs to
+ * 		the default scheduler.
+ *
+ * @par
+ * 		The scheduler found is cached on the object.  It is used again as
+ * 		long as no scheduler was added or freed since and its partition still
+ * 		is the object's, so a partition changed on either side is noticed
+ * 		without searching all the schedulers each time.
+ *
+ * @param[in]	part	- the partition attribute
+ * @param[in,out]	cache	- the scheduler cached on the object
+ * @param[in,out]	cache_gen	- generation of the schedulers *cache was found in
+ *
+ * @return	pbs_sched *
+ * @retval	the scheduler
+ * @retval	NULL if no scheduler has the partition
+ */
+static pbs_sched *
+partition_sched(attribute *part, pbs_sched **cache, long *cache_gen)
+{
+	pbs_sched *psched;
+	attribute *part_attr;
+
+	if (!is_attr_set(part) || strcmp(part->at_val.at_str, DEFAULT_PARTITION) == 0)
+		return dflt_scheduler;
+
+	if (*cache != NULL && *cache_gen == sched_gen) {
+		part_attr = &((*cache)->sch_attr[SCHED_ATR_partition]);
+		if (is_attr_set(part_attr) && !strcmp(part_attr->at_val.at_str, part->at_val.at_str))
+			return *cache;
+	}
+
+	*cache = NULL;
+	for (psched = (pbs_sched*) GET_NEXT(svr_allscheds); psched; psched = (pbs_sched*) GET_NEXT(psched->sc_link)) {
+		part_attr = &(psched->sch_attr[SCHED_ATR_partition]);
+		if (is_attr_set(part_attr)) {
+			if (!strcmp(part_attr->at_val.at_str, part->at_val.at_str)) {
+				*cache = psched;
+				*cache_gen = sched_gen;
+				return psched;
+			}
+		}
+	}
+	return NULL;
+}
+
 /**
  * @brief
  * 		find_assoc_sched_jid - find the corresponding scheduler which is responsible
@@ -156,33 +198,43 @@ find_assoc_sched_jid(char *jid, pbs_sched **target_sched)
 int
 find_assoc_sched_pque(pbs_queue *pq, pbs_sched **target_sched)
 {
-	pbs_sched *psched;
-
 	*target_sched = NULL;
 	if (pq == NULL)
 		return 0;
 
-	if (pq->qu_attr[QA_ATR_partition].at_flags & ATR_VFLAG_SET) {
-		attribute *part_attr;
-		if (strcmp(pq->qu_attr[QA_ATR_partition].at_val.at_str, DEFAULT_PARTITION) == 0) {
-			*target_sched = dflt_scheduler;
-			return 1;
-		}
-		for (psched = (pbs_sched*) GET_NEXT(svr_allscheds); psched; psched = (pbs_sched*) GET_NEXT(psched->sc_link)) {
-			part_attr = &(psched->sch_attr[SCHED_ATR_partition]);
-			if (is_attr_set(part_attr)) {
-				if(!strcmp(part_attr->at_val.at_str, pq->qu_attr[QA_ATR_partition].at_val.at_str)) {
-					*target_sched = psched;
-					return 1;
-				}
-			}
-		}
-	} else {
-		*target_sched = dflt_scheduler;
-		return 1;
-	}
-	return 0;
+	*target_sched = partition_sched(&pq->qu_attr[QA_ATR_partition], &pq->qu_sched, &pq->qu_sched_gen);
+	return (*target_sched != NULL);
+}
 
+/**
+ * @brief
+ * 		find_assoc_sched_pnode - find the scheduler whose partition the
+ * 		vnode is in.
+ *
+ * @param[in]	pnode	- pointer to the vnode
+ *
+ * @return	pbs_sched *
+ * @retval	the scheduler
+ * @retval	NULL if no scheduler has the vnode's partition
+ */
+pbs_sched *
+find_assoc_sched_pnode(struct pbsnode *pnode)
+{
+	if (pnode == NULL)
+		return NULL;
+
+	return partition_sched(&pnode->nd_attr[ND_ATR_partition], &pnode->nd_sched, &pnode->nd_sched_gen);
+}
+
+/**
+ * @brief
+ * 		sched_partitions_changed - forget the schedulers cached on queues
+ * 		and vnodes, called when a scheduler is added or freed.
+ */
+void
+sched_partitions_changed(void)
+{
+	sched_gen++;
 }
 
 /**
@@ -263,9 +315,9 @@ recv_sched_cycle_end(int sock)
 	set_sched_state(psched, state);
 
 	/* clear list of jobs which were altered/modified during cycle */
-	am_jobs.am_used = 0;
-	scheduler_jobs_stat = 0;
-	handle_deferred_cycle_close();
+	psched->sc_am_used = 0;
+	psched->sc_jobs_stat = 0;
+	handle_deferred_cycle_close(psched);
 
 	if (rc == DIS_EOF)
 		rc = -1;
@@ -338,7 +390,11 @@ schedule_jobs(pbs_sched *psched)
 		/* which haven't been sent,  they take priority      */
 		pdefr = (struct deferred_request *)GET_NEXT(svr_deferred_req);
 		while (pdefr) {
-			if (pdefr->dr_sent == 0) {
+			pbs_sched *target_sched;
+
+			/* a qrun of a job in another partition waits for its own scheduler */
+			if (pdefr->dr_sent == 0 &&
+				find_assoc_sched_jid(pdefr->dr_id, &target_sched) && target_sched == psched) {
 				s = is_job_array(pdefr->dr_id);
 				if (s == IS_ARRAY_NO) {
 					if (find_job(pdefr->dr_id) != NULL) {
@@ -361,8 +417,10 @@ schedule_jobs(pbs_sched *psched)
 		if (!send_sched_cmd(psched, cmd, jid)) {
 			set_sched_state(psched, SC_DOWN);
 			return -1;
-		} else if (pdefr != NULL)
+		} else if (pdefr != NULL) {
 			pdefr->dr_sent = 1;   /* mark entry as sent to sched */
+			pdefr->dr_sched = psched;
+		}
 
 		psched->svr_do_schedule = SCH_SCHEDULE_NULL;
 		set_sched_state(psched, SC_SCHEDULING);
@@ -375,7 +433,7 @@ schedule_jobs(pbs_sched *psched)
 		while (pdefr) {
 			if (pdefr->dr_sent == 0) {
 				pbs_sched *target_sched;
-				if (find_assoc_sched_jid(pdefr->dr_preq->rq_ind.rq_queuejob.rq_jid, &target_sched))
+				if (find_assoc_sched_jid(pdefr->dr_id, &target_sched))
 					target_sched->svr_do_schedule = SCH_SCHEDULE_AJOB;
 				break;
 			}
@@ -388,6 +446,35 @@ schedule_jobs(pbs_sched *psched)
 
 }
 
+/**
+ * @brief
+ * 		has_unsent_qrun - is there a deferred run request (qrun) which was not
+ * 		sent to its scheduler yet
+ *
+ * @param[in]	psched	- the scheduler, NULL for any scheduler
+ *
+ * @return	int
+ * @retval	1	: there is one
+ * @retval	0	: there is none
+ */
+int
+has_unsent_qrun(pbs_sched *psched)
+{
+	struct deferred_request *pdefr;
+	pbs_sched *target_sched;
+
+	for (pdefr = (struct deferred_request *)GET_NEXT(svr_deferred_req); pdefr;
+		pdefr = (struct deferred_request *)GET_NEXT(pdefr->dr_link)) {
+		if (pdefr->dr_sent != 0)
+			continue;
+		if (psched == NULL)
+			return 1;
+		if (find_assoc_sched_jid(pdefr->dr_id, &target_sched) && target_sched == psched)
+			return 1;
+	}
+	return 0;
+}
+
 /**
  * @brief
  * 		scheduler_close - connection to scheduler has closed, clear scheduler_called
@@ -431,38 +518,136 @@ scheduler_close(int sock)
 	set_sched_state(psched, SC_DOWN);
 
 	/* clear list of jobs which were altered/modified during cycle */
-	am_jobs.am_used = 0;
-	scheduler_jobs_stat = 0;
+	psched->sc_am_used = 0;
+	psched->sc_jobs_stat = 0;
 
-	handle_deferred_cycle_close();
+	drop_held_replies(psched);
+	handle_deferred_cycle_close(psched);
 }
 
 /**
  * @brief
- * 		Add a job to the am_jobs array, called when a job is moved (locally)
- *		or modified (qalter) during a scheduling cycle
+ * 		Keep the reply to a request from the primary connection of a
+ *		scheduler in the order of the scheduler's requests.
+ *
+ * @par
+ *		The scheduler sends its run requests without waiting for each
+ *		reply and reads the replies back in the order it sent the requests.
+ *		A run request is answered once the job reached Mom, by which time
+ *		later requests may already be answered.  Such a run request is put
+ *		on sc_replyq, and so is every request which follows while the queue
+ *		is not empty.  reply_send() holds back a reply which is not at the
+ *		head of the queue and release_held_replies() sends it once the
+ *		earlier ones are gone.
+ *
+ * @param[in]	preq	- request being served
+ * @param[in]	always	- queue the request even if nothing is held yet
  *
- * @param[in]	pjob	-	pointer to job to add to the array.
+ * @return	void
+ */
+void
+hold_sched_reply(struct batch_request *preq, int always)
+{
+	pbs_sched *psched;
+
+	/* a subjob's request is answered through its parent */
+	if (preq->rq_held || preq->rq_parentbr || preq->prot != PROT_TCP)
+		return;
+	if ((psched = find_sched_from_sock(preq->rq_conn, CONN_SCHED_PRIMARY)) == NULL)
+		return;
+	if (!always && GET_NEXT(psched->sc_replyq) == NULL)
+		return;
+
+	preq->rq_held = RQ_HELD_WAIT;
+	append_link(&psched->sc_replyq, &preq->rq_heldlink, preq);
+}
+
+/**
+ * @brief
+ * 		Send the replies which waited behind the request just removed from
+ *		the head of the reply queue of the scheduler on this connection.
+ *
+ * @param[in]	sock	- connection of the removed request
+ *
+ * @return	void
+ */
+void
+release_held_replies(int sock)
+{
+	pbs_sched *psched;
+	struct batch_request *preq;
+
+	if ((psched = find_sched_from_sock(sock, CONN_SCHED_PRIMARY)) == NULL)
+		return;
+
+	/* reply_send() frees the request, which in turn releases the next one */
+	preq = (struct batch_request *) GET_NEXT(psched->sc_replyq);
+	if (preq && preq->rq_held == RQ_HELD_READY)
+		(void) reply_send(preq);
+}
+
+/**
+ * @brief
+ * 		Empty the reply queue of a scheduler whose connection is gone.
+ *		Replies already built are dropped, requests still being served
+ *		are left to reply to the closed connection as before.
+ *
+ * @param[in]	psched	- scheduler
+ *
+ * @return	void
+ */
+void
+drop_held_replies(pbs_sched *psched)
+{
+	struct batch_request *preq;
+	int ready;
+
+	while ((preq = (struct batch_request *) GET_NEXT(psched->sc_replyq)) != NULL) {
+		ready = (preq->rq_held == RQ_HELD_READY);
+		delete_link(&preq->rq_heldlink);
+		preq->rq_held = 0;
+		if (ready)
+			free_br(preq);
+	}
+}
+
+/**
+ * @brief
+ * 		Add a job to the list of jobs which were moved (locally) or which had
+ *		certain attributes altered (qalter) of each scheduler whose cycle is in
+ *		progress and has queried the jobs.  If a job in the list is run by that
+ *		scheduler in the cycle, the run request is rejected as the
+ *		move/modification may impact the job's requirements and placement.
+ *
+ * @param[in]	pjob	-	pointer to job to add to the lists.
  */
 void
 am_jobs_add(job *pjob)
 {
-	if (am_jobs.am_used == am_jobs.am_max) {
-		/* Need to expand the array, increase by 4 slots */
-		job **tmp = realloc(am_jobs.am_array, sizeof(job *) * (am_jobs.am_max + 4));
-		if (tmp == NULL)
-			return;	/* cannot increase array, so be it */
-		am_jobs.am_array = tmp;
-		am_jobs.am_max  += 4;
+	pbs_sched *psched;
+
+	for (psched = (pbs_sched *) GET_NEXT(svr_allscheds); psched; psched = (pbs_sched *) GET_NEXT(psched->sc_link)) {
+		if (!psched->sc_jobs_stat)
+			continue;
+		if (psched->sc_am_used == psched->sc_am_max) {
+			/* Need to expand the array, increase by 4 slots */
+			job **tmp = realloc(psched->sc_am_jobs, sizeof(job *) * (psched->sc_am_max + 4));
+			if (tmp == NULL)
+				continue;	/* cannot increase array, so be it */
+			psched->sc_am_jobs = tmp;
+			psched->sc_am_max  += 4;
+		}
+		psched->sc_am_jobs[psched->sc_am_used++] = pjob;
 	}
-	*(am_jobs.am_array + am_jobs.am_used++) = pjob;
 }
 
 /**
  * @brief
  * 		Determine if the job in question is in the list of moved/altered
- *		jobs.  Called when a run request for a job comes from the Scheduler.
+ *		jobs of a scheduler.  Called when a run request for a job comes from
+ *		the Scheduler.
  *
+ * @param[in]	psched	-	the scheduler in whose cycle the job is run
  * @param[in]	pjob	-	pointer to job in question.
  *
  * @return	int
@@ -470,11 +655,11 @@ am_jobs_add(job *pjob)
  * @retval	1	- job is in list
  */
 int
-was_job_alteredmoved(job *pjob)
+was_job_alteredmoved(pbs_sched *psched, job *pjob)
 {
 	int i;
-	for (i=0; i<am_jobs.am_used; ++i) {
-		if (*(am_jobs.am_array+i) == pjob)
+	for (i=0; i<psched->sc_am_used; ++i) {
+		if (psched->sc_am_jobs[i] == pjob)
 			return 1;
 	}
 	return 0;
@@ -524,18 +709,21 @@ set_scheduler_flag(int flag, pbs_sched *psched)
  * @brief
  * 	Handles deferred requests during scheduling cycle closure
  *
+ * @param[in]	psched	- the scheduler whose cycle closed
+ *
  * @return void
  */
 void
-handle_deferred_cycle_close(void)
+handle_deferred_cycle_close(pbs_sched *psched)
 {
 	struct deferred_request *pdefr;
 
 	/*
-	 * If a deferred (from qrun) had been sent to the Scheduler and is still
+	 * If a deferred (from qrun) had been sent to this Scheduler and is still
 	 * there, then the Scheduler must have closed the connection without
 	 * dealing with the job. Tell qrun it failed if the qrun connection
-	 * is still there.
+	 * is still there.  Those sent to other Schedulers are still in the
+	 * hands of their cycles.
 	 *
 	 * If any qrun request is pending in the deffered list, set svr_unsent_qrun_req so
 	 * they are sent when the Scheduler completes this cycle
@@ -545,7 +733,7 @@ handle_deferred_cycle_close(void)
 	while (pdefr) {
 		struct deferred_request *next_pdefr = (struct deferred_request *) GET_NEXT(pdefr->dr_link);
 
-		if (pdefr->dr_sent != 0) {
+		if (pdefr->dr_sent != 0 && pdefr->dr_sched == psched) {
 			log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_NOTICE, pdefr->dr_id, "deferred qrun request to scheduler failed");
 			if (pdefr->dr_preq != NULL)
 				req_reject(PBSE_INTERNAL, 0, pdefr->dr_preq);
@@ -416,6 +416,7 @@ sched_alloc(char *sched_name)
 	}
 
 	CLEAR_LINK(psched->sc_link);
+	CLEAR_HEAD(psched->sc_replyq);
 	strncpy(psched->sc_name, sched_name, PBS_MAXSCHEDNAME);
 	psched->sc_name[PBS_MAXSCHEDNAME] = '\0';
 	psched->svr_do_schedule = SCH_SCHEDULE_NULL;
@@ -424,6 +425,7 @@ sched_alloc(char *sched_name)
 	psched->sc_secondary_conn = -1;
 	psched->newobj = 1;
 	append_link(&svr_allscheds, &psched->sc_link, psched);
+	sched_partitions_changed();
 	psched->sc_conn_addr = get_hostaddr(psched->sc_name);
 
 	/* set the working attributes to "unspecified" */
@@ -508,7 +510,10 @@ sched_free(pbs_sched *psched)
 	}
 
 	/* now free the main structure */
+	drop_held_replies(psched);
 	delete_link(&psched->sc_link);
+	sched_partitions_changed();
+	free(psched->sc_am_jobs);
 	(void) free(psched);
 }
 
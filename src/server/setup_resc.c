@@ -64,6 +64,10 @@
 #include "pbs_sched.h"
 
 extern char *msg_daemonname;
+
+/* next resc_lookup slot for a custom resource, never reused */
+static int resc_custom_next = RESC_LAST;
+
 #ifndef PBS_MOM
 extern struct python_interpreter_data  svr_interp_data;
 
@@ -351,12 +355,13 @@ expand_resc_array(char *rname, int rtype, int rflag)
 	pnew->rs_free   = p_resc_type_map->rtm_free;
 	pnew->rs_action = NULL_FUNC_RESC;
 	pnew->rs_custom = 1; /*  built-in resources are loaded from XML defn and initialized to 0 */
+	pnew->rs_index = resc_custom_next++;
 	pnew->rs_flags = rflag;
 	pnew->rs_type  = rtype;
 	pnew->rs_entlimflg = 0;
 	pnew->rs_next  = NULL;
 
-	if (pbs_idx_insert(resc_attrdef_idx, pnew->rs_name, pnew) != PBS_IDX_RET_OK) {
+	if (def_hash_insert(resc_attrdef_idx, pnew->rs_name, pnew) != 0) {
 		free(pnew->rs_name);
 		free(pnew);
 		return (-1);
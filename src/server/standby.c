@@ -0,0 +1,428 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	standby.c
+ *
+ * @brief
+ * 	Job replica kept by an idle Secondary Server when PBS_HOT_STANDBY is set.
+ *
+ *	While the Primary is up, the Secondary periodically reads the jobs
+ *	saved since its last pass from the data service and keeps their
+ *	database rows in memory.  At takeover only the rows saved since the
+ *	last pass and the list of job ids still in the table are read, instead
+ *	of every job with all of its attributes.
+ *
+ *	Included public functions are:
+ *
+ *	standby_refresh
+ *	standby_recover_jobs
+ *	standby_free
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "libpbs.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "job.h"
+#include "reservation.h"
+#include "queue.h"
+#include "server.h"
+#include "log.h"
+#include "pbs_nodes.h"
+#include "pbs_db.h"
+#include "pbs_idx.h"
+#include "svrfunc.h"
+
+/* seconds between two refreshes of the replica */
+#define STANDBY_REFRESH_TIME	30
+/* rows saved this long before a pass are read again, covers clock skew */
+#define STANDBY_SKEW		60
+
+struct standby_job {
+	pbs_db_job_info_t dbjob;	/* the job's row, owns its attributes */
+	int live;			/* row still in the table at takeover */
+};
+
+extern char *msg_daemonname;
+
+static void *standby_idx = NULL;	/* jobid -> struct standby_job */
+static void *standby_conn = NULL;	/* connection used while Secondary */
+static time_t standby_since = 0;	/* rows saved since then are read next */
+static time_t standby_next = 0;		/* time of the next refresh */
+static int standby_count = 0;		/* jobs in the replica */
+static int standby_failed = 0;		/* replica is incomplete, do not use it */
+
+/**
+ * @brief
+ *		move a job's row into another one, the attributes go along with it
+ *
+ * @param[out]	to	- row taking over the data
+ * @param[in]	from	- row handing over the data, left without attributes
+ */
+static void
+move_dbjob(pbs_db_job_info_t *to, pbs_db_job_info_t *from)
+{
+	*to = *from;
+	list_move(&from->db_attr_list.attrs, &to->db_attr_list.attrs);
+	from->db_attr_list.attr_count = 0;
+	from->db_attr_blob = NULL;
+	from->db_attr_bloblen = 0;
+}
+
+/**
+ * @brief
+ *		free a replica entry and the attributes it holds
+ *
+ * @param[in]	sj	- entry to free
+ */
+static void
+free_standby_job(struct standby_job *sj)
+{
+	free_db_attr_list(&sj->dbjob.db_attr_list);
+	free(sj->dbjob.db_attr_blob);
+	free(sj);
+}
+
+/**
+ * @brief
+ *		query callback adding or replacing a job's row in the replica
+ *
+ * @param[in]	dbobj	- the row just read, its attributes are taken over
+ * @param[out]	refreshed	- set to 1 if the row was kept
+ */
+static void
+standby_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed)
+{
+	pbs_db_job_info_t *dbjob = dbobj->pbs_db_un.pbs_db_job;
+	struct standby_job *sj = NULL;
+	void *key = dbjob->ji_jobid;
+
+	*refreshed = 0;
+	if (pbs_idx_find(standby_idx, &key, (void **) &sj, NULL) == PBS_IDX_RET_OK) {
+		free_db_attr_list(&sj->dbjob.db_attr_list);
+		free(sj->dbjob.db_attr_blob);
+	} else {
+		if ((sj = calloc(1, sizeof(struct standby_job))) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			goto err;
+		}
+		strcpy(sj->dbjob.ji_jobid, dbjob->ji_jobid);
+		if (pbs_idx_insert(standby_idx, sj->dbjob.ji_jobid, sj) != PBS_IDX_RET_OK) {
+			log_errf(-1, __func__, "Failed to add job %s to the standby replica", dbjob->ji_jobid);
+			free(sj);
+			goto err;
+		}
+		standby_count++;
+	}
+
+	/* the key keeps pointing at the same jobid, it is copied over itself */
+	move_dbjob(&sj->dbjob, dbjob);
+	sj->live = 1;
+	*refreshed = 1;
+	return;
+
+err:
+	standby_failed = 1;
+	free_db_attr_list(&dbjob->db_attr_list);
+	free(dbjob->db_attr_blob);
+	dbjob->db_attr_blob = NULL;
+}
+
+/**
+ * @brief
+ *		query callback marking the replica entry of a job still in the table
+ *
+ * @param[in]	dbobj	- the row just read, keys only
+ * @param[out]	refreshed	- set to 1 if the job is in the replica
+ */
+static void
+standby_mark_cb(pbs_db_obj_info_t *dbobj, int *refreshed)
+{
+	pbs_db_job_info_t *dbjob = dbobj->pbs_db_un.pbs_db_job;
+	struct standby_job *sj = NULL;
+	void *key = dbjob->ji_jobid;
+
+	*refreshed = 0;
+	if (pbs_idx_find(standby_idx, &key, (void **) &sj, NULL) == PBS_IDX_RET_OK) {
+		sj->live = 1;
+		*refreshed = 1;
+	} else {
+		/* saved before the replica's watermark, yet never read */
+		log_errf(-1, __func__, "Job %s missing from the standby replica", dbjob->ji_jobid);
+		standby_failed = 1;
+	}
+	free_db_attr_list(&dbjob->db_attr_list);
+	free(dbjob->db_attr_blob);
+	dbjob->db_attr_blob = NULL;
+}
+
+/**
+ * @brief
+ *		read the jobs saved since the last pass into the replica
+ *
+ * @param[in]	conn	- database connection to read from
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure, the replica is left as it was
+ */
+static int
+standby_read_delta(void *conn)
+{
+	pbs_db_job_info_t dbjob;
+	pbs_db_obj_info_t obj;
+	pbs_db_query_options_t opts;
+	time_t started = time(NULL);
+	char *conn_db_err = NULL;
+
+	memset(&dbjob, 0, sizeof(dbjob));
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &dbjob;
+	opts.flags = 0;
+	opts.timestamp = standby_since;
+
+	if (pbs_db_search(conn, &obj, &opts, (query_cb_t) &standby_job_cb) == -1) {
+		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+		if (conn_db_err != NULL) {
+			log_errf(-1, __func__, "%s", conn_db_err);
+			free(conn_db_err);
+		}
+		return -1;
+	}
+	standby_since = started - STANDBY_SKEW;
+	return 0;
+}
+
+/**
+ * @brief
+ *		drop the replica and the connection used to fill it
+ */
+void
+standby_free(void)
+{
+	struct standby_job *sj = NULL;
+	void *ctx = NULL;
+
+	if (standby_conn != NULL) {
+		pbs_db_disconnect(standby_conn);
+		standby_conn = NULL;
+	}
+	if (standby_idx == NULL)
+		return;
+
+	while (pbs_idx_find(standby_idx, NULL, (void **) &sj, &ctx) == PBS_IDX_RET_OK)
+		free_standby_job(sj);
+	pbs_idx_free_ctx(ctx);
+	pbs_idx_destroy(standby_idx);
+	standby_idx = NULL;
+	standby_since = 0;
+	standby_count = 0;
+	standby_failed = 0;
+}
+
+/**
+ * @brief
+ *		bring the replica up to date, called by the Secondary while it
+ *		receives handshakes from the Primary.  Does nothing unless
+ *		PBS_HOT_STANDBY is set or the last refresh is recent.
+ *
+ * @param[in]	now	- current time
+ */
+void
+standby_refresh(time_t now)
+{
+	char *host;
+	int rc;
+
+	if (!pbs_conf.pbs_hot_standby || now < standby_next)
+		return;
+	standby_next = now + STANDBY_REFRESH_TIME;
+
+	if (standby_failed)
+		standby_free();
+
+	if (standby_idx == NULL) {
+		if ((standby_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+			log_err(-1, __func__, "Creating standby replica index failed");
+			return;
+		}
+	}
+
+	if (standby_conn == NULL) {
+		/* the data service runs where the Primary keeps it */
+		host = pbs_conf.pbs_data_service_host ? pbs_conf.pbs_data_service_host : pbs_conf.pbs_primary;
+		rc = pbs_db_connect(&standby_conn, host, pbs_conf.pbs_data_service_port, PBS_DB_CNT_TIMEOUT_NORMAL);
+		if (rc != 0 || standby_conn == NULL) {
+			log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, msg_daemonname,
+				"Standby replica could not connect to the data service on %s", host);
+			if (standby_conn != NULL)
+				pbs_db_disconnect(standby_conn);
+			standby_conn = NULL;
+			return;
+		}
+	}
+
+	if (standby_read_delta(standby_conn) != 0) {
+		/* reconnect next time, the replica itself stays good */
+		pbs_db_disconnect(standby_conn);
+		standby_conn = NULL;
+		return;
+	}
+
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, msg_daemonname,
+		"Standby replica holds %d jobs", standby_count);
+}
+
+/**
+ * @brief
+ *		compare two replica entries by their queue rank
+ */
+static int
+cmp_standby_qrank(const void *a, const void *b)
+{
+	const struct standby_job *ja = *(struct standby_job * const *) a;
+	const struct standby_job *jb = *(struct standby_job * const *) b;
+
+	if (ja->dbjob.ji_qrank < jb->dbjob.ji_qrank)
+		return -1;
+	if (ja->dbjob.ji_qrank > jb->dbjob.ji_qrank)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		recover the jobs from the replica at takeover.  The replica is
+ *		caught up one last time, the jobs deleted since it was read are
+ *		dropped and the rest are handed to the callback in queue rank
+ *		order, the same as a search of the job table would.
+ *		The replica is freed in any case.
+ *
+ * @param[in]	conn	- database connection of the now active server
+ * @param[in]	obj	- job object to hand the rows over in
+ * @param[in]	query_cb	- callback recovering one job
+ *
+ * @return	int
+ * @retval	>=0	- number of jobs recovered
+ * @retval	-1	- failure recovering from the replica
+ * @retval	-2	- no usable replica, search the job table instead
+ */
+int
+standby_recover_jobs(void *conn, pbs_db_obj_info_t *obj, query_cb_t query_cb)
+{
+	pbs_db_job_info_t dbjob;
+	pbs_db_obj_info_t keys;
+	pbs_db_query_options_t opts;
+	struct standby_job **arr = NULL;
+	struct standby_job *sj = NULL;
+	void *ctx = NULL;
+	int refreshed;
+	int count = 0;
+	int n = 0;
+	int i;
+
+	if (standby_conn != NULL) {
+		pbs_db_disconnect(standby_conn);
+		standby_conn = NULL;
+	}
+	if (standby_idx == NULL || standby_failed || standby_since == 0)
+		goto fallback;
+
+	if (standby_read_delta(conn) != 0 || standby_failed)
+		goto fallback;
+
+	while (pbs_idx_find(standby_idx, NULL, (void **) &sj, &ctx) == PBS_IDX_RET_OK)
+		sj->live = 0;
+	pbs_idx_free_ctx(ctx);
+	ctx = NULL;
+
+	/* find which of the jobs are still in the table */
+	memset(&dbjob, 0, sizeof(dbjob));
+	keys.pbs_db_obj_type = PBS_DB_JOB;
+	keys.pbs_db_un.pbs_db_job = &dbjob;
+	opts.flags = FIND_JOBS_KEYS_ONLY;
+	opts.timestamp = 0;
+	if (pbs_db_search(conn, &keys, &opts, (query_cb_t) &standby_mark_cb) == -1 || standby_failed)
+		goto fallback;
+
+	if (standby_count > 0 && (arr = malloc(standby_count * sizeof(struct standby_job *))) == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		goto fallback;
+	}
+	while (pbs_idx_find(standby_idx, NULL, (void **) &sj, &ctx) == PBS_IDX_RET_OK) {
+		if (sj->live)
+			arr[n++] = sj;
+		else
+			free_standby_job(sj);
+	}
+	pbs_idx_free_ctx(ctx);
+	pbs_idx_destroy(standby_idx);
+	standby_idx = NULL;
+
+	qsort(arr, n, sizeof(struct standby_job *), cmp_standby_qrank);
+
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, msg_daemonname,
+		"Recovering %d jobs from the standby replica", n);
+
+	for (i = 0; i < n; i++) {
+		move_dbjob(obj->pbs_db_un.pbs_db_job, &arr[i]->dbjob);
+		free(arr[i]);
+		query_cb(obj, &refreshed);
+		if (refreshed)
+			count++;
+	}
+	free(arr);
+	standby_free();
+	return count;
+
+fallback:
+	if (standby_idx != NULL)
+		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE, msg_daemonname,
+			"Standby replica not usable, reading all jobs");
+	standby_free();
+	return -2;
+}
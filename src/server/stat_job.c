@@ -47,13 +47,22 @@
  *
  * Included funtions are:
  *	svrcached()
+ *	stat_enc_count()
+ *	stat_enc_check()
  *	status_attrib()
+ *	modseq_update()
+ *	modseq_clear()
+ *	stat_since()
+ *	status_modseq()
+ *	status_unchanged()
+ *	status_job_attrs()
  *	status_job()
  *	status_subjob()
  *
  */
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
 #include "libpbs.h"
 #include <ctype.h>
 #include <time.h>
@@ -66,11 +75,13 @@
 #include "job.h"
 #include "reservation.h"
 #include "queue.h"
+#include "mem_acct.h"
 #include "work_task.h"
 #include "pbs_error.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
 #include "pbs_ifl.h"
+#include "dis.h"
 
 
 /* Global Data Items: */
@@ -80,6 +91,7 @@ extern int	     resc_access_perm; /* see encode_resc() in attr_fn_resc.c */
 extern struct server server;
 extern char	     statechars[];
 extern time_t time_now;
+extern u_Long svr_modseq;
 
 /**
  * @brief
@@ -164,6 +176,8 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 				wcopy = malloc(sizeof(struct svrattrl));
 				if (wcopy) {
 					*wcopy = *working;
+					/* freed by attrlist_free() as al_tsize bytes */
+					mem_acct_add(MEM_ACCT_SVRATTRL, 1, wcopy->al_tsize);
 					working = working->al_sister;
 					CLEAR_LINK(wcopy->al_link);
 					if (phead != NULL)
@@ -176,6 +190,83 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 	}
 }
 
+/* bits added to the privilege to form the key of a job's encoded status */
+#define STAT_ENC_BINARY	0x10000000	/* encoded for a binary DIS connection */
+#define STAT_ENC_HIDDEN	0x20000000	/* show_hidden_attribs was set */
+#define STAT_ENC_ELIG	0x40000000	/* eligible_time_enable was set */
+
+/**
+ * @brief
+ * 		stat_enc_count - count the job attributes holding a cached svrattrl
+ *		encoding for the given privilege class.
+ *
+ * @param[in]	pjob	-	job
+ * @param[in]	slot	-	1 for operators/managers, 0 for users
+ *
+ * @return	int
+ * @retval	number of attributes with a cached encoding
+ */
+static int
+stat_enc_count(job *pjob, int slot)
+{
+	int i;
+	int ct = 0;
+	int elig = server.sv_attr[(int)SVR_ATR_EligibleTimeEnable].at_val.at_long;
+	attribute *pat;
+
+	for (i = 0; i < (int)JOB_ATR_LAST; i++) {
+		if (!elig && (i == (int)JOB_ATR_eligible_time || i == (int)JOB_ATR_accrue_type))
+			continue;
+		pat = &pjob->ji_wattr[i];
+		if ((slot ? pat->at_priv_encoded : pat->at_user_encoded) != NULL)
+			ct++;
+	}
+	return ct;
+}
+
+/**
+ * @brief
+ * 		stat_enc_check - drop the encoded full status of a job if any of its
+ *		attributes changed since it was built.
+ *
+ *		A change shows either as ATR_VFLAG_MODCACHE or as a cached svrattrl
+ *		encoding that went away.  svrcached() clears ATR_VFLAG_MODCACHE, so
+ *		this must run before any attribute of the job is statused.
+ *
+ * @param[in,out]	pjob	-	job
+ *
+ * @note
+ *	eligible_time and accrue_type are not looked at when eligible_time_enable
+ *	is off, status_job() flips their flags on every stat and never shows them.
+ */
+static void
+stat_enc_check(job *pjob)
+{
+	int i;
+	int slot;
+	int elig;
+
+	if (pjob->ji_stat_enc[0] == NULL && pjob->ji_stat_enc[1] == NULL)
+		return;
+
+	elig = server.sv_attr[(int)SVR_ATR_EligibleTimeEnable].at_val.at_long;
+	for (i = 0; i < (int)JOB_ATR_LAST; i++) {
+		if (!elig && (i == (int)JOB_ATR_eligible_time || i == (int)JOB_ATR_accrue_type))
+			continue;
+		if (pjob->ji_wattr[i].at_flags & ATR_VFLAG_MODCACHE)
+			break;
+	}
+
+	for (slot = 0; slot < 2; slot++) {
+		if (pjob->ji_stat_enc[slot] == NULL)
+			continue;
+		if (i < (int)JOB_ATR_LAST || stat_enc_count(pjob, slot) != pjob->ji_stat_cnt[slot]) {
+			release_brp_enc(pjob->ji_stat_enc[slot]);
+			pjob->ji_stat_enc[slot] = NULL;
+		}
+	}
+}
+
 /*
  * status_attrib - add each requested or all attributes to the status reply
  *
@@ -229,7 +320,141 @@ status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr,
 
 /**
  * @brief
- * 		status_job - Build the status reply for a single job, regular or Array,
+ * 		modseq_update - bring an object's modify_seq up to date, before the
+ *		object is statused.
+ *
+ *		Any attribute marked ATR_VFLAG_MODSEQ changed since the object's
+ *		modify_seq was last taken, so the object gets the next sequence
+ *		number and the marks are cleared.  An object with no sequence yet
+ *		is given one.
+ *
+ * @param[in,out]	pattr	-	the object's attribute array
+ * @param[in]		limit	-	number of attributes in the array
+ * @param[in,out]	pseq	-	the object's modify_seq
+ *
+ * @return	u_Long
+ * @retval	the object's modify_seq
+ */
+u_Long
+modseq_update(attribute *pattr, int limit, u_Long *pseq)
+{
+	int i;
+	int changed = (*pseq == 0);
+
+	for (i = 0; i < limit; i++) {
+		if (pattr[i].at_flags & ATR_VFLAG_MODSEQ) {
+			pattr[i].at_flags &= ~ATR_VFLAG_MODSEQ;
+			changed = 1;
+		}
+	}
+	if (changed)
+		*pseq = ++svr_modseq;
+	return *pseq;
+}
+
+/**
+ * @brief
+ * 		modseq_clear - forget the changes made to an object's attributes
+ *		while it was statused, the values made up for the stat are put back
+ *		and must not count as changes.
+ *
+ * @param[in,out]	pattr	-	the object's attribute array
+ * @param[in]		limit	-	number of attributes in the array
+ */
+void
+modseq_clear(attribute *pattr, int limit)
+{
+	int i;
+
+	for (i = 0; i < limit; i++)
+		pattr[i].at_flags &= ~ATR_VFLAG_MODSEQ;
+}
+
+/**
+ * @brief
+ * 		stat_since - get the modify_seq a status request asked for changes
+ *		since, given as EXTEND_OPT_SINCE in the extend field.
+ *
+ * @param[in]	preq	-	status request
+ *
+ * @return	u_Long
+ * @retval	0	: all objects are to be statused
+ * @retval	>0	: only objects changed after this sequence are statused in full
+ */
+u_Long
+stat_since(struct batch_request *preq)
+{
+	char *p;
+
+	if (preq->rq_extend == NULL)
+		return 0;
+	p = strstr(preq->rq_extend, EXTEND_OPT_SINCE);
+	if (p == NULL)
+		return 0;
+	return (u_Long)strtoull(p + strlen(EXTEND_OPT_SINCE), NULL, 10);
+}
+
+/**
+ * @brief
+ * 		status_modseq - add an object's modify_seq to its status.
+ *
+ * @param[in]		seq	-	the object's modify_seq
+ * @param[in,out]	phead	-	attribute list of the object's status
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+int
+status_modseq(u_Long seq, pbs_list_head *phead)
+{
+	char buf[32];
+	svrattrl *pal;
+
+	snprintf(buf, sizeof(buf), "%llu", (unsigned long long)seq);
+	pal = attrlist_create(ATTR_modify_seq, NULL, strlen(buf) + 1);
+	if (pal == NULL)
+		return (PBSE_SYSTEM);
+	strcpy(pal->al_value, buf);
+	append_link(phead, &pal->al_link, pal);
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_unchanged - add an object which did not change since the
+ *		modify_seq asked for to the status reply, by name only.
+ *
+ * @param[in]		objtype	-	MGR_OBJ_* type of the object
+ * @param[in]		name	-	name of the object
+ * @param[in,out]	preq	-	status request
+ * @param[in,out]	pstathd	-	RETURN: head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+int
+status_unchanged(int objtype, char *name, struct batch_request *preq, pbs_list_head *pstathd)
+{
+	struct brp_status *pstat;
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return (PBSE_SYSTEM);
+	CLEAR_LINK(pstat->brp_stlink);
+	pstat->brp_objtype = objtype;
+	(void)strcpy(pstat->brp_objname, name);
+	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+	preq->rq_reply.brp_count++;
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_job_attrs - Build the status reply for a single job, regular or Array,
  *		but not a subjob of an Array Job.
  *
  * @param[in,out]	pjob	-	ptr to job to status
@@ -237,6 +462,7 @@ status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr,
  * @param[in]	pal	-	specific attributes to status
  * @param[in,out]	pstathd	-	RETURN: head of list to append status to
  * @param[out]	bad	-	RETURN: index of first bad attribute
+ * @param[in]	since	-	modify_seq asked for by EXTEND_OPT_SINCE, or 0
  *
  * @return	int
  * @retval	0	: success
@@ -245,14 +471,18 @@ status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr,
  * @retval	PBSE_NOATTR	: attribute error
  */
 
-int
-status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *pstathd, int *bad)
+static int
+status_job_attrs(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *pstathd, int *bad, u_Long since)
 {
 	struct brp_status *pstat;
 	long oldtime = 0;
 	int old_elig_flags = 0;
 	int old_atyp_flags = 0;
 	int revert_state_r = 0;
+	int cacheable = 0;
+	int slot = 0;
+	int key = 0;
+	struct brp_enc *penc;
 
 	/* see if the client is authorized to status this job */
 
@@ -260,10 +490,28 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 		if (svr_authorize_jobreq(preq, pjob))
 			return (PBSE_PERM);
 
-	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
-		/* for Array Job, if array_indices_remaining is modified */
-		/* then need to recalculate the string value	     */
-		update_array_indices_remaining_attr(pjob);
+	stat_enc_check(pjob);
+
+	/*
+	 * A full status can be encoded once and sent to every later client of
+	 * the same privilege, unless it holds values made up just for this stat.
+	 */
+	if (pal == NULL && since == 0) {
+		cacheable = 1;
+		key = preq->rq_perm & (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR);
+		slot = (key & PRIV_READ) ? 1 : 0;
+		if (server.sv_attr[(int)SVR_ATR_show_hidden_attribs].at_val.at_long)
+			key |= STAT_ENC_HIDDEN;
+		if (dis_is_binary(preq->rq_conn))
+			key |= STAT_ENC_BINARY;
+		if (server.sv_attr[(int)SVR_ATR_EligibleTimeEnable].at_val.at_long) {
+			key |= STAT_ENC_ELIG;
+			if (get_jattr_long(pjob, JOB_ATR_accrue_type) == JOB_ELIGIBLE)
+				cacheable = 0;
+		}
+		if (check_job_state(pjob, JOB_STATE_LTR_RUNNING) &&
+			(pjob->ji_qs.ji_svrflags & (JOB_SVFLG_Suspend | JOB_SVFLG_Actsuspd)))
+			cacheable = 0;
 	}
 
 	/* calc eligible time on the fly and return, don't save. */
@@ -300,9 +548,13 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	pstat->brp_objtype = MGR_OBJ_JOB;
 	(void)strcpy(pstat->brp_objname, pjob->ji_qs.ji_jobid);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
+	if (since != 0 && status_modseq(pjob->ji_modseq, &pstat->brp_attr) != 0)
+		return (PBSE_SYSTEM);
+
 	/* Temporarily set suspend/user suspend states for the stat */
 	if (check_job_state(pjob, JOB_STATE_LTR_RUNNING)) {
 		if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_Suspend) {
@@ -314,11 +566,32 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 		}
 	}
 
+	if (cacheable) {
+		penc = pjob->ji_stat_enc[slot];
+		if (penc != NULL && pjob->ji_stat_key[slot] != key) {
+			release_brp_enc(penc);
+			penc = pjob->ji_stat_enc[slot] = NULL;
+		}
+		if (penc == NULL && (penc = calloc(1, sizeof(struct brp_enc))) != NULL) {
+			penc->be_refct = 1;
+			pjob->ji_stat_enc[slot] = penc;
+			pjob->ji_stat_key[slot] = key;
+		}
+		if (penc != NULL) {
+			penc->be_refct++;
+			pstat->brp_enc = penc;
+		}
+	}
+
 	/* add attributes to the status reply */
 
 	*bad = 0;
-	if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, &pstat->brp_attr, bad))
-		return (PBSE_NOATTR);
+	if (pstat->brp_enc == NULL || pstat->brp_enc->be_data == NULL) {
+		if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, &pstat->brp_attr, bad))
+			return (PBSE_NOATTR);
+		if (pstat->brp_enc != NULL)
+			pjob->ji_stat_cnt[slot] = stat_enc_count(pjob, slot);
+	}
 
 	/* reset eligible time, it was calctd on the fly, real calctn only when accrue_type changes */
 
@@ -342,6 +615,68 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	return (0);
 }
 
+/**
+ * @brief
+ * 		status_job - Build the status reply for a single job, regular or Array,
+ *		but not a subjob of an Array Job.  A compacted history job is loaded
+ *		in full for the stat when it is asked for attributes it gave up,
+ *		and compacted again afterwards.
+ *
+ *		When the request asks for changes since a modify_seq, a job which
+ *		has not changed since is reported by name only.
+ *
+ * @param[in,out]	pjob	-	ptr to job to status
+ * @param[in]	preq	-	request structure
+ * @param[in]	pal	-	specific attributes to status
+ * @param[in,out]	pstathd	-	RETURN: head of list to append status to
+ * @param[out]	bad	-	RETURN: index of first bad attribute
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_PERM	: client is not authorized to status the job
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ * @retval	PBSE_NOATTR	: attribute error
+ */
+
+int
+status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *pstathd, int *bad)
+{
+	svrattrl *pa;
+	int expand = 0;
+	int rc;
+	u_Long since = stat_since(preq);
+
+	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
+		/* for Array Job, if array_indices_remaining is modified */
+		/* then need to recalculate the string value	     */
+		update_array_indices_remaining_attr(pjob);
+	}
+
+	if (modseq_update(pjob->ji_wattr, JOB_ATR_LAST, &pjob->ji_modseq) <= since) {
+		if (! server.sv_attr[(int)SVR_ATR_query_others].at_val.at_long)
+			if (svr_authorize_jobreq(preq, pjob))
+				return (PBSE_PERM);
+		*bad = 0;
+		return (status_unchanged(MGR_OBJ_JOB, pjob->ji_qs.ji_jobid, preq, pstathd));
+	}
+
+	if (pjob->ji_histcompact) {
+		if (pal == NULL)
+			expand = 1;
+		for (pa = pal; pa != NULL && !expand; pa = (svrattrl *)GET_NEXT(pa->al_link))
+			expand = histjob_attr_dropped(find_attr(job_attr_idx, job_attr_def, pa->al_name));
+		if (expand && histjob_expand(pjob) != 0)
+			expand = 0;
+	}
+
+	rc = status_job_attrs(pjob, preq, pal, pstathd, bad, since);
+
+	if (expand)
+		histjob_compact(pjob);
+	modseq_clear(pjob->ji_wattr, JOB_ATR_LAST);
+	return rc;
+}
+
 /**
  * @brief
  * 		status_subjob - status a single subjob (of an Array Job)
@@ -372,6 +707,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	int		   oldatypflags = 0;
 	char 		   subjob_state = -1;
 	char 		   *old_subjob_comment = NULL;
+	u_Long		   since = stat_since(preq);
 
 	/* see if the client is authorized to status this job */
 
@@ -382,15 +718,26 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) == 0)
 		return PBSE_IVALREQ;
 
+	/* statusing the parent's attributes below clears their MODCACHE flags */
+	stat_enc_check(pjob);
+
 	/* if subjob job obj exists, use real job structure */
 
-	if ((get_subjob_state(pjob, subj) != JOB_STATE_LTR_QUEUED) && (psubjob = pjob->ji_ajtrk->tkm_tbl[subj].trk_psubjob)) {
+	if ((get_subjob_state(pjob, subj) != JOB_STATE_LTR_QUEUED) && (psubjob = get_subjob_ptr(pjob, subj))) {
 
 		status_job(psubjob, preq, pal, pstathd, bad);
 		return 0;
 	}
 
-	/* otherwise we fake it with info from the parent      */
+	/* otherwise we fake it with info from the parent,     */
+	/* which also holds the subjob's modify_seq	       */
+	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob)
+		update_array_indices_remaining_attr(pjob);
+	if (modseq_update(pjob->ji_wattr, JOB_ATR_LAST, &pjob->ji_modseq) <= since) {
+		*bad = 0;
+		return (status_unchanged(MGR_OBJ_JOB, mk_subjob_id(pjob, subj), preq, pstathd));
+	}
+
 	/* allocate reply structure and fill in header portion */
 
 
@@ -405,12 +752,15 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	pstat->brp_objtype = MGR_OBJ_JOB;
 	(void)strcpy(pstat->brp_objname, mk_subjob_id(pjob, subj));
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_enc = NULL;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
 	/* add attributes to the status reply */
 
 	*bad = 0;
+	if (since != 0 && status_modseq(pjob->ji_modseq, &pstat->brp_attr) != 0)
+		return (PBSE_SYSTEM);
 
 	/*
 	 * fake the job state and comment by setting the parent job's state
@@ -421,7 +771,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 	set_job_state(pjob, subjob_state);
 
 	if (subjob_state == JOB_STATE_LTR_EXPIRED || subjob_state == JOB_STATE_LTR_FINISHED) {
-		if (pjob->ji_ajtrk->tkm_tbl[subj].trk_substate == JOB_SUBSTATE_FINISHED) {
+		if (get_subjob_substate(pjob, subj) == JOB_SUBSTATE_FINISHED) {
 			if (is_jattr_set(pjob, JOB_ATR_Comment)) {
 				old_subjob_comment = strdup(get_jattr_str(pjob, JOB_ATR_Comment));
 				if (old_subjob_comment == NULL)
@@ -430,7 +780,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 			if (set_jattr_str_slim(pjob, JOB_ATR_Comment, "Subjob finished", NULL)) {
 				return (PBSE_SYSTEM);
 			}
-		} else if (pjob->ji_ajtrk->tkm_tbl[subj].trk_substate == JOB_SUBSTATE_FAILED) {
+		} else if (get_subjob_substate(pjob, subj) == JOB_SUBSTATE_FAILED) {
 			if (is_jattr_set(pjob, JOB_ATR_Comment)) {
 				old_subjob_comment = strdup(get_jattr_str(pjob, JOB_ATR_Comment));
 				if (old_subjob_comment == NULL)
@@ -439,7 +789,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 			if (set_jattr_str_slim(pjob, JOB_ATR_Comment, "Subjob failed", NULL)) {
 				return (PBSE_SYSTEM);
 			}
-		} else if (pjob->ji_ajtrk->tkm_tbl[subj].trk_substate == JOB_SUBSTATE_TERMINATED) {
+		} else if (get_subjob_substate(pjob, subj) == JOB_SUBSTATE_TERMINATED) {
 			if (is_jattr_set(pjob, JOB_ATR_Comment)) {
 				old_subjob_comment = strdup(get_jattr_str(pjob, JOB_ATR_Comment));
 				if (old_subjob_comment == NULL)
@@ -486,6 +836,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 		pjob->ji_wattr[(int)JOB_ATR_eligible_time].at_flags = oldeligflags;
 		pjob->ji_wattr[(int)JOB_ATR_accrue_type].at_flags = oldatypflags;
 	}
+	modseq_clear(pjob->ji_wattr, JOB_ATR_LAST);
 
 	return (rc);
 }
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	status_snapshot.c
+ *
+ * @brief
+ * 	Status snapshot of the jobs, vnodes and queues, written when
+ *	PBS_STATUS_SNAPSHOT is set in pbs.conf.
+ *
+ *	Every PBS_STATUS_SNAPSHOT seconds the server writes the status of its
+ *	objects, as a Manager would see it, to PBS_HOME/server_priv/status_snapshot.
+ *	The file is written aside and renamed into place, so a reader always
+ *	maps a whole snapshot.  Clients on the server host read it with
+ *	pbs_statsnap() instead of sending status requests.  The format is
+ *	described in pbs_share.h.
+ *
+ *	Included public functions are:
+ *
+ *	snapshot_status
+ *	snapshot_remove
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "libpbs.h"
+#include "pbs_share.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "job.h"
+#include "reservation.h"
+#include "queue.h"
+#include "server.h"
+#include "work_task.h"
+#include "log.h"
+#include "pbs_nodes.h"
+#include "svrfunc.h"
+
+extern int status_attrib(svrattrl *, void *, attribute_def *, attribute *, int, int, pbs_list_head *, int *);
+extern int status_nodeattrib(svrattrl *, struct pbsnode *, int, int, pbs_list_head *, int *);
+extern char *build_path(char *, char *, char *);
+
+extern pbs_list_head svr_alljobs;
+extern pbs_list_head svr_queues;
+extern char *path_priv;
+extern char server_name[];
+extern time_t time_now;
+extern char *msg_daemonname;
+
+/* the snapshot is written as a Manager would status the objects */
+#define SNAPSHOT_PRIV	(ATR_DFLAG_MGRD | ATR_DFLAG_OPRD | ATR_DFLAG_USRD)
+
+static uint64_t snapshot_generation = 0;
+static char *snapshot_path = NULL;
+static char *snapshot_tmp = NULL;
+
+/**
+ * @brief
+ *		write a string of the snapshot, its length counting the NUL first
+ *
+ * @param[in]	fp	- the snapshot file
+ * @param[in]	str	- the string, NULL or "" for an empty one
+ * @param[in,out]	len	- bytes written so far
+ */
+static void
+snap_put_str(FILE *fp, char *str, uint64_t *len)
+{
+	uint32_t slen = 0;
+
+	if (str != NULL && *str != '\0')
+		slen = strlen(str) + 1;
+	fwrite(&slen, sizeof(slen), 1, fp);
+	if (slen > 0)
+		fwrite(str, 1, slen, fp);
+	*len += sizeof(slen) + slen;
+}
+
+/**
+ * @brief
+ *		write one object of the snapshot
+ *
+ * @param[in]	fp	- the snapshot file
+ * @param[in]	objtype	- MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_QUEUE
+ * @param[in]	name	- name of the object
+ * @param[in]	phead	- the object's status, as built by status_attrib()
+ * @param[in,out]	len	- bytes written so far
+ */
+static void
+snap_put_obj(FILE *fp, int objtype, char *name, pbs_list_head *phead, uint64_t *len)
+{
+	svrattrl *pal;
+	uint32_t val;
+
+	val = objtype;
+	fwrite(&val, sizeof(val), 1, fp);
+	val = 0;
+	for (pal = (svrattrl *) GET_NEXT(*phead); pal; pal = (svrattrl *) GET_NEXT(pal->al_link))
+		val++;
+	fwrite(&val, sizeof(val), 1, fp);
+	*len += 2 * sizeof(val);
+	snap_put_str(fp, name, len);
+
+	for (pal = (svrattrl *) GET_NEXT(*phead); pal; pal = (svrattrl *) GET_NEXT(pal->al_link)) {
+		snap_put_str(fp, pal->al_name, len);
+		snap_put_str(fp, pal->al_resc, len);
+		snap_put_str(fp, pal->al_value, len);
+	}
+}
+
+/**
+ * @brief
+ *		work task writing a status snapshot, it sets itself up again
+ *		PBS_STATUS_SNAPSHOT seconds later
+ *
+ * @param[in]	ptask	- the work task, unused
+ */
+void
+snapshot_status(struct work_task *ptask)
+{
+	struct snapshot_hdr hdr;
+	pbs_list_head head;
+	FILE *fp;
+	job *pjob;
+	pbs_queue *pque;
+	int bad;
+	int i;
+	int fd;
+
+	if (pbs_conf.pbs_status_snapshot == 0)
+		return;
+	(void) set_task(WORK_Timed, time_now + pbs_conf.pbs_status_snapshot, snapshot_status, NULL);
+
+	if (snapshot_path == NULL) {
+		snapshot_path = build_path(path_priv, SNAPSHOT_FILENAME, NULL);
+		snapshot_tmp = build_path(path_priv, SNAPSHOT_FILENAME, ".new");
+		if (snapshot_path == NULL || snapshot_tmp == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return;
+		}
+	}
+
+	/* only root, and the local clients it runs, may read the snapshot */
+	if ((fd = open(snapshot_tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1) {
+		log_errf(errno, __func__, "Unable to create %s", snapshot_tmp);
+		return;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		log_errf(errno, __func__, "Unable to open %s", snapshot_tmp);
+		close(fd);
+		unlink(snapshot_tmp);
+		return;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	strcpy(hdr.magic, SNAPSHOT_MAGIC);
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.hdr_size = sizeof(hdr);
+	hdr.generation = ++snapshot_generation;
+	hdr.taken = time_now;
+	hdr.interval = pbs_conf.pbs_status_snapshot;
+	snprintf(hdr.server, sizeof(hdr.server), "%s", server_name);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	CLEAR_HEAD(head);
+	for (pjob = (job *) GET_NEXT(svr_alljobs); pjob; pjob = (job *) GET_NEXT(pjob->ji_alljobs)) {
+		bad = 0;
+		if (status_attrib(NULL, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST,
+				  SNAPSHOT_PRIV, &head, &bad) == 0) {
+			snap_put_obj(fp, MGR_OBJ_JOB, pjob->ji_qs.ji_jobid, &head, &hdr.data_len);
+			hdr.num_objs++;
+		}
+		free_attrlist(&head);
+		CLEAR_HEAD(head);
+	}
+
+	for (i = 0; i < svr_totnodes; i++) {
+		struct pbsnode *pnode = pbsndlist[i];
+
+		if (pnode->nd_state & INUSE_DELETED)
+			continue;
+		/* sync state attribute with nd_state, as status_node() does */
+		if (pnode->nd_state != pnode->nd_attr[(int) ND_ATR_state].at_val.at_long) {
+			pnode->nd_attr[(int) ND_ATR_state].at_val.at_long = pnode->nd_state;
+			pnode->nd_attr[(int) ND_ATR_state].at_flags |= ATR_MOD_MCACHE;
+		}
+		bad = 0;
+		if (status_nodeattrib(NULL, pnode, ND_ATR_LAST, SNAPSHOT_PRIV, &head, &bad) == 0) {
+			snap_put_obj(fp, MGR_OBJ_NODE, pnode->nd_name, &head, &hdr.data_len);
+			hdr.num_objs++;
+		}
+		free_attrlist(&head);
+		CLEAR_HEAD(head);
+	}
+
+	for (pque = (pbs_queue *) GET_NEXT(svr_queues); pque; pque = (pbs_queue *) GET_NEXT(pque->qu_link)) {
+		status_que_counts(pque);
+		bad = 0;
+		if (status_attrib(NULL, que_attr_idx, que_attr_def, pque->qu_attr, QA_ATR_LAST,
+				  SNAPSHOT_PRIV, &head, &bad) == 0) {
+			snap_put_obj(fp, MGR_OBJ_QUEUE, pque->qu_qs.qu_name, &head, &hdr.data_len);
+			hdr.num_objs++;
+		}
+		free_attrlist(&head);
+		CLEAR_HEAD(head);
+	}
+
+	/* now that the objects are counted, the header is final */
+	if (fseek(fp, 0L, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+		fflush(fp) != 0 || ferror(fp)) {
+		log_errf(errno, __func__, "Unable to write %s", snapshot_tmp);
+		fclose(fp);
+		unlink(snapshot_tmp);
+		return;
+	}
+	if (fclose(fp) != 0 || rename(snapshot_tmp, snapshot_path) == -1) {
+		log_errf(errno, __func__, "Unable to replace %s", snapshot_path);
+		unlink(snapshot_tmp);
+		return;
+	}
+
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, msg_daemonname,
+		   "Status snapshot %llu written, %u objects", (unsigned long long) hdr.generation, hdr.num_objs);
+}
+
+/**
+ * @brief
+ *		remove the status snapshot when the server goes down, so clients
+ *		do not keep reading it
+ */
+void
+snapshot_remove(void)
+{
+	if (snapshot_path != NULL)
+		unlink(snapshot_path);
+}
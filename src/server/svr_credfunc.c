@@ -70,12 +70,13 @@ long svr_cred_renew_cache_period = SVR_RENEW_CACHE_PERIOD_DEFAULT;
 extern time_t time_now;
 extern pbs_list_head svr_alljobs;
 
-extern int send_cred(job *pjob);
+extern int renew_cred(job *pjob);
 
 /* @brief
  *	The work task for particular job. This work task renew credentials for
  *	a job specified in the work task and sends the credentials to the
- *	superior mom.
+ *	superior mom. The renewal is shared with the other jobs of the same
+ *	credid and does not wait for SVR_ATR_cred_renew_tool, see renew_cred().
  *
  * @param[in] pwt - work task structure
  *
@@ -94,11 +95,11 @@ svr_renew_job_cred(struct work_task *pwt)
 		if ((is_jattr_set(pjob, JOB_ATR_cred_id)) == 0)
 			return;
 
-		rc = send_cred(pjob);
+		rc = renew_cred(pjob);
 		if (rc != 0) {
 			log_eventf(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER,
 				LOG_NOTICE, msg_daemonname,
-				"svr_renew_job_cred %s renew failed, send_cred returned: %d", pjob->ji_qs.ji_jobid, rc);
+				"svr_renew_job_cred %s renew failed, renew_cred returned: %d", pjob->ji_qs.ji_jobid, rc);
 		} else {
 			log_eventf(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
 				LOG_NOTICE, msg_daemonname,
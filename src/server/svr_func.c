@@ -261,6 +261,8 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 	resource     *rescp = NULL;
 	attribute    *queru = NULL;
 	attribute    *sysru = NULL;
+	static resc_lookup syslk;
+	static resc_lookup quelk;
 
 	/*First part of this lengthy function figures out which
 	 *"resources_assigned" lists need to get updated.  Most of
@@ -378,6 +380,10 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 	 *Note: if we aren't supposed to be updating the server's or the queue's
 	 *	"resources_assigned" the pointers "sysru"/"queru" should be NULL
 	 */
+	if (sysru)
+		resc_lookup_load(&syslk, sysru);
+	if (queru)
+		resc_lookup_load(&quelk, queru);
 	while (rescp) {
 		rscdef = rescp->rs_defin;
 
@@ -388,11 +394,12 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 			/* update system attribute of resources assigned */
 
 			if (sysru) {
-				pr = find_resc_entry(sysru, rscdef);
+				pr = resc_lookup_find(&syslk, rscdef);
 				if (pr == NULL) {
 					pr = add_resource_entry(sysru, rscdef);
 					if (pr == NULL)
 						return;
+					resc_lookup_note(&syslk, pr);
 				}
 				rscdef->rs_set(&pr->rs_value, &rescp->rs_value, op);
 				sysru->at_flags |= ATR_MOD_MCACHE;
@@ -401,11 +408,12 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 			/* update queue attribute of resources assigned */
 
 			if (queru) {
-				pr = find_resc_entry(queru, rscdef);
+				pr = resc_lookup_find(&quelk, rscdef);
 				if (pr == NULL) {
 					pr = add_resource_entry(queru, rscdef);
 					if (pr == NULL)
 						return;
+					resc_lookup_note(&quelk, pr);
 				}
 				rscdef->rs_set(&pr->rs_value, &rescp->rs_value, op);
 				queru->at_flags |= ATR_MOD_MCACHE;
@@ -423,7 +431,7 @@ set_resc_assigned(void *pobj, int objtype, enum batch_op op)
 			update_node_rassn(&pjob->ji_wattr[(int) JOB_ATR_resc_released], op);
 		else
 			/* updating all resources from exec vnode attribute */
-			update_node_rassn(&pjob->ji_wattr[(int) JOB_ATR_exec_vnode], op);
+			update_job_node_rassn(pjob, &pjob->ji_wattr[(int) JOB_ATR_exec_vnode], op);
 		if (is_jattr_set(pjob, JOB_ATR_exec_vnode_deallocated)) {
 			update_job_node_rassn(pjob, &pjob->ji_wattr[(int) JOB_ATR_exec_vnode_deallocated], op);
 		}
@@ -1934,29 +1942,19 @@ extern char	 statechars[];
 static int
 check_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, int subjobs, job *pjob)
 {
-	char *kstr;
 	void *ctx;
 	svr_entlim_leaf_t *plf;
 	int   count = subjobs;
 
-	kstr = entlim_mk_runkey(kt, ename);
-	if (kstr == NULL) {
-		log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
-			LOG_ALERT, msg_daemonname,
-			"rejecting job,  unable to make entity limit key, no memory");
-		ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, LIM_OVERALL)
-		return LIM_OVERALL;
-	}
-	ET_LIM_DBG("kstr %s, %d", __func__, kstr, subjobs)
+	ET_LIM_DBG("entity %d:%s, %d", __func__, (int)kt, ename, subjobs)
 	ctx = patr->at_val.at_enty.ae_tree;
-	plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+	plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, ename, ENTLIM_RUN_ID);
 
 	if (plf) {
 		count += plf->slf_sum.at_val.at_long;
-		ET_LIM_DBG("ct usage for %s is %ld", __func__, kstr, plf->slf_sum.at_val.at_long)
-		ET_LIM_DBG("ct specific limit for %s is %ld", __func__, kstr, plf->slf_limit.at_val.at_long)
+		ET_LIM_DBG("ct usage for %s is %ld", __func__, ename, plf->slf_sum.at_val.at_long)
+		ET_LIM_DBG("ct specific limit for %s is %ld", __func__, ename, plf->slf_limit.at_val.at_long)
 	}
-	free(kstr);
 
 	ET_LIM_DBG("count is %d", __func__, count)
 	if (plf && (is_attr_set(&plf->slf_limit))) {
@@ -1969,15 +1967,9 @@ check_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, int s
 		}
 	} else if (kt != LIM_OVERALL) {
 		/* compare against generic limit if one */
-		kstr = entlim_mk_runkey(kt, PBS_GENERIC_ENTITY);
-		if (kstr == NULL) {
-			ET_LIM_DBG("exiting, ret No_Limit [generic limit]", __func__)
-			return No_Limit;
-		}
-		plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+		plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, PBS_GENERIC_ENTITY, ENTLIM_RUN_ID);
 		if (plf && (is_attr_set(&plf->slf_limit))) {
-			ET_LIM_DBG("ct generic limit for %s is %ld", __func__, kstr, plf->slf_limit.at_val.at_long)
-			free(kstr);
+			ET_LIM_DBG("ct generic limit for %s is %ld", __func__, PBS_GENERIC_ENTITY, plf->slf_limit.at_val.at_long)
 			if (count > plf->slf_limit.at_val.at_long) {
 				ET_LIM_DBG("exiting, ret Exceeds_Generic [generic limit]", __func__)
 				return Exceeds_Generic;
@@ -1986,7 +1978,6 @@ check_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, int s
 				return Within_Limit;
 			}
 		}
-		free(kstr);
 	}
 	ET_LIM_DBG("exiting, ret No_Limit [all ok]", __func__)
 	return No_Limit;
@@ -2017,24 +2008,22 @@ check_single_entity_res(enum lim_keytypes kt, char *ename,
 	int	  subjobs,
 	job	  *pjob)
 {
-	char *kstr;
+	char *rescn = newr->rs_defin->rs_name;
+	int rescid;
 	void               *ctx;
 	svr_entlim_leaf_t *plf;
 	int		   rc;
 	int i;
 	attribute  tmpval = {0};
 
-	kstr = entlim_mk_reskey(kt, ename, newr->rs_defin->rs_name);
-	if (kstr == NULL) {
-		log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER,
-			LOG_ALERT, msg_daemonname,
-			"rejecting job,  unable to make entity limit key, no memory");
-		ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, LIM_OVERALL)
-		return LIM_OVERALL;
+	/* no id means no limit or usage on this resource was ever recorded */
+	if ((rescid = entlim_resc_id(rescn)) == -1) {
+		ET_LIM_DBG("exiting, ret No_Limit [%s never limited]", __func__, rescn)
+		return No_Limit;
 	}
-	ET_LIM_DBG("kstr %s, %d, oldr %p", __func__, kstr, subjobs, oldr)
+	ET_LIM_DBG("entity %d:%s res %s, %d, oldr %p", __func__, (int)kt, ename, rescn, subjobs, oldr)
 	ctx = patr->at_val.at_enty.ae_tree;
-	plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+	plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, ename, rescid);
 
 	if (plf) {
 		tmpval = plf->slf_sum;
@@ -2057,13 +2046,12 @@ check_single_entity_res(enum lim_keytypes kt, char *ename,
 				limit_val = limit->al_value;
 			} else
 				limit_val = "(not_set)";
-			ET_LIM_DBG("res usage for %s is %s", __func__, kstr, sum_val)
-			ET_LIM_DBG("res specific limit for %s is %s", __func__, kstr, limit_val)
+			ET_LIM_DBG("res usage for %s is %s", __func__, ename, sum_val)
+			ET_LIM_DBG("res specific limit for %s is %s", __func__, ename, limit_val)
 			free(sum);
 			free(limit);
 		}
 	}
-	free(kstr);
 	if (plf && (is_attr_set(&plf->slf_limit))) {
 		/* check the specific user's limit */
 		rc = plf->slf_rescd->rs_comp(&tmpval, &plf->slf_limit);
@@ -2075,12 +2063,7 @@ check_single_entity_res(enum lim_keytypes kt, char *ename,
 		return Within_Limit;
 	} else if (kt != LIM_OVERALL) {
 		/* check against the generic limit if one */
-		kstr = entlim_mk_reskey(kt, PBS_GENERIC_ENTITY, newr->rs_defin->rs_name);
-		if (kstr == NULL) {
-			ET_LIM_DBG("exiting, ret No_Limit [generic limit]", __func__)
-			return No_Limit;
-		}
-		plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+		plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, PBS_GENERIC_ENTITY, rescid);
 		if (plf && (is_attr_set(&plf->slf_limit))) {
 			if (!(is_attr_set(&tmpval))) {  /* for no recorded usage for entity */
 				plf->slf_rescd->rs_set(&tmpval, &newr->rs_value, SET);
@@ -2090,13 +2073,12 @@ check_single_entity_res(enum lim_keytypes kt, char *ename,
 				if (will_log_event(PBSEVENT_DEBUG4) && (is_attr_set(&tmpval))) {
 					svrattrl *count;
 					plf->slf_rescd->rs_encode(&tmpval, NULL, "tmpval", NULL, ATR_ENCODE_CLIENT, &count);
-					ET_LIM_DBG("res generic limit for %s is %s", __func__, kstr, count->al_value)
+					ET_LIM_DBG("res generic limit for %s is %s", __func__, PBS_GENERIC_ENTITY, count->al_value)
 					free(count);
 				} else
-					ET_LIM_DBG("res generic limit for %s is (not_set)", __func__, kstr)
+					ET_LIM_DBG("res generic limit for %s is (not_set)", __func__, PBS_GENERIC_ENTITY)
 			}
 			rc = plf->slf_rescd->rs_comp(&tmpval, &plf->slf_limit);
-			free(kstr);
 			if (rc > 0) {
 				ET_LIM_DBG("exiting, ret Exceeds_Generic, rc=%d [generic limit]", __func__, rc)
 				return Exceeds_Generic;
@@ -2104,7 +2086,6 @@ check_single_entity_res(enum lim_keytypes kt, char *ename,
 			ET_LIM_DBG("exiting, ret Within_Limit, rc=%d [generic limit]", __func__, rc)
 			return Within_Limit;
 		}
-		free(kstr);
 	}
 	ET_LIM_DBG("exiting, ret No_Limit [all ok]", __func__)
 	return No_Limit;
@@ -3012,17 +2993,17 @@ set_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, job *pj
 	svr_entlim_leaf_t *plf;
 	int		   rc;
 
-	kstr = entlim_mk_runkey(kt, ename);
-	if (kstr == NULL) {
-		ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, PBSE_SYSTEM)
-		return (PBSE_SYSTEM);
-	}
-	ET_LIM_DBG("kstr %s, %d, %s", __func__, kstr, subjobs, (op==INCR)?"INCR":"DECR")
+	ET_LIM_DBG("entity %d:%s, %d, %s", __func__, (int)kt, ename, subjobs, (op==INCR)?"INCR":"DECR")
 	ctx = patr->at_val.at_enty.ae_tree;
-	plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+	plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, ename, ENTLIM_RUN_ID);
 	if (op == INCR) {
 		if (plf == NULL) {
 			/* add leaf for this entity-limit */
+			kstr = entlim_mk_runkey(kt, ename);
+			if (kstr == NULL) {
+				ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, PBSE_SYSTEM)
+				return (PBSE_SYSTEM);
+			}
 			if ((rc = alloc_svrleaf(NULL, &plf)) != PBSE_NONE) {
 				free(kstr);
 				ET_LIM_DBG("exiting, ret %d [alloc_svrleaf failed]", __func__, rc)
@@ -3034,13 +3015,13 @@ set_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, job *pj
 				ET_LIM_DBG("exiting, ret %d [entlim_add failed]", __func__, PBSE_SYSTEM)
 				return (PBSE_SYSTEM);
 			}
+			free(kstr);
 		}
 		plf->slf_sum.at_val.at_long += subjobs;
 		mark_attr_set(&plf->slf_sum);
 		ET_LIM_DBG("usage INCR to %ld, by %d", __func__, plf->slf_sum.at_val.at_long, subjobs)
 	} else {
 		if (plf == NULL) {
-			free(kstr);
 			/* Do not decrement what isn't there */
 			ET_LIM_DBG("exiting, ret %d [plf is NULL]", __func__, PBSE_INTERNAL)
 			return (PBSE_INTERNAL);
@@ -3052,11 +3033,13 @@ set_single_entity_ct(enum lim_keytypes kt, char *ename, attribute *patr, job *pj
 		if (plf->slf_sum.at_val.at_long < 0L) {
 			ET_LIM_DBG("zeroing usage, was %ld, by %d", __func__, plf->slf_sum.at_val.at_long, subjobs)
 			plf->slf_sum.at_val.at_long = 0L;
-			snprintf(log_buffer, LOG_BUF_SIZE-1, "set_single_entity_ct zeroing negative usage for %s", kstr);
-			log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER , LOG_WARNING, msg_daemonname, log_buffer);
+			if ((kstr = entlim_mk_runkey(kt, ename)) != NULL) {
+				snprintf(log_buffer, LOG_BUF_SIZE-1, "set_single_entity_ct zeroing negative usage for %s", kstr);
+				log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER , LOG_WARNING, msg_daemonname, log_buffer);
+				free(kstr);
+			}
 		}
 	}
-	free(kstr);
 	ET_LIM_DBG("exiting, ret 0 [all ok]", __func__)
 	return PBSE_NONE;
 }
@@ -3093,21 +3076,13 @@ set_single_entity_res(enum lim_keytypes kt, char *ename,
 	int		   i;
 	attribute tmpval = newval->rs_value;
 
-	kstr = entlim_mk_reskey(kt, ename, rescn);
-	if (kstr == NULL) {
-		snprintf(log_buffer, LOG_BUF_SIZE-1, "Error in entlim_mk_reskey for rescn %s", rescn);
-		log_err(-1, __func__, log_buffer);
-		ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, PBSE_SYSTEM)
-		return (PBSE_SYSTEM);
-	}
-	ET_LIM_DBG("kstr %s, %d, %s, res %s, %p", __func__, kstr,
+	ET_LIM_DBG("entity %d:%s, %d, %s, res %s, %p", __func__, (int)kt, ename,
 			subjobs, (op==INCR)?"INCR":"DECR", rescn, oldval)
 	ctx = patr->at_val.at_enty.ae_tree;
-	plf = (svr_entlim_leaf_t *)entlim_get(kstr, ctx);
+	plf = (svr_entlim_leaf_t *)entlim_get_id(ctx, kt, ename, entlim_resc_id(rescn));
 
 	if (oldval && plf) {
 		if (!(plf->slf_rescd->rs_comp(&tmpval, &oldval->rs_value))) {
-			free(kstr);
 			ET_LIM_DBG("exiting, ret 0 [newval == oldval]", __func__)
 			return PBSE_NONE;
 		}
@@ -3144,6 +3119,13 @@ set_single_entity_res(enum lim_keytypes kt, char *ename,
 		/* increment resource by newval, subtracting oldval if there */
 		if (plf == NULL) {
 			/* add leaf for this entity-limit */
+			kstr = entlim_mk_reskey(kt, ename, rescn);
+			if (kstr == NULL) {
+				snprintf(log_buffer, LOG_BUF_SIZE-1, "Error in entlim_mk_reskey for rescn %s", rescn);
+				log_err(-1, __func__, log_buffer);
+				ET_LIM_DBG("exiting, ret %d [kstr is NULL]", __func__, PBSE_SYSTEM)
+				return (PBSE_SYSTEM);
+			}
 			if ((rc = alloc_svrleaf(rescn, &plf)) != PBSE_NONE) {
 				free(kstr);
 				ET_LIM_DBG("exiting, ret %d [alloc_svrleaf failed]", __func__, rc)
@@ -3157,6 +3139,7 @@ set_single_entity_res(enum lim_keytypes kt, char *ename,
 				ET_LIM_DBG("exiting, ret %d [entlim_add failed]", __func__, PBSE_SYSTEM)
 				return (PBSE_SYSTEM);
 			}
+			free(kstr);
 		}
 
 		for (i = 0; i < subjobs; i++) {
@@ -3177,9 +3160,8 @@ set_single_entity_res(enum lim_keytypes kt, char *ename,
 		/* decrement resource by newval, adding oldval if there */
 		if (plf == NULL) {
 			/* Do not decrement what isn't there */
-			snprintf(log_buffer, LOG_BUF_SIZE-1, "decrementing resource for reskey %s: isn't found in attribute tree", kstr);
+			snprintf(log_buffer, LOG_BUF_SIZE-1, "decrementing resource %s for entity %s: isn't found in attribute tree", rescn, ename);
 			log_err(-1, __func__, log_buffer);
-			free(kstr);
 			ET_LIM_DBG("exiting, ret %d [plf is NULL]", __func__, PBSE_INTERNAL)
 			return (PBSE_INTERNAL);
 		}
@@ -3201,12 +3183,14 @@ set_single_entity_res(enum lim_keytypes kt, char *ename,
 		if (plf->slf_rescd->rs_comp(&plf->slf_sum, &tmpval) < 0) {
 			ET_LIM_DBG("zeroing res usage", __func__)
 			plf->slf_sum = tmpval;
-			snprintf(log_buffer, LOG_BUF_SIZE-1, "set_single_entity_res zeroing negative usage for %s-%s", plf->slf_rescd->rs_name, kstr);
-			log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER , LOG_WARNING, msg_daemonname, log_buffer);
+			if ((kstr = entlim_mk_reskey(kt, ename, rescn)) != NULL) {
+				snprintf(log_buffer, LOG_BUF_SIZE-1, "set_single_entity_res zeroing negative usage for %s-%s", plf->slf_rescd->rs_name, kstr);
+				log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER , LOG_WARNING, msg_daemonname, log_buffer);
+				free(kstr);
+			}
 		}
 	}
 
-	free(kstr);
 	ET_LIM_DBG("exiting, ret 0 [all ok]", __func__)
 	return PBSE_NONE;
 }
@@ -4797,6 +4781,60 @@ free_prov_vnode(struct pbsnode * pnode)
 	}
 }
 
+/**
+ * @brief
+ *		Checks one provisioning vnode of a job.
+ *
+ * @param[in]   vnode	-	name of the vnode
+ * @param[in]   aoe_req	-	aoe the job requested
+ *
+ * @return	int
+ * @retval	0	: vnode is done provisioning with aoe_req
+ * @retval	-1	: vnode is still provisioning
+ * @retval	-2	: vnode is gone or offline
+ * @retval	-3	: vnode is done provisioning, but curr_aoe does not
+ *					match req_aoe
+ *
+ * @par MT-safe: No
+ *
+ */
+
+static int
+prov_vnode_state(char *vnode, char *aoe_req)
+{
+	struct pbsnode	*np;
+	char		*current_aoe = NULL;
+
+	np = find_nodebyname(vnode);
+	if (np == NULL) {
+		DBPRT(("%s: node %s is null\n", __func__, vnode))
+		return -2;
+	}
+
+	/* check if vnode offline, since it could have failed prov */
+	if (np->nd_state & (INUSE_OFFLINE|INUSE_OFFLINE_BY_MOM)) {
+		DBPRT(("%s: vnode %s is offline (failed prov)\n",
+			__func__, np->nd_name))
+		return -2;
+	}
+
+	if ((np->nd_state & INUSE_PROV) || (np->nd_state & INUSE_WAIT_PROV)) {
+		DBPRT(("%s: vnode %s still provisioning\n", __func__, np->nd_name))
+		return -1;
+	}
+
+	/* check if node has the correct aoe or not */
+	if (np->nd_attr[(int)ND_ATR_current_aoe].at_flags & ATR_VFLAG_SET)
+		current_aoe = np->nd_attr[(int)ND_ATR_current_aoe].at_val.at_str;
+
+	if ((current_aoe == NULL) || strcmp(current_aoe, aoe_req) != 0) {
+		DBPRT(("%s: req_aoe mismatch on %s\n", __func__, vnode))
+		return -3;
+	}
+
+	return 0;
+}
+
 /**
  * @brief
  *		Determines if job can be run on account of a vnode finishing
@@ -4835,14 +4873,12 @@ free_prov_vnode(struct pbsnode * pnode)
 static int
 is_runnable(job *ptr, struct prov_vnode_info *pvnfo)
 {
-	struct			pbsnode	*np = NULL;
 	int			i;
 	int			eflag = 0;
 	exec_vnode_listtype 	prov_vnode_list=NULL;
 	int			num_of_prov_vnodes = 1;
 	job			*pjob;
 	char			*aoe_req=NULL;
-	char			*current_aoe;
 
 
 	if (!ptr) {
@@ -4875,48 +4911,8 @@ is_runnable(job *ptr, struct prov_vnode_info *pvnfo)
 	}
 
 	for (i = 0; i < num_of_prov_vnodes; i++) {
-
-		np = find_nodebyname(prov_vnode_list[i]);
-		if (np == NULL) {
-			DBPRT(("%s: node %s is null\n",
-				__func__, prov_vnode_list[i]))
-			eflag = -2;
-			/* let eflag get overwritten in next iterations
-			 by other conditions */
-			break;
-		}
-
-		/* check if vnode offline, since it could have failed prov */
-		if (np->nd_state & (INUSE_OFFLINE|INUSE_OFFLINE_BY_MOM)) {
-
-			DBPRT(("%s: vnode %s is offline (failed prov)\n",
-				__func__, np->nd_name))
-			eflag = -2;
+		if ((eflag = prov_vnode_state(prov_vnode_list[i], aoe_req)) != 0)
 			break;
-
-		} else if ((np->nd_state & INUSE_PROV) ||
-			(np->nd_state & INUSE_WAIT_PROV)) {
-			/* Check any vnode is provisioning */
-			eflag = -1;
-			DBPRT(("%s: Some nodes still provisioning\n", __func__))
-			break;
-		} else {
-			/* check if node has the correct aoe or not */
-			current_aoe = NULL;
-			if (np->nd_attr[(int)ND_ATR_current_aoe].at_flags
-				& ATR_VFLAG_SET)
-				current_aoe =
-					np->nd_attr[(int)ND_ATR_current_aoe].
-				at_val.at_str;
-
-			if ((current_aoe == NULL) ||
-				strcmp(current_aoe,  aoe_req) != 0) {
-				eflag = -3;
-				DBPRT(("%s: req_aoe mismatch on %s\n",
-					__func__, prov_vnode_list[i]))
-				break;
-			}
-		}
 	}
 label1:
 
@@ -5280,7 +5276,19 @@ check_and_run_jobs(struct prov_vnode_info * prov_vnode_info)
 	if (pjob == NULL)
 		return;
 
-	rc = is_runnable(pjob, prov_vnode_info);
+	/*
+	 * While other vnodes of the job are still provisioning only the one
+	 * that came up needs a look.  All of them are checked once the last
+	 * one is done.
+	 */
+	if (pjob->ji_prov_pending > 1 && check_job_substate(pjob, JOB_SUBSTATE_PROVISION)) {
+		rc = prov_vnode_state(prov_vnode_info->pvnfo_vnode, prov_vnode_info->pvnfo_aoe_req);
+		if (rc == 0) {
+			pjob->ji_prov_pending--;
+			return;
+		}
+	} else
+		rc = is_runnable(pjob, prov_vnode_info);
 
 
 	if (rc == 0) {
@@ -6307,6 +6315,9 @@ check_and_enqueue_provisioning(job *pjob, int *need_prov)
 		set_vnode_state(pnode, INUSE_WAIT_PROV, Nd_State_Or);
 	}
 
+	/* the job is started when the last of its vnodes is done */
+	pjob->ji_prov_pending = num_of_prov_vnodes;
+
 	/*
 	 * then start a immediate work task to start provisioning
 	 * based on max allowed provisioings - start an immediate
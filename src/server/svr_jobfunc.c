@@ -102,6 +102,47 @@ char statechars[] = "TQHWREXBMF";
 
 /* Private Functions */
 
+/* jobs of each owner, keyed by the user name part of job_owner */
+struct owner_jobs {
+	pbs_list_head oj_jobs;	/* linked through ji_ownerjobs, in qrank order */
+	char oj_name[PBS_MAXUSER + 1];
+};
+static void *owner_idx = NULL;
+
+static void owner_link_job(job *, int);
+
+/* history jobs in history_timestamp order, see svr_clean_job_history() */
+static pbs_list_head svr_histjobs = {&svr_histjobs, &svr_histjobs, NULL};
+
+static void histjob_link(job *);
+
+/*
+ * Attributes a finished history job gives up, see histjob_compact().
+ * Nothing in the server reads them once the job ended, and together
+ * with the job's environment they hold most of its memory.
+ */
+static int histjob_drop_attrs[] = {
+	JOB_ATR_variables,
+	JOB_ATR_exec_vnode,
+	JOB_ATR_exec_vnode_acct,
+	JOB_ATR_exec_vnode_deallocated,
+	JOB_ATR_exec_vnode_orig,
+	JOB_ATR_exec_host,
+	JOB_ATR_exec_host_acct,
+	JOB_ATR_exec_host_orig,
+	JOB_ATR_resource_orig,
+	JOB_ATR_resource_acct,
+	JOB_ATR_resc_used_acct,
+	JOB_ATR_resc_used_update,
+	JOB_ATR_SchedSelect,
+	JOB_ATR_SchedSelect_orig,
+	JOB_ATR_submit_arguments,
+	JOB_ATR_executable,
+	JOB_ATR_Arglist,
+	JOB_ATR_resc_released,
+	JOB_ATR_resc_released_list,
+	JOB_ATR_LAST
+};
 static void default_std(job *, int key, char * to);
 static void Time4reply(struct work_task  *);
 static void Time4resv(struct work_task*);
@@ -147,9 +188,37 @@ extern void free_job_work_tasks(job *);
 
 /* Private Functions */
 
-#ifndef NDEBUG
-static void correct_ct(pbs_queue *);
-#endif 	/* NDEBUG */
+/**
+ * @brief
+ *		Move a job that is counted by the server to another state number
+ *		in the job state counts of the server and of its queue.  The
+ *		counts always follow ji_ctstate, the state the job was counted
+ *		under, so they stay exact whatever the state attribute is set to
+ *		in between.
+ *
+ * @param[in,out]	pjob	-	the job
+ * @param[in]	state_num	-	the new state number, -1 to take it out of the counts
+ */
+static void
+jobstate_count(job *pjob, int state_num)
+{
+	pbs_queue *pque = pjob->ji_qhdr;
+
+	if (!pjob->ji_counted || pjob->ji_ctstate == state_num)
+		return;
+
+	if (pjob->ji_ctstate != -1) {
+		server.sv_jobstates[pjob->ji_ctstate]--;
+		if (pque != NULL)
+			pque->qu_njstate[pjob->ji_ctstate]--;
+	}
+	if (state_num != -1) {
+		server.sv_jobstates[state_num]++;
+		if (pque != NULL)
+			pque->qu_njstate[state_num]++;
+	}
+	pjob->ji_ctstate = state_num;
+}
 
 /**
  * @brief
@@ -231,16 +300,18 @@ svr_enquejob(job *pjob)
 		 */
 		if ((check_job_state(pjob, JOB_STATE_LTR_MOVED)) ||
 			(check_job_state(pjob, JOB_STATE_LTR_FINISHED))) {
-			if (is_linked(&svr_alljobs, &pjob->ji_alljobs) == 0) {
+			if (!pjob->ji_counted) {
 				if (pbs_idx_insert(jobs_idx, pjob->ji_qs.ji_jobid, pjob) != PBS_IDX_RET_OK) {
 					log_joberr(PBSE_INTERNAL, __func__, "Failed add history job in index", pjob->ji_qs.ji_jobid);
 					return PBSE_INTERNAL;
 				}
 				append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
+				owner_link_job(pjob, 0);
+				pjob->ji_counted = 1;
+				server.sv_qs.sv_numjobs++;
 			}
-			server.sv_qs.sv_numjobs++;
-			if (state_num != -1)
-				server.sv_jobstates[state_num]++;
+			histjob_link(pjob);
+			jobstate_count(pjob, state_num);
 			if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
 				struct ajtrkhd *ptbl = pjob->ji_ajtrk;
 				if (ptbl) {
@@ -286,10 +357,10 @@ svr_enquejob(job *pjob)
 		insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
 			LINK_INSET_AFTER);
 	}
+	owner_link_job(pjob, 1);
 
+	pjob->ji_counted = 1;
 	server.sv_qs.sv_numjobs++;
-	if (state_num != -1)
-		server.sv_jobstates[state_num]++;
 
 	/* place into queue in order of queue rank starting at end */
 
@@ -311,11 +382,13 @@ svr_enquejob(job *pjob)
 			LINK_INSET_AFTER);
 	}
 
-	/* update counts: queue and queue by state */
+	/* update counts: server and queue by state, and queue */
 
 	pque->qu_numjobs++;
-	if (state_num != -1)
-		pque->qu_njstate[state_num]++;
+	jobstate_count(pjob, state_num);
+	route_wakeup(pjob);
+
+	histjob_link(pjob);
 
 	if ((check_job_state(pjob, JOB_STATE_LTR_MOVED)) ||
 		(check_job_state(pjob, JOB_STATE_LTR_FINISHED))) {
@@ -441,6 +514,299 @@ svr_enquejob(job *pjob)
 	return (0);
 }
 
+/**
+ * @brief
+ * 		find_owner - find the owner_jobs entry of a user
+ *
+ * @param[in]	owner	-	user name, anything from '@' on is ignored
+ * @param[in]	create	-	create the entry if there is none
+ *
+ * @return	struct owner_jobs *
+ * @retval	NULL	: no such entry, or out of memory when create is set
+ */
+static struct owner_jobs *
+find_owner(char *owner, int create)
+{
+	char name[PBS_MAXUSER + 1];
+	char *pc;
+	struct owner_jobs *poj = NULL;
+	void *key;
+
+	if (owner == NULL)
+		return NULL;
+	pbs_strncpy(name, owner, sizeof(name));
+	if ((pc = strchr(name, '@')) != NULL)
+		*pc = '\0';
+
+	if (owner_idx == NULL) {
+		if (!create || (owner_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+			return NULL;
+	}
+	key = name;
+	if (pbs_idx_find(owner_idx, &key, (void **)&poj, NULL) == PBS_IDX_RET_OK)
+		return poj;
+	if (!create)
+		return NULL;
+
+	if ((poj = malloc(sizeof(struct owner_jobs))) == NULL) {
+		log_err(errno, __func__, "Out of memory");
+		return NULL;
+	}
+	CLEAR_HEAD(poj->oj_jobs);
+	strcpy(poj->oj_name, name);
+	if (pbs_idx_insert(owner_idx, poj->oj_name, poj) != PBS_IDX_RET_OK) {
+		free(poj);
+		return NULL;
+	}
+	return poj;
+}
+
+/**
+ * @brief
+ * 		owner_link_job - add a job to the list of jobs of its owner, in the
+ *		same qrank order as svr_alljobs
+ *
+ * @param[in]	pjob	-	job being enqueued
+ * @param[in]	ranked	-	insert by qrank, else append
+ */
+static void
+owner_link_job(job *pjob, int ranked)
+{
+	struct owner_jobs *poj;
+	job *pjcur;
+
+	if ((poj = find_owner(get_jattr_str(pjob, JOB_ATR_job_owner), 1)) == NULL) {
+		log_joberr(PBSE_INTERNAL, __func__, "Failed to add job to owner index", pjob->ji_qs.ji_jobid);
+		return;
+	}
+
+	delete_link(&pjob->ji_ownerjobs);
+	if (!ranked) {
+		append_link(&poj->oj_jobs, &pjob->ji_ownerjobs, pjob);
+		return;
+	}
+	pjcur = (job *)GET_PRIOR(poj->oj_jobs);
+	while (pjcur) {
+		if (get_jattr_long(pjob, JOB_ATR_qrank) >= get_jattr_long(pjcur, JOB_ATR_qrank))
+			break;
+		pjcur = (job *)GET_PRIOR(pjcur->ji_ownerjobs);
+	}
+	if (pjcur == NULL)
+		insert_link(&poj->oj_jobs, &pjob->ji_ownerjobs, pjob, LINK_INSET_AFTER);
+	else
+		insert_link(&pjcur->ji_ownerjobs, &pjob->ji_ownerjobs, pjob, LINK_INSET_AFTER);
+}
+
+/**
+ * @brief
+ * 		owner_unlink_job - remove a job from the list of jobs of its owner,
+ *		dropping the owner's entry with its last job
+ *
+ * @param[in]	pjob	-	job being dequeued or freed
+ */
+void
+owner_unlink_job(job *pjob)
+{
+	struct owner_jobs *poj;
+
+	if (pjob->ji_ownerjobs.ll_next == NULL || pjob->ji_ownerjobs.ll_next == &pjob->ji_ownerjobs)
+		return;	/* not linked */
+	delete_link(&pjob->ji_ownerjobs);
+
+	poj = find_owner(get_jattr_str(pjob, JOB_ATR_job_owner), 0);
+	if (poj != NULL && GET_NEXT(poj->oj_jobs) == NULL) {
+		(void)pbs_idx_delete(owner_idx, poj->oj_name);
+		free(poj);
+	}
+}
+
+/**
+ * @brief
+ * 		histjob_link - add a history job to the list of history jobs, in
+ *		history_timestamp order.  A job recovered without a history
+ *		timestamp gets one here.
+ *
+ * @param[in]	pjob	-	job being enqueued or made a history job
+ */
+static void
+histjob_link(job *pjob)
+{
+	job *pjcur;
+	long ts;
+	int walltime_used;
+
+	if (!check_job_state(pjob, JOB_STATE_LTR_MOVED) &&
+		!check_job_state(pjob, JOB_STATE_LTR_FINISHED) &&
+		!check_job_state(pjob, JOB_STATE_LTR_EXPIRED))
+		return;
+
+	if (!(is_jattr_set(pjob, JOB_ATR_history_timestamp))) {
+		if (check_job_state(pjob, JOB_STATE_LTR_MOVED))
+			set_jattr_l_slim(pjob, JOB_ATR_history_timestamp, time_now, SET);
+		else {
+			if (((walltime_used = get_used_wall(pjob)) == -1) ||
+				!(is_jattr_set(pjob, JOB_ATR_stime))) {
+				log_joberr(-1, __func__,
+					"Finished job missing start-time/walltime used, cannot clean history",
+					pjob->ji_qs.ji_jobid);
+				return;
+			}
+			set_jattr_l_slim(pjob, JOB_ATR_history_timestamp,
+					get_jattr_long(pjob, JOB_ATR_stime) + walltime_used, SET);
+		}
+		pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
+		job_save_db(pjob);
+	}
+	ts = get_jattr_long(pjob, JOB_ATR_history_timestamp);
+
+	/* jobs mostly become history in timestamp order, so search from the end */
+	delete_link(&pjob->ji_histjobs);
+	pjcur = (job *)GET_PRIOR(svr_histjobs);
+	while (pjcur) {
+		if (ts >= get_jattr_long(pjcur, JOB_ATR_history_timestamp))
+			break;
+		pjcur = (job *)GET_PRIOR(pjcur->ji_histjobs);
+	}
+	if (pjcur == NULL)
+		insert_link(&svr_histjobs, &pjob->ji_histjobs, pjob, LINK_INSET_AFTER);
+	else
+		insert_link(&pjcur->ji_histjobs, &pjob->ji_histjobs, pjob, LINK_INSET_AFTER);
+
+	/* a job just recovered is all in the database */
+	if ((server.sv_attr[SVR_ATR_State].at_val.at_long == SV_STATE_INIT) &&
+		(pjob->ji_pendsave.ll_next == &pjob->ji_pendsave))
+		histjob_compact(pjob);
+}
+
+/**
+ * @brief
+ * 		histjob_unlink - remove a job from the list of history jobs
+ *
+ * @param[in]	pjob	-	job being freed
+ */
+void
+histjob_unlink(job *pjob)
+{
+	if (pjob->ji_histjobs.ll_next == NULL)
+		return;
+	delete_link(&pjob->ji_histjobs);
+}
+
+/**
+ * @brief
+ * 		histjob_attr_dropped - tell whether a compacted history job gave
+ *		up an attribute
+ *
+ * @param[in]	attr_idx	-	index of the job attribute
+ *
+ * @return	int
+ * @retval	1	: the attribute is not kept by compacted history jobs
+ * @retval	0	: otherwise
+ */
+int
+histjob_attr_dropped(int attr_idx)
+{
+	int i;
+
+	for (i = 0; histjob_drop_attrs[i] != JOB_ATR_LAST; i++)
+		if (histjob_drop_attrs[i] == attr_idx)
+			return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		histjob_compact - free the attributes of a finished history job
+ *		that are only needed to status it in full.  They stay in the
+ *		database and histjob_expand() loads them back on demand.
+ *
+ * @par
+ *		Must only be called when everything the job holds has been
+ *		written, or queued to be written, to the database.
+ *
+ * @param[in,out]	pjob	-	the history job
+ */
+void
+histjob_compact(job *pjob)
+{
+	int i;
+
+	if (pjob->ji_histcompact || !svr_history_enable || pjob->newobj)
+		return;
+	if (!check_job_state(pjob, JOB_STATE_LTR_FINISHED) &&
+		!check_job_state(pjob, JOB_STATE_LTR_EXPIRED))
+		return;
+
+	for (i = 0; histjob_drop_attrs[i] != JOB_ATR_LAST; i++) {
+		if (is_jattr_set(pjob, histjob_drop_attrs[i]))
+			free_jattr(pjob, histjob_drop_attrs[i]);
+	}
+	release_brp_enc(pjob->ji_stat_enc[0]);
+	release_brp_enc(pjob->ji_stat_enc[1]);
+	pjob->ji_stat_enc[0] = NULL;
+	pjob->ji_stat_enc[1] = NULL;
+	job_alloc_free(pjob);
+	pjob->ji_histcompact = 1;
+}
+
+/**
+ * @brief
+ * 		histjob_expand - load the attributes a compacted history job gave
+ *		up back from the database.  The attributes the job kept are left
+ *		alone, they may be newer than the database.
+ *
+ * @param[in,out]	pjob	-	the history job
+ *
+ * @return	int
+ * @retval	0	: the job holds all of its attributes
+ * @retval	-1	: the job could not be loaded from the database
+ */
+int
+histjob_expand(job *pjob)
+{
+	job *ptmp;
+	int i;
+	int idx;
+
+	if (!pjob->ji_histcompact)
+		return 0;
+
+	if ((ptmp = job_recov_db(pjob->ji_qs.ji_jobid, NULL)) == NULL) {
+		log_joberr(PBSE_INTERNAL, __func__, "Failed to load history job attributes", pjob->ji_qs.ji_jobid);
+		return -1;
+	}
+	for (i = 0; histjob_drop_attrs[i] != JOB_ATR_LAST; i++) {
+		idx = histjob_drop_attrs[i];
+		if (!is_jattr_set(ptmp, idx))
+			continue;
+		if (set_attr_with_attr(&job_attr_def[idx], &pjob->ji_wattr[idx], &ptmp->ji_wattr[idx], SET) == 0)
+			pjob->ji_wattr[idx].at_flags &= ~ATR_VFLAG_MODIFY;	/* same as the database */
+	}
+	job_free(ptmp);
+	pjob->ji_histcompact = 0;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		find_owner_jobs - get the jobs owned by a user
+ *
+ * @param[in]	owner	-	user name, anything from '@' on is ignored
+ *
+ * @return	job *
+ * @retval	first job of the owner, the others follow through ji_ownerjobs
+ * @retval	NULL	: the user owns no job
+ */
+job *
+find_owner_jobs(char *owner)
+{
+	struct owner_jobs *poj;
+
+	if ((poj = find_owner(owner, 0)) == NULL)
+		return NULL;
+	return (job *)GET_NEXT(poj->oj_jobs);
+}
+
 /**
  * @brief
  * 		svr_dequejob() - remove job from whatever queue its in and reduce counts
@@ -451,25 +817,22 @@ svr_enquejob(job *pjob)
 void
 svr_dequejob(job *pjob)
 {
-	int	   bad_ct = 0;
 	pbs_queue *pque;
-	int state_num;
 
-	/* remove job from server's all job list and reduce server counts */
+	/* take the job out of the server and queue state counts */
 
-	if (is_linked(&svr_alljobs, &pjob->ji_alljobs)) {
-		int state_num;
+	jobstate_count(pjob, -1);
+
+	/* remove job from server's all job list and reduce server counts */
 
+	if (pjob->ji_counted) {
 		delete_link(&pjob->ji_alljobs);
 		delete_link(&pjob->ji_unlicjobs);
+		owner_unlink_job(pjob);
 		if (pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid) != PBS_IDX_RET_OK)
 			log_joberr(PBSE_INTERNAL, __func__, "Failed to delete job from index", pjob->ji_qs.ji_jobid);
-		if (--server.sv_qs.sv_numjobs < 0)
-			bad_ct = 1;
-
-		state_num = get_job_state_num(pjob);
-		if (state_num != -1 && --server.sv_jobstates[state_num] < 0)
-			bad_ct = 1;
+		server.sv_qs.sv_numjobs--;
+		pjob->ji_counted = 0;
 	}
 
 	if ((pque = pjob->ji_qhdr) != NULL) {
@@ -480,16 +843,11 @@ svr_dequejob(job *pjob)
 				pjob->ji_etlimit_decr_queued ? ETLIM_ACC_ALL_MAX : ETLIM_ACC_ALL);
 
 
-		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
-			delete_link(&pjob->ji_jobque);
-			if (--pque->qu_numjobs < 0)
-				bad_ct = 1;
-
-			state_num = get_job_state_num(pjob);
-			if (state_num != -1 && --pque->qu_njstate[state_num] < 0)
-				bad_ct = 1;
-		}
+		/* a job with a queue header is always in the queue's list */
+		delete_link(&pjob->ji_jobque);
+		pque->qu_numjobs--;
 		pjob->ji_qhdr = NULL;
+		route_changed();
 	}
 
 #ifndef NDEBUG
@@ -497,8 +855,6 @@ svr_dequejob(job *pjob)
 		pque ? pque->qu_qs.qu_name : "", get_job_state(pjob));
 	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 		pjob->ji_qs.ji_jobid, log_buffer);
-	if (bad_ct) 		/* state counts are all messed up */
-		correct_ct(pque);
 #endif	/* NDEBUG */
 
 	mark_jattr_not_set(pjob, JOB_ATR_qtime);
@@ -507,6 +863,22 @@ svr_dequejob(job *pjob)
 	clear_default_resc(pjob);
 }
 
+/**
+ * @brief
+ * 		svr_chgjobstate - set only the state of a job and move it in the
+ *		server/queue state counts, without any of the other work of
+ *		svr_setjobstate().  For jobs about to be aborted or purged.
+ *
+ * @param[in,out]	pjob	-	The job to be operated on.
+ * @param[in]	newstate	-	new job state
+ */
+void
+svr_chgjobstate(job *pjob, char newstate)
+{
+	jobstate_count(pjob, state_char2int(newstate));
+	set_job_state(pjob, newstate);
+}
+
 /**
  * @brief
  * 		svr_setjobstate - set the job state, update the server/queue state counts,
@@ -526,6 +898,7 @@ svr_setjobstate(job *pjob, char newstate, int newsubstate)
 {
 	pbs_queue *pque = pjob->ji_qhdr;
 	pbs_sched *psched;
+	char prevstate;
 
 	/*
 	 * If the job has already finished, then do not make any new changes
@@ -546,20 +919,9 @@ svr_setjobstate(job *pjob, char newstate, int newsubstate)
 		/* if the state is changing, also update the state counts */
 
 		if (oldstate != newstate) {
-			int oldstatenum;
-			int newstatenum;
-
-			oldstatenum = state_char2int(oldstate);
-			newstatenum = state_char2int(newstate);
-			if (oldstatenum != -1)
-				server.sv_jobstates[oldstatenum]--;
-			if (newstatenum != -1)
-				server.sv_jobstates[newstatenum]++;
+			jobstate_count(pjob, state_char2int(newstate));
 			if (pque != NULL) {
-				if (oldstatenum != -1)
-					pque->qu_njstate[oldstatenum]--;
-				if (newstatenum != -1)
-					pque->qu_njstate[newstatenum]++;
+				route_changed();
 
 				/*
 				 * if execution queue, and eligability to run
@@ -595,8 +957,11 @@ svr_setjobstate(job *pjob, char newstate, int newsubstate)
 	}
 
 	/* set the states accordingly */
+	prevstate = get_job_state(pjob);
 	set_job_state(pjob, newstate);
 	set_job_substate(pjob, newsubstate);
+	if (prevstate != newstate)
+		svr_event_job(pjob);
 
 	/* eligible_time_enable */
 	if (server.sv_attr[SVR_ATR_EligibleTimeEnable].at_val.at_long == 1) {
@@ -808,23 +1173,27 @@ chk_svr_resc_limit(attribute *jobatr, attribute *queatr,
 	resource *svrc;
 	resource *cmpwith;
 	static resource_def *noderesc = NULL;
+	static resc_lookup qulk;
+	static resc_lookup svlk;
 
 	if (noderesc == NULL) {
 		noderesc = 	&svr_resc_def[RESC_NODES];
 	}
 	comp_resc_gt = 0;
 	comp_resc_lt = 0;
+	resc_lookup_load(&qulk, queatr);
+	resc_lookup_load(&svlk, svratr);
 
 	jbrc = (resource *)GET_NEXT(jobatr->at_val.at_list);
 	while (jbrc) {
 		cmpwith = 0;
 		if (is_attr_set(&jbrc->rs_value)) {
-			qurc = find_resc_entry(queatr, jbrc->rs_defin);
+			qurc = resc_lookup_find(&qulk, jbrc->rs_defin);
 			if ((qurc == 0) ||
 				((is_attr_set(&qurc->rs_value))==0)) {
 				/* queue limit not set, check server's */
 
-				svrc = find_resc_entry(svratr, jbrc->rs_defin);
+				svrc = resc_lookup_find(&svlk, jbrc->rs_defin);
 				if ((svrc != 0) &&
 					(is_attr_set(&svrc->rs_value))) {
 					cmpwith = svrc;
@@ -1915,15 +2284,15 @@ set_select_and_place(int objtype, void *pobj, attribute *patr)
 int
 set_chunk_sum(attribute  *pselectattr, attribute *pattr)
 {
-	char     *chunk;
 	int       i;
 	int       j;
+	int       k;
 	int       nchk;
-	int       nelem;
 	int	  rc;
 	int	  default_flag;
 	int	  total_chunks = 0;
 	struct key_value_pair *pkvp;
+	parsed_select	  *ps;
 	resource	  *presc;
 	resource_def	  *pdef;
 	static attribute   tmpatr;
@@ -1955,48 +2324,43 @@ set_chunk_sum(attribute  *pselectattr, attribute *pattr)
 		presc = (resource *)GET_NEXT(presc->rs_link);
 	}
 
-	/* now, parse the select directive */
+	/* now, walk the parsed select directive */
 
-	chunk = parse_plus_spec(pselectattr->at_val.at_str, &rc);
-	if (rc != 0)
-		return rc;
-	while (chunk) {
-#ifdef NAS /* localmod 082 */
-		if (parse_chunk(chunk, 0, &nchk, &nelem, &pkvp, NULL) == 0)
-#else
-		if (parse_chunk(chunk, &nchk, &nelem, &pkvp, NULL) == 0)
-#endif /* localmod 082 */
-		{
-			total_chunks += nchk;
-			for (j=0; j<nelem; ++j) {
-				for (i=0; svr_resc_sum[i].rs_def; ++i) {
-					if (strcmp(svr_resc_sum[i].rs_def->rs_name, pkvp[j].kv_keyw) == 0) {
-						rc = svr_resc_sum[i].rs_def->rs_decode(&tmpatr, 0,
-							0, pkvp[j].kv_val);
-						if (rc != 0)
-							return rc;
-						else if (!is_attr_set(&tmpatr))
-							return PBSE_BADATVAL;	/* illegal null value */
-						if (svr_resc_sum[i].rs_def->rs_type == ATR_TYPE_SIZE)
-							tmpatr.at_val.at_size.atsv_num *= nchk;
-						else if (svr_resc_sum[i].rs_def->rs_type == ATR_TYPE_FLOAT)
-							tmpatr.at_val.at_float *= nchk;
-						else
-							tmpatr.at_val.at_long *= nchk;
+	if ((ps = get_parsed_select(pselectattr->at_val.at_str)) == NULL)
+		return PBSE_SYSTEM;
+	for (k = 0; k < ps->ps_nchunks; k++) {
+		sel_chunk *sc = &ps->ps_chunks[k];
 
-						(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &tmpatr, INCR);
-						svr_resc_sum[i].rs_set = 1;
-						break;
-					}
+		if (sc->sc_rc != 0)
+			return (PBSE_BADATVAL);
+		nchk = sc->sc_nchk;
+		pkvp = sc->sc_kv;
+		total_chunks += nchk;
+		for (j=0; j<sc->sc_nelem; ++j) {
+			for (i=0; svr_resc_sum[i].rs_def; ++i) {
+				if (strcmp(svr_resc_sum[i].rs_def->rs_name, pkvp[j].kv_keyw) == 0) {
+					rc = svr_resc_sum[i].rs_def->rs_decode(&tmpatr, 0,
+						0, pkvp[j].kv_val);
+					if (rc != 0)
+						return rc;
+					else if (!is_attr_set(&tmpatr))
+						return PBSE_BADATVAL;	/* illegal null value */
+					if (svr_resc_sum[i].rs_def->rs_type == ATR_TYPE_SIZE)
+						tmpatr.at_val.at_size.atsv_num *= nchk;
+					else if (svr_resc_sum[i].rs_def->rs_type == ATR_TYPE_FLOAT)
+						tmpatr.at_val.at_float *= nchk;
+					else
+						tmpatr.at_val.at_long *= nchk;
+
+					(void)svr_resc_sum[i].rs_def->rs_set(&svr_resc_sum[i].rs_attr, &tmpatr, INCR);
+					svr_resc_sum[i].rs_set = 1;
+					break;
 				}
 			}
-		} else {
-			return (PBSE_BADATVAL);
 		}
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return rc;
 	}
+	if (ps->ps_rc != 0)
+		return ps->ps_rc;
 
 	/* check that the user asked for at least one chunk total */
 
@@ -2100,11 +2464,13 @@ set_deflt_resc(attribute *jb, attribute *dflt, int selflg)
 	resource       *prescdt;
 	resource_def   *seldef;
 	resource_def   *plcdef;
+	static resc_lookup jblk;
 
 	seldef = &svr_resc_def[RESC_SELECT];
 	plcdef = &svr_resc_def[RESC_PLACE];
 
 	if (is_attr_set(dflt)) {
+		resc_lookup_load(&jblk, jb);
 
 		/* for each resource in the default value list */
 
@@ -2120,14 +2486,17 @@ set_deflt_resc(attribute *jb, attribute *dflt, int selflg)
 
 			if (is_attr_set(&prescdt->rs_value)) {
 				/* see if the job already has that resource */
-				prescjb = find_resc_entry(jb, prescdt->rs_defin);
+				prescjb = resc_lookup_find(&jblk, prescdt->rs_defin);
 				if ((prescjb == NULL) ||
 					((prescjb->rs_value.at_flags &
 					ATR_VFLAG_SET) == 0)) {
 
-					if (prescjb == NULL)
+					if (prescjb == NULL) {
 						prescjb = add_resource_entry(jb,
 							prescdt->rs_defin);
+						if (prescjb)
+							resc_lookup_note(&jblk, prescjb);
+					}
 					if (prescjb) {
 						if (prescdt->rs_defin->rs_set(&prescjb->rs_value, &prescdt->rs_value, SET) == 0)
 							prescjb->rs_value.at_flags |= (ATR_VFLAG_SET|ATR_VFLAG_DEFLT);
@@ -2279,73 +2648,6 @@ eval_chkpnt(job *pjob, attribute *queckp)
 }
 
 
-#ifndef NDEBUG
-/**
- * @brief
- * 		correct_ct - This is a work-around for an as yet unfound bug where
- *		the counts of jobs in each state sometimes (rarely) become wrong.
- *		When this happens, the count for a state can become negative.
- *		If this is detected (see above), this routine is called to reset
- *		all of the counts and log a message.
- *
- * @param[in]	pqj	-	pbs queue structure
- */
-
-static void
-correct_ct(pbs_queue *pqj)
-{
-	int	   i;
-	char	  *pc;
-	job	  *pjob;
-	pbs_queue *pque;
-
-
-	(void)sprintf(log_buffer, "Job state counts incorrect, server %d: ",
-		server.sv_qs.sv_numjobs);
-	server.sv_qs.sv_numjobs = 0;
-	for (i=0; i<PBS_NUMJOBSTATE-4; ++i) {
-		pc = log_buffer + strlen(log_buffer);
-		(void)sprintf(pc, "%d ", server.sv_jobstates[i]);
-		server.sv_jobstates[i] = 0;
-	}
-	if (pqj) {
-		pc = log_buffer + strlen(log_buffer);
-		(void)sprintf(pc, "; queue %s %d: ", pqj->qu_qs.qu_name,
-			pqj->qu_numjobs);
-		for (i=0; i<PBS_NUMJOBSTATE-4; ++i) {
-			pc = log_buffer + strlen(log_buffer);
-			(void)sprintf(pc, "%d ", pqj->qu_njstate[i]);
-		}
-	}
-	log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
-		msg_daemonname, log_buffer);
-
-	for (pque = (pbs_queue *)GET_NEXT(svr_queues); pque;
-		pque = (pbs_queue *)GET_NEXT(pque->qu_link)) {
-		pque->qu_numjobs = 0;
-		for (i=0; i<PBS_NUMJOBSTATE-4; ++i)
-			pque->qu_njstate[i] = 0;
-	}
-
-	for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
-		pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
-		int state_num;
-
-		state_num = get_job_state(pjob);
-		server.sv_qs.sv_numjobs++;
-		if (state_num != -1)
-			server.sv_jobstates[state_num]++;
-		if (pjob->ji_qhdr) {
-			(pjob->ji_qhdr)->qu_numjobs++;
-			if (state_num != -1)
-				(pjob->ji_qhdr)->qu_njstate[state_num]++;
-		}
-	}
-	return;
-}
-#endif 	/* NDEBUG */
-
-
 /**
  * @brief
  * 		get_wall - get the value of "walltime" for the job
@@ -2809,8 +3111,6 @@ Time4occurrenceFinish(resc_resv *presv)
 	int rcount_adjusted = 0;
 	char *execvnodes = NULL;
 	char *newxc = NULL;
-	char **short_xc = NULL;
-	char **tofree = NULL;
 	time_t dtstart;
 	time_t dtend;
 	time_t next;
@@ -2926,8 +3226,7 @@ Time4occurrenceFinish(resc_resv *presv)
 		DBPRT(("stdg_resv: next occurrence end   = %s", ctime(&dtend)))
 	}
 	DBPRT(("stdg_resv: execvnodes sequence   = %s\n", presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str))
-	execvnodes = strdup(presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str);
-	short_xc = (char **) unroll_execvnode_seq(execvnodes, &tofree);
+	execvnodes = presv->ri_wattr[RESV_ATR_resv_execvnodes].at_val.at_str;
 
 	/* when a reservation is reconfirmed, the 'count' of occurrences may differ
 	 * from the original 'count', we need to adjust for the actual remaining
@@ -2935,15 +3234,11 @@ Time4occurrenceFinish(resc_resv *presv)
 	 */
 	rcount_adjusted = rcount - get_execvnodes_count(execvnodes);
 
-	/* The reservation index starts at 1 but the short_xc array at 0. Occurrence 1
-	 * is therefore given by array element 0.
+	/* The reservation index starts at 1 but the sequence at 0. Occurrence 1
+	 * is therefore given by index 0. Only that occurrence's execvnode is
+	 * copied out of the sequence.
 	 */
-	newxc = strdup(short_xc[ridx - rcount_adjusted - 1]);
-
-	/* clean up helper variables */
-	free(short_xc);
-	free(execvnodes);
-	free_execvnode_seq(tofree);
+	newxc = get_execvnode_occurrence(execvnodes, ridx - rcount_adjusted - 1);
 
 	/* Set reservation state to finished. Will re-evaluate
 	 * the state for the next occurrence later in the function.
@@ -3414,6 +3709,7 @@ resv_setResvState(resc_resv *presv, int state, int sub)
 	presv->ri_wattr[(int)RESV_ATR_substate].at_val.at_long = sub;
 	presv->ri_wattr[(int)RESV_ATR_substate].at_flags |= ATR_SET_MOD_MCACHE;
 
+	svr_event_resv(presv);
 	resv_save_db(presv);
 	return;
 }
@@ -4642,7 +4938,6 @@ svr_clean_job_history(struct work_task *pwt)
 {
 	job 	*pjob;
 	job 	*nxpjob = NULL;
-	int 	walltime_used = 0;
 
 	/*
 	 * Keep track of time spent purging jobs, interrupts purge if necessary.
@@ -4662,44 +4957,23 @@ svr_clean_job_history(struct work_task *pwt)
 	end_time = begin_time;
 
 	/*
-	 * Traverse through the SERVER job list and find the history
-	 * jobs (job with state JOB_STATE_LTR_MOVED and JOB_STATE_LTR_FINISHED)
-	 * which exceed the configured job_history_duration value and
-	 * purge them immediately.
+	 * The history jobs are kept in history_timestamp order, so only
+	 * the expired front of the list needs to be looked at.  A moved
+	 * job is only purged once it finished at the remote server, the
+	 * others are purged right away.
 	 */
-	pjob = (job *)GET_NEXT(svr_alljobs);
+	pjob = (job *)GET_NEXT(svr_histjobs);
 
 	while (pjob != NULL) {
-		/* save the next job */
-		nxpjob = (job *)GET_NEXT(pjob->ji_alljobs);
+		if (time_now < (get_jattr_long(pjob, JOB_ATR_history_timestamp) + svr_history_duration))
+			break;
 
-		if ((check_job_state(pjob, JOB_STATE_LTR_MOVED) && check_job_substate(pjob, JOB_SUBSTATE_FINISHED)) ||
-			(check_job_state(pjob, JOB_STATE_LTR_FINISHED)) ||
-			(check_job_state(pjob, JOB_STATE_LTR_EXPIRED))) {
+		/* save the next job */
+		nxpjob = (job *)GET_NEXT(pjob->ji_histjobs);
 
-			if (!(is_jattr_set(pjob,  JOB_ATR_history_timestamp))) {
-				if (check_job_state(pjob, JOB_STATE_LTR_MOVED))
-					set_jattr_l_slim(pjob, JOB_ATR_history_timestamp, time_now, SET);
-			else {
-					if (((walltime_used = get_used_wall(pjob)) == -1) ||
-						!(is_jattr_set(pjob,  JOB_ATR_stime))) {
-						log_err(-1, "svr_clean_job_history",
-							"Finished job missing start-time/walltime used, cannot clean history");
-						pjob = nxpjob;
-						continue;
-					}
-					set_jattr_l_slim(pjob, JOB_ATR_history_timestamp,
-							get_jattr_long(pjob, JOB_ATR_stime) + walltime_used, SET);
-				}
-				pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
-				job_save_db(pjob);
-			}
+		if (!check_job_state(pjob, JOB_STATE_LTR_MOVED) || check_job_substate(pjob, JOB_SUBSTATE_FINISHED))
+			job_purge(pjob);
 
-			if (time_now >= (get_jattr_long(pjob,  JOB_ATR_history_timestamp) + svr_history_duration)) {
-				job_purge(pjob);
-				pjob = NULL;
-			}
-		}
 		/* restore the saved next in pjob */
 		pjob = nxpjob;
 
@@ -4737,9 +5011,13 @@ svr_clean_job_history(struct work_task *pwt)
 		}
 	} /* end of while loop through jobs */
 
-	/* We purged everything necessary in this task if we get here.
+	/* We purged everything necessary in this task if we get here,
+	 * so the days all of whose jobs expired can go from the database.
 	 * set up another work task for next time period.
 	 */
+	if (svr_history_enable)
+		job_hist_expire_db(time_now - svr_history_duration);
+
 	if (pwt && svr_history_enable) {
 		if (!set_task(WORK_Timed,
 			(time_now + time_between_tasks),
@@ -4780,27 +5058,9 @@ svr_clean_job_history(struct work_task *pwt)
 void
 svr_histjob_update(job * pjob, char newstate, int newsubstate)
 {
-	char oldstate = get_job_state(pjob);
-	pbs_queue *pque = pjob->ji_qhdr;
-
 	/* update the state count in queue and server */
-	if (oldstate != newstate) {
-		int oldstatenum;
-		int newstatenum;
-
-		oldstatenum = state_char2int(oldstate);
-		newstatenum = state_char2int(newstate);
-		if (oldstatenum != -1)
-			server.sv_jobstates[oldstatenum]--;
-		if (newstatenum != -1)
-			server.sv_jobstates[newstatenum]++;
-		if (pque != NULL) {
-			if (oldstatenum != -1)
-				pque->qu_njstate[oldstatenum]--;
-			if (newstatenum != -1)
-				pque->qu_njstate[newstatenum]++;
-		}
-	}
+	jobstate_count(pjob, state_char2int(newstate));
+
 	/* set the job state and state char */
 	set_job_state(pjob, newstate);
 	set_job_substate(pjob, newsubstate);
@@ -4817,7 +5077,7 @@ svr_histjob_update(job * pjob, char newstate, int newsubstate)
 		if (ptbl) {
 			/* update the subjob state table */
 			for (indx = 0; indx < ptbl->tkm_ct; ++indx) {
-				job *psubj = ptbl->tkm_tbl[indx].trk_psubjob;
+				job *psubj = get_subjob_ptr(pjob, indx);
 				if (psubj) {
 					if (!check_job_substate(psubj, JOB_SUBSTATE_TERMINATED) &&
 						!check_job_substate(psubj, JOB_SUBSTATE_FINISHED) &&
@@ -5042,7 +5302,7 @@ svr_setjob_histinfo(job *pjob, histjob_type type)
 			pjob->ji_wattr[(int)JOB_ATR_stageout_status].at_flags = ATR_SET_MOD_MCACHE;
 			}
 			for (i=0; i<ptbl->tkm_ct; i++) {
-				if (ptbl->tkm_tbl[i].trk_exitstat) {
+				if (ptbl->tkm_tbl[i].trk_flags & TRKFLG_EXITSTAT) {
 					set_jattr_l_slim(pjob, JOB_ATR_exit_status, pjob->ji_qs.ji_un.ji_exect.ji_exitstat, SET);
 				pjob->ji_wattr[(int)JOB_ATR_exit_status].at_flags = ATR_SET_MOD_MCACHE;
 					break;
@@ -5093,6 +5353,7 @@ svr_setjob_histinfo(job *pjob, histjob_type type)
 pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_SET_MOD_MCACHE;
 	/* update the history job state and substate */
 	svr_histjob_update(pjob, newstate, newsubstate);
+	histjob_link(pjob);
 
 	/*
 	 * Work tasks on history jobs are not required and may change the
@@ -5148,21 +5409,95 @@ svr_chk_histjob(job *pjob)
 	return rc;
 }
 
+/**
+ * @brief
+ *	Answer the first 'n' node release requests of a job waiting on
+ *	exec_vnode updates to its primary mom, and drop them from the job.
+ *
+ * @param[in,out]	pjob - job structure
+ * @param[in]		n - number of requests to answer
+ * @param[in]		code - PBSE_NONE to acknowledge them, or the error code
+ * @param[in]		msg - error message to go with 'code', or NULL
+ *
+ * @return none
+ */
+void
+reply_job_exec_update_reqs(job *pjob, int n, int code, char *msg)
+{
+	struct batch_request *preq;
+	int i;
+
+	if (n > pjob->ji_exec_update_nreqs)
+		n = pjob->ji_exec_update_nreqs;
+	if (n <= 0)
+		return;
+
+	for (i = 0; i < n; i++) {
+		preq = pjob->ji_exec_update_reqs[i];
+		if (code != PBSE_NONE) {
+			if (msg != NULL)
+				reply_text(preq, code, msg);
+			else
+				req_reject(code, 0, preq);
+		} else if (preq->rq_extend == NULL)
+			reply_ack(preq);
+		else
+			reply_text(preq, PBSE_NONE, preq->rq_extend);
+	}
+
+	pjob->ji_exec_update_nreqs -= n;
+	memmove(pjob->ji_exec_update_reqs, pjob->ji_exec_update_reqs + n,
+		pjob->ji_exec_update_nreqs * sizeof(struct batch_request *));
+	pjob->ji_exec_update_nout = (pjob->ji_exec_update_nout > n) ? pjob->ji_exec_update_nout - n : 0;
+}
+
+/**
+ * @brief
+ *	Add a node release request to the ones of a job waiting on exec_vnode
+ *	updates to its primary mom.
+ *
+ * @param[in,out]	pjob - job structure
+ * @param[in]		preq - the request
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval 1	- out of memory
+ */
+static int
+add_job_exec_update_req(job *pjob, struct batch_request *preq)
+{
+	struct batch_request **reqs;
+
+	reqs = realloc(pjob->ji_exec_update_reqs,
+		(pjob->ji_exec_update_nreqs + 1) * sizeof(struct batch_request *));
+	if (reqs == NULL) {
+		log_err(errno, __func__, "realloc failed");
+		return (1);
+	}
+	reqs[pjob->ji_exec_update_nreqs++] = preq;
+	pjob->ji_exec_update_reqs = reqs;
+
+	return (0);
+}
+
 /**
  * @brief
  * 	Finish the request to mom to update a job's exec_* values.
- *	Both the mom request and the originating client request are acknowledged.
+ *	Both the mom request and the originating client requests are
+ *	acknowledged.  If the job's exec_* values changed again while the
+ *	request was out, the next update is sent.
  *
  * @param[in,out]	pwt -	work_task structure, containing info
- *				about the mom request and the client request.
+ *				about the mom request.
  * @return none
  */
 static void
 post_send_job_exec_update_req(struct work_task *pwt)
 {
 	struct batch_request *mom_preq = NULL;
-	struct batch_request *cli_preq = NULL;
+	job *pjob;
 	int bcode = 0;
+	char err_msg[LOG_BUF_SIZE];
 
 	if (pwt == NULL)
 		return;
@@ -5173,11 +5508,9 @@ post_send_job_exec_update_req(struct work_task *pwt)
 	mom_preq->rq_conn = mom_preq->rq_orgconn;  /* restore socket to client */
 	bcode = mom_preq->rq_reply.brp_code;
 
-	cli_preq = pwt->wt_parm2;
+	pjob = find_job(mom_preq->rq_ind.rq_modify.rq_objname);
 
 	if (bcode) {
-		char err_msg[LOG_BUF_SIZE];
-
 		/* also take note of the reject msg if any */
 		if (mom_preq->rq_reply.brp_choice == BATCH_REPLY_CHOICE_Text) {
 			(void)snprintf(err_msg, sizeof(err_msg), "%s", mom_preq->rq_reply.brp_un.brp_txt.brp_str);
@@ -5186,16 +5519,24 @@ post_send_job_exec_update_req(struct work_task *pwt)
 		}
 		log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, mom_preq->rq_ind.rq_modify.rq_objname, err_msg);
 		req_reject(bcode, 0, mom_preq);
-		reply_text(cli_preq, bcode, err_msg);
+		if (pjob != NULL)
+			reply_job_exec_update_reqs(pjob, pjob->ji_exec_update_nout, bcode, err_msg);
 	} else {
 		reply_ack(mom_preq);
-		if (cli_preq != NULL) {
-			if (cli_preq->rq_extend == NULL) {
-				reply_ack(cli_preq);
-			} else {
-				reply_text(cli_preq, PBSE_NONE, cli_preq->rq_extend);
-			}
-		}
+		if (pjob != NULL)
+			reply_job_exec_update_reqs(pjob, pjob->ji_exec_update_nout, PBSE_NONE, NULL);
+	}
+
+	if (pjob == NULL)
+		return;
+
+	pjob->ji_exec_update_out = 0;
+	if (pjob->ji_exec_update_again) {
+		/* one update carries all the releases made while this one was out */
+		pjob->ji_exec_update_again = 0;
+		err_msg[0] = '\0';
+		if (send_job_exec_update_to_mom(pjob, err_msg, sizeof(err_msg), NULL) != 0)
+			reply_job_exec_update_reqs(pjob, pjob->ji_exec_update_nreqs, PBSE_SYSTEM, err_msg);
 	}
 }
 
@@ -5205,12 +5546,17 @@ post_send_job_exec_update_req(struct work_task *pwt)
  * Communicate to the MS mom pjob's exec_vnode, exec_host,
  * exec_host2, and schedselect attributes.
  *
+ * Only one update of a job is out to the MS mom at a time.  Releases made
+ * while one is out are sent together in one update once it is answered,
+ * since an update carries the job's current values.
+ *
  * @param[in]	pjob - job structure
  * @param[out]  err_msg - a buffer of size 'err_msg_sz' supplied by the
  *       		  caller and upon a failure will contain an appropriate
  *       		  error message
  * @param[in]	err_msg_sz - size of 'err_msg' buf
- * @param[in]	reply_req - the batch request to reply to if any
+ * @param[in]	reply_req - the batch request to reply to if any, it is
+ *			    answered when the update carrying it is
  *
  * @return int
  * @retrval	0	- sucess
@@ -5248,6 +5594,16 @@ send_job_exec_update_to_mom(job *pjob, char *err_msg, int err_msg_sz,
 
 	}
 
+	if (pjob->ji_exec_update_out) {
+		/* sent with the next update, once the one out is answered */
+		if ((reply_req != NULL) && (add_job_exec_update_req(pjob, reply_req) != 0))
+			return (1);
+		pjob->ji_exec_update_again = 1;
+		log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, pjob->ji_qs.ji_jobid,
+			"exec_vnode update waits for the one out to the primary mom");
+		return (0);
+	}
+
 	newreq = alloc_br(PBS_BATCH_ModifyJob);
 
 	if (newreq == (struct batch_request *) 0) {
@@ -5363,11 +5719,25 @@ send_job_exec_update_to_mom(job *pjob, char *err_msg, int err_msg_sz,
 		if (rc != 0) {
 			log_err(-1, __func__, "failed telling mom of the request");
 		} else {
-			pwt->wt_parm2 = reply_req;
+			pjob->ji_exec_update_out = 1;
+			if ((reply_req != NULL) && (add_job_exec_update_req(pjob, reply_req) != 0)) {
+				/* the update is out, so the request can't be failed */
+				if (reply_req->rq_extend == NULL)
+					reply_ack(reply_req);
+				else
+					reply_text(reply_req, PBSE_NONE, reply_req->rq_extend);
+			}
+			pjob->ji_exec_update_nout = pjob->ji_exec_update_nreqs;
 		}
 	} else {
 		/* no updates, ok */
 		rc = 0;
+		if (reply_req != NULL) {
+			if (reply_req->rq_extend == NULL)
+				reply_ack(reply_req);
+			else
+				reply_text(reply_req, PBSE_NONE, reply_req->rq_extend);
+		}
 	}
 
 send_job_exec_update_exit:
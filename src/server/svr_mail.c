@@ -50,6 +50,7 @@
  *		write3_smtp_data()
  *		send_mail()
  *		send_mail_detach()
+ *		svr_mail_helper_start()
  *		svr_mailowner_id()
  *		svr_mailowner()
  *		svr_mailownerResv()
@@ -63,7 +64,14 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/types.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/wait.h>
 #include "pbs_ifl.h"
 #include "list_link.h"
 #include "attribute.h"
@@ -74,6 +82,7 @@
 #include "reservation.h"
 #include "server.h"
 #include "tpp.h"
+#include "libutil.h"
 
 
 /* External Functions Called */
@@ -94,6 +103,42 @@ extern char *msg_job_stageinfail;
 
 #define MAIL_ADDR_BUF_LEN 1024
 
+/*
+ * Mail is handed over a pipe to a mailer helper process started by
+ * svr_mail_helper_start().  Each record written on the pipe is an int
+ * holding the payload length followed by the NUL terminated fields
+ * listed below.  A record is never longer than PIPE_BUF so a write of
+ * it on the non-blocking pipe is all or nothing.
+ */
+enum mail_rec_field {
+	MAIL_REC_INTERVAL,
+	MAIL_REC_MAILER,
+	MAIL_REC_FROM,
+	MAIL_REC_TO,
+	MAIL_REC_SUBJECT,
+	MAIL_REC_BODY,
+	MAIL_REC_NFIELDS
+};
+
+/* one recipient's mail collected by the helper for a digest */
+struct mail_digest {
+	struct mail_digest *md_next;
+	char	*md_key;	/* mailer, from and to, NUL separated */
+	int	 md_keylen;
+	char	*md_mailer;
+	char	*md_from;
+	char	*md_to;
+	char	*md_subject;	/* subject of the first message */
+	char	*md_body;	/* body of the first message */
+	char	*md_digest;	/* all the messages, each under its subject */
+	int	 md_digestsz;
+	int	 md_count;
+	time_t	 md_due;
+};
+
+static int mail_helper_fd = -1;
+static struct mail_digest *mail_digests = NULL;
+
 /**
  * @brief
  * 		Exec mailer (sendmail like) and return a descriptor with a pipe
@@ -124,7 +169,7 @@ svr_exec_mailer(char *mailer, char *mailfrom, char *mailto)
 	margs[4] = NULL;
 
 	if (pipe(mfds) == -1)
-		exit(1);
+		return NULL;
 
 	mcpid = fork();
 	if (mcpid == 0) {
@@ -143,22 +188,468 @@ svr_exec_mailer(char *mailer, char *mailfrom, char *mailto)
 	if (mcpid == -1) {/* Error on fork */
 		log_err(errno, __func__, "fork failed\n");
 		(void)close(mfds[0]);
-		exit(1);
+		(void)close(mfds[1]);
+		return NULL;
 	}
 
-	/* parent (not the real server though) will write body of message on pipe */
+	/* parent will write body of message on pipe */
 	(void)close(mfds[0]);
 
 	return(fdopen(mfds[1], "w"));
 }
 
+/**
+ * @brief
+ * 		Run the mailer and pipe one message into it.
+ *
+ * @param[in]	mailer - path to sendmail/mailer
+ * @param[in]	mailfrom - the sender of the email
+ * @param[in]	mailto - the recipients of the email
+ * @param[in]	subject - the Subject: header
+ * @param[in]	body - the message text
+ *
+ * @return	int
+ * @retval	0 : message piped to the mailer
+ * @retval	-1 : the mailer could not be started
+ */
+static int
+svr_deliver_mail(char *mailer, char *mailfrom, char *mailto,
+	char *subject, char *body)
+{
+	FILE *outmail;
+
+	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
+		return -1;
+
+	/* Pipe in mail headers: To: and Subject:, then the text */
+
+	fprintf(outmail, "To: %s\n", mailto);
+	fprintf(outmail, "Subject: %s\n\n", subject);
+	fputs(body, outmail);
+	fclose(outmail);
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Send the digest of one recipient and free it.
+ *
+ * @param[in]	md - the digest
+ */
+static void
+mail_helper_send_digest(struct mail_digest *md)
+{
+	char subject[80];
+
+	if (md->md_count == 1)
+		(void)svr_deliver_mail(md->md_mailer, md->md_from, md->md_to,
+			md->md_subject, md->md_body);
+	else {
+		snprintf(subject, sizeof(subject), "PBS digest of %d messages",
+			md->md_count);
+		(void)svr_deliver_mail(md->md_mailer, md->md_from, md->md_to,
+			subject, md->md_digest);
+	}
+	free(md->md_key);
+	free(md->md_subject);
+	free(md->md_body);
+	free(md->md_digest);
+	free(md);
+}
+
+/**
+ * @brief
+ * 		Send the digests whose interval is over.
+ *
+ * @param[in]	now - the current time
+ * @param[in]	all - if non-zero, send every digest regardless of time
+ *
+ * @return	time_t
+ * @retval	the earliest due time of the digests left, 0 if none
+ */
+static time_t
+mail_helper_flush(time_t now, int all)
+{
+	struct mail_digest **pmd = &mail_digests;
+	struct mail_digest *md;
+	time_t next = 0;
+
+	while ((md = *pmd) != NULL) {
+		if (all || md->md_due <= now) {
+			*pmd = md->md_next;
+			mail_helper_send_digest(md);
+			continue;
+		}
+		if (next == 0 || md->md_due < next)
+			next = md->md_due;
+		pmd = &md->md_next;
+	}
+	return next;
+}
+
+/**
+ * @brief
+ * 		Take one record read off the pipe by the helper: send it now
+ *		or add it to the digest of its recipient.
+ *
+ * @param[in]	rec - the record payload
+ * @param[in]	len - length of the payload
+ */
+static void
+mail_helper_take(char *rec, int len)
+{
+	char *fld[MAIL_REC_NFIELDS];
+	char *p = rec;
+	char *end = rec + len;
+	char *entry = NULL;
+	long interval;
+	int keylen;
+	int i;
+	struct mail_digest *md;
+
+	for (i = 0; i < MAIL_REC_NFIELDS; i++) {
+		fld[i] = p;
+		p = memchr(p, '\0', end - p);
+		if (p == NULL)
+			return;	/* malformed, drop it */
+		p++;
+	}
+
+	interval = strtol(fld[MAIL_REC_INTERVAL], NULL, 10);
+	if (interval <= 0) {
+		(void)svr_deliver_mail(fld[MAIL_REC_MAILER], fld[MAIL_REC_FROM],
+			fld[MAIL_REC_TO], fld[MAIL_REC_SUBJECT], fld[MAIL_REC_BODY]);
+		return;
+	}
+
+	/* the key is the mailer, from and to fields as laid out in the record */
+	keylen = fld[MAIL_REC_SUBJECT] - fld[MAIL_REC_MAILER];
+	for (md = mail_digests; md != NULL; md = md->md_next) {
+		if ((md->md_keylen == keylen) &&
+			(memcmp(md->md_key, fld[MAIL_REC_MAILER], keylen) == 0))
+			break;
+	}
+
+	if (md == NULL) {
+		if ((md = calloc(1, sizeof(struct mail_digest))) == NULL)
+			return;
+		if ((md->md_key = malloc(keylen)) == NULL) {
+			free(md);
+			return;
+		}
+		memcpy(md->md_key, fld[MAIL_REC_MAILER], keylen);
+		md->md_keylen = keylen;
+		md->md_mailer = md->md_key;
+		md->md_from = md->md_key + (fld[MAIL_REC_FROM] - fld[MAIL_REC_MAILER]);
+		md->md_to = md->md_key + (fld[MAIL_REC_TO] - fld[MAIL_REC_MAILER]);
+		md->md_subject = strdup(fld[MAIL_REC_SUBJECT]);
+		md->md_body = strdup(fld[MAIL_REC_BODY]);
+		if ((md->md_subject == NULL) || (md->md_body == NULL)) {
+			free(md->md_subject);
+			free(md->md_body);
+			free(md->md_key);
+			free(md);
+			return;
+		}
+		md->md_due = time(NULL) + interval;
+		md->md_next = mail_digests;
+		mail_digests = md;
+	}
+
+	md->md_count++;
+	if (pbs_asprintf(&entry, "==== %s ====\n%s\n",
+		fld[MAIL_REC_SUBJECT], fld[MAIL_REC_BODY]) != -1) {
+		(void)pbs_strcat(&md->md_digest, &md->md_digestsz, entry);
+		free(entry);
+	}
+}
+
+/**
+ * @brief
+ * 		Main loop of the mailer helper process.  Reads mail records off
+ *		the pipe until the server closes it, then sends what is left
+ *		and exits.
+ *
+ * @param[in]	fd - read end of the pipe from the server
+ */
+static void
+mail_helper_main(int fd)
+{
+	char buf[2 * PIPE_BUF];
+	int have = 0;
+	int len;
+	ssize_t n;
+	time_t next;
+	time_t now;
+	fd_set rfds;
+	struct timeval tv;
+
+	for (;;) {
+		/* collect the mailers that have finished */
+		while (waitpid((pid_t)-1, NULL, WNOHANG) > 0)
+			;
+
+		now = time(NULL);
+		next = mail_helper_flush(now, 0);
+		if (next != 0) {
+			tv.tv_sec = next - now;
+			tv.tv_usec = 0;
+		} else {
+			/* wake up now and then to reap the mailers */
+			tv.tv_sec = 60;
+			tv.tv_usec = 0;
+		}
+
+		FD_ZERO(&rfds);
+		FD_SET(fd, &rfds);
+		n = select(fd + 1, &rfds, NULL, NULL, &tv);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (n == 0)
+			continue;
+
+		n = read(fd, buf + have, sizeof(buf) - have);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (n == 0)
+			break;	/* server went away */
+		have += n;
+
+		while (have >= (int)sizeof(int)) {
+			memcpy(&len, buf, sizeof(int));
+			if ((len <= 0) || (len > PIPE_BUF - (int)sizeof(int)))
+				goto done;	/* lost sync with the server */
+			if (have < (int)sizeof(int) + len)
+				break;
+			mail_helper_take(buf + sizeof(int), len);
+			have -= sizeof(int) + len;
+			memmove(buf, buf + sizeof(int) + len, have);
+		}
+	}
+
+done:
+	(void)mail_helper_flush(0, 1);
+	exit(0);
+}
+
+/**
+ * @brief
+ * 		Start the mailer helper process.  It is started before the
+ *		server loads its jobs so that the helper, and the mailers it
+ *		forks, stay small.  If the helper dies, it is restarted on the
+ *		next mail.
+ *
+ * @return	int
+ * @retval	0 : helper running
+ * @retval	-1 : helper could not be started
+ */
+int
+svr_mail_helper_start(void)
+{
+	int mfds[2];
+	int i;
+	int maxfd;
+	pid_t pid;
+	struct sigaction act;
+
+	if (mail_helper_fd != -1)
+		return 0;
+
+	if (pipe(mfds) == -1) {
+		log_err(errno, __func__, "pipe failed");
+		return -1;
+	}
+
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork failed");
+		(void)close(mfds[0]);
+		(void)close(mfds[1]);
+		return -1;
+	}
+
+	if (pid == 0) {
+		/* the helper: keep only the read end of the pipe */
+		log_close(0);
+		maxfd = sysconf(_SC_OPEN_MAX);
+		for (i = 0; i < maxfd; i++) {
+			if (i != mfds[0])
+				(void)close(i);
+		}
+		(void)setsid();
+
+		sigemptyset(&act.sa_mask);
+		act.sa_flags = 0;
+		act.sa_handler = SIG_DFL;
+		(void)sigaction(SIGCHLD, &act, NULL);
+		(void)sigaction(SIGHUP, &act, NULL);
+		(void)sigaction(SIGINT, &act, NULL);
+		(void)sigaction(SIGTERM, &act, NULL);
+		act.sa_handler = SIG_IGN;
+		(void)sigaction(SIGPIPE, &act, NULL);
+		(void)sigprocmask(SIG_SETMASK, &act.sa_mask, NULL);
+
+		/* Unprotect child from being killed by kernel */
+		daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+		mail_helper_main(mfds[0]);
+		exit(0);
+	}
+
+	(void)close(mfds[0]);
+	(void)fcntl(mfds[1], F_SETFD, FD_CLOEXEC);
+	(void)fcntl(mfds[1], F_SETFL, fcntl(mfds[1], F_GETFL) | O_NONBLOCK);
+	mail_helper_fd = mfds[1];
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Pass one message to the mailer helper.
+ *
+ * @param[in]	mailer - path to sendmail/mailer
+ * @param[in]	mailfrom - the sender of the email
+ * @param[in]	mailto - the recipients of the email
+ * @param[in]	subject - the Subject: header
+ * @param[in]	body - the message text
+ *
+ * @return	int
+ * @retval	0 : message queued with the helper
+ * @retval	-1 : helper not available or message too long for a record
+ */
+static int
+svr_mail_queue(char *mailer, char *mailfrom, char *mailto,
+	char *subject, char *body)
+{
+	char rec[PIPE_BUF];
+	char interval[32];
+	char *fld[MAIL_REC_NFIELDS];
+	int len = sizeof(int);
+	int flen;
+	int i;
+	ssize_t n;
+
+	if ((mail_helper_fd == -1) && (svr_mail_helper_start() == -1))
+		return -1;
+
+	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_MailDigest]))
+		snprintf(interval, sizeof(interval), "%ld",
+			server.sv_attr[(int)SVR_ATR_MailDigest].at_val.at_long);
+	else
+		strcpy(interval, "0");
+
+	fld[MAIL_REC_INTERVAL] = interval;
+	fld[MAIL_REC_MAILER] = mailer;
+	fld[MAIL_REC_FROM] = mailfrom;
+	fld[MAIL_REC_TO] = mailto;
+	fld[MAIL_REC_SUBJECT] = subject;
+	fld[MAIL_REC_BODY] = body;
+
+	for (i = 0; i < MAIL_REC_NFIELDS; i++) {
+		flen = strlen(fld[i]) + 1;
+		if (len + flen > (int)sizeof(rec))
+			return -1;
+		memcpy(rec + len, fld[i], flen);
+		len += flen;
+	}
+	i = len - sizeof(int);
+	memcpy(rec, &i, sizeof(int));
+
+	do {
+		n = write(mail_helper_fd, rec, len);
+	} while ((n == -1) && (errno == EINTR));
+
+	if (n == len)
+		return 0;
+
+	if ((n == -1) && (errno == EAGAIN))
+		return -1;	/* helper is behind, send this one directly */
+
+	log_err(errno, __func__, "mailer helper went away");
+	(void)close(mail_helper_fd);
+	mail_helper_fd = -1;
+	return -1;
+}
+
+/**
+ * @brief
+ * 		Send a message, through the mailer helper if possible.  If the
+ *		helper cannot take it, a child is forked to not hold up the
+ *		Server.  This child will fork/exec the mailer and pipe the
+ *		message to it.
+ *
+ * @param[in]	mailfrom - the sender of the email
+ * @param[in]	mailto - the recipients of the email
+ * @param[in]	subject - the Subject: header
+ * @param[in]	body - the message text
+ */
+static void
+svr_send_mail(char *mailfrom, char *mailto, char *subject, char *body)
+{
+	char	*mailer;
+	pid_t	 mcpid;
+
+	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_mailer]))
+		mailer = server.sv_attr[(int)SVR_ATR_mailer].at_val.at_str;
+	else
+		mailer = SENDMAIL_CMD;
+
+	if (svr_mail_queue(mailer, mailfrom, mailto, subject, body) == 0)
+		return;
+
+	mcpid = fork();
+	if (mcpid == -1) { /* Error on fork */
+		log_err(errno, __func__, "fork failed\n");
+		return;
+	}
+	if (mcpid > 0)
+		return;		/* its all up to the child now */
+
+	/*
+	 * From here on, we are a child process of the server.
+	 * Fix up file descriptors and signal handlers.
+	 */
+	net_close(-1);
+	tpp_terminate();
+
+	/* Unprotect child from being killed by kernel */
+	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+	if (svr_deliver_mail(mailer, mailfrom, mailto, subject, body) == -1)
+		exit(1);
+	exit(0);
+}
+
+/**
+ * @brief
+ * 		Add one line, made of a label and a value, to a mail body.
+ *
+ * @param[in,out]	body - the body, grown as needed
+ * @param[in,out]	bodysz - allocated size of body
+ * @param[in]	label - text put before the value
+ * @param[in]	value - the value
+ */
+static void
+svr_mail_add_line(char **body, int *bodysz, char *label, char *value)
+{
+	(void)pbs_strcat(body, bodysz, label);
+	(void)pbs_strcat(body, bodysz, value ? value : "");
+	(void)pbs_strcat(body, bodysz, "\n");
+}
+
 /**
  * @brief
  * 		Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is handed to the mailer helper, see svr_send_mail().
  *
  * @param[in]	jid	-	the Job ID (string)
  * @param[in]	pjob	-	pointer to the job structure
@@ -173,19 +664,17 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 {
 	int	 addmailhost;
 	int	 i;
-	char    *mailer;
 	char	*mailfrom;
 	char	 mailto[MAIL_ADDR_BUF_LEN];
 	int	 mailaddrlen = 0;
 	struct array_strings *pas;
 	char	*stdmessage = NULL;
 	char	*pat;
+	char	 subject[MAIL_ADDR_BUF_LEN];
+	char	*body = NULL;
+	int	 bodysz = 0;
 	extern  char server_host[];
 
-	FILE   *outmail;
-	pid_t   mcpid;
-
-
 	/* if force is true, force the mail out regardless of mailpoint */
 
 	if (force != MAIL_FORCE) {
@@ -215,34 +704,6 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		}
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-	net_close(-1);
-	tpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
-	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_mailer]))
-		mailer = server.sv_attr[(int)SVR_ATR_mailer].at_val.at_str;
-	else
-		mailer = SENDMAIL_CMD;
-
 	/* Who is mail from, if SVR_ATR_mailfrom not set use default */
 
 	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_mailfrom]))
@@ -318,19 +779,12 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		strcpy(mailto, mailfrom);
 	}
 
-	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
-		exit(1);
-
-	/* Pipe in mail headers: To: and Subject: */
-
-	fprintf(outmail, "To: %s\n", mailto);
-
 	if (pjob)
-		fprintf(outmail, "Subject: PBS JOB %s\n\n", jid);
+		snprintf(subject, sizeof(subject), "PBS JOB %s", jid);
 	else
-		fprintf(outmail, "Subject: PBS Server on %s\n\n", server_host);
+		snprintf(subject, sizeof(subject), "PBS Server on %s", server_host);
 
-	/* Now pipe in "standard" message */
+	/* Now add in "standard" message */
 
 	switch (mailpoint) {
 
@@ -353,25 +807,24 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 	}
 
 	if (pjob) {
-		fprintf(outmail, "PBS Job Id: %s\n", jid);
-		fprintf(outmail, "Job Name:   %s\n",
+		svr_mail_add_line(&body, &bodysz, "PBS Job Id: ", jid);
+		svr_mail_add_line(&body, &bodysz, "Job Name:   ",
 			get_jattr_str(pjob, JOB_ATR_jobname));
 	}
 	if (stdmessage)
-		fprintf(outmail, "%s\n", stdmessage);
+		svr_mail_add_line(&body, &bodysz, "", stdmessage);
 	if (text != NULL)
-		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
+		svr_mail_add_line(&body, &bodysz, "", text);
 
-	exit(0);
+	svr_send_mail(mailfrom, mailto, subject, body ? body : "");
+	free(body);
 }
 /**
  * @brief
  * 		svr_mailowner - Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is handed to the mailer helper, see svr_send_mail().
  *
  * @param[in]	pjob	-	ptr to job (null for server based mail)
  * @param[in]	mailpoint	-	note, single character
@@ -389,8 +842,7 @@ svr_mailowner(job *pjob, int mailpoint, int force, char *text)
  * 		Send mail to owner of a reservation when an event happens that
  *		requires mail, such as the reservation starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is handed to the mailer helper, see svr_send_mail().
  *
  * @param[in]	presv	-	pointer to the reservation structure
  * @param[in]	mailpoint	-	which mail event is triggering the send
@@ -404,16 +856,15 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 {
 	int	 i;
 	int	 addmailhost;
-	char    *mailer;
 	char	*mailfrom;
 	char	 mailto[MAIL_ADDR_BUF_LEN];
 	int	 mailaddrlen = 0;
 	struct array_strings *pas;
 	char	*pat;
 	char	*stdmessage = NULL;
-
-	FILE	*outmail;
-	pid_t	 mcpid;
+	char	 subject[MAIL_ADDR_BUF_LEN];
+	char	*body = NULL;
+	int	 bodysz = 0;
 
 	if (force != MAIL_FORCE) {
 		/*Not forcing out mail regardless of mailpoint */
@@ -439,35 +890,6 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 			return;
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-
-	net_close(-1);
-	tpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
-	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_mailer]))
-		mailer = server.sv_attr[(int)SVR_ATR_mailer].at_val.at_str;
-	else
-		mailer = SENDMAIL_CMD;
-
 	/* Who is mail from, if SVR_ATR_mailfrom not set use default */
 
 	if (is_attr_set(&server.sv_attr[(int)SVR_ATR_mailfrom]))
@@ -534,15 +956,9 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 		}
 	}
 
-	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
-		exit(1);
+	snprintf(subject, sizeof(subject), "PBS RESERVATION %s", presv->ri_qs.ri_resvID);
 
-	/* Pipe in mail headers: To: and Subject: */
-
-	fprintf(outmail, "To: %s\n", mailto);
-	fprintf(outmail, "Subject: PBS RESERVATION %s\n\n", presv->ri_qs.ri_resvID);
-
-	/* Now pipe in "standard" message */
+	/* Now add in "standard" message */
 
 	switch (mailpoint) {
 
@@ -567,14 +983,14 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 			break;
 	}
 
-	fprintf(outmail, "PBS Reservation Id: %s\n", presv->ri_qs.ri_resvID);
-	fprintf(outmail, "Reservation Name:   %s\n",
+	svr_mail_add_line(&body, &bodysz, "PBS Reservation Id: ", presv->ri_qs.ri_resvID);
+	svr_mail_add_line(&body, &bodysz, "Reservation Name:   ",
 		presv->ri_wattr[(int)RESV_ATR_resv_name].at_val.at_str);
 	if (stdmessage)
-		fprintf(outmail, "%s\n", stdmessage);
+		svr_mail_add_line(&body, &bodysz, "", stdmessage);
 	if (text != NULL)
-		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
+		svr_mail_add_line(&body, &bodysz, "", text);
 
-	exit(0);
+	svr_send_mail(mailfrom, mailto, subject, body ? body : "");
+	free(body);
 }
@@ -83,6 +83,7 @@
 #include "hook.h"
 #include "pbs_sched.h"
 #include "acct.h"
+#include "pbs_version.h"
 
 
 #define	RETRY	3	/* number of times to retry network move */
@@ -123,7 +124,6 @@ extern unsigned int pbs_server_port_dis;
 extern int	resc_access_perm;
 extern time_t	time_now;
 extern int svr_create_tmp_jobscript(job *pj, char *script_name);
-extern int	scheduler_jobs_stat;
 extern	char	*path_hooks_workdir;
 extern struct work_task *add_mom_deferred_list(int stream, mominfo_t *minfo, void (*func)(), char *msgid, void *parm1, void *parm2);
 
@@ -277,7 +277,7 @@ local_move(job *jobp, struct batch_request *req)
 	 * had changes resulting from the move that would impact scheduling or
 	 * placement, add job to list of jobs which cannot be run in this cycle.
 	 */
-	if ((req == NULL || (find_sched_from_sock(req->rq_conn, CONN_SCHED_PRIMARY) == NULL)) && (scheduler_jobs_stat))
+	if (req == NULL || (find_sched_from_sock(req->rq_conn, CONN_SCHED_PRIMARY) == NULL))
 		am_jobs_add(jobp);
 
 	return 0;
@@ -447,6 +447,30 @@ post_movejob(struct work_task *pwt)
 	return;
 }
 
+/**
+ * @brief
+ *	Tell whether a MoM takes a job in one PBS_BATCH_ExecJob request.
+ *
+ *	During a rolling upgrade older MoMs do not know the request, so it
+ *	is only sent to a MoM that reported the server's own version and
+ *	has not rejected it since it last reported.
+ *
+ * @param[in]	pmom - the MoM
+ *
+ * @return int
+ * @retval 1	send PBS_BATCH_ExecJob
+ * @retval 0	send Queue Job, Job Script, Job Credential and Commit
+ */
+static int
+mom_takes_execjob(mominfo_t *pmom)
+{
+	mom_svrinfo_t *psvrmom = (mom_svrinfo_t *) pmom->mi_data;
+
+	if (psvrmom->msr_no_execjob || psvrmom->msr_pbs_ver == NULL)
+		return 0;
+	return (strcmp(psvrmom->msr_pbs_ver, PBS_VERSION) == 0);
+}
+
 /**
  *
  * @brief
@@ -483,7 +507,8 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 	char *dup_msgid = NULL;
 	struct work_task *ptask = NULL;
 	int save_resc_access_perm;
-	char *extend = NULL;
+	int bundled;
+	char *script;
 
 	/* saving resc_access_perm global variable as backup */
 	save_resc_access_perm = resc_access_perm;
@@ -526,14 +551,29 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 
 	(void) strcpy(job_id, jobp->ji_qs.ji_jobid);
 
-	if (((jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) == 0) && (credlen <= 0) && ((jobp->ji_qs.ji_svrflags & JOB_SVFLG_HASRUN) == 0))
-		extend = EXTEND_OPT_IMPLICIT_COMMIT;
+	/*
+	 * A job that has not run yet has no files to move, its script and
+	 * credential go along with the attributes in one Exec Job request
+	 * which the MoM commits at once, if the MoM knows that request
+	 */
+	bundled = ((jobp->ji_qs.ji_svrflags & JOB_SVFLG_HASRUN) == 0) && mom_takes_execjob(pmom);
 
 	pqjatr = &((svrattrl *) GET_NEXT(attrl))->al_atopl;
-	jobid = PBSD_queuejob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr, extend, PROT_TPP, &msgid, NULL);
-	free_attrlist(&attrl);
-	if (jobid == NULL)
-		goto send_err;
+	if (bundled) {
+		script = (jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) ? jobp->ji_script : NULL;
+		rc = PBSD_execjob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr,
+			script, script ? strlen(script) : 0,
+			jobp->ji_extended.ji_ext.ji_credtype, credbuf, credlen, &msgid);
+		free_attrlist(&attrl);
+		free(credbuf);
+		if (rc != 0)
+			goto send_err;
+	} else {
+		jobid = PBSD_queuejob(stream, jobp->ji_qs.ji_jobid, destin, pqjatr, NULL, PROT_TPP, &msgid, NULL);
+		free_attrlist(&attrl);
+		if (jobid == NULL)
+			goto send_err;
+	}
 
 	tpp_add_close_func(stream, process_DreplyTPP); /* register a close handler */
 
@@ -548,12 +588,16 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, struct batch_request *req
 	append_link(&jobp->ji_svrtask, &ptask->wt_linkobj, ptask);
 
 	/*
-	 * svr-mom communication is asynchronous, so PBSD_quejob does not return in this flow
-	 * hence commit_done is meaningless here
-	 * We only need to check extend and skip sending the other messages
+	 * svr-mom communication is asynchronous, the reply to the whole
+	 * transfer is handled by post_sendmom, nothing else to send
 	 */
-	if (extend)
+	if (bundled) {
+		if (jobp->ji_script) {
+			free(jobp->ji_script);
+			jobp->ji_script = NULL;
+		}
 		goto done;
+	}
 
 	/* we cannot use the same msgid, since it is not part of the preq,
 	 * make a dup of it, and we can freely free it
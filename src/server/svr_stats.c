@@ -0,0 +1,756 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	svr_stats.c
+ *
+ * @brief
+ *	Latency statistics of the server main loop: the time spent serving
+ *	each type of batch request, running each work task function, in
+ *	database round trips and server hooks, waiting for requests, and the
+ *	time each main loop pass was busy.
+ *
+ *	Every latency goes into a histogram of SVR_STAT_BUCKETS buckets of
+ *	doubling width, the first one holding times under 100 microseconds,
+ *	so percentiles can be estimated.  The statistics are shown in the
+ *	read-only server attribute server_stats when it is asked for by name,
+ *	and written as JSON to server_priv/server_stats.json every
+ *	server_stats_interval when that is set.
+ *
+ *	The live object counts kept by mem_acct_add() are shown the same way
+ *	in server_memory, with a count of the set attribute values taken
+ *	when it is read.
+ *
+ * Included public functions are:
+ *	svr_stats_init()
+ *	svr_stats_record()
+ *	svr_stats_request()
+ *	svr_stats_busy()
+ *	svr_stats_elapsed()
+ *	svr_stats_as_string()
+ *	svr_mem_as_string()
+ *	svr_stats_write_file()
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "pbs_ifl.h"
+#include "libpbs.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "server_limits.h"
+#include "server.h"
+#include "resource.h"
+#include "job.h"
+#include "queue.h"
+#include "reservation.h"
+#include "pbs_nodes.h"
+#include "work_task.h"
+#include "mem_acct.h"
+#include "pbs_db.h"
+#include "log.h"
+#include "svrfunc.h"
+
+#define	SVR_STAT_BUCKETS	24
+#define	SVR_STAT_BASE		0.0001	/* upper bound of the first bucket, seconds */
+#define	SVR_STAT_REQTYPES	128	/* request types counted one by one */
+#define	SVR_STAT_TASKFUNCS	256	/* work task functions counted one by one */
+#define	SVR_STAT_FILE		"server_stats.json"
+
+struct svr_stat_hist {
+	unsigned long	sh_count;	/* number of events */
+	double		sh_total;	/* total time in seconds */
+	double		sh_max;		/* longest time in seconds */
+	unsigned long	sh_hist[SVR_STAT_BUCKETS];
+};
+
+struct svr_task_stat {
+	void		(*ts_func)(struct work_task *);
+	struct svr_stat_hist ts_hist;
+};
+
+static char *kind_names[SVR_STAT_KINDS] = {"loop", "poll", "db", "hook"};
+
+static struct {
+	int	rn_type;
+	char	*rn_name;
+} req_names[] = {
+	{PBS_BATCH_Connect,	"Connect"},
+	{PBS_BATCH_QueueJob,	"QueueJob"},
+	{PBS_BATCH_jobscript,	"jobscript"},
+	{PBS_BATCH_RdytoCommit,	"RdytoCommit"},
+	{PBS_BATCH_Commit,	"Commit"},
+	{PBS_BATCH_DeleteJob,	"DeleteJob"},
+	{PBS_BATCH_HoldJob,	"HoldJob"},
+	{PBS_BATCH_LocateJob,	"LocateJob"},
+	{PBS_BATCH_Manager,	"Manager"},
+	{PBS_BATCH_MessJob,	"MessJob"},
+	{PBS_BATCH_ModifyJob,	"ModifyJob"},
+	{PBS_BATCH_MoveJob,	"MoveJob"},
+	{PBS_BATCH_ReleaseJob,	"ReleaseJob"},
+	{PBS_BATCH_Rerun,	"Rerun"},
+	{PBS_BATCH_RunJob,	"RunJob"},
+	{PBS_BATCH_SelectJobs,	"SelectJobs"},
+	{PBS_BATCH_Shutdown,	"Shutdown"},
+	{PBS_BATCH_SignalJob,	"SignalJob"},
+	{PBS_BATCH_StatusJob,	"StatusJob"},
+	{PBS_BATCH_StatusQue,	"StatusQue"},
+	{PBS_BATCH_StatusSvr,	"StatusSvr"},
+	{PBS_BATCH_TrackJob,	"TrackJob"},
+	{PBS_BATCH_AsyrunJob,	"AsyrunJob"},
+	{PBS_BATCH_Rescq,	"Rescq"},
+	{PBS_BATCH_ReserveResc,	"ReserveResc"},
+	{PBS_BATCH_ReleaseResc,	"ReleaseResc"},
+	{PBS_BATCH_FailOver,	"FailOver"},
+	{PBS_BATCH_StageIn,	"StageIn"},
+	{PBS_BATCH_OrderJob,	"OrderJob"},
+	{PBS_BATCH_SelStat,	"SelStat"},
+	{PBS_BATCH_RegistDep,	"RegistDep"},
+	{PBS_BATCH_CopyFiles,	"CopyFiles"},
+	{PBS_BATCH_DelFiles,	"DelFiles"},
+	{PBS_BATCH_JobObit,	"JobObit"},
+	{PBS_BATCH_MvJobFile,	"MvJobFile"},
+	{PBS_BATCH_StatusNode,	"StatusNode"},
+	{PBS_BATCH_Disconnect,	"Disconnect"},
+	{PBS_BATCH_JobCred,	"JobCred"},
+	{PBS_BATCH_CopyFiles_Cred, "CopyFiles_Cred"},
+	{PBS_BATCH_DelFiles_Cred,	"DelFiles_Cred"},
+	{PBS_BATCH_SubmitResv,	"SubmitResv"},
+	{PBS_BATCH_StatusResv,	"StatusResv"},
+	{PBS_BATCH_DeleteResv,	"DeleteResv"},
+	{PBS_BATCH_UserCred,	"UserCred"},
+	{PBS_BATCH_ConfirmResv,	"ConfirmResv"},
+	{PBS_BATCH_DefSchReply,	"DefSchReply"},
+	{PBS_BATCH_StatusSched,	"StatusSched"},
+	{PBS_BATCH_StatusRsc,	"StatusRsc"},
+	{PBS_BATCH_StatusHook,	"StatusHook"},
+	{PBS_BATCH_PySpawn,	"PySpawn"},
+	{PBS_BATCH_CopyHookFile,	"CopyHookFile"},
+	{PBS_BATCH_DelHookFile,	"DelHookFile"},
+	{PBS_BATCH_HookPeriodic,	"HookPeriodic"},
+	{PBS_BATCH_RelnodesJob,	"RelnodesJob"},
+	{PBS_BATCH_ModifyResv,	"ModifyResv"},
+	{PBS_BATCH_ResvOccurEnd,	"ResvOccurEnd"},
+	{PBS_BATCH_PreemptJobs,	"PreemptJobs"},
+	{PBS_BATCH_Cred,	"Cred"},
+	{PBS_BATCH_Authenticate,	"Authenticate"},
+	{PBS_BATCH_ModifyJob_Async, "ModifyJob_Async"},
+	{PBS_BATCH_AsyrunJob_ack,	"AsyrunJob_ack"},
+	{PBS_BATCH_RegisterSched,	"RegisterSched"},
+	{PBS_BATCH_ModifyVnode,	"ModifyVnode"},
+	{PBS_BATCH_DeleteJobList,	"DeleteJobList"},
+	{PBS_BATCH_ModifyJobList_Async, "ModifyJobList_Async"},
+	{PBS_BATCH_RunSubjobs_Async, "RunSubjobs_Async"},
+	{PBS_BATCH_SubmitJob,	"SubmitJob"},
+	{PBS_BATCH_SubmitJobList,	"SubmitJobList"},
+	{PBS_BATCH_Subscribe,	"Subscribe"},
+	{PBS_BATCH_ExecJob,	"ExecJob"},
+	{PBS_BATCH_ModifyJobsSel,	"ModifyJobsSel"},
+	{-1,			NULL}
+};
+
+static struct svr_stat_hist kind_stats[SVR_STAT_KINDS];
+static struct svr_stat_hist req_stats[SVR_STAT_REQTYPES];
+static struct svr_task_stat task_stats[SVR_STAT_TASKFUNCS];
+static struct svr_stat_hist task_other;	/* functions beyond the table */
+static int task_stats_used = 0;
+static double req_busy = 0;		/* seconds spent serving requests */
+static time_t stats_since = 0;
+static time_t stats_written = 0;
+
+extern char *path_priv;
+extern time_t time_now;
+extern pbs_list_head svr_queues;
+
+/**
+ * @brief
+ *	Account for one event that took 'secs' seconds in histogram 'sh'.
+ *
+ * @param[in,out] sh   - the histogram
+ * @param[in]	  secs - how long the event took
+ */
+static void
+hist_add(struct svr_stat_hist *sh, double secs)
+{
+	double limit;
+	int i;
+
+	if (secs < 0)
+		secs = 0;
+	sh->sh_count++;
+	sh->sh_total += secs;
+	if (secs > sh->sh_max)
+		sh->sh_max = secs;
+
+	limit = SVR_STAT_BASE;
+	for (i = 0; (i < SVR_STAT_BUCKETS - 1) && (secs >= limit); i++)
+		limit *= 2;
+	sh->sh_hist[i]++;
+}
+
+/**
+ * @brief
+ *	Returns the upper bound of the histogram bucket holding the 99th
+ *	percentile of the events of 'sh'.
+ */
+static double
+hist_p99(struct svr_stat_hist *sh)
+{
+	unsigned long want = sh->sh_count - sh->sh_count / 100;
+	unsigned long seen = 0;
+	double limit = SVR_STAT_BASE;
+	int i;
+
+	for (i = 0; i < SVR_STAT_BUCKETS - 1; i++) {
+		seen += sh->sh_hist[i];
+		if (seen >= want)
+			break;
+		limit *= 2;
+	}
+	return limit;
+}
+
+/**
+ * @brief
+ *	Work task dispatch callback, see pfn_task_dispatched.  Tasks are
+ *	counted per function in a table addressed by the function pointer.
+ *
+ * @param[in]	func - the function the task ran
+ * @param[in]	secs - how long it ran
+ */
+static void
+svr_stats_task(void (*func)(struct work_task *), double secs)
+{
+	size_t i;
+	size_t n;
+
+	i = ((uintptr_t) func >> 4) % SVR_STAT_TASKFUNCS;
+	for (n = 0; n < SVR_STAT_TASKFUNCS; n++) {
+		if (task_stats[i].ts_func == func)
+			break;
+		if (task_stats[i].ts_func == NULL) {
+			/* keep one slot free so that lookups end */
+			if (task_stats_used == SVR_STAT_TASKFUNCS - 1) {
+				n = SVR_STAT_TASKFUNCS;
+				break;
+			}
+			task_stats[i].ts_func = func;
+			task_stats_used++;
+			break;
+		}
+		i = (i + 1) % SVR_STAT_TASKFUNCS;
+	}
+	if (n == SVR_STAT_TASKFUNCS)
+		hist_add(&task_other, secs);
+	else
+		hist_add(&task_stats[i].ts_hist, secs);
+}
+
+/**
+ * @brief
+ *	Database round trip callback, see pfn_db_round_trip.
+ */
+static void
+svr_stats_db(double secs)
+{
+	hist_add(&kind_stats[SVR_STAT_DB], secs);
+}
+
+/**
+ * @brief
+ *	Start collecting statistics: hook into work task dispatching and
+ *	database round trips.
+ */
+void
+svr_stats_init(void)
+{
+	stats_since = time(NULL);
+	pfn_task_dispatched = svr_stats_task;
+	pfn_db_round_trip = svr_stats_db;
+}
+
+/**
+ * @brief
+ *	Account for one event of the given kind that took 'secs' seconds.
+ *
+ * @param[in]	kind - SVR_STAT_LOOP, SVR_STAT_POLL, SVR_STAT_DB or SVR_STAT_HOOK
+ * @param[in]	secs - how long it took
+ */
+void
+svr_stats_record(enum svr_stat_kind kind, double secs)
+{
+	if ((kind >= 0) && (kind < SVR_STAT_KINDS))
+		hist_add(&kind_stats[kind], secs);
+}
+
+/**
+ * @brief
+ *	Account for serving a batch request of type 'rq_type', which
+ *	started at 'start'.
+ *
+ * @param[in]	rq_type - PBS_BATCH_* type of the request
+ * @param[in]	start	- when the request was dispatched
+ */
+void
+svr_stats_request(int rq_type, struct timeval *start)
+{
+	double secs = svr_stats_elapsed(start);
+
+	if ((rq_type < 0) || (rq_type >= SVR_STAT_REQTYPES))
+		rq_type = 0;
+	hist_add(&req_stats[rq_type], secs);
+	req_busy += secs;
+}
+
+/**
+ * @brief
+ *	Returns the total time in seconds spent serving requests so far.
+ *	The main loop takes it before and after waiting for requests to tell
+ *	the wait from the serving.
+ */
+double
+svr_stats_busy(void)
+{
+	return req_busy;
+}
+
+/**
+ * @brief
+ *	Returns the time in seconds since 'start'.
+ */
+double
+svr_stats_elapsed(struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/**
+ * @brief
+ *	Returns the name of request type 'rq_type'.
+ */
+static char *
+req_name(int rq_type)
+{
+	static char buf[32];
+	int i;
+
+	for (i = 0; req_names[i].rn_name != NULL; i++) {
+		if (req_names[i].rn_type == rq_type)
+			return req_names[i].rn_name;
+	}
+	snprintf(buf, sizeof(buf), "%d", rq_type);
+	return buf;
+}
+
+/**
+ * @brief
+ *	Returns the name of work task function 'func', or its address when
+ *	it has no dynamic symbol.
+ */
+static char *
+task_name(void (*func)(struct work_task *))
+{
+	static char buf[32];
+	Dl_info info;
+
+	if ((dladdr((void *) func, &info) != 0) && (info.dli_sname != NULL))
+		return (char *) info.dli_sname;
+	snprintf(buf, sizeof(buf), "%p", (void *) func);
+	return buf;
+}
+
+/**
+ * @brief
+ *	Append the entry of histogram 'sh' named 'prefix''name' to the string
+ *	form of the statistics.
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+stats_str_add(char **str, int *sz, char *prefix, char *name, struct svr_stat_hist *sh)
+{
+	char entry[256];
+
+	if (sh->sh_count == 0)
+		return 0;
+	snprintf(entry, sizeof(entry),
+		" %s%s:count=%lu,total=%.3f,avg=%.6f,max=%.6f,p99=%.4f",
+		prefix, name, sh->sh_count, sh->sh_total,
+		sh->sh_total / sh->sh_count, sh->sh_max, hist_p99(sh));
+	if (pbs_strcat(str, sz, entry) == NULL)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Returns the string representation of the statistics, the value of
+ *	the server_stats attribute: "since=<time>" followed by one entry per
+ *	kind, request type and work task function seen, separated by spaces:
+ *	<name>:count=<n>,total=<s>,avg=<s>,max=<s>,p99=<s>
+ *	Request types are named req.<type>, work tasks task.<function>.
+ *
+ * @note
+ *	p99 is the upper bound of the histogram bucket holding the 99th
+ *	percentile.  The returned string is in a static buffer.
+ *
+ * @return char *
+ * @retval <string>
+ * @retval NULL	- out of memory
+ */
+char *
+svr_stats_as_string(void)
+{
+	static char *stats_str = NULL;
+	static int stats_sz = 0;
+	int i;
+
+	if (stats_str == NULL) {
+		stats_sz = 1024;
+		if ((stats_str = malloc(stats_sz)) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return NULL;
+		}
+	}
+	snprintf(stats_str, stats_sz, "since=%ld", (long) stats_since);
+
+	for (i = 0; i < SVR_STAT_KINDS; i++) {
+		if (stats_str_add(&stats_str, &stats_sz, "", kind_names[i], &kind_stats[i]) != 0)
+			return NULL;
+	}
+	for (i = 0; i < SVR_STAT_REQTYPES; i++) {
+		if (stats_str_add(&stats_str, &stats_sz, "req.", req_name(i), &req_stats[i]) != 0)
+			return NULL;
+	}
+	for (i = 0; i < SVR_STAT_TASKFUNCS; i++) {
+		if ((task_stats[i].ts_func != NULL) &&
+			(stats_str_add(&stats_str, &stats_sz, "task.", task_name(task_stats[i].ts_func), &task_stats[i].ts_hist) != 0))
+			return NULL;
+	}
+	if (stats_str_add(&stats_str, &stats_sz, "task.", "other", &task_other) != 0)
+		return NULL;
+
+	return stats_str;
+}
+
+/**
+ * @brief
+ *	Returns the bytes held by the value of attribute 'pattr' outside of
+ *	the attribute itself.  Lists of svrattrl are left out, they are
+ *	accounted for as svrattrl.
+ */
+static long long
+attr_value_bytes(attribute *pattr)
+{
+	struct array_strings *parst;
+	resource *prs;
+	long long bytes = 0;
+
+	switch (pattr->at_type) {
+		case ATR_TYPE_STR:
+			if (pattr->at_val.at_str != NULL)
+				bytes = strlen(pattr->at_val.at_str) + 1;
+			break;
+
+		case ATR_TYPE_ARST:
+		case ATR_TYPE_ACL:
+			if ((parst = pattr->at_val.at_arst) != NULL)
+				bytes = sizeof(struct array_strings) +
+					(parst->as_npointers - 1) * sizeof(char *) + parst->as_bufsize;
+			break;
+
+		case ATR_TYPE_RESC:
+			for (prs = (resource *) GET_NEXT(pattr->at_val.at_list); prs;
+				prs = (resource *) GET_NEXT(prs->rs_link))
+				bytes += sizeof(resource) + attr_value_bytes(&prs->rs_value);
+			break;
+	}
+	return bytes;
+}
+
+/**
+ * @brief
+ *	Add the set attributes of the 'nattr' long array 'pattrs' and the
+ *	bytes their values hold to 'count' and 'bytes'.
+ */
+static void
+attr_census(attribute *pattrs, int nattr, long long *count, long long *bytes)
+{
+	int i;
+
+	for (i = 0; i < nattr; i++) {
+		if (is_attr_set(&pattrs[i])) {
+			(*count)++;
+			*bytes += attr_value_bytes(&pattrs[i]);
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Count the set attribute values of all jobs, reservations, queues,
+ *	vnodes and the server, and the bytes the values hold.
+ *
+ * @param[out]	count - number of set attributes
+ * @param[out]	bytes - bytes held by their values
+ */
+static void
+mem_attr_census(long long *count, long long *bytes)
+{
+	job *pjob;
+	resc_resv *presv;
+	pbs_queue *pque;
+	int i;
+
+	*count = 0;
+	*bytes = 0;
+	for (pjob = (job *) GET_NEXT(svr_alljobs); pjob; pjob = (job *) GET_NEXT(pjob->ji_alljobs))
+		attr_census(pjob->ji_wattr, JOB_ATR_LAST, count, bytes);
+	for (presv = (resc_resv *) GET_NEXT(svr_allresvs); presv;
+		presv = (resc_resv *) GET_NEXT(presv->ri_allresvs))
+		attr_census(presv->ri_wattr, RESV_ATR_LAST, count, bytes);
+	for (pque = (pbs_queue *) GET_NEXT(svr_queues); pque; pque = (pbs_queue *) GET_NEXT(pque->qu_link))
+		attr_census(pque->qu_attr, QA_ATR_LAST, count, bytes);
+	for (i = 0; i < svr_totnodes; i++)
+		attr_census(pbsndlist[i]->nd_attr, ND_ATR_LAST, count, bytes);
+	attr_census(server.sv_attr, SVR_ATR_LAST, count, bytes);
+}
+
+/**
+ * @brief
+ *	Get the virtual and resident size of the server process in bytes from
+ *	/proc/self/statm.  Both are 0 where that can not be read.
+ */
+static void
+mem_process_size(long long *vsz, long long *rss)
+{
+	long pages = 0;
+	long resident = 0;
+	long pagesize;
+	FILE *fp;
+
+	*vsz = 0;
+	*rss = 0;
+	if ((fp = fopen("/proc/self/statm", "r")) == NULL)
+		return;
+	if (fscanf(fp, "%ld %ld", &pages, &resident) == 2) {
+		pagesize = sysconf(_SC_PAGESIZE);
+		*vsz = (long long) pages * pagesize;
+		*rss = (long long) resident * pagesize;
+	}
+	fclose(fp);
+}
+
+/**
+ * @brief
+ *	Returns the string representation of the object counts, the value of
+ *	the server_memory attribute: one entry per kind accounted for by
+ *	mem_acct_add(), separated by spaces,
+ *	<name>:count=<n>,bytes=<n>,peak=<n>,allocs=<n>
+ *	followed by attributes:count=<n>,bytes=<n> for the set attribute
+ *	values and process:vsz=<n>,rss=<n> for the process as a whole.
+ *
+ * @note
+ *	The attribute census walks every object, so this is only called when
+ *	the attribute is asked for.  The returned string is in a static buffer.
+ *
+ * @return char *
+ * @retval <string>
+ * @retval NULL	- out of memory
+ */
+char *
+svr_mem_as_string(void)
+{
+	static char *mem_str = NULL;
+	static int mem_sz = 0;
+	char entry[256];
+	long long count;
+	long long bytes;
+	int i;
+
+	if (mem_str == NULL) {
+		mem_sz = 1024;
+		if ((mem_str = malloc(mem_sz)) == NULL) {
+			log_err(errno, __func__, "Out of memory");
+			return NULL;
+		}
+	}
+	mem_str[0] = '\0';
+
+	for (i = 0; i < MEM_ACCT_KINDS; i++) {
+		snprintf(entry, sizeof(entry), "%s:count=%lld,bytes=%lld,peak=%lld,allocs=%lld ",
+			mem_acct_names[i], mem_acct[i].ma_count, mem_acct[i].ma_bytes,
+			mem_acct[i].ma_peak, mem_acct[i].ma_allocs);
+		if (pbs_strcat(&mem_str, &mem_sz, entry) == NULL)
+			return NULL;
+	}
+
+	mem_attr_census(&count, &bytes);
+	snprintf(entry, sizeof(entry), "attributes:count=%lld,bytes=%lld ", count, bytes);
+	if (pbs_strcat(&mem_str, &mem_sz, entry) == NULL)
+		return NULL;
+
+	mem_process_size(&count, &bytes);
+	snprintf(entry, sizeof(entry), "process:vsz=%lld,rss=%lld", count, bytes);
+	if (pbs_strcat(&mem_str, &mem_sz, entry) == NULL)
+		return NULL;
+
+	return mem_str;
+}
+
+/**
+ * @brief
+ *	Write histogram 'sh' as the JSON member 'name'.  Buckets are
+ *	cumulative counts up to their upper bound "le", as in a Prometheus
+ *	histogram, and stop at the last bucket holding any event.
+ */
+static void
+hist_json(FILE *fp, char *sep, char *name, struct svr_stat_hist *sh)
+{
+	unsigned long seen = 0;
+	double limit = SVR_STAT_BASE;
+	int last;
+	int i;
+
+	for (last = SVR_STAT_BUCKETS - 1; last > 0 && sh->sh_hist[last] == 0; last--)
+		;
+	fprintf(fp, "%s\"%s\":{\"count\":%lu,\"total\":%.6f,\"max\":%.6f,\"p99\":%.4f,\"buckets\":[",
+		sep, name, sh->sh_count, sh->sh_total, sh->sh_max, hist_p99(sh));
+	for (i = 0; i <= last; i++) {
+		seen += sh->sh_hist[i];
+		if (i == SVR_STAT_BUCKETS - 1)
+			fprintf(fp, "%s{\"le\":\"+Inf\",\"count\":%lu}", i ? "," : "", seen);
+		else
+			fprintf(fp, "%s{\"le\":%.4f,\"count\":%lu}", i ? "," : "", limit, seen);
+		limit *= 2;
+	}
+	fprintf(fp, "]}");
+}
+
+/**
+ * @brief
+ *	Write the statistics as JSON to server_priv/server_stats.json when
+ *	server_stats_interval is set and that long has passed since the last
+ *	write.  The file is replaced as a whole so a reader never sees it
+ *	half written.  Called once per main loop pass.
+ */
+void
+svr_stats_write_file(void)
+{
+	char path[MAXPATHLEN + 1];
+	char tmp[MAXPATHLEN + sizeof(".new")];
+	long interval;
+	long long count;
+	long long bytes;
+	FILE *fp;
+	char *sep;
+	int i;
+
+	if (!is_attr_set(&server.sv_attr[(int) SVR_ATR_StatsInterval]))
+		return;
+	interval = server.sv_attr[(int) SVR_ATR_StatsInterval].at_val.at_long;
+	if ((interval <= 0) || (time_now < stats_written + interval))
+		return;
+	stats_written = time_now;
+
+	i = snprintf(path, sizeof(path), "%s%s", path_priv, SVR_STAT_FILE);
+	if ((i < 0) || (i >= sizeof(path))) {
+		log_errf(-1, __func__, "path of %s too long", SVR_STAT_FILE);
+		return;
+	}
+	snprintf(tmp, sizeof(tmp), "%s.new", path);
+	if ((fp = fopen(tmp, "w")) == NULL) {
+		log_errf(errno, __func__, "could not open %s", tmp);
+		return;
+	}
+
+	fprintf(fp, "{\"since\":%ld,\"time\":%ld", (long) stats_since, (long) time_now);
+	for (i = 0; i < SVR_STAT_KINDS; i++)
+		hist_json(fp, ",", kind_names[i], &kind_stats[i]);
+
+	fprintf(fp, ",\"requests\":{");
+	sep = "";
+	for (i = 0; i < SVR_STAT_REQTYPES; i++) {
+		if (req_stats[i].sh_count == 0)
+			continue;
+		hist_json(fp, sep, req_name(i), &req_stats[i]);
+		sep = ",";
+	}
+
+	fprintf(fp, "},\"tasks\":{");
+	sep = "";
+	for (i = 0; i < SVR_STAT_TASKFUNCS; i++) {
+		if ((task_stats[i].ts_func == NULL) || (task_stats[i].ts_hist.sh_count == 0))
+			continue;
+		hist_json(fp, sep, task_name(task_stats[i].ts_func), &task_stats[i].ts_hist);
+		sep = ",";
+	}
+	if (task_other.sh_count > 0)
+		hist_json(fp, sep, "other", &task_other);
+
+	fprintf(fp, "},\"memory\":{");
+	for (i = 0; i < MEM_ACCT_KINDS; i++)
+		fprintf(fp, "%s\"%s\":{\"count\":%lld,\"bytes\":%lld,\"peak\":%lld,\"allocs\":%lld}",
+			i ? "," : "", mem_acct_names[i], mem_acct[i].ma_count, mem_acct[i].ma_bytes,
+			mem_acct[i].ma_peak, mem_acct[i].ma_allocs);
+	mem_attr_census(&count, &bytes);
+	fprintf(fp, ",\"attributes\":{\"count\":%lld,\"bytes\":%lld}", count, bytes);
+	mem_process_size(&count, &bytes);
+	fprintf(fp, ",\"process\":{\"vsz\":%lld,\"rss\":%lld}", count, bytes);
+	fprintf(fp, "}}\n");
+
+	if ((fclose(fp) != 0) || (rename(tmp, path) != 0)) {
+		log_errf(errno, __func__, "could not write %s", path);
+		(void) unlink(tmp);
+	}
+}
@@ -66,14 +66,16 @@
 #include	"server.h"
 #include	"queue.h"
 #include	"pbs_reliable.h"
+#include	"pbs_idx.h"
 
 static vnal_t	*vnal_alloc(vnal_t **);
 static vnal_t	*id2vnrl(vnl_t *, char *);
-static vna_t	*attr2vnr(vnal_t *, char *);
 
 static const char	iddelim = ':';
 static const char	attrdelim = '=';
 
+#define	VN_ATTR_IX_MIN	16	/* attributes of a vnode before attr2vnr() indexes them */
+
 extern char	*msg_err_malloc;
 
 /**
@@ -645,6 +647,12 @@ vn_addvnr(vnl_t *vnlp, char *id, char *attr, char *attrval,
 		}
 		vnrlp->vnal_cur = vnrlp->vnal_used++;
 		vnrp = CURVNRLNODE(vnrlp);
+		if ((vnrlp->vnal_ix != NULL) &&
+			(pbs_idx_insert(vnrlp->vnal_ix, attr, (void *)vnrlp->vnal_cur) != PBS_IDX_RET_OK)) {
+			/* drop the index, attr2vnr() rebuilds it when needed */
+			pbs_idx_destroy(vnrlp->vnal_ix);
+			vnrlp->vnal_ix = NULL;
+		}
 	} else {
 		free(vnrp->vna_name);
 		free(vnrp->vna_val);
@@ -687,6 +695,12 @@ id2vnrl(vnl_t *vnlp, char *id)
  *		If a vna_t entry with the given ID attribute (attr), return a pointer
  *		to it;  otherwise NULL is returned.
  *
+ * @par
+ *		A vnode defined with only a few attributes is searched in order.
+ *		Once it holds VN_ATTR_IX_MIN of them, an index keyed by attribute
+ *		name is built and kept up to date by vn_addvnr(), so a vnode
+ *		definition with many resources is not parsed in quadratic time.
+ *
  * @param[in]	vnrlp	-	vnode list to search
  * @param[in]	attr	-	check for the existence of the given attribute
  *
@@ -694,7 +708,7 @@ id2vnrl(vnl_t *vnlp, char *id)
  * @retval	a pointer to vnal_t	: entry with the given ID (attr) exists
  * @retval	NULL	: does not exists.
  */
-static vna_t *
+vna_t *
 attr2vnr(vnal_t *vnrlp, char *attr)
 {
 	unsigned long	i;
@@ -702,6 +716,26 @@ attr2vnr(vnal_t *vnrlp, char *attr)
 	if (vnrlp == NULL || attr == NULL)
 		return NULL;
 
+	if ((vnrlp->vnal_ix == NULL) && (vnrlp->vnal_used >= VN_ATTR_IX_MIN) &&
+		((vnrlp->vnal_ix = pbs_idx_create(PBS_IDX_HASH, 0)) != NULL)) {
+		for (i = 0; i < vnrlp->vnal_used; i++) {
+			vna_t	*vnrp = VNAL_NODENUM(vnrlp, i);
+
+			if (pbs_idx_insert(vnrlp->vnal_ix, vnrp->vna_name, (void *)i) != PBS_IDX_RET_OK) {
+				pbs_idx_destroy(vnrlp->vnal_ix);
+				vnrlp->vnal_ix = NULL;
+				break;
+			}
+		}
+	}
+
+	if (vnrlp->vnal_ix != NULL) {
+		i = 0;
+		if (pbs_idx_find(vnrlp->vnal_ix, (void **)&attr, (void **)&i, NULL) == PBS_IDX_RET_OK)
+			return VNAL_NODENUM(vnrlp, i);
+		return NULL;
+	}
+
 	for (i = 0; i < vnrlp->vnal_used; i ++) {
 		vna_t	*vnrp = VNAL_NODENUM(vnrlp, i);
 
@@ -741,11 +775,10 @@ vnl_free(vnl_t *vnlp)
 			}
 			free(vnrlp->vnal_list);
 			free(vnrlp->vnal_id);
+			pbs_idx_destroy(vnrlp->vnal_ix);
 		}
 		free(vnlp->vnl_list);
-#ifdef PBS_MOM
 		pbs_idx_destroy(vnlp->vnl_ix);
-#endif /* PBS_MOM */
 		free(vnlp);
 	}
 }
@@ -922,7 +955,9 @@ vnl_alloc(vnl_t **vp)
 			free(newchunk);
 			return NULL;
 		}
-		if ((newchunk->vnl_ix = pbs_idx_create(0, 0)) == NULL) {
+		if ((newchunk->vnl_ix = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+			free(newlist->vnal_list);
+			free(newlist);
 			free(newchunk);
 			return NULL;
 		}
@@ -988,6 +1023,7 @@ vnal_alloc(vnal_t **vp)
 			free(newchunk);
 			return NULL;
 		} else {
+			newchunk->vnal_ix = NULL;
 			newchunk->vnal_nelem = VN_NCHUNKS;
 			newchunk->vnal_cur = 0;
 			newchunk->vnal_used = 0;
@@ -1565,6 +1601,68 @@ relnodes_input_vnodelist_init(relnodes_input_vnodelist_t *r_input)
 	r_input->p_new_deallocated_execvnode = NULL;
 }
 
+/*
+ * @brief
+ *	Append a string to a buffer at the buffer's known end, so building a
+ *	long string takes time proportional to what is appended rather than
+ *	to the string built so far.  The buffer must be large enough.
+ *
+ * @param[in,out]	buf - the buffer
+ * @param[in,out]	len - length of the string in 'buf'
+ * @param[in]		str - string to append
+ * @return none
+ */
+static void
+append_at_end(char *buf, size_t *len, const char *str)
+{
+	size_t	n = strlen(str);
+
+	memcpy(buf + *len, str, n + 1);
+	*len += n;
+}
+
+/*
+ * @brief
+ *	Index the names of a '+' separated list of vnodes.
+ *
+ * @param[in,out]	vnodelist - the list, its separators are overwritten
+ *				    and its names are the index's keys
+ * @return void *
+ * @retval the index
+ * @retval NULL - on error
+ */
+static void *
+index_vnodelist(char *vnodelist)
+{
+	void	*idx;
+	char	*p;
+	char	*save_ptr;	/* posn for strtok_r() */
+
+	if ((idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL)
+		return NULL;
+
+	for (p = strtok_r(vnodelist, "+ ", &save_ptr); p != NULL;
+		p = strtok_r(NULL, "+ ", &save_ptr))
+		(void)pbs_idx_insert(idx, p, p);
+
+	return idx;
+}
+
+/*
+ * @brief
+ *	Return 1 if 'name' is in an index made by index_vnodelist().
+ */
+static int
+in_vnode_idx(void *idx, char *name)
+{
+	void	*data;
+
+	if (idx == NULL)
+		return 0;
+
+	return (pbs_idx_find(idx, (void **)&name, &data, NULL) == PBS_IDX_RET_OK);
+}
+
 /*
  * @brief
  *	Release node resources from a job whose node/vnode are appearing in
@@ -1635,6 +1733,13 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 	char		*exec_host = NULL;
 	char		*exec_host2 = NULL;
 	char		*sched_select = NULL;
+	char		*vnodelist_buf = NULL;
+	void		*vnodelist_idx = NULL;
+	void		*freed_idx = NULL;
+	size_t		new_exec_vnode_len = 0;
+	size_t		new_exec_host_len = 0;
+	size_t		new_exec_host2_len = 0;
+	size_t		deallocated_len = 0;
 #ifdef PBS_MOM
 	momvmap_t 	*vn_vmap = NULL;
 #endif
@@ -1677,6 +1782,22 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 		goto release_nodeslist_exit;
 	}
 
+	/* the vnodes to release and the vnodes released are looked up once per
+	 * exec_vnode chunk, so index them rather than scan the lists
+	 */
+	if (r_input2->vnodelist != NULL) {
+		vnodelist_buf = strdup(r_input2->vnodelist);
+		if ((vnodelist_buf == NULL) ||
+			((vnodelist_idx = index_vnodelist(vnodelist_buf)) == NULL)) {
+			log_err(errno, __func__, "vnodelist index error");
+			goto release_nodeslist_exit;
+		}
+	}
+	if ((freed_idx = pbs_idx_create(PBS_IDX_HASH, 0)) == NULL) {
+		log_err(errno, __func__, "freed vnodes index error");
+		goto release_nodeslist_exit;
+	}
+
 	res_in_exec_vnode = resources_seen(exec_vnode);
 
 	new_exec_vnode = (char *)calloc(1, strlen(exec_vnode) + 1);
@@ -1805,7 +1926,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 
 			if (is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port) &&
 			     (r_input2->vnodelist != NULL) &&
-			      in_string_list(noden, '+', r_input2->vnodelist)) {
+			      in_vnode_idx(vnodelist_idx, noden)) {
 				if ((err_msg != NULL) && (err_msg_sz > 0)) {
         				snprintf(err_msg, err_msg_sz,
 				 		"Can't free '%s' since it's on a primary execution host", noden);
@@ -1815,7 +1936,7 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			}
 
 			if ((r_input2->vnodelist != NULL) &&
-			      in_string_list(noden, '+', r_input2->vnodelist) && (pnode != NULL) &&
+			      in_vnode_idx(vnodelist_idx, noden) && (pnode != NULL) &&
 				(pnode->nd_attr[ND_ATR_ResourceAvail].at_flags & ATR_VFLAG_SET) != 0) {
 				for (prs = (resource *)GET_NEXT(pnode->nd_attr[ND_ATR_ResourceAvail].at_val.at_list); prs != NULL; prs = (resource *)GET_NEXT(prs->rs_link)) {
 					if ((prdefvntype != NULL) &&
@@ -1838,53 +1959,53 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			}
 
 			if (is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port) ||
-			     ((r_input2->vnodelist != NULL) && !in_string_list(noden, '+', r_input2->vnodelist))) {
+			     ((r_input2->vnodelist != NULL) && !in_vnode_idx(vnodelist_idx, noden))) {
 
 				if (entry > 0) /* there's something put in previously */
-					strcat(new_exec_vnode, "+");
+					append_at_end(new_exec_vnode, &new_exec_vnode_len, "+");
 
 				if (((hasprn > 0) && (paren > 0)) ||
 				     ((hasprn == 0) && (paren == 0))) {
 						 /* at the beginning of chunk for current host */
 					if (!found_paren) {
-						strcat(new_exec_vnode, "(");
+						append_at_end(new_exec_vnode, &new_exec_vnode_len, "(");
 						found_paren = 1;
 
 						if (h_entry > 0) {
 							/* there's already previous exec_host entry */
 							if (new_exec_host != NULL)
-								strcat(new_exec_host, "+");
+								append_at_end(new_exec_host, &new_exec_host_len, "+");
 							if (new_exec_host2 != NULL)
-								strcat(new_exec_host2, "+");
+								append_at_end(new_exec_host2, &new_exec_host2_len, "+");
 						}
 
 						if (new_exec_host != NULL)
-							strcat(new_exec_host, chunk1);
+							append_at_end(new_exec_host, &new_exec_host_len, chunk1);
 						if (new_exec_host2 != NULL)
-							strcat(new_exec_host2, chunk2);
+							append_at_end(new_exec_host2, &new_exec_host2_len, chunk2);
 						h_entry++;
 					}
 				}
 
 				if (!found_paren) {
-					strcat(new_exec_vnode, "(");
+					append_at_end(new_exec_vnode, &new_exec_vnode_len, "(");
 					found_paren = 1;
 
 					if (h_entry > 0) {
 						/* there's already previous exec_host entry */
 						if (new_exec_host != NULL)
-							strcat(new_exec_host, "+");
+							append_at_end(new_exec_host, &new_exec_host_len, "+");
 						if (new_exec_host2 != NULL)
-							strcat(new_exec_host2, "+");
+							append_at_end(new_exec_host2, &new_exec_host2_len, "+");
 					}
 
 					if (new_exec_host != NULL)
-						strcat(new_exec_host, chunk1);
+						append_at_end(new_exec_host, &new_exec_host_len, chunk1);
 					if (new_exec_host2 != NULL)
-						strcat(new_exec_host2, chunk2);
+						append_at_end(new_exec_host2, &new_exec_host2_len, chunk2);
 					h_entry++;
 				}
-				strcat(new_exec_vnode, noden);
+				append_at_end(new_exec_vnode, &new_exec_vnode_len, noden);
 				entry++;
 
 				for (j = 0; j < nelem; ++j) {
@@ -1904,18 +2025,18 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 
 					snprintf(buf, sizeof(buf),
 						":%s=%s", pkvp[j].kv_keyw, pkvp[j].kv_val);
-					strcat(new_exec_vnode, buf);
+					append_at_end(new_exec_vnode, &new_exec_vnode_len, buf);
 				}
 
 				if (paren == 0) { /* have all chunks for current host */
 
 					if (found_paren) {
-						strcat(new_exec_vnode, ")");
+						append_at_end(new_exec_vnode, &new_exec_vnode_len, ")");
 						found_paren = 0;
 					}
 
 					if (found_paren_dealloc) {
-						strcat(deallocated_execvnode, ")");
+						append_at_end(deallocated_execvnode, &deallocated_len, ")");
 						found_paren_dealloc = 0;
 					}
 
@@ -1967,33 +2088,33 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 			} else {
 				if (!is_parent_host_of_node(pnode, parent_mom, ms_fullhost, ms_port)) {
 					if (f_entry > 0) { /* there's something put in previously */
-						strcat(deallocated_execvnode, "+");
+						append_at_end(deallocated_execvnode, &deallocated_len, "+");
 					}
 
 					if (((hasprn > 0) && (paren > 0)) || ((hasprn == 0) && (paren == 0)) ) {
 						 /* at the beginning of chunk for current host */
 						if (!found_paren_dealloc) {
-							strcat(deallocated_execvnode, "(");
+							append_at_end(deallocated_execvnode, &deallocated_len, "(");
 							found_paren_dealloc = 1;
 						}
 					}
 
 					if (!found_paren_dealloc) {
-						strcat(deallocated_execvnode, "(");
+						append_at_end(deallocated_execvnode, &deallocated_len, "(");
 						found_paren_dealloc = 1;
 					}
-					strcat(deallocated_execvnode, chunk_buf);
+					append_at_end(deallocated_execvnode, &deallocated_len, chunk_buf);
 					f_entry++;
 
 					if (paren == 0) { /* have all chunks for current host */
 
 						if (found_paren) {
-							strcat(new_exec_vnode, ")");
+							append_at_end(new_exec_vnode, &new_exec_vnode_len, ")");
 							found_paren = 0;
 						}
 
 						if (found_paren_dealloc) {
-							strcat(deallocated_execvnode, ")");
+							append_at_end(deallocated_execvnode, &deallocated_len, ")");
 							found_paren_dealloc = 0;
 						}
 					}
@@ -2003,11 +2124,11 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 				if (hasprn < 0) {
 					/* matched ')' in chunk, so need to balance the parenthesis */
 					if (found_paren) {
-						strcat(new_exec_vnode, ")");
+						append_at_end(new_exec_vnode, &new_exec_vnode_len, ")");
 						found_paren = 0;
 					}
 					if (found_paren_dealloc) {
-						strcat(deallocated_execvnode, ")");
+						append_at_end(deallocated_execvnode, &deallocated_len, ")");
 						found_paren_dealloc = 0;
 					}
 
@@ -2130,11 +2251,16 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 
 			pc = strtok_r(tmpbuf, "+", &save_ptr);
 			while (pc != NULL) {
-				/* trying to match '(<vnode_name>:'
-				 *  or '+<vnode_name>:'
+				/* released by this request, or else trying
+				 * to match '(<vnode_name>:' or '+<vnode_name>:'
+				 * among the vnodes released before
 				 */
-				snprintf(chunk_buf, chunk_buf_sz, "(%s:", pc);
-				pc1 = strstr(deallocated_execvnode, chunk_buf);
+				if (in_vnode_idx(freed_idx, pc))
+					pc1 = pc;
+				else {
+					snprintf(chunk_buf, chunk_buf_sz, "(%s:", pc);
+					pc1 = strstr(deallocated_execvnode, chunk_buf);
+				}
 				if (pc1 == NULL) {
 					snprintf(chunk_buf, chunk_buf_sz, "+%s:", pc);
 					pc1 = strstr(deallocated_execvnode, chunk_buf);
@@ -2198,6 +2324,11 @@ pbs_release_nodes_given_nodelist(relnodes_input_t *r_input, relnodes_input_vnode
 	rc = 0;
 
 release_nodeslist_exit:
+	if (vnodelist_idx != NULL)
+		pbs_idx_destroy(vnodelist_idx);
+	if (freed_idx != NULL)
+		pbs_idx_destroy(freed_idx);
+	free(vnodelist_buf);
 	free(ms_fullhost);
 	free(res_in_exec_vnode);
 	free(chunk_buf);
@@ -4593,8 +4724,9 @@ strcat_grow(char **buf, char **curr, size_t *lenbuf, char *source)
 int
 do_schedselect(char *select_val, void *server, void *destin, char **presc_in_err, char **p_sched_select)
 {
-	char        *chunk;
+	parsed_select *ps;
 	int	     i;
+	int	     k;
 	int	     firstchunk;
 	size_t	     len;
 	int 	     nchk;
@@ -4602,6 +4734,8 @@ do_schedselect(char *select_val, void *server, void *destin, char **presc_in_err
 	int 	     nchunk_internally_set;
 	int	     nelem;
 	static char *outbuf   = NULL;
+	static struct key_value_pair *kvbuf = NULL;
+	static int   nkvp = 0;
 	struct key_value_pair *pkvp;
 	struct key_value_pair *qdkvp;
 	int		       qndft;
@@ -4610,7 +4744,6 @@ do_schedselect(char *select_val, void *server, void *destin, char **presc_in_err
 	char		      *quotec;
 	resource_def *presc;
 	char 	    *pc;
-	int	     rc;
 	char	    *tb;
 	int	     validate_resource_exist = 0;
 	static size_t bufsz = 0;
@@ -4645,29 +4778,36 @@ do_schedselect(char *select_val, void *server, void *destin, char **presc_in_err
 		validate_resource_exist = 1;
 
 	*outbuf = '\0';
-	/* copy input, the string will be broken during parsing */
 	firstchunk = 1;
-	chunk = parse_plus_spec(select_val, &rc); /* break '+' separated substrings */
-	if (rc != 0)
-		return rc;
-	while (chunk) {
-#ifdef NAS /* localmod 082 */
-		int k;
-#endif
+	if ((ps = get_parsed_select(select_val)) == NULL)
+		return PBSE_SYSTEM;
+	for (k = 0; k < ps->ps_nchunks; k++) {
+		sel_chunk *sc = &ps->ps_chunks[k];
+
 		if (firstchunk)
 			firstchunk = 0;
 		else
 			strcat(outbuf, "+");
 
-#ifdef NAS /* localmod 082 */
-		k = (pserver ? pserver->sv_nseldft : 0)  + (pque ? pque->qu_nseldft : 0);
-		if (parse_chunk(chunk, k, &nchk, &nelem, &pkvp, &nchunk_internally_set) == 0)
-#else
-		if (parse_chunk(chunk, &nchk, &nelem, &pkvp, &nchunk_internally_set) == 0)
-#endif /* localmod 082 */
-		{
+		if (sc->sc_rc == 0) {
 			int j;
 
+			/* copy the chunk's pairs, defaults are added after them */
+			nchk = sc->sc_nchk;
+			nelem = sc->sc_nelem;
+			nchunk_internally_set = sc->sc_dflt;
+			i = nelem + (pserver ? pserver->sv_nseldft : 0) + (pque ? pque->qu_nseldft : 0);
+			if (i > nkvp) {
+				pkvp = (struct key_value_pair *)realloc(kvbuf, i * sizeof(struct key_value_pair));
+				if (pkvp == NULL)
+					return PBSE_SYSTEM;
+				kvbuf = pkvp;
+				nkvp = i;
+			}
+			pkvp = kvbuf;
+			if (nelem > 0)
+				memcpy(pkvp, sc->sc_kv, nelem * sizeof(struct key_value_pair));
+
 			/* first check for any invalid resources in the select */
 			for (j=0; j<nelem; ++j) {
 
@@ -4819,15 +4959,14 @@ do_schedselect(char *select_val, void *server, void *destin, char **presc_in_err
 
 		} else {
 			if (presc_in_err != NULL) {
-				if ((*presc_in_err = strdup(chunk)) == NULL)
+				if ((*presc_in_err = strdup(sc->sc_str)) == NULL)
 					return PBSE_SYSTEM;
 			}
 			return (PBSE_UNKRESC);
 		}
-		chunk = parse_plus_spec(NULL, &rc);
-		if (rc != 0)
-			return (rc);
 	}
+	if (ps->ps_rc != 0)
+		return (ps->ps_rc);
 
 	*p_sched_select = outbuf;
 	return 0;
@@ -0,0 +1,853 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file    pbs_bench.c
+ *
+ * @brief
+ * 		pbs_bench - microbenchmarks of the hot library code.
+ *
+ * @par
+ *		Each benchmark builds its fixture from a fixed seed, so two runs of
+ *		the same build do the same work, then times the library calls with
+ *		the monotonic clock and counts the malloc(), calloc(), realloc() and
+ *		strdup() calls they make.  The counting relies on the program being
+ *		linked with --wrap for those functions, see src/tools/Makefile.am.
+ *		Every benchmark is repeated and the fastest run is reported, in
+ *		nanoseconds and allocations per operation.
+ *
+ *		DIS runs through an in-memory transport, so the numbers are those of
+ *		the encoding and framing alone, without any system call.
+ *
+ * Functions included are:
+ * 	usage()
+ * 	bench_dis()
+ * 	bench_attr()
+ * 	bench_idx()
+ * 	bench_range()
+ * 	bench_select()
+ * 	bench_tpp()
+ * 	main()
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "cmds.h"
+#include "pbs_version.h"
+#include "libpbs.h"
+#include "dis.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "pbs_idx.h"
+#include "range.h"
+#include "grunt.h"
+#include "tpp_internal.h"
+
+#define BENCH_FD	3	/* descriptor the in-memory DIS transport answers for */
+#define BENCH_MAXRES	64
+#define BENCH_SEED	20200601U
+
+/* one line of the report, the fastest of the repeated runs */
+typedef struct bench_result {
+	char	*name;
+	long	ops;
+	double	ns;		/* nanoseconds per op */
+	double	allocs;		/* allocations per op */
+} bench_result;
+
+typedef struct bench {
+	char	*name;
+	void	(*run)(long n);
+	long	dflt_n;		/* operations at scale 1 */
+	char	*fixture;
+} bench;
+
+static void bench_dis(long n);
+static void bench_attr(long n);
+static void bench_idx(long n);
+static void bench_range(long n);
+static void bench_select(long n);
+static void bench_tpp(long n);
+
+static bench benches[] = {
+	{"dis", bench_dis, 200000, "status reply of jobs with 24 attributes"},
+	{"attr", bench_attr, 1000000, "decode and encode of string, long and array attributes"},
+	{"idx", bench_idx, 200000, "job ids in an AVL tree and a hash index"},
+	{"range", bench_range, 1000000, "subjob indices of one array"},
+	{"select", bench_select, 100000, "eight chunk select specification"},
+	{"tpp", bench_tpp, 1000000, "data packets with a 1kb payload"}
+};
+#define NBENCH	(sizeof(benches) / sizeof(benches[0]))
+
+static bench_result	results[BENCH_MAXRES];
+static int		nresults = 0;
+static unsigned long	nallocs = 0;	/* counted by the __wrap_ functions */
+static unsigned int	seed;
+static struct timespec	t_start;
+static unsigned long	a_start;
+
+/*
+ * The allocation counters.  The linker sends every call the PBS libraries
+ * and this program make to malloc() and friends through these.
+ */
+extern void *__real_malloc(size_t);
+extern void *__real_calloc(size_t, size_t);
+extern void *__real_realloc(void *, size_t);
+extern char *__real_strdup(const char *);
+
+void *
+__wrap_malloc(size_t size)
+{
+	nallocs++;
+	return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size)
+{
+	nallocs++;
+	return __real_calloc(nmemb, size);
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+	nallocs++;
+	return __real_realloc(ptr, size);
+}
+
+char *
+__wrap_strdup(const char *s)
+{
+	nallocs++;
+	return __real_strdup(s);
+}
+
+/**
+ * @brief
+ * 		usage - shows the usage of the tool
+ *
+ * @param[in]	name	-	program name
+ */
+static void
+usage(char *name)
+{
+	size_t i;
+
+	fprintf(stderr, "Usage: %s [-b benchmark[,benchmark...]] [-r repeats] [-x scale]\n", name);
+	fprintf(stderr, "       %s --version\n", name);
+	fprintf(stderr, "benchmarks:\n");
+	for (i = 0; i < NBENCH; i++)
+		fprintf(stderr, "\t%-8s %8ld ops, %s\n", benches[i].name,
+			benches[i].dflt_n, benches[i].fixture);
+}
+
+/**
+ * @brief
+ * 		next value of the fixture generator
+ *
+ * @return	unsigned int
+ */
+static unsigned int
+bench_rand(void)
+{
+	seed = seed * 1103515245U + 12345U;
+	return (seed >> 1);
+}
+
+/**
+ * @brief
+ * 		start timing a section
+ */
+static void
+bench_start(void)
+{
+	a_start = nallocs;
+	clock_gettime(CLOCK_MONOTONIC, &t_start);
+}
+
+/**
+ * @brief
+ * 		stop timing a section and fold it into the result of that name,
+ * 		keeping the fastest run
+ *
+ * @param[in]	name	-	name reported for the section
+ * @param[in]	ops	-	operations done in the section
+ */
+static void
+bench_stop(char *name, long ops)
+{
+	struct timespec	t_end;
+	double		ns;
+	double		allocs;
+	int		i;
+
+	clock_gettime(CLOCK_MONOTONIC, &t_end);
+	if (ops <= 0)
+		return;
+	ns = ((t_end.tv_sec - t_start.tv_sec) * 1e9 + (t_end.tv_nsec - t_start.tv_nsec)) / ops;
+	allocs = (double) (nallocs - a_start) / ops;
+
+	for (i = 0; i < nresults; i++)
+		if (strcmp(results[i].name, name) == 0)
+			break;
+	if (i == nresults) {
+		if (nresults == BENCH_MAXRES)
+			return;
+		nresults++;
+		results[i].name = name;
+		results[i].ops = ops;
+		results[i].ns = ns;
+		results[i].allocs = allocs;
+	} else if (ns < results[i].ns)
+		results[i].ns = ns;
+}
+
+/**
+ * @brief
+ * 		complain about a library call that failed and stop
+ *
+ * @param[in]	what	-	the call that failed
+ */
+static void
+bench_fail(char *what)
+{
+	fprintf(stderr, "pbs_bench: %s failed\n", what);
+	exit(1);
+}
+
+/*
+ * In-memory DIS transport.  Everything sent on BENCH_FD is appended to
+ * one buffer and reads consume it from the front.
+ */
+static pbs_tcp_chan_t	*mem_chan = NULL;
+static char		*wire = NULL;
+static size_t		wire_len = 0;
+static size_t		wire_size = 0;
+static size_t		wire_pos = 0;
+
+static pbs_tcp_chan_t *
+mem_get_chan(int fd)
+{
+	return (fd == BENCH_FD ? mem_chan : NULL);
+}
+
+static int
+mem_set_chan(int fd, pbs_tcp_chan_t *chan)
+{
+	if (fd != BENCH_FD)
+		return -1;
+	mem_chan = chan;
+	return 0;
+}
+
+static int
+mem_append(void *data, int len)
+{
+	if (wire_len + len > wire_size) {
+		size_t	nsize = wire_size ? wire_size : 1024 * 1024;
+		char	*nwire;
+
+		while (nsize < wire_len + len)
+			nsize *= 2;
+		if ((nwire = realloc(wire, nsize)) == NULL)
+			return -1;
+		wire = nwire;
+		wire_size = nsize;
+	}
+	memcpy(wire + wire_len, data, len);
+	wire_len += len;
+	return len;
+}
+
+static int
+mem_send(int fd, void *data, int len)
+{
+	return mem_append(data, len);
+}
+
+static int
+mem_sendv(int fd, void *hdr, int hlen, void *data, int dlen)
+{
+	if (mem_append(hdr, hlen) < 0 || mem_append(data, dlen) < 0)
+		return -1;
+	return hlen + dlen;
+}
+
+static int
+mem_recv(int fd, void *data, int len)
+{
+	if (wire_pos + len > wire_len)
+		len = wire_len - wire_pos;
+	memcpy(data, wire + wire_pos, len);
+	wire_pos += len;
+	return len;
+}
+
+/**
+ * @brief
+ * 		build the attribute list sent for every job of the status reply
+ *
+ * @return	struct attrl *
+ */
+static struct attrl *
+dis_fixture(void)
+{
+	static char *attrs[][3] = {
+		{ATTR_N, NULL, "bench_job_name"},
+		{ATTR_owner, NULL, "pbsuser@submithost.example.com"},
+		{ATTR_state, NULL, "R"},
+		{ATTR_queue, NULL, "workq"},
+		{ATTR_server, NULL, "server.example.com"},
+		{ATTR_c, NULL, "u"},
+		{ATTR_ctime, NULL, "1591000000"},
+		{ATTR_e, NULL, "submithost.example.com:/home/pbsuser/bench_job_name.e123456"},
+		{ATTR_o, NULL, "submithost.example.com:/home/pbsuser/bench_job_name.o123456"},
+		{ATTR_exechost, NULL, "node0042/0*8+node0043/0*8"},
+		{ATTR_h, NULL, "n"},
+		{ATTR_j, NULL, "n"},
+		{ATTR_k, NULL, "n"},
+		{ATTR_m, NULL, "a"},
+		{ATTR_mtime, NULL, "1591000120"},
+		{ATTR_p, NULL, "0"},
+		{ATTR_qtime, NULL, "1591000000"},
+		{ATTR_r, NULL, "True"},
+		{ATTR_l, "ncpus", "16"},
+		{ATTR_l, "mem", "64gb"},
+		{ATTR_l, "select", "2:ncpus=8:mem=32gb"},
+		{ATTR_l, "walltime", "12:00:00"},
+		{ATTR_used, "cput", "01:23:45"},
+		{ATTR_v, NULL, "PBS_O_HOME=/home/pbsuser,PBS_O_LANG=en_US.UTF-8,PBS_O_LOGNAME=pbsuser,PBS_O_PATH=/usr/local/bin:/usr/bin:/bin,PBS_O_SHELL=/bin/bash,PBS_O_WORKDIR=/home/pbsuser,PBS_O_SYSTEM=Linux,PBS_O_QUEUE=workq,PBS_O_HOST=submithost.example.com"}
+	};
+	struct attrl	*head = NULL;
+	struct attrl	*pat;
+	int		i;
+
+	for (i = sizeof(attrs) / sizeof(attrs[0]) - 1; i >= 0; i--) {
+		if ((pat = calloc(1, sizeof(struct attrl))) == NULL)
+			bench_fail("calloc");
+		pat->name = attrs[i][0];
+		pat->resource = attrs[i][1];
+		pat->value = attrs[i][2];
+		pat->op = SET;
+		pat->next = head;
+		head = pat;
+	}
+	return head;
+}
+
+/**
+ * @brief
+ * 		encode and decode a status reply of n jobs the way the server
+ * 		sends it and a command reads it, once with the text and once
+ * 		with the binary integer encoding
+ *
+ * @param[in]	n	-	number of jobs in the reply
+ */
+static void
+bench_dis(long n)
+{
+	static char	*enc_names[] = {"dis_encode_text", "dis_encode_binary"};
+	static char	*dec_names[] = {"dis_decode_text", "dis_decode_binary"};
+	struct attrl	*attrs = dis_fixture();
+	struct attrl	*pat;
+	char		jobid[PBS_MAXSVRJOBID + 1];
+	char		*name;
+	unsigned int	count;
+	int		binary;
+	int		rc;
+	long		i;
+
+	pfn_transport_get_chan = mem_get_chan;
+	pfn_transport_set_chan = mem_set_chan;
+	pfn_transport_send = mem_send;
+	pfn_transport_sendv = mem_sendv;
+	pfn_transport_recv = mem_recv;
+	dis_setup_chan(BENCH_FD, mem_get_chan);
+
+	for (binary = 0; binary <= 1; binary++) {
+		dis_set_binary(BENCH_FD, binary);
+		dis_reset_buf(BENCH_FD, DIS_WRITE_BUF);
+		dis_reset_buf(BENCH_FD, DIS_READ_BUF);
+		wire_len = 0;
+		wire_pos = 0;
+
+		bench_start();
+		if (diswui(BENCH_FD, n) != 0)
+			bench_fail("diswui");
+		for (i = 0; i < n; i++) {
+			snprintf(jobid, sizeof(jobid), "%ld.server.example.com", 100000 + i);
+			if (diswui(BENCH_FD, MGR_OBJ_JOB) != 0 || diswst(BENCH_FD, jobid) != 0 ||
+				encode_DIS_attrl(BENCH_FD, attrs) != 0)
+				bench_fail("encode_DIS_attrl");
+		}
+		if (dis_flush(BENCH_FD) != 0)
+			bench_fail("dis_flush");
+		bench_stop(enc_names[binary], n);
+
+		bench_start();
+		count = disrui(BENCH_FD, &rc);
+		if (rc != 0 || count != n)
+			bench_fail("disrui");
+		for (i = 0; i < n; i++) {
+			(void) disrui(BENCH_FD, &rc);
+			if (rc != 0)
+				bench_fail("disrui");
+			if ((name = disrst(BENCH_FD, &rc)) == NULL || rc != 0)
+				bench_fail("disrst");
+			free(name);
+			pat = NULL;
+			if (decode_DIS_attrl(BENCH_FD, &pat) != 0)
+				bench_fail("decode_DIS_attrl");
+			free_attrl_list(pat);
+		}
+		bench_stop(dec_names[binary], n);
+	}
+
+	dis_destroy_chan(BENCH_FD);
+	for (pat = attrs; pat; pat = attrs) {
+		attrs = pat->next;
+		free(pat);
+	}
+	free(wire);
+	wire = NULL;
+	wire_size = 0;
+}
+
+/**
+ * @brief
+ * 		decode an attribute value, encode it back for a client and free
+ * 		both, for the string, long and string array attribute types
+ *
+ * @param[in]	n	-	number of values of each type
+ */
+static void
+bench_attr(long n)
+{
+	static char	*arst_val = "PBS_O_HOME=/home/pbsuser,PBS_O_LANG=en_US.UTF-8,PBS_O_LOGNAME=pbsuser,PBS_O_PATH=/usr/local/bin:/usr/bin:/bin,PBS_O_SHELL=/bin/bash,PBS_O_WORKDIR=/home/pbsuser,PBS_O_SYSTEM=Linux,PBS_O_QUEUE=workq";
+	static struct {
+		char	*name;
+		char	*val;
+		int	(*decode)(attribute *, char *, char *, char *);
+		int	(*encode)(const attribute *, pbs_list_head *, char *, char *, int, svrattrl **);
+		void	(*free)(attribute *);
+	} types[] = {
+		{"attr_string", "submithost.example.com:/home/pbsuser/bench_job_name.o123456", decode_str, encode_str, free_str},
+		{"attr_long", "1591000120", decode_l, encode_l, free_null},
+		{"attr_array", NULL, decode_arst, encode_arst, free_arst}
+	};
+	pbs_list_head	head;
+	attribute	attr;
+	svrattrl	*rtnl;
+	size_t		t;
+	long		i;
+
+	types[2].val = arst_val;
+	CLEAR_HEAD(head);
+	for (t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		bench_start();
+		for (i = 0; i < n; i++) {
+			memset(&attr, 0, sizeof(attr));
+			if (types[t].decode(&attr, "bench", NULL, types[t].val) != 0)
+				bench_fail(types[t].name);
+			if (types[t].encode(&attr, &head, "bench", NULL, ATR_ENCODE_CLIENT, &rtnl) < 0)
+				bench_fail(types[t].name);
+			free_attrlist(&head);
+			types[t].free(&attr);
+		}
+		bench_stop(types[t].name, n);
+	}
+}
+
+/**
+ * @brief
+ * 		insert, find and delete n job ids, in an AVL tree index and in a
+ * 		hash index
+ *
+ * @param[in]	n	-	number of job ids
+ */
+static void
+bench_idx(long n)
+{
+	static struct {
+		int	flags;
+		char	*names[3];
+	} kinds[] = {
+		{0, {"idx_avl_insert", "idx_avl_find", "idx_avl_delete"}},
+		{PBS_IDX_HASH, {"idx_hash_insert", "idx_hash_find", "idx_hash_delete"}}
+	};
+	char	**keys;
+	void	*idx;
+	void	*key;
+	void	*data;
+	size_t	k;
+	long	i;
+
+	if ((keys = calloc(n, sizeof(char *))) == NULL)
+		bench_fail("calloc");
+	for (i = 0; i < n; i++) {
+		if ((keys[i] = malloc(PBS_MAXSVRJOBID + 1)) == NULL)
+			bench_fail("malloc");
+		snprintf(keys[i], PBS_MAXSVRJOBID + 1, "%u.server.example.com", bench_rand() % 10000000);
+	}
+
+	for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+		if ((idx = pbs_idx_create(kinds[k].flags, 0)) == NULL)
+			bench_fail("pbs_idx_create");
+
+		bench_start();
+		for (i = 0; i < n; i++)
+			(void) pbs_idx_insert(idx, keys[i], keys[i]);
+		bench_stop(kinds[k].names[0], n);
+
+		bench_start();
+		for (i = 0; i < n; i++) {
+			key = keys[(i * 7919) % n];
+			if (pbs_idx_find(idx, &key, &data, NULL) != PBS_IDX_RET_OK)
+				bench_fail("pbs_idx_find");
+		}
+		bench_stop(kinds[k].names[1], n);
+
+		bench_start();
+		for (i = 0; i < n; i++)
+			(void) pbs_idx_delete(idx, keys[i]);
+		bench_stop(kinds[k].names[2], n);
+
+		pbs_idx_destroy(idx);
+	}
+
+	for (i = 0; i < n; i++)
+		free(keys[i]);
+	free(keys);
+}
+
+/**
+ * @brief
+ * 		churn the subjob indices of one array of n subjobs: all queued,
+ * 		started in order, finished in random order, then looked up,
+ * 		printed and parsed back
+ *
+ * @param[in]	n	-	number of subjobs
+ */
+static void
+bench_range(long n)
+{
+	range	*queued = NULL;
+	range	*done = NULL;
+	range	*parsed;
+	char	*str;
+	int	*order;
+	long	nstr;
+	long	i;
+	long	j;
+
+	if ((order = malloc(n * sizeof(int))) == NULL)
+		bench_fail("malloc");
+	for (i = 0; i < n; i++)
+		order[i] = i;
+	for (i = n - 1; i > 0; i--) {
+		int tmp;
+
+		j = bench_rand() % (i + 1);
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+
+	bench_start();
+	for (i = 0; i < n; i++)
+		if (!range_add_value(&queued, i, ENABLE_SUBRANGE_STEPPING))
+			bench_fail("range_add_value");
+	bench_stop("range_add_seq", n);
+
+	bench_start();
+	for (i = 0; i < n; i++)
+		(void) range_remove_value(&queued, i);
+	bench_stop("range_remove_seq", n);
+
+	/* only the first half finishes so the range stays fragmented */
+	bench_start();
+	for (i = 0; i < n / 2; i++)
+		if (!range_add_value(&done, order[i], ENABLE_SUBRANGE_STEPPING))
+			bench_fail("range_add_value");
+	bench_stop("range_add_random", n / 2);
+
+	bench_start();
+	for (i = 0; i < n; i++)
+		(void) range_contains(done, order[(i * 7919) % n]);
+	bench_stop("range_contains", n);
+
+	nstr = n / 10000 > 10 ? n / 10000 : 10;
+	bench_start();
+	for (i = 0; i < nstr; i++) {
+		/* a changed range is printed again, as after each subjob update */
+		(void) range_remove_value(&done, order[0]);
+		(void) range_add_value(&done, order[0], ENABLE_SUBRANGE_STEPPING);
+		if (range_to_str(done) == NULL)
+			bench_fail("range_to_str");
+	}
+	bench_stop("range_to_str", nstr);
+
+	if ((str = strdup(range_to_str(done))) == NULL)
+		bench_fail("strdup");
+	bench_start();
+	for (i = 0; i < nstr; i++) {
+		if ((parsed = range_parse(str)) == NULL)
+			bench_fail("range_parse");
+		free_range_list(parsed);
+	}
+	bench_stop("range_parse", nstr);
+
+	free(str);
+	free(order);
+	free_range_list(queued);
+	free_range_list(done);
+}
+
+/**
+ * @brief
+ * 		break a select specification into its chunks and their resources,
+ * 		as the scheduler does for every job, and through the cache of
+ * 		parsed specifications the server uses
+ *
+ * @param[in]	n	-	number of times the specification is parsed
+ */
+static void
+bench_select(long n)
+{
+	static char	*spec = "1:ncpus=1:mem=4gb:host=login1+16:ncpus=32:mem=192gb:mpiprocs=32:ompthreads=1"
+		"+4:ncpus=64:ngpus=4:mem=768gb:model=gpu+2:ncpus=8:mem=32gb:aoe=rhel8"
+		"+8:ncpus=32:mem=192gb:switch=sw3+1:ncpus=1:mem=1gb:vnode=node0042"
+		"+32:ncpus=16:mem=96gb:arch=linux+1:ncpus=4:mem=16gb:scratch=200gb";
+	struct key_value_pair	*kv = NULL;
+	char	*buf;
+	char	*chunk;
+	char	*last;
+	int	nchk;
+	int	nelem;
+	int	nkve = 0;
+	int	dflt;
+	int	hp;
+	long	i;
+
+	if ((buf = malloc(strlen(spec) + 1)) == NULL)
+		bench_fail("malloc");
+
+	bench_start();
+	for (i = 0; i < n; i++) {
+		strcpy(buf, spec);
+		last = buf;
+		hp = 0;
+		while ((chunk = parse_plus_spec_r(last, &last, &hp)) != NULL) {
+#ifdef NAS /* localmod 082 */
+			if (parse_chunk_r(chunk, 0, &nchk, &nelem, &nkve, &kv, &dflt) != 0)
+#else
+			if (parse_chunk_r(chunk, &nchk, &nelem, &nkve, &kv, &dflt) != 0)
+#endif /* localmod 082 */
+				bench_fail("parse_chunk_r");
+		}
+	}
+	bench_stop("select_parse", n);
+
+	bench_start();
+	for (i = 0; i < n; i++)
+		if (get_parsed_select(spec) == NULL)
+			bench_fail("get_parsed_select");
+	bench_stop("select_parse_cached", n);
+
+	free(kv);
+	free(buf);
+}
+
+/**
+ * @brief
+ * 		frame data packets the way tpp_transport_vsend() does, a length
+ * 		prefix followed by the header and the payload, and take them apart
+ * 		again as the receiving side does
+ *
+ * @param[in]	n	-	number of packets
+ */
+static void
+bench_tpp(long n)
+{
+	tpp_data_pkt_hdr_t	dhdr;
+	tpp_data_pkt_hdr_t	rhdr;
+	tpp_chunk_t		chunks[2];
+	tpp_packet_t		*pkt;
+	char			payload[1024];
+	unsigned int		sum = 0;
+	int			totlen;
+	int			ntotlen;
+	long			i;
+	int			c;
+
+	for (c = 0; c < (int) sizeof(payload); c++)
+		payload[c] = bench_rand() & 0xff;
+	memset(&dhdr, 0, sizeof(dhdr));
+	dhdr.type = TPP_DATA;
+	chunks[0].data = &dhdr;
+	chunks[0].len = sizeof(dhdr);
+	chunks[1].data = payload;
+	chunks[1].len = sizeof(payload);
+
+	bench_start();
+	for (i = 0; i < n; i++) {
+		dhdr.src_sd = htonl(i & 0xffff);
+		dhdr.seq_no = htonl(i);
+		dhdr.totlen = htonl(sizeof(payload));
+
+		totlen = 0;
+		for (c = 0; c < 2; c++)
+			totlen += chunks[c].len;
+		if ((pkt = tpp_cr_pkt(NULL, totlen + sizeof(int), 1)) == NULL)
+			bench_fail("tpp_cr_pkt");
+		ntotlen = htonl(totlen);
+		memcpy(pkt->pos, &ntotlen, sizeof(int));
+		pkt->pos += sizeof(int);
+		for (c = 0; c < 2; c++) {
+			memcpy(pkt->pos, chunks[c].data, chunks[c].len);
+			pkt->pos += chunks[c].len;
+		}
+		pkt->pos = pkt->data;
+
+		memcpy(&ntotlen, pkt->data, sizeof(int));
+		if (ntohl(ntotlen) != totlen)
+			bench_fail("tpp frame length");
+		memcpy(&rhdr, pkt->data + sizeof(int), sizeof(rhdr));
+		sum += ntohl(rhdr.seq_no) + ntohl(rhdr.totlen);
+		tpp_free_pkt(pkt);
+	}
+	bench_stop("tpp_frame", n);
+
+	if (sum == 0)
+		bench_fail("tpp frame content");
+}
+
+/**
+ * @brief
+ * 		The main function in C - entry point
+ *
+ * @param[in]	argc	-	argument count
+ * @param[in]	argv	-	pointer to argument array
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: bad usage
+ */
+int
+main(int argc, char *argv[])
+{
+	char	*which = NULL;
+	char	*end_p;
+	double	scale = 1.0;
+	int	repeats = 3;
+	int	r;
+	int	i;
+	size_t	b;
+
+	/*the real deal or output pbs_version and exit?*/
+	PRINT_VERSION_AND_EXIT(argc, argv);
+
+	while ((i = getopt(argc, argv, "b:r:x:")) != EOF) {
+		switch (i) {
+			case 'b':
+				which = optarg;
+				break;
+			case 'r':
+				repeats = strtol(optarg, &end_p, 10);
+				if (*end_p != '\0' || repeats < 1) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			case 'x':
+				scale = strtod(optarg, &end_p);
+				if (*end_p != '\0' || scale <= 0) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (optind != argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (b = 0; b < NBENCH; b++) {
+		long n;
+
+		if (which != NULL) {
+			char	*p = strstr(which, benches[b].name);
+			size_t	len = strlen(benches[b].name);
+
+			if (p == NULL || (p != which && p[-1] != ',') ||
+				(p[len] != '\0' && p[len] != ','))
+				continue;
+		}
+		n = (long) (benches[b].dflt_n * scale);
+		if (n < 1)
+			n = 1;
+		for (r = 0; r < repeats; r++) {
+			seed = BENCH_SEED;
+			benches[b].run(n);
+		}
+	}
+	if (nresults == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	printf("%-22s %10s %12s %10s\n", "benchmark", "ops", "ns/op", "allocs/op");
+	for (i = 0; i < nresults; i++)
+		printf("%-22s %10ld %12.1f %10.2f\n", results[i].name, results[i].ops,
+			results[i].ns, results[i].allocs);
+	return 0;
+}
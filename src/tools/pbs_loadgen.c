@@ -0,0 +1,556 @@
+/*
+ * Copyright (C) 1994-2020 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file    pbs_loadgen.c
+ *
+ * @brief
+ * 		pbs_loadgen - generate batch request load against a server.
+ *
+ * @par
+ *		A number of threads each open their own connection to the server
+ *		and issue a weighted random mix of submit, status, alter, delete
+ *		and select requests, timing every request.  Jobs are submitted on
+ *		user hold and without a script, so they never run; each thread only
+ *		stats, alters and deletes jobs it submitted itself and deletes
+ *		whatever is left when the run ends.  The report gives the request
+ *		rate and latency percentiles for each request type.
+ *
+ * Functions included are:
+ * 	usage()
+ * 	parse_mix()
+ * 	main()
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "cmds.h"
+#include "pbs_version.h"
+
+#define LG_JOBNAME	"pbs_loadgen"
+#define LG_MAXCONN	1024
+
+enum lg_op {
+	LG_SUBMIT,
+	LG_STAT,
+	LG_ALTER,
+	LG_DELETE,
+	LG_SELECT,
+	LG_NOPS
+};
+
+static char *lg_opnames[LG_NOPS] = {"submit", "stat", "alter", "delete", "select"};
+
+/* latencies, in seconds, of the requests of one type made by one thread */
+typedef struct lg_samples {
+	double	*lat;
+	size_t	n;
+	size_t	size;
+} lg_samples;
+
+typedef struct lg_worker {
+	pthread_t	tid;
+	int		conn;
+	unsigned int	seed;
+	char		**jobs;		/* jobs submitted and not yet deleted */
+	int		njobs;
+	lg_samples	samples[LG_NOPS];
+	long		errors[LG_NOPS];
+	int		lasterr[LG_NOPS];
+} lg_worker;
+
+static char		*server = NULL;
+static char		*destination = "";
+static char		*script = NULL;
+static int		nconn = 8;
+static int		duration = 30;
+static long		nreqs = 0;	/* requests per connection, overrides duration */
+static int		maxjobs = 100;	/* jobs a connection keeps before deleting */
+static int		weights[LG_NOPS] = {1, 4, 1, 1, 1};
+static int		weight_total;
+static struct timespec	stop_at;
+static pthread_barrier_t	start_barrier;
+
+/**
+ * @brief
+ * 		usage - shows the usage of the tool
+ *
+ * @param[in]	name	-	program name
+ */
+static void
+usage(char *name)
+{
+	fprintf(stderr, "Usage: %s [-s server] [-q destination] [-c connections]\n", name);
+	fprintf(stderr, "\t[-t seconds | -n requests] [-j jobs] [-f script]\n");
+	fprintf(stderr, "\t[-m submit=W,stat=W,alter=W,delete=W,select=W]\n");
+	fprintf(stderr, "       %s --version\n", name);
+}
+
+/**
+ * @brief
+ * 		parse_mix - set the request weights from a comma separated list of
+ *		name=weight pairs; request types not listed get weight zero.
+ *
+ * @param[in]	mix	-	the list given with -m
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: bad list
+ */
+static int
+parse_mix(char *mix)
+{
+	char	*tok;
+	char	*val;
+	char	*end;
+	int	i;
+
+	for (i = 0; i < LG_NOPS; i++)
+		weights[i] = 0;
+
+	for (tok = strtok(mix, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		if ((val = strchr(tok, '=')) == NULL)
+			return -1;
+		*val++ = '\0';
+		for (i = 0; i < LG_NOPS; i++)
+			if (strcmp(tok, lg_opnames[i]) == 0)
+				break;
+		if (i == LG_NOPS)
+			return -1;
+		weights[i] = strtol(val, &end, 10);
+		if (*val == '\0' || *end != '\0' || weights[i] < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		seconds elapsed between two monotonic clock readings
+ */
+static double
+elapsed(struct timespec *from, struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief
+ * 		record the latency of one request
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: out of memory
+ */
+static int
+add_sample(lg_samples *s, double lat)
+{
+	if (s->n == s->size) {
+		size_t	nsize = s->size ? s->size * 2 : 1024;
+		double	*nlat;
+
+		if ((nlat = realloc(s->lat, nsize * sizeof(double))) == NULL)
+			return -1;
+		s->lat = nlat;
+		s->size = nsize;
+	}
+	s->lat[s->n++] = lat;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		pick the next request type by weight, falling back to a request
+ *		that makes sense when the thread has no jobs or too many of them
+ */
+static enum lg_op
+pick_op(lg_worker *w)
+{
+	int	r = rand_r(&w->seed) % weight_total;
+	int	op;
+
+	for (op = 0; op < LG_NOPS - 1; op++) {
+		if (r < weights[op])
+			break;
+		r -= weights[op];
+	}
+
+	if (op == LG_SUBMIT && w->njobs >= maxjobs)
+		return (weights[LG_DELETE] ? LG_DELETE : LG_STAT);
+	if ((op == LG_STAT || op == LG_ALTER || op == LG_DELETE) && w->njobs == 0)
+		return (weights[LG_SUBMIT] ? LG_SUBMIT : LG_SELECT);
+	return op;
+}
+
+/**
+ * @brief
+ * 		issue one request of the given type
+ *
+ * @return	int
+ * @retval	0	: the server accepted the request
+ * @retval	!=0	: the request failed, pbs_errno is set
+ */
+static int
+do_request(lg_worker *w, enum lg_op op)
+{
+	static struct attropl	submit_attrs[] = {
+		{&submit_attrs[1], ATTR_N, NULL, LG_JOBNAME, SET},
+		{NULL, ATTR_h, NULL, "u", SET}
+	};
+	struct attropl	select_attr = {NULL, ATTR_N, NULL, LG_JOBNAME, EQ};
+	struct attrl	alter_attr = {NULL, ATTR_p, NULL, NULL, SET};
+	struct batch_status	*bs;
+	char		**sel;
+	char		*jobid;
+	char		prio[16];
+	int		rc = 0;
+	int		i = 0;
+
+	if (w->njobs > 0)
+		i = rand_r(&w->seed) % w->njobs;
+
+	switch (op) {
+		case LG_SUBMIT:
+			if ((jobid = pbs_submit(w->conn, submit_attrs, script, destination, NULL)) == NULL)
+				return pbs_errno ? pbs_errno : -1;
+			w->jobs[w->njobs++] = jobid;
+			return 0;
+
+		case LG_STAT:
+			if ((bs = pbs_statjob(w->conn, w->jobs[i], NULL, NULL)) == NULL)
+				rc = pbs_errno ? pbs_errno : -1;
+			pbs_statfree(bs);
+			break;
+
+		case LG_ALTER:
+			snprintf(prio, sizeof(prio), "%d", rand_r(&w->seed) % 1024);
+			alter_attr.value = prio;
+			if (pbs_alterjob(w->conn, w->jobs[i], &alter_attr, NULL) != 0)
+				rc = pbs_errno ? pbs_errno : -1;
+			break;
+
+		case LG_DELETE:
+			if (pbs_deljob(w->conn, w->jobs[i], NULL) != 0)
+				rc = pbs_errno ? pbs_errno : -1;
+			break;
+
+		case LG_SELECT:
+			if ((sel = pbs_selectjob(w->conn, &select_attr, NULL)) == NULL &&
+				pbs_errno != PBSE_NONE)
+				return pbs_errno;
+			free(sel);
+			return 0;
+
+		default:
+			return -1;
+	}
+
+	/* forget a job once it is deleted, or gone from the server anyway */
+	if (op == LG_DELETE ? (rc == 0 || rc == PBSE_UNKJOBID) : rc == PBSE_UNKJOBID) {
+		free(w->jobs[i]);
+		w->jobs[i] = w->jobs[--w->njobs];
+	}
+	return rc;
+}
+
+/**
+ * @brief
+ * 		body of one load generating thread
+ *
+ * @param[in]	arg	-	the thread's lg_worker
+ *
+ * @return	NULL
+ */
+static void *
+worker(void *arg)
+{
+	lg_worker	*w = arg;
+	struct timespec	t0, t1;
+	long		n;
+	enum lg_op	op;
+	int		rc;
+
+	w->conn = pbs_connect(server);
+	pthread_barrier_wait(&start_barrier);
+	if (w->conn < 0)
+		return NULL;
+
+	for (n = 0; nreqs == 0 || n < nreqs; n++) {
+		op = pick_op(w);
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		rc = do_request(w, op);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+
+		if (rc != 0) {
+			w->errors[op]++;
+			w->lasterr[op] = rc;
+			if (pbs_errno == PBSE_PROTOCOL || pbs_errno == PBSE_EXPIRED)
+				break;
+		} else if (add_sample(&w->samples[op], elapsed(&t0, &t1)) != 0) {
+			fprintf(stderr, "pbs_loadgen: out of memory\n");
+			break;
+		}
+
+		if (nreqs == 0 && elapsed(&t1, &stop_at) <= 0)
+			break;
+	}
+
+	while (w->njobs > 0) {
+		pbs_deljob(w->conn, w->jobs[--w->njobs], NULL);
+		free(w->jobs[w->njobs]);
+	}
+	pbs_disconnect(w->conn);
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		qsort comparison for latencies
+ */
+static int
+cmp_lat(const void *a, const void *b)
+{
+	double	x = *(const double *) a;
+	double	y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief
+ * 		the latency below which the given fraction of the sorted samples fall
+ */
+static double
+percentile(double *lat, size_t n, double p)
+{
+	size_t	i = (size_t)(p * n);
+
+	if (i >= n)
+		i = n - 1;
+	return lat[i];
+}
+
+/**
+ * @brief
+ * 		main - the entry point in pbs_loadgen.c
+ *
+ * @param[in]	argc	-	argument count
+ * @param[in]	argv	-	argument variables.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: bad usage or no connection could be made
+ */
+int
+main(int argc, char *argv[])
+{
+	lg_worker	*workers;
+	struct timespec	start, end;
+	double		wall;
+	long		total = 0;
+	int		connected = 0;
+	int		i, op;
+	char		*end_p;
+
+	/*the real deal or output pbs_version and exit?*/
+	PRINT_VERSION_AND_EXIT(argc, argv);
+
+	if (initsocketlib())
+		return 1;
+
+	while ((i = getopt(argc, argv, "c:f:j:m:n:q:s:t:")) != EOF) {
+		switch (i) {
+			case 'c':
+				nconn = strtol(optarg, &end_p, 10);
+				if (*end_p != '\0' || nconn < 1 || nconn > LG_MAXCONN) {
+					fprintf(stderr, "pbs_loadgen: connections must be 1 to %d\n", LG_MAXCONN);
+					return 1;
+				}
+				break;
+			case 'f':
+				script = optarg;
+				break;
+			case 'j':
+				maxjobs = strtol(optarg, &end_p, 10);
+				if (*end_p != '\0' || maxjobs < 1) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			case 'm':
+				if (parse_mix(optarg) != 0) {
+					fprintf(stderr, "pbs_loadgen: bad request mix\n");
+					return 1;
+				}
+				break;
+			case 'n':
+				nreqs = strtol(optarg, &end_p, 10);
+				if (*end_p != '\0' || nreqs < 1) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			case 'q':
+				destination = optarg;
+				break;
+			case 's':
+				server = optarg;
+				break;
+			case 't':
+				duration = strtol(optarg, &end_p, 10);
+				if (*end_p != '\0' || duration < 1) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (optind != argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (weight_total = 0, op = 0; op < LG_NOPS; op++)
+		weight_total += weights[op];
+	if (weight_total == 0) {
+		fprintf(stderr, "pbs_loadgen: request mix has no weight\n");
+		return 1;
+	}
+
+	if (CS_client_init() != CS_SUCCESS) {
+		fprintf(stderr, "pbs_loadgen: unable to initialize security library.\n");
+		return 1;
+	}
+
+	if ((workers = calloc(nconn, sizeof(lg_worker))) == NULL) {
+		fprintf(stderr, "pbs_loadgen: out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < nconn; i++) {
+		workers[i].seed = (unsigned int) time(NULL) ^ (i * 2654435761U);
+		if ((workers[i].jobs = calloc(maxjobs + 1, sizeof(char *))) == NULL) {
+			fprintf(stderr, "pbs_loadgen: out of memory\n");
+			return 1;
+		}
+	}
+
+	/* all threads connect before any of them starts the clock */
+	pthread_barrier_init(&start_barrier, NULL, nconn + 1);
+	for (i = 0; i < nconn; i++) {
+		if (pthread_create(&workers[i].tid, NULL, worker, &workers[i]) != 0) {
+			fprintf(stderr, "pbs_loadgen: cannot create thread: %s\n", strerror(errno));
+			return 1;
+		}
+	}
+	pthread_barrier_wait(&start_barrier);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	stop_at = start;
+	stop_at.tv_sec += duration;
+
+	for (i = 0; i < nconn; i++)
+		pthread_join(workers[i].tid, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wall = elapsed(&start, &end);
+
+	for (i = 0; i < nconn; i++)
+		if (workers[i].conn >= 0)
+			connected++;
+	if (connected == 0) {
+		fprintf(stderr, "pbs_loadgen: cannot connect to server %s (errno=%d)\n",
+			server ? server : pbs_server, pbs_errno);
+		CS_close_app();
+		return 1;
+	}
+
+	printf("connections %d of %d, %.2f seconds\n", connected, nconn, wall);
+	printf("%-8s %10s %8s %10s %10s %10s %10s %10s\n", "request", "count", "errors",
+		"req/s", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)");
+	for (op = 0; op < LG_NOPS; op++) {
+		lg_samples	all = {NULL, 0, 0};
+		long		errors = 0;
+		int		lasterr = 0;
+
+		for (i = 0; i < nconn; i++) {
+			lg_samples	*s = &workers[i].samples[op];
+			size_t		j;
+
+			for (j = 0; j < s->n; j++)
+				add_sample(&all, s->lat[j]);
+			errors += workers[i].errors[op];
+			if (workers[i].lasterr[op] != 0)
+				lasterr = workers[i].lasterr[op];
+			free(s->lat);
+		}
+		total += all.n;
+		if (all.n == 0 && errors == 0)
+			continue;
+
+		if (all.n > 0) {
+			qsort(all.lat, all.n, sizeof(double), cmp_lat);
+			printf("%-8s %10lu %8ld %10.1f %10.3f %10.3f %10.3f %10.3f\n",
+				lg_opnames[op], (unsigned long) all.n, errors, all.n / wall,
+				percentile(all.lat, all.n, 0.50) * 1000,
+				percentile(all.lat, all.n, 0.90) * 1000,
+				percentile(all.lat, all.n, 0.99) * 1000,
+				all.lat[all.n - 1] * 1000);
+		} else
+			printf("%-8s %10d %8ld\n", lg_opnames[op], 0, errors);
+		if (lasterr != 0)
+			printf("%-8s last error %d: %s\n", "", lasterr, pbse_to_txt(lasterr) ? pbse_to_txt(lasterr) : "");
+		free(all.lat);
+	}
+	printf("%-8s %10ld %8s %10.1f\n", "total", total, "", total / wall);
+
+	for (i = 0; i < nconn; i++)
+		free(workers[i].jobs);
+	free(workers);
+	CS_close_app();
+	return 0;
+}
@@ -514,9 +514,9 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 					continue;
 				}
 				if (strncmp(obj_name, EVENT_VNODELIST_FAIL_OBJECT, vn_fail_obj_len) == 0) {
-					rc = add_to_svrattrl_list_sorted(event_vnode_fail_svrattrl, name_str, resc_str, return_internal_value(attr_name, val_str), 0, NULL);
+					rc = add_to_svrattrl_list(event_vnode_fail_svrattrl, name_str, resc_str, return_internal_value(attr_name, val_str), 0, NULL);
 				} else {
-					rc = add_to_svrattrl_list_sorted(event_vnode_svrattrl, name_str, resc_str, return_internal_value(attr_name, val_str), 0, NULL);
+					rc = add_to_svrattrl_list(event_vnode_svrattrl, name_str, resc_str, return_internal_value(attr_name, val_str), 0, NULL);
 				}
 
 			} else if (event_jobs_svrattrl && (strncmp(obj_name, EVENT_JOBLIST_OBJECT, job_obj_len) == 0)) {
@@ -578,7 +578,7 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 					in_data[0] = '\0';
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(event_jobs_svrattrl,
+				rc = add_to_svrattrl_list(event_jobs_svrattrl,
 					name_str, resc_str, val_str, 0, NULL);
 			} else if (event_src_queue_svrattrl && (strcmp(obj_name, EVENT_SRC_QUEUE_OBJECT) == 0)) {
 				rc = add_to_svrattrl_list(event_src_queue_svrattrl,
@@ -607,6 +607,15 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 		in_data[0] = '\0';
 	}
 
+	/* the per object lists were built unsorted, sort them once now */
+	if ((event_vnode_svrattrl && sort_svrattrl_list(event_vnode_svrattrl) != 0) ||
+		(event_vnode_fail_svrattrl && sort_svrattrl_list(event_vnode_fail_svrattrl) != 0) ||
+		(event_jobs_svrattrl && sort_svrattrl_list(event_jobs_svrattrl) != 0)) {
+		log_err(errno, __func__, "failed to sort the attribute lists");
+		rc = -1;
+		goto populate_svrattrl_fail;
+	}
+
 	if (fp != stdin)
 		fclose(fp);
 
@@ -973,7 +982,7 @@ pbs_python_populate_server_svrattrl_from_file(char *input_file,
 					log_err(-1, __func__, log_buffer);
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(server_jobs_svrattrl,
+				rc = add_to_svrattrl_list(server_jobs_svrattrl,
 					name_str, resc_str, val_str, 0, NULL);
 
 				if ((p2=strrchr(name_str, '.')) != NULL)
@@ -1047,7 +1056,7 @@ pbs_python_populate_server_svrattrl_from_file(char *input_file,
 					log_err(-1, __func__, log_buffer);
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(server_vnodes_svrattrl,
+				rc = add_to_svrattrl_list(server_vnodes_svrattrl,
 					name_str, resc_str,
 					return_internal_value(attr_name, val_str), 0, NULL);
 				if ((p2=strrchr(name_str, '.')) != NULL)
@@ -1121,7 +1130,7 @@ pbs_python_populate_server_svrattrl_from_file(char *input_file,
 					log_err(-1, __func__, log_buffer);
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(server_queues_svrattrl,
+				rc = add_to_svrattrl_list(server_queues_svrattrl,
 					name_str, resc_str, val_str, 0, NULL);
 				if ((p2=strrchr(name_str, '.')) != NULL)
 					*p2 = '\0'; /* name_str=<qname> */
@@ -1193,7 +1202,7 @@ pbs_python_populate_server_svrattrl_from_file(char *input_file,
 					log_err(-1, __func__, log_buffer);
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(server_resvs_svrattrl,
+				rc = add_to_svrattrl_list(server_resvs_svrattrl,
 					name_str, resc_str, val_str, 0, NULL);
 				if ((p2=strrchr(name_str, '.')) != NULL)
 					*p2 = '\0'; /* name_str=<qname> */
@@ -1227,6 +1236,16 @@ pbs_python_populate_server_svrattrl_from_file(char *input_file,
 		}
 	}
 
+	/* the per object lists were built unsorted, sort them once now */
+	if ((server_jobs_svrattrl && sort_svrattrl_list(server_jobs_svrattrl) != 0) ||
+		(server_queues_svrattrl && sort_svrattrl_list(server_queues_svrattrl) != 0) ||
+		(server_resvs_svrattrl && sort_svrattrl_list(server_resvs_svrattrl) != 0) ||
+		(server_vnodes_svrattrl && sort_svrattrl_list(server_vnodes_svrattrl) != 0)) {
+		log_err(errno, __func__, "failed to sort the attribute lists");
+		rc = -1;
+		goto populate_server_svrattrl_fail;
+	}
+
 	if (fp != stdin)
 		fclose(fp);
 
@@ -1600,6 +1619,7 @@ main(int argc, char *argv[], char *envp[])
 		char	the_output[MAXPATHLEN + 1] = {'\0'};
 		char	the_server_output[MAXPATHLEN + 1] = {'\0'};
 		char	the_data[MAXPATHLEN + 1] = {'\0'};
+		char	code_cache[MAXPATHLEN + 1] = {'\0'};
 		char    path_log[MAXPATHLEN + 1] = {'\0'};
 		char    logname[MAXPATHLEN + 1] = {'\0'};
 
@@ -1665,7 +1685,7 @@ main(int argc, char *argv[], char *envp[])
 		strcpy(path_log, ".");
 
 		if (*(argv+2) == NULL) {
-			fprintf(stderr, "%s --hook -i <input_file> [-s <data_file>] [-o <output_file>] [-L <path_log>] [-l <logname>] [-r <resourcedef>] [-e <log_event_mask>] [<python_script>]\n", argv[0]);
+			fprintf(stderr, "%s --hook -i <input_file> [-s <data_file>] [-o <output_file>] [-L <path_log>] [-l <logname>] [-r <resourcedef>] [-e <log_event_mask>] [-c <code_cache>] [<python_script>]\n", argv[0]);
 			exit(2);
 		}
 		argv2 = (char **) argv;
@@ -1689,7 +1709,7 @@ main(int argc, char *argv[], char *envp[])
 		argv2[i] = NULL;
 
 		pbs_python_set_use_static_data_value(0);
-		while ((c = getopt(argc2, argv2, "i:o:l:L:e:r:s:")) != EOF) {
+		while ((c = getopt(argc2, argv2, "i:o:l:L:e:r:s:c:")) != EOF) {
 
 			switch (c) {
 				case 'i':
@@ -1776,11 +1796,21 @@ main(int argc, char *argv[], char *envp[])
 						}
 					}
 					break;
+				case 'c':
+					while (isspace((int)*optarg)) optarg++;
+
+					if (optarg[0] == '\0') {
+						fprintf(stderr, "pbs_python: illegal -c value\n");
+						errflg++;
+					} else {
+						snprintf(code_cache, sizeof(code_cache), "%s", optarg);
+					}
+					break;
 				default:
 					errflg++;
 			}
 			if (errflg) {
-				fprintf(stderr, "%s --hook -i <hook_input> [-s <data_file>] [-o <hook_output>] [-L <path_log>] [-l <logname>] [-r <resourcedef>] [-e <log_event_mask>] [<python_script>]\n", argv[0]);
+				fprintf(stderr, "%s --hook -i <hook_input> [-s <data_file>] [-o <hook_output>] [-L <path_log>] [-l <logname>] [-r <resourcedef>] [-e <log_event_mask>] [-c <code_cache>] [<python_script>]\n", argv[0]);
 				exit(2);
 			}
 
@@ -1985,6 +2015,9 @@ main(int argc, char *argv[], char *envp[])
 
 		(void)pbs_python_ext_alloc_python_script(hook_script,
 			(struct python_script **) &py_script);
+		/* keep the compiled script around for the next run */
+		if ((py_script != NULL) && (code_cache[0] != '\0'))
+			py_script->code_cache = strdup(code_cache);
 
 		hook_perf_stat_start(perf_label, HOOK_PERF_START_PYTHON, 0);
 		if (pbs_python_ext_start_interpreter(&svr_interp_data) != 0) {
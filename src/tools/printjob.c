@@ -432,6 +432,14 @@ print_db_job(char *id, int no_attributes)
 			fprintf(stderr, "Job %s not found\n", dbjob.ji_jobid);
 			return (1);
 		}
+		if (dbjob.db_attr_blob) {
+			if (dbblob_to_attrlist(dbjob.db_attr_blob, dbjob.db_attr_bloblen, &dbjob.db_attr_list) != 0) {
+				fprintf(stderr, "Job %s has corrupt attributes\n", dbjob.ji_jobid);
+				return (1);
+			}
+			free(dbjob.db_attr_blob);
+			dbjob.db_attr_blob = NULL;
+		}
 		db_2_job(&xjob, &dbjob);
 		snprintf(state, sizeof(state), "%c", xjob.ji_wattr[JOB_ATR_state].at_val.at_char);
 		snprintf(substate, sizeof(substate), "%ld", xjob.ji_wattr[JOB_ATR_substate].at_val.at_long);
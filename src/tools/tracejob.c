@@ -47,6 +47,7 @@
  * 	get_cols()
  * 	main()
  * 	parse_log()
+ * 	parse_log_indexed()
  * 	sort_by_date()
  * 	sort_by_message()
  * 	strip_path()
@@ -66,6 +67,14 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <termios.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#ifndef WIN32
+#include <sys/file.h>
+#endif
 #if defined(HAVE_SYS_IOCTL_H)
 #include <sys/ioctl.h>
 #endif
@@ -321,7 +330,7 @@ main(int argc, char *argv[])
 					continue;
 				}
 
-				parse_log(fp, argv[opt], j);
+				parse_log_indexed(fp, filename, argv[opt], j);
 
 				fclose(fp);
 			}
@@ -375,12 +384,45 @@ main(int argc, char *argv[])
 
 /**
  * @brief
- *		parse_log - parse out entires of a log file for a specific job
- *		    and return them in log_entry structures
+ *		read_log_line - read one line of a log file, however long
  *
  * @param[in]	fp	-	the log file
+ * @param[in,out]	buf	-	buffer for the line, grown as needed
+ * @param[in,out]	buf_size	-	size of buf
+ *
+ * @return	int
+ * @retval	1	: a line, which may lack its newline at the end of the file
+ * @retval	0	: end of file or out of memory
+ */
+static int
+read_log_line(FILE *fp, char **buf, int *buf_size)
+{
+	char *tbuf;		/* temporarily hold realloc's for main buffer */
+
+	if (fgets(*buf, *buf_size, fp) == NULL)
+		return 0;
+
+	while (*buf_size == (strlen(*buf) + 1) && (*buf)[*buf_size - 2] != '\n') {
+		*buf_size *= 2;
+		tbuf = (char*)realloc(*buf, (*buf_size + 1) * sizeof(char));
+		if (!tbuf)
+			return 0;
+		*buf = tbuf;
+		if (fgets(*buf + strlen(*buf), *buf_size/2 + 1, fp) == NULL)
+			break;
+	}
+	return 1;
+}
+
+/**
+ * @brief
+ *		parse_log_line - parse one log line and keep it as a log_entry
+ *		    if it is for a specific job
+ *
+ * @param[in]	buf	-	the line, split up in place
  * @param[in]	job	-	the name of the job
  * @param[in]	ind	-	which log file - index in enum index
+ * @param[in]	offset	-	where the line is in the log file
  *
  *	@return	nothing
  *	@note
@@ -388,189 +430,426 @@ main(int argc, char *argv[])
  *
  * @par MT-safe: No
  */
-void
-parse_log(FILE *fp, char *job, int ind)
+static void
+parse_log_line(char *buf, char *job, int ind, long offset)
 {
 	struct log_entry tmp;	/* temporary log entry */
-	char *buf;		/* buffer to read in from file */
-	char *tbuf;		/* temporarily hold realloc's for main buffer */
-	char job_buf[128];	/* hold the jobid and the . */
 	char *p;		/* pointer to use for strtok */
 	int field_count;	/* which field in log entry */
-	int j = 0;
 	struct tm tms;		/* used to convert date to unix date */
-	int lineno = 0;
 	int slen;
 	char *pdot;
-	int buf_size = 16384;	/* initial buffer size */
-	int break_fl = 0;
-
-	buf = (char*)calloc(buf_size, sizeof(char));
-	if (!buf)
-		return;
 
 	tms.tm_isdst = -1;	/* mktime() will attempt to figure it out */
 
-	strcpy(job_buf, job);
+	slen = strlen(buf);
+	if (slen > 0 && buf[slen - 1] == '\n')
+		buf[slen - 1] = '\0';
+	p = strtok(buf, ";");
+	field_count = 0;
+	memset(&tmp, 0, sizeof(struct log_entry));
+
+	for (field_count = 0; field_count < 6 && p != NULL; field_count++) {
+		switch (field_count) {
+			case FLD_DATE:
+				tmp.date = p;
+				if (ind == IND_ACCT)
+					field_count = 2;
+				break;
 
-	while (fgets(buf, buf_size, fp) != NULL) {
-		while (buf_size == (strlen(buf) + 1)) {
-			buf_size *= 2;
-			tbuf = (char*)realloc(buf, (buf_size + 1) * sizeof(char));
-			if (!tbuf) {
-				break_fl = 1;
+			case FLD_EVENT:
+				tmp.event = p;
 				break;
-			}
-			buf = tbuf;
-			if(fgets(buf + strlen(buf), buf_size/2 + 1, fp) == NULL) {
-				break_fl = 1;
+
+			case FLD_OBJ:
+				tmp.obj = p;
+				break;
+
+			case FLD_TYPE:
+				tmp.type = p;
+				break;
+
+			case FLD_NAME:
+				tmp.name = p;
 				break;
-			}
-		}
-		if (break_fl)
-			break;
-		lineno++;
-		j++;
-		buf[strlen(buf)-1] = '\0';
-		p = strtok(buf, ";");
-		field_count = 0;
-		memset(&tmp, 0, sizeof(struct log_entry));
-
-		for (field_count = 0; field_count < 6 && p != NULL; field_count++) {
-			switch (field_count) {
-				case FLD_DATE:
-					tmp.date = p;
-					if (ind == IND_ACCT)
-						field_count = 2;
-					break;
-
-				case FLD_EVENT:
-					tmp.event = p;
-					break;
-
-				case FLD_OBJ:
-					tmp.obj = p;
-					break;
-
-				case FLD_TYPE:
-					tmp.type = p;
-					break;
-
-				case FLD_NAME:
-					tmp.name = p;
-					break;
-
-				case FLD_MSG:
-					tmp.msg = p;
-					break;
-
-				default:
-					printf("Field count too big!\n");
-					printf("%s\n", p);
-			}
 
-			p = strtok(NULL, ";");
+			case FLD_MSG:
+				tmp.msg = p;
+				break;
+
+			default:
+				printf("Field count too big!\n");
+				printf("%s\n", p);
 		}
 
-		pdot = strchr(job_buf, (int)'.');
-		if (pdot == NULL && tmp.name != NULL) {
-			int	tlen = strlen(job_buf);
-
-			slen = strcspn(tmp.name, ".");
-			if (tlen > slen)
-				slen = tlen;
-		} else
-			slen = strlen(job_buf);
-
-		if (tmp.name != NULL && strncmp(job_buf, tmp.name, slen) == 0) {
-			if (ll_cur_amm >= ll_max_amm)
-				alloc_more_space();
-
-			free_log_entry(&log_lines[ll_cur_amm]);
-
-			if (tmp.date != NULL) {
-				/*
-				 * We need to parse the time string.
-				 * The string will either have high res logging or not.
-				 * The high res logging is after the dot after the seconds field.
-				 */
-				log_lines[ll_cur_amm].date = strdup(tmp.date);
-				if ((ind != IND_ACCT) && (strchr(tmp.date, '.'))) {
-					/* Parse time string looking for high res logging.  If we don't parse 7 fields, we have a invalid log time. */
-					if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d.%ld", &tms.tm_mon,
-					    &tms.tm_mday, &tms.tm_year, &tms.tm_hour, &tms.tm_min,
-					    &tms.tm_sec, &(log_lines[ll_cur_amm].highres)) != 7) {
-						log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
-						log_lines[ll_cur_amm].highres = NO_HIGH_RES_TIMESTAMP;
-					} else { /* We found all 7 fields, correctly formed time string */
-						has_high_res_timestamp = 1;
-						if (tms.tm_year > 1900)
-							tms.tm_year -= 1900;
-						/* The number of months since January,
+		p = strtok(NULL, ";");
+	}
+
+	pdot = strchr(job, (int)'.');
+	if (pdot == NULL && tmp.name != NULL) {
+		int	tlen = strlen(job);
+
+		slen = strcspn(tmp.name, ".");
+		if (tlen > slen)
+			slen = tlen;
+	} else
+		slen = strlen(job);
+
+	if (tmp.name != NULL && strncmp(job, tmp.name, slen) == 0) {
+		if (ll_cur_amm >= ll_max_amm)
+			alloc_more_space();
+
+		free_log_entry(&log_lines[ll_cur_amm]);
+
+		if (tmp.date != NULL) {
+			/*
+			 * We need to parse the time string.
+			 * The string will either have high res logging or not.
+			 * The high res logging is after the dot after the seconds field.
+			 */
+			log_lines[ll_cur_amm].date = strdup(tmp.date);
+			if ((ind != IND_ACCT) && (strchr(tmp.date, '.'))) {
+				/* Parse time string looking for high res logging.  If we don't parse 7 fields, we have a invalid log time. */
+				if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d.%ld", &tms.tm_mon,
+				    &tms.tm_mday, &tms.tm_year, &tms.tm_hour, &tms.tm_min,
+				    &tms.tm_sec, &(log_lines[ll_cur_amm].highres)) != 7) {
+					log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
+					log_lines[ll_cur_amm].highres = NO_HIGH_RES_TIMESTAMP;
+				} else { /* We found all 7 fields, correctly formed time string */
+					has_high_res_timestamp = 1;
+					if (tms.tm_year > 1900)
+						tms.tm_year -= 1900;
+					/* The number of months since January,
  						 * in the range 0 to 11 for mktime()
  						 */
-						tms.tm_mon--;
-						log_lines[ll_cur_amm].date_time = mktime(&tms);
-					}
-				} else { /* Normal time string */
-					if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d", &tms.tm_mon, &tms.tm_mday,
-					    &tms.tm_year, &tms.tm_hour, &tms.tm_min, &tms.tm_sec) != 6) {
-						log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
-					} else { /* We found all 6 fields, correctly formed time string */
-						if (tms.tm_year > 1900)
-							tms.tm_year -= 1900;
-						tms.tm_mon--;         /* The number of months since January, in the range 0 to 11 for mktime */
-						log_lines[ll_cur_amm].date_time = mktime(&tms);
-					}
-					log_lines[ll_cur_amm].highres = NO_HIGH_RES_TIMESTAMP;
-
+					tms.tm_mon--;
+					log_lines[ll_cur_amm].date_time = mktime(&tms);
 				}
+			} else { /* Normal time string */
+				if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d", &tms.tm_mon, &tms.tm_mday,
+				    &tms.tm_year, &tms.tm_hour, &tms.tm_min, &tms.tm_sec) != 6) {
+					log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
+				} else { /* We found all 6 fields, correctly formed time string */
+					if (tms.tm_year > 1900)
+						tms.tm_year -= 1900;
+					tms.tm_mon--;         /* The number of months since January, in the range 0 to 11 for mktime */
+					log_lines[ll_cur_amm].date_time = mktime(&tms);
+				}
+				log_lines[ll_cur_amm].highres = NO_HIGH_RES_TIMESTAMP;
+
 			}
-			if (tmp.event != NULL)
-				log_lines[ll_cur_amm].event = strdup(tmp.event);
-			else
-				log_lines[ll_cur_amm].event = none;
-			if (tmp.obj != NULL)
-				log_lines[ll_cur_amm].obj = strdup(tmp.obj);
-			else
-				log_lines[ll_cur_amm].obj = none;
-			if (tmp.type != NULL)
-				log_lines[ll_cur_amm].type = strdup(tmp.type);
-			else
-				log_lines[ll_cur_amm].type = none;
-			if (tmp.name != NULL)
-				log_lines[ll_cur_amm].name = strdup(tmp.name);
-			else
-				log_lines[ll_cur_amm].name = none;
-			if (tmp.msg != NULL)
-				log_lines[ll_cur_amm].msg = strdup(tmp.msg);
-			else
-				log_lines[ll_cur_amm].msg = none;
-			switch (ind) {
-				case IND_SERVER:
-					log_lines[ll_cur_amm].log_file = 'S';
-					break;
-
-				case IND_SCHED:
-					log_lines[ll_cur_amm].log_file = 'L';
-					break;
-
-				case IND_ACCT:
-					log_lines[ll_cur_amm].log_file = 'A';
-					break;
-
-				case IND_MOM:
-					log_lines[ll_cur_amm].log_file = 'M';
-					break;
-				default:
-					log_lines[ll_cur_amm].log_file = 'U';	/* undefined */
+		}
+		if (tmp.event != NULL)
+			log_lines[ll_cur_amm].event = strdup(tmp.event);
+		else
+			log_lines[ll_cur_amm].event = none;
+		if (tmp.obj != NULL)
+			log_lines[ll_cur_amm].obj = strdup(tmp.obj);
+		else
+			log_lines[ll_cur_amm].obj = none;
+		if (tmp.type != NULL)
+			log_lines[ll_cur_amm].type = strdup(tmp.type);
+		else
+			log_lines[ll_cur_amm].type = none;
+		if (tmp.name != NULL)
+			log_lines[ll_cur_amm].name = strdup(tmp.name);
+		else
+			log_lines[ll_cur_amm].name = none;
+		if (tmp.msg != NULL)
+			log_lines[ll_cur_amm].msg = strdup(tmp.msg);
+		else
+			log_lines[ll_cur_amm].msg = none;
+		switch (ind) {
+			case IND_SERVER:
+				log_lines[ll_cur_amm].log_file = 'S';
+				break;
+
+			case IND_SCHED:
+				log_lines[ll_cur_amm].log_file = 'L';
+				break;
+
+			case IND_ACCT:
+				log_lines[ll_cur_amm].log_file = 'A';
+				break;
+
+			case IND_MOM:
+				log_lines[ll_cur_amm].log_file = 'M';
+				break;
+			default:
+				log_lines[ll_cur_amm].log_file = 'U';	/* undefined */
+		}
+		log_lines[ll_cur_amm].offset = offset;
+		ll_cur_amm++;
+	}
+}
+
+/**
+ * @brief
+ *		parse_log - parse out entires of a log file for a specific job
+ *		    and return them in log_entry structures
+ *
+ * @param[in]	fp	-	the log file
+ * @param[in]	job	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ *
+ *	@return	nothing
+ *	@note
+ *		modifies global variables: loglines, ll_cur_amm, ll_max_amm
+ *
+ * @par MT-safe: No
+ */
+void
+parse_log(FILE *fp, char *job, int ind)
+{
+	char *buf;		/* buffer to read in from file */
+	int buf_size = 16384;	/* initial buffer size */
+	long offset = 0;
+
+	buf = (char*)calloc(buf_size, sizeof(char));
+	if (!buf)
+		return;
+
+	while (read_log_line(fp, &buf, &buf_size)) {
+		parse_log_line(buf, job, ind, offset);
+		offset = ftell(fp);
+	}
+	free(buf);
+}
+
+#ifndef WIN32
+/**
+ * @brief
+ *		log_index_key - the key a log line or a job is filed under in a
+ *		    log index: the object name, or the job, up to the first '.'.
+ *		    Only names that look like job or reservation IDs are indexed.
+ *
+ * @param[in]	name	-	object name or job ID
+ * @param[out]	key	-	the key, LOG_INDEX_KEYSZ bytes
+ *
+ * @return	int
+ * @retval	0	: key set
+ * @retval	-1	: name is not indexed
+ */
+static int
+log_index_key(const char *name, char *key)
+{
+	size_t len;
+
+	len = strcspn(name, ".;\n");
+	if (len == 0 || len >= LOG_INDEX_KEYSZ)
+		return -1;
+	if (!isdigit((int)name[0]) && !(isalpha((int)name[0]) && isdigit((int)name[1])))
+		return -1;
+	memcpy(key, name, len);
+	key[len] = '\0';
+	return 0;
+}
+
+/**
+ * @brief
+ *		log_line_key - the log index key of a log line, found the way
+ *		    parse_log_line() finds the object name field
+ *
+ * @param[in]	line	-	the log line
+ * @param[in]	ind	-	which log file - index in enum index
+ * @param[out]	key	-	the key, LOG_INDEX_KEYSZ bytes
+ *
+ * @return	int
+ * @retval	0	: key set
+ * @retval	-1	: the line is not indexed
+ */
+static int
+log_line_key(const char *line, int ind, char *key)
+{
+	int field = (ind == IND_ACCT) ? 2 : 4;	/* fields before the name */
+
+	while (*line == ';')
+		line++;
+	while (field > 0) {
+		if ((line = strchr(line, ';')) == NULL)
+			return -1;
+		while (*line == ';')
+			line++;
+		field--;
+	}
+	return log_index_key(line, key);
+}
+
+/**
+ * @brief
+ *		open_log_index - open, and lock, the index of a log file.  The
+ *		    index of <dir>/<file> is <dir>.index/<file>; it is created, or
+ *		    started over if it does not belong to this log file.
+ *
+ * @param[in]	filename	-	path of the log file
+ * @param[in]	sb	-	stat of the log file
+ * @param[out]	indexed	-	how much of the log file the index covers
+ *
+ * @return	FILE *
+ * @retval	the index, positioned after its header
+ * @retval	NULL	: no index can be used
+ */
+static FILE *
+open_log_index(char *filename, struct stat *sb, long *indexed)
+{
+	char idxname[MAXPATHLEN + 1];
+	char hdr[LOG_INDEX_HDRSZ + 1];
+	char *slash;
+	unsigned long ino;
+	long size;
+	FILE *ixp;
+	int fd;
+
+	if ((slash = strrchr(filename, '/')) == NULL ||
+		snprintf(idxname, sizeof(idxname), "%.*s.index",
+			(int)(slash - filename), filename) >= sizeof(idxname))
+		return NULL;
+	if (mkdir(idxname, 0755) == -1 && errno != EEXIST)
+		return NULL;
+	if (strlen(idxname) + strlen(slash) >= sizeof(idxname))
+		return NULL;
+	strcat(idxname, slash);
+
+	if ((fd = open(idxname, O_RDWR | O_CREAT, 0644)) == -1)
+		return NULL;
+	if (flock(fd, LOCK_EX) == -1 || (ixp = fdopen(fd, "r+")) == NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	if (fgets(hdr, sizeof(hdr), ixp) == NULL ||
+		sscanf(hdr, LOG_INDEX_MAGIC " %lu %ld", &ino, &size) != 2 ||
+		ino != (unsigned long)sb->st_ino || size > sb->st_size) {
+		/* new, or for an older file of the same name: start over */
+		if (ftruncate(fd, 0) == -1) {
+			fclose(ixp);
+			return NULL;
+		}
+		rewind(ixp);
+		ino = (unsigned long)sb->st_ino;
+		size = 0;
+		fprintf(ixp, LOG_INDEX_MAGIC " %20lu %20ld\n", ino, size);
+		fflush(ixp);
+	}
+	*indexed = size;
+	return ixp;
+}
+
+/**
+ * @brief
+ *		parse_log_indexed - parse_log() with the help of an index kept next
+ *		    to the log file.  The index lists the offset of each line that
+ *		    names a job; only those lines are read for the job, and the log
+ *		    is only read in full past the end of the index, which is then
+ *		    extended.  Logs are only ever appended to, so the index stays
+ *		    valid.  Without a usable index the whole log is read.
+ *
+ * @param[in]	fp	-	the log file
+ * @param[in]	filename	-	path of the log file
+ * @param[in]	job	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ *
+ *	@return	nothing
+ *
+ * @par MT-safe: No
+ */
+void
+parse_log_indexed(FILE *fp, char *filename, char *job, int ind)
+{
+	char jobkey[LOG_INDEX_KEYSZ];
+	char key[LOG_INDEX_KEYSZ];
+	char entry[LOG_INDEX_KEYSZ + 32];
+	struct stat sb;
+	FILE *ixp;
+	long indexed;
+	long offset;
+	long entry_pos;
+	long *offsets = NULL;
+	int noffsets = 0;
+	int maxoffsets = 0;
+	char *buf;
+	int buf_size = 16384;
+	int i;
+
+	if (fstat(fileno(fp), &sb) == -1 || log_index_key(job, jobkey) != 0 ||
+		(ixp = open_log_index(filename, &sb, &indexed)) == NULL) {
+		parse_log(fp, job, ind);
+		return;
+	}
+	if ((buf = (char*)calloc(buf_size, sizeof(char))) == NULL) {
+		fclose(ixp);
+		return;
+	}
+
+	/* the lines of this job in the part of the log already indexed */
+	entry_pos = ftell(ixp);
+	while (fgets(entry, sizeof(entry), ixp) != NULL) {
+		if (sscanf(entry, "%ld %63s", &offset, key) != 2 || offset >= indexed) {
+			/* left over from an update that did not finish */
+			if (ftruncate(fileno(ixp), entry_pos) == -1)
+				indexed = 0;
+			break;
+		}
+		entry_pos = ftell(ixp);
+		if (strcmp(key, jobkey) != 0)
+			continue;
+		if (noffsets == maxoffsets) {
+			long *tmp;
+
+			maxoffsets = maxoffsets ? maxoffsets * 2 : 64;
+			if ((tmp = realloc(offsets, maxoffsets * sizeof(long))) == NULL) {
+				noffsets = 0;
+				indexed = 0;
+				break;
 			}
-			log_lines[ll_cur_amm].lineno = lineno;
-			ll_cur_amm++;
+			offsets = tmp;
 		}
+		offsets[noffsets++] = offset;
+	}
+
+	for (i = 0; i < noffsets; i++) {
+		if (fseek(fp, offsets[i], SEEK_SET) == -1 ||
+			!read_log_line(fp, &buf, &buf_size))
+			break;
+		parse_log_line(buf, job, ind, offsets[i]);
+	}
+	free(offsets);
+
+	/* read the rest of the log, adding its complete lines to the index */
+	if (fseek(fp, indexed, SEEK_SET) == -1) {
+		indexed = 0;
+		rewind(fp);
+	}
+	fseek(ixp, entry_pos, SEEK_SET);
+	offset = indexed;
+	while (read_log_line(fp, &buf, &buf_size)) {
+		size_t len = strlen(buf);
+		int complete = (len > 0 && buf[len - 1] == '\n');
+
+		if (complete && log_line_key(buf, ind, key) == 0)
+			fprintf(ixp, "%ld %s\n", offset, key);
+		parse_log_line(buf, job, ind, offset);
+		if (!complete)
+			break;
+		offset = ftell(fp);
+		indexed = offset;
 	}
 	free(buf);
+
+	/* cover the new entries only once they are all written */
+	if (fflush(ixp) == 0) {
+		rewind(ixp);
+		fprintf(ixp, LOG_INDEX_MAGIC " %20lu %20ld\n", (unsigned long)sb.st_ino, indexed);
+	}
+	fclose(ixp);
+}
+#else
+void
+parse_log_indexed(FILE *fp, char *filename, char *job, int ind)
+{
+	parse_log(fp, job, ind);
 }
+#endif /* WIN32 */
 
 /**
  * @brief
@@ -607,9 +886,9 @@ sort_by_date(const void *v1, const void *v2)
 		}
 
 		if (l1->log_file == l2->log_file) {
-			if (l1->lineno < l2->lineno)
+			if (l1->offset < l2->offset)
 				return -1;
-			else if (l1->lineno > l2->lineno)
+			else if (l1->offset > l2->offset)
 				return 1;
 		}
 		return 0;
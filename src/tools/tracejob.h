@@ -71,6 +71,11 @@ extern "C" {
 
 #define SECONDS_IN_DAY 86400
 
+/* log index files, see parse_log_indexed() */
+#define LOG_INDEX_MAGIC "PBS_LOG_INDEX 1"
+#define LOG_INDEX_HDRSZ 64	/* magic, inode and size covered */
+#define LOG_INDEX_KEYSZ 64	/* "%63s" when read back */
+
 /* indicies into the mid_path array */
 enum index
 {
@@ -103,7 +108,7 @@ struct log_entry
 	char *name;		/* name of object */
 	char *msg;		/* log message */
 	char log_file;		/* What log file */
-	int lineno;		/* what line in the file.  used to stabilize the sort */
+	long offset;		/* where the line is in the file.  used to stabilize the sort */
 	unsigned no_print:1;	/* whether or not to print the message */
 	/* A=accounting S=server M=Mom L=Scheduler */
 };
@@ -111,6 +116,7 @@ struct log_entry
 /* prototypes */
 int sort_by_date(const void *v1, const void *v2);
 void parse_log(FILE *fp, char *job, int act);
+void parse_log_indexed(FILE *fp, char *filename, char *job, int act);
 char *strip_path(char *path);
 void free_log_entry(struct log_entry *lg);
 void line_wrap(char *line, int start, int end);
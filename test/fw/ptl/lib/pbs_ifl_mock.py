@@ -150,6 +150,8 @@ ATTR_max_run_res = 'max_run_res'
 ATTR_max_run_soft = 'max_run_soft'
 ATTR_max_run_res_soft = 'max_run_res_soft'
 ATTR_total = 'total_jobs'
+ATTR_modify_seq = 'modify_seq'
+ATTR_event_time = 'event_time'
 ATTR_comment = 'comment'
 ATTR_cookie = 'cookie'
 ATTR_qrank = 'queue_rank'
@@ -273,12 +275,21 @@ ATTR_resv_retry_init = 'reserve_retry_init'
 ATTR_resv_retry_time = 'reserve_retry_time'
 ATTR_JobHistoryEnable = 'job_history_enable'
 ATTR_JobHistoryDuration = 'job_history_duration'
+ATTR_DbBinaryAttrs = 'db_binary_attributes'
+ATTR_AcctJson = 'accounting_json'
+ATTR_MailDigest = 'mail_digest_interval'
+ATTR_ServerStats = 'server_stats'
+ATTR_ServerMemory = 'server_memory'
+ATTR_StatsInterval = 'server_stats_interval'
+ATTR_max_request_rate = 'max_request_rate'
+ATTR_auth_session_lifetime = 'auth_session_lifetime'
 ATTR_max_concurrent_prov = 'max_concurrent_provision'
 ATTR_resv_post_processing = 'resv_post_processing_time'
 ATTR_backfill_depth = 'backfill_depth'
 ATTR_job_requeue_timeout = 'job_requeue_timeout'
 ATTR_SchedHost = 'sched_host'
 ATTR_sched_cycle_len = 'sched_cycle_length'
+ATTR_sched_cycle_profile = 'sched_cycle_profile'
 ATTR_do_not_span_psets = 'do_not_span_psets'
 ATTR_soft_time = 'soft_limit_time'
 ATTR_power_provisioning = 'power_provisioning'
@@ -335,6 +346,10 @@ SHUT_WHO_SECDRY = 0x40
 SHUT_WHO_IDLESECDRY = 0x80
 SHUT_WHO_SECDONLY = 0x100
 
+SUBSCRIBE_JOB = 'job'
+SUBSCRIBE_NODE = 'node'
+SUBSCRIBE_RESV = 'resv'
+
 USER_HOLD = 'u'
 OTHER_HOLD = 'o'
 SYSTEM_HOLD = 's'
@@ -395,6 +410,10 @@ def pbs_alterjob(c, jobid, attrib, extend):
     pass
 
 
+def pbs_alterjob_sel(c, sel, attrib, extend):
+    pass
+
+
 def pbs_connect(c):
     pass
 
@@ -467,6 +486,10 @@ def pbs_statfree(batch_status):
     pass
 
 
+def pbs_status_columns(bs, names):
+    pass
+
+
 def pbs_statjob(c, jobid, attrl, extend):
     pass
 
@@ -519,6 +542,10 @@ def pbs_submit(c, attropl, script, destin, extend):
     pass
 
 
+def pbs_submit_many(c, attropl, njobs, job_attropls, scripts, destin, extend):
+    pass
+
+
 def pbs_submit_resv(c, attropl, jobid):
     pass
 
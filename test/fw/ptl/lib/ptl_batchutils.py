@@ -354,6 +354,49 @@ class BatchUtils(object):
             bs = bs.__next__
         return ret
 
+    def batch_status_to_columns(self, bs=None, attr_names=None):
+        """
+        Convert a batch status to a dictionary of columns, one list of
+        values per attribute and an 'id' list, all in the order of the
+        batch status. Entries that lack an attribute get None. Unlike
+        batch_status_to_dictlist, times are not converted.
+
+        :param bs: Batch status
+        :param attr_names: Attribute names, None for all of them
+        :returns: Dictionary of lists
+        """
+        if API_OK:
+            return pbs_status_columns(bs, attr_names)
+        cols = {'id': []}
+        if attr_names is not None:
+            for name in attr_names:
+                cols[name] = []
+        row = 0
+        while bs:
+            cols['id'].append(bs.name)
+            for k in cols:
+                if k != 'id':
+                    cols[k].append(None)
+            attrs = bs.attribs
+            while attrs is not None:
+                if attrs.resource:
+                    key = attrs.name + '.' + attrs.resource
+                else:
+                    key = attrs.name
+                if key not in cols:
+                    if attr_names is not None:
+                        attrs = attrs.__next__
+                        continue
+                    cols[key] = [None] * (row + 1)
+                if cols[key][row] is None:
+                    cols[key][row] = str(attrs.value)
+                else:
+                    cols[key][row] += ',' + str(attrs.value)
+                attrs = attrs.__next__
+            row += 1
+            bs = bs.__next__
+        return cols
+
     def display_batch_status(self, bs=None, attr_names=None,
                              writer=sys.stdout):
         """
@@ -0,0 +1,101 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import json
+import time
+
+from tests.functional import *
+
+
+class TestAccountingJson(TestFunctional):
+    """
+    With accounting_json set the server writes each accounting record
+    as a JSON line as well
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {ATTR_AcctJson: True})
+        self.addCleanup(self.server.manager, MGR_CMD_UNSET, SERVER,
+                        ATTR_AcctJson)
+
+    def json_records(self, jid):
+        """
+        Return the JSON records of job jid from today's file
+        """
+        path = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                            'server_priv', 'accounting',
+                            time.strftime('%Y%m%d') + '.json')
+        ret = self.du.cat(self.server.hostname, path, sudo=True)
+        recs = []
+        for line in ret['out']:
+            rec = json.loads(line)
+            if rec['id'] == jid:
+                recs.append(rec)
+        return recs
+
+    def test_job_end_record(self):
+        """
+        The E record has resources_used and exec_vnode as structured
+        fields
+        """
+        j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', id=jid, op=UNSET, offset=1)
+        self.server.accounting_match(';E;%s;' % jid, id=jid)
+        recs = self.json_records(jid)
+        types = [r['type'] for r in recs]
+        self.assertIn('Q', types)
+        self.assertIn('S', types)
+        e = [r for r in recs if r['type'] == 'E'][0]
+        self.assertIn('cput', e['resources_used'])
+        self.assertEqual(e['Resource_List']['ncpus'], '1')
+        self.assertEqual(e['exec_vnode'][0]['vnode'], self.mom.shortname)
+        self.assertEqual(e['exec_vnode'][0]['resources']['ncpus'],
+                         '1')
+
+    def test_unset_stops_json(self):
+        """
+        No JSON records are written once accounting_json is unset
+        """
+        self.server.manager(MGR_CMD_UNSET, SERVER, ATTR_AcctJson)
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.accounting_match(';Q;%s;' % jid, id=jid)
+        self.assertEqual(self.json_records(jid), [])
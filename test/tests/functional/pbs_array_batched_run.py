@@ -0,0 +1,112 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import re
+
+from tests.functional import *
+
+
+class TestArrayBatchedRun(TestFunctional):
+    """
+    Test that the subjobs of an array run together in one cycle when the
+    scheduler sends their runs to the server as one batch
+    """
+
+    def runsubjobs_count(self):
+        """
+        Number of Run Subjobs requests the server served so far
+        """
+        if self.du.is_localhost(self.server.hostname):
+            cmd = "list server server_stats"
+        else:
+            cmd = "'list server server_stats'"
+        qmgr = [os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qmgr'), '-c', cmd]
+        ret = self.du.run_cmd(self.server.hostname, qmgr, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        m = re.search(r'req\.RunSubjobs_Async:count=(\d+)',
+                      "\n".join(ret['out']))
+        return int(m.group(1)) if m else 0
+
+    def test_subjobs_run_in_one_cycle(self):
+        """
+        All subjobs that fit start in the same cycle and keep their own
+        exec_vnode
+        """
+        a = {'resources_available.ncpus': 8}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, attrs={ATTR_J: '1-8'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        before = self.runsubjobs_count()
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'array_state_count':
+                                 'Queued:0 Running:8 Exiting:0 '
+                                 'Expired:0 '}, id=jid)
+        # all eight runs went to the server in a single request
+        self.assertEqual(self.runsubjobs_count() - before, 1)
+        for i in range(1, 9):
+            self.server.expect(JOB, {'job_state': 'R',
+                                     'exec_vnode': (MATCH_RE, '.+')},
+                               id=j.create_subjob_id(jid, i))
+        self.server.delete(jid, wait=True)
+
+    def test_subjobs_placed_in_one_pass(self):
+        """
+        Once a subjob of an array runs, the subjobs that still fit are
+        placed in the same pass over the array, and placement stops at
+        the first one that does not fit
+        """
+        a = {'resources_available.ncpus': 8}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, attrs={ATTR_J: '1-20'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        start = time.time()
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'array_state_count':
+                                 'Queued:12 Running:8 Exiting:0 '
+                                 'Expired:0 '}, id=jid)
+        self.scheduler.log_match(
+            jid + ";Ran 7 more subjobs of the array in one pass",
+            starttime=start)
+        self.server.delete(jid, wait=True)
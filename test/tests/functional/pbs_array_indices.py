@@ -0,0 +1,95 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestArrayIndices(TestFunctional):
+    """
+    Test the remaining indices of large and stepped array jobs as
+    subjobs are run and deleted
+    """
+
+    def test_stepped_array_remaining(self):
+        """
+        Run and delete subjobs of a stepped array and check
+        array_indices_remaining after each change and across a restart
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'max_array_size': 200000})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        j = Job(TEST_USER, attrs={ATTR_J: '1-199999:2'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'B'}, id=jid)
+        self.server.expect(JOB, {'array_indices_remaining': '5-199999:2'},
+                           id=jid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.server.delete(j.create_subjob_id(jid, 101))
+        self.server.expect(JOB, {'array_indices_remaining':
+                                 '5-99:2,103-199999:2'}, id=jid)
+        self.server.delete(j.create_subjob_id(jid, 5))
+        self.server.expect(JOB, {'array_indices_remaining':
+                                 '7-99:2,103-199999:2'}, id=jid)
+        self.server.restart()
+        self.server.expect(JOB, {'array_indices_remaining':
+                                 '7-99:2,103-199999:2'}, id=jid)
+
+    def test_qrun_subjob_range(self):
+        """
+        Run a range of subjobs of a large array with qrun and check
+        only those indices leave the remaining list
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'max_array_size': 200000})
+        a = {'resources_available.ncpus': 4}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, attrs={ATTR_J: '0-99999'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.runjob(j.create_subjob_id(jid, 70000))
+        self.server.runjob(j.create_subjob_id(jid, 70001))
+        self.server.expect(JOB, {'array_indices_remaining':
+                                 '0-69999,70002-99999'}, id=jid)
+        self.server.expect(JOB, {'array_state_count':
+                                 'Queued:99998 Running:2 Exiting:0 '
+                                 'Expired:0 '}, id=jid)
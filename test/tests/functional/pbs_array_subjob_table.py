@@ -0,0 +1,88 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestArraySubjobTable(TestFunctional):
+    """
+    Test the compact subjob tracking table of array jobs, which only
+    keeps pointers for instantiated subjobs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def test_large_array_states(self):
+        """
+        A large array keeps correct state counts while a few subjobs run
+        and the remaining indices survive a server restart
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'max_array_size': 200000})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        j = Job(TEST_USER, attrs={ATTR_J: '0-99999'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'B'}, id=jid)
+        self.server.expect(JOB, {'array_state_count':
+                                 'Queued:99998 Running:2 Exiting:0 '
+                                 'Expired:0 '}, id=jid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.server.delete(j.create_subjob_id(jid, 0), wait=True)
+        self.server.expect(JOB, {'array_indices_remaining': '2-99999'},
+                           id=jid)
+        self.server.restart()
+        self.server.expect(JOB, {'array_indices_remaining': '2-99999'},
+                           id=jid)
+        self.server.expect(JOB, {'job_state': 'R'},
+                           id=j.create_subjob_id(jid, 1))
+
+    def test_array_exit_status(self):
+        """
+        The exit status of a finished array reflects its failed subjob
+        """
+        j = Job(TEST_USER, attrs={ATTR_J: '1-3'})
+        j.create_script('test $PBS_ARRAY_INDEX -ne 2\n')
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 1},
+                           id=jid, extend='x', offset=1)
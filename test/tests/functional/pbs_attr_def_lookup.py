@@ -0,0 +1,75 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestAttrDefLookup(TestFunctional):
+    """
+    Test the lookup of attribute and resource definitions by name
+    """
+
+    def test_case_insensitive(self):
+        """
+        Attribute and resource names are still found regardless of case
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, {'resource_list.NCPUS': 2, 'job_name': 'lookup'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'Resource_List.ncpus': 2,
+                                 ATTR_N: 'lookup'}, id=jid)
+
+    def test_custom_resource_again(self):
+        """
+        A custom resource can be deleted and created again, and is found
+        each time
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        for _ in range(2):
+            self.server.manager(MGR_CMD_CREATE, RSC,
+                                {'type': 'long', 'flag': 'q'}, id='foo')
+            j = Job(TEST_USER, {'Resource_List.foo': 3})
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'Resource_List.foo': 3}, id=jid)
+            self.server.delete(jid, wait=True)
+            self.server.manager(MGR_CMD_DELETE, RSC, id='foo')
+        j = Job(TEST_USER, {'Resource_List.foo': 3})
+        with self.assertRaises(PbsSubmitError):
+            self.server.submit(j)
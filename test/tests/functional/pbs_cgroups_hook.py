@@ -4148,6 +4148,35 @@ sleep 300
         self.server.delete(id=jid, wait=True)
         self.assertFalse(self.is_dir(ehjd1, ehost1), "job cpuset dir found")
 
+    def test_cgroup_discovery_reused(self):
+        """
+        Test that the CPUs and devices discovered by one hook event are
+        saved and reused by the following events instead of being
+        discovered again
+        """
+        self.load_default_config()
+        c = {'$logevent': '0xffffffff'}
+        self.mom.add_config(c)
+        pbs_home = self.mom.pbs_conf['PBS_HOME']
+        dfile = os.path.join(os.sep, pbs_home, 'mom_priv', 'hooks',
+                             '%s.discovery' % self.hook_name)
+        self.mom.restart()
+        self.assertTrue(self.du.isfile(hostname=self.mom.shortname,
+                                       path=dfile, sudo=True),
+                        'discovery file not saved')
+        begin = time.time()
+        a = {'Resource_List.select': 'ncpus=1'}
+        j = Job(TEST_USER, attrs=a)
+        j.create_script(self.sleep15_job)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, jid)
+        self.mom.log_match('_load_discovery: Using discovery file',
+                           starttime=begin)
+        self.mom.log_match('_discover_devices: Method called',
+                           starttime=begin, existence=False,
+                           max_attempts=2, interval=1)
+        self.server.delete(id=jid, wait=True)
+
     def tearDown(self):
         TestFunctional.tearDown(self)
         mom_checks = True
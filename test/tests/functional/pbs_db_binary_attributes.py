@@ -0,0 +1,96 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestDbBinaryAttributes(TestFunctional):
+    """
+    Test that job attributes saved in the binary form selected by the
+    db_binary_attributes server attribute survive a server restart
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {ATTR_DbBinaryAttrs: 'True'})
+        self.addCleanup(self.server.manager, MGR_CMD_UNSET, SERVER,
+                        ATTR_DbBinaryAttrs)
+
+    def test_job_attrs_recovered(self):
+        """
+        Submit a held job with string, long, size, boolean and list valued
+        attributes, restart the server and check they are all recovered
+        """
+        a = {ATTR_N: 'binattrs', ATTR_h: None, ATTR_r: 'n',
+             ATTR_l + '.walltime': '01:02:03', ATTR_l + '.mem': '20mb',
+             ATTR_l + '.ncpus': '1', ATTR_v: 'FOO=bar,BAZ=qux',
+             ATTR_p: '10'}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        exp = {ATTR_N: 'binattrs', ATTR_state: 'H', ATTR_r: 'False',
+               'Resource_List.walltime': '01:02:03',
+               'Resource_List.mem': '20mb',
+               'Resource_List.ncpus': '1', ATTR_p: '10'}
+        self.server.expect(JOB, exp, id=jid)
+        self.server.restart()
+        self.server.expect(JOB, exp, id=jid)
+        job = self.server.status(JOB, id=jid)[0]
+        self.assertIn('FOO=bar', job[ATTR_v])
+        self.assertIn('BAZ=qux', job[ATTR_v])
+
+    def test_existing_jobs_unchanged(self):
+        """
+        Jobs submitted before db_binary_attributes is set keep being
+        saved and recovered in the regular form
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {ATTR_DbBinaryAttrs: 'False'})
+        j = Job(TEST_USER, {ATTR_N: 'before', ATTR_h: None})
+        jid1 = self.server.submit(j)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {ATTR_DbBinaryAttrs: 'True'})
+        j = Job(TEST_USER, {ATTR_N: 'after', ATTR_h: None})
+        jid2 = self.server.submit(j)
+        self.server.alterjob(jid1, {ATTR_N: 'before1'})
+        self.server.alterjob(jid2, {ATTR_N: 'after1'})
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'before1'}, id=jid1)
+        self.server.expect(JOB, {ATTR_N: 'after1'}, id=jid2)
@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestDbHotAttributes(TestFunctional):
+    """
+    Test that the often changed job attributes, saved apart from the
+    others, and the others both survive a server restart
+    """
+
+    def test_hot_and_other_attrs_recovered(self):
+        """
+        Alter a job's comment and its name in turns, restarting the
+        server after each, and check neither change is lost
+        """
+        j = Job(TEST_USER, {ATTR_N: 'hot0', ATTR_h: None})
+        jid = self.server.submit(j)
+        self.server.alterjob(jid, {ATTR_comment: 'comment1'},
+                             runas=ROOT_USER)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'hot0', ATTR_comment: 'comment1'},
+                           id=jid)
+        self.server.alterjob(jid, {ATTR_N: 'hot1'})
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'hot1', ATTR_comment: 'comment1'},
+                           id=jid)
+        self.server.alterjob(jid, {ATTR_comment: 'comment2'},
+                             runas=ROOT_USER)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'hot1', ATTR_comment: 'comment2'},
+                           id=jid)
+
+    def test_running_job_recovered(self):
+        """
+        A running job whose state and usage were saved since it was
+        submitted comes back running with its other attributes
+        """
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        j = Job(TEST_USER, {ATTR_N: 'hotrun', ATTR_l + '.ncpus': '1'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_state: 'R', ATTR_N: 'hotrun',
+                                 'Resource_List.ncpus': '1'}, id=jid)
+        self.server.expect(JOB, 'exec_host', op=SET, id=jid)
@@ -2127,3 +2127,30 @@ else:
                 break
         self.assertTrue(found, "%s didn't found in any sched cycle" % jidh)
         self.assertIn(jid2.split('.')[0], sched_cycle.sched_job_run)
+
+    def test_failures_kept_across_cycles(self):
+        """
+        Test that the reason a job equivalence class can not run is reused
+        in the next cycle when nothing has changed, and forgotten once the
+        universe changes
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        # Eat up all the resources
+        a = {'Resource_List.select': '1:ncpus=8'}
+        (jid1, ) = self.submit_jobs(1, a)
+        jids = self.submit_jobs(3, a)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[0])
+
+        # Nothing has changed, the next cycle reuses the failure
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        msg = "Reusing [0-9]+ job equivalence class failures from the last"
+        self.scheduler.log_match(msg, regexp=True, starttime=t)
+
+        # Freeing the resources makes the failure stale
+        self.server.delete(jid1, wait=True)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
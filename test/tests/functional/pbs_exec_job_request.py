@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestExecJobRequest(TestFunctional):
+    """
+    The server hands a job that has not run yet to its Mother Superior
+    with a single Exec Job request carrying the attributes, the script
+    and the credential, which the MoM commits at once
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def test_script_runs(self):
+        """
+        The script sent with the request is the one the job runs
+        """
+        j = Job(TEST_USER)
+        j.create_script(['#!/bin/sh', 'echo execjob_marker_$((40+2))'])
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x', max_attempts=30)
+        job = self.server.status(JOB, id=jid, extend='x')[0]
+        out = job[ATTR_o].split(':', 1)[1]
+        ret = self.du.cat(self.server.client, filename=out, sudo=True)
+        self.assertIn('execjob_marker_42', ret['out'])
+
+    def test_rerun_job(self):
+        """
+        A rerun job is sent again with the separate requests that also
+        move its files, and runs to completion
+        """
+        j = Job(TEST_USER)
+        j.create_script(['#!/bin/sh', 'sleep 5'])
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R', 'run_count': 1}, id=jid)
+        self.server.rerunjob(jid)
+        self.server.expect(JOB, {'job_state': 'R', 'run_count': 2}, id=jid)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x', max_attempts=30)
@@ -461,3 +461,34 @@ class TestFairshare(TestFunctional):
         self.server.expect(JOB, {'job_state': 'R'}, id=jid3, offset=15)
         self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': True})
         self.server.expect(JOB, {'job_state': 'R'}, id=jid1, offset=15)
+
+    def test_fairshare_usage_delta(self):
+        """
+        Test that the usage a running job accumulates between cycles is
+        added to its entity once, and not again in a cycle where the job's
+        usage did not change
+        """
+        self.mom.add_config({'$min_check_poll': 1, '$max_check_poll': 2})
+        self.scheduler.set_sched_config({'fair_share': 'True',
+                                         'fairshare_usage_res': 'walltime'})
+        self.scheduler.add_to_resource_group(TEST_USER, 10, 'root', 50)
+        self.scheduler.set_fairshare_usage(TEST_USER, 1)
+
+        j = Job(TEST_USER)
+        j.set_sleep_time(120)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, {'resources_used.walltime':
+                                 (GT, '00:00:06')}, id=jid, offset=8)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.scheduler.run_scheduling_cycle()
+        fs = self.scheduler.query_fairshare(name=str(TEST_USER))
+        usage = int(fs.usage)
+        self.assertGreater(usage, 6)
+
+        # the job's walltime changes by at most a few seconds between the two
+        # cycles, so its whole usage must not be added a second time
+        self.scheduler.run_scheduling_cycle()
+        fs = self.scheduler.query_fairshare(name=str(TEST_USER))
+        self.assertLess(int(fs.usage), 2 * usage)
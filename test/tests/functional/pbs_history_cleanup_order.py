@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestHistoryCleanupOrder(TestFunctional):
+    """
+    Test that the history cleanup purges the expired history jobs, which
+    the server keeps ordered by their history timestamp
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'job_history_enable': 'True', 'job_history_duration': 5}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+    def test_expired_jobs_purged_after_restart(self):
+        """
+        History jobs recovered at startup are purged once expired
+        """
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid,
+                               extend='x', offset=1)
+        self.server.restart()
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x')
+        # history work task runs every two minutes
+        self.logger.info("Wait for history work task to process...")
+        time.sleep(125)
+        for jid in jids:
+            with self.assertRaises(PbsStatusError) as e:
+                self.server.status(JOB, id=jid, extend='x')
+            # rc = 153 is for 'Unknown Job Id'
+            self.assertEqual(e.exception.rc, 153)
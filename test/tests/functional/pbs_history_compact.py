@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestHistoryCompact(TestFunctional):
+    """
+    Test that finished history jobs, which the server keeps with only part
+    of their attributes, still show all of them when statused
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+
+    def check_full_stat(self, jid):
+        """
+        The full status of the finished job has its run time attributes
+        """
+        a = {'job_state': 'F',
+             'exec_vnode': (MATCH_RE, self.mom.shortname),
+             'exec_host': (MATCH_RE, self.mom.shortname),
+             'Variable_List': (MATCH_RE, 'PBS_O_HOME'),
+             'Submit_arguments': (MATCH_RE, '.+')}
+        self.server.expect(JOB, a, id=jid, extend='x')
+
+    def test_full_stat_of_history_job(self):
+        """
+        A finished job shows its run time attributes, also after a server
+        restart and after being selected on one of them
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=1)
+        self.check_full_stat(jid)
+        self.server.restart()
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x')
+        self.check_full_stat(jid)
+        sel = self.server.select({'exec_host': (EQ, self.mom.shortname +
+                                                '/0')}, extend='x')
+        self.assertIn(jid, sel)
+        self.check_full_stat(jid)
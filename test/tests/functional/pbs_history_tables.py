@@ -0,0 +1,88 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestHistoryTables(TestFunctional):
+    """
+    Test that finished jobs kept in the history tables of the database
+    are saved, recovered and deleted like the active ones
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+    def test_histjob_recovered_after_restart(self):
+        """
+        A finished job moved to the history tables comes back in full
+        after a server restart
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid,
+                           extend='x', offset=1)
+        self.server.restart()
+        a = {'job_state': 'F', 'substate': 92, 'Exit_status': 0}
+        self.server.expect(JOB, a, id=jid, extend='x')
+        self.server.expect(JOB, 'exec_host', op=SET, id=jid, extend='x')
+
+    def test_deleted_histjob_not_recovered(self):
+        """
+        A history job deleted by the user is gone from the history
+        tables, while the other history jobs stay
+        """
+        jids = []
+        for _ in range(2):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid,
+                               extend='x', offset=1)
+        self.server.deljob(jids[0], extend='deletehist')
+        self.server.restart()
+        with self.assertRaises(PbsStatusError) as e:
+            self.server.status(JOB, id=jids[0], extend='x')
+        # rc = 153 is for 'Unknown Job Id'
+        self.assertEqual(e.exception.rc, 153)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jids[1], extend='x')
@@ -74,3 +74,55 @@ class TestHookExechostPeriodic(TestFunctional):
                            max_attempts=5, interval=5)
         self.mom.log_match("exechost_periodic hook2",
                            max_attempts=5, interval=5)
+
+    def test_job_list_filter_started(self):
+        """
+        With job_list_filter=started an exechost_periodic hook gets a job
+        once, on the run after it starts, and an empty job_list after that
+        """
+        hook_body = ("import pbs\n"
+                     "e = pbs.event()\n"
+                     "pbs.logmsg(pbs.EVENT_DEBUG,\n"
+                     "\t\"filtered job_list: %s\" % \\\n"
+                     "\t','.join(sorted(e.job_list.keys())))\n"
+                     "e.accept()\n")
+        attr = {'event': 'exechost_periodic', 'enabled': 'True',
+                'freq': '5', 'job_list_filter': 'started'}
+        self.server.create_import_hook("filtered", attr, hook_body)
+        self.server.expect(HOOK, {'job_list_filter': 'started'},
+                           id='filtered')
+        j = Job(TEST_USER)
+        j.set_sleep_time(300)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.log_match("filtered job_list: %s" % jid,
+                           max_attempts=10, interval=2)
+        t = time.time()
+        self.mom.log_match("filtered job_list: $", regexp=True,
+                           starttime=t, max_attempts=10, interval=2)
+        self.mom.log_match("filtered job_list: %s" % jid, starttime=t,
+                           existence=False, max_attempts=2)
+
+    def test_job_list_filter_values(self):
+        """
+        job_list_filter only takes its listed values, and only on an
+        exechost_periodic hook
+        """
+        attr = {'event': 'execjob_begin'}
+        self.server.create_hook("begin_hook", attr)
+        with self.assertRaises(PbsManagerError):
+            self.server.manager(MGR_CMD_SET, HOOK,
+                                {'job_list_filter': 'started'},
+                                id='begin_hook')
+        attr = {'event': 'exechost_periodic'}
+        self.server.create_hook("periodic_hook", attr)
+        with self.assertRaises(PbsManagerError):
+            self.server.manager(MGR_CMD_SET, HOOK,
+                                {'job_list_filter': 'all,started'},
+                                id='periodic_hook')
+        self.server.manager(MGR_CMD_SET, HOOK,
+                            {'job_list_filter': 'ended,resources_used'},
+                            id='periodic_hook')
+        self.server.expect(HOOK,
+                           {'job_list_filter': 'ended,resources_used'},
+                           id='periodic_hook')
@@ -0,0 +1,120 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookLazyAttributes(TestFunctional):
+    """
+    Job and vnode attribute values given to hooks by the server are set
+    on the Python objects only when first accessed
+    """
+
+    def test_runjob_reads(self):
+        """
+        A runjob hook sees the job attribute values it reads, and values
+        it does not read are left unchanged on the job
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+j = e.job
+pbs.logmsg(pbs.LOG_DEBUG, "lazy name=%s ncpus=%s" %
+           (j.Job_Name, j.Resource_List["ncpus"]))
+v = pbs.server().vnode(pbs.server().name)
+pbs.logmsg(pbs.LOG_DEBUG, "lazy vnode=%s" % (v.name,))
+e.accept()
+"""
+        a = {'event': 'runjob', 'enabled': 'True'}
+        self.server.create_import_hook('lazy_run', a, hook_body)
+        j = Job(TEST_USER, {ATTR_N: 'lazyjob', ATTR_l + '.ncpus': 1})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R', ATTR_N: 'lazyjob'},
+                           id=jid)
+        self.server.log_match("lazy name=lazyjob ncpus=1")
+
+    def test_modifyjob_job_o(self):
+        """
+        A modifyjob hook reading the original job sees its values, and
+        its own change is the only one applied
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+jo = e.job_o
+e.job.comment = "was %s" % (jo.Job_Name,)
+e.accept()
+"""
+        a = {'event': 'modifyjob', 'enabled': 'True'}
+        self.server.create_import_hook('lazy_mod', a, hook_body)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, {ATTR_N: 'before', ATTR_p: 10})
+        jid = self.server.submit(j)
+        self.server.alterjob(jid, {ATTR_N: 'after'})
+        self.server.expect(JOB, {ATTR_N: 'after', 'comment': 'was before',
+                                 ATTR_p: 10}, id=jid)
+
+    def test_jobs_filtered(self):
+        """
+        pbs.server().jobs() and pbs.queue().jobs() only hand the hook the
+        jobs matching the requested states and owner
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+s = pbs.server()
+held = len(list(s.jobs(state="H")))
+queued = len(list(s.jobs(state="Q", username="%s")))
+nobody = len(list(s.jobs(username="nosuchuser")))
+inq = len(list(s.queue("workq").jobs(state="QH")))
+pbs.logmsg(pbs.LOG_DEBUG, "filtered held=%%d queued=%%d nobody=%%d inq=%%d" %%
+           (held, queued, nobody, inq))
+e.accept()
+""" % (str(TEST_USER),)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER, {ATTR_h: None})
+        self.server.submit(j1)
+        j2 = Job(TEST_USER)
+        self.server.submit(j2)
+        a = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('lazy_filter', a, hook_body)
+        j3 = Job(TEST_USER)
+        self.server.submit(j3)
+        self.server.log_match("filtered held=1 queued=1 nobody=0 inq=2")
@@ -0,0 +1,84 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestHookNamespaceReuse(TestFunctional):
+    """
+    The _pbs_v1 module put in each hook's namespace is built once per
+    Python interpreter rather than once per hook run
+    """
+
+    hook_body = """
+import pbs
+e = pbs.event()
+j = e.job
+j.Resource_List["ncpus"] = 1
+if pbs.QUEUEJOB != e.type:
+    e.reject("bad event type")
+e.accept()
+"""
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('qjob', a, self.hook_body)
+
+    def test_many_runs(self):
+        """
+        The hook sees the module constants on every run
+        """
+        for _ in range(20):
+            jid = self.server.submit(Job(TEST_USER))
+            self.server.expect(JOB, {'Resource_List.ncpus': 1}, id=jid)
+
+    def test_interpreter_restart(self):
+        """
+        After the interpreter is restarted the hook still sees the
+        module constants
+        """
+        a = {'python_restart_max_hooks': 2,
+             'python_restart_min_interval': 1}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        for _ in range(6):
+            jid = self.server.submit(Job(TEST_USER))
+            self.server.expect(JOB, {'Resource_List.ncpus': 1}, id=jid)
+            time.sleep(1)
+        self.server.log_match("Restarting Python interpreter")
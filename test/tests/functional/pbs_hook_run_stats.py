@@ -0,0 +1,97 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestHookRunStats(TestFunctional):
+    """
+    The server keeps per event run counters for each hook, shown in
+    the read-only run_stats hook attribute
+    """
+
+    hook_body = """
+import pbs
+e = pbs.event()
+if e.job.Job_Name == "bad":
+    e.reject("bad name")
+e.accept()
+"""
+
+    def list_run_stats(self, hook_name):
+        if self.du.is_localhost(self.server.hostname):
+            cmd = "list hook %s run_stats" % hook_name
+        else:
+            cmd = "'list hook %s run_stats'" % hook_name
+        qmgr = [os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qmgr'), '-c', cmd]
+        ret = self.du.run_cmd(self.server.hostname, qmgr, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        return "\n".join(ret['out'])
+
+    def test_counts(self):
+        """
+        Accepted and rejected runs are counted, and run_stats is left
+        out of the full hook listing
+        """
+        a = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('stats', a, self.hook_body)
+        for _ in range(3):
+            self.server.submit(Job(TEST_USER))
+        j = Job(TEST_USER, {ATTR_N: 'bad'})
+        with self.assertRaises(PbsSubmitError):
+            self.server.submit(j)
+
+        out = self.list_run_stats('stats')
+        self.assertIn("queuejob:runs=4,rejects=1,alarms=0", out)
+        self.assertIn("p99=", out)
+
+        h = self.server.status(HOOK, id='stats')
+        self.assertNotIn('run_stats', h[0])
+
+    def test_not_settable(self):
+        """
+        run_stats cannot be set
+        """
+        a = {'event': 'queuejob', 'enabled': 'True'}
+        self.server.create_import_hook('stats', a, self.hook_body)
+        with self.assertRaises(PbsManagerError):
+            self.server.manager(MGR_CMD_SET, HOOK, {'run_stats': 'x'},
+                                id='stats')
@@ -0,0 +1,158 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestIflAsync(TestFunctional):
+
+    """
+    Tests for the tagged requests sent with the pbs_async_*() IFL calls
+    """
+
+    def test_async_stat_alter(self):
+        """
+        Send tagged status and alter job requests for several jobs on one
+        connection, without waiting between them, and verify that
+        pbs_async_wait() hands back a reply for every tag
+        """
+        if not API_OK:
+            self.skipTest("needs the swig generated pbs_ifl module")
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, attrs={ATTR_h: None})
+            jids.append(self.server.submit(j))
+
+        c = pbs_connect(self.server.hostname)
+        self.assertGreaterEqual(c, 0, "could not connect to the server")
+        try:
+            stat_tags = {}
+            alter_tags = {}
+            a = BatchUtils().dict_to_attrl({ATTR_N: 'async'})
+            for jid in jids:
+                stat_tags[pbs_async_statjob(c, jid, None, None)] = jid
+                alter_tags[pbs_async_alterjob(c, jid, a, None)] = jid
+            self.assertNotIn(0, stat_tags)
+            self.assertNotIn(0, alter_tags)
+
+            replied = {}
+            for _ in range(30):
+                if len(replied) == len(stat_tags) + len(alter_tags):
+                    break
+                head = pbs_async_wait(c, 2, None, None)
+                r = head
+                while r is not None:
+                    names = []
+                    s = r.status
+                    while s is not None:
+                        names.append(s.name)
+                        s = s.next
+                    replied[r.tag] = (r.code, names)
+                    r = r.next
+                pbs_asyncstatfree(head)
+        finally:
+            pbs_disconnect(c)
+
+        for tag, jid in stat_tags.items():
+            self.assertIn(tag, replied)
+            self.assertEqual(replied[tag], (0, [jid]))
+        for tag in alter_tags:
+            self.assertIn(tag, replied)
+            self.assertEqual(replied[tag][0], 0)
+        for jid in jids:
+            self.server.expect(JOB, {ATTR_N: 'async'}, id=jid)
+
+    def test_async_selstat_per_queue(self):
+        """
+        Send a tagged selectable status request for each of two queues on
+        one connection and verify each reply holds the jobs of its queue
+        only, then verify the scheduler, which asks for the jobs of all its
+        queues this way, runs jobs from both queues
+        """
+        if not API_OK:
+            self.skipTest("needs the swig generated pbs_ifl module")
+        a = {'queue_type': 'execution', 'enabled': 'True',
+             'started': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='workq2')
+        a = {'resources_available.ncpus': 4}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = {}
+        for q in ['workq', 'workq2']:
+            jids[q] = []
+            for _ in range(2):
+                j = Job(TEST_USER, attrs={ATTR_queue: q})
+                jids[q].append(self.server.submit(j))
+
+        c = pbs_connect(self.server.hostname)
+        self.assertGreaterEqual(c, 0, "could not connect to the server")
+        try:
+            tags = {}
+            for q in jids:
+                sel = BatchUtils().dict_to_attropl({ATTR_queue: (EQ, q)})
+                tags[pbs_async_selstat(c, sel, None, 'S')] = q
+            self.assertNotIn(0, tags)
+
+            replied = {}
+            for _ in range(30):
+                if len(replied) == len(tags):
+                    break
+                head = pbs_async_wait(c, 2, None, None)
+                r = head
+                while r is not None:
+                    names = []
+                    s = r.status
+                    while s is not None:
+                        names.append(s.name)
+                        s = s.next
+                    replied[r.tag] = (r.code, sorted(names))
+                    r = r.next
+                pbs_asyncstatfree(head)
+        finally:
+            pbs_disconnect(c)
+
+        for tag, q in tags.items():
+            self.assertIn(tag, replied)
+            self.assertEqual(replied[tag], (0, sorted(jids[q])))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        for q in jids:
+            for jid in jids[q]:
+                self.server.expect(JOB, {'job_state': 'R'}, id=jid)
@@ -0,0 +1,80 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestJobAllocParse(TestFunctional):
+    """
+    Test that the resources a running job has on its vnodes, which the
+    server takes from the parsed exec_vnode the job keeps, are assigned
+    and given back correctly
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2, 'resources_available.mem': '2gb'}
+        self.server.create_vnodes('vn', a, 4, self.mom, usenatvnode=True)
+
+    def check_assigned(self, ncpus, mem):
+        """
+        Every vnode has the given ncpus and mem assigned
+        """
+        a = {'resources_assigned.ncpus': ncpus,
+             'resources_assigned.mem': mem}
+        for i in range(4):
+            self.server.expect(NODE, a, id='vn[%d]' % i)
+
+    def test_assign_and_free(self):
+        """
+        A job on all the vnodes has its resources assigned while running,
+        also across a server restart, and freed once it ends
+        """
+        a = {'Resource_List.select': '4:ncpus=2:mem=1gb',
+             'Resource_List.place': 'vscatter'}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time(30)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.check_assigned(2, '1048576kb')
+        self.server.restart()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.check_assigned(2, '1048576kb')
+        self.server.delete(jid, wait=True)
+        self.check_assigned(0, '0kb')
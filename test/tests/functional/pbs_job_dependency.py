@@ -142,6 +142,33 @@ e.accept()
         self.server.expect(JOB, {ATTR_state: 'H', ATTR_h: 's'}, id=j3)
         self.assert_dependency(j1, j2, j3)
 
+    def test_runone_group_runs_one_job_per_cycle(self):
+        """
+        Submit a group of queued jobs having runone dependency on each
+        other, with room for all of them to run, and see that the
+        scheduler runs only one job of the group and the rest are held.
+        """
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        job = Job()
+        jids = [self.server.submit(job)]
+        for _ in range(5):
+            a = {ATTR_depend: 'runone:' + jids[-1]}
+            jids.append(self.server.submit(Job(attrs=a)))
+        for jid in jids:
+            self.server.expect(JOB, {ATTR_state: 'Q'}, id=jid)
+        self.assert_dependency(*jids)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': 1}, count=True)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        running = [jid for jid in jids if self.server.status(
+            JOB, id=jid)[0][ATTR_state] == 'R']
+        self.assertEqual(len(running), 1)
+        for jid in jids:
+            if jid not in running:
+                self.server.expect(JOB, {ATTR_state: 'H'}, id=jid)
+
     def test_runone_depend_basic_on_job_array(self):
         """
         Test basic runone dependency tests on job arrays
@@ -551,3 +578,56 @@ e.accept()
                            max_attempts=3)
         self.check_depend_delete_msg(j3, j4)
         self.server.expect(JOB, {ATTR_state: 'R'}, id=j1)
+
+    def test_wide_dependency_fan_in_and_fan_out(self):
+        """
+        Submit a job which depends on many jobs and many jobs which depend
+        on a single job, more than the server searches in order before it
+        indexes the jobs of a dependency, and see that each job is held
+        until the last job it depends on ends.
+        """
+
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        parents = []
+        for _ in range(24):
+            job = Job()
+            job.set_sleep_time(1)
+            parents.append(self.server.submit(job))
+        job = Job()
+        job.set_sleep_time(30)
+        last = self.server.submit(job)
+        parents.append(last)
+
+        a = {ATTR_depend: "afterok:" + ":".join(reversed(parents))}
+        job = Job(attrs=a)
+        job.set_sleep_time(1)
+        fan_in = self.server.submit(job)
+
+        fan_out = []
+        for _ in range(24):
+            a = {ATTR_depend: "afterok:" + last}
+            job = Job(attrs=a)
+            job.set_sleep_time(1)
+            fan_out.append(self.server.submit(job))
+
+        self.server.expect(JOB, {ATTR_state: 'H'}, id=fan_in)
+        for jid in fan_out:
+            self.server.expect(JOB, {ATTR_state: 'H'}, id=jid)
+        depend = self.server.status(JOB, id=last)[0][ATTR_depend]
+        self.assertEqual(depend.count('@'), len(fan_out) + 1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        for jid in parents[:-1]:
+            self.server.expect(JOB, {ATTR_state: 'F'}, id=jid, extend='x')
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=last)
+        self.server.expect(JOB, {ATTR_state: 'H'}, id=fan_in)
+        depend = self.server.status(JOB, id=fan_in)[0][ATTR_depend]
+        self.assertEqual(depend.split('@')[0], 'afterok:' + last)
+
+        self.server.expect(JOB, {ATTR_state: 'F'}, id=last, extend='x',
+                           offset=20)
+        self.server.expect(JOB, {ATTR_state: 'F'}, id=fan_in, extend='x')
+        for jid in fan_out:
+            self.server.expect(JOB, {ATTR_state: 'F'}, id=jid, extend='x')
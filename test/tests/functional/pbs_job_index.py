@@ -0,0 +1,65 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestJobIndex(TestFunctional):
+    """
+    Test job lookups by id through the hashed job index
+    """
+
+    def test_find_after_delete(self):
+        """
+        Submit jobs, delete every other one and check each job id is
+        found or not found as expected
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(100):
+            jids.append(self.server.submit(Job(TEST_USER)))
+        self.server.delete(jids[::2], wait=True)
+        for jid in jids[1::2]:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+        for jid in jids[::2]:
+            with self.assertRaises(PbsStatusError):
+                self.server.status(JOB, id=jid)
+        self.server.restart()
+        for jid in jids[1::2]:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
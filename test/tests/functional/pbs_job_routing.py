@@ -179,3 +179,37 @@ class TestJobRouting(TestFunctional):
                            id=jid, extend='t')
         self.server.expect(JOB, {ATTR_state + '=X': 2}, count=True,
                            id=jid, extend='t')
+
+    def test_route_on_destination_change(self):
+        """
+        Test that jobs turned away by a disabled or full destination are
+        routed as soon as the destination changes, without waiting for
+        route_retry_time
+        """
+        a = {ATTR_qtype: 'execution', ATTR_enable: 'False',
+             ATTR_start: 'True', ATTR_maxque: 2}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='destq')
+        a = {ATTR_qtype: 'route', ATTR_routedest: 'destq',
+             ATTR_enable: 'True', ATTR_start: 'True',
+             ATTR_routeretry: 3600}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='routeq')
+
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, attrs={ATTR_queue: 'routeq'})
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {ATTR_queue: 'routeq'}, id=jid)
+
+        # Enabling the destination lets the jobs it has room for in
+        self.server.manager(MGR_CMD_SET, QUEUE, {ATTR_enable: 'True'},
+                            id='destq')
+        self.server.expect(JOB, {ATTR_queue + '=destq': 2}, count=True)
+        self.server.expect(JOB, {ATTR_queue + '=routeq': 1}, count=True)
+
+        # Room made in the destination lets the last one in
+        routed = self.server.select(attrib={ATTR_queue: 'destq'})
+        self.server.deljob(routed[0], wait=True)
+        self.server.expect(JOB, {ATTR_queue + '=destq': 2}, count=True,
+                           max_attempts=10)
+        self.server.expect(JOB, {ATTR_queue + '=routeq': 0}, count=True)
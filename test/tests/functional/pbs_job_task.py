@@ -103,3 +103,45 @@ class TestJobTask(TestFunctional):
         if job_status:
             job_output_file = job_status[0]['Output_Path'].split(':')[1]
         self.check_jobs_file(job_output_file)
+
+    def run_pbsdsh_all(self, nprocs, opts=''):
+        """
+        Run pbsdsh over every vnode of a job with nprocs mpiprocs and
+        return the lines of its output
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': nprocs},
+                            id=self.mom.shortname)
+        a = {ATTR_S: '/bin/bash',
+             'Resource_List.select': '1:ncpus=%d:mpiprocs=%d' % (nprocs,
+                                                                 nprocs)}
+        job = Job(TEST_USER, attrs=a)
+        pbsdsh_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                  'bin', 'pbsdsh')
+        script = ['%s %s -- /bin/echo "OK"' % (pbsdsh_cmd, opts)]
+        job.create_script(body=script)
+        jid = self.server.submit(job)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           id=jid, extend='x', max_attempts=120)
+        job_status = self.server.status(JOB, id=jid, extend='x')
+        job_output_file = job_status[0]['Output_Path'].split(':')[1]
+        ret = self.du.cat(hostname=self.server.shortname,
+                          filename=job_output_file, runas=TEST_USER)
+        self.assertEqual(ret['rc'], 0)
+        return ret['out']
+
+    def test_pbsdsh_many_vnodes(self):
+        """
+        This test case validates that pbsdsh starts a task on each of
+        the many vnodes of a job and collects every exit status
+        """
+        out = self.run_pbsdsh_all(64)
+        self.assertEqual(out.count('OK'), 64)
+
+    def test_pbsdsh_many_vnodes_sync(self):
+        """
+        This test case validates that synchronous pbsdsh still starts
+        one task after the other on each vnode of a job
+        """
+        out = self.run_pbsdsh_all(16, '-s')
+        self.assertEqual(out.count('OK'), 16)
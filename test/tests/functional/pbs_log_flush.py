@@ -0,0 +1,78 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestLogFlush(TestFunctional):
+    """
+    The server writes its log once per pass of its main loop, records
+    must still show up before the server waits for the next request
+    """
+
+    def test_records_written_without_traffic(self):
+        """
+        The record of a request is in the log once the request is
+        answered, with no further requests coming in
+        """
+        j = Job(TEST_USER)
+        jid = self.server.submit(j)
+        self.server.log_match("%s;Job Queued" % jid, max_attempts=5,
+                              interval=1)
+
+    def test_max_log_events(self):
+        """
+        Every record is written with all log events on
+        """
+        a = {'log_events': 2047, 'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        jids = []
+        for _ in range(50):
+            jids.append(self.server.submit(Job(TEST_USER)))
+        for jid in jids:
+            self.server.log_match("%s;Job Queued" % jid, n='ALL',
+                                  max_attempts=5, interval=1)
+
+    def test_log_closed_on_shutdown(self):
+        """
+        Records held when the server stops are written
+        """
+        self.server.stop()
+        self.server.log_match("Log closed", max_attempts=5, interval=1)
+        self.server.start()
@@ -0,0 +1,107 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMailDigest(TestFunctional):
+    """
+    Mail is sent through the server's mailer helper, and with
+    mail_digest_interval set, the mail to one recipient is sent as a
+    digest
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mailout = self.du.create_temp_file(prefix='PtlPbsMailOut')
+        body = "#!/bin/sh\n"
+        body += "{ echo \"MAILER $*\"; cat; } >> %s\n" % self.mailout
+        self.mailer = self.du.create_temp_file(prefix='PtlPbsMailer',
+                                               body=body)
+        self.du.chmod(path=self.mailer, mode=0o755)
+        self.du.chmod(path=self.mailout, mode=0o666)
+        self.server.manager(MGR_CMD_SET, SERVER, {'mailer': self.mailer})
+
+    def mail_text(self):
+        ret = self.du.cat(filename=self.mailout, sudo=True)
+        return "\n".join(ret['out'])
+
+    def submit_jobs(self, count):
+        jids = []
+        for _ in range(count):
+            j = Job(TEST_USER, {ATTR_m: 'b'})
+            j.set_sleep_time(100)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        return jids
+
+    def test_no_digest(self):
+        """
+        Without mail_digest_interval each message is sent on its own
+        """
+        jids = self.submit_jobs(2)
+        self.logger.info("Wait for the mailer")
+        time.sleep(3)
+        out = self.mail_text()
+        for jid in jids:
+            self.assertIn("Subject: PBS JOB %s" % jid, out)
+            self.assertIn("PBS Job Id: %s" % jid, out)
+        self.assertEqual(out.count("MAILER "), 2)
+        self.assertNotIn("PBS digest", out)
+
+    def test_digest(self):
+        """
+        Messages to the same recipient within the interval are sent
+        as one digest once the interval is over
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {ATTR_MailDigest: 10})
+        jids = self.submit_jobs(3)
+        time.sleep(1)
+        self.assertEqual(self.mail_text().count("MAILER "), 0)
+
+        self.logger.info("Wait for the digest interval to pass")
+        time.sleep(12)
+        out = self.mail_text()
+        self.assertEqual(out.count("MAILER "), 1)
+        self.assertIn("Subject: PBS digest of 3 messages", out)
+        for jid in jids:
+            self.assertIn("==== PBS JOB %s ====" % jid, out)
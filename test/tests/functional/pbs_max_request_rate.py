@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMaxRequestRate(TestFunctional):
+    """
+    max_request_rate limits the status, select and job list delete
+    requests each user at each host may send per second
+    """
+
+    def qstat(self):
+        qstat = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qstat')
+        return self.du.run_cmd(self.server.hostname, [qstat],
+                               runas=TEST_USER)
+
+    def test_rate_exceeded(self):
+        """
+        Status requests beyond the rate are rejected with a try again
+        error, and accepted again once the allowance has refilled
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'max_request_rate': 2})
+        rejected = 0
+        for _ in range(10):
+            ret = self.qstat()
+            if ret['rc'] != 0:
+                self.assertIn('Try the request again later',
+                              '\n'.join(ret['err']))
+                rejected += 1
+        self.assertGreater(rejected, 0)
+
+        time.sleep(2)
+        self.assertEqual(self.qstat()['rc'], 0)
+
+        # other users are not held back by TEST_USER's rate
+        self.server.status(SERVER)
+
+    def test_no_limit(self):
+        """
+        Without max_request_rate no request is rejected
+        """
+        self.server.manager(MGR_CMD_UNSET, SERVER, 'max_request_rate')
+        for _ in range(10):
+            self.assertEqual(self.qstat()['rc'], 0)
@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomCgroupSample(TestFunctional):
+    """
+    Test the sampling of job resource usage by MoM, which reads job
+    cgroups when the cgroups hook has created them and walks /proc
+    otherwise
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$min_check_poll': 1, '$max_check_poll': 2})
+
+    def test_usage_reported(self):
+        """
+        A running job has its cput, mem and vmem usage reported
+        """
+        a = {'Resource_List.walltime': 60}
+        j = Job(TEST_USER, a)
+        j.create_script('i=0; while [ $i -lt 3000000 ]; do i=$((i+1)); '
+                        'done; sleep 10')
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        for r in ['cput', 'mem', 'vmem']:
+            self.server.expect(JOB, 'resources_used.' + r, op=SET,
+                               id=jid, offset=2)
+
+    def test_cgroup_prefix(self):
+        """
+        The $cgroup_prefix directive is accepted and the job still
+        runs to completion
+        """
+        self.mom.add_config({'$cgroup_prefix': 'pbs_jobs'})
+        self.mom.log_match('cgroup_prefix;pbs_jobs')
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        j = Job(TEST_USER, {'Resource_List.walltime': 60})
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F',
+                                 'resources_used.walltime': (GE, '00:00:00')},
+                           id=jid, extend='x', offset=5)
@@ -0,0 +1,81 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomHookCodeCache(TestFunctional):
+    """
+    Mom hooks run as root keep their compiled script in the hooks work
+    directory, and pick up a changed script
+    """
+
+    hook_body = """
+import pbs
+pbs.logmsg(pbs.LOG_DEBUG, "cached hook says %s")
+pbs.event().accept()
+"""
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom_host = self.mom.shortname
+        self.cache = os.path.join(self.mom.pbs_conf['PBS_HOME'],
+                                  'mom_priv', 'hooks', 'tmp',
+                                  'hook_ccache.pyc')
+
+    def run_job(self):
+        jid = self.server.submit(Job(TEST_USER, {ATTR_l + '.walltime': 1}))
+        self.server.expect(JOB, 'queue', id=jid, op=UNSET, offset=1)
+
+    def test_cache_reused_and_refreshed(self):
+        """
+        The cache file is written on the first run, and a new script
+        version is run instead of the cached one
+        """
+        a = {'event': 'execjob_begin', 'enabled': 'True'}
+        self.server.create_import_hook('ccache', a, self.hook_body % 'one')
+        self.run_job()
+        self.mom.log_match("cached hook says one")
+        self.assertTrue(self.du.isfile(hostname=self.mom_host,
+                                       path=self.cache, sudo=True))
+        self.run_job()
+        self.server.create_import_hook('ccache', a, self.hook_body % 'two')
+        self.run_job()
+        self.mom.log_match("cached hook says two")
@@ -420,3 +420,22 @@ class TestMomHookSync(TestFunctional):
 
         # compare rescdef files between mom and server
         self.compare_rescourcedef()
+
+    def test_no_resend_after_server_restart(self):
+        """
+        After a server restart, hook files are not sent again to moms
+        whose reported hook checksums show they already have them
+        """
+        now = time.time()
+        self.server.restart()
+        self.server.expect(NODE, {'state': 'free'}, id=self.hostA)
+        self.server.expect(NODE, {'state': 'free'}, id=self.hostB)
+
+        for host in (self.momA.hostname, self.momB.hostname):
+            self.server.log_match(
+                'mom %s already has the hook, not resending' % host,
+                starttime=now, max_attempts=10)
+            self.server.log_match(
+                'successfully sent hook file .*cpufreq.PY ' +
+                'to %s.*' % host, existence=False,
+                starttime=now, max_attempts=5, regexp=True)
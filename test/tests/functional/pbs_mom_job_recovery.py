@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestMomJobRecovery(TestFunctional):
+    """
+    Test that MoM recovers the jobs it is running from their job files
+    when it is restarted
+    """
+
+    def test_recover_running_jobs(self):
+        """
+        Running jobs, including ones with large attributes, keep their
+        attribute values across a MoM restart
+        """
+        self.server.manager(MGR_CMD_SET, NODE, {'resources_available.ncpus':
+                                                8}, id=self.mom.shortname)
+        big = 'x' * 9000
+        jids = []
+        for i in range(8):
+            a = {ATTR_v: 'RECOV_VAR=val_%d,RECOV_BIG=%s' % (i, big),
+                 ATTR_N: 'recov_%d' % i}
+            j = Job(TEST_USER, attrs=a)
+            j.set_sleep_time(300)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.stop(sig='-INT')
+        self.mom.start(args=['-p'])
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid, offset=2)
+        for i, jid in enumerate(jids):
+            self.server.expect(JOB, {'Job_Name': 'recov_%d' % i}, id=jid)
+        for jid in jids:
+            self.server.delete(jid, wait=True)
+        self.mom.log_match('error reading attributes portion',
+                           existence=False, max_attempts=2,
+                           starttime=self.server.ctime)
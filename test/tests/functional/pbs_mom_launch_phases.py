@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestMomLaunchPhases(TestFunctional):
+    """
+    Test the per-phase breakdown of the time MoM spends launching a job
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$logevent': '0xffffffff'})
+
+    def check_phases(self, jid):
+        msg = ('%s;launch phases \(ms\): fork=\d+ setup=\d+ prologue=\d+ '
+               'limits=\d+ launch=\d+ start=\d+' % jid)
+        self.mom.log_match(msg, regexp=True, max_attempts=30, interval=2)
+
+    def test_launch_phases_logged(self):
+        """
+        A batch job logs the time spent in each launch phase
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.check_phases(jid)
+
+    def test_launch_phases_with_prologue(self):
+        """
+        An execjob_prologue hook still runs before the job starts now that
+        the job starter does not wait on the prologue request, and its time
+        is reported with the other launch phases
+        """
+        hook_body = """
+import pbs
+pbs.logmsg(pbs.LOG_DEBUG, "launch phase prologue ran")
+"""
+        a = {'event': 'execjob_prologue', 'enabled': 'True'}
+        self.server.create_import_hook('launch_prolo', a, hook_body)
+        j = Job(TEST_USER)
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.log_match('launch phase prologue ran', max_attempts=30,
+                           interval=2)
+        self.check_phases(jid)
@@ -77,3 +77,26 @@ class TestMomMockRun(TestFunctional):
         self.server.accounting_match(
             msg=used_walltime, existence=False, id=jid,
             max_attempts=1, n='ALL')
+
+    def test_mock_run_runtime(self):
+        """
+        Test that $mock_run_runtime ends mock run jobs before their walltime
+        """
+        self.mom.add_config({'$mock_run_runtime': '2-4'}, hup=False)
+        self.mom.stop()
+
+        mompath = os.path.join(self.server.pbs_conf["PBS_EXEC"], "sbin",
+                               "pbs_mom")
+        cmd = [mompath, "-m"]
+        self.du.run_cmd(hosts=self.mom.shortname, cmd=cmd, sudo=True)
+
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        attr = {ATTR_l + ".walltime": "01:00:00"}
+        start = time.time()
+        jid = self.server.submit(Job(attrs=attr))
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.log_match("%s;Started mock run of job, runtime" % jid,
+                           starttime=start)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': '0'},
+                           id=jid, extend='x', offset=2, max_attempts=10)
@@ -0,0 +1,96 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestMomOutputDelivery(TestFunctional):
+    """
+    Test the delivery of job output to a destination local to the MoM:
+    renaming or copying out of the spool in-process, and the
+    $auto_direct_write MoM directive
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.outdir = self.du.create_temp_dir(asuser=TEST_USER, mode=0o755)
+        self.outfile = os.path.join(self.outdir, 'delivered.out')
+        self.spool = os.path.join(self.mom.pbs_conf['PBS_HOME'], 'spool')
+
+    def submit_output_job(self, script, attrs=None):
+        a = {ATTR_o: self.mom.shortname + ':' + self.outfile, ATTR_j: 'oe'}
+        if attrs:
+            a.update(attrs)
+        j = Job(TEST_USER, a)
+        j.create_script(script)
+        return self.server.submit(j)
+
+    def test_large_output_delivered(self):
+        """
+        A large standard output is delivered intact and leaves the spool
+        """
+        jid = self.submit_output_job(
+            '#!/bin/sh\nhead -c 67108864 /dev/zero | tr "\\0" "x"\n')
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=2,
+                           max_attempts=60)
+        ret = self.du.run_cmd(self.mom.hostname, ['stat', '-c', '%s',
+                              self.outfile], runas=TEST_USER)
+        self.assertEqual(ret['rc'], 0)
+        self.assertEqual(ret['out'][0].strip(), '67108864')
+        ret = self.du.run_cmd(self.mom.hostname, ['ls', self.spool],
+                              sudo=True)
+        self.assertFalse([f for f in ret['out'] if f.startswith(
+            jid.split('.')[0] + '.')], 'output left in the spool')
+
+    def test_auto_direct_write(self):
+        """
+        With $auto_direct_write the output is written at its destination
+        while the job runs, not in the spool
+        """
+        self.mom.add_config({'$auto_direct_write': 'True'})
+        jid = self.submit_output_job(
+            '#!/bin/sh\necho started\nsleep 30\n')
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        time.sleep(2)
+        ret = self.du.run_cmd(self.mom.hostname, ['cat', self.outfile],
+                              runas=TEST_USER)
+        self.assertIn('started', ret['out'])
+        spooled = os.path.join(self.spool, jid + '.OU')
+        self.assertFalse(self.du.isfile(self.mom.hostname, spooled,
+                                        sudo=True), 'output in the spool')
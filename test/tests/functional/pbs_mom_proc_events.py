@@ -0,0 +1,81 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomProcEvents(TestFunctional):
+    """
+    Test that MoM notices the exit of a task that is not its child from
+    kernel process events instead of waiting for the next poll
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if self.mom.is_cpuset_mom():
+            self.skipTest('not applicable to cpuset MoM')
+        self.mom.add_config({'$min_check_poll': 60,
+                             '$max_check_poll': 120,
+                             '$logevent': '0xffffffff'})
+        self.restart_time = int(time.time())
+        self.mom.restart()
+
+    def test_attached_task_exit(self):
+        """
+        The exit of an attached task is found well before the next
+        resources_used poll
+        """
+        self.mom.log_match('listening for process exit events',
+                           starttime=self.restart_time)
+        pbs_attach = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                  'bin', 'pbs_attach')
+        body = ['%s -j $PBS_JOBID -P -s /bin/sleep 12\n' % pbs_attach,
+                '/bin/sleep 60\n']
+        j = Job(TEST_USER, {'Resource_List.walltime': 120})
+        j.create_script(body=body)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
+        start = time.time()
+        self.mom.log_match('%s;pid.+attached as task' % jid, regexp=True,
+                           starttime=int(start) - 2)
+        self.mom.log_match('%s;no active process for task' % jid,
+                           starttime=int(start), max_attempts=30,
+                           interval=1)
+        self.assertLess(time.time() - start, 45)
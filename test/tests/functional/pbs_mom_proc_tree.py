@@ -0,0 +1,108 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomProcTree(TestFunctional):
+    """
+    Test MoM's handling of the processes of a job's session, which are
+    looked up by session id and parent pid in the sampled process table
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$min_check_poll': 1, '$max_check_poll': 2})
+
+    def count_procs(self, marker):
+        """
+        Return the number of processes on the MoM host whose command line
+        contains marker
+        """
+        cmd = "ps -eo args | grep '%s' | grep -v grep | wc -l" % marker
+        ret = self.du.run_cmd(self.mom.hostname, cmd=cmd, as_script=True)
+        return int(ret['out'][0])
+
+    def test_delete_kills_tree(self):
+        """
+        Deleting a job kills every process of its session, including
+        background children and grandchildren, and usage is reported
+        for all of them while it runs
+        """
+        marker = 'ptree_%d' % os.getpid()
+        script = ('sh -c "sleep 301 # %s" &\n'
+                  'sh -c "sh -c \\"sleep 302 # %s\\" & wait" &\n'
+                  'sleep 303 # %s\n') % (marker, marker, marker)
+        j = Job(TEST_USER, {'Resource_List.walltime': 120})
+        j.create_script(script)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, 'resources_used.vmem', op=SET, id=jid,
+                           offset=2)
+        self.assertGreaterEqual(self.count_procs(marker), 3)
+        self.server.delete(jid, wait=True)
+        self.assertEqual(self.count_procs(marker), 0)
+
+    def test_concurrent_exits(self):
+        """
+        Jobs whose sessions end together while another job keeps running
+        are each matched to their own exit, finish promptly and keep the
+        usage sampled just before their processes were reaped
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        self.server.manager(MGR_CMD_SET, NODE, {'resources_available.ncpus':
+                                                6}, id=self.mom.shortname)
+        long = Job(TEST_USER, {'Resource_List.walltime': 120})
+        long.set_sleep_time(100)
+        ljid = self.server.submit(long)
+        self.server.expect(JOB, {'job_state': 'R'}, id=ljid)
+        jids = []
+        for _ in range(5):
+            j = Job(TEST_USER)
+            j.create_script('i=0; while [ $i -lt 200000 ]; do '
+                            'i=$((i+1)); done\n')
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                               id=jid, extend='x', offset=1, max_attempts=60)
+            self.server.expect(JOB, 'resources_used.cput', op=SET, id=jid,
+                               extend='x')
+        self.server.expect(JOB, {'job_state': 'R'}, id=ljid)
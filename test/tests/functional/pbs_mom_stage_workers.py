@@ -0,0 +1,101 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestMomStageWorkers(TestFunctional):
+    """
+    Test the $stage_workers MoM directive, which stages the file pairs of
+    a request several at a time
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$stage_workers': 3})
+        self.srcdir = self.du.create_temp_dir(asuser=TEST_USER, mode=0o755)
+        self.dstdir = self.du.create_temp_dir(asuser=TEST_USER, mode=0o755)
+        self.names = ['stg_file_%d' % i for i in range(5)]
+        for n in self.names:
+            self.du.run_cmd(cmd=['dd', 'if=/dev/urandom',
+                                 'of=' + os.path.join(self.srcdir, n),
+                                 'bs=64k', 'count=4'],
+                            runas=TEST_USER)
+
+    def test_parallel_stagein_stageout(self):
+        """
+        All file pairs of a job are staged in and back out with several
+        transfer workers
+        """
+        host = self.mom.shortname
+        sin = ','.join(['%s@%s:%s' % (n, host, os.path.join(self.srcdir, n))
+                        for n in self.names])
+        sout = ','.join(['%s@%s:%s' % (n, host, self.dstdir)
+                         for n in self.names])
+        j = Job(TEST_USER, {ATTR_stagein: sin, ATTR_stageout: sout})
+        j.create_script('#!/bin/sh\nls ' + ' '.join(self.names) + '\n')
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_history_enable': True})
+        jid = self.server.submit(j)
+        self.mom.log_match('%s;Staged 5/5 items in' % jid, max_attempts=30,
+                           interval=2)
+        self.mom.log_match('%s;Staged 5/5 items out' % jid, max_attempts=30,
+                           interval=2)
+        self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                           extend='x', id=jid, offset=2)
+        for n in self.names:
+            ret = self.du.run_cmd(cmd=['cmp', os.path.join(self.srcdir, n),
+                                       os.path.join(self.dstdir, n)],
+                                  runas=TEST_USER)
+            self.assertEqual(ret['rc'], 0, n + ' differs after staging')
+
+    def test_stagein_failure_removes_files(self):
+        """
+        When one pair of a stage-in fails, the files other workers staged
+        in are removed again
+        """
+        host = self.mom.shortname
+        names = self.names + ['stg_missing']
+        sin = ','.join(['%s@%s:%s' % (n, host, os.path.join(self.srcdir, n))
+                        for n in names])
+        j = Job(TEST_USER, {ATTR_stagein: sin})
+        jid = self.server.submit(j)
+        self.mom.log_match('%s;Staged' % jid, max_attempts=30, interval=2)
+        ret = self.du.run_cmd(cmd='ls ~/stg_file_* 2>/dev/null | wc -l',
+                              runas=TEST_USER, as_script=True)
+        self.assertEqual(ret['out'][0].strip(), '0')
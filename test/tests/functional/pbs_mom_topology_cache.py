@@ -0,0 +1,102 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestMomTopologyCache(TestFunctional):
+    """
+    Test that MoM saves the topology it discovers and reuses it across
+    restarts while the hardware is unchanged
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.cache = os.path.join(self.mom.pbs_conf['PBS_HOME'], 'mom_priv',
+                                  'topology.xml')
+
+    def test_topology_reused(self):
+        """
+        A restarted MoM uses the saved topology instead of probing again,
+        and the node keeps its topology_info
+        """
+        self.mom.restart()
+        self.assertTrue(self.mom.du.isfile(self.mom.hostname, self.cache,
+                                           sudo=True))
+        t = time.time()
+        self.mom.restart()
+        self.mom.log_match('using saved topology', starttime=t)
+        self.server.expect(NODE, 'topology_info', op=SET,
+                           id=self.mom.shortname)
+
+    def test_topology_rediscovered(self):
+        """
+        Removing the fingerprint makes MoM probe the hardware again
+        """
+        self.mom.restart()
+        self.mom.du.rm(self.mom.hostname, self.cache + '.fp', sudo=True,
+                       force=True)
+        t = time.time()
+        self.mom.restart()
+        self.mom.log_match('using saved topology', starttime=t,
+                           existence=False, max_attempts=5)
+        self.assertTrue(self.mom.du.isfile(self.mom.hostname,
+                                           self.cache + '.fp', sudo=True))
+
+    def test_get_topology_in_hook(self):
+        """
+        pbs.get_topology() hands execution hooks the saved hwloc XML
+        """
+        hook_body = """
+import pbs
+xml = pbs.get_topology()
+if xml is not None and '<topology' in xml:
+    pbs.logmsg(pbs.LOG_DEBUG, "get_topology returned %d bytes" % len(xml))
+pbs.event().accept()
+"""
+        self.mom.restart()
+        self.server.create_import_hook('topo_hook',
+                                       {'event': 'execjob_begin',
+                                        'enabled': 'True'}, hook_body)
+        j = Job(TEST_USER)
+        j.set_sleep_time(10)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.mom.log_match('get_topology returned [0-9]+ bytes',
+                           regexp=True)
@@ -0,0 +1,88 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestMomUpdateThreshold(TestFunctional):
+    """
+    Test the $resc_used_change and $resc_used_max_interval MoM directives,
+    which hold back periodic resources_used updates of jobs whose usage
+    has hardly changed
+    """
+
+    def get_walltime(self, jid):
+        """
+        Return the resources_used.walltime of a job in seconds
+        """
+        st = self.server.status(JOB, 'resources_used.walltime', id=jid)
+        wt = st[0].get('resources_used.walltime', '00:00:00')
+        h, m, s = [int(x) for x in wt.split(':')]
+        return h * 3600 + m * 60 + s
+
+    def test_idle_job_held_back(self):
+        """
+        An idle job is updated at the max interval rather than every poll
+        """
+        self.mom.add_config({'$min_check_poll': 1, '$max_check_poll': 2,
+                             '$resc_used_change': 50,
+                             '$resc_used_max_interval': 20})
+        j = Job(TEST_USER)
+        j.set_sleep_time(120)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, 'resources_used.walltime', op=SET, id=jid)
+        first = self.get_walltime(jid)
+        time.sleep(8)
+        self.assertLess(self.get_walltime(jid), first + 6)
+        self.server.expect(JOB, {'resources_used.walltime':
+                                 (GE, '00:00:20')}, id=jid, offset=15)
+
+    def test_every_poll_default(self):
+        """
+        Without $resc_used_change every poll updates the job
+        """
+        self.mom.add_config({'$min_check_poll': 1, '$max_check_poll': 2})
+        j = Job(TEST_USER)
+        j.set_sleep_time(60)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, {'resources_used.walltime':
+                                 (GT, '00:00:06')}, id=jid, offset=8)
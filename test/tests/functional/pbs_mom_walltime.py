@@ -205,3 +205,23 @@ class TestMomWalltime(TestFunctional):
                                    op=LT, id=jid, max_attempts=5, interval=5))
         except PtlExpectError:
             pass
+
+    def test_walltime_limit_enforced_on_time(self):
+        """
+        Test that a job is killed when its walltime runs out even if
+        MoM polls its usage much less often
+        """
+        self.mom.add_config({'$min_check_poll': 60, '$max_check_poll': 120})
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        a = {'Resource_List.walltime': 10}
+        J1 = Job(TEST_USER, attrs=a)
+        J1.set_sleep_time(100)
+        jid1 = self.server.submit(J1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {ATTR_state: 'F'}, id=jid1, extend='x',
+                           offset=10, max_attempts=15, interval=1)
+        self.mom.log_match("walltime 1[01] exceeded limit 10", regexp=True,
+                           starttime=self.server.ctime)
+        self.server.expect(JOB, {'resources_used.walltime': 15}, op=LE,
+                           id=jid1, extend='x')
@@ -648,6 +648,39 @@ class TestMultipleSchedulers(TestFunctional):
         self.server.runjob(jid1)
         self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
 
+    def test_partitions_cycle_independently(self):
+        """
+        Test a scheduler stuck in its cycle does not hold up the cycles
+        and qruns of the schedulers of other partitions
+        """
+        self.common_setup()
+        start = time.time()
+        self.scheds['sc1'].signal('-STOP')
+        try:
+            j = Job(TEST_USER1, attrs={ATTR_queue: 'wq1',
+                                       'Resource_List.select': '1:ncpus=1'})
+            jid1 = self.server.submit(j)
+            j = Job(TEST_USER1, attrs={ATTR_queue: 'wq2',
+                                       'Resource_List.select': '1:ncpus=1'})
+            jid2 = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+            self.server.manager(MGR_CMD_SET, SCHED,
+                                {'scheduling': 'False'}, id="sc2")
+            j = Job(TEST_USER1, attrs={ATTR_queue: 'wq2',
+                                       'Resource_List.select': '1:ncpus=1'})
+            jid3 = self.server.submit(j)
+            self.server.runjob(jid3)
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid3)
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid1)
+        finally:
+            self.scheds['sc1'].signal('-CONT')
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        # every scheduler was sent the vnodes of its own partition only
+        vnode1 = self.mom.shortname + '[1]'
+        self.scheds['sc1'].log_match(vnode1, existence=False,
+                                     starttime=start,
+                                     max_attempts=1)
+
     def test_run_limts_per_scheduler(self):
         """
         Test run_limits applied at server level is
@@ -0,0 +1,80 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestNodeFailRequeue(TestFunctional):
+    """
+    Test the handling of the jobs of a Mom which goes down
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 20}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'node_fail_requeue': 5})
+
+    def test_requeue_all_jobs_of_mom(self):
+        """
+        Test that when a Mom with many jobs goes down, each rerunnable job
+        is requeued once and each non-rerunnable job is deleted
+        """
+        rerun = []
+        norerun = []
+        for i in range(20):
+            j = Job(TEST_USER, attrs={ATTR_r: 'y' if i % 2 else 'n'})
+            j.set_sleep_time(1000)
+            jid = self.server.submit(j)
+            (rerun if i % 2 else norerun).append(jid)
+        self.server.expect(JOB, {'job_state=R': 20}, count=True)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        t = time.time()
+        self.mom.stop()
+        self.server.expect(NODE, {'state': (MATCH_RE, 'down')},
+                           id=self.mom.shortname)
+        for jid in rerun:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid, offset=5)
+            self.server.log_match(jid + ';Job requeued, execution node',
+                                  starttime=t, n='ALL', max_attempts=1)
+        for jid in norerun:
+            self.server.expect(JOB, 'queue', op=UNSET, id=jid)
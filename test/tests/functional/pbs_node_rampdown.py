@@ -6955,3 +6955,33 @@ pbs.logjobmsg(pbs.event().job.id, "execjob_end hook executed")
         # Verify the rest of the job is still running
         self.server.expect(JOB, {'job_state': 'R'},
                            id=jid)
+
+    def test_release_nodes_back_to_back(self):
+        """
+        Test:
+            Release nodes of a job with several pbs_release_nodes
+            calls made at once, so that later releases are made while
+            the update of an earlier one is still out to the primary
+            mom.  All the calls succeed and the job is left with the
+            vnodes none of them released.
+        """
+        jid = self.create_and_submit_job('job1_5')
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': self.job1_exec_vnode}, id=jid)
+
+        cmd = ""
+        for n in [self.n5, self.n6, self.n7]:
+            cmd += "%s -j %s %s &\n" % (self.pbs_release_nodes_cmd, jid, n)
+        cmd += "rc=0\nfor p in $(jobs -p); do wait $p || rc=1; done\n"
+        cmd += "exit $rc\n"
+        ret = self.server.du.run_cmd(self.server.hostname, cmd,
+                                     sudo=True, as_script=True)
+        self.assertEqual(ret['rc'], 0)
+
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'Resource_List.nodect': 2}, id=jid)
+        job = self.server.status(JOB, 'exec_vnode', id=jid)[0]
+        for n in [self.n5, self.n6, self.n7]:
+            self.assertNotIn(n + ':', job['exec_vnode'])
+        for n in [self.n1, self.n2, self.n3, self.n4]:
+            self.assertIn(n + ':', job['exec_vnode'])
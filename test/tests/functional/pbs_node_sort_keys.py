@@ -0,0 +1,77 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestNodeSortKeys(TestFunctional):
+
+    """
+    Tests for sorting vnodes on several node_sort_keys
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, 4)
+        self.vn = [self.mom.shortname + '[%d]' % i for i in range(4)]
+
+    def test_multi_key_sort(self):
+        """
+        Sort on a priority key and break its ties with a second key.
+        Vnodes equal on both keys keep their order, so the jobs fill the
+        vnodes in the expected order.
+        """
+        prio = [10, 50, 50, 50]
+        mem = ['4gb', '2gb', '8gb', '2gb']
+        for i, vn in enumerate(self.vn):
+            a = {'priority': prio[i], 'resources_available.mem': mem[i]}
+            self.server.manager(MGR_CMD_SET, NODE, a, id=vn)
+        a = {'node_sort_key': ['"sort_priority HIGH" ALL',
+                               '"mem LOW" ALL']}
+        self.scheduler.set_sched_config(a)
+
+        expected = [self.vn[1], self.vn[3], self.vn[2], self.vn[0]]
+        for vn in expected:
+            j = Job(TEST_USER, {'Resource_List.select': '1:ncpus=1'})
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+            self.server.expect(JOB, {'exec_vnode': '(%s:ncpus=1)' % vn},
+                               id=jid)
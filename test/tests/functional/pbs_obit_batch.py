@@ -0,0 +1,87 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestObitBatch(TestFunctional):
+    """
+    Jobs that end together have their obits, accounting records and
+    node releases handled in one pass of the server
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 8}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+    def test_many_jobs_end(self):
+        """
+        Every job that ends together gets its E record and
+        the vnode is left free
+        """
+        jids = []
+        for _ in range(8):
+            j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+            j.set_sleep_time(2)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, 'queue', id=jid, op=UNSET,
+                               offset=2, max_attempts=60)
+        for jid in jids:
+            self.server.accounting_match(';E;%s;' % jid, id=jid)
+        self.server.expect(NODE, {'state': 'free',
+                                  'resources_assigned.ncpus': 0},
+                           id=self.mom.shortname)
+
+    def test_acct_records_in_order(self):
+        """
+        Records held for a pass of the server are written in order
+        """
+        j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', id=jid, op=UNSET,
+                           offset=1, max_attempts=60)
+        q = self.server.accounting_match(';Q;%s;' % jid, id=jid, n='ALL',
+                                         tail=False)
+        e = self.server.accounting_match(';E;%s;' % jid, id=jid, n='ALL',
+                                         tail=False)
+        self.assertTrue(q and e)
+        self.assertLess(q[0], e[0])
@@ -77,3 +77,41 @@ class Test_explicit_psets(TestFunctional):
         c = "Can Never Run: can't fit in the largest placement set,\
  and can't span psets"
         self.server.expect(JOB, {'comment': c}, id=jid)
+
+    def test_calendar_uses_pset_freed_by_ending_job(self):
+        """
+        Test that when a running job ends in the calendar, the placement
+        set it ran in is updated and the top job is estimated to run there
+        """
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, 4, sharednode=False)
+        vn = [self.mom.shortname + '[%d]' % i for i in range(4)]
+        for i, v in enumerate(vn):
+            self.server.manager(MGR_CMD_SET, NODE,
+                                {'resources_available.foo': 'AB'[i // 2]},
+                                id=v)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'node_group_key': 'foo',
+                             'node_group_enable': 'True'})
+        self.scheduler.set_sched_config({'strict_ordering': 'True'})
+
+        a = {'Resource_List.select': '2:ncpus=1',
+             'Resource_List.walltime': 1000}
+        j1 = Job(TEST_USER, attrs=a)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        a['Resource_List.walltime'] = 100
+        j2 = Job(TEST_USER, attrs=a)
+        jid2 = self.server.submit(j2)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        s = self.server.status(JOB, 'exec_vnode', id=jid2)
+        short_nodes = j2.get_vnodes(s[0]['exec_vnode'])
+
+        a['Resource_List.walltime'] = 1000
+        j3 = Job(TEST_USER, attrs=a)
+        jid3 = self.server.submit(j3)
+        self.server.expect(JOB, 'estimated.exec_vnode', op=SET, id=jid3)
+        s = self.server.status(JOB, 'estimated.exec_vnode', id=jid3)
+        est_nodes = j3.get_vnodes(s[0]['estimated.exec_vnode'])
+        self.assertEqual(sorted(est_nodes), sorted(short_nodes))
@@ -247,3 +247,36 @@ class TestPbsnodes(TestFunctional):
                                      attr_dict['resources_available.ncpus'],
                                      attr_dict['pcpus'], attr_dict['sharing'],
                                      attr_dict['resources_available.mem'])
+
+    def test_pbsnodes_totals(self):
+        """
+        This verifies that 'pbsnodes -t' and 'pbsnodes -T' report the
+        vnode count, state counts and summed resources computed by the
+        server, overall and for each host
+        """
+        attrs = {ATTR_rescavail + '.ncpus': 2}
+        self.mom.create_vnodes(attrs, 3, usenatvnode=False)
+        vn = self.mom.shortname + '[0]'
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'}, id=vn)
+        j = Job(TEST_USER, attrs={'Resource_List.select': '1:ncpus=1'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        out = self.du.run_cmd(self.svrname, cmd=self.pbsnodes + ['-t'])
+        self.assertEqual(out['rc'], 0)
+        totals = {}
+        for line in out['out']:
+            if '=' in line:
+                name, val = line.split('=', 1)
+                totals[name.strip()] = val.strip()
+        nodes = self.server.status(NODE)
+        ncpus = sum([int(n.get(ATTR_rescavail + '.ncpus', 0)) for n in nodes])
+        self.assertEqual(out['out'][0], 'total')
+        self.assertEqual(totals['vnodes'], str(len(nodes)))
+        self.assertEqual(totals['state_count.offline'], '1')
+        self.assertEqual(totals['resources_available.ncpus'], str(ncpus))
+        self.assertEqual(totals['resources_assigned.ncpus'], '1')
+
+        out = self.du.run_cmd(self.svrname, cmd=self.pbsnodes + ['-T'])
+        self.assertEqual(out['rc'], 0)
+        self.assertIn(self.mom.shortname, out['out'])
@@ -308,6 +308,34 @@ exit 1
         self.server.expect(JOB, {'job_state=S': 10})
         self.server.expect(JOB, {'job_state': 'R'}, id=hjid)
 
+    def test_preempt_multiple_jobs_requeue(self):
+        """
+        Test that jobs spread over several vnodes are all requeued in one
+        preemption request and the high priority job runs
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'preempt_order': 'R'})
+        a = {'resources_available.ncpus': 4}
+        self.mom.create_vnodes(a, num=3)
+
+        jids = []
+        for _ in range(12):
+            a = {'Resource_List.select': '1:ncpus=1',
+                 'Resource_List.walltime': 40}
+            j = Job(TEST_USER, a)
+            jids.append(self.server.submit(j))
+
+        self.server.expect(JOB, {'job_state=R': 12})
+        a = {'Resource_List.select': '3:ncpus=4',
+             'Resource_List.walltime': 40,
+             'queue': 'expressq'}
+        hj = Job(TEST_USER, a)
+        hjid = self.server.submit(hj)
+
+        self.server.expect(JOB, {'job_state': 'R'}, id=hjid)
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+            self.scheduler.log_match(jid + ";Job preempted by requeuing")
+
     def test_qalter_preempt_targets_to_none(self):
         """
         Test that a job requesting preempt targets set to two different queues
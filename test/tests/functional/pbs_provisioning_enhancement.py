@@ -479,3 +479,38 @@ e.reject()
         time.sleep(8)
         # delete all nodes
         self.server.manager(MGR_CMD_DELETE, NODE, None, "")
+
+    def test_multinode_app_provisioning_starts_job_once(self):
+        """
+        Test that a job provisioning several vnodes is started once, after
+        the last of them is done, and that a later job asking for the same
+        aoe runs on them without provisioning again
+        """
+        a = {'resources_available.aoe': 'App1,osimage1',
+             'provision_enable': 'True',
+             'resources_available.ncpus': 1}
+        rv = self.momA.create_vnodes(a, 4, sharednode=False)
+        self.assertTrue(rv)
+        vnodes = [self.momA.shortname + '[%d]' % i for i in range(4)]
+
+        j = Job(TEST_USER,
+                attrs={'Resource_List.select': '4:ncpus=1:aoe=App1'})
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        for vn in vnodes:
+            self.server.expect(NODE, {'current_aoe': 'App1'}, id=vn)
+
+        msg = "Provisioning for Job %s succeeded, running job" % jid
+        logs = self.server.log_match(msg, allmatch=True)
+        self.assertEqual(len(logs), 1)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=5)
+
+        start = time.time()
+        j2 = Job(TEST_USER,
+                 attrs={'Resource_List.select': '4:ncpus=1:aoe=App1'})
+        jid2 = self.server.submit(j2)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.server.log_match("Provisioning vnode .* with AOE App1 started",
+                              regexp=True, starttime=start,
+                              existence=False, max_attempts=5)
@@ -0,0 +1,91 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestPwdCache(TestFunctional):
+    """
+    Test the cache of user and group entries kept by the server and MoM
+    """
+
+    def submit_jobs(self, num, attrs=None):
+        jids = []
+        for _ in range(num):
+            j = Job(TEST_USER1, attrs=attrs)
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F', 'Exit_status': 0},
+                               extend='x', id=jid, offset=1,
+                               max_attempts=60)
+        return jids
+
+    def test_jobs_with_cached_entries(self):
+        """
+        Repeated jobs of the same user and secondary group are accepted
+        by a group ACL and run while the entries come from the cache
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_history_enable': True})
+        a = {'queue_type': 'execution', 'started': 't', 'enabled': 't',
+             'acl_group_enable': 't', 'acl_groups': TSTGRP1}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='workq2')
+        self.submit_jobs(5, {'queue': 'workq2'})
+
+    def test_cache_disabled(self):
+        """
+        With $pwd_cache_ttl 0 MoM looks up every entry and still runs jobs
+        """
+        self.mom.add_config({'$pwd_cache_ttl': 0})
+        self.mom.log_match('pwd_cache_ttl;0')
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_history_enable': True})
+        self.submit_jobs(3)
+
+    def test_bad_ttl_rejected(self):
+        """
+        A negative $pwd_cache_ttl is refused, the previous ttl is kept
+        and jobs keep running
+        """
+        self.mom.add_config({'$pwd_cache_ttl': 30})
+        self.mom.log_match('pwd_cache_ttl;30')
+        self.mom.add_config({'$pwd_cache_ttl': -5})
+        self.mom.log_match('Bad value -5, pwd_cache_ttl stays 30')
+        self.assertTrue(self.mom.isUp())
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_history_enable': True})
+        self.submit_jobs(1)
@@ -429,3 +429,31 @@ pbs.event().accept()
         msg = "Restarting Python interpreter to reduce mem usage"
         self.server.log_match(msg, starttime=stime, max_attempts=8,
                               existence=False)
+
+    def test_restart_warms_hook_modules(self):
+        """
+        Test that modules imported by hooks are imported again right
+        after the interpreter is restarted
+        """
+        hook_body = """
+import pbs
+import colorsys
+pbs.event().accept()
+"""
+        a = {'event': "queuejob", 'enabled': "True"}
+        self.server.create_import_hook("test", a, hook_body, overwrite=True)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {"log_events": 2047,
+                             'python_restart_max_hooks': 1,
+                             'python_restart_min_interval': 1},
+                            runas=ROOT_USER)
+        stime = time.time()
+        for x in range(3):
+            self.server.submit(Job())
+            time.sleep(2)
+        self.server.log_match(
+            "Restarting Python interpreter to reduce mem usage",
+            starttime=stime)
+        self.server.log_match(
+            r"Imported [1-9][0-9]* of [1-9][0-9]* modules used by hooks",
+            regexp=True, starttime=stime)
@@ -0,0 +1,92 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestQdelJobList(TestFunctional):
+    """
+    A qdel of a long job list is done in slices, the server keeps
+    serving other requests in between
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+    def test_qdel_many_queued(self):
+        """
+        Every job of a long qdel list is deleted and one reply
+        comes back for all of them
+        """
+        jids = []
+        for _ in range(2000):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+        self.server.delete(jids, wait=True)
+        self.server.expect(SERVER, {'total_jobs': 0})
+
+    def test_qdel_list_with_unknown(self):
+        """
+        An unknown job in the list is reported, the others
+        are deleted
+        """
+        jids = []
+        for _ in range(100):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+        bad = '999999.' + self.server.hostname
+        try:
+            self.server.delete(jids + [bad])
+        except PbsDeleteError as e:
+            self.assertIn('Unknown Job Id', e.msg[0])
+        self.server.expect(SERVER, {'total_jobs': 0})
+
+    def test_requests_served_during_delete(self):
+        """
+        A qstat issued while a long list is deleted is answered
+        """
+        jids = []
+        for _ in range(2000):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+        self.server.delete(jids, runas=TEST_USER, wait=False)
+        self.server.status(SERVER)
+        self.server.expect(SERVER, {'total_jobs': 0}, max_attempts=120)
@@ -417,3 +417,50 @@ class TestQmgr(TestFunctional):
                     if rv:
                         self.delete_resource_helper(None, resc_flag,
                                                     ctrl_flag, k, v)
+
+    def test_bulk_node_set(self):
+        """
+        Check that set and unset node take a list of vnodes or a
+        @[attribute=value] selector in one qmgr command, and that an
+        unknown vnode in a list does not stop the others from being set
+        """
+        qmgr_path = os.path.join(self.server.pbs_conf["PBS_EXEC"], "bin",
+                                 "qmgr")
+        if not os.path.isfile(qmgr_path):
+            self.server.skipTest("qmgr binary not found!")
+
+        attr = {'type': 'string', 'flag': 'h'}
+        self.server.manager(MGR_CMD_CREATE, RSC, attr, id='color')
+        attrs = {ATTR_rescavail + ".ncpus": 1}
+        self.mom.create_vnodes(attrs, 4, vname='vn')
+        vn = ['vn[%d]' % i for i in range(4)]
+
+        def qmgr(cmd):
+            if self.du.is_localhost(self.server.hostname) is True:
+                qmgr_cmd = [qmgr_path, "-c", cmd]
+            else:
+                qmgr_cmd = [qmgr_path, "-c", "\'" + cmd + "\'"]
+            return self.du.run_cmd(self.server.hostname, qmgr_cmd)
+
+        ret = qmgr("set node %s,%s resources_available.color=blue" %
+                   (vn[2], vn[3]))
+        self.assertEqual(ret['rc'], 0)
+        ret = qmgr("set node @[resources_available.color=blue] comment=sel")
+        self.assertEqual(ret['rc'], 0)
+        for n in vn[2:]:
+            self.server.expect(VNODE, {ATTR_comment: 'sel'}, id=n)
+        for n in vn[:2]:
+            self.server.expect(VNODE, ATTR_comment, op=UNSET, id=n)
+
+        ret = qmgr("unset node @[comment=sel] comment")
+        self.assertEqual(ret['rc'], 0)
+        for n in vn[2:]:
+            self.server.expect(VNODE, ATTR_comment, op=UNSET, id=n)
+
+        ret = qmgr("set node %s,nosuchnode,%s comment=list" % (vn[0], vn[1]))
+        self.assertNotEqual(ret['rc'], 0)
+        for n in vn[:2]:
+            self.server.expect(VNODE, {ATTR_comment: 'list'}, id=n)
+
+        ret = qmgr("set node @[resources_available.color=red] comment=x")
+        self.assertNotEqual(ret['rc'], 0)
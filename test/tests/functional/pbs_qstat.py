@@ -155,3 +155,110 @@ class TestQstat(TestFunctional):
                                       % re.escape(self.mom.shortname),
                                       qstat_out), None, "The exec host does"
                             " not contain the task slot number")
+
+    def test_qstat_binary_dis(self):
+        """
+        Enable PBS_DIS_BINARY on the server host so that the commands and
+        the server negotiate binary DIS integers, and verify that qsub,
+        qstat -f and qselect still work over such connections
+        """
+        conf = {'PBS_DIS_BINARY': '1'}
+        self.du.set_pbs_config(self.server.hostname, confs=conf)
+        self.server.restart()
+        try:
+            j = Job(TEST_USER, attrs={'Resource_List.walltime': 3600,
+                                      'Resource_List.ncpus': 1})
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'R',
+                                     'Resource_List.walltime': '01:00:00'},
+                               id=jid)
+            qselect_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                       'bin', 'qselect')
+            ret = self.du.run_cmd(self.server.hostname,
+                                  cmd=[qselect_cmd, '-s', 'R'])
+            self.assertEqual(ret['rc'], 0)
+            self.assertIn(jid, '\n'.join(ret['out']))
+        finally:
+            self.du.unset_pbs_config(self.server.hostname,
+                                     confs=list(conf.keys()))
+            self.server.restart()
+
+    def test_qstat_large_reply(self):
+        """
+        Submit enough jobs with long attribute values that a full status
+        reply spans several DIS packets, and verify qstat -f still
+        reports every job and value intact
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        value = 'v' * 4000
+        jids = []
+        for i in range(50):
+            j = Job(TEST_USER, attrs={ATTR_v: 'LONG_VAR=%s%d' % (value, i)})
+            jids.append(self.server.submit(j))
+        jobs = self.server.status(JOB)
+        self.assertEqual(len(jobs), len(jids))
+        for i, jid in enumerate(jids):
+            pat = 'LONG_VAR=%s%d(,|$)' % (value, i)
+            self.server.expect(JOB, {ATTR_v: (MATCH_RE, pat)}, id=jid,
+                               max_attempts=1)
+
+    def test_qstat_auth_session(self):
+        """
+        Enable PBS_AUTH_SESSIONS on the server host and verify that a
+        second qstat from the same user resumes the session issued to the
+        first one instead of authenticating again
+        """
+        conf = {'PBS_AUTH_SESSIONS': '1'}
+        self.du.set_pbs_config(self.server.hostname, confs=conf)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        try:
+            qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                     'bin', 'qstat')
+            start = time.time()
+            for _ in range(2):
+                ret = self.du.run_cmd(self.server.hostname,
+                                      cmd=[qstat_cmd, '-B'],
+                                      runas=TEST_USER)
+                self.assertEqual(ret['rc'], 0)
+            self.server.log_match("session resumed for %s@" % TEST_USER,
+                                  starttime=int(start))
+        finally:
+            self.du.unset_pbs_config(self.server.hostname,
+                                     confs=list(conf.keys()))
+            self.server.restart()
+
+    def test_qstat_auth_session_revoked(self):
+        """
+        Setting auth_session_lifetime revokes the sessions issued so far,
+        and a lifetime of zero stops sessions from being resumed
+        """
+        conf = {'PBS_AUTH_SESSIONS': '1'}
+        self.du.set_pbs_config(self.server.hostname, confs=conf)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                 'bin', 'qstat')
+
+        def qstat():
+            ret = self.du.run_cmd(self.server.hostname,
+                                  cmd=[qstat_cmd, '-B'], runas=TEST_USER)
+            self.assertEqual(ret['rc'], 0)
+
+        try:
+            qstat()
+            self.server.manager(MGR_CMD_SET, SERVER,
+                                {'auth_session_lifetime': 0})
+            self.server.log_match("authenticated sessions revoked")
+            start = time.time()
+            qstat()
+            qstat()
+            self.server.log_match("session resumed for %s@" % TEST_USER,
+                                  starttime=int(start), existence=False,
+                                  max_attempts=5)
+        finally:
+            self.server.manager(MGR_CMD_UNSET, SERVER,
+                                'auth_session_lifetime')
+            self.du.unset_pbs_config(self.server.hostname,
+                                     confs=list(conf.keys()))
+            self.server.restart()
@@ -279,3 +279,46 @@ class TestqstatStateCount(TestFunctional):
         # Restart server
         self.server.restart()
         self.verify_count()
+
+    def test_state_count_hook_deletejob(self):
+        """
+        A job deleted by an execjob_begin hook goes from running back
+        to queued and is aborted without svr_setjobstate, check the
+        state counts stay exact
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+e.job.delete()
+e.accept()
+"""
+        self.server.create_import_hook('begin_del', {'event': 'execjob_begin'},
+                                       hook_body)
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid)
+        self.server.manager(MGR_CMD_DELETE, HOOK, id='begin_del')
+        for _ in range(3):
+            self.server.submit(Job(TEST_USER))
+        self.verify_count()
+
+    def test_state_count_history_queue_delete(self):
+        """
+        Delete a queue holding only finished jobs, check the server
+        state counts are not thrown off by the history jobs left behind
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_history_enable': 'True'})
+        a = {'queue_type': 'Execution', 'enabled': 'True',
+             'started': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, 'workq2')
+        jids = []
+        for _ in range(2):
+            j = Job(TEST_USER, {ATTR_queue: 'workq2'})
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x')
+        self.server.manager(MGR_CMD_DELETE, QUEUE, id='workq2')
+        self.server.submit(Job(TEST_USER))
+        counts = self.find_state_counts()
+        self.assertEqual(counts['Queued'] + counts['Running'], 1,
+                         'Job count incorrect')
@@ -759,3 +759,31 @@ class TestQstatFormats(TestFunctional):
         except ValueError:
             self.logger.info(qstat_out)
             self.assertFalse(True, "Json failed to load")
+
+    def test_json_dsv_many_jobs(self):
+        """
+        Check qstat -f -F json and -F dsv report every job when the job
+        status reply comes in several parts and is written out as it is
+        read
+        """
+        num = 1100
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {ATTR_J: '0-%d' % (num - 1)}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                                 'qstat')
+        ret = self.du.run_cmd(self.server.hostname,
+                              cmd=qstat_cmd + ' -f -t -F json')
+        qstat_out = "\n".join(ret['out'])
+        try:
+            json_data = json.loads(qstat_out)
+        except ValueError:
+            self.assertFalse(True, "Json failed to load")
+        self.assertEqual(len(json_data['Jobs']), num + 1)
+        self.assertIn(jid, json_data['Jobs'])
+        ret = self.du.run_cmd(self.server.hostname,
+                              cmd=qstat_cmd + ' -f -t -F dsv')
+        ids = [l.split('|')[0] for l in ret['out'] if l]
+        self.assertEqual(len(ids), num + 1)
+        self.assertEqual(len(set(ids)), num + 1)
@@ -0,0 +1,87 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestRescLookup(TestFunctional):
+    """
+    Test the resource matching done when defaults, limits and
+    resources_assigned are applied to jobs, for built-in and custom
+    resources
+    """
+
+    def test_deflt_limit_assigned(self):
+        """
+        Give a queue defaults and limits on built-in and custom
+        resources, then check jobs get the defaults, are held to the
+        limits and are counted in resources_assigned
+        """
+        for r in ('foo', 'bar'):
+            self.server.manager(MGR_CMD_CREATE, RSC,
+                                {'type': 'long', 'flag': 'q'}, id=r)
+        a = {'resources_default.foo': 2, 'resources_default.mem': '10mb',
+             'resources_max.bar': 5}
+        self.server.manager(MGR_CMD_SET, QUEUE, a, id='workq')
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'resources_available.foo': 100})
+
+        j = Job(TEST_USER, {'Resource_List.bar': 6})
+        try:
+            self.server.submit(j)
+        except PbsSubmitError as e:
+            self.assertIn('Job exceeds queue resource limits', e.msg[0])
+        else:
+            self.fail('job over resources_max.bar was accepted')
+
+        j = Job(TEST_USER, {'Resource_List.bar': 3})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'Resource_List.foo': 2,
+                                 'Resource_List.mem': '10mb',
+                                 'Resource_List.bar': 3}, id=jid)
+        self.server.expect(QUEUE, {'resources_assigned.foo': 2,
+                                   'resources_assigned.bar': 3},
+                           id='workq')
+        self.server.expect(SERVER, {'resources_assigned.foo': 2})
+        self.server.delete(jid, wait=True)
+        self.server.expect(QUEUE, {'resources_assigned.foo': 0,
+                                   'resources_assigned.bar': 0},
+                           id='workq')
@@ -285,6 +285,42 @@ class TestReservations(TestFunctional):
         self.degraded_resv_reconfirm(start=25, end=625,
                                      rrule='freq=HOURLY;count=5')
 
+    def test_degraded_only_affected_standing_reservation(self):
+        """
+        Verify that a vnode going offline degrades only the standing
+        reservations with it in an occurrence, also after a reservation
+        was deleted
+        """
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, num=3)
+
+        now = int(time.time())
+        rids = []
+        for _ in range(2):
+            rid = self.submit_reservation(user=TEST_USER, select='1:ncpus=1',
+                                          rrule='freq=HOURLY;count=5',
+                                          start=now + 3600,
+                                          end=now + 3900)
+            a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+            self.server.expect(RESV, a, id=rid)
+            rids.append(rid)
+
+        self.server.status(RESV, 'resv_nodes')
+        nodes = [self.server.reservations[r].get_vnodes()[0] for r in rids]
+        self.assertNotEqual(nodes[0], nodes[1])
+
+        degraded = {'reserve_state': (MATCH_RE, 'RESV_DEGRADED|10')}
+        confirmed = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=nodes[0])
+        self.server.expect(RESV, degraded, id=rids[0])
+        self.server.expect(RESV, confirmed, id=rids[1])
+
+        self.server.delete(rids[0])
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=nodes[1])
+        self.server.expect(RESV, degraded, id=rids[1])
+
     def test_degraded_advance_reservations(self):
         """
         Verify that degraded advance reservations are reconfirmed
@@ -501,6 +537,39 @@ class TestReservations(TestFunctional):
         a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
         self.server.expect(RESV, a, id=rid2, offset=end - int(time.time()))
 
+    def test_standing_resv_many_occurrences(self):
+        """
+        Test that a standing reservation with many occurrences moves on
+        to the execvnode of its next occurrence when one finishes, and
+        is degraded when a vnode of a later occurrence goes offline
+        """
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, num=2)
+
+        now = int(time.time())
+        start = now + 20
+        end = now + 40
+        rid = self.submit_reservation(user=TEST_USER, select='1:ncpus=1',
+                                      start=start, end=end,
+                                      rrule='freq=HOURLY;count=200')
+        a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.expect(RESV, a, id=rid)
+
+        a = {'reserve_state': (MATCH_RE, 'RESV_RUNNING|5'),
+             'reserve_index': 1}
+        self.server.expect(RESV, a, id=rid, offset=start - int(time.time()))
+
+        a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2'),
+             'reserve_index': 2}
+        self.server.expect(RESV, a, id=rid, offset=end - int(time.time()))
+
+        self.server.status(RESV, 'resv_nodes', id=rid)
+        resv_node = self.server.reservations[rid].get_vnodes()[0]
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            resv_node)
+        a = {'reserve_state': (MATCH_RE, 'RESV_DEGRADED|10')}
+        self.server.expect(RESV, a, id=rid)
+
     def test_degraded_reservation_reconfirm_running_job(self):
         """
         Test that a reservation isn't reconfirmed if there is a running job
@@ -0,0 +1,90 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSaveAttrs(TestFunctional):
+    """
+    Test that job, reservation and node attributes saved to the database
+    come back after a server restart
+    """
+
+    def test_attrs_after_restart(self):
+        """
+        Set string, long, size and resource attributes on jobs and a
+        node, restart the server and check all of them are recovered
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for i in range(20):
+            a = {ATTR_N: 'name%d' % i, ATTR_p: i,
+                 'Resource_List.mem': '%dmb' % (i + 1),
+                 ATTR_v: 'A=%d,B=x' % i}
+            jids.append(self.server.submit(Job(TEST_USER, a)))
+        self.server.alterjob(jids[0], {ATTR_N: 'altered'})
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'saved'},
+                            id=self.mom.shortname)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'altered'}, id=jids[0])
+        for i in range(1, 20):
+            a = {ATTR_N: 'name%d' % i, ATTR_p: i,
+                 'Resource_List.mem': '%dmb' % (i + 1)}
+            self.server.expect(JOB, a, id=jids[i])
+        self.server.expect(NODE, {'comment': 'saved'},
+                           id=self.mom.shortname)
+
+    def test_nosave_attrs_not_recovered(self):
+        """
+        Alter the scheduler estimates and comment of a job, check they
+        are shown while the server runs and are not recovered from the
+        database after a restart, unlike an attribute that is saved
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.alterjob(jid, {ATTR_N: 'saved'})
+        a = {'estimated.start_time': '2000000000',
+             ATTR_comment: 'not saved'}
+        self.server.alterjob(jid, a, runas=ROOT_USER)
+        self.server.expect(JOB, {ATTR_comment: 'not saved'}, id=jid)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid)
+        self.server.restart()
+        self.server.expect(JOB, {ATTR_N: 'saved'}, id=jid)
+        self.server.expect(JOB, 'estimated.start_time', op=UNSET, id=jid)
+        self.server.expect(JOB, ATTR_comment, op=UNSET, id=jid)
@@ -80,7 +80,7 @@ class TestSchedAttrUpdates(TestFunctional):
         # Verify that scheduler didn't send attr updates for new jobs
         self.server.expect(JOB, "comment", op=UNSET, id=jid5)
         self.server.expect(JOB, "comment", op=UNSET, id=jid6)
-        self.server.log_match("Type 96 request received", existence=False,
+        self.server.log_match("Type 101 request received", existence=False,
                               starttime=t, max_attempts=5)
 
         self.logger.info("Sleep for 45s for the attr_update_period to pass")
@@ -94,7 +94,7 @@ class TestSchedAttrUpdates(TestFunctional):
         # Verify that scheduler sent attr updates for all new jobs
         self.server.expect(JOB, "comment", op=SET, id=jid7)
         self.server.expect(JOB, "comment", op=SET, id=jid8)
-        self.server.log_match("Type 96 request received", starttime=t)
+        self.server.log_match("Type 101 request received", starttime=t)
 
     def test_accrue_type(self):
         """
@@ -138,3 +138,31 @@ class TestSchedAttrUpdates(TestFunctional):
         self.server.expect(JOB, "comment", op=SET, id=jid3, max_attempts=1)
         self.server.expect(JOB, {"accrue_type": "1"}, id=jid3, max_attempts=1)
         self.server.expect(JOB, {"accrue_type": "1"}, id=jid2, max_attempts=1)
+
+    def test_batched_updates(self):
+        """
+        Test that the updates for all jobs of a cycle reach the server
+        in one Modify Job List request
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {"resources_available.ncpus": 1},
+                            id=self.mom.shortname)
+        a = {"scheduling": "False"}
+        self.server.manager(MGR_CMD_SET, SCHED, a, id="default")
+
+        j = Job()
+        j.set_sleep_time(1000)
+        jid1 = self.server.submit(j)
+        jids = []
+        for _ in range(5):
+            jids.append(self.server.submit(Job()))
+
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {"job_state": "R"}, id=jid1)
+        for jid in jids:
+            self.server.expect(JOB, "comment", op=SET, id=jid)
+        # one list request, not one Modify Job request per job
+        self.server.log_match("Type 101 request received", starttime=t)
+        self.server.log_match("Type 96 request received", starttime=t,
+                              existence=False, max_attempts=2)
@@ -0,0 +1,164 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import json
+import socket
+import struct
+
+from tests.functional import *
+
+
+class TestSchedCycleProfile(TestFunctional):
+    """
+    Test the scheduler's cycle phase timers
+    """
+
+    def test_profile_attribute(self):
+        """
+        Test that the sched object's sched_cycle_profile attribute is
+        set with the times of the phases the scheduler went through
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        jid = self.server.submit(Job())
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        self.server.expect(SCHED, 'sched_cycle_profile', op=SET,
+                           id='default')
+        s = self.server.status(SCHED, 'sched_cycle_profile', id='default')
+        prof = s[0]['sched_cycle_profile']
+        phases = {}
+        for p in prof.split(','):
+            name, secs, count, hist = p.split(':')
+            phases[name] = (float(secs), int(count),
+                            [int(h) for h in hist.split('/')])
+        for name in ['cycle', 'query', 'eval', 'send_run_job']:
+            self.assertIn(name, phases)
+            self.assertGreaterEqual(phases[name][1], 1)
+            self.assertEqual(sum(phases[name][2]), phases[name][1])
+
+    def test_profile_file(self):
+        """
+        Test that the cycle_profile_file sched_config option dumps each
+        cycle's phase times as a line of JSON
+        """
+        fname = 'cycle_profile.json'
+        self.scheduler.set_sched_config({'cycle_profile_file': fname})
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        self.server.submit(Job())
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match('Cycle phase times:')
+
+        path = os.path.join(self.server.pbs_conf['PBS_HOME'], 'sched_priv',
+                            fname)
+        ret = self.du.cat(self.scheduler.hostname, path, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        line = json.loads(ret['out'][-1])
+        self.assertIn('phases', line)
+        self.assertGreaterEqual(line['phases']['cycle']['count'], 1)
+        self.du.rm(self.scheduler.hostname, path, sudo=True, force=True)
+
+    def test_capture_file(self):
+        """
+        Test that the cycle_capture_file sched_config option writes the
+        server replies of the last cycle
+        """
+        fname = 'cycle_capture'
+        self.scheduler.set_sched_config({'cycle_capture_file': fname})
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        jid = self.server.submit(Job())
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        path = os.path.join(self.server.pbs_conf['PBS_HOME'], 'sched_priv',
+                            fname)
+        ret = self.du.cat(self.scheduler.hostname, path, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertEqual(ret['out'][0], 'capture\t1')
+        calls = set(l.split('\t')[1] for l in ret['out']
+                    if l.startswith('reply\t'))
+        for call in ['statserver', 'statsched', 'statrsc', 'statque',
+                     'statvnode', 'selstat']:
+            self.assertIn(call, calls)
+        self.assertTrue(ret['out'][-1].startswith('time\t'))
+        self.du.rm(self.scheduler.hostname, path, sudo=True, force=True)
+
+    def test_decision_trace(self):
+        """
+        Test that a SIGUSR2 dumps the decision trace to the
+        decision_trace_file with a record for each job considered
+        """
+        fname = 'decision_trace'
+        self.scheduler.set_sched_config({'decision_trace_file': fname})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        jid1 = self.server.submit(Job())
+        jid2 = self.server.submit(Job())
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+
+        self.assertTrue(self.scheduler.signal('-USR2'))
+        path = os.path.join(self.server.pbs_conf['PBS_HOME'], 'sched_priv',
+                            fname)
+        time.sleep(1)
+        self.assertTrue(self.du.isfile(self.scheduler.hostname, path,
+                                       sudo=True))
+        local = self.du.create_temp_file()
+        ret = self.du.run_copy(hosts=socket.gethostname(),
+                               srchost=self.scheduler.hostname, src=path,
+                               dest=local, sudo=True, mode=0o644)
+        self.assertEqual(ret['rc'], 0)
+        with open(local, 'rb') as f:
+            data = f.read()
+        self.du.rm(path=local, force=True)
+        self.du.rm(self.scheduler.hostname, path, sudo=True, force=True)
+
+        magic, rec_size, nrecs = struct.unpack_from('=8sII', data)
+        self.assertEqual(magic, b'PBSTRC01')
+        self.assertEqual(rec_size, 64)
+        self.assertEqual(len(data), 16 + nrecs * rec_size)
+        ran = {}
+        for i in range(nrecs):
+            rec = struct.unpack_from('=iIiIBB2x44s', data, 16 + i * rec_size)
+            jobid = rec[6].split(b'\0')[0].decode()
+            ran[jobid] = rec[5]
+        self.assertEqual(ran[jid1], 1)
+        self.assertEqual(ran[jid2], 0)
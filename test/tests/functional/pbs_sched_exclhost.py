@@ -0,0 +1,74 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedExclhost(TestFunctional):
+    """
+    Test exclhost placement on a host with several vnodes
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(a, 4, usenatvnode=True)
+
+    def test_busy_host_skipped(self):
+        """
+        A job on one vnode makes the whole host unavailable to an
+        exclhost job, which runs once the host is idle
+        """
+        vnode = self.mom.shortname + '[0]'
+        a = {'Resource_List.select': '1:ncpus=1:vnode=' + vnode}
+        j1 = Job(TEST_USER, a)
+        j1.set_sleep_time(20)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        a = {'Resource_List.select': '1:ncpus=1',
+             'Resource_List.place': 'exclhost'}
+        jid2 = self.server.submit(Job(TEST_USER, a))
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+        self.scheduler.log_match(jid2 + ';Host ' + self.mom.shortname +
+                                 ' is not free for exclusive use')
+
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid1, offset=20)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
@@ -0,0 +1,92 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedNodeStatus(TestFunctional):
+    """
+    Test that the scheduler sees vnode changes while it is only sent
+    the vnodes whose status changed
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.scheduler.set_sched_config({'node_refresh_cycles': '100'})
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, 3, vname='vn')
+
+    def test_changed_vnode(self):
+        """
+        Test that a vnode whose resources change between cycles is seen
+        with its new resources, and unchanged vnodes keep their status
+        """
+        self.scheduler.run_scheduling_cycle()
+
+        a = {'Resource_List.select': '1:ncpus=2'}
+        jid = self.server.submit(Job(attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2}, id='vn[1]')
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, {'exec_vnode': '(vn[1]:ncpus=2)'}, id=jid)
+
+        # unchanged vnodes are still usable
+        jid2 = self.server.submit(Job())
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+
+    def test_deleted_vnode(self):
+        """
+        Test that a deleted vnode is not used from the last status
+        """
+        self.scheduler.run_scheduling_cycle()
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2}, id='vn[2]')
+        self.scheduler.run_scheduling_cycle()
+        self.server.manager(MGR_CMD_DELETE, NODE, id='vn[2]')
+
+        a = {'Resource_List.select': '1:ncpus=2'}
+        jid = self.server.submit(Job(attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
@@ -0,0 +1,72 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedPinThreads(TestFunctional):
+    """
+    Test pinning the scheduler's worker threads to cpus
+    """
+
+    def test_pin_threads(self):
+        """
+        Test that the pin_threads sched_config option pins the worker
+        threads and that jobs still run across nodes checked by them
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, 2000, sharednode=False, expect=False)
+        self.server.expect(NODE, {'state=free': (GE, 2000)})
+
+        self.scheduler.stop()
+        self.scheduler.start(args=['-t', '2'])
+        t = time.time()
+        self.scheduler.set_sched_config({'pin_threads': 'True'})
+        self.scheduler.log_match('Launching 2 worker threads', starttime=t)
+        for th in [1, 2]:
+            self.scheduler.log_match('Thread %d pinned to cpu' % th,
+                                     starttime=t)
+
+        self.server.manager(MGR_CMD_SET, SCHED, {'scheduling': 'False'})
+        jid = self.server.submit(Job(attrs={
+            'Resource_List.select': '1500:ncpus=1',
+            'Resource_List.place': 'scatter'}))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
@@ -277,6 +277,77 @@ pbs.event().accept()
         # Check that server received PBS_BATCH_AsyrunJob_ack request
         self.server.log_match("Type 97 request received", starttime=t)
 
+    def test_runjob_hook_reject_pipelined(self):
+        """
+        Test that with job_run_wait=runjob_hook, the resources of a job
+        rejected by the runjob hook are given to other jobs in the same
+        cycle and the rejected job gets the hook's message as its comment
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {"resources_available.ncpus": 3},
+                            id=self.mom.shortname)
+        a = {"scheduling": "False", "job_run_wait": "runjob_hook"}
+        self.server.manager(MGR_CMD_SET, SCHED, a, id="default")
+
+        hook_txt = """
+import pbs
+
+e = pbs.event()
+if e.job.Job_Name == 'rejectme':
+    e.reject("rejecting pipelined job")
+e.accept()
+"""
+        hk_attrs = {'event': 'runjob', 'enabled': 'True'}
+        self.server.create_import_hook('rj', hk_attrs, hook_txt)
+
+        jids = []
+        for name in ['j1', 'rejectme', 'j3', 'j4']:
+            a = {'Resource_List.select': '1:ncpus=1', 'Job_Name': name}
+            jids.append(self.server.submit(Job(attrs=a)))
+
+        self.scheduler.run_scheduling_cycle()
+        for jid in [jids[0], jids[2], jids[3]]:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        a = {'job_state': 'Q',
+             'comment': (MATCH_RE, 'rejecting pipelined job')}
+        self.server.expect(JOB, a, id=jids[1])
+
+    def test_execjob_hook_reject_pipelined(self):
+        """
+        Test that with job_run_wait=execjob_hook, the run requests of a
+        cycle do not wait on each other and the resources of a job
+        rejected by an execjob_begin hook are given to other jobs in the
+        same cycle
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {"resources_available.ncpus": 3},
+                            id=self.mom.shortname)
+        a = {"scheduling": "False", "job_run_wait": "execjob_hook"}
+        self.server.manager(MGR_CMD_SET, SCHED, a, id="default")
+
+        hook_txt = """
+import pbs
+
+e = pbs.event()
+if e.job.Job_Name == 'rejectme':
+    e.reject("rejecting pipelined job")
+e.accept()
+"""
+        hk_attrs = {'event': 'execjob_begin', 'enabled': 'True'}
+        self.server.create_import_hook('ejb', hk_attrs, hook_txt)
+
+        jids = []
+        for name in ['j1', 'rejectme', 'j3', 'j4']:
+            a = {'Resource_List.select': '1:ncpus=1', 'Job_Name': name}
+            jids.append(self.server.submit(Job(attrs=a)))
+
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        for jid in [jids[0], jids[2], jids[3]]:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[1])
+        self.scheduler.log_match(jids[1] + ";Not Running", starttime=t)
+
     def test_throughput_ok(self):
         """
         Test that throughput_mode still works correctly
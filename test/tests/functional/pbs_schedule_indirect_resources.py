@@ -121,3 +121,50 @@ class TestIndirectResources(TestFunctional):
             self.server.status(JOB, 'exec_vnode', jid)
             vn = j.get_vnodes()
             self.assertEqual(int(vn[0][-2]) + 3, int(vn[1][-2]))
+
+    def test_shared_indirect_res_after_dup(self):
+        """
+        Test a consumable resource shared by several vnodes through
+        indirect references is accounted on the vnode it points to, also
+        in the copy of the universe the scheduler makes to plan a top job
+        Steps:
+        -> Configure 6 vnodes, the first one with 2 of 'foo' and the other
+        five pointing their 'foo' at it
+        -> Sort the vnodes so the target does not come first
+        -> Submit 3 jobs asking for 1 'foo' each with strict ordering on
+        -> Verify two jobs run, and the third is planned to start when
+        one of them ends
+        """
+        attr = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(attr, 6)
+        vn = ['%s[%d]' % (self.mom.shortname, i) for i in range(6)]
+
+        attr = {'type': 'long', 'flag': 'nh'}
+        self.server.manager(MGR_CMD_CREATE, RSC, attr, id='foo')
+        self.scheduler.add_resource('foo')
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.foo': 2}, vn[0])
+        for i in range(1, 6):
+            self.server.manager(MGR_CMD_SET, NODE,
+                                {'resources_available.foo': '@' + vn[0]},
+                                vn[i])
+            self.server.manager(MGR_CMD_SET, NODE, {'priority': 10 * i},
+                                vn[i])
+        a = {'node_sort_key': '"sort_priority HIGH" ALL',
+             'strict_ordering': 'True ALL'}
+        self.scheduler.set_sched_config(a)
+        self.server.manager(MGR_CMD_SET, SERVER, {'backfill_depth': 1})
+
+        attr = {'Resource_List.select': '1:ncpus=1:foo=1',
+                'Resource_List.walltime': 100}
+        jids = []
+        for _ in range(3):
+            jid, _ = self.submit_job(attr)
+            jids.append(jid)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[1])
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[2])
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jids[2])
+        self.assertEqual(self.server.status(NODE, 'resources_assigned.foo',
+                                            id=vn[0])[0]
+                         ['resources_assigned.foo'], '2')
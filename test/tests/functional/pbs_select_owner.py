@@ -0,0 +1,88 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSelectOwner(TestFunctional):
+    """
+    Test job selection by owner, which the server serves from its index
+    of jobs per owner
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.jids = {TEST_USER: [], TEST_USER1: []}
+        for user in (TEST_USER, TEST_USER1, TEST_USER):
+            jid = self.server.submit(Job(user))
+            self.jids[user].append(jid)
+
+    def check_select(self, user):
+        """
+        qselect -u user must return exactly the given user's jobs
+        """
+        jids = self.server.select({ATTR_u: str(user)})
+        self.assertEqual(sorted(jids), sorted(self.jids[user]))
+
+    def test_select_by_owner(self):
+        """
+        Select the jobs of each user, also after one of them is deleted
+        and after a server restart
+        """
+        self.check_select(TEST_USER)
+        self.check_select(TEST_USER1)
+        self.server.delete(self.jids[TEST_USER1][0], wait=True)
+        self.jids[TEST_USER1] = []
+        self.check_select(TEST_USER1)
+        self.server.restart()
+        self.check_select(TEST_USER)
+
+    def test_select_owner_and_queue(self):
+        """
+        A selection by owner and queue only returns the user's jobs in
+        that queue
+        """
+        a = {'queue_type': 'execution', 'enabled': 'True',
+             'started': 'True'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='workq2')
+        self.server.movejob(self.jids[TEST_USER][0], 'workq2')
+        jids = self.server.select({ATTR_u: str(TEST_USER),
+                                   ATTR_q: 'workq2'})
+        self.assertEqual(jids, [self.jids[TEST_USER][0]])
@@ -0,0 +1,88 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSelectParseCache(TestFunctional):
+    """
+    Test that the server's job wide limits and schedselect follow the
+    select specification when the same selects are parsed again and again
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def test_qalter_select_back_and_forth(self):
+        """
+        Alter a job's select between two specs several times and check the
+        summed limits and schedselect match the current one each time
+        """
+        j = Job(TEST_USER, {'Resource_List.select': '2:ncpus=1'})
+        jid = self.server.submit(j)
+        specs = [('2:ncpus=1', '2', '2'),
+                 ('1:ncpus=3+2:ncpus=2:mem=1gb', '7', '3')]
+        for _ in range(3):
+            for sel, ncpus, nodect in specs:
+                self.server.alterjob(jid, {'Resource_List.select': sel})
+                self.server.expect(JOB, {'Resource_List.ncpus': ncpus,
+                                         'Resource_List.nodect': nodect},
+                                   id=jid)
+        self.server.expect(JOB, {'schedselect':
+                                 (MATCH_RE, r'^1:ncpus=3\+2:ncpus=2:mem=1gb')},
+                           id=jid)
+
+    def test_bad_select_still_rejected(self):
+        """
+        Check a select the server has already parsed as bad is rejected
+        again, and a good one submitted in between is accepted
+        """
+        for sel in ['+1:ncpus=1', '1:ncpus=1', '+1:ncpus=1']:
+            j = Job(TEST_USER, {'Resource_List.select': sel})
+            if sel.startswith('+'):
+                with self.assertRaises(PbsSubmitError):
+                    self.server.submit(j)
+            else:
+                self.server.submit(j)
+        j = Job(TEST_USER, {'Resource_List.select': '1:nosuchres=1'})
+        with self.assertRaises(PbsSubmitError) as e:
+            self.server.submit(j)
+        self.assertIn('Unknown resource', e.exception.msg[0])
@@ -0,0 +1,131 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+import json
+import re
+
+from tests.functional import *
+
+
+class TestServerStats(TestFunctional):
+    """
+    The server keeps latency histograms for its main loop, shown in the
+    read-only server_stats attribute and optionally written as JSON
+    """
+
+    def list_server_stats(self, attr='server_stats'):
+        if self.du.is_localhost(self.server.hostname):
+            cmd = "list server " + attr
+        else:
+            cmd = "'list server " + attr + "'"
+        qmgr = [os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                             'qmgr'), '-c', cmd]
+        ret = self.du.run_cmd(self.server.hostname, qmgr, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        return "\n".join(ret['out'])
+
+    def test_list_stats(self):
+        """
+        Requests served are counted per type, and server_stats is left
+        out of the full server listing
+        """
+        self.server.submit(Job(TEST_USER))
+        self.server.status(SERVER)
+
+        out = self.list_server_stats()
+        self.assertIn("loop:count=", out)
+        self.assertIn("req.StatusSvr:count=", out)
+        self.assertIn("req.QueueJob:count=", out)
+        self.assertIn("p99=", out)
+
+        s = self.server.status(SERVER)
+        self.assertNotIn('server_stats', s[0])
+
+    def test_not_settable(self):
+        """
+        server_stats cannot be set
+        """
+        with self.assertRaises(PbsManagerError):
+            self.server.manager(MGR_CMD_SET, SERVER, {'server_stats': 'x'})
+
+    def test_stats_file(self):
+        """
+        Setting server_stats_interval makes the server write its
+        histograms to server_priv/server_stats.json
+        """
+        path = os.path.join(self.server.pbs_conf['PBS_HOME'], 'server_priv',
+                            'server_stats.json')
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'server_stats_interval': 1})
+        self.server.submit(Job(TEST_USER))
+        self.logger.info("Waiting for the statistics file")
+        time.sleep(5)
+        ret = self.du.cat(self.server.hostname, path, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        stats = json.loads("\n".join(ret['out']))
+        self.assertIn('loop', stats)
+        self.assertIn('buckets', stats['loop'])
+        self.assertIn('QueueJob', stats['requests'])
+        self.assertIn('jobs', stats['memory'])
+        self.assertIn('rss', stats['memory']['process'])
+
+    def test_server_memory(self):
+        """
+        server_memory counts the live jobs, and the count drops again when
+        they are gone
+        """
+        def jobs_count():
+            out = self.list_server_stats('server_memory')
+            m = re.search(r'jobs:count=(\d+),bytes=(\d+)', out)
+            self.assertIsNotNone(m)
+            self.assertIn("attributes:count=", out)
+            self.assertIn("process:vsz=", out)
+            return int(m.group(1))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        before = jobs_count()
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(3)]
+        self.assertEqual(jobs_count(), before + 3)
+        for jid in jids:
+            self.server.delete(jid, wait=True)
+        self.assertEqual(jobs_count(), before)
+
+        s = self.server.status(SERVER)
+        self.assertNotIn('server_memory', s[0])
@@ -0,0 +1,113 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSimpleJobPath(TestFunctional):
+    """
+    Test the first fit node search for single chunk, non-exclusive jobs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2, 'resources_available.mem': '4gb'}
+        self.mom.create_vnodes(a, 4, attrfunc=self.cust_attr_func)
+        self.vn = [self.mom.shortname + '[%d]' % i for i in range(4)]
+        self.server.manager(MGR_CMD_SET, SCHED,
+                            {'log_events': 2047})
+        self.scheduler.set_sched_config(
+            {'node_sort_key': '\"sort_priority HIGH\"'})
+
+    def cust_attr_func(self, name, totalnodes, numnode, attribs):
+        """
+        Give the vnodes a decreasing priority, so they sort in order
+        """
+        return {**attribs, 'Priority': 100 - numnode}
+
+    def submit_held(self, num, select='1:ncpus=1:mem=1gb'):
+        """
+        Submit num jobs with scheduling off
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(num):
+            j = Job(TEST_USER, attrs={'Resource_List.select': select})
+            jids.append(self.server.submit(j))
+        return jids
+
+    def vnode_of(self, jid):
+        """
+        Return the vnode a single chunk job runs on
+        """
+        st = self.server.status(JOB, 'exec_vnode', id=jid)
+        return st[0]['exec_vnode'].split(':')[0].lstrip('(')
+
+    def test_first_fit_in_sort_order(self):
+        """
+        Test simple jobs fill the vnodes in node sort order, and a vnode
+        freed by a job ending is used again first
+        """
+        jids = self.submit_held(6)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': 6})
+        for i, jid in enumerate(jids):
+            self.assertEqual(self.vnode_of(jid), self.vn[i // 2])
+
+        self.server.delete(jids[0], wait=True)
+        jids2 = self.submit_held(2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids2[0])
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids2[1])
+        self.assertEqual(self.vnode_of(jids2[0]), self.vn[0])
+        self.assertEqual(self.vnode_of(jids2[1]), self.vn[3])
+
+    def test_simple_job_can_not_run(self):
+        """
+        Test a simple job which fits on no vnode gets the comment
+        of the normal node search
+        """
+        jids = self.submit_held(1, select='1:ncpus=1:mem=8gb')
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'Q',
+                                 'comment': (MATCH_RE,
+                                             'Insufficient amount of '
+                                             'resource: mem')},
+                           id=jids[0])
@@ -0,0 +1,81 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+@requirements(num_moms=3)
+class TestSisterJoin(TestFunctional):
+    """
+    Mother superior sends JOIN_JOB to all sisters at once and starts
+    the job when the last one has answered
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if len(self.moms) != 3:
+            self.skipTest("test requires three MoMs as input, " +
+                          "use -p moms=<mom1:mom2:mom3>")
+
+    def test_join_all_sisters(self):
+        """
+        A job on three hosts runs once every sister joined
+        """
+        j = Job(TEST_USER)
+        j.set_attributes({'Resource_List.select': '3:ncpus=1',
+                          'Resource_List.place': 'scatter'})
+        j.set_sleep_time(5)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.expect(JOB, 'queue', id=jid, op=UNSET, offset=5)
+        self.server.accounting_match(';E;%s;.*Exit_status=0' % jid,
+                                     regexp=True, id=jid)
+
+    def test_join_twice(self):
+        """
+        A rerun job joins its sisters again
+        """
+        j = Job(TEST_USER)
+        j.set_attributes({'Resource_List.select': '3:ncpus=1',
+                          'Resource_List.place': 'scatter'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.server.rerunjob(jid)
+        self.server.expect(JOB, {'job_state': 'R', 'run_count': 2},
+                           id=jid)
@@ -0,0 +1,90 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestStatEncodedCache(TestFunctional):
+    """
+    Test that the encoded full status kept with each job is refreshed
+    whenever one of the job's attributes changes
+    """
+
+    def test_alter_seen_after_full_stat(self):
+        """
+        Full stat a job twice, alter it, and check both the full and the
+        single attribute status show the new value
+        """
+        j = Job(TEST_USER, {ATTR_N: 'first', ATTR_h: None})
+        jid = self.server.submit(j)
+        for _ in range(2):
+            self.server.expect(JOB, {ATTR_N: 'first'}, id=jid)
+        self.server.alterjob(jid, {ATTR_N: 'second'})
+        self.server.expect(JOB, {ATTR_N: 'second'}, id=jid)
+        job = self.server.status(JOB, ATTR_N, id=jid)[0]
+        self.assertEqual(job[ATTR_N], 'second')
+
+    def test_privilege_kept_apart(self):
+        """
+        A user's full status of a job must not be handed to a manager,
+        who sees more attributes, and the other way around
+        """
+        j = Job(TEST_USER, {ATTR_h: None})
+        jid = self.server.submit(j)
+        mgr = self.server.status(JOB, id=jid)[0]
+        usr = self.server.status(JOB, id=jid, runas=TEST_USER)[0]
+        mgr2 = self.server.status(JOB, id=jid)[0]
+        self.assertEqual(sorted(mgr.keys()), sorted(mgr2.keys()))
+        self.assertLessEqual(len(usr.keys()), len(mgr.keys()))
+
+    def test_suspended_state_shown(self):
+        """
+        The suspended state is set only for the stat, check it is still
+        shown after a full stat of the running job was cached
+        """
+        self.server.manager(MGR_CMD_SET, NODE, {'resources_available.ncpus':
+                                                1}, id=self.mom.shortname)
+        j = Job(TEST_USER)
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
+        self.server.sigjob(jid, 'suspend')
+        self.server.expect(JOB, {ATTR_state: 'S'}, id=jid)
+        self.server.sigjob(jid, 'resume')
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
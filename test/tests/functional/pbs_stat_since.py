@@ -0,0 +1,101 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestStatSince(TestFunctional):
+    """
+    Test the modify_seq kept with each object and the status of only the
+    objects changed since a given modify_seq
+    """
+
+    def stat_since(self, c, seq):
+        """
+        Status all jobs changed since seq, return a dictionary of job id
+        to the dictionary of its attributes
+        """
+        jobs = {}
+        head = pbs_statjob(c, None, None, 'since=%d' % seq)
+        b = head
+        while b is not None:
+            attrs = {}
+            a = b.attribs
+            while a is not None:
+                attrs[a.name] = a.value
+                a = a.next
+            jobs[b.name] = attrs
+            b = b.next
+        pbs_statfree(head)
+        return jobs
+
+    def test_since_job(self):
+        """
+        Stat jobs since their modify_seq, alter one of them, and check
+        only the altered job comes back with its attributes
+        """
+        if not API_OK:
+            self.skipTest("needs the swig generated pbs_ifl module")
+        jid1 = self.server.submit(Job(TEST_USER, attrs={ATTR_h: None}))
+        jid2 = self.server.submit(Job(TEST_USER, attrs={ATTR_h: None}))
+
+        c = pbs_connect(self.server.hostname)
+        self.assertGreaterEqual(c, 0, "could not connect to the server")
+        try:
+            jobs = self.stat_since(c, 1)
+            self.assertIn(ATTR_modify_seq, jobs[jid1])
+            self.assertIn(ATTR_modify_seq, jobs[jid2])
+            seq = max(int(jobs[jid1][ATTR_modify_seq]),
+                      int(jobs[jid2][ATTR_modify_seq]))
+
+            # nothing changed, both jobs are listed by name only
+            jobs = self.stat_since(c, seq)
+            self.assertEqual(jobs, {jid1: {}, jid2: {}})
+
+            self.server.alterjob(jid2, {ATTR_N: 'since'})
+            jobs = self.stat_since(c, seq)
+            self.assertEqual(jobs[jid1], {})
+            self.assertEqual(jobs[jid2][ATTR_N], 'since')
+            self.assertGreater(int(jobs[jid2][ATTR_modify_seq]), seq)
+        finally:
+            pbs_disconnect(c)
+
+        # a plain status does not carry modify_seq
+        job = self.server.status(JOB, id=jid2)[0]
+        self.assertNotIn(ATTR_modify_seq, job)
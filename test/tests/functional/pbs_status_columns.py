@@ -0,0 +1,83 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestStatusColumns(TestFunctional):
+    """
+    Test the columnar status conversion of the pbs_ifl module
+    """
+
+    def test_columns_match_status(self):
+        """
+        Stat a set of jobs through pbs_ifl, convert the reply to columns
+        and check they agree with the row-wise status
+        """
+        if not API_OK:
+            self.skipTest("needs the swig generated pbs_ifl module")
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for i in range(5):
+            a = {ATTR_N: 'col%d' % i}
+            if i % 2:
+                a['Resource_List.mem'] = '%dmb' % (i + 1)
+            jids.append(self.server.submit(Job(TEST_USER, a)))
+        c = pbs_connect(self.server.hostname)
+        self.assertGreater(c, 0, 'could not connect to the server')
+        try:
+            bs = pbs_statjob(c, None, None, None)
+            names = [ATTR_N, 'Resource_List.mem', 'no_such_attr']
+            cols = BatchUtils().batch_status_to_columns(bs, names)
+            allcols = BatchUtils().batch_status_to_columns(bs)
+            pbs_statfree(bs)
+        finally:
+            pbs_disconnect(c)
+        self.assertEqual(cols['id'], jids)
+        self.assertEqual(cols[ATTR_N], ['col%d' % i for i in range(5)])
+        self.assertEqual(cols['Resource_List.mem'],
+                         [None, '2mb', None, '4mb', None])
+        self.assertEqual(cols['no_such_attr'], [None] * 5)
+        self.assertEqual(allcols[ATTR_N], cols[ATTR_N])
+        self.assertEqual(allcols['Resource_List.mem'],
+                         cols['Resource_List.mem'])
+        for i, jid in enumerate(jids):
+            st = self.server.status(JOB, 'job_state', id=jid)
+            self.assertEqual(allcols['job_state'][i], st[0]['job_state'])
@@ -0,0 +1,89 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestStatusSnapshot(TestFunctional):
+    """
+    Test the PBS_STATUS_SNAPSHOT pbs.conf setting, which has the server
+    write a status snapshot that local clients read with pbs_statsnap()
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.snap = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                                 'server_priv', 'status_snapshot')
+        self.conf = {'PBS_STATUS_SNAPSHOT': '2'}
+        self.du.set_pbs_config(self.server.hostname, confs=self.conf)
+        self.server.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=list(self.conf.keys()))
+        self.server.restart()
+        TestFunctional.tearDown(self)
+
+    def test_snapshot_written(self):
+        """
+        The snapshot is refreshed with the jobs, vnodes and queues, is
+        only readable by root, and is removed when the server goes down
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        j = Job(TEST_USER, {ATTR_N: 'snapjob', ATTR_h: None})
+        jid = self.server.submit(j)
+        start = time.time()
+        self.server.log_match("Status snapshot .* written", regexp=True,
+                              starttime=start)
+        for name in [jid, 'snapjob', self.mom.shortname, 'workq']:
+            ret = self.du.run_cmd(self.server.hostname,
+                                  ['grep', '-a', '-q', name, self.snap],
+                                  sudo=True)
+            self.assertEqual(ret['rc'], 0, "%s not in snapshot" % name)
+
+        ret = self.du.run_cmd(self.server.hostname,
+                              ['stat', '-c', '%a', self.snap], sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertEqual(ret['out'][0].strip(), '600')
+
+        self.server.stop()
+        self.assertFalse(self.du.isfile(self.server.hostname, self.snap,
+                                        sudo=True))
+        self.server.start()
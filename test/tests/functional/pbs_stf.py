@@ -184,6 +184,31 @@ class TestSTF(TestFunctional):
         attr = {'Resource_List.walltime': (GE, '00:10:00')}
         self.server.expect(JOB, attr, id=jid)
 
+    def test_shrink_to_first_of_many_dedtimes(self):
+        """
+        Test shrink to fit with several dedicated times, one of them inside
+        another.  The job must shrink to the start of the earliest one.
+        """
+        now = int(time.time())
+        self.scheduler.add_dedicated_time(start=now + 3600, end=now + 36000,
+                                          hup=False)
+        self.scheduler.add_dedicated_time(start=now + 7200, end=now + 9000,
+                                          hup=False)
+        self.scheduler.add_dedicated_time(start=now + 72000,
+                                          end=now + 75600)
+
+        a = {'Resource_List.max_walltime': '10:00:00',
+             'Resource_List.min_walltime': '00:10:00'}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        attr = {'Resource_List.walltime': (LE, '01:00:00')}
+        self.server.expect(JOB, attr, id=jid)
+
+        attr = {'Resource_List.walltime': (GE, '00:10:00')}
+        self.server.expect(JOB, attr, id=jid)
+
     def test_t_4_2_1(self):
         """
         Test shrink to fit by setting primetime that starts 4 hours from now
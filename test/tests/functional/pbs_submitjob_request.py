@@ -0,0 +1,86 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSubmitJobRequest(TestFunctional):
+    """
+    A job with a script is queued with a single Submit Job request that
+    carries the attributes and the script together
+    """
+
+    def test_script_is_kept(self):
+        """
+        The script sent with the request is the one the job runs
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        j = Job(TEST_USER)
+        j.create_script(['#!/bin/sh', 'echo submitjob_marker_$((40+2))'])
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           max_attempts=30)
+        self.server.log_match("%s;Job Queued" % jid)
+        job = self.server.status(JOB, id=jid, extend='x')[0]
+        out = job[ATTR_o].split(':', 1)[1]
+        ret = self.du.cat(self.server.client, filename=out, sudo=True)
+        self.assertIn('submitjob_marker_42', ret['out'])
+
+    def test_block_job(self):
+        """
+        A blocking job with a script still gets its Commit request
+        """
+        j = Job(TEST_USER, attrs={ATTR_block: 'true'})
+        j.create_script(['#!/bin/sh', 'sleep 1'])
+        jid = self.server.submit(j)
+        self.server.log_match("%s;Job Queued" % jid)
+
+    def test_script_max_size(self):
+        """
+        jobscript_max_size is checked for a script sent with the request
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'jobscript_max_size': 10})
+        j = Job(TEST_USER)
+        j.create_script(['echo "a line longer than the limit"'])
+        with self.assertRaises(PbsSubmitError) as e:
+            self.server.submit(j)
+        self.assertIn("jobscript size exceeded the jobscript_max_size",
+                      e.exception.msg[0])
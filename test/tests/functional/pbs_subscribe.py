@@ -0,0 +1,129 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSubscribe(TestFunctional):
+    """
+    Test the job, vnode and reservation state change events the server
+    pushes to a connection subscribed with pbs_subscribe()
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        if not API_OK:
+            self.skipTest("needs the swig generated pbs_ifl module")
+        self.c = pbs_connect(self.server.hostname)
+        self.assertGreaterEqual(self.c, 0, "could not connect to the server")
+
+    def tearDown(self):
+        if getattr(self, 'c', -1) >= 0:
+            pbs_disconnect(self.c)
+        TestFunctional.tearDown(self)
+
+    def get_events(self, want, timeout=30):
+        """
+        Read events until one for each (name, attribute, value) in want was
+        seen or timeout seconds passed, return the events read as a list of
+        (name, dictionary of attributes)
+        """
+        events = []
+        left = list(want)
+        end = time.time() + timeout
+        while left and time.time() < end:
+            head = pbs_get_events(self.c, 2)
+            b = head
+            while b is not None:
+                attrs = {}
+                a = b.attribs
+                while a is not None:
+                    attrs[a.name] = a.value
+                    a = a.next
+                events.append((b.name, attrs))
+                for w in list(left):
+                    if w[0] == b.name and attrs.get(w[1]) == w[2]:
+                        left.remove(w)
+                b = b.next
+            pbs_statfree(head)
+        self.assertEqual(left, [], "events not seen: %s" % str(left))
+        return events
+
+    def test_job_events(self):
+        """
+        Subscribe to job events, hold and release a job and check the
+        state changes are pushed with their event time
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.assertEqual(pbs_subscribe(self.c, SUBSCRIBE_JOB, None, None), 0)
+        jid = self.server.submit(Job(TEST_USER, attrs={ATTR_h: None}))
+        self.server.rlsjob(jid, 'u')
+        events = self.get_events([(jid, ATTR_state, 'H'),
+                                  (jid, ATTR_state, 'Q')])
+        for name, attrs in events:
+            self.assertIn(ATTR_event_time, attrs)
+
+    def test_owner_filter(self):
+        """
+        Subscribe to the jobs of one user and check the state changes of
+        another user's jobs are not pushed
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = BatchUtils().dict_to_attrl({ATTR_euser: str(TEST_USER1)})
+        self.assertEqual(pbs_subscribe(self.c, SUBSCRIBE_JOB, a, None), 0)
+        jid1 = self.server.submit(Job(TEST_USER, attrs={ATTR_h: None}))
+        jid2 = self.server.submit(Job(TEST_USER1, attrs={ATTR_h: None}))
+        events = self.get_events([(jid2, ATTR_state, 'H')])
+        self.assertNotIn(jid1, [name for name, _ in events])
+
+    def test_node_events(self):
+        """
+        Subscribe to vnode events and check offlining a vnode is pushed
+        """
+        self.assertEqual(pbs_subscribe(self.c, SUBSCRIBE_NODE, None, None),
+                         0)
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=self.mom.shortname)
+        self.get_events([(self.mom.shortname, ATTR_NODE_state, 'offline')])
+
+    def test_bad_class(self):
+        """
+        An unknown event class is rejected
+        """
+        self.assertNotEqual(pbs_subscribe(self.c, 'bogus', None, None), 0)
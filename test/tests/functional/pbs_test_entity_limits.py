@@ -1036,3 +1036,42 @@ class TestEntityLimits(TestFunctional):
         self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
         self.server.expect(JOB, {'job_state': 'S'}, id=jid1)
         self.server.expect(JOB, {'job_state': 'Q'}, id=jid4)
+
+    def test_limits_among_many_entities(self):
+        """
+        Test that a user's limits are found, changed and removed correctly
+        when many other users have limits on the same attribute, both at
+        submission (server) and when running jobs (scheduler).
+        """
+        a = {'resources_available.ncpus': 4}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        others = ",".join("[u:user%d=%d]" % (i, i + 5) for i in range(50))
+
+        # server: max_queued with a specific limit for TEST_USER
+        a = {'max_queued': others + ",[u:%s=2]" % TEST_USER}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        for _ in range(2):
+            self.server.submit(Job(TEST_USER))
+        with self.assertRaises(PbsSubmitError) as e:
+            self.server.submit(Job(TEST_USER))
+        self.assertIn(str(TEST_USER), e.exception.msg[0])
+
+        # raising the specific limit lets one more job in
+        a = {'max_queued': others + ",[u:%s=3]" % TEST_USER}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.submit(Job(TEST_USER))
+        self.server.manager(MGR_CMD_UNSET, SERVER, 'max_queued')
+        self.server.cleanup_jobs()
+
+        # scheduler: max_run_res.ncpus with a specific limit for TEST_USER
+        a = {'max_run_res.ncpus': others + ",[u:%s=1]" % TEST_USER}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        j1 = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, {'job_state': 'R'}, id=j1)
+        j2 = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, {'job_state': 'Q'}, id=j2)
+
+        # with only other users limited, TEST_USER is not limited at all
+        a = {'max_run_res.ncpus': others}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.expect(JOB, {'job_state': 'R'}, id=j2)
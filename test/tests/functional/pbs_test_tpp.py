@@ -265,6 +265,149 @@ class TestTPP(TestFunctional):
         self.common_steps(job=True, interactive=True, resv=True,
                           resv_job=True)
 
+    def test_many_small_messages(self):
+        """
+        Run a burst of short subjobs so that many small TPP messages
+        queue up on the same connections and are sent out together,
+        and verify every subjob still completes
+        """
+        a = {'resources_available.ncpus': 8}
+        self.mom.create_vnodes(a, 1)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        j = Job(TEST_USER, attrs={ATTR_J: '1-200'})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=5, interval=2, max_attempts=150)
+        for i in [1, 100, 200]:
+            sjid = j.create_subjob_id(jid, i)
+            self.server.expect(JOB, {'exit_status': 0}, id=sjid,
+                               extend='x')
+
+    def test_burst_delete(self):
+        """
+        Run a large array job and delete it while its subjobs are
+        running, so that a burst of commands is posted to the TPP
+        threads at once, and verify the node returns to free
+        """
+        a = {'resources_available.ncpus': 100}
+        self.mom.create_vnodes(a, 1)
+        j = Job(TEST_USER, attrs={ATTR_J: '1-100'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'B'}, id=jid)
+        self.server.expect(JOB, {'job_state=R': 100}, count=True,
+                           extend='t', max_attempts=60)
+        self.server.delete(jid, wait=True)
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname,
+                           max_attempts=60)
+        self.server.expect(NODE, {'resources_assigned.ncpus': 0},
+                           id=self.mom.shortname)
+
+    def test_io_uring_event_backend(self):
+        """
+        Set PBS_USE_IO_URING on the server host so the server and pbs_comm
+        monitor their sockets with io_uring, restart the mom so it
+        reconnects, and verify jobs still run and qstat still answers
+        """
+        self.node_list.append(self.server.hostname)
+        self.set_pbs_conf(self.server.hostname, {'PBS_USE_IO_URING': 1})
+        self.mom.restart()
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        jids = []
+        for _ in range(5):
+            j = Job(TEST_USER)
+            j.set_sleep_time(1)
+            jids.append(self.server.submit(j))
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'F', 'exit_status': 0},
+                               id=jid, extend='x', max_attempts=60)
+        self.server.log_match("io_uring not available", existence=False,
+                              max_attempts=1)
+
+    def test_reconnect_after_comm_restart(self):
+        """
+        Restart pbs_comm and verify the mom reconnects, says hello to the
+        server again and its node returns to free within the bounded
+        reconnect window
+        """
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.comm.stop('-KILL')
+        self.server.expect(NODE, {'state': (MATCH_RE, 'down')},
+                           id=self.mom.shortname)
+        start = time.time()
+        self.comm.start()
+        self.mom.log_match("HELLO sent to server", starttime=int(start),
+                           max_attempts=60)
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname,
+                           max_attempts=60)
+
+    def test_lz4_compression(self):
+        """
+        Select the lz4 codec with PBS_USE_COMPRESSION=2 and verify that a
+        job whose script is large enough to be compressed on its way to
+        the mom still runs and produces the expected output
+        """
+        self.node_list.append(self.server.hostname)
+        self.set_pbs_conf(self.server.hostname, {'PBS_USE_COMPRESSION': 2})
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        lines = ['# padding line %d to make the job script large' % i
+                 for i in range(1000)]
+        script = '\n'.join(lines) + '\necho lz4_done\n'
+        j = Job(TEST_USER)
+        j.create_script(script)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F', 'exit_status': 0},
+                           id=jid, extend='x', max_attempts=60)
+        self.mom.log_match("Job;%s;Started" % jid, regexp=False,
+                           max_attempts=5)
+
+    def test_coalesce_delay(self):
+        """
+        Set PBS_TPP_COALESCE_DELAY so that small messages are held back
+        to be sent together, and verify that node state, job start and
+        job obit traffic still flow between server and mom
+        """
+        self.node_list.append(self.server.hostname)
+        self.set_pbs_conf(self.server.hostname,
+                          {'PBS_TPP_COALESCE_DELAY': 20})
+        self.server.log_match("Using TPP coalesce delay of 20 ms")
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        j = Job(TEST_USER, attrs={ATTR_J: '1-50'})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=5, interval=2, max_attempts=100)
+
+    def test_comm_threads_route_cache(self):
+        """
+        With several pbs_comm threads forwarding at once, verify that
+        traffic between server and mom keeps flowing both before and
+        after the route to the mom changes
+        """
+        self.node_list.append(self.server.hostname)
+        self.set_pbs_conf(self.server.hostname, {'PBS_COMM_THREADS': 8})
+        self.server.expect(NODE, {'state': 'free'}, id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        for _ in range(2):
+            j = Job(TEST_USER, attrs={ATTR_J: '1-50'})
+            j.set_sleep_time(1)
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'F'}, id=jid,
+                               extend='x', offset=5, interval=2,
+                               max_attempts=100)
+            # reconnecting the mom invalidates the cached routes
+            self.mom.restart()
+            self.server.expect(NODE, {'state': 'free'},
+                               id=self.mom.shortname)
+
     @skip(reason="Run this through cmd-line by removing this decorator")
     @requirements(num_moms=2, num_clients=1)
     def test_client_with_mom(self):
@@ -1023,6 +1166,50 @@ class TestTPP(TestFunctional):
         self.set_pbs_conf(host_name=self.server.shortname, conf_param=c)
         self.common_steps_for_mom_pool_tests()
 
+    @requirements(num_moms=2, no_mom_on_server=True, num_comms=3)
+    def test_mcast_across_comm_hops(self):
+        """
+        Test that a multicast reaches moms that are two pbs_comm hops
+        away from the server, with every pbs_comm on the way forwarding
+        a single MCAST packet rather than one copy per mom
+        Configuration:
+        Node 1 : Server, Sched, Comm (self.hostA)
+        Node 2 : Mom (self.hostB)
+        Node 3 : Comm (self.hostD)
+        Node 4 : Mom (self.hostC)
+        Node 5 : Comm (self.hostE)
+        """
+        self.common_setup(no_mom_on_comm=True, req_comms=3)
+        a = {'PBS_COMM_ROUTERS': self.hostA}
+        for host in [self.hostD, self.hostE]:
+            self.set_pbs_conf(host_name=host, conf_param=a)
+        b = {'PBS_LEAF_ROUTERS': self.hostE}
+        for host in [self.hostB, self.hostC]:
+            self.set_pbs_conf(host_name=host, conf_param=b)
+        c = {'PBS_LEAF_ROUTERS': self.hostD}
+        self.set_pbs_conf(host_name=self.server.shortname, conf_param=c)
+        self.server.expect(NODE, {'state': 'free'}, id=self.hostB)
+        self.server.expect(NODE, {'state': 'free'}, id=self.hostC)
+
+        start = time.time()
+        hook_name = "mcast_hops"
+        attrs = {'event': 'execjob_begin', 'enabled': 'True'}
+        self.server.create_hook(hook_name, attrs)
+        self.server.import_hook(hook_name, body="import pbs")
+        comm_e = self.comms[self.hostE]
+        comm_e.log_match("MCAST packet from", starttime=start)
+        comm_e.log_match("Sending MCAST packet", starttime=start,
+                         existence=False, max_attempts=5)
+        self.comms[self.hostA].log_match("Sending MCAST packet to",
+                                         starttime=start)
+        self.comms[self.hostA].log_match("mcast hop limit reached",
+                                         starttime=start, existence=False,
+                                         max_attempts=5)
+        for host in [self.hostB, self.hostC]:
+            self.moms[host].log_match(
+                "%s.PY;copy hook-related file request received" % hook_name,
+                starttime=start)
+
     @requirements(num_moms=4, no_mom_on_server=True, num_comms=5)
     def test_comm_failover_with_isolated_mom_pools(self):
         """
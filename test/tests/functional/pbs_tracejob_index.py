@@ -0,0 +1,75 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestTracejobIndex(TestFunctional):
+    """
+    Test the log indexes tracejob keeps next to the log directories
+    """
+
+    def test_index_created_and_used(self):
+        """
+        Test that tracejob builds an index of the server log and reports
+        the same lines, including newer ones, when it uses the index
+        """
+        j = Job(TEST_USER, attrs={ATTR_h: None})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'H'}, id=jid)
+
+        first = self.server.log_lines(logtype='tracejob', id=jid, n='ALL')
+        idx_dir = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                               'server_logs.index')
+        self.assertTrue(self.du.isdir(path=idx_dir, sudo=True),
+                        'tracejob did not create ' + idx_dir)
+
+        again = self.server.log_lines(logtype='tracejob', id=jid, n='ALL')
+        self.assertEqual(first, again)
+
+        # lines logged after the index was built are still found
+        self.server.rlsjob(jid, USER_HOLD)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        later = self.server.log_lines(logtype='tracejob', id=jid, n='ALL')
+        self.assertGreater(len(later), len(first))
+        self.du.rm(path=idx_dir, recursive=True, force=True, sudo=True)
+        full = self.server.log_lines(logtype='tracejob', id=jid, n='ALL')
+        self.assertEqual(later, full)
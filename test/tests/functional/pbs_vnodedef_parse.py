@@ -0,0 +1,78 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestVnodeDefParse(TestFunctional):
+    """
+    Test vnode definitions carrying many resources per vnode, which the
+    Mom and the server look up by name while parsing and applying them
+    """
+
+    def test_many_resources_per_vnode(self):
+        """
+        Every resource of every vnode is set, and a resource defined twice
+        for a vnode keeps the value given last
+        """
+        nres = 24
+        nvnodes = 8
+        rescs = ['vdp%d' % i for i in range(nres)]
+        for r in rescs:
+            self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'long',
+                                                      'flag': 'nh'}, id=r)
+        self.server.manager(MGR_CMD_DELETE, NODE, None, "")
+        host = self.mom.shortname
+        a = {'resources_available.ncpus': 1}
+        for i, r in enumerate(rescs):
+            a['resources_available.' + r] = i
+        vdef = self.mom.create_vnode_def(host, a, nvnodes)
+        self.assertNotEqual(vdef, None)
+        vdef += '%s[0]: resources_available.%s=%d\n' % (host, rescs[-1],
+                                                         1000)
+        self.mom.insert_vnode_def(vdef, 'vnode.def')
+        self.server.manager(MGR_CMD_CREATE, NODE, id=host)
+        for n in range(nvnodes):
+            vn = '%s[%d]' % (host, n)
+            exp = {'state': 'free'}
+            for i, r in enumerate(rescs):
+                exp['resources_available.' + r] = i
+            if n == 0:
+                exp['resources_available.' + rescs[-1]] = 1000
+            self.server.expect(VNODE, exp, id=vn)
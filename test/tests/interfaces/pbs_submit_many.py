@@ -0,0 +1,123 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2020 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.interfaces import *
+
+test_code = '''
+#include <stdio.h>
+#include <string.h>
+#include <pbs_ifl.h>
+
+int main(int argc, char **argv)
+{
+    struct attropl common[2] = {
+        {&common[1], ATTR_N, NULL, "common", SET},
+        {NULL, ATTR_l, "ncpus", "1", SET}
+    };
+    struct attropl own = {NULL, ATTR_N, NULL, "own", SET};
+    struct attropl bad = {NULL, ATTR_l, "ncpus", "bogus", SET};
+    struct attropl *job_attribs[3] = {&own, NULL, &bad};
+    char *scripts[3] = {NULL, argv[1], NULL};
+    struct batch_deljob_status *stat, *p;
+    int c = pbs_connect(NULL);
+
+    if (c <= 0)
+        return 1;
+    stat = pbs_submit_many(c, common, 3, job_attribs, scripts, NULL, NULL);
+    if (stat == NULL)
+        return 1;
+    for (p = stat; p != NULL; p = p->next)
+        printf("%s %d\\n", p->name[0] ? p->name : "-", p->code);
+    pbs_delstatfree(stat);
+    pbs_disconnect(c);
+    return 0;
+}
+'''
+
+
+class TestSubmitMany(TestInterfaces):
+    """
+    Test suite for submitting many jobs with one pbs_submit_many() call
+    """
+
+    def test_submit_many(self):
+        """
+        Submit three jobs sharing attributes, one of them with a script
+        and one with a bad value.  The reply must have one entry per job
+        in the order of the request, and the attributes of a job must
+        win over the shared ones.
+        """
+        if self.du.get_platform().lower() != 'linux':
+            self.skipTest("This test is only supported on Linux!")
+        _gcc = self.du.which(exe='gcc')
+        if _gcc == 'gcc':
+            self.skipTest("Couldn't find gcc!")
+        _exec = self.server.pbs_conf['PBS_EXEC']
+        _id = os.path.join(_exec, 'include')
+        _ld = os.path.join(_exec, 'lib')
+        if not self.du.isfile(path=os.path.join(_id, 'pbs_ifl.h')):
+            _m = "Couldn't find pbs_ifl.h in %s" % _id
+            _m += ", Please install PBS devel package"
+            self.skipTest(_m)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        _fn = self.du.create_temp_file(body=test_code, suffix='.c')
+        _en = self.du.create_temp_file()
+        self.du.rm(path=_en)
+        cmd = ['gcc', '-g', '-O2', '-Wall', '-Werror']
+        cmd += ['-o', _en]
+        cmd += ['-I%s' % _id, _fn, '-L%s' % _ld, '-lpbs', '-lz']
+        _res = self.du.run_cmd(cmd=cmd)
+        self.assertEqual(_res['rc'], 0, "\n".join(_res['err']))
+        _sc = self.du.create_temp_file(body='#!/bin/sh\nsleep 100\n')
+        cmd = ['LD_LIBRARY_PATH=%s %s %s' % (_ld, _en, _sc)]
+        _res = self.du.run_cmd(cmd=cmd, as_script=True)
+        self.assertEqual(_res['rc'], 0)
+        self.assertEqual(len(_res['out']), 3)
+        ids = [l.split()[0] for l in _res['out']]
+        codes = [int(l.split()[1]) for l in _res['out']]
+        self.assertEqual(codes[:2], [0, 0])
+        self.assertNotEqual(codes[2], 0)
+        self.assertEqual(ids[2], '-')
+        self.server.expect(JOB, {ATTR_N: 'own', 'Resource_List.ncpus': 1},
+                           id=ids[0])
+        self.server.expect(JOB, {ATTR_N: 'common', 'job_state': 'Q'},
+                           id=ids[1])
+        jobs = self.server.status(JOB)
+        self.assertEqual(len(jobs), 2)
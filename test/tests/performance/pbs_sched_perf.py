@@ -280,6 +280,33 @@ class TestSchedPerf(TestPerformance):
 
         self.perf_test_result(times, m, "sec")
 
+    @timeout(3600)
+    def test_run_wide_jobs_with_psets(self):
+        """
+        Time a cycle which runs and calendars jobs of 1000 chunks with
+        placement sets enabled.  Each run updates the jobs' nodes and
+        every placement set they are in.
+        """
+        self.common_setup1()
+        self.scheduler.set_sched_config({'strict_ordering': 'True'})
+        a = {'node_group_key': 'color', 'node_group_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        num_jobs = 100
+        a = {'Resource_List.select': '1000:ncpus=1'}
+        self.submit_jobs(a, num_jobs, step=60, wt_start=3600)
+
+        t = self.run_cycle()
+        # one job fits in each color's placement set
+        self.server.expect(JOB, {'job_state=R': 7},
+                           trigger_sched_cycle=False)
+        m = 'Time taken in cycle to run and calendar %d 1000 chunk jobs' % \
+            num_jobs
+        self.logger.info('#' * 80)
+        self.logger.info('%s: %.2f' % (m, t))
+        self.logger.info('#' * 80)
+        self.perf_test_result(t, m, "seconds")
+
     @timeout(10000)
     def test_many_jobs_with_calendaring(self):
         """
@@ -86,3 +86,36 @@ class TestDependencyPerformance(TestPerformance):
         self.check_depend_delete_msg(j_arr[4999], j_arr[5000])
         self.perf_test_result((t2 - t1),
                               "time_taken_delete_all_dependent_jobs", "sec")
+
+    @timeout(1800)
+    def test_release_wide_dependency_fan_out(self):
+        """
+        Submit many jobs that depend on a single job, which registers each
+        of them with that one job, and then measure the time PBS takes to
+        release all of them once the job ends.
+        """
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job())
+        j_arr = []
+        t1 = time.time()
+        for _ in range(5000):
+            a = {ATTR_depend: 'afterany:' + jid}
+            j_arr.append(self.server.submit(Job(attrs=a)))
+        t2 = time.time()
+        self.server.expect(JOB, {ATTR_state: 'H'}, id=j_arr[-1])
+
+        t3 = time.time()
+        self.server.delete(jid)
+        self.server.expect(JOB, {ATTR_state: 'Q'}, id=j_arr[-1], interval=2)
+        t4 = time.time()
+        self.logger.info('#' * 80)
+        self.logger.info('Time taken to register all dependents %f' %
+                         (t2 - t1))
+        self.logger.info('Time taken to release all dependents %f' %
+                         (t4 - t3))
+        self.logger.info('#' * 80)
+        self.perf_test_result((t2 - t1),
+                              "time_taken_register_all_dependent_jobs", "sec")
+        self.perf_test_result((t4 - t3),
+                              "time_taken_release_all_dependent_jobs", "sec")